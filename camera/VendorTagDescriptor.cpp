@@ -237,11 +237,11 @@ const char* VendorTagDescriptor::getTagName(uint32_t tag) const {
 }
 
 int VendorTagDescriptor::getTagType(uint32_t tag) const {
-    ssize_t index = mTagToNameMap.indexOfKey(tag);
+    ssize_t index = mTagToTypeMap.indexOfKey(tag);
     if (index < 0) {
         return VENDOR_TAG_TYPE_ERR;
     }
-    return mTagToTypeMap.valueFor(tag);
+    return mTagToTypeMap.valueAt(index);
 }
 
 status_t VendorTagDescriptor::writeToParcel(Parcel* parcel) const {
@@ -284,7 +284,8 @@ const SortedVector<String8>* VendorTagDescriptor::getAllSectionNames() const {
     return &mSections;
 }
 
-status_t VendorTagDescriptor::lookupTag(String8 name, String8 section, /*out*/uint32_t* tag) const {
+status_t VendorTagDescriptor::lookupTag(const String8& name, const String8& section,
+        /*out*/uint32_t* tag) const {
     ssize_t index = mReverseMapping.indexOfKey(section);
     if (index < 0) {
         ALOGE("%s: Section '%s' does not exist.", __FUNCTION__, section.string());
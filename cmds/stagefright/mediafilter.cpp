@@ -50,11 +50,13 @@ static const int64_t kTimeout = 500ll;
 static const int32_t kInvert = false;   // ZeroFilter param
 static const float kBlurRadius = 15.0f; // IntrinsicBlurFilter param
 static const float kSaturation = 0.0f;  // SaturationFilter param
+static const char *kFilterChain = "saturation,invert";  // FilterChain param
 
 static void usage(const char *me) {
     fprintf(stderr, "usage: [flags] %s\n"
                     "\t[-b] use IntrinsicBlurFilter\n"
                     "\t[-c] use argb to rgba conversion RSFilter\n"
+                    "\t[-f] use FilterChain (saturation and invert)\n"
                     "\t[-n] use night vision RSFilter\n"
                     "\t[-r] use saturation RSFilter\n"
                     "\t[-s] use SaturationFilter\n"
@@ -153,6 +155,7 @@ enum FilterType {
     FILTERTYPE_RS_SATURATION,
     FILTERTYPE_RS_NIGHT_VISION,
     FILTERTYPE_RS_ARGB_TO_RGBA,
+    FILTERTYPE_CHAIN,
 };
 
 size_t inputFramesSinceFlush = 0;
@@ -414,6 +417,14 @@ static int decode(
             params->setFloat("saturation", kSaturation);
             break;
         }
+        case FILTERTYPE_CHAIN:
+        {
+            filterState->mCodec = MediaCodec::CreateByComponentName(
+                    looper, "android.filter.chain");
+            params->setString("filters", kFilterChain);
+            params->setFloat("saturation", kSaturation);
+            break;
+        }
         case FILTERTYPE_RS_SATURATION:
         {
             SaturationRSFilter *satFilter = new SaturationRSFilter;
@@ -669,7 +680,7 @@ int main(int argc, char **argv) {
     FilterType filterType = FILTERTYPE_ZERO;
 
     int res;
-    while ((res = getopt(argc, argv, "bcnrszTRSh")) >= 0) {
+    while ((res = getopt(argc, argv, "bcfnrszTRSh")) >= 0) {
         switch (res) {
             case 'b':
             {
@@ -681,6 +692,11 @@ int main(int argc, char **argv) {
                 filterType = FILTERTYPE_RS_ARGB_TO_RGBA;
                 break;
             }
+            case 'f':
+            {
+                filterType = FILTERTYPE_CHAIN;
+                break;
+            }
             case 'n':
             {
                 filterType = FILTERTYPE_RS_NIGHT_VISION;
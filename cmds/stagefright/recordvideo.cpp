@@ -52,6 +52,7 @@ static void usage(const char *me) {
     fprintf(stderr, "       -p encoder profile. see omx il header (default: encoder specific)\n");
     fprintf(stderr, "       -v video codec: [0] AVC [1] M4V [2] H263 (default: 0)\n");
     fprintf(stderr, "       -s(oftware) prefer software codec\n");
+    fprintf(stderr, "       -m(otion) encode a moving pattern, to benchmark motion estimation\n");
     fprintf(stderr, "       -o filename: output file (default: /sdcard/output.mp4)\n");
     exit(1);
 }
@@ -59,12 +60,13 @@ static void usage(const char *me) {
 class DummySource : public MediaSource {
 
 public:
-    DummySource(int width, int height, int nFrames, int fps, int colorFormat)
+    DummySource(int width, int height, int nFrames, int fps, int colorFormat, bool moving)
         : mWidth(width),
           mHeight(height),
           mMaxNumFrames(nFrames),
           mFrameRate(fps),
           mColorFormat(colorFormat),
+          mMoving(moving),
           mSize((width * height * 3) / 2) {
 
         mGroup.add_buffer(new MediaBuffer(mSize));
@@ -113,6 +115,9 @@ public:
         memset((*buffer)->data(), x, mSize);
         x = x >= 0xa0 ? 0x60 : x + 1;
 #endif
+        if (mMoving) {
+            generateMovingFrame((uint8_t *)(*buffer)->data());
+        }
         (*buffer)->set_range(0, mSize);
         (*buffer)->meta_data()->clear();
         (*buffer)->meta_data()->setInt64(
@@ -125,12 +130,30 @@ public:
 protected:
     virtual ~DummySource() {}
 
+    // A textured pattern panning by a few pixels per frame, so that the encoder finds
+    // motion vectors, including half-pel ones, instead of skipping every macroblock.
+    void generateMovingFrame(uint8_t *data) {
+        int dx = (int)mNumFramesOutput * 3;
+        int dy = (int)mNumFramesOutput * 2;
+        for (int y = 0; y < mHeight; ++y) {
+            uint8_t *row = data + y * mWidth;
+            for (int x = 0; x < mWidth; ++x) {
+                int u = x + dx;
+                int v = y + dy;
+                row[x] = (uint8_t)(((u * 5) ^ (v * 3)) + ((u >> 3) * (v >> 3)));
+            }
+        }
+        // gray chroma, for both planar and semi planar formats
+        memset(data + mWidth * mHeight, 0x80, mSize - mWidth * mHeight);
+    }
+
 private:
     MediaBufferGroup mGroup;
     int mWidth, mHeight;
     int mMaxNumFrames;
     int mFrameRate;
     int mColorFormat;
+    bool mMoving;
     size_t mSize;
     int64_t mNumFramesOutput;;
 
@@ -176,10 +199,11 @@ int main(int argc, char **argv) {
     int codec = 0;
     const char *fileName = "/sdcard/output.mp4";
     bool preferSoftwareCodec = false;
+    bool movingFrames = false;
 
     android::ProcessState::self()->startThreadPool();
     int res;
-    while ((res = getopt(argc, argv, "b:c:f:i:n:w:t:l:p:v:o:hs")) >= 0) {
+    while ((res = getopt(argc, argv, "b:c:f:i:n:w:t:l:p:v:o:hsm")) >= 0) {
         switch (res) {
             case 'b':
             {
@@ -259,6 +283,12 @@ int main(int argc, char **argv) {
                 break;
             }
 
+            case 'm':
+            {
+                movingFrames = true;
+                break;
+            }
+
             case 'h':
             default:
             {
@@ -270,7 +300,7 @@ int main(int argc, char **argv) {
 
     status_t err = OK;
     sp<MediaSource> source =
-        new DummySource(width, height, nFrames, frameRateFps, colorFormat);
+        new DummySource(width, height, nFrames, frameRateFps, colorFormat, movingFrames);
 
     sp<AMessage> enc_meta = new AMessage;
     switch (codec) {
@@ -117,7 +117,10 @@ status_t DrmManager::loadPlugIns(const String8& plugInDirPath) {
 status_t DrmManager::unloadPlugIns() {
     Mutex::Autolock _l(mLock);
     mConvertSessionMap.clear();
-    mDecryptSessionMap.clear();
+    {
+        Mutex::Autolock _d(mDecryptLock);
+        mDecryptSessionMap.clear();
+    }
     mPlugInManager.unloadPlugIns();
     mSupportInfoToPlugInIdMap.clear();
     return DRM_NO_ERROR;
@@ -274,10 +277,12 @@ int DrmManager::checkRightsStatus(int uniqueId, const String8& path, int action)
 status_t DrmManager::consumeRights(
     int uniqueId, DecryptHandle* decryptHandle, int action, bool reserve) {
     status_t result = DRM_ERROR_UNKNOWN;
-    Mutex::Autolock _l(mDecryptLock);
-    if (mDecryptSessionMap.indexOfKey(decryptHandle->decryptId) != NAME_NOT_FOUND) {
-        IDrmEngine* drmEngine = mDecryptSessionMap.valueFor(decryptHandle->decryptId);
-        result = drmEngine->consumeRights(uniqueId, decryptHandle, action, reserve);
+    sp<DecryptSession> session = getDecryptSession(decryptHandle);
+    if (session != NULL) {
+        Mutex::Autolock _l(session->mLock);
+        if (!session->mClosed) {
+            result = session->mEngine->consumeRights(uniqueId, decryptHandle, action, reserve);
+        }
     }
     return result;
 }
@@ -285,10 +290,13 @@ status_t DrmManager::consumeRights(
 status_t DrmManager::setPlaybackStatus(
     int uniqueId, DecryptHandle* decryptHandle, int playbackStatus, int64_t position) {
     status_t result = DRM_ERROR_UNKNOWN;
-    Mutex::Autolock _l(mDecryptLock);
-    if (mDecryptSessionMap.indexOfKey(decryptHandle->decryptId) != NAME_NOT_FOUND) {
-        IDrmEngine* drmEngine = mDecryptSessionMap.valueFor(decryptHandle->decryptId);
-        result = drmEngine->setPlaybackStatus(uniqueId, decryptHandle, playbackStatus, position);
+    sp<DecryptSession> session = getDecryptSession(decryptHandle);
+    if (session != NULL) {
+        Mutex::Autolock _l(session->mLock);
+        if (!session->mClosed) {
+            result = session->mEngine->setPlaybackStatus(
+                    uniqueId, decryptHandle, playbackStatus, position);
+        }
     }
     return result;
 }
@@ -419,7 +427,7 @@ DecryptHandle* DrmManager::openDecryptSession(
 
             if (DRM_NO_ERROR == result) {
                 ++mDecryptSessionId;
-                mDecryptSessionMap.add(mDecryptSessionId, &rDrmEngine);
+                mDecryptSessionMap.add(mDecryptSessionId, new DecryptSession(&rDrmEngine));
                 break;
             }
         }
@@ -447,7 +455,7 @@ DecryptHandle* DrmManager::openDecryptSession(
 
             if (DRM_NO_ERROR == result) {
                 ++mDecryptSessionId;
-                mDecryptSessionMap.add(mDecryptSessionId, &rDrmEngine);
+                mDecryptSessionMap.add(mDecryptSessionId, new DecryptSession(&rDrmEngine));
                 break;
             }
         }
@@ -476,7 +484,7 @@ DecryptHandle* DrmManager::openDecryptSession(
 
             if (DRM_NO_ERROR == result) {
                 ++mDecryptSessionId;
-                mDecryptSessionMap.add(mDecryptSessionId, &rDrmEngine);
+                mDecryptSessionMap.add(mDecryptSessionId, new DecryptSession(&rDrmEngine));
                 break;
             }
         }
@@ -490,13 +498,18 @@ DecryptHandle* DrmManager::openDecryptSession(
 }
 
 status_t DrmManager::closeDecryptSession(int uniqueId, DecryptHandle* decryptHandle) {
-    Mutex::Autolock _l(mDecryptLock);
     status_t result = DRM_ERROR_UNKNOWN;
-    if (mDecryptSessionMap.indexOfKey(decryptHandle->decryptId) != NAME_NOT_FOUND) {
-        IDrmEngine* drmEngine = mDecryptSessionMap.valueFor(decryptHandle->decryptId);
-        result = drmEngine->closeDecryptSession(uniqueId, decryptHandle);
-        if (DRM_NO_ERROR == result) {
-            mDecryptSessionMap.removeItem(decryptHandle->decryptId);
+    sp<DecryptSession> session = getDecryptSession(decryptHandle);
+    if (session != NULL) {
+        Mutex::Autolock _l(session->mLock);
+        if (!session->mClosed) {
+            result = session->mEngine->closeDecryptSession(uniqueId, decryptHandle);
+            if (DRM_NO_ERROR == result) {
+                // calls racing with the close fail once they get the session lock
+                session->mClosed = true;
+                Mutex::Autolock _d(mDecryptLock);
+                mDecryptSessionMap.removeItem(decryptHandle->decryptId);
+            }
         }
     }
     return result;
@@ -505,10 +518,13 @@ status_t DrmManager::closeDecryptSession(int uniqueId, DecryptHandle* decryptHan
 status_t DrmManager::initializeDecryptUnit(
     int uniqueId, DecryptHandle* decryptHandle, int decryptUnitId, const DrmBuffer* headerInfo) {
     status_t result = DRM_ERROR_UNKNOWN;
-    Mutex::Autolock _l(mDecryptLock);
-    if (mDecryptSessionMap.indexOfKey(decryptHandle->decryptId) != NAME_NOT_FOUND) {
-        IDrmEngine* drmEngine = mDecryptSessionMap.valueFor(decryptHandle->decryptId);
-        result = drmEngine->initializeDecryptUnit(uniqueId, decryptHandle, decryptUnitId, headerInfo);
+    sp<DecryptSession> session = getDecryptSession(decryptHandle);
+    if (session != NULL) {
+        Mutex::Autolock _l(session->mLock);
+        if (!session->mClosed) {
+            result = session->mEngine->initializeDecryptUnit(
+                    uniqueId, decryptHandle, decryptUnitId, headerInfo);
+        }
     }
     return result;
 }
@@ -517,11 +533,13 @@ status_t DrmManager::decrypt(int uniqueId, DecryptHandle* decryptHandle, int dec
             const DrmBuffer* encBuffer, DrmBuffer** decBuffer, DrmBuffer* IV) {
     status_t result = DRM_ERROR_UNKNOWN;
 
-    Mutex::Autolock _l(mDecryptLock);
-    if (mDecryptSessionMap.indexOfKey(decryptHandle->decryptId) != NAME_NOT_FOUND) {
-        IDrmEngine* drmEngine = mDecryptSessionMap.valueFor(decryptHandle->decryptId);
-        result = drmEngine->decrypt(
-                uniqueId, decryptHandle, decryptUnitId, encBuffer, decBuffer, IV);
+    sp<DecryptSession> session = getDecryptSession(decryptHandle);
+    if (session != NULL) {
+        Mutex::Autolock _l(session->mLock);
+        if (!session->mClosed) {
+            result = session->mEngine->decrypt(
+                    uniqueId, decryptHandle, decryptUnitId, encBuffer, decBuffer, IV);
+        }
     }
     return result;
 }
@@ -529,10 +547,13 @@ status_t DrmManager::decrypt(int uniqueId, DecryptHandle* decryptHandle, int dec
 status_t DrmManager::finalizeDecryptUnit(
             int uniqueId, DecryptHandle* decryptHandle, int decryptUnitId) {
     status_t result = DRM_ERROR_UNKNOWN;
-    Mutex::Autolock _l(mDecryptLock);
-    if (mDecryptSessionMap.indexOfKey(decryptHandle->decryptId) != NAME_NOT_FOUND) {
-        IDrmEngine* drmEngine = mDecryptSessionMap.valueFor(decryptHandle->decryptId);
-        result = drmEngine->finalizeDecryptUnit(uniqueId, decryptHandle, decryptUnitId);
+    sp<DecryptSession> session = getDecryptSession(decryptHandle);
+    if (session != NULL) {
+        Mutex::Autolock _l(session->mLock);
+        if (!session->mClosed) {
+            result = session->mEngine->finalizeDecryptUnit(
+                    uniqueId, decryptHandle, decryptUnitId);
+        }
     }
     return result;
 }
@@ -541,14 +562,26 @@ ssize_t DrmManager::pread(int uniqueId, DecryptHandle* decryptHandle,
             void* buffer, ssize_t numBytes, off64_t offset) {
     ssize_t result = DECRYPT_FILE_ERROR;
 
-    Mutex::Autolock _l(mDecryptLock);
-    if (mDecryptSessionMap.indexOfKey(decryptHandle->decryptId) != NAME_NOT_FOUND) {
-        IDrmEngine* drmEngine = mDecryptSessionMap.valueFor(decryptHandle->decryptId);
-        result = drmEngine->pread(uniqueId, decryptHandle, buffer, numBytes, offset);
+    sp<DecryptSession> session = getDecryptSession(decryptHandle);
+    if (session != NULL) {
+        Mutex::Autolock _l(session->mLock);
+        if (!session->mClosed) {
+            result = session->mEngine->pread(uniqueId, decryptHandle, buffer, numBytes, offset);
+        }
     }
     return result;
 }
 
+sp<DrmManager::DecryptSession> DrmManager::getDecryptSession(
+        const DecryptHandle* decryptHandle) {
+    Mutex::Autolock _l(mDecryptLock);
+    ssize_t index = mDecryptSessionMap.indexOfKey(decryptHandle->decryptId);
+    if (index < 0) {
+        return NULL;
+    }
+    return mDecryptSessionMap.valueAt(index);
+}
+
 String8 DrmManager::getSupportedPlugInId(
             int uniqueId, const String8& path, const String8& mimeType) {
     String8 plugInId("");
@@ -141,6 +141,20 @@ private:
 
     bool canHandle(int uniqueId, const String8& path);
 
+private:
+    // An open decrypt session. Calls on one session are serialized by its own lock, so that
+    // sessions of different clients decrypt concurrently.
+    struct DecryptSession : public RefBase {
+        explicit DecryptSession(IDrmEngine* engine) : mEngine(engine), mClosed(false) {}
+
+        Mutex mLock;
+        IDrmEngine* mEngine;
+        bool mClosed;
+    };
+
+    // Returns the session of the handle, or NULL if it is not open.
+    sp<DecryptSession> getDecryptSession(const DecryptHandle* decryptHandle);
+
 private:
     enum {
         kMaxNumUniqueIds = 0x1000,
@@ -159,7 +173,8 @@ private:
     KeyedVector< DrmSupportInfo, String8 > mSupportInfoToPlugInIdMap;
     KeyedVector< int, IDrmEngine*> mConvertSessionMap;
     KeyedVector< int, sp<IDrmServiceListener> > mServiceListeners;
-    KeyedVector< int, IDrmEngine*> mDecryptSessionMap;
+    // Guarded by mDecryptLock
+    KeyedVector< int, sp<DecryptSession> > mDecryptSessionMap;
 };
 
 };
@@ -261,6 +261,42 @@ ssize_t Crypto::decrypt(
             errorDetailMsg);
 }
 
+status_t Crypto::decryptSamples(
+        DestinationType dstType,
+        CryptoPlugin::Mode mode,
+        const CryptoPlugin::Pattern &pattern,
+        const sp<IMemory> &sharedBuffer,
+        const Vector<Sample> &samples,
+        Vector<ssize_t> *results,
+        AString *errorDetailMsg) {
+    Mutex::Autolock autoLock(mLock);
+
+    results->clear();
+    if (mInitCheck != OK) {
+        return mInitCheck;
+    }
+
+    if (mPlugin == NULL || dstType == kDestinationTypeNativeHandle) {
+        return -EINVAL;
+    }
+
+    results->setCapacity(samples.size());
+    const uint8_t *base = static_cast<const uint8_t *>(sharedBuffer->pointer());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const Sample &sample = samples[i];
+        ssize_t result = mPlugin->decrypt(
+                dstType != kDestinationTypeVmPointer,
+                sample.mKey, sample.mIv, mode, pattern, base + sample.mOffset,
+                sample.mSubSamples.array(), sample.mSubSamples.size(), sample.mDstPtr,
+                errorDetailMsg);
+        results->push_back(result);
+        if (result < 0) {
+            return result;
+        }
+    }
+    return OK;
+}
+
 void Crypto::notifyResolution(uint32_t width, uint32_t height) {
     Mutex::Autolock autoLock(mLock);
 
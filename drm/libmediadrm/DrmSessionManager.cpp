@@ -92,9 +92,12 @@ void DrmSessionManager::useSession(const Vector<uint8_t> &sessionId) {
     for (size_t i = 0; i < mSessionMap.size(); ++i) {
         SessionInfos& infos = mSessionMap.editValueAt(i);
         for (size_t j = 0; j < infos.size(); ++j) {
-            SessionInfo& info = infos.editItemAt(j);
-            if (isEqualSessionId(sessionId, info.sessionId)) {
+            if (isEqualSessionId(sessionId, infos[j].sessionId)) {
+                // keep the sessions of a pid ordered from the least recently used
+                SessionInfo info = infos[j];
                 info.timeStamp = getTime_l();
+                infos.removeAt(j);
+                infos.push_back(info);
                 return;
             }
         }
@@ -178,34 +181,35 @@ int64_t DrmSessionManager::getTime_l() {
 }
 
 bool DrmSessionManager::getLowestPriority_l(int* lowestPriorityPid, int* lowestPriority) {
-    int pid = -1;
-    int priority = -1;
+    Vector<int> pids;
+    pids.setCapacity(mSessionMap.size());
     for (size_t i = 0; i < mSessionMap.size(); ++i) {
         if (mSessionMap.valueAt(i).size() == 0) {
             // no opened session by this process.
             continue;
         }
-        int tempPid = mSessionMap.keyAt(i);
-        int tempPriority;
-        if (!mProcessInfo->getPriority(tempPid, &tempPriority)) {
-            // shouldn't happen.
-            return false;
-        }
-        if (pid == -1) {
-            pid = tempPid;
-            priority = tempPriority;
-        } else {
-            if (tempPriority > priority) {
-                pid = tempPid;
-                priority = tempPriority;
-            }
-        }
+        pids.push_back(mSessionMap.keyAt(i));
+    }
+    if (pids.isEmpty()) {
+        return false;
     }
-    if (pid != -1) {
-        *lowestPriorityPid = pid;
-        *lowestPriority = priority;
+
+    // query all the pids at once, rather than one process info call per pid
+    Vector<int> priorities;
+    if (!mProcessInfo->getPriorities(pids, &priorities) || priorities.size() != pids.size()) {
+        // shouldn't happen.
+        return false;
     }
-    return (pid != -1);
+
+    size_t lowestIndex = 0;
+    for (size_t i = 1; i < pids.size(); ++i) {
+        if (priorities[i] > priorities[lowestIndex]) {
+            lowestIndex = i;
+        }
+    }
+    *lowestPriorityPid = pids[lowestIndex];
+    *lowestPriority = priorities[lowestIndex];
+    return true;
 }
 
 bool DrmSessionManager::getLeastUsedSession_l(
@@ -215,25 +219,14 @@ bool DrmSessionManager::getLeastUsedSession_l(
         return false;
     }
 
-    int leastUsedIndex = -1;
-    int64_t minTs = LLONG_MAX;
+    // the sessions are ordered from the least recently used
     const SessionInfos& infos = mSessionMap.valueAt(index);
-    for (size_t j = 0; j < infos.size(); ++j) {
-        if (leastUsedIndex == -1) {
-            leastUsedIndex = j;
-            minTs = infos[j].timeStamp;
-        } else {
-            if (infos[j].timeStamp < minTs) {
-                leastUsedIndex = j;
-                minTs = infos[j].timeStamp;
-            }
-        }
-    }
-    if (leastUsedIndex != -1) {
-        *drm = infos[leastUsedIndex].drm;
-        *sessionId = infos[leastUsedIndex].sessionId;
+    if (infos.isEmpty()) {
+        return false;
     }
-    return (leastUsedIndex != -1);
+    *drm = infos[0].drm;
+    *sessionId = infos[0].sessionId;
+    return true;
 }
 
 }  // namespace android
@@ -61,10 +61,20 @@ class CCHelper {
 
     static bool verifyClock_l();
 
+    // Returns the clock to make a call on, dropping |dead_clock| first if a call on it
+    // failed with DEAD_OBJECT.  The call itself is made without holding lock_, so that
+    // threads polling the clock do not wait on each other's binder transactions.
+    static sp<ICommonClock> getClock(const sp<ICommonClock>& dead_clock);
+
     static Mutex lock_;
     static sp<ICommonClock> common_clock_;
     static sp<ICommonClockListener> common_clock_listener_;
     static uint32_t ref_count_;
+
+    // the frequencies never change for a given service instance, cached after the
+    // first successful query and dropped when reconnecting
+    static uint64_t common_freq_;
+    static uint64_t local_freq_;
 };
 
 
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _LOG_HISTOGRAM_H
+#define _LOG_HISTOGRAM_H
+
+#include <math.h>
+#include <stdint.h>
+
+// Histogram of positive samples, with buckets whose width grows with their value:
+// each octave [minValue * 2^k, minValue * 2^(k+1)) is divided into bucketsPerOctave buckets
+// of equal width.  So a quantile is known to within 1 / bucketsPerOctave of its value,
+// in constant memory, whatever the number of samples.
+// Adding a sample costs a frexp() and an increment, so it can be done on a fast thread.
+// Histograms of the same geometry can be merged, for example those of several threads.
+// Samples below minValue, or at or above the last octave, are counted in an underflow and an
+// overflow bucket; the minimum and maximum are exact.
+// Not multithread safe
+class LogHistogram {
+
+public:
+
+    static const unsigned kMaxBuckets = 512;    // including the underflow and overflow buckets
+
+    // octaves * bucketsPerOctave + 2 must be at most kMaxBuckets, or octaves is reduced
+    LogHistogram(double minValue, unsigned octaves, unsigned bucketsPerOctave);
+
+    ~LogHistogram() { }
+
+    // add x to the set of samples
+    void sample(double x);
+
+    // add the samples of other, which must have the same geometry; returns false if not
+    bool merge(const LogHistogram& other);
+
+    // return the estimated value below which a fraction q in [0, 1] of the samples lie,
+    // or NAN if there are no samples
+    double quantile(double q) const;
+
+    // return the minimum of all samples so far
+    double minimum() const { return mMinimum; }
+
+    // return the maximum of all samples so far
+    double maximum() const { return mMaximum; }
+
+    // return the number of samples added so far
+    uint64_t n() const { return mN; }
+
+    // return the number of buckets, and the count and lower bound of a bucket
+    unsigned buckets() const { return mBuckets; }
+    uint32_t count(unsigned bucket) const { return bucket < mBuckets ? mCounts[bucket] : 0; }
+    double bucketLow(unsigned bucket) const;
+
+    // reset the set of samples to be empty
+    void reset();
+
+private:
+    const double    mMinValue;
+    const unsigned  mOctaves;
+    const unsigned  mBucketsPerOctave;
+    const unsigned  mBuckets;
+    double          mMinimum;
+    double          mMaximum;
+    uint64_t        mN;     // number of samples so far
+    uint32_t        mCounts[kMaxBuckets];   // saturate rather than wrap
+};
+
+#endif // _LOG_HISTOGRAM_H
@@ -85,6 +85,19 @@ public:
         };
     };
 
+    /* Client should declare a MappedBuffer and pass its address to obtainMappedBuffer()
+     * and releaseMappedBuffer().  The frames are read in place from the shared buffer,
+     * which they span in at most two parts: the second part is only non-empty when the frames
+     * wrap around the end of the shared buffer, and then continues from its start.
+     */
+    struct MappedBuffer {
+        size_t      frameCount;     // total number of frames, frames[0] + frames[1]
+        const void* raw[2];         // first frame of each part, NULL for an empty part
+        size_t      frames[2];      // number of frames of each part
+        int64_t     position;       // frames read before raw[0], as LOCATION_CLIENT
+        ExtendedTimestamp timestamp; // as returned by getTimestamp() after the obtain
+    };
+
     /* As a convenience, if a callback is supplied, a handler thread
      * is automatically created with the appropriate priority. This thread
      * invokes the callback when a new buffer becomes available or various conditions occur.
@@ -465,6 +478,28 @@ public:
      */
             void        releaseBuffer(const Buffer* audioBuffer);
 
+    /* Public API for TRANSFER_OBTAIN mode.
+     * Obtains up to frameCount full frames without copying them, as obtainBuffer() does with
+     * waitCount, except that the frames that wrap around the end of the shared buffer are
+     * returned as a second part rather than left to a later call.
+     * The frames remain valid until they are released with releaseMappedBuffer(),
+     * and must not be written.
+     *
+     * Returned status (from utils/Errors.h) is that of obtainBuffer().
+     * After error return, frameCount and both parts are 0.  The timestamp is
+     * left cleared if the server has not provided one yet.
+     */
+            status_t    obtainMappedBuffer(MappedBuffer* buffer, size_t frameCount,
+                                int32_t waitCount);
+
+    /* Public API for TRANSFER_OBTAIN mode.
+     * Releases the first frameCount frames of the buffer, which must be the most recent one
+     * obtained by obtainMappedBuffer(), for AudioFlinger to re-fill.
+     * frameCount is clamped to buffer->frameCount.  Frames not released remain readable
+     * by the next obtain.
+     */
+            void        releaseMappedBuffer(const MappedBuffer* buffer, size_t frameCount);
+
     /* As a convenience we provide a read() interface to the audio buffer.
      * Input parameter 'size' is in byte units.
      * This is implemented on top of obtainBuffer/releaseBuffer. For best
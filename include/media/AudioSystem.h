@@ -174,6 +174,11 @@ public:
     static status_t getFrameCountHAL(audio_io_handle_t ioHandle,
                                      size_t* frameCount);
 
+    // Hint that a track will soon be started on ioHandle, or on the primary output by default,
+    // so that the output can leave standby ahead of the first write.  See
+    // IAudioFlinger::prewarmOutput().
+    static status_t prewarmOutput(audio_io_handle_t ioHandle = AUDIO_IO_HANDLE_NONE);
+
     // Events used to synchronize actions between audio sessions.
     // For instance SYNC_EVENT_PRESENTATION_COMPLETE can be used to delay recording start until
     // playback is complete on another audio session.
@@ -30,6 +30,7 @@ namespace android {
 // ----------------------------------------------------------------------------
 
 struct audio_track_cblk_t;
+class AudioTrackCallbackPool;
 class AudioTrackClientProxy;
 class StaticAudioTrackClientProxy;
 
@@ -152,6 +153,8 @@ public:
         TRANSFER_OBTAIN,    // call obtainBuffer() and releaseBuffer()
         TRANSFER_SYNC,      // synchronous write()
         TRANSFER_SHARED,    // shared memory
+        TRANSFER_CALLBACK_POOLED, // like TRANSFER_CALLBACK, but the callback may run on a
+                            // thread shared with the other pooled tracks of the process
     };
 
     /* Constructs an uninitialized AudioTrack. No connection with
@@ -849,7 +852,9 @@ protected:
     class AudioTrackThread : public Thread
     {
     public:
-        AudioTrackThread(AudioTrack& receiver, bool bCanCallJava = false);
+        // If pool is not 0, the thread is not run, and the callbacks run on the pool instead.
+        AudioTrackThread(AudioTrack& receiver, bool bCanCallJava = false,
+                const sp<AudioTrackCallbackPool>& pool = 0);
 
         // Do not call Thread::requestExitAndWait() without first calling requestExit().
         // Thread::requestExitAndWait() is not virtual, and the implementation doesn't do enough.
@@ -863,9 +868,13 @@ protected:
                 void        pauseInternal(nsecs_t ns = 0LL);
                                         // like pause(), but only used internally within thread
 
+        // AudioTrackCallbackPool::service_t calling processAudioBuffer()
+        static  nsecs_t     servicePooled(void *cookie);
+
         friend class AudioTrack;
         virtual bool        threadLoop();
         AudioTrack&         mReceiver;
+        const sp<AudioTrackCallbackPool> mPool;
         virtual ~AudioTrackThread();
         Mutex               mMyLock;    // Thread::mLock is private
         Condition           mMyCond;    // Thread::mThreadExitedCondition is private
@@ -936,6 +945,8 @@ protected:
 
     sp<AudioTrackThread>    mAudioTrackThread;
     bool                    mThreadCanCallJava;
+    bool                    mPooledCallback;        // callbacks run on AudioTrackCallbackPool,
+                                                    // so processAudioBuffer() must not block
 
     float                   mVolume[2];
     float                   mSendLevel;
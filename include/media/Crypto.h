@@ -60,6 +60,15 @@ struct Crypto : public BnCrypto {
             void *dstPtr,
             AString *errorDetailMsg);
 
+    virtual status_t decryptSamples(
+            DestinationType dstType,
+            CryptoPlugin::Mode mode,
+            const CryptoPlugin::Pattern &pattern,
+            const sp<IMemory> &sharedBuffer,
+            const Vector<Sample> &samples,
+            Vector<ssize_t> *results,
+            AString *errorDetailMsg);
+
 private:
     mutable Mutex mLock;
 
@@ -34,11 +34,48 @@
 #include <media/IEffect.h>
 #include <media/IEffectClient.h>
 #include <utils/String8.h>
+#include <utils/Vector.h>
 
 namespace android {
 
 // ----------------------------------------------------------------------------
 
+// Mixer usage of the playback tracks belonging to one uid, summed over all playback threads.
+// Times and byte counts are cumulative since each track was created.
+struct AudioUidMixerUsage {
+    uid_t       mUid;
+    uint32_t    mTrackCount;            // tracks currently attached to a playback thread
+    int64_t     mResamplerNs;           // time spent resampling the tracks
+    int64_t     mEffectNs;              // share of the session effect chain processing time
+    int64_t     mBytesMixed;            // client bytes consumed by the mixer
+    uint32_t    mUnderruns;             // underrun occurrences
+    float       mUnderrunsPerSecond;    // underrun rate over the most recent second
+};
+
+// Parameters and results for one track of IAudioFlinger::createTracks().
+// The fields have the same meaning as the createTrack() parameters of the same name.
+struct AudioTrackCreateArgs {
+    AudioTrackCreateArgs() :
+        mStreamType(AUDIO_STREAM_DEFAULT), mSampleRate(0), mFormat(AUDIO_FORMAT_DEFAULT),
+        mChannelMask(AUDIO_CHANNEL_NONE), mFrameCount(0), mFlags(AUDIO_OUTPUT_FLAG_NONE),
+        mOutput(AUDIO_IO_HANDLE_NONE), mTid(-1), mSessionId(AUDIO_SESSION_ALLOCATE),
+        mStatus(NO_INIT), mStartStatus(NO_INIT) { }
+
+    audio_stream_type_t     mStreamType;
+    uint32_t                mSampleRate;
+    audio_format_t          mFormat;
+    audio_channel_mask_t    mChannelMask;
+    size_t                  mFrameCount;    // in/out
+    audio_output_flags_t    mFlags;         // in/out
+    sp<IMemory>             mSharedBuffer;
+    audio_io_handle_t       mOutput;
+    pid_t                   mTid;
+    audio_session_t         mSessionId;     // in/out
+    status_t                mStatus;        // out
+    sp<IAudioTrack>         mTrack;         // out, non-0 if and only if mStatus == NO_ERROR
+    status_t                mStartStatus;   // out, result of IAudioTrack::start() if requested
+};
+
 class IAudioFlinger : public IInterface
 {
 public:
@@ -245,6 +282,35 @@ public:
 
     // Returns the number of frames per audio HAL buffer.
     virtual size_t frameCountHAL(audio_io_handle_t ioHandle) const = 0;
+
+    /* List per-uid mixer usage.  On input *num_usages is the capacity of usages,
+     * on output it is the number of entries returned. */
+    virtual status_t listUidMixerUsage(unsigned int *num_usages,
+                                       struct AudioUidMixerUsage *usages) = 0;
+
+    /* Create several audio tracks for the same client pid and uid in one call.
+     * All tracks are created while holding AudioFlinger's lock once, and the control blocks
+     * and buffers are allocated from the client's single shared memory heap.
+     * If start is true, the created tracks are also started, such that all tracks on
+     * the same output begin in the same mix cycle.
+     * The result of each track is returned in args[i].mStatus and args[i].mTrack, and if start
+     * is true in args[i].mStartStatus; one failed track does not prevent the others from being
+     * created.
+     * Returns NO_ERROR if the request was processed, BAD_VALUE if args is empty or has more than
+     * kMaxCreateTracks entries, or a binder error.
+     */
+    static const size_t kMaxCreateTracks = 64;
+    virtual status_t createTracks(Vector<AudioTrackCreateArgs>& args,
+                                  pid_t pid,
+                                  int clientUid,
+                                  bool start) = 0;
+
+    /* Hint that a track is about to be started on output, or on the primary output if output is
+     * AUDIO_IO_HANDLE_NONE.  If the output is in standby, it leaves standby ahead of the track so
+     * that the first frames are not delayed by the audio HAL wake-up, and stays ready for
+     * the standby delay.  The call is asynchronous and has no effect on outputs without a mixer.
+     */
+    virtual status_t prewarmOutput(audio_io_handle_t output) = 0;
 };
 
 
@@ -17,6 +17,7 @@
 #include <binder/IInterface.h>
 #include <media/stagefright/foundation/ABase.h>
 #include <media/hardware/CryptoAPI.h>
+#include <utils/Vector.h>
 
 #ifndef ANDROID_ICRYPTO_H_
 
@@ -63,6 +64,30 @@ struct ICrypto : public IInterface {
             void *dstPtr,
             AString *errorDetailMsg) = 0;
 
+    // A sample of a batch, located in the shared buffer of the batch.
+    struct Sample {
+        uint8_t mKey[16];
+        uint8_t mIv[16];
+        size_t mOffset;
+        Vector<CryptoPlugin::SubSample> mSubSamples;
+        // The secure buffer id, or where the non-secure data is decrypted to
+        void *mDstPtr;
+    };
+
+    // Decrypts several samples sharing one buffer, mode and pattern in a single call,
+    // to a kDestinationTypeVmPointer or kDestinationTypeOpaqueHandle destination.
+    // Samples are decrypted in order, |results| gets the number of bytes decrypted for
+    // each. If a sample fails to decrypt, its error is returned and is the last entry of
+    // |results|, later samples are not decrypted. Invalid samples fail the whole batch.
+    virtual status_t decryptSamples(
+            DestinationType dstType,
+            CryptoPlugin::Mode mode,
+            const CryptoPlugin::Pattern &pattern,
+            const sp<IMemory> &sharedBuffer,
+            const Vector<Sample> &samples,
+            Vector<ssize_t> *results,
+            AString *errorDetailMsg) = 0;
+
 private:
     DISALLOW_EVIL_CONSTRUCTORS(ICrypto);
 };
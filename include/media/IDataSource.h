@@ -38,6 +38,16 @@ public:
     // the number of bytes read, or -1 on error. |size| must not be larger than
     // the buffer.
     virtual ssize_t readAt(off64_t offset, size_t size) = 0;
+    // Read the |count| ranges of |sizes[i]| bytes at |offsets[i]| back to back into the memory
+    // returned by getIMemory(), range i starting after the |sizes| of the ranges before it, and
+    // set |results[i]| to what readAt would have returned. The sizes must add up to no more
+    // than the buffer, and |count| must not be larger than kMaxReadRanges. Returns OK, or
+    // INVALID_OPERATION if the source only implements readAt.
+    enum {
+        kMaxReadRanges = 64,
+    };
+    virtual status_t readAtRanges(
+            size_t count, const off64_t *offsets, const size_t *sizes, ssize_t *results);
     // Get the size, or -1 if the size is unknown.
     virtual status_t getSize(off64_t* size) = 0;
     // This should be called before deleting |this|. The other methods may
@@ -111,6 +111,12 @@ public:
             node_id node, OMX_U32 port_index, const sp<IMemory> &params,
             buffer_id *buffer, OMX_U32 allottedSize) = 0;
 
+    // Same as useBuffer for each of |params| in turn, in a single call. Stops at the first
+    // failure; |buffers| then holds the ids of the buffers used before it.
+    virtual status_t useBuffers(
+            node_id node, OMX_U32 port_index, const Vector<sp<IMemory> > &params,
+            Vector<buffer_id> *buffers, OMX_U32 allottedSize) = 0;
+
     virtual status_t useGraphicBuffer(
             node_id node, OMX_U32 port_index,
             const sp<GraphicBuffer> &graphicBuffer, buffer_id *buffer) = 0;
@@ -193,6 +199,7 @@ public:
         INTERNAL_OPTION_TIME_LAPSE, // data is an int64_t[2]
         INTERNAL_OPTION_COLOR_ASPECTS, // data is ColorAspects
         INTERNAL_OPTION_TIME_OFFSET, // data is an int64_t
+        INTERNAL_OPTION_MAX_INPUT_LATENCY, // data is an int64_t
     };
     virtual status_t setInternalOption(
             node_id node,
@@ -29,7 +29,8 @@ public:
         kUnspecified = 0,
         kSecureCodec,
         kNonSecureCodec,
-        kGraphicMemory
+        kGraphicMemory,
+        kCodecLoad      // in macroblocks per second
     };
 
     enum SubType {
@@ -61,6 +62,7 @@ inline static const char *asString(MediaResource::Type i, const char *def = "??"
         case MediaResource::kSecureCodec:    return "secure-codec";
         case MediaResource::kNonSecureCodec: return "non-secure-codec";
         case MediaResource::kGraphicMemory:  return "graphic-memory";
+        case MediaResource::kCodecLoad:      return "codec-load";
         default:                             return def;
     }
 }
@@ -25,6 +25,7 @@ namespace android {
 
 extern const char kPolicySupportsMultipleSecureCodecs[];
 extern const char kPolicySupportsSecureWithNonSecureCodec[];
+extern const char kPolicyMaxCodecLoad[];
 
 class MediaResourcePolicy {
 public:
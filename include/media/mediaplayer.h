@@ -166,7 +166,12 @@ enum media_parameter_keys {
     KEY_PARAMETER_PLAYBACK_RATE_PERMILLE = 1300,                // set only
 
     // Set a Parcel containing the value of a parcelled Java AudioAttribute instance
-    KEY_PARAMETER_AUDIO_ATTRIBUTES = 1400                       // set only
+    KEY_PARAMETER_AUDIO_ATTRIBUTES = 1400,                      // set only
+
+    // Return a Parcel containing the playback quality histograms (A/V drift, video lateness,
+    // decode time, render jitter and rebuffering) of each second of playback since the last
+    // call. See NuPlayer::PlaybackMetrics for the layout.
+    KEY_PARAMETER_PLAYBACK_METRICS = 1500                       // get only
 };
 
 // Keep INVOKE_ID_* in sync with MediaPlayer.java.
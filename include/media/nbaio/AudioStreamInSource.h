@@ -47,6 +47,8 @@ public:
 
     virtual ssize_t read(void *buffer, size_t count);
 
+    virtual status_t getTimestamp(ExtendedTimestamp &timestamp);
+
     // NBAIO_Sink end
 
 #if 0   // until necessary
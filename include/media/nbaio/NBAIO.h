@@ -301,6 +301,11 @@ public:
     // Default implementation ignores the timestamp.
     virtual void    onTimestamp(const ExtendedTimestamp& timestamp) { }
 
+    // Returns NO_ERROR if a timestamp is available.  The timestamp includes the total number
+    // of frames captured from an external source, together with the value of CLOCK_MONOTONIC
+    // as of this capture count.  The timestamp parameter is undefined if error is returned.
+    virtual status_t getTimestamp(ExtendedTimestamp &timestamp) { return INVALID_OPERATION; }
+
 protected:
     NBAIO_Source(const NBAIO_Format& format = Format_Invalid) : NBAIO_Port(format), mFramesRead(0)
             { }
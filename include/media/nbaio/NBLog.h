@@ -20,13 +20,14 @@
 #define ANDROID_MEDIA_NBLOG_H
 
 #include <binder/IMemory.h>
+#include <utils/KeyedVector.h>
 #include <utils/Mutex.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
 #include <audio_utils/roundup.h>
 
 namespace android {
 
-class String8;
-
 class NBLog {
 
 public:
@@ -40,6 +41,8 @@ enum Event {
     EVENT_RESERVED,
     EVENT_STRING,               // ASCII string, not NUL-terminated
     EVENT_TIMESTAMP,            // clock_gettime(CLOCK_MONOTONIC)
+    EVENT_FORMAT_DEFINE,        // format ID byte, then the format string, not NUL-terminated
+    EVENT_FORMAT,               // format ID byte, then the raw arguments, see Writer::logFormat
 };
 
 // ---------------------------------------------------------------------------
@@ -120,7 +123,7 @@ public:
     Writer(size_t size, void *shared);
     Writer(size_t size, const sp<IMemory>& iMemory);
 
-    virtual ~Writer() { }
+    virtual ~Writer();
 
     virtual void    log(const char *string);
     virtual void    logf(const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
@@ -128,6 +131,14 @@ public:
     virtual void    logTimestamp();
     virtual void    logTimestamp(const struct timespec& ts);
 
+    // Like logf(), but the arguments are stored in binary and the text is only formatted
+    // by the Reader at dump time, which keeps the cost of logging low on the fast threads.
+    // Formats are identified by address, so fmt must be a string literal.
+    // Formats with conversions other than d i o u x X c s p e E f F g G a A, with the l ll z j t
+    // length modifiers, or that have * widths or too many arguments, are logged with logvf().
+    virtual void    logFormat(const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
+    virtual void    logvFormat(const char *fmt, va_list ap);
+
     virtual bool    isEnabled() const;
 
     // return value for all of these is the previous isEnabled()
@@ -138,14 +149,32 @@ public:
     sp<IMemory>     getIMemory() const  { return mIMemory; }
 
 private:
+    static const size_t kMaxFormats = 64;       // per Writer, later formats are logged as text
+    static const size_t kMaxFormatArgs = 16;
+
+    // a format of logFormat(), parsed on first use
+    struct Format {
+        const char *mFmt;                       // the ID of the format is its index
+        bool        mBinary;                    // false if the format is logged as text
+        bool        mDefined;                   // whether EVENT_FORMAT_DEFINE has been logged
+        int32_t     mDefinedAt;                 // mRear before the most recent definition
+        size_t      mArgCount;
+        uint8_t     mArgTypes[kMaxFormatArgs];
+    };
+
     void    log(Event event, const void *data, size_t length);
     void    log(const Entry *entry, bool trusted = false);
 
+    // returns the Format of fmt, or NULL if the table is full
+    Format *getFormat(const char *fmt);
+
     const size_t    mSize;      // circular buffer size in bytes, must be a power of 2
     Shared* const   mShared;    // raw pointer to shared memory
     const sp<IMemory> mIMemory; // ref-counted version
     int32_t         mRear;      // my private copy of mShared->mRear
     bool            mEnabled;   // whether to actually log
+    Format         *mFormats;   // kMaxFormats, allocated only if there is shared memory
+    size_t          mFormatCount;
 };
 
 // ---------------------------------------------------------------------------
@@ -161,6 +190,8 @@ public:
     virtual void    logvf(const char *fmt, va_list ap);
     virtual void    logTimestamp();
     virtual void    logTimestamp(const struct timespec& ts);
+    virtual void    logFormat(const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
+    virtual void    logvFormat(const char *fmt, va_list ap);
 
     virtual bool    isEnabled() const;
     virtual bool    setEnabled(bool enabled);
@@ -181,7 +212,17 @@ public:
 
     virtual ~Reader() { }
 
+    // A line of the log, as read().
+    struct Line {
+        int64_t mTimeNs;    // CLOCK_MONOTONIC of the most recent timestamp, -1 if none yet
+        String8 mText;
+    };
+
     void    dump(int fd, size_t indent = 0);
+
+    // Like dump(), but appends the new lines to lines rather than writing them.
+    void    read(Vector<Line>& lines);
+
     bool    isIMemory(const sp<IMemory>& iMemory) const;
 
 private:
@@ -191,6 +232,10 @@ private:
     int32_t     mFront;         // index of oldest acknowledged Entry
     int     mFd;                // file descriptor
     int     mIndent;            // indentation level
+    KeyedVector<uint8_t, String8> mFormats; // by ID, kept as the definitions may be in a
+                                            // previous dump
+    Vector<Line> *mLines;       // non-NULL during read()
+    int64_t mLineTimeNs;        // time of the lines being dumped, kept between dumps
 
     void    dumpLine(const String8& timestamp, String8& body);
 
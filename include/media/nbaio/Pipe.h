@@ -18,12 +18,16 @@
 #define ANDROID_AUDIO_PIPE_H
 
 #include "NBAIO.h"
+#include <media/SingleStateQueue.h>
 
 namespace android {
 
 // Pipe is multi-thread safe for readers (see PipeReader), but safe for only a single writer thread.
 // It cannot UNDERRUN on write, unless we allow designation of a master reader that provides the
 // time-base. Readers can be added and removed dynamically, and it's OK to have no readers.
+// Each reader has its own position and overrun counts, so several consumers can tap the same
+// stream without copying it.  Readers may wait for data (see PipeReader::waitAvailable()), and
+// the writer may publish the timestamps of its source to all readers (see setTimestamp()).
 class Pipe : public NBAIO_Sink {
 
     friend class PipeReader;
@@ -56,12 +60,20 @@ public:
     virtual ssize_t write(const void *buffer, size_t count);
     //virtual ssize_t writeVia(writeVia_t via, size_t total, void *user, size_t block);
 
+    // Publishes the LOCATION_KERNEL timestamp of the source of the written frames,
+    // for PipeReader::getTimestamp().  Called by the writer thread, and does not block.
+            void    setTimestamp(const ExtendedTimestamp& timestamp);
+
 private:
     const size_t    mMaxFrames;     // always a power of 2
     void * const    mBuffer;
     volatile int32_t mRear;         // written by android_atomic_release_store
     volatile int32_t mReaders;      // number of PipeReader clients currently attached to this Pipe
+    volatile int32_t mWaiters;      // number of PipeReader clients in waitAvailable(), so that
+                                    // write() only needs a futex wake if there are any
     const bool      mFreeBufferInDestructor;
+    SingleStateQueue<ExtendedTimestamp>::Shared  mTimestampShared;
+    SingleStateQueue<ExtendedTimestamp>::Mutator mTimestampMutator;
 };
 
 }   // namespace android
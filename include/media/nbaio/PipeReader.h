@@ -17,6 +17,7 @@
 #ifndef ANDROID_AUDIO_PIPE_READER_H
 #define ANDROID_AUDIO_PIPE_READER_H
 
+#include <utils/Timers.h>
 #include "Pipe.h"
 
 namespace android {
@@ -47,8 +48,16 @@ public:
 
     virtual ssize_t read(void *buffer, size_t count);
 
+    // Returns the most recent timestamp published by Pipe::setTimestamp(), or
+    // INVALID_OPERATION if there has been none since this PipeReader was created.
+    virtual status_t getTimestamp(ExtendedTimestamp& timestamp);
+
     // NBAIO_Source end
 
+    // Waits up to timeoutNs for availableToRead() to be non-zero, and returns it.
+    // Unlike read(), waitAvailable() may block, so it must not be called on a fast thread.
+            ssize_t waitAvailable(nsecs_t timeoutNs);
+
 #if 0   // until necessary
     Pipe& pipe() const { return mPipe; }
 #endif
@@ -58,6 +67,9 @@ private:
     int32_t     mFront;         // follows behind mPipe.mRear
     int64_t     mFramesOverrun;
     int64_t     mOverruns;
+    SingleStateQueue<ExtendedTimestamp>::Observer mTimestampObserver;
+    ExtendedTimestamp mTimestamp;   // most recently observed
+    bool        mHaveTimestamp;
 };
 
 }   // namespace android
@@ -217,14 +217,17 @@ private:
     // the error code or OK on success. If |fd| is negative, it returns OK
     status_t waitForFence(int fd, const char *dbg);
 
-#if TRACK_BUFFER_TIMING
+    // times input buffers were sent to the component, by presentation time, reported to
+    // MediaCodec with the output buffer of the same time
     struct BufferStats {
         int64_t mEmptyBufferTimeUs;
         int64_t mFillBufferDoneTimeUs;
     };
+    enum {
+        kMaxBufferStats = 64,  // entries never matched by an output buffer are dropped
+    };
 
     KeyedVector<int64_t, BufferStats> mBufferStats;
-#endif
 
     sp<AMessage> mNotify;
 
@@ -296,6 +299,7 @@ private:
     int64_t mRepeatFrameDelayUs;
     int64_t mMaxPtsGapUs;
     float mMaxFps;
+    int64_t mMaxInputLatencyUs;
 
     int64_t mTimePerFrameUs;
     int64_t mTimePerCaptureUs;
@@ -480,6 +484,10 @@ private:
             AudioEncoding encoding = kAudioEncodingPcm16bit);
 
     status_t setPriority(int32_t priority);
+    // Lets audio decoders put several packets of up to durationUs in each output buffer.
+    status_t setOutputBatchDuration(int32_t durationUs);
+    // Lets audio decoders output their frames as soon as decoded, e.g. for calls.
+    status_t setLowLatency(bool enable);
     status_t setOperatingRate(float rateFloat, bool isVideo);
     status_t getIntraRefreshPeriod(uint32_t *intraRefreshPeriod);
     status_t setIntraRefreshPeriod(uint32_t intraRefreshPeriod, bool inConfigure);
@@ -33,6 +33,8 @@ class AudioRecord;
 struct AudioSource : public MediaSource, public MediaBufferObserver {
     // Note that the "channels" parameter _is_ the number of channels,
     // _not_ a bitmask of audio_channels_t constants.
+    // |flags| are passed to the AudioRecord, e.g. AUDIO_INPUT_FLAG_FAST to request a
+    // low latency input. The flags are only a hint, AudioFlinger may deny them.
     AudioSource(
             audio_source_t inputSource,
             const String16 &opPackageName,
@@ -40,7 +42,8 @@ struct AudioSource : public MediaSource, public MediaBufferObserver {
             uint32_t channels,
             uint32_t outSampleRate = 0,
             uid_t uid = -1,
-            pid_t pid = -1);
+            pid_t pid = -1,
+            audio_input_flags_t flags = AUDIO_INPUT_FLAG_NONE);
 
     status_t initCheck() const;
 
@@ -71,6 +74,10 @@ private:
         // This is the initial mute duration to suppress
         // the video recording signal tone
         kAutoRampStartUs = 0,
+
+        // Returned buffers of kMaxBufferSize are kept for reuse, up to
+        // this many.
+        kMaxNumPooledBuffers = 32,
     };
 
     Mutex mLock;
@@ -92,6 +99,7 @@ private:
     int64_t mNumClientOwnedBuffers;
 
     List<MediaBuffer * > mBuffersReceived;
+    List<MediaBuffer * > mBufferPool;
 
     void trackMaxAmplitude(int16_t *data, int nSamples);
 
@@ -101,6 +109,12 @@ private:
         int32_t startFrame, int32_t rampDurationFrames,
         uint8_t *data,   size_t bytes);
 
+    // Returns a buffer with a range of |size| bytes, from the pool if possible.
+    MediaBuffer *obtainBuffer_l(size_t size);
+    // Returns |buffer| to the pool, or frees it if the pool is full.
+    void recycleBuffer_l(MediaBuffer *buffer);
+    void freeBufferPool_l();
+
     void queueInputBuffer_l(MediaBuffer *buffer, int64_t timeUs);
     void releaseQueuedFrames_l();
     void waitOutstandingEncodingFrames_l();
@@ -241,6 +241,10 @@ private:
     List<sp<IMemory> > mFramesReceived;
     List<sp<IMemory> > mFramesBeingEncoded;
     List<int64_t> mFrameTimes;
+    // When the frames in mFramesReceived were queued, and when the ones in
+    // mFramesBeingEncoded were read, in systemTime().
+    List<nsecs_t> mFrameQueueTimes;
+    List<nsecs_t> mFrameReadTimes;
 
     int64_t mFirstFrameTimeUs;
     int32_t mNumFramesDropped;
@@ -248,6 +252,15 @@ private:
     int64_t mGlitchDurationThresholdUs;
     bool mCollectStats;
 
+    // Collected if mCollectStats: how long the frames waited to be read by the
+    // encoder and how long the encoder held them, and how many frames were
+    // dropped because no memory base was free to pass them in.
+    int64_t mTotalQueueDelayUs;
+    int64_t mMaxQueueDelayUs;
+    int64_t mTotalEncodeDelayUs;
+    int64_t mMaxEncodeDelayUs;
+    int32_t mNumMemoryBaseTimeouts;
+
     // The mode video buffers are received from camera. One of VIDEO_BUFFER_MODE_*.
     int32_t mVideoBufferMode;
 
@@ -272,6 +285,8 @@ private:
     sp<BufferQueueListener> mBufferQueueListener;
 
     void releaseQueuedFrames();
+    // Queues a frame for read(). mLock must be locked.
+    void queueFrameLocked(const sp<IMemory> &data, int64_t timestampUs);
     void releaseOneRecordingFrame(const sp<IMemory>& frame);
     void createVideoBufferMemoryHeap(size_t size, uint32_t bufferCount);
 
@@ -28,11 +28,16 @@
 namespace android {
 
 struct ColorConverter {
+    // |to| is OMX_COLOR_Format16bitRGB565 or OMX_COLOR_Format32BitRGBA8888.
     ColorConverter(OMX_COLOR_FORMATTYPE from, OMX_COLOR_FORMATTYPE to);
     ~ColorConverter();
 
     bool isValid() const;
 
+    // Selects the YUV to RGB matrix from the ColorUtils::ColorStandard and
+    // ColorUtils::ColorRange of the source, BT.601 limited range by default.
+    void setSrcColorSpace(uint32_t standard, uint32_t range);
+
     status_t convert(
             const void *srcBits,
             size_t srcWidth, size_t srcHeight,
@@ -43,6 +48,21 @@ struct ColorConverter {
             size_t dstCropLeft, size_t dstCropTop,
             size_t dstCropRight, size_t dstCropBottom);
 
+    // Where the samples of the cropped source are, in any of the source formats.
+    struct YUVPlanes {
+        const uint8_t *mY, *mU, *mV;
+        size_t mYStride, mUVStride;
+        size_t mYStep, mUVStep;     // between two luma and two chroma samples of a row
+        bool mChromaSubsampledV;    // a chroma row covers two luma rows
+        size_t mChromaPhase;        // 1 if the first row is the second of its chroma row
+    };
+
+    // The YUV to RGB matrix, in 1/65536ths.
+    struct Coeffs {
+        int32_t mY, mRV, mGU, mGV, mBU;
+        int32_t mYOffset;
+    };
+
 private:
     struct BitmapParams {
         BitmapParams(
@@ -60,27 +80,21 @@ private:
     };
 
     OMX_COLOR_FORMATTYPE mSrcFormat, mDstFormat;
-    uint8_t *mClip;
-
-    uint8_t *initClip();
-
-    status_t convertCbYCrY(
-            const BitmapParams &src, const BitmapParams &dst);
-
-    status_t convertYUV420Planar(
-            const BitmapParams &src, const BitmapParams &dst);
+    uint32_t mSrcStandard, mSrcRange;
+    Coeffs mCoeffs;
 
-    status_t convertYUV420PlanarUseLibYUV(
-            const BitmapParams &src, const BitmapParams &dst);
+    bool isBT601LimitedRange() const;
 
-    status_t convertQCOMYUV420SemiPlanar(
-            const BitmapParams &src, const BitmapParams &dst);
+    status_t getPlanes(const BitmapParams &src, YUVPlanes *planes) const;
 
-    status_t convertYUV420SemiPlanar(
-            const BitmapParams &src, const BitmapParams &dst);
+    // Returns ERROR_UNSUPPORTED if libyuv has no conversion for the formats and matrix.
+    status_t convertUseLibYUV(
+            const YUVPlanes &planes, size_t width, size_t height,
+            uint8_t *dst, size_t dstStride);
 
-    status_t convertTIYUV420PackedSemiPlanar(
-            const BitmapParams &src, const BitmapParams &dst);
+    void convertYUVToRGB(
+            const YUVPlanes &planes, size_t width, size_t height,
+            uint8_t *dst, size_t dstStride);
 
     ColorConverter(const ColorConverter &);
     ColorConverter &operator=(const ColorConverter &);
@@ -65,6 +65,18 @@ public:
     // beyond, the end of the source.
     virtual ssize_t readAt(off64_t offset, void *data, size_t size) = 0;
 
+    struct ReadRange {
+        off64_t mOffset;
+        size_t mSize;
+        void *mData;
+        // set to what readAt would return for the range
+        ssize_t mResult;
+    };
+
+    // Reads each of the |count| ranges. Sources that pay for each call, like the ones backed
+    // by an IDataSource in another process, read several ranges at once.
+    virtual void readAtRanges(ReadRange *ranges, size_t count);
+
     // Convenience methods:
     bool getUInt16(off64_t offset, uint16_t *x);
     bool getUInt24(off64_t offset, uint32_t *x); // 3 byte int, returned as a 32-bit int
@@ -131,11 +143,18 @@ protected:
     virtual ~DataSource() {}
 
 private:
+    struct Sniffer {
+        SnifferFunc mFunc;
+        // the highest confidence the sniffer reports
+        float mMaxConfidence;
+    };
+
     static Mutex gSnifferMutex;
-    static List<SnifferFunc> gSniffers;
+    // by decreasing mMaxConfidence
+    static List<Sniffer> gSniffers;
     static bool gSniffersRegistered;
 
-    static void RegisterSniffer_l(SnifferFunc func);
+    static void RegisterSniffer_l(SnifferFunc func, float maxConfidence);
 
     DataSource(const DataSource &);
     DataSource &operator=(const DataSource &);
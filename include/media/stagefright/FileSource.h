@@ -57,6 +57,16 @@ private:
     Mutex mLock;
     String8 mName;
 
+    // Regular files are read through a mapping of [mOffset, mOffset + mLength), set up on the
+    // first read, so that the many small reads of the extractors are copies, not syscalls.
+    bool mMapTried;
+    void *mMapBase;
+    size_t mMapSize;
+    const uint8_t *mMapData;
+    // end of the last read, and of the range the kernel was asked to read ahead
+    int64_t mLastReadEnd;
+    int64_t mReadaheadEnd;
+
     /*for DRM*/
     sp<DecryptHandle> mDecryptHandle;
     DrmManagerClient *mDrmManagerClient;
@@ -66,6 +76,10 @@ private:
 
     ssize_t readAtDRM(off64_t offset, void *data, size_t size);
 
+    void mapFile_l();
+    void unmapFile_l();
+    void readahead_l(off64_t offset, size_t size);
+
     FileSource(const FileSource &);
     FileSource &operator=(const FileSource &);
 };
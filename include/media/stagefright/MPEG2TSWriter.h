@@ -51,6 +51,13 @@ private:
         kWhatSourceNotify = 'noti'
     };
 
+    enum {
+        kTSPacketSize = 188,
+        // The packets are written out in batches of up to this many, which is a multiple of
+        // the 7 packets carried by a datagram.
+        kMaxTSPacketsPerWrite = 7 * 50,
+    };
+
     struct SourceInfo;
 
     FILE *mFile;
@@ -72,15 +79,28 @@ private:
     int mPMTContinuityCounter;
     uint32_t mCrcTable[256];
 
+    // The program association table and program map packets are built once, only their
+    // continuity counter changes from one to the next.
+    uint8_t mPATPacket[kTSPacketSize];
+    uint8_t mPMTPacket[kTSPacketSize];
+
+    // The packets not written out yet.
+    sp<ABuffer> mOutputBuffer;
+
     void init();
 
     void writeTS();
+    void buildProgramAssociationTable();
+    void buildProgramMap();
     void writeProgramAssociationTable();
     void writeProgramMap();
     void writeAccessUnit(int32_t sourceIndex, const sp<ABuffer> &buffer);
     void initCrcTable();
     uint32_t crc32(const uint8_t *start, size_t length);
 
+    // Returns the next packet of the output buffer, for the caller to fill in.
+    uint8_t *appendTSPacket();
+    void flushTSPackets();
     ssize_t internalWrite(const void *data, size_t size);
     status_t reset();
 
@@ -23,6 +23,7 @@
 #include <media/IMediaSource.h>
 #include <media/stagefright/MediaWriter.h>
 #include <utils/List.h>
+#include <utils/Vector.h>
 #include <utils/threads.h>
 
 namespace android {
@@ -101,6 +102,23 @@ private:
     bool mAreGeoTagsAvailable;
     int32_t mStartTimeOffsetMs;
 
+    // Fragmented file authoring
+    int64_t mFragmentDurationUs;
+    bool mFragmentedMoovWritten;
+    uint32_t mFragmentSequenceNumber;
+    off64_t mMvhdDurationOffset;
+
+    // Write-behind buffer of the data not yet written to the file, which
+    // ends at mOffset, and the write latency statistics.
+    uint8_t *mWriteBuffer;
+    size_t mWriteBufferLength;
+    bool mPreallocate;
+    off64_t mPreallocatedOffset;
+    int64_t mNumFileWrites;
+    int64_t mFileWriteBytes;
+    int64_t mTotalFileWriteTimeUs;
+    int64_t mMaxFileWriteTimeUs;
+
     Mutex mLock;
 
     List<Track *> mTracks;
@@ -115,16 +133,29 @@ private:
     size_t numTracks();
     int64_t estimateMoovBoxSize(int32_t bitRate);
 
+    // A sample of a movie fragment, as described in its 'trun' box
+    struct FragmentSample {
+        uint32_t mSize;
+        uint32_t mDurationTicks;
+        int32_t  mCompositionOffsetTicks;
+        bool     mIsSync;
+    };
+
     struct Chunk {
         Track               *mTrack;        // Owner
         int64_t             mTimeStampUs;   // Timestamp of the 1st sample
         List<MediaBuffer *> mSamples;       // Sample data
 
+        // Only for a movie fragment
+        Vector<FragmentSample> mFragmentSamples;
+        int64_t             mBaseDecodeTimeTicks;
+
         // Convenient constructor
-        Chunk(): mTrack(NULL), mTimeStampUs(0) {}
+        Chunk(): mTrack(NULL), mTimeStampUs(0), mBaseDecodeTimeTicks(0) {}
 
         Chunk(Track *track, int64_t timeUs, List<MediaBuffer *> samples)
-            : mTrack(track), mTimeStampUs(timeUs), mSamples(samples) {
+            : mTrack(track), mTimeStampUs(timeUs), mSamples(samples),
+              mBaseDecodeTimeTicks(0) {
         }
 
     };
@@ -165,6 +196,10 @@ private:
     // Actually write the given chunk to the file.
     void writeChunkToFile(Chunk* chunk);
 
+    // Write the given chunk as a movie fragment, preceded by the movie
+    // header if it is the first one.
+    void writeFragmentToFile(Chunk* chunk);
+
     // Adjust other track media clock (presumably wall clock)
     // based on audio track media clock with the drift time.
     int64_t mDriftTimeUs;
@@ -185,6 +220,15 @@ private:
     void lock();
     void unlock();
 
+    // Buffered writes of the file data at mOffset, and at an offset
+    // already written, e.g. the size of a box.
+    void writeToFile(const void *data, size_t size);
+    void writeToFileAt(off64_t offset, const void *data, size_t size);
+    // Writes out the buffered data, all of it or only up to a block boundary.
+    void flushWriteBuffer(bool all);
+    void issueFileWrite(const void *data, size_t size, off64_t offset);
+    void preallocate(off64_t offset);
+
     // Acquire lock before calling these methods
     off64_t addSample_l(MediaBuffer *buffer);
     off64_t addLengthPrefixedSample_l(MediaBuffer *buffer);
@@ -194,10 +238,14 @@ private:
     bool use32BitFileOffset() const;
     bool exceedsFileDurationLimit();
     bool isFileStreamable() const;
+    bool isFragmented() const;
     void trackProgressStatus(size_t trackId, int64_t timeUs, status_t err = OK);
     void writeCompositionMatrix(int32_t degrees);
     void writeMvhdBox(int64_t durationUs);
     void writeMoovBox(int64_t durationUs);
+    void writeMvexBox();
+    void fixupFragmentedDurations(int64_t durationUs);
+    void rewriteInt32(off64_t offset, uint32_t x);
     void writeFtypBox(MetaData *param);
     void writeUdtaBox();
     void writeGeoDataBox();
@@ -18,6 +18,9 @@
 
 #define MEDIA_BUFFER_GROUP_H_
 
+#include <list>
+#include <vector>
+
 #include <media/stagefright/MediaBuffer.h>
 #include <utils/Errors.h>
 #include <utils/threads.h>
@@ -64,6 +67,25 @@ private:
     size_t mGrowthLimit;  // Do not automatically grow group larger than this.
     std::list<MediaBuffer *> mBuffers;
 
+    // Buffers whose last local reference was released, by size class: the buffers of
+    // mFreeBuffers[i] have a size of at least 2^i, and less than 2^(i + 1) except in
+    // the last class. They may still have remote references, and buffers freed
+    // otherwise (claim(), remote release) are only found by a scan of mBuffers.
+    static const size_t kNumSizeClasses = 32;
+    std::vector<MediaBuffer *> mFreeBuffers[kNumSizeClasses];
+
+    // statistics, logged when the group is destroyed
+    size_t mAcquireCount;
+    size_t mFreeListHitCount;   // acquired from mFreeBuffers, without a scan of mBuffers
+    size_t mAllocationCount;
+    size_t mWaitCount;
+    size_t mPeakBuffers;
+
+    static size_t sizeClass(size_t size);
+    void addFreeBuffer_l(MediaBuffer *buffer);
+    void removeFreeBuffer_l(MediaBuffer *buffer);
+    MediaBuffer *takeFreeBuffer_l(size_t requestedSize);
+
     MediaBufferGroup(const MediaBufferGroup &);
     MediaBufferGroup &operator=(const MediaBufferGroup &);
 };
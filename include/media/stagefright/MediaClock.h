@@ -22,6 +22,8 @@
 #include <utils/Mutex.h>
 #include <utils/RefBase.h>
 
+#include <atomic>
+
 namespace android {
 
 struct AMessage;
@@ -58,19 +60,37 @@ protected:
     virtual ~MediaClock();
 
 private:
-    status_t getMediaTime_l(
+    // A consistent copy of the clock state.
+    struct Snapshot {
+        int64_t mAnchorTimeMediaUs;
+        int64_t mAnchorTimeRealUs;
+        int64_t mMaxTimeMediaUs;
+        int64_t mStartingTimeMediaUs;
+        float mPlaybackRate;
+    };
+
+    // Readers do not take mLock, they retry until they copy the state while no
+    // writer changes it. Writers are serialized by mLock, and make mSequence
+    // odd while they change the state.
+    void readSnapshot(Snapshot *snapshot) const;
+    void beginWrite_l();
+    void endWrite_l();
+
+    static status_t getMediaTime(
+            const Snapshot &snapshot,
             int64_t realUs,
             int64_t *outMediaUs,
-            bool allowPastMaxTime) const;
+            bool allowPastMaxTime);
 
-    mutable Mutex mLock;
+    Mutex mLock;
+    std::atomic<uint32_t> mSequence;
 
-    int64_t mAnchorTimeMediaUs;
-    int64_t mAnchorTimeRealUs;
-    int64_t mMaxTimeMediaUs;
-    int64_t mStartingTimeMediaUs;
+    std::atomic<int64_t> mAnchorTimeMediaUs;
+    std::atomic<int64_t> mAnchorTimeRealUs;
+    std::atomic<int64_t> mMaxTimeMediaUs;
+    std::atomic<int64_t> mStartingTimeMediaUs;
 
-    float mPlaybackRate;
+    std::atomic<float> mPlaybackRate;
 
     DISALLOW_EVIL_CONSTRUCTORS(MediaClock);
 };
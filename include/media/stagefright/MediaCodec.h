@@ -144,6 +144,38 @@ struct MediaCodec : public AHandler {
     status_t renderOutputBufferAndRelease(size_t index);
     status_t releaseOutputBuffer(size_t index);
 
+    // A buffer of the batched calls below: the arguments of queueInputBuffer(), or
+    // the results of dequeueOutputBuffer().
+    struct BufferEntry {
+        size_t mIndex;
+        size_t mOffset;
+        size_t mSize;
+        int64_t mPresentationTimeUs;
+        uint32_t mFlags;
+    };
+
+    // Queues count input buffers in a single round trip to the looper of the codec,
+    // stopping at the first one that fails. *numQueued is set to the number queued.
+    status_t queueInputBuffers(
+            const BufferEntry *entries,
+            size_t count,
+            size_t *numQueued,
+            AString *errorDetailMsg = NULL);
+
+    // Like dequeueOutputBuffer(), but once a buffer is available, also returns those
+    // available after it, up to maxCount. *count is set to the number returned, which is
+    // 0 if an error or an INFO_ code is returned. Stops at an end of stream buffer, and
+    // before an output format or buffers change.
+    status_t dequeueOutputBuffers(
+            BufferEntry *entries,
+            size_t maxCount,
+            size_t *count,
+            int64_t timeoutUs = 0ll);
+
+    // Releases count output buffers, rendering them if render is set, in a single round
+    // trip. Stops at the first one that fails.
+    status_t releaseOutputBuffers(const size_t *indices, size_t count, bool render = false);
+
     status_t signalEndOfInputStream();
 
     status_t getOutputFormat(sp<AMessage> *format) const;
@@ -169,6 +201,13 @@ struct MediaCodec : public AHandler {
 
     status_t getName(AString *componentName) const;
 
+    // Returns the average and maximum latency of each stage of the recent buffers, from the
+    // client queueing an input buffer to the output buffer of the same presentation time being
+    // rendered: "queue-to-component", "component", "component-to-client" and
+    // "client-to-render", each as "<stage>-avg-us" and "<stage>-max-us", and the
+    // number of buffers in "<stage>-samples". Stages without samples are omitted.
+    status_t getLatencyStats(sp<AMessage> *stats) const;
+
     status_t setParameters(const sp<AMessage> &params);
 
     // Create a MediaCodec notification message from a list of rendered or dropped render infos
@@ -217,8 +256,10 @@ private:
         kWhatRelease                        = 'rele',
         kWhatDequeueInputBuffer             = 'deqI',
         kWhatQueueInputBuffer               = 'queI',
+        kWhatQueueInputBuffers              = 'qIBs',
         kWhatDequeueOutputBuffer            = 'deqO',
         kWhatReleaseOutputBuffer            = 'relO',
+        kWhatReleaseOutputBuffers           = 'rOBs',
         kWhatSignalEndOfInputStream         = 'eois',
         kWhatGetBuffers                     = 'getB',
         kWhatFlush                          = 'flus',
@@ -230,6 +271,7 @@ private:
         kWhatRequestIDRFrame                = 'ridr',
         kWhatRequestActivityNotification    = 'racN',
         kWhatGetName                        = 'getN',
+        kWhatGetLatencyStats                = 'gLat',
         kWhatSetParameters                  = 'setP',
         kWhatSetCallback                    = 'setC',
         kWhatSetNotification                = 'setN',
@@ -314,6 +356,12 @@ private:
     int32_t mVideoHeight;
     int32_t mRotationDegrees;
 
+    // decode/encode load reported to the resource manager, in macroblocks per second. It is
+    // estimated from the configured frame rate, then raised if the measured one is higher.
+    uint64_t mCodecLoad;
+    int64_t mLoadWindowStartUs;  // -1 until the first input buffer
+    int32_t mLoadWindowFrames;
+
     // initial create parameters
     AString mInitName;
     bool mInitNameIsType;
@@ -336,6 +384,23 @@ private:
 
     int32_t mDequeueOutputTimeoutGeneration;
     sp<AReplyToken> mDequeueOutputReplyID;
+    size_t mDequeueOutputMaxCount;  // of the current dequeue request
+
+    // ring of the latest buffers traced through the codec, by presentation time;
+    // times are in us, -1 if not (yet) known
+    struct LatencyTrace {
+        int64_t mTimeUs;
+        int64_t mQueuedUs;      // input queued by the client
+        int64_t mEmptiedUs;     // input sent to the component
+        int64_t mFilledUs;      // output returned by the component
+        int64_t mDequeuedUs;    // output dequeued by the client
+        int64_t mRenderedUs;    // output rendered
+    };
+    enum {
+        kMaxLatencyTraces = 64,
+    };
+    LatencyTrace mLatencyTraces[kMaxLatencyTraces];
+    size_t mNumLatencyTraces;  // ever added, since the last flush
 
     sp<ICrypto> mCrypto;
 
@@ -371,6 +436,12 @@ private:
 
     bool handleDequeueInputBuffer(const sp<AReplyToken> &replyID, bool newRequest = false);
     bool handleDequeueOutputBuffer(const sp<AReplyToken> &replyID, bool newRequest = false);
+    void getOutputBufferEntry(size_t index, BufferEntry *entry);
+
+    // Returns the trace of the latest buffer of timeUs, adding one if add is set.
+    LatencyTrace *findLatencyTrace(int64_t timeUs, bool add);
+    void onFramesRendered(const sp<AMessage> &msg);
+    sp<AMessage> computeLatencyStats() const;
     void cancelPendingDequeueOperations();
 
     void extractCSD(const sp<AMessage> &format);
@@ -394,6 +465,8 @@ private:
     bool isExecuting() const;
 
     uint64_t getGraphicBufferSize();
+    uint64_t getMacroblocksPerFrame() const;
+    void updateCodecLoad();
     void addResource(MediaResource::Type type, MediaResource::SubType subtype, uint64_t value);
 
     bool hasPendingBuffer(int portIndex);
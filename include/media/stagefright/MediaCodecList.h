@@ -146,6 +146,10 @@ private:
 
     status_t initializeCapabilities(const char *type);
 
+    // Gets the highest load measured on a hardware video codec in media_codecs_performance.xml,
+    // in macroblocks per second, or 0 if none is measured.
+    uint64_t getMeasuredCodecLoad() const;
+
     DISALLOW_EVIL_CONSTRUCTORS(MediaCodecList);
 };
 
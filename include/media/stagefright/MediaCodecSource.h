@@ -38,6 +38,9 @@ struct MediaCodecSource : public MediaSource,
     enum FlagBits {
         FLAG_USE_SURFACE_INPUT      = 1,
         FLAG_PREFER_SOFTWARE_CODEC  = 4,  // used for testing only
+        // Feeds buffers read from the source to the encoder on the thread that read them,
+        // when an encoder input buffer is available, instead of on the looper.
+        FLAG_LOW_LATENCY            = 8,
     };
 
     static sp<MediaCodecSource> Create(
@@ -97,6 +100,9 @@ private:
     status_t initEncoder();
     void releaseEncoder();
     status_t feedEncoderInputBuffers();
+    status_t feedEncoderInputBuffers_l(bool *inputError);
+    // called by the puller after it has read a buffer, in low latency mode
+    void onPullerBufferAvailable();
     void suspend();
     void resume(int64_t skipFramesBeforeUs = -1ll);
     void signalEOS(status_t err = ERROR_END_OF_STREAM);
@@ -123,6 +129,10 @@ private:
     sp<IGraphicBufferProducer> mGraphicBufferProducer;
     sp<IGraphicBufferConsumer> mGraphicBufferConsumer;
     List<MediaBuffer *> mInputBufferQueue;
+
+    // Protects the encoder input state below, and mEncoder against its release, as these are
+    // also used from the puller thread in low latency mode.
+    Mutex mFeedLock;
     List<size_t> mAvailEncoderInputIndices;
     List<int64_t> mDecodingTimeQueue; // decoding time (us) for video
     int64_t mInputBufferTimeOffsetUs;
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MEDIA_SOURCE_SPLITTER_H_
+
+#define MEDIA_SOURCE_SPLITTER_H_
+
+#include <media/stagefright/foundation/ABase.h>
+#include <media/stagefright/MediaSource.h>
+#include <utils/List.h>
+#include <utils/threads.h>
+
+namespace android {
+
+class MediaBuffer;
+
+// Feeds the output of one media source, e.g. the MediaCodecSource of an
+// encoder, to several writers, so that recording to a file and streaming
+// share a single encode.
+//
+// Each client created by createClient() reads clones of the buffers of the
+// source, which share their data, through its own queue. Whichever client
+// runs out of buffers first pulls the next one from the source, so a slow
+// client does not hold up the others: once it falls maxQueuedBuffers behind,
+// its queued buffers are dropped and it resumes at the next sync frame.
+// Codec config buffers are never dropped, and are also handed to the clients
+// started later.
+struct MediaSourceSplitter : public RefBase {
+    enum {
+        kDefaultMaxQueuedBuffers = 64,
+    };
+
+    MediaSourceSplitter(const sp<IMediaSource> &source);
+
+    // The source is started with the parameters of the first client started,
+    // and stopped with the last client.
+    sp<MediaSource> createClient(size_t maxQueuedBuffers = kDefaultMaxQueuedBuffers);
+
+protected:
+    virtual ~MediaSourceSplitter();
+
+private:
+    struct Client;
+
+    Mutex mLock;
+    Condition mCondition;
+
+    sp<IMediaSource> mSource;
+    bool mIsVideo;
+
+    bool mSourceStarted;
+    bool mReading;  // a client is reading from the source
+    status_t mFinalResult;
+    List<Client *> mClients;  // the clients started
+    List<MediaBuffer *> mCodecConfigBuffers;
+
+    status_t startClient(Client *client, MetaData *params);
+    status_t stopClient(Client *client);
+    status_t readForClient(Client *client, MediaBuffer **buffer);
+    sp<MetaData> getFormat();
+
+    void queueBuffer_l(MediaBuffer *buffer);
+    // Returns the number of buffers released.
+    static size_t flushClient_l(Client *client, bool keepCodecConfig);
+
+    DISALLOW_EVIL_CONSTRUCTORS(MediaSourceSplitter);
+};
+
+}  // namespace android
+
+#endif  // MEDIA_SOURCE_SPLITTER_H_
@@ -22,6 +22,8 @@
 
 #include <stdint.h>
 
+#include <vector>
+
 #include <binder/Parcel.h>
 #include <utils/RefBase.h>
 #include <utils/KeyedVector.h>
@@ -117,6 +119,10 @@ enum {
     kKey64BitFileOffset   = 'fobt',  // int32_t (bool)
     kKey2ByteNalLength    = '2NAL',  // int32_t (bool)
 
+    // Set this key to author a fragmented file, cutting a movie fragment
+    // about every so many microseconds
+    kKeyFragmentDurationUs = 'frdu',  // int64_t
+
     // Identify the file output format for authoring
     // Please see <media/mediarecorder.h> for the supported
     // file output formats.
@@ -280,6 +286,10 @@ private:
         typed_data(const MetaData::typed_data &);
         typed_data &operator=(const MetaData::typed_data &);
 
+        // Moving leaves from empty and does not copy its storage.
+        typed_data(MetaData::typed_data &&from) noexcept;
+        typed_data &operator=(MetaData::typed_data &&from) noexcept;
+
         void clear();
         void setData(uint32_t type, const void *data, size_t size);
         void getData(uint32_t *type, const void **data, size_t *size) const;
@@ -290,9 +300,11 @@ private:
         uint32_t mType;
         size_t mSize;
 
+        // Up to sizeof(u.reservoir) bytes, which covers all the scalar types,
+        // rects and short strings, are stored in place.
         union {
             void *ext_data;
-            float reservoir;
+            int64_t reservoir[2];
         } u;
 
         bool usesReservoir() const {
@@ -315,7 +327,20 @@ private:
         int32_t mLeft, mTop, mRight, mBottom;
     };
 
-    KeyedVector<uint32_t, typed_data> mItems;
+    struct item {
+        item() : mKey(0) {}
+
+        uint32_t mKey;
+        typed_data mData;
+    };
+
+    // Sorted by key. Items are moved, not copied, on insertion and removal, and clear()
+    // keeps the capacity for the MetaData reused by each access unit (MediaBuffer::reset()).
+    std::vector<item> mItems;
+
+    // Index of the first item whose key is not less than key.
+    size_t lowerBound(uint32_t key) const;
+    ssize_t indexOfKey(uint32_t key) const;
 
     // MetaData &operator=(const MetaData &);
 };
@@ -49,6 +49,14 @@ struct NuMediaExtractor : public RefBase {
         kIncludeExtensiveMetaData = 1, // reads sample table and possibly stream headers
     };
 
+    struct SampleInfo {
+        size_t mTrackIndex;
+        int64_t mTimeUs;
+        uint32_t mFlags;  // bitmask of "SampleFlags"
+        size_t mOffset;
+        size_t mSize;
+    };
+
     NuMediaExtractor();
 
     status_t setDataSource(
@@ -65,6 +73,11 @@ struct NuMediaExtractor : public RefBase {
 
     status_t getFileFormat(sp<AMessage> *format) const;
 
+    // Reads each track selected afterwards ahead on a thread of its own, keeping up to
+    // maxQueuedSamples of its samples in memory. 0, the default, reads the samples on the
+    // calling thread when they are needed. Fails once a track is selected.
+    status_t setPrefetching(size_t maxQueuedSamples);
+
     status_t selectTrack(size_t index);
     status_t unselectTrack(size_t index);
 
@@ -75,6 +88,11 @@ struct NuMediaExtractor : public RefBase {
 
     status_t advance();
     status_t readSampleData(const sp<ABuffer> &buffer);
+    // Reads up to maxSamples samples, in the order of readSampleData() and advance(), back to
+    // back into buffer and advances past them. Stops early at the first sample that does not
+    // fit, and returns -ENOMEM if the first one does not.
+    status_t readSampleDataBatch(
+            const sp<ABuffer> &buffer, size_t maxSamples, Vector<SampleInfo> *samples);
     status_t getSampleTrackIndex(size_t *trackIndex);
     status_t getSampleTime(int64_t *sampleTimeUs);
     status_t getSampleMeta(sp<MetaData> *sampleMeta);
@@ -93,11 +111,15 @@ private:
         kMaxTrackCount = 16384,
     };
 
+    struct TrackReader;
+
     struct TrackInfo {
         sp<IMediaSource> mSource;
+        sp<TrackReader> mReader;  // if prefetching
         size_t mTrackIndex;
         status_t mFinalResult;
         MediaBuffer *mSample;
+        sp<MetaData> mSampleMeta;
         int64_t mSampleTimeUs;
 
         uint32_t mTrackFlags;  // bitmask of "TrackFlags"
@@ -113,6 +135,7 @@ private:
     Vector<TrackInfo> mSelectedTracks;
     int64_t mTotalBitrate;  // in bits/sec
     int64_t mDurationUs;
+    size_t mMaxQueuedSamples;
 
     ssize_t fetchTrackSamples(
             int64_t seekTimeUs = -1ll,
@@ -120,10 +143,14 @@ private:
                 MediaSource::ReadOptions::SEEK_CLOSEST_SYNC);
 
     void releaseTrackSamples();
+    void releaseTrackSample(TrackInfo *info);
+    void stopTrack(TrackInfo *info);
 
     bool getTotalBitrate(int64_t *bitRate) const;
     status_t updateDurationAndBitrate();
-    status_t appendVorbisNumPageSamples(TrackInfo *info, const sp<ABuffer> &buffer);
+    status_t appendVorbisNumPageSamples(TrackInfo *info, uint8_t *sampleData);
+    status_t copySampleData(
+            TrackInfo *info, uint8_t *data, size_t capacity, size_t *sampleSize);
 
     DISALLOW_EVIL_CONSTRUCTORS(NuMediaExtractor);
 };
@@ -28,6 +28,7 @@ struct ProcessInfo : public ProcessInfoInterface {
 
     virtual bool getPriority(int pid, int* priority);
     virtual bool isValidPid(int pid);
+    virtual bool getPriorities(const Vector<int>& pids, Vector<int>* priorities);
 
 protected:
     virtual ~ProcessInfo();
@@ -18,6 +18,7 @@
 #define PROCESS_INFO_INTERFACE_H_
 
 #include <utils/RefBase.h>
+#include <utils/Vector.h>
 
 namespace android {
 
@@ -25,6 +26,20 @@ struct ProcessInfoInterface : public RefBase {
     virtual bool getPriority(int pid, int* priority) = 0;
     virtual bool isValidPid(int pid) = 0;
 
+    // Gets the priorities of several processes at once, fails if any pid fails.
+    virtual bool getPriorities(const Vector<int>& pids, Vector<int>* priorities) {
+        priorities->clear();
+        priorities->setCapacity(pids.size());
+        for (size_t i = 0; i < pids.size(); ++i) {
+            int priority;
+            if (!getPriority(pids[i], &priority)) {
+                return false;
+            }
+            priorities->push_back(priority);
+        }
+        return true;
+    }
+
 protected:
     virtual ~ProcessInfoInterface() {}
 };
@@ -19,9 +19,14 @@
 #define STAGEFRIGHT_MEDIA_SCANNER_H_
 
 #include <media/mediascanner.h>
+#include <utils/KeyedVector.h>
+#include <utils/RefBase.h>
+#include <utils/Vector.h>
 
 namespace android {
 
+class MediaMetadataRetriever;
+
 struct StagefrightMediaScanner : public MediaScanner {
     StagefrightMediaScanner();
     virtual ~StagefrightMediaScanner();
@@ -32,13 +37,52 @@ struct StagefrightMediaScanner : public MediaScanner {
 
     virtual MediaAlbumArt *extractAlbumArt(int fd);
 
+    // What tells whether a file changed since it was scanned: its size, its
+    // modification time and a hash of its first and last kFingerprintBytes.
+    struct Fingerprint {
+        int64_t mSize;
+        int64_t mModifiedTime;  // seconds
+        uint32_t mHash;
+    };
+
+    enum {
+        kFingerprintBytes = 4096,
+        kMaxNumScanThreads = 4,
+    };
+
+    static status_t GetFingerprint(const char *path, Fingerprint *fingerprint);
+
+    // Processes |paths| on up to kMaxNumScanThreads threads. The client is
+    // called on the calling thread only, for one file at a time and in the
+    // order of |paths|, as processFile() would. The files whose fingerprint in
+    // |fingerprints| did not change are skipped without calling the client,
+    // the fingerprints of the files processed are added to it. |results|, if
+    // not NULL, receives the result of each file. Returns
+    // MEDIA_SCAN_RESULT_ERROR, not processing the next files, when a file does.
+    MediaScanResult processFiles(
+            const Vector<String8> &paths, MediaScannerClient &client,
+            KeyedVector<String8, Fingerprint> *fingerprints,
+            Vector<MediaScanResult> *results);
+
 private:
+    struct FileMetadata;
+    struct Batch;
+    struct ScanWorker;
+
     StagefrightMediaScanner(const StagefrightMediaScanner &);
     StagefrightMediaScanner &operator=(const StagefrightMediaScanner &);
 
     MediaScanResult processFileInternal(
             const char *path, const char *mimeType,
             MediaScannerClient &client);
+
+    // Extracts what the client is told about the file at |path|, on any thread.
+    static void ExtractFile(
+            const char *path, sp<MediaMetadataRetriever> *retriever,
+            FileMetadata *metadata);
+
+    static MediaScanResult ReportFile(
+            const FileMetadata &metadata, MediaScannerClient &client);
 };
 
 }  // namespace android
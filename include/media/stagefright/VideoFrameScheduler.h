@@ -82,6 +82,8 @@ private:
     };
 
     void updateVsync();
+    // re-anchors the scheduling if the display timing changed from the last refresh
+    void checkVsyncChange(nsecs_t lastVsyncTime, nsecs_t lastVsyncPeriod, nsecs_t now);
 
     nsecs_t mVsyncTime;        // vsync timing from display
     nsecs_t mVsyncPeriod;
@@ -46,6 +46,11 @@ public:
     // Tries to skip |n| bits. Returns true iff successful. Skipping 0 bits will always succeed.
     bool skipBits(size_t n);
 
+    // Tries to get an unsigned Exp-Golomb code (ue(v) of H.264 and HEVC). If not successful,
+    // returns false: the stream ended, or the code is longer than 63 bits, in which case its
+    // bits are skipped. Otherwise, stores the value in |out| and returns true.
+    bool getUEGraceful(uint32_t *out);
+
     // "Puts" |n| bits with the value |x| back virtually into the bit stream. The put-back bits
     // are not actually written into the data, but are tracked in a separate buffer that can
     // store at most 32 bits. This is a no-op if the stream has already been over-read.
@@ -63,12 +68,16 @@ protected:
     const uint8_t *mData;
     size_t mSize;
 
-    uint32_t mReservoir;  // left-aligned bits
+    uint64_t mReservoir;  // left-aligned bits
     size_t mNumBitsLeft;
     bool mOverRead;
 
+    // Loads up to 64 bits into the empty reservoir.
     virtual bool fillReservoir();
 
+    // Skips |n| bytes of the data following the reservoir. Returns false if there are fewer.
+    virtual bool skipBytes(size_t n);
+
     DISALLOW_EVIL_CONSTRUCTORS(ABitReader);
 };
 
@@ -82,6 +91,11 @@ private:
     int32_t mNumZeros;
 
     virtual bool fillReservoir();
+    virtual bool skipBytes(size_t n);
+
+    // Consumes the next byte of the data, mSize being > 0. Returns false, leaving |byte|
+    // untouched, if it is an emulation_prevention_three_byte.
+    bool consumeByte(uint8_t *byte);
 
     DISALLOW_EVIL_CONSTRUCTORS(NALBitReader);
 };
@@ -44,6 +44,10 @@ struct ABuffer : public RefBase {
     // create buffer from dup of some memory block
     static sp<ABuffer> CreateAsCopy(const void *data, size_t capacity);
 
+    // create buffer referencing |size| bytes of the data of |buffer| from |offset|, without
+    // copying. |buffer| is kept alive by the slice, and writes are seen through both.
+    static sp<ABuffer> CreateAsSlice(const sp<ABuffer> &buffer, size_t offset, size_t size);
+
     void setInt32Data(int32_t data) { mInt32Data = data; }
     int32_t int32Data() const { return mInt32Data; }
 
@@ -60,6 +64,8 @@ private:
 
     MediaBufferBase *mMediaBufferBase;
 
+    sp<ABuffer> mSliceOf;  // owner of the data of a slice
+
     void *mData;
     size_t mCapacity;
     size_t mRangeOffset;
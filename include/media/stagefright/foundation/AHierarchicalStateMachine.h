@@ -19,14 +19,21 @@
 #define A_HIERARCHICAL_STATE_MACHINE_H_
 
 #include <media/stagefright/foundation/AHandler.h>
+#include <utils/threads.h>
 
 namespace android {
 
+struct AString;
+
 struct AState : public RefBase {
     AState(const sp<AState> &parentState = NULL);
 
     sp<AState> parentState();
 
+    // Name of the state in the state history and in systrace, a string literal.
+    const char *name() const;
+    void setName(const char *name);
+
 protected:
     virtual ~AState();
 
@@ -39,6 +46,7 @@ private:
     friend struct AHierarchicalStateMachine;
 
     sp<AState> mParentState;
+    const char *mName;
 
     DISALLOW_EVIL_CONSTRUCTORS(AState);
 };
@@ -46,6 +54,11 @@ private:
 struct AHierarchicalStateMachine {
     AHierarchicalStateMachine();
 
+    // Appends the last states entered, with the time spent in each and in handling
+    // their messages, and a histogram of the message handling times. May be called
+    // from any thread.
+    void dumpStateHistory(AString *out);
+
 protected:
     virtual ~AHierarchicalStateMachine();
 
@@ -55,8 +68,31 @@ protected:
     void changeState(const sp<AState> &state);
 
 private:
+    enum {
+        kNumStateRecords = 32,
+        kNumHandlingTimeBuckets = 8,
+    };
+
+    struct StateRecord {
+        const char *mName;
+        int64_t mEnteredUs;
+        int64_t mExitedUs;  // -1 for the current state
+        int64_t mHandlingUs;
+        int64_t mMaxHandlingUs;
+        uint32_t mNumMessages;
+    };
+
     sp<AState> mState;
 
+    // Ring of the last states entered, the current one being the record of
+    // transition mNumTransitions - 1.
+    Mutex mHistoryLock;
+    StateRecord mHistory[kNumStateRecords];
+    size_t mNumTransitions;
+    uint32_t mHandlingTimeHistogram[kNumHandlingTimeBuckets];
+
+    void recordMessage(size_t transition, int64_t handlingUs);
+
     DISALLOW_EVIL_CONSTRUCTORS(AHierarchicalStateMachine);
 };
 
@@ -50,6 +50,13 @@ struct ALooper : public RefBase {
             int32_t priority = PRIORITY_DEFAULT
             );
 
+    // Instead of a thread of its own, runs the handlers of the looper on a process-wide
+    // pool of worker threads, as many as there are CPUs. Messages are still delivered
+    // one at a time and in order, but not always on the same thread, and at the default
+    // priority. Workers are added while others wait in postAndAwaitResponse().
+    // Meant for loopers whose handlers do little work and are idle most of the time.
+    status_t startOnWorkerPool();
+
     status_t stop();
 
     static int64_t GetNowUs();
@@ -58,6 +65,15 @@ struct ALooper : public RefBase {
         return mName.c_str();
     }
 
+    // Messages due within slackUs after the time the looper wakes up for are delivered
+    // on that wakeup, instead of waking the looper up again. This delivers them up to
+    // slackUs early. The default of 0 delivers each message at its time.
+    void setWakeupSlackUs(int64_t slackUs);
+
+    // Appends the event queue depth and delivery latency statistics to s,
+    // and resets them if clear is set.
+    void appendStats(AString *s, bool clear);
+
 protected:
     virtual ~ALooper();
 
@@ -66,6 +82,7 @@ private:
 
     struct Event {
         int64_t mWhenUs;
+        uint64_t mSeq;  // orders the events of the same mWhenUs as they were posted
         sp<AMessage> mMessage;
     };
 
@@ -74,12 +91,43 @@ private:
 
     AString mName;
 
-    List<Event> mEventQueue;
+    // binary min-heap of the events, ordered by mWhenUs then mSeq
+    Vector<Event> mEventQueue;
+    uint64_t mNextSeq;
+
+    // whether loop() waits on mQueueChangedCondition, and until when (-1 for no timeout)
+    bool mWaiting;
+    int64_t mWaitUntilUs;
+    int64_t mWakeupSlackUs;
+
+    // statistics for ALooperRoster::dump
+    size_t mMaxQueueDepth;
+    uint64_t mPostedCount;
+    uint64_t mDeliveredCount;
+    uint64_t mWakeupCount;
+    int64_t mTotalLatencyUs;
+    int64_t mMaxLatencyUs;
 
     struct LooperThread;
     sp<LooperThread> mThread;
     bool mRunningLocally;
 
+    struct WorkerPool;
+    bool mPooled;  // started on the worker pool
+
+    // scheduling on the worker pool, protected by its lock
+    enum PoolState {
+        POOL_IDLE,      // no event queued, or not pooled
+        POOL_TIMED,     // waiting for mPoolWhenUs
+        POOL_QUEUED,    // waiting for a worker
+        POOL_RUNNING,   // delivering events on mPoolWorkerId
+    };
+    PoolState mPoolState;
+    int64_t mPoolWhenUs;
+    bool mPoolEnabled;
+    bool mPoolRecheck;  // an event was posted while running
+    android_thread_id_t mPoolWorkerId;
+
     // use a separate lock for reply handling, as it is always on another thread
     // use a central lock, however, to avoid creating a mutex for each reply
     Mutex mRepliesLock;
@@ -103,6 +151,13 @@ private:
 
     bool loop();
 
+    // Delivers the events due on a worker of the pool. Returns when the next event
+    // is due, or -1 if there is none or the looper was stopped.
+    int64_t deliverDueEvents();
+
+    void pushEvent(const Event &event);
+    void popEvent();
+
     DISALLOW_EVIL_CONSTRUCTORS(ALooper);
 };
 
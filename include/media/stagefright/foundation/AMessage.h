@@ -180,6 +180,10 @@ struct AMessage : public RefBase {
     size_t countEntries() const;
     const char *getEntryNameAt(size_t index, Type *type) const;
 
+    // AMessages are allocated from a process wide pool of freed messages
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr);
+
 protected:
     virtual ~AMessage();
 
@@ -198,6 +202,12 @@ private:
         int32_t mLeft, mTop, mRight, mBottom;
     };
 
+    enum {
+        // names and string values up to this size, including their terminating NULs,
+        // are stored in the Item instead of being allocated
+        kItemInlineSize = 24,
+    };
+
     struct Item {
         union {
             int32_t int32Value;
@@ -209,11 +219,23 @@ private:
             RefBase *refValue;
             AString *stringValue;
             Rect rectValue;
+            struct {
+                const char *mData;  // in mInline
+                size_t mLength;
+            } inlineStringValue;
         } u;
         const char *mName;
         size_t      mNameLength;
         Type mType;
+        bool mStringInline;         // a kTypeString value is in u.inlineStringValue
+        char mInline[kItemInlineSize];
+
         void setName(const char *name, size_t len);
+        void freeName();
+        // sets the value of a kTypeString item, after its name
+        void setStringValue(const char *s, size_t len);
+        const char *stringData() const;
+        size_t stringLength() const;
     };
 
     enum {
@@ -222,6 +244,20 @@ private:
     Item mItems[kMaxNumItems];
     size_t mNumItems;
 
+    enum {
+        // Messages with more than kIndexMinItems items are looked up through mIndex,
+        // an open addressed hash table of the names, which holds item index + 1 per slot,
+        // or 0 for an empty slot.
+        kIndexMinItems = 8,
+        kIndexSize = 128,   // power of 2, at least twice kMaxNumItems
+    };
+    uint8_t mIndex[kIndexSize];
+    bool mIndexed;
+
+    static uint32_t HashName(const char *name, size_t len);
+    void addToIndex(size_t i);
+    void buildIndex();
+
     Item *allocateItem(const char *name);
     void freeItemValue(Item *item);
     const Item *findItem(const char *name, Type type) const;
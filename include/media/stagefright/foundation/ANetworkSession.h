@@ -27,10 +27,13 @@
 
 namespace android {
 
+struct ABuffer;
 struct AMessage;
 
 // Helper class to manage a number of live sockets (datagram and stream-based)
 // on a single thread. Clients are notified about activity through AMessages.
+// The sockets are registered in an epoll set for the events their sessions
+// are waiting for, which is only updated when those change.
 struct ANetworkSession : public RefBase {
     ANetworkSession();
 
@@ -77,6 +80,12 @@ struct ANetworkSession : public RefBase {
             int32_t sessionID, const void *data, ssize_t size = -1,
             bool timeValid = false, int64_t timeUs = -1ll);
 
+    // Like sendRequest, but a UDP session queues |buffer| as it is, without
+    // copying it. It must not be modified until it has been sent.
+    status_t sendDatagram(
+            int32_t sessionID, const sp<ABuffer> &buffer,
+            bool timeValid = false, int64_t timeUs = -1ll);
+
     status_t switchToWebSocketMode(int32_t sessionID);
 
     enum NotificationReason {
@@ -103,6 +112,7 @@ private:
     int32_t mNextSessionID;
 
     int mPipeFd[2];
+    int mEpollFd;
 
     KeyedVector<int32_t, sp<Session> > mSessions;
 
@@ -125,6 +135,10 @@ private:
     void threadLoop();
     void interrupt();
 
+    // Registers the socket of session for the events it now waits for.
+    void updateEpollEvents_l(const sp<Session> &session);
+    void closeEpoll();
+
     static status_t MakeSocketNonBlocking(int s);
 
     DISALLOW_EVIL_CONSTRUCTORS(ANetworkSession);
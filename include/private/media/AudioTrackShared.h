@@ -24,6 +24,7 @@
 #include <utils/threads.h>
 #include <utils/Log.h>
 #include <utils/RefBase.h>
+#include <utils/Timers.h>
 #include <audio_utils/roundup.h>
 #include <media/AudioResamplerPublic.h>
 #include <media/AudioTimestamp.h>
@@ -335,10 +336,38 @@ public:
         mTimestamp.clear();
     }
 
+    // Opt-in adaptive wait for obtainBuffer() with a non-zero timeout.
+    // When enabled, obtainBuffer() polls for the server wake up for a while before falling
+    // back to the futex wait, which saves a syscall and a context switch when the server
+    // releases frames shortly after the client runs out of them, as with fast tracks.
+    // The polling time is an estimate of the time between the start of a wait and the server
+    // wake up, learnt from the previous waits, and is at most maxSpinNs.
+    // If the estimate exceeds maxSpinNs, the client does not poll until the waits get shorter.
+    // maxSpinNs 0 disables polling, which is the default.
+    void        setSpinWait(nsecs_t maxSpinNs) {
+        mMaxSpinNs = maxSpinNs > 0 ? maxSpinNs : 0;
+    }
+
+    // Number of waits of obtainBuffer() satisfied by polling, and by a futex wait.
+    void        getWaitCounts(uint32_t *spinHits, uint32_t *futexWaits) const {
+        *spinHits = mSpinHits;
+        *futexWaits = mFutexWaits;
+    }
+
 private:
+    // returns how long obtainBuffer() should poll before a futex wait
+    nsecs_t     spinBudgetNs() const;
+    // adds the duration of a wait which ended with a server wake up to mWaitEstimateNs
+    void        updateWaitEstimate(nsecs_t waitNs);
+
     // This is a copy of mCblk->mBufferSizeInFrames
     uint32_t   mBufferSizeInFrames;  // effective size of the buffer
 
+    nsecs_t     mMaxSpinNs;         // 0 if polling is disabled
+    nsecs_t     mWaitEstimateNs;    // moving average of the observed waits, 0 if none yet
+    uint32_t    mSpinHits;
+    uint32_t    mFutexWaits;
+
     Modulo<uint32_t> mEpoch;
 
     // The shared buffer contents referred to by the timestamp observer
@@ -469,6 +498,12 @@ public:
         android_atomic_release_store(rear, &mCblk->u.mStreaming.mFront);
         return (Modulo<int32_t>(rear) - front).unsignedValue();
     }
+
+    // Extends the frames of the most recent obtainBuffer(), when they end at the end of the
+    // buffers, with up to buffer->mFrameCount of the frames that follow from the start of the
+    // buffers.  A single releaseBuffer() may then release the frames of both calls.
+    // Always non-blocking.  Returns NO_ERROR, or WOULD_BLOCK if there are no such frames.
+    status_t    obtainWrapped(Buffer* buffer);
 };
 
 // ----------------------------------------------------------------------------
@@ -26,6 +26,8 @@ Mutex CCHelper::lock_;
 sp<ICommonClock> CCHelper::common_clock_;
 sp<ICommonClockListener> CCHelper::common_clock_listener_;
 uint32_t CCHelper::ref_count_ = 0;
+uint64_t CCHelper::common_freq_ = 0;
+uint64_t CCHelper::local_freq_ = 0;
 
 bool CCHelper::verifyClock_l() {
     bool ret = false;
@@ -57,6 +59,23 @@ bailout:
     return ret;
 }
 
+sp<ICommonClock> CCHelper::getClock(const sp<ICommonClock>& dead_clock) {
+    Mutex::Autolock lock(&lock_);
+
+    if (dead_clock != NULL && dead_clock == common_clock_) {
+        // the service went away, connect to its next instance
+        common_clock_listener_ = NULL;
+        common_clock_ = NULL;
+        common_freq_ = 0;
+        local_freq_ = 0;
+    }
+
+    if (!verifyClock_l())
+        return NULL;
+
+    return common_clock_;
+}
+
 CCHelper::CCHelper() {
     Mutex::Autolock lock(&lock_);
     ref_count_++;
@@ -94,16 +113,16 @@ void CCHelper::CommonClockListener::onTimelineChanged(uint64_t timelineID __unus
 // best they can.
 #define CCHELPER_METHOD(decl, call)                 \
     status_t CCHelper::decl {                       \
-        Mutex::Autolock lock(&lock_);               \
-                                                    \
-        if (!verifyClock_l())                       \
+        sp<ICommonClock> clock = getClock(NULL);    \
+        if (clock == NULL)                          \
             return DEAD_OBJECT;                     \
                                                     \
-        status_t status = common_clock_->call;      \
+        status_t status = clock->call;              \
         if (DEAD_OBJECT == status) {                \
-            if (!verifyClock_l())                   \
+            clock = getClock(clock);                \
+            if (clock == NULL)                      \
                 return DEAD_OBJECT;                 \
-            status = common_clock_->call;           \
+            status = clock->call;                   \
         }                                           \
                                                     \
         return status;                              \
@@ -111,6 +130,38 @@ void CCHelper::CommonClockListener::onTimelineChanged(uint64_t timelineID __unus
 
 #define VERIFY_CLOCK()
 
+// Same as CCHELPER_METHOD for the frequency queries, whose answer is cached in
+// |cache| after the first success.
+#define CCHELPER_FREQ_METHOD(name, cache)           \
+    status_t CCHelper::name(uint64_t* freq) {       \
+        {                                           \
+            Mutex::Autolock lock(&lock_);           \
+            if (cache != 0) {                       \
+                *freq = cache;                      \
+                return OK;                          \
+            }                                       \
+        }                                           \
+                                                    \
+        sp<ICommonClock> clock = getClock(NULL);    \
+        if (clock == NULL)                          \
+            return DEAD_OBJECT;                     \
+                                                    \
+        status_t status = clock->name(freq);        \
+        if (DEAD_OBJECT == status) {                \
+            clock = getClock(clock);                \
+            if (clock == NULL)                      \
+                return DEAD_OBJECT;                 \
+            status = clock->name(freq);             \
+        }                                           \
+                                                    \
+        if (OK == status) {                         \
+            Mutex::Autolock lock(&lock_);           \
+            if (clock == common_clock_)             \
+                cache = *freq;                      \
+        }                                           \
+        return status;                              \
+    }
+
 CCHELPER_METHOD(isCommonTimeValid(bool* valid, uint32_t* timelineID),
                 isCommonTimeValid(valid, timelineID))
 CCHELPER_METHOD(commonTimeToLocalTime(int64_t commonTime, int64_t* localTime),
@@ -119,11 +170,9 @@ CCHELPER_METHOD(localTimeToCommonTime(int64_t localTime, int64_t* commonTime),
                 localTimeToCommonTime(localTime, commonTime))
 CCHELPER_METHOD(getCommonTime(int64_t* commonTime),
                 getCommonTime(commonTime))
-CCHELPER_METHOD(getCommonFreq(uint64_t* freq),
-                getCommonFreq(freq))
+CCHELPER_FREQ_METHOD(getCommonFreq, common_freq_)
 CCHELPER_METHOD(getLocalTime(int64_t* localTime),
                 getLocalTime(localTime))
-CCHELPER_METHOD(getLocalFreq(uint64_t* freq),
-                getLocalFreq(freq))
+CCHELPER_FREQ_METHOD(getLocalFreq, local_freq_)
 
 }  // namespace android
@@ -130,35 +130,40 @@ class ANDROID_API EndianOutput : public Output {
 
 template<typename T>
 inline status_t EndianOutput::writeHelper(const T* buf, size_t offset, size_t count) {
-    assert(offset <= count);
+    // Convert into a local buffer and write it at once, rather than one element at a time
+    const size_t kChunkSize = 256;
+    T tmp[kChunkSize];
+    if (mEndian != BIG && mEndian != LITTLE) {
+        return BAD_VALUE;
+    }
     status_t res = OK;
-    size_t size = sizeof(T);
-    switch(mEndian) {
-        case BIG: {
-            for (size_t i = offset; i < count; ++i) {
-                T tmp = convertToBigEndian<T>(buf[offset + i]);
-                if ((res = mOutput->write(reinterpret_cast<uint8_t*>(&tmp), 0, size))
-                        != OK) {
-                    return res;
+    const T* src = buf + offset;
+    while (count > 0) {
+        size_t chunk = (count < kChunkSize) ? count : kChunkSize;
+        switch(mEndian) {
+            case BIG: {
+                for (size_t i = 0; i < chunk; ++i) {
+                    tmp[i] = convertToBigEndian<T>(src[i]);
                 }
-                mOffset += size;
+                break;
             }
-            break;
-        }
-        case LITTLE: {
-            for (size_t i = offset; i < count; ++i) {
-                T tmp = convertToLittleEndian<T>(buf[offset + i]);
-                if ((res = mOutput->write(reinterpret_cast<uint8_t*>(&tmp), 0, size))
-                        != OK) {
-                    return res;
+            case LITTLE: {
+                for (size_t i = 0; i < chunk; ++i) {
+                    tmp[i] = convertToLittleEndian<T>(src[i]);
                 }
-                mOffset += size;
+                break;
+            }
+            default: {
+                return BAD_VALUE;
             }
-            break;
         }
-        default: {
-            return BAD_VALUE;
+        size_t size = chunk * sizeof(T);
+        if ((res = mOutput->write(reinterpret_cast<uint8_t*>(tmp), 0, size)) != OK) {
+            return res;
         }
+        mOffset += size;
+        src += chunk;
+        count -= chunk;
     }
     return res;
 }
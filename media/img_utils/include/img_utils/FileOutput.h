@@ -35,6 +35,9 @@ class ANDROID_API FileOutput : public Output {
         virtual status_t write(const uint8_t* buf, size_t offset, size_t count);
         virtual status_t close();
     private:
+        // Size of the stdio buffer, large enough to write image strips in few calls
+        static const size_t kBufferSize = 256 * 1024;
+
         FILE *mFp;
         String8 mPath;
         bool mOpen;
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IMG_UTILS_LOSSLESS_JPEG_STRIP_SOURCE_H
+#define IMG_UTILS_LOSSLESS_JPEG_STRIP_SOURCE_H
+
+#include <img_utils/Output.h>
+#include <img_utils/StripSource.h>
+
+#include <cutils/compiler.h>
+#include <utils/Errors.h>
+#include <utils/Vector.h>
+
+#include <stdint.h>
+
+namespace android {
+namespace img_utils {
+
+/**
+ * StripSource that writes raw sensor samples as lossless JPEG strips (ITU-T T.81
+ * process 14, predictor 1), for DNG IFDs with Compression set to 7.  Each strip is a
+ * separate JPEG image, with two interleaved components for images of even width so that
+ * samples are predicted from the neighboring sample of the same color in a Bayer mosaic.
+ *
+ * The strips are compressed up front, in parallel, so that their sizes can be set with
+ * TiffWriter::addCompressedStrips before the file is written.
+ */
+class ANDROID_API LosslessJpegStripSource : public StripSource {
+    public:
+        /**
+         * The pixels buffer holds height rows of width samples, rowStride samples apart.
+         * It must stay valid until compress returns.
+         */
+        LosslessJpegStripSource(uint32_t ifd, const uint16_t* pixels, uint32_t width,
+                uint32_t height, uint32_t rowStride, uint32_t bitsPerSample);
+
+        virtual ~LosslessJpegStripSource();
+
+        /**
+         * Compress the image in strips of rowsPerStrip rows, on up to maxThreads
+         * threads.
+         *
+         * Returns OK on success, or a negative error code.
+         */
+        virtual status_t compress(uint32_t rowsPerStrip, uint32_t maxThreads);
+
+        /**
+         * Return the compressed size of each strip.  Only valid after compress.
+         */
+        virtual const Vector<uint32_t>& getStripByteCounts() const;
+
+        /**
+         * Write the compressed strips to the stream.  Count must be the total size of the
+         * strips.
+         *
+         * Returns OK on success, or a negative error code.
+         */
+        virtual status_t writeToStream(Output& stream, uint32_t count);
+
+        /**
+         * Return the source IFD.
+         */
+        virtual uint32_t getIfd() const;
+
+    private:
+        class CompressThread;
+
+        static const uint32_t kNumCategories = 17;
+
+        // Compress the rows of the given strip into a complete JPEG image.
+        status_t compressStrip(size_t strip, /*out*/Vector<uint8_t>* out) const;
+
+        // Compute the prediction difference of each sample in the row, row 0 of the
+        // strip has no row above.
+        void getRowDifferences(const uint16_t* row, const uint16_t* above,
+                /*out*/int32_t* differences) const;
+
+        // Build JPEG Huffman table code lengths and values from the category frequencies,
+        // as in ITU-T T.81 Annex K.2.
+        static void buildHuffmanTable(const uint32_t* frequencies, /*out*/uint8_t* bits,
+                /*out*/uint8_t* values, /*out*/size_t* valueCount);
+
+        uint32_t mIfd;
+        const uint16_t* mPixels;
+        uint32_t mWidth;
+        uint32_t mHeight;
+        uint32_t mRowStride;
+        uint32_t mBitsPerSample;
+        uint32_t mComponents;
+        uint32_t mRowsPerStrip;
+
+        Vector<Vector<uint8_t> > mStrips;
+        Vector<uint32_t> mStripByteCounts;
+};
+
+} /*namespace img_utils*/
+} /*namespace android*/
+
+#endif /*IMG_UTILS_LOSSLESS_JPEG_STRIP_SOURCE_H*/
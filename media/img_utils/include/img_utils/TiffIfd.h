@@ -27,6 +27,7 @@
 #include <utils/String8.h>
 #include <utils/SortedVector.h>
 #include <utils/StrongPointer.h>
+#include <utils/Vector.h>
 #include <stdint.h>
 
 namespace android {
@@ -115,6 +116,18 @@ class ANDROID_API TiffIfd : public TiffWritable {
          */
         virtual status_t validateAndSetStripTags();
 
+        /**
+         * Convenience method to set strip-related image tags for compressed strips.
+         *
+         * Like validateAndSetStripTags, but for an IFD with a Compression tag other than
+         * uncompressed. Each strip holds rowsPerStrip rows, except the last one, and
+         * byteCounts holds the compressed size of each strip.
+         *
+         * Returns OK on success, or a negative error code.
+         */
+        virtual status_t setCompressedStripTags(uint32_t rowsPerStrip,
+                const Vector<uint32_t>& byteCounts);
+
         /**
          * Returns true if validateAndSetStripTags has been called, but not setStripOffsets.
          */
@@ -154,6 +167,10 @@ class ANDROID_API TiffIfd : public TiffWritable {
 
     protected:
         virtual uint32_t checkAndGetOffset(uint32_t offset) const;
+
+        // Add the RowsPerStrip, StripByteCounts and uninitialized StripOffsets tags
+        status_t addStripTags(uint32_t stripRows, const Vector<uint32_t>& byteCounts);
+
         SortedEntryVector mEntries;
         sp<TiffIfd> mNextIfd;
         uint32_t mIfdId;
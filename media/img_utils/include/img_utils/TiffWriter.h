@@ -175,6 +175,19 @@ class ANDROID_API TiffWriter : public LightRefBase<TiffWriter> {
          */
         virtual status_t addStrip(uint32_t ifd);
 
+        /**
+         * Convenience function to set the strip related tags for a given IFD holding
+         * compressed strips, such as the ones from LosslessJpegStripSource.
+         *
+         * The following tags must be set before calling this method:
+         * - ImageLength
+         * - Compression
+         *
+         * Returns OK on success, or a negative error code.
+         */
+        virtual status_t addCompressedStrips(uint32_t ifd, uint32_t rowsPerStrip,
+                const Vector<uint32_t>& byteCounts);
+
         /**
          * Return the TIFF entry with the given tag ID in the IFD with the given ID,
          * or an empty pointer if none exists.
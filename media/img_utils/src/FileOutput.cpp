@@ -40,6 +40,9 @@ status_t FileOutput::open() {
         ALOGE("%s: Could not open file %s", __FUNCTION__, mPath.string());
         return BAD_VALUE;
     }
+    if (::setvbuf(mFp, NULL, _IOFBF, kBufferSize) != 0) {
+        ALOGW("%s: Could not set the buffer size for file %s", __FUNCTION__, mPath.string());
+    }
     mOpen = true;
     return OK;
 }
@@ -0,0 +1,458 @@
+/*
+ * Copyright 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <img_utils/LosslessJpegStripSource.h>
+
+#include <utils/Log.h>
+#include <utils/StrongPointer.h>
+#include <utils/Thread.h>
+
+#include <string.h>
+
+namespace android {
+namespace img_utils {
+
+namespace {
+
+// JPEG markers
+const uint8_t kMarkerSoi = 0xD8;
+const uint8_t kMarkerEoi = 0xD9;
+const uint8_t kMarkerSof3 = 0xC3;
+const uint8_t kMarkerDht = 0xC4;
+const uint8_t kMarkerSos = 0xDA;
+
+// Predictor 1, the sample to the left
+const uint8_t kPredictor = 1;
+
+// Worst case size of the markers and tables of a strip
+const size_t kMaxHeaderSize = 128;
+
+// Worst case size of a sample: a 16 bit code and 16 extra bits, doubled by byte stuffing
+const size_t kMaxSampleSize = 8;
+
+// Bit writer for entropy coded data, with 0xFF bytes stuffed with 0x00.
+class BitWriter {
+    public:
+        explicit BitWriter(uint8_t* out) : mOut(out), mBits(0), mBitCount(0) {}
+
+        // Append the low count bits of value, count must be 16 or less.
+        inline void putBits(uint32_t value, uint32_t count) {
+            mBits = (mBits << count) | (value & ((1 << count) - 1));
+            mBitCount += count;
+            while (mBitCount >= 8) {
+                mBitCount -= 8;
+                uint8_t byte = static_cast<uint8_t>(mBits >> mBitCount);
+                *mOut++ = byte;
+                if (byte == 0xFF) {
+                    *mOut++ = 0;
+                }
+            }
+        }
+
+        // Pad the last byte with 1 bits, and return the end of the data.
+        uint8_t* flush() {
+            if (mBitCount > 0) {
+                putBits(0xFF, 8 - mBitCount);
+            }
+            return mOut;
+        }
+
+    private:
+        uint8_t* mOut;
+        uint32_t mBits;
+        uint32_t mBitCount;
+};
+
+inline uint8_t* putMarker(uint8_t* out, uint8_t marker) {
+    *out++ = 0xFF;
+    *out++ = marker;
+    return out;
+}
+
+inline uint8_t* putShort(uint8_t* out, uint32_t value) {
+    *out++ = static_cast<uint8_t>(value >> 8);
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+// Return the category of a difference, the number of extra bits coding it. A difference
+// of -32768 has category 16 and no extra bits.
+inline uint32_t getCategory(int32_t difference) {
+    uint32_t magnitude = (difference < 0) ? -difference : difference;
+    return (magnitude == 0) ? 0 : 32 - __builtin_clz(magnitude);
+}
+
+} /*anonymous namespace*/
+
+/**
+ * Worker compressing every step-th strip, from the first.
+ */
+class LosslessJpegStripSource::CompressThread : public Thread {
+    public:
+        CompressThread(const LosslessJpegStripSource* parent, Vector<uint8_t>* strips,
+                size_t stripCount, size_t first, size_t step) : Thread(/*canCallJava*/false),
+                mParent(parent), mStrips(strips), mStripCount(stripCount), mFirst(first),
+                mStep(step), mResult(OK) {}
+
+        virtual ~CompressThread() {}
+
+        status_t compressStrips() {
+            for (size_t i = mFirst; i < mStripCount; i += mStep) {
+                mResult = mParent->compressStrip(i, &mStrips[i]);
+                if (mResult != OK) {
+                    break;
+                }
+            }
+            return mResult;
+        }
+
+        status_t getResult() const {
+            return mResult;
+        }
+
+    private:
+        virtual bool threadLoop() {
+            compressStrips();
+            return false;
+        }
+
+        const LosslessJpegStripSource* mParent;
+        Vector<uint8_t>* mStrips;
+        size_t mStripCount;
+        size_t mFirst;
+        size_t mStep;
+        status_t mResult;
+};
+
+LosslessJpegStripSource::LosslessJpegStripSource(uint32_t ifd, const uint16_t* pixels,
+        uint32_t width, uint32_t height, uint32_t rowStride, uint32_t bitsPerSample) :
+        mIfd(ifd), mPixels(pixels), mWidth(width), mHeight(height), mRowStride(rowStride),
+        mBitsPerSample(bitsPerSample), mComponents((width % 2 == 0) ? 2 : 1),
+        mRowsPerStrip(0) {}
+
+LosslessJpegStripSource::~LosslessJpegStripSource() {}
+
+status_t LosslessJpegStripSource::compress(uint32_t rowsPerStrip, uint32_t maxThreads) {
+    if (mPixels == NULL || mWidth == 0 || mHeight == 0 || mRowStride < mWidth) {
+        ALOGE("%s: Invalid image %ux%u, row stride %u.", __FUNCTION__, mWidth, mHeight,
+                mRowStride);
+        return BAD_VALUE;
+    }
+    if (mBitsPerSample < 2 || mBitsPerSample > 16) {
+        ALOGE("%s: Invalid bits per sample %u.", __FUNCTION__, mBitsPerSample);
+        return BAD_VALUE;
+    }
+    if (rowsPerStrip == 0 || rowsPerStrip > UINT16_MAX || mWidth / mComponents > UINT16_MAX) {
+        ALOGE("%s: Strips of %u rows of %u samples exceed the JPEG image size.",
+                __FUNCTION__, rowsPerStrip, mWidth);
+        return BAD_VALUE;
+    }
+
+    mRowsPerStrip = rowsPerStrip;
+    size_t stripCount = (mHeight + rowsPerStrip - 1) / rowsPerStrip;
+    mStrips.clear();
+    mStripByteCounts.clear();
+    mStrips.insertAt(0, stripCount);
+
+    size_t threadCount = (maxThreads == 0) ? 1 : maxThreads;
+    if (threadCount > stripCount) {
+        threadCount = stripCount;
+    }
+
+    // Each worker writes only its own strips, the caller compresses the first share
+    Vector<uint8_t>* strips = mStrips.editArray();
+    Vector<sp<CompressThread> > workers;
+    workers.setCapacity(threadCount - 1);
+    for (size_t i = 1; i < threadCount; ++i) {
+        sp<CompressThread> worker = new CompressThread(this, strips, stripCount, i,
+                threadCount);
+        if (worker->run("LosslessJpegCompress") != OK) {
+            ALOGW("%s: Could not start compression thread %zu, compressing inline.",
+                    __FUNCTION__, i);
+            worker->compressStrips();
+        }
+        workers.push_back(worker);
+    }
+
+    sp<CompressThread> inlineWorker = new CompressThread(this, strips, stripCount, 0,
+            threadCount);
+    status_t res = inlineWorker->compressStrips();
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->join();
+        if (res == OK) {
+            res = workers[i]->getResult();
+        }
+    }
+    if (res != OK) {
+        ALOGE("%s: Failed to compress strips: %s (%d).", __FUNCTION__, strerror(-res), res);
+        mStrips.clear();
+        return res;
+    }
+
+    mStripByteCounts.setCapacity(stripCount);
+    for (size_t i = 0; i < stripCount; ++i) {
+        mStripByteCounts.push_back(static_cast<uint32_t>(mStrips[i].size()));
+    }
+    return OK;
+}
+
+const Vector<uint32_t>& LosslessJpegStripSource::getStripByteCounts() const {
+    return mStripByteCounts;
+}
+
+status_t LosslessJpegStripSource::writeToStream(Output& stream, uint32_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < mStrips.size(); ++i) {
+        total += mStrips[i].size();
+    }
+    if (mStrips.isEmpty() || total != count) {
+        ALOGE("%s: Requested %u bytes, %zu compressed bytes available.", __FUNCTION__, count,
+                total);
+        return BAD_VALUE;
+    }
+
+    status_t res = OK;
+    for (size_t i = 0; i < mStrips.size(); ++i) {
+        if ((res = stream.write(mStrips[i].array(), 0, mStrips[i].size())) != OK) {
+            ALOGE("%s: Failed to write strip %zu.", __FUNCTION__, i);
+            return res;
+        }
+    }
+    return OK;
+}
+
+uint32_t LosslessJpegStripSource::getIfd() const {
+    return mIfd;
+}
+
+void LosslessJpegStripSource::getRowDifferences(const uint16_t* row, const uint16_t* above,
+        /*out*/int32_t* differences) const {
+    uint32_t components = mComponents;
+    for (uint32_t i = 0; i < mWidth; ++i) {
+        int32_t prediction;
+        if (i >= components) {
+            prediction = row[i - components];
+        } else if (above != NULL) {
+            prediction = above[i];
+        } else {
+            prediction = 1 << (mBitsPerSample - 1);
+        }
+        // Differences are taken modulo 2^16
+        int32_t difference = (row[i] - prediction) & 0xFFFF;
+        differences[i] = (difference >= 0x8000) ? difference - 0x10000 : difference;
+    }
+}
+
+void LosslessJpegStripSource::buildHuffmanTable(const uint32_t* frequencies,
+        /*out*/uint8_t* bits, /*out*/uint8_t* values, /*out*/size_t* valueCount) {
+    // One reserved symbol guarantees that no code is all 1 bits
+    const size_t symbolCount = kNumCategories + 1;
+    const size_t maxCodeSize = 32;
+    uint32_t freq[symbolCount];
+    uint32_t codeSize[symbolCount];
+    int32_t others[symbolCount];
+    for (size_t i = 0; i < kNumCategories; ++i) {
+        freq[i] = frequencies[i];
+    }
+    freq[kNumCategories] = 1;
+    for (size_t i = 0; i < symbolCount; ++i) {
+        codeSize[i] = 0;
+        others[i] = -1;
+    }
+
+    // Merge the two least frequent trees until one is left
+    while (true) {
+        int32_t v1 = -1;
+        int32_t v2 = -1;
+        for (size_t i = 0; i < symbolCount; ++i) {
+            if (freq[i] == 0) {
+                continue;
+            }
+            if (v1 < 0 || freq[i] <= freq[v1]) {
+                v2 = v1;
+                v1 = i;
+            } else if (v2 < 0 || freq[i] <= freq[v2]) {
+                v2 = i;
+            }
+        }
+        if (v2 < 0) {
+            break;
+        }
+
+        freq[v1] += freq[v2];
+        freq[v2] = 0;
+        codeSize[v1]++;
+        while (others[v1] >= 0) {
+            v1 = others[v1];
+            codeSize[v1]++;
+        }
+        others[v1] = v2;
+        codeSize[v2]++;
+        while (others[v2] >= 0) {
+            v2 = others[v2];
+            codeSize[v2]++;
+        }
+    }
+
+    uint32_t codeCounts[maxCodeSize + 1];
+    memset(codeCounts, 0, sizeof(codeCounts));
+    for (size_t i = 0; i < symbolCount; ++i) {
+        if (codeSize[i] > 0) {
+            codeCounts[codeSize[i]]++;
+        }
+    }
+
+    // Limit the codes to 16 bits
+    for (size_t i = maxCodeSize; i > 16; --i) {
+        while (codeCounts[i] > 0) {
+            size_t j = i - 2;
+            while (codeCounts[j] == 0) {
+                --j;
+            }
+            codeCounts[i] -= 2;
+            codeCounts[i - 1]++;
+            codeCounts[j + 1] += 2;
+            codeCounts[j]--;
+        }
+    }
+
+    // Drop the reserved symbol, which has the longest code
+    size_t longest = 16;
+    while (codeCounts[longest] == 0) {
+        --longest;
+    }
+    codeCounts[longest]--;
+
+    for (size_t i = 1; i <= 16; ++i) {
+        bits[i - 1] = static_cast<uint8_t>(codeCounts[i]);
+    }
+    size_t count = 0;
+    for (size_t size = 1; size <= maxCodeSize; ++size) {
+        for (size_t i = 0; i < kNumCategories; ++i) {
+            if (codeSize[i] == size) {
+                values[count++] = static_cast<uint8_t>(i);
+            }
+        }
+    }
+    *valueCount = count;
+}
+
+status_t LosslessJpegStripSource::compressStrip(size_t strip,
+        /*out*/Vector<uint8_t>* out) const {
+    uint32_t firstRow = strip * mRowsPerStrip;
+    uint32_t rowCount = mHeight - firstRow;
+    if (rowCount > mRowsPerStrip) {
+        rowCount = mRowsPerStrip;
+    }
+
+    Vector<int32_t> differences;
+    if (differences.resize(static_cast<size_t>(mWidth) * rowCount) < 0) {
+        return NO_MEMORY;
+    }
+    int32_t* diffs = differences.editArray();
+
+    // First pass, predict and gather the category frequencies
+    uint32_t frequencies[kNumCategories];
+    memset(frequencies, 0, sizeof(frequencies));
+    for (uint32_t y = 0; y < rowCount; ++y) {
+        const uint16_t* row = mPixels + static_cast<size_t>(firstRow + y) * mRowStride;
+        const uint16_t* above = (y == 0) ? NULL : row - mRowStride;
+        int32_t* rowDiffs = diffs + static_cast<size_t>(y) * mWidth;
+        getRowDifferences(row, above, rowDiffs);
+        for (uint32_t x = 0; x < mWidth; ++x) {
+            frequencies[getCategory(rowDiffs[x])]++;
+        }
+    }
+
+    uint8_t bits[16];
+    uint8_t values[kNumCategories];
+    size_t valueCount = 0;
+    buildHuffmanTable(frequencies, bits, values, &valueCount);
+
+    uint16_t codes[kNumCategories];
+    uint8_t codeSizes[kNumCategories];
+    memset(codeSizes, 0, sizeof(codeSizes));
+    uint32_t code = 0;
+    size_t k = 0;
+    for (size_t size = 1; size <= 16; ++size) {
+        for (size_t n = 0; n < bits[size - 1]; ++n, ++k) {
+            codes[values[k]] = static_cast<uint16_t>(code++);
+            codeSizes[values[k]] = static_cast<uint8_t>(size);
+        }
+        code <<= 1;
+    }
+
+    size_t maxSize = kMaxHeaderSize + kMaxSampleSize * mWidth * rowCount;
+    if (out->resize(maxSize) < 0) {
+        return NO_MEMORY;
+    }
+    uint8_t* begin = out->editArray();
+    uint8_t* p = begin;
+
+    p = putMarker(p, kMarkerSoi);
+
+    p = putMarker(p, kMarkerDht);
+    p = putShort(p, 2 + 1 + 16 + valueCount);
+    *p++ = 0; // DC table 0
+    memcpy(p, bits, sizeof(bits));
+    p += sizeof(bits);
+    memcpy(p, values, valueCount);
+    p += valueCount;
+
+    p = putMarker(p, kMarkerSof3);
+    p = putShort(p, 8 + 3 * mComponents);
+    *p++ = static_cast<uint8_t>(mBitsPerSample);
+    p = putShort(p, rowCount);
+    p = putShort(p, mWidth / mComponents);
+    *p++ = static_cast<uint8_t>(mComponents);
+    for (uint32_t c = 0; c < mComponents; ++c) {
+        *p++ = static_cast<uint8_t>(c);
+        *p++ = 0x11; // No subsampling
+        *p++ = 0; // No quantization table
+    }
+
+    p = putMarker(p, kMarkerSos);
+    p = putShort(p, 6 + 2 * mComponents);
+    *p++ = static_cast<uint8_t>(mComponents);
+    for (uint32_t c = 0; c < mComponents; ++c) {
+        *p++ = static_cast<uint8_t>(c);
+        *p++ = 0; // Huffman table 0
+    }
+    *p++ = kPredictor;
+    *p++ = 0; // Se
+    *p++ = 0; // No point transform
+
+    // Second pass, the components are interleaved in sample order
+    BitWriter writer(p);
+    size_t sampleCount = differences.size();
+    for (size_t i = 0; i < sampleCount; ++i) {
+        int32_t difference = diffs[i];
+        uint32_t category = getCategory(difference);
+        writer.putBits(codes[category], codeSizes[category]);
+        if (category > 0 && category < 16) {
+            writer.putBits((difference < 0) ? difference - 1 : difference, category);
+        }
+    }
+    p = writer.flush();
+
+    p = putMarker(p, kMarkerEoi);
+
+    out->resize(p - begin);
+    return OK;
+}
+
+} /*namespace img_utils*/
+} /*namespace android*/
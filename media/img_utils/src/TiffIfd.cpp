@@ -229,16 +229,6 @@ status_t TiffIfd::validateAndSetStripTags() {
         numStrips += 1;
     }
 
-    // Put each row in it's own strip
-    uint32_t rowsPerStripVal = rowsPerChunk;
-    sp<TiffEntry> rowsPerStrip = TiffWriter::uncheckedBuildEntry(TAG_ROWSPERSTRIP, LONG, 1,
-            UNDEFINED_ENDIAN, &rowsPerStripVal);
-
-    if (rowsPerStrip == NULL) {
-        ALOGE("%s: Could not build entry for RowsPerStrip tag.", __FUNCTION__);
-        return BAD_VALUE;
-    }
-
     Vector<uint32_t> byteCounts;
 
     for (size_t i = 0; i < numStrips; ++i) {
@@ -249,6 +239,46 @@ status_t TiffIfd::validateAndSetStripTags() {
         }
     }
 
+    return addStripTags(rowsPerChunk, byteCounts);
+}
+
+status_t TiffIfd::setCompressedStripTags(uint32_t rowsPerStrip,
+        const Vector<uint32_t>& byteCounts) {
+    sp<TiffEntry> compressionEntry = getEntry(TAG_COMPRESSION);
+    if (compressionEntry == NULL || *(compressionEntry->getData<uint16_t>()) == 1) {
+        ALOGE("%s: IFD %u doesn't have a Compression tag set", __FUNCTION__, mIfdId);
+        return BAD_VALUE;
+    }
+
+    sp<TiffEntry> heightEntry = getEntry(TAG_IMAGELENGTH);
+    if (heightEntry == NULL) {
+        ALOGE("%s: IFD %u doesn't have a ImageLength tag set", __FUNCTION__, mIfdId);
+        return BAD_VALUE;
+    }
+
+    uint32_t height = *(heightEntry->getData<uint32_t>());
+    if (rowsPerStrip == 0 ||
+            byteCounts.size() != (height + rowsPerStrip - 1) / rowsPerStrip) {
+        ALOGE("%s: %zu strips of %u rows don't match the height %u in IFD %u", __FUNCTION__,
+                byteCounts.size(), rowsPerStrip, height, mIfdId);
+        return BAD_VALUE;
+    }
+
+    return addStripTags(rowsPerStrip, byteCounts);
+}
+
+status_t TiffIfd::addStripTags(uint32_t stripRows, const Vector<uint32_t>& byteCounts) {
+    size_t numStrips = byteCounts.size();
+
+    uint32_t rowsPerStripVal = stripRows;
+    sp<TiffEntry> rowsPerStrip = TiffWriter::uncheckedBuildEntry(TAG_ROWSPERSTRIP, LONG, 1,
+            UNDEFINED_ENDIAN, &rowsPerStripVal);
+
+    if (rowsPerStrip == NULL) {
+        ALOGE("%s: Could not build entry for RowsPerStrip tag.", __FUNCTION__);
+        return BAD_VALUE;
+    }
+
     // Set byte counts for each strip
     sp<TiffEntry> stripByteCounts = TiffWriter::uncheckedBuildEntry(TAG_STRIPBYTECOUNTS, LONG,
             static_cast<uint32_t>(numStrips), UNDEFINED_ENDIAN, byteCounts.array());
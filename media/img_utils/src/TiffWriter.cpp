@@ -110,7 +110,7 @@ status_t TiffWriter::write(Output* out, StripSource** sources, size_t sourcesCou
         bool found = false;
         for (size_t j = 0; j < sourcesCount; ++j) {
             if (sources[j]->getIfd() == ifdKey) {
-                if ((ret = sources[i]->writeToStream(endOut, sizeToWrite)) != OK) {
+                if ((ret = sources[j]->writeToStream(endOut, sizeToWrite)) != OK) {
                     ALOGE("%s: Could not write to stream, received %d.", __FUNCTION__, ret);
                     return ret;
                 }
@@ -214,6 +214,17 @@ status_t TiffWriter::addStrip(uint32_t ifd) {
     return selected->validateAndSetStripTags();
 }
 
+status_t TiffWriter::addCompressedStrips(uint32_t ifd, uint32_t rowsPerStrip,
+        const Vector<uint32_t>& byteCounts) {
+    ssize_t index = mNamedIfds.indexOfKey(ifd);
+    if (index < 0) {
+        ALOGE("%s: Ifd %u doesn't exist, cannot add strip entries.", __FUNCTION__, ifd);
+        return BAD_VALUE;
+    }
+    sp<TiffIfd> selected = mNamedIfds[index];
+    return selected->setCompressedStripTags(rowsPerStrip, byteCounts);
+}
+
 status_t TiffWriter::addIfd(uint32_t ifd) {
     ssize_t index = mNamedIfds.indexOfKey(ifd);
     if (index >= 0) {
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include <cpustats/LogHistogram.h>
+
+static unsigned boundedOctaves(unsigned octaves, unsigned bucketsPerOctave)
+{
+    if (bucketsPerOctave == 0) {
+        return 0;
+    }
+    unsigned maxOctaves = (LogHistogram::kMaxBuckets - 2) / bucketsPerOctave;
+    return octaves < maxOctaves ? octaves : maxOctaves;
+}
+
+LogHistogram::LogHistogram(double minValue, unsigned octaves, unsigned bucketsPerOctave) :
+        mMinValue(minValue > 0 ? minValue : 1),
+        mOctaves(boundedOctaves(octaves, bucketsPerOctave)),
+        mBucketsPerOctave(bucketsPerOctave > 0 ? bucketsPerOctave : 1),
+        mBuckets(mOctaves * mBucketsPerOctave + 2)
+{
+    reset();
+}
+
+void LogHistogram::sample(double x)
+{
+    if (x < mMinimum)
+        mMinimum = x;
+    if (x > mMaximum)
+        mMaximum = x;
+    ++mN;
+    unsigned bucket;
+    if (!(x >= mMinValue)) {
+        bucket = 0;
+    } else {
+        // x / mMinValue = mantissa * 2^exponent, with mantissa in [0.5, 1)
+        int exponent;
+        double mantissa = frexp(x / mMinValue, &exponent);
+        unsigned octave = exponent - 1;
+        if (octave >= mOctaves) {
+            bucket = mBuckets - 1;
+        } else {
+            unsigned sub = (unsigned) ((mantissa * 2 - 1) * mBucketsPerOctave);
+            if (sub >= mBucketsPerOctave) {
+                sub = mBucketsPerOctave - 1;
+            }
+            bucket = 1 + octave * mBucketsPerOctave + sub;
+        }
+    }
+    if (mCounts[bucket] != UINT32_MAX) {
+        ++mCounts[bucket];
+    }
+}
+
+bool LogHistogram::merge(const LogHistogram& other)
+{
+    if (other.mMinValue != mMinValue || other.mOctaves != mOctaves ||
+            other.mBucketsPerOctave != mBucketsPerOctave) {
+        return false;
+    }
+    for (unsigned i = 0; i < mBuckets; ++i) {
+        uint32_t sum = mCounts[i] + other.mCounts[i];
+        mCounts[i] = sum < mCounts[i] ? UINT32_MAX : sum;
+    }
+    mN += other.mN;
+    if (other.mMinimum < mMinimum)
+        mMinimum = other.mMinimum;
+    if (other.mMaximum > mMaximum)
+        mMaximum = other.mMaximum;
+    return true;
+}
+
+double LogHistogram::bucketLow(unsigned bucket) const
+{
+    if (bucket == 0) {
+        return 0;
+    }
+    if (bucket >= mBuckets - 1) {
+        return ldexp(mMinValue, mOctaves);
+    }
+    unsigned octave = (bucket - 1) / mBucketsPerOctave;
+    unsigned sub = (bucket - 1) % mBucketsPerOctave;
+    return ldexp(mMinValue, octave) * (1 + (double) sub / mBucketsPerOctave);
+}
+
+double LogHistogram::quantile(double q) const
+{
+    if (mN == 0) {
+        return NAN;
+    }
+    if (q <= 0) {
+        return mMinimum;
+    }
+    if (q >= 1) {
+        return mMaximum;
+    }
+    // the bucket of the sample at index q * n of the sorted samples
+    double index = floor(q * mN);
+    double cumulative = 0;
+    unsigned bucket;
+    for (bucket = 0; bucket < mBuckets - 1; ++bucket) {
+        cumulative += mCounts[bucket];
+        if (cumulative > index) {
+            break;
+        }
+    }
+    double value;
+    if (bucket == 0) {
+        value = mMinimum;
+    } else if (bucket == mBuckets - 1) {
+        value = mMaximum;
+    } else {
+        // the middle of the bucket
+        value = (bucketLow(bucket) + bucketLow(bucket + 1)) / 2;
+    }
+    if (value < mMinimum)
+        value = mMinimum;
+    if (value > mMaximum)
+        value = mMaximum;
+    return value;
+}
+
+void LogHistogram::reset()
+{
+    mMinimum = INFINITY;
+    mMaximum = -INFINITY;
+    mN = 0;
+    memset(mCounts, 0, sizeof(mCounts));
+}
@@ -21,6 +21,10 @@
 #include <string.h>
 #include <stdlib.h>
 #include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <cutils/misc.h>
 #include <cutils/config_utils.h>
@@ -44,6 +48,41 @@ static int gInitDone; // true is global initialization has been preformed
 static int gCanQueryEffect; // indicates that call to EffectQueryEffect() is valid, i.e. that the list of effects
                           // was not modified since last call to EffectQueryNumberEffects()
 
+// Descriptor cache
+//
+// Opening every configured library only to query the descriptors of its effects is most of the
+// time taken by init() during audioserver start. The descriptors are saved in
+// EFFECTS_DESCRIPTOR_CACHE_FILE, and on the next starts a library whose file is unchanged is only
+// opened by the first EffectCreate() of one of its effects.
+// A library file is identified by its path, size and modification time, and the whole cache by
+// the build fingerprint.
+#define CACHE_MAGIC 0x43584645 // "EFXC"
+#define CACHE_VERSION 1
+#define CACHE_PATH_MAX 256
+#define CACHE_MAX_ENTRIES 1024
+
+typedef struct cache_header_s {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t numEntries;
+    char fingerprint[PROPERTY_VALUE_MAX];
+} cache_header_t;
+
+typedef struct cache_entry_s {
+    char path[CACHE_PATH_MAX];  // library file
+    int64_t size;
+    int64_t mtimeNs;
+    effect_uuid_t uuid;         // uuid the descriptor was queried for
+    effect_descriptor_t desc;
+} cache_entry_t;
+
+static cache_entry_t *gCache;       // entries read from the cache file, only valid during init()
+static uint32_t gCacheSize;
+static cache_entry_t *gNewCache;    // entries queried during init(), written back if different
+static uint32_t gNewCacheSize;
+static uint32_t gNewCacheCapacity;
+static int gCacheStale;             // a descriptor queried during init() was not in gCache
+
 
 /////////////////////////////////////////////////
 //      Local functions prototypes
@@ -71,6 +110,12 @@ static int findSubEffect(const effect_uuid_t *uuid,
 static void dumpEffectDescriptor(effect_descriptor_t *desc, char *str, size_t len, int indent);
 static int stringToUuid(const char *str, effect_uuid_t *uuid);
 static int uuidToString(const effect_uuid_t *uuid, char *str, size_t maxLen);
+// To open a library entry created from the descriptor cache
+static int openLibrary(lib_entry_t *l);
+static int openSubEffectLibraries(const effect_uuid_t *uuid);
+static int queryDescriptor(lib_entry_t *l, const effect_uuid_t *uuid, effect_descriptor_t *desc);
+static void readDescriptorCache();
+static void writeDescriptorCache();
 
 /////////////////////////////////////////////////
 //      Effect Control Interface functions
@@ -306,6 +351,16 @@ int EffectCreate(const effect_uuid_t *uuid, int32_t sessionId, int32_t ioId, eff
         }
     }
 
+    // libraries known from the descriptor cache are opened by their first effect
+    ret = openLibrary(l);
+    if (ret == 0) {
+        ret = openSubEffectLibraries(uuid);
+    }
+    if (ret < 0) {
+        ALOGW("EffectCreate() could not open library %s for fx %s", l->name, d->name);
+        goto exit;
+    }
+
     // create effect in library
     ret = l->desc->create_effect(uuid, sessionId, ioId, &itfe);
     if (ret != 0) {
@@ -456,11 +511,13 @@ int init() {
     if (ignoreFxConfFiles) {
         ALOGI("Audio effects in configuration files will be ignored");
     } else {
+        readDescriptorCache();
         if (access(AUDIO_EFFECT_VENDOR_CONFIG_FILE, R_OK) == 0) {
             loadEffectConfigFile(AUDIO_EFFECT_VENDOR_CONFIG_FILE);
         } else if (access(AUDIO_EFFECT_DEFAULT_CONFIG_FILE, R_OK) == 0) {
             loadEffectConfigFile(AUDIO_EFFECT_DEFAULT_CONFIG_FILE);
         }
+        writeDescriptorCache();
     }
 
     updateNumEffects();
@@ -508,13 +565,13 @@ int loadLibraries(cnode *root)
 int loadLibrary(cnode *root, const char *name)
 {
     cnode *node;
-    void *hdl;
-    audio_effect_library_t *desc;
     list_elem_t *e;
     lib_entry_t *l;
     char path[PATH_MAX];
     char *str;
     size_t len;
+    struct stat st;
+    uint32_t i;
 
     node = config_find(root, PATH_TAG);
     if (node == NULL) {
@@ -534,9 +591,60 @@ int loadLibrary(cnode *root, const char *name)
     if (strlen(path) >= PATH_MAX - 1)
         return -EINVAL;
 
-    hdl = dlopen(path, RTLD_NOW);
+    l = malloc(sizeof(lib_entry_t));
+    l->name = strndup(name, PATH_MAX);
+    l->path = strndup(path, PATH_MAX);
+    l->handle = NULL;
+    l->desc = NULL;
+    l->effects = NULL;
+    l->size = -1;
+    l->mtimeNs = 0;
+    pthread_mutex_init(&l->lock, NULL);
+    if (stat(path, &st) == 0) {
+        l->size = st.st_size;
+        l->mtimeNs = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    }
+
+    // the library is opened now unless the descriptor cache knows it
+    for (i = 0; i < gCacheSize; i++) {
+        if (!strncmp(gCache[i].path, l->path, CACHE_PATH_MAX) &&
+                gCache[i].size == l->size && gCache[i].mtimeNs == l->mtimeNs) {
+            break;
+        }
+    }
+    if ((l->size < 0 || i == gCacheSize) && openLibrary(l) != 0) {
+        pthread_mutex_destroy(&l->lock);
+        free(l->path);
+        free(l->name);
+        free(l);
+        return -EINVAL;
+    }
+
+    // add entry for library in gLibraryList
+
+    e = malloc(sizeof(list_elem_t));
+    e->object = l;
+    pthread_mutex_lock(&gLibLock);
+    e->next = gLibraryList;
+    gLibraryList = e;
+    pthread_mutex_unlock(&gLibLock);
+    ALOGV("getLibrary() linked library %p for path %s", l, path);
+
+    return 0;
+}
+
+int openLibrary(lib_entry_t *l)
+{
+    void *hdl;
+    audio_effect_library_t *desc;
+
+    if (l->desc != NULL) {
+        return 0;
+    }
+
+    hdl = dlopen(l->path, RTLD_NOW);
     if (hdl == NULL) {
-        ALOGW("loadLibrary() failed to open %s", path);
+        ALOGW("loadLibrary() failed to open %s", l->path);
         goto error;
     }
 
@@ -557,23 +665,9 @@ int loadLibrary(cnode *root, const char *name)
         goto error;
     }
 
-    // add entry for library in gLibraryList
-    l = malloc(sizeof(lib_entry_t));
-    l->name = strndup(name, PATH_MAX);
-    l->path = strndup(path, PATH_MAX);
     l->handle = hdl;
     l->desc = desc;
-    l->effects = NULL;
-    pthread_mutex_init(&l->lock, NULL);
-
-    e = malloc(sizeof(list_elem_t));
-    e->object = l;
-    pthread_mutex_lock(&gLibLock);
-    e->next = gLibraryList;
-    gLibraryList = e;
-    pthread_mutex_unlock(&gLibLock);
-    ALOGV("getLibrary() linked library %p for path %s", l, path);
-
+    ALOGV("openLibrary() opened library %s", l->path);
     return 0;
 
 error:
@@ -583,6 +677,29 @@ error:
     return -EINVAL;
 }
 
+// Opens the libraries of the sub effects of the effect with this uuid, as EffectProxy calls
+// them directly
+int openSubEffectLibraries(const effect_uuid_t *uuid)
+{
+    list_sub_elem_t *e;
+    list_elem_t *subefx;
+    int ret;
+
+    for (e = gSubEffectList; e != NULL; e = e->next) {
+        if (memcmp(uuid, &((effect_descriptor_t *)e->object)->uuid, sizeof(effect_uuid_t))) {
+            continue;
+        }
+        for (subefx = e->sub_elem; subefx != NULL; subefx = subefx->next) {
+            ret = openLibrary(((sub_effect_entry_t *)subefx->object)->lib);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        break;
+    }
+    return 0;
+}
+
 // This will find the library and UUID tags of the sub effect pointed by the
 // node, gets the effect descriptor and lib_entry_t and adds the subeffect -
 // sub_entry_t to the gSubEffectList
@@ -612,7 +729,7 @@ int addSubEffect(cnode *root)
         return -EINVAL;
     }
     d = malloc(sizeof(effect_descriptor_t));
-    if (l->desc->get_descriptor(&uuid, d) != 0) {
+    if (queryDescriptor(l, &uuid, d) != 0) {
         char s[40];
         uuidToString(&uuid, s, 40);
         ALOGW("Error querying effect %s on lib %s", s, l->name);
@@ -694,7 +811,7 @@ int loadEffect(cnode *root)
     }
 
     d = malloc(sizeof(effect_descriptor_t));
-    if (l->desc->get_descriptor(&uuid, d) != 0) {
+    if (queryDescriptor(l, &uuid, d) != 0) {
         char s[40];
         uuidToString(&uuid, s, 40);
         ALOGW("Error querying effect %s on lib %s", s, l->name);
@@ -818,6 +935,147 @@ int findSubEffect(const effect_uuid_t *uuid,
     return ret;
 }
 
+int queryDescriptor(lib_entry_t *l, const effect_uuid_t *uuid, effect_descriptor_t *desc)
+{
+    cache_entry_t *entry;
+    uint32_t i;
+    int ret;
+
+    for (i = 0; i < gCacheSize; i++) {
+        entry = &gCache[i];
+        if (!strncmp(entry->path, l->path, CACHE_PATH_MAX) && entry->size == l->size &&
+                entry->mtimeNs == l->mtimeNs &&
+                !memcmp(&entry->uuid, uuid, sizeof(effect_uuid_t))) {
+            *desc = entry->desc;
+            break;
+        }
+    }
+    if (i == gCacheSize) {
+        gCacheStale = 1;
+        ret = openLibrary(l);
+        if (ret == 0) {
+            ret = l->desc->get_descriptor(uuid, desc);
+        }
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    if (l->size < 0 || strlen(l->path) >= CACHE_PATH_MAX) {
+        return 0;
+    }
+    if (gNewCacheSize == gNewCacheCapacity) {
+        uint32_t capacity = gNewCacheCapacity == 0 ? 16 : gNewCacheCapacity * 2;
+        cache_entry_t *newCache;
+        if (capacity > CACHE_MAX_ENTRIES) {
+            return 0;
+        }
+        newCache = realloc(gNewCache, capacity * sizeof(cache_entry_t));
+        if (newCache == NULL) {
+            return 0;
+        }
+        gNewCache = newCache;
+        gNewCacheCapacity = capacity;
+    }
+    entry = &gNewCache[gNewCacheSize++];
+    memset(entry, 0, sizeof(cache_entry_t));
+    strlcpy(entry->path, l->path, CACHE_PATH_MAX);
+    entry->size = l->size;
+    entry->mtimeNs = l->mtimeNs;
+    entry->uuid = *uuid;
+    entry->desc = *desc;
+    return 0;
+}
+
+void readDescriptorCache()
+{
+    cache_header_t header;
+    char fingerprint[PROPERTY_VALUE_MAX];
+    size_t size;
+    int fd;
+
+    fd = open(EFFECTS_DESCRIPTOR_CACHE_FILE, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        ALOGV("readDescriptorCache() no cache: %s", strerror(errno));
+        return;
+    }
+    memset(fingerprint, 0, sizeof(fingerprint));
+    property_get("ro.build.fingerprint", fingerprint, "");
+    if (read(fd, &header, sizeof(header)) != (ssize_t)sizeof(header) ||
+            header.magic != CACHE_MAGIC || header.version != CACHE_VERSION ||
+            header.numEntries > CACHE_MAX_ENTRIES ||
+            strncmp(header.fingerprint, fingerprint, PROPERTY_VALUE_MAX)) {
+        ALOGI("readDescriptorCache() ignoring invalid or outdated %s",
+                EFFECTS_DESCRIPTOR_CACHE_FILE);
+        goto exit;
+    }
+    size = header.numEntries * sizeof(cache_entry_t);
+    gCache = malloc(size);
+    if (gCache == NULL) {
+        goto exit;
+    }
+    if (read(fd, gCache, size) != (ssize_t)size) {
+        ALOGW("readDescriptorCache() truncated %s", EFFECTS_DESCRIPTOR_CACHE_FILE);
+        free(gCache);
+        gCache = NULL;
+        goto exit;
+    }
+    gCacheSize = header.numEntries;
+    ALOGV("readDescriptorCache() read %u descriptors", gCacheSize);
+
+exit:
+    close(fd);
+}
+
+void writeDescriptorCache()
+{
+    const char *tmpFile = EFFECTS_DESCRIPTOR_CACHE_FILE ".tmp";
+    cache_header_t header;
+    size_t size;
+    int fd;
+
+    // rewritten only if a descriptor had to be queried from its library, or entries were removed
+    if (!gCacheStale && gNewCacheSize == gCacheSize) {
+        goto exit;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.numEntries = gNewCacheSize;
+    property_get("ro.build.fingerprint", header.fingerprint, "");
+
+    fd = open(tmpFile, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        ALOGW("writeDescriptorCache() could not create %s: %s", tmpFile, strerror(errno));
+        goto exit;
+    }
+    size = gNewCacheSize * sizeof(cache_entry_t);
+    if (write(fd, &header, sizeof(header)) != (ssize_t)sizeof(header) ||
+            (size != 0 && write(fd, gNewCache, size) != (ssize_t)size)) {
+        ALOGW("writeDescriptorCache() could not write %s: %s", tmpFile, strerror(errno));
+        close(fd);
+        unlink(tmpFile);
+        goto exit;
+    }
+    close(fd);
+    if (rename(tmpFile, EFFECTS_DESCRIPTOR_CACHE_FILE) != 0) {
+        ALOGW("writeDescriptorCache() could not rename %s: %s", tmpFile, strerror(errno));
+        unlink(tmpFile);
+        goto exit;
+    }
+    ALOGV("writeDescriptorCache() wrote %u descriptors", gNewCacheSize);
+
+exit:
+    free(gCache);
+    gCache = NULL;
+    gCacheSize = 0;
+    free(gNewCache);
+    gNewCache = NULL;
+    gNewCacheSize = 0;
+    gNewCacheCapacity = 0;
+}
+
 lib_entry_t *getLibrary(const char *name)
 {
     list_elem_t *e;
@@ -991,7 +1249,7 @@ int EffectDumpEffects(int fd) {
     while (e) {
         l = (lib_entry_t *)e->object;
         list_elem_t *efx = l->effects;
-        dprintf(fd, "Library %s\n", l->name);
+        dprintf(fd, "Library %s%s\n", l->name, l->desc == NULL ? " (not loaded)" : "");
         if (!efx) {
             dprintf(fd, "  (no effects)\n");
         }
@@ -28,6 +28,9 @@ extern "C" {
 
 #define PROPERTY_IGNORE_EFFECTS "ro.audio.ignore_effects"
 
+// descriptors of the effects of the configured libraries, see readDescriptorCache()
+#define EFFECTS_DESCRIPTOR_CACHE_FILE "/data/misc/audioserver/audio_effects_descriptors.cache"
+
 typedef struct list_elem_s {
     void *object;
     struct list_elem_s *next;
@@ -43,12 +46,14 @@ typedef struct list_sub_elem_s {
 } list_sub_elem_t;
 
 typedef struct lib_entry_s {
-    audio_effect_library_t *desc;
+    audio_effect_library_t *desc; // NULL until the library is opened, see openLibrary()
     char *name;
     char *path;
     void *handle;
     list_elem_t *effects; //list of effect_descriptor_t
     pthread_mutex_t lock;
+    int64_t size;       // size of the library file, or -1 if unknown
+    int64_t mtimeNs;    // modification time of the library file
 } lib_entry_t;
 
 typedef struct effect_entry_s {
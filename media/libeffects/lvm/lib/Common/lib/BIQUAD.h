@@ -308,6 +308,13 @@ void PK_2I_D32F32C14G11_TRC_WRA_01 (        Biquad_Instance_t       *pInstance,
                                             LVM_INT32                    *pDataOut,
                                             LVM_INT16                    NrSamples);
 
+/* Applies NrStages (at least 1) PK_2I_D32F32C14G11_TRC_WRA_01 filters in one pass */
+void PK_2I_D32F32C14G11_Cascade_TRC_WRA_01 ( Biquad_Instance_t      **pInstances,
+                                            LVM_INT16                    NrStages,
+                                            LVM_INT32                    *pDataIn,
+                                            LVM_INT32                    *pDataOut,
+                                            LVM_INT16                    NrSamples);
+
 
 /**********************************************************************************
    FUNCTION PROTOTYPES: DC REMOVAL FILTERS
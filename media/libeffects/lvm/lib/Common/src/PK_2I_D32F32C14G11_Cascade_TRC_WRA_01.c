@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BIQUAD.h"
+#include "PK_2I_D32F32CssGss_TRC_WRA_01_Private.h"
+#include "LVM_Macros.h"
+
+#if defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#define USE_NEON
+#endif
+
+/**************************************************************************
+ Cascade of PK_2I_D32F32C14G11_TRC_WRA_01 peaking filters.
+
+ Each sample goes through all NrStages filters before the next sample is
+ read, so the block is read and written once whatever the number of bands,
+ and the delays of the stages are kept in locals for the whole block.
+ Stages are processed in groups of PK_CASCADE_MAX_STAGES.
+
+ With NEON both channels are filtered together. The products are computed
+ in 64 bits and shifted, which is what MUL32x16INTO32 computes for a 16 bit
+ coefficient: the output is bit exact with the single stage filter applied
+ NrStages times.
+
+ COEFS and DELAYS of each instance are as in PK_2I_D32F32C14G11_TRC_WRA_01
+***************************************************************************/
+
+#define PK_CASCADE_MAX_STAGES   8
+
+#ifdef USE_NEON
+
+/* (A * B) >> Shift on both channels */
+#define MUL32x16INTO32_2I(A, B, Shift)   vmovn_s64(vshrq_n_s64(vmull_n_s32((A), (B)), (Shift)))
+
+static void PK_Cascade_Group(PFilter_State           *pStates,
+                             LVM_INT16               NrStages,
+                             LVM_INT32               *pDataIn,
+                             LVM_INT32               *pDataOut,
+                             LVM_INT16               NrSamples)
+    {
+        int32x2_t x1[PK_CASCADE_MAX_STAGES], x2[PK_CASCADE_MAX_STAGES];
+        int32x2_t y1[PK_CASCADE_MAX_STAGES], y2[PK_CASCADE_MAX_STAGES];
+        int32x2_t xn, yn;
+        LVM_INT16 ii, jj;
+
+        for (jj = 0; jj < NrStages; jj++)
+        {
+            x1[jj] = vld1_s32(&pStates[jj]->pDelays[0]);
+            x2[jj] = vld1_s32(&pStates[jj]->pDelays[2]);
+            y1[jj] = vld1_s32(&pStates[jj]->pDelays[4]);
+            y2[jj] = vld1_s32(&pStates[jj]->pDelays[6]);
+        }
+
+        for (ii = NrSamples; ii != 0; ii--)
+        {
+            xn = vld1_s32(pDataIn);
+            pDataIn += 2;
+
+            for (jj = 0; jj < NrStages; jj++)
+            {
+                const LVM_INT32 *coefs = pStates[jj]->coefs;
+
+                /* yn= (A0 * (x(n) - x(n-2)) >>14) + (-B2 * y(n-2) >>14) + (-B1 * y(n-1) >>14) */
+                yn = MUL32x16INTO32_2I(vsub_s32(xn, x2[jj]), coefs[0], 14);
+                yn = vadd_s32(yn, MUL32x16INTO32_2I(y2[jj], coefs[1], 14));
+                yn = vadd_s32(yn, MUL32x16INTO32_2I(y1[jj], coefs[2], 14));
+
+                x2[jj] = x1[jj];
+                x1[jj] = xn;
+                y2[jj] = y1[jj];
+                y1[jj] = yn;
+
+                /* the input of the next stage is ((Gain * yn) >>11) + x(n) */
+                xn = vadd_s32(MUL32x16INTO32_2I(yn, coefs[3], 11), xn);
+            }
+
+            vst1_s32(pDataOut, xn);
+            pDataOut += 2;
+        }
+
+        for (jj = 0; jj < NrStages; jj++)
+        {
+            vst1_s32(&pStates[jj]->pDelays[0], x1[jj]);
+            vst1_s32(&pStates[jj]->pDelays[2], x2[jj]);
+            vst1_s32(&pStates[jj]->pDelays[4], y1[jj]);
+            vst1_s32(&pStates[jj]->pDelays[6], y2[jj]);
+        }
+    }
+
+#else
+
+static void PK_Cascade_Group(PFilter_State           *pStates,
+                             LVM_INT16               NrStages,
+                             LVM_INT32               *pDataIn,
+                             LVM_INT32               *pDataOut,
+                             LVM_INT16               NrSamples)
+    {
+        LVM_INT32 delays[PK_CASCADE_MAX_STAGES][8];
+        LVM_INT32 xnL, xnR, ynL, ynR, templ;
+        LVM_INT16 ii, jj, kk;
+
+        for (jj = 0; jj < NrStages; jj++)
+        {
+            for (kk = 0; kk < 8; kk++)
+            {
+                delays[jj][kk] = pStates[jj]->pDelays[kk];
+            }
+        }
+
+        for (ii = NrSamples; ii != 0; ii--)
+        {
+            xnL = *pDataIn++;
+            xnR = *pDataIn++;
+
+            for (jj = 0; jj < NrStages; jj++)
+            {
+                const LVM_INT32 *coefs = pStates[jj]->coefs;
+                LVM_INT32 *d = delays[jj];
+
+                /* ynL= (A0 * (x(n)L - x(n-2)L) >>14) + (-B2 * y(n-2)L >>14)
+                 *      + (-B1 * y(n-1)L >>14) */
+                templ = xnL - d[2];
+                MUL32x16INTO32(templ, coefs[0], ynL, 14)
+                MUL32x16INTO32(d[6], coefs[1], templ, 14)
+                ynL += templ;
+                MUL32x16INTO32(d[4], coefs[2], templ, 14)
+                ynL += templ;
+
+                /* same for the right channel */
+                templ = xnR - d[3];
+                MUL32x16INTO32(templ, coefs[0], ynR, 14)
+                MUL32x16INTO32(d[7], coefs[1], templ, 14)
+                ynR += templ;
+                MUL32x16INTO32(d[5], coefs[2], templ, 14)
+                ynR += templ;
+
+                d[7] = d[5];
+                d[6] = d[4];
+                d[3] = d[1];
+                d[2] = d[0];
+                d[5] = ynR;
+                d[4] = ynL;
+                d[1] = xnR;
+                d[0] = xnL;
+
+                /* the input of the next stage is ((Gain * yn) >>11) + x(n) */
+                MUL32x16INTO32(ynL, coefs[3], templ, 11)
+                xnL += templ;
+                MUL32x16INTO32(ynR, coefs[3], templ, 11)
+                xnR += templ;
+            }
+
+            *pDataOut++ = xnL;
+            *pDataOut++ = xnR;
+        }
+
+        for (jj = 0; jj < NrStages; jj++)
+        {
+            for (kk = 0; kk < 8; kk++)
+            {
+                pStates[jj]->pDelays[kk] = delays[jj][kk];
+            }
+        }
+    }
+
+#endif /* USE_NEON */
+
+void PK_2I_D32F32C14G11_Cascade_TRC_WRA_01 ( Biquad_Instance_t       **pInstances,
+                                             LVM_INT16               NrStages,
+                                             LVM_INT32               *pDataIn,
+                                             LVM_INT32               *pDataOut,
+                                             LVM_INT16               NrSamples)
+    {
+        PFilter_State pStates[PK_CASCADE_MAX_STAGES];
+        LVM_INT16 jj, nn;
+
+        while (NrStages > 0)
+        {
+            nn = (NrStages > PK_CASCADE_MAX_STAGES) ? PK_CASCADE_MAX_STAGES : NrStages;
+            for (jj = 0; jj < nn; jj++)
+            {
+                pStates[jj] = (PFilter_State) pInstances[jj];
+            }
+
+            PK_Cascade_Group(pStates, nn, pDataIn, pDataOut, NrSamples);
+
+            /* the following groups filter the output in place */
+            pDataIn = pDataOut;
+            pInstances += nn;
+            NrStages = (LVM_INT16)(NrStages - nn);
+        }
+    }
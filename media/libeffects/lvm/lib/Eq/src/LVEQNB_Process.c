@@ -34,6 +34,7 @@
 /****************************************************************************************/
 
 #define SHIFT       13
+#define MAX_CASCADE 8       /* Single precision bands filtered in one pass */
 
 /****************************************************************************************/
 /*                                                                                      */
@@ -66,6 +67,8 @@ LVEQNB_ReturnStatus_en LVEQNB_Process(LVEQNB_Handle_t       hInstance,
 
     LVM_UINT16          i;
     Biquad_Instance_t   *pBiquad;
+    Biquad_Instance_t   *pCascade[MAX_CASCADE];
+    LVM_INT16           NCascade = 0;
     LVEQNB_Instance_t   *pInstance = (LVEQNB_Instance_t  *)hInstance;
     LVM_INT32           *pScratch;
 
@@ -127,15 +130,33 @@ LVEQNB_ReturnStatus_en LVEQNB_Process(LVEQNB_Handle_t       hInstance,
                     {
                         case LVEQNB_SinglePrecision:
                         {
-                            PK_2I_D32F32C14G11_TRC_WRA_01(pBiquad,
-                                                          (LVM_INT32 *)pScratch,
-                                                          (LVM_INT32 *)pScratch,
-                                                          (LVM_INT16)NumSamples);
+                            /*
+                             * Consecutive single precision bands are filtered in one pass
+                             */
+                            pCascade[NCascade++] = pBiquad;
+                            if (NCascade == MAX_CASCADE)
+                            {
+                                PK_2I_D32F32C14G11_Cascade_TRC_WRA_01(pCascade,
+                                                                      NCascade,
+                                                                      (LVM_INT32 *)pScratch,
+                                                                      (LVM_INT32 *)pScratch,
+                                                                      (LVM_INT16)NumSamples);
+                                NCascade = 0;
+                            }
                             break;
                         }
 
                         case LVEQNB_DoublePrecision:
                         {
+                            if (NCascade != 0)
+                            {
+                                PK_2I_D32F32C14G11_Cascade_TRC_WRA_01(pCascade,
+                                                                      NCascade,
+                                                                      (LVM_INT32 *)pScratch,
+                                                                      (LVM_INT32 *)pScratch,
+                                                                      (LVM_INT16)NumSamples);
+                                NCascade = 0;
+                            }
                             PK_2I_D32F32C30G11_TRC_WRA_01(pBiquad,
                                                           (LVM_INT32 *)pScratch,
                                                           (LVM_INT32 *)pScratch,
@@ -147,6 +168,14 @@ LVEQNB_ReturnStatus_en LVEQNB_Process(LVEQNB_Handle_t       hInstance,
                     }
                 }
             }
+            if (NCascade != 0)
+            {
+                PK_2I_D32F32C14G11_Cascade_TRC_WRA_01(pCascade,
+                                                      NCascade,
+                                                      (LVM_INT32 *)pScratch,
+                                                      (LVM_INT32 *)pScratch,
+                                                      (LVM_INT16)NumSamples);
+            }
         }
 
 
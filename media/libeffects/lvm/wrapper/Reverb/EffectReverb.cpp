@@ -417,7 +417,9 @@ int process( LVM_INT16     *pIn,
 
     LVM_INT16               samplesPerFrame = 1;
     LVREV_ReturnStatus_en   LvmStatus = LVREV_SUCCESS;              /* Function call status */
-    LVM_INT16 *OutFrames16;
+    #ifdef LVM_PCM
+    LVM_INT16 *OutFrames16 = (LVM_INT16 *)pContext->InFrames32; // free once LVREV_Process() ran
+    #endif
 
 
     // Check that the input is either mono or stereo
@@ -428,8 +430,6 @@ int process( LVM_INT16     *pIn,
         return -EINVAL;
     }
 
-    OutFrames16 = (LVM_INT16 *)pContext->OutFrames32;
-
     // Check for NULL pointers
     if((pContext->InFrames32 == NULL)||(pContext->OutFrames32 == NULL)){
         ALOGV("\tLVREV_ERROR : process failed to allocate memory for temporary buffers ");
@@ -478,46 +478,29 @@ int process( LVM_INT16     *pIn,
     LVM_ERROR_CHECK(LvmStatus, "LVREV_Process", "process")
     if(LvmStatus != LVREV_SUCCESS) return -EINVAL;
 
-    // Convert to 16 bits
-    if (pContext->auxiliary) {
-        for (int i=0; i < frameCount*2; i++) { //always stereo here
-            OutFrames16[i] = clamp16(pContext->OutFrames32[i]>>8);
-        }
-    } else {
-        for (int i=0; i < frameCount*2; i++) { //always stereo here
-            OutFrames16[i] = clamp16((pContext->OutFrames32[i]>>8) + (LVM_INT32)pIn[i]);
-        }
-
+    // Convert to 16 bits, mix with the dry input, apply the volume and write or accumulate the
+    // output in a single pass over the frames
+    bool applyVolume = false;
+    LVM_INT32 vl = 0, incl = 0, vr = 0, incr = 0;   // volumes in 4.12 format << 16
+    if (!pContext->auxiliary) {
         // apply volume with ramp if needed
         if ((pContext->leftVolume != pContext->prevLeftVolume ||
                 pContext->rightVolume != pContext->prevRightVolume) &&
                 pContext->volumeMode == REVERB_VOLUME_RAMP) {
-            LVM_INT32 vl = (LVM_INT32)pContext->prevLeftVolume << 16;
-            LVM_INT32 incl = (((LVM_INT32)pContext->leftVolume << 16) - vl) / frameCount;
-            LVM_INT32 vr = (LVM_INT32)pContext->prevRightVolume << 16;
-            LVM_INT32 incr = (((LVM_INT32)pContext->rightVolume << 16) - vr) / frameCount;
-
-            for (int i = 0; i < frameCount; i++) {
-                OutFrames16[2*i] =
-                        clamp16((LVM_INT32)((vl >> 16) * OutFrames16[2*i]) >> 12);
-                OutFrames16[2*i+1] =
-                        clamp16((LVM_INT32)((vr >> 16) * OutFrames16[2*i+1]) >> 12);
-
-                vl += incl;
-                vr += incr;
-            }
+            vl = (LVM_INT32)pContext->prevLeftVolume << 16;
+            incl = (((LVM_INT32)pContext->leftVolume << 16) - vl) / frameCount;
+            vr = (LVM_INT32)pContext->prevRightVolume << 16;
+            incr = (((LVM_INT32)pContext->rightVolume << 16) - vr) / frameCount;
+            applyVolume = true;
 
             pContext->prevLeftVolume = pContext->leftVolume;
             pContext->prevRightVolume = pContext->rightVolume;
         } else if (pContext->volumeMode != REVERB_VOLUME_OFF) {
             if (pContext->leftVolume != REVERB_UNIT_VOLUME ||
                 pContext->rightVolume != REVERB_UNIT_VOLUME) {
-                for (int i = 0; i < frameCount; i++) {
-                    OutFrames16[2*i] =
-                            clamp16((LVM_INT32)(pContext->leftVolume * OutFrames16[2*i]) >> 12);
-                    OutFrames16[2*i+1] =
-                            clamp16((LVM_INT32)(pContext->rightVolume * OutFrames16[2*i+1]) >> 12);
-                }
+                vl = (LVM_INT32)pContext->leftVolume << 16;
+                vr = (LVM_INT32)pContext->rightVolume << 16;
+                applyVolume = true;
             }
             pContext->prevLeftVolume = pContext->leftVolume;
             pContext->prevRightVolume = pContext->rightVolume;
@@ -525,22 +508,43 @@ int process( LVM_INT16     *pIn,
         }
     }
 
+    const bool accumulate =
+            pContext->config.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE;
+    const LVM_INT32 *pReverb = pContext->OutFrames32;
+    for (int i = 0; i < frameCount; i++) { //always stereo here
+        int32_t left, right;
+        if (pContext->auxiliary) {
+            left = clamp16(pReverb[2*i] >> 8);
+            right = clamp16(pReverb[2*i+1] >> 8);
+        } else {
+            left = clamp16((pReverb[2*i] >> 8) + (LVM_INT32)pIn[2*i]);
+            right = clamp16((pReverb[2*i+1] >> 8) + (LVM_INT32)pIn[2*i+1]);
+            if (applyVolume) {
+                left = clamp16((LVM_INT32)((vl >> 16) * left) >> 12);
+                right = clamp16((LVM_INT32)((vr >> 16) * right) >> 12);
+                vl += incl;
+                vr += incr;
+            }
+        }
+
+        #ifdef LVM_PCM
+        OutFrames16[2*i] = left;
+        OutFrames16[2*i+1] = right;
+        #endif
+
+        if (accumulate) {
+            left = clamp16((int32_t)pOut[2*i] + left);
+            right = clamp16((int32_t)pOut[2*i+1] + right);
+        }
+        pOut[2*i] = left;
+        pOut[2*i+1] = right;
+    }
+
     #ifdef LVM_PCM
     fwrite(OutFrames16, frameCount*sizeof(LVM_INT16)*2, 1, pContext->PcmOutPtr);
     fflush(pContext->PcmOutPtr);
     #endif
 
-    // Accumulate if required
-    if (pContext->config.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE){
-        //ALOGV("\tBuffer access is ACCUMULATE");
-        for (int i=0; i<frameCount*2; i++){ //always stereo here
-            pOut[i] = clamp16((int32_t)pOut[i] + (int32_t)OutFrames16[i]);
-        }
-    }else{
-        //ALOGV("\tBuffer access is WRITE");
-        memcpy(pOut, OutFrames16, frameCount*sizeof(LVM_INT16)*2);
-    }
-
     return 0;
 }    /* end process */
 
@@ -1873,11 +1877,18 @@ int Reverb_process(effect_handle_t   self,
         return -EINVAL;
     }
     //ALOGV("\tReverb_process() Calling process with %d frames", outBuffer->frameCount);
-    /* Process all the available frames, block processing is handled internalLY by the LVM bundle */
-    status = process(    (LVM_INT16 *)inBuffer->raw,
-                         (LVM_INT16 *)outBuffer->raw,
-                                      outBuffer->frameCount,
-                                      pContext);
+    /* Process all the available frames, in blocks that fit the preallocated 32 bit buffers */
+    const size_t inChannels =
+            pContext->config.inputCfg.channels == AUDIO_CHANNEL_OUT_MONO ? 1 : 2;
+    for (size_t done = 0; status == 0 && done < outBuffer->frameCount; ) {
+        const size_t frames = outBuffer->frameCount - done < LVREV_MAX_FRAME_SIZE ?
+                outBuffer->frameCount - done : LVREV_MAX_FRAME_SIZE;
+        status = process(    (LVM_INT16 *)inBuffer->raw + done * inChannels,
+                             (LVM_INT16 *)outBuffer->raw + done * 2,  // always stereo
+                                          frames,
+                                          pContext);
+        done += frames;
+    }
 
     if (pContext->bEnabled == LVM_FALSE) {
         if (pContext->SamplesToExitCount > 0) {
@@ -31,6 +31,9 @@
 // undefine to perform multi channels API functional tests
 //#define DUAL_MIC_TEST
 
+// undefine to log the time spent in the webRTC APM by each session
+//#define PREPROC_PROFILING
+
 //------------------------------------------------------------------------------
 // local definitions
 //------------------------------------------------------------------------------
@@ -96,6 +99,35 @@ struct preproc_effect_s {
 #endif
 };
 
+#ifdef PREPROC_PROFILING
+// number of 10 ms APM frames between two profiling logs
+#define PREPROC_PROFILING_FRAMES 500
+
+// time spent processing APM frames since the last log
+typedef struct preproc_profile_s {
+    nsecs_t totalNs;
+    nsecs_t maxNs;
+    uint32_t frames;
+} preproc_profile_t;
+
+static void Profile_Add(preproc_profile_t *profile, nsecs_t startNs,
+                        const char *name, int sessionId, uint32_t enabledMsk)
+{
+    nsecs_t durationNs = systemTime() - startNs;
+    profile->totalNs += durationNs;
+    if (durationNs > profile->maxNs) {
+        profile->maxNs = durationNs;
+    }
+    if (++profile->frames == PREPROC_PROFILING_FRAMES) {
+        ALOGD("%s session %d enabled %08x: %u frames, average %lld us, max %lld us",
+              name, sessionId, enabledMsk, profile->frames,
+              (long long)(profile->totalNs / profile->frames / 1000),
+              (long long)(profile->maxNs / 1000));
+        memset(profile, 0, sizeof(*profile));
+    }
+}
+#endif
+
 // Session context
 struct preproc_session_s {
     struct preproc_effect_s effects[PREPROC_NUM_EFFECTS]; // effects in this session
@@ -132,6 +164,10 @@ struct preproc_session_s {
     size_t revBufSize;                  // reverse channel input buffer size
     size_t framesRev;                   // number of frames in reverse channel input buffer
     SpeexResamplerState *revResampler;  // handle on reverse channel input speex resampler
+#ifdef PREPROC_PROFILING
+    preproc_profile_t procProfile;      // time spent in ProcessStream()
+    preproc_profile_t revProfile;       // time spent in AnalyzeReverseStream()
+#endif
 };
 
 #ifdef DUAL_MIC_TEST
@@ -811,6 +847,10 @@ int Session_Init(preproc_session_t *session)
     session->io = 0;
     session->createdMsk = 0;
     session->apm = NULL;
+#ifdef PREPROC_PROFILING
+    memset(&session->procProfile, 0, sizeof(session->procProfile));
+    memset(&session->revProfile, 0, sizeof(session->revProfile));
+#endif
     for (i = 0; i < PREPROC_NUM_EFFECTS && status == 0; i++) {
         status = Effect_Init(&session->effects[i], i);
     }
@@ -1241,7 +1281,7 @@ int PreProcessingFx_Process(effect_handle_t     self,
             memcpy(outBuffer->s16,
                   session->outBuf,
                   fr * session->outChannelCount * sizeof(int16_t));
-            memcpy(session->outBuf,
+            memmove(session->outBuf,
                   session->outBuf + fr * session->outChannelCount,
                   (session->framesOut - fr) * session->outChannelCount * sizeof(int16_t));
             session->framesOut -= fr;
@@ -1304,7 +1344,7 @@ int PreProcessingFx_Process(effect_handle_t     self,
                                                         session->procFrame->data_,
                                                         &frOut);
             }
-            memcpy(session->inBuf,
+            memmove(session->inBuf,
                    session->inBuf + frIn * session->inChannelCount,
                    (session->framesIn - frIn) * session->inChannelCount * sizeof(int16_t));
             session->framesIn -= frIn;
@@ -1335,7 +1375,24 @@ int PreProcessingFx_Process(effect_handle_t     self,
         }
         session->procFrame->samples_per_channel_ = session->apmFrameCount;
 
+#ifdef PREPROC_PROFILING
+        nsecs_t startNs = systemTime();
+#endif
         effect->session->apm->ProcessStream(session->procFrame);
+#ifdef PREPROC_PROFILING
+        Profile_Add(&session->procProfile, startNs, "ProcessStream", session->id,
+                    session->enabledMsk);
+#endif
+
+        // session->framesOut is 0 here: without output resampler, a frame that fits in
+        // outBuffer is copied there directly instead of going through outBuf
+        if (session->outResampler == NULL && framesRq - framesWr >= session->frameCount) {
+            memcpy(outBuffer->s16 + framesWr * session->outChannelCount,
+                   session->procFrame->data_,
+                   session->frameCount * session->outChannelCount * sizeof(int16_t));
+            outBuffer->frameCount += session->frameCount;
+            return 0;
+        }
 
         if (session->outBufSize < session->framesOut + session->frameCount) {
             int16_t *buf;
@@ -1382,7 +1439,7 @@ int PreProcessingFx_Process(effect_handle_t     self,
         memcpy(outBuffer->s16 + framesWr * session->outChannelCount,
               session->outBuf,
               fr * session->outChannelCount * sizeof(int16_t));
-        memcpy(session->outBuf,
+        memmove(session->outBuf,
               session->outBuf + fr * session->outChannelCount,
               (session->framesOut - fr) * session->outChannelCount * sizeof(int16_t));
         session->framesOut -= fr;
@@ -1841,7 +1898,7 @@ int PreProcessingFx_ProcessReverse(effect_handle_t     self,
                                                         session->revFrame->data_,
                                                         &frOut);
             }
-            memcpy(session->revBuf,
+            memmove(session->revBuf,
                    session->revBuf + frIn * session->inChannelCount,
                    (session->framesRev - frIn) * session->inChannelCount * sizeof(int16_t));
             session->framesRev -= frIn;
@@ -1861,7 +1918,14 @@ int PreProcessingFx_ProcessReverse(effect_handle_t     self,
             session->framesRev = 0;
         }
         session->revFrame->samples_per_channel_ = session->apmFrameCount;
+#ifdef PREPROC_PROFILING
+        nsecs_t startNs = systemTime();
+#endif
         effect->session->apm->AnalyzeReverseStream(session->revFrame);
+#ifdef PREPROC_PROFILING
+        Profile_Add(&session->revProfile, startNs, "AnalyzeReverseStream", session->id,
+                    session->revEnabledMsk);
+#endif
         return 0;
     } else {
         return -ENODATA;
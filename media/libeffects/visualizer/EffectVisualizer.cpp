@@ -18,6 +18,7 @@
 //#define LOG_NDEBUG 0
 #include <log/log.h>
 #include <assert.h>
+#include <atomic>
 #include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
@@ -74,13 +75,16 @@ struct BufferStats {
 struct VisualizerContext {
     const struct effect_interface_s *mItfe;
     effect_config_t mConfig;
-    uint32_t mCaptureIdx;
+    // The capture buffer is a single writer ring: process() writes the samples and then publishes
+    // mCaptureIdx and mBufferUpdateTimeNs with release semantics, so that commands can read them
+    // without synchronizing with the audio thread.
+    std::atomic<uint32_t> mCaptureIdx;  // next write position in mCaptureBuf
     uint32_t mCaptureSize;
     uint32_t mScalingMode;
     uint8_t mState;
     uint32_t mLastCaptureIdx;
     uint32_t mLatency;
-    struct timespec mBufferUpdateTime;
+    std::atomic<int64_t> mBufferUpdateTimeNs; // CLOCK_MONOTONIC time of the last update, 0 if idle
     uint8_t mCaptureBuf[CAPTURE_BUF_SIZE];
     // for measurements
     uint8_t mChannelCount; // to avoid recomputing it every time a buffer is processed
@@ -93,18 +97,22 @@ struct VisualizerContext {
 //
 //--- Local functions
 //
+// returns the CLOCK_MONOTONIC time in ns, or 0 on error
+static int64_t Visualizer_getMonotonicTimeNs() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0) {
+        return 0;
+    }
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
 uint32_t Visualizer_getDeltaTimeMsFromUpdatedTime(VisualizerContext* pContext) {
     uint32_t deltaMs = 0;
-    if (pContext->mBufferUpdateTime.tv_sec != 0) {
-        struct timespec ts;
-        if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
-            time_t secs = ts.tv_sec - pContext->mBufferUpdateTime.tv_sec;
-            long nsec = ts.tv_nsec - pContext->mBufferUpdateTime.tv_nsec;
-            if (nsec < 0) {
-                --secs;
-                nsec += 1000000000;
-            }
-            deltaMs = secs * 1000 + nsec / 1000000;
+    const int64_t updateTimeNs = pContext->mBufferUpdateTimeNs.load(std::memory_order_acquire);
+    if (updateTimeNs != 0) {
+        const int64_t nowNs = Visualizer_getMonotonicTimeNs();
+        if (nowNs != 0) {
+            deltaMs = (nowNs - updateTimeNs) / 1000000;
         }
     }
     return deltaMs;
@@ -113,9 +121,9 @@ uint32_t Visualizer_getDeltaTimeMsFromUpdatedTime(VisualizerContext* pContext) {
 
 void Visualizer_reset(VisualizerContext *pContext)
 {
-    pContext->mCaptureIdx = 0;
+    pContext->mCaptureIdx.store(0, std::memory_order_relaxed);
     pContext->mLastCaptureIdx = 0;
-    pContext->mBufferUpdateTime.tv_sec = 0;
+    pContext->mBufferUpdateTimeNs.store(0, std::memory_order_relaxed);
     pContext->mLatency = 0;
     memset(pContext->mCaptureBuf, 0x80, CAPTURE_BUF_SIZE);
 }
@@ -326,21 +334,23 @@ int Visualizer_process(
     // perform measurements if needed
     if (pContext->mMeasurementMode & MEASUREMENT_MODE_PEAK_RMS) {
         // find the peak and RMS squared for the new buffer
-        uint32_t inIdx;
-        int16_t maxSample = 0;
-        float rmsSqAcc = 0;
-        for (inIdx = 0 ; inIdx < inBuffer->frameCount * pContext->mChannelCount ; inIdx++) {
-            if (inBuffer->s16[inIdx] > maxSample) {
-                maxSample = inBuffer->s16[inIdx];
-            } else if (-inBuffer->s16[inIdx] > maxSample) {
-                maxSample = -inBuffer->s16[inIdx];
+        // integer accumulation is exact and lets the compiler vectorize the loop
+        const uint32_t sampleCount = inBuffer->frameCount * pContext->mChannelCount;
+        int32_t maxSample = 0;
+        int64_t rmsSqAcc = 0;
+        for (uint32_t inIdx = 0 ; inIdx < sampleCount ; inIdx++) {
+            const int32_t smp = inBuffer->s16[inIdx];
+            const int32_t absSmp = smp < 0 ? -smp : smp;
+            if (absSmp > maxSample) {
+                maxSample = absSmp;
             }
-            rmsSqAcc += (inBuffer->s16[inIdx] * inBuffer->s16[inIdx]);
+            rmsSqAcc += smp * smp;
         }
         // store the measurement
-        pContext->mPastMeasurements[pContext->mMeasurementBufferIdx].mPeakU16 = (uint16_t)maxSample;
+        pContext->mPastMeasurements[pContext->mMeasurementBufferIdx].mPeakU16 =
+                maxSample > INT16_MAX ? INT16_MAX : (uint16_t)maxSample;
         pContext->mPastMeasurements[pContext->mMeasurementBufferIdx].mRmsSquared =
-                rmsSqAcc / (inBuffer->frameCount * pContext->mChannelCount);
+                (float)rmsSqAcc / sampleCount;
         pContext->mPastMeasurements[pContext->mMeasurementBufferIdx].mIsValid = true;
         if (++pContext->mMeasurementBufferIdx >= pContext->mMeasurementWindowSizeInBuffers) {
             pContext->mMeasurementBufferIdx = 0;
@@ -378,7 +388,7 @@ int Visualizer_process(
     uint32_t captIdx;
     uint32_t inIdx;
     uint8_t *buf = pContext->mCaptureBuf;
-    for (inIdx = 0, captIdx = pContext->mCaptureIdx;
+    for (inIdx = 0, captIdx = pContext->mCaptureIdx.load(std::memory_order_relaxed);
          inIdx < inBuffer->frameCount;
          inIdx++, captIdx++) {
         if (captIdx >= CAPTURE_BUF_SIZE) {
@@ -390,13 +400,10 @@ int Visualizer_process(
         buf[captIdx] = ((uint8_t)smp)^0x80;
     }
 
-    // XXX the following two should really be atomic, though it probably doesn't
-    // matter much for visualization purposes
-    pContext->mCaptureIdx = captIdx;
-    // update last buffer update time stamp
-    if (clock_gettime(CLOCK_MONOTONIC, &pContext->mBufferUpdateTime) < 0) {
-        pContext->mBufferUpdateTime.tv_sec = 0;
-    }
+    // publish the new samples, then the last buffer update time stamp
+    pContext->mCaptureIdx.store(captIdx, std::memory_order_release);
+    pContext->mBufferUpdateTimeNs.store(Visualizer_getMonotonicTimeNs(),
+            std::memory_order_release);
 
     if (inBuffer->raw != outBuffer->raw) {
         if (pContext->mConfig.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE) {
@@ -569,14 +576,16 @@ int Visualizer_command(effect_handle_t self, uint32_t cmdCode, uint32_t cmdSize,
         }
         if (pContext->mState == VISUALIZER_STATE_ACTIVE) {
             const uint32_t deltaMs = Visualizer_getDeltaTimeMsFromUpdatedTime(pContext);
+            // samples before this index were completely written by process()
+            const uint32_t captureIdx = pContext->mCaptureIdx.load(std::memory_order_acquire);
 
             // if audio framework has stopped playing audio although the effect is still
             // active we must clear the capture buffer to return silence
-            if ((pContext->mLastCaptureIdx == pContext->mCaptureIdx) &&
-                    (pContext->mBufferUpdateTime.tv_sec != 0) &&
+            if ((pContext->mLastCaptureIdx == captureIdx) &&
+                    (pContext->mBufferUpdateTimeNs.load(std::memory_order_relaxed) != 0) &&
                     (deltaMs > MAX_STALL_TIME_MS)) {
                     ALOGV("capture going to idle");
-                    pContext->mBufferUpdateTime.tv_sec = 0;
+                    pContext->mBufferUpdateTimeNs.store(0, std::memory_order_relaxed);
                     memset(pReplyData, 0x80, captureSize);
             } else {
                 int32_t latencyMs = pContext->mLatency;
@@ -594,7 +603,7 @@ int Visualizer_command(effect_handle_t self, uint32_t cmdCode, uint32_t cmdSize,
                     deltaSmpl = CAPTURE_BUF_SIZE;
                 }
 
-                int32_t capturePoint = pContext->mCaptureIdx - deltaSmpl;
+                int32_t capturePoint = captureIdx - deltaSmpl;
                 // a negative capturePoint means we wrap the buffer.
                 if (capturePoint < 0) {
                     uint32_t size = -capturePoint;
@@ -613,7 +622,7 @@ int Visualizer_command(effect_handle_t self, uint32_t cmdCode, uint32_t cmdSize,
                        captureSize);
             }
 
-            pContext->mLastCaptureIdx = pContext->mCaptureIdx;
+            pContext->mLastCaptureIdx = captureIdx;
         } else {
             memset(pReplyData, 0x80, captureSize);
         }
@@ -17,6 +17,7 @@ include $(CLEAR_VARS)
 LOCAL_SRC_FILES:= \
     AudioTrack.cpp \
     AudioTrackShared.cpp \
+    AudioTrackCallbackPool.cpp \
     IAudioFlinger.cpp \
     IAudioFlingerClient.cpp \
     IAudioTrack.cpp \
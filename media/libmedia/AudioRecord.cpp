@@ -858,6 +858,65 @@ void AudioRecord::releaseBuffer(const Buffer* audioBuffer)
     // the server does not automatically disable recorder on overrun, so no need to restart
 }
 
+status_t AudioRecord::obtainMappedBuffer(MappedBuffer* buffer, size_t frameCount,
+        int32_t waitCount)
+{
+    if (buffer == NULL) {
+        return BAD_VALUE;
+    }
+    buffer->frameCount = 0;
+    for (int i = 0; i < 2; i++) {
+        buffer->raw[i] = NULL;
+        buffer->frames[i] = 0;
+    }
+    buffer->position = mFramesRead;
+    buffer->timestamp.clear();
+    if (frameCount == 0) {
+        return BAD_VALUE;
+    }
+
+    Buffer audioBuffer;
+    audioBuffer.frameCount = frameCount;
+    size_t nonContig;
+    status_t status = obtainBuffer(&audioBuffer, waitCount, &nonContig);
+    if (status != NO_ERROR) {
+        return status;
+    }
+    buffer->raw[0] = audioBuffer.raw;
+    buffer->frames[0] = audioBuffer.frameCount;
+
+    if (nonContig > 0 && audioBuffer.frameCount < frameCount) {
+        AutoMutex lock(mLock);
+        // the proxy may have been re-created since obtainBuffer(), in which case it has
+        // nothing unreleased to extend and the buffer stays in one part
+        Proxy::Buffer wrapped;
+        wrapped.mFrameCount = frameCount - audioBuffer.frameCount;
+        if (mProxy->obtainWrapped(&wrapped) == NO_ERROR) {
+            buffer->raw[1] = wrapped.mRaw;
+            buffer->frames[1] = wrapped.mFrameCount;
+        }
+    }
+    buffer->frameCount = buffer->frames[0] + buffer->frames[1];
+    (void) getTimestamp(&buffer->timestamp);
+    return NO_ERROR;
+}
+
+void AudioRecord::releaseMappedBuffer(const MappedBuffer* buffer, size_t frameCount)
+{
+    if (buffer == NULL) {
+        return;
+    }
+    if (frameCount > buffer->frameCount) {
+        frameCount = buffer->frameCount;
+    }
+    Buffer audioBuffer;
+    audioBuffer.frameCount = frameCount;
+    audioBuffer.size = frameCount * mFrameSize;
+    audioBuffer.raw = const_cast<void *>(buffer->raw[0]);
+    releaseBuffer(&audioBuffer);
+    mFramesRead += frameCount;
+}
+
 audio_io_handle_t AudioRecord::getInputPrivate() const
 {
     AutoMutex lock(mLock);
@@ -452,6 +452,13 @@ status_t AudioSystem::getFrameCountHAL(audio_io_handle_t ioHandle,
     return NO_ERROR;
 }
 
+status_t AudioSystem::prewarmOutput(audio_io_handle_t ioHandle)
+{
+    const sp<IAudioFlinger>& af = AudioSystem::get_audio_flinger();
+    if (af == 0) return PERMISSION_DENIED;
+    return af->prewarmOutput(ioHandle);
+}
+
 // ---------------------------------------------------------------------------
 
 
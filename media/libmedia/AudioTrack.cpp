@@ -24,6 +24,7 @@
 
 #include <audio_utils/primitives.h>
 #include <binder/IPCThreadState.h>
+#include <cutils/properties.h>
 #include <media/AudioTrack.h>
 #include <utils/Log.h>
 #include <private/media/AudioTrackShared.h>
@@ -31,6 +32,8 @@
 #include <media/AudioPolicyHelper.h>
 #include <media/AudioResamplerPublic.h>
 
+#include "AudioTrackCallbackPool.h"
+
 #define WAIT_PERIOD_MS                  10
 #define WAIT_STREAM_END_TIMEOUT_SEC     120
 static const int kMaxLoopCountNotifications = 32;
@@ -302,6 +305,11 @@ status_t AudioTrack::set(
 
     mThreadCanCallJava = threadCanCallJava;
 
+    const bool pooledCallback = transferType == TRANSFER_CALLBACK_POOLED;
+    if (pooledCallback) {
+        transferType = TRANSFER_CALLBACK;
+    }
+
     switch (transferType) {
     case TRANSFER_DEFAULT:
         if (sharedBuffer != 0) {
@@ -497,7 +505,19 @@ status_t AudioTrack::set(
     mOrigFlags = mFlags = flags;
     mCbf = cbf;
 
-    if (cbf != NULL) {
+    // A callback may only be serviced by the pool if it does not need to block:
+    // fast tracks need their own thread for the priority boost, and offloaded and direct
+    // tracks wait for the server in processAudioBuffer().
+    mPooledCallback = pooledCallback && cbf != NULL && !threadCanCallJava
+            && audio_has_proportional_frames(mFormat)
+            && !(mFlags & (AUDIO_OUTPUT_FLAG_FAST | AUDIO_OUTPUT_FLAG_DIRECT
+                    | AUDIO_OUTPUT_FLAG_COMPRESS_OFFLOAD));
+    ALOGV_IF(pooledCallback && !mPooledCallback, "TRANSFER_CALLBACK_POOLED uses a thread");
+    if (mPooledCallback) {
+        mAudioTrackThread = new AudioTrackThread(*this, threadCanCallJava,
+                AudioTrackCallbackPool::get());
+        // the pool task begins paused, like the thread below
+    } else if (cbf != NULL) {
         mAudioTrackThread = new AudioTrackThread(*this, threadCanCallJava);
         mAudioTrackThread->run("AudioTrack", ANDROID_PRIORITY_AUDIO, 0 /*stack*/);
         // thread begins in paused state, and will not reference us until start()
@@ -1522,6 +1542,15 @@ status_t AudioTrack::createTrack_l()
         mProxy = mStaticProxy;
     }
 
+    // A fast track is refilled every server period, often from a tight callback, so it may
+    // opt in to polling for the server in obtainBuffer() rather than always blocking.
+    if (mFlags & AUDIO_OUTPUT_FLAG_FAST) {
+        const int32_t spinWaitUs = property_get_int32("audio.track.fast_spin_wait_us", 0);
+        if (spinWaitUs > 0) {
+            mProxy->setSpinWait((nsecs_t) spinWaitUs * 1000);
+        }
+    }
+
     mProxy->setVolumeLR(gain_minifloat_pack(
             gain_from_float(mVolume[AUDIO_INTERLEAVE_LEFT]),
             gain_from_float(mVolume[AUDIO_INTERLEAVE_RIGHT])));
@@ -2016,7 +2045,10 @@ nsecs_t AudioTrack::processAudioBuffer()
 
     struct timespec timeout;
     const struct timespec *requested = &ClientProxy::kForever;
-    if (ns != NS_WHENEVER) {
+    if (mPooledCallback) {
+        // the pool thread is shared, so poll and let the pool call again when space is due
+        requested = &ClientProxy::kNonBlocking;
+    } else if (ns != NS_WHENEVER) {
         timeout.tv_sec = ns / 1000000000LL;
         timeout.tv_nsec = ns % 1000000000LL;
         ALOGV("timeout %ld.%03d", timeout.tv_sec, (int) timeout.tv_nsec / 1000000);
@@ -2037,6 +2069,13 @@ nsecs_t AudioTrack::processAudioBuffer()
         ALOGV("obtainBuffer(%u) returned %zu = %zu + %zu err %d",
                 mRemainingFrames, avail, audioBuffer.frameCount, nonContig, err);
         if (err != NO_ERROR) {
+            if (err == WOULD_BLOCK && mPooledCallback) {
+                // the buffer is full, so space for mRemainingFrames is due when the server
+                // has consumed them, unless an event is due earlier
+                const nsecs_t spaceNs =
+                        framesToNanoseconds(mRemainingFrames, sampleRate, speed);
+                return ns >= 0 && ns < spaceNs ? ns : spaceNs;
+            }
             if (err == TIMED_OUT || err == WOULD_BLOCK || err == -EINTR ||
                     (isOffloaded() && (err == DEAD_OBJECT))) {
                 // FIXME bug 25195759
@@ -2584,6 +2623,12 @@ status_t AudioTrack::dump(int fd, const Vector<String16>& args __unused) const
     result.append(buffer);
     snprintf(buffer, 255, "  state(%d), latency (%d)\n", mState, mLatency);
     result.append(buffer);
+    if (mProxy != 0) {
+        uint32_t spinHits, futexWaits;
+        mProxy->getWaitCounts(&spinHits, &futexWaits);
+        snprintf(buffer, 255, "  spin hits(%u), futex waits(%u)\n", spinHits, futexWaits);
+        result.append(buffer);
+    }
     ::write(fd, result.string(), result.size());
     return NO_ERROR;
 }
@@ -2710,10 +2755,20 @@ void AudioTrack::DeathNotifier::binderDied(const wp<IBinder>& who __unused)
 
 // =========================================================================
 
-AudioTrack::AudioTrackThread::AudioTrackThread(AudioTrack& receiver, bool bCanCallJava)
-    : Thread(bCanCallJava), mReceiver(receiver), mPaused(true), mPausedInt(false), mPausedNs(0LL),
-      mIgnoreNextPausedInt(false)
+AudioTrack::AudioTrackThread::AudioTrackThread(AudioTrack& receiver, bool bCanCallJava,
+        const sp<AudioTrackCallbackPool>& pool)
+    : Thread(bCanCallJava), mReceiver(receiver), mPool(pool), mPaused(true), mPausedInt(false),
+      mPausedNs(0LL), mIgnoreNextPausedInt(false)
+{
+    if (mPool != 0) {
+        mPool->add(this, servicePooled);
+    }
+}
+
+/*static*/ nsecs_t AudioTrack::AudioTrackThread::servicePooled(void *cookie)
 {
+    AudioTrackThread *thread = (AudioTrackThread *) cookie;
+    return thread->mReceiver.processAudioBuffer();
 }
 
 AudioTrack::AudioTrackThread::~AudioTrackThread()
@@ -2768,6 +2823,11 @@ bool AudioTrack::AudioTrackThread::threadLoop()
 
 void AudioTrack::AudioTrackThread::requestExit()
 {
+    if (mPool != 0) {
+        // the thread was never run, so requestExitAndWait() returns immediately
+        mPool->remove(this);
+        return;
+    }
     // must be in this order to avoid a race condition
     Thread::requestExit();
     resume();
@@ -2775,12 +2835,20 @@ void AudioTrack::AudioTrackThread::requestExit()
 
 void AudioTrack::AudioTrackThread::pause()
 {
+    if (mPool != 0) {
+        mPool->pause(this);
+        return;
+    }
     AutoMutex _l(mMyLock);
     mPaused = true;
 }
 
 void AudioTrack::AudioTrackThread::resume()
 {
+    if (mPool != 0) {
+        mPool->resume(this);
+        return;
+    }
     AutoMutex _l(mMyLock);
     mIgnoreNextPausedInt = true;
     if (mPaused || mPausedInt) {
@@ -2792,6 +2860,10 @@ void AudioTrack::AudioTrackThread::resume()
 
 void AudioTrack::AudioTrackThread::wake()
 {
+    if (mPool != 0) {
+        mPool->wake(this);
+        return;
+    }
     AutoMutex _l(mMyLock);
     if (!mPaused) {
         // wake() might be called while servicing a callback - ignore the next
@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "AudioTrackCallbackPool"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <cutils/properties.h>
+#include <utils/Log.h>
+
+#include "AudioTrackCallbackPool.h"
+
+namespace android {
+
+static Mutex gPoolLock;
+static sp<AudioTrackCallbackPool> gPool;
+
+// upper limit of property audio.track.callback_pool_threads
+static const int32_t kMaxPoolThreads = 8;
+
+/*static*/ sp<AudioTrackCallbackPool> AudioTrackCallbackPool::get()
+{
+    Mutex::Autolock _l(gPoolLock);
+    if (gPool == 0) {
+        int32_t threadCount = property_get_int32("audio.track.callback_pool_threads", 1);
+        const long cpus = sysconf(_SC_NPROCESSORS_CONF);
+        if (cpus > 0 && threadCount > cpus) {
+            threadCount = cpus;
+        }
+        if (threadCount > kMaxPoolThreads) {
+            threadCount = kMaxPoolThreads;
+        } else if (threadCount < 1) {
+            threadCount = 1;
+        }
+        gPool = new AudioTrackCallbackPool(threadCount);
+    }
+    return gPool;
+}
+
+AudioTrackCallbackPool::AudioTrackCallbackPool(size_t threadCount)
+{
+    for (size_t i = 0; i < threadCount; i++) {
+        sp<Worker> worker = new Worker();
+        char name[32];
+        snprintf(name, sizeof(name), "AudioTrackPool%zu", i);
+        if (worker->run(name, ANDROID_PRIORITY_AUDIO) != NO_ERROR) {
+            ALOGW("cannot start callback pool thread %s", name);
+            continue;
+        }
+        mWorkers.add(worker);
+    }
+    LOG_ALWAYS_FATAL_IF(mWorkers.isEmpty(), "no callback pool thread");
+}
+
+void AudioTrackCallbackPool::add(void *cookie, service_t service)
+{
+    Mutex::Autolock _l(mLock);
+    size_t best = 0;
+    size_t bestCount = mWorkers[0]->taskCount();
+    for (size_t i = 1; i < mWorkers.size() && bestCount > 0; i++) {
+        const size_t count = mWorkers[i]->taskCount();
+        if (count < bestCount) {
+            best = i;
+            bestCount = count;
+        }
+    }
+    mAssignment.add(cookie, best);
+    mWorkers[best]->add(cookie, service);
+}
+
+void AudioTrackCallbackPool::remove(void *cookie)
+{
+    sp<Worker> worker;
+    {
+        Mutex::Autolock _l(mLock);
+        const ssize_t index = mAssignment.indexOfKey(cookie);
+        if (index < 0) {
+            return;
+        }
+        worker = mWorkers[mAssignment.valueAt(index)];
+        mAssignment.removeItemsAt(index);
+    }
+    // without mLock, as this may wait for a call of the task, which may use the pool
+    worker->remove(cookie);
+}
+
+void AudioTrackCallbackPool::pause(void *cookie)
+{
+    Mutex::Autolock _l(mLock);
+    const ssize_t index = mAssignment.indexOfKey(cookie);
+    if (index >= 0) {
+        mWorkers[mAssignment.valueAt(index)]->pause(cookie);
+    }
+}
+
+void AudioTrackCallbackPool::resume(void *cookie)
+{
+    Mutex::Autolock _l(mLock);
+    const ssize_t index = mAssignment.indexOfKey(cookie);
+    if (index >= 0) {
+        mWorkers[mAssignment.valueAt(index)]->resume(cookie);
+    }
+}
+
+void AudioTrackCallbackPool::wake(void *cookie)
+{
+    Mutex::Autolock _l(mLock);
+    const ssize_t index = mAssignment.indexOfKey(cookie);
+    if (index >= 0) {
+        mWorkers[mAssignment.valueAt(index)]->wake(cookie);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+AudioTrackCallbackPool::Worker::Worker()
+    : Thread(false /*canCallJava*/), mRunning(NULL)
+{
+}
+
+size_t AudioTrackCallbackPool::Worker::taskCount() const
+{
+    Mutex::Autolock _l(mLock);
+    return mTasks.size();
+}
+
+ssize_t AudioTrackCallbackPool::Worker::indexOf_l(void *cookie) const
+{
+    for (size_t i = 0; i < mTasks.size(); i++) {
+        if (mTasks[i].mCookie == cookie) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void AudioTrackCallbackPool::Worker::add(void *cookie, service_t service)
+{
+    Task task;
+    task.mCookie = cookie;
+    task.mService = service;
+    task.mState = TASK_INACTIVE;
+    task.mDeadlineNs = 0;
+    task.mPaused = true;
+    task.mWakePending = false;
+    Mutex::Autolock _l(mLock);
+    mTasks.add(task);
+}
+
+void AudioTrackCallbackPool::Worker::remove(void *cookie)
+{
+    Mutex::Autolock _l(mLock);
+    const ssize_t index = indexOf_l(cookie);
+    if (index >= 0) {
+        mTasks.removeAt(index);
+    }
+    // the task may still be running; its call must complete before its track is destroyed
+    while (mRunning == cookie && getTid() != gettid()) {
+        mIdleCond.wait(mLock);
+    }
+}
+
+void AudioTrackCallbackPool::Worker::pause(void *cookie)
+{
+    Mutex::Autolock _l(mLock);
+    const ssize_t index = indexOf_l(cookie);
+    if (index >= 0) {
+        mTasks.editItemAt(index).mPaused = true;
+    }
+}
+
+void AudioTrackCallbackPool::Worker::resume(void *cookie)
+{
+    Mutex::Autolock _l(mLock);
+    const ssize_t index = indexOf_l(cookie);
+    if (index < 0) {
+        return;
+    }
+    Task& task = mTasks.editItemAt(index);
+    task.mPaused = false;
+    task.mWakePending = true;
+    if (task.mState != TASK_DONE) {
+        task.mState = TASK_READY;
+        task.mDeadlineNs = 0;
+    }
+    mCond.signal();
+}
+
+void AudioTrackCallbackPool::Worker::wake(void *cookie)
+{
+    Mutex::Autolock _l(mLock);
+    const ssize_t index = indexOf_l(cookie);
+    if (index < 0) {
+        return;
+    }
+    Task& task = mTasks.editItemAt(index);
+    if (task.mPaused) {
+        return;
+    }
+    // like AudioTrackThread::wake(), this does not restart an inactive task
+    task.mWakePending = true;
+    if (task.mState == TASK_READY) {
+        task.mDeadlineNs = 0;
+        mCond.signal();
+    }
+}
+
+void AudioTrackCallbackPool::Worker::requestExit()
+{
+    // must call base class
+    Thread::requestExit();
+    Mutex::Autolock _l(mLock);
+    mCond.signal();
+}
+
+void AudioTrackCallbackPool::Worker::reschedule_l(Task& task, nsecs_t ns, nsecs_t now)
+{
+    if (ns == NS_NEVER) {
+        task.mState = TASK_DONE;
+        return;
+    }
+    // a change of state while running cancels the wait the task asked for,
+    // as mIgnoreNextPausedInt does for AudioTrackThread
+    if (task.mWakePending) {
+        task.mWakePending = false;
+        ns = 0;
+    }
+    switch (ns) {
+    case NS_INACTIVE:
+        task.mState = TASK_INACTIVE;
+        break;
+    case NS_WHENEVER:
+        task.mState = TASK_READY;
+        task.mDeadlineNs = INT64_MAX;
+        break;
+    default:
+        LOG_ALWAYS_FATAL_IF(ns < 0, "callback returned %lld", (long long) ns);
+        task.mState = TASK_READY;
+        task.mDeadlineNs = now + ns;
+        break;
+    }
+}
+
+bool AudioTrackCallbackPool::Worker::threadLoop()
+{
+    Mutex::Autolock _l(mLock);
+    if (exitPending()) {
+        return false;
+    }
+    // find the ready task with the earliest deadline
+    ssize_t next = -1;
+    for (size_t i = 0; i < mTasks.size(); i++) {
+        const Task& task = mTasks[i];
+        if (task.mPaused || task.mState != TASK_READY) {
+            continue;
+        }
+        if (next < 0 || task.mDeadlineNs < mTasks[next].mDeadlineNs) {
+            next = i;
+        }
+    }
+    if (next < 0 || mTasks[next].mDeadlineNs == INT64_MAX) {
+        mCond.wait(mLock);
+        return true;
+    }
+    nsecs_t now = systemTime();
+    if (mTasks[next].mDeadlineNs > now) {
+        (void) mCond.waitRelative(mLock, mTasks[next].mDeadlineNs - now);
+        return true;
+    }
+
+    Task& task = mTasks.editItemAt(next);
+    task.mWakePending = false;
+    void * const cookie = task.mCookie;
+    const service_t service = task.mService;
+    mRunning = cookie;
+    mLock.unlock();
+    const nsecs_t ns = service(cookie);
+    mLock.lock();
+    mRunning = NULL;
+    mIdleCond.broadcast();
+
+    // the task may have been removed, and other tasks added, while it was running
+    const ssize_t index = indexOf_l(cookie);
+    if (index >= 0) {
+        now = systemTime();
+        reschedule_l(mTasks.editItemAt(index), ns, now);
+    }
+    return true;
+}
+
+}   // namespace android
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_TRACK_CALLBACK_POOL_H
+#define ANDROID_AUDIO_TRACK_CALLBACK_POOL_H
+
+#include <utils/Condition.h>
+#include <utils/KeyedVector.h>
+#include <utils/Mutex.h>
+#include <utils/RefBase.h>
+#include <utils/Thread.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+// AudioTrackCallbackPool runs the callbacks of many AudioTrack::TRANSFER_CALLBACK_POOLED
+// tracks of a process on a few shared threads, rather than on one AudioTrackThread per track.
+//
+// Each task is assigned to the worker thread with the fewest tasks when it is added.
+// A worker runs its ready tasks in deadline order.  The return value of a task has the
+// meaning of the return value of AudioTrack::processAudioBuffer(), and the scheduling
+// operations have the semantics of AudioTrackThread::pause(), resume() and wake().
+// Since a worker runs one task at a time, a task must not block: pooled tracks obtain
+// their buffers without waiting, and return the time at which to try again.
+class AudioTrackCallbackPool : public RefBase {
+public:
+    typedef nsecs_t (*service_t)(void *cookie);
+
+    // see AudioTrack::processAudioBuffer()
+    static const nsecs_t NS_WHENEVER = -1, NS_INACTIVE = -2, NS_NEVER = -3;
+
+    // Returns the pool of the process, which is created on first use with the number of
+    // threads of property audio.track.callback_pool_threads, 1 by default.
+    static sp<AudioTrackCallbackPool> get();
+
+    // Adds a task identified by cookie, initially paused.
+    void        add(void *cookie, service_t service);
+
+    // Removes the task.  Waits for a running call of the task to return, unless called
+    // from that call.
+    void        remove(void *cookie);
+
+    void        pause(void *cookie);    // suspend the task at its next completion
+    void        resume(void *cookie);   // run the task as soon as possible
+    void        wake(void *cookie);     // like resume(), unless paused or inactive
+
+private:
+    explicit AudioTrackCallbackPool(size_t threadCount);
+
+    class Worker : public Thread {
+    public:
+        Worker();
+
+        void        add(void *cookie, service_t service);
+        void        remove(void *cookie);
+        void        pause(void *cookie);
+        void        resume(void *cookie);
+        void        wake(void *cookie);
+        size_t      taskCount() const;
+
+        // Thread virtuals
+        virtual void requestExit();
+
+    private:
+        virtual bool threadLoop();
+
+        enum task_state {
+            TASK_READY,         // run at mDeadlineNs
+            TASK_INACTIVE,      // run after resume()
+            TASK_DONE,          // never run again
+        };
+
+        struct Task {
+            void       *mCookie;
+            service_t   mService;
+            task_state  mState;
+            nsecs_t     mDeadlineNs;    // INT64_MAX for "whenever", that is until wake()
+            bool        mPaused;        // by pause(), until resume()
+            bool        mWakePending;   // resume() or wake() was called while running
+        };
+
+        ssize_t     indexOf_l(void *cookie) const;
+        // reschedules a task after it ran and returned ns
+        void        reschedule_l(Task& task, nsecs_t ns, nsecs_t now);
+
+        mutable Mutex       mLock;
+        Condition           mCond;          // signaled on a scheduling change, or on exit
+        Condition           mIdleCond;      // signaled when a call of a task returns
+        Vector<Task>        mTasks;         // protected by mLock
+        void               *mRunning;       // cookie of the running task, or NULL
+    };
+
+    Mutex                   mLock;
+    Vector< sp<Worker> >    mWorkers;
+    KeyedVector<void *, size_t> mAssignment;    // protected by mLock, cookie to worker index
+};
+
+}   // namespace android
+
+#endif  // ANDROID_AUDIO_TRACK_CALLBACK_POOL_H
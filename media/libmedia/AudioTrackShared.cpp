@@ -71,6 +71,10 @@ ClientProxy::ClientProxy(audio_track_cblk_t* cblk, void *buffers, size_t frameCo
     : Proxy(cblk, buffers, frameCount, frameSize, isOut, clientInServer)
     , mEpoch(0)
     , mTimestampObserver(&cblk->mExtendedTimestampQueue)
+    , mMaxSpinNs(0)
+    , mWaitEstimateNs(0)
+    , mSpinHits(0)
+    , mFutexWaits(0)
 {
     setBufferSizeInFrames(frameCount);
 }
@@ -80,6 +84,44 @@ const struct timespec ClientProxy::kNonBlocking = {0 /*tv_sec*/, 0 /*tv_nsec*/};
 
 #define MEASURE_NS 10000000 // attempt to provide accurate timeouts if requested >= MEASURE_NS
 
+// Lets a sibling hardware thread run while polling.
+static inline void cpuRelax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#endif
+}
+
+nsecs_t ClientProxy::spinBudgetNs() const
+{
+    if (mMaxSpinNs == 0) {
+        return 0;
+    }
+    // until a wait has been observed, try the maximum
+    if (mWaitEstimateNs == 0) {
+        return mMaxSpinNs;
+    }
+    if (mWaitEstimateNs > mMaxSpinNs) {
+        return 0;
+    }
+    // leave some margin for the jitter of the server cadence
+    const nsecs_t budgetNs = mWaitEstimateNs + mWaitEstimateNs / 2;
+    return budgetNs < mMaxSpinNs ? budgetNs : mMaxSpinNs;
+}
+
+void ClientProxy::updateWaitEstimate(nsecs_t waitNs)
+{
+    // exponential moving average with weight 1/8, which follows a change of cadence
+    // within a few server periods
+    mWaitEstimateNs = mWaitEstimateNs == 0 ? waitNs
+            : mWaitEstimateNs + (waitNs - mWaitEstimateNs) / 8;
+    if (mWaitEstimateNs <= 0) {
+        mWaitEstimateNs = 1;
+    }
+}
+
 // To facilitate quicker recovery from server failure, this value limits the timeout per each futex
 // wait.  However it does not protect infinite timeouts.  If defined to be zero, there is no limit.
 // FIXME May not be compatible with audio tunneling requirements where timeout should be in the
@@ -140,6 +182,7 @@ status_t ClientProxy::obtainBuffer(Buffer* buffer, const struct timespec *reques
     bool beforeIsValid = false;
     audio_track_cblk_t* cblk = mCblk;
     bool ignoreInitialPendingInterrupt = true;
+    bool spun = false;  // polling is only attempted for the first wait of the call
     // check for shared memory corruption
     if (mIsShutdown) {
         status = NO_INIT;
@@ -270,7 +313,29 @@ status_t ClientProxy::obtainBuffer(Buffer* buffer, const struct timespec *reques
             ts = NULL;
             break;
         }
+        // The server sets CBLK_FUTEX_WAKE under the same conditions as it wakes the futex,
+        // so polling for it is equivalent to the futex wait, without the syscall.
+        // The elapsed time is not accounted, as polling is bounded by a small mMaxSpinNs.
+        nsecs_t waitStartNs = 0;    // non-zero if this wait is timed for the estimate
+        bool polled = false;
+        if (mMaxSpinNs > 0) {
+            waitStartNs = systemTime();
+            const nsecs_t budgetNs = spun ? 0 : spinBudgetNs();
+            spun = true;
+            if (budgetNs > 0
+                    && !(android_atomic_acquire_load(&cblk->mFutex) & CBLK_FUTEX_WAKE)) {
+                polled = true;
+                while (!(android_atomic_acquire_load(&cblk->mFutex) & CBLK_FUTEX_WAKE)
+                        && systemTime() - waitStartNs < budgetNs) {
+                    cpuRelax();
+                }
+            }
+        }
         int32_t old = android_atomic_and(~CBLK_FUTEX_WAKE, &cblk->mFutex);
+        if (polled && (old & CBLK_FUTEX_WAKE)) {
+            mSpinHits++;
+            updateWaitEstimate(systemTime() - waitStartNs);
+        }
         if (!(old & CBLK_FUTEX_WAKE)) {
             if (measure && !beforeIsValid) {
                 clock_gettime(CLOCK_MONOTONIC, &before);
@@ -280,6 +345,12 @@ status_t ClientProxy::obtainBuffer(Buffer* buffer, const struct timespec *reques
             (void) syscall(__NR_futex, &cblk->mFutex,
                     mClientInServer ? FUTEX_WAIT_PRIVATE : FUTEX_WAIT, old & ~CBLK_FUTEX_WAKE, ts);
             status_t error = errno; // clock_gettime can affect errno
+            if (waitStartNs != 0) {
+                mFutexWaits++;
+                if (error == 0 || error == EWOULDBLOCK) {
+                    updateWaitEstimate(systemTime() - waitStartNs);
+                }
+            }
             // update total elapsed time spent waiting
             if (measure) {
                 struct timespec after;
@@ -612,6 +683,33 @@ void StaticAudioTrackClientProxy::getBufferPositionAndLoopCount(
 
 // ---------------------------------------------------------------------------
 
+status_t AudioRecordClientProxy::obtainWrapped(Buffer* buffer)
+{
+    LOG_ALWAYS_FATAL_IF(buffer == NULL || buffer->mFrameCount == 0);
+    audio_track_cblk_t* cblk = mCblk;
+    int32_t front = cblk->u.mStreaming.mFront;
+    int32_t rear = android_atomic_acquire_load(&cblk->u.mStreaming.mRear);
+    ssize_t filled = rear - front;
+    size_t part2 = 0;
+    // only the frames of the most recent obtainBuffer() ending at the end of the buffers
+    // can be extended; an overrun since then is left to the next obtainBuffer() to recover
+    if (!mIsShutdown && mUnreleased > 0 &&
+            ((front + mUnreleased) & (mFrameCountP2 - 1)) == 0 &&
+            0 <= filled && (size_t) filled <= mFrameCount) {
+        part2 = filled - mUnreleased;
+        if (part2 > buffer->mFrameCount) {
+            part2 = buffer->mFrameCount;
+        }
+    }
+    buffer->mFrameCount = part2;
+    buffer->mRaw = part2 > 0 ? mBuffers : NULL;
+    buffer->mNonContig = 0;
+    mUnreleased += part2;
+    return part2 > 0 ? NO_ERROR : WOULD_BLOCK;
+}
+
+// ---------------------------------------------------------------------------
+
 ServerProxy::ServerProxy(audio_track_cblk_t* cblk, void *buffers, size_t frameCount,
         size_t frameSize, bool isOut, bool clientInServer)
     : Proxy(cblk, buffers, frameCount, frameSize, isOut, clientInServer),
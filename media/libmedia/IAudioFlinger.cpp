@@ -83,6 +83,9 @@ enum {
     GET_AUDIO_HW_SYNC,
     SYSTEM_READY,
     FRAME_COUNT_HAL,
+    LIST_UID_MIXER_USAGE,
+    CREATE_TRACKS,
+    PREWARM_OUTPUT,
 };
 
 #define MAX_ITEMS_PER_LIST 1024
@@ -929,6 +932,93 @@ public:
         }
         return reply.readInt64();
     }
+    virtual status_t listUidMixerUsage(unsigned int *num_usages,
+                                       struct AudioUidMixerUsage *usages)
+    {
+        if (num_usages == NULL || *num_usages == 0 || usages == NULL) {
+            return BAD_VALUE;
+        }
+        Parcel data, reply;
+        data.writeInterfaceToken(IAudioFlinger::getInterfaceDescriptor());
+        data.writeInt32(*num_usages);
+        status_t status = remote()->transact(LIST_UID_MIXER_USAGE, data, &reply);
+        if (status != NO_ERROR ||
+                (status = (status_t)reply.readInt32()) != NO_ERROR) {
+            return status;
+        }
+        *num_usages = (unsigned int)reply.readInt32();
+        reply.read(usages, *num_usages * sizeof(struct AudioUidMixerUsage));
+        return status;
+    }
+
+    virtual status_t createTracks(Vector<AudioTrackCreateArgs>& args,
+                                  pid_t pid,
+                                  int clientUid,
+                                  bool start)
+    {
+        if (args.isEmpty() || args.size() > kMaxCreateTracks) {
+            return BAD_VALUE;
+        }
+        Parcel data, reply;
+        data.writeInterfaceToken(IAudioFlinger::getInterfaceDescriptor());
+        data.writeInt32((int32_t) pid);
+        data.writeInt32(clientUid);
+        data.writeInt32(start);
+        data.writeInt32(args.size());
+        for (size_t i = 0; i < args.size(); i++) {
+            const AudioTrackCreateArgs& arg = args[i];
+            data.writeInt32((int32_t) arg.mStreamType);
+            data.writeInt32(arg.mSampleRate);
+            data.writeInt32(arg.mFormat);
+            data.writeInt32(arg.mChannelMask);
+            data.writeInt64(arg.mFrameCount);
+            data.writeInt32(arg.mFlags);
+            // haveSharedBuffer
+            if (arg.mSharedBuffer != 0) {
+                data.writeInt32(true);
+                data.writeStrongBinder(IInterface::asBinder(arg.mSharedBuffer));
+            } else {
+                data.writeInt32(false);
+            }
+            data.writeInt32((int32_t) arg.mOutput);
+            data.writeInt32((int32_t) arg.mTid);
+            data.writeInt32(arg.mSessionId);
+        }
+        status_t status = remote()->transact(CREATE_TRACKS, data, &reply);
+        if (status != NO_ERROR ||
+                (status = (status_t)reply.readInt32()) != NO_ERROR) {
+            ALOGE("createTracks error: %s", strerror(-status));
+            return status;
+        }
+        for (size_t i = 0; i < args.size(); i++) {
+            AudioTrackCreateArgs& arg = args.editItemAt(i);
+            arg.mFrameCount = reply.readInt64();
+            arg.mFlags = (audio_output_flags_t) reply.readInt32();
+            arg.mSessionId = (audio_session_t) reply.readInt32();
+            arg.mStatus = reply.readInt32();
+            arg.mStartStatus = reply.readInt32();
+            arg.mTrack = interface_cast<IAudioTrack>(reply.readStrongBinder());
+            if (arg.mStatus == NO_ERROR) {
+                if (arg.mTrack == 0) {
+                    ALOGE("createTracks should have returned an IAudioTrack for track %zu", i);
+                    arg.mStatus = UNKNOWN_ERROR;
+                }
+            } else if (arg.mTrack != 0) {
+                ALOGE("createTracks returned an IAudioTrack for track %zu but with status %d",
+                        i, arg.mStatus);
+                arg.mTrack.clear();
+            }
+        }
+        return status;
+    }
+
+    virtual status_t prewarmOutput(audio_io_handle_t output)
+    {
+        Parcel data, reply;
+        data.writeInterfaceToken(IAudioFlinger::getInterfaceDescriptor());
+        data.writeInt32((int32_t) output);
+        return remote()->transact(PREWARM_OUTPUT, data, &reply, IBinder::FLAG_ONEWAY);
+    }
 
 };
 
@@ -1449,6 +1539,92 @@ status_t BnAudioFlinger::onTransact(
             reply->writeInt64( frameCountHAL((audio_io_handle_t) data.readInt32()) );
             return NO_ERROR;
         } break;
+        case LIST_UID_MIXER_USAGE: {
+            CHECK_INTERFACE(IAudioFlinger, data, reply);
+            unsigned int numUsagesReq = data.readInt32();
+            if (numUsagesReq > MAX_ITEMS_PER_LIST) {
+                numUsagesReq = MAX_ITEMS_PER_LIST;
+            }
+            unsigned int numUsages = numUsagesReq;
+            struct AudioUidMixerUsage *usages =
+                    (struct AudioUidMixerUsage *)calloc(numUsagesReq,
+                                                        sizeof(struct AudioUidMixerUsage));
+            if (usages == NULL) {
+                reply->writeInt32(NO_MEMORY);
+                reply->writeInt32(0);
+                return NO_ERROR;
+            }
+            status_t status = listUidMixerUsage(&numUsages, usages);
+            reply->writeInt32(status);
+            reply->writeInt32(numUsages);
+            if (status == NO_ERROR) {
+                if (numUsagesReq > numUsages) {
+                    numUsagesReq = numUsages;
+                }
+                reply->write(usages, numUsagesReq * sizeof(struct AudioUidMixerUsage));
+            }
+            free(usages);
+            return NO_ERROR;
+        } break;
+        case CREATE_TRACKS: {
+            CHECK_INTERFACE(IAudioFlinger, data, reply);
+            pid_t pid = (pid_t) data.readInt32();
+            int clientUid = data.readInt32();
+            bool start = data.readInt32() != 0;
+            size_t count = (size_t) data.readInt32();
+            if (count == 0 || count > kMaxCreateTracks) {
+                reply->writeInt32(BAD_VALUE);
+                return NO_ERROR;
+            }
+            Vector<AudioTrackCreateArgs> args;
+            args.resize(count);
+            bool sharedBufferError = false;
+            for (size_t i = 0; i < count; i++) {
+                AudioTrackCreateArgs& arg = args.editItemAt(i);
+                arg.mStreamType = (audio_stream_type_t) data.readInt32();
+                arg.mSampleRate = data.readInt32();
+                arg.mFormat = (audio_format_t) data.readInt32();
+                arg.mChannelMask = data.readInt32();
+                arg.mFrameCount = data.readInt64();
+                arg.mFlags = (audio_output_flags_t) data.readInt32();
+                bool haveSharedBuffer = data.readInt32() != 0;
+                if (haveSharedBuffer) {
+                    arg.mSharedBuffer = interface_cast<IMemory>(data.readStrongBinder());
+                    if (arg.mSharedBuffer == 0 || arg.mSharedBuffer->pointer() == NULL) {
+                        sharedBufferError = true;
+                    }
+                }
+                arg.mOutput = (audio_io_handle_t) data.readInt32();
+                arg.mTid = (pid_t) data.readInt32();
+                arg.mSessionId = (audio_session_t) data.readInt32();
+            }
+            status_t status;
+            if (sharedBufferError) {
+                ALOGW("CREATE_TRACKS: cannot retrieve shared memory");
+                status = DEAD_OBJECT;
+            } else {
+                status = createTracks(args, pid, clientUid, start);
+            }
+            reply->writeInt32(status);
+            if (status == NO_ERROR) {
+                for (size_t i = 0; i < count; i++) {
+                    const AudioTrackCreateArgs& arg = args[i];
+                    LOG_ALWAYS_FATAL_IF((arg.mTrack != 0) != (arg.mStatus == NO_ERROR));
+                    reply->writeInt64(arg.mFrameCount);
+                    reply->writeInt32(arg.mFlags);
+                    reply->writeInt32(arg.mSessionId);
+                    reply->writeInt32(arg.mStatus);
+                    reply->writeInt32(arg.mStartStatus);
+                    reply->writeStrongBinder(IInterface::asBinder(arg.mTrack));
+                }
+            }
+            return NO_ERROR;
+        } break;
+        case PREWARM_OUTPUT: {
+            CHECK_INTERFACE(IAudioFlinger, data, reply);
+            prewarmOutput((audio_io_handle_t) data.readInt32());
+            return NO_ERROR;
+        } break;
         default:
             return BBinder::onTransact(code, data, reply, flags);
     }
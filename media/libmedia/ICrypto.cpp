@@ -36,8 +36,35 @@ enum {
     DECRYPT,
     NOTIFY_RESOLUTION,
     SET_MEDIADRM_SESSION,
+    DECRYPT_SAMPLES,
 };
 
+// Returns the total size of the subsamples, or -EINVAL if they overflow or do not fit
+// in |sharedBuffer| at |offset|.
+static ssize_t getSubSamplesSize(
+        const sp<IMemory> &sharedBuffer, size_t offset,
+        const CryptoPlugin::SubSample *subSamples, size_t numSubSamples) {
+    size_t sumSubsampleSizes = 0;
+    for (size_t i = 0; i < numSubSamples; ++i) {
+        const CryptoPlugin::SubSample &ss = subSamples[i];
+        if (sumSubsampleSizes > SIZE_MAX - ss.mNumBytesOfEncryptedData) {
+            return -EINVAL;
+        }
+        sumSubsampleSizes += ss.mNumBytesOfEncryptedData;
+        if (sumSubsampleSizes > SIZE_MAX - ss.mNumBytesOfClearData) {
+            return -EINVAL;
+        }
+        sumSubsampleSizes += ss.mNumBytesOfClearData;
+    }
+
+    if (sumSubsampleSizes > sharedBuffer->size()
+            || offset > sharedBuffer->size() - sumSubsampleSizes
+            || sumSubsampleSizes > INT32_MAX) {
+        return -EINVAL;
+    }
+    return sumSubsampleSizes;
+}
+
 struct BpCrypto : public BpInterface<ICrypto> {
     BpCrypto(const sp<IBinder> &impl)
         : BpInterface<ICrypto>(impl) {
@@ -159,6 +186,74 @@ struct BpCrypto : public BpInterface<ICrypto> {
         return result;
     }
 
+    virtual status_t decryptSamples(
+            DestinationType dstType,
+            CryptoPlugin::Mode mode,
+            const CryptoPlugin::Pattern &pattern,
+            const sp<IMemory> &sharedBuffer,
+            const Vector<Sample> &samples,
+            Vector<ssize_t> *results,
+            AString *errorDetailMsg) {
+        results->clear();
+        if (dstType == kDestinationTypeNativeHandle) {
+            return -EINVAL;
+        }
+
+        Parcel data, reply;
+        data.writeInterfaceToken(ICrypto::getInterfaceDescriptor());
+        data.writeInt32((int32_t)dstType);
+        data.writeInt32(mode);
+        data.writeInt32(pattern.mEncryptBlocks);
+        data.writeInt32(pattern.mSkipBlocks);
+        data.writeStrongBinder(IInterface::asBinder(sharedBuffer));
+
+        data.writeInt32(samples.size());
+        for (size_t i = 0; i < samples.size(); ++i) {
+            const Sample &sample = samples[i];
+            data.write(sample.mKey, 16);
+            data.write(sample.mIv, 16);
+            data.writeInt32(sample.mOffset);
+            data.writeInt32(sample.mSubSamples.size());
+            data.write(sample.mSubSamples.array(),
+                    sizeof(CryptoPlugin::SubSample) * sample.mSubSamples.size());
+            if (dstType == kDestinationTypeOpaqueHandle) {
+                data.writeInt64(static_cast<uint64_t>(
+                        reinterpret_cast<uintptr_t>(sample.mDstPtr)));
+            }
+        }
+
+        status_t err = remote()->transact(DECRYPT_SAMPLES, data, &reply);
+        if (err != OK) {
+            return err;
+        }
+
+        status_t result = reply.readInt32();
+        size_t numResults = reply.readInt32();
+        if (numResults > samples.size()) {
+            return -EINVAL;
+        }
+        results->setCapacity(numResults);
+        for (size_t i = 0; i < numResults; ++i) {
+            results->push_back(reply.readInt32());
+        }
+        if (isCryptoError(result)) {
+            errorDetailMsg->setTo(reply.readCString());
+        }
+
+        if (dstType == kDestinationTypeVmPointer) {
+            // For the non-secure case, the decrypted data of each sample is returned
+            // in place in the shared memory
+            const uint8_t *base = static_cast<const uint8_t *>(sharedBuffer->pointer());
+            for (size_t i = 0; i < numResults; ++i) {
+                if ((*results)[i] > 0) {
+                    memcpy(samples[i].mDstPtr, base + samples[i].mOffset, (*results)[i]);
+                }
+            }
+        }
+
+        return result;
+    }
+
     virtual void notifyResolution(
         uint32_t width, uint32_t height) {
         Parcel data, reply;
@@ -326,27 +421,9 @@ status_t BnCrypto::onTransact(
             AString errorDetailMsg;
             ssize_t result;
 
-            size_t sumSubsampleSizes = 0;
-            bool overflow = false;
-            for (int32_t i = 0; i < numSubSamples; ++i) {
-                CryptoPlugin::SubSample &ss = subSamples[i];
-                if (sumSubsampleSizes <= SIZE_MAX - ss.mNumBytesOfEncryptedData) {
-                    sumSubsampleSizes += ss.mNumBytesOfEncryptedData;
-                } else {
-                    overflow = true;
-                }
-                if (sumSubsampleSizes <= SIZE_MAX - ss.mNumBytesOfClearData) {
-                    sumSubsampleSizes += ss.mNumBytesOfClearData;
-                } else {
-                    overflow = true;
-                }
-            }
-
-            if (overflow || sumSubsampleSizes != totalSize) {
-                result = -EINVAL;
-            } else if (totalSize > sharedBuffer->size()) {
-                result = -EINVAL;
-            } else if ((size_t)offset > sharedBuffer->size() - totalSize) {
+            ssize_t subSamplesSize = numSubSamples < 0 ? -EINVAL
+                    : getSubSamplesSize(sharedBuffer, offset, subSamples, numSubSamples);
+            if (subSamplesSize < 0 || (size_t)subSamplesSize != totalSize) {
                 result = -EINVAL;
             } else {
                 result = decrypt(
@@ -393,6 +470,116 @@ status_t BnCrypto::onTransact(
             return OK;
         }
 
+        case DECRYPT_SAMPLES:
+        {
+            CHECK_INTERFACE(ICrypto, data, reply);
+
+            DestinationType dstType = (DestinationType)data.readInt32();
+            CryptoPlugin::Mode mode = (CryptoPlugin::Mode)data.readInt32();
+            CryptoPlugin::Pattern pattern;
+            pattern.mEncryptBlocks = data.readInt32();
+            pattern.mSkipBlocks = data.readInt32();
+
+            sp<IMemory> sharedBuffer =
+                interface_cast<IMemory>(data.readStrongBinder());
+            int32_t numSamples = data.readInt32();
+            if (sharedBuffer == NULL || numSamples < 0
+                    || (dstType != kDestinationTypeVmPointer
+                            && dstType != kDestinationTypeOpaqueHandle)) {
+                reply->writeInt32(BAD_VALUE);
+                reply->writeInt32(0);
+                return OK;
+            }
+
+            // Non-secure samples are decrypted to one scratch buffer, then copied in
+            // place to the shared memory
+            Vector<Sample> samples;
+            Vector<size_t> sampleSizes;
+            size_t totalSize = 0;
+            status_t err = OK;
+            for (int32_t i = 0; i < numSamples; ++i) {
+                Sample sample;
+                if (data.dataAvail() < sizeof(sample.mKey) + sizeof(sample.mIv)
+                        + 2 * sizeof(int32_t)) {
+                    err = BAD_VALUE;
+                    break;
+                }
+                data.read(sample.mKey, sizeof(sample.mKey));
+                data.read(sample.mIv, sizeof(sample.mIv));
+                sample.mOffset = data.readInt32();
+                int32_t numSubSamples = data.readInt32();
+                if (numSubSamples < 0 || (size_t)numSubSamples
+                        > data.dataAvail() / sizeof(CryptoPlugin::SubSample)) {
+                    err = BAD_VALUE;
+                    break;
+                }
+                if (numSubSamples > 0) {
+                    sample.mSubSamples.insertAt((size_t)0, numSubSamples);
+                    data.read(sample.mSubSamples.editArray(),
+                            sizeof(CryptoPlugin::SubSample) * numSubSamples);
+                }
+                sample.mDstPtr = NULL;
+                if (dstType == kDestinationTypeOpaqueHandle) {
+                    sample.mDstPtr = reinterpret_cast<void *>(
+                            static_cast<uintptr_t>(data.readInt64()));
+                }
+
+                ssize_t size = getSubSamplesSize(sharedBuffer, sample.mOffset,
+                        sample.mSubSamples.array(), sample.mSubSamples.size());
+                if (size < 0 || totalSize > SIZE_MAX - size) {
+                    err = -EINVAL;
+                    break;
+                }
+                samples.push_back(sample);
+                sampleSizes.push_back(size);
+                totalSize += size;
+            }
+
+            uint8_t *scratch = NULL;
+            if (err == OK && dstType == kDestinationTypeVmPointer) {
+                scratch = static_cast<uint8_t *>(malloc(totalSize > 0 ? totalSize : 1));
+                if (scratch == NULL) {
+                    err = NO_MEMORY;
+                } else {
+                    size_t scratchOffset = 0;
+                    for (size_t i = 0; i < samples.size(); ++i) {
+                        samples.editItemAt(i).mDstPtr = scratch + scratchOffset;
+                        scratchOffset += sampleSizes[i];
+                    }
+                }
+            }
+
+            AString errorDetailMsg;
+            Vector<ssize_t> results;
+            if (err == OK) {
+                err = decryptSamples(dstType, mode, pattern, sharedBuffer, samples,
+                        &results, &errorDetailMsg);
+            }
+
+            reply->writeInt32(err);
+            reply->writeInt32(results.size());
+            for (size_t i = 0; i < results.size(); ++i) {
+                reply->writeInt32(results[i]);
+            }
+            if (isCryptoError(err)) {
+                reply->writeCString(errorDetailMsg.c_str());
+            }
+
+            if (scratch != NULL) {
+                uint8_t *base = static_cast<uint8_t *>(sharedBuffer->pointer());
+                for (size_t i = 0; i < results.size(); ++i) {
+                    if (results[i] > 0) {
+                        CHECK_LE(results[i], static_cast<ssize_t>(sampleSizes[i]));
+                        memcpy(base + samples[i].mOffset, samples[i].mDstPtr, results[i]);
+                    }
+                }
+                free(scratch);
+                scratch = NULL;
+            }
+
+            return OK;
+        }
+
         case NOTIFY_RESOLUTION:
         {
             CHECK_INTERFACE(ICrypto, data, reply);
@@ -36,6 +36,7 @@ enum {
     GET_FLAGS,
     TO_STRING,
     DRM_INITIALIZATION,
+    READ_AT_RANGES,
 };
 
 struct BpDataSource : public BpInterface<IDataSource> {
@@ -58,6 +59,28 @@ struct BpDataSource : public BpInterface<IDataSource> {
         return reply.readInt64();
     }
 
+    virtual status_t readAtRanges(
+            size_t count, const off64_t *offsets, const size_t *sizes, ssize_t *results) {
+        Parcel data, reply;
+        data.writeInterfaceToken(IDataSource::getInterfaceDescriptor());
+        data.writeInt32(count);
+        for (size_t i = 0; i < count; ++i) {
+            data.writeInt64(offsets[i]);
+            data.writeInt64(sizes[i]);
+        }
+        status_t err = remote()->transact(READ_AT_RANGES, data, &reply);
+        if (err == OK) {
+            err = reply.readInt32();
+        }
+        if (err != OK) {
+            return err;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            results[i] = reply.readInt64();
+        }
+        return OK;
+    }
+
     virtual status_t getSize(off64_t* size) {
         Parcel data, reply;
         data.writeInterfaceToken(IDataSource::getInterfaceDescriptor());
@@ -131,6 +154,12 @@ struct BpDataSource : public BpInterface<IDataSource> {
 
 IMPLEMENT_META_INTERFACE(DataSource, "android.media.IDataSource");
 
+status_t IDataSource::readAtRanges(
+        size_t /* count */, const off64_t * /* offsets */, const size_t * /* sizes */,
+        ssize_t * /* results */) {
+    return INVALID_OPERATION;
+}
+
 status_t BnDataSource::onTransact(
     uint32_t code, const Parcel& data, Parcel* reply, uint32_t flags) {
     switch (code) {
@@ -146,6 +175,29 @@ status_t BnDataSource::onTransact(
             reply->writeInt64(readAt(offset, size));
             return NO_ERROR;
         } break;
+        case READ_AT_RANGES: {
+            CHECK_INTERFACE(IDataSource, data, reply);
+            size_t count = (size_t) data.readInt32();
+            if (count > kMaxReadRanges) {
+                reply->writeInt32(BAD_VALUE);
+                return NO_ERROR;
+            }
+            off64_t offsets[kMaxReadRanges];
+            size_t sizes[kMaxReadRanges];
+            ssize_t results[kMaxReadRanges];
+            for (size_t i = 0; i < count; ++i) {
+                offsets[i] = (off64_t) data.readInt64();
+                sizes[i] = (size_t) data.readInt64();
+            }
+            status_t err = readAtRanges(count, offsets, sizes, results);
+            reply->writeInt32(err);
+            if (err == OK) {
+                for (size_t i = 0; i < count; ++i) {
+                    reply->writeInt64(results[i]);
+                }
+            }
+            return NO_ERROR;
+        } break;
         case GET_SIZE: {
             CHECK_INTERFACE(IDataSource, data, reply);
             off64_t size;
@@ -361,9 +361,31 @@ status_t BnMediaSource::onTransact(
                 size_t offset = buf->range_offset();
                 if (length >= (supportNonblockingRead() && buf->mMemory != nullptr ?
                         kTransferSharedAsSharedThreshold : kTransferInlineAsSharedThreshold)) {
-                    if (buf->mMemory != nullptr) {
+                    // A source that cannot read nonblocking may need its buffer back before it
+                    // can return the next one, so passing its buffer ends the batch. Unless it is
+                    // the last one anyway, copy it into one of our pooled buffers if one is free,
+                    // so that a batch of large buffers still takes a single transaction.
+                    const bool copyToPool = buf->mMemory != nullptr
+                            && !supportNonblockingRead()
+                            && bufferCount + 1 < maxNumBuffers
+                            && mGroup->has_buffers();
+                    if (buf->mMemory != nullptr && !copyToPool) {
                         ALOGV("Use shared memory: %zu", length);
                         transferBuf = buf;
+                    } else if (copyToPool) {
+                        if (mGroup->acquire_buffer(
+                                &transferBuf, true /* nonBlocking */, length) == OK
+                                && transferBuf != nullptr
+                                && transferBuf->mMemory != nullptr) {
+                            ALOGV("Copy to pooled shared memory: %zu", length);
+                            memcpy(transferBuf->data(), (uint8_t*)buf->data() + offset, length);
+                            offset = 0;
+                        } else {
+                            if (transferBuf != nullptr) {
+                                transferBuf->release();
+                            }
+                            transferBuf = buf;
+                        }
                     } else {
                         ALOGD("Large buffer %zu without IMemory!", length);
                         ret = mGroup->acquire_buffer(
@@ -62,6 +62,7 @@ enum {
     UPDATE_GRAPHIC_BUFFER_IN_META,
     CONFIGURE_VIDEO_TUNNEL_MODE,
     UPDATE_NATIVE_HANDLE_IN_META,
+    USE_BUFFERS,
 };
 
 class BpOMX : public BpInterface<IOMX> {
@@ -277,6 +278,33 @@ public:
         return err;
     }
 
+    virtual status_t useBuffers(
+            node_id node, OMX_U32 port_index, const Vector<sp<IMemory> > &params,
+            Vector<buffer_id> *buffers, OMX_U32 allottedSize) {
+        Parcel data, reply;
+        data.writeInterfaceToken(IOMX::getInterfaceDescriptor());
+        data.writeInt32((int32_t)node);
+        data.writeInt32(port_index);
+        data.writeInt32(allottedSize);
+        data.writeInt32(params.size());
+        for (size_t i = 0; i < params.size(); ++i) {
+            data.writeStrongBinder(IInterface::asBinder(params[i]));
+        }
+        buffers->clear();
+        status_t err = remote()->transact(USE_BUFFERS, data, &reply);
+        if (err != OK) {
+            return err;
+        }
+
+        err = reply.readInt32();
+        size_t count = reply.readInt32();
+        for (size_t i = 0; i < count && i < params.size(); ++i) {
+            buffers->push((buffer_id)reply.readInt32());
+        }
+
+        return err;
+    }
+
 
     virtual status_t useGraphicBuffer(
             node_id node, OMX_U32 port_index,
@@ -897,6 +925,39 @@ status_t BnOMX::onTransact(
             return NO_ERROR;
         }
 
+        case USE_BUFFERS:
+        {
+            CHECK_OMX_INTERFACE(IOMX, data, reply);
+
+            node_id node = (node_id)data.readInt32();
+            OMX_U32 port_index = data.readInt32();
+            OMX_U32 allottedSize = data.readInt32();
+            uint32_t count = data.readInt32();
+
+            // each buffer takes a binder object, so a bogus count runs out of data
+            Vector<sp<IMemory> > params;
+            for (uint32_t i = 0; i < count; ++i) {
+                sp<IMemory> mem = interface_cast<IMemory>(data.readStrongBinder());
+                if (mem == NULL) {
+                    ALOGE("useBuffers: missing buffer %u of %u", i, count);
+                    reply->writeInt32(INVALID_OPERATION);
+                    reply->writeInt32(0);
+                    return NO_ERROR;
+                }
+                params.push(mem);
+            }
+
+            Vector<buffer_id> buffers;
+            status_t err = useBuffers(node, port_index, params, &buffers, allottedSize);
+            reply->writeInt32(err);
+            reply->writeInt32(buffers.size());
+            for (size_t i = 0; i < buffers.size(); ++i) {
+                reply->writeInt32((int32_t)buffers[i]);
+            }
+
+            return NO_ERROR;
+        }
+
         case USE_GRAPHIC_BUFFER:
         {
             CHECK_OMX_INTERFACE(IOMX, data, reply);
@@ -47,6 +47,7 @@
 #include <media/stagefright/MediaCodecSource.h>
 #include <media/MediaProfiles.h>
 #include <camera/CameraParameters.h>
+#include <cutils/properties.h>
 
 #include <utils/Errors.h>
 #include <sys/types.h>
@@ -938,6 +939,15 @@ sp<MediaCodecSource> StagefrightRecorder::createAudioSource() {
         }
     }
 
+    // A fast capture input lowers the capture latency, which keeps the audio
+    // closer in sync with the camera. It is opt-in as not all inputs support it.
+    audio_input_flags_t flags = AUDIO_INPUT_FLAG_NONE;
+    char value[PROPERTY_VALUE_MAX];
+    if (property_get("media.stagefright.fast-audio-input", value, NULL)
+            && (!strcmp(value, "1") || !strcasecmp(value, "true"))) {
+        flags = AUDIO_INPUT_FLAG_FAST;
+    }
+
     sp<AudioSource> audioSource =
         new AudioSource(
                 mAudioSource,
@@ -946,7 +956,8 @@ sp<MediaCodecSource> StagefrightRecorder::createAudioSource() {
                 mAudioChannels,
                 mSampleRate,
                 mClientUid,
-                mClientPid);
+                mClientPid,
+                flags);
 
     status_t err = audioSource->initCheck();
 
@@ -1622,6 +1633,11 @@ status_t StagefrightRecorder::setupVideoEncoder(
     } else {
         // require dataspace setup even if not using surface input
         format->setInt32("android._using-recorder", 1);
+
+        // streamed output is consumed live, so feed camera frames without a looper hop
+        if (mOutputFormat == OUTPUT_FORMAT_RTP_AVP || mOutputFormat == OUTPUT_FORMAT_MPEG2TS) {
+            flags |= MediaCodecSource::FLAG_LOW_LATENCY;
+        }
     }
 
     sp<MediaCodecSource> encoder = MediaCodecSource::Create(
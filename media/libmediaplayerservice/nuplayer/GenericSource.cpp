@@ -352,6 +352,8 @@ NuPlayer::GenericSource::~GenericSource() {
         mLooper->unregisterHandler(id());
         mLooper->stop();
     }
+    stopReader(&mAudioTrack);
+    stopReader(&mVideoTrack);
     resetDataSource();
 }
 
@@ -362,6 +364,9 @@ void NuPlayer::GenericSource::prepareAsync() {
         mLooper->start();
 
         mLooper->registerHandler(this);
+
+        startReader(&mAudioTrack, "generic-audio");
+        startReader(&mVideoTrack, "generic-video");
     }
 
     sp<AMessage> msg = new AMessage(kWhatPrepareAsync, this);
@@ -481,7 +486,7 @@ void NuPlayer::GenericSource::finishPrepareAsync() {
 
             mBufferingMonitorLooper = new ALooper;
             mBufferingMonitorLooper->setName("GSBMonitor");
-            mBufferingMonitorLooper->start();
+            mBufferingMonitorLooper->startOnWorkerPool();
             mBufferingMonitorLooper->registerHandler(mBufferingMonitor);
         }
 
@@ -651,12 +656,15 @@ void NuPlayer::GenericSource::onMessageReceived(const sp<AMessage> &msg) {
           }
 
 
-          if (track->mSource != NULL) {
-              track->mSource->stop();
+          {
+              Mutex::Autolock _l(track->mReadLock);
+              if (track->mSource != NULL) {
+                  track->mSource->stop();
+              }
+              track->mSource = source;
+              track->mSource->start();
+              track->mIndex = trackIndex;
           }
-          track->mSource = source;
-          track->mSource->start();
-          track->mIndex = trackIndex;
 
           int64_t timeUs, actualTimeUs;
           const bool formatChange = true;
@@ -721,7 +729,11 @@ void NuPlayer::GenericSource::onMessageReceived(const sp<AMessage> &msg) {
       {
           // mStopRead is only used for Widevine to prevent the video source
           // from being read while the associated video decoder is shutting down.
-          mStopRead = true;
+          {
+              // wait for the read in progress on the video reader looper
+              Mutex::Autolock _l(mVideoTrack.mReadLock);
+              mStopRead = true;
+          }
           if (mVideoTrack.mSource != NULL) {
               mVideoTrack.mPackets->clear();
           }
@@ -1347,12 +1359,31 @@ sp<ABuffer> NuPlayer::GenericSource::mediaBufferToABuffer(
     return ab;
 }
 
+void NuPlayer::GenericSource::startReader(Track *track, const char *name) {
+    track->mReadLooper = new ALooper;
+    track->mReadLooper->setName(name);
+    track->mReadLooper->start();
+
+    track->mReader = new AHandlerReflector<GenericSource>(this);
+    track->mReadLooper->registerHandler(track->mReader);
+}
+
+void NuPlayer::GenericSource::stopReader(Track *track) {
+    if (track->mReadLooper != NULL) {
+        track->mReadLooper->unregisterHandler(track->mReader->id());
+        track->mReadLooper->stop();
+        track->mReadLooper.clear();
+    }
+}
+
 void NuPlayer::GenericSource::postReadBuffer(media_track_type trackType) {
     Mutex::Autolock _l(mReadBufferLock);
 
     if ((mPendingReadBufferTypes & (1 << trackType)) == 0) {
         mPendingReadBufferTypes |= (1 << trackType);
-        sp<AMessage> msg = new AMessage(kWhatReadBuffer, this);
+        const Track &track =
+            trackType == MEDIA_TRACK_TYPE_AUDIO ? mAudioTrack : mVideoTrack;
+        sp<AMessage> msg = new AMessage(kWhatReadBuffer, track.mReader);
         msg->setInt32("trackType", trackType);
         msg->post();
     }
@@ -1373,10 +1404,6 @@ void NuPlayer::GenericSource::onReadBuffer(sp<AMessage> msg) {
 
 void NuPlayer::GenericSource::readBuffer(
         media_track_type trackType, int64_t seekTimeUs, int64_t *actualTimeUs, bool formatChange) {
-    // Do not read data if Widevine source is stopped
-    if (mStopRead) {
-        return;
-    }
     Track *track;
     size_t maxBuffers = 1;
     switch (trackType) {
@@ -1406,6 +1433,14 @@ void NuPlayer::GenericSource::readBuffer(
             TRESPASS();
     }
 
+    // The audio and video tracks are also read on their reader loopers.
+    Mutex::Autolock _l(track->mReadLock);
+
+    // Do not read data if Widevine source is stopped
+    if (mStopRead) {
+        return;
+    }
+
     if (track->mSource == NULL) {
         return;
     }
@@ -24,6 +24,7 @@
 #include "ATSParser.h"
 
 #include <media/mediaplayer.h>
+#include <media/stagefright/foundation/AHandlerReflector.h>
 
 namespace android {
 
@@ -111,6 +112,13 @@ private:
         size_t mIndex;
         sp<IMediaSource> mSource;
         sp<AnotherPacketSource> mPackets;
+
+        // The audio and video tracks are read on loopers of their own, so
+        // that a slow read of one does not starve the decoder of the other.
+        sp<ALooper> mReadLooper;
+        sp<AHandlerReflector<GenericSource> > mReader;
+        // Held while reading from mSource, or replacing it.
+        Mutex mReadLock;
     };
 
     // Helper to monitor buffering status. The polling happens every second.
@@ -280,6 +288,8 @@ private:
             int64_t seekTimeUs,
             int64_t *actualTimeUs = NULL);
 
+    void startReader(Track *track, const char *name);
+    void stopReader(Track *track);
     void postReadBuffer(media_track_type trackType);
     void onReadBuffer(sp<AMessage> msg);
     void readBuffer(
@@ -289,6 +299,9 @@ private:
     void queueDiscontinuityIfNeeded(
             bool seeking, bool formatChange, media_track_type trackType, Track *track);
 
+    // kWhatReadBuffer is handled on the reader looper of the track.
+    friend struct AHandlerReflector<GenericSource>;
+
     DISALLOW_EVIL_CONSTRUCTORS(GenericSource);
 };
 
@@ -405,6 +405,19 @@ void NuPlayer::HTTPLiveSource::onSessionNotify(const sp<AMessage> &msg) {
             break;
         }
 
+        case LiveSession::kWhatBandwidthSwitch:
+        {
+            // let the app follow the bandwidth the variant is picked for
+            int32_t bandwidthBps;
+            CHECK(msg->findInt32("estimated-bandwidth", &bandwidthBps));
+
+            sp<AMessage> notify = dupNotify();
+            notify->setInt32("what", kWhatCacheStats);
+            notify->setInt32("bandwidth", bandwidthBps / 1000);
+            notify->post();
+            break;
+        }
+
         case LiveSession::kWhatError:
         {
             break;
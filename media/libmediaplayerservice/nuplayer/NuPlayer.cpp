@@ -26,6 +26,7 @@
 #include "NuPlayerDecoderBase.h"
 #include "NuPlayerDecoderPassThrough.h"
 #include "NuPlayerDriver.h"
+#include "NuPlayerPlaybackMetrics.h"
 #include "NuPlayerRenderer.h"
 #include "NuPlayerSource.h"
 #include "RTSPSource.h"
@@ -59,6 +60,12 @@
 
 namespace android {
 
+// Whether the video decoder is instantiated as soon as the source is prepared,
+// rather than on start, so that start does not wait for the codec allocation.
+static inline bool getWarmPrepareSetting() {
+    return property_get_bool("media.stagefright.prepare.warm", false /* default_value */);
+}
+
 struct NuPlayer::Action : public RefBase {
     Action() {}
 
@@ -84,16 +91,18 @@ private:
 };
 
 struct NuPlayer::ResumeDecoderAction : public Action {
-    ResumeDecoderAction(bool needNotify)
-        : mNeedNotify(needNotify) {
+    ResumeDecoderAction(bool needNotify, int64_t prerollUntilUs = -1ll)
+        : mNeedNotify(needNotify),
+          mPrerollUntilUs(prerollUntilUs) {
     }
 
     virtual void execute(NuPlayer *player) {
-        player->performResumeDecoders(mNeedNotify);
+        player->performResumeDecoders(mNeedNotify, mPrerollUntilUs);
     }
 
 private:
     bool mNeedNotify;
+    int64_t mPrerollUntilUs;
 
     DISALLOW_EVIL_CONSTRUCTORS(ResumeDecoderAction);
 };
@@ -171,6 +180,7 @@ NuPlayer::NuPlayer(pid_t pid)
       mPID(pid),
       mSourceFlags(0),
       mOffloadAudio(false),
+      mMetrics(new PlaybackMetrics),
       mAudioDecoderGeneration(0),
       mVideoDecoderGeneration(0),
       mRendererGeneration(0),
@@ -193,7 +203,8 @@ NuPlayer::NuPlayer(pid_t pid)
       mSourceStarted(false),
       mPaused(false),
       mPausedByClient(true),
-      mPausedForBuffering(false) {
+      mPausedForBuffering(false),
+      mBufferingStartUs(-1ll) {
     clearFlushComplete();
 }
 
@@ -419,10 +430,11 @@ void NuPlayer::resetAsync() {
     (new AMessage(kWhatReset, this))->post();
 }
 
-void NuPlayer::seekToAsync(int64_t seekTimeUs, bool needNotify) {
+void NuPlayer::seekToAsync(int64_t seekTimeUs, bool needNotify, bool precise) {
     sp<AMessage> msg = new AMessage(kWhatSeek, this);
     msg->setInt64("seekTimeUs", seekTimeUs);
     msg->setInt32("needNotify", needNotify);
+    msg->setInt32("precise", precise);
     msg->post();
 }
 
@@ -1197,11 +1209,13 @@ void NuPlayer::onMessageReceived(const sp<AMessage> &msg) {
         {
             int64_t seekTimeUs;
             int32_t needNotify;
+            int32_t precise;
             CHECK(msg->findInt64("seekTimeUs", &seekTimeUs));
             CHECK(msg->findInt32("needNotify", &needNotify));
+            CHECK(msg->findInt32("precise", &precise));
 
-            ALOGV("kWhatSeek seekTimeUs=%lld us, needNotify=%d",
-                    (long long)seekTimeUs, needNotify);
+            ALOGV("kWhatSeek seekTimeUs=%lld us, needNotify=%d, precise=%d",
+                    (long long)seekTimeUs, needNotify, precise);
 
             if (!mStarted) {
                 // Seek before the player is started. In order to preview video,
@@ -1230,8 +1244,10 @@ void NuPlayer::onMessageReceived(const sp<AMessage> &msg) {
             // After a flush without shutdown, decoder is paused.
             // Don't resume it until source seek is done, otherwise it could
             // start pulling stale data too soon.
+            // The source resumes at the sync frame before the seek position,
+            // for a precise seek the decoders preroll the frames up to it.
             mDeferredActions.push_back(
-                    new ResumeDecoderAction(needNotify));
+                    new ResumeDecoderAction(needNotify, precise ? seekTimeUs : -1ll));
 
             processDeferredActions();
             break;
@@ -1314,6 +1330,20 @@ status_t NuPlayer::onInstantiateSecureDecoders() {
     return OK;
 }
 
+void NuPlayer::warmUpDecoders() {
+    // As for the secure decoders, the decoder does not request data until it
+    // is handed the renderer on start.
+    if (mRenderer != NULL || mSurface == NULL) {
+        return;
+    }
+
+    status_t err = instantiateDecoder(false /* audio */, &mVideoDecoder);
+    if (err != OK) {
+        // start scans the sources again.
+        ALOGW("failed to instantiate the video decoder on prepare (%d)", err);
+    }
+}
+
 void NuPlayer::onStart(int64_t startPositionUs) {
     if (!mSourceStarted) {
         mSourceStarted = true;
@@ -1366,7 +1396,7 @@ void NuPlayer::onStart(int64_t startPositionUs) {
     sp<AMessage> notify = new AMessage(kWhatRendererNotify, this);
     ++mRendererGeneration;
     notify->setInt32("generation", mRendererGeneration);
-    mRenderer = new Renderer(mAudioSink, notify, flags);
+    mRenderer = new Renderer(mAudioSink, notify, flags, mMetrics);
     mRendererLooper = new ALooper;
     mRendererLooper->setName("NuPlayerRenderer");
     mRendererLooper->start(false, false, ANDROID_PRIORITY_AUDIO);
@@ -1648,7 +1678,7 @@ status_t NuPlayer::instantiateDecoder(
         notify->setInt32("generation", mVideoDecoderGeneration);
 
         *decoder = new Decoder(
-                notify, mSource, mPID, mRenderer, mSurface, mCCDecoder);
+                notify, mSource, mPID, mRenderer, mSurface, mCCDecoder, mMetrics);
 
         // enable FRC if high-quality AV sync is requested, even if not
         // directly queuing to display, as this will even improve textureview
@@ -1906,6 +1936,10 @@ status_t NuPlayer::getCurrentPosition(int64_t *mediaUs) {
     return renderer->getCurrentPosition(mediaUs);
 }
 
+void NuPlayer::getPlaybackMetrics(Parcel *reply) const {
+    mMetrics->writeToParcel(reply);
+}
+
 void NuPlayer::getStats(Vector<sp<AMessage> > *mTrackStats) {
     CHECK(mTrackStats != NULL);
 
@@ -2083,7 +2117,7 @@ void NuPlayer::performSetSurface(const sp<Surface> &surface) {
     }
 }
 
-void NuPlayer::performResumeDecoders(bool needNotify) {
+void NuPlayer::performResumeDecoders(bool needNotify, int64_t prerollUntilUs) {
     if (needNotify) {
         mResumePending = true;
         if (mVideoDecoder == NULL) {
@@ -2099,11 +2133,11 @@ void NuPlayer::performResumeDecoders(bool needNotify) {
         // complete. Let's wait for at least one video output frame before
         // notifying seek complete, so that the video thumbnail gets updated
         // when seekbar is dragged.
-        mVideoDecoder->signalResume(needNotify);
+        mVideoDecoder->signalResume(needNotify, prerollUntilUs);
     }
 
     if (mAudioDecoder != NULL) {
-        mAudioDecoder->signalResume(false /* needNotify */);
+        mAudioDecoder->signalResume(false /* needNotify */, prerollUntilUs);
     }
 }
 
@@ -2165,6 +2199,9 @@ void NuPlayer::onSourceNotify(const sp<AMessage> &msg) {
                 processDeferredActions();
             } else {
                 mPrepared = true;
+                if (getWarmPrepareSetting()) {
+                    warmUpDecoders();
+                }
             }
 
             sp<NuPlayerDriver> driver = mDriver.promote();
@@ -2233,6 +2270,7 @@ void NuPlayer::onSourceNotify(const sp<AMessage> &msg) {
                 ALOGI("buffer low, pausing...");
 
                 mPausedForBuffering = true;
+                mBufferingStartUs = ALooper::GetNowUs();
                 onPause();
             }
             notifyListener(MEDIA_INFO, MEDIA_INFO_BUFFERING_START, 0);
@@ -2246,6 +2284,11 @@ void NuPlayer::onSourceNotify(const sp<AMessage> &msg) {
                 ALOGI("buffer ready, resuming...");
 
                 mPausedForBuffering = false;
+                if (mBufferingStartUs >= 0) {
+                    mMetrics->record(PlaybackMetrics::kMetricRebuffering,
+                            ALooper::GetNowUs() - mBufferingStartUs);
+                    mBufferingStartUs = -1;
+                }
 
                 // do not resume yet if client didn't unpause
                 if (!mPausedByClient) {
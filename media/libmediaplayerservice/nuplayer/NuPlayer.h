@@ -70,7 +70,9 @@ struct NuPlayer : public AHandler {
 
     // Will notify the driver through "notifySeekComplete" once finished
     // and needNotify is true.
-    void seekToAsync(int64_t seekTimeUs, bool needNotify = false);
+    // A precise seek resumes playback at seekTimeUs rather than at the sync
+    // frame before it.
+    void seekToAsync(int64_t seekTimeUs, bool needNotify = false, bool precise = false);
 
     status_t setVideoScalingMode(int32_t mode);
     status_t getTrackInfo(Parcel* reply) const;
@@ -78,6 +80,8 @@ struct NuPlayer : public AHandler {
     status_t selectTrack(size_t trackIndex, bool select, int64_t timeUs);
     status_t getCurrentPosition(int64_t *mediaUs);
     void getStats(Vector<sp<AMessage> > *mTrackStats);
+    // See KEY_PARAMETER_PLAYBACK_METRICS.
+    void getPlaybackMetrics(Parcel *reply) const;
 
     sp<MetaData> getFileMeta();
     float getFrameRate();
@@ -96,6 +100,7 @@ private:
     struct DecoderBase;
     struct DecoderPassThrough;
     struct CCDecoder;
+    struct PlaybackMetrics;
     struct GenericSource;
     struct HTTPLiveSource;
     struct Renderer;
@@ -151,6 +156,7 @@ private:
     sp<CCDecoder> mCCDecoder;
     sp<Renderer> mRenderer;
     sp<ALooper> mRendererLooper;
+    sp<PlaybackMetrics> mMetrics;
     int32_t mAudioDecoderGeneration;
     int32_t mVideoDecoderGeneration;
     int32_t mRendererGeneration;
@@ -212,6 +218,7 @@ private:
 
     // Pause state as requested by source (internally) due to buffering
     bool mPausedForBuffering;
+    int64_t mBufferingStartUs;  // system time the current buffering began at, or -1
 
     inline const sp<DecoderBase> &getDecoder(bool audio) {
         return audio ? mAudioDecoder : mVideoDecoder;
@@ -235,6 +242,8 @@ private:
             bool audio, sp<DecoderBase> *decoder, bool checkAudioModeChange = true);
 
     status_t onInstantiateSecureDecoders();
+    // Instantiates the video decoder ahead of start.
+    void warmUpDecoders();
 
     void updateVideoSize(
             const sp<AMessage> &inputFormat,
@@ -268,7 +277,7 @@ private:
     void performReset();
     void performScanSources();
     void performSetSurface(const sp<Surface> &wrapper);
-    void performResumeDecoders(bool needNotify);
+    void performResumeDecoders(bool needNotify, int64_t prerollUntilUs = -1ll);
 
     void onSourceNotify(const sp<AMessage> &msg);
     void onClosedCaptionNotify(const sp<AMessage> &msg);
@@ -23,6 +23,7 @@
 
 #include "NuPlayerCCDecoder.h"
 #include "NuPlayerDecoder.h"
+#include "NuPlayerPlaybackMetrics.h"
 #include "NuPlayerRenderer.h"
 #include "NuPlayerSource.h"
 
@@ -59,17 +60,24 @@ NuPlayer::Decoder::Decoder(
         pid_t pid,
         const sp<Renderer> &renderer,
         const sp<Surface> &surface,
-        const sp<CCDecoder> &ccDecoder)
+        const sp<CCDecoder> &ccDecoder,
+        const sp<PlaybackMetrics> &metrics)
     : DecoderBase(notify),
       mSurface(surface),
       mSource(source),
       mRenderer(renderer),
       mCCDecoder(ccDecoder),
+      mMetrics(metrics),
       mPid(pid),
       mSkipRenderingUntilMediaTimeUs(-1ll),
       mNumFramesTotal(0ll),
       mNumInputFramesDropped(0ll),
       mNumOutputFramesDropped(0ll),
+      mPrerollStartUs(-1ll),
+      mNumPrerollFramesSkipped(0ll),
+      mNumPrerolls(0),
+      mPrerollTotalUs(0ll),
+      mPrerollMaxUs(0ll),
       mVideoWidth(0),
       mVideoHeight(0),
       mIsAudio(true),
@@ -99,6 +107,17 @@ sp<AMessage> NuPlayer::Decoder::getStats() const {
     mStats->setInt64("frames-total", mNumFramesTotal);
     mStats->setInt64("frames-dropped-input", mNumInputFramesDropped);
     mStats->setInt64("frames-dropped-output", mNumOutputFramesDropped);
+    if (mNumPrerolls > 0) {
+        mStats->setInt32("prerolls", mNumPrerolls);
+        mStats->setInt64("frames-skipped-preroll", mNumPrerollFramesSkipped);
+        mStats->setInt64("preroll-avg-us", mPrerollTotalUs / mNumPrerolls);
+        mStats->setInt64("preroll-max-us", mPrerollMaxUs);
+    }
+
+    sp<AMessage> latency;
+    if (mCodec != NULL && mCodec->getLatencyStats(&latency) == OK) {
+        mStats->setMessage("latency", latency);
+    }
     return mStats;
 }
 
@@ -421,9 +440,16 @@ void NuPlayer::Decoder::onGetInputBuffers(
     CHECK_EQ((status_t)OK, mCodec->getWidevineLegacyBuffers(dstBuffers));
 }
 
-void NuPlayer::Decoder::onResume(bool notifyComplete) {
+void NuPlayer::Decoder::onResume(bool notifyComplete, int64_t prerollUntilUs) {
     mPaused = false;
 
+    if (prerollUntilUs >= 0) {
+        ALOGV("[%s] prerolling until %lld us",
+                mComponentName.c_str(), (long long)prerollUntilUs);
+        mSkipRenderingUntilMediaTimeUs = prerollUntilUs;
+        mPrerollStartUs = ALooper::GetNowUs();
+    }
+
     if (notifyComplete) {
         mResumePending = true;
     }
@@ -660,14 +686,31 @@ bool NuPlayer::Decoder::handleAnOutputBuffer(
             ALOGV("[%s] dropping buffer at time %lld as requested.",
                      mComponentName.c_str(), (long long)timeUs);
 
+            if (mPrerollStartUs >= 0) {
+                // decoded only to reach the seek position, not a dropped frame
+                mNumPrerollFramesSkipped += !mIsAudio;
+                reply->setInt32("preroll", true);
+            }
             reply->post();
             return true;
         }
 
         mSkipRenderingUntilMediaTimeUs = -1;
+        if (mPrerollStartUs >= 0) {
+            int64_t prerollUs = ALooper::GetNowUs() - mPrerollStartUs;
+            ALOGV("[%s] prerolled to %lld us in %lld us",
+                    mComponentName.c_str(), (long long)timeUs, (long long)prerollUs);
+            mPrerollStartUs = -1;
+            ++mNumPrerolls;
+            mPrerollTotalUs += prerollUs;
+            if (prerollUs > mPrerollMaxUs) {
+                mPrerollMaxUs = prerollUs;
+            }
+        }
     }
 
     mNumFramesTotal += !mIsAudio;
+    recordDecodeTime(timeUs);
 
     // wait until 1st frame comes out to signal resume complete
     notifyResumeCompleteIfNecessary();
@@ -736,6 +779,19 @@ void NuPlayer::Decoder::releaseAndResetMediaBuffers() {
     mPendingInputMessages.clear();
     mDequeuedInputBuffers.clear();
     mSkipRenderingUntilMediaTimeUs = -1;
+    mPrerollStartUs = -1;
+    mInputQueueTimesUs.clear();
+}
+
+void NuPlayer::Decoder::recordDecodeTime(int64_t timeUs) {
+    ssize_t index = mInputQueueTimesUs.indexOfKey(timeUs);
+    if (index < 0) {
+        return;
+    }
+    mMetrics->record(PlaybackMetrics::kMetricDecodeTime,
+            ALooper::GetNowUs() - mInputQueueTimesUs.valueAt(index));
+    // the frames before it were output already, or dropped by the codec.
+    mInputQueueTimesUs.removeItemsAt(0, index + 1);
 }
 
 void NuPlayer::Decoder::requestCodecNotification() {
@@ -816,7 +872,19 @@ status_t NuPlayer::Decoder::fetchInputData(sp<AMessage> &reply) {
         if (!mIsAudio && !mIsSecure) {
             int32_t layerId = 0;
             bool haveLayerId = accessUnit->meta()->findInt32("temporal-layer-id", &layerId);
-            if (mRenderer->getVideoLateByUs() > 100000ll
+            int64_t timeUs;
+            if (mPrerollStartUs >= 0
+                    && mSkipRenderingUntilMediaTimeUs >= 0
+                    && mIsVideoAVC
+                    && accessUnit->meta()->findInt64("timeUs", &timeUs)
+                    && timeUs < mSkipRenderingUntilMediaTimeUs
+                    && !IsAVCReferenceFrame(accessUnit)) {
+                // Neither rendered nor referenced by the frames past the preroll,
+                // don't bother decoding it.
+                ++mNumPrerollFramesSkipped;
+                dropAccessUnit = true;
+                continue;
+            } else if (mRenderer->getVideoLateByUs() > 100000ll
                     && mIsVideoAVC
                     && !IsAVCReferenceFrame(accessUnit)) {
                 dropAccessUnit = true;
@@ -980,6 +1048,12 @@ bool NuPlayer::Decoder::onInputBufferFetched(const sp<AMessage> &msg) {
             handleError(err);
         } else {
             mInputBufferIsDequeued.editItemAt(bufferIx) = false;
+            if (mMetrics != NULL && !mIsAudio && flags == 0) {
+                if (mInputQueueTimesUs.size() >= kMaxNumInputQueueTimes) {
+                    mInputQueueTimesUs.removeItemsAt(0);
+                }
+                mInputQueueTimesUs.add(timeUs, ALooper::GetNowUs());
+            }
             if (mediaBuffer != NULL) {
                 CHECK(mMediaBuffers[bufferIx] == NULL);
                 mMediaBuffers.editItemAt(bufferIx) = mediaBuffer;
@@ -1011,7 +1085,10 @@ void NuPlayer::Decoder::onRenderBuffer(const sp<AMessage> &msg) {
         CHECK(msg->findInt64("timestampNs", &timestampNs));
         err = mCodec->renderOutputBufferAndRelease(bufferIx, timestampNs);
     } else {
-        mNumOutputFramesDropped += !mIsAudio;
+        int32_t preroll;
+        if (!msg->findInt32("preroll", &preroll) || !preroll) {
+            mNumOutputFramesDropped += !mIsAudio;
+        }
         err = mCodec->releaseOutputBuffer(bufferIx);
     }
     if (err != OK) {
@@ -29,7 +29,8 @@ struct NuPlayer::Decoder : public DecoderBase {
             pid_t pid,
             const sp<Renderer> &renderer = NULL,
             const sp<Surface> &surface = NULL,
-            const sp<CCDecoder> &ccDecoder = NULL);
+            const sp<CCDecoder> &ccDecoder = NULL,
+            const sp<PlaybackMetrics> &metrics = NULL);
 
     virtual sp<AMessage> getStats() const;
 
@@ -45,7 +46,7 @@ protected:
     virtual void onSetParameters(const sp<AMessage> &params);
     virtual void onSetRenderer(const sp<Renderer> &renderer);
     virtual void onGetInputBuffers(Vector<sp<ABuffer> > *dstBuffers);
-    virtual void onResume(bool notifyComplete);
+    virtual void onResume(bool notifyComplete, int64_t prerollUntilUs);
     virtual void onFlush();
     virtual void onShutdown(bool notifyComplete);
     virtual bool doRequestBuffers();
@@ -59,6 +60,8 @@ private:
 
     enum {
         kMaxNumVideoTemporalLayers = 32,
+        // access units tracked for the decode time
+        kMaxNumInputQueueTimes = 64,
     };
 
     sp<Surface> mSurface;
@@ -66,6 +69,9 @@ private:
     sp<Source> mSource;
     sp<Renderer> mRenderer;
     sp<CCDecoder> mCCDecoder;
+    sp<PlaybackMetrics> mMetrics;
+    // system time each video access unit was queued at, by media time
+    KeyedVector<int64_t, int64_t> mInputQueueTimesUs;
 
     sp<AMessage> mInputFormat;
     sp<AMessage> mOutputFormat;
@@ -87,6 +93,11 @@ private:
     int64_t mNumFramesTotal;
     int64_t mNumInputFramesDropped;
     int64_t mNumOutputFramesDropped;
+    int64_t mPrerollStartUs;  // system time the pending preroll started at, or -1
+    int64_t mNumPrerollFramesSkipped;
+    int32_t mNumPrerolls;
+    int64_t mPrerollTotalUs;
+    int64_t mPrerollMaxUs;
     int32_t mVideoWidth;
     int32_t mVideoHeight;
     bool mIsAudio;
@@ -115,6 +126,7 @@ private:
     void handleOutputFormatChange(const sp<AMessage> &format);
 
     void releaseAndResetMediaBuffers();
+    void recordDecodeTime(int64_t timeUs);
     void requestCodecNotification();
     bool isStaleReply(const sp<AMessage> &msg);
 
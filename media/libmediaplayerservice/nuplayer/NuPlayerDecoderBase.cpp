@@ -103,9 +103,10 @@ void NuPlayer::DecoderBase::signalFlush() {
     (new AMessage(kWhatFlush, this))->post();
 }
 
-void NuPlayer::DecoderBase::signalResume(bool notifyComplete) {
+void NuPlayer::DecoderBase::signalResume(bool notifyComplete, int64_t prerollUntilUs) {
     sp<AMessage> msg = new AMessage(kWhatResume, this);
     msg->setInt32("notifyComplete", notifyComplete);
+    msg->setInt64("prerollUntilUs", prerollUntilUs);
     msg->post();
 }
 
@@ -195,9 +196,11 @@ void NuPlayer::DecoderBase::onMessageReceived(const sp<AMessage> &msg) {
         case kWhatResume:
         {
             int32_t notifyComplete;
+            int64_t prerollUntilUs;
             CHECK(msg->findInt32("notifyComplete", &notifyComplete));
+            CHECK(msg->findInt64("prerollUntilUs", &prerollUntilUs));
 
-            onResume(notifyComplete);
+            onResume(notifyComplete, prerollUntilUs);
             break;
         }
 
@@ -44,7 +44,9 @@ struct NuPlayer::DecoderBase : public AHandler {
 
     status_t getInputBuffers(Vector<sp<ABuffer> > *dstBuffers) const;
     void signalFlush();
-    void signalResume(bool notifyComplete);
+    // If prerollUntilUs is not negative, the output before that media time
+    // is decoded but not rendered, e.g. to resume exactly at a seek position.
+    void signalResume(bool notifyComplete, int64_t prerollUntilUs = -1ll);
     void initiateShutdown();
 
     virtual sp<AMessage> getStats() const {
@@ -71,7 +73,7 @@ protected:
     virtual void onSetParameters(const sp<AMessage> &params) = 0;
     virtual void onSetRenderer(const sp<Renderer> &renderer) = 0;
     virtual void onGetInputBuffers(Vector<sp<ABuffer> > *dstBuffers) = 0;
-    virtual void onResume(bool notifyComplete) = 0;
+    virtual void onResume(bool notifyComplete, int64_t prerollUntilUs) = 0;
     virtual void onFlush() = 0;
     virtual void onShutdown(bool notifyComplete) = 0;
 
@@ -358,8 +358,11 @@ void NuPlayer::DecoderPassThrough::onBufferConsumed(int32_t size) {
     onRequestInputBuffers();
 }
 
-void NuPlayer::DecoderPassThrough::onResume(bool notifyComplete) {
+void NuPlayer::DecoderPassThrough::onResume(bool notifyComplete, int64_t prerollUntilUs) {
     mPaused = false;
+    if (prerollUntilUs >= 0) {
+        mSkipRenderingUntilMediaTimeUs = prerollUntilUs;
+    }
 
     onRequestInputBuffers();
 
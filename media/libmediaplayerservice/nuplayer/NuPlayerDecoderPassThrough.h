@@ -39,7 +39,7 @@ protected:
     virtual void onSetParameters(const sp<AMessage> &params);
     virtual void onSetRenderer(const sp<Renderer> &renderer);
     virtual void onGetInputBuffers(Vector<sp<ABuffer> > *dstBuffers);
-    virtual void onResume(bool notifyComplete);
+    virtual void onResume(bool notifyComplete, int64_t prerollUntilUs);
     virtual void onFlush();
     virtual void onShutdown(bool notifyComplete);
     virtual bool doRequestBuffers();
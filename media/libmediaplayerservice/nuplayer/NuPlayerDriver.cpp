@@ -33,6 +33,12 @@
 
 namespace android {
 
+// Whether a seek resumes playback at the position requested rather than at the
+// sync frame before it, by decoding without rendering the frames in between.
+static inline bool getPreciseSeekSetting() {
+    return property_get_bool("media.stagefright.seek.precise", false /* default_value */);
+}
+
 NuPlayerDriver::NuPlayerDriver(pid_t pid)
     : mState(STATE_IDLE),
       mIsAsyncPrepare(false),
@@ -398,7 +404,8 @@ status_t NuPlayerDriver::seekTo(int msec) {
             mSeekInProgress = true;
             // seeks can take a while, so we essentially paused
             notifyListener_l(MEDIA_PAUSED);
-            mPlayer->seekToAsync(seekTimeUs, true /* needNotify */);
+            mPlayer->seekToAsync(
+                    seekTimeUs, true /* needNotify */, getPreciseSeekSetting());
             break;
         }
 
@@ -569,7 +576,11 @@ status_t NuPlayerDriver::setParameter(
     return INVALID_OPERATION;
 }
 
-status_t NuPlayerDriver::getParameter(int /* key */, Parcel * /* reply */) {
+status_t NuPlayerDriver::getParameter(int key, Parcel *reply) {
+    if (key == KEY_PARAMETER_PLAYBACK_METRICS) {
+        mPlayer->getPlaybackMetrics(reply);
+        return OK;
+    }
     return INVALID_OPERATION;
 }
 
@@ -692,6 +703,39 @@ status_t NuPlayerDriver::dump(
                      numFramesTotal == 0
                             ? 0.0 : (double)(numFramesDropped * 100) / numFramesTotal);
             logString.append(buf);
+
+            int32_t numPrerolls;
+            if (stats->findInt32("prerolls", &numPrerolls)) {
+                int64_t numFramesSkipped = 0, avgUs = 0, maxUs = 0;
+                stats->findInt64("frames-skipped-preroll", &numFramesSkipped);
+                stats->findInt64("preroll-avg-us", &avgUs);
+                stats->findInt64("preroll-max-us", &maxUs);
+                snprintf(buf, sizeof(buf), "    precise seeks(%d): numFramesSkipped(%lld), "
+                         "seek latency avg %lld us, max %lld us\n",
+                         numPrerolls, (long long)numFramesSkipped,
+                         (long long)avgUs, (long long)maxUs);
+                logString.append(buf);
+            }
+        }
+
+        sp<AMessage> latency;
+        if (stats->findMessage("latency", &latency)) {
+            for (size_t j = 0; j < latency->countEntries(); ++j) {
+                AMessage::Type type;
+                AString avgName = latency->getEntryNameAt(j, &type);
+                if (!avgName.endsWith("-avg-us")) {
+                    continue;
+                }
+                AString stage(avgName, 0, avgName.size() - strlen("-avg-us"));
+                int64_t avgUs = 0, maxUs = 0;
+                int32_t samples = 0;
+                latency->findInt64(avgName.c_str(), &avgUs);
+                latency->findInt64(AStringPrintf("%s-max-us", stage.c_str()).c_str(), &maxUs);
+                latency->findInt32(AStringPrintf("%s-samples", stage.c_str()).c_str(), &samples);
+                snprintf(buf, sizeof(buf), "    latency(%s): avg %lld us, max %lld us (%d)\n",
+                         stage.c_str(), (long long)avgUs, (long long)maxUs, samples);
+                logString.append(buf);
+            }
         }
     }
 
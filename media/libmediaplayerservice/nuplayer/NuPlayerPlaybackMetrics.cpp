@@ -0,0 +1,109 @@
+/*
+ * Copyright 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "NuPlayerPlaybackMetrics"
+#include <utils/Log.h>
+
+#include "NuPlayerPlaybackMetrics.h"
+
+#include <binder/Parcel.h>
+#include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/ALooper.h>
+
+#include <string.h>
+
+namespace android {
+
+static const int64_t kWindowDurationUs = 1000000ll;
+
+static const int64_t kBucketLimitsUs[NuPlayer::PlaybackMetrics::kNumBuckets - 1] = {
+    1000ll, 2000ll, 5000ll, 10000ll, 20000ll, 40000ll, 80000ll, 160000ll, 500000ll,
+};
+
+NuPlayer::PlaybackMetrics::PlaybackMetrics() {
+    startWindow_l(ALooper::GetNowUs());
+}
+
+NuPlayer::PlaybackMetrics::~PlaybackMetrics() {
+}
+
+void NuPlayer::PlaybackMetrics::record(Metric metric, int64_t valueUs) {
+    CHECK_LT(metric, kNumMetrics);
+
+    Mutex::Autolock autoLock(mLock);
+    completeWindowIfNeeded_l(ALooper::GetNowUs());
+
+    const int64_t magnitudeUs = valueUs < 0 ? -valueUs : valueUs;
+    size_t bucket = 0;
+    while (bucket < kNumBuckets - 1 && magnitudeUs >= kBucketLimitsUs[bucket]) {
+        ++bucket;
+    }
+
+    Histogram *histogram = &mCurrentWindow.mHistograms[metric];
+    ++histogram->mCount;
+    histogram->mSumUs += valueUs;
+    if (magnitudeUs > histogram->mMaxUs) {
+        histogram->mMaxUs = magnitudeUs;
+    }
+    ++histogram->mBuckets[bucket];
+    mCurrentWindow.mEmpty = false;
+}
+
+void NuPlayer::PlaybackMetrics::writeToParcel(Parcel *parcel) {
+    Mutex::Autolock autoLock(mLock);
+    completeWindowIfNeeded_l(ALooper::GetNowUs());
+
+    parcel->writeInt32(mCompletedWindows.size());
+    for (List<Window>::iterator it = mCompletedWindows.begin();
+            it != mCompletedWindows.end(); ++it) {
+        parcel->writeInt64(it->mStartUs);
+        parcel->writeInt64(kWindowDurationUs);
+        for (size_t i = 0; i < kNumMetrics; ++i) {
+            const Histogram &histogram = it->mHistograms[i];
+            parcel->writeInt32(histogram.mCount);
+            parcel->writeInt64(histogram.mSumUs);
+            parcel->writeInt64(histogram.mMaxUs);
+            for (size_t j = 0; j < kNumBuckets; ++j) {
+                parcel->writeInt32(histogram.mBuckets[j]);
+            }
+        }
+    }
+    mCompletedWindows.clear();
+}
+
+void NuPlayer::PlaybackMetrics::startWindow_l(int64_t nowUs) {
+    memset(&mCurrentWindow, 0, sizeof(mCurrentWindow));
+    mCurrentWindow.mStartUs = nowUs;
+    mCurrentWindow.mEmpty = true;
+}
+
+void NuPlayer::PlaybackMetrics::completeWindowIfNeeded_l(int64_t nowUs) {
+    if (nowUs - mCurrentWindow.mStartUs < kWindowDurationUs) {
+        return;
+    }
+
+    // Windows without any sample, e.g. while paused, are not reported.
+    if (!mCurrentWindow.mEmpty) {
+        mCompletedWindows.push_back(mCurrentWindow);
+        if (mCompletedWindows.size() > kMaxWindows) {
+            mCompletedWindows.erase(mCompletedWindows.begin());
+        }
+    }
+    startWindow_l(nowUs);
+}
+
+}  // namespace android
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NUPLAYER_PLAYBACK_METRICS_H_
+
+#define NUPLAYER_PLAYBACK_METRICS_H_
+
+#include "NuPlayer.h"
+
+#include <utils/List.h>
+
+namespace android {
+
+class Parcel;
+
+// Histograms of the playback quality over windows of one second, gathered
+// by the renderer, the video decoder and the player, and polled by the client
+// through KEY_PARAMETER_PLAYBACK_METRICS.
+//
+// The parcel written holds the number of windows, followed for each window
+// by its start (system time) and duration, in us, then for each metric in
+// the order of Metric: the number of samples, their sum and the largest
+// magnitude in us, and the number of samples in each of the kNumBuckets
+// buckets. A sample lands in the first bucket whose limit its magnitude is
+// below, see kBucketLimitsUs; the last bucket takes the rest.
+struct NuPlayer::PlaybackMetrics : public RefBase {
+    enum Metric {
+        kMetricAVDrift,         // rendered video behind the audio clock
+        kMetricVideoLateness,   // video frame drained past its render time
+        kMetricDecodeTime,      // video access unit queued to frame decoded
+        kMetricRenderJitter,    // render interval against media interval
+        kMetricRebuffering,     // duration of a pause for buffering
+        kNumMetrics,
+    };
+
+    enum {
+        kNumBuckets = 10,
+        // windows kept for the client to poll
+        kMaxWindows = 10,
+    };
+
+    PlaybackMetrics();
+
+    void record(Metric metric, int64_t valueUs);
+
+    // Writes the windows completed since the last call, then forgets them.
+    void writeToParcel(Parcel *parcel);
+
+protected:
+    virtual ~PlaybackMetrics();
+
+private:
+    struct Histogram {
+        int32_t mCount;
+        int64_t mSumUs;
+        int64_t mMaxUs;
+        int32_t mBuckets[kNumBuckets];
+    };
+
+    struct Window {
+        int64_t mStartUs;
+        bool mEmpty;
+        Histogram mHistograms[kNumMetrics];
+    };
+
+    Mutex mLock;
+    Window mCurrentWindow;
+    List<Window> mCompletedWindows;
+
+    void startWindow_l(int64_t nowUs);
+    void completeWindowIfNeeded_l(int64_t nowUs);
+
+    DISALLOW_EVIL_CONSTRUCTORS(PlaybackMetrics);
+};
+
+}  // namespace android
+
+#endif  // NUPLAYER_PLAYBACK_METRICS_H_
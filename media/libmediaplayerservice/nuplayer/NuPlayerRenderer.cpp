@@ -19,6 +19,7 @@
 #include <utils/Log.h>
 
 #include "NuPlayerRenderer.h"
+#include "NuPlayerPlaybackMetrics.h"
 #include <algorithm>
 #include <cutils/properties.h>
 #include <media/stagefright/foundation/ABuffer.h>
@@ -66,6 +67,10 @@ static inline int32_t getAudioSinkPcmMsSetting() {
             "media.stagefright.audio.sink", 500 /* default_value */);
 }
 
+static inline bool getAudioSinkBatchingSetting() {
+    return property_get_bool("media.stagefright.audio.batch", true /* default_value */);
+}
+
 // Maximum time in paused state when offloading audio decompression. When elapsed, the AudioSink
 // is closed to allow the audio DSP to power down.
 static const int64_t kOffloadPauseMaxUs = 10000000ll;
@@ -75,6 +80,9 @@ static const int64_t kMaxAllowedAudioSinkDelayUs = 1500000ll;
 
 static const int64_t kMinimumAudioClockUpdatePeriodUs = 20 /* msec */ * 1000;
 
+// When batching audio, the sink is refilled once it has about this much audio left to play.
+static const int64_t kBatchedAudioWakeupMarginUs = 100000ll;
+
 // static
 const NuPlayer::Renderer::PcmInfo NuPlayer::Renderer::AUDIO_PCMINFO_INITIALIZER = {
         AUDIO_CHANNEL_NONE,
@@ -90,7 +98,8 @@ const int64_t NuPlayer::Renderer::kMinPositionUpdateDelayUs = 100000ll;
 NuPlayer::Renderer::Renderer(
         const sp<MediaPlayerBase::AudioSink> &sink,
         const sp<AMessage> &notify,
-        uint32_t flags)
+        uint32_t flags,
+        const sp<PlaybackMetrics> &metrics)
     : mAudioSink(sink),
       mUseVirtualAudioSink(false),
       mNotify(notify),
@@ -108,6 +117,9 @@ NuPlayer::Renderer::Renderer(
       mAnchorTimeMediaUs(-1),
       mAnchorNumFramesWritten(-1),
       mVideoLateByUs(0ll),
+      mMetrics(metrics),
+      mLastVideoDrainTimeUs(-1ll),
+      mLastVideoRenderTimeUs(-1ll),
       mHasAudio(false),
       mHasVideo(false),
       mNotifyCompleteAudio(false),
@@ -129,6 +141,7 @@ NuPlayer::Renderer::Renderer(
       mTotalBuffersQueued(0),
       mLastAudioBufferDrained(0),
       mUseAudioCallback(false),
+      mBatchAudio(false),
       mWakeLock(new AWakeLock()) {
     mMediaClock = new MediaClock;
     mPlaybackRate = mPlaybackSettings.mSpeed;
@@ -498,8 +511,10 @@ void NuPlayer::Renderer::onMessageReceived(const sp<AMessage> &msg) {
                 }
 
                 // Let's give it more data after about half that time
-                // has elapsed.
-                delayUs /= 2;
+                // has elapsed, or shortly before it runs out when batching.
+                delayUs = mBatchAudio
+                        ? std::max(delayUs / 2, delayUs - kBatchedAudioWakeupMarginUs)
+                        : delayUs / 2;
                 // check the buffer size to estimate maximum delay permitted.
                 const int64_t maxDrainDelayUs = std::max(
                         mAudioSink->getBufferDurationInUs(), (int64_t)500000 /* half second */);
@@ -821,7 +836,9 @@ size_t NuPlayer::Renderer::fillAudioBuffer(void *buffer, size_t size) {
 
         entry->mOffset += copy;
         if (entry->mOffset == entry->mBuffer->size()) {
-            entry->mNotifyConsumed->post();
+            if (entry->mNotifyConsumed != NULL) {
+                entry->mNotifyConsumed->post();
+            }
             mAudioQueue.erase(mAudioQueue.begin());
             entry = NULL;
         }
@@ -870,7 +887,8 @@ void NuPlayer::Renderer::drainAudioQueueUntilLastEOS() {
         int32_t eos;
         QueueEntry *entry = &*it++;
         if (entry->mBuffer == NULL
-                || (entry->mNotifyConsumed->findInt32("eos", &eos) && eos != 0)) {
+                || (entry->mNotifyConsumed != NULL
+                        && entry->mNotifyConsumed->findInt32("eos", &eos) && eos != 0)) {
             itEOS = it;
             foundEOS = true;
         }
@@ -882,7 +900,7 @@ void NuPlayer::Renderer::drainAudioQueueUntilLastEOS() {
             if (it->mBuffer == NULL) {
                 // delay doesn't matter as we don't even have an AudioTrack
                 notifyEOS(true /* audio */, it->mFinalResult);
-            } else {
+            } else if (it->mNotifyConsumed != NULL) {
                 it->mNotifyConsumed->post();
             }
         }
@@ -992,7 +1010,9 @@ bool NuPlayer::Renderer::onDrainAudioQueue() {
                 copy -= remainder;
             }
 
-            entry->mNotifyConsumed->post();
+            if (entry->mNotifyConsumed != NULL) {
+                entry->mNotifyConsumed->post();
+            }
             mAudioQueue.erase(mAudioQueue.begin());
 
             entry = NULL;
@@ -1073,6 +1093,49 @@ int64_t NuPlayer::Renderer::getPendingAudioPlayoutDurationUs(int64_t nowUs) {
     return writtenAudioDurationUs - mAudioSink->getPlayedOutDurationUs(nowUs);
 }
 
+// Returns how long the audio sink can go without more data, less a margin for waking up.
+int64_t NuPlayer::Renderer::getBatchedAudioDrainDelayUs(int64_t nowUs) {
+    int64_t delayUs = getPendingAudioPlayoutDurationUs(nowUs);
+    if (mPlaybackRate > 1.0f) {
+        delayUs /= mPlaybackRate;
+    }
+    delayUs -= kBatchedAudioWakeupMarginUs;
+    return delayUs > 0 ? delayUs : 0;
+}
+
+// The decoder cannot decode ahead of the audio sink while the renderer holds on to its output
+// buffers. So that the sink can be refilled in large batches, as few times as possible, a copy
+// of the buffer is queued instead and the decoder's buffer is released right away, as long as
+// no more than about one sink buffer of audio is queued up.
+void NuPlayer::Renderer::stageAudioBuffer_l(QueueEntry *entry) {
+    int32_t eos;
+    const ssize_t frameCount = mAudioSink->frameCount();
+    if (frameCount <= 0 || entry->mBuffer->size() == 0
+            || (entry->mNotifyConsumed->findInt32("eos", &eos) && eos != 0)) {
+        return;
+    }
+
+    size_t queuedBytes = entry->mBuffer->size();
+    for (List<QueueEntry>::iterator it = mAudioQueue.begin(); it != mAudioQueue.end(); ++it) {
+        if (it->mBuffer != NULL) {
+            queuedBytes += it->mBuffer->size() - it->mOffset;
+        }
+    }
+    if (queuedBytes > (size_t)frameCount * mAudioSink->frameSize()) {
+        return;
+    }
+
+    int64_t mediaTimeUs;
+    CHECK(entry->mBuffer->meta()->findInt64("timeUs", &mediaTimeUs));
+    sp<ABuffer> copy = new ABuffer(entry->mBuffer->size());
+    memcpy(copy->data(), entry->mBuffer->data(), entry->mBuffer->size());
+    copy->meta()->setInt64("timeUs", mediaTimeUs);
+
+    entry->mNotifyConsumed->post();
+    entry->mNotifyConsumed.clear();
+    entry->mBuffer = copy;
+}
+
 int64_t NuPlayer::Renderer::getRealTimeUs(int64_t mediaTimeUs, int64_t nowUs) {
     int64_t realUs;
     if (mMediaClock->getRealTimeFor(mediaTimeUs, &realUs) != OK) {
@@ -1308,6 +1371,10 @@ void NuPlayer::Renderer::onDrainVideoQueue() {
     mVideoQueue.erase(mVideoQueue.begin());
     entry = NULL;
 
+    if (mMetrics != NULL && !mPaused && mVideoSampleReceived) {
+        recordVideoMetrics(nowUs, realTimeUs, !tooLate);
+    }
+
     mVideoSampleReceived = true;
 
     if (!mPaused) {
@@ -1320,6 +1387,27 @@ void NuPlayer::Renderer::onDrainVideoQueue() {
     }
 }
 
+void NuPlayer::Renderer::recordVideoMetrics(
+        int64_t nowUs, int64_t realTimeUs, bool rendered) {
+    const int64_t lateUs = nowUs > realTimeUs ? nowUs - realTimeUs : 0ll;
+    mMetrics->record(PlaybackMetrics::kMetricVideoLateness, lateUs);
+    if (!rendered) {
+        return;
+    }
+
+    // A frame rendered past its time is shown behind the audio.
+    if (mHasAudio && !(mFlags & FLAG_REAL_TIME)) {
+        mMetrics->record(PlaybackMetrics::kMetricAVDrift, lateUs);
+    }
+
+    if (mLastVideoRenderTimeUs >= 0) {
+        mMetrics->record(PlaybackMetrics::kMetricRenderJitter,
+                (nowUs - mLastVideoDrainTimeUs) - (realTimeUs - mLastVideoRenderTimeUs));
+    }
+    mLastVideoDrainTimeUs = nowUs;
+    mLastVideoRenderTimeUs = realTimeUs;
+}
+
 void NuPlayer::Renderer::notifyVideoRenderingStart() {
     sp<AMessage> notify = mNotify->dup();
     notify->setInt32("what", kWhatVideoRenderingStart);
@@ -1382,9 +1470,16 @@ void NuPlayer::Renderer::onQueueBuffer(const sp<AMessage> &msg) {
     entry.mBufferOrdinal = ++mTotalBuffersQueued;
 
     if (audio) {
+        // When batching, the sink is refilled shortly before it runs out rather than as soon
+        // as a buffer is decoded.
+        const int64_t delayUs =
+                mBatchAudio ? getBatchedAudioDrainDelayUs(ALooper::GetNowUs()) : 0;
         Mutex::Autolock autoLock(mLock);
+        if (mBatchAudio) {
+            stageAudioBuffer_l(&entry);
+        }
         mAudioQueue.push_back(entry);
-        postDrainAudioQueue_l();
+        postDrainAudioQueue_l(delayUs);
     } else {
         mVideoQueue.push_back(entry);
         postDrainVideoQueue();
@@ -1419,7 +1514,9 @@ void NuPlayer::Renderer::onQueueBuffer(const sp<AMessage> &msg) {
         // Audio data starts More than 0.1 secs before video.
         // Drop some audio.
 
-        (*mAudioQueue.begin()).mNotifyConsumed->post();
+        if ((*mAudioQueue.begin()).mNotifyConsumed != NULL) {
+            (*mAudioQueue.begin()).mNotifyConsumed->post();
+        }
         mAudioQueue.erase(mAudioQueue.begin());
         return;
     }
@@ -1550,6 +1647,7 @@ void NuPlayer::Renderer::onFlush(const sp<AMessage> &msg) {
         flushQueue(&mVideoQueue);
 
         mDrainVideoQueuePending = false;
+        mLastVideoRenderTimeUs = -1;
 
         if (mVideoScheduler != NULL) {
             mVideoScheduler->restart();
@@ -1571,7 +1669,7 @@ void NuPlayer::Renderer::flushQueue(List<QueueEntry> *queue) {
     while (!queue->empty()) {
         QueueEntry *entry = &*queue->begin();
 
-        if (entry->mBuffer != NULL) {
+        if (entry->mBuffer != NULL && entry->mNotifyConsumed != NULL) {
             entry->mNotifyConsumed->post();
         }
 
@@ -1651,6 +1749,7 @@ void NuPlayer::Renderer::onPause() {
         mPaused = true;
         mMediaClock->setPlaybackRate(0.0);
     }
+    mLastVideoRenderTimeUs = -1;
 
     mDrainAudioQueuePending = false;
     mDrainVideoQueuePending = false;
@@ -1877,6 +1976,7 @@ status_t NuPlayer::Renderer::onOpenAudioSink(
                     notifyAudioTearDown(kForceNonOffload);
                 }
             } else {
+                mBatchAudio = false;
                 mUseAudioCallback = true;  // offload mode transfers data through callback
                 ++mAudioDrainGeneration;  // discard pending kWhatDrainAudioQueue message.
             }
@@ -1944,6 +2044,10 @@ status_t NuPlayer::Renderer::onOpenAudioSink(
             return err;
         }
         mCurrentPcmInfo = info;
+        mBatchAudio = !mUseAudioCallback
+                && (pcmFlags & AUDIO_OUTPUT_FLAG_DEEP_BUFFER)
+                && getAudioSinkBatchingSetting();
+        ALOGV_IF(mBatchAudio, "openAudioSink: batching audio");
         if (!mPaused) { // for preview mode, don't start if paused
             mAudioSink->start();
         }
@@ -1957,6 +2061,7 @@ status_t NuPlayer::Renderer::onOpenAudioSink(
 
 void NuPlayer::Renderer::onCloseAudioSink() {
     mAudioSink->close();
+    mBatchAudio = false;
     mCurrentOffloadInfo = AUDIO_INFO_INITIALIZER;
     mCurrentPcmInfo = AUDIO_PCMINFO_INITIALIZER;
 }
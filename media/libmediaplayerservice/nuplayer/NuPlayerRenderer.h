@@ -37,7 +37,8 @@ struct NuPlayer::Renderer : public AHandler {
     };
     Renderer(const sp<MediaPlayerBase::AudioSink> &sink,
              const sp<AMessage> &notify,
-             uint32_t flags = 0);
+             uint32_t flags = 0,
+             const sp<PlaybackMetrics> &metrics = NULL);
 
     static size_t AudioSinkCallback(
             MediaPlayerBase::AudioSink *audioSink,
@@ -163,6 +164,11 @@ private:
     int64_t mAnchorTimeMediaUs;
     int64_t mAnchorNumFramesWritten;
     int64_t mVideoLateByUs;
+    sp<PlaybackMetrics> mMetrics;
+    // the drain and render times of the last video frame rendered, for the
+    // render jitter; mLastVideoRenderTimeUs is -1 after a flush or a pause.
+    int64_t mLastVideoDrainTimeUs;
+    int64_t mLastVideoRenderTimeUs;
     bool mHasAudio;
     bool mHasVideo;
 
@@ -202,6 +208,8 @@ private:
     int32_t mTotalBuffersQueued;
     int32_t mLastAudioBufferDrained;
     bool mUseAudioCallback;
+    // Batch the audio written to a deep buffer sink, see stageAudioBuffer_l().
+    bool mBatchAudio;
 
     sp<AWakeLock> mWakeLock;
 
@@ -218,7 +226,9 @@ private:
     bool onDrainAudioQueue();
     void drainAudioQueueUntilLastEOS();
     int64_t getPendingAudioPlayoutDurationUs(int64_t nowUs);
+    int64_t getBatchedAudioDrainDelayUs(int64_t nowUs);
     void postDrainAudioQueue_l(int64_t delayUs = 0);
+    void stageAudioBuffer_l(QueueEntry *entry);
 
     void clearAnchorTime_l();
     void clearAudioFirstAnchorTime_l();
@@ -229,6 +239,7 @@ private:
     int64_t getRealTimeUs(int64_t mediaTimeUs, int64_t nowUs);
 
     void onDrainVideoQueue();
+    void recordVideoMetrics(int64_t nowUs, int64_t realTimeUs, bool rendered);
     void postDrainVideoQueue();
 
     void prepareForMediaRenderingStart_l();
@@ -79,4 +79,19 @@ ssize_t AudioStreamInSource::read(void *buffer, size_t count)
     }
 }
 
+status_t AudioStreamInSource::getTimestamp(ExtendedTimestamp &timestamp)
+{
+    if (mStream->get_capture_position == NULL) {
+        return INVALID_OPERATION;
+    }
+
+    int64_t position, time;
+    if (mStream->get_capture_position(mStream, &position, &time) != OK) {
+        return INVALID_OPERATION;
+    }
+    timestamp.mPosition[ExtendedTimestamp::LOCATION_KERNEL] = position;
+    timestamp.mTimeNs[ExtendedTimestamp::LOCATION_KERNEL] = time;
+    return OK;
+}
+
 }   // namespace android
@@ -30,6 +30,171 @@
 
 namespace android {
 
+// Argument types of EVENT_FORMAT.  Integers are stored as 8 bytes, zero or sign extended
+// according to ARG_SIGNED, doubles and pointers as 8 bytes, and strings as a length byte
+// followed by the characters.  All are in the byte order of the writer.
+enum {
+    ARG_NONE,                   // %%
+    ARG_INT,
+    ARG_LONG,
+    ARG_LONG_LONG,
+    ARG_SIZE,
+    ARG_INTMAX,
+    ARG_PTRDIFF,
+    ARG_DOUBLE,
+    ARG_POINTER,
+    ARG_STRING,
+    ARG_TYPE_MASK = 0x7f,
+    ARG_SIGNED = 0x80,          // for the integer types
+};
+
+// Parses the conversion specification that follows a '%' at spec.  Returns the character
+// after the conversion, or NULL if it is not supported by logFormat().
+// *type is the argument type, and *prefix the length of the flags, width and precision.
+static const char *parseConversion(const char *spec, uint8_t *type, size_t *prefix)
+{
+    const char *p = spec;
+    while (*p != '\0' && strchr("-+ #0", *p) != NULL) {
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+        p++;
+    }
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    *prefix = p - spec;
+    uint8_t length = ARG_INT;
+    switch (*p) {
+    case 'l':
+        if (*++p == 'l') {
+            p++;
+            length = ARG_LONG_LONG;
+        } else {
+            length = ARG_LONG;
+        }
+        break;
+    case 'z': p++; length = ARG_SIZE; break;
+    case 'j': p++; length = ARG_INTMAX; break;
+    case 't': p++; length = ARG_PTRDIFF; break;
+    default: break;
+    }
+    switch (*p) {
+    case 'd':
+    case 'i':
+        *type = length | ARG_SIGNED;
+        break;
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+        *type = length;
+        break;
+    case 'c':
+        if (length != ARG_INT) {
+            return NULL;
+        }
+        *type = ARG_INT | ARG_SIGNED;
+        break;
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        // 'l' has no effect on these
+        if (length != ARG_INT && length != ARG_LONG) {
+            return NULL;
+        }
+        *type = ARG_DOUBLE;
+        break;
+    case 's':
+    case 'p':
+        if (length != ARG_INT) {
+            return NULL;
+        }
+        *type = *p == 's' ? ARG_STRING : ARG_POINTER;
+        break;
+    case '%':
+        if (p != spec) {
+            return NULL;
+        }
+        *type = ARG_NONE;
+        break;
+    default:
+        return NULL;
+    }
+    return p + 1;
+}
+
+// Formats the arguments of an EVENT_FORMAT of fmt into body.  Returns false if they are corrupt.
+static bool formatArgs(String8& body, const char *fmt, const uint8_t *args, size_t length)
+{
+    const uint8_t *end = args + length;
+    const char *p = fmt;
+    while (*p != '\0') {
+        const char *percent = strchr(p, '%');
+        if (percent == NULL) {
+            body.append(p);
+            break;
+        }
+        body.append(p, percent - p);
+        uint8_t type;
+        size_t prefix;
+        const char *next = parseConversion(percent + 1, &type, &prefix);
+        if (next == NULL) {
+            return false;
+        }
+        // rewrite the conversion with the length modifier that matches the stored argument
+        String8 spec("%");
+        spec.append(percent + 1, prefix);
+        const char conversion = next[-1];
+        uint64_t value = 0;
+        if (type != ARG_NONE && type != ARG_STRING) {
+            if (end - args < (ptrdiff_t) sizeof(value)) {
+                return false;
+            }
+            memcpy(&value, args, sizeof(value));
+            args += sizeof(value);
+        }
+        switch (type & ARG_TYPE_MASK) {
+        case ARG_NONE:
+            body.append("%");
+            break;
+        case ARG_DOUBLE: {
+            double d;
+            memcpy(&d, &value, sizeof(d));
+            spec.append(&conversion, 1);
+            body.appendFormat(spec.string(), d);
+            } break;
+        case ARG_POINTER:
+            body.appendFormat("0x%llx", (unsigned long long) value);
+            break;
+        case ARG_STRING: {
+            if (args == end || end - args - 1 < *args) {
+                return false;
+            }
+            String8 string((const char *) args + 1, *args);
+            args += *args + 1;
+            spec.append("s");
+            body.appendFormat(spec.string(), string.string());
+            } break;
+        default:
+            if (conversion == 'c') {
+                spec.append("c");
+                body.appendFormat(spec.string(), (int) value);
+            } else {
+                spec.append("ll");
+                spec.append(&conversion, 1);
+                body.appendFormat(spec.string(), (long long) value);
+            }
+            break;
+        }
+        p = next;
+    }
+    return args == end;
+}
+
+// ---------------------------------------------------------------------------
+
 int NBLog::Entry::readAt(size_t offset) const
 {
     // FIXME This is too slow, despite the name it is used during writing
@@ -73,19 +238,26 @@ size_t NBLog::Timeline::sharedSize(size_t size)
 // ---------------------------------------------------------------------------
 
 NBLog::Writer::Writer()
-    : mSize(0), mShared(NULL), mRear(0), mEnabled(false)
+    : mSize(0), mShared(NULL), mRear(0), mEnabled(false), mFormats(NULL), mFormatCount(0)
 {
 }
 
 NBLog::Writer::Writer(size_t size, void *shared)
-    : mSize(roundup(size)), mShared((Shared *) shared), mRear(0), mEnabled(mShared != NULL)
+    : mSize(roundup(size)), mShared((Shared *) shared), mRear(0), mEnabled(mShared != NULL),
+      mFormats(mShared != NULL ? new Format[kMaxFormats] : NULL), mFormatCount(0)
 {
 }
 
 NBLog::Writer::Writer(size_t size, const sp<IMemory>& iMemory)
     : mSize(roundup(size)), mShared(iMemory != 0 ? (Shared *) iMemory->pointer() : NULL),
-      mIMemory(iMemory), mRear(0), mEnabled(mShared != NULL)
+      mIMemory(iMemory), mRear(0), mEnabled(mShared != NULL),
+      mFormats(mShared != NULL ? new Format[kMaxFormats] : NULL), mFormatCount(0)
+{
+}
+
+NBLog::Writer::~Writer()
 {
+    delete[] mFormats;
 }
 
 void NBLog::Writer::log(const char *string)
@@ -147,6 +319,132 @@ void NBLog::Writer::logTimestamp(const struct timespec& ts)
     log(EVENT_TIMESTAMP, &ts, sizeof(struct timespec));
 }
 
+void NBLog::Writer::logFormat(const char *fmt, ...)
+{
+    if (!mEnabled) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    Writer::logvFormat(fmt, ap);    // the Writer:: is needed to avoid virtual dispatch
+    va_end(ap);
+}
+
+void NBLog::Writer::logvFormat(const char *fmt, va_list ap)
+{
+    if (!mEnabled) {
+        return;
+    }
+    Format *format = getFormat(fmt);
+    if (format == NULL || !format->mBinary) {
+        Writer::logvf(fmt, ap);
+        return;
+    }
+    uint8_t buffer[255];
+    size_t length = 0;
+    buffer[length++] = format - mFormats;
+    for (size_t i = 0; i < format->mArgCount; i++) {
+        const uint8_t type = format->mArgTypes[i];
+        const bool isSigned = (type & ARG_SIGNED) != 0;
+        uint64_t value;
+        switch (type & ARG_TYPE_MASK) {
+        case ARG_INT:
+            value = isSigned ? (uint64_t) va_arg(ap, int) : va_arg(ap, unsigned);
+            break;
+        case ARG_LONG:
+            value = isSigned ? (uint64_t) va_arg(ap, long) : va_arg(ap, unsigned long);
+            break;
+        case ARG_LONG_LONG:
+            value = va_arg(ap, unsigned long long);
+            break;
+        case ARG_SIZE:
+            value = isSigned ? (uint64_t) va_arg(ap, ssize_t) : va_arg(ap, size_t);
+            break;
+        case ARG_INTMAX:
+            value = va_arg(ap, uintmax_t);
+            break;
+        case ARG_PTRDIFF: {
+            ptrdiff_t v = va_arg(ap, ptrdiff_t);
+            value = isSigned ? (uint64_t) v : (uint64_t) (size_t) v;
+            } break;
+        case ARG_DOUBLE: {
+            double d = va_arg(ap, double);
+            memcpy(&value, &d, sizeof(value));
+            } break;
+        case ARG_POINTER:
+            value = (uintptr_t) va_arg(ap, void *);
+            break;
+        case ARG_STRING: {
+            const char *string = va_arg(ap, const char *);
+            if (length >= sizeof(buffer)) {
+                return;
+            }
+            if (string == NULL) {
+                string = "(null)";
+            }
+            // strings are truncated to what remains of the entry
+            size_t n = strnlen(string, sizeof(buffer) - length - 1);
+            buffer[length++] = n;
+            memcpy(&buffer[length], string, n);
+            length += n;
+            } continue;
+        default:
+            value = 0;
+            break;
+        }
+        if (length + sizeof(value) > sizeof(buffer)) {
+            // cannot happen with kMaxFormatArgs, unless strings used up the entry
+            return;
+        }
+        memcpy(&buffer[length], &value, sizeof(value));
+        length += sizeof(value);
+    }
+    // (re)define the format unless its definition is still in the circular buffer
+    // once the entry is written
+    const size_t fmtLength = strnlen(fmt, 254);
+    if (!format->mDefined ||
+            (uint32_t) (mRear - format->mDefinedAt) + length + 3 > mSize) {
+        uint8_t define[255];
+        define[0] = buffer[0];
+        memcpy(&define[1], fmt, fmtLength);
+        format->mDefined = true;
+        format->mDefinedAt = mRear;
+        log(EVENT_FORMAT_DEFINE, define, fmtLength + 1);
+    }
+    log(EVENT_FORMAT, buffer, length);
+}
+
+NBLog::Writer::Format *NBLog::Writer::getFormat(const char *fmt)
+{
+    for (size_t i = 0; i < mFormatCount; i++) {
+        if (mFormats[i].mFmt == fmt) {
+            return &mFormats[i];
+        }
+    }
+    if (mFormats == NULL || mFormatCount >= kMaxFormats) {
+        return NULL;
+    }
+    Format *format = &mFormats[mFormatCount++];
+    format->mFmt = fmt;
+    format->mDefined = false;
+    format->mDefinedAt = 0;
+    format->mArgCount = 0;
+    format->mBinary = strlen(fmt) <= 254;
+    for (const char *p = strchr(fmt, '%'); p != NULL; p = strchr(p, '%')) {
+        uint8_t type;
+        size_t prefix;
+        p = parseConversion(p + 1, &type, &prefix);
+        if (p == NULL || (type != ARG_NONE && format->mArgCount >= kMaxFormatArgs)) {
+            format->mBinary = false;
+            break;
+        }
+        if (type != ARG_NONE) {
+            format->mArgTypes[format->mArgCount++] = type;
+        }
+    }
+    return format;
+}
+
 void NBLog::Writer::log(Event event, const void *data, size_t length)
 {
     if (!mEnabled) {
@@ -158,6 +456,8 @@ void NBLog::Writer::log(Event event, const void *data, size_t length)
     switch (event) {
     case EVENT_STRING:
     case EVENT_TIMESTAMP:
+    case EVENT_FORMAT_DEFINE:
+    case EVENT_FORMAT:
         break;
     case EVENT_RESERVED:
     default:
@@ -258,6 +558,22 @@ void NBLog::LockedWriter::logTimestamp(const struct timespec& ts)
     Writer::logTimestamp(ts);
 }
 
+void NBLog::LockedWriter::logFormat(const char *fmt, ...)
+{
+    // the format table is shared by the threads, but there is no formatting under the lock
+    Mutex::Autolock _l(mLock);
+    va_list ap;
+    va_start(ap, fmt);
+    Writer::logvFormat(fmt, ap);
+    va_end(ap);
+}
+
+void NBLog::LockedWriter::logvFormat(const char *fmt, va_list ap)
+{
+    Mutex::Autolock _l(mLock);
+    Writer::logvFormat(fmt, ap);
+}
+
 bool NBLog::LockedWriter::isEnabled() const
 {
     Mutex::Autolock _l(mLock);
@@ -273,16 +589,24 @@ bool NBLog::LockedWriter::setEnabled(bool enabled)
 // ---------------------------------------------------------------------------
 
 NBLog::Reader::Reader(size_t size, const void *shared)
-    : mSize(roundup(size)), mShared((const Shared *) shared), mFront(0)
+    : mSize(roundup(size)), mShared((const Shared *) shared), mFront(0),
+      mLines(NULL), mLineTimeNs(-1)
 {
 }
 
 NBLog::Reader::Reader(size_t size, const sp<IMemory>& iMemory)
     : mSize(roundup(size)), mShared(iMemory != 0 ? (const Shared *) iMemory->pointer() : NULL),
-      mIMemory(iMemory), mFront(0)
+      mIMemory(iMemory), mFront(0), mLines(NULL), mLineTimeNs(-1)
 {
 }
 
+void NBLog::Reader::read(Vector<Line>& lines)
+{
+    mLines = &lines;
+    dump(-1 /*fd*/, 0 /*indent*/);
+    mLines = NULL;
+}
+
 void NBLog::Reader::dump(int fd, size_t indent)
 {
     int32_t rear = android_atomic_acquire_load(&mShared->mRear);
@@ -335,6 +659,11 @@ void NBLog::Reader::dump(int fd, size_t indent)
             if (ts.tv_sec > maxSec) {
                 maxSec = ts.tv_sec;
             }
+        } else if (event == EVENT_FORMAT_DEFINE && length >= 1) {
+            // an ID keeps its format, so a definition also applies to the earlier entries
+            // whose own definition has been overwritten
+            mFormats.replaceValueFor(copy[i - length - 1],
+                    String8((const char *) &copy[i - length], length - 1));
         }
         i -= length + 3;
     }
@@ -403,7 +732,9 @@ void NBLog::Reader::dump(int fd, size_t indent)
                 deferredTimestamp = false;
             }
             timestamp.clear();
+            mLineTimeNs = ts.tv_sec * 1000000000LL + ts.tv_nsec;
             if (n >= kSquashTimestamp) {
+                mLineTimeNs += deltaTotal;
                 timestamp.appendFormat("[%d.%03d to .%.03d by .%.03d to .%.03d]",
                         (int) ts.tv_sec, (int) (ts.tv_nsec / 1000000),
                         (int) ((ts.tv_nsec + deltaTotal) / 1000000),
@@ -416,6 +747,19 @@ void NBLog::Reader::dump(int fd, size_t indent)
                     (int) (ts.tv_nsec / 1000000));
             deferredTimestamp = true;
             } break;
+        case EVENT_FORMAT_DEFINE:
+            // already added to mFormats by the scan above
+            break;
+        case EVENT_FORMAT: {
+            ssize_t index = length >= 1 ? mFormats.indexOfKey(((const uint8_t *) data)[0]) : -1;
+            if (index < 0) {
+                body.append("warning: event of an undefined format");
+            } else if (!formatArgs(body, mFormats.valueAt(index).string(),
+                    (const uint8_t *) data + 1, length - 1)) {
+                body.appendFormat("warning: corrupt event of format \"%s\"",
+                        mFormats.valueAt(index).string());
+            }
+            } break;
         case EVENT_RESERVED:
         default:
             body.appendFormat("warning: unknown event %d", event);
@@ -437,7 +781,14 @@ void NBLog::Reader::dump(int fd, size_t indent)
 
 void NBLog::Reader::dumpLine(const String8& timestamp, String8& body)
 {
-    if (mFd >= 0) {
+    if (mLines != NULL) {
+        if (!body.isEmpty()) {
+            Line line;
+            line.mTimeNs = mLineTimeNs;
+            line.mText = body;
+            mLines->add(line);
+        }
+    } else if (mFd >= 0) {
         dprintf(mFd, "%.*s%s %s\n", mIndent, "", timestamp.string(), body.string());
     } else {
         ALOGI("%.*s%s %s", mIndent, "", timestamp.string(), body.string());
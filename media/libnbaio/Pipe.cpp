@@ -17,6 +17,10 @@
 #define LOG_TAG "Pipe"
 //#define LOG_NDEBUG 0
 
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #include <cutils/atomic.h>
 #include <cutils/compiler.h>
 #include <utils/Log.h>
@@ -31,7 +35,10 @@ Pipe::Pipe(size_t maxFrames, const NBAIO_Format& format, void *buffer) :
         mBuffer(buffer == NULL ? malloc(mMaxFrames * Format_frameSize(format)) : buffer),
         mRear(0),
         mReaders(0),
-        mFreeBufferInDestructor(buffer == NULL)
+        mWaiters(0),
+        mFreeBufferInDestructor(buffer == NULL),
+        mTimestampShared(),     // zero-initialized, in case there is no reader yet
+        mTimestampMutator(&mTimestampShared)
 {
 }
 
@@ -67,7 +74,15 @@ ssize_t Pipe::write(const void *buffer, size_t count)
     }
     android_atomic_release_store(written + mRear, &mRear);
     mFramesWritten += written;
+    if (CC_UNLIKELY(android_atomic_acquire_load(&mWaiters) > 0)) {
+        (void) syscall(__NR_futex, &mRear, FUTEX_WAKE_PRIVATE, INT_MAX);
+    }
     return written;
 }
 
+void Pipe::setTimestamp(const ExtendedTimestamp& timestamp)
+{
+    mTimestampMutator.push(timestamp);
+}
+
 }   // namespace android
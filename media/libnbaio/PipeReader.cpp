@@ -17,6 +17,10 @@
 #define LOG_TAG "PipeReader"
 //#define LOG_NDEBUG 0
 
+#include <errno.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #include <cutils/compiler.h>
 #include <utils/Log.h>
 #include <media/nbaio/PipeReader.h>
@@ -29,7 +33,9 @@ PipeReader::PipeReader(Pipe& pipe) :
         // any data already in the pipe is not visible to this PipeReader
         mFront(android_atomic_acquire_load(&pipe.mRear)),
         mFramesOverrun(0),
-        mOverruns(0)
+        mOverruns(0),
+        mTimestampObserver(&pipe.mTimestampShared),
+        mHaveTimestamp(false)
 {
     android_atomic_inc(&pipe.mReaders);
 }
@@ -64,6 +70,54 @@ ssize_t PipeReader::availableToRead()
     return avail;
 }
 
+ssize_t PipeReader::waitAvailable(nsecs_t timeoutNs)
+{
+    ssize_t avail = availableToRead();
+    if (avail != 0 || timeoutNs <= 0) {
+        return avail;
+    }
+    android_atomic_inc(&mPipe.mWaiters);
+    const nsecs_t deadlineNs = systemTime() + timeoutNs;
+    for (;;) {
+        // the futex compares mRear with the value checked, so a write in between is not missed
+        int32_t rear = android_atomic_acquire_load(&mPipe.mRear);
+        if (rear != mFront) {
+            break;
+        }
+        nsecs_t remainingNs = deadlineNs - systemTime();
+        if (remainingNs <= 0) {
+            break;
+        }
+        struct timespec ts;
+        ts.tv_sec = remainingNs / 1000000000LL;
+        ts.tv_nsec = remainingNs % 1000000000LL;
+        if (syscall(__NR_futex, &mPipe.mRear, FUTEX_WAIT_PRIVATE, rear, &ts) < 0 &&
+                errno != EINTR && errno != EAGAIN && errno != ETIMEDOUT) {
+            ALOGE("%s futex error %d", __func__, errno);
+            break;
+        }
+    }
+    android_atomic_dec(&mPipe.mWaiters);
+    return availableToRead();
+}
+
+status_t PipeReader::getTimestamp(ExtendedTimestamp& timestamp)
+{
+    ExtendedTimestamp ets;
+    if (mTimestampObserver.poll(ets)) {
+        mTimestamp = ets;
+        mHaveTimestamp = true;
+    }
+    if (!mHaveTimestamp) {
+        return INVALID_OPERATION;
+    }
+    timestamp.mPosition[ExtendedTimestamp::LOCATION_KERNEL] =
+            mTimestamp.mPosition[ExtendedTimestamp::LOCATION_KERNEL];
+    timestamp.mTimeNs[ExtendedTimestamp::LOCATION_KERNEL] =
+            mTimestamp.mTimeNs[ExtendedTimestamp::LOCATION_KERNEL];
+    return OK;
+}
+
 ssize_t PipeReader::read(void *buffer, size_t count)
 {
     ssize_t avail = availableToRead();
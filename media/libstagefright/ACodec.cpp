@@ -22,6 +22,7 @@
 #endif
 
 #include <inttypes.h>
+#include <unistd.h>
 #include <utils/Trace.h>
 
 #include <gui/Surface.h>
@@ -519,6 +520,7 @@ ACodec::ACodec()
       mRepeatFrameDelayUs(-1ll),
       mMaxPtsGapUs(-1ll),
       mMaxFps(-1),
+      mMaxInputLatencyUs(-1ll),
       mTimePerFrameUs(-1ll),
       mTimePerCaptureUs(-1ll),
       mCreateInputBuffersSuspended(false),
@@ -538,6 +540,16 @@ ACodec::ACodec()
     mIdleToLoadedState = new IdleToLoadedState(this);
     mFlushingState = new FlushingState(this);
 
+    mUninitializedState->setName("ACodec::Uninitialized");
+    mLoadedState->setName("ACodec::Loaded");
+    mLoadedToIdleState->setName("ACodec::LoadedToIdle");
+    mIdleToExecutingState->setName("ACodec::IdleToExecuting");
+    mExecutingState->setName("ACodec::Executing");
+    mOutputPortSettingsChangedState->setName("ACodec::OutputPortSettingsChanged");
+    mExecutingToIdleState->setName("ACodec::ExecutingToIdle");
+    mIdleToLoadedState->setName("ACodec::IdleToLoaded");
+    mFlushingState->setName("ACodec::Flushing");
+
     mPortEOS[kPortIndexInput] = mPortEOS[kPortIndexOutput] = false;
     mInputEOSResult = OK;
 
@@ -861,10 +873,19 @@ status_t ACodec::allocateBuffersOnPort(OMX_U32 portIndex) {
             size_t totalSize = def.nBufferCountActual * (alignedSize + alignedConvSize);
             mDealer[portIndex] = new MemoryDealer(totalSize, "ACodec");
 
+            // allocateSecureBuffer only returns a usable pointer in the process of the node
+            const bool omxLivesLocally = !(mFlags & kFlagIsSecure)
+                    && mOMX->livesLocally(mNode, getpid());
+
+            // buffers to pass to useBuffers() at once, and their index in mBuffers
+            Vector<sp<IMemory> > useMems;
+            Vector<size_t> useIndices;
+
             for (OMX_U32 i = 0; i < def.nBufferCountActual && err == OK; ++i) {
                 sp<IMemory> mem = mDealer[portIndex]->allocate(bufSize);
                 if (mem == NULL || mem->pointer() == NULL) {
-                    return NO_MEMORY;
+                    err = NO_MEMORY;
+                    break;
                 }
 
                 BufferInfo info;
@@ -901,11 +922,47 @@ status_t ACodec::allocateBuffersOnPort(OMX_U32 portIndex) {
                             ptr != NULL ? ptr : (void *)native_handle_ptr, bufSize);
                     info.mNativeHandle = native_handle;
                     info.mCodecData = info.mData;
+                } else if ((mQuirks & requiresAllocateBufferBit)
+                        && type == kMetadataBufferTypeInvalid && omxLivesLocally) {
+                    // The buffers allocated by the component are in our address space, so
+                    // use them directly instead of copying through a backup buffer.
+                    mem.clear();
+
+                    void *ptr = NULL;
+                    sp<NativeHandle> native_handle;
+                    err = mOMX->allocateSecureBuffer(
+                            mNode, portIndex, bufSize, &info.mBufferID,
+                            &ptr, &native_handle);
+                    if (err == OK && (ptr == NULL || native_handle != NULL)) {
+                        ALOGE("[%s] component did not allocate a plain buffer on %s port",
+                                mComponentName.c_str(),
+                                portIndex == kPortIndexInput ? "input" : "output");
+                        mOMX->freeBuffer(mNode, portIndex, info.mBufferID);
+                        err = UNKNOWN_ERROR;
+                    }
+                    if (err == OK) {
+                        info.mCodecData = new ABuffer(ptr, bufSize);
+                        if (mConverter[portIndex] != NULL) {
+                            CHECK_GT(conversionBufferSize, (size_t)0);
+                            sp<IMemory> convMem = mDealer[portIndex]->allocate(
+                                    conversionBufferSize);
+                            if (convMem == NULL || convMem->pointer() == NULL) {
+                                mOMX->freeBuffer(mNode, portIndex, info.mBufferID);
+                                return NO_MEMORY;
+                            }
+                            info.mData = new ABuffer(convMem->pointer(), conversionBufferSize);
+                            info.mMemRef = convMem;
+                        } else {
+                            info.mData = info.mCodecData;
+                        }
+                    }
                 } else if (mQuirks & requiresAllocateBufferBit) {
                     err = mOMX->allocateBufferWithBackup(
                             mNode, portIndex, mem, &info.mBufferID, allottedSize);
                 } else {
-                    err = mOMX->useBuffer(mNode, portIndex, mem, &info.mBufferID, allottedSize);
+                    info.mBufferID = 0;
+                    useMems.push(mem);
+                    useIndices.push(mBuffers[portIndex].size());
                 }
 
                 if (mem != NULL) {
@@ -922,10 +979,11 @@ status_t ACodec::allocateBuffersOnPort(OMX_U32 portIndex) {
                         CHECK_GT(conversionBufferSize, (size_t)0);
                         mem = mDealer[portIndex]->allocate(conversionBufferSize);
                         if (mem == NULL|| mem->pointer() == NULL) {
-                            return NO_MEMORY;
+                            err = NO_MEMORY;
+                        } else {
+                            info.mData = new ABuffer(mem->pointer(), conversionBufferSize);
+                            info.mMemRef = mem;
                         }
-                        info.mData = new ABuffer(mem->pointer(), conversionBufferSize);
-                        info.mMemRef = mem;
                     } else {
                         info.mData = info.mCodecData;
                         info.mMemRef = info.mCodecRef;
@@ -934,6 +992,23 @@ status_t ACodec::allocateBuffersOnPort(OMX_U32 portIndex) {
 
                 mBuffers[portIndex].push(info);
             }
+
+            if (!useMems.isEmpty()) {
+                // one IOMX call for all the buffers of the port, instead of one per buffer
+                Vector<IOMX::buffer_id> bufferIDs;
+                if (err == OK) {
+                    err = mOMX->useBuffers(mNode, portIndex, useMems, &bufferIDs, allottedSize);
+                }
+                CHECK_LE(bufferIDs.size(), useIndices.size());
+                for (size_t j = 0; j < bufferIDs.size(); ++j) {
+                    mBuffers[portIndex].editItemAt(useIndices[j]).mBufferID = bufferIDs[j];
+                }
+
+                // the buffers not given to the component are not to be freed
+                for (size_t j = useIndices.size(); j > bufferIDs.size(); --j) {
+                    mBuffers[portIndex].removeAt(useIndices[j - 1]);
+                }
+            }
         }
     }
 
@@ -1879,6 +1954,10 @@ status_t ACodec::configureCodec(
             mMaxFps = -1;
         }
 
+        if (!msg->findInt64("max-input-latency-to-encoder", &mMaxInputLatencyUs)) {
+            mMaxInputLatencyUs = -1ll;
+        }
+
         if (!msg->findInt64("time-lapse", &mTimePerCaptureUs)) {
             mTimePerCaptureUs = -1ll;
         }
@@ -2071,8 +2150,12 @@ status_t ACodec::configureCodec(
         // determine need for software renderer
         bool usingSwRenderer = false;
         if (haveNativeWindow && mComponentName.startsWith("OMX.google.")) {
-            usingSwRenderer = true;
-            haveNativeWindow = false;
+            // unless the component can write into the graphic buffers of the window itself
+            if (encoder || mOMX->enableNativeBuffers(
+                    mNode, kPortIndexOutput, OMX_TRUE /* graphic */, OMX_FALSE) != OK) {
+                usingSwRenderer = true;
+                haveNativeWindow = false;
+            }
         }
 
         if (encoder) {
@@ -2323,6 +2406,16 @@ status_t ACodec::configureCodec(
         err = setPriority(priority);
     }
 
+    int32_t batchDurationUs;
+    if (!encoder && !video && msg->findInt32("output-batch-duration-us", &batchDurationUs)) {
+        err = setOutputBatchDuration(batchDurationUs);
+    }
+
+    int32_t lowLatency;
+    if (!encoder && !video && msg->findInt32("low-latency", &lowLatency)) {
+        err = setLowLatency(lowLatency != 0);
+    }
+
     int32_t rateInt = -1;
     float rateFloat = -1;
     if (!msg->findFloat("operating-rate", &rateFloat)) {
@@ -2384,6 +2477,46 @@ status_t ACodec::setPriority(int32_t priority) {
     return OK;
 }
 
+status_t ACodec::setOutputBatchDuration(int32_t durationUs) {
+    if (durationUs < 0) {
+        return BAD_VALUE;
+    }
+    OMX_INDEXTYPE index;
+    status_t err = mOMX->getExtensionIndex(
+            mNode, "OMX.google.android.index.outputBatchDurationUs", &index);
+    if (err != OK) {
+        ALOGI("codec does not support output batching (err %d)", err);
+        return OK;
+    }
+    OMX_PARAM_U32TYPE params;
+    InitOMXParams(&params);
+    params.nPortIndex = kPortIndexOutput;
+    params.nU32 = (OMX_U32)durationUs;
+    err = mOMX->setParameter(mNode, index, &params, sizeof(params));
+    if (err != OK) {
+        ALOGI("codec does not support output batch duration %d us (err %d)", durationUs, err);
+    }
+    return OK;
+}
+
+status_t ACodec::setLowLatency(bool enable) {
+    OMX_INDEXTYPE index;
+    status_t err = mOMX->getExtensionIndex(
+            mNode, "OMX.google.android.index.lowLatency", &index);
+    if (err != OK) {
+        ALOGI("codec does not support low latency mode (err %d)", err);
+        return OK;
+    }
+    OMX_CONFIG_BOOLEANTYPE params;
+    InitOMXParams(&params);
+    params.bEnabled = enable ? OMX_TRUE : OMX_FALSE;
+    err = mOMX->setParameter(mNode, index, &params, sizeof(params));
+    if (err != OK) {
+        ALOGI("codec does not support low latency mode %d (err %d)", enable, err);
+    }
+    return OK;
+}
+
 status_t ACodec::setOperatingRate(float rateFloat, bool isVideo) {
     if (rateFloat < 0) {
         return BAD_VALUE;
@@ -5555,6 +5688,10 @@ void ACodec::signalError(OMX_ERRORTYPE error, status_t internalError) {
 
     mFatalError = true;
 
+    AString history;
+    dumpStateHistory(&history);
+    ALOGW("%s", history.c_str());
+
     notify->setInt32("err", internalError);
     notify->setInt32("actionCode", ACTION_CODE_FATAL); // could translate from OMX error.
     notify->post();
@@ -6058,12 +6195,15 @@ void ACodec::BaseState::onInputBufferFilled(const sp<AMessage> &msg) {
 #endif
                 }
 
-#if TRACK_BUFFER_TIMING
-                ACodec::BufferStats stats;
-                stats.mEmptyBufferTimeUs = ALooper::GetNowUs();
-                stats.mFillBufferDoneTimeUs = -1ll;
-                mCodec->mBufferStats.add(timeUs, stats);
-#endif
+                if (!(flags & OMX_BUFFERFLAG_CODECCONFIG)) {
+                    if (mCodec->mBufferStats.size() >= ACodec::kMaxBufferStats) {
+                        mCodec->mBufferStats.removeItemsAt(0);  // the earliest
+                    }
+                    ACodec::BufferStats stats;
+                    stats.mEmptyBufferTimeUs = ALooper::GetNowUs();
+                    stats.mFillBufferDoneTimeUs = -1ll;
+                    mCodec->mBufferStats.add(timeUs, stats);
+                }
 
                 if (mCodec->storingMetadataInDecodedBuffers()) {
                     // try to submit an output buffer for each input buffer
@@ -6225,20 +6365,21 @@ bool ACodec::BaseState::onOMXFillBufferDone(
     ssize_t index;
     status_t err= OK;
 
-#if TRACK_BUFFER_TIMING
+    ACodec::BufferStats stats;
+    stats.mEmptyBufferTimeUs = -1ll;
+    stats.mFillBufferDoneTimeUs = ALooper::GetNowUs();
     index = mCodec->mBufferStats.indexOfKey(timeUs);
     if (index >= 0) {
-        ACodec::BufferStats *stats = &mCodec->mBufferStats.editValueAt(index);
-        stats->mFillBufferDoneTimeUs = ALooper::GetNowUs();
+        stats.mEmptyBufferTimeUs = mCodec->mBufferStats.valueAt(index).mEmptyBufferTimeUs;
 
+#if TRACK_BUFFER_TIMING
         ALOGI("frame PTS %lld: %lld",
-                timeUs,
-                stats->mFillBufferDoneTimeUs - stats->mEmptyBufferTimeUs);
+                (long long)timeUs,
+                (long long)(stats.mFillBufferDoneTimeUs - stats.mEmptyBufferTimeUs));
+#endif
 
         mCodec->mBufferStats.removeItemsAt(index);
-        stats = NULL;
     }
-#endif
 
     BufferInfo *info =
         mCodec->findBufferByID(kPortIndexOutput, bufferID, &index);
@@ -6368,6 +6509,10 @@ bool ACodec::BaseState::onOMXFillBufferDone(
             notify->setInt32("buffer-id", info->mBufferID);
             notify->setBuffer("buffer", info->mData);
             notify->setInt32("flags", flags);
+            if (stats.mEmptyBufferTimeUs >= 0ll) {
+                notify->setInt64("empty-time-us", stats.mEmptyBufferTimeUs);
+            }
+            notify->setInt64("fill-done-time-us", stats.mFillBufferDoneTimeUs);
 
             reply->setInt32("buffer-id", info->mBufferID);
 
@@ -6949,6 +7094,22 @@ status_t ACodec::LoadedState::setupInputSurface() {
         }
     }
 
+    if (mCodec->mMaxInputLatencyUs > 0ll) {
+        err = mCodec->mOMX->setInternalOption(
+                mCodec->mNode,
+                kPortIndexInput,
+                IOMX::INTERNAL_OPTION_MAX_INPUT_LATENCY,
+                &mCodec->mMaxInputLatencyUs,
+                sizeof(mCodec->mMaxInputLatencyUs));
+
+        if (err != OK) {
+            ALOGE("[%s] Unable to configure max input latency (err %d)",
+                    mCodec->mComponentName.c_str(),
+                    err);
+            return err;
+        }
+    }
+
     if (mCodec->mTimePerCaptureUs > 0ll
             && mCodec->mTimePerFrameUs > 0ll) {
         int64_t timeLapse[2];
@@ -21,6 +21,7 @@ LOCAL_SRC_FILES:=                         \
         ESDS.cpp                          \
         FileSource.cpp                    \
         FLACExtractor.cpp                 \
+        FrameIndexSeeker.cpp              \
         FrameRenderTracker.cpp            \
         HTTPBase.cpp                      \
         HevcUtils.cpp                     \
@@ -42,6 +43,7 @@ LOCAL_SRC_FILES:=                         \
         http/MediaHTTP.cpp                \
         MediaMuxer.cpp                    \
         MediaSource.cpp                   \
+        MediaSourceSplitter.cpp           \
         NuCachedSource2.cpp               \
         NuMediaExtractor.cpp              \
         OMXClient.cpp                     \
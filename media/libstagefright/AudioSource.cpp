@@ -52,7 +52,7 @@ static void AudioRecordCallbackFunction(int event, void *user, void *info) {
 AudioSource::AudioSource(
         audio_source_t inputSource, const String16 &opPackageName,
         uint32_t sampleRate, uint32_t channelCount, uint32_t outSampleRate,
-        uid_t uid, pid_t pid)
+        uid_t uid, pid_t pid, audio_input_flags_t flags)
     : mStarted(false),
       mSampleRate(sampleRate),
       mOutSampleRate(outSampleRate > 0 ? outSampleRate : sampleRate),
@@ -63,8 +63,8 @@ AudioSource::AudioSource(
       mInitialReadTimeUs(0),
       mNumFramesReceived(0),
       mNumClientOwnedBuffers(0) {
-    ALOGV("sampleRate: %u, outSampleRate: %u, channelCount: %u",
-            sampleRate, outSampleRate, channelCount);
+    ALOGV("sampleRate: %u, outSampleRate: %u, channelCount: %u, flags: %#x",
+            sampleRate, outSampleRate, channelCount, flags);
     CHECK(channelCount == 1 || channelCount == 2);
     CHECK(sampleRate > 0);
 
@@ -94,7 +94,7 @@ AudioSource::AudioSource(
                     frameCount /*notificationFrames*/,
                     AUDIO_SESSION_ALLOCATE,
                     AudioRecord::TRANSFER_DEFAULT,
-                    AUDIO_INPUT_FLAG_NONE,
+                    flags,
                     uid,
                     pid);
         mInitCheck = mRecord->initCheck();
@@ -110,6 +110,9 @@ AudioSource::~AudioSource() {
     if (mStarted) {
         reset();
     }
+
+    Mutex::Autolock autoLock(mLock);
+    freeBufferPool_l();
 }
 
 status_t AudioSource::initCheck() const {
@@ -150,11 +153,41 @@ void AudioSource::releaseQueuedFrames_l() {
     List<MediaBuffer *>::iterator it;
     while (!mBuffersReceived.empty()) {
         it = mBuffersReceived.begin();
-        (*it)->release();
+        recycleBuffer_l(*it);
         mBuffersReceived.erase(it);
     }
 }
 
+MediaBuffer *AudioSource::obtainBuffer_l(size_t size) {
+    MediaBuffer *buffer;
+    if (size <= kMaxBufferSize && !mBufferPool.empty()) {
+        buffer = *mBufferPool.begin();
+        mBufferPool.erase(mBufferPool.begin());
+    } else {
+        buffer = new MediaBuffer(size > kMaxBufferSize ? size : kMaxBufferSize);
+    }
+    buffer->set_range(0, size);
+    return buffer;
+}
+
+void AudioSource::recycleBuffer_l(MediaBuffer *buffer) {
+    if (buffer->size() != kMaxBufferSize || mBufferPool.size() >= kMaxNumPooledBuffers) {
+        buffer->release();
+        return;
+    }
+    buffer->reset();
+    mBufferPool.push_back(buffer);
+}
+
+void AudioSource::freeBufferPool_l() {
+    List<MediaBuffer *>::iterator it;
+    while (!mBufferPool.empty()) {
+        it = mBufferPool.begin();
+        (*it)->release();
+        mBufferPool.erase(it);
+    }
+}
+
 void AudioSource::waitOutstandingEncodingFrames_l() {
     ALOGV("waitOutstandingEncodingFrames_l: %" PRId64, mNumClientOwnedBuffers);
     while (mNumClientOwnedBuffers > 0) {
@@ -178,6 +211,7 @@ status_t AudioSource::reset() {
     mRecord->stop();
     waitOutstandingEncodingFrames_l();
     releaseQueuedFrames_l();
+    freeBufferPool_l();
 
     return OK;
 }
@@ -289,7 +323,7 @@ void AudioSource::signalBufferReturned(MediaBuffer *buffer) {
     Mutex::Autolock autoLock(mLock);
     --mNumClientOwnedBuffers;
     buffer->setObserver(0);
-    buffer->release();
+    recycleBuffer_l(buffer);
     mFrameEncodingCompletionCondition.signal();
     return;
 }
@@ -351,9 +385,8 @@ status_t AudioSource::dataCallback(const AudioRecord::Buffer& audioBuffer) {
         } else {
             numLostBytes = 0;
         }
-        MediaBuffer *lostAudioBuffer = new MediaBuffer(bufferSize);
+        MediaBuffer *lostAudioBuffer = obtainBuffer_l(bufferSize);
         memset(lostAudioBuffer->data(), 0, bufferSize);
-        lostAudioBuffer->set_range(0, bufferSize);
         queueInputBuffer_l(lostAudioBuffer, timeUs);
     }
 
@@ -362,11 +395,11 @@ status_t AudioSource::dataCallback(const AudioRecord::Buffer& audioBuffer) {
         return OK;
     }
 
-    const size_t bufferSize = audioBuffer.size;
-    MediaBuffer *buffer = new MediaBuffer(bufferSize);
+    // The AudioRecord buffer is handed back when the callback returns, so the
+    // data is copied, but into a pooled buffer rather than a new allocation.
+    MediaBuffer *buffer = obtainBuffer_l(audioBuffer.size);
     memcpy((uint8_t *) buffer->data(),
             audioBuffer.i16, audioBuffer.size);
-    buffer->set_range(0, bufferSize);
     queueInputBuffer_l(buffer, timeUs);
     return OK;
 }
@@ -31,7 +31,8 @@ namespace android {
 CallbackDataSource::CallbackDataSource(
     const sp<IDataSource>& binderDataSource)
     : mIDataSource(binderDataSource),
-      mIsClosed(false) {
+      mIsClosed(false),
+      mReadAtRangesUnsupported(false) {
     // Set up the buffer to read into.
     mMemory = mIDataSource->getIMemory();
     mName = String8::format("CallbackDataSource(%s)", mIDataSource->toString().string());
@@ -85,6 +86,71 @@ ssize_t CallbackDataSource::readAt(off64_t offset, void* data, size_t size) {
     return totalNumRead;
 }
 
+void CallbackDataSource::readAtRanges(ReadRange *ranges, size_t count) {
+    if (mMemory == NULL || mReadAtRangesUnsupported) {
+        DataSource::readAtRanges(ranges, count);
+        return;
+    }
+
+    const size_t bufferSize = mMemory->size();
+    size_t i = 0;
+    while (i < count) {
+        if (ranges[i].mSize > bufferSize / 2) {
+            // nothing to gain from batching a large read
+            ranges[i].mResult = readAt(ranges[i].mOffset, ranges[i].mData, ranges[i].mSize);
+            ++i;
+            continue;
+        }
+
+        size_t batchCount = 0;
+        size_t batchSize = 0;
+        while (i + batchCount < count && batchCount < IDataSource::kMaxReadRanges
+                && ranges[i + batchCount].mSize <= bufferSize - batchSize) {
+            batchSize += ranges[i + batchCount].mSize;
+            ++batchCount;
+        }
+
+        status_t err = readBatch(&ranges[i], batchCount);
+        if (err != OK) {
+            if (err == INVALID_OPERATION) {
+                ALOGV("readAtRanges unsupported, reading one range at a time");
+                mReadAtRangesUnsupported = true;
+            }
+            DataSource::readAtRanges(&ranges[i], count - i);
+            return;
+        }
+        i += batchCount;
+    }
+}
+
+status_t CallbackDataSource::readBatch(ReadRange *ranges, size_t count) {
+    off64_t offsets[IDataSource::kMaxReadRanges];
+    size_t sizes[IDataSource::kMaxReadRanges];
+    ssize_t results[IDataSource::kMaxReadRanges];
+    for (size_t i = 0; i < count; ++i) {
+        offsets[i] = ranges[i].mOffset;
+        sizes[i] = ranges[i].mSize;
+    }
+
+    status_t err = mIDataSource->readAtRanges(count, offsets, sizes, results);
+    if (err != OK) {
+        return err;
+    }
+
+    const uint8_t *data = (const uint8_t *)mMemory->pointer();
+    for (size_t i = 0; i < count; ++i) {
+        ssize_t numRead = results[i];
+        if (numRead > 0 && (size_t)numRead > sizes[i]) {
+            numRead = ERROR_OUT_OF_RANGE;
+        } else if (numRead > 0) {
+            memcpy(ranges[i].mData, data, numRead);
+        }
+        ranges[i].mResult = numRead;
+        data += sizes[i];
+    }
+    return OK;
+}
+
 status_t CallbackDataSource::getSize(off64_t *size) {
     status_t err = mIDataSource->getSize(size);
     if (err != OK) {
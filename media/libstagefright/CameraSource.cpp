@@ -212,7 +212,12 @@ CameraSource::CameraSource(
       mNumFramesDropped(0),
       mNumGlitches(0),
       mGlitchDurationThresholdUs(200000),
-      mCollectStats(false) {
+      mCollectStats(false),
+      mTotalQueueDelayUs(0),
+      mMaxQueueDelayUs(0),
+      mTotalEncodeDelayUs(0),
+      mMaxEncodeDelayUs(0),
+      mNumMemoryBaseTimeouts(0) {
     mVideoSize.width  = -1;
     mVideoSize.height = -1;
 
@@ -908,6 +913,13 @@ status_t CameraSource::reset() {
             ALOGI("Frames received/encoded/dropped: %d/%d/%d in %" PRId64 " us",
                     mNumFramesReceived, mNumFramesEncoded, mNumFramesDropped,
                     mLastFrameTimestampUs - mFirstFrameTimeUs);
+            if (mNumFramesEncoded > 0) {
+                ALOGI("Frame delays (avg/max): %" PRId64 "/%" PRId64 " us queued, "
+                        "%" PRId64 "/%" PRId64 " us encoding, %d memory base timeouts",
+                        mTotalQueueDelayUs / mNumFramesEncoded, mMaxQueueDelayUs,
+                        mTotalEncodeDelayUs / mNumFramesEncoded, mMaxEncodeDelayUs,
+                        mNumMemoryBaseTimeouts);
+            }
         }
 
         if (mNumGlitches > 0) {
@@ -998,6 +1010,18 @@ void CameraSource::releaseQueuedFrames() {
         mFramesReceived.erase(it);
         ++mNumFramesDropped;
     }
+    mFrameTimes.clear();
+    mFrameQueueTimes.clear();
+}
+
+void CameraSource::queueFrameLocked(const sp<IMemory> &data, int64_t timestampUs) {
+    mFramesReceived.push_back(data);
+    int64_t timeUs = mStartTimeUs + (timestampUs - mFirstFrameTimeUs);
+    mFrameTimes.push_back(timeUs);
+    mFrameQueueTimes.push_back(systemTime());
+    ALOGV("initial delay: %" PRId64 ", current time stamp: %" PRId64,
+        mStartTimeUs, timeUs);
+    mFrameAvailableCondition.signal();
 }
 
 sp<MetaData> CameraSource::getFormat() {
@@ -1011,11 +1035,20 @@ void CameraSource::releaseOneRecordingFrame(const sp<IMemory>& frame) {
 void CameraSource::signalBufferReturned(MediaBuffer *buffer) {
     ALOGV("signalBufferReturned: %p", buffer->data());
     Mutex::Autolock autoLock(mLock);
+    List<nsecs_t>::iterator readTime = mFrameReadTimes.begin();
     for (List<sp<IMemory> >::iterator it = mFramesBeingEncoded.begin();
-         it != mFramesBeingEncoded.end(); ++it) {
+         it != mFramesBeingEncoded.end(); ++it, ++readTime) {
         if ((*it)->pointer() ==  buffer->data()) {
             releaseOneRecordingFrame((*it));
             mFramesBeingEncoded.erase(it);
+            if (mCollectStats) {
+                int64_t delayUs = (systemTime() - *readTime) / 1000;
+                mTotalEncodeDelayUs += delayUs;
+                if (delayUs > mMaxEncodeDelayUs) {
+                    mMaxEncodeDelayUs = delayUs;
+                }
+            }
+            mFrameReadTimes.erase(readTime);
             ++mNumFramesEncoded;
             buffer->setObserver(0);
             buffer->release();
@@ -1064,7 +1097,19 @@ status_t CameraSource::read(
 
         frameTime = *mFrameTimes.begin();
         mFrameTimes.erase(mFrameTimes.begin());
+
+        nsecs_t now = systemTime();
+        if (mCollectStats) {
+            int64_t delayUs = (now - *mFrameQueueTimes.begin()) / 1000;
+            mTotalQueueDelayUs += delayUs;
+            if (delayUs > mMaxQueueDelayUs) {
+                mMaxQueueDelayUs = delayUs;
+            }
+        }
+        mFrameQueueTimes.erase(mFrameQueueTimes.begin());
+
         mFramesBeingEncoded.push_back(frame);
+        mFrameReadTimes.push_back(now);
         *buffer = new MediaBuffer(frame->pointer(), frame->size());
         (*buffer)->setObserver(this);
         (*buffer)->add_ref();
@@ -1126,12 +1171,7 @@ void CameraSource::dataCallbackTimestamp(int64_t timestampUs,
     ++mNumFramesReceived;
 
     CHECK(data != NULL && data->size() > 0);
-    mFramesReceived.push_back(data);
-    int64_t timeUs = mStartTimeUs + (timestampUs - mFirstFrameTimeUs);
-    mFrameTimes.push_back(timeUs);
-    ALOGV("initial delay: %" PRId64 ", current time stamp: %" PRId64,
-        mStartTimeUs, timeUs);
-    mFrameAvailableCondition.signal();
+    queueFrameLocked(data, timestampUs);
 }
 
 void CameraSource::releaseRecordingFrameHandle(native_handle_t* handle) {
@@ -1162,6 +1202,7 @@ void CameraSource::recordingFrameHandleCallbackTimestamp(int64_t timestampUs,
         if (mMemoryBaseAvailableCond.waitRelative(mLock, kMemoryBaseAvailableTimeoutNs) ==
                 TIMED_OUT) {
             ALOGW("Waiting on an available memory base timed out. Dropping a recording frame.");
+            ++mNumMemoryBaseTimeouts;
             releaseRecordingFrameHandle(handle);
             return;
         }
@@ -1177,11 +1218,7 @@ void CameraSource::recordingFrameHandleCallbackTimestamp(int64_t timestampUs,
     metadata->eType = kMetadataBufferTypeNativeHandleSource;
     metadata->pHandle = handle;
 
-    mFramesReceived.push_back(data);
-    int64_t timeUs = mStartTimeUs + (timestampUs - mFirstFrameTimeUs);
-    mFrameTimes.push_back(timeUs);
-    ALOGV("initial delay: %" PRId64 ", current time stamp: %" PRId64, mStartTimeUs, timeUs);
-    mFrameAvailableCondition.signal();
+    queueFrameLocked(data, timestampUs);
 }
 
 CameraSource::BufferQueueListener::BufferQueueListener(const sp<BufferItemConsumer>& consumer,
@@ -1238,6 +1275,7 @@ void CameraSource::processBufferQueueFrame(BufferItem& buffer) {
         if (mMemoryBaseAvailableCond.waitRelative(mLock, kMemoryBaseAvailableTimeoutNs) ==
                 TIMED_OUT) {
             ALOGW("Waiting on an available memory base timed out. Dropping a recording frame.");
+            ++mNumMemoryBaseTimeouts;
             mVideoBufferConsumer->releaseBuffer(buffer);
             return;
         }
@@ -1263,12 +1301,7 @@ void CameraSource::processBufferQueueFrame(BufferItem& buffer) {
     // when the encoder returns the native window buffer.
     mReceivedBufferItemMap.add(payload->pBuffer, buffer);
 
-    mFramesReceived.push_back(data);
-    int64_t timeUs = mStartTimeUs + (timestampUs - mFirstFrameTimeUs);
-    mFrameTimes.push_back(timeUs);
-    ALOGV("initial delay: %" PRId64 ", current time stamp: %" PRId64,
-        mStartTimeUs, timeUs);
-    mFrameAvailableCondition.signal();
+    queueFrameLocked(data, timestampUs);
 }
 
 MetadataBufferType CameraSource::metaDataStoredInVideoBuffers() const {
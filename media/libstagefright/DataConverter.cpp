@@ -25,6 +25,19 @@
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/foundation/AUtils.h>
 
+#if defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#define USE_CONVERTER_NEON 1
+#define USE_CONVERTER_SSE 0
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_CONVERTER_NEON 0
+#define USE_CONVERTER_SSE 1
+#else
+#define USE_CONVERTER_NEON 0
+#define USE_CONVERTER_SSE 0
+#endif
+
 namespace android {
 
 status_t DataConverter::convert(const sp<ABuffer> &source, sp<ABuffer> &target) {
@@ -91,6 +104,65 @@ static size_t getAudioSampleSize(AudioEncoding e) {
 }
 
 
+// Vectorized versions of memcpy_to_float_from_i16() and memcpy_to_i16_from_float(), the
+// conversions of decoders and encoders with float PCM. They produce the same results as
+// audio_utils for all non-NaN input: floats are rounded to the nearest integer (ties to even)
+// and clamped. Leftover samples are converted by audio_utils.
+static void convertFloatFromI16(float *dst, const int16_t *src, size_t count) {
+    size_t i = 0;
+#if USE_CONVERTER_NEON
+    const float32x4_t scale = vdupq_n_f32(1.0f / (1 << 15));
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t in = vld1q_s16(src + i);
+        vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(in))), scale));
+        vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(in))), scale));
+    }
+#elif USE_CONVERTER_SSE
+    const __m128 scale = _mm_set1_ps(1.0f / (1 << 15));
+    for (; i + 8 <= count; i += 8) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+        // sign extend by unpacking into the high halves, then shifting down
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+#endif
+    memcpy_to_float_from_i16(dst + i, src + i, count - i);
+}
+
+static void convertI16FromFloat(int16_t *dst, const float *src, size_t count) {
+    size_t i = 0;
+#if USE_CONVERTER_NEON
+    // same as clamp16_from_float(): adding 384 leaves the rounded sample in the low 16 bits
+    // of the significand, and the bit patterns of the sums order like the floats do.
+    const float32x4_t offset = vdupq_n_f32(384.0f);
+    const int32x4_t limNeg = vdupq_n_s32(0x43bf8000);  // 384 - 32768 ulps
+    const int32x4_t limPos = vdupq_n_s32(0x43c07fff);  // 384 + 32767 ulps
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t lo = vreinterpretq_s32_f32(vaddq_f32(vld1q_f32(src + i), offset));
+        int32x4_t hi = vreinterpretq_s32_f32(vaddq_f32(vld1q_f32(src + i + 4), offset));
+        lo = vminq_s32(vmaxq_s32(lo, limNeg), limPos);
+        hi = vminq_s32(vmaxq_s32(hi, limNeg), limPos);
+        vst1q_s16(dst + i, vcombine_s16(vmovn_s32(lo), vmovn_s32(hi)));
+    }
+#elif USE_CONVERTER_SSE
+    // the conversion rounds to nearest even in the default rounding mode
+    const __m128 scale = _mm_set1_ps(1 << 15);
+    const __m128 limNeg = _mm_set1_ps(-32768.0f);
+    const __m128 limPos = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128 lo = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        __m128 hi = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+        lo = _mm_min_ps(_mm_max_ps(lo, limNeg), limPos);
+        hi = _mm_min_ps(_mm_max_ps(hi, limNeg), limPos);
+        _mm_storeu_si128((__m128i *)(dst + i),
+                _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi)));
+    }
+#endif
+    memcpy_to_i16_from_float(dst + i, src + i, count - i);
+}
+
 // static
 AudioConverter* AudioConverter::Create(AudioEncoding source, AudioEncoding target) {
     uint32_t sourceSampleSize = getAudioSampleSize(source);
@@ -109,11 +181,11 @@ status_t AudioConverter::safeConvert(const sp<ABuffer> &src, sp<ABuffer> &tgt) {
     } else if (mTo == kAudioEncodingPcm16bit && mFrom == kAudioEncodingPcm8bit) {
         memcpy_to_i16_from_u8((int16_t*)tgt->base(), (const uint8_t*)src->data(), src->size());
     } else if (mTo == kAudioEncodingPcm16bit && mFrom == kAudioEncodingPcmFloat) {
-        memcpy_to_i16_from_float((int16_t*)tgt->base(), (const float*)src->data(), src->size() / 4);
+        convertI16FromFloat((int16_t*)tgt->base(), (const float*)src->data(), src->size() / 4);
     } else if (mTo == kAudioEncodingPcmFloat && mFrom == kAudioEncodingPcm8bit) {
         memcpy_to_float_from_u8((float*)tgt->base(), (const uint8_t*)src->data(), src->size());
     } else if (mTo == kAudioEncodingPcmFloat && mFrom == kAudioEncodingPcm16bit) {
-        memcpy_to_float_from_i16((float*)tgt->base(), (const int16_t*)src->data(), src->size() / 2);
+        convertFloatFromI16((float*)tgt->base(), (const int16_t*)src->data(), src->size() / 2);
     } else {
         return INVALID_OPERATION;
     }
@@ -104,6 +104,12 @@ bool DataSource::getUInt64(off64_t offset, uint64_t *x) {
     return true;
 }
 
+void DataSource::readAtRanges(ReadRange *ranges, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        ranges[i].mResult = readAt(ranges[i].mOffset, ranges[i].mData, ranges[i].mSize);
+    }
+}
+
 status_t DataSource::getSize(off64_t *size) {
     *size = 0;
 
@@ -112,8 +118,88 @@ status_t DataSource::getSize(off64_t *size) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Serves the reads of the sniffers from the start of the source out of a buffer filled once,
+// since most of them read the first few KB, each with reads of its own.
+struct SniffCacheSource : public DataSource {
+    SniffCacheSource(const sp<DataSource> &source)
+        : mSource(source),
+          mCachedSize(-1) {
+    }
+
+    virtual status_t initCheck() const {
+        return mSource->initCheck();
+    }
+
+    virtual ssize_t readAt(off64_t offset, void *data, size_t size) {
+        if (mCachedSize < 0 && offset < kCacheSize) {
+            mCachedSize = mSource->readAt(0, mCache, kCacheSize);
+            if (mCachedSize < 0) {
+                return mCachedSize;
+            }
+        }
+        if (offset < 0 || offset >= mCachedSize) {
+            return mSource->readAt(offset, data, size);
+        }
+
+        size_t numCached = mCachedSize - offset;
+        if (numCached >= size) {
+            memcpy(data, &mCache[offset], size);
+            return size;
+        }
+        memcpy(data, &mCache[offset], numCached);
+        if (mCachedSize < kCacheSize) {
+            // the source ends within the cache
+            return numCached;
+        }
+        ssize_t n = mSource->readAt(
+                offset + numCached, (uint8_t *)data + numCached, size - numCached);
+        return n < 0 ? n : numCached + n;
+    }
+
+    virtual status_t getSize(off64_t *size) {
+        return mSource->getSize(size);
+    }
+
+    virtual uint32_t flags() {
+        return mSource->flags();
+    }
+
+    virtual String8 toString() {
+        return mSource->toString();
+    }
+
+    virtual sp<DecryptHandle> DrmInitialization(const char *mime) {
+        // the source may return decrypted data from now on
+        mCachedSize = -1;
+        return mSource->DrmInitialization(mime);
+    }
+
+    virtual void getDrmInfo(sp<DecryptHandle> &handle, DrmManagerClient **client) {
+        mSource->getDrmInfo(handle, client);
+    }
+
+    virtual String8 getUri() {
+        return mSource->getUri();
+    }
+
+    virtual String8 getMIMEType() const {
+        return mSource->getMIMEType();
+    }
+
+private:
+    enum {
+        kCacheSize = 32 * 1024,
+    };
+
+    sp<DataSource> mSource;
+    uint8_t mCache[kCacheSize];
+    ssize_t mCachedSize;
+
+    DISALLOW_EVIL_CONSTRUCTORS(SniffCacheSource);
+};
+
 Mutex DataSource::gSnifferMutex;
-List<DataSource::SnifferFunc> DataSource::gSniffers;
+List<DataSource::Sniffer> DataSource::gSniffers;
 bool DataSource::gSniffersRegistered = false;
 
 bool DataSource::sniff(
@@ -129,12 +215,21 @@ bool DataSource::sniff(
         }
     }
 
-    for (List<SnifferFunc>::iterator it = gSniffers.begin();
+    sp<DataSource> source = new SniffCacheSource(this);
+
+    // The sniffers are ordered by decreasing maximum confidence, so once one matches, none of
+    // the remaining ones can beat it. Sniffers with the same maximum keep the order they were
+    // registered in, so ties are broken the same way as when all sniffers run.
+    for (List<Sniffer>::iterator it = gSniffers.begin();
          it != gSniffers.end(); ++it) {
+        if (*confidence >= (*it).mMaxConfidence) {
+            break;
+        }
+
         String8 newMimeType;
         float newConfidence;
         sp<AMessage> newMeta;
-        if ((*it)(this, &newMimeType, &newConfidence, &newMeta)) {
+        if ((*it).mFunc(source, &newMimeType, &newConfidence, &newMeta)) {
             if (newConfidence > *confidence) {
                 *mimeType = newMimeType;
                 *confidence = newConfidence;
@@ -147,15 +242,22 @@ bool DataSource::sniff(
 }
 
 // static
-void DataSource::RegisterSniffer_l(SnifferFunc func) {
-    for (List<SnifferFunc>::iterator it = gSniffers.begin();
+void DataSource::RegisterSniffer_l(SnifferFunc func, float maxConfidence) {
+    List<Sniffer>::iterator insertPos = gSniffers.end();
+    for (List<Sniffer>::iterator it = gSniffers.begin();
          it != gSniffers.end(); ++it) {
-        if (*it == func) {
+        if ((*it).mFunc == func) {
             return;
         }
+        if (insertPos == gSniffers.end() && (*it).mMaxConfidence < maxConfidence) {
+            insertPos = it;
+        }
     }
 
-    gSniffers.push_back(func);
+    Sniffer sniffer;
+    sniffer.mFunc = func;
+    sniffer.mMaxConfidence = maxConfidence;
+    gSniffers.insert(insertPos, sniffer);
 }
 
 // static
@@ -165,26 +267,27 @@ void DataSource::RegisterDefaultSniffers() {
         return;
     }
 
-    RegisterSniffer_l(SniffMPEG4);
-    RegisterSniffer_l(SniffMatroska);
-    RegisterSniffer_l(SniffOgg);
-    RegisterSniffer_l(SniffWAV);
-    RegisterSniffer_l(SniffFLAC);
-    RegisterSniffer_l(SniffAMR);
-    RegisterSniffer_l(SniffMPEG2TS);
-    RegisterSniffer_l(SniffMP3);
-    RegisterSniffer_l(SniffAAC);
-    RegisterSniffer_l(SniffMPEG2PS);
+    // The confidences must match the ones the sniffers report.
+    RegisterSniffer_l(SniffMPEG4, 0.4f);
+    RegisterSniffer_l(SniffMatroska, 0.6f);
+    RegisterSniffer_l(SniffOgg, 0.2f);
+    RegisterSniffer_l(SniffWAV, 0.3f);
+    RegisterSniffer_l(SniffFLAC, 0.5f);
+    RegisterSniffer_l(SniffAMR, 0.5f);
+    RegisterSniffer_l(SniffMPEG2TS, 0.1f);
+    RegisterSniffer_l(SniffMP3, 0.2f);
+    RegisterSniffer_l(SniffAAC, 0.2f);
+    RegisterSniffer_l(SniffMPEG2PS, 0.25f);
     if (getuid() == AID_MEDIA) {
         // WVM only in the media server process
-        RegisterSniffer_l(SniffWVM);
+        RegisterSniffer_l(SniffWVM, 10.0f);
     }
-    RegisterSniffer_l(SniffMidi);
+    RegisterSniffer_l(SniffMidi, 0.8f);
 
     char value[PROPERTY_VALUE_MAX];
     if (property_get("drm.service.enabled", value, NULL)
             && (!strcmp(value, "1") || !strcasecmp(value, "true"))) {
-        RegisterSniffer_l(SniffDRM);
+        RegisterSniffer_l(SniffDRM, 10.0f);
     }
     gSniffersRegistered = true;
 }
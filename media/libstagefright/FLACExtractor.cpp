@@ -31,6 +31,7 @@
 #include <media/stagefright/MetaData.h>
 #include <media/stagefright/MediaSource.h>
 #include <media/stagefright/MediaBuffer.h>
+#include <utils/Vector.h>
 
 namespace android {
 
@@ -114,6 +115,12 @@ protected:
     virtual ~FLACParser();
 
 private:
+    enum {
+        kMaxFrameIndexEntries = 4096,
+    };
+    // seeks decode at most this far from the closest indexed frame before the target
+    static const int64_t kMaxDecodeAheadUs = 3000000LL;
+
     sp<DataSource> mDataSource;
     sp<MetaData> mFileMetadata;
     sp<MetaData> mTrackMetadata;
@@ -135,6 +142,15 @@ private:
     FLAC__StreamMetadata_StreamInfo mStreamInfo;
     bool mStreamInfoValid;
 
+    // Frames known to start at a given sample, from the SEEKTABLE and from the frames decoded
+    // so far, by increasing sample number. Seeks decode forward from the closest one.
+    struct FrameIndexEntry {
+        FLAC__uint64 mSample;
+        off64_t mOffset;
+    };
+    Vector<FrameIndexEntry> mFrameIndex;
+    off64_t mFirstFrameOffset;
+
     // cached when a decoded PCM block is "written" by libFLAC parser
     bool mWriteRequested;
     bool mWriteCompleted;
@@ -147,6 +163,10 @@ private:
     status_t init();
     MediaBuffer *readBuffer(bool doSeek, FLAC__uint64 sample);
 
+    void addToFrameIndex(FLAC__uint64 sample, off64_t offset, FLAC__uint64 minSpacing);
+    void indexNextFrame();
+    bool seekWithFrameIndex(FLAC__uint64 sample, unsigned *skipSamples);
+
     // no copy constructor or assignment
     FLACParser(const FLACParser &);
     FLACParser &operator=(const FLACParser &);
@@ -343,6 +363,21 @@ void FLACParser::metadataCallback(const FLAC__StreamMetadata *metadata)
             ALOGE("FLACParser::metadataCallback unexpected STREAMINFO");
         }
         break;
+    case FLAC__METADATA_TYPE_SEEKTABLE:
+        {
+        // offsets are relative to the first frame until the end of the metadata
+        const FLAC__StreamMetadata_SeekTable *st = &metadata->data.seek_table;
+        for (unsigned i = 0; i < st->num_points; ++i) {
+            const FLAC__StreamMetadata_SeekPoint *point = &st->points[i];
+            if (point->sample_number == FLAC__STREAM_METADATA_SEEKPOINT_PLACEHOLDER
+                    || (getTotalSamples() > 0 && point->sample_number >= getTotalSamples())
+                    || point->stream_offset > INT64_MAX / 2) {
+                continue;
+            }
+            addToFrameIndex(point->sample_number, point->stream_offset, 0);
+        }
+        }
+        break;
     case FLAC__METADATA_TYPE_VORBIS_COMMENT:
         {
         const FLAC__StreamMetadata_VorbisComment *vc;
@@ -497,6 +532,7 @@ FLACParser::FLACParser(
       mCurrentPos(0LL),
       mEOF(false),
       mStreamInfoValid(false),
+      mFirstFrameOffset(-1LL),
       mWriteRequested(false),
       mWriteCompleted(false),
       mWriteBuffer(NULL),
@@ -536,6 +572,8 @@ status_t FLACParser::init()
             mDecoder, FLAC__METADATA_TYPE_PICTURE);
     FLAC__stream_decoder_set_metadata_respond(
             mDecoder, FLAC__METADATA_TYPE_VORBIS_COMMENT);
+    FLAC__stream_decoder_set_metadata_respond(
+            mDecoder, FLAC__METADATA_TYPE_SEEKTABLE);
     FLAC__StreamDecoderInitStatus initStatus;
     initStatus = FLAC__stream_decoder_init_stream(
             mDecoder,
@@ -553,6 +591,16 @@ status_t FLACParser::init()
         ALOGE("end_of_metadata failed");
         return NO_INIT;
     }
+    FLAC__uint64 firstFrameOffset;
+    if (FLAC__stream_decoder_get_decode_position(mDecoder, &firstFrameOffset)) {
+        mFirstFrameOffset = firstFrameOffset;
+        for (size_t i = 0; i < mFrameIndex.size(); ++i) {
+            mFrameIndex.editItemAt(i).mOffset += mFirstFrameOffset;
+        }
+        addToFrameIndex(0, mFirstFrameOffset, 0);
+    } else {
+        mFrameIndex.clear();
+    }
     if (mStreamInfoValid) {
         // check channel count
         if (getChannels() == 0 || getChannels() > 8) {
@@ -645,17 +693,111 @@ void FLACParser::releaseBuffers()
     mGroup = NULL;
 }
 
+void FLACParser::addToFrameIndex(
+        FLAC__uint64 sample, off64_t offset, FLAC__uint64 minSpacing)
+{
+    // frames are mostly indexed in order
+    size_t index = mFrameIndex.size();
+    while (index > 0 && mFrameIndex.itemAt(index - 1).mSample >= sample) {
+        --index;
+    }
+    if (index < mFrameIndex.size() && mFrameIndex.itemAt(index).mSample == sample) {
+        return;
+    }
+    if ((index > 0 && sample - mFrameIndex.itemAt(index - 1).mSample < minSpacing)
+            || (index < mFrameIndex.size()
+                && mFrameIndex.itemAt(index).mSample - sample < minSpacing)
+            || mFrameIndex.size() >= kMaxFrameIndexEntries) {
+        return;
+    }
+    FrameIndexEntry entry;
+    entry.mSample = sample;
+    entry.mOffset = offset;
+    mFrameIndex.insertAt(entry, index);
+}
+
+// Indexes the frame following the one just decoded, about once a second.
+void FLACParser::indexNextFrame()
+{
+    FLAC__uint64 offset;
+    if (mFirstFrameOffset < 0
+            || mWriteHeader.number_type != FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER
+            || !FLAC__stream_decoder_get_decode_position(mDecoder, &offset)) {
+        return;
+    }
+    addToFrameIndex(mWriteHeader.number.sample_number + mWriteHeader.blocksize,
+            offset, getSampleRate());
+}
+
+// Decodes forward from the closest indexed frame at or before sample, up to the frame holding
+// it, of which the first *skipSamples samples are before it. Returns false if the index cannot
+// be used, leaving the seek to libFLAC.
+bool FLACParser::seekWithFrameIndex(FLAC__uint64 sample, unsigned *skipSamples)
+{
+    *skipSamples = 0;
+    size_t index = mFrameIndex.size();
+    while (index > 0 && mFrameIndex.itemAt(index - 1).mSample > sample) {
+        --index;
+    }
+    if (index == 0) {
+        return false;
+    }
+    const FrameIndexEntry entry = mFrameIndex.itemAt(index - 1);
+    if (sample - entry.mSample > (FLAC__uint64)kMaxDecodeAheadUs * getSampleRate() / 1000000LL
+            || !FLAC__stream_decoder_flush(mDecoder)) {
+        return false;
+    }
+    mCurrentPos = entry.mOffset;
+    mEOF = false;
+    for (;;) {
+        mWriteRequested = true;
+        mWriteCompleted = false;
+        if (!FLAC__stream_decoder_process_single(mDecoder)) {
+            ALOGE("FLACParser::seekWithFrameIndex process_single failed");
+            return false;
+        }
+        if (!mWriteCompleted) {
+            // end of stream
+            return true;
+        }
+        if (mWriteHeader.number_type != FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER) {
+            return false;
+        }
+        FLAC__uint64 frameSample = mWriteHeader.number.sample_number;
+        if (frameSample > sample) {
+            ALOGW("FLACParser::seekWithFrameIndex no frame at offset %lld for sample %llu",
+                    (long long)entry.mOffset, (unsigned long long)entry.mSample);
+            mFrameIndex.removeAt(index - 1);
+            return false;
+        }
+        if (sample < frameSample + mWriteHeader.blocksize) {
+            *skipSamples = sample - frameSample;
+            return true;
+        }
+        indexNextFrame();
+    }
+}
+
 MediaBuffer *FLACParser::readBuffer(bool doSeek, FLAC__uint64 sample)
 {
     mWriteRequested = true;
     mWriteCompleted = false;
+    unsigned skipSamples = 0;
     if (doSeek) {
-        // We implement the seek callback, so this works without explicit flush
-        if (!FLAC__stream_decoder_seek_absolute(mDecoder, sample)) {
-            ALOGE("FLACParser::readBuffer seek to sample %lld failed", (long long)sample);
-            return NULL;
+        if (seekWithFrameIndex(sample, &skipSamples)) {
+            ALOGV("FLACParser::readBuffer seek to sample %lld using the frame index",
+                    (long long)sample);
+        } else {
+            mWriteRequested = true;
+            mWriteCompleted = false;
+            skipSamples = 0;
+            // We implement the seek callback, so this works without explicit flush
+            if (!FLAC__stream_decoder_seek_absolute(mDecoder, sample)) {
+                ALOGE("FLACParser::readBuffer seek to sample %lld failed", (long long)sample);
+                return NULL;
+            }
+            ALOGV("FLACParser::readBuffer seek to sample %lld succeeded", (long long)sample);
         }
-        ALOGV("FLACParser::readBuffer seek to sample %lld succeeded", (long long)sample);
     } else {
         if (!FLAC__stream_decoder_process_single(mDecoder)) {
             ALOGE("FLACParser::readBuffer process_single failed");
@@ -680,6 +822,18 @@ MediaBuffer *FLACParser::readBuffer(bool doSeek, FLAC__uint64 sample)
                 mWriteHeader.sample_rate, mWriteHeader.channels, mWriteHeader.bits_per_sample);
         return NULL;
     }
+    indexNextFrame();
+    // drop the samples before the seek target
+    const FLAC__int32 *channels[8];
+    const FLAC__int32 * const *src = mWriteBuffer;
+    if (skipSamples > 0) {
+        CHECK(skipSamples < blocksize);
+        for (unsigned c = 0; c < getChannels(); ++c) {
+            channels[c] = mWriteBuffer[c] + skipSamples;
+        }
+        src = channels;
+        blocksize -= skipSamples;
+    }
     // acquire a media buffer
     CHECK(mGroup != NULL);
     MediaBuffer *buffer;
@@ -692,10 +846,10 @@ MediaBuffer *FLACParser::readBuffer(bool doSeek, FLAC__uint64 sample)
     short *data = (short *) buffer->data();
     buffer->set_range(0, bufferSize);
     // copy PCM from FLAC write buffer to our media buffer, with interleaving
-    (*mCopy)(data, mWriteBuffer, blocksize, getChannels());
+    (*mCopy)(data, src, blocksize, getChannels());
     // fill in buffer metadata
     CHECK(mWriteHeader.number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER);
-    FLAC__uint64 sampleNumber = mWriteHeader.number.sample_number;
+    FLAC__uint64 sampleNumber = mWriteHeader.number.sample_number + skipSamples;
     int64_t timeUs = (1000000LL * sampleNumber) / getSampleRate();
     buffer->meta_data()->setInt64(kKeyTime, timeUs);
     buffer->meta_data()->setInt32(kKeyIsSyncFrame, 1);
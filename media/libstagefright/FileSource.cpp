@@ -24,16 +24,30 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <sys/types.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 
 namespace android {
 
+// Files larger than this are read without a mapping, to spare the address space of 32-bit
+// processes.
+static const int64_t kMaxMapSize = sizeof(void *) > 4 ? (1ll << 40) : (256ll << 20);
+
+// How far ahead of a sequential reader the kernel is asked to read.
+static const int64_t kReadaheadSize = 1024 * 1024;
+
 FileSource::FileSource(const char *filename)
     : mFd(-1),
       mOffset(0),
       mLength(-1),
       mName("<null>"),
+      mMapTried(false),
+      mMapBase(NULL),
+      mMapSize(0),
+      mMapData(NULL),
+      mLastReadEnd(0),
+      mReadaheadEnd(0),
       mDecryptHandle(NULL),
       mDrmManagerClient(NULL),
       mDrmBufOffset(0),
@@ -58,6 +72,12 @@ FileSource::FileSource(int fd, int64_t offset, int64_t length)
       mOffset(offset),
       mLength(length),
       mName("<null>"),
+      mMapTried(false),
+      mMapBase(NULL),
+      mMapSize(0),
+      mMapData(NULL),
+      mLastReadEnd(0),
+      mReadaheadEnd(0),
       mDecryptHandle(NULL),
       mDrmManagerClient(NULL),
       mDrmBufOffset(0),
@@ -100,6 +120,8 @@ FileSource::FileSource(int fd, int64_t offset, int64_t length)
 }
 
 FileSource::~FileSource() {
+    unmapFile_l();
+
     if (mFd >= 0) {
         ::close(mFd);
         mFd = -1;
@@ -148,6 +170,15 @@ ssize_t FileSource::readAt(off64_t offset, void *data, size_t size) {
             == mDecryptHandle->decryptApiType) {
         return readAtDRM(offset, data, size);
    } else {
+        if (!mMapTried) {
+            mapFile_l();
+        }
+        if (mMapData != NULL) {
+            readahead_l(offset, size);
+            memcpy(data, mMapData + offset, size);
+            return size;
+        }
+
         off64_t result = lseek64(mFd, offset + mOffset, SEEK_SET);
         if (result == -1) {
             ALOGE("seek to %lld failed", (long long)(offset + mOffset));
@@ -170,6 +201,67 @@ status_t FileSource::getSize(off64_t *size) {
     return OK;
 }
 
+void FileSource::mapFile_l() {
+    mMapTried = true;
+
+    struct stat s;
+    if (mLength <= 0 || mLength > kMaxMapSize
+            || fstat(mFd, &s) != 0 || !S_ISREG(s.st_mode)
+            || mOffset + mLength > s.st_size) {
+        return;
+    }
+
+    const int64_t pageSize = sysconf(_SC_PAGESIZE);
+    const int64_t mapOffset = mOffset - mOffset % pageSize;
+    mMapSize = mLength + (mOffset - mapOffset);
+    void *base = mmap64(NULL, mMapSize, PROT_READ, MAP_SHARED, mFd, mapOffset);
+    if (base == MAP_FAILED) {
+        ALOGW("%s: mmap failed (%s), reading the file instead", mName.string(), strerror(errno));
+        mMapSize = 0;
+        return;
+    }
+
+    mMapBase = base;
+    mMapData = (const uint8_t *)base + (mOffset - mapOffset);
+}
+
+void FileSource::unmapFile_l() {
+    if (mMapBase != NULL) {
+        munmap(mMapBase, mMapSize);
+        mMapBase = NULL;
+        mMapData = NULL;
+        mMapSize = 0;
+    }
+}
+
+void FileSource::readahead_l(off64_t offset, size_t size) {
+    const bool sequential = offset == mLastReadEnd;
+    mLastReadEnd = offset + size;
+    if (!sequential) {
+        // A seek, or a random access by an extractor: let the page faults bring the data in.
+        mReadaheadEnd = mLastReadEnd;
+        return;
+    }
+
+    // Ask for the next window once the reader is half way through the current one, so that
+    // madvise is called once every kReadaheadSize / 2 bytes rather than on every read.
+    if (mLastReadEnd + kReadaheadSize / 2 < mReadaheadEnd || mReadaheadEnd >= mLength) {
+        return;
+    }
+    int64_t start = mReadaheadEnd > mLastReadEnd ? mReadaheadEnd : mLastReadEnd;
+    int64_t end = start + kReadaheadSize;
+    if (end > mLength) {
+        end = mLength;
+    }
+
+    const uintptr_t pageMask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+    uintptr_t begin = (uintptr_t)(mMapData + start) & ~pageMask;
+    if (madvise((void *)begin, (uintptr_t)(mMapData + end) - begin, MADV_WILLNEED) != 0) {
+        ALOGV("madvise failed (%s)", strerror(errno));
+    }
+    mReadaheadEnd = end;
+}
+
 sp<DecryptHandle> FileSource::DrmInitialization(const char *mime) {
     if (mDrmManagerClient == NULL) {
         mDrmManagerClient = new DrmManagerClient();
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "FrameIndexSeeker"
+#include <utils/Log.h>
+
+#include "include/FrameIndexSeeker.h"
+#include "include/avc_utils.h"
+
+#include <media/stagefright/DataSource.h>
+#include <media/stagefright/Utils.h>
+
+namespace android {
+
+// The header bits that stay the same from frame to frame, as in MP3Extractor.
+static const uint32_t kMask = 0xfffe0c00;
+
+// static
+sp<FrameIndexSeeker> FrameIndexSeeker::CreateFromSource(
+        const sp<DataSource> &source, off64_t first_frame_pos, uint32_t fixed_header) {
+    size_t frame_size;
+    int sample_rate;
+    if (!GetMPEGAudioFrameSize(fixed_header, &frame_size, &sample_rate)) {
+        return NULL;
+    }
+
+    return new FrameIndexSeeker(source, first_frame_pos, fixed_header, sample_rate);
+}
+
+FrameIndexSeeker::FrameIndexSeeker(
+        const sp<DataSource> &source, off64_t first_frame_pos,
+        uint32_t fixed_header, int sample_rate)
+    : mSource(source),
+      mFixedHeader(fixed_header),
+      mSampleRate(sample_rate),
+      mScanPos(first_frame_pos),
+      mScanSample(0),
+      mScanFrames(0),
+      mLastFramePos(first_frame_pos),
+      mLastFrameSample(0),
+      mScanDone(false),
+      mScanFailed(false),
+      mBufferOffset(0),
+      mBufferSize(0) {
+}
+
+bool FrameIndexSeeker::getDuration(int64_t * /* durationUs */) {
+    // only known once the whole file has been scanned
+    return false;
+}
+
+bool FrameIndexSeeker::getOffsetForTime(int64_t *timeUs, off64_t *pos) {
+    Mutex::Autolock autoLock(mLock);
+
+    // rounded up, so that seeking to the time of a frame finds that frame
+    int64_t sample = *timeUs <= 0 ? 0 : (*timeUs * mSampleRate + 999999) / 1000000ll;
+    scanTo(sample);
+
+    if (sample >= mScanSample) {
+        if (!mScanDone || mScanFailed || mIndex.isEmpty()) {
+            // not indexed that far
+            return false;
+        }
+        // past the end, seek to the last frame
+        *pos = mLastFramePos;
+        *timeUs = mLastFrameSample * 1000000ll / mSampleRate;
+        return true;
+    }
+
+    // the last entry at or before the requested sample
+    size_t lo = 0;
+    size_t hi = mIndex.size();
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (mIndex.itemAt(mid).mSample <= sample) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // then the frame that contains it
+    off64_t framePos = mIndex.itemAt(lo).mOffset;
+    int64_t frameSample = mIndex.itemAt(lo).mSample;
+    for (;;) {
+        size_t frameSize;
+        int numSamples;
+        bool eos;
+        if (!parseFrame(framePos, &frameSize, &numSamples, &eos)) {
+            // indexed frames were parsed before
+            ALOGW("frame at %lld disappeared", (long long)framePos);
+            return false;
+        }
+        if (frameSample + numSamples > sample) {
+            break;
+        }
+        framePos += frameSize;
+        frameSample += numSamples;
+    }
+
+    *pos = framePos;
+    *timeUs = frameSample * 1000000ll / mSampleRate;
+
+    ALOGV("seek to %lld us at %lld", (long long)*timeUs, (long long)*pos);
+    return true;
+}
+
+void FrameIndexSeeker::scanTo(int64_t sample) {
+    const off64_t stopPos = mScanPos + kMaxScanSize;
+    while (!mScanDone && mScanSample <= sample && mScanPos < stopPos) {
+        size_t frameSize;
+        int numSamples;
+        bool eos;
+        if (!parseFrame(mScanPos, &frameSize, &numSamples, &eos)) {
+            // The file ends, possibly with a tag, or the stream is corrupt past this point.
+            mScanDone = true;
+            mScanFailed = !eos && mSource->readAt(mScanPos, mBuffer, 3) == 3
+                    && memcmp(mBuffer, "TAG", 3) != 0;
+            mBufferSize = 0;
+            ALOGV("scan stopped at %lld after %zu frames%s", (long long)mScanPos,
+                    mScanFrames, mScanFailed ? ", lost sync" : "");
+            break;
+        }
+
+        if (mScanFrames % kFramesPerEntry == 0) {
+            Entry entry;
+            entry.mOffset = mScanPos;
+            entry.mSample = mScanSample;
+            mIndex.push(entry);
+        }
+        mLastFramePos = mScanPos;
+        mLastFrameSample = mScanSample;
+
+        mScanPos += frameSize;
+        mScanSample += numSamples;
+        ++mScanFrames;
+    }
+}
+
+bool FrameIndexSeeker::parseFrame(
+        off64_t pos, size_t *frameSize, int *numSamples, bool *eos) {
+    uint32_t header;
+    *eos = !readHeader(pos, &header);
+    if (*eos) {
+        return false;
+    }
+
+    return (header & kMask) == (mFixedHeader & kMask)
+            && GetMPEGAudioFrameSize(header, frameSize, NULL, NULL, NULL, numSamples)
+            && *frameSize > 0;
+}
+
+bool FrameIndexSeeker::readHeader(off64_t pos, uint32_t *header) {
+    // The headers are read through a buffer, since they are only a few hundred bytes apart.
+    if (pos < mBufferOffset || pos + 4 > mBufferOffset + (off64_t)mBufferSize) {
+        ssize_t n = mSource->readAt(pos, mBuffer, sizeof(mBuffer));
+        if (n < 4) {
+            mBufferSize = 0;
+            return false;
+        }
+        mBufferOffset = pos;
+        mBufferSize = n;
+    }
+
+    *header = U32_AT(&mBuffer[pos - mBufferOffset]);
+    return true;
+}
+
+}  // namespace android
@@ -21,6 +21,7 @@
 #include "include/MP3Extractor.h"
 
 #include "include/avc_utils.h"
+#include "include/FrameIndexSeeker.h"
 #include "include/ID3.h"
 #include "include/VBRISeeker.h"
 #include "include/XINGSeeker.h"
@@ -317,6 +318,10 @@ MP3Extractor::MP3Extractor(
         }
         mFirstFramePos = pos;
         mFixedHeader = header;
+    } else if (!(mDataSource->flags()
+            & (DataSource::kIsCachingDataSource | DataSource::kIsHTTPBasedSource))) {
+        // Without a seek table, walk the frame headers of local files to seek exactly.
+        mSeeker = FrameIndexSeeker::CreateFromSource(mDataSource, mFirstFramePos, mFixedHeader);
     }
 
     size_t frame_size;
@@ -499,6 +499,10 @@ void MPEG2TSWriter::init() {
     CHECK(mFile != NULL || mWriteFunc != NULL);
 
     initCrcTable();
+    buildProgramAssociationTable();
+
+    mOutputBuffer = new ABuffer(kMaxTSPacketsPerWrite * kTSPacketSize);
+    mOutputBuffer->setRange(0, 0);
 
     mLooper = new ALooper;
     mLooper->setName("MPEG2TSWriter");
@@ -549,6 +553,8 @@ status_t MPEG2TSWriter::start(MetaData * /* param */) {
     mNumSourcesDone = 0;
     mNumTSPacketsWritten = 0;
     mNumTSPacketsBeforeMeta = 0;
+    mOutputBuffer->setRange(0, 0);
+    buildProgramMap();
 
     for (size_t i = 0; i < mSources.size(); ++i) {
         sp<AMessage> notify =
@@ -690,7 +696,7 @@ void MPEG2TSWriter::onMessageReceived(const sp<AMessage> &msg) {
     }
 }
 
-void MPEG2TSWriter::writeProgramAssociationTable() {
+void MPEG2TSWriter::buildProgramAssociationTable() {
     // 0x47
     // transport_error_indicator = b0
     // payload_unit_start_indicator = b1
@@ -727,22 +733,14 @@ void MPEG2TSWriter::writeProgramAssociationTable() {
         0x00, 0x00, 0x00, 0x00   // b???? ???? ???? ???? ???? ???? ???? ????
     };
 
-    sp<ABuffer> buffer = new ABuffer(188);
-    memset(buffer->data(), 0xff, buffer->size());
-    memcpy(buffer->data(), kData, sizeof(kData));
-
-    if (++mPATContinuityCounter == 16) {
-        mPATContinuityCounter = 0;
-    }
-    buffer->data()[3] |= mPATContinuityCounter;
-
-    uint32_t crc = htonl(crc32(&buffer->data()[5], 12));
-    memcpy(&buffer->data()[17], &crc, sizeof(crc));
+    memset(mPATPacket, 0xff, sizeof(mPATPacket));
+    memcpy(mPATPacket, kData, sizeof(kData));
 
-    CHECK_EQ(internalWrite(buffer->data(), buffer->size()), buffer->size());
+    uint32_t crc = htonl(crc32(&mPATPacket[5], 12));
+    memcpy(&mPATPacket[17], &crc, sizeof(crc));
 }
 
-void MPEG2TSWriter::writeProgramMap() {
+void MPEG2TSWriter::buildProgramMap() {
     // 0x47
     // transport_error_indicator = b0
     // payload_unit_start_indicator = b1
@@ -784,24 +782,19 @@ void MPEG2TSWriter::writeProgramMap() {
         0xe0, 0x00, 0xf0, 0x00   // b111? ???? ???? ???? 1111 0000 0000 0000
     };
 
-    sp<ABuffer> buffer = new ABuffer(188);
-    memset(buffer->data(), 0xff, buffer->size());
-    memcpy(buffer->data(), kData, sizeof(kData));
-
-    if (++mPMTContinuityCounter == 16) {
-        mPMTContinuityCounter = 0;
-    }
-    buffer->data()[3] |= mPMTContinuityCounter;
+    uint8_t *buffer = mPMTPacket;
+    memset(buffer, 0xff, sizeof(mPMTPacket));
+    memcpy(buffer, kData, sizeof(kData));
 
     size_t section_length = 5 * mSources.size() + 4 + 9;
-    buffer->data()[6] |= section_length >> 8;
-    buffer->data()[7] = section_length & 0xff;
+    buffer[6] |= section_length >> 8;
+    buffer[7] = section_length & 0xff;
 
     static const unsigned kPCR_PID = 0x1e1;
-    buffer->data()[13] |= (kPCR_PID >> 8) & 0x1f;
-    buffer->data()[14] = kPCR_PID & 0xff;
+    buffer[13] |= (kPCR_PID >> 8) & 0x1f;
+    buffer[14] = kPCR_PID & 0xff;
 
-    uint8_t *ptr = &buffer->data()[sizeof(kData)];
+    uint8_t *ptr = &buffer[sizeof(kData)];
     for (size_t i = 0; i < mSources.size(); ++i) {
         *ptr++ = mSources.editItemAt(i)->streamType();
 
@@ -812,10 +805,28 @@ void MPEG2TSWriter::writeProgramMap() {
         *ptr++ = 0x00;
     }
 
-    uint32_t crc = htonl(crc32(&buffer->data()[5], 12+mSources.size()*5));
-    memcpy(&buffer->data()[17+mSources.size()*5], &crc, sizeof(crc));
+    uint32_t crc = htonl(crc32(&buffer[5], 12+mSources.size()*5));
+    memcpy(&buffer[17+mSources.size()*5], &crc, sizeof(crc));
+}
+
+void MPEG2TSWriter::writeProgramAssociationTable() {
+    uint8_t *packet = appendTSPacket();
+    memcpy(packet, mPATPacket, kTSPacketSize);
+
+    if (++mPATContinuityCounter == 16) {
+        mPATContinuityCounter = 0;
+    }
+    packet[3] |= mPATContinuityCounter;
+}
+
+void MPEG2TSWriter::writeProgramMap() {
+    uint8_t *packet = appendTSPacket();
+    memcpy(packet, mPMTPacket, kTSPacketSize);
 
-    CHECK_EQ(internalWrite(buffer->data(), buffer->size()), buffer->size());
+    if (++mPMTContinuityCounter == 16) {
+        mPMTContinuityCounter = 0;
+    }
+    packet[3] |= mPMTContinuityCounter;
 }
 
 void MPEG2TSWriter::writeAccessUnit(
@@ -855,9 +866,6 @@ void MPEG2TSWriter::writeAccessUnit(
     // reserved = b1
     // the first fragment of "buffer" follows
 
-    sp<ABuffer> buffer = new ABuffer(188);
-    memset(buffer->data(), 0xff, buffer->size());
-
     const unsigned PID = 0x1e0 + sourceIndex + 1;
 
     const unsigned continuity_counter =
@@ -884,7 +892,9 @@ void MPEG2TSWriter::writeAccessUnit(
         PES_packet_length = 0;
     }
 
-    uint8_t *ptr = buffer->data();
+    // The packets are filled in right in the output buffer, stuffing bytes included.
+    uint8_t *packet = appendTSPacket();
+    uint8_t *ptr = packet;
     *ptr++ = 0x47;
     *ptr++ = 0x40 | (PID >> 8);
     *ptr++ = PID & 0xff;
@@ -894,6 +904,7 @@ void MPEG2TSWriter::writeAccessUnit(
         *ptr++ = paddingSize - 1;
         if (paddingSize >= 2) {
             *ptr++ = 0x00;
+            memset(ptr, 0xff, paddingSize - 2);
             ptr += paddingSize - 2;
         }
     }
@@ -912,15 +923,14 @@ void MPEG2TSWriter::writeAccessUnit(
     *ptr++ = (PTS >> 7) & 0xff;
     *ptr++ = ((PTS & 0x7f) << 1) | 1;
 
-    size_t sizeLeft = buffer->data() + buffer->size() - ptr;
+    size_t sizeLeft = packet + kTSPacketSize - ptr;
     size_t copy = accessUnit->size();
     if (copy > sizeLeft) {
         copy = sizeLeft;
     }
 
     memcpy(ptr, accessUnit->data(), copy);
-
-    CHECK_EQ(internalWrite(buffer->data(), buffer->size()), buffer->size());
+    memset(ptr + copy, 0xff, sizeLeft - copy);
 
     size_t offset = copy;
     while (offset < accessUnit->size()) {
@@ -936,12 +946,11 @@ void MPEG2TSWriter::writeAccessUnit(
         // continuity_counter = b????
         // the fragment of "buffer" follows.
 
-        memset(buffer->data(), 0xff, buffer->size());
-
         const unsigned continuity_counter =
             mSources.editItemAt(sourceIndex)->incrementContinuityCounter();
 
-        ptr = buffer->data();
+        packet = appendTSPacket();
+        ptr = packet;
         *ptr++ = 0x47;
         *ptr++ = 0x00 | (PID >> 8);
         *ptr++ = PID & 0xff;
@@ -954,22 +963,25 @@ void MPEG2TSWriter::writeAccessUnit(
             *ptr++ = paddingSize - 1;
             if (paddingSize >= 2) {
                 *ptr++ = 0x00;
+                memset(ptr, 0xff, paddingSize - 2);
                 ptr += paddingSize - 2;
             }
         }
 
-        size_t sizeLeft = buffer->data() + buffer->size() - ptr;
+        size_t sizeLeft = packet + kTSPacketSize - ptr;
         size_t copy = accessUnit->size() - offset;
         if (copy > sizeLeft) {
             copy = sizeLeft;
         }
 
         memcpy(ptr, accessUnit->data() + offset, copy);
-        CHECK_EQ(internalWrite(buffer->data(), buffer->size()),
-                 buffer->size());
+        memset(ptr + copy, 0xff, sizeLeft - copy);
 
         offset += copy;
     }
+
+    // Readers of a live stream get each access unit as soon as it is muxed.
+    flushTSPackets();
 }
 
 void MPEG2TSWriter::writeTS() {
@@ -1008,6 +1020,27 @@ uint32_t MPEG2TSWriter::crc32(const uint8_t *p_start, size_t length) {
     return crc;
 }
 
+uint8_t *MPEG2TSWriter::appendTSPacket() {
+    if (mOutputBuffer->size() + kTSPacketSize > mOutputBuffer->capacity()) {
+        flushTSPackets();
+    }
+
+    uint8_t *packet = mOutputBuffer->data() + mOutputBuffer->size();
+    mOutputBuffer->setRange(0, mOutputBuffer->size() + kTSPacketSize);
+    ++mNumTSPacketsWritten;
+    return packet;
+}
+
+void MPEG2TSWriter::flushTSPackets() {
+    if (mOutputBuffer->size() == 0) {
+        return;
+    }
+
+    CHECK_EQ(internalWrite(mOutputBuffer->data(), mOutputBuffer->size()),
+             (ssize_t)mOutputBuffer->size());
+    mOutputBuffer->setRange(0, 0);
+}
+
 ssize_t MPEG2TSWriter::internalWrite(const void *data, size_t size) {
     if (mFile != NULL) {
         return fwrite(data, 1, size, mFile);
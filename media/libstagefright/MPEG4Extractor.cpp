@@ -134,6 +134,9 @@ private:
 
     size_t parseNALSize(const uint8_t *data) const;
     status_t parseChunk(off64_t *offset);
+    status_t parseFragment(off64_t moofOffset);
+    void addFragmentToIndex(off64_t moofOffset, uint64_t startTime);
+    size_t findFragment(uint64_t seekTime, ReadOptions::SeekMode mode);
     status_t parseTrackFragmentHeader(off64_t offset, off64_t size);
     status_t parseTrackFragmentRun(off64_t offset, off64_t size);
     status_t parseSampleAuxiliaryInformationSizes(off64_t offset, off64_t size);
@@ -172,6 +175,13 @@ private:
     };
     Vector<Sample> mCurrentSamples;
 
+    // The fragments parsed so far, from the first one on, to seek without a sidx.
+    struct FragmentEntry {
+        off64_t mMoofOffset;
+        uint64_t mStartTime;  // in mTimescale units
+    };
+    Vector<FragmentEntry> mFragmentIndex;
+
     MPEG4Source(const MPEG4Source &);
     MPEG4Source &operator=(const MPEG4Source &);
 };
@@ -3570,6 +3580,7 @@ MPEG4Source::MPEG4Source(
       mTrex(trex),
       mFirstMoofOffset(firstMoofOffset),
       mCurrentMoofOffset(firstMoofOffset),
+      mNextMoofOffset(firstMoofOffset),
       mCurrentTime(0),
       mCurrentSampleInfoAllocSize(0),
       mCurrentSampleInfoSizes(NULL),
@@ -3635,8 +3646,8 @@ MPEG4Source::MPEG4Source(
     CHECK(format->findInt32(kKeyTrackID, &mTrackId));
 
     if (mFirstMoofOffset != 0) {
-        off64_t offset = mFirstMoofOffset;
-        parseChunk(&offset);
+        addFragmentToIndex(mFirstMoofOffset, 0);
+        parseFragment(mFirstMoofOffset);
     }
 }
 
@@ -3832,6 +3843,69 @@ status_t MPEG4Source::parseChunk(off64_t *offset) {
     return OK;
 }
 
+status_t MPEG4Source::parseFragment(off64_t moofOffset) {
+    mCurrentMoofOffset = moofOffset;
+    // stays at or before mCurrentMoofOffset if there is no next fragment
+    mNextMoofOffset = moofOffset;
+    mCurrentSamples.clear();
+    mCurrentSampleIndex = 0;
+
+    off64_t offset = moofOffset;
+    return parseChunk(&offset);
+}
+
+void MPEG4Source::addFragmentToIndex(off64_t moofOffset, uint64_t startTime) {
+    // Fragments are only indexed in order, so that the index never has gaps.
+    if (!mFragmentIndex.isEmpty()
+            && moofOffset <= mFragmentIndex.itemAt(mFragmentIndex.size() - 1).mMoofOffset) {
+        return;
+    }
+    FragmentEntry entry;
+    entry.mMoofOffset = moofOffset;
+    entry.mStartTime = startTime;
+    mFragmentIndex.push(entry);
+}
+
+size_t MPEG4Source::findFragment(uint64_t seekTime, ReadOptions::SeekMode mode) {
+    // Extend the index until it goes past the requested time. Only the moof boxes are read.
+    while (mFragmentIndex.itemAt(mFragmentIndex.size() - 1).mStartTime <= seekTime) {
+        const FragmentEntry last = mFragmentIndex.itemAt(mFragmentIndex.size() - 1);
+        parseFragment(last.mMoofOffset);
+        if (mNextMoofOffset <= last.mMoofOffset) {
+            break;
+        }
+        uint64_t duration = 0;
+        for (size_t i = 0; i < mCurrentSamples.size(); ++i) {
+            duration += mCurrentSamples[i].duration;
+        }
+        addFragmentToIndex(mNextMoofOffset, last.mStartTime + duration);
+    }
+
+    // the last fragment starting at or before the requested time
+    size_t lo = 0;
+    size_t hi = mFragmentIndex.size();
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (mFragmentIndex.itemAt(mid).mStartTime <= seekTime) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // The first sample of a fragment is its only known sync sample.
+    if (lo + 1 < mFragmentIndex.size()) {
+        uint64_t startTime = mFragmentIndex.itemAt(lo).mStartTime;
+        uint64_t nextStartTime = mFragmentIndex.itemAt(lo + 1).mStartTime;
+        if ((mode == ReadOptions::SEEK_NEXT_SYNC && seekTime > startTime) ||
+            (mode == ReadOptions::SEEK_CLOSEST_SYNC &&
+            (seekTime - startTime) > (nextStartTime - seekTime))) {
+            ++lo;
+        }
+    }
+    return lo;
+}
+
 status_t MPEG4Source::parseSampleAuxiliaryInformationSizes(
         off64_t offset, off64_t /* size */) {
     ALOGV("parseSampleAuxiliaryInformationSizes");
@@ -4652,14 +4726,12 @@ status_t MPEG4Source::fragmentedRead(
             mCurrentSampleIndex = 0;
             parseChunk(&totalOffset);
             mCurrentTime = totalTime * mTimescale / 1000000ll;
-        } else {
-            // without sidx boxes, we can only seek to 0
-            mCurrentMoofOffset = mFirstMoofOffset;
-            mCurrentSamples.clear();
-            mCurrentSampleIndex = 0;
-            off64_t tmp = mCurrentMoofOffset;
-            parseChunk(&tmp);
-            mCurrentTime = 0;
+        } else if (!mFragmentIndex.isEmpty()) {
+            // without sidx boxes, look the fragment up in the ones parsed so far
+            uint64_t seekTime = seekTimeUs < 0 ? 0 : seekTimeUs * mTimescale / 1000000ll;
+            const FragmentEntry &entry = mFragmentIndex.itemAt(findFragment(seekTime, mode));
+            mCurrentTime = (uint32_t)entry.mStartTime;
+            parseFragment(entry.mMoofOffset);
         }
 
         if (mBuffer != NULL) {
@@ -4683,11 +4755,10 @@ status_t MPEG4Source::fragmentedRead(
             if (mNextMoofOffset <= mCurrentMoofOffset) {
                 return ERROR_END_OF_STREAM;
             }
-            off64_t nextMoof = mNextMoofOffset;
-            mCurrentMoofOffset = nextMoof;
-            mCurrentSamples.clear();
-            mCurrentSampleIndex = 0;
-            parseChunk(&nextMoof);
+            if (mSegments.isEmpty()) {
+                addFragmentToIndex(mNextMoofOffset, mCurrentTime);
+            }
+            parseFragment(mNextMoofOffset);
             if (mCurrentSampleIndex >= mCurrentSamples.size()) {
                 return ERROR_END_OF_STREAM;
             }
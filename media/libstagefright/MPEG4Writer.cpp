@@ -22,6 +22,7 @@
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <linux/falloc.h>
 #include <pthread.h>
 #include <sys/prctl.h>
 #include <sys/stat.h>
@@ -70,6 +71,17 @@ static const uint8_t kNalUnitTypeSeqParamSet = 0x07;
 static const uint8_t kNalUnitTypePicParamSet = 0x08;
 static const int64_t kInitialDelayTimeUs     = 700000LL;
 
+// The file data is written in large writes of whole blocks, to space
+// preallocated ahead of them.
+static const size_t  kFileBlockSize          = 4096;
+static const size_t  kWriteBufferSize        = 1024 * 1024;
+static const int64_t kPreallocationSize      = 16 * 1024 * 1024;
+
+// The sample tables are stored in blocks of kTableBlockSize bytes, and up
+// to kMaxFreeTableBlocks blocks are kept for reuse.
+static const size_t  kTableBlockSize         = 16 * 1024;
+static const size_t  kMaxFreeTableBlocks     = 256;
+
 static const char kMetaKey_Version[]    = "com.android.version";
 #ifdef SHOW_MODEL_BUILD
 static const char kMetaKey_Model[]      = "com.android.model";
@@ -93,6 +105,47 @@ static const uint8_t kHevcNalUnitTypes[5] = {
 /* uncomment to include model and build in meta */
 //#define SHOW_MODEL_BUILD 1
 
+// The fixed size blocks the sample tables of the tracks are stored in. Free
+// blocks are kept for the tables of the next recording in the process, so
+// that a recording does not go back to the allocator for each of them.
+struct TableBlockPool {
+    // Returns a block of kTableBlockSize bytes, or NULL.
+    static void *acquire();
+    static void release(void *block);
+
+private:
+    static Mutex sLock;
+    static Vector<void *> sFreeBlocks;
+};
+
+Mutex TableBlockPool::sLock;
+Vector<void *> TableBlockPool::sFreeBlocks;
+
+// static
+void *TableBlockPool::acquire() {
+    {
+        Mutex::Autolock autoLock(sLock);
+        if (!sFreeBlocks.isEmpty()) {
+            void *block = sFreeBlocks.top();
+            sFreeBlocks.pop();
+            return block;
+        }
+    }
+    return malloc(kTableBlockSize);
+}
+
+// static
+void TableBlockPool::release(void *block) {
+    {
+        Mutex::Autolock autoLock(sLock);
+        if (sFreeBlocks.size() < kMaxFreeTableBlocks) {
+            sFreeBlocks.push(block);
+            return;
+        }
+    }
+    free(block);
+}
+
 class MPEG4Writer::Track {
 public:
     Track(MPEG4Writer *owner, const sp<IMediaSource> &source, size_t trackId);
@@ -114,6 +167,12 @@ public:
     bool isMPEG4() const { return mIsMPEG4; }
     void addChunkOffset(off64_t offset);
     int32_t getTrackId() const { return mTrackId; }
+    // Simple validation on the codec specific data
+    status_t checkCodecSpecificData() const;
+    void writeTrafBox(const Chunk &chunk, off64_t moofOffset);
+    void fixupTrunDataOffset(uint32_t dataOffset);
+    void fixupTrunSampleSize(size_t index, uint32_t size);
+    void fixupDurations();
     status_t dump(int fd, const Vector<String16>& args) const;
     static const char *getFourCCForMime(const char *mime);
 
@@ -123,27 +182,24 @@ private:
         kSampleArraySize = 1000,
     };
 
-    // A helper class to handle faster write box with table entries
+    // A helper class to handle faster write box with table entries.
+    // The entries are stored in the blocks of the table block pool.
     template<class TYPE, unsigned ENTRY_SIZE>
     // ENTRY_SIZE: # of values in each entry
     struct ListTableEntries {
         static_assert(ENTRY_SIZE > 0, "ENTRY_SIZE must be positive");
-        ListTableEntries(uint32_t elementCapacity)
-            : mElementCapacity(elementCapacity),
+        static_assert(sizeof(TYPE) * ENTRY_SIZE <= kTableBlockSize, "entry too large");
+        ListTableEntries()
+            : mElementCapacity(kTableBlockSize / (sizeof(TYPE) * ENTRY_SIZE)),
             mTotalNumTableEntries(0),
             mNumValuesInCurrEntry(0),
             mCurrTableEntriesElement(NULL) {
-            CHECK_GT(mElementCapacity, 0);
-            // Ensure no integer overflow on allocation in add().
-            CHECK_LT(ENTRY_SIZE, UINT32_MAX / mElementCapacity);
         }
 
-        // Free the allocated memory.
+        // Give the blocks back to the pool.
         ~ListTableEntries() {
-            while (!mTableEntryList.empty()) {
-                typename List<TYPE *>::iterator it = mTableEntryList.begin();
-                delete[] (*it);
-                mTableEntryList.erase(it);
+            for (size_t i = 0; i < mTableEntryBlocks.size(); ++i) {
+                TableBlockPool::release(mTableEntryBlocks[i]);
             }
         }
 
@@ -154,16 +210,10 @@ private:
         void set(const TYPE& value, uint32_t pos) {
             CHECK_LT(pos, mTotalNumTableEntries * ENTRY_SIZE);
 
-            typename List<TYPE *>::iterator it = mTableEntryList.begin();
-            uint32_t iterations = (pos / (mElementCapacity * ENTRY_SIZE));
-            while (it != mTableEntryList.end() && iterations > 0) {
-                ++it;
-                --iterations;
-            }
-            CHECK(it != mTableEntryList.end());
-            CHECK_EQ(iterations, 0);
+            uint32_t block = pos / (mElementCapacity * ENTRY_SIZE);
+            CHECK_LT(block, mTableEntryBlocks.size());
 
-            (*it)[(pos % (mElementCapacity * ENTRY_SIZE))] = value;
+            mTableEntryBlocks[block][(pos % (mElementCapacity * ENTRY_SIZE))] = value;
         }
 
         // Get the value at the given position by the given value.
@@ -175,16 +225,10 @@ private:
                 return false;
             }
 
-            typename List<TYPE *>::iterator it = mTableEntryList.begin();
-            uint32_t iterations = (pos / (mElementCapacity * ENTRY_SIZE));
-            while (it != mTableEntryList.end() && iterations > 0) {
-                ++it;
-                --iterations;
-            }
-            CHECK(it != mTableEntryList.end());
-            CHECK_EQ(iterations, 0);
+            uint32_t block = pos / (mElementCapacity * ENTRY_SIZE);
+            CHECK_LT(block, mTableEntryBlocks.size());
 
-            value = (*it)[(pos % (mElementCapacity * ENTRY_SIZE))];
+            value = mTableEntryBlocks[block][(pos % (mElementCapacity * ENTRY_SIZE))];
             return true;
         }
 
@@ -193,7 +237,8 @@ private:
                 std::function<void(size_t /* ix */, TYPE(& /* entry */)[ENTRY_SIZE])> update) {
             size_t nEntries = mTotalNumTableEntries + mNumValuesInCurrEntry / ENTRY_SIZE;
             size_t ix = 0;
-            for (TYPE *entryArray : mTableEntryList) {
+            for (size_t block = 0; block < mTableEntryBlocks.size(); ++block) {
+                TYPE *entryArray = mTableEntryBlocks[block];
                 size_t num = std::min(nEntries, (size_t)mElementCapacity);
                 for (size_t i = 0; i < num; ++i) {
                     update(ix++, (TYPE(&)[ENTRY_SIZE])(*entryArray));
@@ -210,9 +255,9 @@ private:
             uint32_t nEntries = mTotalNumTableEntries % mElementCapacity;
             uint32_t nValues  = mNumValuesInCurrEntry % ENTRY_SIZE;
             if (nEntries == 0 && nValues == 0) {
-                mCurrTableEntriesElement = new TYPE[ENTRY_SIZE * mElementCapacity];
+                mCurrTableEntriesElement = static_cast<TYPE *>(TableBlockPool::acquire());
                 CHECK(mCurrTableEntriesElement != NULL);
-                mTableEntryList.push_back(mCurrTableEntriesElement);
+                mTableEntryBlocks.push(mCurrTableEntriesElement);
             }
 
             uint32_t pos = nEntries * ENTRY_SIZE + nValues;
@@ -233,14 +278,14 @@ private:
             CHECK_EQ(mNumValuesInCurrEntry % ENTRY_SIZE, 0);
             uint32_t nEntries = mTotalNumTableEntries;
             writer->writeInt32(nEntries);
-            for (typename List<TYPE *>::iterator it = mTableEntryList.begin();
-                it != mTableEntryList.end(); ++it) {
+            for (size_t block = 0; block < mTableEntryBlocks.size(); ++block) {
                 CHECK_GT(nEntries, 0);
                 if (nEntries >= mElementCapacity) {
-                    writer->write(*it, sizeof(TYPE) * ENTRY_SIZE, mElementCapacity);
+                    writer->write(mTableEntryBlocks[block],
+                            sizeof(TYPE) * ENTRY_SIZE, mElementCapacity);
                     nEntries -= mElementCapacity;
                 } else {
-                    writer->write(*it, sizeof(TYPE) * ENTRY_SIZE, nEntries);
+                    writer->write(mTableEntryBlocks[block], sizeof(TYPE) * ENTRY_SIZE, nEntries);
                     break;
                 }
             }
@@ -250,11 +295,11 @@ private:
         uint32_t count() const { return mTotalNumTableEntries; }
 
     private:
-        uint32_t         mElementCapacity;  // # entries in an element
+        uint32_t         mElementCapacity;  // # entries in a block
         uint32_t         mTotalNumTableEntries;
         uint32_t         mNumValuesInCurrEntry;  // up to ENTRY_SIZE
         TYPE             *mCurrTableEntriesElement;
-        mutable List<TYPE *>     mTableEntryList;
+        Vector<TYPE *>   mTableEntryBlocks;
 
         DISALLOW_EVIL_CONSTRUCTORS(ListTableEntries);
     };
@@ -288,6 +333,8 @@ private:
     List<MediaBuffer *> mChunkSamples;
 
     bool                mSamplesHaveSameSize;
+    uint32_t            mNumSamples;
+    uint32_t            mNumSyncSamples;
     ListTableEntries<uint32_t, 1> *mStszTableEntries;
 
     ListTableEntries<uint32_t, 1> *mStcoTableEntries;
@@ -300,6 +347,14 @@ private:
     int64_t mMinCttsOffsetTimeUs;
     int64_t mMaxCttsOffsetTimeUs;
 
+    // Samples of the current movie fragment, and the decoding time it starts at
+    Vector<FragmentSample> mFragmentSamples;
+    int64_t mFragmentDecodeTimeTicks;
+    // Where the last 'trun' box and the durations of the movie header were written
+    off64_t mTrunOffset;
+    off64_t mTkhdDurationOffset;
+    off64_t mMdhdDurationOffset;
+
     // Sequence parameter set or picture parameter set
     struct AVCParamSet {
         AVCParamSet(uint16_t length, const uint8_t *data)
@@ -360,11 +415,10 @@ private:
     // value, the user-supplied time scale will be used.
     void setTimeScale();
 
-    // Simple validation on the codec specific data
-    status_t checkCodecSpecificData() const;
     int32_t mRotation;
 
     void updateTrackSizeEstimate();
+    void bufferFragment(int64_t timestampUs);
     void addOneStscTableEntry(size_t chunkId, size_t sampleId);
     void addOneStssTableEntry(size_t sampleId);
 
@@ -432,6 +486,18 @@ MPEG4Writer::MPEG4Writer(int fd)
       mLongitudex10000(0),
       mAreGeoTagsAvailable(false),
       mStartTimeOffsetMs(-1),
+      mFragmentDurationUs(0),
+      mFragmentedMoovWritten(false),
+      mFragmentSequenceNumber(0),
+      mMvhdDurationOffset(0),
+      mWriteBuffer(NULL),
+      mWriteBufferLength(0),
+      mPreallocate(true),
+      mPreallocatedOffset(0),
+      mNumFileWrites(0),
+      mFileWriteBytes(0),
+      mTotalFileWriteTimeUs(0),
+      mMaxFileWriteTimeUs(0),
       mMetaKeys(new AMessage()) {
     addDeviceMeta();
 
@@ -464,6 +530,11 @@ status_t MPEG4Writer::dump(
     result.append(buffer);
     snprintf(buffer, SIZE, "     mStarted: %s\n", mStarted? "true": "false");
     result.append(buffer);
+    snprintf(buffer, SIZE, "     file writes: %" PRId64 " of %" PRId64 " bytes, latency avg %"
+            PRId64 " max %" PRId64 " us\n", mNumFileWrites, mFileWriteBytes,
+            mNumFileWrites > 0 ? mTotalFileWriteTimeUs / mNumFileWrites : 0,
+            mMaxFileWriteTimeUs);
+    result.append(buffer);
     ::write(fd, result.string(), result.size());
     for (List<Track *>::iterator it = mTracks.begin();
          it != mTracks.end(); ++it) {
@@ -482,7 +553,7 @@ status_t MPEG4Writer::Track::dump(
     snprintf(buffer, SIZE, "       reached EOS: %s\n",
             mReachedEOS? "true": "false");
     result.append(buffer);
-    snprintf(buffer, SIZE, "       frames encoded : %d\n", mStszTableEntries->count());
+    snprintf(buffer, SIZE, "       frames encoded : %d\n", mNumSamples);
     result.append(buffer);
     snprintf(buffer, SIZE, "       duration encoded : %" PRId64 " us\n", mTrackDurationUs);
     result.append(buffer);
@@ -743,6 +814,11 @@ status_t MPEG4Writer::start(MetaData *param) {
     CHECK_GT(mTimeScale, 0);
     ALOGV("movie time scale: %d", mTimeScale);
 
+    if (param && param->findInt64(kKeyFragmentDurationUs, &mFragmentDurationUs) &&
+        mFragmentDurationUs > 0) {
+        ALOGI("Writing movie fragments of %" PRId64 " us", mFragmentDurationUs);
+    }
+
     /*
      * When the requested file size limit is small, the priority
      * is to meet the file size limit requirement, rather than
@@ -753,6 +829,14 @@ status_t MPEG4Writer::start(MetaData *param) {
         (mMaxFileSizeLimitBytes != 0 &&
          mMaxFileSizeLimitBytes >= kMinStreamableFileSizeInBytes);
 
+    /*
+     * A fragmented file has its movie header written in front of the
+     * first movie fragment, and needs no space reserved for it.
+     */
+    if (isFragmented()) {
+        mStreamableFile = false;
+    }
+
     /*
      * mWriteMoovBoxToMemory is true if the amount of data in moov box is
      * smaller than the reserved free space at the beginning of a file, AND
@@ -793,6 +877,13 @@ status_t MPEG4Writer::start(MetaData *param) {
     mMoovBoxBuffer = NULL;
     mMoovBoxBufferOffset = 0;
 
+    // Without the buffer, the data is written as it comes.
+    if (posix_memalign((void **)&mWriteBuffer, kFileBlockSize, kWriteBufferSize) != 0) {
+        ALOGW("Failed to allocate the write buffer");
+        mWriteBuffer = NULL;
+    }
+    mWriteBufferLength = 0;
+
     writeFtypBox(param);
 
     mFreeBoxOffset = mOffset;
@@ -815,9 +906,13 @@ status_t MPEG4Writer::start(MetaData *param) {
         mMdatOffset = mOffset;
     }
 
+    // The reserved free space is skipped
+    flushWriteBuffer(true);
     mOffset = mMdatOffset;
     lseek64(mFd, mMdatOffset, SEEK_SET);
-    if (mUse32BitOffset) {
+    if (isFragmented()) {
+        // Each movie fragment comes with its own 'mdat' box
+    } else if (mUse32BitOffset) {
         write("????mdat", 8);
     } else {
         write("\x00\x00\x00\x01mdat????????", 16);
@@ -929,6 +1024,18 @@ void MPEG4Writer::writeCompositionMatrix(int degrees) {
 }
 
 void MPEG4Writer::release() {
+    flushWriteBuffer(true);
+    if (mPreallocatedOffset > 0) {
+        // Give back the space preallocated past the end of the file
+        struct stat st;
+        if (fstat(mFd, &st) == 0) {
+            ftruncate(mFd, st.st_size);
+        }
+        mPreallocatedOffset = 0;
+    }
+    free(mWriteBuffer);
+    mWriteBuffer = NULL;
+    mWriteBufferLength = 0;
     close(mFd);
     mFd = -1;
     mInitCheck = NO_INIT;
@@ -977,6 +1084,17 @@ status_t MPEG4Writer::reset() {
 
     stopWriterThread();
 
+    // The movie header of a fragmented file was written with the first
+    // fragment; the fragments written out stay playable even on error.
+    if (isFragmented()) {
+        if (mFragmentedMoovWritten) {
+            fixupFragmentedDurations(maxDurationUs);
+        }
+        CHECK(mBoxes.empty());
+        release();
+        return err;
+    }
+
     // Do not write out movie header on error.
     if (err != OK) {
         release();
@@ -985,16 +1103,13 @@ status_t MPEG4Writer::reset() {
 
     // Fix up the size of the 'mdat' chunk.
     if (mUse32BitOffset) {
-        lseek64(mFd, mMdatOffset, SEEK_SET);
         uint32_t size = htonl(static_cast<uint32_t>(mOffset - mMdatOffset));
-        ::write(mFd, &size, 4);
+        writeToFileAt(mMdatOffset, &size, 4);
     } else {
-        lseek64(mFd, mMdatOffset + 8, SEEK_SET);
         uint64_t size = mOffset - mMdatOffset;
         size = hton64(size);
-        ::write(mFd, &size, 8);
+        writeToFileAt(mMdatOffset + 8, &size, 8);
     }
-    lseek64(mFd, mOffset, SEEK_SET);
 
     // Construct moov box now
     mMoovBoxBufferOffset = 0;
@@ -1018,14 +1133,14 @@ status_t MPEG4Writer::reset() {
         CHECK_LE(mMoovBoxBufferOffset + 8, mEstimatedMoovBoxSize);
 
         // Moov box
-        lseek64(mFd, mFreeBoxOffset, SEEK_SET);
-        mOffset = mFreeBoxOffset;
-        write(mMoovBoxBuffer, 1, mMoovBoxBufferOffset);
+        writeToFileAt(mFreeBoxOffset, mMoovBoxBuffer, mMoovBoxBufferOffset);
 
         // Free box
-        lseek64(mFd, mOffset, SEEK_SET);
-        writeInt32(mEstimatedMoovBoxSize - mMoovBoxBufferOffset);
-        write("free", 4);
+        uint8_t freeBox[8];
+        uint32_t freeBoxSize = htonl(mEstimatedMoovBoxSize - mMoovBoxBufferOffset);
+        memcpy(freeBox, &freeBoxSize, 4);
+        memcpy(freeBox + 4, "free", 4);
+        writeToFileAt(mFreeBoxOffset + mMoovBoxBufferOffset, freeBox, 8);
     } else {
         ALOGI("The mp4 file will not be streamable.");
     }
@@ -1064,6 +1179,7 @@ void MPEG4Writer::writeMvhdBox(int64_t durationUs) {
     writeInt32(now);           // modification time
     writeInt32(mTimeScale);    // mvhd timescale
     int32_t duration = (durationUs * mTimeScale + 5E5) / 1E6;
+    mMvhdDurationOffset = mOffset;
     writeInt32(duration);
     writeInt32(0x10000);       // rate: 1.0
     writeInt16(0x100);         // volume
@@ -1093,9 +1209,41 @@ void MPEG4Writer::writeMoovBox(int64_t durationUs) {
         it != mTracks.end(); ++it, ++id) {
         (*it)->writeTrackHeader(mUse32BitOffset);
     }
+    if (isFragmented()) {
+        writeMvexBox();
+    }
     endBox();  // moov
 }
 
+void MPEG4Writer::writeMvexBox() {
+    beginBox("mvex");
+    for (List<Track *>::iterator it = mTracks.begin();
+        it != mTracks.end(); ++it) {
+        beginBox("trex");
+        writeInt32(0);                     // version=0, flags=0
+        writeInt32((*it)->getTrackId());   // track id
+        writeInt32(1);                     // default sample description index
+        writeInt32(0);                     // default sample duration
+        writeInt32(0);                     // default sample size
+        writeInt32(0);                     // default sample flags
+        endBox();  // trex
+    }
+    endBox();  // mvex
+}
+
+void MPEG4Writer::fixupFragmentedDurations(int64_t durationUs) {
+    rewriteInt32(mMvhdDurationOffset, (durationUs * mTimeScale + 5E5) / 1E6);
+    for (List<Track *>::iterator it = mTracks.begin();
+        it != mTracks.end(); ++it) {
+        (*it)->fixupDurations();
+    }
+}
+
+void MPEG4Writer::rewriteInt32(off64_t offset, uint32_t x) {
+    x = htonl(x);
+    writeToFileAt(offset, &x, 4);
+}
+
 void MPEG4Writer::writeFtypBox(MetaData *param) {
     beginBox("ftyp");
 
@@ -1159,14 +1307,119 @@ void MPEG4Writer::unlock() {
     mLock.unlock();
 }
 
+void MPEG4Writer::writeToFile(const void *data, size_t size) {
+    if (mWriteBuffer == NULL) {
+        issueFileWrite(data, size, mOffset);
+        mOffset += size;
+        return;
+    }
+
+    const uint8_t *ptr = (const uint8_t *)data;
+    while (size > 0) {
+        size_t n = kWriteBufferSize - mWriteBufferLength;
+        if (n > size) {
+            n = size;
+        }
+        memcpy(mWriteBuffer + mWriteBufferLength, ptr, n);
+        mWriteBufferLength += n;
+        mOffset += n;
+        ptr += n;
+        size -= n;
+
+        if (mWriteBufferLength == kWriteBufferSize) {
+            flushWriteBuffer(false);
+        }
+    }
+}
+
+void MPEG4Writer::writeToFileAt(off64_t offset, const void *data, size_t size) {
+    const uint8_t *ptr = (const uint8_t *)data;
+    const off64_t bufferOffset = mOffset - mWriteBufferLength;
+    if (offset < bufferOffset) {
+        size_t n = size;
+        if (offset + (off64_t)n > bufferOffset) {
+            n = bufferOffset - offset;
+        }
+        issueFileWrite(ptr, n, offset);
+        offset += n;
+        ptr += n;
+        size -= n;
+    }
+    if (size > 0) {
+        // The rest is still in the buffer
+        CHECK_LE(offset + (off64_t)size, mOffset);
+        memcpy(mWriteBuffer + (offset - bufferOffset), ptr, size);
+    }
+}
+
+void MPEG4Writer::flushWriteBuffer(bool all) {
+    if (mWriteBufferLength == 0) {
+        return;
+    }
+
+    const off64_t bufferOffset = mOffset - mWriteBufferLength;
+    size_t length = mWriteBufferLength;
+    if (!all) {
+        // End the write on a block boundary, so that the next one starts on one
+        off64_t end = mOffset & ~((off64_t)kFileBlockSize - 1);
+        if (end > bufferOffset) {
+            length = end - bufferOffset;
+        }
+    }
+
+    preallocate(bufferOffset + length);
+    issueFileWrite(mWriteBuffer, length, bufferOffset);
+    memmove(mWriteBuffer, mWriteBuffer + length, mWriteBufferLength - length);
+    mWriteBufferLength -= length;
+}
+
+void MPEG4Writer::issueFileWrite(const void *data, size_t size, off64_t offset) {
+    const int64_t startTimeUs = systemTime() / 1000;
+    const uint8_t *ptr = (const uint8_t *)data;
+    while (size > 0) {
+        ssize_t n = pwrite64(mFd, ptr, size, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            ALOGE("Failed to write %zu bytes at %" PRId64 ": %s",
+                    size, (int64_t)offset, n < 0 ? strerror(errno) : "no space");
+            break;
+        }
+        ptr += n;
+        offset += n;
+        size -= n;
+        mFileWriteBytes += n;
+    }
+
+    const int64_t writeTimeUs = systemTime() / 1000 - startTimeUs;
+    ++mNumFileWrites;
+    mTotalFileWriteTimeUs += writeTimeUs;
+    if (writeTimeUs > mMaxFileWriteTimeUs) {
+        mMaxFileWriteTimeUs = writeTimeUs;
+    }
+}
+
+void MPEG4Writer::preallocate(off64_t offset) {
+    // Keep at least half of the preallocated space ahead of the data
+    if (!mPreallocate || offset + kPreallocationSize / 2 <= mPreallocatedOffset) {
+        return;
+    }
+
+    off64_t start = offset > mPreallocatedOffset ? offset : mPreallocatedOffset;
+    off64_t end = offset + kPreallocationSize;
+    if (fallocate64(mFd, FALLOC_FL_KEEP_SIZE, start, end - start) != 0) {
+        ALOGV("No preallocation: %s", strerror(errno));
+        mPreallocate = false;
+        return;
+    }
+    mPreallocatedOffset = end;
+}
+
 off64_t MPEG4Writer::addSample_l(MediaBuffer *buffer) {
     off64_t old_offset = mOffset;
 
-    ::write(mFd,
-          (const uint8_t *)buffer->data() + buffer->range_offset(),
-          buffer->range_length());
-
-    mOffset += buffer->range_length();
+    writeToFile((const uint8_t *)buffer->data() + buffer->range_offset(),
+            buffer->range_length());
 
     return old_offset;
 }
@@ -1222,29 +1475,21 @@ off64_t MPEG4Writer::addLengthPrefixedSample_l(MediaBuffer *buffer) {
     size_t length = buffer->range_length();
 
     if (mUse4ByteNalLength) {
-        uint8_t x = length >> 24;
-        ::write(mFd, &x, 1);
-        x = (length >> 16) & 0xff;
-        ::write(mFd, &x, 1);
-        x = (length >> 8) & 0xff;
-        ::write(mFd, &x, 1);
-        x = length & 0xff;
-        ::write(mFd, &x, 1);
-
-        ::write(mFd,
-              (const uint8_t *)buffer->data() + buffer->range_offset(),
-              length);
-
-        mOffset += length + 4;
+        uint8_t x[4];
+        x[0] = length >> 24;
+        x[1] = (length >> 16) & 0xff;
+        x[2] = (length >> 8) & 0xff;
+        x[3] = length & 0xff;
+        writeToFile(x, 4);
+        writeToFile((const uint8_t *)buffer->data() + buffer->range_offset(), length);
     } else {
         CHECK_LT(length, 65536);
 
-        uint8_t x = length >> 8;
-        ::write(mFd, &x, 1);
-        x = length & 0xff;
-        ::write(mFd, &x, 1);
-        ::write(mFd, (const uint8_t *)buffer->data() + buffer->range_offset(), length);
-        mOffset += length + 2;
+        uint8_t x[2];
+        x[0] = length >> 8;
+        x[1] = length & 0xff;
+        writeToFile(x, 2);
+        writeToFile((const uint8_t *)buffer->data() + buffer->range_offset(), length);
     }
 
     return old_offset;
@@ -1269,10 +1514,8 @@ size_t MPEG4Writer::write(
                  it != mBoxes.end(); ++it) {
                 (*it) += mOffset;
             }
-            lseek64(mFd, mOffset, SEEK_SET);
-            ::write(mFd, mMoovBoxBuffer, mMoovBoxBufferOffset);
-            ::write(mFd, ptr, bytes);
-            mOffset += (bytes + mMoovBoxBufferOffset);
+            writeToFile(mMoovBoxBuffer, mMoovBoxBufferOffset);
+            writeToFile(ptr, bytes);
 
             // All subsequent moov box content will be written
             // to the end of the file.
@@ -1282,8 +1525,7 @@ size_t MPEG4Writer::write(
             mMoovBoxBufferOffset += bytes;
         }
     } else {
-        ::write(mFd, ptr, size * nmemb);
-        mOffset += bytes;
+        writeToFile(ptr, bytes);
     }
     return bytes;
 }
@@ -1316,10 +1558,8 @@ void MPEG4Writer::endBox() {
        int32_t x = htonl(mMoovBoxBufferOffset - offset);
        memcpy(mMoovBoxBuffer + offset, &x, 4);
     } else {
-        lseek64(mFd, offset, SEEK_SET);
-        writeInt32(mOffset - offset);
-        mOffset -= 4;
-        lseek64(mFd, mOffset, SEEK_SET);
+        int32_t x = htonl(mOffset - offset);
+        writeToFileAt(offset, &x, 4);
     }
 }
 
@@ -1456,6 +1696,10 @@ bool MPEG4Writer::isFileStreamable() const {
     return mStreamableFile;
 }
 
+bool MPEG4Writer::isFragmented() const {
+    return mFragmentDurationUs > 0;
+}
+
 bool MPEG4Writer::exceedsFileSizeLimit() {
     // No limit
     if (mMaxFileSizeLimitBytes == 0) {
@@ -1542,13 +1786,19 @@ MPEG4Writer::Track::Track(
       mTrackDurationUs(0),
       mEstimatedTrackSizeBytes(0),
       mSamplesHaveSameSize(true),
-      mStszTableEntries(new ListTableEntries<uint32_t, 1>(1000)),
-      mStcoTableEntries(new ListTableEntries<uint32_t, 1>(1000)),
-      mCo64TableEntries(new ListTableEntries<off64_t, 1>(1000)),
-      mStscTableEntries(new ListTableEntries<uint32_t, 3>(1000)),
-      mStssTableEntries(new ListTableEntries<uint32_t, 1>(1000)),
-      mSttsTableEntries(new ListTableEntries<uint32_t, 2>(1000)),
-      mCttsTableEntries(new ListTableEntries<uint32_t, 2>(1000)),
+      mNumSamples(0),
+      mNumSyncSamples(0),
+      mStszTableEntries(new ListTableEntries<uint32_t, 1>()),
+      mStcoTableEntries(new ListTableEntries<uint32_t, 1>()),
+      mCo64TableEntries(new ListTableEntries<off64_t, 1>()),
+      mStscTableEntries(new ListTableEntries<uint32_t, 3>()),
+      mStssTableEntries(new ListTableEntries<uint32_t, 1>()),
+      mSttsTableEntries(new ListTableEntries<uint32_t, 2>()),
+      mCttsTableEntries(new ListTableEntries<uint32_t, 2>()),
+      mFragmentDecodeTimeTicks(-1),
+      mTrunOffset(0),
+      mTkhdDurationOffset(0),
+      mMdhdDurationOffset(0),
       mCodecSpecificData(NULL),
       mCodecSpecificDataSize(0),
       mGotAllCodecSpecificData(false),
@@ -1594,6 +1844,10 @@ void MPEG4Writer::Track::updateTrackSizeEstimate() {
                                     stcoBoxSizeBytes +           // stco box size
                                     stszBoxSizeBytes;            // stsz box size
     }
+    if (mOwner->isFragmented()) {
+        // Each sample has its entry in the 'trun' box of its fragment
+        mEstimatedTrackSizeBytes += mNumSamples * 16;
+    }
 }
 
 void MPEG4Writer::Track::addOneStscTableEntry(
@@ -1755,6 +2009,11 @@ void MPEG4Writer::writeChunkToFile(Chunk* chunk) {
     ALOGV("writeChunkToFile: %" PRId64 " from %s track",
         chunk->mTimeStampUs, chunk->mTrack->isAudio()? "audio": "video");
 
+    if (isFragmented()) {
+        writeFragmentToFile(chunk);
+        return;
+    }
+
     int32_t isFirstSample = true;
     while (!chunk->mSamples.empty()) {
         List<MediaBuffer *>::iterator it = chunk->mSamples.begin();
@@ -1775,6 +2034,68 @@ void MPEG4Writer::writeChunkToFile(Chunk* chunk) {
     chunk->mSamples.clear();
 }
 
+void MPEG4Writer::writeFragmentToFile(Chunk* chunk) {
+    if (!mFragmentedMoovWritten) {
+        for (List<Track *>::iterator it = mTracks.begin();
+             it != mTracks.end(); ++it) {
+            if ((*it)->checkCodecSpecificData() != OK) {
+                ALOGE("Dropping a fragment of the %s track, %s track has no codec specific data",
+                        chunk->mTrack->isAudio()? "audio": "video",
+                        (*it)->isAudio()? "audio": "video");
+                while (!chunk->mSamples.empty()) {
+                    (*chunk->mSamples.begin())->release();
+                    chunk->mSamples.erase(chunk->mSamples.begin());
+                }
+                return;
+            }
+        }
+        writeMoovBox(0);
+        mFragmentedMoovWritten = true;
+    }
+
+    off64_t moofOffset = mOffset;
+    beginBox("moof");
+    beginBox("mfhd");
+    writeInt32(0);                         // version=0, flags=0
+    writeInt32(++mFragmentSequenceNumber); // sequence number
+    endBox();  // mfhd
+    chunk->mTrack->writeTrafBox(*chunk, moofOffset);
+    endBox();  // moof
+
+    off64_t mdatOffset = mOffset;
+    uint32_t mdatSize = 8;
+    for (size_t i = 0; i < chunk->mFragmentSamples.size(); ++i) {
+        mdatSize += chunk->mFragmentSamples.itemAt(i).mSize;
+    }
+    writeInt32(mdatSize);
+    writeFourcc("mdat");
+    chunk->mTrack->fixupTrunDataOffset(mOffset - moofOffset);
+
+    size_t index = 0;
+    while (!chunk->mSamples.empty()) {
+        List<MediaBuffer *>::iterator it = chunk->mSamples.begin();
+
+        off64_t offset = (chunk->mTrack->isAvc() || chunk->mTrack->isHevc())
+                                ? addMultipleLengthPrefixedSamples_l(*it)
+                                : addSample_l(*it);
+
+        // The start codes of the extra NAL units of a sample are replaced by
+        // length prefixes which need not be of the same size.
+        uint32_t size = mOffset - offset;
+        if (size != chunk->mFragmentSamples.itemAt(index).mSize) {
+            chunk->mTrack->fixupTrunSampleSize(index, size);
+        }
+        ++index;
+
+        (*it)->release();
+        (*it) = NULL;
+        chunk->mSamples.erase(it);
+    }
+    if (mOffset - mdatOffset != mdatSize) {
+        rewriteInt32(mdatOffset, mOffset - mdatOffset);
+    }
+}
+
 void MPEG4Writer::writeAllChunks() {
     ALOGV("writeAllChunks");
     size_t outstandingChunks = 0;
@@ -1797,6 +2118,12 @@ bool MPEG4Writer::findChunkToWrite(Chunk *chunk) {
     Track *track = NULL;
     for (List<ChunkInfo>::iterator it = mChunkInfos.begin();
          it != mChunkInfos.end(); ++it) {
+        // The movie header written with the first fragment describes all
+        // the tracks, so wait until every track has its first fragment.
+        if (isFragmented() && !mFragmentedMoovWritten && !mDone
+                && it->mChunks.empty() && !it->mTrack->reachedEOS()) {
+            return false;
+        }
         if (!it->mChunks.empty()) {
             List<Chunk>::iterator chunkIt = it->mChunks.begin();
             if (chunkIt->mTimeStampUs < minTimestampUs) {
@@ -2361,7 +2688,16 @@ status_t MPEG4Writer::Track::threadEntry() {
     int32_t count = 0;
     const int64_t interleaveDurationUs = mOwner->interleaveDuration();
     const bool hasMultipleTracks = (mOwner->numTracks() > 1);
+    const bool fragmented = mOwner->isFragmented();
+    // The samples of a single track are written from this thread, unless
+    // recording in real time, where the writer thread keeps the file writes
+    // from holding up the source.
+    const bool writesSamples =
+            !hasMultipleTracks && !fragmented && !mOwner->isRealTimeRecording();
+    const int64_t maxCttsOffsetTimeTicks =
+            (kMaxCttsOffsetTimeUs * mTimeScale + 500000LL) / 1000000LL;
     int64_t chunkTimestampUs = 0;
+    int64_t fragmentTimestampUs = 0;
     int32_t nChunks = 0;
     int32_t nActualFrames = 0;        // frames containing non-CSD data (non-0 length)
     int32_t nZeroLengthFrames = 0;
@@ -2500,7 +2836,7 @@ status_t MPEG4Writer::Track::threadEntry() {
         CHECK(meta_data->findInt64(kKeyTime, &timestampUs));
 
 ////////////////////////////////////////////////////////////////////////////////
-        if (mStszTableEntries->count() == 0) {
+        if (mNumSamples == 0) {
             mFirstSampleTimeRealUs = systemTime() / 1000;
             mStartTimestampUs = timestampUs;
             mOwner->setStartTimestampUs(mStartTimestampUs);
@@ -2579,7 +2915,9 @@ status_t MPEG4Writer::Track::threadEntry() {
                 break;
             }
 
-            if (mStszTableEntries->count() == 0) {
+            if (fragmented) {
+                // The offsets go to the 'trun' box of the fragment instead
+            } else if (mNumSamples == 0) {
                 // Force the first ctts table entry to have one single entry
                 // so that we can do adjustment for the initial track start
                 // time offset easily in writeCttsBox().
@@ -2597,7 +2935,7 @@ status_t MPEG4Writer::Track::threadEntry() {
             }
 
             // Update ctts time offset range
-            if (mStszTableEntries->count() == 0) {
+            if (mNumSamples == 0) {
                 mMinCttsOffsetTimeUs = currCttsOffsetTimeTicks;
                 mMaxCttsOffsetTimeUs = currCttsOffsetTimeTicks;
             } else {
@@ -2662,12 +3000,16 @@ status_t MPEG4Writer::Track::threadEntry() {
             }
         }
 
-        mStszTableEntries->add(htonl(sampleSize));
-        if (mStszTableEntries->count() > 2) {
+        // The sample tables of a fragmented file stay empty
+        ++mNumSamples;
+        if (!fragmented) {
+            mStszTableEntries->add(htonl(sampleSize));
+        }
+        if (!fragmented && mNumSamples > 2) {
 
             // Force the first sample to have its own stts entry so that
             // we can adjust its value later to maintain the A/V sync.
-            if (mStszTableEntries->count() == 3 || currDurationTicks != lastDurationTicks) {
+            if (mNumSamples == 3 || currDurationTicks != lastDurationTicks) {
                 addOneSttsTableEntry(sampleCount, lastDurationTicks);
                 sampleCount = 1;
             } else {
@@ -2676,7 +3018,7 @@ status_t MPEG4Writer::Track::threadEntry() {
 
         }
         if (mSamplesHaveSameSize) {
-            if (mStszTableEntries->count() >= 2 && previousSampleSize != sampleSize) {
+            if (mNumSamples >= 2 && previousSampleSize != sampleSize) {
                 mSamplesHaveSameSize = false;
             }
             previousSampleSize = sampleSize;
@@ -2688,7 +3030,10 @@ status_t MPEG4Writer::Track::threadEntry() {
         lastTimestampUs = timestampUs;
 
         if (isSync != 0) {
-            addOneStssTableEntry(mStszTableEntries->count());
+            ++mNumSyncSamples;
+            if (!fragmented) {
+                addOneStssTableEntry(mNumSamples);
+            }
         }
 
         if (mTrackingProgressStatus) {
@@ -2697,7 +3042,33 @@ status_t MPEG4Writer::Track::threadEntry() {
             }
             trackProgressStatus(timestampUs);
         }
-        if (!hasMultipleTracks) {
+        if (fragmented) {
+            if (!mFragmentSamples.isEmpty()) {
+                mFragmentSamples.editTop().mDurationTicks = currDurationTicks;
+
+                // Start each video fragment with a sync sample, so that
+                // playback can start at any fragment.
+                if (timestampUs - fragmentTimestampUs >= mOwner->mFragmentDurationUs &&
+                    (mIsAudio || isSync)) {
+                    bufferFragment(fragmentTimestampUs);
+                }
+            }
+            if (mFragmentSamples.isEmpty()) {
+                fragmentTimestampUs = timestampUs;
+            }
+
+            FragmentSample sample;
+            sample.mSize = sampleSize;
+            sample.mDurationTicks = 0;  // Known with the next sample
+            sample.mCompositionOffsetTicks =
+                    mIsAudio ? 0 : currCttsOffsetTimeTicks - maxCttsOffsetTimeTicks;
+            sample.mIsSync = mIsAudio || isSync;
+            mFragmentSamples.push(sample);
+            mChunkSamples.push_back(copy);
+            continue;
+        }
+
+        if (writesSamples) {
             off64_t offset = (mIsAvc || mIsHevc) ? mOwner->addMultipleLengthPrefixedSamples_l(copy)
                                  : mOwner->addSample_l(copy);
 
@@ -2747,8 +3118,10 @@ status_t MPEG4Writer::Track::threadEntry() {
     mOwner->trackProgressStatus(mTrackId, -1, err);
 
     // Last chunk
-    if (!hasMultipleTracks) {
-        addOneStscTableEntry(1, mStszTableEntries->count());
+    if (fragmented) {
+        // The last fragment is buffered once its duration is known below
+    } else if (writesSamples) {
+        addOneStscTableEntry(1, mNumSamples);
     } else if (!mChunkSamples.empty()) {
         addOneStscTableEntry(++nChunks, mChunkSamples.size());
         bufferChunk(timestampUs);
@@ -2757,14 +3130,19 @@ status_t MPEG4Writer::Track::threadEntry() {
     // We don't really know how long the last frame lasts, since
     // there is no frame time after it, just repeat the previous
     // frame's duration.
-    if (mStszTableEntries->count() == 1) {
+    if (mNumSamples == 1) {
         lastDurationUs = 0;  // A single sample's duration
         lastDurationTicks = 0;
     } else {
         ++sampleCount;  // Count for the last sample
     }
 
-    if (mStszTableEntries->count() <= 2) {
+    if (fragmented) {
+        if (!mFragmentSamples.isEmpty()) {
+            mFragmentSamples.editTop().mDurationTicks = lastDurationTicks;
+            bufferFragment(fragmentTimestampUs);
+        }
+    } else if (mNumSamples <= 2) {
         addOneSttsTableEntry(1, lastDurationTicks);
         if (sampleCount - 1 > 0) {
             addOneSttsTableEntry(sampleCount - 1, lastDurationTicks);
@@ -2787,7 +3165,7 @@ status_t MPEG4Writer::Track::threadEntry() {
     sendTrackSummary(hasMultipleTracks);
 
     ALOGI("Received total/0-length (%d/%d) buffers and encoded %d frames. - %s",
-            count, nZeroLengthFrames, mStszTableEntries->count(), trackName);
+            count, nZeroLengthFrames, mNumSamples, trackName);
     if (mIsAudio) {
         ALOGI("Audio track drift time: %" PRId64 " us", mOwner->getDriftTimeUs());
     }
@@ -2803,12 +3181,12 @@ bool MPEG4Writer::Track::isTrackMalFormed() const {
         return true;
     }
 
-    if (mStszTableEntries->count() == 0) {                      // no samples written
+    if (mNumSamples == 0) {                                     // no samples written
         ALOGE("The number of recorded samples is 0");
         return true;
     }
 
-    if (!mIsAudio && mStssTableEntries->count() == 0) {  // no sync frames for video
+    if (!mIsAudio && mNumSyncSamples == 0) {             // no sync frames for video
         ALOGE("There are no sync frames for video track");
         return true;
     }
@@ -2839,7 +3217,7 @@ void MPEG4Writer::Track::sendTrackSummary(bool hasMultipleTracks) {
 
     mOwner->notify(MEDIA_RECORDER_TRACK_EVENT_INFO,
                     trackNum | MEDIA_RECORDER_TRACK_INFO_ENCODED_FRAMES,
-                    mStszTableEntries->count());
+                    mNumSamples);
 
     {
         // The system delay time excluding the requested initial delay that
@@ -2941,6 +3319,24 @@ void MPEG4Writer::Track::bufferChunk(int64_t timestampUs) {
     mChunkSamples.clear();
 }
 
+void MPEG4Writer::Track::bufferFragment(int64_t timestampUs) {
+    ALOGV("bufferFragment: %zu samples", mFragmentSamples.size());
+
+    if (mFragmentDecodeTimeTicks < 0) {
+        mFragmentDecodeTimeTicks = getStartTimeOffsetScaledTime();
+    }
+
+    Chunk chunk(this, timestampUs, mChunkSamples);
+    chunk.mFragmentSamples = mFragmentSamples;
+    chunk.mBaseDecodeTimeTicks = mFragmentDecodeTimeTicks;
+    for (size_t i = 0; i < mFragmentSamples.size(); ++i) {
+        mFragmentDecodeTimeTicks += mFragmentSamples.itemAt(i).mDurationTicks;
+    }
+    mOwner->bufferChunk(chunk);
+    mChunkSamples.clear();
+    mFragmentSamples.clear();
+}
+
 int64_t MPEG4Writer::Track::getDurationUs() const {
     return mTrackDurationUs;
 }
@@ -3006,6 +3402,21 @@ void MPEG4Writer::Track::writeStblBox(bool use32BitOffset) {
         writeVideoFourCCBox();
     }
     mOwner->endBox();  // stsd
+    if (mOwner->isFragmented()) {
+        // All the samples are described by the movie fragments
+        static const char *kSampleTables[] = { "stts", "stsc", "stsz", "stco" };
+        for (size_t i = 0; i < sizeof(kSampleTables) / sizeof(kSampleTables[0]); ++i) {
+            mOwner->beginBox(kSampleTables[i]);
+            mOwner->writeInt32(0);  // version=0, flags=0
+            if (!strcmp(kSampleTables[i], "stsz")) {
+                mOwner->writeInt32(0);  // sample size
+            }
+            mOwner->writeInt32(0);  // entry count
+            mOwner->endBox();
+        }
+        mOwner->endBox();  // stbl
+        return;
+    }
     writeSttsBox();
     writeCttsBox();
     if (!mIsAudio) {
@@ -3017,6 +3428,60 @@ void MPEG4Writer::Track::writeStblBox(bool use32BitOffset) {
     mOwner->endBox();  // stbl
 }
 
+void MPEG4Writer::Track::writeTrafBox(const Chunk &chunk, off64_t moofOffset) {
+    mOwner->beginBox("traf");
+
+    mOwner->beginBox("tfhd");
+    mOwner->writeInt32(0x01);          // version=0, flags=base data offset present
+    mOwner->writeInt32(mTrackId);
+    mOwner->writeInt64(moofOffset);    // base data offset
+    mOwner->endBox();  // tfhd
+
+    mOwner->beginBox("tfdt");
+    mOwner->writeInt32(0x01000000);    // version=1, flags=0
+    mOwner->writeInt64(chunk.mBaseDecodeTimeTicks);
+    mOwner->endBox();  // tfdt
+
+    // Sample duration, size and flags present, and for video the signed
+    // sample composition time offset of version 1.
+    mTrunOffset = mOwner->mOffset;
+    mOwner->beginBox("trun");
+    mOwner->writeInt32(mIsAudio ? 0x00000701 : 0x01000f01);
+    mOwner->writeInt32(chunk.mFragmentSamples.size());
+    mOwner->writeInt32(0);             // data offset, see fixupTrunDataOffset()
+    for (size_t i = 0; i < chunk.mFragmentSamples.size(); ++i) {
+        const FragmentSample &sample = chunk.mFragmentSamples.itemAt(i);
+        mOwner->writeInt32(sample.mDurationTicks);
+        mOwner->writeInt32(sample.mSize);
+        // A sync sample does not depend on others, other samples do
+        mOwner->writeInt32(sample.mIsSync ? 0x02000000 : 0x01010000);
+        if (!mIsAudio) {
+            mOwner->writeInt32(sample.mCompositionOffsetTicks);
+        }
+    }
+    mOwner->endBox();  // trun
+
+    mOwner->endBox();  // traf
+}
+
+void MPEG4Writer::Track::fixupTrunDataOffset(uint32_t dataOffset) {
+    // after the box header, the version and flags, and the sample count
+    mOwner->rewriteInt32(mTrunOffset + 16, dataOffset);
+}
+
+void MPEG4Writer::Track::fixupTrunSampleSize(size_t index, uint32_t size) {
+    // the sample size follows the duration in each sample entry
+    const size_t entrySize = mIsAudio ? 12 : 16;
+    mOwner->rewriteInt32(mTrunOffset + 20 + index * entrySize + 4, size);
+}
+
+void MPEG4Writer::Track::fixupDurations() {
+    int64_t trakDurationUs = getDurationUs();
+    mOwner->rewriteInt32(mTkhdDurationOffset,
+            (trakDurationUs * mOwner->getTimeScale() + 5E5) / 1E6);
+    mOwner->rewriteInt32(mMdhdDurationOffset, (trakDurationUs * mTimeScale + 5E5) / 1E6);
+}
+
 void MPEG4Writer::Track::writeVideoFourCCBox() {
     const char *mime;
     bool success = mMeta->findCString(kKeyMIMEType, &mime);
@@ -3226,10 +3691,12 @@ void MPEG4Writer::Track::writeTkhdBox(uint32_t now) {
     mOwner->writeInt32(now);           // modification time
     mOwner->writeInt32(mTrackId);      // track id starts with 1
     mOwner->writeInt32(0);             // reserved
-    int64_t trakDurationUs = getDurationUs();
+    // The duration of a fragmented track is only known in the end
+    int64_t trakDurationUs = mOwner->isFragmented() ? 0 : getDurationUs();
     int32_t mvhdTimeScale = mOwner->getTimeScale();
     int32_t tkhdDuration =
         (trakDurationUs * mvhdTimeScale + 5E5) / 1E6;
+    mTkhdDurationOffset = mOwner->mOffset;
     mOwner->writeInt32(tkhdDuration);  // in mvhd timescale
     mOwner->writeInt32(0);             // reserved
     mOwner->writeInt32(0);             // reserved
@@ -3287,13 +3754,14 @@ void MPEG4Writer::Track::writeHdlrBox() {
 }
 
 void MPEG4Writer::Track::writeMdhdBox(uint32_t now) {
-    int64_t trakDurationUs = getDurationUs();
+    int64_t trakDurationUs = mOwner->isFragmented() ? 0 : getDurationUs();
     mOwner->beginBox("mdhd");
     mOwner->writeInt32(0);             // version=0, flags=0
     mOwner->writeInt32(now);           // creation time
     mOwner->writeInt32(now);           // modification time
     mOwner->writeInt32(mTimeScale);    // media timescale
     int32_t mdhdDuration = (trakDurationUs * mTimeScale + 5E5) / 1E6;
+    mMdhdDurationOffset = mOwner->mOffset;
     mOwner->writeInt32(mdhdDuration);  // use media timescale
     // Language follows the three letter standard ISO-639-2/T
     // 'e', 'n', 'g' for "English", for instance.
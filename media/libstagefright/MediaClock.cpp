@@ -18,6 +18,8 @@
 #define LOG_TAG "MediaClock"
 #include <utils/Log.h>
 
+#include <sched.h>
+
 #include <media/stagefright/MediaClock.h>
 
 #include <media/stagefright/foundation/ADebug.h>
@@ -30,7 +32,8 @@ namespace android {
 static const int64_t kAnchorFluctuationAllowedUs = 10000ll;
 
 MediaClock::MediaClock()
-    : mAnchorTimeMediaUs(-1),
+    : mSequence(0),
+      mAnchorTimeMediaUs(-1),
       mAnchorTimeRealUs(-1),
       mMaxTimeMediaUs(INT64_MAX),
       mStartingTimeMediaUs(-1),
@@ -40,15 +43,48 @@ MediaClock::MediaClock()
 MediaClock::~MediaClock() {
 }
 
+void MediaClock::readSnapshot(Snapshot *snapshot) const {
+    for (;;) {
+        uint32_t sequence = mSequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+            // a writer is changing the state, it only holds mLock for a few stores
+            sched_yield();
+            continue;
+        }
+        snapshot->mAnchorTimeMediaUs = mAnchorTimeMediaUs.load(std::memory_order_relaxed);
+        snapshot->mAnchorTimeRealUs = mAnchorTimeRealUs.load(std::memory_order_relaxed);
+        snapshot->mMaxTimeMediaUs = mMaxTimeMediaUs.load(std::memory_order_relaxed);
+        snapshot->mStartingTimeMediaUs = mStartingTimeMediaUs.load(std::memory_order_relaxed);
+        snapshot->mPlaybackRate = mPlaybackRate.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (mSequence.load(std::memory_order_relaxed) == sequence) {
+            return;
+        }
+    }
+}
+
+void MediaClock::beginWrite_l() {
+    mSequence.store(mSequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void MediaClock::endWrite_l() {
+    mSequence.store(mSequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
 void MediaClock::setStartingTimeMedia(int64_t startingTimeMediaUs) {
     Mutex::Autolock autoLock(mLock);
-    mStartingTimeMediaUs = startingTimeMediaUs;
+    beginWrite_l();
+    mStartingTimeMediaUs.store(startingTimeMediaUs, std::memory_order_relaxed);
+    endWrite_l();
 }
 
 void MediaClock::clearAnchor() {
     Mutex::Autolock autoLock(mLock);
-    mAnchorTimeMediaUs = -1;
-    mAnchorTimeRealUs = -1;
+    beginWrite_l();
+    mAnchorTimeMediaUs.store(-1, std::memory_order_relaxed);
+    mAnchorTimeRealUs.store(-1, std::memory_order_relaxed);
+    endWrite_l();
 }
 
 void MediaClock::updateAnchor(
@@ -60,56 +96,66 @@ void MediaClock::updateAnchor(
         return;
     }
 
+    // Only writers change the state, and they hold mLock.
     Mutex::Autolock autoLock(mLock);
+    Snapshot old;
+    readSnapshot(&old);
     int64_t nowUs = ALooper::GetNowUs();
     int64_t nowMediaUs =
-        anchorTimeMediaUs + (nowUs - anchorTimeRealUs) * (double)mPlaybackRate;
+        anchorTimeMediaUs + (nowUs - anchorTimeRealUs) * (double)old.mPlaybackRate;
     if (nowMediaUs < 0) {
         ALOGW("reject anchor time since it leads to negative media time.");
         return;
     }
 
+    beginWrite_l();
     if (maxTimeMediaUs != -1) {
-        mMaxTimeMediaUs = maxTimeMediaUs;
+        mMaxTimeMediaUs.store(maxTimeMediaUs, std::memory_order_relaxed);
     }
-    if (mAnchorTimeRealUs != -1) {
-        int64_t oldNowMediaUs =
-            mAnchorTimeMediaUs + (nowUs - mAnchorTimeRealUs) * (double)mPlaybackRate;
-        if (nowMediaUs < oldNowMediaUs
-                && nowMediaUs > oldNowMediaUs - kAnchorFluctuationAllowedUs) {
-            return;
-        }
+    bool keepAnchor = false;
+    if (old.mAnchorTimeRealUs != -1) {
+        int64_t oldNowMediaUs = old.mAnchorTimeMediaUs
+                + (nowUs - old.mAnchorTimeRealUs) * (double)old.mPlaybackRate;
+        keepAnchor = nowMediaUs < oldNowMediaUs
+                && nowMediaUs > oldNowMediaUs - kAnchorFluctuationAllowedUs;
+    }
+    if (!keepAnchor) {
+        mAnchorTimeRealUs.store(nowUs, std::memory_order_relaxed);
+        mAnchorTimeMediaUs.store(nowMediaUs, std::memory_order_relaxed);
     }
-    mAnchorTimeRealUs = nowUs;
-    mAnchorTimeMediaUs = nowMediaUs;
+    endWrite_l();
 }
 
 void MediaClock::updateMaxTimeMedia(int64_t maxTimeMediaUs) {
     Mutex::Autolock autoLock(mLock);
-    mMaxTimeMediaUs = maxTimeMediaUs;
+    beginWrite_l();
+    mMaxTimeMediaUs.store(maxTimeMediaUs, std::memory_order_relaxed);
+    endWrite_l();
 }
 
 void MediaClock::setPlaybackRate(float rate) {
     CHECK_GE(rate, 0.0);
     Mutex::Autolock autoLock(mLock);
-    if (mAnchorTimeRealUs == -1) {
-        mPlaybackRate = rate;
-        return;
-    }
-
-    int64_t nowUs = ALooper::GetNowUs();
-    mAnchorTimeMediaUs += (nowUs - mAnchorTimeRealUs) * (double)mPlaybackRate;
-    if (mAnchorTimeMediaUs < 0) {
-        ALOGW("setRate: anchor time should not be negative, set to 0.");
-        mAnchorTimeMediaUs = 0;
+    Snapshot old;
+    readSnapshot(&old);
+    beginWrite_l();
+    mPlaybackRate.store(rate, std::memory_order_relaxed);
+    if (old.mAnchorTimeRealUs != -1) {
+        int64_t nowUs = ALooper::GetNowUs();
+        int64_t anchorTimeMediaUs = old.mAnchorTimeMediaUs
+                + (nowUs - old.mAnchorTimeRealUs) * (double)old.mPlaybackRate;
+        if (anchorTimeMediaUs < 0) {
+            ALOGW("setRate: anchor time should not be negative, set to 0.");
+            anchorTimeMediaUs = 0;
+        }
+        mAnchorTimeMediaUs.store(anchorTimeMediaUs, std::memory_order_relaxed);
+        mAnchorTimeRealUs.store(nowUs, std::memory_order_relaxed);
     }
-    mAnchorTimeRealUs = nowUs;
-    mPlaybackRate = rate;
+    endWrite_l();
 }
 
 float MediaClock::getPlaybackRate() const {
-    Mutex::Autolock autoLock(mLock);
-    return mPlaybackRate;
+    return mPlaybackRate.load(std::memory_order_relaxed);
 }
 
 status_t MediaClock::getMediaTime(
@@ -118,23 +164,26 @@ status_t MediaClock::getMediaTime(
         return BAD_VALUE;
     }
 
-    Mutex::Autolock autoLock(mLock);
-    return getMediaTime_l(realUs, outMediaUs, allowPastMaxTime);
+    Snapshot snapshot;
+    readSnapshot(&snapshot);
+    return getMediaTime(snapshot, realUs, outMediaUs, allowPastMaxTime);
 }
 
-status_t MediaClock::getMediaTime_l(
-        int64_t realUs, int64_t *outMediaUs, bool allowPastMaxTime) const {
-    if (mAnchorTimeRealUs == -1) {
+// static
+status_t MediaClock::getMediaTime(
+        const Snapshot &snapshot,
+        int64_t realUs, int64_t *outMediaUs, bool allowPastMaxTime) {
+    if (snapshot.mAnchorTimeRealUs == -1) {
         return NO_INIT;
     }
 
-    int64_t mediaUs = mAnchorTimeMediaUs
-            + (realUs - mAnchorTimeRealUs) * (double)mPlaybackRate;
-    if (mediaUs > mMaxTimeMediaUs && !allowPastMaxTime) {
-        mediaUs = mMaxTimeMediaUs;
+    int64_t mediaUs = snapshot.mAnchorTimeMediaUs
+            + (realUs - snapshot.mAnchorTimeRealUs) * (double)snapshot.mPlaybackRate;
+    if (mediaUs > snapshot.mMaxTimeMediaUs && !allowPastMaxTime) {
+        mediaUs = snapshot.mMaxTimeMediaUs;
     }
-    if (mediaUs < mStartingTimeMediaUs) {
-        mediaUs = mStartingTimeMediaUs;
+    if (mediaUs < snapshot.mStartingTimeMediaUs) {
+        mediaUs = snapshot.mStartingTimeMediaUs;
     }
     if (mediaUs < 0) {
         mediaUs = 0;
@@ -149,19 +198,20 @@ status_t MediaClock::getRealTimeFor(
         return BAD_VALUE;
     }
 
-    Mutex::Autolock autoLock(mLock);
-    if (mPlaybackRate == 0.0) {
+    Snapshot snapshot;
+    readSnapshot(&snapshot);
+    if (snapshot.mPlaybackRate == 0.0) {
         return NO_INIT;
     }
 
     int64_t nowUs = ALooper::GetNowUs();
     int64_t nowMediaUs;
     status_t status =
-            getMediaTime_l(nowUs, &nowMediaUs, true /* allowPastMaxTime */);
+            getMediaTime(snapshot, nowUs, &nowMediaUs, true /* allowPastMaxTime */);
     if (status != OK) {
         return status;
     }
-    *outRealUs = (targetMediaUs - nowMediaUs) / (double)mPlaybackRate + nowUs;
+    *outRealUs = (targetMediaUs - nowMediaUs) / (double)snapshot.mPlaybackRate + nowUs;
     return OK;
 }
 
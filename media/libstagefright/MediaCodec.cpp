@@ -63,6 +63,8 @@ static bool isResourceError(status_t err) {
 
 static const int kMaxRetry = 2;
 static const int kMaxReclaimWaitTimeInUs = 500000;  // 0.5s
+static const int64_t kCodecLoadWindowUs = 1000000ll;  // 1s
+static const int32_t kDefaultFrameRate = 30;
 
 struct ResourceManagerClient : public BnResourceManagerClient {
     ResourceManagerClient(MediaCodec* codec) : mMediaCodec(codec) {}
@@ -273,10 +275,15 @@ MediaCodec::MediaCodec(const sp<ALooper> &looper, pid_t pid)
       mVideoWidth(0),
       mVideoHeight(0),
       mRotationDegrees(0),
+      mCodecLoad(0),
+      mLoadWindowStartUs(-1ll),
+      mLoadWindowFrames(0),
       mDequeueInputTimeoutGeneration(0),
       mDequeueInputReplyID(0),
       mDequeueOutputTimeoutGeneration(0),
       mDequeueOutputReplyID(0),
+      mDequeueOutputMaxCount(1),
+      mNumLatencyTraces(0),
       mHaveInputSurface(false),
       mHavePendingInputBuffers(false) {
 }
@@ -455,6 +462,15 @@ status_t MediaCodec::configure(
             ALOGE("buffer size is too big, width=%d, height=%d", mVideoWidth, mVideoHeight);
             return BAD_VALUE;
         }
+
+        float frameRate;
+        int32_t frameRateInt;
+        if (format->findInt32("frame-rate", &frameRateInt) && frameRateInt > 0) {
+            frameRate = frameRateInt;
+        } else if (!format->findFloat("frame-rate", &frameRate) || frameRate <= 0) {
+            frameRate = kDefaultFrameRate;
+        }
+        mCodecLoad = (uint64_t)(getMacroblocksPerFrame() * frameRate);
     }
 
     msg->setMessage("format", format);
@@ -478,6 +494,18 @@ status_t MediaCodec::configure(
     // Don't know the buffer size at this point, but it's fine to use 1 because
     // the reclaimResource call doesn't consider the requester's buffer size for now.
     resources.push_back(MediaResource(MediaResource::kGraphicMemory, 1));
+    if (mIsVideo) {
+        resources.push_back(MediaResource(MediaResource::kCodecLoad, mCodecLoad));
+
+        // Admit the load before allocating the codec: if it does not fit in the capacity
+        // of the codecs, lower priority clients are reclaimed now instead of after the
+        // allocation fails. Only the load is passed, so nothing is reclaimed if it fits.
+        if (mCodecLoad > 0) {
+            Vector<MediaResource> loadResources;
+            loadResources.push_back(MediaResource(MediaResource::kCodecLoad, mCodecLoad));
+            mResourceManagerService->reclaimResource(loadResources);
+        }
+    }
     for (int i = 0; i <= kMaxRetry; ++i) {
         if (i > 0) {
             // Don't try to reclaim resource for the first time.
@@ -556,6 +584,41 @@ uint64_t MediaCodec::getGraphicBufferSize() {
     return size;
 }
 
+uint64_t MediaCodec::getMacroblocksPerFrame() const {
+    if (!mIsVideo || mVideoWidth <= 0 || mVideoHeight <= 0) {
+        return 0;
+    }
+    return (uint64_t)((mVideoWidth + 15) / 16) * ((mVideoHeight + 15) / 16);
+}
+
+void MediaCodec::updateCodecLoad() {
+    int64_t nowUs = ALooper::GetNowUs();
+    if (mLoadWindowStartUs < 0) {
+        // skip the first window, the input is queued in a burst after start and flush.
+        mLoadWindowStartUs = nowUs + kCodecLoadWindowUs;
+        mLoadWindowFrames = 0;
+        return;
+    }
+    if (nowUs < mLoadWindowStartUs) {
+        return;
+    }
+    ++mLoadWindowFrames;
+    int64_t elapsedUs = nowUs - mLoadWindowStartUs;
+    if (elapsedUs < kCodecLoadWindowUs) {
+        return;
+    }
+
+    uint64_t load = getMacroblocksPerFrame() * mLoadWindowFrames * 1000000ll / elapsedUs;
+    if (load > mCodecLoad + mCodecLoad / 4) {
+        ALOGV("[%s] codec load raised from %llu to %llu macroblocks/s", mComponentName.c_str(),
+                (unsigned long long)mCodecLoad, (unsigned long long)load);
+        mCodecLoad = load;
+        addResource(MediaResource::kCodecLoad, MediaResource::kUnspecifiedSubType, mCodecLoad);
+    }
+    mLoadWindowStartUs = nowUs;
+    mLoadWindowFrames = 0;
+}
+
 void MediaCodec::addResource(
         MediaResource::Type type, MediaResource::SubType subtype, uint64_t value) {
     Vector<MediaResource> resources;
@@ -577,6 +640,9 @@ status_t MediaCodec::start() {
     // Don't know the buffer size at this point, but it's fine to use 1 because
     // the reclaimResource call doesn't consider the requester's buffer size for now.
     resources.push_back(MediaResource(MediaResource::kGraphicMemory, 1));
+    if (mIsVideo) {
+        resources.push_back(MediaResource(MediaResource::kCodecLoad, mCodecLoad));
+    }
     for (int i = 0; i <= kMaxRetry; ++i) {
         if (i > 0) {
             // Don't try to reclaim resource for the first time.
@@ -811,6 +877,76 @@ status_t MediaCodec::releaseOutputBuffer(size_t index) {
     return PostAndAwaitResponse(msg, &response);
 }
 
+status_t MediaCodec::queueInputBuffers(
+        const BufferEntry *entries,
+        size_t count,
+        size_t *numQueued,
+        AString *errorDetailMsg) {
+    *numQueued = 0;
+    if (errorDetailMsg != NULL) {
+        errorDetailMsg->clear();
+    }
+
+    sp<AMessage> msg = new AMessage(kWhatQueueInputBuffers, this);
+    msg->setPointer("entries", (void *)entries);
+    msg->setSize("count", count);
+    msg->setPointer("errorDetailMsg", errorDetailMsg);
+
+    sp<AMessage> response;
+    status_t err = PostAndAwaitResponse(msg, &response);
+    if (response != NULL) {
+        response->findSize("numQueued", numQueued);
+    }
+    return err;
+}
+
+status_t MediaCodec::dequeueOutputBuffers(
+        BufferEntry *entries,
+        size_t maxCount,
+        size_t *count,
+        int64_t timeoutUs) {
+    *count = 0;
+    if (maxCount == 0) {
+        return -EINVAL;
+    }
+
+    sp<AMessage> msg = new AMessage(kWhatDequeueOutputBuffer, this);
+    msg->setInt64("timeoutUs", timeoutUs);
+    msg->setSize("maxCount", maxCount);
+
+    sp<AMessage> response;
+    status_t err;
+    if ((err = PostAndAwaitResponse(msg, &response)) != OK) {
+        return err;
+    }
+
+    sp<ABuffer> buffer;
+    if (response->findBuffer("entries", &buffer)) {
+        CHECK_LE(buffer->size(), maxCount * sizeof(BufferEntry));
+        *count = buffer->size() / sizeof(BufferEntry);
+        memcpy(entries, buffer->data(), buffer->size());
+    } else {
+        CHECK(response->findSize("index", &entries[0].mIndex));
+        CHECK(response->findSize("offset", &entries[0].mOffset));
+        CHECK(response->findSize("size", &entries[0].mSize));
+        CHECK(response->findInt64("timeUs", &entries[0].mPresentationTimeUs));
+        CHECK(response->findInt32("flags", (int32_t *)&entries[0].mFlags));
+        *count = 1;
+    }
+
+    return OK;
+}
+
+status_t MediaCodec::releaseOutputBuffers(const size_t *indices, size_t count, bool render) {
+    sp<AMessage> msg = new AMessage(kWhatReleaseOutputBuffers, this);
+    msg->setPointer("indices", (void *)indices);
+    msg->setSize("count", count);
+    msg->setInt32("render", render);
+
+    sp<AMessage> response;
+    return PostAndAwaitResponse(msg, &response);
+}
+
 status_t MediaCodec::signalEndOfInputStream() {
     sp<AMessage> msg = new AMessage(kWhatSignalEndOfInputStream, this);
 
@@ -860,6 +996,20 @@ status_t MediaCodec::getName(AString *name) const {
     return OK;
 }
 
+status_t MediaCodec::getLatencyStats(sp<AMessage> *stats) const {
+    sp<AMessage> msg = new AMessage(kWhatGetLatencyStats, this);
+
+    sp<AMessage> response;
+    status_t err;
+    if ((err = PostAndAwaitResponse(msg, &response)) != OK) {
+        return err;
+    }
+
+    CHECK(response->findMessage("stats", stats));
+
+    return OK;
+}
+
 status_t MediaCodec::getWidevineLegacyBuffers(Vector<sp<ABuffer> > *buffers) const {
     sp<AMessage> msg = new AMessage(kWhatGetBuffers, this);
     msg->setInt32("portIndex", kPortIndexInput);
@@ -1046,37 +1196,145 @@ bool MediaCodec::handleDequeueOutputBuffer(const sp<AReplyToken> &replyID, bool
             return false;
         }
 
-        const sp<ABuffer> &buffer =
-            mPortBuffers[kPortIndexOutput].itemAt(index).mData;
+        BufferEntry entry;
+        getOutputBufferEntry(index, &entry);
+
+        response->setSize("index", entry.mIndex);
+        response->setSize("offset", entry.mOffset);
+        response->setSize("size", entry.mSize);
+        response->setInt64("timeUs", entry.mPresentationTimeUs);
+        response->setInt32("flags", entry.mFlags);
+
+        if (mDequeueOutputMaxCount > 1) {
+            sp<ABuffer> entries = new ABuffer(mDequeueOutputMaxCount * sizeof(BufferEntry));
+            BufferEntry *out = (BufferEntry *)entries->data();
+            out[0] = entry;
+            size_t count = 1;
+
+            // stop where successive dequeueOutputBuffer calls would have returned
+            // something else than a buffer, or the client has to handle end of stream
+            while (count < mDequeueOutputMaxCount
+                    && !(out[count - 1].mFlags & BUFFER_FLAG_EOS)
+                    && !(mFlags & (kFlagStickyError
+                            | kFlagOutputBuffersChanged
+                            | kFlagOutputFormatChanged))
+                    && (index = dequeuePortBuffer(kPortIndexOutput)) >= 0) {
+                getOutputBufferEntry(index, &out[count]);
+                ++count;
+            }
 
-        response->setSize("index", index);
-        response->setSize("offset", buffer->offset());
-        response->setSize("size", buffer->size());
+            entries->setRange(0, count * sizeof(BufferEntry));
+            response->setBuffer("entries", entries);
+        }
 
-        int64_t timeUs;
-        CHECK(buffer->meta()->findInt64("timeUs", &timeUs));
+        response->postReply(replyID);
+    }
 
-        response->setInt64("timeUs", timeUs);
+    return true;
+}
 
-        int32_t omxFlags;
-        CHECK(buffer->meta()->findInt32("omxFlags", &omxFlags));
+void MediaCodec::getOutputBufferEntry(size_t index, BufferEntry *entry) {
+    const sp<ABuffer> &buffer =
+        mPortBuffers[kPortIndexOutput].itemAt(index).mData;
 
-        uint32_t flags = 0;
-        if (omxFlags & OMX_BUFFERFLAG_SYNCFRAME) {
-            flags |= BUFFER_FLAG_SYNCFRAME;
-        }
-        if (omxFlags & OMX_BUFFERFLAG_CODECCONFIG) {
-            flags |= BUFFER_FLAG_CODECCONFIG;
-        }
-        if (omxFlags & OMX_BUFFERFLAG_EOS) {
-            flags |= BUFFER_FLAG_EOS;
+    entry->mIndex = index;
+    entry->mOffset = buffer->offset();
+    entry->mSize = buffer->size();
+
+    CHECK(buffer->meta()->findInt64("timeUs", &entry->mPresentationTimeUs));
+
+    int32_t omxFlags;
+    CHECK(buffer->meta()->findInt32("omxFlags", &omxFlags));
+
+    uint32_t flags = 0;
+    if (omxFlags & OMX_BUFFERFLAG_SYNCFRAME) {
+        flags |= BUFFER_FLAG_SYNCFRAME;
+    }
+    if (omxFlags & OMX_BUFFERFLAG_CODECCONFIG) {
+        flags |= BUFFER_FLAG_CODECCONFIG;
+    }
+    if (omxFlags & OMX_BUFFERFLAG_EOS) {
+        flags |= BUFFER_FLAG_EOS;
+    }
+    entry->mFlags = flags;
+}
+
+MediaCodec::LatencyTrace *MediaCodec::findLatencyTrace(int64_t timeUs, bool add) {
+    size_t count = mNumLatencyTraces < kMaxLatencyTraces ? mNumLatencyTraces : kMaxLatencyTraces;
+    for (size_t i = 1; i <= count; ++i) {
+        LatencyTrace *trace = &mLatencyTraces[(mNumLatencyTraces - i) % kMaxLatencyTraces];
+        if (trace->mTimeUs == timeUs) {
+            return trace;
         }
+    }
+    if (!add) {
+        return NULL;
+    }
 
-        response->setInt32("flags", flags);
-        response->postReply(replyID);
+    LatencyTrace *trace = &mLatencyTraces[mNumLatencyTraces++ % kMaxLatencyTraces];
+    trace->mTimeUs = timeUs;
+    trace->mQueuedUs = -1ll;
+    trace->mEmptiedUs = -1ll;
+    trace->mFilledUs = -1ll;
+    trace->mDequeuedUs = -1ll;
+    trace->mRenderedUs = -1ll;
+    return trace;
+}
+
+void MediaCodec::onFramesRendered(const sp<AMessage> &msg) {
+    int64_t mediaTimeUs;
+    int64_t systemNano;
+    for (size_t index = 0;
+            msg->findInt64(AStringPrintf("%zu-media-time-us", index).c_str(), &mediaTimeUs)
+            && msg->findInt64(AStringPrintf("%zu-system-nano", index).c_str(), &systemNano);
+            ++index) {
+        LatencyTrace *trace = findLatencyTrace(mediaTimeUs, false /* add */);
+        if (trace != NULL) {
+            trace->mRenderedUs = systemNano / 1000;
+        }
+    }
+}
+
+sp<AMessage> MediaCodec::computeLatencyStats() const {
+    static const char *kStages[] = {
+        "queue-to-component", "component", "component-to-client", "client-to-render",
+    };
+    const size_t kNumStages = ARRAY_SIZE(kStages);
+    int64_t totalUs[kNumStages] = { 0 };
+    int64_t maxUs[kNumStages] = { 0 };
+    int32_t samples[kNumStages] = { 0 };
+
+    size_t count = mNumLatencyTraces < kMaxLatencyTraces ? mNumLatencyTraces : kMaxLatencyTraces;
+    for (size_t i = 0; i < count; ++i) {
+        const LatencyTrace &trace = mLatencyTraces[i];
+        const int64_t times[kNumStages + 1] = {
+            trace.mQueuedUs, trace.mEmptiedUs, trace.mFilledUs, trace.mDequeuedUs,
+            trace.mRenderedUs,
+        };
+        for (size_t stage = 0; stage < kNumStages; ++stage) {
+            if (times[stage] < 0ll || times[stage + 1] < times[stage]) {
+                continue;
+            }
+            int64_t latencyUs = times[stage + 1] - times[stage];
+            totalUs[stage] += latencyUs;
+            if (latencyUs > maxUs[stage]) {
+                maxUs[stage] = latencyUs;
+            }
+            ++samples[stage];
+        }
     }
 
-    return true;
+    sp<AMessage> stats = new AMessage;
+    for (size_t stage = 0; stage < kNumStages; ++stage) {
+        if (samples[stage] == 0) {
+            continue;
+        }
+        stats->setInt64(AStringPrintf("%s-avg-us", kStages[stage]).c_str(),
+                totalUs[stage] / samples[stage]);
+        stats->setInt64(AStringPrintf("%s-max-us", kStages[stage]).c_str(), maxUs[stage]);
+        stats->setInt32(AStringPrintf("%s-samples", kStages[stage]).c_str(), samples[stage]);
+    }
+    return stats;
 }
 
 void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
@@ -1394,6 +1652,13 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
                                         MediaResource::kGraphicMemory,
                                         MediaResource::kUnspecifiedSubType,
                                         getGraphicBufferSize());
+                                // also accounted for the codecs that don't return their
+                                // output, e.g. tunneled ones.
+                                addResource(
+                                        MediaResource::kCodecLoad,
+                                        MediaResource::kUnspecifiedSubType,
+                                        mCodecLoad);
+                                mLoadWindowStartUs = -1ll;
                             }
                             setState(STARTED);
                             (new AMessage)->postReply(mReplyID);
@@ -1463,6 +1728,8 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
 
                 case CodecBase::kWhatOutputFramesRendered:
                 {
+                    onFramesRendered(msg);
+
                     // ignore these in all states except running, and check that we have a
                     // notification set
                     if (mState == STARTED && mOnFrameRenderedNotification != NULL) {
@@ -1547,6 +1814,19 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
 
                     buffer->meta()->setInt32("omxFlags", omxFlags);
 
+                    int64_t timeUs;
+                    if (!(omxFlags & OMX_BUFFERFLAG_CODECCONFIG)
+                            && buffer->meta()->findInt64("timeUs", &timeUs)) {
+                        LatencyTrace *trace = findLatencyTrace(timeUs, true /* add */);
+                        int64_t emptiedUs;
+                        if (msg->findInt64("empty-time-us", &emptiedUs)) {
+                            trace->mEmptiedUs = emptiedUs;
+                        }
+                        if (!msg->findInt64("fill-done-time-us", &trace->mFilledUs)) {
+                            trace->mFilledUs = ALooper::GetNowUs();
+                        }
+                    }
+
                     if (mFlags & kFlagGatherCodecSpecificData) {
                         // This is the very first output buffer after a
                         // format change was signalled, it'll either contain
@@ -2044,6 +2324,54 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
             break;
         }
 
+        case kWhatQueueInputBuffers:
+        {
+            sp<AReplyToken> replyID;
+            CHECK(msg->senderAwaitsResponse(&replyID));
+
+            if (!isExecuting()) {
+                PostReplyWithError(replyID, INVALID_OPERATION);
+                break;
+            } else if (mFlags & kFlagStickyError) {
+                PostReplyWithError(replyID, getStickyError());
+                break;
+            }
+
+            const BufferEntry *entries;
+            size_t count;
+            AString *errorDetailMsg;
+            CHECK(msg->findPointer("entries", (void **)&entries));
+            CHECK(msg->findSize("count", &count));
+            CHECK(msg->findPointer("errorDetailMsg", (void **)&errorDetailMsg));
+
+            // onQueueInputBuffer takes the arguments of each buffer in turn in this message
+            sp<AMessage> entryMsg = new AMessage;
+            entryMsg->setPointer("errorDetailMsg", errorDetailMsg);
+
+            status_t err = OK;
+            size_t numQueued = 0;
+            while (numQueued < count) {
+                const BufferEntry &entry = entries[numQueued];
+                entryMsg->setSize("index", entry.mIndex);
+                entryMsg->setSize("offset", entry.mOffset);
+                entryMsg->setSize("size", entry.mSize);
+                entryMsg->setInt64("timeUs", entry.mPresentationTimeUs);
+                entryMsg->setInt32("flags", entry.mFlags);
+
+                err = onQueueInputBuffer(entryMsg);
+                if (err != OK) {
+                    break;
+                }
+                ++numQueued;
+            }
+
+            sp<AMessage> response = new AMessage;
+            response->setInt32("err", mReleasedByResourceManager ? DEAD_OBJECT : err);
+            response->setSize("numQueued", numQueued);
+            response->postReply(replyID);
+            break;
+        }
+
         case kWhatDequeueOutputBuffer:
         {
             sp<AReplyToken> replyID;
@@ -2055,6 +2383,13 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
                 break;
             }
 
+            if (!(mFlags & kFlagDequeueOutputPending)) {
+                // set by dequeueOutputBuffers
+                if (!msg->findSize("maxCount", &mDequeueOutputMaxCount)) {
+                    mDequeueOutputMaxCount = 1;
+                }
+            }
+
             if (handleDequeueOutputBuffer(replyID, true /* new request */)) {
                 break;
             }
@@ -2118,6 +2453,40 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
             break;
         }
 
+        case kWhatReleaseOutputBuffers:
+        {
+            sp<AReplyToken> replyID;
+            CHECK(msg->senderAwaitsResponse(&replyID));
+
+            if (!isExecuting()) {
+                PostReplyWithError(replyID, INVALID_OPERATION);
+                break;
+            } else if (mFlags & kFlagStickyError) {
+                PostReplyWithError(replyID, getStickyError());
+                break;
+            }
+
+            const size_t *indices;
+            size_t count;
+            int32_t render;
+            CHECK(msg->findPointer("indices", (void **)&indices));
+            CHECK(msg->findSize("count", &count));
+            CHECK(msg->findInt32("render", &render));
+
+            // onReleaseOutputBuffer takes the index of each buffer in turn in this message
+            sp<AMessage> entryMsg = new AMessage;
+            entryMsg->setInt32("render", render);
+
+            status_t err = OK;
+            for (size_t i = 0; i < count && err == OK; ++i) {
+                entryMsg->setSize("index", indices[i]);
+                err = onReleaseOutputBuffer(entryMsg);
+            }
+
+            PostReplyWithError(replyID, err);
+            break;
+        }
+
         case kWhatSignalEndOfInputStream:
         {
             sp<AReplyToken> replyID;
@@ -2198,6 +2567,8 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
 
             mCodec->signalFlush();
             returnBuffersToCodec();
+            mNumLatencyTraces = 0;
+            mLoadWindowStartUs = -1ll;
             break;
         }
 
@@ -2242,6 +2613,17 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
             break;
         }
 
+        case kWhatGetLatencyStats:
+        {
+            sp<AReplyToken> replyID;
+            CHECK(msg->senderAwaitsResponse(&replyID));
+
+            sp<AMessage> response = new AMessage;
+            response->setMessage("stats", computeLatencyStats());
+            response->postReply(replyID);
+            break;
+        }
+
         case kWhatGetName:
         {
             sp<AReplyToken> replyID;
@@ -2564,6 +2946,13 @@ status_t MediaCodec::onQueueInputBuffer(const sp<AMessage> &msg) {
 
     info->mNotify = NULL;
 
+    if (!(flags & BUFFER_FLAG_CODECCONFIG)) {
+        findLatencyTrace(timeUs, true /* add */)->mQueuedUs = ALooper::GetNowUs();
+        if (mIsVideo) {
+            updateCodecLoad();
+        }
+    }
+
     return OK;
 }
 
@@ -2664,6 +3053,14 @@ ssize_t MediaCodec::dequeuePortBuffer(int32_t portIndex) {
 
     BufferInfo *info = &mPortBuffers[portIndex].editItemAt(index);
     CHECK(!info->mOwnedByClient);
+
+    int64_t timeUs;
+    if (portIndex == kPortIndexOutput && info->mData->meta()->findInt64("timeUs", &timeUs)) {
+        LatencyTrace *trace = findLatencyTrace(timeUs, false /* add */);
+        if (trace != NULL) {
+            trace->mDequeuedUs = ALooper::GetNowUs();
+        }
+    }
     {
         Mutex::Autolock al(mBufferLock);
         info->mOwnedByClient = true;
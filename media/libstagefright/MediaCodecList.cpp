@@ -223,6 +223,21 @@ void MediaCodecList::parseTopLevelXMLFile(const char *codecs_xml, bool ignore_er
                         String8(kPolicySupportsSecureWithNonSecureCodec),
                         String8(value.c_str())));
     }
+    if (mGlobalSettings->findString(kPolicyMaxCodecLoad, &value)) {
+        policies.push_back(
+                MediaResourcePolicy(
+                        String8(kPolicyMaxCodecLoad),
+                        String8(value.c_str())));
+    } else {
+        // without an explicit limit, the hardware can run at most what was measured on it.
+        uint64_t measuredLoad = getMeasuredCodecLoad();
+        if (measuredLoad > 0) {
+            policies.push_back(
+                    MediaResourcePolicy(
+                            String8(kPolicyMaxCodecLoad),
+                            String8::format("%llu", (unsigned long long)measuredLoad)));
+        }
+    }
     if (policies.size() > 0) {
         sp<IServiceManager> sm = defaultServiceManager();
         sp<IBinder> binder = sm->getService(String16("media.resource_manager"));
@@ -383,6 +398,43 @@ void MediaCodecList::EndElementHandlerWrapper(void *me, const char *name) {
     static_cast<MediaCodecList *>(me)->endElementHandler(name);
 }
 
+uint64_t MediaCodecList::getMeasuredCodecLoad() const {
+    uint64_t maxLoad = 0;
+    for (size_t i = 0; i < mCodecInfos.size(); ++i) {
+        const MediaCodecInfo &info = *mCodecInfos.itemAt(i).get();
+        if (isSoftwareCodec(info.mName)) {
+            continue;
+        }
+        for (size_t j = 0; j < info.mCaps.size(); ++j) {
+            const sp<AMessage> &details = info.mCaps.valueAt(j)->getDetails();
+            for (size_t k = 0; k < details->countEntries(); ++k) {
+                AMessage::Type type;
+                const char *name = details->getEntryNameAt(k, &type);
+                int width, height;
+                char suffix[8];
+                AString range;
+                if (type != AMessage::kTypeString
+                        || sscanf(name, "measured-frame-rate-%dx%d-%7s",
+                                &width, &height, suffix) != 3
+                        || strcmp(suffix, "range") || width <= 0 || height <= 0
+                        || !details->findString(name, &range)) {
+                    continue;
+                }
+                long long minRate, maxRate;
+                if (sscanf(range.c_str(), "%lld-%lld", &minRate, &maxRate) != 2
+                        || maxRate <= 0) {
+                    continue;
+                }
+                uint64_t load = (uint64_t)((width + 15) / 16) * ((height + 15) / 16) * maxRate;
+                if (load > maxLoad) {
+                    maxLoad = load;
+                }
+            }
+        }
+    }
+    return maxLoad;
+}
+
 status_t MediaCodecList::includeXMLFile(const char **attrs) {
     const char *href = NULL;
     size_t i = 0;
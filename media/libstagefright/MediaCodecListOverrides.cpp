@@ -27,9 +27,12 @@
 #include <media/MediaCodecInfo.h>
 #include <media/MediaResourcePolicy.h>
 #include <media/openmax/OMX_IVCommon.h>
+#include <media/stagefright/foundation/ABuffer.h>
+#include <media/stagefright/foundation/ALooper.h>
 #include <media/stagefright/foundation/AMessage.h>
 #include <media/stagefright/MediaCodec.h>
 #include <media/stagefright/MediaCodecList.h>
+#include <media/stagefright/MediaErrors.h>
 
 namespace android {
 
@@ -49,7 +52,9 @@ AString getProfilingVersionString() {
 static const int kMaxInstances = 32;
 
 // TODO: move MediaCodecInfo to C++. Until then, some temp methods to parse out info.
-static bool getMeasureSize(sp<MediaCodecInfo::Capabilities> caps, int32_t *width, int32_t *height) {
+static bool getSizeRange(
+        sp<MediaCodecInfo::Capabilities> caps,
+        int32_t *minWidth, int32_t *minHeight, int32_t *maxWidth, int32_t *maxHeight) {
     AString sizeRange;
     if (!caps->getDetails()->findString("size-range", &sizeRange)) {
         return false;
@@ -61,15 +66,25 @@ static bool getMeasureSize(sp<MediaCodecInfo::Capabilities> caps, int32_t *width
     }
     AString sWidth;
     AString sHeight;
-    if (!splitString(minSize, "x", &sWidth, &sHeight)) {
-        if (!splitString(minSize, "*", &sWidth, &sHeight)) {
-            return false;
-        }
+    if (!splitString(minSize, "x", &sWidth, &sHeight)
+            && !splitString(minSize, "*", &sWidth, &sHeight)) {
+        return false;
     }
+    *minWidth = strtol(sWidth.c_str(), NULL, 10);
+    *minHeight = strtol(sHeight.c_str(), NULL, 10);
+    if (!splitString(maxSize, "x", &sWidth, &sHeight)
+            && !splitString(maxSize, "*", &sWidth, &sHeight)) {
+        return false;
+    }
+    *maxWidth = strtol(sWidth.c_str(), NULL, 10);
+    *maxHeight = strtol(sHeight.c_str(), NULL, 10);
+    return *minWidth > 0 && *minHeight > 0 && *maxWidth >= *minWidth && *maxHeight >= *minHeight;
+}
 
-    *width = strtol(sWidth.c_str(), NULL, 10);
-    *height = strtol(sHeight.c_str(), NULL, 10);
-    return (*width > 0) && (*height > 0);
+static bool getMeasureSize(sp<MediaCodecInfo::Capabilities> caps, int32_t *width, int32_t *height) {
+    int32_t maxWidth;
+    int32_t maxHeight;
+    return getSizeRange(caps, width, height, &maxWidth, &maxHeight);
 }
 
 static void getMeasureBitrate(sp<MediaCodecInfo::Capabilities> caps, int32_t *bitrate) {
@@ -238,6 +253,303 @@ static size_t doProfileCodecs(
     return codecs.size();
 }
 
+// Frame rate measurement points, of which those within the size range of a codec are measured.
+static const struct {
+    int32_t mWidth;
+    int32_t mHeight;
+} kMeasureSizes[] = {
+    { 176, 144 },
+    { 320, 240 },
+    { 720, 480 },
+    { 1280, 720 },
+    { 1920, 1080 },
+    { 3840, 2160 },
+};
+
+static const size_t kMeasureFrames = 90;
+// the measured range spans the frame rates achieved in each window of frames
+static const size_t kMeasureWindows = 3;
+static const int64_t kMeasureTimeoutUs = 20000000ll;
+static const int64_t kMeasureFrameDurationUs = 33333ll;
+
+// Fills a planar or semi-planar 4:2:0 frame with a diagonal gradient moving with |frame|, so
+// consecutive frames differ as they would in a panning scene.
+static void fillMeasureFrame(uint8_t *data, size_t size, int32_t width, size_t frame) {
+    const size_t lineSize = width;
+    const uint8_t shift = frame * 4;
+    for (size_t offset = 0, line = 0; offset < size; offset += lineSize, ++line) {
+        const size_t n = size - offset < lineSize ? size - offset : lineSize;
+        for (size_t x = 0; x < n; ++x) {
+            data[offset + x] = (uint8_t)(x + line + shift);
+        }
+    }
+}
+
+// Feeds kMeasureFrames frames to a started |codec|: the access units of |input| if not NULL,
+// otherwise generated raw frames of |frameSize| bytes. Appends the frame rate of each window
+// of output frames to |rates|, and copies the output into |output| if not NULL.
+static status_t runMeasurement(
+        const sp<MediaCodec> &codec, const Vector<sp<ABuffer> > *input,
+        size_t frameSize, int32_t width,
+        Vector<double> *rates, Vector<sp<ABuffer> > *output) {
+    const size_t numInput = input != NULL ? input->size() : kMeasureFrames;
+    const size_t framesPerWindow = kMeasureFrames / kMeasureWindows;
+    const int64_t startUs = ALooper::GetNowUs();
+
+    size_t numQueued = 0;
+    size_t numFrames = 0;
+    size_t numWindowFrames = 0;
+    int64_t windowStartUs = -1;
+    bool eosQueued = false;
+    for (;;) {
+        if (ALooper::GetNowUs() - startUs > kMeasureTimeoutUs) {
+            return TIMED_OUT;
+        }
+
+        size_t index;
+        status_t err;
+        if (!eosQueued && codec->dequeueInputBuffer(&index) == OK) {
+            sp<ABuffer> buffer;
+            if ((err = codec->getInputBuffer(index, &buffer)) != OK) {
+                return err;
+            }
+
+            size_t size = 0;
+            uint32_t flags = 0;
+            if (numQueued == numInput) {
+                flags = MediaCodec::BUFFER_FLAG_EOS;
+                eosQueued = true;
+            } else if (input != NULL) {
+                const sp<ABuffer> &accessUnit = input->itemAt(numQueued);
+                size = accessUnit->size();
+                if (size > buffer->capacity()) {
+                    return ERROR_BUFFER_TOO_SMALL;
+                }
+                memcpy(buffer->base(), accessUnit->data(), size);
+
+                int32_t csd;
+                if (accessUnit->meta()->findInt32("csd", &csd) && csd) {
+                    flags = MediaCodec::BUFFER_FLAG_CODECCONFIG;
+                }
+            } else {
+                size = frameSize < buffer->capacity() ? frameSize : buffer->capacity();
+                fillMeasureFrame(buffer->base(), size, width, numQueued);
+            }
+
+            err = codec->queueInputBuffer(
+                    index, 0 /* offset */, size, numQueued * kMeasureFrameDurationUs, flags);
+            if (err != OK) {
+                return err;
+            }
+            ++numQueued;
+        }
+
+        size_t offset;
+        size_t size;
+        int64_t timeUs;
+        uint32_t flags;
+        err = codec->dequeueOutputBuffer(&index, &offset, &size, &timeUs, &flags, 5000ll);
+        if (err == -EAGAIN || err == INFO_FORMAT_CHANGED || err == INFO_OUTPUT_BUFFERS_CHANGED) {
+            continue;
+        } else if (err != OK) {
+            return err;
+        }
+
+        if (output != NULL && size > 0) {
+            sp<ABuffer> buffer;
+            if ((err = codec->getOutputBuffer(index, &buffer)) != OK) {
+                return err;
+            }
+            sp<ABuffer> copy = new ABuffer(size);
+            memcpy(copy->data(), buffer->data(), size);
+            if (flags & MediaCodec::BUFFER_FLAG_CODECCONFIG) {
+                copy->meta()->setInt32("csd", true);
+            }
+            output->push(copy);
+        }
+
+        if (size > 0 && !(flags & MediaCodec::BUFFER_FLAG_CODECCONFIG)) {
+            // the time to the first frame is not part of the rate
+            const int64_t nowUs = ALooper::GetNowUs();
+            if (windowStartUs < 0) {
+                windowStartUs = nowUs;
+            } else if (++numWindowFrames == framesPerWindow) {
+                if (nowUs > windowStartUs) {
+                    rates->push(numWindowFrames * 1E6 / (nowUs - windowStartUs));
+                }
+                numWindowFrames = 0;
+                windowStartUs = nowUs;
+            }
+            ++numFrames;
+        }
+
+        codec->releaseOutputBuffer(index);
+        if (flags & MediaCodec::BUFFER_FLAG_EOS) {
+            break;
+        }
+    }
+
+    ALOGV("runMeasurement: %zu frames out of %zu in %lld us",
+            numFrames, numQueued, (long long)(ALooper::GetNowUs() - startUs));
+    return rates->isEmpty() ? ERROR_MALFORMED : OK;
+}
+
+// Measures the frame rates achieved by the codec |name| at width x height. For an encoder,
+// keeps the encoded stream in |output| if not NULL; a decoder decodes |input|.
+static bool doProfileFrameRate(
+        bool isEncoder, const AString &name, const AString &mime,
+        sp<MediaCodecInfo::Capabilities> caps, int32_t width, int32_t height,
+        const Vector<sp<ABuffer> > *input, Vector<sp<ABuffer> > *output,
+        double *minRate, double *maxRate) {
+    sp<AMessage> format = new AMessage();
+    format->setString("mime", mime);
+    format->setInt32("width", width);
+    format->setInt32("height", height);
+
+    if (isEncoder) {
+        Vector<uint32_t> colorFormats;
+        caps->getSupportedColorFormats(&colorFormats);
+        if (colorFormats.size() == 0) {
+            return false;
+        }
+        format->setInt32("color-format", colorFormats[0]);
+
+        // about 0.1 bit per pixel, within the bitrate range of the codec if it has one
+        int32_t minBitrate;
+        getMeasureBitrate(caps, &minBitrate);
+        int32_t bitrate = width * height * 3;
+        if (bitrate < minBitrate) {
+            bitrate = minBitrate;
+        }
+        format->setInt32("bitrate", bitrate);
+        format->setFloat("frame-rate", 1E6 / kMeasureFrameDurationUs);
+        format->setInt32("i-frame-interval", 1);
+    }
+    ALOGV("doProfileFrameRate: %s %s", name.c_str(), format->debugString().c_str());
+
+    sp<ALooper> looper = new ALooper;
+    looper->setName("MediaCodec_looper");
+    looper->start(
+            false /* runOnCallingThread */, false /* canCallJava */, ANDROID_PRIORITY_AUDIO);
+
+    status_t err = OK;
+    sp<MediaCodec> codec = MediaCodec::CreateByComponentName(looper, name.c_str(), &err);
+    if (err != OK) {
+        ALOGV("Failed to create codec: %s", name.c_str());
+        return false;
+    }
+
+    Vector<double> rates;
+    err = codec->configure(
+            format, NULL /* nativeWindow */, NULL /* crypto */,
+            isEncoder ? MediaCodec::CONFIGURE_FLAG_ENCODE : 0);
+    if (err == OK) {
+        err = codec->start();
+    }
+    if (err == OK) {
+        err = runMeasurement(codec, input, width * height * 3 / 2, width, &rates, output);
+    }
+    codec->release();
+
+    if (err != OK) {
+        ALOGV("Failed to measure %s at %dx%d: %d", name.c_str(), width, height, err);
+        return false;
+    }
+
+    *minRate = *maxRate = rates[0];
+    for (size_t i = 1; i < rates.size(); ++i) {
+        *minRate = rates[i] < *minRate ? rates[i] : *minRate;
+        *maxRate = rates[i] > *maxRate ? rates[i] : *maxRate;
+    }
+    return true;
+}
+
+static void addCodecSetting(
+        KeyedVector<AString, CodecSettings> *results,
+        const AString &key, const AString &name, const AString &value) {
+    ssize_t index = results->indexOfKey(key);
+    if (index < 0) {
+        index = results->add(key, CodecSettings());
+    }
+    results->editValueAt(index).add(name, value);
+}
+
+// Measures the frame rates of the video codecs at the sizes of kMeasureSizes they support.
+// Decoders decode a stream encoded by an encoder of the same type, so types without an
+// encoder cannot be measured.
+static void profileFrameRates(
+        const Vector<sp<MediaCodecInfo>> &infos,
+        KeyedVector<AString, CodecSettings> *encoder_results,
+        KeyedVector<AString, CodecSettings> *decoder_results) {
+    // encoded streams, by "<mime> <width>x<height>"
+    KeyedVector<AString, Vector<sp<ABuffer> > > streams;
+
+    // encoders first, for their output to be decoded
+    for (int pass = 0; pass < 2; ++pass) {
+        const bool encoders = pass == 0;
+        for (size_t i = 0; i < infos.size(); ++i) {
+            const sp<MediaCodecInfo> info = infos[i];
+            AString name = info->getCodecName();
+            if (info->isEncoder() != encoders || name.endsWith(".secure")) {
+                continue;
+            }
+
+            Vector<AString> mimes;
+            info->getSupportedMimes(&mimes);
+            for (size_t j = 0; j < mimes.size(); ++j) {
+                const AString &mime = mimes[j];
+                const sp<MediaCodecInfo::Capabilities> &caps =
+                        info->getCapabilitiesFor(mime.c_str());
+                int32_t minWidth, minHeight, maxWidth, maxHeight;
+                if (!mime.startsWith("video/")
+                        || !getSizeRange(caps, &minWidth, &minHeight, &maxWidth, &maxHeight)) {
+                    continue;
+                }
+
+                for (size_t k = 0; k < ARRAY_SIZE(kMeasureSizes); ++k) {
+                    const int32_t width = kMeasureSizes[k].mWidth;
+                    const int32_t height = kMeasureSizes[k].mHeight;
+                    if (width < minWidth || width > maxWidth
+                            || height < minHeight || height > maxHeight) {
+                        continue;
+                    }
+
+                    AString streamKey = AStringPrintf("%s %dx%d", mime.c_str(), width, height);
+                    ssize_t streamIndex = streams.indexOfKey(streamKey);
+                    Vector<sp<ABuffer> > *output = NULL;
+                    const Vector<sp<ABuffer> > *input = NULL;
+                    Vector<sp<ABuffer> > encoded;
+                    if (encoders) {
+                        output = streamIndex < 0 ? &encoded : NULL;
+                    } else if (streamIndex >= 0) {
+                        input = &streams.valueAt(streamIndex);
+                    } else {
+                        continue;
+                    }
+
+                    double minRate, maxRate;
+                    if (!doProfileFrameRate(
+                            encoders, name, mime, caps, width, height, input, output,
+                            &minRate, &maxRate)) {
+                        continue;
+                    }
+                    if (output != NULL && !encoded.isEmpty()) {
+                        streams.add(streamKey, encoded);
+                    }
+
+                    ALOGV("%s %s %dx%d: %.1f-%.1f fps",
+                            name.c_str(), mime.c_str(), width, height, minRate, maxRate);
+                    addCodecSetting(
+                            encoders ? encoder_results : decoder_results,
+                            AStringPrintf("%s %s", name.c_str(), mime.c_str()),
+                            AStringPrintf("measured-frame-rate-%dx%d", width, height),
+                            AStringPrintf("%d-%d", (int)minRate, (int)(maxRate + 0.5)));
+                }
+            }
+        }
+    }
+}
+
 bool splitString(const AString &s, const AString &delimiter, AString *s1, AString *s2) {
     ssize_t pos = s.find(delimiter.c_str());
     if (pos < 0) {
@@ -264,7 +576,9 @@ void profileCodecs(const Vector<sp<MediaCodecInfo>> &infos) {
     CodecSettings global_results;
     KeyedVector<AString, CodecSettings> encoder_results;
     KeyedVector<AString, CodecSettings> decoder_results;
-    profileCodecs(infos, &global_results, &encoder_results, &decoder_results);
+    profileCodecs(infos, &global_results, &encoder_results, &decoder_results,
+            false /* forceToMeasure */,
+            property_get_bool("debug.stagefright.profilecodec.framerates", false));
     exportResultsToXML(kProfilingResults, global_results, encoder_results, decoder_results);
 }
 
@@ -273,7 +587,8 @@ void profileCodecs(
         CodecSettings *global_results,
         KeyedVector<AString, CodecSettings> *encoder_results,
         KeyedVector<AString, CodecSettings> *decoder_results,
-        bool forceToMeasure) {
+        bool forceToMeasure,
+        bool measureFrameRates) {
     KeyedVector<AString, sp<MediaCodecInfo::Capabilities>> codecsNeedMeasure;
     AString supportMultipleSecureCodecs = "true";
     size_t maxEncoderInputBuffers = 0;
@@ -335,6 +650,10 @@ void profileCodecs(
         global_results->add(kMaxEncoderInputBuffers, tmp);
     }
     global_results->add(kPolicySupportsMultipleSecureCodecs, supportMultipleSecureCodecs);
+
+    if (measureFrameRates) {
+        profileFrameRates(infos, encoder_results, decoder_results);
+    }
 }
 
 static AString globalResultsToXml(const CodecSettings& results) {
@@ -364,11 +683,13 @@ static AString codecResultsToXml(const KeyedVector<AString, CodecSettings>& resu
         ret.append(codec);
         CodecSettings settings = results.valueAt(i);
         for (size_t i = 0; i < settings.size(); ++i) {
-            // WARNING: we assume all the settings are "Limit". Currently we have only one type
-            // of setting in this case, which is "max-supported-instances".
+            // WARNING: we assume all the settings are "Limit". Currently we have only
+            // "max-supported-instances", and the "measured-frame-rate-*" ranges.
+            const AString &name = settings.keyAt(i);
             AString setting = AStringPrintf(
-                    "            <Limit name=\"%s\" value=\"%s\" />\n",
-                    settings.keyAt(i).c_str(),
+                    "            <Limit name=\"%s\" %s=\"%s\" />\n",
+                    name.c_str(),
+                    name.startsWith("measured-") ? "range" : "value",
                     settings.valueAt(i).c_str());
             ret.append(setting);
         }
@@ -39,12 +39,15 @@ bool splitString(const AString &s, const AString &delimiter, AString *s1, AStrin
 void profileCodecs(const Vector<sp<MediaCodecInfo>> &infos);
 
 // profile codecs and save the result to global_results, encoder_results and decoder_results.
+// if measureFrameRates is set, also measures the frame rates the video codecs achieve at
+// common sizes, as "measured-frame-rate-WxH" ranges.
 void profileCodecs(
         const Vector<sp<MediaCodecInfo>> &infos,
         CodecSettings *global_results,
         KeyedVector<AString, CodecSettings> *encoder_results,
         KeyedVector<AString, CodecSettings> *decoder_results,
-        bool forceToMeasure = false);
+        bool forceToMeasure = false,
+        bool measureFrameRates = false);
 
 void exportResultsToXML(
         const char *fileName,
@@ -50,7 +50,9 @@ struct MediaCodecSource::Puller : public AHandler {
     Puller(const sp<MediaSource> &source);
 
     void interruptSource();
-    status_t start(const sp<MetaData> &meta, const sp<AMessage> &notify);
+    // If feeder is set, buffers read are handed to it right away, instead of through notify.
+    status_t start(const sp<MetaData> &meta, const sp<AMessage> &notify,
+            const wp<MediaCodecSource> &feeder);
     void stop();
     void stopSource();
     void pause();
@@ -71,6 +73,7 @@ private:
 
     sp<MediaSource> mSource;
     sp<AMessage> mNotify;
+    wp<MediaCodecSource> mFeeder;
     sp<ALooper> mLooper;
     bool mIsAudio;
 
@@ -162,7 +165,8 @@ status_t MediaCodecSource::Puller::postSynchronouslyAndReturnError(
     return err;
 }
 
-status_t MediaCodecSource::Puller::start(const sp<MetaData> &meta, const sp<AMessage> &notify) {
+status_t MediaCodecSource::Puller::start(const sp<MetaData> &meta, const sp<AMessage> &notify,
+        const wp<MediaCodecSource> &feeder) {
     ALOGV("puller (%s) start", mIsAudio ? "audio" : "video");
     mLooper->start(
             false /* runOnCallingThread */,
@@ -170,6 +174,7 @@ status_t MediaCodecSource::Puller::start(const sp<MetaData> &meta, const sp<AMes
             PRIORITY_AUDIO);
     mLooper->registerHandler(this);
     mNotify = notify;
+    mFeeder = feeder;
 
     sp<AMessage> msg = new AMessage(kWhatStart, this);
     msg->setObject("meta", meta);
@@ -302,7 +307,12 @@ void MediaCodecSource::Puller::onMessageReceived(const sp<AMessage> &msg) {
             queue.unlock();
 
             if (mbuf != NULL) {
-                mNotify->post();
+                sp<MediaCodecSource> feeder = mFeeder.promote();
+                if (feeder != NULL) {
+                    feeder->onPullerBufferAvailable();
+                } else {
+                    mNotify->post();
+                }
                 msg->post();
             } else {
                 handleEOS();
@@ -563,6 +573,7 @@ status_t MediaCodecSource::initEncoder() {
 }
 
 void MediaCodecSource::releaseEncoder() {
+    Mutex::Autolock autoLock(mFeedLock);
     if (mEncoder == NULL) {
         return;
     }
@@ -648,6 +659,39 @@ void MediaCodecSource::resume(int64_t skipFramesBeforeUs) {
 }
 
 status_t MediaCodecSource::feedEncoderInputBuffers() {
+    bool inputError = false;
+    status_t err;
+    {
+        Mutex::Autolock autoLock(mFeedLock);
+        err = feedEncoderInputBuffers_l(&inputError);
+    }
+    if (inputError) {
+        signalEOS();
+    }
+    return err;
+}
+
+void MediaCodecSource::onPullerBufferAvailable() {
+    // Runs on the puller thread. If no encoder input buffer is available, the buffer stays
+    // queued in the puller until the encoder returns one.
+    bool inputError = false;
+    {
+        Mutex::Autolock autoLock(mFeedLock);
+        if (mEncoder == NULL) {
+            return;
+        }
+        (void)feedEncoderInputBuffers_l(&inputError);
+    }
+    if (inputError) {
+        // EOS must be handled on the looper
+        sp<AMessage> msg = new AMessage(kWhatPullerNotify, mReflector);
+        msg->setInt32("eos", 1);
+        msg->post();
+    }
+}
+
+status_t MediaCodecSource::feedEncoderInputBuffers_l(bool *inputError) {
+    *inputError = false;
     MediaBuffer* mbuf = NULL;
     while (!mAvailEncoderInputIndices.empty() && mPuller->readBuffer(&mbuf)) {
         size_t bufferIndex = *mAvailEncoderInputIndices.begin();
@@ -693,7 +737,7 @@ status_t MediaCodecSource::feedEncoderInputBuffers() {
             status_t err = mEncoder->getInputBuffer(bufferIndex, &inbuf);
             if (err != OK || inbuf == NULL) {
                 mbuf->release();
-                signalEOS();
+                *inputError = true;
                 break;
             }
 
@@ -731,9 +775,12 @@ status_t MediaCodecSource::onStart(MetaData *params) {
 
     if (mStarted) {
         ALOGI("MediaCodecSource (%s) resuming", mIsVideo ? "video" : "audio");
-        if (mPausePending) {
-            mPausePending = false;
-            return OK;
+        {
+            Mutex::Autolock autoLock(mFeedLock);
+            if (mPausePending) {
+                mPausePending = false;
+                return OK;
+            }
         }
         if (mIsVideo) {
             mEncoder->requestIDRFrame();
@@ -769,7 +816,11 @@ status_t MediaCodecSource::onStart(MetaData *params) {
         }
 
         sp<AMessage> notify = new AMessage(kWhatPullerNotify, mReflector);
-        err = mPuller->start(meta.get(), notify);
+        wp<MediaCodecSource> feeder;
+        if (mFlags & FLAG_LOW_LATENCY) {
+            feeder = this;
+        }
+        err = mPuller->start(meta.get(), notify, feeder);
         if (err != OK) {
             return err;
         }
@@ -821,7 +872,10 @@ void MediaCodecSource::onMessageReceived(const sp<AMessage> &msg) {
             int32_t index;
             CHECK(msg->findInt32("index", &index));
 
-            mAvailEncoderInputIndices.push_back(index);
+            {
+                Mutex::Autolock autoLock(mFeedLock);
+                mAvailEncoderInputIndices.push_back(index);
+            }
             feedEncoderInputBuffers();
         } else if (cbID == MediaCodec::CB_OUTPUT_FORMAT_CHANGED) {
             status_t err = mEncoder->getOutputFormat(&mOutputFormat);
@@ -866,6 +920,7 @@ void MediaCodecSource::onMessageReceived(const sp<AMessage> &msg) {
                 if (mIsVideo) {
                     int64_t decodingTimeUs;
                     if (mFlags & FLAG_USE_SURFACE_INPUT) {
+                        Mutex::Autolock autoLock(mFeedLock);
                         if (mFirstSampleSystemTimeUs < 0ll) {
                             mFirstSampleSystemTimeUs = systemTime() / 1000;
                             if (mPausePending) {
@@ -885,6 +940,7 @@ void MediaCodecSource::onMessageReceived(const sp<AMessage> &msg) {
                         // this logic into MediaCodec.
                         decodingTimeUs = timeUs;
                     } else {
+                        Mutex::Autolock autoLock(mFeedLock);
                         CHECK(!mDecodingTimeQueue.empty());
                         decodingTimeUs = *(mDecodingTimeQueue.begin());
                         mDecodingTimeQueue.erase(mDecodingTimeQueue.begin());
@@ -896,6 +952,7 @@ void MediaCodecSource::onMessageReceived(const sp<AMessage> &msg) {
                 } else {
                     int64_t driftTimeUs = 0;
 #if DEBUG_DRIFT_TIME
+                    Mutex::Autolock autoLock(mFeedLock);
                     CHECK(!mDriftTimeQueue.empty());
                     driftTimeUs = *(mDriftTimeQueue.begin());
                     mDriftTimeQueue.erase(mDriftTimeQueue.begin());
@@ -1002,6 +1059,7 @@ void MediaCodecSource::onMessageReceived(const sp<AMessage> &msg) {
 
     case kWhatPause:
     {
+        Mutex::Autolock autoLock(mFeedLock);
         if (mFirstSampleSystemTimeUs < 0) {
             mPausePending = true;
         } else {
@@ -1014,12 +1072,16 @@ void MediaCodecSource::onMessageReceived(const sp<AMessage> &msg) {
         sp<AReplyToken> replyID;
         CHECK(msg->senderAwaitsResponse(&replyID));
         status_t err = OK;
-        CHECK(msg->findInt64("time-offset-us", &mInputBufferTimeOffsetUs));
+        int64_t timeOffsetUs;
+        CHECK(msg->findInt64("time-offset-us", &timeOffsetUs));
+        mFeedLock.lock();
+        mInputBufferTimeOffsetUs = timeOffsetUs;
+        mFeedLock.unlock();
 
         // Propagate the timestamp offset to GraphicBufferSource.
         if (mIsVideo) {
             sp<AMessage> params = new AMessage;
-            params->setInt64("time-offset-us", mInputBufferTimeOffsetUs);
+            params->setInt64("time-offset-us", timeOffsetUs);
             err = mEncoder->setParameters(params);
         }
 
@@ -1034,7 +1096,9 @@ void MediaCodecSource::onMessageReceived(const sp<AMessage> &msg) {
         CHECK(msg->senderAwaitsResponse(&replyID));
 
         sp<AMessage> response = new AMessage;
+        mFeedLock.lock();
         response->setInt64("time-us", mFirstSampleSystemTimeUs);
+        mFeedLock.unlock();
         response->postReply(replyID);
         break;
     }
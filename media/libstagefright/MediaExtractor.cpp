@@ -84,6 +84,8 @@ public:
 
     virtual sp<IMemory> getIMemory();
     virtual ssize_t readAt(off64_t offset, size_t size);
+    virtual status_t readAtRanges(
+            size_t count, const off64_t *offsets, const size_t *sizes, ssize_t *results);
     virtual status_t getSize(off64_t* size);
     virtual void close();
     virtual uint32_t getFlags();
@@ -121,6 +123,36 @@ ssize_t RemoteDataSource::readAt(off64_t offset, size_t size) {
     ALOGV("readAt(%" PRId64 ", %zu)", offset, size);
     return mSource->readAt(offset, mMemory->pointer(), size);
 }
+status_t RemoteDataSource::readAtRanges(
+        size_t count, const off64_t *offsets, const size_t *sizes, ssize_t *results) {
+    ALOGV("readAtRanges(%zu)", count);
+    if (mSource == NULL || mMemory == NULL) {
+        return NO_INIT;
+    }
+    size_t totalSize = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (sizes[i] > mMemory->size() - totalSize) {
+            return BAD_VALUE;
+        }
+        totalSize += sizes[i];
+    }
+
+    Vector<DataSource::ReadRange> ranges;
+    ranges.resize(count);
+    uint8_t *data = (uint8_t *)mMemory->pointer();
+    for (size_t i = 0; i < count; ++i) {
+        DataSource::ReadRange &range = ranges.editItemAt(i);
+        range.mOffset = offsets[i];
+        range.mSize = sizes[i];
+        range.mData = data;
+        data += sizes[i];
+    }
+    mSource->readAtRanges(ranges.editArray(), count);
+    for (size_t i = 0; i < count; ++i) {
+        results[i] = ranges[i].mResult;
+    }
+    return OK;
+}
 status_t RemoteDataSource::getSize(off64_t* size) {
     return mSource->getSize(size);
 }
@@ -139,6 +171,100 @@ sp<DecryptHandle> RemoteDataSource::DrmInitialization(const char *mime) {
     return mSource->DrmInitialization(mime);
 }
 
+// Remembers the container types sniffed for recently opened sources, since the same files
+// tend to be opened over and over by galleries and scanners. A source is identified by its
+// description, which includes the file name for files, its size and a hash of its first bytes.
+// Only the MIME type is kept: the extractors that take sniffer metadata find it again by
+// themselves, and DRM content is always sniffed, for its DRM session to be set up.
+struct SniffResultCache {
+    static bool Lookup(const sp<DataSource> &source, String8 *mime);
+    static void Insert(const sp<DataSource> &source, const String8 &mime);
+
+private:
+    enum {
+        kMaxEntries  = 32,
+        kHashedBytes = 4096,
+    };
+
+    struct Entry {
+        String8 mName;
+        off64_t mSize;
+        uint32_t mHash;
+        String8 mMime;
+    };
+
+    static Mutex gLock;
+    // most recently used first
+    static List<Entry> gEntries;
+
+    static bool GetKey(const sp<DataSource> &source, Entry *entry);
+};
+
+Mutex SniffResultCache::gLock;
+List<SniffResultCache::Entry> SniffResultCache::gEntries;
+
+// static
+bool SniffResultCache::GetKey(const sp<DataSource> &source, Entry *entry) {
+    if (source->getSize(&entry->mSize) != OK || entry->mSize <= 0) {
+        return false;
+    }
+
+    uint8_t data[kHashedBytes];
+    ssize_t n = source->readAt(0, data, sizeof(data));
+    if (n <= 0) {
+        return false;
+    }
+    // FNV-1a
+    entry->mHash = 2166136261u;
+    for (ssize_t i = 0; i < n; ++i) {
+        entry->mHash = (entry->mHash ^ data[i]) * 16777619u;
+    }
+
+    entry->mName = source->toString();
+    return true;
+}
+
+// static
+bool SniffResultCache::Lookup(const sp<DataSource> &source, String8 *mime) {
+    Entry key;
+    if (!GetKey(source, &key)) {
+        return false;
+    }
+
+    Mutex::Autolock autoLock(gLock);
+    for (List<Entry>::iterator it = gEntries.begin(); it != gEntries.end(); ++it) {
+        if ((*it).mSize == key.mSize && (*it).mHash == key.mHash && (*it).mName == key.mName) {
+            *mime = (*it).mMime;
+            if (it != gEntries.begin()) {
+                Entry entry = *it;
+                gEntries.erase(it);
+                gEntries.push_front(entry);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// static
+void SniffResultCache::Insert(const sp<DataSource> &source, const String8 &mime) {
+    if (!strncmp(mime.string(), "drm+", 4)) {
+        return;
+    }
+
+    Entry entry;
+    if (!GetKey(source, &entry)) {
+        return;
+    }
+    entry.mMime = mime;
+
+    Mutex::Autolock autoLock(gLock);
+    gEntries.push_front(entry);
+    if (gEntries.size() > kMaxEntries) {
+        gEntries.erase(--gEntries.end());
+    }
+}
+
 // static
 sp<IMediaExtractor> MediaExtractor::Create(
         const sp<DataSource> &source, const char *mime) {
@@ -197,7 +323,10 @@ sp<MediaExtractor> MediaExtractor::CreateFromService(
     sp<AMessage> meta;
 
     String8 tmp;
-    if (mime == NULL) {
+    if (mime == NULL && SniffResultCache::Lookup(source, &tmp)) {
+        mime = tmp.string();
+        ALOGV("Media content previously detected as '%s'", mime);
+    } else if (mime == NULL) {
         float confidence;
         if (!source->sniff(&tmp, &confidence, &meta)) {
             ALOGV("FAILED to autodetect media content.");
@@ -208,6 +337,7 @@ sp<MediaExtractor> MediaExtractor::CreateFromService(
         mime = tmp.string();
         ALOGV("Autodetected media content as '%s' with confidence %.2f",
              mime, confidence);
+        SniffResultCache::Insert(source, tmp);
     }
 
     bool isDrm = false;
@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "MediaSourceSplitter"
+#include <utils/Log.h>
+
+#include <strings.h>
+
+#include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/MediaBuffer.h>
+#include <media/stagefright/MediaErrors.h>
+#include <media/stagefright/MediaSourceSplitter.h>
+#include <media/stagefright/MetaData.h>
+
+namespace android {
+
+// Deletes a buffer from outside of a MediaBufferGroup once its last clone is released.
+struct DetachedBufferObserver : public MediaBufferObserver {
+    virtual void signalBufferReturned(MediaBuffer *buffer) {
+        buffer->setObserver(NULL);
+        buffer->release();
+    }
+};
+
+static DetachedBufferObserver gDetachedBufferObserver;
+
+struct MediaSourceSplitter::Client : public MediaSource {
+    Client(const sp<MediaSourceSplitter> &splitter, size_t maxQueuedBuffers);
+
+    virtual status_t start(MetaData *params = NULL);
+    virtual status_t stop();
+    virtual sp<MetaData> getFormat();
+    virtual status_t read(
+            MediaBuffer **buffer, const ReadOptions *options = NULL);
+
+protected:
+    virtual ~Client();
+
+private:
+    friend struct MediaSourceSplitter;
+
+    sp<MediaSourceSplitter> mSplitter;
+
+    // Protected by the lock of the splitter.
+    bool mStarted;
+    size_t mMaxQueuedBuffers;
+    List<MediaBuffer *> mQueue;
+    bool mWaitingForSyncFrame;
+    size_t mNumDroppedBuffers;
+
+    DISALLOW_EVIL_CONSTRUCTORS(Client);
+};
+
+MediaSourceSplitter::Client::Client(
+        const sp<MediaSourceSplitter> &splitter, size_t maxQueuedBuffers)
+    : mSplitter(splitter),
+      mStarted(false),
+      mMaxQueuedBuffers(maxQueuedBuffers),
+      mWaitingForSyncFrame(false),
+      mNumDroppedBuffers(0) {
+    CHECK_GT(mMaxQueuedBuffers, 0u);
+}
+
+MediaSourceSplitter::Client::~Client() {
+    stop();
+}
+
+status_t MediaSourceSplitter::Client::start(MetaData *params) {
+    return mSplitter->startClient(this, params);
+}
+
+status_t MediaSourceSplitter::Client::stop() {
+    return mSplitter->stopClient(this);
+}
+
+sp<MetaData> MediaSourceSplitter::Client::getFormat() {
+    return mSplitter->getFormat();
+}
+
+status_t MediaSourceSplitter::Client::read(
+        MediaBuffer **buffer, const ReadOptions *options) {
+    int64_t seekTimeUs;
+    ReadOptions::SeekMode seekMode;
+    if (options && options->getSeekTo(&seekTimeUs, &seekMode)) {
+        ALOGW("seeking is not supported");
+    }
+    return mSplitter->readForClient(this, buffer);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+MediaSourceSplitter::MediaSourceSplitter(const sp<IMediaSource> &source)
+    : mSource(source),
+      mIsVideo(false),
+      mSourceStarted(false),
+      mReading(false),
+      mFinalResult(OK) {
+    CHECK(mSource != NULL);
+
+    const char *mime;
+    sp<MetaData> format = mSource->getFormat();
+    if (format != NULL && format->findCString(kKeyMIMEType, &mime)) {
+        mIsVideo = !strncasecmp(mime, "video/", 6);
+    }
+}
+
+MediaSourceSplitter::~MediaSourceSplitter() {
+    CHECK(mClients.empty());
+    while (!mCodecConfigBuffers.empty()) {
+        (*mCodecConfigBuffers.begin())->release();
+        mCodecConfigBuffers.erase(mCodecConfigBuffers.begin());
+    }
+}
+
+sp<MediaSource> MediaSourceSplitter::createClient(size_t maxQueuedBuffers) {
+    return new Client(this, maxQueuedBuffers);
+}
+
+sp<MetaData> MediaSourceSplitter::getFormat() {
+    return mSource->getFormat();
+}
+
+status_t MediaSourceSplitter::startClient(Client *client, MetaData *params) {
+    Mutex::Autolock autoLock(mLock);
+    if (client->mStarted) {
+        return OK;
+    }
+
+    if (!mSourceStarted) {
+        // Nobody reads from the source before it is started, or while it is
+        // being stopped by the last client.
+        while (mReading) {
+            mCondition.wait(mLock);
+        }
+        status_t err = mSource->start(params);
+        if (err != OK) {
+            ALOGE("failed to start the source (%d)", err);
+            return err;
+        }
+        mSourceStarted = true;
+        mFinalResult = OK;
+    }
+
+    // A client joining late starts with the codec config and the next sync frame.
+    for (List<MediaBuffer *>::iterator it = mCodecConfigBuffers.begin();
+            it != mCodecConfigBuffers.end(); ++it) {
+        client->mQueue.push_back((*it)->clone());
+    }
+    client->mWaitingForSyncFrame = mIsVideo && !mClients.empty();
+    client->mNumDroppedBuffers = 0;
+    client->mStarted = true;
+    mClients.push_back(client);
+    return OK;
+}
+
+status_t MediaSourceSplitter::stopClient(Client *client) {
+    bool stopSource = false;
+    {
+        Mutex::Autolock autoLock(mLock);
+        if (!client->mStarted) {
+            return OK;
+        }
+
+        client->mStarted = false;
+        flushClient_l(client, false /* keepCodecConfig */);
+        for (List<Client *>::iterator it = mClients.begin(); it != mClients.end(); ++it) {
+            if (*it == client) {
+                mClients.erase(it);
+                break;
+            }
+        }
+        if (client->mNumDroppedBuffers > 0) {
+            ALOGI("client %p dropped %zu buffers", client, client->mNumDroppedBuffers);
+        }
+
+        if (mClients.empty()) {
+            stopSource = true;
+            mSourceStarted = false;
+            // The source is stopped below, hold off new starts until it is.
+            mReading = true;
+        }
+        // Wake up the read of the client.
+        mCondition.broadcast();
+    }
+
+    if (!stopSource) {
+        return OK;
+    }
+
+    // Stopping the source also makes a blocking read of the source return.
+    status_t err = mSource->stop();
+
+    Mutex::Autolock autoLock(mLock);
+    mReading = false;
+    while (!mCodecConfigBuffers.empty()) {
+        (*mCodecConfigBuffers.begin())->release();
+        mCodecConfigBuffers.erase(mCodecConfigBuffers.begin());
+    }
+    mCondition.broadcast();
+    return err;
+}
+
+status_t MediaSourceSplitter::readForClient(Client *client, MediaBuffer **buffer) {
+    *buffer = NULL;
+
+    Mutex::Autolock autoLock(mLock);
+    for (;;) {
+        if (!client->mStarted) {
+            return NO_INIT;
+        }
+
+        if (!client->mQueue.empty()) {
+            *buffer = *client->mQueue.begin();
+            client->mQueue.erase(client->mQueue.begin());
+            return OK;
+        }
+
+        if (mFinalResult != OK) {
+            return mFinalResult;
+        }
+
+        if (mReading) {
+            // Another client pulls the next buffer for all of them.
+            mCondition.wait(mLock);
+            continue;
+        }
+
+        mReading = true;
+        MediaBuffer *sourceBuffer = NULL;
+        mLock.unlock();
+        status_t err = mSource->read(&sourceBuffer);
+        mLock.lock();
+        mReading = false;
+
+        if (err == OK) {
+            queueBuffer_l(sourceBuffer);
+        } else {
+            ALOGV("source returned %d", err);
+            mFinalResult = err;
+        }
+        mCondition.broadcast();
+    }
+}
+
+void MediaSourceSplitter::queueBuffer_l(MediaBuffer *buffer) {
+    int32_t isCodecConfig = false;
+    int32_t isSync = false;
+    sp<MetaData> meta = buffer->meta_data();
+    meta->findInt32(kKeyIsCodecConfig, &isCodecConfig);
+    meta->findInt32(kKeyIsSyncFrame, &isSync);
+    isSync = isSync || !mIsVideo;
+
+    if (buffer->localRefcount() == 0) {
+        // Such a buffer is deleted on its first release, let its clones hold a reference.
+        buffer->setObserver(&gDetachedBufferObserver);
+        buffer->add_ref();
+    }
+
+    if (isCodecConfig) {
+        mCodecConfigBuffers.push_back(buffer->clone());
+    }
+
+    for (List<Client *>::iterator it = mClients.begin(); it != mClients.end(); ++it) {
+        Client *client = *it;
+        if (!isCodecConfig) {
+            if (client->mQueue.size() >= client->mMaxQueuedBuffers) {
+                if (!client->mWaitingForSyncFrame) {
+                    ALOGW("client %p is %zu buffers behind, dropping them",
+                            client, client->mQueue.size());
+                }
+                client->mNumDroppedBuffers += flushClient_l(client, true /* keepCodecConfig */);
+                client->mWaitingForSyncFrame = true;
+            }
+            if (client->mWaitingForSyncFrame && !isSync) {
+                ++client->mNumDroppedBuffers;
+                continue;
+            }
+            client->mWaitingForSyncFrame = false;
+        }
+        client->mQueue.push_back(buffer->clone());
+    }
+
+    // The clones hold on to the buffer of the source.
+    buffer->release();
+}
+
+// static
+size_t MediaSourceSplitter::flushClient_l(Client *client, bool keepCodecConfig) {
+    size_t numFlushed = 0;
+    List<MediaBuffer *>::iterator it = client->mQueue.begin();
+    while (it != client->mQueue.end()) {
+        int32_t isCodecConfig = false;
+        if (keepCodecConfig
+                && (*it)->meta_data()->findInt32(kKeyIsCodecConfig, &isCodecConfig)
+                && isCodecConfig) {
+            ++it;
+            continue;
+        }
+        (*it)->release();
+        it = client->mQueue.erase(it);
+        ++numFlushed;
+    }
+    return numFlushed;
+}
+
+}  // namespace android
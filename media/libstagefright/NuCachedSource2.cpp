@@ -14,7 +14,10 @@
  * limitations under the License.
  */
 
+#include <fcntl.h>
 #include <inttypes.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 //#define LOG_NDEBUG 0
 #define LOG_TAG "NuCachedSource2"
@@ -44,38 +47,55 @@ struct PageCache {
 
     void appendPage(Page *page);
     size_t releaseFromStart(size_t maxBytes);
+    size_t releaseFromEnd(size_t maxBytes);
+
+    // Releases exactly |numBytes| from the start, moving the remainder of a
+    // partially released page to its front.
+    void trimStart(size_t numBytes);
+
+    // Moves the pages of |other| to the end of this cache.
+    void appendPages(PageCache *other);
 
     size_t totalSize() const {
         return mTotalSize;
     }
 
-    void copy(size_t from, void *data, size_t size);
+    void copy(size_t from, void *data, size_t size) const;
 
 private:
     size_t mPageSize;
     size_t mTotalSize;
 
-    List<Page *> mActivePages;
+    // The active pages and where each of them starts, counted from where the
+    // first page ever appended started, so that releasing pages does not move
+    // the offsets of the others. Fetches may return less than a page, the
+    // page holding an offset is found by a binary search.
+    Vector<Page *> mActivePages;
+    Vector<off64_t> mPageOffsets;
+    off64_t mStartOffset;
+
     List<Page *> mFreePages;
 
-    void freePages(List<Page *> *list);
+    // Releases the first |numPages| active pages.
+    void releaseFirstPages(size_t numPages);
 
     DISALLOW_EVIL_CONSTRUCTORS(PageCache);
 };
 
 PageCache::PageCache(size_t pageSize)
     : mPageSize(pageSize),
-      mTotalSize(0) {
+      mTotalSize(0),
+      mStartOffset(0) {
 }
 
 PageCache::~PageCache() {
-    freePages(&mActivePages);
-    freePages(&mFreePages);
-}
+    for (size_t i = 0; i < mActivePages.size(); ++i) {
+        free(mActivePages[i]->mData);
+        delete mActivePages[i];
+    }
 
-void PageCache::freePages(List<Page *> *list) {
-    List<Page *>::iterator it = list->begin();
-    while (it != list->end()) {
+    List<Page *>::iterator it = mFreePages.begin();
+    while (it != mFreePages.end()) {
         Page *page = *it;
 
         free(page->mData);
@@ -108,72 +128,338 @@ void PageCache::releasePage(Page *page) {
 }
 
 void PageCache::appendPage(Page *page) {
-    mTotalSize += page->mSize;
     mActivePages.push_back(page);
+    mPageOffsets.push_back(mStartOffset + mTotalSize);
+    mTotalSize += page->mSize;
+}
+
+void PageCache::releaseFirstPages(size_t numPages) {
+    for (size_t i = 0; i < numPages; ++i) {
+        Page *page = mActivePages[i];
+        mStartOffset += page->mSize;
+        mTotalSize -= page->mSize;
+
+        releasePage(page);
+    }
+
+    mActivePages.removeItemsAt(0, numPages);
+    mPageOffsets.removeItemsAt(0, numPages);
 }
 
 size_t PageCache::releaseFromStart(size_t maxBytes) {
+    size_t numPages = 0;
     size_t bytesReleased = 0;
 
-    while (maxBytes > 0 && !mActivePages.empty()) {
-        List<Page *>::iterator it = mActivePages.begin();
+    while (numPages < mActivePages.size()
+            && bytesReleased + mActivePages[numPages]->mSize <= maxBytes) {
+        bytesReleased += mActivePages[numPages]->mSize;
+        ++numPages;
+    }
 
-        Page *page = *it;
+    if (numPages > 0) {
+        releaseFirstPages(numPages);
+    }
 
-        if (maxBytes < page->mSize) {
+    return bytesReleased;
+}
+
+size_t PageCache::releaseFromEnd(size_t maxBytes) {
+    size_t bytesReleased = 0;
+
+    while (!mActivePages.isEmpty()) {
+        size_t last = mActivePages.size() - 1;
+
+        Page *page = mActivePages[last];
+
+        if (maxBytes < bytesReleased + page->mSize) {
             break;
         }
 
-        mActivePages.erase(it);
+        mActivePages.removeAt(last);
+        mPageOffsets.removeAt(last);
 
-        maxBytes -= page->mSize;
         bytesReleased += page->mSize;
+        mTotalSize -= page->mSize;
 
         releasePage(page);
     }
 
-    mTotalSize -= bytesReleased;
     return bytesReleased;
 }
 
-void PageCache::copy(size_t from, void *data, size_t size) {
-    ALOGV("copy from %zu size %zu", from, size);
+void PageCache::trimStart(size_t numBytes) {
+    CHECK_LE(numBytes, mTotalSize);
 
-    if (size == 0) {
+    numBytes -= releaseFromStart(numBytes);
+    if (numBytes == 0) {
         return;
     }
 
-    CHECK_LE(from + size, mTotalSize);
+    Page *page = mActivePages[0];
+    CHECK_LT(numBytes, page->mSize);
 
-    size_t offset = 0;
-    List<Page *>::iterator it = mActivePages.begin();
-    while (from >= offset + (*it)->mSize) {
-        offset += (*it)->mSize;
-        ++it;
+    memmove(page->mData, (const uint8_t *)page->mData + numBytes, page->mSize - numBytes);
+    page->mSize -= numBytes;
+    mPageOffsets.editItemAt(0) += numBytes;
+    mStartOffset += numBytes;
+    mTotalSize -= numBytes;
+}
+
+void PageCache::appendPages(PageCache *other) {
+    CHECK_EQ(mPageSize, other->mPageSize);
+
+    for (size_t i = 0; i < other->mActivePages.size(); ++i) {
+        appendPage(other->mActivePages[i]);
     }
 
-    size_t delta = from - offset;
-    size_t avail = (*it)->mSize - delta;
+    other->mActivePages.clear();
+    other->mPageOffsets.clear();
+    other->mStartOffset += other->mTotalSize;
+    other->mTotalSize = 0;
+}
+
+void PageCache::copy(size_t from, void *data, size_t size) const {
+    ALOGV("copy from %zu size %zu", from, size);
 
-    if (avail >= size) {
-        memcpy(data, (const uint8_t *)(*it)->mData + delta, size);
+    if (size == 0) {
         return;
     }
 
-    memcpy(data, (const uint8_t *)(*it)->mData + delta, avail);
-    ++it;
-    data = (uint8_t *)data + avail;
-    size -= avail;
+    CHECK_LE(from + size, mTotalSize);
+
+    // the last page starting at or before the offset
+    off64_t offset = mStartOffset + from;
+    size_t lo = 0;
+    size_t hi = mPageOffsets.size();
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (mPageOffsets[mid] <= offset) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
 
-    while (size > 0) {
-        size_t copy = (*it)->mSize;
+    size_t delta = offset - mPageOffsets[lo];
+    for (size_t i = lo; size > 0; ++i) {
+        const Page *page = mActivePages[i];
+
+        size_t copy = page->mSize - delta;
         if (copy > size) {
             copy = size;
         }
-        memcpy(data, (*it)->mData, copy);
+        memcpy(data, (const uint8_t *)page->mData + delta, copy);
         data = (uint8_t *)data + copy;
         size -= copy;
-        ++it;
+        delta = 0;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Keeps the data fetched from a source in a file of the directory named by
+// media.stagefright.cache-dir, at the offsets it was read from, along with an
+// index of the ranges cached. The files are named by the hash of the URI and
+// a cache is only reused if the content length still matches. Removing old
+// files is up to the owner of the directory.
+struct DiskCache {
+    // Returns NULL if the disk cache is disabled or cannot be opened.
+    static DiskCache *Open(const String8 &uri, off64_t size);
+
+    ~DiskCache();
+
+    // Returns the number of bytes at |offset| read from the cache, 0 if
+    // |offset| is not cached.
+    ssize_t read(off64_t offset, void *data, size_t size);
+
+    void write(off64_t offset, const void *data, size_t size);
+
+private:
+    DiskCache(int fd, const String8 &indexPath, off64_t size);
+
+    int mFd;
+    String8 mIndexPath;
+    off64_t mSize;
+    bool mIndexChanged;
+
+    // disjoint ranges cached, their end offsets keyed by their start offsets
+    KeyedVector<off64_t, off64_t> mRanges;
+
+    void addRange(off64_t start, off64_t end);
+
+    void loadIndex();
+    void saveIndex();
+
+    DISALLOW_EVIL_CONSTRUCTORS(DiskCache);
+};
+
+// static
+DiskCache *DiskCache::Open(const String8 &uri, off64_t size) {
+    char dir[PROPERTY_VALUE_MAX];
+    if (!property_get("media.stagefright.cache-dir", dir, NULL) || size <= 0) {
+        return NULL;
+    }
+
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < uri.length(); ++i) {
+        hash = (hash ^ (uint8_t)uri.string()[i]) * 0x100000001b3ull;
+    }
+
+    String8 path = String8::format("%s/%016" PRIx64, dir, hash);
+    int fd = open((path + ".data").string(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        ALOGW("failed to open disk cache %s (%s)", path.string(), strerror(errno));
+        return NULL;
+    }
+
+    DiskCache *cache = new DiskCache(fd, path + ".index", size);
+    cache->loadIndex();
+    return cache;
+}
+
+DiskCache::DiskCache(int fd, const String8 &indexPath, off64_t size)
+    : mFd(fd),
+      mIndexPath(indexPath),
+      mSize(size),
+      mIndexChanged(false) {
+}
+
+DiskCache::~DiskCache() {
+    if (mIndexChanged) {
+        saveIndex();
+    }
+
+    close(mFd);
+    mFd = -1;
+}
+
+ssize_t DiskCache::read(off64_t offset, void *data, size_t size) {
+    for (size_t i = 0; i < mRanges.size(); ++i) {
+        if (offset < mRanges.keyAt(i) || offset >= mRanges.valueAt(i)) {
+            continue;
+        }
+
+        if ((off64_t)size > mRanges.valueAt(i) - offset) {
+            size = mRanges.valueAt(i) - offset;
+        }
+
+        size_t numBytesRead = 0;
+        while (numBytesRead < size) {
+            ssize_t n = pread64(
+                    mFd, (uint8_t *)data + numBytesRead, size - numBytesRead,
+                    offset + numBytesRead);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n <= 0) {
+                ALOGW("failed to read disk cache (%s)", n < 0 ? strerror(errno) : "eof");
+
+                // the data is gone, fetch it from the source again
+                mRanges.clear();
+                mIndexChanged = true;
+                return 0;
+            }
+            numBytesRead += n;
+        }
+
+        return numBytesRead;
+    }
+
+    return 0;
+}
+
+void DiskCache::write(off64_t offset, const void *data, size_t size) {
+    if (offset < 0 || offset + (off64_t)size > mSize) {
+        return;
+    }
+
+    size_t numBytesWritten = 0;
+    while (numBytesWritten < size) {
+        ssize_t n = pwrite64(
+                mFd, (const uint8_t *)data + numBytesWritten, size - numBytesWritten,
+                offset + numBytesWritten);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            ALOGW("failed to write disk cache (%s)", n < 0 ? strerror(errno) : "eof");
+            return;
+        }
+        numBytesWritten += n;
+    }
+
+    addRange(offset, offset + size);
+}
+
+void DiskCache::addRange(off64_t start, off64_t end) {
+    size_t i = 0;
+    while (i < mRanges.size()) {
+        if (mRanges.keyAt(i) > end || mRanges.valueAt(i) < start) {
+            ++i;
+            continue;
+        }
+
+        // the ranges overlap or touch, merge them
+        if (mRanges.keyAt(i) < start) {
+            start = mRanges.keyAt(i);
+        }
+        if (mRanges.valueAt(i) > end) {
+            end = mRanges.valueAt(i);
+        }
+        mRanges.removeItemsAt(i);
+    }
+
+    mRanges.add(start, end);
+    mIndexChanged = true;
+}
+
+void DiskCache::loadIndex() {
+    FILE *file = fopen(mIndexPath.string(), "re");
+    if (file == NULL) {
+        return;
+    }
+
+    struct stat st;
+    long long size;
+    if (fstat(mFd, &st) == 0 && fscanf(file, "%lld\n", &size) == 1 && size == mSize) {
+        long long start, end;
+        while (fscanf(file, "%lld %lld\n", &start, &end) == 2) {
+            if (start < 0 || start >= end || end > st.st_size) {
+                mRanges.clear();
+                break;
+            }
+            addRange(start, end);
+        }
+    }
+    fclose(file);
+
+    if (mRanges.isEmpty()) {
+        // the content changed or the index is corrupt
+        ftruncate(mFd, 0);
+    }
+    mIndexChanged = false;
+
+    ALOGV("loaded %zu ranges from disk cache %s", mRanges.size(), mIndexPath.string());
+}
+
+void DiskCache::saveIndex() {
+    String8 tmpPath = mIndexPath + ".tmp";
+    FILE *file = fopen(tmpPath.string(), "we");
+    if (file == NULL) {
+        ALOGW("failed to save disk cache index (%s)", strerror(errno));
+        return;
+    }
+
+    fprintf(file, "%lld\n", (long long)mSize);
+    for (size_t i = 0; i < mRanges.size(); ++i) {
+        fprintf(file, "%lld %lld\n", (long long)mRanges.keyAt(i), (long long)mRanges.valueAt(i));
+    }
+
+    // the data is written before the index refers to it
+    bool ok = fflush(file) == 0 && fdatasync(mFd) == 0 && fsync(fileno(file)) == 0;
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(tmpPath.string(), mIndexPath.string()) != 0) {
+        ALOGW("failed to save disk cache index (%s)", strerror(errno));
+        unlink(tmpPath.string());
     }
 }
 
@@ -188,6 +474,7 @@ NuCachedSource2::NuCachedSource2(
       mLooper(new ALooper),
       mCache(new PageCache(kPageSize)),
       mCacheOffset(0),
+      mDiskCache(NULL),
       mFinalStatus(OK),
       mLastAccessPos(0),
       mFetching(true),
@@ -214,6 +501,11 @@ NuCachedSource2::NuCachedSource2(
         mKeepAliveIntervalUs = 0;
     }
 
+    off64_t size;
+    if ((mSource->flags() & kIsHTTPBasedSource) && mSource->getSize(&size) == OK) {
+        mDiskCache = DiskCache::Open(mSource->getUri(), size);
+    }
+
     mLooper->setName("NuCachedSource2");
     mLooper->registerHandler(mReflector);
 
@@ -234,6 +526,14 @@ NuCachedSource2::~NuCachedSource2() {
 
     delete mCache;
     mCache = NULL;
+
+    for (size_t i = 0; i < mRetainedRanges.size(); ++i) {
+        delete mRetainedRanges.valueAt(i);
+    }
+    mRetainedRanges.clear();
+
+    delete mDiskCache;
+    mDiskCache = NULL;
 }
 
 // static
@@ -322,6 +622,7 @@ void NuCachedSource2::fetchInternal() {
     ALOGV("fetchInternal");
 
     bool reconnect = false;
+    off64_t fetchOffset;
 
     {
         Mutex::Autolock autoLock(mLock);
@@ -332,35 +633,55 @@ void NuCachedSource2::fetchInternal() {
 
             reconnect = true;
         }
+
+        {
+            RWLock::AutoWLock autoPagesLock(mPagesLock);
+            mergeRetainedRanges_l();
+        }
+        fetchOffset = mCacheOffset + mCache->totalSize();
     }
 
-    if (reconnect) {
-        status_t err =
-            mSource->reconnectAtOffset(mCacheOffset + mCache->totalSize());
+    // what the disk cache holds is not fetched again.
+    PageCache::Page *page = mCache->acquirePage();
+    ssize_t n = 0;
+    if (mDiskCache != NULL) {
+        n = mDiskCache->read(fetchOffset, page->mData, kPageSize);
+    }
+
+    if (n > 0) {
+        reconnect = false;
+    } else if (reconnect) {
+        status_t err = mSource->reconnectAtOffset(fetchOffset);
 
         Mutex::Autolock autoLock(mLock);
 
         if (mDisconnecting) {
             mNumRetriesLeft = 0;
             mFinalStatus = ERROR_END_OF_STREAM;
+            mCache->releasePage(page);
             return;
         } else if (err == ERROR_UNSUPPORTED || err == -EPIPE) {
             // These are errors that are not likely to go away even if we
             // retry, i.e. the server doesn't support range requests or similar.
             mNumRetriesLeft = 0;
+            mCache->releasePage(page);
             return;
         } else if (err != OK) {
             ALOGI("The attempt to reconnect failed, %d retries remaining",
                  mNumRetriesLeft);
 
+            mCache->releasePage(page);
             return;
         }
     }
 
-    PageCache::Page *page = mCache->acquirePage();
+    if (n == 0) {
+        n = mSource->readAt(fetchOffset, page->mData, kPageSize);
 
-    ssize_t n = mSource->readAt(
-            mCacheOffset + mCache->totalSize(), page->mData, kPageSize);
+        if (n > 0 && mDiskCache != NULL) {
+            mDiskCache->write(fetchOffset, page->mData, n);
+        }
+    }
 
     Mutex::Autolock autoLock(mLock);
 
@@ -389,6 +710,8 @@ void NuCachedSource2::fetchInternal() {
         mFinalStatus = OK;
 
         page->mSize = n;
+
+        RWLock::AutoWLock autoPagesLock(mPagesLock);
         mCache->appendPage(page);
     }
 }
@@ -504,8 +827,12 @@ void NuCachedSource2::restartPrefetcherIfNecessary_l(
         maxBytes -= kGrayArea;
     }
 
-    size_t actualBytes = mCache->releaseFromStart(maxBytes);
-    mCacheOffset += actualBytes;
+    {
+        RWLock::AutoWLock autoPagesLock(mPagesLock);
+
+        size_t actualBytes = mCache->releaseFromStart(maxBytes);
+        mCacheOffset += actualBytes;
+    }
 
     ALOGI("restarting prefetcher, totalSize = %zu", mCache->totalSize());
     mFetching = true;
@@ -516,21 +843,47 @@ ssize_t NuCachedSource2::readAt(off64_t offset, void *data, size_t size) {
 
     ALOGV("readAt offset %lld, size %zu", (long long)offset, size);
 
-    Mutex::Autolock autoLock(mLock);
-    if (mDisconnecting) {
-        return ERROR_END_OF_STREAM;
-    }
+    // If the request can be completely satisfied from the cache, do so. The
+    // pages are copied holding only the read side of mPagesLock, so that the
+    // fetcher does not wait for the copy, nor the read for the fetcher.
+    {
+        mLock.lock();
+        if (mDisconnecting) {
+            mLock.unlock();
+            return ERROR_END_OF_STREAM;
+        }
 
-    // If the request can be completely satisfied from the cache, do so.
+        const PageCache *cache = NULL;
+        size_t delta = 0;
+        if (offset >= mCacheOffset
+                && offset + size <= mCacheOffset + mCache->totalSize()) {
+            cache = mCache;
+            delta = offset - mCacheOffset;
 
-    if (offset >= mCacheOffset
-            && offset + size <= mCacheOffset + mCache->totalSize()) {
-        size_t delta = offset - mCacheOffset;
-        mCache->copy(delta, data, size);
+            mLastAccessPos = offset + size;
+        } else {
+            ssize_t index = findRetainedRange_l(offset, size);
+            if (index >= 0) {
+                cache = mRetainedRanges.valueAt(index);
+                delta = offset - mRetainedRanges.keyAt(index);
+            }
+        }
 
-        mLastAccessPos = offset + size;
+        if (cache != NULL) {
+            mPagesLock.readLock();
+            mLock.unlock();
 
-        return size;
+            cache->copy(delta, data, size);
+            mPagesLock.unlock();
+
+            return size;
+        }
+        mLock.unlock();
+    }
+
+    Mutex::Autolock autoLock(mLock);
+    if (mDisconnecting) {
+        return ERROR_END_OF_STREAM;
     }
 
     sp<AMessage> msg = new AMessage(kWhatRead, mReflector);
@@ -601,13 +954,16 @@ ssize_t NuCachedSource2::readInternal(off64_t offset, void *data, size_t size) {
         return ERROR_END_OF_STREAM;
     }
 
-    if (!mFetching) {
-        mLastAccessPos = offset;
-        restartPrefetcherIfNecessary_l(
-                false, // ignoreLowWaterThreshold
-                true); // force
+    ssize_t index = findRetainedRange_l(offset, size);
+    if (index >= 0) {
+        mRetainedRanges.valueAt(index)->copy(
+                offset - mRetainedRanges.keyAt(index), data, size);
+
+        return size;
     }
 
+    // Seek before restarting the prefetcher, which would release the cache
+    // before the offset rather than retain it.
     if (offset < mCacheOffset
             || offset >= (off64_t)(mCacheOffset + mCache->totalSize())) {
         static const off64_t kPadding = 256 * 1024;
@@ -621,6 +977,13 @@ ssize_t NuCachedSource2::readInternal(off64_t offset, void *data, size_t size) {
         seekInternal_l(seekOffset);
     }
 
+    if (!mFetching) {
+        mLastAccessPos = offset;
+        restartPrefetcherIfNecessary_l(
+                false, // ignoreLowWaterThreshold
+                true); // force
+    }
+
     size_t delta = offset - mCacheOffset;
 
     if (mFinalStatus != OK && mNumRetriesLeft == 0) {
@@ -660,17 +1023,119 @@ status_t NuCachedSource2::seekInternal_l(off64_t offset) {
 
     ALOGI("new range: offset= %lld", (long long)offset);
 
-    mCacheOffset = offset;
+    RWLock::AutoWLock autoPagesLock(mPagesLock);
+
+    // keep what was cached, the range may be read again
+    if (mCache->totalSize() > 0) {
+        ssize_t index = mRetainedRanges.indexOfKey(mCacheOffset);
+        if (index >= 0) {
+            delete mRetainedRanges.valueAt(index);
+            mRetainedRanges.removeItemsAt(index);
+        }
+        mRetainedRanges.add(mCacheOffset, mCache);
+        mCache = new PageCache(kPageSize);
+    }
 
-    size_t totalSize = mCache->totalSize();
-    CHECK_EQ(mCache->releaseFromStart(totalSize), totalSize);
+    ssize_t index = findRetainedRange_l(offset, 0);
+    if (index >= 0) {
+        // go on fetching where the range ends
+        ALOGI("resuming cached range at offset %lld", (long long)mRetainedRanges.keyAt(index));
 
+        delete mCache;
+        mCacheOffset = mRetainedRanges.keyAt(index);
+        mCache = mRetainedRanges.valueAt(index);
+        mRetainedRanges.removeItemsAt(index);
+    } else {
+        mCacheOffset = offset;
+    }
+
+    evictRetainedRanges_l();
+
+    // reaching the end of the previous range says nothing about this one
+    if (mFinalStatus == ERROR_END_OF_STREAM) {
+        mFinalStatus = OK;
+    }
     mNumRetriesLeft = kMaxNumRetries;
     mFetching = true;
 
     return OK;
 }
 
+ssize_t NuCachedSource2::findRetainedRange_l(off64_t offset, size_t size) const {
+    for (size_t i = 0; i < mRetainedRanges.size(); ++i) {
+        off64_t start = mRetainedRanges.keyAt(i);
+        off64_t end = start + mRetainedRanges.valueAt(i)->totalSize();
+        if (offset >= start && offset + (off64_t)size <= end) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void NuCachedSource2::evictRetainedRanges_l() {
+    size_t maxBytes = mHighwaterThresholdBytes / 2;
+
+    size_t totalSize = 0;
+    for (size_t i = 0; i < mRetainedRanges.size(); ++i) {
+        totalSize += mRetainedRanges.valueAt(i)->totalSize();
+    }
+
+    while (totalSize > maxBytes) {
+        // release from the range farthest from where the cache is read
+        size_t farthest = 0;
+        off64_t farthestDistance = -1;
+        for (size_t i = 0; i < mRetainedRanges.size(); ++i) {
+            off64_t start = mRetainedRanges.keyAt(i);
+            off64_t distance = (start > mLastAccessPos)
+                    ? start - mLastAccessPos : mLastAccessPos - start;
+            if (distance > farthestDistance) {
+                farthest = i;
+                farthestDistance = distance;
+            }
+        }
+
+        // The start of a range is where it was read, release from its end, at
+        // least a page.
+        PageCache *cache = mRetainedRanges.valueAt(farthest);
+        totalSize -= cache->releaseFromEnd(totalSize - maxBytes + kPageSize - 1);
+        if (cache->totalSize() == 0) {
+            delete cache;
+            mRetainedRanges.removeItemsAt(farthest);
+        }
+    }
+}
+
+void NuCachedSource2::mergeRetainedRanges_l() {
+    off64_t end = mCacheOffset + mCache->totalSize();
+
+    size_t i = 0;
+    while (i < mRetainedRanges.size()) {
+        off64_t start = mRetainedRanges.keyAt(i);
+        PageCache *cache = mRetainedRanges.valueAt(i);
+        off64_t rangeEnd = start + cache->totalSize();
+
+        if (start < mCacheOffset || start > end) {
+            ++i;
+            continue;
+        }
+
+        if (rangeEnd > end) {
+            // the fetch continues after the range
+            ALOGV("merging cached range %lld-%lld", (long long)start, (long long)rangeEnd);
+
+            cache->trimStart(end - start);
+            mCache->appendPages(cache);
+            end = rangeEnd;
+        }
+
+        delete cache;
+        mRetainedRanges.removeItemsAt(i);
+
+        // an earlier range may follow the merged one
+        i = 0;
+    }
+}
+
 void NuCachedSource2::resumeFetchingIfNecessary() {
     Mutex::Autolock autoLock(mLock);
 
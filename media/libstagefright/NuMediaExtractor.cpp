@@ -26,6 +26,8 @@
 
 #include <media/stagefright/foundation/ABuffer.h>
 #include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/AHandler.h>
+#include <media/stagefright/foundation/ALooper.h>
 #include <media/stagefright/foundation/AMessage.h>
 #include <media/stagefright/DataSource.h>
 #include <media/stagefright/FileSource.h>
@@ -36,22 +38,213 @@
 #include <media/stagefright/MediaSource.h>
 #include <media/stagefright/MetaData.h>
 #include <media/stagefright/Utils.h>
+#include <utils/List.h>
 
 namespace android {
 
+// Reads the samples of a track ahead on a looper of its own. The samples are copied out of the
+// source's buffers, since a source may only have a few of those to hand out at a time.
+struct NuMediaExtractor::TrackReader : public AHandler {
+    TrackReader(const sp<IMediaSource> &source, size_t maxQueuedSamples);
+
+    void start();
+    void stop();
+
+    // Returns the next sample read ahead, waiting for it if needed. Seeking (seekTimeUs >= 0)
+    // drops the samples read ahead of the seek.
+    status_t read(
+            MediaBuffer **buffer, sp<MetaData> *meta,
+            int64_t seekTimeUs, MediaSource::ReadOptions::SeekMode mode);
+
+protected:
+    virtual ~TrackReader();
+    virtual void onMessageReceived(const sp<AMessage> &msg);
+
+private:
+    enum {
+        kWhatPull = 'pull',
+    };
+
+    struct Sample {
+        MediaBuffer *mBuffer;
+        sp<MetaData> mMeta;
+    };
+
+    sp<IMediaSource> mSource;
+    size_t mMaxQueuedSamples;
+    sp<ALooper> mLooper;
+
+    Mutex mLock;
+    Condition mCondition;
+    List<Sample> mSamples;
+    status_t mFinalResult;
+    bool mPulling;  // a pull is posted or in progress
+    bool mStopping;
+    // bumped by each seek, to drop the samples of a pull started before it
+    int32_t mGeneration;
+    int64_t mSeekTimeUs;
+    MediaSource::ReadOptions::SeekMode mSeekMode;
+
+    void flush_l();
+    void schedulePull_l();
+
+    DISALLOW_EVIL_CONSTRUCTORS(TrackReader);
+};
+
+NuMediaExtractor::TrackReader::TrackReader(
+        const sp<IMediaSource> &source, size_t maxQueuedSamples)
+    : mSource(source),
+      mMaxQueuedSamples(maxQueuedSamples),
+      mLooper(new ALooper),
+      mFinalResult(OK),
+      mPulling(false),
+      mStopping(false),
+      mGeneration(0),
+      mSeekTimeUs(-1ll),
+      mSeekMode(MediaSource::ReadOptions::SEEK_CLOSEST_SYNC) {
+    mLooper->setName("extractor_reader");
+}
+
+NuMediaExtractor::TrackReader::~TrackReader() {
+    flush_l();
+}
+
+void NuMediaExtractor::TrackReader::start() {
+    mLooper->start();
+    mLooper->registerHandler(this);
+
+    Mutex::Autolock autoLock(mLock);
+    schedulePull_l();
+}
+
+void NuMediaExtractor::TrackReader::stop() {
+    {
+        Mutex::Autolock autoLock(mLock);
+        mStopping = true;
+        flush_l();
+    }
+
+    // waits for a read in progress
+    mLooper->stop();
+    mLooper->unregisterHandler(id());
+}
+
+status_t NuMediaExtractor::TrackReader::read(
+        MediaBuffer **buffer, sp<MetaData> *meta,
+        int64_t seekTimeUs, MediaSource::ReadOptions::SeekMode mode) {
+    *buffer = NULL;
+
+    Mutex::Autolock autoLock(mLock);
+    if (seekTimeUs >= 0ll) {
+        flush_l();
+        ++mGeneration;
+        mSeekTimeUs = seekTimeUs;
+        mSeekMode = mode;
+        mFinalResult = OK;
+    }
+
+    schedulePull_l();
+    while (mSamples.empty() && mFinalResult == OK) {
+        mCondition.wait(mLock);
+    }
+
+    if (mSamples.empty()) {
+        return mFinalResult;
+    }
+
+    *buffer = mSamples.begin()->mBuffer;
+    *meta = mSamples.begin()->mMeta;
+    mSamples.erase(mSamples.begin());
+
+    schedulePull_l();
+    return OK;
+}
+
+void NuMediaExtractor::TrackReader::flush_l() {
+    for (List<Sample>::iterator it = mSamples.begin(); it != mSamples.end(); ++it) {
+        it->mBuffer->release();
+    }
+    mSamples.clear();
+}
+
+void NuMediaExtractor::TrackReader::schedulePull_l() {
+    if (mPulling || mStopping || mFinalResult != OK
+            || mSamples.size() >= mMaxQueuedSamples) {
+        return;
+    }
+    mPulling = true;
+    (new AMessage(kWhatPull, this))->post();
+}
+
+void NuMediaExtractor::TrackReader::onMessageReceived(const sp<AMessage> &msg) {
+    switch (msg->what()) {
+        case kWhatPull:
+        {
+            MediaSource::ReadOptions options;
+            int32_t generation;
+            {
+                Mutex::Autolock autoLock(mLock);
+                if (mStopping) {
+                    mPulling = false;
+                    break;
+                }
+                generation = mGeneration;
+                if (mSeekTimeUs >= 0ll) {
+                    options.setSeekTo(mSeekTimeUs, mSeekMode);
+                    mSeekTimeUs = -1ll;
+                }
+            }
+
+            MediaBuffer *mbuf = NULL;
+            status_t err = mSource->read(&mbuf, &options);
+
+            Sample sample;
+            sample.mBuffer = NULL;
+            if (err == OK) {
+                sp<ABuffer> data = new ABuffer(mbuf->range_length());
+                memcpy(data->data(),
+                        (const uint8_t *)mbuf->data() + mbuf->range_offset(),
+                        mbuf->range_length());
+                sample.mBuffer = new MediaBuffer(data);
+                sample.mMeta = new MetaData(*mbuf->meta_data());
+                mbuf->release();
+            } else {
+                CHECK(mbuf == NULL);
+            }
+
+            Mutex::Autolock autoLock(mLock);
+            mPulling = false;
+            if (generation != mGeneration || mStopping) {
+                if (sample.mBuffer != NULL) {
+                    sample.mBuffer->release();
+                }
+            } else if (err != OK) {
+                mFinalResult = err;
+            } else {
+                mSamples.push_back(sample);
+            }
+            mCondition.signal();
+            schedulePull_l();
+            break;
+        }
+
+        default:
+            TRESPASS();
+    }
+}
+
 NuMediaExtractor::NuMediaExtractor()
     : mIsWidevineExtractor(false),
       mTotalBitrate(-1ll),
-      mDurationUs(-1ll) {
+      mDurationUs(-1ll),
+      mMaxQueuedSamples(0) {
 }
 
 NuMediaExtractor::~NuMediaExtractor() {
     releaseTrackSamples();
 
     for (size_t i = 0; i < mSelectedTracks.size(); ++i) {
-        TrackInfo *info = &mSelectedTracks.editItemAt(i);
-
-        CHECK_EQ((status_t)OK, info->mSource->stop());
+        stopTrack(&mSelectedTracks.editItemAt(i));
     }
 
     mSelectedTracks.clear();
@@ -283,6 +476,17 @@ status_t NuMediaExtractor::getFileFormat(sp<AMessage> *format) const {
     return OK;
 }
 
+status_t NuMediaExtractor::setPrefetching(size_t maxQueuedSamples) {
+    Mutex::Autolock autoLock(mLock);
+
+    if (!mSelectedTracks.isEmpty()) {
+        return INVALID_OPERATION;
+    }
+
+    mMaxQueuedSamples = maxQueuedSamples;
+    return OK;
+}
+
 status_t NuMediaExtractor::selectTrack(size_t index) {
     Mutex::Autolock autoLock(mLock);
 
@@ -327,6 +531,11 @@ status_t NuMediaExtractor::selectTrack(size_t index) {
         info->mTrackFlags |= kIsVorbis;
     }
 
+    if (mMaxQueuedSamples > 0) {
+        info->mReader = new TrackReader(source, mMaxQueuedSamples);
+        info->mReader->start();
+    }
+
     return OK;
 }
 
@@ -357,14 +566,8 @@ status_t NuMediaExtractor::unselectTrack(size_t index) {
 
     TrackInfo *info = &mSelectedTracks.editItemAt(i);
 
-    if (info->mSample != NULL) {
-        info->mSample->release();
-        info->mSample = NULL;
-
-        info->mSampleTimeUs = -1ll;
-    }
-
-    CHECK_EQ((status_t)OK, info->mSource->stop());
+    releaseTrackSample(info);
+    stopTrack(info);
 
     mSelectedTracks.removeAt(i);
 
@@ -373,15 +576,28 @@ status_t NuMediaExtractor::unselectTrack(size_t index) {
 
 void NuMediaExtractor::releaseTrackSamples() {
     for (size_t i = 0; i < mSelectedTracks.size(); ++i) {
-        TrackInfo *info = &mSelectedTracks.editItemAt(i);
+        releaseTrackSample(&mSelectedTracks.editItemAt(i));
+    }
+}
 
-        if (info->mSample != NULL) {
-            info->mSample->release();
-            info->mSample = NULL;
+void NuMediaExtractor::releaseTrackSample(TrackInfo *info) {
+    if (info->mSample != NULL) {
+        info->mSample->release();
+        info->mSample = NULL;
+        info->mSampleMeta.clear();
 
-            info->mSampleTimeUs = -1ll;
-        }
+        info->mSampleTimeUs = -1ll;
+    }
+}
+
+void NuMediaExtractor::stopTrack(TrackInfo *info) {
+    if (info->mReader != NULL) {
+        // the reader must be done with the source before it is stopped
+        info->mReader->stop();
+        info->mReader.clear();
     }
+
+    CHECK_EQ((status_t)OK, info->mSource->stop());
 }
 
 ssize_t NuMediaExtractor::fetchTrackSamples(
@@ -395,21 +611,26 @@ ssize_t NuMediaExtractor::fetchTrackSamples(
         if (seekTimeUs >= 0ll) {
             info->mFinalResult = OK;
 
-            if (info->mSample != NULL) {
-                info->mSample->release();
-                info->mSample = NULL;
-                info->mSampleTimeUs = -1ll;
-            }
+            releaseTrackSample(info);
         } else if (info->mFinalResult != OK) {
             continue;
         }
 
         if (info->mSample == NULL) {
-            MediaSource::ReadOptions options;
-            if (seekTimeUs >= 0ll) {
-                options.setSeekTo(seekTimeUs, mode);
+            status_t err;
+            if (info->mReader != NULL) {
+                err = info->mReader->read(
+                        &info->mSample, &info->mSampleMeta, seekTimeUs, mode);
+            } else {
+                MediaSource::ReadOptions options;
+                if (seekTimeUs >= 0ll) {
+                    options.setSeekTo(seekTimeUs, mode);
+                }
+                err = info->mSource->read(&info->mSample, &options);
+                if (err == OK) {
+                    info->mSampleMeta = info->mSample->meta_data();
+                }
             }
-            status_t err = info->mSource->read(&info->mSample, &options);
 
             if (err != OK) {
                 CHECK(info->mSample == NULL);
@@ -425,8 +646,7 @@ ssize_t NuMediaExtractor::fetchTrackSamples(
                 continue;
             } else {
                 CHECK(info->mSample != NULL);
-                CHECK(info->mSample->meta_data()->findInt64(
-                            kKeyTime, &info->mSampleTimeUs));
+                CHECK(info->mSampleMeta->findInt64(kKeyTime, &info->mSampleTimeUs));
             }
         }
 
@@ -461,30 +681,26 @@ status_t NuMediaExtractor::advance() {
         return ERROR_END_OF_STREAM;
     }
 
-    TrackInfo *info = &mSelectedTracks.editItemAt(minIndex);
-
-    info->mSample->release();
-    info->mSample = NULL;
-    info->mSampleTimeUs = -1ll;
+    releaseTrackSample(&mSelectedTracks.editItemAt(minIndex));
 
     return OK;
 }
 
-status_t NuMediaExtractor::appendVorbisNumPageSamples(TrackInfo *info, const sp<ABuffer> &buffer) {
+status_t NuMediaExtractor::appendVorbisNumPageSamples(TrackInfo *info, uint8_t *sampleData) {
     int32_t numPageSamples;
-    if (!info->mSample->meta_data()->findInt32(
+    if (!info->mSampleMeta->findInt32(
             kKeyValidSamples, &numPageSamples)) {
         numPageSamples = -1;
     }
 
-    memcpy((uint8_t *)buffer->data() + info->mSample->range_length(),
+    memcpy(sampleData + info->mSample->range_length(),
            &numPageSamples,
            sizeof(numPageSamples));
 
     uint32_t type;
     const void *data;
     size_t size, size2;
-    if (info->mSample->meta_data()->findData(kKeyEncryptedSizes, &type, &data, &size)) {
+    if (info->mSampleMeta->findData(kKeyEncryptedSizes, &type, &data, &size)) {
         // Signal numPageSamples (a plain int32_t) is appended at the end,
         // i.e. sizeof(numPageSamples) plain bytes + 0 encrypted bytes
         if (SIZE_MAX - size < sizeof(int32_t)) {
@@ -502,9 +718,9 @@ status_t NuMediaExtractor::appendVorbisNumPageSamples(TrackInfo *info, const sp<
         int32_t zero = 0;
         memcpy(adata, data, size);
         memcpy(adata + size, &zero, sizeof(zero));
-        info->mSample->meta_data()->setData(kKeyEncryptedSizes, type, adata, newSize);
+        info->mSampleMeta->setData(kKeyEncryptedSizes, type, adata, newSize);
 
-        if (info->mSample->meta_data()->findData(kKeyPlainSizes, &type, &data, &size2)) {
+        if (info->mSampleMeta->findData(kKeyPlainSizes, &type, &data, &size2)) {
             if (size2 != size) {
                 return ERROR_MALFORMED;
             }
@@ -517,32 +733,23 @@ status_t NuMediaExtractor::appendVorbisNumPageSamples(TrackInfo *info, const sp<
         // append sizeof(numPageSamples) to plain sizes.
         int32_t int32Size = sizeof(numPageSamples);
         memcpy(adata + size, &int32Size, sizeof(int32Size));
-        info->mSample->meta_data()->setData(kKeyPlainSizes, type, adata, newSize);
+        info->mSampleMeta->setData(kKeyPlainSizes, type, adata, newSize);
     }
 
     return OK;
 }
 
-status_t NuMediaExtractor::readSampleData(const sp<ABuffer> &buffer) {
-    Mutex::Autolock autoLock(mLock);
-
-    ssize_t minIndex = fetchTrackSamples();
-
-    if (minIndex < 0) {
-        return ERROR_END_OF_STREAM;
-    }
-
-    TrackInfo *info = &mSelectedTracks.editItemAt(minIndex);
-
-    size_t sampleSize = info->mSample->range_length();
+status_t NuMediaExtractor::copySampleData(
+        TrackInfo *info, uint8_t *data, size_t capacity, size_t *sampleSize) {
+    *sampleSize = info->mSample->range_length();
 
     if (info->mTrackFlags & kIsVorbis) {
         // Each sample's data is suffixed by the number of page samples
         // or -1 if not available.
-        sampleSize += sizeof(int32_t);
+        *sampleSize += sizeof(int32_t);
     }
 
-    if (buffer->capacity() < sampleSize) {
+    if (capacity < *sampleSize) {
         return -ENOMEM;
     }
 
@@ -550,13 +757,31 @@ status_t NuMediaExtractor::readSampleData(const sp<ABuffer> &buffer) {
         (const uint8_t *)info->mSample->data()
             + info->mSample->range_offset();
 
-    memcpy((uint8_t *)buffer->data(), src, info->mSample->range_length());
+    memcpy(data, src, info->mSample->range_length());
 
     status_t err = OK;
     if (info->mTrackFlags & kIsVorbis) {
-        err = appendVorbisNumPageSamples(info, buffer);
+        err = appendVorbisNumPageSamples(info, data);
     }
 
+    return err;
+}
+
+status_t NuMediaExtractor::readSampleData(const sp<ABuffer> &buffer) {
+    Mutex::Autolock autoLock(mLock);
+
+    ssize_t minIndex = fetchTrackSamples();
+
+    if (minIndex < 0) {
+        return ERROR_END_OF_STREAM;
+    }
+
+    TrackInfo *info = &mSelectedTracks.editItemAt(minIndex);
+
+    size_t sampleSize;
+    status_t err = copySampleData(
+            info, (uint8_t *)buffer->data(), buffer->capacity(), &sampleSize);
+
     if (err == OK) {
         buffer->setRange(0, sampleSize);
     }
@@ -564,6 +789,63 @@ status_t NuMediaExtractor::readSampleData(const sp<ABuffer> &buffer) {
     return err;
 }
 
+status_t NuMediaExtractor::readSampleDataBatch(
+        const sp<ABuffer> &buffer, size_t maxSamples, Vector<SampleInfo> *samples) {
+    Mutex::Autolock autoLock(mLock);
+
+    samples->clear();
+    buffer->setRange(0, 0);
+
+    size_t offset = 0;
+    while (samples->size() < maxSamples) {
+        ssize_t minIndex = fetchTrackSamples();
+
+        if (minIndex < 0) {
+            break;
+        }
+
+        TrackInfo *info = &mSelectedTracks.editItemAt(minIndex);
+
+        size_t sampleSize;
+        status_t err = copySampleData(
+                info, (uint8_t *)buffer->data() + offset, buffer->capacity() - offset,
+                &sampleSize);
+
+        if (err == -ENOMEM && !samples->isEmpty()) {
+            break;
+        } else if (err != OK) {
+            return err;
+        }
+
+        SampleInfo sample;
+        sample.mTrackIndex = info->mTrackIndex;
+        sample.mTimeUs = info->mSampleTimeUs;
+        sample.mFlags = 0;
+        sample.mOffset = offset;
+        sample.mSize = sampleSize;
+
+        int32_t isSync;
+        if (info->mSampleMeta->findInt32(kKeyIsSyncFrame, &isSync) && isSync != 0) {
+            sample.mFlags |= SAMPLE_FLAG_SYNC;
+        }
+
+        uint32_t type;
+        const void *data;
+        size_t size;
+        if (info->mSampleMeta->findData(kKeyEncryptedSizes, &type, &data, &size)) {
+            sample.mFlags |= SAMPLE_FLAG_ENCRYPTED;
+        }
+
+        samples->push(sample);
+        offset += sampleSize;
+        buffer->setRange(0, offset);
+
+        releaseTrackSample(info);
+    }
+
+    return samples->isEmpty() ? ERROR_END_OF_STREAM : OK;
+}
+
 status_t NuMediaExtractor::getSampleTrackIndex(size_t *trackIndex) {
     Mutex::Autolock autoLock(mLock);
 
@@ -606,7 +888,7 @@ status_t NuMediaExtractor::getSampleMeta(sp<MetaData> *sampleMeta) {
     }
 
     TrackInfo *info = &mSelectedTracks.editItemAt(minIndex);
-    *sampleMeta = info->mSample->meta_data();
+    *sampleMeta = info->mSampleMeta;
 
     return OK;
 }
@@ -103,6 +103,10 @@ struct MuxOMX : public IOMX {
             node_id node, OMX_U32 port_index, const sp<IMemory> &params,
             buffer_id *buffer, OMX_U32 allottedSize);
 
+    virtual status_t useBuffers(
+            node_id node, OMX_U32 port_index, const Vector<sp<IMemory> > &params,
+            Vector<buffer_id> *buffers, OMX_U32 allottedSize);
+
     virtual status_t useGraphicBuffer(
             node_id node, OMX_U32 port_index,
             const sp<GraphicBuffer> &graphicBuffer, buffer_id *buffer);
@@ -389,6 +393,12 @@ status_t MuxOMX::useBuffer(
     return getOMX(node)->useBuffer(node, port_index, params, buffer, allottedSize);
 }
 
+status_t MuxOMX::useBuffers(
+        node_id node, OMX_U32 port_index, const Vector<sp<IMemory> > &params,
+        Vector<buffer_id> *buffers, OMX_U32 allottedSize) {
+    return getOMX(node)->useBuffers(node, port_index, params, buffers, allottedSize);
+}
+
 status_t MuxOMX::useGraphicBuffer(
         node_id node, OMX_U32 port_index,
         const sp<GraphicBuffer> &graphicBuffer, buffer_id *buffer) {
@@ -105,6 +105,11 @@ protected:
         int64_t mTimeUs;
     };
 
+    enum {
+        kMaxNumPageIndexEntries = 8192 / sizeof(TOCEntry),
+    };
+    static const int64_t kMinPageIndexSpacingUs = 1000000ll;
+
     sp<DataSource> mSource;
     off64_t mOffset;
     Page mCurrentPage;
@@ -129,6 +134,11 @@ protected:
 
     Vector<TOCEntry> mTableOfContents;
 
+    // Pages seen during playback when there is no table of contents, by increasing
+    // offset and at least mPageIndexSpacingUs apart.
+    Vector<TOCEntry> mPageIndex;
+    int64_t mPageIndexSpacingUs;
+
     ssize_t readPage(off64_t offset, Page *page);
     status_t findNextPage(off64_t startOffset, off64_t *pageOffset);
 
@@ -159,6 +169,9 @@ protected:
 
     void buildTableOfContents();
 
+    void addToPageIndex(off64_t pageOffset, uint64_t granulePos);
+    status_t findPageIndexOffset(int64_t timeUs, off64_t *offset);
+
     MyOggExtractor(const MyOggExtractor &);
     MyOggExtractor &operator=(const MyOggExtractor &);
 };
@@ -309,7 +322,8 @@ MyOggExtractor::MyOggExtractor(
       mMimeType(mimeType),
       mNumHeaders(numHeaders),
       mSeekPreRollUs(seekPreRollUs),
-      mFirstDataOffset(-1) {
+      mFirstDataOffset(-1),
+      mPageIndexSpacingUs(kMinPageIndexSpacingUs) {
     mCurrentPage.mNumSegments = 0;
 
     vorbis_info_init(&mVi);
@@ -325,13 +339,41 @@ sp<MetaData> MyOggExtractor::getFormat() const {
     return mMeta;
 }
 
+// Returns the index of the first "OggS" capture pattern in data, or -1. The bytes are
+// tested a 64-bit word at a time for an 'O', and the pattern is only compared where
+// one may be.
+static ssize_t findCapturePattern(const uint8_t *data, size_t size) {
+    static const uint64_t kOnes = 0x0101010101010101ull;
+    static const uint64_t kHighBits = 0x8080808080808080ull;
+    static const uint64_t kOs = kOnes * 'O';
+
+    size_t i = 0;
+    while (i + 4 <= size) {
+        if (i + 8 <= size) {
+            uint64_t word;
+            memcpy(&word, &data[i], sizeof(word));
+            word ^= kOs;
+            if (((word - kOnes) & ~word & kHighBits) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+        if (data[i] == 'O' && !memcmp(&data[i], "OggS", 4)) {
+            return i;
+        }
+        ++i;
+    }
+    return -1;
+}
+
 status_t MyOggExtractor::findNextPage(
         off64_t startOffset, off64_t *pageOffset) {
-    *pageOffset = startOffset;
+    static const size_t kScanSize = 4096;
 
+    uint8_t buffer[kScanSize];
+    off64_t offset = startOffset;
     for (;;) {
-        char signature[4];
-        ssize_t n = mSource->readAt(*pageOffset, &signature, 4);
+        ssize_t n = mSource->readAt(offset, buffer, sizeof(buffer));
 
         if (n < 4) {
             *pageOffset = 0;
@@ -339,7 +381,9 @@ status_t MyOggExtractor::findNextPage(
             return (n < 0) ? n : (status_t)ERROR_END_OF_STREAM;
         }
 
-        if (!memcmp(signature, "OggS", 4)) {
+        ssize_t index = findCapturePattern(buffer, n);
+        if (index >= 0) {
+            *pageOffset = offset + index;
             if (*pageOffset > startOffset) {
                 ALOGV("skipped %lld bytes of junk to reach next frame",
                      (long long)(*pageOffset - startOffset));
@@ -348,7 +392,8 @@ status_t MyOggExtractor::findNextPage(
             return OK;
         }
 
-        ++*pageOffset;
+        // The pattern may straddle the end of the buffer.
+        offset += n - 3;
     }
 }
 
@@ -417,6 +462,13 @@ status_t MyOggExtractor::seekToTime(int64_t timeUs) {
     }
 
     if (mTableOfContents.isEmpty()) {
+        off64_t pos;
+        if (findPageIndexOffset(timeUs, &pos) == OK) {
+            ALOGV("seeking to offset %lld using %zu indexed pages",
+                    (long long)pos, mPageIndex.size());
+            return seekToOffset(pos);
+        }
+
         // Perform approximate seeking based on avg. bitrate.
         uint64_t bps = approxBitrate();
         if (bps <= 0) {
@@ -786,6 +838,10 @@ status_t MyOggExtractor::_readNextPacket(MediaBuffer **out, bool calcVorbisTimes
 
         mPrevGranulePosition = mCurrentPage.mGranulePosition;
 
+        if (mTableOfContents.isEmpty()) {
+            addToPageIndex(mOffset, mCurrentPage.mGranulePosition);
+        }
+
         mCurrentPageSize = n;
         mNextLaceIndex = 0;
 
@@ -892,6 +948,78 @@ void MyOggExtractor::buildTableOfContents() {
     }
 }
 
+void MyOggExtractor::addToPageIndex(off64_t pageOffset, uint64_t granulePos) {
+    if (mFirstDataOffset < 0 || pageOffset < mFirstDataOffset || granulePos == (uint64_t)-1) {
+        // a header page, or no packet ends on this page
+        return;
+    }
+
+    // Entries are usually appended, but seeks may land anywhere before the last one.
+    size_t index = mPageIndex.size();
+    while (index > 0 && mPageIndex.itemAt(index - 1).mPageOffset >= pageOffset) {
+        --index;
+    }
+
+    int64_t timeUs = getTimeUsOfGranule(granulePos);
+    if ((index > 0
+                && timeUs < mPageIndex.itemAt(index - 1).mTimeUs + mPageIndexSpacingUs)
+            || (index < mPageIndex.size()
+                && timeUs > mPageIndex.itemAt(index).mTimeUs - mPageIndexSpacingUs)) {
+        return;
+    }
+
+    TOCEntry entry;
+    entry.mPageOffset = pageOffset;
+    entry.mTimeUs = timeUs;
+    mPageIndex.insertAt(entry, index);
+
+    if (mPageIndex.size() >= kMaxNumPageIndexEntries) {
+        // Keep every other entry and halve the density of those to come.
+        for (size_t i = 1; i < mPageIndex.size(); ++i) {
+            mPageIndex.removeAt(i);
+        }
+        mPageIndexSpacingUs *= 2;
+    }
+}
+
+// Interpolates the offset of the page holding timeUs between the indexed pages around it,
+// or extrapolates it from the last one using the average bitrate.
+status_t MyOggExtractor::findPageIndexOffset(int64_t timeUs, off64_t *offset) {
+    if (mPageIndex.isEmpty()) {
+        return NAME_NOT_FOUND;
+    }
+
+    size_t index = 0;
+    while (index < mPageIndex.size() && mPageIndex.itemAt(index).mTimeUs < timeUs) {
+        ++index;
+    }
+
+    if (index == mPageIndex.size()) {
+        const TOCEntry &last = mPageIndex.itemAt(index - 1);
+        uint64_t bps = approxBitrate();
+        if (bps <= 0) {
+            return INVALID_OPERATION;
+        }
+        *offset = last.mPageOffset + (timeUs - last.mTimeUs) * bps / 8000000ll;
+        return OK;
+    }
+
+    const TOCEntry &next = mPageIndex.itemAt(index);
+    off64_t prevOffset = mFirstDataOffset;
+    int64_t prevTimeUs = 0;
+    if (index > 0) {
+        prevOffset = mPageIndex.itemAt(index - 1).mPageOffset;
+        prevTimeUs = mPageIndex.itemAt(index - 1).mTimeUs;
+    }
+    if (next.mTimeUs <= prevTimeUs || timeUs <= prevTimeUs) {
+        *offset = prevOffset;
+        return OK;
+    }
+    *offset = prevOffset + (off64_t)((double)(next.mPageOffset - prevOffset)
+            * (timeUs - prevTimeUs) / (next.mTimeUs - prevTimeUs));
+    return OK;
+}
+
 int32_t MyOggExtractor::getPacketBlockSize(MediaBuffer *buffer) {
     const uint8_t *data =
         (const uint8_t *)buffer->data() + buffer->range_offset();
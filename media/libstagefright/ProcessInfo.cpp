@@ -26,6 +26,9 @@
 
 namespace android {
 
+static const int32_t INVALID_ADJ = -10000;
+static const int32_t NATIVE_ADJ = -1000;
+
 ProcessInfo::ProcessInfo() {}
 
 bool ProcessInfo::getPriority(int pid, int* priority) {
@@ -34,8 +37,6 @@ bool ProcessInfo::getPriority(int pid, int* priority) {
 
     size_t length = 1;
     int32_t state;
-    static const int32_t INVALID_ADJ = -10000;
-    static const int32_t NATIVE_ADJ = -1000;
     int32_t score = INVALID_ADJ;
     status_t err = service->getProcessStatesAndOomScoresFromPids(length, &pid, &state, &score);
     if (err != OK) {
@@ -53,6 +54,42 @@ bool ProcessInfo::getPriority(int pid, int* priority) {
     return true;
 }
 
+bool ProcessInfo::getPriorities(const Vector<int>& pids, Vector<int>* priorities) {
+    priorities->clear();
+    if (pids.isEmpty()) {
+        return true;
+    }
+
+    sp<IBinder> binder = defaultServiceManager()->getService(String16("processinfo"));
+    sp<IProcessInfoService> service = interface_cast<IProcessInfoService>(binder);
+
+    // one call to the service for all the pids
+    size_t length = pids.size();
+    Vector<int32_t> states;
+    Vector<int32_t> scores;
+    states.insertAt(0, (size_t)0, length);
+    scores.insertAt(INVALID_ADJ, (size_t)0, length);
+    status_t err = service->getProcessStatesAndOomScoresFromPids(
+            length, const_cast<int32_t*>(pids.array()), states.editArray(),
+            scores.editArray());
+    if (err != OK) {
+        ALOGE("getProcessStatesAndOomScoresFromPids failed");
+        return false;
+    }
+
+    priorities->setCapacity(length);
+    for (size_t i = 0; i < length; ++i) {
+        ALOGV("pid %d state %d score %d", pids[i], states[i], scores[i]);
+        if (scores[i] <= NATIVE_ADJ) {
+            ALOGE("pid %d invalid OOM adjustments value %d", pids[i], scores[i]);
+            priorities->clear();
+            return false;
+        }
+        priorities->push_back(scores[i]);
+    }
+    return true;
+}
+
 bool ProcessInfo::isValidPid(int pid) {
     int callingPid = IPCThreadState::self()->getCallingPid();
     // Trust it if this is called from the same process otherwise pid has to match the calling pid.
@@ -203,10 +203,10 @@ status_t SampleIterator::getChunkOffset(uint32_t chunk, off64_t *offset) {
     if (mTable->mChunkOffsetType == SampleTable::kChunkOffsetType32) {
         uint32_t offset32;
 
-        if (mTable->mDataSource->readAt(
+        if (mTable->readTableData(
                     mTable->mChunkOffsetOffset + 8 + 4 * chunk,
                     &offset32,
-                    sizeof(offset32)) < (ssize_t)sizeof(offset32)) {
+                    sizeof(offset32)) != OK) {
             return ERROR_IO;
         }
 
@@ -215,10 +215,10 @@ status_t SampleIterator::getChunkOffset(uint32_t chunk, off64_t *offset) {
         CHECK_EQ(mTable->mChunkOffsetType, SampleTable::kChunkOffsetType64);
 
         uint64_t offset64;
-        if (mTable->mDataSource->readAt(
+        if (mTable->readTableData(
                     mTable->mChunkOffsetOffset + 8 + 8 * chunk,
                     &offset64,
-                    sizeof(offset64)) < (ssize_t)sizeof(offset64)) {
+                    sizeof(offset64)) != OK) {
             return ERROR_IO;
         }
 
@@ -244,22 +244,23 @@ status_t SampleIterator::getSampleSizeDirect(
     switch (mTable->mSampleSizeFieldSize) {
         case 32:
         {
-            if (mTable->mDataSource->readAt(
+            uint32_t x;
+            if (mTable->readTableData(
                         mTable->mSampleSizeOffset + 12 + 4 * sampleIndex,
-                        size, sizeof(*size)) < (ssize_t)sizeof(*size)) {
+                        &x, sizeof(x)) != OK) {
                 return ERROR_IO;
             }
 
-            *size = ntohl(*size);
+            *size = ntohl(x);
             break;
         }
 
         case 16:
         {
             uint16_t x;
-            if (mTable->mDataSource->readAt(
+            if (mTable->readTableData(
                         mTable->mSampleSizeOffset + 12 + 2 * sampleIndex,
-                        &x, sizeof(x)) < (ssize_t)sizeof(x)) {
+                        &x, sizeof(x)) != OK) {
                 return ERROR_IO;
             }
 
@@ -270,9 +271,9 @@ status_t SampleIterator::getSampleSizeDirect(
         case 8:
         {
             uint8_t x;
-            if (mTable->mDataSource->readAt(
+            if (mTable->readTableData(
                         mTable->mSampleSizeOffset + 12 + sampleIndex,
-                        &x, sizeof(x)) < (ssize_t)sizeof(x)) {
+                        &x, sizeof(x)) != OK) {
                 return ERROR_IO;
             }
 
@@ -285,9 +286,9 @@ status_t SampleIterator::getSampleSizeDirect(
             CHECK_EQ(mTable->mSampleSizeFieldSize, 4);
 
             uint8_t x;
-            if (mTable->mDataSource->readAt(
+            if (mTable->readTableData(
                         mTable->mSampleSizeOffset + 12 + sampleIndex / 2,
-                        &x, sizeof(x)) < (ssize_t)sizeof(x)) {
+                        &x, sizeof(x)) != OK) {
                 return ERROR_IO;
             }
 
@@ -53,14 +53,15 @@ struct SampleTable::CompositionDeltaLookup {
     CompositionDeltaLookup();
 
     void setEntries(
-            const int32_t *deltaEntries, size_t numDeltaEntries);
+            SampleTable *table, off64_t deltaEntriesOffset, size_t numDeltaEntries);
 
     int32_t getCompositionTimeOffset(uint32_t sampleIndex);
 
 private:
     Mutex mLock;
 
-    const int32_t *mDeltaEntries;
+    SampleTable *mTable;
+    off64_t mDeltaEntriesOffset;
     size_t mNumDeltaEntries;
 
     size_t mCurrentDeltaEntry;
@@ -70,17 +71,19 @@ private:
 };
 
 SampleTable::CompositionDeltaLookup::CompositionDeltaLookup()
-    : mDeltaEntries(NULL),
+    : mTable(NULL),
+      mDeltaEntriesOffset(-1),
       mNumDeltaEntries(0),
       mCurrentDeltaEntry(0),
       mCurrentEntrySampleIndex(0) {
 }
 
 void SampleTable::CompositionDeltaLookup::setEntries(
-        const int32_t *deltaEntries, size_t numDeltaEntries) {
+        SampleTable *table, off64_t deltaEntriesOffset, size_t numDeltaEntries) {
     Mutex::Autolock autolock(mLock);
 
-    mDeltaEntries = deltaEntries;
+    mTable = table;
+    mDeltaEntriesOffset = deltaEntriesOffset;
     mNumDeltaEntries = numDeltaEntries;
     mCurrentDeltaEntry = 0;
     mCurrentEntrySampleIndex = 0;
@@ -90,7 +93,7 @@ int32_t SampleTable::CompositionDeltaLookup::getCompositionTimeOffset(
         uint32_t sampleIndex) {
     Mutex::Autolock autolock(mLock);
 
-    if (mDeltaEntries == NULL) {
+    if (mTable == NULL) {
         return 0;
     }
 
@@ -100,9 +103,15 @@ int32_t SampleTable::CompositionDeltaLookup::getCompositionTimeOffset(
     }
 
     while (mCurrentDeltaEntry < mNumDeltaEntries) {
-        uint32_t sampleCount = mDeltaEntries[2 * mCurrentDeltaEntry];
+        uint8_t entry[8];
+        if (mTable->readTableData(
+                    mDeltaEntriesOffset + 8 * mCurrentDeltaEntry, entry, sizeof(entry)) != OK) {
+            return 0;
+        }
+
+        uint32_t sampleCount = U32_AT(entry);
         if (sampleIndex < mCurrentEntrySampleIndex + sampleCount) {
-            return mDeltaEntries[2 * mCurrentDeltaEntry + 1];
+            return (int32_t)U32_AT(&entry[4]);
         }
 
         mCurrentEntrySampleIndex += sampleCount;
@@ -129,7 +138,7 @@ SampleTable::SampleTable(const sp<DataSource> &source)
       mTimeToSampleCount(0),
       mTimeToSample(NULL),
       mSampleTimeEntries(NULL),
-      mCompositionTimeDeltaEntries(NULL),
+      mCompositionTimeDeltaOffset(-1),
       mNumCompositionTimeDeltaEntries(0),
       mCompositionDeltaLookup(new CompositionDeltaLookup),
       mSyncSampleOffset(-1),
@@ -137,7 +146,10 @@ SampleTable::SampleTable(const sp<DataSource> &source)
       mSyncSamples(NULL),
       mLastSyncSampleIndex(0),
       mSampleToChunkEntries(NULL),
-      mTotalSize(0) {
+      mTotalSize(0),
+      mTableWindows(NULL),
+      mLastTableWindow(0),
+      mTableWindowUseCount(0) {
     mSampleIterator = new SampleIterator(this);
 }
 
@@ -154,8 +166,8 @@ SampleTable::~SampleTable() {
     delete mCompositionDeltaLookup;
     mCompositionDeltaLookup = NULL;
 
-    delete[] mCompositionTimeDeltaEntries;
-    mCompositionTimeDeltaEntries = NULL;
+    delete[] mTableWindows;
+    mTableWindows = NULL;
 
     delete[] mSampleTimeEntries;
     mSampleTimeEntries = NULL;
@@ -282,11 +294,10 @@ status_t SampleTable::setSampleToChunkParams(
     for (uint32_t i = 0; i < mNumSampleToChunkOffsets; ++i) {
         uint8_t buffer[sizeof(SampleToChunkEntry)];
 
-        if (mDataSource->readAt(
+        if (readTableData(
                     mSampleToChunkOffset + 8 + i * sizeof(SampleToChunkEntry),
                     buffer,
-                    sizeof(buffer))
-                != (ssize_t)sizeof(buffer)) {
+                    sizeof(buffer)) != OK) {
             return ERROR_IO;
         }
         // chunk index is 1 based in the spec.
@@ -442,7 +453,7 @@ status_t SampleTable::setCompositionTimeToSampleParams(
         off64_t data_offset, size_t data_size) {
     ALOGI("There are reordered frames present.");
 
-    if (mCompositionTimeDeltaEntries != NULL || data_size < 8) {
+    if (mCompositionTimeDeltaOffset >= 0 || data_size < 8) {
         return ERROR_MALFORMED;
     }
 
@@ -468,46 +479,16 @@ status_t SampleTable::setCompositionTimeToSampleParams(
         return ERROR_MALFORMED;
     }
 
-    mNumCompositionTimeDeltaEntries = numEntries;
-    uint64_t allocSize = (uint64_t)numEntries * 2 * sizeof(int32_t);
-    if (allocSize > kMaxTotalSize) {
-        ALOGE("Composition-time-to-sample table size too large.");
-        return ERROR_OUT_OF_RANGE;
-    }
-
-    mTotalSize += allocSize;
-    if (mTotalSize > kMaxTotalSize) {
-        ALOGE("Composition-time-to-sample table would make sample table too large.\n"
-              "    Requested composition-time-to-sample table size = %llu\n"
-              "    Eventual sample table size >= %llu\n"
-              "    Allowed sample table size = %llu\n",
-              (unsigned long long)allocSize,
-              (unsigned long long)mTotalSize,
-              (unsigned long long)kMaxTotalSize);
-        return ERROR_OUT_OF_RANGE;
-    }
-
-    mCompositionTimeDeltaEntries = new (std::nothrow) int32_t[2 * numEntries];
-    if (!mCompositionTimeDeltaEntries) {
-        ALOGE("Cannot allocate composition-time-to-sample table with %llu "
-                "entries.", (unsigned long long)numEntries);
-        return ERROR_OUT_OF_RANGE;
-    }
-
-    if (mDataSource->readAt(data_offset + 8, mCompositionTimeDeltaEntries,
-            (size_t)allocSize) < (ssize_t)allocSize) {
-        delete[] mCompositionTimeDeltaEntries;
-        mCompositionTimeDeltaEntries = NULL;
-
-        return ERROR_IO;
+    if (numEntries > 0 && data_offset > kMaxOffset - (off64_t)data_size) {
+        return ERROR_MALFORMED;
     }
 
-    for (size_t i = 0; i < 2 * numEntries; ++i) {
-        mCompositionTimeDeltaEntries[i] = ntohl(mCompositionTimeDeltaEntries[i]);
-    }
+    // The entries are not loaded, only looked up through the table windows.
+    mCompositionTimeDeltaOffset = data_offset;
+    mNumCompositionTimeDeltaEntries = numEntries;
 
     mCompositionDeltaLookup->setEntries(
-            mCompositionTimeDeltaEntries, mNumCompositionTimeDeltaEntries);
+            this, mCompositionTimeDeltaOffset + 8, mNumCompositionTimeDeltaEntries);
 
     return OK;
 }
@@ -986,5 +967,78 @@ int32_t SampleTable::getCompositionTimeOffset(uint32_t sampleIndex) {
     return mCompositionDeltaLookup->getCompositionTimeOffset(sampleIndex);
 }
 
+status_t SampleTable::readTableData(off64_t offset, void *data, size_t size) {
+    Mutex::Autolock autoLock(mTableWindowLock);
+
+    if (offset < 0 || (off64_t)size > kMaxOffset - offset) {
+        return ERROR_MALFORMED;
+    }
+
+    if (mTableWindows == NULL) {
+        mTableWindows = new (std::nothrow) TableWindow[kNumTableWindows];
+        if (mTableWindows == NULL) {
+            return ERROR_IO;
+        }
+        for (size_t i = 0; i < kNumTableWindows; ++i) {
+            mTableWindows[i].mOffset = -1;
+            mTableWindows[i].mSize = 0;
+            mTableWindows[i].mLastUse = 0;
+        }
+    }
+
+    uint8_t *dst = (uint8_t *)data;
+    while (size > 0) {
+        const off64_t windowOffset = offset & ~((off64_t)kTableWindowSize - 1);
+
+        // Entries are looked up mostly in order, so try the last window first.
+        TableWindow *window = &mTableWindows[mLastTableWindow];
+        if (window->mOffset != windowOffset) {
+            size_t leastRecentlyUsed = 0;
+            window = NULL;
+            for (size_t i = 0; i < kNumTableWindows; ++i) {
+                if (mTableWindows[i].mOffset == windowOffset) {
+                    window = &mTableWindows[i];
+                    mLastTableWindow = i;
+                    break;
+                }
+                if (mTableWindows[i].mLastUse < mTableWindows[leastRecentlyUsed].mLastUse) {
+                    leastRecentlyUsed = i;
+                }
+            }
+
+            if (window == NULL) {
+                window = &mTableWindows[leastRecentlyUsed];
+                mLastTableWindow = leastRecentlyUsed;
+
+                ssize_t n = mDataSource->readAt(windowOffset, window->mData, kTableWindowSize);
+                if (n <= 0) {
+                    window->mOffset = -1;
+                    return ERROR_IO;
+                }
+                window->mOffset = windowOffset;
+                window->mSize = n;
+            }
+        }
+        window->mLastUse = ++mTableWindowUseCount;
+
+        const size_t start = offset - windowOffset;
+        if (start >= window->mSize) {
+            // a short read, past the end of the source
+            return ERROR_IO;
+        }
+        size_t copy = window->mSize - start;
+        if (copy > size) {
+            copy = size;
+        }
+        memcpy(dst, &window->mData[start], copy);
+
+        dst += copy;
+        offset += copy;
+        size -= copy;
+    }
+
+    return OK;
+}
+
 }  // namespace android
 
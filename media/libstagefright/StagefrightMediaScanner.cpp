@@ -21,15 +21,117 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
 
 #include <media/stagefright/StagefrightMediaScanner.h>
 
 #include <media/IMediaHTTPService.h>
 #include <media/mediametadataretriever.h>
 #include <private/media/VideoFrame.h>
+#include <utils/Thread.h>
 
 namespace android {
 
+// What a file tells the client, extracted before the client is called.
+struct StagefrightMediaScanner::FileMetadata {
+    FileMetadata()
+        : mResult(MEDIA_SCAN_RESULT_SKIPPED),
+          mUnchanged(false),
+          mHasFingerprint(false),
+          mHasMimeType(false) {
+    }
+
+    MediaScanResult mResult;
+    bool mUnchanged;
+    bool mHasFingerprint;
+    Fingerprint mFingerprint;
+    bool mHasMimeType;
+    String8 mMimeType;
+    Vector<const char *> mTagNames;
+    Vector<String8> mTagValues;
+};
+
+// The files of a processFiles() call, extracted by the workers and reported
+// by the calling thread.
+struct StagefrightMediaScanner::Batch {
+    enum {
+        // how far the workers may get ahead of the files reported
+        kMaxNumPendingFiles = 16,
+    };
+
+    Mutex mLock;
+    Condition mCondition;
+
+    Vector<String8> mPaths;
+    Vector<Fingerprint> mPreviousFingerprints;  // mSize < 0 if none
+    Vector<FileMetadata *> mFiles;              // NULL until extracted
+    size_t mNextFile;
+    size_t mNextReport;
+    bool mAborted;
+};
+
+// Extracts the files of a batch one at a time, reusing its retriever.
+struct StagefrightMediaScanner::ScanWorker : public Thread {
+    ScanWorker(Batch *batch)
+        : Thread(false /* canCallJava */),
+          mBatch(batch) {
+    }
+
+protected:
+    virtual ~ScanWorker() {}
+
+private:
+    Batch *mBatch;
+    sp<MediaMetadataRetriever> mRetriever;
+
+    virtual bool threadLoop();
+
+    DISALLOW_EVIL_CONSTRUCTORS(ScanWorker);
+};
+
+bool StagefrightMediaScanner::ScanWorker::threadLoop() {
+    size_t index;
+    String8 path;
+    Fingerprint previous;
+    {
+        Mutex::Autolock autoLock(mBatch->mLock);
+        while (!mBatch->mAborted && mBatch->mNextFile < mBatch->mPaths.size()
+                && mBatch->mNextFile >= mBatch->mNextReport + Batch::kMaxNumPendingFiles) {
+            mBatch->mCondition.wait(mBatch->mLock);
+        }
+        if (mBatch->mAborted || mBatch->mNextFile >= mBatch->mPaths.size()) {
+            index = mBatch->mPaths.size();
+        } else {
+            index = mBatch->mNextFile++;
+            path = mBatch->mPaths[index];
+            previous = mBatch->mPreviousFingerprints[index];
+        }
+    }
+    if (index >= mBatch->mPaths.size()) {
+        // drops the last file the retriever holds open
+        mRetriever.clear();
+        return false;
+    }
+
+    FileMetadata *metadata = new FileMetadata;
+    if (GetFingerprint(path.string(), &metadata->mFingerprint) == OK) {
+        metadata->mHasFingerprint = true;
+        metadata->mUnchanged = previous.mSize >= 0
+                && previous.mSize == metadata->mFingerprint.mSize
+                && previous.mModifiedTime == metadata->mFingerprint.mModifiedTime
+                && previous.mHash == metadata->mFingerprint.mHash;
+    }
+    if (!metadata->mUnchanged) {
+        ExtractFile(path.string(), &mRetriever, metadata);
+    }
+
+    Mutex::Autolock autoLock(mBatch->mLock);
+    mBatch->mFiles.editItemAt(index) = metadata;
+    mBatch->mCondition.broadcast();
+    return true;
+}
+
 StagefrightMediaScanner::StagefrightMediaScanner() {}
 
 StagefrightMediaScanner::~StagefrightMediaScanner() {}
@@ -69,17 +171,34 @@ MediaScanResult StagefrightMediaScanner::processFile(
 MediaScanResult StagefrightMediaScanner::processFileInternal(
         const char *path, const char * /* mimeType */,
         MediaScannerClient &client) {
+    sp<MediaMetadataRetriever> retriever;
+
+    FileMetadata metadata;
+    ExtractFile(path, &retriever, &metadata);
+    return ReportFile(metadata, client);
+}
+
+// static
+void StagefrightMediaScanner::ExtractFile(
+        const char *path, sp<MediaMetadataRetriever> *retriever,
+        FileMetadata *metadata) {
     const char *extension = strrchr(path, '.');
 
     if (!extension) {
-        return MEDIA_SCAN_RESULT_SKIPPED;
+        metadata->mResult = MEDIA_SCAN_RESULT_SKIPPED;
+        return;
     }
 
     if (!FileHasAcceptableExtension(extension)) {
-        return MEDIA_SCAN_RESULT_SKIPPED;
+        metadata->mResult = MEDIA_SCAN_RESULT_SKIPPED;
+        return;
     }
 
-    sp<MediaMetadataRetriever> mRetriever(new MediaMetadataRetriever);
+    // a retriever takes a new data source without connecting to the service again
+    if (*retriever == NULL) {
+        *retriever = new MediaMetadataRetriever;
+    }
+    sp<MediaMetadataRetriever> mRetriever = *retriever;
 
     int fd = open(path, O_RDONLY | O_LARGEFILE);
     status_t status;
@@ -92,16 +211,15 @@ MediaScanResult StagefrightMediaScanner::processFileInternal(
     }
 
     if (status) {
-        return MEDIA_SCAN_RESULT_ERROR;
+        metadata->mResult = MEDIA_SCAN_RESULT_ERROR;
+        return;
     }
 
     const char *value;
     if ((value = mRetriever->extractMetadata(
                     METADATA_KEY_MIMETYPE)) != NULL) {
-        status = client.setMimeType(value);
-        if (status) {
-            return MEDIA_SCAN_RESULT_ERROR;
-        }
+        metadata->mHasMimeType = true;
+        metadata->mMimeType = value;
     }
 
     struct KeyMap {
@@ -131,16 +249,186 @@ MediaScanResult StagefrightMediaScanner::processFileInternal(
     for (size_t i = 0; i < kNumEntries; ++i) {
         const char *value;
         if ((value = mRetriever->extractMetadata(kKeyMap[i].key)) != NULL) {
-            status = client.addStringTag(kKeyMap[i].tag, value);
-            if (status != OK) {
-                return MEDIA_SCAN_RESULT_ERROR;
-            }
+            metadata->mTagNames.push(kKeyMap[i].tag);
+            metadata->mTagValues.push(String8(value));
+        }
+    }
+
+    metadata->mResult = MEDIA_SCAN_RESULT_OK;
+}
+
+// static
+MediaScanResult StagefrightMediaScanner::ReportFile(
+        const FileMetadata &metadata, MediaScannerClient &client) {
+    if (metadata.mResult != MEDIA_SCAN_RESULT_OK) {
+        return metadata.mResult;
+    }
+
+    status_t status;
+    if (metadata.mHasMimeType) {
+        status = client.setMimeType(metadata.mMimeType.string());
+        if (status) {
+            return MEDIA_SCAN_RESULT_ERROR;
+        }
+    }
+
+    for (size_t i = 0; i < metadata.mTagNames.size(); ++i) {
+        status = client.addStringTag(metadata.mTagNames[i], metadata.mTagValues[i].string());
+        if (status != OK) {
+            return MEDIA_SCAN_RESULT_ERROR;
         }
     }
 
     return MEDIA_SCAN_RESULT_OK;
 }
 
+// static
+status_t StagefrightMediaScanner::GetFingerprint(const char *path, Fingerprint *fingerprint) {
+    int fd = open(path, O_RDONLY | O_LARGEFILE);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        status_t err = -errno;
+        close(fd);
+        return err;
+    }
+
+    fingerprint->mSize = st.st_size;
+    fingerprint->mModifiedTime = st.st_mtime;
+
+    // FNV-1a of the first and the last bytes
+    uint32_t hash = 2166136261u;
+    uint8_t buffer[kFingerprintBytes];
+
+    off64_t offsets[2] = { 0, (off64_t)st.st_size - kFingerprintBytes };
+    size_t numParts = (st.st_size > 2 * kFingerprintBytes) ? 2 : 1;
+    for (size_t i = 0; i < numParts; ++i) {
+        ssize_t n = pread64(fd, buffer, sizeof(buffer), offsets[i]);
+        if (n < 0) {
+            status_t err = -errno;
+            close(fd);
+            return err;
+        }
+        for (ssize_t j = 0; j < n; ++j) {
+            hash = (hash ^ buffer[j]) * 16777619u;
+        }
+    }
+    fingerprint->mHash = hash;
+
+    close(fd);
+    return OK;
+}
+
+MediaScanResult StagefrightMediaScanner::processFiles(
+        const Vector<String8> &paths, MediaScannerClient &client,
+        KeyedVector<String8, Fingerprint> *fingerprints,
+        Vector<MediaScanResult> *results) {
+    ALOGV("processFiles %zu files", paths.size());
+
+    if (results != NULL) {
+        results->clear();
+    }
+
+    Batch batch;
+    batch.mPaths = paths;
+    batch.mNextFile = 0;
+    batch.mNextReport = 0;
+    batch.mAborted = false;
+
+    Fingerprint none;
+    none.mSize = -1;
+    none.mModifiedTime = 0;
+    none.mHash = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        ssize_t index = (fingerprints != NULL) ? fingerprints->indexOfKey(paths[i]) : -1;
+        batch.mPreviousFingerprints.push(index >= 0 ? fingerprints->valueAt(index) : none);
+        batch.mFiles.push(NULL);
+    }
+
+    long onlineCores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t numWorkers = (onlineCores < 1) ? 1
+            : (onlineCores < kMaxNumScanThreads ? onlineCores : kMaxNumScanThreads);
+    if (numWorkers > paths.size()) {
+        numWorkers = paths.size();
+    }
+
+    Vector<sp<ScanWorker> > workers;
+    for (size_t i = 0; i < numWorkers; ++i) {
+        sp<ScanWorker> worker = new ScanWorker(&batch);
+        if (worker->run("MediaScanWorker") != OK) {
+            ALOGW("cannot start scan worker %zu", i);
+            break;
+        }
+        workers.push(worker);
+    }
+
+    client.setLocale(locale());
+
+    MediaScanResult batchResult = MEDIA_SCAN_RESULT_OK;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        FileMetadata *metadata;
+        if (workers.isEmpty()) {
+            metadata = new FileMetadata;
+            sp<MediaMetadataRetriever> retriever;
+            ExtractFile(paths[i].string(), &retriever, metadata);
+        } else {
+            Mutex::Autolock autoLock(batch.mLock);
+            while (batch.mFiles[i] == NULL) {
+                batch.mCondition.wait(batch.mLock);
+            }
+            metadata = batch.mFiles[i];
+            batch.mFiles.editItemAt(i) = NULL;
+            batch.mNextReport = i + 1;
+            batch.mCondition.broadcast();
+        }
+
+        MediaScanResult result;
+        if (metadata->mUnchanged) {
+            ALOGV("'%s' did not change", paths[i].string());
+            result = MEDIA_SCAN_RESULT_SKIPPED;
+        } else {
+            client.beginFile();
+            result = ReportFile(*metadata, client);
+            client.endFile();
+
+            if (result == MEDIA_SCAN_RESULT_OK && metadata->mHasFingerprint
+                    && fingerprints != NULL) {
+                fingerprints->add(paths[i], metadata->mFingerprint);
+            }
+        }
+        delete metadata;
+
+        if (results != NULL) {
+            results->push(result);
+        }
+
+        if (result == MEDIA_SCAN_RESULT_ERROR) {
+            batchResult = MEDIA_SCAN_RESULT_ERROR;
+            break;
+        }
+    }
+
+    {
+        Mutex::Autolock autoLock(batch.mLock);
+        batch.mAborted = true;
+        batch.mCondition.broadcast();
+    }
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->requestExitAndWait();
+    }
+    workers.clear();
+
+    // the files extracted past an error
+    for (size_t i = 0; i < batch.mFiles.size(); ++i) {
+        delete batch.mFiles[i];
+    }
+
+    return batchResult;
+}
+
 MediaAlbumArt *StagefrightMediaScanner::extractAlbumArt(int fd) {
     ALOGV("extractAlbumArt %d", fd);
 
@@ -31,6 +31,7 @@
 #include <media/stagefright/foundation/ABuffer.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/foundation/AMessage.h>
+#include <media/stagefright/foundation/ColorUtils.h>
 #include <media/stagefright/ColorConverter.h>
 #include <media/stagefright/DataSource.h>
 #include <media/stagefright/FileSource.h>
@@ -53,7 +54,8 @@ static const size_t kRetryCount = 20; // must be >0
 
 StagefrightMetadataRetriever::StagefrightMetadataRetriever()
     : mParsedMetaData(false),
-      mAlbumArt(NULL) {
+      mAlbumArt(NULL),
+      mFrameDecoder(NULL) {
     ALOGV("StagefrightMetadataRetriever()");
 
     DataSource::RegisterDefaultSniffers();
@@ -139,20 +141,61 @@ status_t StagefrightMetadataRetriever::setDataSource(
     return OK;
 }
 
-static VideoFrame *extractVideoFrame(
-        const AString &componentName,
-        const sp<MetaData> &trackMeta,
-        const sp<IMediaSource> &source,
-        int64_t frameTimeUs,
-        int seekMode) {
+// A started decoder and track, kept between calls to getFrameAtTime() so that
+// extracting several frames from a file instantiates the decoder only once.
+struct StagefrightMetadataRetriever::FrameDecoder {
+    FrameDecoder(size_t trackIndex, const AString &componentName, bool seekingClosest);
+    ~FrameDecoder();
+
+    status_t init(const sp<MetaData> &trackMeta, const sp<IMediaSource> &source);
+
+    // Seeks and decodes the frame at frameTimeUs, the thumbnail time of the
+    // track if negative. Returns NULL if the decoder fails, it cannot be used
+    // again then.
+    VideoFrame *extractFrame(const sp<MetaData> &trackMeta, int64_t frameTimeUs, int seekMode);
+
+    const size_t mTrackIndex;
+    const AString mComponentName;
+    const bool mSeekingClosest;
+
+private:
+    sp<ALooper> mLooper;
+    sp<MediaCodec> mDecoder;
+    sp<IMediaSource> mSource;
+    bool mSourceStarted;
+    bool mNeedsFlush;
+    Vector<sp<ABuffer> > mInputBuffers;
+    Vector<sp<ABuffer> > mOutputBuffers;
+    sp<AMessage> mOutputFormat;
+
+    DISALLOW_EVIL_CONSTRUCTORS(FrameDecoder);
+};
+
+StagefrightMetadataRetriever::FrameDecoder::FrameDecoder(
+        size_t trackIndex, const AString &componentName, bool seekingClosest)
+    : mTrackIndex(trackIndex),
+      mComponentName(componentName),
+      mSeekingClosest(seekingClosest),
+      mSourceStarted(false),
+      mNeedsFlush(false) {
+}
 
-    sp<MetaData> format = source->getFormat();
+StagefrightMetadataRetriever::FrameDecoder::~FrameDecoder() {
+    if (mSourceStarted) {
+        mSource->stop();
+    }
+    if (mDecoder != NULL) {
+        mDecoder->release();
+    }
+}
 
+status_t StagefrightMetadataRetriever::FrameDecoder::init(
+        const sp<MetaData> &trackMeta, const sp<IMediaSource> &source) {
     sp<AMessage> videoFormat;
     if (convertMetaDataToMessage(trackMeta, &videoFormat) != OK) {
         ALOGE("b/23680780");
         ALOGW("Failed to convert meta data to message");
-        return NULL;
+        return ERROR_MALFORMED;
     }
 
     // TODO: Use Flexible color instead
@@ -161,46 +204,80 @@ static VideoFrame *extractVideoFrame(
     // For the thumbnail extraction case, try to allocate single buffer in both
     // input and output ports, if seeking to a sync frame. NOTE: This request may
     // fail if component requires more than that for decoding.
-    bool isSeekingClosest = (seekMode == MediaSource::ReadOptions::SEEK_CLOSEST);
-    if (!isSeekingClosest) {
+    if (!mSeekingClosest) {
         videoFormat->setInt32("android._num-input-buffers", 1);
         videoFormat->setInt32("android._num-output-buffers", 1);
     }
 
     status_t err;
-    sp<ALooper> looper = new ALooper;
-    looper->start();
-    sp<MediaCodec> decoder = MediaCodec::CreateByComponentName(
-            looper, componentName, &err);
+    mLooper = new ALooper;
+    mLooper->start();
+    mDecoder = MediaCodec::CreateByComponentName(
+            mLooper, mComponentName, &err);
 
-    if (decoder.get() == NULL || err != OK) {
-        ALOGW("Failed to instantiate decoder [%s]", componentName.c_str());
-        return NULL;
+    if (mDecoder.get() == NULL || err != OK) {
+        ALOGW("Failed to instantiate decoder [%s]", mComponentName.c_str());
+        mDecoder.clear();
+        return err != OK ? err : UNKNOWN_ERROR;
     }
 
-    err = decoder->configure(videoFormat, NULL /* surface */, NULL /* crypto */, 0 /* flags */);
+    err = mDecoder->configure(videoFormat, NULL /* surface */, NULL /* crypto */, 0 /* flags */);
     if (err != OK) {
         ALOGW("configure returned error %d (%s)", err, asString(err));
-        decoder->release();
-        return NULL;
+        return err;
     }
 
-    err = decoder->start();
+    err = mDecoder->start();
     if (err != OK) {
         ALOGW("start returned error %d (%s)", err, asString(err));
-        decoder->release();
-        return NULL;
+        return err;
+    }
+
+    mSource = source;
+    err = mSource->start();
+    if (err != OK) {
+        ALOGW("source failed to start: %d (%s)", err, asString(err));
+        return err;
+    }
+    mSourceStarted = true;
+
+    err = mDecoder->getInputBuffers(&mInputBuffers);
+    if (err != OK) {
+        ALOGW("failed to get input buffers: %d (%s)", err, asString(err));
+        return err;
     }
 
+    err = mDecoder->getOutputBuffers(&mOutputBuffers);
+    if (err != OK) {
+        ALOGW("failed to get output buffers: %d (%s)", err, asString(err));
+        return err;
+    }
+
+    return OK;
+}
+
+VideoFrame *StagefrightMetadataRetriever::FrameDecoder::extractFrame(
+        const sp<MetaData> &trackMeta, int64_t frameTimeUs, int seekMode) {
+    sp<MetaData> format = mSource->getFormat();
+
     MediaSource::ReadOptions options;
     if (seekMode < MediaSource::ReadOptions::SEEK_PREVIOUS_SYNC ||
         seekMode > MediaSource::ReadOptions::SEEK_CLOSEST) {
 
         ALOGE("Unknown seek mode: %d", seekMode);
-        decoder->release();
         return NULL;
     }
 
+    // the previous frame left the decoder at the end of stream
+    if (mNeedsFlush) {
+        status_t err = mDecoder->flush();
+        if (err != OK) {
+            ALOGW("flush returned error %d (%s)", err, asString(err));
+            return NULL;
+        }
+        mNeedsFlush = false;
+    }
+
     MediaSource::ReadOptions::SeekMode mode =
             static_cast<MediaSource::ReadOptions::SeekMode>(seekMode);
 
@@ -216,32 +293,7 @@ static VideoFrame *extractVideoFrame(
         options.setSeekTo(frameTimeUs, mode);
     }
 
-    err = source->start();
-    if (err != OK) {
-        ALOGW("source failed to start: %d (%s)", err, asString(err));
-        decoder->release();
-        return NULL;
-    }
-
-    Vector<sp<ABuffer> > inputBuffers;
-    err = decoder->getInputBuffers(&inputBuffers);
-    if (err != OK) {
-        ALOGW("failed to get input buffers: %d (%s)", err, asString(err));
-        decoder->release();
-        source->stop();
-        return NULL;
-    }
-
-    Vector<sp<ABuffer> > outputBuffers;
-    err = decoder->getOutputBuffers(&outputBuffers);
-    if (err != OK) {
-        ALOGW("failed to get output buffers: %d (%s)", err, asString(err));
-        decoder->release();
-        source->stop();
-        return NULL;
-    }
-
-    sp<AMessage> outputFormat = NULL;
+    status_t err = OK;
     bool haveMoreInputs = true;
     size_t index, offset, size;
     int64_t timeUs;
@@ -260,6 +312,8 @@ static VideoFrame *extractVideoFrame(
     bool firstSample = true;
     int64_t targetTimeUs = -1ll;
 
+    mNeedsFlush = true;
+
     do {
         size_t inputIndex = -1;
         int64_t ptsUs = 0ll;
@@ -267,7 +321,7 @@ static VideoFrame *extractVideoFrame(
         sp<ABuffer> codecBuffer = NULL;
 
         while (haveMoreInputs) {
-            err = decoder->dequeueInputBuffer(&inputIndex, kBufferTimeOutUs);
+            err = mDecoder->dequeueInputBuffer(&inputIndex, kBufferTimeOutUs);
             if (err != OK) {
                 ALOGW("Timed out waiting for input");
                 if (retriesLeft) {
@@ -275,18 +329,18 @@ static VideoFrame *extractVideoFrame(
                 }
                 break;
             }
-            codecBuffer = inputBuffers[inputIndex];
+            codecBuffer = mInputBuffers[inputIndex];
 
             MediaBuffer *mediaBuffer = NULL;
 
-            err = source->read(&mediaBuffer, &options);
+            err = mSource->read(&mediaBuffer, &options);
             options.clearSeekTo();
             if (err != OK) {
                 ALOGW("Input Error or EOS");
                 haveMoreInputs = false;
                 break;
             }
-            if (firstSample && isSeekingClosest) {
+            if (firstSample && mSeekingClosest) {
                 mediaBuffer->meta_data()->findInt64(kKeyTargetTime, &targetTimeUs);
                 ALOGV("Seeking closest: targetTimeUs=%lld", (long long)targetTimeUs);
             }
@@ -303,7 +357,7 @@ static VideoFrame *extractVideoFrame(
                 memcpy(codecBuffer->data(),
                         (const uint8_t*)mediaBuffer->data() + mediaBuffer->range_offset(),
                         mediaBuffer->range_length());
-                if (isAvcOrHevc && IsIDR(codecBuffer) && !isSeekingClosest) {
+                if (isAvcOrHevc && IsIDR(codecBuffer) && !mSeekingClosest) {
                     // Only need to decode one IDR frame, unless we're seeking with CLOSEST
                     // option, in which case we need to actually decode to targetTimeUs.
                     haveMoreInputs = false;
@@ -315,10 +369,10 @@ static VideoFrame *extractVideoFrame(
             break;
         }
 
-        if (err == OK && inputIndex < inputBuffers.size()) {
+        if (err == OK && inputIndex < mInputBuffers.size()) {
             ALOGV("QueueInput: size=%zu ts=%" PRId64 " us flags=%x",
                     codecBuffer->size(), ptsUs, flags);
-            err = decoder->queueInputBuffer(
+            err = mDecoder->queueInputBuffer(
                     inputIndex,
                     codecBuffer->offset(),
                     codecBuffer->size(),
@@ -333,7 +387,7 @@ static VideoFrame *extractVideoFrame(
 
         while (err == OK) {
             // wait for a decoded buffer
-            err = decoder->dequeueOutputBuffer(
+            err = mDecoder->dequeueOutputBuffer(
                     &index,
                     &offset,
                     &size,
@@ -343,10 +397,10 @@ static VideoFrame *extractVideoFrame(
 
             if (err == INFO_FORMAT_CHANGED) {
                 ALOGV("Received format change");
-                err = decoder->getOutputFormat(&outputFormat);
+                err = mDecoder->getOutputFormat(&mOutputFormat);
             } else if (err == INFO_OUTPUT_BUFFERS_CHANGED) {
                 ALOGV("Output buffers changed");
-                err = decoder->getOutputBuffers(&outputBuffers);
+                err = mDecoder->getOutputBuffers(&mOutputBuffers);
             } else {
                 if (err == -EAGAIN /* INFO_TRY_AGAIN_LATER */ && --retriesLeft > 0) {
                     ALOGV("Timed-out waiting for output.. retries left = %zu", retriesLeft);
@@ -357,7 +411,7 @@ static VideoFrame *extractVideoFrame(
                     done = (targetTimeUs < 0ll) || (timeUs >= targetTimeUs);
                     ALOGV("Received an output buffer, timeUs=%lld", (long long)timeUs);
                     if (!done) {
-                        err = decoder->releaseOutputBuffer(index);
+                        err = mDecoder->releaseOutputBuffer(index);
                     }
                 } else {
                     ALOGW("Received error %d (%s) instead of output", err, asString(err));
@@ -368,15 +422,15 @@ static VideoFrame *extractVideoFrame(
         }
     } while (err == OK && !done);
 
-    if (err != OK || size <= 0 || outputFormat == NULL) {
+    // a decoder reused after a flush does not report its output format again
+    if (err != OK || size <= 0 || mOutputFormat == NULL) {
         ALOGE("Failed to decode thumbnail frame");
-        source->stop();
-        decoder->release();
         return NULL;
     }
 
     ALOGV("successfully decoded video frame.");
-    sp<ABuffer> videoFrameBuffer = outputBuffers.itemAt(index);
+    sp<ABuffer> videoFrameBuffer = mOutputBuffers.itemAt(index);
+    const sp<AMessage> &outputFormat = mOutputFormat;
 
     if (thumbNailTime >= 0) {
         if (timeUs != thumbNailTime) {
@@ -425,6 +479,10 @@ static VideoFrame *extractVideoFrame(
 
     ColorConverter converter((OMX_COLOR_FORMATTYPE)srcFormat, OMX_COLOR_Format16bitRGB565);
 
+    int32_t range, standard, transfer;
+    ColorUtils::getColorConfigFromFormat(outputFormat, &range, &standard, &transfer);
+    converter.setSrcColorSpace(standard, range);
+
     if (converter.isValid()) {
         err = converter.convert(
                 (const uint8_t *)videoFrameBuffer->data(),
@@ -441,9 +499,7 @@ static VideoFrame *extractVideoFrame(
     }
 
     videoFrameBuffer.clear();
-    source->stop();
-    decoder->releaseOutputBuffer(index);
-    decoder->release();
+    mDecoder->releaseOutputBuffer(index);
 
     if (err != OK) {
         ALOGE("Colorconverter failed to convert frame.");
@@ -499,13 +555,6 @@ VideoFrame *StagefrightMetadataRetriever::getFrameAtTime(
     sp<MetaData> trackMeta = mExtractor->getTrackMetaData(
             i, MediaExtractor::kIncludeExtensiveMetaData);
 
-    sp<IMediaSource> source = mExtractor->getTrack(i);
-
-    if (source.get() == NULL) {
-        ALOGV("unable to instantiate video track.");
-        return NULL;
-    }
-
     const void *data;
     uint32_t type;
     size_t dataSize;
@@ -514,6 +563,29 @@ VideoFrame *StagefrightMetadataRetriever::getFrameAtTime(
         mAlbumArt = MediaAlbumArt::fromData(dataSize, data);
     }
 
+    bool seekingClosest = (option == MediaSource::ReadOptions::SEEK_CLOSEST);
+    if (mFrameDecoder != NULL) {
+        if (mFrameDecoder->mTrackIndex == i && mFrameDecoder->mSeekingClosest == seekingClosest) {
+            VideoFrame *frame = mFrameDecoder->extractFrame(trackMeta, timeUs, option);
+            if (frame != NULL) {
+                return frame;
+            }
+            ALOGV("%s failed to extract thumbnail again, instantiating decoders",
+                    mFrameDecoder->mComponentName.c_str());
+        }
+
+        // stops the track before a new one is instantiated
+        delete mFrameDecoder;
+        mFrameDecoder = NULL;
+    }
+
+    sp<IMediaSource> source = mExtractor->getTrack(i);
+
+    if (source.get() == NULL) {
+        ALOGV("unable to instantiate video track.");
+        return NULL;
+    }
+
     const char *mime;
     CHECK(trackMeta->findCString(kKeyMIMEType, &mime));
 
@@ -524,14 +596,20 @@ VideoFrame *StagefrightMetadataRetriever::getFrameAtTime(
             MediaCodecList::kPreferSoftwareCodecs,
             &matchingCodecs);
 
-    for (size_t i = 0; i < matchingCodecs.size(); ++i) {
-        const AString &componentName = matchingCodecs[i];
-        VideoFrame *frame =
-            extractVideoFrame(componentName, trackMeta, source, timeUs, option);
+    for (size_t j = 0; j < matchingCodecs.size(); ++j) {
+        const AString &componentName = matchingCodecs[j];
+
+        FrameDecoder *decoder = new FrameDecoder(i, componentName, seekingClosest);
+        VideoFrame *frame = NULL;
+        if (decoder->init(trackMeta, source) == OK) {
+            frame = decoder->extractFrame(trackMeta, timeUs, option);
+        }
 
         if (frame != NULL) {
+            mFrameDecoder = decoder;
             return frame;
         }
+        delete decoder;
         ALOGV("%s failed to extract thumbnail, trying next decoder.", componentName.c_str());
     }
 
@@ -777,6 +855,10 @@ void StagefrightMetadataRetriever::parseMetaData() {
 }
 
 void StagefrightMetadataRetriever::clearMetadata() {
+    // the decoder extracts frames of the previous source
+    delete mFrameDecoder;
+    mFrameDecoder = NULL;
+
     mParsedMetaData = false;
     mMetaData.clear();
     delete mAlbumArt;
@@ -326,6 +326,7 @@ nsecs_t VideoFrameScheduler::PLL::getPeriod() const {
 
 static const nsecs_t kDefaultVsyncPeriod = kNanosIn1s / 60;  // 60Hz
 static const nsecs_t kVsyncRefreshPeriod = kNanosIn1s;       // 1 sec
+static const nsecs_t kVsyncRecheckPeriod = kNanosIn1s / 10;  // 100 msec, after a change
 
 VideoFrameScheduler::VideoFrameScheduler()
     : mVsyncTime(0),
@@ -336,7 +337,10 @@ VideoFrameScheduler::VideoFrameScheduler()
 }
 
 void VideoFrameScheduler::updateVsync() {
-    mVsyncRefreshAt = systemTime(SYSTEM_TIME_MONOTONIC) + kVsyncRefreshPeriod;
+    nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+    nsecs_t lastVsyncTime = mVsyncTime;
+    nsecs_t lastVsyncPeriod = mVsyncPeriod;
+    mVsyncRefreshAt = now + kVsyncRefreshPeriod;
     mVsyncPeriod = 0;
     mVsyncTime = 0;
 
@@ -355,6 +359,9 @@ void VideoFrameScheduler::updateVsync() {
                     (long long)stats.vsyncTime, (long long)stats.vsyncPeriod);
             mVsyncTime = stats.vsyncTime;
             mVsyncPeriod = stats.vsyncPeriod;
+            if (lastVsyncPeriod > 0 && mVsyncPeriod > 0) {
+                checkVsyncChange(lastVsyncTime, lastVsyncPeriod, now);
+            }
         } else {
             ALOGW("getDisplayStats returned %d", res);
         }
@@ -363,6 +370,26 @@ void VideoFrameScheduler::updateVsync() {
     }
 }
 
+void VideoFrameScheduler::checkVsyncChange(
+        nsecs_t lastVsyncTime, nsecs_t lastVsyncPeriod, nsecs_t now) {
+    // the display may switch refresh rates, or drop and resync its VSYNC
+    bool periodChanged = abs(mVsyncPeriod - lastVsyncPeriod) > lastVsyncPeriod / 100;
+    nsecs_t phaseError = periodicError(mVsyncTime - lastVsyncTime, mVsyncPeriod);
+    if (!periodChanged && phaseError <= mVsyncPeriod / 10) {
+        return;
+    }
+
+    ALOGV("vsync changed: period %lld => %lld, phase error %lld",
+            (long long)lastVsyncPeriod, (long long)mVsyncPeriod, (long long)phaseError);
+    if (periodChanged) {
+        // the VSYNC count of the last frame and the correction are for the old period
+        mLastVsyncTime = -1;
+        mTimeCorrection = 0;
+    }
+    // follow the new timing closely until it settles
+    mVsyncRefreshAt = now + kVsyncRecheckPeriod;
+}
+
 void VideoFrameScheduler::init(float videoFps) {
     updateVsync();
 
@@ -430,12 +457,23 @@ nsecs_t VideoFrameScheduler::schedule(nsecs_t renderTime) {
             N = 20;
         }
 
+        // When the frame period is within 1% of a multiple of half VSYNCs (e.g. 24p or
+        // 30p on 60Hz), lock the projected frame edges to that cadence, so that the jitter of
+        // the PLL estimate does not move the frames across VSYNC edges and break the pulldown.
+        // The drift of the actual render times is still followed by the correction.
+        nsecs_t cadencePeriod = videoPeriod;
+        nsecs_t halfVsyncs = divRound(videoPeriod * 2, mVsyncPeriod);
+        if (halfVsyncs > 0 && abs(videoPeriod * 2 - halfVsyncs * mVsyncPeriod)
+                < halfVsyncs * mVsyncPeriod / 100) {
+            cadencePeriod = halfVsyncs * mVsyncPeriod / 2;
+        }
+
         nsecs_t offset = 0;
         nsecs_t edgeRemainder = 0;
         for (size_t i = 1; i <= N; i++) {
             offset +=
-                (renderTime + mTimeCorrection + videoPeriod * i - mVsyncTime) % mVsyncPeriod;
-            edgeRemainder += (videoPeriod * i) % mVsyncPeriod;
+                (renderTime + mTimeCorrection + cadencePeriod * i - mVsyncTime) % mVsyncPeriod;
+            edgeRemainder += (cadencePeriod * i) % mVsyncPeriod;
         }
         mTimeCorrection += mVsyncPeriod / 2 - offset / (nsecs_t)N;
         renderTime += mTimeCorrection;
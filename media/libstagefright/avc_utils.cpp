@@ -31,32 +31,17 @@
 namespace android {
 
 unsigned parseUE(ABitReader *br) {
-    unsigned numZeroes = 0;
-    while (br->getBits(1) == 0) {
-        ++numZeroes;
-    }
-
-    unsigned x = br->getBits(numZeroes);
-
-    return x + (1u << numZeroes) - 1;
+    uint32_t x;
+    CHECK(br->getUEGraceful(&x));
+    return x;
 }
 
 unsigned parseUEWithFallback(ABitReader *br, unsigned fallback) {
-    unsigned numZeroes = 0;
-    while (br->getBitsWithFallback(1, 1) == 0) {
-        ++numZeroes;
-    }
     uint32_t x;
-    if (numZeroes < 32) {
-        if (br->getBitsGraceful(numZeroes, &x)) {
-            return x + (1u << numZeroes) - 1;
-        } else {
-            return fallback;
-        }
-    } else {
-        br->skipBits(numZeroes);
-        return fallback;
+    if (br->getUEGraceful(&x)) {
+        return x;
     }
+    return fallback;
 }
 
 signed parseSE(ABitReader *br) {
@@ -268,28 +253,32 @@ status_t getNextNALUnit(
         return -EAGAIN;
     }
 
-    size_t offset = 0;
-
     // A valid startcode consists of at least two 0x00 bytes followed by 0x01.
-    for (; offset + 2 < size; ++offset) {
-        if (data[offset + 2] == 0x01 && data[offset] == 0x00
-                && data[offset + 1] == 0x00) {
+    // Look for the 0x01 bytes with memchr, which scans a word or more at a
+    // time, and check the preceding bytes only there.
+    size_t offset = 2;
+    for (;;) {
+        const uint8_t *next = (const uint8_t *)memchr(&data[offset], 0x01, size - offset);
+        if (next == NULL) {
+            *_data = &data[size - 2];
+            *_size = 2;
+            return -EAGAIN;
+        }
+        offset = next - data;
+
+        if (data[offset - 1] == 0x00 && data[offset - 2] == 0x00) {
             break;
         }
+
+        ++offset;
     }
-    if (offset + 2 >= size) {
-        *_data = &data[offset];
-        *_size = 2;
-        return -EAGAIN;
-    }
-    offset += 3;
+    ++offset;
 
     size_t startOffset = offset;
 
     for (;;) {
-        while (offset < size && data[offset] != 0x01) {
-            ++offset;
-        }
+        const uint8_t *next = (const uint8_t *)memchr(&data[offset], 0x01, size - offset);
+        offset = (next == NULL) ? size : next - data;
 
         if (offset == size) {
             if (startCodeFollows) {
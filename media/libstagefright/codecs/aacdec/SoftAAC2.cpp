@@ -44,9 +44,17 @@
 #define PROP_DRC_OVERRIDE_BOOST      "aac_drc_boost"
 #define PROP_DRC_OVERRIDE_HEAVY      "aac_drc_heavy"
 #define PROP_DRC_OVERRIDE_ENC_LEVEL "aac_drc_enc_target_level"
+// error concealment methods of AAC_CONCEAL_METHOD, energy interpolation delays by one frame
+#define CONCEAL_METHOD_NOISE_SUBSTITUTION 1
+#define CONCEAL_METHOD_ENERGY_INTERPOLATION 2
 
 namespace android {
 
+// output buffers are sized for batches at up to this rate, and hold fewer frames above it
+static const int32_t kMaxBatchSampleRate = 48000;
+static const int64_t kMaxBatchTimestampJitterUs = 1000;
+static const OMX_U32 kMaxOutputBatchDurationUs = 1000000;
+
 template<class T>
 static void InitOMXParams(T *params) {
     params->nSize = sizeof(T);
@@ -77,6 +85,8 @@ SoftAAC2::SoftAAC2(
       mOutputBufferCount(0),
       mSignalledError(false),
       mLastInHeader(NULL),
+      mOutputBatchDurationUs(0),
+      mLowLatency(false),
       mOutputPortSettingsChange(NONE) {
     initPorts();
     CHECK_EQ(initDecoder(), (status_t)OK);
@@ -315,6 +325,34 @@ OMX_ERRORTYPE SoftAAC2::internalGetParameter(
             return OMX_ErrorNone;
         }
 
+        case kOutputBatchDurationIndex:
+        {
+            OMX_PARAM_U32TYPE *batchParams = (OMX_PARAM_U32TYPE *)params;
+
+            if (!isValidOMXParam(batchParams)) {
+                return OMX_ErrorBadParameter;
+            }
+
+            if (batchParams->nPortIndex != 1) {
+                return OMX_ErrorUndefined;
+            }
+
+            batchParams->nU32 = mOutputBatchDurationUs;
+            return OMX_ErrorNone;
+        }
+
+        case kLowLatencyIndex:
+        {
+            OMX_CONFIG_BOOLEANTYPE *lowLatencyParams = (OMX_CONFIG_BOOLEANTYPE *)params;
+
+            if (!isValidOMXParam(lowLatencyParams)) {
+                return OMX_ErrorBadParameter;
+            }
+
+            lowLatencyParams->bEnabled = mLowLatency ? OMX_TRUE : OMX_FALSE;
+            return OMX_ErrorNone;
+        }
+
         default:
             return SimpleSoftOMXComponent::internalGetParameter(index, params);
     }
@@ -452,11 +490,72 @@ OMX_ERRORTYPE SoftAAC2::internalSetParameter(
             return OMX_ErrorNone;
         }
 
+        case kOutputBatchDurationIndex:
+        {
+            const OMX_PARAM_U32TYPE *batchParams = (const OMX_PARAM_U32TYPE *)params;
+
+            if (!isValidOMXParam(batchParams)) {
+                return OMX_ErrorBadParameter;
+            }
+
+            if (batchParams->nPortIndex != 1) {
+                return OMX_ErrorUndefined;
+            }
+
+            if (batchParams->nU32 > kMaxOutputBatchDurationUs) {
+                return OMX_ErrorUnsupportedSetting;
+            }
+
+            // room for the batch, plus the largest frame that can end it
+            mOutputBatchDurationUs = batchParams->nU32;
+            OMX_U32 bufferSize = (OMX_U32)(
+                    ((int64_t)mOutputBatchDurationUs * kMaxBatchSampleRate / 1000000ll + 2048)
+                            * sizeof(int16_t) * MAX_CHANNEL_COUNT);
+            OMX_PARAM_PORTDEFINITIONTYPE *def = &editPortInfo(1)->mDef;
+            if (def->nBufferSize < bufferSize) {
+                def->nBufferSize = bufferSize;
+            }
+
+            return OMX_ErrorNone;
+        }
+
+        case kLowLatencyIndex:
+        {
+            const OMX_CONFIG_BOOLEANTYPE *lowLatencyParams =
+                (const OMX_CONFIG_BOOLEANTYPE *)params;
+
+            if (!isValidOMXParam(lowLatencyParams)) {
+                return OMX_ErrorBadParameter;
+            }
+
+            mLowLatency = lowLatencyParams->bEnabled == OMX_TRUE;
+            ALOGV("set low latency %d", mLowLatency);
+            // energy interpolation needs the next frame to conceal an erroneous one
+            aacDecoder_SetParam(mAACDecoder, AAC_CONCEAL_METHOD,
+                    mLowLatency ? CONCEAL_METHOD_NOISE_SUBSTITUTION
+                            : CONCEAL_METHOD_ENERGY_INTERPOLATION);
+
+            return OMX_ErrorNone;
+        }
+
         default:
             return SimpleSoftOMXComponent::internalSetParameter(index, params);
     }
 }
 
+OMX_ERRORTYPE SoftAAC2::getExtensionIndex(
+        const char *name, OMX_INDEXTYPE *index) {
+    if (!strcmp(name, "OMX.google.android.index.outputBatchDurationUs")) {
+        *(int32_t *)index = kOutputBatchDurationIndex;
+        return OMX_ErrorNone;
+    } else if (!strcmp(name, "OMX.google.android.index.lowLatency")) {
+        *(int32_t *)index = kLowLatencyIndex;
+        return OMX_ErrorNone;
+    }
+
+    return SimpleSoftOMXComponent::getExtensionIndex(name, index);
+}
+
 bool SoftAAC2::isConfigured() const {
     return mInputBufferCount > 0;
 }
@@ -541,6 +640,25 @@ int32_t SoftAAC2::outputDelayRingBufferSpaceLeft() {
     return mOutputDelayRingBufferSize - outputDelayRingBufferSamplesAvailable();
 }
 
+int32_t SoftAAC2::outputBatchFrames() {
+    int32_t frameSamples = mStreamInfo->frameSize * mStreamInfo->numChannels;
+    if (mOutputBatchDurationUs == 0 || mLowLatency || frameSamples == 0) {
+        return 1;
+    }
+    int32_t numFrames = (int32_t)((int64_t)mOutputBatchDurationUs * mStreamInfo->sampleRate
+            / (1000000ll * mStreamInfo->frameSize));
+    // leave room in the ring buffer for the next frame to be decoded
+    int32_t maxFrames = mOutputDelayRingBufferSize / frameSamples - 1;
+    if (numFrames > maxFrames) {
+        numFrames = maxFrames;
+    }
+    maxFrames = editPortInfo(1)->mDef.nBufferSize / (frameSamples * sizeof(int16_t));
+    if (numFrames > maxFrames) {
+        numFrames = maxFrames;
+    }
+    return numFrames > 1 ? numFrames : 1;
+}
+
 
 void SoftAAC2::onQueueFilled(OMX_U32 /* portIndex */) {
     if (mSignalledError || mOutputPortSettingsChange != NONE) {
@@ -834,7 +952,9 @@ void SoftAAC2::onQueueFilled(OMX_U32 /* portIndex */) {
             } while (decoderErr == AAC_DEC_OK);
         }
 
-        int32_t outputDelay = mStreamInfo->outputDelay * mStreamInfo->numChannels;
+        // in low latency mode the delay is left in, which also spares flushing it at the end
+        int32_t outputDelay =
+                mLowLatency ? 0 : mStreamInfo->outputDelay * mStreamInfo->numChannels;
 
         if (!mEndOfInput && mOutputDelayCompensated < outputDelay) {
             // discard outputDelay at the beginning
@@ -875,9 +995,13 @@ void SoftAAC2::onQueueFilled(OMX_U32 /* portIndex */) {
             }
         }
 
+        // when batching, decode the queued input buffers until there is a batch of frames,
+        // but never wait for more input to fill an output buffer
+        int32_t batchFrames = outputBatchFrames();
+        int32_t minFrames = (mEndOfInput || inQueue.empty()) ? 1 : batchFrames;
         while (!outQueue.empty()
                 && outputDelayRingBufferSamplesAvailable()
-                        >= mStreamInfo->frameSize * mStreamInfo->numChannels) {
+                        >= minFrames * mStreamInfo->frameSize * mStreamInfo->numChannels) {
             BufferInfo *outInfo = *outQueue.begin();
             OMX_BUFFERHEADERTYPE *outHeader = outInfo->mHeader;
 
@@ -910,6 +1034,9 @@ void SoftAAC2::onQueueFilled(OMX_U32 /* portIndex */) {
             if (available) {
 
                 int numFrames = numSamples / (mStreamInfo->frameSize * mStreamInfo->numChannels);
+                if (batchFrames > 1 && numFrames > batchFrames) {
+                    numFrames = batchFrames;
+                }
                 numSamples = numFrames * (mStreamInfo->frameSize * mStreamInfo->numChannels);
 
                 ALOGV("%d samples available (%d), or %d frames",
@@ -917,6 +1044,8 @@ void SoftAAC2::onQueueFilled(OMX_U32 /* portIndex */) {
                 int64_t *nextTimeStamp = &mBufferTimestamps.editItemAt(0);
                 currentTime = *nextTimeStamp;
                 int32_t *currentBufLeft = &mBufferSizes.editItemAt(0);
+                int64_t frameDurationUs = mStreamInfo->aacSamplesPerFrame *
+                        1000000ll / mStreamInfo->aacSampleRate;
                 for (int i = 0; i < numFrames; i++) {
                     int32_t decodedSize = mDecodedSizes.itemAt(0);
                     mDecodedSizes.removeAt(0);
@@ -924,8 +1053,7 @@ void SoftAAC2::onQueueFilled(OMX_U32 /* portIndex */) {
                     if (*currentBufLeft > decodedSize) {
                         // adjust/interpolate next time stamp
                         *currentBufLeft -= decodedSize;
-                        *nextTimeStamp += mStreamInfo->aacSamplesPerFrame *
-                                1000000ll / mStreamInfo->aacSampleRate;
+                        *nextTimeStamp += frameDurationUs;
                         ALOGV("adjusted nextTimeStamp/size to %lld/%d",
                                 (long long) *nextTimeStamp, *currentBufLeft);
                     } else {
@@ -938,6 +1066,17 @@ void SoftAAC2::onQueueFilled(OMX_U32 /* portIndex */) {
                             ALOGV("moved to next time/size: %lld/%d",
                                     (long long) *nextTimeStamp, *currentBufLeft);
                         }
+                        // a batch goes on with the frames of the next input buffer, as long
+                        // as they follow the previous ones
+                        if (batchFrames > 1 && i + 1 < numFrames
+                                && mBufferTimestamps.size() > 0) {
+                            int64_t driftUs =
+                                    *nextTimeStamp - (currentTime + (i + 1) * frameDurationUs);
+                            if (driftUs <= kMaxBatchTimestampJitterUs
+                                    && driftUs >= -kMaxBatchTimestampJitterUs) {
+                                continue;
+                            }
+                        }
                         // try to limit output buffer size to match input buffers
                         // (e.g when an input buffer contained 4 "sub" frames, output
                         // at most 4 decoded units in the corresponding output buffer)
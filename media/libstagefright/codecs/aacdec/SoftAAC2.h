@@ -39,6 +39,9 @@ protected:
     virtual OMX_ERRORTYPE internalSetParameter(
             OMX_INDEXTYPE index, const OMX_PTR params);
 
+    virtual OMX_ERRORTYPE getExtensionIndex(
+            const char *name, OMX_INDEXTYPE *index);
+
     virtual void onQueueFilled(OMX_U32 portIndex);
     virtual void onPortFlushCompleted(OMX_U32 portIndex);
     virtual void onPortEnableCompleted(OMX_U32 portIndex, bool enabled);
@@ -51,6 +54,11 @@ private:
         kNumDelayBlocksMax      = 8,
     };
 
+    enum {
+        kOutputBatchDurationIndex = kUseAndroidNativeBufferIndex + 1,
+        kLowLatencyIndex,
+    };
+
     HANDLE_AACDECODER mAACDecoder;
     CStreamInfo *mStreamInfo;
     bool mIsADTS;
@@ -65,6 +73,11 @@ private:
 
     CDrcPresModeWrapper mDrcWrap;
 
+    // 0 for one input buffer worth of frames per output buffer
+    OMX_U32 mOutputBatchDurationUs;
+    // outputs the frames as decoded, without the concealment and output delays
+    bool mLowLatency;
+
     enum {
         NONE,
         AWAITING_DISABLED,
@@ -75,6 +88,8 @@ private:
     status_t initDecoder();
     bool isConfigured() const;
     void drainDecoder();
+    // number of frames to gather in an output buffer, 1 when not batching
+    int32_t outputBatchFrames();
 
 //      delay compensation
     bool mEndOfInput;
@@ -86,6 +86,21 @@ else
     LOCAL_C_INCLUDES_arm += $(LOCAL_PATH)/src/asm/ARMV7
 endif
 
+LOCAL_SRC_FILES_arm64 := \
+        src/asm/ARMV8/convolve_neon.c \
+        src/asm/ARMV8/cor_h_vec_neon.c \
+        src/asm/ARMV8/Deemph_32_neon.c \
+        src/asm/ARMV8/Dot_p_neon.c \
+        src/asm/ARMV8/Filt_6k_7k_neon.c \
+        src/asm/ARMV8/Norm_Corr_neon.c \
+        src/asm/ARMV8/pred_lt4_1_neon.c \
+        src/asm/ARMV8/residu_asm_neon.c \
+        src/asm/ARMV8/scale_sig_neon.c \
+        src/asm/ARMV8/Syn_filt_32_neon.c \
+        src/asm/ARMV8/syn_filt_neon.c
+
+LOCAL_CFLAGS_arm64 := -DASM_OPT
+
 LOCAL_MODULE := libstagefright_amrwbenc
 
 LOCAL_ARM_MODE := arm
@@ -135,5 +150,29 @@ LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_SHARED_LIBRARY)
 
+################################################################################
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+        test/amrwbenc_test.cpp
+
+LOCAL_C_INCLUDES := \
+	frameworks/av/media/libstagefright/codecs/common/include
+
+LOCAL_CFLAGS += -Werror
+LOCAL_CLANG := true
+
+LOCAL_STATIC_LIBRARIES := \
+        libstagefright_amrwbenc
+
+LOCAL_SHARED_LIBRARIES := \
+        libstagefright_enc_common
+
+LOCAL_MODULE := libstagefright_amrwbenc_test
+LOCAL_MODULE_TAGS := tests
+
+include $(BUILD_EXECUTABLE)
+
 ################################################################################
 include $(call all-makefiles-under,$(LOCAL_PATH))
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+       File: Dot_p_neon.c
+
+       Description: AArch64 NEON version of Dot_product12(). The sum is
+                    accumulated on 64 bits and saturated once, which is
+                    the same as the saturation of each step of the C
+                    version for the 12 bit vectors it is used with.
+
+************************************************************************/
+
+#include <arm_neon.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "math_op.h"
+
+Word32 Dot_product12_asm(                      /* (o) Q31: normalized result (1 < val <= -1) */
+        Word16 x[],                           /* (i) 12bits: x vector                       */
+        Word16 y[],                           /* (i) 12bits: y vector                       */
+        Word16 lg,                            /* (i)    : vector length                     */
+        Word16 * exp                          /* (o)    : exponent of result (0..+30)       */
+        )
+{
+    Word16 sft;
+    Word32 i, L_sum;
+    int64_t sum;
+    int16x8_t xv, yv;
+    int64x2_t acc = vdupq_n_s64(0);
+
+    for (i = 0; i + 8 <= lg; i += 8)
+    {
+        xv = vld1q_s16(x + i);
+        yv = vld1q_s16(y + i);
+        acc = vpadalq_s32(acc, vmull_s16(vget_low_s16(xv), vget_low_s16(yv)));
+        acc = vpadalq_s32(acc, vmull_s16(vget_high_s16(xv), vget_high_s16(yv)));
+    }
+    sum = vaddvq_s64(acc);
+    for (; i < lg; i++)
+    {
+        sum += (Word32) x[i] * (Word32) y[i];
+    }
+
+    if (sum > MAX_32)
+    {
+        L_sum = MAX_32;
+    }
+    else if (sum < MIN_32)
+    {
+        L_sum = MIN_32;
+    }
+    else
+    {
+        L_sum = (Word32) sum;
+    }
+    L_sum = L_shl2(L_sum, 1);
+    L_sum = L_add(L_sum, 1);
+    /* Normalize acc in Q31 */
+    sft = norm_l(L_sum);
+    L_sum = L_sum << sft;
+    *exp = 30 - sft;            /* exponent = 0..30 */
+    return (L_sum);
+}
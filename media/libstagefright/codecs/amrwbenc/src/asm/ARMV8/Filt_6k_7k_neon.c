@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+       File: Filt_6k_7k_neon.c
+
+       Description: AArch64 NEON version of Filt_6k_7k(), eight outputs
+                    at a time, using the symmetry of the filter
+
+************************************************************************/
+
+#include <arm_neon.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "cnst.h"
+#include "acelp.h"
+
+#define L_FIR 31
+
+extern Word16 fir_6k_7k[L_FIR];
+
+void Filt_6k_7k_asm(
+        Word16 signal[],                      /* input:  signal                  */
+        Word16 lg,                            /* input:  length of input         */
+        Word16 mem[]                          /* in/out: memory (size=30)        */
+        )
+{
+    Word16 x[L_SUBFR16k + (L_FIR - 1)];
+    Word32 i, k, L_tmp;
+    int16x8_t xv;
+    int32x4_t s_lo, s_hi;
+
+    Copy(mem, x, L_FIR - 1);
+    for (i = lg - 1; i >= 0; i--)
+    {
+        x[i + L_FIR - 1] = signal[i] >> 2;                         /* gain of filter = 4 */
+    }
+
+    for (i = 0; i + 8 <= lg; i += 8)
+    {
+        /* the sums of the symmetric taps fit in 16 bits, as x[] is signal[] >> 2 */
+        xv = vld1q_s16(x + i + L_FIR / 2);
+        s_lo = vmull_n_s16(vget_low_s16(xv), fir_6k_7k[L_FIR / 2]);
+        s_hi = vmull_n_s16(vget_high_s16(xv), fir_6k_7k[L_FIR / 2]);
+        for (k = 0; k < L_FIR / 2; k++)
+        {
+            xv = vaddq_s16(vld1q_s16(x + i + k), vld1q_s16(x + i + L_FIR - 1 - k));
+            s_lo = vmlal_n_s16(s_lo, vget_low_s16(xv), fir_6k_7k[k]);
+            s_hi = vmlal_n_s16(s_hi, vget_high_s16(xv), fir_6k_7k[k]);
+        }
+        /* signal[i] = (L_tmp + 0x4000) >> 15 */
+        vst1q_s16(signal + i, vcombine_s16(vrshrn_n_s32(s_lo, 15), vrshrn_n_s32(s_hi, 15)));
+    }
+    for (; i < lg; i++)
+    {
+        L_tmp = x[i + L_FIR / 2] * fir_6k_7k[L_FIR / 2];
+        for (k = 0; k < L_FIR / 2; k++)
+        {
+            L_tmp += (x[i + k] + x[i + L_FIR - 1 - k]) * fir_6k_7k[k];
+        }
+        signal[i] = (L_tmp + 0x4000) >> 15;
+    }
+
+    Copy(x + lg, mem, L_FIR - 1);
+}
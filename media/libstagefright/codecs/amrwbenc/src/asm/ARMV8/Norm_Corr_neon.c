@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+       File: Norm_Corr_neon.c
+
+       Description: AArch64 NEON version of Norm_Corr(), the normalized
+                    correlation between the target vector and the
+                    filtered past excitation
+
+************************************************************************/
+
+#include <arm_neon.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "math_op.h"
+#include "cnst.h"
+#include "acelp.h"
+
+#define UNUSED(x) (void)(x)
+
+void Norm_corr_asm(
+        Word16 exc[],                         /* (i)     : excitation buffer                     */
+        Word16 xn[],                          /* (i)     : target vector                         */
+        Word16 h[],                           /* (i) Q15 : impulse response of synth/wgt filters */
+        Word16 L_subfr,
+        Word16 t_min,                         /* (i)     : minimum value of pitch lag.           */
+        Word16 t_max,                         /* (i)     : maximum value of pitch lag.           */
+        Word16 corr_norm[]                    /* (o) Q15 : normalized correlation                */
+        )
+{
+    Word32 i, k, t;
+    Word32 corr, exp_corr, norm, exp, scale;
+    Word16 exp_norm, tmp;
+    Word16 excf_buf[8 + L_SUBFR];
+    Word16 *excf = excf_buf + 8;          /* excf[-1] is 0, for the update of excf[0] */
+    Word32 L_tmp, L_tmp1, L_tmp2;
+    int16x8_t xv, ev;
+    int32x4_t s, s1;
+    UNUSED(L_subfr);
+
+    /* compute the filtered excitation for the first delay t_min */
+    k = -t_min;
+    Convolve_asm(&exc[k], h, excf, 64);
+    excf[-1] = 0;
+
+    /* Compute rounded down 1/sqrt(energy of xn[]) */
+    s = vdupq_n_s32(0);
+    for (i = 0; i < 64; i += 8)
+    {
+        xv = vld1q_s16(xn + i);
+        s = vmlal_s16(s, vget_low_s16(xv), vget_low_s16(xv));
+        s = vmlal_s16(s, vget_high_s16(xv), vget_high_s16(xv));
+    }
+    L_tmp = vaddvq_s32(s);
+
+    L_tmp = L_add(L_shl(L_tmp, 1), 1);
+    exp = norm_l(L_tmp);
+    exp = L_sub(32, exp);
+    scale = -(exp >> 1);           /* (1<<scale) < 1/sqrt(energy rounded) */
+
+    /* loop for every possible period */
+
+    for (t = t_min; t <= t_max; t++)
+    {
+        /* Compute correlation between xn[] and excf[] */
+        s = vdupq_n_s32(0);
+        s1 = vdupq_n_s32(0);
+        for (i = 0; i < 64; i += 8)
+        {
+            xv = vld1q_s16(xn + i);
+            ev = vld1q_s16(excf + i);
+            s = vmlal_s16(s, vget_low_s16(xv), vget_low_s16(ev));
+            s = vmlal_s16(s, vget_high_s16(xv), vget_high_s16(ev));
+            s1 = vmlal_s16(s1, vget_low_s16(ev), vget_low_s16(ev));
+            s1 = vmlal_s16(s1, vget_high_s16(ev), vget_high_s16(ev));
+        }
+        L_tmp = vaddvq_s32(s);
+        L_tmp1 = vaddvq_s32(s1);
+
+        L_tmp = L_add(L_shl(L_tmp, 1), 1);
+        L_tmp1 = L_add(L_shl(L_tmp1, 1), 1);
+
+        exp = norm_l(L_tmp);
+        L_tmp = L_shl(L_tmp, exp);
+        exp_corr = L_sub(30, exp);
+        corr = extract_h(L_tmp);
+
+        exp = norm_l(L_tmp1);
+        L_tmp = L_shl(L_tmp1, exp);
+        exp_norm = L_sub(30, exp);
+
+        Isqrt_n(&L_tmp, &exp_norm);
+        norm = extract_h(L_tmp);
+
+        /* Normalize correlation = correlation * (1/sqrt(energy)) */
+
+        L_tmp = L_mult(corr, norm);
+
+        L_tmp2 = L_add(exp_corr, exp_norm + scale);
+        if(L_tmp2 < 0)
+        {
+            L_tmp2 = -L_tmp2;
+            L_tmp = L_tmp >> L_tmp2;
+        }
+        else
+        {
+            L_tmp = L_shl(L_tmp, L_tmp2);
+        }
+
+        corr_norm[t] = voround(L_tmp);
+        /* modify the filtered excitation excf[] for the next iteration */
+
+        if(t != t_max)
+        {
+            /* excf[i] = excf[i - 1] + (tmp * h[i]) >> 15, from the end, as each block
+               of outputs is stored after the excf[i - 1] it needs are loaded */
+            k = -(t + 1);
+            tmp = exc[k];
+            for (i = 56; i >= 0; i -= 8)
+            {
+                ev = vld1q_s16(excf + i - 1);
+                xv = vld1q_s16(h + i);
+                xv = vcombine_s16(vshrn_n_s32(vmull_n_s16(vget_low_s16(xv), tmp), 15),
+                        vshrn_n_s32(vmull_n_s16(vget_high_s16(xv), tmp), 15));
+                vst1q_s16(excf + i, vaddq_s16(xv, ev));
+            }
+        }
+    }
+    return;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+       File: Syn_filt_32_neon.c
+
+       Description: AArch64 NEON version of Syn_filt_32(), with the
+                    arithmetic of the ARMv7 version: the taps a[1..M]
+                    are subtracted from both the high and low parts.
+
+************************************************************************/
+
+#include <arm_neon.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "cnst.h"
+#include "acelp.h"
+
+#define UNUSED(x) (void)(x)
+
+void Syn_filt_32_asm(
+        Word16 a[],                           /* (i) Q12 : a[m+1] prediction coefficients */
+        Word16 m,                             /* (i)     : order of LP filter             */
+        Word16 exc[],                         /* (i) Qnew: excitation (exc[i] >> Qnew)    */
+        Word16 Qnew,                          /* (i)     : exc scaling = 0(min) to 8(max) */
+        Word16 sig_hi[],                      /* (o) /16 : synthesis high                 */
+        Word16 sig_lo[],                      /* (o) /16 : synthesis low                  */
+        Word16 lg                             /* (i)     : size of filtering              */
+        )
+{
+    Word32 i, a0, L_tmp, L_lo, L_hi;
+    Word16 a_rev[M];
+    int16x8_t a_lo, a_hi, v_lo, v_hi;
+    int32x4_t s_lo, s_hi;
+    UNUSED(m);
+
+    /* a_rev[j] = a[M - j] multiplies sig[i - M + j] */
+    for (i = 0; i < M; i++)
+    {
+        a_rev[i] = a[M - i];
+    }
+    a_lo = vld1q_s16(a_rev);
+    a_hi = vld1q_s16(a_rev + 8);
+    a0 = a[0] >> (4 + Qnew);          /* input / 16 and >>Qnew */
+
+    for (i = 0; i < lg; i++)
+    {
+        v_lo = vld1q_s16(sig_lo + i - M);
+        v_hi = vld1q_s16(sig_lo + i - 8);
+        s_lo = vmull_s16(vget_low_s16(v_lo), vget_low_s16(a_lo));
+        s_lo = vmlal_s16(s_lo, vget_high_s16(v_lo), vget_high_s16(a_lo));
+        s_lo = vmlal_s16(s_lo, vget_low_s16(v_hi), vget_low_s16(a_hi));
+        s_lo = vmlal_s16(s_lo, vget_high_s16(v_hi), vget_high_s16(a_hi));
+
+        v_lo = vld1q_s16(sig_hi + i - M);
+        v_hi = vld1q_s16(sig_hi + i - 8);
+        s_hi = vmull_s16(vget_low_s16(v_lo), vget_low_s16(a_lo));
+        s_hi = vmlal_s16(s_hi, vget_high_s16(v_lo), vget_high_s16(a_lo));
+        s_hi = vmlal_s16(s_hi, vget_low_s16(v_hi), vget_low_s16(a_hi));
+        s_hi = vmlal_s16(s_hi, vget_high_s16(v_hi), vget_high_s16(a_hi));
+
+        L_lo = -vaddvq_s32(s_lo);
+        L_hi = vaddvq_s32(s_hi);
+
+        L_tmp = vo_L_mult(exc[i], a0) + (L_lo >> 11) - (L_hi << 1);
+        L_tmp <<= 3;                  /* ai in Q12 */
+
+        /* sig_hi = bit16 to bit31 of synthesis */
+        sig_hi[i] = extract_h(L_tmp);
+
+        /* sig_lo = bit4 to bit15 of synthesis */
+        L_tmp >>= 4;                  /* 4 : sig_lo[i] >> 4 */
+        sig_lo[i] = (Word16)(L_tmp - (sig_hi[i] << 12));
+    }
+    return;
+}
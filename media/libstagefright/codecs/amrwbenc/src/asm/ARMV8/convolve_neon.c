@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+       File: convolve_neon.c
+
+       Description: AArch64 NEON version of Convolve(), eight outputs
+                    at a time. Each output adds its products with
+                    saturation and in the same order as the C version,
+                    which makes them bit exact.
+
+************************************************************************/
+
+#include <arm_neon.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "cnst.h"
+#include "acelp.h"
+
+#define UNUSED(x) (void)(x)
+
+void Convolve_asm(
+        Word16 x[],        /* (i)     : input vector                           */
+        Word16 h[],        /* (i)     : impulse response                       */
+        Word16 y[],        /* (o)     : output vector                          */
+        Word16 L           /* (i)     : vector size                            */
+        )
+{
+    Word32 i, n;
+    Word16 h_buf[8 + L_SUBFR];
+    Word16 *hz = h_buf + 8;         /* h[] preceded by zeros, for h[n - i] with i > n */
+    int32x4_t s_lo, s_hi;
+    int16x8_t hv;
+    UNUSED(L);
+
+    vst1q_s16(h_buf, vdupq_n_s16(0));
+    for (i = 0; i < L_SUBFR; i += 8)
+    {
+        vst1q_s16(hz + i, vld1q_s16(h + i));
+    }
+
+    for (n = 0; n < L_SUBFR; n += 8)
+    {
+        /* lane j accumulates x[i] * h[n + j - i], like L_add() */
+        s_lo = vdupq_n_s32(0);
+        s_hi = vdupq_n_s32(0);
+        for (i = 0; i < n + 8; i++)
+        {
+            hv = vld1q_s16(hz + n - i);
+            s_lo = vqaddq_s32(s_lo, vmull_n_s16(vget_low_s16(hv), x[i]));
+            s_hi = vqaddq_s32(s_hi, vmull_n_s16(vget_high_s16(hv), x[i]));
+        }
+        /* y[n] = voround(L_shl(s, 1)) */
+        vst1q_s16(y + n, vcombine_s16(vqrshrn_n_s32(vqshlq_n_s32(s_lo, 1), 16),
+                    vqrshrn_n_s32(vqshlq_n_s32(s_hi, 1), 16)));
+    }
+    return;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+       File: cor_h_vec_neon.c
+
+       Description: AArch64 NEON version of cor_h_vec_012(), the
+                    correlations of h[] with vec[] for tracks 0 to 2
+
+************************************************************************/
+
+#include <arm_neon.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "math_op.h"
+
+#define L_SUBFR   64
+#define NB_POS    16
+#define STEP      4
+
+/* sum of h[k] * v[k] for k = 0..n-1 */
+static inline Word32 dot_h(const Word16 *h, const Word16 *v, Word32 n)
+{
+    Word32 k, L_sum;
+    int16x8_t hv, vv;
+    int32x4_t s = vdupq_n_s32(0);
+
+    for (k = 0; k + 8 <= n; k += 8)
+    {
+        hv = vld1q_s16(h + k);
+        vv = vld1q_s16(v + k);
+        s = vmlal_s16(s, vget_low_s16(hv), vget_low_s16(vv));
+        s = vmlal_s16(s, vget_high_s16(hv), vget_high_s16(vv));
+    }
+    L_sum = vaddvq_s32(s);
+    for (; k < n; k++)
+    {
+        L_sum += h[k] * v[k];
+    }
+    return L_sum;
+}
+
+void cor_h_vec_012_asm(
+        Word16 h[],                           /* (i) scaled impulse response                 */
+        Word16 vec[],                         /* (i) scaled vector (/8) to correlate with h[] */
+        Word16 track,                         /* (i) track to use                            */
+        Word16 sign[],                        /* (i) sign vector                             */
+        Word16 rrixix[][NB_POS],              /* (i) correlation of h[x] with h[x]      */
+        Word16 cor_1[],                       /* (o) result of correlation (NB_POS elements) */
+        Word16 cor_2[]                        /* (o) result of correlation (NB_POS elements) */
+        )
+{
+    Word32 i, pos, corr;
+    Word16 *p0, *p3;
+    Word32 L_sum1, L_sum2;
+
+    p0 = rrixix[track];
+    p3 = rrixix[track + 1];
+    pos = track;
+
+    for (i = 0; i < NB_POS; i++)
+    {
+        L_sum1 = dot_h(h, &vec[pos], L_SUBFR - pos);
+        L_sum2 = dot_h(h, &vec[pos + 1], L_SUBFR - 1 - pos);
+        L_sum1 = L_shl(L_sum1, 2);
+        L_sum2 = L_shl(L_sum2, 2);
+
+        corr = voround(L_sum1);
+        cor_1[i] = vo_mult(corr, sign[pos]) + (*p0++);
+        corr = voround(L_sum2);
+        cor_2[i] = vo_mult(corr, sign[pos + 1]) + (*p3++);
+        pos += STEP;
+    }
+    return;
+}
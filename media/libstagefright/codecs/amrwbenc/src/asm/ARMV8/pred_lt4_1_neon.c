@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+       File: pred_lt4_1_neon.c
+
+       Description: AArch64 NEON version of Pred_lt4(). The outputs are
+                    computed one after the other, as exc[j] may depend
+                    on the ones before it.
+
+************************************************************************/
+
+#include <arm_neon.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "acelp.h"
+
+#define UP_SAMP      4
+#define L_INTERPOL2  16
+
+extern Word16 inter4_2[UP_SAMP][2 * L_INTERPOL2];
+
+void pred_lt4_asm(
+        Word16 exc[],                         /* in/out: excitation buffer */
+        Word16 T0,                            /* input : integer pitch lag */
+        Word16 frac,                          /* input : fraction of lag   */
+        Word16 L_subfr                        /* input : subframe size     */
+        )
+{
+    Word32 j, L_sum;
+    Word16 *x, *ptr;
+    int16x8_t c0, c1, c2, c3, x0, x1, x2, x3;
+    int32x4_t s;
+
+    x = exc - T0;
+    frac = -frac;
+    if (frac < 0)
+    {
+        frac += UP_SAMP;
+        x--;
+    }
+    x -= L_INTERPOL2 - 1;
+    ptr = inter4_2[UP_SAMP - 1 - frac];
+
+    c0 = vld1q_s16(ptr);
+    c1 = vld1q_s16(ptr + 8);
+    c2 = vld1q_s16(ptr + 16);
+    c3 = vld1q_s16(ptr + 24);
+
+    for (j = 0; j < L_subfr; j++)
+    {
+        x0 = vld1q_s16(x);
+        x1 = vld1q_s16(x + 8);
+        x2 = vld1q_s16(x + 16);
+        x3 = vld1q_s16(x + 24);
+
+        s = vmull_s16(vget_low_s16(x0), vget_low_s16(c0));
+        s = vmlal_s16(s, vget_high_s16(x0), vget_high_s16(c0));
+        s = vmlal_s16(s, vget_low_s16(x1), vget_low_s16(c1));
+        s = vmlal_s16(s, vget_high_s16(x1), vget_high_s16(c1));
+        s = vmlal_s16(s, vget_low_s16(x2), vget_low_s16(c2));
+        s = vmlal_s16(s, vget_high_s16(x2), vget_high_s16(c2));
+        s = vmlal_s16(s, vget_low_s16(x3), vget_low_s16(c3));
+        s = vmlal_s16(s, vget_high_s16(x3), vget_high_s16(c3));
+        L_sum = vaddvq_s32(s);
+
+        L_sum = L_shl2(L_sum, 2);
+        exc[j] = extract_h(L_add(L_sum, 0x8000));
+        x++;
+    }
+    return;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+       File: residu_asm_neon.c
+
+       Description: AArch64 NEON version of Residu(), eight outputs at a
+                    time
+
+************************************************************************/
+
+#include <arm_neon.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "cnst.h"
+#include "acelp.h"
+
+void Residu_opt(
+        Word16 a[],                           /* (i) Q12 : prediction coefficients                     */
+        Word16 x[],                           /* (i)     : speech (values x[-m..-1] are needed         */
+        Word16 y[],                           /* (o) x2  : residual signal                             */
+        Word16 lg                             /* (i)     : size of filtering                           */
+        )
+{
+    Word32 i, k, s;
+    int16x8_t xv;
+    int32x4_t s_lo, s_hi;
+
+    for (i = 0; i + 8 <= lg; i += 8)
+    {
+        s_lo = vdupq_n_s32(0);
+        s_hi = vdupq_n_s32(0);
+        for (k = 0; k <= M; k++)
+        {
+            xv = vld1q_s16(x + i - k);
+            s_lo = vmlal_n_s16(s_lo, vget_low_s16(xv), a[k]);
+            s_hi = vmlal_n_s16(s_hi, vget_high_s16(xv), a[k]);
+        }
+        /* y[i] = extract_h(L_add(L_shl2(s, 5), 0x8000)) */
+        vst1q_s16(y + i, vcombine_s16(vqrshrn_n_s32(vqshlq_n_s32(s_lo, 5), 16),
+                    vqrshrn_n_s32(vqshlq_n_s32(s_hi, 5), 16)));
+    }
+    for (; i < lg; i++)
+    {
+        s = 0;
+        for (k = 0; k <= M; k++)
+        {
+            s += vo_mult32(a[k], x[i - k]);
+        }
+        s = L_shl2(s, 5);
+        y[i] = extract_h(L_add(s, 0x8000));
+    }
+    return;
+}
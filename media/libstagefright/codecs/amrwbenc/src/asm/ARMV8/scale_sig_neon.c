@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+       File: scale_sig_neon.c
+
+       Description: AArch64 NEON version of Scale_sig(), eight samples
+                    at a time
+
+************************************************************************/
+
+#include <arm_neon.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "acelp.h"
+
+void Scale_sig_opt(
+        Word16 x[],                           /* (i/o) : signal to scale               */
+        Word16 lg,                            /* (i)   : size of x[]                   */
+        Word16 exp                            /* (i)   : exponent: x = round(x << exp) */
+        )
+{
+    Word32 i;
+    Word32 L_tmp;
+    int16x8_t xv;
+    int32x4_t shift;
+
+    if (exp > 0)
+    {
+        /* x = extract_h(L_add(L_shl2(x, 16 + exp), 0x8000)) */
+        shift = vdupq_n_s32(16 + exp);
+        for (i = 0; i + 8 <= lg; i += 8)
+        {
+            xv = vld1q_s16(x + i);
+            vst1q_s16(x + i, vcombine_s16(
+                        vqrshrn_n_s32(vqshlq_s32(vmovl_s16(vget_low_s16(xv)), shift), 16),
+                        vqrshrn_n_s32(vqshlq_s32(vmovl_s16(vget_high_s16(xv)), shift), 16)));
+        }
+        for (; i < lg; i++)
+        {
+            L_tmp = L_shl2(x[i], 16 + exp);
+            x[i] = extract_h(L_add(L_tmp, 0x8000));
+        }
+    }
+    else
+    {
+        /* x = ((x << 16 >> -exp) + 0x8000) >> 16, which cannot overflow */
+        shift = vdupq_n_s32(exp);
+        for (i = 0; i + 8 <= lg; i += 8)
+        {
+            xv = vld1q_s16(x + i);
+            vst1q_s16(x + i, vcombine_s16(
+                        vrshrn_n_s32(vshlq_s32(vshll_n_s16(vget_low_s16(xv), 16), shift), 16),
+                        vrshrn_n_s32(vshlq_s32(vshll_n_s16(vget_high_s16(xv), 16), shift), 16)));
+        }
+        exp = -exp;
+        for (; i < lg; i++)
+        {
+            L_tmp = x[i] << 16;
+            L_tmp >>= exp;
+            x[i] = (L_tmp + 0x8000)>>16;
+        }
+    }
+    return;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+       File: syn_filt_neon.c
+
+       Description: AArch64 NEON version of Syn_filt() for the
+                    L_SUBFR16k samples of the high band, with the update
+                    of the memory
+
+************************************************************************/
+
+#include <arm_neon.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "cnst.h"
+#include "acelp.h"
+
+void Syn_filt_asm(
+        Word16 a[],                           /* (i) Q12 : a[m+1] prediction coefficients           */
+        Word16 x[],                           /* (i)     : input signal                             */
+        Word16 y[],                           /* (o)     : output signal                            */
+        Word16 mem[]                          /* (i/o)   : memory associated with this filtering.   */
+        )
+{
+    Word32 i, a0, L_tmp;
+    Word16 y_buf[L_SUBFR16k + M];
+    Word16 *yy = y_buf + M;
+    Word16 a_rev[M];
+    int16x8_t a_lo, a_hi, y_lo, y_hi;
+    int32x4_t s;
+
+    /* a_rev[j] = a[M - j] multiplies yy[i - M + j] */
+    for (i = 0; i < M; i++)
+    {
+        y_buf[i] = mem[i];
+        a_rev[i] = a[M - i];
+    }
+    a_lo = vld1q_s16(a_rev);
+    a_hi = vld1q_s16(a_rev + 8);
+    a0 = (a[0] >> 1);                     /* input / 2 */
+
+    for (i = 0; i < L_SUBFR16k; i++)
+    {
+        y_lo = vld1q_s16(yy + i - M);
+        y_hi = vld1q_s16(yy + i - 8);
+        s = vmull_s16(vget_low_s16(y_lo), vget_low_s16(a_lo));
+        s = vmlal_s16(s, vget_high_s16(y_lo), vget_high_s16(a_lo));
+        s = vmlal_s16(s, vget_low_s16(y_hi), vget_low_s16(a_hi));
+        s = vmlal_s16(s, vget_high_s16(y_hi), vget_high_s16(a_hi));
+
+        L_tmp = vo_mult32(a0, x[i]) - vaddvq_s32(s);
+        L_tmp = L_shl2(L_tmp, 4);
+        y[i] = yy[i] = extract_h(L_add(L_tmp, 0x8000));
+    }
+
+    for (i = 0; i < M; i++)
+    {
+        mem[i] = yy[L_SUBFR16k - M + i];
+    }
+    return;
+}
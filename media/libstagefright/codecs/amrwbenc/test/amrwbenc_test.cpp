@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the speed of the AMR-WB encoder in each of its modes, on a raw 16 kHz mono
+// 16-bit input file or, without one, on a synthetic voiced signal. Prints the time taken
+// per frame, how many times faster than real time the encoder runs, and a checksum of the
+// bitstream, to compare the outputs of builds with different versions of the DSP kernels.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cmnMemory.h"
+#include "voAMRWB.h"
+
+enum {
+    kSampleRate     = 16000,
+    kFrameSamples   = 320,      // 20 ms
+    kOutputSize     = 1024,
+    kDefaultFrames  = 1500,     // 30 s, a short voice call
+};
+
+static const char *kModeNames[VOAMRWB_N_MODES] = {
+    "6.60", "8.85", "12.65", "14.25", "15.85", "18.25", "19.85", "23.05", "23.85",
+};
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-m mode] [-n frames] [input.raw]\n", me);
+    fprintf(stderr, "  -m mode    only encode in mode 0 (6.60 kbps) to 8 (23.85 kbps)\n");
+    fprintf(stderr, "  -n frames  number of synthetic 20 ms frames, default %d\n",
+            kDefaultFrames);
+}
+
+// A voiced signal with a gliding pitch, cut into syllables, over a little noise.
+static void synthesizeSpeech(int16_t *pcm, int numSamples) {
+    const double kPi = 3.14159265358979323846;
+    double phase = 0;
+    uint32_t seed = 1;
+
+    for (int n = 0; n < numSamples; ++n) {
+        const double t = (double)n / kSampleRate;
+        const double pitchHz = 140 + 60 * sin(2 * kPi * t / 2.3);
+        phase += 2 * kPi * pitchHz / kSampleRate;
+
+        double voiced = 0;
+        for (int k = 1; k * pitchHz < 4000; ++k) {
+            voiced += sin(k * phase) / k;
+        }
+        const double envelope = fmod(t, 1.5) < 1.2 ? 0.5 - 0.5 * cos(2 * kPi * 4 * t) : 0;
+
+        seed = seed * 1103515245 + 12345;
+        const double noise = (double)((seed >> 16) & 0x7fff) / 0x8000 - 0.5;
+
+        pcm[n] = (int16_t)(6000 * envelope * voiced + 100 * noise);
+    }
+}
+
+static double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Encodes the numFrames frames of pcm in the given mode, returning the time taken by the
+// encoder and an FNV-1a hash of the bitstream.
+static bool encode(int mode, const int16_t *pcm, int numFrames,
+        double *seconds, uint32_t *checksum) {
+    VO_AUDIO_CODECAPI api;
+    if (voGetAMRWBEncAPI(&api) != VO_ERR_NONE) {
+        fprintf(stderr, "Failed to get the encoder API\n");
+        return false;
+    }
+
+    VO_MEM_OPERATOR memOperator;
+    memOperator.Alloc = cmnMemAlloc;
+    memOperator.Copy = cmnMemCopy;
+    memOperator.Free = cmnMemFree;
+    memOperator.Set = cmnMemSet;
+    memOperator.Check = cmnMemCheck;
+
+    VO_CODEC_INIT_USERDATA userData;
+    memset(&userData, 0, sizeof(userData));
+    userData.memflag = VO_IMF_USERMEMOPERATOR;
+    userData.memData = (VO_PTR)&memOperator;
+
+    VO_HANDLE handle;
+    if (api.Init(&handle, VO_AUDIO_CodingAMRWB, &userData) != VO_ERR_NONE) {
+        fprintf(stderr, "Failed to init the encoder\n");
+        return false;
+    }
+
+    bool ok = true;
+    VOAMRWBFRAMETYPE frameType = VOAMRWB_RFC3267;
+    VOAMRWBMODE wbMode = (VOAMRWBMODE)mode;
+    int16_t allowDtx = 0;
+    if (api.SetParam(handle, VO_PID_AMRWB_FRAMETYPE, &frameType) != VO_ERR_NONE
+            || api.SetParam(handle, VO_PID_AMRWB_MODE, &wbMode) != VO_ERR_NONE
+            || api.SetParam(handle, VO_PID_AMRWB_DTX, &allowDtx) != VO_ERR_NONE) {
+        fprintf(stderr, "Failed to configure the encoder\n");
+        ok = false;
+    }
+
+    uint8_t output[kOutputSize];
+    uint32_t hash = 2166136261u;
+    double elapsed = 0;
+
+    for (int i = 0; ok && i < numFrames; ++i) {
+        VO_CODECBUFFER inData;
+        memset(&inData, 0, sizeof(inData));
+        inData.Buffer = (VO_PBYTE)(pcm + i * kFrameSamples);
+        inData.Length = kFrameSamples * sizeof(int16_t);
+
+        VO_CODECBUFFER outData;
+        memset(&outData, 0, sizeof(outData));
+        outData.Buffer = output;
+        outData.Length = sizeof(output);
+        VO_AUDIO_OUTPUTINFO outInfo;
+        memset(&outInfo, 0, sizeof(outInfo));
+
+        const double start = nowSeconds();
+        VO_U32 err = api.SetInputData(handle, &inData);
+        if (err == VO_ERR_NONE) {
+            err = api.GetOutputData(handle, &outData, &outInfo);
+        }
+        elapsed += nowSeconds() - start;
+
+        if (err != VO_ERR_NONE) {
+            fprintf(stderr, "Failed to encode frame %d: 0x%x\n", i, (unsigned)err);
+            ok = false;
+            break;
+        }
+        for (VO_U32 k = 0; k < outData.Length; ++k) {
+            hash = (hash ^ output[k]) * 16777619u;
+        }
+    }
+
+    api.Uninit(handle);
+    *seconds = elapsed;
+    *checksum = hash;
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    int onlyMode = -1;
+    int numFrames = kDefaultFrames;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:n:")) != -1) {
+        switch (opt) {
+        case 'm':
+            onlyMode = atoi(optarg);
+            break;
+        case 'n':
+            numFrames = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (onlyMode >= VOAMRWB_N_MODES || numFrames <= 0 || argc - optind > 1) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int16_t *pcm = NULL;
+    if (optind < argc) {
+        FILE *file = fopen(argv[optind], "rb");
+        if (file == NULL) {
+            fprintf(stderr, "Error opening input file %s\n", argv[optind]);
+            return EXIT_FAILURE;
+        }
+        fseek(file, 0, SEEK_END);
+        const long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        numFrames = size > 0 ? (int)(size / (kFrameSamples * sizeof(int16_t))) : 0;
+        if (numFrames > 0) {
+            pcm = (int16_t *)malloc(numFrames * kFrameSamples * sizeof(int16_t));
+        }
+        if (pcm == NULL
+                || fread(pcm, kFrameSamples * sizeof(int16_t), numFrames, file)
+                        != (size_t)numFrames) {
+            fprintf(stderr, "Error reading input file %s\n", argv[optind]);
+            fclose(file);
+            free(pcm);
+            return EXIT_FAILURE;
+        }
+        fclose(file);
+    } else {
+        pcm = (int16_t *)malloc(numFrames * kFrameSamples * sizeof(int16_t));
+        if (pcm == NULL) {
+            return EXIT_FAILURE;
+        }
+        synthesizeSpeech(pcm, numFrames * kFrameSamples);
+    }
+
+    const double audioSeconds = (double)numFrames * kFrameSamples / kSampleRate;
+    int retVal = EXIT_SUCCESS;
+    for (int mode = 0; mode < VOAMRWB_N_MODES; ++mode) {
+        if (onlyMode >= 0 && mode != onlyMode) {
+            continue;
+        }
+        double seconds;
+        uint32_t checksum;
+        if (!encode(mode, pcm, numFrames, &seconds, &checksum)) {
+            retVal = EXIT_FAILURE;
+            break;
+        }
+        printf("mode %d (%5s kbps): %d frames, %7.1f us/frame, %6.1fx real time,"
+                " checksum %08x\n", mode, kModeNames[mode], numFrames,
+                seconds * 1e6 / numFrames, audioSeconds / seconds, checksum);
+    }
+
+    free(pcm);
+    return retVal;
+}
@@ -29,6 +29,7 @@ int AVCSAD_Blk_HalfPel_C(uint8 *ref,uint8 *blk,int dmin,int width,int rx,int xh,
 
 #include "avcenc_lib.h"
 #include "sad_halfpel_inline.h"
+#include "sad_neon_inline.h"
 
 #ifdef _SAD_STAT
 uint32 num_sad_HP_MB = 0;
@@ -78,6 +79,10 @@ int AVCSAD_MB_HalfPel_Cxhyh(uint8 *ref, uint8 *blk, int dmin_rx, void *extra_inf
 
     NUM_SAD_HP_MB_CALL();
 
+#ifdef PV_NEON_SAD
+    return neon_sad_mb_halfpel2(ref, blk, (int)((uint32)dmin_rx >> 16), rx);
+#endif
+
     p1 = ref;
     p2 = ref + 1;
     p3 = ref + rx;
@@ -119,6 +124,10 @@ int AVCSAD_MB_HalfPel_Cyh(uint8 *ref, uint8 *blk, int dmin_rx, void *extra_info)
 
     NUM_SAD_HP_MB_CALL();
 
+#ifdef PV_NEON_SAD
+    return neon_sad_mb_halfpel1(ref, ref + rx, blk, (int)((uint32)dmin_rx >> 16), rx);
+#endif
+
     p1 = ref;
     p2 = ref + rx; /* either left/right or top/bottom pixel */
     kk  = blk;
@@ -154,6 +163,10 @@ int AVCSAD_MB_HalfPel_Cxh(uint8 *ref, uint8 *blk, int dmin_rx, void *extra_info)
 
     NUM_SAD_HP_MB_CALL();
 
+#ifdef PV_NEON_SAD
+    return neon_sad_mb_halfpel1(ref, ref + 1, blk, (int)((uint32)dmin_rx >> 16), rx);
+#endif
+
     p1 = ref;
     kk  = blk;
 
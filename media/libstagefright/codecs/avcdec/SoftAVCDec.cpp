@@ -136,30 +136,17 @@ SoftAVC::~SoftAVC() {
     CHECK_EQ(deInitDecoder(), (status_t)OK);
 }
 
+// The memory context of the decoder is the component, whose frame pool keeps the frames
+// freed on a resolution change for the next resolution.
 static void *ivd_aligned_malloc(void *ctxt, WORD32 alignment, WORD32 size) {
-    UNUSED(ctxt);
-    return memalign(alignment, size);
+    return static_cast<SoftAVC *>(ctxt)->allocateFrameMemory(alignment, size);
 }
 
 static void ivd_aligned_free(void *ctxt, void *buf) {
-    UNUSED(ctxt);
-    free(buf);
+    static_cast<SoftAVC *>(ctxt)->freeFrameMemory(buf);
     return;
 }
 
-static size_t GetCPUCoreCount() {
-    long cpuCoreCount = 1;
-#if defined(_SC_NPROCESSORS_ONLN)
-    cpuCoreCount = sysconf(_SC_NPROCESSORS_ONLN);
-#else
-    // _SC_NPROC_ONLN must be defined...
-    cpuCoreCount = sysconf(_SC_NPROC_ONLN);
-#endif
-    CHECK(cpuCoreCount >= 1);
-    ALOGV("Number of CPU cores: %ld", cpuCoreCount);
-    return (size_t)cpuCoreCount;
-}
-
 void SoftAVC::logVersion() {
     ivd_ctl_getversioninfo_ip_t s_ctl_ip;
     ivd_ctl_getversioninfo_op_t s_ctl_op;
@@ -253,9 +240,10 @@ status_t SoftAVC::setNumCores() {
     ivdext_ctl_set_num_cores_ip_t s_set_cores_ip;
     ivdext_ctl_set_num_cores_op_t s_set_cores_op;
     IV_API_CALL_STATUS_T status;
+    mNumCores = acquireDecodeThreads(CODEC_MAX_NUM_CORES);
     s_set_cores_ip.e_cmd = IVD_CMD_VIDEO_CTL;
     s_set_cores_ip.e_sub_cmd = IVDEXT_CMD_CTL_SET_NUM_CORES;
-    s_set_cores_ip.u4_num_cores = MIN(mNumCores, CODEC_MAX_NUM_CORES);
+    s_set_cores_ip.u4_num_cores = mNumCores;
     s_set_cores_ip.u4_size = sizeof(ivdext_ctl_set_num_cores_ip_t);
     s_set_cores_op.u4_size = sizeof(ivdext_ctl_set_num_cores_op_t);
     status = ivdec_api_function(
@@ -295,10 +283,9 @@ status_t SoftAVC::setFlushMode() {
 status_t SoftAVC::initDecoder() {
     IV_API_CALL_STATUS_T status;
 
-    mNumCores = GetCPUCoreCount();
     mCodecCtx = NULL;
 
-    mStride = outputBufferWidth();
+    mStride = outputBufferStride();
 
     /* Initialize the decoder */
     {
@@ -314,7 +301,7 @@ status_t SoftAVC::initDecoder() {
         s_create_ip.s_ivd_create_ip_t.e_output_format = mIvColorFormat;
         s_create_ip.s_ivd_create_ip_t.pf_aligned_alloc = ivd_aligned_malloc;
         s_create_ip.s_ivd_create_ip_t.pf_aligned_free = ivd_aligned_free;
-        s_create_ip.s_ivd_create_ip_t.pv_mem_ctxt = NULL;
+        s_create_ip.s_ivd_create_ip_t.pv_mem_ctxt = this;
 
         status = ivdec_api_function(mCodecCtx, (void *)&s_create_ip, (void *)&s_create_op);
 
@@ -351,6 +338,8 @@ status_t SoftAVC::deInitDecoder() {
     size_t i;
     IV_API_CALL_STATUS_T status;
 
+    releaseDecodeThreads();
+
     if (mCodecCtx) {
         ivdext_delete_ip_t s_delete_ip;
         ivdext_delete_op_t s_delete_op;
@@ -430,7 +419,7 @@ bool SoftAVC::setDecodeArgs(
         OMX_BUFFERHEADERTYPE *inHeader,
         OMX_BUFFERHEADERTYPE *outHeader,
         size_t timeStampIx) {
-    size_t sizeY = outputBufferWidth() * outputBufferHeight();
+    size_t sizeY = outputBufferStride() * outputBufferHeight();
     size_t sizeUV;
 
     ps_dec_ip->u4_size = sizeof(ivd_video_decode_ip_t);
@@ -456,21 +445,22 @@ bool SoftAVC::setDecodeArgs(
     ps_dec_ip->s_out_buffer.u4_min_out_buf_size[1] = sizeUV;
     ps_dec_ip->s_out_buffer.u4_min_out_buf_size[2] = sizeUV;
 
-    uint8_t *pBuf;
+    OutputPlanes planes;
     if (outHeader) {
-        if (outHeader->nAllocLen < sizeY + (sizeUV * 2)) {
-            android_errorWriteLog(0x534e4554, "27833616");
+        // unlocked once decoded
+        if (!lockOutputBuffer(outHeader, &planes)) {
             return false;
         }
-        pBuf = outHeader->pBuffer;
     } else {
         // mFlushOutBuffer always has the right size.
-        pBuf = mFlushOutBuffer;
+        planes.mY = mFlushOutBuffer;
+        planes.mU = mFlushOutBuffer + sizeY;
+        planes.mV = mFlushOutBuffer + sizeY + sizeUV;
     }
 
-    ps_dec_ip->s_out_buffer.pu1_bufs[0] = pBuf;
-    ps_dec_ip->s_out_buffer.pu1_bufs[1] = pBuf + sizeY;
-    ps_dec_ip->s_out_buffer.pu1_bufs[2] = pBuf + sizeY + sizeUV;
+    ps_dec_ip->s_out_buffer.pu1_bufs[0] = planes.mY;
+    ps_dec_ip->s_out_buffer.pu1_bufs[1] = planes.mU;
+    ps_dec_ip->s_out_buffer.pu1_bufs[2] = planes.mV;
     ps_dec_ip->s_out_buffer.u4_num_bufs = 3;
     return true;
 }
@@ -480,11 +470,11 @@ void SoftAVC::onPortFlushCompleted(OMX_U32 portIndex) {
         setFlushMode();
 
         /* Allocate a picture buffer to flushed data */
-        uint32_t displayStride = outputBufferWidth();
+        uint32_t displayStride = outputBufferStride();
         uint32_t displayHeight = outputBufferHeight();
 
         uint32_t bufferSize = displayStride * displayHeight * 3 / 2;
-        mFlushOutBuffer = (uint8_t *)memalign(128, bufferSize);
+        mFlushOutBuffer = (uint8_t *)allocateFrameMemory(128, bufferSize);
         if (NULL == mFlushOutBuffer) {
             ALOGE("Could not allocate flushOutputBuffer of size %u", bufferSize);
             return;
@@ -506,7 +496,7 @@ void SoftAVC::onPortFlushCompleted(OMX_U32 portIndex) {
         }
 
         if (mFlushOutBuffer) {
-            free(mFlushOutBuffer);
+            freeFrameMemory(mFlushOutBuffer);
             mFlushOutBuffer = NULL;
         }
 
@@ -531,9 +521,9 @@ void SoftAVC::onQueueFilled(OMX_U32 portIndex) {
             return;
         }
     }
-    if (outputBufferWidth() != mStride) {
+    if (outputBufferStride() != mStride) {
         /* Set the run-time (dynamic) parameters */
-        mStride = outputBufferWidth();
+        mStride = outputBufferStride();
         setParams(mStride);
     }
 
@@ -627,6 +617,7 @@ void SoftAVC::onQueueFilled(OMX_U32 portIndex) {
 
             IV_API_CALL_STATUS_T status;
             status = ivdec_api_function(mCodecCtx, (void *)&s_dec_ip, (void *)&s_dec_op);
+            unlockOutputBuffer(outHeader);
 
             bool unsupportedResolution =
                 (IVD_STREAM_WIDTH_HEIGHT_NOT_SUPPORTED == (s_dec_op.u4_error_code & 0xFF));
@@ -673,7 +664,7 @@ void SoftAVC::onQueueFilled(OMX_U32 portIndex) {
                 mChangingResolution = false;
                 resetDecoder();
                 resetPlugin();
-                mStride = outputBufferWidth();
+                mStride = outputBufferStride();
                 setParams(mStride);
                 continue;
             }
@@ -760,6 +751,10 @@ int SoftAVC::getColorAspectPreference() {
     return kPreferBitstream;
 }
 
+bool SoftAVC::supportsNativeBuffers() {
+    return true;
+}
+
 }  // namespace android
 
 android::SoftOMXComponent *createSoftOMXComponent(
@@ -636,6 +636,15 @@ OMX_ERRORTYPE SoftAVC::initEncoder() {
 
     mStride = mWidth;
 
+    if (mRealTime) {
+        // The encoder processes macroblock rows on all its cores. Below 720p, fewer threads
+        // keep up with real time and synchronize less.
+        mNumCores = getRealTimeEncodeThreads(CODEC_MAX_CORES);
+        mEncSpeed = IVE_FASTEST;
+        mEnableFastSad = 1;
+        ALOGV("real time encoding of %dx%d on %zu cores", mWidth, mHeight, mNumCores);
+    }
+
     if (mInputDataIsMeta) {
         for (size_t i = 0; i < MAX_CONVERSION_BUFFERS; i++) {
             if (mConversionBuffers[i] != NULL) {
@@ -1143,7 +1152,7 @@ OMX_ERRORTYPE SoftAVC::setConfig(
         }
 
         default:
-            return SimpleSoftOMXComponent::setConfig(index, _params);
+            return SoftVideoEncoderOMXComponent::setConfig(index, _params);
     }
 }
 
@@ -20,8 +20,14 @@
 
 #include "SoftFlacEncoder.h"
 
+#include <pthread.h>
+#include <unistd.h>
+
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/MediaDefs.h>
+#include <utils/Condition.h>
+#include <utils/Mutex.h>
+#include <utils/Thread.h>
 
 #define FLAC_COMPRESSION_LEVEL_MIN     0
 #define FLAC_COMPRESSION_LEVEL_DEFAULT 5
@@ -44,6 +50,308 @@ static void InitOMXParams(T *params) {
     params->nVersion.s.nStep = 0;
 }
 
+// highest sample rate encoded on the OMX thread, see SoftFlacEncoder.h
+static const OMX_U32 kMaxSerialSampleRate = 48000;
+
+static uint16_t sCrc16Table[256];
+static pthread_once_t sCrc16TableOnce = PTHREAD_ONCE_INIT;
+
+// CRC-16 of FLAC frames: polynomial x^16 + x^15 + x^2 + 1, initialized with 0
+static void initCrc16Table() {
+    for (unsigned i = 0; i < 256; i++) {
+        unsigned crc = i << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x8005 : crc << 1;
+        }
+        sCrc16Table[i] = crc & 0xffff;
+    }
+}
+
+static uint16_t flacCrc16(const uint8_t *data, size_t size) {
+    unsigned crc = 0;
+    for (size_t i = 0; i < size; i++) {
+        crc = ((crc << 8) & 0xffff) ^ sCrc16Table[(crc >> 8) ^ data[i]];
+    }
+    return crc;
+}
+
+// CRC-8 of FLAC frame headers: polynomial x^8 + x^2 + x + 1, initialized with 0
+static uint8_t flacCrc8(const uint8_t *data, size_t size) {
+    unsigned crc = 0;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = ((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1) & 0xff;
+        }
+    }
+    return crc;
+}
+
+// Each encoder of the pipelined mode numbers its frames from 0. Rewrites the number of the frame
+// held in frame[0..*size), coded as UTF-8 in the frame header, to frameNumber, and updates both
+// CRCs of the frame. Returns false if this is not a fixed block size frame numbered 0.
+static bool setFlacFrameNumber(
+        uint8_t *frame, size_t *size, size_t capacity, uint32_t frameNumber) {
+    // sync code and fixed block size, block size and sample rate codes, channel assignment and
+    // sample size, frame number 0
+    if (*size < 8 || frame[0] != 0xff || frame[1] != 0xf8 || frame[4] != 0) {
+        return false;
+    }
+    size_t crc8Pos = 5;
+    const unsigned blockSizeCode = frame[2] >> 4;
+    if (blockSizeCode == 6) {
+        crc8Pos += 1;
+    } else if (blockSizeCode == 7) {
+        crc8Pos += 2;
+    }
+    const unsigned sampleRateCode = frame[2] & 0xf;
+    if (sampleRateCode == 12) {
+        crc8Pos += 1;
+    } else if (sampleRateCode == 13 || sampleRateCode == 14) {
+        crc8Pos += 2;
+    }
+
+    uint8_t number[6];
+    size_t numberSize = 1;
+    frameNumber &= 0x7fffffff;
+    if (frameNumber < 0x80) {
+        number[0] = frameNumber;
+    } else {
+        numberSize = frameNumber < 0x800 ? 2 : frameNumber < 0x10000 ? 3
+                : frameNumber < 0x200000 ? 4 : frameNumber < 0x4000000 ? 5 : 6;
+        uint32_t n = frameNumber;
+        for (size_t i = numberSize - 1; i > 0; i--) {
+            number[i] = 0x80 | (n & 0x3f);
+            n >>= 6;
+        }
+        // as many leading ones as there are bytes
+        number[0] = ((0xff00 >> numberSize) | n) & 0xff;
+    }
+
+    const size_t extra = numberSize - 1;
+    if (crc8Pos + 3 > *size || *size + extra > capacity) {
+        return false;
+    }
+    memmove(frame + 5 + extra, frame + 5, *size - 5);
+    memcpy(frame + 4, number, numberSize);
+    *size += extra;
+    crc8Pos += extra;
+    frame[crc8Pos] = flacCrc8(frame, crc8Pos);
+    const uint16_t crc16 = flacCrc16(frame, *size - 2);
+    frame[*size - 2] = crc16 >> 8;
+    frame[*size - 1] = crc16 & 0xff;
+    return true;
+}
+
+// Encodes blocks as single FLAC frames on a thread of its own, one block at a time.
+struct SoftFlacEncoder::BlockEncoder : public Thread {
+    BlockEncoder(unsigned numChannels, unsigned sampleRate, unsigned compressionLevel,
+            unsigned blockSize);
+
+    status_t init();
+
+    // Starts encoding numFrames samples per channel of *pcm as frame frameNumber. *pcm is
+    // swapped with a buffer of the encoder, so that the caller can fill the next block.
+    void submit(FLAC__int32 **pcm, unsigned numFrames, uint32_t frameNumber,
+            OMX_TICKS timeStamp);
+
+    // Returns whether the submitted block was encoded, waiting for it if wait is set.
+    bool isDone(bool wait);
+
+    // Makes the encoder available for the next block, once the output was consumed.
+    void release();
+
+    void stop();
+
+    // valid once isDone() returned true
+    OMX_TICKS mTimeStamp;
+    uint8_t *mOutput;
+    size_t mOutputSize;
+    bool mError;
+
+protected:
+    virtual ~BlockEncoder();
+
+private:
+    enum State {
+        IDLE,
+        QUEUED,
+        DONE,
+    };
+
+    Mutex mLock;
+    Condition mCondition;
+    State mState;
+
+    const unsigned mNumChannels;
+    const unsigned mSampleRate;
+    const unsigned mCompressionLevel;
+    const unsigned mBlockSize;
+    FLAC__StreamEncoder *mEncoder;
+    FLAC__int32 *mPcm;
+    unsigned mNumFrames;
+    uint32_t mFrameNumber;
+
+    virtual bool threadLoop();
+    bool encode();
+
+    static FLAC__StreamEncoderWriteStatus writeCallback(
+            const FLAC__StreamEncoder *encoder, const FLAC__byte buffer[],
+            size_t bytes, unsigned samples, unsigned current_frame, void *client_data);
+
+    DISALLOW_EVIL_CONSTRUCTORS(BlockEncoder);
+};
+
+SoftFlacEncoder::BlockEncoder::BlockEncoder(
+        unsigned numChannels, unsigned sampleRate, unsigned compressionLevel,
+        unsigned blockSize)
+    : Thread(false /* canCallJava */),
+      mTimeStamp(0),
+      mOutput(NULL),
+      mOutputSize(0),
+      mError(false),
+      mState(IDLE),
+      mNumChannels(numChannels),
+      mSampleRate(sampleRate),
+      mCompressionLevel(compressionLevel),
+      mBlockSize(blockSize),
+      mEncoder(NULL),
+      mPcm(NULL),
+      mNumFrames(0),
+      mFrameNumber(0) {
+}
+
+SoftFlacEncoder::BlockEncoder::~BlockEncoder() {
+    if (mEncoder != NULL) {
+        FLAC__stream_encoder_delete(mEncoder);
+    }
+    free(mPcm);
+    free(mOutput);
+}
+
+status_t SoftFlacEncoder::BlockEncoder::init() {
+    mEncoder = FLAC__stream_encoder_new();
+    mPcm = (FLAC__int32 *) malloc(sizeof(FLAC__int32) * mNumChannels * mBlockSize);
+    mOutput = (uint8_t *) malloc(kMaxOutputBufferSize);
+    if (mEncoder == NULL || mPcm == NULL || mOutput == NULL) {
+        return NO_MEMORY;
+    }
+    return OK;
+}
+
+void SoftFlacEncoder::BlockEncoder::submit(
+        FLAC__int32 **pcm, unsigned numFrames, uint32_t frameNumber, OMX_TICKS timeStamp) {
+    Mutex::Autolock autoLock(mLock);
+    CHECK_EQ((int)mState, (int)IDLE);
+    FLAC__int32 *tmp = mPcm;
+    mPcm = *pcm;
+    *pcm = tmp;
+    mNumFrames = numFrames;
+    mFrameNumber = frameNumber;
+    mTimeStamp = timeStamp;
+    mState = QUEUED;
+    mCondition.broadcast();
+}
+
+bool SoftFlacEncoder::BlockEncoder::isDone(bool wait) {
+    Mutex::Autolock autoLock(mLock);
+    while (wait && mState == QUEUED) {
+        mCondition.wait(mLock);
+    }
+    return mState == DONE;
+}
+
+void SoftFlacEncoder::BlockEncoder::release() {
+    Mutex::Autolock autoLock(mLock);
+    mState = IDLE;
+}
+
+void SoftFlacEncoder::BlockEncoder::stop() {
+    {
+        Mutex::Autolock autoLock(mLock);
+        requestExit();
+        mCondition.broadcast();
+    }
+    join();
+}
+
+bool SoftFlacEncoder::BlockEncoder::threadLoop() {
+    {
+        Mutex::Autolock autoLock(mLock);
+        while (mState != QUEUED && !exitPending()) {
+            mCondition.wait(mLock);
+        }
+        if (mState != QUEUED) {
+            return false;
+        }
+    }
+
+    bool ok = encode();
+
+    Mutex::Autolock autoLock(mLock);
+    mError = !ok;
+    mState = DONE;
+    mCondition.broadcast();
+    return true;
+}
+
+bool SoftFlacEncoder::BlockEncoder::encode() {
+    mOutputSize = 0;
+
+    // the settings, block size included, are lost when the encoder is finished
+    FLAC__bool ok = true;
+    ok = ok && FLAC__stream_encoder_set_channels(mEncoder, mNumChannels);
+    ok = ok && FLAC__stream_encoder_set_sample_rate(mEncoder, mSampleRate);
+    ok = ok && FLAC__stream_encoder_set_bits_per_sample(mEncoder, 16);
+    ok = ok && FLAC__stream_encoder_set_compression_level(mEncoder, mCompressionLevel);
+    ok = ok && FLAC__stream_encoder_set_blocksize(mEncoder, mBlockSize);
+    ok = ok && FLAC__stream_encoder_set_verify(mEncoder, false);
+    ok = ok && FLAC__STREAM_ENCODER_INIT_STATUS_OK ==
+            FLAC__stream_encoder_init_stream(mEncoder,
+                    writeCallback /*write_callback*/,
+                    NULL /*seek_callback*/,
+                    NULL /*tell_callback*/,
+                    NULL /*metadata_callback*/,
+                    (void *) this /*client_data*/);
+    ok = ok && FLAC__stream_encoder_process_interleaved(mEncoder, mPcm, mNumFrames);
+    // the encoder waits for the first sample of the next block before writing a frame, finishing
+    // the stream writes it
+    ok = FLAC__stream_encoder_finish(mEncoder) && ok;
+    if (!ok) {
+        ALOGE("error encoding block %u: %s", mFrameNumber,
+                FLAC__stream_encoder_get_resolved_state_string(mEncoder));
+        return false;
+    }
+
+    if (!setFlacFrameNumber(mOutput, &mOutputSize, kMaxOutputBufferSize, mFrameNumber)) {
+        ALOGE("unexpected FLAC frame of %zu bytes for block %u", mOutputSize, mFrameNumber);
+        return false;
+    }
+    return true;
+}
+
+// static
+FLAC__StreamEncoderWriteStatus SoftFlacEncoder::BlockEncoder::writeCallback(
+            const FLAC__StreamEncoder * /* encoder */,
+            const FLAC__byte buffer[],
+            size_t bytes,
+            unsigned samples,
+            unsigned /* current_frame */,
+            void *client_data) {
+    BlockEncoder *me = (BlockEncoder *) client_data;
+    if (samples == 0) {
+        // stream header, only the frame is output
+        return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+    }
+    if (bytes > kMaxOutputBufferSize - me->mOutputSize) {
+        ALOGE("no room for %zu bytes of encoded data", bytes);
+        return FLAC__STREAM_ENCODER_WRITE_STATUS_FATAL_ERROR;
+    }
+    memcpy(me->mOutput + me->mOutputSize, buffer, bytes);
+    me->mOutputSize += bytes;
+    return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+}
+
 SoftFlacEncoder::SoftFlacEncoder(
         const char *name,
         const OMX_CALLBACKTYPE *callbacks,
@@ -57,7 +365,16 @@ SoftFlacEncoder::SoftFlacEncoder(
       mEncoderWriteData(false),
       mEncoderReturnedEncodedData(false),
       mEncoderReturnedNbBytes(0),
-      mInputBufferPcm32(NULL)
+      mInputBufferPcm32(NULL),
+      mPipelineConfigured(false),
+      mNumWorkers(0),
+      mBlockSize(0),
+      mBlockPcm(NULL),
+      mBlockFill(0),
+      mBlockTimeStamp(0),
+      mNextBlockNumber(0),
+      mNextOutputBlockNumber(0),
+      mSawInputEOS(false)
 #ifdef WRITE_FLAC_HEADER_IN_FIRST_BUFFER
       , mHeaderOffset(0)
       , mWroteHeader(false)
@@ -83,6 +400,7 @@ SoftFlacEncoder::SoftFlacEncoder(
 
 SoftFlacEncoder::~SoftFlacEncoder() {
     ALOGV("SoftFlacEncoder::~SoftFlacEncoder()");
+    stopPipeline();
     if (mFlacStreamEncoder != NULL) {
         FLAC__stream_encoder_delete(mFlacStreamEncoder);
         mFlacStreamEncoder = NULL;
@@ -296,6 +614,14 @@ void SoftFlacEncoder::onQueueFilled(OMX_U32 portIndex) {
         return;
     }
 
+    if (!mPipelineConfigured) {
+        configurePipeline();
+    }
+    if (mNumWorkers > 0) {
+        onQueueFilledPipelined();
+        return;
+    }
+
     List<BufferInfo *> &inQueue = getPortQueue(0);
     List<BufferInfo *> &outQueue = getPortQueue(1);
 
@@ -375,6 +701,207 @@ void SoftFlacEncoder::onQueueFilled(OMX_U32 portIndex) {
     }
 }
 
+void SoftFlacEncoder::configurePipeline() {
+    mPipelineConfigured = true;
+    mNumWorkers = 0;
+
+    long onlineCores = sysconf(_SC_NPROCESSORS_ONLN);
+    mBlockSize = FLAC__stream_encoder_get_blocksize(mFlacStreamEncoder);
+    // an input buffer must complete at most one block
+    if (mSampleRate <= kMaxSerialSampleRate || onlineCores < 2
+            || mBlockSize < kMaxNumSamplesPerFrame) {
+        return;
+    }
+    size_t numWorkers = onlineCores < kMaxNumWorkers ? (size_t)onlineCores : (size_t)kMaxNumWorkers;
+
+    pthread_once(&sCrc16TableOnce, initCrc16Table);
+    mBlockPcm = (FLAC__int32 *) malloc(sizeof(FLAC__int32) * mNumChannels * mBlockSize);
+    if (mBlockPcm == NULL) {
+        ALOGW("cannot allocate a block, encoding on a single thread");
+        return;
+    }
+    for (size_t i = 0; i < numWorkers; i++) {
+        sp<BlockEncoder> encoder = new BlockEncoder(
+                mNumChannels, mSampleRate, mCompressionLevel, mBlockSize);
+        if (encoder->init() != OK
+                || encoder->run("FlacBlockEncoder", ANDROID_PRIORITY_AUDIO) != OK) {
+            ALOGW("cannot start block encoder %zu, encoding on a single thread", i);
+            stopPipeline();
+            return;
+        }
+        mBlockEncoders.push(encoder);
+    }
+    mNumWorkers = numWorkers;
+    mBlockFill = 0;
+    mNextBlockNumber = 0;
+    mNextOutputBlockNumber = 0;
+    mSawInputEOS = false;
+    ALOGV("encoding blocks of %u samples on %zu threads", mBlockSize, mNumWorkers);
+}
+
+void SoftFlacEncoder::stopPipeline() {
+    for (size_t i = 0; i < mBlockEncoders.size(); i++) {
+        mBlockEncoders[i]->stop();
+    }
+    mBlockEncoders.clear();
+    mNumWorkers = 0;
+    free(mBlockPcm);
+    mBlockPcm = NULL;
+}
+
+void SoftFlacEncoder::submitBlock() {
+    mBlockEncoders[mNextBlockNumber % mNumWorkers]->submit(
+            &mBlockPcm, mBlockFill, mNextBlockNumber, mBlockTimeStamp);
+    mNextBlockNumber++;
+    mBlockFill = 0;
+}
+
+bool SoftFlacEncoder::outputEncodedBlock(bool wait) {
+    const sp<BlockEncoder> &encoder = mBlockEncoders[mNextOutputBlockNumber % mNumWorkers];
+    if (!encoder->isDone(wait)) {
+        return false;
+    }
+    if (encoder->mError) {
+        mSignalledError = true;
+        notify(OMX_EventError, OMX_ErrorUndefined, 0, NULL);
+        return false;
+    }
+
+    List<BufferInfo *> &outQueue = getPortQueue(1);
+    BufferInfo *outInfo = *outQueue.begin();
+    OMX_BUFFERHEADERTYPE *outHeader = outInfo->mHeader;
+
+    outHeader->nOffset = 0;
+    outHeader->nFilledLen = 0;
+    if (encoder->mOutputSize > outHeader->nAllocLen) {
+        ALOGE(" not enough space left to write encoded data, dropping %zu bytes",
+                encoder->mOutputSize);
+    } else {
+        memcpy(outHeader->pBuffer, encoder->mOutput, encoder->mOutputSize);
+        outHeader->nFilledLen = encoder->mOutputSize;
+    }
+    outHeader->nTimeStamp = encoder->mTimeStamp;
+    outHeader->nFlags = 0;
+    encoder->release();
+    mNextOutputBlockNumber++;
+
+    outInfo->mOwnedByUs = false;
+    outQueue.erase(outQueue.begin());
+    notifyFillBufferDone(outHeader);
+    return true;
+}
+
+void SoftFlacEncoder::onQueueFilledPipelined() {
+    List<BufferInfo *> &inQueue = getPortQueue(0);
+    List<BufferInfo *> &outQueue = getPortQueue(1);
+
+    while (!inQueue.empty() && !mSawInputEOS) {
+        BufferInfo *inInfo = *inQueue.begin();
+        OMX_BUFFERHEADERTYPE *inHeader = inInfo->mHeader;
+
+        if (inHeader->nFilledLen > kMaxInputBufferSize) {
+            ALOGE("input buffer too large (%d).", inHeader->nFilledLen);
+            mSignalledError = true;
+            notify(OMX_EventError, OMX_ErrorUndefined, 0, NULL);
+            return;
+        }
+
+        const bool eos = (inHeader->nFlags & OMX_BUFFERFLAG_EOS) != 0;
+        const unsigned nbInputFrames = inHeader->nFilledLen / (2 * mNumChannels);
+        // a full block, and a partial one at the end of the stream
+        size_t numSubmits = (mBlockFill + nbInputFrames) / mBlockSize;
+        if (eos && (mBlockFill + nbInputFrames) % mBlockSize != 0) {
+            numSubmits++;
+        }
+
+        // the worker of each block must be done with its previous block
+        while (mNextBlockNumber - mNextOutputBlockNumber + numSubmits > mNumWorkers) {
+            if (outQueue.empty()) {
+                return;
+            }
+            if (!outputEncodedBlock(true /* wait */)) {
+                return;
+            }
+        }
+
+        const OMX_S16 * const pcm16 =
+                reinterpret_cast<OMX_S16 *>(inHeader->pBuffer + inHeader->nOffset);
+        for (unsigned frame = 0; frame < nbInputFrames;) {
+            if (mBlockFill == 0) {
+                mBlockTimeStamp = inHeader->nTimeStamp + (OMX_TICKS)frame * 1000000ll / mSampleRate;
+            }
+            unsigned n = mBlockSize - mBlockFill;
+            if (n > nbInputFrames - frame) {
+                n = nbInputFrames - frame;
+            }
+            FLAC__int32 *pcm32 = mBlockPcm + mBlockFill * mNumChannels;
+            const OMX_S16 *in = pcm16 + frame * mNumChannels;
+            for (unsigned i = 0; i < n * mNumChannels; i++) {
+                pcm32[i] = (FLAC__int32) in[i];
+            }
+            mBlockFill += n;
+            frame += n;
+            if (mBlockFill == mBlockSize) {
+                submitBlock();
+            }
+        }
+        if (eos) {
+            if (mBlockFill > 0) {
+                submitBlock();
+            }
+            mSawInputEOS = true;
+        }
+
+        inInfo->mOwnedByUs = false;
+        inQueue.erase(inQueue.begin());
+        notifyEmptyBufferDone(inHeader);
+    }
+
+    // output the blocks encoded so far in order, and all of them at the end of the stream
+    while (!outQueue.empty() && mNextOutputBlockNumber != mNextBlockNumber) {
+        if (!outputEncodedBlock(mSawInputEOS /* wait */)) {
+            return;
+        }
+    }
+
+    if (mSawInputEOS && !outQueue.empty() && mNextOutputBlockNumber == mNextBlockNumber) {
+        BufferInfo *outInfo = *outQueue.begin();
+        OMX_BUFFERHEADERTYPE *outHeader = outInfo->mHeader;
+        outHeader->nFilledLen = 0;
+        outHeader->nFlags = OMX_BUFFERFLAG_EOS;
+
+        outQueue.erase(outQueue.begin());
+        outInfo->mOwnedByUs = false;
+        notifyFillBufferDone(outHeader);
+        mSawInputEOS = false;
+    }
+}
+
+void SoftFlacEncoder::onPortFlushCompleted(OMX_U32 portIndex) {
+    if (mNumWorkers == 0) {
+        return;
+    }
+    if (portIndex == 0) {
+        mBlockFill = 0;
+        mSawInputEOS = false;
+    } else {
+        // drop the blocks still being encoded
+        while (mNextOutputBlockNumber != mNextBlockNumber) {
+            const sp<BlockEncoder> &encoder =
+                    mBlockEncoders[mNextOutputBlockNumber % mNumWorkers];
+            encoder->isDone(true /* wait */);
+            encoder->release();
+            mNextOutputBlockNumber++;
+        }
+    }
+}
+
+void SoftFlacEncoder::onReset() {
+    // the pipeline is set up again for the next configuration
+    stopPipeline();
+    mPipelineConfigured = false;
+}
+
 FLAC__StreamEncoderWriteStatus SoftFlacEncoder::onEncodedFlacAvailable(
             const FLAC__byte buffer[],
             size_t bytes, unsigned samples,
@@ -20,6 +20,8 @@
 
 #include "SimpleSoftOMXComponent.h"
 
+#include <utils/Vector.h>
+
 #include "FLAC/stream_encoder.h"
 
 // use this symbol to have the first output buffer start with FLAC frame header so a dump of
@@ -46,6 +48,8 @@ protected:
             OMX_INDEXTYPE index, const OMX_PTR params);
 
     virtual void onQueueFilled(OMX_U32 portIndex);
+    virtual void onPortFlushCompleted(OMX_U32 portIndex);
+    virtual void onReset();
 
 private:
 
@@ -54,6 +58,7 @@ private:
         kMaxNumSamplesPerFrame = 1152,
         kMaxInputBufferSize = kMaxNumSamplesPerFrame * sizeof(int16_t) * 2,
         kMaxOutputBufferSize = 65536,    //TODO check if this can be reduced
+        kMaxNumWorkers = 4,
     };
 
     bool mSignalledError;
@@ -88,6 +93,30 @@ private:
     // before passing the input data to the encoder
     FLAC__int32* mInputBufferPcm32;
 
+    // Pipelined mode, used above 48 kHz on multicore devices: the input is cut into blocks of
+    // the FLAC block size, which are encoded as independent frames by encoders of their own on
+    // worker threads. Block n goes to worker n % mNumWorkers, and the frames are output in order.
+    struct BlockEncoder;
+    Vector<sp<BlockEncoder> > mBlockEncoders;
+    bool mPipelineConfigured;
+    size_t mNumWorkers;             // 0 when encoding on the OMX thread
+    unsigned mBlockSize;            // samples per channel of a FLAC frame
+    FLAC__int32 *mBlockPcm;         // block being filled from the input buffers
+    unsigned mBlockFill;
+    OMX_TICKS mBlockTimeStamp;
+    uint32_t mNextBlockNumber;      // of the block being filled
+    uint32_t mNextOutputBlockNumber;
+    bool mSawInputEOS;              // not output yet
+
+    void configurePipeline();
+    void stopPipeline();
+    void onQueueFilledPipelined();
+    // Hands the filled block over to its worker, which must be idle.
+    void submitBlock();
+    // Outputs the oldest block in an output buffer, waiting for it to be encoded if wait is
+    // set. Returns false if it was not encoded yet, or on error.
+    bool outputEncodedBlock(bool wait);
+
 #ifdef WRITE_FLAC_HEADER_IN_FIRST_BUFFER
     unsigned mHeaderOffset;
     bool mWroteHeader;
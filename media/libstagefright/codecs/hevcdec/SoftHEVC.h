@@ -62,6 +62,7 @@ protected:
     virtual void onPortFlushCompleted(OMX_U32 portIndex);
     virtual void onReset();
     virtual int getColorAspectPreference();
+    virtual bool supportsNativeBuffers();
 private:
     // Number of input and output buffers
     enum {
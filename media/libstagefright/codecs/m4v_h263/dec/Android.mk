@@ -19,6 +19,7 @@ LOCAL_SRC_FILES := \
  	src/get_pred_adv_b_add.cpp \
  	src/get_pred_outside.cpp \
  	src/idct.cpp \
+ 	src/idct_neon.cpp \
  	src/idct_vca.cpp \
  	src/mb_motion_comp.cpp \
  	src/mb_utils.cpp \
@@ -81,3 +82,27 @@ LOCAL_CLANG := true
 LOCAL_SANITIZE := signed-integer-overflow
 
 include $(BUILD_SHARED_LIBRARY)
+
+################################################################################
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+        test/m4v_h263_dec_idct_test.cpp
+
+LOCAL_C_INCLUDES := \
+        $(LOCAL_PATH)/src \
+        $(LOCAL_PATH)/include
+
+LOCAL_CFLAGS := -DOSCL_EXPORT_REF= -DOSCL_IMPORT_REF=
+LOCAL_CFLAGS += -Werror
+LOCAL_CLANG := true
+LOCAL_SANITIZE := signed-integer-overflow
+
+LOCAL_STATIC_LIBRARIES := \
+        libstagefright_m4vh263dec
+
+LOCAL_MODULE := libstagefright_m4vh263dec_test
+LOCAL_MODULE_TAGS := tests
+
+include $(BUILD_EXECUTABLE)
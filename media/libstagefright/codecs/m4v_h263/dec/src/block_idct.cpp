@@ -277,6 +277,10 @@ void BlockIDCT_intra(
     }
     else
     {
+#ifdef PV_NEON_IDCT
+        idct_neon(coeff_in, NULL, c_comp, width);
+        return;
+#endif
         i = 8;
         while (i--)
         {
@@ -374,6 +378,10 @@ void BlockIDCT(
     }
     else
     {
+#ifdef PV_NEON_IDCT
+        idct_neon(coeff_in, pred, dst, width);
+        return ;
+#endif
         i = 8;
 
         while (i--)
@@ -66,6 +66,19 @@ extern "C"
 #endif
 #endif
 
+#if defined(__ARM_NEON__) || defined(__aarch64__)
+#define PV_NEON_IDCT
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    /* full 8x8 IDCT, adding pred (of pitch 16) unless NULL, see idct_neon.cpp */
+    void idct_neon(int16 *blk, uint8 *pred, uint8 *dst, int width);
+#ifdef __cplusplus
+}
+#endif
+#endif
+
 /* this code assumes ">>" to be a two's-complement arithmetic */
 /* right shift: (-2)>>1 == -1 , (-3)>>1 == -2                 */
 
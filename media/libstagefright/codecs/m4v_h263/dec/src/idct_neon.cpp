@@ -0,0 +1,202 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+#include "mp4def.h"
+#include "idct.h"
+
+#ifdef PV_NEON_IDCT
+
+#include <arm_neon.h>
+
+/****************************************************************
+*       idct_neon.cpp : NEON version of the full 8x8 integer IDCT
+*                       of block_idct.cpp (idctcol then idctrow),
+*                       computing 8 columns or rows at a time.
+*                       It gives the same results as the C version,
+*                       which the reduced idct_vca.cpp ones only
+*                       specialize for zero coefficients.
+******************************************************************/
+
+/* transposes the 8x8 block of rows r[0..7] */
+static inline void transpose8x8(int16x8_t r[8])
+{
+    int16x8x2_t t01 = vtrnq_s16(r[0], r[1]);
+    int16x8x2_t t23 = vtrnq_s16(r[2], r[3]);
+    int16x8x2_t t45 = vtrnq_s16(r[4], r[5]);
+    int16x8x2_t t67 = vtrnq_s16(r[6], r[7]);
+
+    int32x4x2_t u02 = vtrnq_s32(vreinterpretq_s32_s16(t01.val[0]),
+                                vreinterpretq_s32_s16(t23.val[0]));
+    int32x4x2_t u13 = vtrnq_s32(vreinterpretq_s32_s16(t01.val[1]),
+                                vreinterpretq_s32_s16(t23.val[1]));
+    int32x4x2_t u46 = vtrnq_s32(vreinterpretq_s32_s16(t45.val[0]),
+                                vreinterpretq_s32_s16(t67.val[0]));
+    int32x4x2_t u57 = vtrnq_s32(vreinterpretq_s32_s16(t45.val[1]),
+                                vreinterpretq_s32_s16(t67.val[1]));
+
+    r[0] = vcombine_s16(vget_low_s16(vreinterpretq_s16_s32(u02.val[0])),
+                        vget_low_s16(vreinterpretq_s16_s32(u46.val[0])));
+    r[1] = vcombine_s16(vget_low_s16(vreinterpretq_s16_s32(u13.val[0])),
+                        vget_low_s16(vreinterpretq_s16_s32(u57.val[0])));
+    r[2] = vcombine_s16(vget_low_s16(vreinterpretq_s16_s32(u02.val[1])),
+                        vget_low_s16(vreinterpretq_s16_s32(u46.val[1])));
+    r[3] = vcombine_s16(vget_low_s16(vreinterpretq_s16_s32(u13.val[1])),
+                        vget_low_s16(vreinterpretq_s16_s32(u57.val[1])));
+    r[4] = vcombine_s16(vget_high_s16(vreinterpretq_s16_s32(u02.val[0])),
+                        vget_high_s16(vreinterpretq_s16_s32(u46.val[0])));
+    r[5] = vcombine_s16(vget_high_s16(vreinterpretq_s16_s32(u13.val[0])),
+                        vget_high_s16(vreinterpretq_s16_s32(u57.val[0])));
+    r[6] = vcombine_s16(vget_high_s16(vreinterpretq_s16_s32(u02.val[1])),
+                        vget_high_s16(vreinterpretq_s16_s32(u46.val[1])));
+    r[7] = vcombine_s16(vget_high_s16(vreinterpretq_s16_s32(u13.val[1])),
+                        vget_high_s16(vreinterpretq_s16_s32(u57.val[1])));
+}
+
+/* (181 * x + 128) >> 8 */
+static inline int32x4_t mul181(int32x4_t x)
+{
+    return vshrq_n_s32(vmlaq_n_s32(vdupq_n_s32(128), x, 181), 8);
+}
+
+/* 1-D IDCT of b[0..7], 4 at a time, as idctcol (row == 0) or idctrow (row == 1) */
+static inline void idct8(int32x4_t b[8], const int row)
+{
+    int32x4_t x0, x1, x2, x3, x4, x5, x6, x7, x8;
+    int32x4_t rnd = vdupq_n_s32(row ? 4 : 0);
+
+    if (row)
+    {
+        x0 = vaddq_s32(vshlq_n_s32(b[0], 8), vdupq_n_s32(8192));
+        x1 = vshlq_n_s32(b[4], 8);
+    }
+    else
+    {
+        x0 = vaddq_s32(vshlq_n_s32(b[0], 11), vdupq_n_s32(128));
+        x1 = vshlq_n_s32(b[4], 11);
+    }
+    x2 = b[6];
+    x3 = b[2];
+    x4 = b[1];
+    x5 = b[7];
+    x6 = b[5];
+    x7 = b[3];
+
+    /* first stage */
+    x8 = vmlaq_n_s32(rnd, vaddq_s32(x4, x5), W7);
+    x4 = vmlaq_n_s32(x8, x4, W1 - W7);
+    x5 = vmlsq_n_s32(x8, x5, W1 + W7);
+    x8 = vmlaq_n_s32(rnd, vaddq_s32(x6, x7), W3);
+    x6 = vmlsq_n_s32(x8, x6, W3 - W5);
+    x7 = vmlsq_n_s32(x8, x7, W3 + W5);
+    if (row)
+    {
+        x4 = vshrq_n_s32(x4, 3);
+        x5 = vshrq_n_s32(x5, 3);
+        x6 = vshrq_n_s32(x6, 3);
+        x7 = vshrq_n_s32(x7, 3);
+    }
+
+    /* second stage */
+    x8 = vaddq_s32(x0, x1);
+    x0 = vsubq_s32(x0, x1);
+    x1 = vmlaq_n_s32(rnd, vaddq_s32(x3, x2), W6);
+    x2 = vmlsq_n_s32(x1, x2, W2 + W6);
+    x3 = vmlaq_n_s32(x1, x3, W2 - W6);
+    if (row)
+    {
+        x2 = vshrq_n_s32(x2, 3);
+        x3 = vshrq_n_s32(x3, 3);
+    }
+    x1 = vaddq_s32(x4, x6);
+    x4 = vsubq_s32(x4, x6);
+    x6 = vaddq_s32(x5, x7);
+    x5 = vsubq_s32(x5, x7);
+
+    /* third stage */
+    x7 = vaddq_s32(x8, x3);
+    x8 = vsubq_s32(x8, x3);
+    x3 = vaddq_s32(x0, x2);
+    x0 = vsubq_s32(x0, x2);
+    x2 = mul181(vaddq_s32(x4, x5));
+    x4 = mul181(vsubq_s32(x4, x5));
+
+    /* fourth stage, shifted by 14 for rows and 8 for columns */
+    b[0] = vaddq_s32(x7, x1);
+    b[1] = vaddq_s32(x3, x2);
+    b[2] = vaddq_s32(x0, x4);
+    b[3] = vaddq_s32(x8, x6);
+    b[4] = vsubq_s32(x8, x6);
+    b[5] = vsubq_s32(x0, x4);
+    b[6] = vsubq_s32(x3, x2);
+    b[7] = vsubq_s32(x7, x1);
+}
+
+void idct_neon(int16 *blk, uint8 *pred, uint8 *dst, int width)
+{
+    int16x8_t r[8];
+    int32x4_t lo[8], hi[8];
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        r[i] = vld1q_s16(blk + (i << 3));
+        lo[i] = vmovl_s16(vget_low_s16(r[i]));
+        hi[i] = vmovl_s16(vget_high_s16(r[i]));
+    }
+
+    /* columns, stored as int16 like idctcol does */
+    idct8(lo, 0);
+    idct8(hi, 0);
+    for (i = 0; i < 8; i++)
+    {
+        r[i] = vcombine_s16(vmovn_s32(vshrq_n_s32(lo[i], 8)),
+                            vmovn_s32(vshrq_n_s32(hi[i], 8)));
+    }
+
+    /* rows, r[i] holding coefficient i of the 8 rows */
+    transpose8x8(r);
+    for (i = 0; i < 8; i++)
+    {
+        lo[i] = vmovl_s16(vget_low_s16(r[i]));
+        hi[i] = vmovl_s16(vget_high_s16(r[i]));
+    }
+    idct8(lo, 1);
+    idct8(hi, 1);
+    for (i = 0; i < 8; i++)
+    {
+        /* saturating does not change the clipped result */
+        r[i] = vcombine_s16(vqshrn_n_s32(lo[i], 14), vqshrn_n_s32(hi[i], 14));
+    }
+    transpose8x8(r);
+
+    for (i = 0; i < 8; i++)
+    {
+        int16x8_t res = r[i];
+        if (pred)
+        {
+            uint8x8_t p = vld1_u8(pred + (i << 4));
+            res = vqaddq_s16(res, vreinterpretq_s16_u16(vmovl_u8(p)));
+        }
+        vst1_u8(dst, vqmovun_s16(res));
+        dst += width;
+
+        /* leave the block cleared, as the row IDCT does */
+        vst1q_s16(blk + (i << 3), vdupq_n_s16(0));
+    }
+}
+
+#endif /* PV_NEON_IDCT */
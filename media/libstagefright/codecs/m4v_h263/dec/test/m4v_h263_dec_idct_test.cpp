@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks that the block IDCT of the decoder, whichever of its C or SIMD versions
+// is built, is bit exact with the reference integer IDCT below, on dequantized
+// blocks dense enough to take the full IDCT path.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mp4dec_lib.h"
+
+enum {
+    kNumBlocks = 100000,
+    kWidth     = 24,    // a destination pitch other than the prediction one
+    kMaxCoeff  = 2047,  // the dequantizer clips to [-2048, 2047]
+};
+
+static const uint8_t kMask[8] = { 128, 64, 32, 16, 8, 4, 2, 1 };
+
+static int32_t clip(int32_t x) {
+    return x < 0 ? 0 : (x > 255 ? 255 : x);
+}
+
+// 1-D IDCT of 8 values of blk, spaced by step, with the rounding of idctcol
+// (row == false) or idctrow (row == true) in block_idct.cpp.
+static void referenceIdct8(const int16_t *blk, int step, bool row, int32_t *out) {
+    const int32_t W1 = 2841, W2 = 2676, W3 = 2408, W5 = 1609, W6 = 1108, W7 = 565;
+    const int32_t round = row ? 4 : 0;
+    const int shift = row ? 3 : 0;
+
+    int32_t x0 = ((int32_t)blk[0] << (row ? 8 : 11)) + (row ? 8192 : 128);
+    int32_t x1 = (int32_t)blk[4 * step] << (row ? 8 : 11);
+    int32_t x2 = blk[6 * step];
+    int32_t x3 = blk[2 * step];
+    int32_t x4 = blk[1 * step];
+    int32_t x5 = blk[7 * step];
+    int32_t x6 = blk[5 * step];
+    int32_t x7 = blk[3 * step];
+    int32_t x8;
+
+    x8 = W7 * (x4 + x5) + round;
+    x4 = (x8 + (W1 - W7) * x4) >> shift;
+    x5 = (x8 - (W1 + W7) * x5) >> shift;
+    x8 = W3 * (x6 + x7) + round;
+    x6 = (x8 - (W3 - W5) * x6) >> shift;
+    x7 = (x8 - (W3 + W5) * x7) >> shift;
+
+    x8 = x0 + x1;
+    x0 -= x1;
+    x1 = W6 * (x3 + x2) + round;
+    x2 = (x1 - (W2 + W6) * x2) >> shift;
+    x3 = (x1 + (W2 - W6) * x3) >> shift;
+    x1 = x4 + x6;
+    x4 -= x6;
+    x6 = x5 + x7;
+    x5 -= x7;
+
+    x7 = x8 + x3;
+    x8 -= x3;
+    x3 = x0 + x2;
+    x0 -= x2;
+    x2 = (181 * (x4 + x5) + 128) >> 8;
+    x4 = (181 * (x4 - x5) + 128) >> 8;
+
+    out[0] = x7 + x1;
+    out[1] = x3 + x2;
+    out[2] = x0 + x4;
+    out[3] = x8 + x6;
+    out[4] = x8 - x6;
+    out[5] = x0 - x4;
+    out[6] = x3 - x2;
+    out[7] = x7 - x1;
+}
+
+// Reconstructs blk into dst, adding pred (of pitch 16) unless it is NULL.
+static void referenceIdct(const int16_t *blk, const uint8_t *pred, uint8_t *dst, int width) {
+    int16_t tmp[64];
+    int32_t out[8];
+
+    for (int i = 0; i < 8; ++i) {
+        referenceIdct8(blk + i, 8, false, out);
+        for (int k = 0; k < 8; ++k) {
+            tmp[(k << 3) + i] = (int16_t)(out[k] >> 8);
+        }
+    }
+    for (int i = 0; i < 8; ++i) {
+        referenceIdct8(tmp + (i << 3), 1, true, out);
+        for (int k = 0; k < 8; ++k) {
+            int32_t res = out[k] >> 14;
+            if (pred != NULL) {
+                res += pred[(i << 4) + k];
+            }
+            dst[i * width + k] = (uint8_t)clip(res);
+        }
+    }
+}
+
+// Fills blk with a random dequantized block, and the bitmaps the way vlc_dequant.cpp does.
+static void randomBlock(int16_t *blk, uint8_t *bitmapcol, uint8_t *bitmaprow) {
+    // a random subset of the columns and rows, to cover the specialized C versions
+    const int columns = rand() & 0xff;
+    const int rows = rand() & 0xff;
+    const int range = (rand() & 1) ? kMaxCoeff : 64;
+
+    memset(bitmapcol, 0, 8);
+    *bitmaprow = 0;
+    for (int k = 0; k < 64; ++k) {
+        int16_t level = 0;
+        if (k == 0 || (((columns >> (k & 7)) & (rows >> (k >> 3)) & 1) && (rand() & 1))) {
+            level = (int16_t)(rand() % (2 * range + 1) - range);
+        }
+        blk[k] = level;
+        if (level != 0) {
+            bitmapcol[k & 7] |= kMask[k >> 3];
+        }
+    }
+    for (int k = 1; k < 4; ++k) {
+        if (bitmapcol[k] != 0) {
+            *bitmaprow |= kMask[k];
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const unsigned seed = argc > 1 ? (unsigned)atoi(argv[1]) : 1;
+    srand(seed);
+
+    static MacroBlock mblock;
+    int16_t coeffs[64];
+    uint8_t expected[8 * kWidth];
+    uint8_t actual[8 * kWidth];
+    int failures = 0;
+
+    for (int n = 0; n < kNumBlocks; ++n) {
+        const bool intra = n & 1;
+        uint8_t *bitmapcol = mblock.bitmapcol[0];
+        randomBlock(coeffs, bitmapcol, &mblock.bitmaprow[0]);
+        for (size_t i = 0; i < sizeof(mblock.pred_block); ++i) {
+            mblock.pred_block[i] = (uint8_t)rand();
+        }
+        memset(expected, 0, sizeof(expected));
+        memcpy(actual, expected, sizeof(actual));
+
+        referenceIdct(coeffs, intra ? NULL : mblock.pred_block, expected, kWidth);
+        memcpy(mblock.block[0], coeffs, sizeof(coeffs));
+        mblock.no_coeff[0] = 64;
+        if (intra) {
+            BlockIDCT_intra(&mblock, actual, 0, kWidth);
+        } else {
+            BlockIDCT(actual, mblock.pred_block, mblock.block[0], kWidth, 64,
+                    bitmapcol, mblock.bitmaprow[0]);
+        }
+
+        bool cleared = true;
+        for (int k = 0; k < 64; ++k) {
+            cleared = cleared && mblock.block[0][k] == 0;
+        }
+        if (memcmp(expected, actual, sizeof(actual)) != 0 || !cleared) {
+            if (failures < 10) {
+                fprintf(stderr, "block %d (%s) mismatch%s\n", n, intra ? "intra" : "inter",
+                        cleared ? "" : ", coefficients not cleared");
+            }
+            ++failures;
+        }
+    }
+
+    printf("%d of %d blocks failed (seed %u)\n", failures, kNumBlocks, seed);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,140 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+/*********************************************************************************/
+/*  Filename: sad_neon_inline.h                                                 */
+/*  Description: NEON implementation of the 16x16 integer and half-pel SAD,     */
+/*               used in sad.cpp and sad_halfpel.cpp when NEON is available.    */
+/*               They return the same SAD as the C versions when it is not      */
+/*               larger than dmin, and otherwise a partial SAD larger than it.  */
+/*  Modified:                                                                   */
+/*********************************************************************************/
+#ifndef _SAD_NEON_INLINE_H_
+#define _SAD_NEON_INLINE_H_
+
+#if defined(__ARM_NEON__) || defined(__aarch64__)
+
+#define PV_NEON_SAD
+
+#include <arm_neon.h>
+
+/* dmin is checked every NEON_SAD_ROWS rows, instead of every row */
+#define NEON_SAD_ROWS 4
+
+/* sum of the 8 lanes of the row SADs */
+static inline Int neon_sad_sum(uint16x8_t acc)
+{
+    uint32x4_t sum32 = vpaddlq_u16(acc);
+    uint64x2_t sum64 = vpaddlq_u32(sum32);
+    return (Int)(vgetq_lane_u64(sum64, 0) + vgetq_lane_u64(sum64, 1));
+}
+
+/* accumulates the SAD of the 16 pixels of pred and blk into acc */
+static inline uint16x8_t neon_sad_row(uint16x8_t acc, uint8x16_t pred, const UChar *blk)
+{
+    uint8x16_t cur = vld1q_u8(blk);
+    acc = vabal_u8(acc, vget_low_u8(pred), vget_low_u8(cur));
+    return vabal_u8(acc, vget_high_u8(pred), vget_high_u8(cur));
+}
+
+/* SAD 16x16 between blk (of stride 16) and ref (of stride lx) */
+static inline Int neon_sad_mb(UChar *ref, UChar *blk, Int dmin, Int lx)
+{
+    uint16x8_t acc = vdupq_n_u16(0);
+    Int i, sad = 0;
+
+    for (i = 0; i < 16; i++)
+    {
+        acc = neon_sad_row(acc, vld1q_u8(ref), blk);
+        ref += lx;
+        blk += 16;
+
+        if ((i & (NEON_SAD_ROWS - 1)) == NEON_SAD_ROWS - 1)
+        {
+            sad = neon_sad_sum(acc);
+            if (sad > dmin)
+                return sad;
+        }
+    }
+    return sad;
+}
+
+/* half-pel SAD, horizontally (p2 = ref + 1) or vertically (p2 = ref + rx) */
+static inline Int neon_sad_mb_halfpel1(UChar *ref, UChar *p2, UChar *blk, Int dmin, Int rx)
+{
+    uint16x8_t acc = vdupq_n_u16(0);
+    Int i, sad = 0;
+
+    for (i = 0; i < 16; i++)
+    {
+        /* (p1 + p2 + 1) >> 1 */
+        uint8x16_t pred = vrhaddq_u8(vld1q_u8(ref), vld1q_u8(p2));
+        acc = neon_sad_row(acc, pred, blk);
+        ref += rx;
+        p2 += rx;
+        blk += 16;
+
+        if ((i & (NEON_SAD_ROWS - 1)) == NEON_SAD_ROWS - 1)
+        {
+            sad = neon_sad_sum(acc);
+            if (sad > dmin)
+                return sad;
+        }
+    }
+    return sad;
+}
+
+/* half-pel SAD, both horizontally and vertically */
+static inline Int neon_sad_mb_halfpel2(UChar *ref, UChar *blk, Int dmin, Int rx)
+{
+    uint16x8_t acc = vdupq_n_u16(0);
+    uint8x16_t top0 = vld1q_u8(ref);
+    uint8x16_t top1 = vld1q_u8(ref + 1);
+    uint16x8_t topLo = vaddl_u8(vget_low_u8(top0), vget_low_u8(top1));
+    uint16x8_t topHi = vaddl_u8(vget_high_u8(top0), vget_high_u8(top1));
+    Int i, sad = 0;
+
+    for (i = 0; i < 16; i++)
+    {
+        ref += rx;
+        uint8x16_t bottom0 = vld1q_u8(ref);
+        uint8x16_t bottom1 = vld1q_u8(ref + 1);
+        uint16x8_t bottomLo = vaddl_u8(vget_low_u8(bottom0), vget_low_u8(bottom1));
+        uint16x8_t bottomHi = vaddl_u8(vget_high_u8(bottom0), vget_high_u8(bottom1));
+
+        /* (p1 + p2 + p3 + p4 + 2) >> 2 */
+        uint8x16_t pred = vcombine_u8(
+                vrshrn_n_u16(vaddq_u16(topLo, bottomLo), 2),
+                vrshrn_n_u16(vaddq_u16(topHi, bottomHi), 2));
+        acc = neon_sad_row(acc, pred, blk);
+        topLo = bottomLo;
+        topHi = bottomHi;
+        blk += 16;
+
+        if ((i & (NEON_SAD_ROWS - 1)) == NEON_SAD_ROWS - 1)
+        {
+            sad = neon_sad_sum(acc);
+            if (sad > dmin)
+                return sad;
+        }
+    }
+    return sad;
+}
+
+#endif /* __ARM_NEON__ || __aarch64__ */
+
+#endif /* _SAD_NEON_INLINE_H_ */
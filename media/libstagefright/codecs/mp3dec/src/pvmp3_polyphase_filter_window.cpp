@@ -50,6 +50,10 @@ Input
     apply polyphase filter window
     Input 32 subband samples
     Calculate 64 values
+
+    On NEON builds, the outputs 1 to 15 and 17 to 31 are computed 4 at a
+    time, with the same 32 bit fixed point arithmetic, so that the output
+    is the same as the one of the C version.
 ------------------------------------------------------------------------------
  REQUIREMENTS
 
@@ -76,6 +80,11 @@ Input
 #include "pvmp3_dec_defs.h"
 #include "pvmp3_tables.h"
 
+#if defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#define PV_MP3_NEON
+#endif
+
 /*----------------------------------------------------------------------------
 ; MACROS
 ; Define module1 specific macros here
@@ -94,6 +103,25 @@ Input
 ; Function Prototype declaration
 ----------------------------------------------------------------------------*/
 
+#ifdef PV_MP3_NEON
+
+/* fxp_mul32_Q32() of each lane */
+static inline int32x4_t fxp_mul32_Q32_x4(int32x4_t a, int32x4_t b)
+{
+    int64x2_t lo = vmull_s32(vget_low_s32(a), vget_low_s32(b));
+    int64x2_t hi = vmull_s32(vget_high_s32(a), vget_high_s32(b));
+    return vcombine_s32(vshrn_n_s64(lo, 32), vshrn_n_s64(hi, 32));
+}
+
+/* loads p[3], p[2], p[1], p[0] */
+static inline int32x4_t load_reversed(const int32 *p)
+{
+    int32x4_t v = vrev64q_s32(vld1q_s32(p));
+    return vcombine_s32(vget_high_s32(v), vget_low_s32(v));
+}
+
+#endif
+
 /*----------------------------------------------------------------------------
 ; LOCAL STORE/BUFFER/POINTER DEFINITIONS
 ; Variable declaration - defined here and used outside this module1
@@ -122,6 +150,54 @@ void pvmp3_polyphase_filter_window(int32 *synth_buffer,
     int32 i;
 
 
+#ifdef PV_MP3_NEON
+    /* lane k of each vector is for j + k, the last lane of j = 13 is dropped */
+    for (int32 j = 1; j < SUBBANDS_NUMBER / 2; j += 4)
+    {
+        const int32 *pt_1 = &synth_buffer[(SUBBANDS_NUMBER >> 1) + j];
+        const int32 *pt_2 = &synth_buffer[(SUBBANDS_NUMBER >> 1) - j - 3];
+        int32x4_t vsum1 = vdupq_n_s32(0x00000020);
+        int32x4_t vsum2 = vdupq_n_s32(0x00000020);
+
+        for (int32 m = 0; m < 4; m++)
+        {
+            int32x4_t temp1 = vld1q_s32(&pt_1[SUBBANDS_NUMBER * (2 * m)]);
+            int32x4_t temp3 = load_reversed(&pt_2[SUBBANDS_NUMBER * (15 - 2 * m)]);
+            int32x4_t temp2 = load_reversed(&pt_2[SUBBANDS_NUMBER * (2 * m + 1)]);
+            int32x4_t temp4 = vld1q_s32(&pt_1[SUBBANDS_NUMBER * (14 - 2 * m)]);
+
+            /* winPtr[4*m .. 4*m + 3] of the 4 rows of 16 coefficients, transposed */
+            const int32 *win = &winPtr[((j - 1) << 4) + (m << 2)];
+            int32x4x2_t t01 = vtrnq_s32(vld1q_s32(win), vld1q_s32(win + 16));
+            int32x4x2_t t23 = vtrnq_s32(vld1q_s32(win + 32), vld1q_s32(win + 48));
+            int32x4_t w0 = vcombine_s32(vget_low_s32(t01.val[0]), vget_low_s32(t23.val[0]));
+            int32x4_t w1 = vcombine_s32(vget_low_s32(t01.val[1]), vget_low_s32(t23.val[1]));
+            int32x4_t w2 = vcombine_s32(vget_high_s32(t01.val[0]), vget_high_s32(t23.val[0]));
+            int32x4_t w3 = vcombine_s32(vget_high_s32(t01.val[1]), vget_high_s32(t23.val[1]));
+
+            vsum1 = vaddq_s32(vsum1, fxp_mul32_Q32_x4(temp1, w0));
+            vsum2 = vaddq_s32(vsum2, fxp_mul32_Q32_x4(temp3, w0));
+            vsum2 = vaddq_s32(vsum2, fxp_mul32_Q32_x4(temp1, w1));
+            vsum1 = vsubq_s32(vsum1, fxp_mul32_Q32_x4(temp3, w1));
+            vsum1 = vaddq_s32(vsum1, fxp_mul32_Q32_x4(temp2, w2));
+            vsum2 = vsubq_s32(vsum2, fxp_mul32_Q32_x4(temp4, w2));
+            vsum2 = vaddq_s32(vsum2, fxp_mul32_Q32_x4(temp2, w3));
+            vsum1 = vaddq_s32(vsum1, fxp_mul32_Q32_x4(temp4, w3));
+        }
+
+        int16 out1[4];
+        int16 out2[4];
+        vst1_s16(out1, vqmovn_s32(vshrq_n_s32(vsum1, 6)));
+        vst1_s16(out2, vqmovn_s32(vshrq_n_s32(vsum2, 6)));
+        for (int32 k = 0; k < 4 && j + k < SUBBANDS_NUMBER / 2; k++)
+        {
+            int32 n = (j + k) << (numChannels - 1);
+            outPcm[n] = out1[k];
+            outPcm[(numChannels<<5) - n] = out2[k];
+        }
+    }
+    winPtr += ((SUBBANDS_NUMBER / 2) - 1) << 4;
+#else
     for (int16 j = 1; j < SUBBANDS_NUMBER / 2; j++)
     {
         sum1 = 0x00000020;
@@ -199,6 +275,7 @@ void pvmp3_polyphase_filter_window(int32 *synth_buffer,
         outPcm[k] = saturate16(sum1 >> 6);
         outPcm[(numChannels<<5) - k] = saturate16(sum2 >> 6);
     }
+#endif
 
 
 
@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <assert.h>
 #include <string.h>
+#include <time.h>
 
 #include "pvmp3decoder_api.h"
 #include "mp3reader.h"
@@ -37,6 +38,12 @@
 
 using namespace std;
 
+static int64_t getNowUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000ll + ts.tv_nsec / 1000;
+}
+
 enum {
     kInputBufferSize = 10 * 1024,
     kOutputBufferSize = 4608 * 2,
@@ -95,6 +102,9 @@ int main(int argc, const char **argv) {
 
     // Decode loop.
     int retVal = EXIT_SUCCESS;
+    int64_t decodeTimeUs = 0;
+    int64_t numSamples = 0;
+    int numFrames = 0;
     while (1) {
         // Read input from the file.
         uint32_t bytesRead;
@@ -110,7 +120,9 @@ int main(int argc, const char **argv) {
         config.outputFrameSize = kOutputBufferSize / sizeof(int16_t);
 
         ERROR_CODE decoderErr;
+        int64_t startUs = getNowUs();
         decoderErr = pvmp3_framedecoder(&config, decoderBuf);
+        decodeTimeUs += getNowUs() - startUs;
         if (decoderErr != NO_DECODING_ERROR) {
             fprintf(stderr, "Decoder encountered error\n");
             retVal = EXIT_FAILURE;
@@ -118,7 +130,18 @@ int main(int argc, const char **argv) {
         }
         sf_writef_short(handle, outputBuf,
                         config.outputFrameSize / sfInfo.channels);
+        numSamples += config.outputFrameSize / sfInfo.channels;
+        ++numFrames;
+    }
+
+    // Report the decoding speed, not counting the file accesses.
+    double audioDurationSec = (double)numSamples / sfInfo.samplerate;
+    printf("%s: %d frames, %.2f s of audio decoded in %.3f s",
+           argv[1], numFrames, audioDurationSec, decodeTimeUs / 1E6);
+    if (decodeTimeUs > 0) {
+        printf(", %.1fx real time", audioDurationSec * 1E6 / decodeTimeUs);
     }
+    printf("\n");
 
     // Close input reader and output writer.
     mp3Reader.close();
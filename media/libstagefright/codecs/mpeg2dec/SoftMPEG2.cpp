@@ -104,19 +104,6 @@ static size_t getMinTimestampIdx(OMX_S64 *pNTimeStamp, bool *pIsTimeStampValid)
     return idx;
 }
 
-static size_t GetCPUCoreCount() {
-    long cpuCoreCount = 1;
-#if defined(_SC_NPROCESSORS_ONLN)
-    cpuCoreCount = sysconf(_SC_NPROCESSORS_ONLN);
-#else
-    // _SC_NPROC_ONLN must be defined...
-    cpuCoreCount = sysconf(_SC_NPROC_ONLN);
-#endif
-    CHECK(cpuCoreCount >= 1);
-    ALOGV("Number of CPU cores: %ld", cpuCoreCount);
-    return (size_t)cpuCoreCount;
-}
-
 void SoftMPEG2::logVersion() {
     ivd_ctl_getversioninfo_ip_t s_ctl_ip;
     ivd_ctl_getversioninfo_op_t s_ctl_op;
@@ -212,9 +199,10 @@ status_t SoftMPEG2::setNumCores() {
     ivdext_ctl_set_num_cores_ip_t s_set_cores_ip;
     ivdext_ctl_set_num_cores_op_t s_set_cores_op;
     IV_API_CALL_STATUS_T status;
+    mNumCores = acquireDecodeThreads(CODEC_MAX_NUM_CORES);
     s_set_cores_ip.e_cmd = IVD_CMD_VIDEO_CTL;
     s_set_cores_ip.e_sub_cmd = IVDEXT_CMD_CTL_SET_NUM_CORES;
-    s_set_cores_ip.u4_num_cores = MIN(mNumCores, CODEC_MAX_NUM_CORES);
+    s_set_cores_ip.u4_num_cores = mNumCores;
     s_set_cores_ip.u4_size = sizeof(ivdext_ctl_set_num_cores_ip_t);
     s_set_cores_op.u4_size = sizeof(ivdext_ctl_set_num_cores_op_t);
 
@@ -259,7 +247,6 @@ status_t SoftMPEG2::initDecoder() {
     UWORD32 u4_num_ref_frames;
     UWORD32 u4_share_disp_buf;
 
-    mNumCores = GetCPUCoreCount();
     mWaitForI = true;
 
     /* Initialize number of ref and reorder modes (for MPEG2) */
@@ -412,6 +399,8 @@ status_t SoftMPEG2::initDecoder() {
 status_t SoftMPEG2::deInitDecoder() {
     size_t i;
 
+    releaseDecodeThreads();
+
     if (mMemRecords) {
         iv_mem_rec_t *ps_mem_rec;
 
@@ -23,8 +23,10 @@
 
 namespace android {
 
-#define ivd_aligned_malloc(alignment, size) memalign(alignment, size)
-#define ivd_aligned_free(buf) free(buf)
+// Used in the members of SoftMPEG2 only: the memory records are taken from the frame pool of
+// the component, for reInitDecoder() to reuse them.
+#define ivd_aligned_malloc(alignment, size) allocateFrameMemory(alignment, size)
+#define ivd_aligned_free(buf) freeFrameMemory(buf)
 
 /** Number of entries in the time-stamp array */
 #define MAX_TIME_STAMPS 64
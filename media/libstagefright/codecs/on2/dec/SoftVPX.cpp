@@ -156,15 +156,16 @@ bool SoftVPX::outputBuffers(bool flushDecoder, bool display, bool eos, bool *por
         outHeader->nFlags = 0;
         outHeader->nFilledLen = (outputBufferWidth() * outputBufferHeight() * 3) / 2;
         outHeader->nTimeStamp = *(OMX_TICKS *)mImg->user_priv;
-        if (outputBufferSafe(outHeader)) {
-            uint8_t *dst = outHeader->pBuffer;
+        OutputPlanes dst;
+        if (outputBufferSafe(outHeader) && lockOutputBuffer(outHeader, &dst)) {
             const uint8_t *srcY = (const uint8_t *)mImg->planes[VPX_PLANE_Y];
             const uint8_t *srcU = (const uint8_t *)mImg->planes[VPX_PLANE_U];
             const uint8_t *srcV = (const uint8_t *)mImg->planes[VPX_PLANE_V];
             size_t srcYStride = mImg->stride[VPX_PLANE_Y];
             size_t srcUStride = mImg->stride[VPX_PLANE_U];
             size_t srcVStride = mImg->stride[VPX_PLANE_V];
-            copyYV12FrameToOutputBuffer(dst, srcY, srcU, srcV, srcYStride, srcUStride, srcVStride);
+            copyYV12FrameToOutputPlanes(dst, srcY, srcU, srcV, srcYStride, srcUStride, srcVStride);
+            unlockOutputBuffer(outHeader);
         } else {
             outHeader->nFilledLen = 0;
         }
@@ -325,6 +326,10 @@ void SoftVPX::onReset() {
     mEOSStatus = INPUT_DATA_AVAILABLE;
 }
 
+bool SoftVPX::supportsNativeBuffers() {
+    return true;
+}
+
 }  // namespace android
 
 android::SoftOMXComponent *createSoftOMXComponent(
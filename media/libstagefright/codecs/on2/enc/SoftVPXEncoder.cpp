@@ -107,6 +107,7 @@ SoftVPXEncoder::~SoftVPXEncoder() {
 status_t SoftVPXEncoder::initEncoder() {
     vpx_codec_err_t codec_return;
     status_t result = UNKNOWN_ERROR;
+    int32_t dctPartitions = mDCTPartitions;
 
     mCodecInterface = vpx_codec_vp8_cx();
     if (mCodecInterface == NULL) {
@@ -130,6 +131,21 @@ status_t SoftVPXEncoder::initEncoder() {
     mCodecConfiguration->g_h = mHeight;
     mCodecConfiguration->g_threads = GetCPUCoreCount();
     mCodecConfiguration->g_error_resilient = mErrorResilience;
+    if (mRealTime) {
+        mCodecConfiguration->g_threads = getRealTimeEncodeThreads(GetCPUCoreCount());
+        // Disable lagged encoding.
+        mCodecConfiguration->g_lag_in_frames = 0;
+        // Unless set, use a token partition per thread so that they are packed in parallel,
+        // up to the 8 partitions of VP8E_SET_TOKEN_PARTITIONS.
+        if (dctPartitions == 0) {
+            while (dctPartitions < 3
+                    && (1u << (dctPartitions + 1)) <= mCodecConfiguration->g_threads) {
+                ++dctPartitions;
+            }
+        }
+        ALOGV("real time encoding on %u threads, %d token partitions",
+                mCodecConfiguration->g_threads, 1 << dctPartitions);
+    }
 
     switch (mLevel) {
         case OMX_VIDEO_VP8Level_Version0:
@@ -285,7 +301,7 @@ status_t SoftVPXEncoder::initEncoder() {
 
     codec_return = vpx_codec_control(mCodecContext,
                                      VP8E_SET_TOKEN_PARTITIONS,
-                                     mDCTPartitions);
+                                     dctPartitions);
     if (codec_return != VPX_CODEC_OK) {
         ALOGE("Error setting dct partitions for vpx encoder.");
         goto CLEAN_UP;
@@ -316,6 +332,15 @@ status_t SoftVPXEncoder::initEncoder() {
             ALOGE("Error setting cbr parameters for vpx encoder.");
             goto CLEAN_UP;
         }
+    } else if (mRealTime) {
+        // Fastest real time speed, as with CBR.
+        codec_return = vpx_codec_control(mCodecContext,
+                                         VP8E_SET_CPUUSED,
+                                         -8);
+        if (codec_return != VPX_CODEC_OK) {
+            ALOGE("Error setting real time speed for vpx encoder.");
+            goto CLEAN_UP;
+        }
     }
 
     if (mColorFormat != OMX_COLOR_FormatYUV420Planar || mInputDataIsMeta) {
@@ -526,7 +551,7 @@ OMX_ERRORTYPE SoftVPXEncoder::setConfig(
         }
 
         default:
-            return SimpleSoftOMXComponent::setConfig(index, _params);
+            return SoftVideoEncoderOMXComponent::setConfig(index, _params);
     }
 }
 
@@ -40,6 +40,11 @@ static const int kRate = 48000;
 // http://www.xiph.org/vorbis/doc/Vorbis_I_spec.html
 static const int kMaxChannels = 8;
 
+// Maximum difference between the timestamp of a packet and the time it follows on from,
+// for it to be appended to the same output buffer.
+static const int64_t kMaxBatchTimestampJitterUs = 1000;
+static const OMX_U32 kMaxOutputBatchDurationUs = 1000000;
+
 template<class T>
 static void InitOMXParams(T *params) {
     params->nSize = sizeof(T);
@@ -62,6 +67,7 @@ SoftOpus::SoftOpus(
       mSeekPreRoll(0),
       mAnchorTimeUs(0),
       mNumFramesOutput(0),
+      mOutputBatchDurationUs(0),
       mOutputPortSettingsChange(NONE) {
     initPorts();
     CHECK_EQ(initDecoder(), (status_t)OK);
@@ -186,6 +192,22 @@ OMX_ERRORTYPE SoftOpus::internalGetParameter(
             return OMX_ErrorNone;
         }
 
+        case kOutputBatchDurationIndex:
+        {
+            OMX_PARAM_U32TYPE *batchParams = (OMX_PARAM_U32TYPE *)params;
+
+            if (!isValidOMXParam(batchParams)) {
+                return OMX_ErrorBadParameter;
+            }
+
+            if (batchParams->nPortIndex != 1) {
+                return OMX_ErrorUndefined;
+            }
+
+            batchParams->nU32 = mOutputBatchDurationUs;
+            return OMX_ErrorNone;
+        }
+
         default:
             return SimpleSoftOMXComponent::internalGetParameter(index, params);
     }
@@ -228,11 +250,50 @@ OMX_ERRORTYPE SoftOpus::internalSetParameter(
             return OMX_ErrorNone;
         }
 
+        case kOutputBatchDurationIndex:
+        {
+            const OMX_PARAM_U32TYPE *batchParams = (const OMX_PARAM_U32TYPE *)params;
+
+            if (!isValidOMXParam(batchParams)) {
+                return OMX_ErrorBadParameter;
+            }
+
+            if (batchParams->nPortIndex != 1) {
+                return OMX_ErrorUndefined;
+            }
+
+            if (batchParams->nU32 > kMaxOutputBatchDurationUs) {
+                return OMX_ErrorUnsupportedSetting;
+            }
+
+            // room for the batch, plus the largest packet that can end it
+            mOutputBatchDurationUs = batchParams->nU32;
+            OMX_U32 bufferSize = (OMX_U32)(
+                    ((int64_t)mOutputBatchDurationUs * kRate / 1000000ll
+                            + kMaxNumSamplesPerBuffer) * sizeof(int16_t) * kMaxChannels);
+            OMX_PARAM_PORTDEFINITIONTYPE *def = &editPortInfo(1)->mDef;
+            if (def->nBufferSize < bufferSize) {
+                def->nBufferSize = bufferSize;
+            }
+
+            return OMX_ErrorNone;
+        }
+
         default:
             return SimpleSoftOMXComponent::internalSetParameter(index, params);
     }
 }
 
+OMX_ERRORTYPE SoftOpus::getExtensionIndex(
+        const char *name, OMX_INDEXTYPE *index) {
+    if (!strcmp(name, "OMX.google.android.index.outputBatchDurationUs")) {
+        *(int32_t *)index = kOutputBatchDurationIndex;
+        return OMX_ErrorNone;
+    }
+
+    return SimpleSoftOMXComponent::getExtensionIndex(name, index);
+}
+
 bool SoftOpus::isConfigured() const {
     return mInputBufferCount >= 1;
 }
@@ -444,74 +505,121 @@ void SoftOpus::onQueueFilled(OMX_U32 portIndex) {
             return;
         }
 
-        if (inHeader->nOffset == 0) {
-            mAnchorTimeUs = inHeader->nTimeStamp;
-            mNumFramesOutput = 0;
-        }
+        outHeader->nOffset = 0;
+        outHeader->nFilledLen = 0;
+        outHeader->nFlags = 0;
 
-        // When seeking to zero, |mCodecDelay| samples has to be discarded
-        // instead of |mSeekPreRoll| samples (as we would when seeking to any
-        // other timestamp).
-        if (inHeader->nTimeStamp == 0) {
-            mSamplesToDiscard = mCodecDelay;
-        }
+        for (;;) {
+            if (!decodePacket(inHeader, outHeader)) {
+                return;
+            }
 
-        const uint8_t *data = inHeader->pBuffer + inHeader->nOffset;
-        const uint32_t size = inHeader->nFilledLen;
-        size_t frameSize = kMaxOpusOutputPacketSizeSamples;
-        if (frameSize > outHeader->nAllocLen / sizeof(int16_t) / mHeader->channels) {
-            frameSize = outHeader->nAllocLen / sizeof(int16_t) / mHeader->channels;
-            android_errorWriteLog(0x534e4554, "27833616");
-        }
+            inInfo->mOwnedByUs = false;
+            inQueue.erase(inQueue.begin());
+            inInfo = NULL;
+            notifyEmptyBufferDone(inHeader);
+            inHeader = NULL;
 
-        int numFrames = opus_multistream_decode(mDecoder,
-                                                data,
-                                                size,
-                                                (int16_t *)outHeader->pBuffer,
-                                                frameSize,
-                                                0);
-        if (numFrames < 0) {
-            ALOGE("opus_multistream_decode returned %d", numFrames);
-            notify(OMX_EventError, OMX_ErrorUndefined, 0, NULL);
-            return;
-        }
+            ++mInputBufferCount;
 
-        outHeader->nOffset = 0;
-        if (mSamplesToDiscard > 0) {
-            if (mSamplesToDiscard > numFrames) {
-                mSamplesToDiscard -= numFrames;
-                numFrames = 0;
-            } else {
-                numFrames -= mSamplesToDiscard;
-                outHeader->nOffset = mSamplesToDiscard * sizeof(int16_t) *
-                                     mHeader->channels;
-                mSamplesToDiscard = 0;
+            if (inQueue.empty()) {
+                break;
+            }
+            inInfo = *inQueue.begin();
+            inHeader = inInfo->mHeader;
+            if (!canAppendPacket(inHeader, outHeader)) {
+                break;
             }
         }
 
-        outHeader->nFilledLen = numFrames * sizeof(int16_t) * mHeader->channels;
-        outHeader->nFlags = 0;
+        outInfo->mOwnedByUs = false;
+        outQueue.erase(outQueue.begin());
+        outInfo = NULL;
+        notifyFillBufferDone(outHeader);
+        outHeader = NULL;
+    }
+}
+
+bool SoftOpus::decodePacket(
+        OMX_BUFFERHEADERTYPE *inHeader, OMX_BUFFERHEADERTYPE *outHeader) {
+    if (inHeader->nOffset == 0) {
+        mAnchorTimeUs = inHeader->nTimeStamp;
+        mNumFramesOutput = 0;
+    }
+
+    // When seeking to zero, |mCodecDelay| samples has to be discarded
+    // instead of |mSeekPreRoll| samples (as we would when seeking to any
+    // other timestamp).
+    if (inHeader->nTimeStamp == 0) {
+        mSamplesToDiscard = mCodecDelay;
+    }
+
+    const size_t frameBytes = sizeof(int16_t) * mHeader->channels;
+    const uint32_t outOffset = outHeader->nOffset + outHeader->nFilledLen;
+    const uint8_t *data = inHeader->pBuffer + inHeader->nOffset;
+    const uint32_t size = inHeader->nFilledLen;
+    size_t frameSize = kMaxOpusOutputPacketSizeSamples;
+    if (frameSize > (outHeader->nAllocLen - outOffset) / frameBytes) {
+        frameSize = (outHeader->nAllocLen - outOffset) / frameBytes;
+        android_errorWriteLog(0x534e4554, "27833616");
+    }
 
+    int numFrames = opus_multistream_decode(mDecoder,
+                                            data,
+                                            size,
+                                            (int16_t *)(outHeader->pBuffer + outOffset),
+                                            frameSize,
+                                            0);
+    if (numFrames < 0) {
+        ALOGE("opus_multistream_decode returned %d", numFrames);
+        notify(OMX_EventError, OMX_ErrorUndefined, 0, NULL);
+        return false;
+    }
+
+    // Samples are only discarded at the start of an output buffer, see canAppendPacket().
+    if (outHeader->nFilledLen == 0) {
         outHeader->nTimeStamp = mAnchorTimeUs +
                                 (mNumFramesOutput * 1000000ll) /
                                 kRate;
+    }
+    mNumFramesOutput += numFrames;
 
-        mNumFramesOutput += numFrames;
+    if (mSamplesToDiscard > 0) {
+        if (mSamplesToDiscard > numFrames) {
+            mSamplesToDiscard -= numFrames;
+            numFrames = 0;
+        } else {
+            numFrames -= mSamplesToDiscard;
+            outHeader->nOffset += mSamplesToDiscard * frameBytes;
+            mSamplesToDiscard = 0;
+        }
+    }
 
-        inInfo->mOwnedByUs = false;
-        inQueue.erase(inQueue.begin());
-        inInfo = NULL;
-        notifyEmptyBufferDone(inHeader);
-        inHeader = NULL;
+    outHeader->nFilledLen += numFrames * frameBytes;
+    return true;
+}
 
-        outInfo->mOwnedByUs = false;
-        outQueue.erase(outQueue.begin());
-        outInfo = NULL;
-        notifyFillBufferDone(outHeader);
-        outHeader = NULL;
+bool SoftOpus::canAppendPacket(
+        const OMX_BUFFERHEADERTYPE *inHeader, const OMX_BUFFERHEADERTYPE *outHeader) const {
+    if (mOutputBatchDurationUs == 0 || outHeader->nFilledLen == 0
+            || (inHeader->nFlags & (OMX_BUFFERFLAG_EOS | OMX_BUFFERFLAG_CODECCONFIG))) {
+        return false;
+    }
 
-        ++mInputBufferCount;
+    const size_t frameBytes = sizeof(int16_t) * mHeader->channels;
+    const int64_t numFrames = outHeader->nFilledLen / frameBytes;
+    if (numFrames * 1000000ll >= (int64_t)mOutputBatchDurationUs * kRate
+            || outHeader->nAllocLen - outHeader->nOffset - outHeader->nFilledLen
+                    < kMaxOpusOutputPacketSizeSamples * frameBytes) {
+        return false;
     }
+
+    // The packet must start where the output buffer ends, for its samples to keep their
+    // timestamps. This also stops at a seek to zero, which has samples to discard.
+    const int64_t endTimeUs = outHeader->nTimeStamp + (numFrames * 1000000ll) / kRate;
+    const int64_t driftUs = inHeader->nTimeStamp - endTimeUs;
+    return driftUs <= kMaxBatchTimestampJitterUs && driftUs >= -kMaxBatchTimestampJitterUs
+            && mSamplesToDiscard == 0;
 }
 
 void SoftOpus::onPortFlushCompleted(OMX_U32 portIndex) {
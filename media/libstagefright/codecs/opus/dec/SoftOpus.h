@@ -54,6 +54,9 @@ protected:
     virtual OMX_ERRORTYPE internalSetParameter(
             OMX_INDEXTYPE index, const OMX_PTR params);
 
+    virtual OMX_ERRORTYPE getExtensionIndex(
+            const char *name, OMX_INDEXTYPE *index);
+
     virtual void onQueueFilled(OMX_U32 portIndex);
     virtual void onPortFlushCompleted(OMX_U32 portIndex);
     virtual void onPortEnableCompleted(OMX_U32 portIndex, bool enabled);
@@ -65,6 +68,10 @@ private:
         kMaxNumSamplesPerBuffer = 960 * 6
     };
 
+    enum {
+        kOutputBatchDurationIndex = kUseAndroidNativeBufferIndex + 1,
+    };
+
     size_t mInputBufferCount;
 
     OpusMSDecoder *mDecoder;
@@ -76,6 +83,10 @@ private:
     int64_t mAnchorTimeUs;
     int64_t mNumFramesOutput;
 
+    // If nonzero, the packets queued after the one decoded in an output buffer are
+    // appended to it, as long as they follow on and at most this duration is output.
+    OMX_U32 mOutputBatchDurationUs;
+
     enum {
         NONE,
         AWAITING_DISABLED,
@@ -86,6 +97,11 @@ private:
     status_t initDecoder();
     bool isConfigured() const;
 
+    // Decodes the packet of inHeader after the data of outHeader. Returns false on error.
+    bool decodePacket(OMX_BUFFERHEADERTYPE *inHeader, OMX_BUFFERHEADERTYPE *outHeader);
+    bool canAppendPacket(
+            const OMX_BUFFERHEADERTYPE *inHeader, const OMX_BUFFERHEADERTYPE *outHeader) const;
+
     DISALLOW_EVIL_CONSTRUCTORS(SoftOpus);
 };
 
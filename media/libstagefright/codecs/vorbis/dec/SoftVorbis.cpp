@@ -33,6 +33,11 @@ extern "C" {
 
 namespace android {
 
+// Maximum difference between the timestamp of a packet and the time it follows on from,
+// for it to be appended to the same output buffer.
+static const int64_t kMaxBatchTimestampJitterUs = 1000;
+static const OMX_U32 kMaxOutputBatchDurationUs = 1000000;
+
 template<class T>
 static void InitOMXParams(T *params) {
     params->nSize = sizeof(T);
@@ -57,6 +62,7 @@ SoftVorbis::SoftVorbis(
       mSawInputEos(false),
       mSignalledOutputEos(false),
       mSignalledError(false),
+      mOutputBatchDurationUs(0),
       mOutputPortSettingsChange(NONE) {
     initPorts();
     CHECK_EQ(initDecoder(), (status_t)OK);
@@ -125,7 +131,7 @@ status_t SoftVorbis::initDecoder() {
 
 OMX_ERRORTYPE SoftVorbis::internalGetParameter(
         OMX_INDEXTYPE index, OMX_PTR params) {
-    switch (index) {
+    switch ((int)index) {
         case OMX_IndexParamAudioVorbis:
         {
             OMX_AUDIO_PARAM_VORBISTYPE *vorbisParams =
@@ -193,6 +199,22 @@ OMX_ERRORTYPE SoftVorbis::internalGetParameter(
             return OMX_ErrorNone;
         }
 
+        case kOutputBatchDurationIndex:
+        {
+            OMX_PARAM_U32TYPE *batchParams = (OMX_PARAM_U32TYPE *)params;
+
+            if (!isValidOMXParam(batchParams)) {
+                return OMX_ErrorBadParameter;
+            }
+
+            if (batchParams->nPortIndex != 1) {
+                return OMX_ErrorUndefined;
+            }
+
+            batchParams->nU32 = mOutputBatchDurationUs;
+            return OMX_ErrorNone;
+        }
+
         default:
             return SimpleSoftOMXComponent::internalGetParameter(index, params);
     }
@@ -200,7 +222,7 @@ OMX_ERRORTYPE SoftVorbis::internalGetParameter(
 
 OMX_ERRORTYPE SoftVorbis::internalSetParameter(
         OMX_INDEXTYPE index, const OMX_PTR params) {
-    switch (index) {
+    switch ((int)index) {
         case OMX_IndexParamStandardComponentRole:
         {
             const OMX_PARAM_COMPONENTROLETYPE *roleParams =
@@ -235,11 +257,42 @@ OMX_ERRORTYPE SoftVorbis::internalSetParameter(
             return OMX_ErrorNone;
         }
 
+        case kOutputBatchDurationIndex:
+        {
+            const OMX_PARAM_U32TYPE *batchParams = (const OMX_PARAM_U32TYPE *)params;
+
+            if (!isValidOMXParam(batchParams)) {
+                return OMX_ErrorBadParameter;
+            }
+
+            if (batchParams->nPortIndex != 1) {
+                return OMX_ErrorUndefined;
+            }
+
+            if (batchParams->nU32 > kMaxOutputBatchDurationUs) {
+                return OMX_ErrorUnsupportedSetting;
+            }
+
+            // the output buffers are sized once the sample rate is known
+            mOutputBatchDurationUs = batchParams->nU32;
+            return OMX_ErrorNone;
+        }
+
         default:
             return SimpleSoftOMXComponent::internalSetParameter(index, params);
     }
 }
 
+OMX_ERRORTYPE SoftVorbis::getExtensionIndex(
+        const char *name, OMX_INDEXTYPE *index) {
+    if (!strcmp(name, "OMX.google.android.index.outputBatchDurationUs")) {
+        *(int32_t *)index = kOutputBatchDurationIndex;
+        return OMX_ErrorNone;
+    }
+
+    return SimpleSoftOMXComponent::getExtensionIndex(name, index);
+}
+
 bool SoftVorbis::isConfigured() const {
     return mInputBufferCount >= 2;
 }
@@ -313,6 +366,7 @@ void SoftVorbis::onQueueFilled(OMX_U32 portIndex) {
             mState = new vorbis_dsp_state;
             CHECK_EQ(0, vorbis_dsp_init(mState, mVi));
 
+            updateOutputBufferSize();
             notify(OMX_EventPortSettingsChanged, 1, 0, NULL);
             mOutputPortSettingsChange = AWAITING_DISABLED;
         }
@@ -337,123 +391,183 @@ void SoftVorbis::onQueueFilled(OMX_U32 portIndex) {
         BufferInfo *outInfo = *outQueue.begin();
         OMX_BUFFERHEADERTYPE *outHeader = outInfo->mHeader;
 
-        int32_t numPageSamples = 0;
+        outHeader->nOffset = 0;
+        outHeader->nFilledLen = 0;
+        outHeader->nFlags = 0;
 
-        if (inHeader) {
-            if (inHeader->nFlags & OMX_BUFFERFLAG_EOS) {
-                mSawInputEos = true;
+        for (;;) {
+            if (!decodePacket(inHeader, outHeader)) {
+                return;
             }
 
-            if (inHeader->nFilledLen || !mSawInputEos) {
-                if (inHeader->nFilledLen < sizeof(numPageSamples)) {
-                    notify(OMX_EventError, OMX_ErrorBadParameter, 0, NULL);
-                    mSignalledError = true;
-                    ALOGE("onQueueFilled, input header has nFilledLen %u, expected %zu",
-                            inHeader->nFilledLen, sizeof(numPageSamples));
-                    return;
-                }
-                memcpy(&numPageSamples,
-                       inHeader->pBuffer
-                        + inHeader->nOffset + inHeader->nFilledLen - 4,
-                       sizeof(numPageSamples));
-
-                if (inHeader->nOffset == 0) {
-                    mAnchorTimeUs = inHeader->nTimeStamp;
-                    mNumFramesOutput = 0;
-                }
-
-                inHeader->nFilledLen -= sizeof(numPageSamples);;
+            if (inHeader) {
+                inInfo->mOwnedByUs = false;
+                inQueue.erase(inQueue.begin());
+                inInfo = NULL;
+                notifyEmptyBufferDone(inHeader);
+                inHeader = NULL;
             }
-        }
 
-        if (numPageSamples >= 0) {
-            mNumFramesLeftOnPage = numPageSamples;
+            ++mInputBufferCount;
+
+            if (inQueue.empty()) {
+                break;
+            }
+            inInfo = *inQueue.begin();
+            inHeader = inInfo->mHeader;
+            if (!canAppendPacket(inHeader, outHeader)) {
+                break;
+            }
         }
 
-        ogg_buffer buf;
-        buf.data = inHeader ? inHeader->pBuffer + inHeader->nOffset : NULL;
-        buf.size = inHeader ? inHeader->nFilledLen : 0;
-        buf.refcount = 1;
-        buf.ptr.owner = NULL;
+        outInfo->mOwnedByUs = false;
+        outQueue.erase(outQueue.begin());
+        outInfo = NULL;
+        notifyFillBufferDone(outHeader);
+        outHeader = NULL;
+    }
+}
 
-        ogg_reference ref;
-        ref.buffer = &buf;
-        ref.begin = 0;
-        ref.length = buf.size;
-        ref.next = NULL;
+bool SoftVorbis::decodePacket(
+        OMX_BUFFERHEADERTYPE *inHeader, OMX_BUFFERHEADERTYPE *outHeader) {
+    int32_t numPageSamples = 0;
 
-        ogg_packet pack;
-        pack.packet = &ref;
-        pack.bytes = ref.length;
-        pack.b_o_s = 0;
-        pack.e_o_s = 0;
-        pack.granulepos = 0;
-        pack.packetno = 0;
+    if (inHeader) {
+        if (inHeader->nFlags & OMX_BUFFERFLAG_EOS) {
+            mSawInputEos = true;
+        }
 
-        int numFrames = 0;
+        if (inHeader->nFilledLen || !mSawInputEos) {
+            if (inHeader->nFilledLen < sizeof(numPageSamples)) {
+                notify(OMX_EventError, OMX_ErrorBadParameter, 0, NULL);
+                mSignalledError = true;
+                ALOGE("onQueueFilled, input header has nFilledLen %u, expected %zu",
+                        inHeader->nFilledLen, sizeof(numPageSamples));
+                return false;
+            }
+            memcpy(&numPageSamples,
+                   inHeader->pBuffer
+                    + inHeader->nOffset + inHeader->nFilledLen - 4,
+                   sizeof(numPageSamples));
+
+            if (inHeader->nOffset == 0) {
+                mAnchorTimeUs = inHeader->nTimeStamp;
+                mNumFramesOutput = 0;
+            }
 
-        outHeader->nFlags = 0;
-        int err = vorbis_dsp_synthesis(mState, &pack, 1);
-        if (err != 0) {
-            // FIXME temporary workaround for log spam
+            inHeader->nFilledLen -= sizeof(numPageSamples);;
+        }
+    }
+
+    if (numPageSamples >= 0) {
+        mNumFramesLeftOnPage = numPageSamples;
+    }
+
+    ogg_buffer buf;
+    buf.data = inHeader ? inHeader->pBuffer + inHeader->nOffset : NULL;
+    buf.size = inHeader ? inHeader->nFilledLen : 0;
+    buf.refcount = 1;
+    buf.ptr.owner = NULL;
+
+    ogg_reference ref;
+    ref.buffer = &buf;
+    ref.begin = 0;
+    ref.length = buf.size;
+    ref.next = NULL;
+
+    ogg_packet pack;
+    pack.packet = &ref;
+    pack.bytes = ref.length;
+    pack.b_o_s = 0;
+    pack.e_o_s = 0;
+    pack.granulepos = 0;
+    pack.packetno = 0;
+
+    int numFrames = 0;
+
+    const uint32_t outOffset = outHeader->nOffset + outHeader->nFilledLen;
+    int err = vorbis_dsp_synthesis(mState, &pack, 1);
+    if (err != 0) {
+        // FIXME temporary workaround for log spam
 #if !defined(__arm__) && !defined(__aarch64__)
-            ALOGV("vorbis_dsp_synthesis returned %d", err);
+        ALOGV("vorbis_dsp_synthesis returned %d", err);
 #else
-            ALOGW("vorbis_dsp_synthesis returned %d", err);
+        ALOGW("vorbis_dsp_synthesis returned %d", err);
 #endif
-        } else {
-            size_t numSamplesPerBuffer = kMaxNumSamplesPerBuffer;
-            if (numSamplesPerBuffer > outHeader->nAllocLen / sizeof(int16_t)) {
-                numSamplesPerBuffer = outHeader->nAllocLen / sizeof(int16_t);
-                android_errorWriteLog(0x534e4554, "27833616");
-            }
-            numFrames = vorbis_dsp_pcmout(
-                    mState, (int16_t *)outHeader->pBuffer,
-                    (numSamplesPerBuffer / mVi->channels));
+    } else {
+        size_t numSamplesPerBuffer = kMaxNumSamplesPerBuffer;
+        if (numSamplesPerBuffer > (outHeader->nAllocLen - outOffset) / sizeof(int16_t)) {
+            numSamplesPerBuffer = (outHeader->nAllocLen - outOffset) / sizeof(int16_t);
+            android_errorWriteLog(0x534e4554, "27833616");
+        }
+        numFrames = vorbis_dsp_pcmout(
+                mState, (int16_t *)(outHeader->pBuffer + outOffset),
+                (numSamplesPerBuffer / mVi->channels));
 
-            if (numFrames < 0) {
-                ALOGE("vorbis_dsp_pcmout returned %d", numFrames);
-                numFrames = 0;
-            }
+        if (numFrames < 0) {
+            ALOGE("vorbis_dsp_pcmout returned %d", numFrames);
+            numFrames = 0;
         }
+    }
 
-        if (mNumFramesLeftOnPage >= 0) {
-            if (numFrames > mNumFramesLeftOnPage) {
-                ALOGV("discarding %d frames at end of page",
-                     numFrames - mNumFramesLeftOnPage);
-                numFrames = mNumFramesLeftOnPage;
-                if (mSawInputEos) {
-                    outHeader->nFlags = OMX_BUFFERFLAG_EOS;
-                    mSignalledOutputEos = true;
-                }
+    if (mNumFramesLeftOnPage >= 0) {
+        if (numFrames > mNumFramesLeftOnPage) {
+            ALOGV("discarding %d frames at end of page",
+                 numFrames - mNumFramesLeftOnPage);
+            numFrames = mNumFramesLeftOnPage;
+            if (mSawInputEos) {
+                outHeader->nFlags = OMX_BUFFERFLAG_EOS;
+                mSignalledOutputEos = true;
             }
-            mNumFramesLeftOnPage -= numFrames;
         }
+        mNumFramesLeftOnPage -= numFrames;
+    }
 
-        outHeader->nFilledLen = numFrames * sizeof(int16_t) * mVi->channels;
-        outHeader->nOffset = 0;
-
+    if (outHeader->nFilledLen == 0) {
         outHeader->nTimeStamp =
             mAnchorTimeUs
                 + (mNumFramesOutput * 1000000ll) / mVi->rate;
+    }
+    outHeader->nFilledLen += numFrames * sizeof(int16_t) * mVi->channels;
 
-        mNumFramesOutput += numFrames;
+    mNumFramesOutput += numFrames;
+    return true;
+}
 
-        if (inHeader) {
-            inInfo->mOwnedByUs = false;
-            inQueue.erase(inQueue.begin());
-            inInfo = NULL;
-            notifyEmptyBufferDone(inHeader);
-            inHeader = NULL;
-        }
+bool SoftVorbis::canAppendPacket(
+        const OMX_BUFFERHEADERTYPE *inHeader, const OMX_BUFFERHEADERTYPE *outHeader) const {
+    if (mOutputBatchDurationUs == 0 || outHeader->nFilledLen == 0 || mSignalledOutputEos
+            || (inHeader->nFlags & (OMX_BUFFERFLAG_EOS | OMX_BUFFERFLAG_CODECCONFIG))) {
+        return false;
+    }
 
-        outInfo->mOwnedByUs = false;
-        outQueue.erase(outQueue.begin());
-        outInfo = NULL;
-        notifyFillBufferDone(outHeader);
-        outHeader = NULL;
+    const size_t frameBytes = sizeof(int16_t) * mVi->channels;
+    const int64_t numFrames = outHeader->nFilledLen / frameBytes;
+    if (numFrames * 1000000ll >= (int64_t)mOutputBatchDurationUs * mVi->rate
+            || outHeader->nAllocLen - outHeader->nOffset - outHeader->nFilledLen
+                    < kMaxNumSamplesPerBuffer * sizeof(int16_t)) {
+        return false;
+    }
 
-        ++mInputBufferCount;
+    // The packet must start where the output buffer ends, for its samples to keep their
+    // timestamps.
+    const int64_t endTimeUs = outHeader->nTimeStamp + (numFrames * 1000000ll) / mVi->rate;
+    const int64_t driftUs = inHeader->nTimeStamp - endTimeUs;
+    return driftUs <= kMaxBatchTimestampJitterUs && driftUs >= -kMaxBatchTimestampJitterUs;
+}
+
+void SoftVorbis::updateOutputBufferSize() {
+    if (mOutputBatchDurationUs == 0) {
+        return;
+    }
+
+    // room for the batch, plus the largest packet that can end it
+    OMX_U32 bufferSize = (OMX_U32)(
+            ((int64_t)mOutputBatchDurationUs * mVi->rate / 1000000ll * mVi->channels
+                    + kMaxNumSamplesPerBuffer) * sizeof(int16_t));
+    OMX_PARAM_PORTDEFINITIONTYPE *def = &editPortInfo(1)->mDef;
+    if (def->nBufferSize < bufferSize) {
+        def->nBufferSize = bufferSize;
     }
 }
 
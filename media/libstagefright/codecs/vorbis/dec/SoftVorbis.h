@@ -40,6 +40,9 @@ protected:
     virtual OMX_ERRORTYPE internalSetParameter(
             OMX_INDEXTYPE index, const OMX_PTR params);
 
+    virtual OMX_ERRORTYPE getExtensionIndex(
+            const char *name, OMX_INDEXTYPE *index);
+
     virtual void onQueueFilled(OMX_U32 portIndex);
     virtual void onPortFlushCompleted(OMX_U32 portIndex);
     virtual void onPortEnableCompleted(OMX_U32 portIndex, bool enabled);
@@ -51,6 +54,10 @@ private:
         kMaxNumSamplesPerBuffer = 8192 * 2
     };
 
+    enum {
+        kOutputBatchDurationIndex = kUseAndroidNativeBufferIndex + 1,
+    };
+
     size_t mInputBufferCount;
 
     vorbis_dsp_state *mState;
@@ -63,6 +70,10 @@ private:
     bool mSignalledOutputEos;
     bool mSignalledError;
 
+    // If nonzero, the packets queued after the one decoded in an output buffer are
+    // appended to it, as long as they follow on and at most this duration is output.
+    OMX_U32 mOutputBatchDurationUs;
+
     enum {
         NONE,
         AWAITING_DISABLED,
@@ -73,6 +84,13 @@ private:
     status_t initDecoder();
     bool isConfigured() const;
 
+    // Decodes the packet of inHeader, or the remaining samples at end of stream if it
+    // is NULL, after the data of outHeader. Returns false on error.
+    bool decodePacket(OMX_BUFFERHEADERTYPE *inHeader, OMX_BUFFERHEADERTYPE *outHeader);
+    bool canAppendPacket(
+            const OMX_BUFFERHEADERTYPE *inHeader, const OMX_BUFFERHEADERTYPE *outHeader) const;
+    void updateOutputBufferSize();
+
     DISALLOW_EVIL_CONSTRUCTORS(SoftVorbis);
 };
 
@@ -19,10 +19,13 @@
 #include <utils/Log.h>
 
 #include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/ColorUtils.h>
 #include <media/stagefright/ColorConverter.h>
 #include <media/stagefright/MediaErrors.h>
 
+#include "libyuv/convert_argb.h"
 #include "libyuv/convert_from.h"
+#include "libyuv/convert_from_argb.h"
 
 #define USE_LIBYUV
 
@@ -31,17 +34,16 @@ namespace android {
 ColorConverter::ColorConverter(
         OMX_COLOR_FORMATTYPE from, OMX_COLOR_FORMATTYPE to)
     : mSrcFormat(from),
-      mDstFormat(to),
-      mClip(NULL) {
+      mDstFormat(to) {
+    setSrcColorSpace(ColorUtils::kColorStandardUnspecified, ColorUtils::kColorRangeUnspecified);
 }
 
 ColorConverter::~ColorConverter() {
-    delete[] mClip;
-    mClip = NULL;
 }
 
 bool ColorConverter::isValid() const {
-    if (mDstFormat != OMX_COLOR_Format16bitRGB565) {
+    if (mDstFormat != OMX_COLOR_Format16bitRGB565
+            && mDstFormat != OMX_COLOR_Format32BitRGBA8888) {
         return false;
     }
 
@@ -58,6 +60,68 @@ bool ColorConverter::isValid() const {
     }
 }
 
+void ColorConverter::setSrcColorSpace(uint32_t standard, uint32_t range) {
+    mSrcStandard = standard;
+    mSrcRange = range;
+
+    // Kr and Kb of the matrix, as mapped by ColorUtils
+    double kr, kb;
+    switch (standard) {
+        case ColorUtils::kColorStandardBT709:
+        case ColorUtils::kColorStandardBT601_625_Unadjusted:
+            kr = 0.2126;
+            kb = 0.0722;
+            break;
+
+        case ColorUtils::kColorStandardBT601_525_Unadjusted:
+            // SMPTE 240M
+            kr = 0.212;
+            kb = 0.087;
+            break;
+
+        case ColorUtils::kColorStandardBT2020:
+        case ColorUtils::kColorStandardBT2020Constant:
+        case ColorUtils::kColorStandardFilm:
+            kr = 0.2627;
+            kb = 0.0593;
+            break;
+
+        case ColorUtils::kColorStandardBT470M:
+            kr = 0.30;
+            kb = 0.11;
+            break;
+
+        default:
+            kr = 0.299;
+            kb = 0.114;
+            break;
+    }
+    double kg = 1.0 - kr - kb;
+
+    bool fullRange = (range == ColorUtils::kColorRangeFull);
+    double yScale = fullRange ? 1.0 : 255.0 / 219.0;
+    double cScale = fullRange ? 1.0 : 255.0 / 224.0;
+
+    mCoeffs.mY = (int32_t)(yScale * 65536 + 0.5);
+    mCoeffs.mRV = (int32_t)(2 * (1 - kr) * cScale * 65536 + 0.5);
+    mCoeffs.mGU = (int32_t)(2 * kb * (1 - kb) / kg * cScale * 65536 + 0.5);
+    mCoeffs.mGV = (int32_t)(2 * kr * (1 - kr) / kg * cScale * 65536 + 0.5);
+    mCoeffs.mBU = (int32_t)(2 * (1 - kb) * cScale * 65536 + 0.5);
+    mCoeffs.mYOffset = fullRange ? 0 : 16;
+}
+
+bool ColorConverter::isBT601LimitedRange() const {
+    switch (mSrcStandard) {
+        case ColorUtils::kColorStandardUnspecified:
+        case ColorUtils::kColorStandardBT601_625:
+        case ColorUtils::kColorStandardBT601_525:
+            return mSrcRange != ColorUtils::kColorRangeFull;
+
+        default:
+            return false;
+    }
+}
+
 ColorConverter::BitmapParams::BitmapParams(
         void *bits,
         size_t width, size_t height,
@@ -89,7 +153,7 @@ status_t ColorConverter::convert(
         size_t dstWidth, size_t dstHeight,
         size_t dstCropLeft, size_t dstCropTop,
         size_t dstCropRight, size_t dstCropBottom) {
-    if (mDstFormat != OMX_COLOR_Format16bitRGB565) {
+    if (!isValid()) {
         return ERROR_UNSUPPORTED;
     }
 
@@ -103,458 +167,282 @@ status_t ColorConverter::convert(
             dstWidth, dstHeight,
             dstCropLeft, dstCropTop, dstCropRight, dstCropBottom);
 
-    status_t err;
-
-    switch (mSrcFormat) {
-        case OMX_COLOR_FormatYUV420Planar:
-#ifdef USE_LIBYUV
-            err = convertYUV420PlanarUseLibYUV(src, dst);
-#else
-            err = convertYUV420Planar(src, dst);
-#endif
-            break;
-
-        case OMX_COLOR_FormatCbYCrY:
-            err = convertCbYCrY(src, dst);
-            break;
-
-        case OMX_QCOM_COLOR_FormatYVU420SemiPlanar:
-            err = convertQCOMYUV420SemiPlanar(src, dst);
-            break;
-
-        case OMX_COLOR_FormatYUV420SemiPlanar:
-            err = convertYUV420SemiPlanar(src, dst);
-            break;
-
-        case OMX_TI_COLOR_FormatYUV420PackedSemiPlanar:
-            err = convertTIYUV420PackedSemiPlanar(src, dst);
-            break;
-
-        default:
-        {
-            CHECK(!"Should not be here. Unknown color conversion.");
-            break;
-        }
-    }
-
-    return err;
-}
-
-status_t ColorConverter::convertCbYCrY(
-        const BitmapParams &src, const BitmapParams &dst) {
-    // XXX Untested
-
-    uint8_t *kAdjustedClip = initClip();
-
-    if (!((src.mCropLeft & 1) == 0
-        && src.cropWidth() == dst.cropWidth()
-        && src.cropHeight() == dst.cropHeight())) {
-        return ERROR_UNSUPPORTED;
-    }
-
-    uint16_t *dst_ptr = (uint16_t *)dst.mBits
-        + dst.mCropTop * dst.mWidth + dst.mCropLeft;
-
-    const uint8_t *src_ptr = (const uint8_t *)src.mBits
-        + (src.mCropTop * dst.mWidth + src.mCropLeft) * 2;
-
-    for (size_t y = 0; y < src.cropHeight(); ++y) {
-        for (size_t x = 0; x < src.cropWidth(); x += 2) {
-            signed y1 = (signed)src_ptr[2 * x + 1] - 16;
-            signed y2 = (signed)src_ptr[2 * x + 3] - 16;
-            signed u = (signed)src_ptr[2 * x] - 128;
-            signed v = (signed)src_ptr[2 * x + 2] - 128;
-
-            signed u_b = u * 517;
-            signed u_g = -u * 100;
-            signed v_g = -v * 208;
-            signed v_r = v * 409;
-
-            signed tmp1 = y1 * 298;
-            signed b1 = (tmp1 + u_b) / 256;
-            signed g1 = (tmp1 + v_g + u_g) / 256;
-            signed r1 = (tmp1 + v_r) / 256;
-
-            signed tmp2 = y2 * 298;
-            signed b2 = (tmp2 + u_b) / 256;
-            signed g2 = (tmp2 + v_g + u_g) / 256;
-            signed r2 = (tmp2 + v_r) / 256;
-
-            uint32_t rgb1 =
-                ((kAdjustedClip[r1] >> 3) << 11)
-                | ((kAdjustedClip[g1] >> 2) << 5)
-                | (kAdjustedClip[b1] >> 3);
-
-            uint32_t rgb2 =
-                ((kAdjustedClip[r2] >> 3) << 11)
-                | ((kAdjustedClip[g2] >> 2) << 5)
-                | (kAdjustedClip[b2] >> 3);
-
-            if (x + 1 < src.cropWidth()) {
-                *(uint32_t *)(&dst_ptr[x]) = (rgb2 << 16) | rgb1;
-            } else {
-                dst_ptr[x] = rgb1;
-            }
-        }
-
-        src_ptr += src.mWidth * 2;
-        dst_ptr += dst.mWidth;
-    }
-
-    return OK;
-}
-
-status_t ColorConverter::convertYUV420PlanarUseLibYUV(
-        const BitmapParams &src, const BitmapParams &dst) {
     if (!((src.mCropLeft & 1) == 0
             && src.cropWidth() == dst.cropWidth()
             && src.cropHeight() == dst.cropHeight())) {
         return ERROR_UNSUPPORTED;
     }
 
-    uint16_t *dst_ptr = (uint16_t *)dst.mBits
-        + dst.mCropTop * dst.mWidth + dst.mCropLeft;
-
-    const uint8_t *src_y =
-        (const uint8_t *)src.mBits + src.mCropTop * src.mWidth + src.mCropLeft;
-
-    const uint8_t *src_u =
-        (const uint8_t *)src_y + src.mWidth * src.mHeight
-        + src.mCropTop * (src.mWidth / 2) + src.mCropLeft / 2;
+    YUVPlanes planes;
+    status_t err = getPlanes(src, &planes);
+    if (err != OK) {
+        return err;
+    }
 
-    const uint8_t *src_v =
-        src_u + (src.mWidth / 2) * (src.mHeight / 2);
+    size_t bytesPerPixel = (mDstFormat == OMX_COLOR_Format16bitRGB565) ? 2 : 4;
+    uint8_t *dst_ptr = (uint8_t *)dst.mBits
+        + (dst.mCropTop * dst.mWidth + dst.mCropLeft) * bytesPerPixel;
+    size_t dstStride = dst.mWidth * bytesPerPixel;
 
+#ifdef USE_LIBYUV
+    if (convertUseLibYUV(planes, src.cropWidth(), src.cropHeight(), dst_ptr, dstStride) == OK) {
+        return OK;
+    }
+#endif
 
-    libyuv::I420ToRGB565(src_y, src.mWidth, src_u, src.mWidth / 2, src_v, src.mWidth / 2,
-            (uint8 *)dst_ptr, dst.mWidth * 2, dst.mWidth, dst.mHeight);
+    convertYUVToRGB(planes, src.cropWidth(), src.cropHeight(), dst_ptr, dstStride);
 
     return OK;
 }
 
-status_t ColorConverter::convertYUV420Planar(
-        const BitmapParams &src, const BitmapParams &dst) {
-    if (!((src.mCropLeft & 1) == 0
-            && src.cropWidth() == dst.cropWidth()
-            && src.cropHeight() == dst.cropHeight())) {
-        return ERROR_UNSUPPORTED;
-    }
-
-    uint8_t *kAdjustedClip = initClip();
-
-    uint16_t *dst_ptr = (uint16_t *)dst.mBits
-        + dst.mCropTop * dst.mWidth + dst.mCropLeft;
-
-    const uint8_t *src_y =
-        (const uint8_t *)src.mBits + src.mCropTop * src.mWidth + src.mCropLeft;
-
-    const uint8_t *src_u =
-        (const uint8_t *)src_y + src.mWidth * src.mHeight
-        + src.mCropTop * (src.mWidth / 2) + src.mCropLeft / 2;
-
-    const uint8_t *src_v =
-        src_u + (src.mWidth / 2) * (src.mHeight / 2);
-
-    for (size_t y = 0; y < src.cropHeight(); ++y) {
-        for (size_t x = 0; x < src.cropWidth(); x += 2) {
-            // B = 1.164 * (Y - 16) + 2.018 * (U - 128)
-            // G = 1.164 * (Y - 16) - 0.813 * (V - 128) - 0.391 * (U - 128)
-            // R = 1.164 * (Y - 16) + 1.596 * (V - 128)
-
-            // B = 298/256 * (Y - 16) + 517/256 * (U - 128)
-            // G = .................. - 208/256 * (V - 128) - 100/256 * (U - 128)
-            // R = .................. + 409/256 * (V - 128)
-
-            // min_B = (298 * (- 16) + 517 * (- 128)) / 256 = -277
-            // min_G = (298 * (- 16) - 208 * (255 - 128) - 100 * (255 - 128)) / 256 = -172
-            // min_R = (298 * (- 16) + 409 * (- 128)) / 256 = -223
+status_t ColorConverter::getPlanes(const BitmapParams &src, YUVPlanes *planes) const {
+    const uint8_t *bits = (const uint8_t *)src.mBits;
 
-            // max_B = (298 * (255 - 16) + 517 * (255 - 128)) / 256 = 534
-            // max_G = (298 * (255 - 16) - 208 * (- 128) - 100 * (- 128)) / 256 = 432
-            // max_R = (298 * (255 - 16) + 409 * (255 - 128)) / 256 = 481
+    planes->mYStride = src.mWidth;
+    planes->mYStep = 1;
+    planes->mChromaSubsampledV = true;
+    planes->mChromaPhase = src.mCropTop & 1;
 
-            // clip range -278 .. 535
-
-            signed y1 = (signed)src_y[x] - 16;
-            signed y2 = (signed)src_y[x + 1] - 16;
-
-            signed u = (signed)src_u[x / 2] - 128;
-            signed v = (signed)src_v[x / 2] - 128;
-
-            signed u_b = u * 517;
-            signed u_g = -u * 100;
-            signed v_g = -v * 208;
-            signed v_r = v * 409;
-
-            signed tmp1 = y1 * 298;
-            signed b1 = (tmp1 + u_b) / 256;
-            signed g1 = (tmp1 + v_g + u_g) / 256;
-            signed r1 = (tmp1 + v_r) / 256;
-
-            signed tmp2 = y2 * 298;
-            signed b2 = (tmp2 + u_b) / 256;
-            signed g2 = (tmp2 + v_g + u_g) / 256;
-            signed r2 = (tmp2 + v_r) / 256;
-
-            uint32_t rgb1 =
-                ((kAdjustedClip[r1] >> 3) << 11)
-                | ((kAdjustedClip[g1] >> 2) << 5)
-                | (kAdjustedClip[b1] >> 3);
+    switch (mSrcFormat) {
+        case OMX_COLOR_FormatYUV420Planar:
+        {
+            planes->mY = bits + src.mCropTop * src.mWidth + src.mCropLeft;
+            planes->mU = bits + src.mWidth * src.mHeight
+                + (src.mCropTop / 2) * (src.mWidth / 2) + src.mCropLeft / 2;
+            planes->mV = planes->mU + (src.mWidth / 2) * (src.mHeight / 2);
+            planes->mUVStride = src.mWidth / 2;
+            planes->mUVStep = 1;
+            break;
+        }
 
-            uint32_t rgb2 =
-                ((kAdjustedClip[r2] >> 3) << 11)
-                | ((kAdjustedClip[g2] >> 2) << 5)
-                | (kAdjustedClip[b2] >> 3);
+        case OMX_COLOR_FormatYUV420SemiPlanar:
+        case OMX_QCOM_COLOR_FormatYVU420SemiPlanar:
+        {
+            planes->mY = bits + src.mCropTop * src.mWidth + src.mCropLeft;
 
-            if (x + 1 < src.cropWidth()) {
-                *(uint32_t *)(&dst_ptr[x]) = (rgb2 << 16) | rgb1;
+            const uint8_t *src_uv = bits + src.mWidth * src.mHeight
+                + (src.mCropTop / 2) * src.mWidth + src.mCropLeft;
+            if (mSrcFormat == OMX_COLOR_FormatYUV420SemiPlanar) {
+                planes->mU = src_uv;
+                planes->mV = src_uv + 1;
             } else {
-                dst_ptr[x] = rgb1;
+                planes->mV = src_uv;
+                planes->mU = src_uv + 1;
             }
+            planes->mUVStride = src.mWidth;
+            planes->mUVStep = 2;
+            break;
         }
 
-        src_y += src.mWidth;
+        case OMX_TI_COLOR_FormatYUV420PackedSemiPlanar:
+        {
+            // the buffer starts at the top of the crop rectangle
+            planes->mY = bits;
+            planes->mU = bits + src.mWidth * (src.mHeight - src.mCropTop / 2);
+            planes->mV = planes->mU + 1;
+            planes->mUVStride = src.mWidth;
+            planes->mUVStep = 2;
+            planes->mChromaPhase = 0;
+            break;
+        }
 
-        if (y & 1) {
-            src_u += src.mWidth / 2;
-            src_v += src.mWidth / 2;
+        case OMX_COLOR_FormatCbYCrY:
+        {
+            const uint8_t *src_uyvy = bits + (src.mCropTop * src.mWidth + src.mCropLeft) * 2;
+            planes->mU = src_uyvy;
+            planes->mY = src_uyvy + 1;
+            planes->mV = src_uyvy + 2;
+            planes->mYStride = src.mWidth * 2;
+            planes->mUVStride = src.mWidth * 2;
+            planes->mYStep = 2;
+            planes->mUVStep = 4;
+            planes->mChromaSubsampledV = false;
+            planes->mChromaPhase = 0;
+            break;
         }
 
-        dst_ptr += dst.mWidth;
+        default:
+            return ERROR_UNSUPPORTED;
     }
 
     return OK;
 }
 
-status_t ColorConverter::convertQCOMYUV420SemiPlanar(
-        const BitmapParams &src, const BitmapParams &dst) {
-    uint8_t *kAdjustedClip = initClip();
-
-    if (!((src.mCropLeft & 1) == 0
-            && src.cropWidth() == dst.cropWidth()
-            && src.cropHeight() == dst.cropHeight())) {
+status_t ColorConverter::convertUseLibYUV(
+        const YUVPlanes &planes, size_t width, size_t height,
+        uint8_t *dst, size_t dstStride) {
+    // libyuv converts with the BT.601 limited range matrix, and takes chroma
+    // rows from the first row on.
+    if (!isBT601LimitedRange() || planes.mChromaPhase != 0) {
         return ERROR_UNSUPPORTED;
     }
 
-    uint16_t *dst_ptr = (uint16_t *)dst.mBits
-        + dst.mCropTop * dst.mWidth + dst.mCropLeft;
-
-    const uint8_t *src_y =
-        (const uint8_t *)src.mBits + src.mCropTop * src.mWidth + src.mCropLeft;
-
-    const uint8_t *src_u =
-        (const uint8_t *)src_y + src.mWidth * src.mHeight
-        + src.mCropTop * src.mWidth + src.mCropLeft;
-
-    for (size_t y = 0; y < src.cropHeight(); ++y) {
-        for (size_t x = 0; x < src.cropWidth(); x += 2) {
-            signed y1 = (signed)src_y[x] - 16;
-            signed y2 = (signed)src_y[x + 1] - 16;
-
-            signed u = (signed)src_u[x & ~1] - 128;
-            signed v = (signed)src_u[(x & ~1) + 1] - 128;
-
-            signed u_b = u * 517;
-            signed u_g = -u * 100;
-            signed v_g = -v * 208;
-            signed v_r = v * 409;
-
-            signed tmp1 = y1 * 298;
-            signed b1 = (tmp1 + u_b) / 256;
-            signed g1 = (tmp1 + v_g + u_g) / 256;
-            signed r1 = (tmp1 + v_r) / 256;
-
-            signed tmp2 = y2 * 298;
-            signed b2 = (tmp2 + u_b) / 256;
-            signed g2 = (tmp2 + v_g + u_g) / 256;
-            signed r2 = (tmp2 + v_r) / 256;
+    bool toRGB565 = (mDstFormat == OMX_COLOR_Format16bitRGB565);
 
-            uint32_t rgb1 =
-                ((kAdjustedClip[b1] >> 3) << 11)
-                | ((kAdjustedClip[g1] >> 2) << 5)
-                | (kAdjustedClip[r1] >> 3);
-
-            uint32_t rgb2 =
-                ((kAdjustedClip[b2] >> 3) << 11)
-                | ((kAdjustedClip[g2] >> 2) << 5)
-                | (kAdjustedClip[r2] >> 3);
-
-            if (x + 1 < src.cropWidth()) {
-                *(uint32_t *)(&dst_ptr[x]) = (rgb2 << 16) | rgb1;
+    switch (mSrcFormat) {
+        case OMX_COLOR_FormatYUV420Planar:
+        {
+            if (toRGB565) {
+                libyuv::I420ToRGB565(
+                        planes.mY, planes.mYStride,
+                        planes.mU, planes.mUVStride, planes.mV, planes.mUVStride,
+                        (uint8 *)dst, dstStride, width, height);
             } else {
-                dst_ptr[x] = rgb1;
+                // libyuv names formats by the order of a little endian word
+                libyuv::I420ToABGR(
+                        planes.mY, planes.mYStride,
+                        planes.mU, planes.mUVStride, planes.mV, planes.mUVStride,
+                        (uint8 *)dst, dstStride, width, height);
             }
+            return OK;
         }
 
-        src_y += src.mWidth;
-
-        if (y & 1) {
-            src_u += src.mWidth;
+        case OMX_COLOR_FormatYUV420SemiPlanar:
+        case OMX_TI_COLOR_FormatYUV420PackedSemiPlanar:
+        {
+            if (toRGB565) {
+                libyuv::NV12ToRGB565(
+                        planes.mY, planes.mYStride, planes.mU, planes.mUVStride,
+                        (uint8 *)dst, dstStride, width, height);
+            } else {
+                libyuv::NV12ToARGB(
+                        planes.mY, planes.mYStride, planes.mU, planes.mUVStride,
+                        (uint8 *)dst, dstStride, width, height);
+                libyuv::ARGBToABGR(
+                        (const uint8 *)dst, dstStride, (uint8 *)dst, dstStride, width, height);
+            }
+            return OK;
         }
 
-        dst_ptr += dst.mWidth;
-    }
-
-    return OK;
-}
-
-status_t ColorConverter::convertYUV420SemiPlanar(
-        const BitmapParams &src, const BitmapParams &dst) {
-    // XXX Untested
-
-    uint8_t *kAdjustedClip = initClip();
-
-    if (!((src.mCropLeft & 1) == 0
-            && src.cropWidth() == dst.cropWidth()
-            && src.cropHeight() == dst.cropHeight())) {
-        return ERROR_UNSUPPORTED;
-    }
-
-    uint16_t *dst_ptr = (uint16_t *)dst.mBits
-        + dst.mCropTop * dst.mWidth + dst.mCropLeft;
-
-    const uint8_t *src_y =
-        (const uint8_t *)src.mBits + src.mCropTop * src.mWidth + src.mCropLeft;
-
-    const uint8_t *src_u =
-        (const uint8_t *)src_y + src.mWidth * src.mHeight
-        + src.mCropTop * src.mWidth + src.mCropLeft;
-
-    for (size_t y = 0; y < src.cropHeight(); ++y) {
-        for (size_t x = 0; x < src.cropWidth(); x += 2) {
-            signed y1 = (signed)src_y[x] - 16;
-            signed y2 = (signed)src_y[x + 1] - 16;
-
-            signed v = (signed)src_u[x & ~1] - 128;
-            signed u = (signed)src_u[(x & ~1) + 1] - 128;
-
-            signed u_b = u * 517;
-            signed u_g = -u * 100;
-            signed v_g = -v * 208;
-            signed v_r = v * 409;
-
-            signed tmp1 = y1 * 298;
-            signed b1 = (tmp1 + u_b) / 256;
-            signed g1 = (tmp1 + v_g + u_g) / 256;
-            signed r1 = (tmp1 + v_r) / 256;
-
-            signed tmp2 = y2 * 298;
-            signed b2 = (tmp2 + u_b) / 256;
-            signed g2 = (tmp2 + v_g + u_g) / 256;
-            signed r2 = (tmp2 + v_r) / 256;
-
-            uint32_t rgb1 =
-                ((kAdjustedClip[b1] >> 3) << 11)
-                | ((kAdjustedClip[g1] >> 2) << 5)
-                | (kAdjustedClip[r1] >> 3);
-
-            uint32_t rgb2 =
-                ((kAdjustedClip[b2] >> 3) << 11)
-                | ((kAdjustedClip[g2] >> 2) << 5)
-                | (kAdjustedClip[r2] >> 3);
-
-            if (x + 1 < src.cropWidth()) {
-                *(uint32_t *)(&dst_ptr[x]) = (rgb2 << 16) | rgb1;
+        case OMX_QCOM_COLOR_FormatYVU420SemiPlanar:
+        {
+            if (toRGB565) {
+                libyuv::NV21ToRGB565(
+                        planes.mY, planes.mYStride, planes.mV, planes.mUVStride,
+                        (uint8 *)dst, dstStride, width, height);
             } else {
-                dst_ptr[x] = rgb1;
+                libyuv::NV21ToARGB(
+                        planes.mY, planes.mYStride, planes.mV, planes.mUVStride,
+                        (uint8 *)dst, dstStride, width, height);
+                libyuv::ARGBToABGR(
+                        (const uint8 *)dst, dstStride, (uint8 *)dst, dstStride, width, height);
             }
+            return OK;
         }
 
-        src_y += src.mWidth;
-
-        if (y & 1) {
-            src_u += src.mWidth;
+        case OMX_COLOR_FormatCbYCrY:
+        {
+            // there is no direct conversion to RGB565
+            if (toRGB565) {
+                return ERROR_UNSUPPORTED;
+            }
+            libyuv::UYVYToARGB(
+                    planes.mU, planes.mYStride, (uint8 *)dst, dstStride, width, height);
+            libyuv::ARGBToABGR(
+                    (const uint8 *)dst, dstStride, (uint8 *)dst, dstStride, width, height);
+            return OK;
         }
 
-        dst_ptr += dst.mWidth;
+        default:
+            return ERROR_UNSUPPORTED;
     }
+}
 
-    return OK;
+static inline uint32_t clamp8(int32_t x) {
+    return x < 0 ? 0 : (x > 255 ? 255 : x);
 }
 
-status_t ColorConverter::convertTIYUV420PackedSemiPlanar(
-        const BitmapParams &src, const BitmapParams &dst) {
-    uint8_t *kAdjustedClip = initClip();
+struct RGB565Pixel {
+    typedef uint16_t type;
 
-    if (!((src.mCropLeft & 1) == 0
-            && src.cropWidth() == dst.cropWidth()
-            && src.cropHeight() == dst.cropHeight())) {
-        return ERROR_UNSUPPORTED;
+    static inline uint16_t pack(int32_t luma, int32_t r, int32_t g, int32_t b) {
+        return ((clamp8((luma + r) >> 16) >> 3) << 11)
+            | ((clamp8((luma + g) >> 16) >> 2) << 5)
+            | (clamp8((luma + b) >> 16) >> 3);
     }
+};
 
-    uint16_t *dst_ptr = (uint16_t *)dst.mBits
-        + dst.mCropTop * dst.mWidth + dst.mCropLeft;
-
-    const uint8_t *src_y = (const uint8_t *)src.mBits;
-
-    const uint8_t *src_u =
-        (const uint8_t *)src_y + src.mWidth * (src.mHeight - src.mCropTop / 2);
-
-    for (size_t y = 0; y < src.cropHeight(); ++y) {
-        for (size_t x = 0; x < src.cropWidth(); x += 2) {
-            signed y1 = (signed)src_y[x] - 16;
-            signed y2 = (signed)src_y[x + 1] - 16;
-
-            signed u = (signed)src_u[x & ~1] - 128;
-            signed v = (signed)src_u[(x & ~1) + 1] - 128;
-
-            signed u_b = u * 517;
-            signed u_g = -u * 100;
-            signed v_g = -v * 208;
-            signed v_r = v * 409;
+struct RGBA8888Pixel {
+    typedef uint32_t type;
 
-            signed tmp1 = y1 * 298;
-            signed b1 = (tmp1 + u_b) / 256;
-            signed g1 = (tmp1 + v_g + u_g) / 256;
-            signed r1 = (tmp1 + v_r) / 256;
-
-            signed tmp2 = y2 * 298;
-            signed b2 = (tmp2 + u_b) / 256;
-            signed g2 = (tmp2 + v_g + u_g) / 256;
-            signed r2 = (tmp2 + v_r) / 256;
-
-            uint32_t rgb1 =
-                ((kAdjustedClip[r1] >> 3) << 11)
-                | ((kAdjustedClip[g1] >> 2) << 5)
-                | (kAdjustedClip[b1] >> 3);
-
-            uint32_t rgb2 =
-                ((kAdjustedClip[r2] >> 3) << 11)
-                | ((kAdjustedClip[g2] >> 2) << 5)
-                | (kAdjustedClip[b2] >> 3);
-
-            if (x + 1 < src.cropWidth()) {
-                *(uint32_t *)(&dst_ptr[x]) = (rgb2 << 16) | rgb1;
-            } else {
-                dst_ptr[x] = rgb1;
-            }
+    // R, G, B, A in memory, on a little endian cpu
+    static inline uint32_t pack(int32_t luma, int32_t r, int32_t g, int32_t b) {
+        return clamp8((luma + r) >> 16)
+            | (clamp8((luma + g) >> 16) << 8)
+            | (clamp8((luma + b) >> 16) << 16)
+            | 0xff000000;
+    }
+};
+
+// Converts a row of |width| pixels. The conversion is done in integers without
+// table lookups, and the steps between samples are constants, so that the
+// compiler vectorizes the loop.
+template <class Pixel, size_t kYStep, size_t kUVStep>
+static void convertRow(
+        const ColorConverter::Coeffs &coeffs,
+        const uint8_t *src_y, const uint8_t *src_u, const uint8_t *src_v,
+        size_t width, typename Pixel::type *dst_ptr) {
+    const int32_t cY = coeffs.mY;
+    const int32_t cRV = coeffs.mRV;
+    const int32_t cGU = coeffs.mGU;
+    const int32_t cGV = coeffs.mGV;
+    const int32_t cBU = coeffs.mBU;
+    const int32_t yOffset = coeffs.mYOffset;
+
+    // two pixels share a chroma sample
+    size_t numPairs = (width + 1) / 2;
+    size_t numFullPairs = width / 2;
+
+    for (size_t x = 0; x < numPairs; ++x) {
+        int32_t u = (int32_t)src_u[x * kUVStep] - 128;
+        int32_t v = (int32_t)src_v[x * kUVStep] - 128;
+
+        int32_t r = cRV * v;
+        int32_t g = -cGU * u - cGV * v;
+        int32_t b = cBU * u;
+
+        int32_t luma1 = cY * ((int32_t)src_y[2 * x * kYStep] - yOffset) + 32768;
+        dst_ptr[2 * x] = Pixel::pack(luma1, r, g, b);
+
+        if (x < numFullPairs) {
+            int32_t luma2 = cY * ((int32_t)src_y[(2 * x + 1) * kYStep] - yOffset) + 32768;
+            dst_ptr[2 * x + 1] = Pixel::pack(luma2, r, g, b);
         }
+    }
+}
 
-        src_y += src.mWidth;
-
-        if (y & 1) {
-            src_u += src.mWidth;
+template <class Pixel>
+static void convertRows(
+        const ColorConverter::Coeffs &coeffs, const ColorConverter::YUVPlanes &planes,
+        size_t width, size_t height, uint8_t *dst, size_t dstStride) {
+    for (size_t y = 0; y < height; ++y) {
+        size_t uvRow = planes.mChromaSubsampledV ? (y + planes.mChromaPhase) / 2 : y;
+
+        const uint8_t *src_y = planes.mY + y * planes.mYStride;
+        const uint8_t *src_u = planes.mU + uvRow * planes.mUVStride;
+        const uint8_t *src_v = planes.mV + uvRow * planes.mUVStride;
+        typename Pixel::type *dst_ptr = (typename Pixel::type *)dst;
+
+        if (planes.mYStep == 2) {
+            convertRow<Pixel, 2, 4>(coeffs, src_y, src_u, src_v, width, dst_ptr);
+        } else if (planes.mUVStep == 2) {
+            convertRow<Pixel, 1, 2>(coeffs, src_y, src_u, src_v, width, dst_ptr);
+        } else {
+            convertRow<Pixel, 1, 1>(coeffs, src_y, src_u, src_v, width, dst_ptr);
         }
 
-        dst_ptr += dst.mWidth;
+        dst += dstStride;
     }
-
-    return OK;
 }
 
-uint8_t *ColorConverter::initClip() {
-    static const signed kClipMin = -278;
-    static const signed kClipMax = 535;
-
-    if (mClip == NULL) {
-        mClip = new uint8_t[kClipMax - kClipMin + 1];
-
-        for (signed i = kClipMin; i <= kClipMax; ++i) {
-            mClip[i - kClipMin] = (i < 0) ? 0 : (i > 255) ? 255 : (uint8_t)i;
-        }
+void ColorConverter::convertYUVToRGB(
+        const YUVPlanes &planes, size_t width, size_t height,
+        uint8_t *dst, size_t dstStride) {
+    if (mDstFormat == OMX_COLOR_Format16bitRGB565) {
+        convertRows<RGB565Pixel>(mCoeffs, planes, width, height, dst, dstStride);
+    } else {
+        convertRows<RGBA8888Pixel>(mCoeffs, planes, width, height, dst, dstStride);
     }
-
-    return &mClip[-kClipMin];
 }
 
 }  // namespace android
@@ -22,9 +22,13 @@
 #include <cutils/properties.h> // for property_get
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/foundation/AMessage.h>
+#include <media/stagefright/foundation/ColorUtils.h>
 #include <system/window.h>
 #include <ui/GraphicBufferMapper.h>
 #include <gui/IGraphicBufferProducer.h>
+#include <utils/Thread.h>
+
+#include <unistd.h>
 
 namespace android {
 
@@ -38,6 +42,167 @@ static int ALIGN(int x, int y) {
     return (x + y - 1) & ~(y - 1);
 }
 
+// A part of the conversion of a frame, run on rows [top, bottom).
+struct SoftwareRenderer::BandJob {
+    virtual ~BandJob() {}
+    virtual void run(size_t top, size_t bottom) = 0;
+};
+
+// Converts the rows of a frame with ColorConverter.
+struct SoftwareRenderer::ConvertJob : public BandJob {
+    ConvertJob(ColorConverter *converter, const void *data,
+            size_t width, size_t height,
+            size_t cropLeft, size_t cropTop, size_t cropRight,
+            void *dst, size_t dstWidth, size_t dstHeight)
+        : mConverter(converter),
+          mData(data),
+          mWidth(width),
+          mHeight(height),
+          mCropLeft(cropLeft),
+          mCropTop(cropTop),
+          mCropRight(cropRight),
+          mDst(dst),
+          mDstWidth(dstWidth),
+          mDstHeight(dstHeight) {
+    }
+
+    virtual void run(size_t top, size_t bottom) {
+        mConverter->convert(
+                mData,
+                mWidth, mHeight,
+                mCropLeft, mCropTop + top, mCropRight, mCropTop + bottom - 1,
+                mDst,
+                mDstWidth, mDstHeight,
+                0, top, mCropRight - mCropLeft, bottom - 1);
+    }
+
+private:
+    ColorConverter *mConverter;
+    const void *mData;
+    size_t mWidth, mHeight;
+    size_t mCropLeft, mCropTop, mCropRight;
+    void *mDst;
+    size_t mDstWidth, mDstHeight;
+
+    DISALLOW_EVIL_CONSTRUCTORS(ConvertJob);
+};
+
+// Copies the rows of a planar or semi-planar frame to a YV12 buffer. The band
+// of rows [top, bottom) copies the chroma rows [top / 2, (bottom + 1) / 2).
+struct SoftwareRenderer::YV12CopyJob : public BandJob {
+    YV12CopyJob() {}
+
+    virtual void run(size_t top, size_t bottom) {
+        for (size_t y = top; y < bottom; ++y) {
+            memcpy(mDstY + y * mDstYStride, mSrcY + y * mSrcYStride, mWidth);
+        }
+
+        size_t uvWidth = (mWidth + 1) / 2;
+        for (size_t y = top / 2; y < (bottom + 1) / 2; ++y) {
+            const uint8_t *src_u = mSrcU + y * mSrcUVStride;
+            const uint8_t *src_v = mSrcV + y * mSrcUVStride;
+            uint8_t *dst_u = mDstU + y * mDstUVStride;
+            uint8_t *dst_v = mDstV + y * mDstUVStride;
+
+            if (mSrcUVStep == 1) {
+                memcpy(dst_u, src_u, uvWidth);
+                memcpy(dst_v, src_v, uvWidth);
+            } else {
+                for (size_t x = 0; x < uvWidth; ++x) {
+                    dst_u[x] = src_u[2 * x];
+                    dst_v[x] = src_v[2 * x];
+                }
+            }
+        }
+    }
+
+    const uint8_t *mSrcY, *mSrcU, *mSrcV;
+    size_t mSrcYStride, mSrcUVStride;
+    size_t mSrcUVStep;      // 2 if the chroma samples are interleaved
+    uint8_t *mDstY, *mDstU, *mDstV;
+    size_t mDstYStride, mDstUVStride;
+    size_t mWidth;
+
+private:
+    DISALLOW_EVIL_CONSTRUCTORS(YV12CopyJob);
+};
+
+// Runs one band of a job at a time on a thread of its own.
+struct SoftwareRenderer::BandWorker : public Thread {
+    BandWorker()
+        : Thread(false /* canCallJava */),
+          mQueued(false),
+          mStopping(false),
+          mJob(NULL),
+          mTop(0),
+          mBottom(0) {
+    }
+
+    void submit(BandJob *job, size_t top, size_t bottom) {
+        Mutex::Autolock autoLock(mLock);
+        CHECK(!mQueued);
+
+        mJob = job;
+        mTop = top;
+        mBottom = bottom;
+        mQueued = true;
+        mCondition.broadcast();
+    }
+
+    // Waits for the submitted band to be done.
+    void wait() {
+        Mutex::Autolock autoLock(mLock);
+        while (mQueued) {
+            mCondition.wait(mLock);
+        }
+        mJob = NULL;
+    }
+
+    void stop() {
+        {
+            Mutex::Autolock autoLock(mLock);
+            mStopping = true;
+            mCondition.broadcast();
+        }
+        requestExitAndWait();
+    }
+
+protected:
+    virtual ~BandWorker() {}
+
+private:
+    Mutex mLock;
+    Condition mCondition;
+    bool mQueued;
+    bool mStopping;
+    BandJob *mJob;
+    size_t mTop, mBottom;
+
+    virtual bool threadLoop() {
+        Mutex::Autolock autoLock(mLock);
+        while (!mQueued && !mStopping) {
+            mCondition.wait(mLock);
+        }
+        if (mStopping) {
+            return false;
+        }
+
+        BandJob *job = mJob;
+        size_t top = mTop;
+        size_t bottom = mBottom;
+
+        mLock.unlock();
+        job->run(top, bottom);
+        mLock.lock();
+
+        mQueued = false;
+        mCondition.broadcast();
+        return true;
+    }
+
+    DISALLOW_EVIL_CONSTRUCTORS(BandWorker);
+};
+
 SoftwareRenderer::SoftwareRenderer(
         const sp<ANativeWindow> &nativeWindow, int32_t rotation)
     : mColorFormat(OMX_COLOR_FormatUnused),
@@ -56,10 +221,59 @@ SoftwareRenderer::SoftwareRenderer(
 }
 
 SoftwareRenderer::~SoftwareRenderer() {
+    for (size_t i = 0; i < mBandWorkers.size(); ++i) {
+        mBandWorkers[i]->stop();
+    }
+    mBandWorkers.clear();
+
     delete mConverter;
     mConverter = NULL;
 }
 
+void SoftwareRenderer::startBandWorkers() {
+    long onlineCores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (onlineCores < 2) {
+        return;
+    }
+
+    // the rendering thread converts a band as well
+    size_t numWorkers = (onlineCores < kMaxNumBands ? onlineCores : kMaxNumBands) - 1;
+    for (size_t i = 0; i < numWorkers; ++i) {
+        sp<BandWorker> worker = new BandWorker;
+        if (worker->run("SoftwareRendererBand") != OK) {
+            ALOGW("cannot start band worker %zu", i);
+            break;
+        }
+        mBandWorkers.push(worker);
+    }
+    ALOGV("converting in %zu bands", mBandWorkers.size() + 1);
+}
+
+void SoftwareRenderer::runInBands(BandJob *job, size_t numRows, bool split) {
+    if (!split || mBandWorkers.isEmpty()
+            || (size_t)mCropWidth * mCropHeight < kMinPixelsForBands) {
+        job->run(0, numRows);
+        return;
+    }
+
+    size_t numBands = mBandWorkers.size() + 1;
+    size_t bandHeight = ((numRows + numBands - 1) / numBands + 1) & ~1;
+
+    size_t top = 0;
+    size_t numSubmitted = 0;
+    while (numSubmitted < mBandWorkers.size() && top + bandHeight < numRows) {
+        mBandWorkers[numSubmitted]->submit(job, top, top + bandHeight);
+        top += bandHeight;
+        ++numSubmitted;
+    }
+
+    job->run(top, numRows);
+
+    for (size_t i = 0; i < numSubmitted; ++i) {
+        mBandWorkers[i]->wait();
+    }
+}
+
 void SoftwareRenderer::resetFormatIfChanged(const sp<AMessage> &format) {
     CHECK(format != NULL);
 
@@ -110,6 +324,7 @@ void SoftwareRenderer::resetFormatIfChanged(const sp<AMessage> &format) {
         switch (mColorFormat) {
             case OMX_COLOR_FormatYUV420Planar:
             case OMX_COLOR_FormatYUV420SemiPlanar:
+            case OMX_QCOM_COLOR_FormatYVU420SemiPlanar:
             case OMX_TI_COLOR_FormatYUV420PackedSemiPlanar:
             {
                 halFormat = HAL_PIXEL_FORMAT_YV12;
@@ -150,6 +365,10 @@ void SoftwareRenderer::resetFormatIfChanged(const sp<AMessage> &format) {
     CHECK(mCropHeight > 0);
     CHECK(mConverter == NULL || mConverter->isValid());
 
+    if (mBandWorkers.isEmpty() && (size_t)mCropWidth * mCropHeight >= kMinPixelsForBands) {
+        startBandWorkers();
+    }
+
 #ifdef EXYNOS4_ENHANCEMENTS
     CHECK_EQ(0,
             native_window_set_usage(
@@ -243,13 +462,19 @@ std::list<FrameRenderTracker::Info> SoftwareRenderer::render(
     // TODO move the other conversions also into ColorConverter, and
     // fix cropping issues (when mCropLeft/Top != 0 or mWidth != mCropWidth)
     if (mConverter) {
-        mConverter->convert(
-                data,
+        int32_t range, standard, transfer;
+        ColorUtils::getColorConfigFromFormat(format, &range, &standard, &transfer);
+        mConverter->setSrcColorSpace(standard, range);
+
+        ConvertJob job(
+                mConverter, data,
                 mWidth, mHeight,
-                mCropLeft, mCropTop, mCropRight, mCropBottom,
-                dst,
-                buf->stride, buf->height,
-                0, 0, mCropWidth - 1, mCropHeight - 1);
+                mCropLeft, mCropTop, mCropRight,
+                dst, buf->stride, buf->height);
+
+        // the TI format does not offset the luma plane by the crop
+        runInBands(&job, mCropHeight,
+                mColorFormat != OMX_TI_COLOR_FormatYUV420PackedSemiPlanar);
     } else if (mColorFormat == OMX_COLOR_FormatYUV420Planar) {
         if ((size_t)mWidth * mHeight * 3 / 2 > size) {
             goto skip_copying;
@@ -272,30 +497,33 @@ std::list<FrameRenderTracker::Info> SoftwareRenderer::render(
         uint8_t *dst_v = dst_y + dst_y_size;
         uint8_t *dst_u = dst_v + dst_c_size;
 
-        for (int y = 0; y < mCropHeight; ++y) {
-            memcpy(dst_y, src_y, mCropWidth);
-
-            src_y += mWidth;
-            dst_y += buf->stride;
-        }
-
-        for (int y = 0; y < (mCropHeight + 1) / 2; ++y) {
-            memcpy(dst_u, src_u, (mCropWidth + 1) / 2);
-            memcpy(dst_v, src_v, (mCropWidth + 1) / 2);
-
-            src_u += mWidth / 2;
-            src_v += mWidth / 2;
-            dst_u += dst_c_stride;
-            dst_v += dst_c_stride;
-        }
+        YV12CopyJob job;
+        job.mSrcY = src_y;
+        job.mSrcU = src_u;
+        job.mSrcV = src_v;
+        job.mSrcYStride = mWidth;
+        job.mSrcUVStride = mWidth / 2;
+        job.mSrcUVStep = 1;
+        job.mDstY = dst_y;
+        job.mDstU = dst_u;
+        job.mDstV = dst_v;
+        job.mDstYStride = buf->stride;
+        job.mDstUVStride = dst_c_stride;
+        job.mWidth = mCropWidth;
+
+        runInBands(&job, mCropHeight, true);
     } else if (mColorFormat == OMX_TI_COLOR_FormatYUV420PackedSemiPlanar
-            || mColorFormat == OMX_COLOR_FormatYUV420SemiPlanar) {
+            || mColorFormat == OMX_COLOR_FormatYUV420SemiPlanar
+            || mColorFormat == OMX_QCOM_COLOR_FormatYVU420SemiPlanar) {
         if ((size_t)mWidth * mHeight * 3 / 2 > size) {
             goto skip_copying;
         }
         const uint8_t *src_y = (const uint8_t *)data;
         const uint8_t *src_uv = (const uint8_t *)data
                 + mWidth * (mHeight - mCropTop / 2);
+        if (mColorFormat == OMX_QCOM_COLOR_FormatYVU420SemiPlanar) {
+            src_uv = (const uint8_t *)data + mWidth * mHeight;
+        }
 
 #ifdef EXYNOS4_ENHANCEMENTS
         void *pYUVBuf[3];
@@ -317,24 +545,27 @@ std::list<FrameRenderTracker::Info> SoftwareRenderer::render(
         uint8_t *dst_u = dst_v + dst_c_size;
 #endif
 
-        for (int y = 0; y < mCropHeight; ++y) {
-            memcpy(dst_y, src_y, mCropWidth);
-
-            src_y += mWidth;
-            dst_y += buf->stride;
-        }
-
-        for (int y = 0; y < (mCropHeight + 1) / 2; ++y) {
-            size_t tmp = (mCropWidth + 1) / 2;
-            for (size_t x = 0; x < tmp; ++x) {
-                dst_u[x] = src_uv[2 * x];
-                dst_v[x] = src_uv[2 * x + 1];
-            }
-
-            src_uv += mWidth;
-            dst_u += dst_c_stride;
-            dst_v += dst_c_stride;
+        YV12CopyJob job;
+        job.mSrcY = src_y;
+        if (mColorFormat == OMX_QCOM_COLOR_FormatYVU420SemiPlanar) {
+            // V first, the YV12 planes take it as is rather than converting to RGB
+            job.mSrcV = src_uv;
+            job.mSrcU = src_uv + 1;
+        } else {
+            job.mSrcU = src_uv;
+            job.mSrcV = src_uv + 1;
         }
+        job.mSrcYStride = mWidth;
+        job.mSrcUVStride = mWidth;
+        job.mSrcUVStep = 2;
+        job.mDstY = dst_y;
+        job.mDstU = dst_u;
+        job.mDstV = dst_v;
+        job.mDstYStride = buf->stride;
+        job.mDstUVStride = dst_c_stride;
+        job.mWidth = mCropWidth;
+
+        runInBands(&job, mCropHeight, true);
     } else if (mColorFormat == OMX_COLOR_Format24bitRGB888) {
         if ((size_t)mWidth * mHeight * 3 > size) {
             goto skip_copying;
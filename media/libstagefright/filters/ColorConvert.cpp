@@ -48,21 +48,19 @@ void YUVToRGB(
 void convertYUV420spToARGB(
         uint8_t *pY, uint8_t *pUV, int32_t width, int32_t height,
         uint8_t *dest) {
-    const int32_t bytes_per_pixel = 2;
-
     for (int32_t i = 0; i < height; i++) {
-        for (int32_t j = 0; j < width; j++) {
-            int32_t y = *(pY + i * width + j);
-            int32_t u = *(pUV + (i/2) * width + bytes_per_pixel * (j/2));
-            int32_t v = *(pUV + (i/2) * width + bytes_per_pixel * (j/2) + 1);
+        const uint8_t *rowY = pY + i * width;
+        const uint8_t *rowUV = pUV + (i / 2) * width;
 
+        for (int32_t j = 0; j < width; j++) {
             int32_t r, g, b;
-            YUVToRGB(y, u, v, &r, &g, &b);
+            YUVToRGB(rowY[j], rowUV[j & ~1], rowUV[(j & ~1) + 1], &r, &g, &b);
 
-            *dest++ = 0xFF;
-            *dest++ = r;
-            *dest++ = g;
-            *dest++ = b;
+            dest[0] = 0xFF;
+            dest[1] = r;
+            dest[2] = g;
+            dest[3] = b;
+            dest += 4;
         }
     }
 }
@@ -70,41 +68,36 @@ void convertYUV420spToARGB(
 void convertYUV420spToRGB888(
         uint8_t *pY, uint8_t *pUV, int32_t width, int32_t height,
         uint8_t *dest) {
-    const int32_t bytes_per_pixel = 2;
-
     for (int32_t i = 0; i < height; i++) {
-        for (int32_t j = 0; j < width; j++) {
-            int32_t y = *(pY + i * width + j);
-            int32_t u = *(pUV + (i/2) * width + bytes_per_pixel * (j/2));
-            int32_t v = *(pUV + (i/2) * width + bytes_per_pixel * (j/2) + 1);
+        const uint8_t *rowY = pY + i * width;
+        const uint8_t *rowUV = pUV + (i / 2) * width;
 
+        for (int32_t j = 0; j < width; j++) {
             int32_t r, g, b;
-            YUVToRGB(y, u, v, &r, &g, &b);
+            YUVToRGB(rowY[j], rowUV[j & ~1], rowUV[(j & ~1) + 1], &r, &g, &b);
 
-            *dest++ = r;
-            *dest++ = g;
-            *dest++ = b;
+            dest[0] = r;
+            dest[1] = g;
+            dest[2] = b;
+            dest += 3;
         }
     }
 }
 
-// HACK - not even slightly optimized
 // TODO: remove when RGBA support is added to SoftwareRenderer
 void convertRGBAToARGB(
         uint8_t *src, int32_t width, int32_t height, uint32_t stride,
         uint8_t *dest) {
     for (int32_t i = 0; i < height; ++i) {
+        const uint8_t *row = src + (size_t)i * stride * 4;
         for (int32_t j = 0; j < width; ++j) {
-            uint8_t r = *src++;
-            uint8_t g = *src++;
-            uint8_t b = *src++;
-            uint8_t a = *src++;
-            *dest++ = a;
-            *dest++ = r;
-            *dest++ = g;
-            *dest++ = b;
+            dest[0] = row[3];
+            dest[1] = row[0];
+            dest[2] = row[1];
+            dest[3] = row[2];
+            dest += 4;
+            row += 4;
         }
-        src += (stride - width) * 4;
     }
 }
 
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "FilterChain"
+
+#include <utils/Log.h>
+
+#include <media/stagefright/foundation/ABuffer.h>
+#include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/AMessage.h>
+#include <media/stagefright/foundation/AString.h>
+
+#include "FilterChain.h"
+
+namespace android {
+
+status_t FilterChain::start() {
+    mSaturationQ8 = (int32_t)(mSaturation * 256.f + (mSaturation < 0.f ? -0.5f : 0.5f));
+    return OK;
+}
+
+status_t FilterChain::setParameters(const sp<AMessage> &msg) {
+    sp<AMessage> params;
+    CHECK(msg->findMessage("params", &params));
+
+    float saturation;
+    if (params->findFloat("saturation", &saturation)) {
+        mSaturation = saturation;
+    }
+
+    AString filters;
+    if (params->findString("filters", &filters)) {
+        Vector<Stage> stages;
+        size_t start = 0;
+        while (start <= filters.size()) {
+            ssize_t end = filters.find(",", start);
+            if (end < 0) {
+                end = filters.size();
+            }
+
+            AString name(filters, start, end - start);
+            name.trim();
+            if (name == "saturation") {
+                stages.push(kStageSaturation);
+            } else if (name == "invert") {
+                stages.push(kStageInvert);
+            } else if (!name.empty()) {
+                ALOGE("Unrecognized filter in chain: %s", name.c_str());
+                return BAD_VALUE;
+            }
+            start = end + 1;
+        }
+        mStages = stages;
+    }
+
+    return OK;
+}
+
+status_t FilterChain::processBuffers(
+        const sp<ABuffer> &srcBuffer, const sp<ABuffer> &outBuffer) {
+    size_t size = srcBuffer->size();
+    if (size > outBuffer->capacity()) {
+        ALOGE("Output buffer too small: %zu < %zu", outBuffer->capacity(), size);
+        return BAD_VALUE;
+    }
+
+    const uint8_t *src = srcBuffer->data();
+    uint8_t *dst = outBuffer->data();
+    if (mStages.isEmpty()) {
+        memcpy(dst, src, size);
+        outBuffer->setRange(0, size);
+        return OK;
+    }
+
+    size_t numPixels = size / 4;
+    for (size_t offset = 0; offset < numPixels; offset += kBlockPixels) {
+        size_t n = numPixels - offset;
+        if (n > kBlockPixels) {
+            n = kBlockPixels;
+        }
+
+        // the first filter reads the source, the next ones work in place
+        const uint8_t *in = src + offset * 4;
+        uint8_t *out = dst + offset * 4;
+        for (size_t i = 0; i < mStages.size(); ++i) {
+            switch (mStages[i]) {
+                case kStageSaturation:
+                    ApplySaturation(in, out, n, mSaturationQ8);
+                    break;
+                case kStageInvert:
+                    ApplyInvert(in, out, n);
+                    break;
+            }
+            in = out;
+        }
+    }
+    outBuffer->setRange(0, size);
+
+    return OK;
+}
+
+static inline uint8_t Clamp(int32_t x) {
+    return x < 0 ? 0 : (x > 255 ? 255 : x);
+}
+
+// The loops below are written so that the compiler vectorizes them (four
+// interleaved channels map to NEON vld4/vst4).
+
+// static
+void FilterChain::ApplySaturation(
+        const uint8_t *src, uint8_t *dst, size_t numPixels, int32_t saturationQ8) {
+    // same as saturationARGB.rs, in Q8: mix(dot(rgb, 0.299, 0.587, 0.114), rgb, saturation)
+    for (size_t i = 0; i < numPixels; ++i) {
+        int32_t r = src[4 * i + 1];
+        int32_t g = src[4 * i + 2];
+        int32_t b = src[4 * i + 3];
+        int32_t mono = (77 * r + 150 * g + 29 * b + 128) >> 8;
+
+        dst[4 * i] = src[4 * i];
+        dst[4 * i + 1] = Clamp(mono + (((r - mono) * saturationQ8 + 128) >> 8));
+        dst[4 * i + 2] = Clamp(mono + (((g - mono) * saturationQ8 + 128) >> 8));
+        dst[4 * i + 3] = Clamp(mono + (((b - mono) * saturationQ8 + 128) >> 8));
+    }
+}
+
+// static
+void FilterChain::ApplyInvert(const uint8_t *src, uint8_t *dst, size_t numPixels) {
+    // like ZeroFilter, inverts all the channels
+    for (size_t i = 0; i < numPixels * 4; ++i) {
+        dst[i] = ~src[i];
+    }
+}
+
+}   // namespace android
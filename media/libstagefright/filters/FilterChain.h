@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FILTER_CHAIN_H_
+#define FILTER_CHAIN_H_
+
+#include <utils/Vector.h>
+
+#include "SimpleFilter.h"
+
+namespace android {
+
+// Applies a chain of per-pixel filters to ARGB8888 frames without RenderScript.
+// The filters run one after the other on a block of pixels small enough to
+// stay in cache, so that a frame is only read and written once whatever the
+// number of filters.
+//
+// The "filters" parameter lists the filters in the order they are applied,
+// separated by commas: "saturation" (with the "saturation" parameter) and
+// "invert".
+struct FilterChain : public SimpleFilter {
+public:
+    FilterChain() : mSaturation(1.f) {};
+
+    virtual status_t start();
+    virtual void reset() {};
+    virtual status_t setParameters(const sp<AMessage> &msg);
+    virtual status_t processBuffers(
+            const sp<ABuffer> &srcBuffer, const sp<ABuffer> &outBuffer);
+
+protected:
+    virtual ~FilterChain() {};
+
+private:
+    enum {
+        // pixels each filter processes before the next runs
+        kBlockPixels = 1024,
+    };
+
+    enum Stage {
+        kStageSaturation,
+        kStageInvert,
+    };
+
+    Vector<Stage> mStages;
+    float mSaturation;
+    int32_t mSaturationQ8;  // mSaturation in Q8, set when starting
+
+    static void ApplySaturation(
+            const uint8_t *src, uint8_t *dst, size_t numPixels, int32_t saturationQ8);
+    static void ApplyInvert(const uint8_t *src, uint8_t *dst, size_t numPixels);
+};
+
+}   // namespace android
+
+#endif  // FILTER_CHAIN_H_
@@ -35,6 +35,7 @@
 
 #include "ColorConvert.h"
 #include "GraphicBufferListener.h"
+#include "FilterChain.h"
 #include "IntrinsicBlurFilter.h"
 #include "RSFilter.h"
 #include "SaturationFilter.h"
@@ -453,6 +454,8 @@ void MediaFilter::onAllocateComponent(const sp<AMessage> &msg) {
         mFilter = new IntrinsicBlurFilter;
     } else if (!strcasecmp(name, "android.filter.RenderScript")) {
         mFilter = new RSFilter;
+    } else if (!strcasecmp(name, "android.filter.chain")) {
+        mFilter = new FilterChain;
     } else {
         ALOGE("Unrecognized filter name: %s", name);
         signalError(NAME_NOT_FOUND);
@@ -38,8 +38,18 @@ bool ABitReader::fillReservoir() {
     }
 
     mReservoir = 0;
+    if (mSize >= 8) {
+        for (size_t i = 0; i < 8; ++i) {
+            mReservoir = (mReservoir << 8) | mData[i];
+        }
+        mData += 8;
+        mSize -= 8;
+        mNumBitsLeft = 64;
+        return true;
+    }
+
     size_t i;
-    for (i = 0; mSize > 0 && i < 4; ++i) {
+    for (i = 0; mSize > 0; ++i) {
         mReservoir = (mReservoir << 8) | *mData;
 
         ++mData;
@@ -47,7 +57,20 @@ bool ABitReader::fillReservoir() {
     }
 
     mNumBitsLeft = 8 * i;
-    mReservoir <<= 32 - mNumBitsLeft;
+    mReservoir <<= 64 - mNumBitsLeft;
+    return true;
+}
+
+bool ABitReader::skipBytes(size_t n) {
+    if (n > mSize) {
+        mData += mSize;
+        mSize = 0;
+        mOverRead = true;
+        return false;
+    }
+
+    mData += n;
+    mSize -= n;
     return true;
 }
 
@@ -68,7 +91,20 @@ bool ABitReader::getBitsGraceful(size_t n, uint32_t *out) {
         return false;
     }
 
-    uint32_t result = 0;
+    if (n == 0) {
+        *out = 0;
+        return true;
+    }
+
+    // all the bits are in the reservoir, which is the common case
+    if (n <= mNumBitsLeft) {
+        *out = (uint32_t)(mReservoir >> (64 - n));
+        mReservoir <<= n;
+        mNumBitsLeft -= n;
+        return true;
+    }
+
+    uint64_t result = 0;
     while (n > 0) {
         if (mNumBitsLeft == 0) {
             if (!fillReservoir()) {
@@ -81,46 +117,90 @@ bool ABitReader::getBitsGraceful(size_t n, uint32_t *out) {
             m = mNumBitsLeft;
         }
 
-        result = (result << m) | (mReservoir >> (32 - m));
+        result = (result << m) | (mReservoir >> (64 - m));
         mReservoir <<= m;
         mNumBitsLeft -= m;
 
         n -= m;
     }
 
-    *out = result;
+    *out = (uint32_t)result;
     return true;
 }
 
 bool ABitReader::skipBits(size_t n) {
+    if (n <= mNumBitsLeft) {
+        mReservoir = n < 64 ? mReservoir << n : 0;
+        mNumBitsLeft -= n;
+        return true;
+    }
+
+    // drop the reservoir, then whole bytes, then read the remaining bits
+    n -= mNumBitsLeft;
+    mReservoir = 0;
+    mNumBitsLeft = 0;
+
+    if (!skipBytes(n / 8)) {
+        return false;
+    }
+
     uint32_t dummy;
-    while (n > 32) {
-        if (!getBitsGraceful(32, &dummy)) {
+    return getBitsGraceful(n % 8, &dummy);
+}
+
+bool ABitReader::getUEGraceful(uint32_t *out) {
+    // The code is |numZeros| zero bits, a one bit and |numZeros| bits of value, and usually
+    // fits in the reservoir. Bits after the reservoir may not be zero, see putBits().
+    if (mReservoir != 0) {
+        size_t numZeros = __builtin_clzll(mReservoir);
+        size_t length = 2 * numZeros + 1;
+        if (numZeros < 32 && length <= mNumBitsLeft) {
+            *out = (uint32_t)((mReservoir >> (64 - length)) - 1);
+            mReservoir <<= length;
+            mNumBitsLeft -= length;
+            return true;
+        }
+    }
+
+    size_t numZeros = 0;
+    uint32_t bit;
+    for (;;) {
+        if (!getBitsGraceful(1, &bit)) {
             return false;
         }
-        n -= 32;
+        if (bit != 0) {
+            break;
+        }
+        ++numZeros;
+    }
+
+    if (numZeros >= 32) {
+        skipBits(numZeros);
+        return false;
     }
 
-    if (n > 0) {
-        return getBitsGraceful(n, &dummy);
+    uint32_t x;
+    if (!getBitsGraceful(numZeros, &x)) {
+        return false;
     }
+    *out = x + (1u << numZeros) - 1;
     return true;
 }
 
 void ABitReader::putBits(uint32_t x, size_t n) {
-    if (mOverRead) {
+    if (mOverRead || n == 0) {
         return;
     }
 
     CHECK_LE(n, 32u);
 
-    while (mNumBitsLeft + n > 32) {
+    while (mNumBitsLeft + n > 64) {
         mNumBitsLeft -= 8;
         --mData;
         ++mSize;
     }
 
-    mReservoir = (mReservoir >> n) | (x << (32 - n));
+    mReservoir = (mReservoir >> n) | ((uint64_t)x << (64 - n));
     mNumBitsLeft += n;
 }
 
@@ -169,6 +249,24 @@ bool NALBitReader::atLeastNumBitsLeft(size_t n) const {
     return (numBitsRemaining <= 0);
 }
 
+bool NALBitReader::consumeByte(uint8_t *byte) {
+    bool isEmulationPreventionByte = (mNumZeros >= 2 && *mData == 3);
+
+    if (*mData == 0) {
+        ++mNumZeros;
+    } else {
+        mNumZeros = 0;
+    }
+
+    if (!isEmulationPreventionByte) {
+        *byte = *mData;
+    }
+
+    ++mData;
+    --mSize;
+    return !isEmulationPreventionByte;
+}
+
 bool NALBitReader::fillReservoir() {
     if (mSize == 0) {
         mOverRead = true;
@@ -176,28 +274,56 @@ bool NALBitReader::fillReservoir() {
     }
 
     mReservoir = 0;
-    size_t i = 0;
-    while (mSize > 0 && i < 4) {
-        bool isEmulationPreventionByte = (mNumZeros >= 2 && *mData == 3);
 
-        if (*mData == 0) {
-            ++mNumZeros;
-        } else {
+    // Without a zero byte there is no emulation prevention byte, other than one
+    // following zeros at the end of the previous reservoir.
+    if (mSize >= 8 && (mNumZeros < 2 || mData[0] != 3)) {
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < 8; ++i) {
+            bytes = (bytes << 8) | mData[i];
+        }
+        const uint64_t kOnes = 0x0101010101010101ull;
+        if (((bytes - kOnes) & ~bytes & (kOnes << 7)) == 0) {
+            mReservoir = bytes;
+            mData += 8;
+            mSize -= 8;
             mNumZeros = 0;
+            mNumBitsLeft = 64;
+            return true;
         }
+    }
 
+    size_t i = 0;
+    while (mSize > 0 && i < 8) {
         // skip emulation_prevention_three_byte
-        if (!isEmulationPreventionByte) {
-            mReservoir = (mReservoir << 8) | *mData;
+        uint8_t byte;
+        if (consumeByte(&byte)) {
+            mReservoir = (mReservoir << 8) | byte;
             ++i;
         }
-
-        ++mData;
-        --mSize;
     }
 
     mNumBitsLeft = 8 * i;
-    mReservoir <<= 32 - mNumBitsLeft;
+    if (mNumBitsLeft == 0) {
+        // only emulation prevention bytes were left
+        mOverRead = true;
+        return false;
+    }
+    mReservoir <<= 64 - mNumBitsLeft;
+    return true;
+}
+
+bool NALBitReader::skipBytes(size_t n) {
+    uint8_t byte;
+    while (n > 0) {
+        if (mSize == 0) {
+            mOverRead = true;
+            return false;
+        }
+        if (consumeByte(&byte)) {
+            --n;
+        }
+    }
     return true;
 }
 
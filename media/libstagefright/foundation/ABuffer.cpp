@@ -59,6 +59,17 @@ sp<ABuffer> ABuffer::CreateAsCopy(const void *data, size_t capacity)
     return res;
 }
 
+// static
+sp<ABuffer> ABuffer::CreateAsSlice(const sp<ABuffer> &buffer, size_t offset, size_t size)
+{
+    CHECK_LE(offset, buffer->size());
+    CHECK_LE(size, buffer->size() - offset);
+
+    sp<ABuffer> res = new ABuffer(buffer->data() + offset, size);
+    res->mSliceOf = buffer;
+    return res;
+}
+
 ABuffer::~ABuffer() {
     if (mOwnsData) {
         if (mData != NULL) {
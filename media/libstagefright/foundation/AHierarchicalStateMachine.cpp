@@ -16,18 +16,30 @@
 
 //#define LOG_NDEBUG 0
 #define LOG_TAG "AHierarchicalStateMachine"
+#define ATRACE_TAG ATRACE_TAG_VIDEO
 #include <utils/Log.h>
+#include <utils/Trace.h>
+
+#include <string.h>
 
 #include <media/stagefright/foundation/AHierarchicalStateMachine.h>
 
 #include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/ALooper.h>
 #include <media/stagefright/foundation/AMessage.h>
+#include <media/stagefright/foundation/AString.h>
 #include <utils/Vector.h>
 
 namespace android {
 
+// upper bounds of the message handling time buckets, the last one being unbounded
+static const int64_t kHandlingTimeBucketsUs[] = {
+    100, 500, 1000, 5000, 10000, 50000, 100000,
+};
+
 AState::AState(const sp<AState> &parentState)
-    : mParentState(parentState) {
+    : mParentState(parentState),
+      mName("AState") {
 }
 
 AState::~AState() {
@@ -37,6 +49,14 @@ sp<AState> AState::parentState() {
     return mParentState;
 }
 
+const char *AState::name() const {
+    return mName;
+}
+
+void AState::setName(const char *name) {
+    mName = name;
+}
+
 void AState::stateEntered() {
 }
 
@@ -45,13 +65,21 @@ void AState::stateExited() {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-AHierarchicalStateMachine::AHierarchicalStateMachine() {
+AHierarchicalStateMachine::AHierarchicalStateMachine()
+    : mNumTransitions(0) {
+    static_assert(ARRAY_SIZE(kHandlingTimeBucketsUs) == (size_t)kNumHandlingTimeBuckets - 1,
+            "one bucket per bound, and an unbounded one");
+    memset(mHandlingTimeHistogram, 0, sizeof(mHandlingTimeHistogram));
 }
 
 AHierarchicalStateMachine::~AHierarchicalStateMachine() {
 }
 
 void AHierarchicalStateMachine::handleMessage(const sp<AMessage> &msg) {
+    // the time is accounted to the state the message was received in
+    const size_t transition = mNumTransitions;
+    const int64_t startUs = ALooper::GetNowUs();
+
     sp<AState> save = mState;
 
     sp<AState> cur = mState;
@@ -63,12 +91,34 @@ void AHierarchicalStateMachine::handleMessage(const sp<AMessage> &msg) {
         cur = cur->parentState();
     }
 
-    if (cur != NULL) {
-        return;
+    if (cur == NULL) {
+        ALOGW("Warning message %s unhandled in root state.",
+             msg->debugString().c_str());
+    }
+
+    recordMessage(transition, ALooper::GetNowUs() - startUs);
+}
+
+void AHierarchicalStateMachine::recordMessage(size_t transition, int64_t handlingUs) {
+    Mutex::Autolock autoLock(mHistoryLock);
+
+    size_t bucket = 0;
+    while (bucket < ARRAY_SIZE(kHandlingTimeBucketsUs)
+            && handlingUs >= kHandlingTimeBucketsUs[bucket]) {
+        ++bucket;
+    }
+    ++mHandlingTimeHistogram[bucket];
+
+    if (transition == 0 || mNumTransitions - transition >= kNumStateRecords) {
+        return;  // no state yet, or its record was overwritten
     }
 
-    ALOGW("Warning message %s unhandled in root state.",
-         msg->debugString().c_str());
+    StateRecord &record = mHistory[(transition - 1) % kNumStateRecords];
+    record.mHandlingUs += handlingUs;
+    if (handlingUs > record.mMaxHandlingUs) {
+        record.mMaxHandlingUs = handlingUs;
+    }
+    ++record.mNumMessages;
 }
 
 void AHierarchicalStateMachine::changeState(const sp<AState> &state) {
@@ -103,6 +153,31 @@ void AHierarchicalStateMachine::changeState(const sp<AState> &state) {
         B.pop();
     }
 
+    const char *exitedName = mState == NULL ? NULL : mState->name();
+    const char *enteredName = state == NULL ? "none" : state->name();
+    const int32_t cookie = (int32_t)(intptr_t)this;
+    if (exitedName != NULL) {
+        ATRACE_ASYNC_END(exitedName, cookie);
+    }
+    ATRACE_ASYNC_BEGIN(enteredName, cookie);
+
+    {
+        Mutex::Autolock autoLock(mHistoryLock);
+        const int64_t nowUs = ALooper::GetNowUs();
+        if (mNumTransitions > 0) {
+            mHistory[(mNumTransitions - 1) % kNumStateRecords].mExitedUs = nowUs;
+        }
+
+        StateRecord &record = mHistory[mNumTransitions % kNumStateRecords];
+        record.mName = enteredName;
+        record.mEnteredUs = nowUs;
+        record.mExitedUs = -1;
+        record.mHandlingUs = 0;
+        record.mMaxHandlingUs = 0;
+        record.mNumMessages = 0;
+        ++mNumTransitions;
+    }
+
     mState = state;
 
     for (size_t i = 0; i < A.size(); ++i) {
@@ -115,4 +190,40 @@ void AHierarchicalStateMachine::changeState(const sp<AState> &state) {
     }
 }
 
+void AHierarchicalStateMachine::dumpStateHistory(AString *out) {
+    Mutex::Autolock autoLock(mHistoryLock);
+
+    const int64_t nowUs = ALooper::GetNowUs();
+    const size_t first =
+        mNumTransitions > kNumStateRecords ? mNumTransitions - kNumStateRecords : 0;
+
+    out->append("state history:\n");
+    for (size_t i = first; i < mNumTransitions; ++i) {
+        const StateRecord &record = mHistory[i % kNumStateRecords];
+        const bool current = record.mExitedUs < 0;
+        const int64_t exitedUs = current ? nowUs : record.mExitedUs;
+
+        out->append(AStringPrintf(
+                "  %s: entered at %.3f s for %.3f ms%s, "
+                "%u messages handled in %.3f ms (max %.3f ms)\n",
+                record.mName,
+                record.mEnteredUs / 1E6,
+                (exitedUs - record.mEnteredUs) / 1E3,
+                current ? " (current)" : "",
+                record.mNumMessages,
+                record.mHandlingUs / 1E3,
+                record.mMaxHandlingUs / 1E3));
+    }
+
+    out->append("message handling times:");
+    for (size_t i = 0; i < kNumHandlingTimeBuckets; ++i) {
+        if (i < ARRAY_SIZE(kHandlingTimeBucketsUs)) {
+            out->append(AStringPrintf(" <%.1f ms: %u,",
+                    kHandlingTimeBucketsUs[i] / 1E3, mHandlingTimeHistogram[i]));
+        } else {
+            out->append(AStringPrintf(" more: %u\n", mHandlingTimeHistogram[i]));
+        }
+    }
+}
+
 }  // namespace android
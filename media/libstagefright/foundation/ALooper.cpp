@@ -21,7 +21,9 @@
 
 #include <utils/Log.h>
 
+#include <inttypes.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 #include "ALooper.h"
 
@@ -64,13 +66,375 @@ private:
     DISALLOW_EVIL_CONSTRUCTORS(LooperThread);
 };
 
+// Process-wide pool of threads delivering the events of the loopers started with
+// startOnWorkerPool(). A looper is either idle, waiting in mTimers for its first event
+// to be due, waiting in mRunQueue for a worker, or running on one worker at a time.
+//
+// Locking: a looper's mLock may be held while taking mLock of the pool, never the reverse.
+struct ALooper::WorkerPool {
+    static WorkerPool *Get();
+
+    void enable(ALooper *looper);
+    // Schedules looper to run at whenUs, or earlier if it already was.
+    void schedule(ALooper *looper, int64_t whenUs);
+    // Removes looper from the pool, and waits for it to no longer run on a worker,
+    // unless this is that worker.
+    void disable(ALooper *looper);
+
+    // To be called around a wait for a response, so that a worker can be added if this
+    // is a worker thread and others would not be enough.
+    bool beginBlocking();
+    void endBlocking();
+
+private:
+    struct Worker;
+
+    struct Entry {
+        int64_t mWhenUs;
+        ALooper *mLooper;       // identifies the looper, which may be being destroyed
+        wp<ALooper> mRef;
+    };
+
+    enum {
+        kMaxWorkers = 64,
+        kMaxEventsPerTurn = 16,
+    };
+
+    Mutex mLock;
+    Condition mWorkCondition;       // waited for by idle workers
+    Condition mIdleCondition;       // broadcast when a looper stops running
+
+    List<Entry> mRunQueue;
+    Vector<Entry> mTimers;          // sorted by decreasing mWhenUs
+
+    Vector<android_thread_id_t> mWorkerIds;
+    size_t mTargetWorkers;
+    size_t mNumWorkers;
+    size_t mNumIdle;                // waiting for work
+    size_t mNumBlocked;             // waiting for a response
+
+    WorkerPool();
+
+    void enqueue_l(ALooper *looper, int64_t whenUs, int64_t nowUs);
+    void removeTimer_l(ALooper *looper);
+    void removeQueued_l(ALooper *looper);
+    void addWorkerIfNeeded_l();
+    bool isWorkerThread_l() const;
+
+    void addWorkerThread();
+    bool runOnce();      // returns false when the worker exits
+
+    DISALLOW_EVIL_CONSTRUCTORS(WorkerPool);
+};
+
+struct ALooper::WorkerPool::Worker : public Thread {
+    Worker(WorkerPool *pool)
+        : Thread(false /* canCallJava */),
+          mPool(pool) {
+    }
+
+    virtual status_t readyToRun() {
+        mPool->addWorkerThread();
+
+        return Thread::readyToRun();
+    }
+
+    virtual bool threadLoop() {
+        return mPool->runOnce();
+    }
+
+protected:
+    virtual ~Worker() {}
+
+private:
+    WorkerPool *mPool;
+
+    DISALLOW_EVIL_CONSTRUCTORS(Worker);
+};
+
+static Mutex gWorkerPoolLock;
+static ALooper::WorkerPool *gWorkerPool;
+
+// static
+ALooper::WorkerPool *ALooper::WorkerPool::Get() {
+    Mutex::Autolock autoLock(gWorkerPoolLock);
+    if (gWorkerPool == NULL) {
+        // never deleted, as loopers may be stopped by static destructors
+        gWorkerPool = new WorkerPool;
+    }
+    return gWorkerPool;
+}
+
+ALooper::WorkerPool::WorkerPool()
+    : mNumWorkers(0),
+      mNumIdle(0),
+      mNumBlocked(0) {
+    long numCpus = sysconf(_SC_NPROCESSORS_CONF);
+    mTargetWorkers = numCpus > 2 ? numCpus : 2;
+}
+
+void ALooper::WorkerPool::enable(ALooper *looper) {
+    Mutex::Autolock autoLock(mLock);
+    looper->mPoolEnabled = true;
+}
+
+void ALooper::WorkerPool::schedule(ALooper *looper, int64_t whenUs) {
+    Mutex::Autolock autoLock(mLock);
+
+    if (!looper->mPoolEnabled) {
+        return;
+    }
+
+    switch (looper->mPoolState) {
+        case POOL_RUNNING:
+            looper->mPoolRecheck = true;
+            return;
+
+        case POOL_QUEUED:
+            return;
+
+        case POOL_TIMED:
+            if (whenUs >= looper->mPoolWhenUs) {
+                return;
+            }
+            removeTimer_l(looper);
+            break;
+
+        case POOL_IDLE:
+            break;
+    }
+
+    enqueue_l(looper, whenUs, GetNowUs());
+}
+
+void ALooper::WorkerPool::enqueue_l(ALooper *looper, int64_t whenUs, int64_t nowUs) {
+    Entry entry;
+    entry.mWhenUs = whenUs;
+    entry.mLooper = looper;
+    entry.mRef = looper;
+
+    if (whenUs <= nowUs) {
+        mRunQueue.push_back(entry);
+        looper->mPoolState = POOL_QUEUED;
+    } else {
+        size_t i = mTimers.size();
+        while (i > 0 && mTimers[i - 1].mWhenUs < whenUs) {
+            --i;
+        }
+        mTimers.insertAt(entry, i);
+        looper->mPoolState = POOL_TIMED;
+        looper->mPoolWhenUs = whenUs;
+        if (i + 1 < mTimers.size()) {
+            return;  // not the earliest timer, the idle workers do not wait for it
+        }
+    }
+
+    if (mNumIdle > 0) {
+        mWorkCondition.signal();
+    } else {
+        addWorkerIfNeeded_l();
+    }
+}
+
+void ALooper::WorkerPool::removeTimer_l(ALooper *looper) {
+    for (size_t i = 0; i < mTimers.size(); ++i) {
+        if (mTimers[i].mLooper == looper) {
+            mTimers.removeAt(i);
+            break;
+        }
+    }
+}
+
+void ALooper::WorkerPool::removeQueued_l(ALooper *looper) {
+    for (List<Entry>::iterator it = mRunQueue.begin(); it != mRunQueue.end(); ++it) {
+        if ((*it).mLooper == looper) {
+            mRunQueue.erase(it);
+            break;
+        }
+    }
+}
+
+void ALooper::WorkerPool::disable(ALooper *looper) {
+    Mutex::Autolock autoLock(mLock);
+
+    looper->mPoolEnabled = false;
+
+    switch (looper->mPoolState) {
+        case POOL_TIMED:
+            removeTimer_l(looper);
+            looper->mPoolState = POOL_IDLE;
+            break;
+
+        case POOL_QUEUED:
+            removeQueued_l(looper);
+            looper->mPoolState = POOL_IDLE;
+            break;
+
+        case POOL_RUNNING:
+            if (looper->mPoolWorkerId == androidGetThreadId()) {
+                // the worker leaves the looper idle once the current message is delivered
+                break;
+            }
+            while (looper->mPoolState == POOL_RUNNING) {
+                mIdleCondition.wait(mLock);
+            }
+            break;
+
+        case POOL_IDLE:
+            break;
+    }
+}
+
+void ALooper::WorkerPool::addWorkerIfNeeded_l() {
+    if (mNumIdle > 0 || mNumWorkers - mNumBlocked >= mTargetWorkers
+            || (mRunQueue.empty() && mTimers.empty())) {
+        return;
+    }
+
+    if (mNumWorkers >= kMaxWorkers) {
+        ALOGW("all %zu looper pool workers are busy or blocked", mNumWorkers);
+        return;
+    }
+
+    sp<Worker> worker = new Worker(this);
+    if (worker->run("ALooperPool") == OK) {
+        // the worker keeps a reference to itself while running
+        ++mNumWorkers;
+    }
+}
+
+bool ALooper::WorkerPool::isWorkerThread_l() const {
+    const android_thread_id_t id = androidGetThreadId();
+    for (size_t i = 0; i < mWorkerIds.size(); ++i) {
+        if (mWorkerIds[i] == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ALooper::WorkerPool::addWorkerThread() {
+    Mutex::Autolock autoLock(mLock);
+    mWorkerIds.push(androidGetThreadId());
+}
+
+bool ALooper::WorkerPool::beginBlocking() {
+    Mutex::Autolock autoLock(mLock);
+    if (!isWorkerThread_l()) {
+        return false;
+    }
+    ++mNumBlocked;
+    addWorkerIfNeeded_l();
+    return true;
+}
+
+void ALooper::WorkerPool::endBlocking() {
+    Mutex::Autolock autoLock(mLock);
+    --mNumBlocked;
+}
+
+bool ALooper::WorkerPool::runOnce() {
+    Entry entry;
+
+    {
+        Mutex::Autolock autoLock(mLock);
+        for (;;) {
+            int64_t nowUs = GetNowUs();
+            while (!mTimers.empty() && mTimers.top().mWhenUs <= nowUs) {
+                Entry timer = mTimers.top();
+                mTimers.pop();
+                enqueue_l(timer.mLooper, nowUs, nowUs);
+            }
+
+            if (!mRunQueue.empty()) {
+                break;
+            }
+
+            if (mNumWorkers - mNumBlocked > mTargetWorkers) {
+                // added while others were blocked, which are now back
+                const android_thread_id_t id = androidGetThreadId();
+                for (size_t i = 0; i < mWorkerIds.size(); ++i) {
+                    if (mWorkerIds[i] == id) {
+                        mWorkerIds.removeAt(i);
+                        break;
+                    }
+                }
+                --mNumWorkers;
+                return false;
+            }
+
+            ++mNumIdle;
+            if (mTimers.empty()) {
+                mWorkCondition.wait(mLock);
+            } else {
+                mWorkCondition.waitRelative(mLock, (mTimers.top().mWhenUs - nowUs) * 1000ll);
+            }
+            --mNumIdle;
+        }
+
+        entry = *mRunQueue.begin();
+        mRunQueue.erase(mRunQueue.begin());
+
+        entry.mLooper->mPoolState = POOL_RUNNING;
+        entry.mLooper->mPoolRecheck = false;
+        entry.mLooper->mPoolWorkerId = androidGetThreadId();
+    }
+
+    // The looper may be being destroyed, in which case its destructor waits in
+    // disable() for it to go back to idle.
+    sp<ALooper> looper = entry.mRef.promote();
+    int64_t nextUs = -1;
+    for (size_t i = 0; looper != NULL && i < kMaxEventsPerTurn; ++i) {
+        nextUs = looper->deliverDueEvents();
+        if (nextUs < 0 || nextUs > GetNowUs() + looper->mWakeupSlackUs) {
+            break;
+        }
+    }
+
+    {
+        Mutex::Autolock autoLock(mLock);
+        ALooper *raw = entry.mLooper;
+        raw->mPoolState = POOL_IDLE;
+        if (looper != NULL && raw->mPoolEnabled) {
+            int64_t nowUs = GetNowUs();
+            if (raw->mPoolRecheck) {
+                enqueue_l(raw, nowUs, nowUs);
+            } else if (nextUs >= 0) {
+                enqueue_l(raw, nextUs, nowUs);
+            }
+        }
+        mIdleCondition.broadcast();
+    }
+
+    // may destroy the looper, if this was its last reference
+    looper.clear();
+
+    return true;
+}
+
 // static
 int64_t ALooper::GetNowUs() {
     return systemTime(SYSTEM_TIME_MONOTONIC) / 1000ll;
 }
 
 ALooper::ALooper()
-    : mRunningLocally(false) {
+    : mNextSeq(0),
+      mWaiting(false),
+      mWaitUntilUs(-1),
+      mWakeupSlackUs(0),
+      mMaxQueueDepth(0),
+      mPostedCount(0),
+      mDeliveredCount(0),
+      mWakeupCount(0),
+      mTotalLatencyUs(0),
+      mMaxLatencyUs(0),
+      mRunningLocally(false),
+      mPooled(false),
+      mPoolState(POOL_IDLE),
+      mPoolWhenUs(-1),
+      mPoolEnabled(false),
+      mPoolRecheck(false),
+      mPoolWorkerId(NULL) {
     // clean up stale AHandlers. Doing it here instead of in the destructor avoids
     // the side effect of objects being deleted from the unregister function recursively.
     gLooperRoster.unregisterStaleHandlers();
@@ -85,6 +449,31 @@ void ALooper::setName(const char *name) {
     mName = name;
 }
 
+void ALooper::setWakeupSlackUs(int64_t slackUs) {
+    Mutex::Autolock autoLock(mLock);
+    mWakeupSlackUs = slackUs > 0 ? slackUs : 0;
+}
+
+void ALooper::appendStats(AString *s, bool clear) {
+    Mutex::Autolock autoLock(mLock);
+    s->append(AStringPrintf(
+            "%zu queued (max %zu), %" PRIu64 " posted, %" PRIu64 " delivered, "
+            "%" PRIu64 " wakeups, latency avg %" PRId64 " us max %" PRId64 " us, "
+            "slack %" PRId64 " us",
+            mEventQueue.size(), mMaxQueueDepth, mPostedCount, mDeliveredCount,
+            mWakeupCount,
+            mDeliveredCount > 0 ? mTotalLatencyUs / (int64_t)mDeliveredCount : 0,
+            mMaxLatencyUs, mWakeupSlackUs));
+    if (clear) {
+        mMaxQueueDepth = mEventQueue.size();
+        mPostedCount = 0;
+        mDeliveredCount = 0;
+        mWakeupCount = 0;
+        mTotalLatencyUs = 0;
+        mMaxLatencyUs = 0;
+    }
+}
+
 ALooper::handler_id ALooper::registerHandler(const sp<AHandler> &handler) {
     return gLooperRoster.registerHandler(this, handler);
 }
@@ -99,7 +488,7 @@ status_t ALooper::start(
         {
             Mutex::Autolock autoLock(mLock);
 
-            if (mThread != NULL || mRunningLocally) {
+            if (mThread != NULL || mRunningLocally || mPooled) {
                 return INVALID_OPERATION;
             }
 
@@ -114,7 +503,7 @@ status_t ALooper::start(
 
     Mutex::Autolock autoLock(mLock);
 
-    if (mThread != NULL || mRunningLocally) {
+    if (mThread != NULL || mRunningLocally || mPooled) {
         return INVALID_OPERATION;
     }
 
@@ -129,23 +518,48 @@ status_t ALooper::start(
     return err;
 }
 
+status_t ALooper::startOnWorkerPool() {
+    Mutex::Autolock autoLock(mLock);
+
+    if (mThread != NULL || mRunningLocally || mPooled) {
+        return INVALID_OPERATION;
+    }
+
+    mPooled = true;
+
+    WorkerPool *pool = WorkerPool::Get();
+    pool->enable(this);
+    if (!mEventQueue.empty()) {
+        pool->schedule(this, mEventQueue[0].mWhenUs);
+    }
+
+    return OK;
+}
+
 status_t ALooper::stop() {
     sp<LooperThread> thread;
     bool runningLocally;
+    bool pooled;
 
     {
         Mutex::Autolock autoLock(mLock);
 
         thread = mThread;
         runningLocally = mRunningLocally;
+        pooled = mPooled;
         mThread.clear();
         mRunningLocally = false;
+        mPooled = false;
     }
 
-    if (thread == NULL && !runningLocally) {
+    if (thread == NULL && !runningLocally && !pooled) {
         return INVALID_OPERATION;
     }
 
+    if (pooled) {
+        WorkerPool::Get()->disable(this);
+    }
+
     if (thread != NULL) {
         thread->requestExit();
     }
@@ -156,7 +570,7 @@ status_t ALooper::stop() {
         mRepliesCondition.broadcast();
     }
 
-    if (!runningLocally && !thread->isCurrentThread()) {
+    if (thread != NULL && !thread->isCurrentThread()) {
         // If not running locally and this thread _is_ the looper thread,
         // the loop() function will return and never be called again.
         thread->requestExitAndWait();
@@ -165,6 +579,55 @@ status_t ALooper::stop() {
     return OK;
 }
 
+static inline bool isBefore(int64_t whenUs, uint64_t seq, int64_t otherWhenUs, uint64_t otherSeq) {
+    return whenUs < otherWhenUs || (whenUs == otherWhenUs && seq < otherSeq);
+}
+
+void ALooper::pushEvent(const Event &event) {
+    // move the hole from the end of the heap up to where event belongs
+    size_t i = mEventQueue.size();
+    mEventQueue.push();
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        const Event &p = mEventQueue[parent];
+        if (!isBefore(event.mWhenUs, event.mSeq, p.mWhenUs, p.mSeq)) {
+            break;
+        }
+        mEventQueue.editItemAt(i) = p;
+        i = parent;
+    }
+    mEventQueue.editItemAt(i) = event;
+}
+
+void ALooper::popEvent() {
+    // move the hole from the top of the heap down to where the last event belongs
+    Event last = mEventQueue.top();
+    mEventQueue.pop();
+    size_t n = mEventQueue.size();
+    if (n == 0) {
+        return;
+    }
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= n) {
+            break;
+        }
+        if (child + 1 < n && isBefore(
+                mEventQueue[child + 1].mWhenUs, mEventQueue[child + 1].mSeq,
+                mEventQueue[child].mWhenUs, mEventQueue[child].mSeq)) {
+            ++child;
+        }
+        const Event &c = mEventQueue[child];
+        if (!isBefore(c.mWhenUs, c.mSeq, last.mWhenUs, last.mSeq)) {
+            break;
+        }
+        mEventQueue.editItemAt(i) = c;
+        i = child;
+    }
+    mEventQueue.editItemAt(i) = last;
+}
+
 void ALooper::post(const sp<AMessage> &msg, int64_t delayUs) {
     Mutex::Autolock autoLock(mLock);
 
@@ -175,20 +638,28 @@ void ALooper::post(const sp<AMessage> &msg, int64_t delayUs) {
         whenUs = GetNowUs();
     }
 
-    List<Event>::iterator it = mEventQueue.begin();
-    while (it != mEventQueue.end() && (*it).mWhenUs <= whenUs) {
-        ++it;
-    }
-
     Event event;
     event.mWhenUs = whenUs;
+    event.mSeq = mNextSeq++;
     event.mMessage = msg;
 
-    if (it == mEventQueue.begin()) {
+    pushEvent(event);
+
+    ++mPostedCount;
+    if (mEventQueue.size() > mMaxQueueDepth) {
+        mMaxQueueDepth = mEventQueue.size();
+    }
+
+    // Only wake up a waiting loop() if the message is due before it wakes up anyway,
+    // by more than the slack. Once signaled, loop() looks at the whole queue again.
+    if (mWaiting && (mWaitUntilUs < 0 || whenUs + mWakeupSlackUs < mWaitUntilUs)) {
+        mWaiting = false;
         mQueueChangedCondition.signal();
     }
 
-    mEventQueue.insert(it, event);
+    if (mPooled && mEventQueue[0].mSeq == event.mSeq) {
+        WorkerPool::Get()->schedule(this, whenUs);
+    }
 }
 
 bool ALooper::loop() {
@@ -199,22 +670,32 @@ bool ALooper::loop() {
         if (mThread == NULL && !mRunningLocally) {
             return false;
         }
-        if (mEventQueue.empty()) {
-            mQueueChangedCondition.wait(mLock);
-            return true;
-        }
-        int64_t whenUs = (*mEventQueue.begin()).mWhenUs;
         int64_t nowUs = GetNowUs();
-
-        if (whenUs > nowUs) {
-            int64_t delayUs = whenUs - nowUs;
-            mQueueChangedCondition.waitRelative(mLock, delayUs * 1000ll);
+        if (mEventQueue.empty() || mEventQueue[0].mWhenUs > nowUs + mWakeupSlackUs) {
+            mWaiting = true;
+            if (mEventQueue.empty()) {
+                mWaitUntilUs = -1;
+                mQueueChangedCondition.wait(mLock);
+            } else {
+                mWaitUntilUs = mEventQueue[0].mWhenUs;
+                int64_t delayUs = mWaitUntilUs - nowUs;
+                mQueueChangedCondition.waitRelative(mLock, delayUs * 1000ll);
+            }
+            mWaiting = false;
+            ++mWakeupCount;
 
             return true;
         }
 
-        event = *mEventQueue.begin();
-        mEventQueue.erase(mEventQueue.begin());
+        event = mEventQueue[0];
+        popEvent();
+
+        int64_t latencyUs = nowUs > event.mWhenUs ? nowUs - event.mWhenUs : 0;
+        ++mDeliveredCount;
+        mTotalLatencyUs += latencyUs;
+        if (latencyUs > mMaxLatencyUs) {
+            mMaxLatencyUs = latencyUs;
+        }
     }
 
     event.mMessage->deliver();
@@ -227,6 +708,40 @@ bool ALooper::loop() {
     return true;
 }
 
+int64_t ALooper::deliverDueEvents() {
+    Event event;
+
+    {
+        Mutex::Autolock autoLock(mLock);
+        if (!mPooled || mEventQueue.empty()) {
+            return -1;
+        }
+        int64_t nowUs = GetNowUs();
+        if (mEventQueue[0].mWhenUs > nowUs + mWakeupSlackUs) {
+            return mEventQueue[0].mWhenUs;
+        }
+        ++mWakeupCount;
+
+        event = mEventQueue[0];
+        popEvent();
+
+        int64_t latencyUs = nowUs > event.mWhenUs ? nowUs - event.mWhenUs : 0;
+        ++mDeliveredCount;
+        mTotalLatencyUs += latencyUs;
+        if (latencyUs > mMaxLatencyUs) {
+            mMaxLatencyUs = latencyUs;
+        }
+    }
+
+    event.mMessage->deliver();
+
+    Mutex::Autolock autoLock(mLock);
+    if (!mPooled || mEventQueue.empty()) {
+        return -1;
+    }
+    return mEventQueue[0].mWhenUs;
+}
+
 // to be called by AMessage::postAndAwaitResponse only
 sp<AReplyToken> ALooper::createReplyToken() {
     return new AReplyToken(this);
@@ -234,19 +749,35 @@ sp<AReplyToken> ALooper::createReplyToken() {
 
 // to be called by AMessage::postAndAwaitResponse only
 status_t ALooper::awaitResponse(const sp<AReplyToken> &replyToken, sp<AMessage> *response) {
+    // a worker of the pool waiting here no longer delivers the events of other loopers
+    WorkerPool *pool = NULL;
+    {
+        Mutex::Autolock autoLock(gWorkerPoolLock);
+        pool = gWorkerPool;
+    }
+    const bool blockingWorker = pool != NULL && pool->beginBlocking();
+
     // return status in case we want to handle an interrupted wait
-    Mutex::Autolock autoLock(mRepliesLock);
-    CHECK(replyToken != NULL);
-    while (!replyToken->retrieveReply(response)) {
-        {
-            Mutex::Autolock autoLock(mLock);
-            if (mThread == NULL) {
-                return -ENOENT;
+    status_t err = OK;
+    {
+        Mutex::Autolock autoLock(mRepliesLock);
+        CHECK(replyToken != NULL);
+        while (!replyToken->retrieveReply(response)) {
+            {
+                Mutex::Autolock autoLock(mLock);
+                if (mThread == NULL && !mPooled) {
+                    err = -ENOENT;
+                    break;
+                }
             }
+            mRepliesCondition.wait(mRepliesLock);
         }
-        mRepliesCondition.wait(mRepliesLock);
     }
-    return OK;
+
+    if (blockingWorker) {
+        pool->endBlocking();
+    }
+    return err;
 }
 
 status_t ALooper::postReply(const sp<AReplyToken> &replyToken, const sp<AMessage> &reply) {
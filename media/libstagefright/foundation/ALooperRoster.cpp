@@ -129,6 +129,9 @@ void ALooperRoster::dump(int fd, const Vector<String16>& args) {
         s.append("(verbose stats collection enabled, stats will be cleared)\n");
     }
 
+    // declared before the lock, so that the last reference to a looper is released after it
+    Vector<sp<ALooper> > loopers;
+
     Mutex::Autolock autoLock(mLock);
     size_t n = mHandlers.size();
     s.appendFormat(" %zu registered handlers:\n", n);
@@ -138,6 +141,13 @@ void ALooperRoster::dump(int fd, const Vector<String16>& args) {
         HandlerInfo &info = mHandlers.editValueAt(i);
         sp<ALooper> looper = info.mLooper.promote();
         if (looper != NULL) {
+            bool listed = false;
+            for (size_t j = 0; j < loopers.size() && !listed; j++) {
+                listed = loopers[j] == looper;
+            }
+            if (!listed) {
+                loopers.add(looper);
+            }
             s.append(looper->getName());
             sp<AHandler> handler = info.mHandler.promote();
             if (handler != NULL) {
@@ -166,6 +176,13 @@ void ALooperRoster::dump(int fd, const Vector<String16>& args) {
         }
         s.append("\n");
     }
+
+    s.appendFormat(" %zu loopers:\n", loopers.size());
+    for (size_t i = 0; i < loopers.size(); i++) {
+        AString stats;
+        loopers[i]->appendStats(&stats, clear);
+        s.appendFormat("  %s: %s\n", loopers[i]->getName(), stats.c_str());
+    }
     write(fd, s.string(), s.size());
 }
 
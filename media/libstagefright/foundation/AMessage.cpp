@@ -32,11 +32,52 @@
 
 #include <binder/Parcel.h>
 #include <media/stagefright/foundation/hexdump.h>
+#include <utils/Mutex.h>
 
 namespace android {
 
 extern ALooperRoster gLooperRoster;
 
+// Freed AMessages kept for reuse. Messages are freed on whichever thread releases
+// the last reference, often not the one of the looper that allocated them, so the
+// pool is shared by the process rather than owned by a looper.
+static const size_t kMaxPooledMessages = 64;
+
+static Mutex gMessagePoolLock;
+static void *gMessagePool = NULL;   // singly linked through the first word of each block
+static size_t gMessagePoolSize = 0;
+
+// static
+void *AMessage::operator new(size_t size) {
+    if (size == sizeof(AMessage)) {
+        Mutex::Autolock autoLock(gMessagePoolLock);
+        void *ptr = gMessagePool;
+        if (ptr != NULL) {
+            gMessagePool = *(void **)ptr;
+            --gMessagePoolSize;
+            return ptr;
+        }
+    }
+    return ::operator new(size);
+}
+
+// static
+void AMessage::operator delete(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    {
+        Mutex::Autolock autoLock(gMessagePoolLock);
+        if (gMessagePoolSize < kMaxPooledMessages) {
+            *(void **)ptr = gMessagePool;
+            gMessagePool = ptr;
+            ++gMessagePoolSize;
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+
 status_t AReplyToken::setReply(const sp<AMessage> &reply) {
     if (mReplied) {
         ALOGE("trying to post a duplicate reply");
@@ -51,12 +92,14 @@ status_t AReplyToken::setReply(const sp<AMessage> &reply) {
 AMessage::AMessage(void)
     : mWhat(0),
       mTarget(0),
-      mNumItems(0) {
+      mNumItems(0),
+      mIndexed(false) {
 }
 
 AMessage::AMessage(uint32_t what, const sp<const AHandler> &handler)
     : mWhat(what),
-      mNumItems(0) {
+      mNumItems(0),
+      mIndexed(false) {
     setTarget(handler);
 }
 
@@ -87,18 +130,20 @@ void AMessage::setTarget(const sp<const AHandler> &handler) {
 void AMessage::clear() {
     for (size_t i = 0; i < mNumItems; ++i) {
         Item *item = &mItems[i];
-        delete[] item->mName;
-        item->mName = NULL;
+        item->freeName();
         freeItemValue(item);
     }
     mNumItems = 0;
+    mIndexed = false;
 }
 
 void AMessage::freeItemValue(Item *item) {
     switch (item->mType) {
         case kTypeString:
         {
-            delete item->u.stringValue;
+            if (!item->mStringInline) {
+                delete item->u.stringValue;
+            }
             break;
         }
 
@@ -147,7 +192,47 @@ static void reportStats() {
 }
 #endif
 
+// static
+uint32_t AMessage::HashName(const char *name, size_t len) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+void AMessage::addToIndex(size_t i) {
+    const Item &item = mItems[i];
+    size_t slot = HashName(item.mName, item.mNameLength) & (kIndexSize - 1);
+    while (mIndex[slot] != 0) {
+        slot = (slot + 1) & (kIndexSize - 1);
+    }
+    mIndex[slot] = (uint8_t)(i + 1);
+}
+
+void AMessage::buildIndex() {
+    mIndexed = mNumItems > kIndexMinItems;
+    if (mIndexed) {
+        memset(mIndex, 0, sizeof(mIndex));
+        for (size_t i = 0; i < mNumItems; ++i) {
+            addToIndex(i);
+        }
+    }
+}
+
 inline size_t AMessage::findItemIndex(const char *name, size_t len) const {
+    if (mIndexed) {
+        size_t slot = HashName(name, len) & (kIndexSize - 1);
+        for (; mIndex[slot] != 0; slot = (slot + 1) & (kIndexSize - 1)) {
+            const Item &item = mItems[mIndex[slot] - 1];
+            if (len == item.mNameLength && !memcmp(item.mName, name, len)) {
+                return mIndex[slot] - 1;
+            }
+        }
+        return mNumItems;
+    }
+
 #ifdef DUMP_STATS
     size_t memchecks = 0;
 #endif
@@ -179,10 +264,40 @@ inline size_t AMessage::findItemIndex(const char *name, size_t len) const {
 // assumes item's name was uninitialized or NULL
 void AMessage::Item::setName(const char *name, size_t len) {
     mNameLength = len;
-    mName = new char[len + 1];
+    mName = len < kItemInlineSize ? mInline : new char[len + 1];
     memcpy((void*)mName, name, len + 1);
 }
 
+void AMessage::Item::freeName() {
+    if (mName != mInline) {
+        delete[] mName;
+    }
+    mName = NULL;
+}
+
+// assumes the name is set, and the previous value was freed
+void AMessage::Item::setStringValue(const char *s, size_t len) {
+    size_t offset = mName == mInline ? mNameLength + 1 : 0;
+    mStringInline = offset + len < kItemInlineSize;
+    if (mStringInline) {
+        char *data = mInline + offset;
+        memcpy(data, s, len);
+        data[len] = '\0';
+        u.inlineStringValue.mData = data;
+        u.inlineStringValue.mLength = len;
+    } else {
+        u.stringValue = new AString(s, len);
+    }
+}
+
+const char *AMessage::Item::stringData() const {
+    return mStringInline ? u.inlineStringValue.mData : u.stringValue->c_str();
+}
+
+size_t AMessage::Item::stringLength() const {
+    return mStringInline ? u.inlineStringValue.mLength : u.stringValue->size();
+}
+
 AMessage::Item *AMessage::allocateItem(const char *name) {
     size_t len = strlen(name);
     size_t i = findItemIndex(name, len);
@@ -196,6 +311,11 @@ AMessage::Item *AMessage::allocateItem(const char *name) {
         i = mNumItems++;
         item = &mItems[i];
         item->setName(name, len);
+        if (mIndexed) {
+            addToIndex(i);
+        } else if (mNumItems > kIndexMinItems) {
+            buildIndex();
+        }
     }
 
     return item;
@@ -274,7 +394,7 @@ void AMessage::setString(
         const char *name, const char *s, ssize_t len) {
     Item *item = allocateItem(name);
     item->mType = kTypeString;
-    item->u.stringValue = new AString(s, len < 0 ? strlen(s) : len);
+    item->setStringValue(s, len < 0 ? strlen(s) : len);
 }
 
 void AMessage::setString(
@@ -322,7 +442,7 @@ void AMessage::setRect(
 bool AMessage::findString(const char *name, AString *value) const {
     const Item *item = findItem(name, kTypeString);
     if (item) {
-        *value = *item->u.stringValue;
+        value->setTo(item->stringData(), item->stringLength());
         return true;
     }
     return false;
@@ -462,8 +582,7 @@ sp<AMessage> AMessage::dup() const {
         switch (from->mType) {
             case kTypeString:
             {
-                to->u.stringValue =
-                    new AString(*from->u.stringValue);
+                to->setStringValue(from->stringData(), from->stringLength());
                 break;
             }
 
@@ -493,6 +612,12 @@ sp<AMessage> AMessage::dup() const {
         }
     }
 
+    // the items are at the same indices, so is the index
+    msg->mIndexed = mIndexed;
+    if (mIndexed) {
+        memcpy(msg->mIndex, mIndex, sizeof(mIndex));
+    }
+
     return msg;
 }
 
@@ -567,7 +692,7 @@ AString AMessage::debugString(int32_t indent) const {
                 tmp = AStringPrintf(
                         "string %s = \"%s\"",
                         item.mName,
-                        item.u.stringValue->c_str());
+                        item.stringData());
                 break;
             case kTypeObject:
                 tmp = AStringPrintf(
@@ -644,8 +769,9 @@ sp<AMessage> AMessage::FromParcel(const Parcel &parcel, size_t maxNestingLevel)
         }
 
         item->mType = static_cast<Type>(parcel.readInt32());
-        // setName() happens below so that we don't leak memory when parsing
-        // is aborted in the middle.
+        // setName() and setStringValue() happen below so that we don't leak memory
+        // when parsing is aborted in the middle.
+        const char *stringValue = NULL;
         switch (item->mType) {
             case kTypeInt32:
             {
@@ -679,15 +805,13 @@ sp<AMessage> AMessage::FromParcel(const Parcel &parcel, size_t maxNestingLevel)
 
             case kTypeString:
             {
-                const char *stringValue = parcel.readCString();
+                stringValue = parcel.readCString();
                 if (stringValue == NULL) {
                     ALOGE("Failed reading string value from a parcel. "
                         "Parsing aborted.");
                     msg->mNumItems = i;
                     continue;
                     // The loop will terminate subsequently.
-                } else {
-                    item->u.stringValue = new AString(stringValue);
                 }
                 break;
             }
@@ -696,6 +820,7 @@ sp<AMessage> AMessage::FromParcel(const Parcel &parcel, size_t maxNestingLevel)
             {
                 if (maxNestingLevel == 0) {
                     ALOGE("Too many levels of AMessage nesting.");
+                    msg->mNumItems = i;
                     return NULL;
                 }
                 sp<AMessage> subMsg = AMessage::FromParcel(
@@ -705,6 +830,7 @@ sp<AMessage> AMessage::FromParcel(const Parcel &parcel, size_t maxNestingLevel)
                     // This condition will be triggered when there exists an
                     // object that cannot cross process boundaries or when the
                     // level of nested AMessage is too deep.
+                    msg->mNumItems = i;
                     return NULL;
                 }
                 subMsg->incStrong(msg.get());
@@ -716,13 +842,20 @@ sp<AMessage> AMessage::FromParcel(const Parcel &parcel, size_t maxNestingLevel)
             default:
             {
                 ALOGE("This type of object cannot cross process boundaries.");
+                // only the items before this one are initialized, for ~AMessage()
+                msg->mNumItems = i;
                 return NULL;
             }
         }
 
         item->setName(name, strlen(name));
+        if (stringValue != NULL) {
+            item->setStringValue(stringValue, strlen(stringValue));
+        }
     }
 
+    msg->buildIndex();
+
     return msg;
 }
 
@@ -769,7 +902,7 @@ void AMessage::writeToParcel(Parcel *parcel) const {
 
             case kTypeString:
             {
-                parcel->writeCString(item.u.stringValue->c_str());
+                parcel->writeCString(item.stringData());
                 break;
             }
 
@@ -836,8 +969,9 @@ sp<AMessage> AMessage::changesFrom(const sp<const AMessage> &other, bool deep) c
                 break;
 
             case kTypeString:
-                if (oitem == NULL || *item.u.stringValue != *oitem->u.stringValue) {
-                    diff->setString(item.mName, *item.u.stringValue);
+                if (oitem == NULL || item.stringLength() != oitem->stringLength()
+                        || memcmp(item.stringData(), oitem->stringData(), item.stringLength())) {
+                    diff->setString(item.mName, item.stringData(), item.stringLength());
                 }
                 break;
 
@@ -27,6 +27,7 @@
 #include <net/if.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 
@@ -52,6 +53,15 @@ static uint64_t U64_AT(const uint8_t *ptr) {
 static const size_t kMaxUDPSize = 1500;
 static const int32_t kMaxUDPRetries = 200;
 
+// datagrams received or sent with a single recvmmsg() or sendmmsg()
+static const size_t kMaxDatagramBatch = 16;
+
+// epoll events returned by a single epoll_wait()
+static const int kMaxEpollEvents = 32;
+
+// epoll_event.data of the interrupt pipe, session IDs start at 1
+static const uint32_t kPipeEventID = 0;
+
 struct ANetworkSession::NetworkThread : public Thread {
     NetworkThread(ANetworkSession *session);
 
@@ -96,11 +106,16 @@ struct ANetworkSession::Session : public RefBase {
     bool wantsToRead();
     bool wantsToWrite();
 
+    // epoll events the socket is registered for, 0 if it is not in the epoll set
+    uint32_t epollEvents() const;
+    void setEpollEvents(uint32_t events);
+
     status_t readMore();
     status_t writeMore();
 
     status_t sendRequest(
             const void *data, ssize_t size, bool timeValid, int64_t timeUs);
+    status_t sendDatagram(const sp<ABuffer> &buffer, bool timeValid, int64_t timeUs);
 
     void setMode(Mode mode);
 
@@ -133,6 +148,15 @@ private:
 
     int64_t mLastStallReportUs;
 
+    uint32_t mEpollEvents;
+
+    // receive buffers of a datagram session, reallocated once delivered
+    sp<ABuffer> mRecvBuffers[kMaxDatagramBatch];
+
+    // the last datagram sender, usually the only one, and its formatted address
+    in_addr_t mLastFromIP;
+    AString mLastFromAddr;
+
     void notifyError(bool send, status_t err, const char *detail);
     void notify(NotificationReason reason);
 
@@ -170,7 +194,9 @@ ANetworkSession::Session::Session(
       mSawReceiveFailure(false),
       mSawSendFailure(false),
       mUDPRetries(kMaxUDPRetries),
-      mLastStallReportUs(-1ll) {
+      mLastStallReportUs(-1ll),
+      mEpollEvents(0),
+      mLastFromIP(0) {
     if (mState == CONNECTED) {
         struct sockaddr_in localAddr;
         socklen_t localAddrLen = sizeof(localAddr);
@@ -265,55 +291,86 @@ bool ANetworkSession::Session::wantsToWrite() {
             || (mState == DATAGRAM && !mOutFragments.empty()));
 }
 
+uint32_t ANetworkSession::Session::epollEvents() const {
+    return mEpollEvents;
+}
+
+void ANetworkSession::Session::setEpollEvents(uint32_t events) {
+    mEpollEvents = events;
+}
+
 status_t ANetworkSession::Session::readMore() {
     if (mState == DATAGRAM) {
         CHECK_EQ(mMode, MODE_DATAGRAM);
 
         status_t err;
+        int n;
         do {
-            sp<ABuffer> buf = new ABuffer(kMaxUDPSize);
+            struct mmsghdr msgs[kMaxDatagramBatch];
+            struct iovec iovecs[kMaxDatagramBatch];
+            struct sockaddr_in remoteAddrs[kMaxDatagramBatch];
+            memset(msgs, 0, sizeof(msgs));
+
+            for (size_t i = 0; i < kMaxDatagramBatch; ++i) {
+                if (mRecvBuffers[i] == NULL) {
+                    mRecvBuffers[i] = new ABuffer(kMaxUDPSize);
+                }
+                iovecs[i].iov_base = mRecvBuffers[i]->data();
+                iovecs[i].iov_len = mRecvBuffers[i]->capacity();
 
-            struct sockaddr_in remoteAddr;
-            socklen_t remoteAddrLen = sizeof(remoteAddr);
+                msgs[i].msg_hdr.msg_name = &remoteAddrs[i];
+                msgs[i].msg_hdr.msg_namelen = sizeof(remoteAddrs[i]);
+                msgs[i].msg_hdr.msg_iov = &iovecs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
 
-            ssize_t n;
             do {
-                n = recvfrom(
-                        mSocket, buf->data(), buf->capacity(), 0,
-                        (struct sockaddr *)&remoteAddr, &remoteAddrLen);
+                n = recvmmsg(mSocket, msgs, kMaxDatagramBatch, 0, NULL /* timeout */);
             } while (n < 0 && errno == EINTR);
 
             err = OK;
             if (n < 0) {
                 err = -errno;
-            } else if (n == 0) {
-                err = -ECONNRESET;
-            } else {
-                buf->setRange(0, n);
+                break;
+            }
 
-                int64_t nowUs = ALooper::GetNowUs();
+            int64_t nowUs = ALooper::GetNowUs();
+            for (int i = 0; i < n; ++i) {
+                if (msgs[i].msg_len == 0) {
+                    err = -ECONNRESET;
+                    break;
+                }
+
+                sp<ABuffer> buf = mRecvBuffers[i];
+                mRecvBuffers[i].clear();
+
+                buf->setRange(0, msgs[i].msg_len);
                 buf->meta()->setInt64("arrivalTimeUs", nowUs);
 
                 sp<AMessage> notify = mNotify->dup();
                 notify->setInt32("sessionID", mSessionID);
                 notify->setInt32("reason", kWhatDatagram);
 
-                uint32_t ip = ntohl(remoteAddr.sin_addr.s_addr);
-                notify->setString(
-                        "fromAddr",
-                        AStringPrintf(
+                uint32_t ip = ntohl(remoteAddrs[i].sin_addr.s_addr);
+                if (ip != mLastFromIP || mLastFromAddr.empty()) {
+                    mLastFromIP = ip;
+                    mLastFromAddr = AStringPrintf(
                             "%u.%u.%u.%u",
                             ip >> 24,
                             (ip >> 16) & 0xff,
                             (ip >> 8) & 0xff,
-                            ip & 0xff).c_str());
+                            ip & 0xff);
+                }
+                notify->setString("fromAddr", mLastFromAddr.c_str());
 
-                notify->setInt32("fromPort", ntohs(remoteAddr.sin_port));
+                notify->setInt32("fromPort", ntohs(remoteAddrs[i].sin_port));
 
                 notify->setBuffer("data", buf);
                 notify->post();
             }
-        } while (err == OK);
+
+            // a partial batch means the socket has no more queued datagrams
+        } while (err == OK && n == (int)kMaxDatagramBatch);
 
         if (err == -EAGAIN) {
             err = OK;
@@ -554,22 +611,36 @@ status_t ANetworkSession::Session::writeMore() {
 
         status_t err;
         do {
-            const Fragment &frag = *mOutFragments.begin();
-            const sp<ABuffer> &datagram = frag.mBuffer;
+            struct mmsghdr msgs[kMaxDatagramBatch];
+            struct iovec iovecs[kMaxDatagramBatch];
+            memset(msgs, 0, sizeof(msgs));
+
+            unsigned count = 0;
+            for (List<Fragment>::iterator it = mOutFragments.begin();
+                    it != mOutFragments.end() && count < kMaxDatagramBatch; ++it, ++count) {
+                iovecs[count].iov_base = (*it).mBuffer->data();
+                iovecs[count].iov_len = (*it).mBuffer->size();
+
+                msgs[count].msg_hdr.msg_iov = &iovecs[count];
+                msgs[count].msg_hdr.msg_iovlen = 1;
+            }
 
             int n;
             do {
-                n = send(mSocket, datagram->data(), datagram->size(), 0);
+                n = sendmmsg(mSocket, msgs, count, 0);
             } while (n < 0 && errno == EINTR);
 
             err = OK;
 
             if (n > 0) {
-                if (frag.mFlags & FRAGMENT_FLAG_TIME_VALID) {
-                    dumpFragmentStats(frag);
-                }
+                for (int i = 0; i < n; ++i) {
+                    const Fragment &frag = *mOutFragments.begin();
+                    if (frag.mFlags & FRAGMENT_FLAG_TIME_VALID) {
+                        dumpFragmentStats(frag);
+                    }
 
-                mOutFragments.erase(mOutFragments.begin());
+                    mOutFragments.erase(mOutFragments.begin());
+                }
             } else if (n < 0) {
                 err = -errno;
             } else if (n == 0) {
@@ -580,6 +651,25 @@ status_t ANetworkSession::Session::writeMore() {
         if (err == -EAGAIN) {
             if (!mOutFragments.empty()) {
                 ALOGI("%zu datagrams remain queued.", mOutFragments.size());
+
+                // the sender backs off while its datagrams queue up
+                int64_t nowUs = ALooper::GetNowUs();
+                if (mLastStallReportUs < 0ll
+                        || nowUs > mLastStallReportUs + 100000ll) {
+                    size_t numBytesQueued = 0;
+                    for (List<Fragment>::iterator it = mOutFragments.begin();
+                            it != mOutFragments.end(); ++it) {
+                        numBytesQueued += (*it).mBuffer->size();
+                    }
+
+                    sp<AMessage> msg = mNotify->dup();
+                    msg->setInt32("sessionID", mSessionID);
+                    msg->setInt32("reason", kWhatNetworkStall);
+                    msg->setSize("numBytesQueued", numBytesQueued);
+                    msg->post();
+
+                    mLastStallReportUs = nowUs;
+                }
             }
             err = OK;
         }
@@ -777,6 +867,31 @@ status_t ANetworkSession::Session::sendRequest(
     return OK;
 }
 
+status_t ANetworkSession::Session::sendDatagram(
+        const sp<ABuffer> &buffer, bool timeValid, int64_t timeUs) {
+    if (mState != DATAGRAM) {
+        return sendRequest(buffer->data(), buffer->size(), timeValid, timeUs);
+    }
+
+    if (buffer->size() == 0) {
+        return OK;
+    }
+
+    Fragment frag;
+
+    frag.mFlags = 0;
+    if (timeValid) {
+        frag.mFlags = FRAGMENT_FLAG_TIME_VALID;
+        frag.mTimeUs = timeUs;
+    }
+
+    frag.mBuffer = buffer;
+
+    mOutFragments.push_back(frag);
+
+    return OK;
+}
+
 void ANetworkSession::Session::notifyError(
         bool send, status_t err, const char *detail) {
     sp<AMessage> msg = mNotify->dup();
@@ -798,7 +913,8 @@ void ANetworkSession::Session::notify(NotificationReason reason) {
 ////////////////////////////////////////////////////////////////////////////////
 
 ANetworkSession::ANetworkSession()
-    : mNextSessionID(1) {
+    : mNextSessionID(1),
+      mEpollFd(-1) {
     mPipeFd[0] = mPipeFd[1] = -1;
 }
 
@@ -817,13 +933,40 @@ status_t ANetworkSession::start() {
         return -errno;
     }
 
-    mThread = new NetworkThread(this);
+    status_t err = OK;
+
+    mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (mEpollFd < 0) {
+        err = -errno;
+    } else {
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u32 = kPipeEventID;
+        if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mPipeFd[0], &event) < 0) {
+            err = -errno;
+        }
+    }
+
+    if (err == OK) {
+        {
+            // sessions may have been created before start()
+            Mutex::Autolock autoLock(mLock);
+            for (size_t i = 0; i < mSessions.size(); ++i) {
+                updateEpollEvents_l(mSessions.valueAt(i));
+            }
+        }
 
-    status_t err = mThread->run("ANetworkSession", ANDROID_PRIORITY_AUDIO);
+        mThread = new NetworkThread(this);
+
+        err = mThread->run("ANetworkSession", ANDROID_PRIORITY_AUDIO);
+    }
 
     if (err != OK) {
         mThread.clear();
 
+        closeEpoll();
+
         close(mPipeFd[0]);
         close(mPipeFd[1]);
         mPipeFd[0] = mPipeFd[1] = -1;
@@ -834,6 +977,19 @@ status_t ANetworkSession::start() {
     return OK;
 }
 
+void ANetworkSession::closeEpoll() {
+    Mutex::Autolock autoLock(mLock);
+
+    if (mEpollFd >= 0) {
+        close(mEpollFd);
+        mEpollFd = -1;
+    }
+
+    for (size_t i = 0; i < mSessions.size(); ++i) {
+        mSessions.valueAt(i)->setEpollEvents(0);
+    }
+}
+
 status_t ANetworkSession::stop() {
     if (mThread == NULL) {
         return INVALID_OPERATION;
@@ -845,6 +1001,8 @@ status_t ANetworkSession::stop() {
 
     mThread.clear();
 
+    closeEpoll();
+
     close(mPipeFd[0]);
     close(mPipeFd[1]);
     mPipeFd[0] = mPipeFd[1] = -1;
@@ -937,9 +1095,13 @@ status_t ANetworkSession::destroySession(int32_t sessionID) {
         return -ENOENT;
     }
 
-    mSessions.removeItemsAt(index);
+    const sp<Session> session = mSessions.valueAt(index);
+    if (session->epollEvents() != 0) {
+        epoll_ctl(mEpollFd, EPOLL_CTL_DEL, session->socket(), NULL);
+        session->setEpollEvents(0);
+    }
 
-    interrupt();
+    mSessions.removeItemsAt(index);
 
     return OK;
 }
@@ -1150,7 +1312,7 @@ status_t ANetworkSession::createClientOrServer(
 
     mSessions.add(session->sessionID(), session);
 
-    interrupt();
+    updateEpollEvents_l(session);
 
     *sessionID = session->sessionID();
 
@@ -1217,7 +1379,29 @@ status_t ANetworkSession::sendRequest(
 
     status_t err = session->sendRequest(data, size, timeValid, timeUs);
 
-    interrupt();
+    // the network thread wakes up once the socket is registered for writing
+    updateEpollEvents_l(session);
+
+    return err;
+}
+
+status_t ANetworkSession::sendDatagram(
+        int32_t sessionID, const sp<ABuffer> &buffer,
+        bool timeValid, int64_t timeUs) {
+    Mutex::Autolock autoLock(mLock);
+
+    ssize_t index = mSessions.indexOfKey(sessionID);
+
+    if (index < 0) {
+        return -ENOENT;
+    }
+
+    const sp<Session> session = mSessions.valueAt(index);
+
+    status_t err = session->sendDatagram(buffer, timeValid, timeUs);
+
+    // the network thread wakes up once the socket is registered for writing
+    updateEpollEvents_l(session);
 
     return err;
 }
@@ -1248,43 +1432,51 @@ void ANetworkSession::interrupt() {
     }
 }
 
-void ANetworkSession::threadLoop() {
-    fd_set rs, ws;
-    FD_ZERO(&rs);
-    FD_ZERO(&ws);
+void ANetworkSession::updateEpollEvents_l(const sp<Session> &session) {
+    int s = session->socket();
+    if (mEpollFd < 0 || s < 0) {
+        return;
+    }
 
-    FD_SET(mPipeFd[0], &rs);
-    int maxFd = mPipeFd[0];
+    uint32_t events = 0;
+    if (session->wantsToRead()) {
+        events |= EPOLLIN;
+    }
+    if (session->wantsToWrite()) {
+        events |= EPOLLOUT;
+    }
 
-    {
-        Mutex::Autolock autoLock(mLock);
+    const uint32_t registered = session->epollEvents();
+    if (events == registered) {
+        return;
+    }
 
-        for (size_t i = 0; i < mSessions.size(); ++i) {
-            const sp<Session> &session = mSessions.valueAt(i);
+    // A socket waiting for nothing is removed, as errors and hang-ups would
+    // otherwise be reported again and again.
+    int op = EPOLL_CTL_MOD;
+    if (registered == 0) {
+        op = EPOLL_CTL_ADD;
+    } else if (events == 0) {
+        op = EPOLL_CTL_DEL;
+    }
 
-            int s = session->socket();
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.u32 = session->sessionID();
 
-            if (s < 0) {
-                continue;
-            }
+    if (epoll_ctl(mEpollFd, op, s, &event) < 0) {
+        ALOGE("epoll_ctl on socket %d failed w/ error %d (%s)", s, errno, strerror(errno));
+        return;
+    }
 
-            if (session->wantsToRead()) {
-                FD_SET(s, &rs);
-                if (s > maxFd) {
-                    maxFd = s;
-                }
-            }
+    session->setEpollEvents(events);
+}
 
-            if (session->wantsToWrite()) {
-                FD_SET(s, &ws);
-                if (s > maxFd) {
-                    maxFd = s;
-                }
-            }
-        }
-    }
+void ANetworkSession::threadLoop() {
+    struct epoll_event events[kMaxEpollEvents];
 
-    int res = select(maxFd + 1, &rs, &ws, NULL, NULL /* tv */);
+    int res = epoll_wait(mEpollFd, events, kMaxEpollEvents, -1 /* timeout */);
 
     if (res == 0) {
         return;
@@ -1295,117 +1487,126 @@ void ANetworkSession::threadLoop() {
             return;
         }
 
-        ALOGE("select failed w/ error %d (%s)", errno, strerror(errno));
+        ALOGE("epoll_wait failed w/ error %d (%s)", errno, strerror(errno));
         return;
     }
 
-    if (FD_ISSET(mPipeFd[0], &rs)) {
-        char c;
-        ssize_t n;
-        do {
-            n = read(mPipeFd[0], &c, 1);
-        } while (n < 0 && errno == EINTR);
+    Mutex::Autolock autoLock(mLock);
+
+    List<sp<Session> > sessionsToAdd;
 
-        if (n < 0) {
-            ALOGW("Error reading from pipe (%s)", strerror(errno));
+    for (int i = 0; i < res; ++i) {
+        if (events[i].data.u32 == kPipeEventID) {
+            char c;
+            ssize_t n;
+            do {
+                n = read(mPipeFd[0], &c, 1);
+            } while (n < 0 && errno == EINTR);
+
+            if (n < 0) {
+                ALOGW("Error reading from pipe (%s)", strerror(errno));
+            }
+            continue;
         }
 
-        --res;
-    }
+        // the session may have been destroyed since epoll_wait() returned
+        ssize_t index = mSessions.indexOfKey((int32_t)events[i].data.u32);
+        if (index < 0) {
+            continue;
+        }
+
+        const sp<Session> session = mSessions.valueAt(index);
 
-    {
-        Mutex::Autolock autoLock(mLock);
+        int s = session->socket();
 
-        List<sp<Session> > sessionsToAdd;
+        if (s < 0) {
+            continue;
+        }
 
-        for (size_t i = mSessions.size(); res > 0 && i > 0;) {
-            i--;
-            const sp<Session> &session = mSessions.valueAt(i);
+        // as with select(), an error or hang-up makes the socket readable and writable
+        const uint32_t registered = session->epollEvents();
+        const uint32_t ready = events[i].events;
+        const bool readable =
+            (registered & EPOLLIN) && (ready & (EPOLLIN | EPOLLERR | EPOLLHUP));
+        const bool writable =
+            (registered & EPOLLOUT) && (ready & (EPOLLOUT | EPOLLERR | EPOLLHUP));
 
-            int s = session->socket();
+        if (readable) {
+            if (session->isRTSPServer() || session->isTCPDatagramServer()) {
+                struct sockaddr_in remoteAddr;
+                socklen_t remoteAddrLen = sizeof(remoteAddr);
 
-            if (s < 0) {
-                continue;
-            }
+                int clientSocket = accept(
+                        s, (struct sockaddr *)&remoteAddr, &remoteAddrLen);
 
-            if (FD_ISSET(s, &rs) || FD_ISSET(s, &ws)) {
-                --res;
-            }
+                if (clientSocket >= 0) {
+                    status_t err = MakeSocketNonBlocking(clientSocket);
 
-            if (FD_ISSET(s, &rs)) {
-                if (session->isRTSPServer() || session->isTCPDatagramServer()) {
-                    struct sockaddr_in remoteAddr;
-                    socklen_t remoteAddrLen = sizeof(remoteAddr);
-
-                    int clientSocket = accept(
-                            s, (struct sockaddr *)&remoteAddr, &remoteAddrLen);
-
-                    if (clientSocket >= 0) {
-                        status_t err = MakeSocketNonBlocking(clientSocket);
-
-                        if (err != OK) {
-                            ALOGE("Unable to make client socket non blocking, "
-                                  "failed w/ error %d (%s)",
-                                  err, strerror(-err));
-
-                            close(clientSocket);
-                            clientSocket = -1;
-                        } else {
-                            in_addr_t addr = ntohl(remoteAddr.sin_addr.s_addr);
-
-                            ALOGI("incoming connection from %d.%d.%d.%d:%d "
-                                  "(socket %d)",
-                                  (addr >> 24),
-                                  (addr >> 16) & 0xff,
-                                  (addr >> 8) & 0xff,
-                                  addr & 0xff,
-                                  ntohs(remoteAddr.sin_port),
-                                  clientSocket);
-
-                            sp<Session> clientSession =
-                                new Session(
-                                        mNextSessionID++,
-                                        Session::CONNECTED,
-                                        clientSocket,
-                                        session->getNotificationMessage());
-
-                            clientSession->setMode(
-                                    session->isRTSPServer()
-                                        ? Session::MODE_RTSP
-                                        : Session::MODE_DATAGRAM);
-
-                            sessionsToAdd.push_back(clientSession);
-                        }
+                    if (err != OK) {
+                        ALOGE("Unable to make client socket non blocking, "
+                              "failed w/ error %d (%s)",
+                              err, strerror(-err));
+
+                        close(clientSocket);
+                        clientSocket = -1;
                     } else {
-                        ALOGE("accept returned error %d (%s)",
-                              errno, strerror(errno));
+                        in_addr_t addr = ntohl(remoteAddr.sin_addr.s_addr);
+
+                        ALOGI("incoming connection from %d.%d.%d.%d:%d "
+                              "(socket %d)",
+                              (addr >> 24),
+                              (addr >> 16) & 0xff,
+                              (addr >> 8) & 0xff,
+                              addr & 0xff,
+                              ntohs(remoteAddr.sin_port),
+                              clientSocket);
+
+                        sp<Session> clientSession =
+                            new Session(
+                                    mNextSessionID++,
+                                    Session::CONNECTED,
+                                    clientSocket,
+                                    session->getNotificationMessage());
+
+                        clientSession->setMode(
+                                session->isRTSPServer()
+                                    ? Session::MODE_RTSP
+                                    : Session::MODE_DATAGRAM);
+
+                        sessionsToAdd.push_back(clientSession);
                     }
                 } else {
-                    status_t err = session->readMore();
-                    if (err != OK) {
-                        ALOGE("readMore on socket %d failed w/ error %d (%s)",
-                              s, err, strerror(-err));
-                    }
+                    ALOGE("accept returned error %d (%s)",
+                          errno, strerror(errno));
                 }
-            }
-
-            if (FD_ISSET(s, &ws)) {
-                status_t err = session->writeMore();
+            } else {
+                status_t err = session->readMore();
                 if (err != OK) {
-                    ALOGE("writeMore on socket %d failed w/ error %d (%s)",
+                    ALOGE("readMore on socket %d failed w/ error %d (%s)",
                           s, err, strerror(-err));
                 }
             }
         }
 
-        while (!sessionsToAdd.empty()) {
-            sp<Session> session = *sessionsToAdd.begin();
-            sessionsToAdd.erase(sessionsToAdd.begin());
+        if (writable) {
+            status_t err = session->writeMore();
+            if (err != OK) {
+                ALOGE("writeMore on socket %d failed w/ error %d (%s)",
+                      s, err, strerror(-err));
+            }
+        }
 
-            mSessions.add(session->sessionID(), session);
+        updateEpollEvents_l(session);
+    }
 
-            ALOGI("added clientSession %d", session->sessionID());
-        }
+    while (!sessionsToAdd.empty()) {
+        sp<Session> session = *sessionsToAdd.begin();
+        sessionsToAdd.erase(sessionsToAdd.begin());
+
+        mSessions.add(session->sessionID(), session);
+        updateEpollEvents_l(session);
+
+        ALOGI("added clientSession %d", session->sessionID());
     }
 }
 
@@ -17,6 +17,8 @@
 #define LOG_TAG "MediaBufferGroup"
 #include <utils/Log.h>
 
+#include <algorithm>
+
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/MediaBuffer.h>
 #include <media/stagefright/MediaBufferGroup.h>
@@ -33,11 +35,21 @@ static const size_t kSharedMemoryThreshold = MIN(
         (size_t)MediaBuffer::kSharedMemThreshold, (size_t)(4 * 1024));
 
 MediaBufferGroup::MediaBufferGroup(size_t growthLimit) :
-    mGrowthLimit(growthLimit) {
+    mGrowthLimit(growthLimit),
+    mAcquireCount(0),
+    mFreeListHitCount(0),
+    mAllocationCount(0),
+    mWaitCount(0),
+    mPeakBuffers(0) {
 }
 
 MediaBufferGroup::MediaBufferGroup(size_t buffers, size_t buffer_size, size_t growthLimit)
-    : mGrowthLimit(growthLimit) {
+    : mGrowthLimit(growthLimit),
+      mAcquireCount(0),
+      mFreeListHitCount(0),
+      mAllocationCount(0),
+      mWaitCount(0),
+      mPeakBuffers(0) {
 
     if (mGrowthLimit > 0 && buffers > mGrowthLimit) {
         ALOGW("Preallocated buffers %zu > growthLimit %zu, increasing growthLimit",
@@ -81,6 +93,8 @@ MediaBufferGroup::MediaBufferGroup(size_t buffers, size_t buffer_size, size_t gr
 }
 
 MediaBufferGroup::~MediaBufferGroup() {
+    ALOGV("%zu acquired, %zu from free list, %zu allocated, %zu waits, peak %zu buffers",
+            mAcquireCount, mFreeListHitCount, mAllocationCount, mWaitCount, mPeakBuffers);
     for (MediaBuffer *buffer : mBuffers) {
         if (buffer->refcount() != 0) {
             const int localRefcount = buffer->localRefcount();
@@ -114,6 +128,7 @@ void MediaBufferGroup::add_buffer(MediaBuffer *buffer) {
             && mBuffers.size() >= mGrowthLimit
             && it != mBuffers.end();) {
         if ((*it)->refcount() == 0) {
+            removeFreeBuffer_l(*it);
             (*it)->setObserver(nullptr);
             (*it)->release();
             it = mBuffers.erase(it);
@@ -124,6 +139,10 @@ void MediaBufferGroup::add_buffer(MediaBuffer *buffer) {
 
     buffer->setObserver(this);
     mBuffers.emplace_back(buffer);
+    mPeakBuffers = std::max(mPeakBuffers, mBuffers.size());
+    if (buffer->refcount() == 0) {
+        addFreeBuffer_l(buffer);
+    }
 }
 
 bool MediaBufferGroup::has_buffers() {
@@ -141,15 +160,26 @@ bool MediaBufferGroup::has_buffers() {
 status_t MediaBufferGroup::acquire_buffer(
         MediaBuffer **out, bool nonBlocking, size_t requestedSize) {
     Mutex::Autolock autoLock(mLock);
+    ++mAcquireCount;
     for (;;) {
+        MediaBuffer *buffer = takeFreeBuffer_l(requestedSize);
+        if (buffer != nullptr) {
+            ++mFreeListHitCount;
+            buffer->add_ref();
+            buffer->reset();
+            *out = buffer;
+            return OK;
+        }
+
+        // Buffers freed by claim() or by a remote release are not in the free list.
         size_t smallest = requestedSize;
-        MediaBuffer *buffer = nullptr;
         auto free = mBuffers.end();
         for (auto it = mBuffers.begin(); it != mBuffers.end(); ++it) {
             if ((*it)->refcount() == 0) {
                 const size_t size = (*it)->size();
                 if (size >= requestedSize) {
                     buffer = *it;
+                    removeFreeBuffer_l(buffer);
                     break;
                 }
                 if (size < smallest) {
@@ -169,16 +199,19 @@ status_t MediaBufferGroup::acquire_buffer(
                 delete buffer; // Invalid alloc, prefer not to call release.
                 buffer = nullptr;
             } else {
+                ++mAllocationCount;
                 buffer->setObserver(this);
                 if (free != mBuffers.end()) {
                     ALOGV("reallocate buffer, requested size %zu vs available %zu",
                             requestedSize, (*free)->size());
+                    removeFreeBuffer_l(*free);
                     (*free)->setObserver(nullptr);
                     (*free)->release();
                     *free = buffer; // in-place replace
                 } else {
                     ALOGV("allocate buffer, requested size %zu", requestedSize);
                     mBuffers.emplace_back(buffer);
+                    mPeakBuffers = std::max(mPeakBuffers, mBuffers.size());
                 }
             }
         }
@@ -193,13 +226,62 @@ status_t MediaBufferGroup::acquire_buffer(
             return WOULD_BLOCK;
         }
         // All buffers are in use, block until one of them is returned.
+        ++mWaitCount;
         mCondition.wait(mLock);
     }
     // Never gets here.
 }
 
-void MediaBufferGroup::signalBufferReturned(MediaBuffer *) {
+void MediaBufferGroup::signalBufferReturned(MediaBuffer *buffer) {
+    // buffer is null when only a remote reference was released, see IMediaSource.
+    if (buffer != nullptr) {
+        Mutex::Autolock autoLock(mLock);
+        addFreeBuffer_l(buffer);
+    }
     mCondition.signal();
 }
 
+// static
+size_t MediaBufferGroup::sizeClass(size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    const size_t log2Size = sizeof(unsigned long) * 8 - 1 - __builtin_clzl(size);
+    return log2Size < kNumSizeClasses ? log2Size : kNumSizeClasses - 1;
+}
+
+void MediaBufferGroup::addFreeBuffer_l(MediaBuffer *buffer) {
+    std::vector<MediaBuffer *> &freeBuffers = mFreeBuffers[sizeClass(buffer->size())];
+    if (std::find(freeBuffers.begin(), freeBuffers.end(), buffer) == freeBuffers.end()) {
+        freeBuffers.push_back(buffer);
+    }
+}
+
+void MediaBufferGroup::removeFreeBuffer_l(MediaBuffer *buffer) {
+    std::vector<MediaBuffer *> &freeBuffers = mFreeBuffers[sizeClass(buffer->size())];
+    auto it = std::find(freeBuffers.begin(), freeBuffers.end(), buffer);
+    if (it != freeBuffers.end()) {
+        *it = freeBuffers.back();
+        freeBuffers.pop_back();
+    }
+}
+
+MediaBuffer *MediaBufferGroup::takeFreeBuffer_l(size_t requestedSize) {
+    // The most recently returned buffer of the smallest fitting class is taken first,
+    // its memory being the most likely to still be in cache.
+    for (size_t c = sizeClass(requestedSize); c < kNumSizeClasses; ++c) {
+        std::vector<MediaBuffer *> &freeBuffers = mFreeBuffers[c];
+        for (size_t i = freeBuffers.size(); i > 0; --i) {
+            MediaBuffer *buffer = freeBuffers[i - 1];
+            // a buffer may still be referenced remotely, or have been acquired by a scan
+            if (buffer->refcount() == 0 && buffer->size() >= requestedSize) {
+                freeBuffers[i - 1] = freeBuffers.back();
+                freeBuffers.pop_back();
+                return buffer;
+            }
+        }
+    }
+    return nullptr;
+}
+
 }  // namespace android
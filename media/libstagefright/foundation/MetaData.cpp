@@ -45,14 +45,36 @@ void MetaData::clear() {
     mItems.clear();
 }
 
+size_t MetaData::lowerBound(uint32_t key) const {
+    size_t lo = 0;
+    size_t hi = mItems.size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (mItems[mid].mKey < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+ssize_t MetaData::indexOfKey(uint32_t key) const {
+    size_t i = lowerBound(key);
+    if (i < mItems.size() && mItems[i].mKey == key) {
+        return i;
+    }
+    return -1;
+}
+
 bool MetaData::remove(uint32_t key) {
-    ssize_t i = mItems.indexOfKey(key);
+    ssize_t i = indexOfKey(key);
 
     if (i < 0) {
         return false;
     }
 
-    mItems.removeItemsAt(i);
+    mItems.erase(mItems.begin() + i);
 
     return true;
 }
@@ -192,15 +214,15 @@ bool MetaData::setData(
         uint32_t key, uint32_t type, const void *data, size_t size) {
     bool overwrote_existing = true;
 
-    ssize_t i = mItems.indexOfKey(key);
-    if (i < 0) {
-        typed_data item;
-        i = mItems.add(key, item);
+    size_t i = lowerBound(key);
+    if (i == mItems.size() || mItems[i].mKey != key) {
+        mItems.emplace(mItems.begin() + i);
+        mItems[i].mKey = key;
 
         overwrote_existing = false;
     }
 
-    typed_data &item = mItems.editValueAt(i);
+    typed_data &item = mItems[i].mData;
 
     item.setData(type, data, size);
 
@@ -209,13 +231,13 @@ bool MetaData::setData(
 
 bool MetaData::findData(uint32_t key, uint32_t *type,
                         const void **data, size_t *size) const {
-    ssize_t i = mItems.indexOfKey(key);
+    ssize_t i = indexOfKey(key);
 
     if (i < 0) {
         return false;
     }
 
-    const typed_data &item = mItems.valueAt(i);
+    const typed_data &item = mItems[i].mData;
 
     item.getData(type, data, size);
 
@@ -223,7 +245,7 @@ bool MetaData::findData(uint32_t key, uint32_t *type,
 }
 
 bool MetaData::hasData(uint32_t key) const {
-    ssize_t i = mItems.indexOfKey(key);
+    ssize_t i = indexOfKey(key);
 
     if (i < 0) {
         return false;
@@ -251,6 +273,28 @@ MetaData::typed_data::typed_data(const typed_data &from)
     }
 }
 
+MetaData::typed_data::typed_data(typed_data &&from) noexcept
+    : mType(from.mType),
+      mSize(from.mSize),
+      u(from.u) {
+    from.mType = 0;
+    from.mSize = 0;
+}
+
+MetaData::typed_data &MetaData::typed_data::operator=(
+        MetaData::typed_data &&from) noexcept {
+    if (this != &from) {
+        clear();
+        mType = from.mType;
+        mSize = from.mSize;
+        u = from.u;
+        from.mType = 0;
+        from.mSize = 0;
+    }
+
+    return *this;
+}
+
 MetaData::typed_data &MetaData::typed_data::operator=(
         const MetaData::typed_data &from) {
     if (this != &from) {
@@ -273,6 +317,13 @@ void MetaData::typed_data::clear() {
 
 void MetaData::typed_data::setData(
         uint32_t type, const void *data, size_t size) {
+    // an external buffer of the same size, as for a per-frame value, is reused
+    if (size == mSize && !usesReservoir()) {
+        mType = type;
+        memcpy(u.ext_data, data, size);
+        return;
+    }
+
     clear();
 
     mType = type;
@@ -370,10 +421,10 @@ static void MakeFourCCString(uint32_t x, char *s) {
 String8 MetaData::toString() const {
     String8 s;
     for (int i = mItems.size(); --i >= 0;) {
-        int32_t key = mItems.keyAt(i);
+        int32_t key = mItems[i].mKey;
         char cc[5];
         MakeFourCCString(key, cc);
-        const typed_data &item = mItems.valueAt(i);
+        const typed_data &item = mItems[i].mData;
         s.appendFormat("%s: %s", cc, item.asString(false).string());
         if (i != 0) {
             s.append(", ");
@@ -383,10 +434,10 @@ String8 MetaData::toString() const {
 }
 void MetaData::dumpToLog() const {
     for (int i = mItems.size(); --i >= 0;) {
-        int32_t key = mItems.keyAt(i);
+        int32_t key = mItems[i].mKey;
         char cc[5];
         MakeFourCCString(key, cc);
-        const typed_data &item = mItems.valueAt(i);
+        const typed_data &item = mItems[i].mData;
         ALOGI("%s: %s", cc, item.asString(true /* verbose */).string());
     }
 }
@@ -399,8 +450,8 @@ status_t MetaData::writeToParcel(Parcel &parcel) {
         return ret;
     }
     for (size_t i = 0; i < numItems; i++) {
-        int32_t key = mItems.keyAt(i);
-        const typed_data &item = mItems.valueAt(i);
+        int32_t key = mItems[i].mKey;
+        const typed_data &item = mItems[i].mData;
         uint32_t type;
         const void *data;
         size_t size;
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "AdaptationPolicy"
+#include <utils/Log.h>
+
+#include "AdaptationPolicy.h"
+
+#include <cutils/properties.h>
+#include <math.h>
+#include <string.h>
+
+namespace android {
+
+// static
+size_t AdaptationPolicy::getIndexForBandwidth(
+        const Vector<Variant> &variants, int32_t bandwidthBps) {
+    size_t lowestIndex = 0;
+    while (lowestIndex + 1 < variants.size() && !variants[lowestIndex].mValid) {
+        ++lowestIndex;
+    }
+
+    size_t index = variants.size() - 1;
+    while (index > lowestIndex) {
+        const Variant &variant = variants[index];
+        if (variant.mBandwidthBps <= bandwidthBps && variant.mValid) {
+            break;
+        }
+        --index;
+    }
+    return index;
+}
+
+// static
+size_t AdaptationPolicy::selectByThroughput(
+        const Vector<Variant> &variants, const State &state) {
+    int32_t curBandwidthBps = variants[state.mCurrentIndex].mBandwidthBps;
+    bool canSwitchDown = state.mBufferLow && state.mBandwidthBps < curBandwidthBps;
+    bool canSwitchUp = state.mBufferHigh
+            && state.mBandwidthBps > (int64_t)curBandwidthBps * 12 / 10;
+    if (!canSwitchDown && !canSwitchUp) {
+        return state.mCurrentIndex;
+    }
+
+    // bandwidth estimating has some delay, if we have to downswitch when
+    // it hasn't stabilized, use the short term to guess real bandwidth,
+    // since it may be dropping too fast.
+    int32_t bandwidthBps = state.mBandwidthBps;
+    if (canSwitchDown && !state.mBandwidthStable && state.mShortTermBps < bandwidthBps) {
+        bandwidthBps = state.mShortTermBps;
+    }
+
+    size_t index = getIndexForBandwidth(variants, (int64_t)bandwidthBps * 7 / 10);
+    if ((canSwitchUp && index > state.mCurrentIndex)
+            || (canSwitchDown && index < state.mCurrentIndex)) {
+        return index;
+    }
+    return state.mCurrentIndex;
+}
+
+// The policy LiveSession has always used, driven by the bandwidth estimate.
+struct ThroughputPolicy : public AdaptationPolicy {
+    ThroughputPolicy() {}
+
+    virtual const char *name() const {
+        return "throughput";
+    }
+
+    virtual size_t selectVariant(const Vector<Variant> &variants, const State &state) {
+        return selectByThroughput(variants, state);
+    }
+
+private:
+    DISALLOW_EVIL_CONSTRUCTORS(ThroughputPolicy);
+};
+
+// Picks the variant from the buffer level with BOLA (Spiteri et al., "BOLA: Near-Optimal
+// Bitrate Adaptation for Online Videos"): the variant maximizing
+//     (V * (utility + gamma) - buffer) / bitrate
+// where the utility is the log of the bitrate. V and gamma are set so that the lowest
+// variant is picked at the minimum buffer, and the highest at the target buffer.
+//
+// At startup and below the minimum buffer, the throughput policy picks. Above it, the
+// variant is never switched up beyond what the bandwidth estimate sustains, nor down
+// below it, so the buffer level only decides within what the bandwidth allows.
+struct HybridPolicy : public AdaptationPolicy {
+    HybridPolicy() {}
+
+    virtual const char *name() const {
+        return "hybrid";
+    }
+
+    virtual size_t selectVariant(const Vector<Variant> &variants, const State &state);
+
+private:
+    static const int64_t kMaxTargetBufferUs = 25000000ll;
+    static const int64_t kMinTargetBufferSegments = 3;
+
+    // Returns the variant with the best score for |bufferedS| seconds of buffer.
+    static size_t selectForBuffer(
+            const Vector<Variant> &variants,
+            double minBufferS, double targetBufferS, double bufferedS);
+
+    DISALLOW_EVIL_CONSTRUCTORS(HybridPolicy);
+};
+
+size_t HybridPolicy::selectVariant(const Vector<Variant> &variants, const State &state) {
+    if (state.mSegmentDurationUs <= 0) {
+        return selectByThroughput(variants, state);
+    }
+
+    // live playlists only hold a few segments ahead, scale the buffer targets to them
+    int64_t targetBufferUs = state.mSegmentDurationUs * kMinTargetBufferSegments;
+    if (targetBufferUs > kMaxTargetBufferUs) {
+        targetBufferUs = kMaxTargetBufferUs;
+    }
+    int64_t minBufferUs = targetBufferUs * 2 / 5;
+    if (state.mPreparing || state.mBufferedDurationUs < minBufferUs) {
+        return selectByThroughput(variants, state);
+    }
+
+    int32_t bandwidthBps = state.mBandwidthBps;
+    if (!state.mBandwidthStable && state.mShortTermBps < bandwidthBps) {
+        bandwidthBps = state.mShortTermBps;
+    }
+    size_t throughputIndex = getIndexForBandwidth(variants, (int64_t)bandwidthBps * 7 / 10);
+
+    double minBufferS = minBufferUs / 1E6;
+    double targetBufferS = targetBufferUs / 1E6;
+    double bufferedS = state.mBufferedDurationUs / 1E6;
+    size_t index = selectForBuffer(variants, minBufferS, targetBufferS, bufferedS);
+    if (index > state.mCurrentIndex) {
+        // The buffer grows by a segment at a time, only switch up if the variant still
+        // wins with half a segment less, so that the variant does not flip back and forth.
+        size_t upIndex = selectForBuffer(variants, minBufferS, targetBufferS,
+                bufferedS - state.mSegmentDurationUs / 2E6);
+        index = upIndex > state.mCurrentIndex ? upIndex : state.mCurrentIndex;
+
+        // do not switch up beyond what the bandwidth sustains
+        if (index > throughputIndex) {
+            index = throughputIndex > state.mCurrentIndex
+                    ? throughputIndex : state.mCurrentIndex;
+        }
+    } else if (index < state.mCurrentIndex) {
+        // only follow the buffer down as far as the bandwidth requires
+        size_t floorIndex = throughputIndex < state.mCurrentIndex
+                ? throughputIndex : state.mCurrentIndex;
+        if (index < floorIndex) {
+            index = floorIndex;
+        }
+    }
+    return index;
+}
+
+// static
+size_t HybridPolicy::selectForBuffer(
+        const Vector<Variant> &variants,
+        double minBufferS, double targetBufferS, double bufferedS) {
+    ssize_t lowestIndex = -1;
+    ssize_t highestIndex = -1;
+    for (size_t i = 0; i < variants.size(); ++i) {
+        if (variants[i].mValid && variants[i].mAverageBandwidthBps > 0) {
+            if (lowestIndex < 0) {
+                lowestIndex = i;
+            }
+            highestIndex = i;
+        }
+    }
+    if (lowestIndex < 0) {
+        return 0;
+    }
+    if (lowestIndex == highestIndex
+            || variants[highestIndex].mAverageBandwidthBps
+                    <= variants[lowestIndex].mAverageBandwidthBps) {
+        return lowestIndex;
+    }
+
+    // utilities are shifted so that the lowest variant has a utility of 1
+    double lowestBps = variants[lowestIndex].mAverageBandwidthBps;
+    double highestUtility = log(variants[highestIndex].mAverageBandwidthBps / lowestBps) + 1;
+    double gamma = (highestUtility - 1) / (targetBufferS / minBufferS - 1);
+    double v = minBufferS / gamma;
+
+    size_t bestIndex = lowestIndex;
+    double bestScore = 0;
+    for (size_t i = lowestIndex; i <= (size_t)highestIndex; ++i) {
+        const Variant &variant = variants[i];
+        if (!variant.mValid || variant.mAverageBandwidthBps <= 0) {
+            continue;
+        }
+        double bps = variant.mAverageBandwidthBps;
+        double utility = log(bps / lowestBps) + 1;
+        double score = (v * (utility + gamma) - bufferedS) / bps;
+        if (i == (size_t)lowestIndex || score >= bestScore) {
+            bestIndex = i;
+            bestScore = score;
+        }
+    }
+    return bestIndex;
+}
+
+// static
+sp<AdaptationPolicy> AdaptationPolicy::Create() {
+    char value[PROPERTY_VALUE_MAX];
+    if (property_get("media.httplive.abr", value, NULL) && !strcmp(value, "throughput")) {
+        return new ThroughputPolicy;
+    }
+    return new HybridPolicy;
+}
+
+}  // namespace android
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ADAPTATION_POLICY_H_
+
+#define ADAPTATION_POLICY_H_
+
+#include <media/stagefright/foundation/ABase.h>
+#include <utils/RefBase.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+// Picks the variant of a HLS stream that LiveSession fetches next.
+struct AdaptationPolicy : public RefBase {
+    struct Variant {
+        int32_t mBandwidthBps;          // peak bandwidth declared by the master playlist
+        int32_t mAverageBandwidthBps;   // average bandwidth, the peak if not declared
+        bool mValid;                    // not blacklisted after a failure
+    };
+
+    struct State {
+        size_t mCurrentIndex;
+        int32_t mBandwidthBps;          // long term estimate
+        int32_t mShortTermBps;
+        bool mBandwidthStable;
+        int64_t mBufferedDurationUs;    // the lowest of the audio and video buffers
+        int64_t mSegmentDurationUs;     // target duration of the playlist
+        bool mBufferHigh;               // enough buffered to switch up
+        bool mBufferLow;                // few enough buffered to switch down
+        bool mPreparing;
+    };
+
+    virtual const char *name() const = 0;
+
+    // |variants| are sorted by bandwidth. Returns the index of the variant to fetch,
+    // mCurrentIndex to stay.
+    virtual size_t selectVariant(const Vector<Variant> &variants, const State &state) = 0;
+
+    // Creates the policy named by media.httplive.abr, "hybrid" (default) or "throughput".
+    static sp<AdaptationPolicy> Create();
+
+protected:
+    AdaptationPolicy() {}
+    virtual ~AdaptationPolicy() {}
+
+    // Returns the highest valid variant that fits in |bandwidthBps|, or the lowest valid one.
+    static size_t getIndexForBandwidth(const Vector<Variant> &variants, int32_t bandwidthBps);
+
+    // Switches down when the buffer is low and the bandwidth does not sustain the current
+    // variant, and up when the buffer is high and the bandwidth exceeds it by 20%. Only
+    // 70% of the estimate is used, to avoid overestimating and switching down again.
+    static size_t selectByThroughput(const Vector<Variant> &variants, const State &state);
+
+private:
+    DISALLOW_EVIL_CONSTRUCTORS(AdaptationPolicy);
+};
+
+}  // namespace android
+
+#endif  // ADAPTATION_POLICY_H_
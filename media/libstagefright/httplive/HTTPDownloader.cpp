@@ -20,6 +20,7 @@
 
 #include "HTTPDownloader.h"
 #include "M3UParser.h"
+#include <cutils/properties.h>
 
 #include <media/IMediaHTTPConnection.h>
 #include <media/IMediaHTTPService.h>
@@ -35,12 +36,20 @@
 
 namespace android {
 
+static inline bool getPipelineRangesSetting() {
+    return property_get_bool("media.httplive.pipeline-ranges", true);
+}
+
 HTTPDownloader::HTTPDownloader(
         const sp<IMediaHTTPService> &httpService,
         const KeyedVector<String8, String8> &headers) :
     mHTTPDataSource(new MediaHTTP(httpService->makeHTTPConnection())),
     mExtraHeaders(headers),
-    mDisconnecting(false) {
+    mDisconnecting(false),
+    mPipelineRanges(getPipelineRangesSetting()),
+    mPipelineStartOffset(0ll),
+    mPipelineNextOffset(-1ll),
+    mReadOffset(0ll) {
 }
 
 void HTTPDownloader::reconnect() {
@@ -52,6 +61,7 @@ void HTTPDownloader::disconnect() {
     {
         AutoMutex _l(mLock);
         mDisconnecting = true;
+        mPipelineNextOffset = -1ll;
     }
     mHTTPDataSource->disconnect();
 }
@@ -88,42 +98,71 @@ ssize_t HTTPDownloader::fetchBlock(
     }
 
     off64_t size;
+    int64_t requested_length = range_length;
+    bool pipelined = false;     // reading off an open-ended range request
+    bool continued = false;     // ... that was opened for an earlier range
 
     if (reconnect) {
         if (!strncasecmp(url, "file://", 7)) {
             mDataSource = new FileSource(url + 7);
+            mPipelineURL.clear();
         } else if (strncasecmp(url, "http://", 7)
                 && strncasecmp(url, "https://", 8)) {
             return ERROR_UNSUPPORTED;
         } else {
-            KeyedVector<String8, String8> headers = mExtraHeaders;
-            if (range_offset > 0 || range_length >= 0) {
-                headers.add(
-                        String8("Range"),
-                        String8(
-                            AStringPrintf(
-                                "bytes=%lld-%s",
-                                range_offset,
-                                range_length < 0
-                                    ? "" : AStringPrintf("%lld",
-                                            range_offset + range_length - 1).c_str()).c_str()));
+            pipelined = mPipelineRanges && range_length >= 0;
+            if (pipelined) {
+                AutoMutex _l(mLock);
+                continued = mPipelineNextOffset == range_offset && mPipelineURL == url;
             }
 
-            status_t err = mHTTPDataSource->connect(url, &headers);
+            if (!continued) {
+                KeyedVector<String8, String8> headers = mExtraHeaders;
+                if (range_offset > 0 || range_length >= 0) {
+                    headers.add(
+                            String8("Range"),
+                            String8(
+                                AStringPrintf(
+                                    "bytes=%lld-%s",
+                                    range_offset,
+                                    range_length < 0 || pipelined
+                                        ? "" : AStringPrintf("%lld",
+                                                range_offset + range_length - 1).c_str()).c_str()));
+                }
 
-            if (isDisconnecting()) {
-                return ERROR_NOT_CONNECTED;
-            }
+                status_t err = mHTTPDataSource->connect(url, &headers);
 
-            if (err != OK) {
-                return err;
+                if (isDisconnecting()) {
+                    return ERROR_NOT_CONNECTED;
+                }
+
+                if (err != OK) {
+                    return err;
+                }
+
+                mPipelineURL = pipelined ? url : "";
+                mPipelineStartOffset = range_offset;
             }
 
             mDataSource = mHTTPDataSource;
         }
+
+        {
+            AutoMutex _l(mLock);
+            mPipelineNextOffset = -1ll;
+        }
+        mReadOffset = continued ? range_offset - mPipelineStartOffset : 0ll;
+    } else {
+        pipelined = !mPipelineURL.empty();
     }
 
-    status_t getSizeErr = mDataSource->getSize(&size);
+    // an open-ended request reports the size of the rest of the file
+    status_t getSizeErr = OK;
+    if (pipelined) {
+        size = requested_length;
+    } else {
+        getSizeErr = mDataSource->getSize(&size);
+    }
 
     if (isDisconnecting()) {
         return ERROR_NOT_CONNECTED;
@@ -181,13 +220,22 @@ ssize_t HTTPDownloader::fetchBlock(
         // The DataSource is responsible for informing us of error (n < 0) or eof (n == 0)
         // to help us break out of the loop.
         ssize_t n = mDataSource->readAt(
-                buffer->size(), buffer->data() + buffer->size(),
+                mReadOffset + buffer->size(), buffer->data() + buffer->size(),
                 maxBytesToRead);
 
         if (isDisconnecting()) {
             return ERROR_NOT_CONNECTED;
         }
 
+        if (n < 0 && continued && bytesRead == 0) {
+            // the server may have dropped the request while it was idle
+            ALOGV("continuing range request failed (%zd), requesting the range", n);
+            mPipelineURL.clear();
+            return fetchBlock(
+                    url, out, range_offset, requested_length, block_size, actualUrl,
+                    true /* reconnect */);
+        }
+
         if (n < 0) {
             return n;
         }
@@ -200,6 +248,13 @@ ssize_t HTTPDownloader::fetchBlock(
         bytesRead += n;
     }
 
+    if (pipelined) {
+        AutoMutex _l(mLock);
+        if (!mDisconnecting) {
+            mPipelineNextOffset = range_offset + buffer->size();
+        }
+    }
+
     *out = buffer;
     if (actualUrl != NULL) {
         *actualUrl = mDataSource->getUri();
@@ -222,7 +277,8 @@ ssize_t HTTPDownloader::fetchFile(
 }
 
 sp<M3UParser> HTTPDownloader::fetchPlaylist(
-        const char *url, uint8_t *curPlaylistHash, bool *unchanged) {
+        const char *url, uint8_t *curPlaylistHash, bool *unchanged,
+        const sp<M3UParser> &previous) {
     ALOGV("fetchPlaylist '%s'", url);
 
     *unchanged = false;
@@ -263,7 +319,7 @@ sp<M3UParser> HTTPDownloader::fetchPlaylist(
 #endif
 
     sp<M3UParser> playlist =
-        new M3UParser(actualUrl.string(), buffer->data(), buffer->size());
+        new M3UParser(actualUrl.string(), buffer->data(), buffer->size(), previous);
 
     if (playlist->initCheck() != OK) {
         ALOGE("failed to parse .m3u8 playlist");
@@ -19,6 +19,7 @@
 #define HTTP_DOWNLOADER_H_
 
 #include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/AString.h>
 #include <utils/KeyedVector.h>
 #include <utils/Mutex.h>
 #include <utils/RefBase.h>
@@ -50,6 +51,10 @@ struct HTTPDownloader : public RefBase {
     //
     // For reused HTTP sources, the caller must download a file sequentially without
     // any overlaps or gaps to prevent reconnection.
+    //
+    // Byte ranges are requested open-ended, so that a range of the same file starting
+    // where the previous one ended is read off the same request instead of connecting
+    // again. Set media.httplive.pipeline-ranges to false to request each range alone.
     ssize_t fetchBlock(
             const char *url,
             sp<ABuffer> *out,
@@ -66,9 +71,10 @@ struct HTTPDownloader : public RefBase {
             sp<ABuffer> *out,
             String8 *actualUrl = NULL);
 
-    // fetch a playlist file
+    // fetch a playlist file, sharing the segments still listed with |previous|
     sp<M3UParser> fetchPlaylist(
-            const char *url, uint8_t *curPlaylistHash, bool *unchanged);
+            const char *url, uint8_t *curPlaylistHash, bool *unchanged,
+            const sp<M3UParser> &previous = NULL);
 
 private:
     sp<HTTPBase> mHTTPDataSource;
@@ -78,6 +84,13 @@ private:
     Mutex mLock;
     bool mDisconnecting;
 
+    // the open-ended request consecutive byte ranges are read from
+    const bool mPipelineRanges;
+    AString mPipelineURL;
+    int64_t mPipelineStartOffset;   // file offset of the first byte of the request
+    int64_t mPipelineNextOffset;    // file offset the request continues at, -1 if none
+    int64_t mReadOffset;            // offset of the range read within the request
+
     DISALLOW_EVIL_CONSTRUCTORS(HTTPDownloader);
 };
 
@@ -288,6 +288,9 @@ LiveSession::LiveSession(
       mLastBandwidthBps(-1ll),
       mLastBandwidthStable(false),
       mBandwidthEstimator(new BandwidthEstimator()),
+      mAdaptationPolicy(AdaptationPolicy::Create()),
+      mTargetDurationUs(-1ll),
+      mBufferedDurationUs(-1ll),
       mMaxWidth(720),
       mMaxHeight(480),
       mStreamMask(0),
@@ -722,6 +725,7 @@ void LiveSession::onMessageReceived(const sp<AMessage> &msg) {
                     mUpSwitchMark = min(kUpSwitchMarkUs, targetDurationUs * 7 / 4);
                     mDownSwitchMark = min(kDownSwitchMarkUs, targetDurationUs * 9 / 4);
                     mUpSwitchMargin = min(kUpSwitchMarginUs, targetDurationUs);
+                    mTargetDurationUs = targetDurationUs;
                     break;
                 }
 
@@ -1050,6 +1054,10 @@ void LiveSession::onMasterPlaylistFetched(const sp<AMessage> &msg) {
             mPlaylist->itemAt(i, &uri, &meta);
 
             CHECK(meta->findInt32("bandwidth", (int32_t *)&item.mBandwidth));
+            if (!meta->findInt32("average-bandwidth", (int32_t *)&item.mAverageBandwidth)
+                    || item.mAverageBandwidth == 0) {
+                item.mAverageBandwidth = item.mBandwidth;
+            }
 
             int32_t width, height;
             if (meta->findInt32("width", &width)) {
@@ -1089,6 +1097,7 @@ void LiveSession::onMasterPlaylistFetched(const sp<AMessage> &msg) {
         BandwidthItem item;
         item.mPlaylistIndex = 0;
         item.mBandwidth = 0;
+        item.mAverageBandwidth = 0;
         mBandwidthItems.push(item);
     }
 
@@ -1325,7 +1334,7 @@ ssize_t LiveSession::getLowestValidBandwidthIndex() const {
     return 0;
 }
 
-size_t LiveSession::getBandwidthIndex(int32_t bandwidthBps) {
+size_t LiveSession::getBandwidthIndex(AdaptationPolicy::State *state) {
     if (mBandwidthItems.size() < 2) {
         // shouldn't be here if we only have 1 bandwidth, check
         // logic to get rid of redundant bandwidth polling
@@ -1352,29 +1361,27 @@ size_t LiveSession::getBandwidthIndex(int32_t bandwidthBps) {
             char *end;
             long maxBw = strtoul(value, &end, 10);
             if (end > value && *end == '\0') {
-                if (maxBw > 0 && bandwidthBps > maxBw) {
+                if (maxBw > 0 && state->mBandwidthBps > maxBw) {
                     ALOGV("bandwidth capped to %ld bps", maxBw);
-                    bandwidthBps = maxBw;
+                    state->mBandwidthBps = maxBw;
+                }
+                if (maxBw > 0 && state->mShortTermBps > maxBw) {
+                    state->mShortTermBps = maxBw;
                 }
             }
         }
 
-        // Pick the highest bandwidth stream that's not currently blacklisted
-        // below or equal to estimated bandwidth.
-
-        index = mBandwidthItems.size() - 1;
-        ssize_t lowestBandwidth = getLowestValidBandwidthIndex();
-        while (index > lowestBandwidth) {
-            // be conservative (70%) to avoid overestimating and immediately
-            // switching down again.
-            size_t adjustedBandwidthBps = bandwidthBps * 7 / 10;
-            const BandwidthItem &item = mBandwidthItems[index];
-            if (item.mBandwidth <= adjustedBandwidthBps
-                    && isBandwidthValid(item)) {
-                break;
-            }
-            --index;
+        // Let the policy pick among the streams that are not currently blacklisted.
+        Vector<AdaptationPolicy::Variant> variants;
+        for (size_t i = 0; i < mBandwidthItems.size(); ++i) {
+            const BandwidthItem &item = mBandwidthItems[i];
+            AdaptationPolicy::Variant variant;
+            variant.mBandwidthBps = item.mBandwidth;
+            variant.mAverageBandwidthBps = item.mAverageBandwidth;
+            variant.mValid = isBandwidthValid(item);
+            variants.push(variant);
         }
+        index = mAdaptationPolicy->selectVariant(variants, *state);
     }
 #elif 0
     // Change bandwidth at random()
@@ -2148,6 +2155,7 @@ bool LiveSession::checkBuffering(
     size_t activeCount, underflowCount, readyCount, downCount, upCount;
     activeCount = underflowCount = readyCount = downCount = upCount =0;
     int32_t minBufferPercent = -1;
+    int64_t minBufferedDurationUs = -1ll;
     int64_t durationUs;
     if (getDuration(&durationUs) != OK) {
         durationUs = -1;
@@ -2191,6 +2199,9 @@ bool LiveSession::checkBuffering(
             ++readyCount;
         }
         if (!mPacketSources[i]->isFinished(0)) {
+            if (minBufferedDurationUs < 0 || bufferedDurationUs < minBufferedDurationUs) {
+                minBufferedDurationUs = bufferedDurationUs;
+            }
             if (bufferedDurationUs < kUnderflowMarkUs) {
                 ++underflowCount;
             }
@@ -2206,6 +2217,7 @@ bool LiveSession::checkBuffering(
     if (minBufferPercent >= 0) {
         notifyBufferingUpdate(minBufferPercent);
     }
+    mBufferedDurationUs = minBufferedDurationUs;
 
     if (activeCount > 0) {
         up        = (upCount == activeCount);
@@ -2316,42 +2328,47 @@ bool LiveSession::switchBandwidthIfNeeded(bool bufferHigh, bool bufferLow) {
         return false;
     }
 
-    int32_t curBandwidth = mBandwidthItems.itemAt(mCurBandwidthIndex).mBandwidth;
-    // canSwithDown and canSwitchUp can't both be true.
-    // we only want to switch up when measured bw is 120% higher than current variant,
-    // and we only want to switch down when measured bw is below current variant.
-    bool canSwitchDown = bufferLow
-            && (bandwidthBps < (int32_t)curBandwidth);
-    bool canSwitchUp = bufferHigh
-            && (bandwidthBps > (int32_t)curBandwidth * 12 / 10);
-
-    if (canSwitchDown || canSwitchUp) {
-        // bandwidth estimating has some delay, if we have to downswitch when
-        // it hasn't stabilized, use the short term to guess real bandwidth,
-        // since it may be dropping too fast.
-        // (note this doesn't apply to upswitch, always use longer average there)
-        if (!isStable && canSwitchDown) {
-            if (shortTermBps < bandwidthBps) {
-                bandwidthBps = shortTermBps;
-            }
-        }
+    AdaptationPolicy::State state;
+    state.mCurrentIndex = mCurBandwidthIndex;
+    state.mBandwidthBps = bandwidthBps;
+    state.mShortTermBps = shortTermBps;
+    state.mBandwidthStable = isStable;
+    state.mBufferedDurationUs = mBufferedDurationUs;
+    state.mSegmentDurationUs = mTargetDurationUs;
+    state.mBufferHigh = bufferHigh;
+    state.mBufferLow = bufferLow;
+    state.mPreparing = mInPreparationPhase;
+
+    ssize_t bandwidthIndex = getBandwidthIndex(&state);
+    // while preparing, only switch down
+    if (bandwidthIndex > mCurBandwidthIndex && mInPreparationPhase) {
+        return false;
+    }
+    if (bandwidthIndex == mCurBandwidthIndex) {
+        return false;
+    }
 
-        ssize_t bandwidthIndex = getBandwidthIndex(bandwidthBps);
+    ALOGI("%s policy switches from %lu bps to %lu bps, "
+            "bandwidth %d bps, buffered %lld us",
+            mAdaptationPolicy->name(),
+            mBandwidthItems.itemAt(mCurBandwidthIndex).mBandwidth,
+            mBandwidthItems.itemAt(bandwidthIndex).mBandwidth,
+            state.mBandwidthBps, (long long)mBufferedDurationUs);
 
-        // it's possible that we're checking for canSwitchUp case, but the returned
-        // bandwidthIndex is < mCurBandwidthIndex, as getBandwidthIndex() only uses 70%
-        // of measured bw. In that case we don't want to do anything, since we have
-        // both enough buffer and enough bw.
-        if ((canSwitchUp && bandwidthIndex > mCurBandwidthIndex)
-         || (canSwitchDown && bandwidthIndex < mCurBandwidthIndex)) {
-            // if not yet prepared, just restart again with new bw index.
-            // this is faster and playback experience is cleaner.
-            changeConfiguration(
-                    mInPreparationPhase ? 0 : -1ll, bandwidthIndex);
-            return true;
-        }
-    }
-    return false;
+    sp<AMessage> notify = mNotify->dup();
+    notify->setInt32("what", kWhatBandwidthSwitch);
+    notify->setString("policy", mAdaptationPolicy->name());
+    notify->setInt32("from-bandwidth", mBandwidthItems.itemAt(mCurBandwidthIndex).mBandwidth);
+    notify->setInt32("to-bandwidth", mBandwidthItems.itemAt(bandwidthIndex).mBandwidth);
+    notify->setInt32("estimated-bandwidth", state.mBandwidthBps);
+    notify->setInt64("buffered-us", mBufferedDurationUs);
+    notify->post();
+
+    // if not yet prepared, just restart again with new bw index.
+    // this is faster and playback experience is cleaner.
+    changeConfiguration(
+            mInPreparationPhase ? 0 : -1ll, bandwidthIndex);
+    return true;
 }
 
 void LiveSession::postError(status_t err) {
@@ -23,6 +23,7 @@
 
 #include <utils/String8.h>
 
+#include "AdaptationPolicy.h"
 #include "mpeg2ts/ATSParser.h"
 
 namespace android {
@@ -110,6 +111,7 @@ struct LiveSession : public AHandler {
         kWhatBufferingEnd,
         kWhatBufferingUpdate,
         kWhatMetadataDetected,
+        kWhatBandwidthSwitch,
     };
 
 protected:
@@ -119,6 +121,7 @@ protected:
 
 private:
     friend struct PlaylistFetcher;
+    friend struct SegmentPrefetcher;
 
     enum {
         kWhatConnect                    = 'conn',
@@ -146,6 +149,7 @@ private:
     struct BandwidthItem {
         size_t mPlaylistIndex;
         unsigned long mBandwidth;
+        unsigned long mAverageBandwidth;
         int64_t mLastFailureUs;
     };
 
@@ -202,6 +206,9 @@ private:
     int32_t mLastBandwidthBps;
     bool mLastBandwidthStable;
     sp<BandwidthEstimator> mBandwidthEstimator;
+    sp<AdaptationPolicy> mAdaptationPolicy;
+    int64_t mTargetDurationUs;
+    int64_t mBufferedDurationUs;    // the lowest of the streams, at the last buffer poll
 
     sp<M3UParser> mPlaylist;
     int32_t mMaxWidth;
@@ -269,7 +276,7 @@ private:
     float getAbortThreshold(
             ssize_t currentBWIndex, ssize_t targetBWIndex) const;
     void addBandwidthMeasurement(size_t numBytes, int64_t delayUs);
-    size_t getBandwidthIndex(int32_t bandwidthBps);
+    size_t getBandwidthIndex(AdaptationPolicy::State *state);
     ssize_t getLowestValidBandwidthIndex() const;
     HLSTime latestMediaSegmentStartTime() const;
 
@@ -242,8 +242,34 @@ bool M3UParser::MediaGroup::getActiveURI(AString *uri) const {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// A segment of a media playlist. Segments are immutable once parsed, so that the
+// next parse of a live playlist can share the ones it still lists.
+struct M3UParser::Segment : public LightRefBase<Segment> {
+    Segment()
+        : mDurationUs(0ll),
+          mRangeOffset(0ll),
+          mRangeLength(-1ll),
+          mDiscontinuitySeq(0),
+          mDiscontinuity(false) {
+    }
+
+    AString mURI;
+    int64_t mDurationUs;
+    int64_t mRangeOffset;
+    int64_t mRangeLength;       // -1 for the whole file
+    int32_t mDiscontinuitySeq;
+    bool mDiscontinuity;
+    sp<AMessage> mCipherInfo;   // shared by the segments using the same key
+
+private:
+    DISALLOW_EVIL_CONSTRUCTORS(Segment);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 M3UParser::M3UParser(
-        const char *baseURI, const void *data, size_t size)
+        const char *baseURI, const void *data, size_t size,
+        const sp<M3UParser> &previous)
     : mInitCheck(NO_INIT),
       mBaseURI(baseURI),
       mIsExtM3U(false),
@@ -256,7 +282,35 @@ M3UParser::M3UParser(
       mDiscontinuitySeq(0),
       mDiscontinuityCount(0),
       mSelectedIndex(-1) {
-    mInitCheck = parse(data, size);
+    sp<M3UParser> reusable = previous;
+    if (reusable != NULL && (reusable->initCheck() != OK
+            || reusable->isVariantPlaylist() || reusable->mBaseURI != mBaseURI)) {
+        reusable.clear();
+    }
+
+    mInitCheck = parse(data, size, reusable);
+    if (mInitCheck == -EAGAIN) {
+        // the media sequence changed after segments were matched against it
+        ALOGW("media sequence declared after the first segment, parsing it all again");
+        reset();
+        mInitCheck = parse(data, size, NULL /* previous */);
+    }
+}
+
+void M3UParser::reset() {
+    mIsExtM3U = false;
+    mIsVariantPlaylist = false;
+    mIsComplete = false;
+    mIsEvent = false;
+    mFirstSeqNumber = -1;
+    mLastSeqNumber = -1;
+    mTargetDurationUs = -1ll;
+    mDiscontinuitySeq = 0;
+    mDiscontinuityCount = 0;
+    mMeta.clear();
+    mItems.clear();
+    mSegments.clear();
+    mMediaGroups.clear();
 }
 
 M3UParser::~M3UParser() {
@@ -304,7 +358,7 @@ sp<AMessage> M3UParser::meta() {
 }
 
 size_t M3UParser::size() {
-    return mItems.size();
+    return mIsVariantPlaylist ? mItems.size() : mSegments.size();
 }
 
 bool M3UParser::itemAt(size_t index, AString *uri, sp<AMessage> *meta) {
@@ -316,6 +370,33 @@ bool M3UParser::itemAt(size_t index, AString *uri, sp<AMessage> *meta) {
         *meta = NULL;
     }
 
+    if (!mIsVariantPlaylist) {
+        if (index >= mSegments.size()) {
+            return false;
+        }
+
+        const sp<Segment> &segment = mSegments.itemAt(index);
+        if (uri) {
+            *uri = segment->mURI;
+        }
+
+        if (meta) {
+            // the cipher info holds the cipher-* entries of the key
+            *meta = segment->mCipherInfo != NULL ? segment->mCipherInfo->dup() : new AMessage;
+            (*meta)->setInt64("durationUs", segment->mDurationUs);
+            (*meta)->setInt32("discontinuity-sequence", segment->mDiscontinuitySeq);
+            if (segment->mDiscontinuity) {
+                (*meta)->setInt32("discontinuity", true);
+            }
+            if (segment->mRangeLength >= 0) {
+                (*meta)->setInt64("range-offset", segment->mRangeOffset);
+                (*meta)->setInt64("range-length", segment->mRangeLength);
+            }
+        }
+
+        return true;
+    }
+
     if (index >= mItems.size()) {
         return false;
     }
@@ -331,6 +412,29 @@ bool M3UParser::itemAt(size_t index, AString *uri, sp<AMessage> *meta) {
     return true;
 }
 
+int64_t M3UParser::getItemDurationUs(size_t index) const {
+    CHECK(!mIsVariantPlaylist);
+    return mSegments.itemAt(index)->mDurationUs;
+}
+
+size_t M3UParser::getItemDiscontinuitySeq(size_t index) const {
+    CHECK(!mIsVariantPlaylist);
+    return mSegments.itemAt(index)->mDiscontinuitySeq;
+}
+
+sp<AMessage> M3UParser::getItemCipherInfo(size_t index) const {
+    CHECK(!mIsVariantPlaylist);
+    return mSegments.itemAt(index)->mCipherInfo;
+}
+
+sp<M3UParser::Segment> M3UParser::findSegment(int32_t seqNumber) const {
+    if (mIsVariantPlaylist || seqNumber < mFirstSeqNumber
+            || seqNumber > mLastSeqNumber) {
+        return NULL;
+    }
+    return mSegments.itemAt(seqNumber - mFirstSeqNumber);
+}
+
 void M3UParser::pickRandomMediaItems() {
     for (size_t i = 0; i < mMediaGroups.size(); ++i) {
         mMediaGroups.valueAt(i)->pickRandomMediaItems();
@@ -544,11 +648,27 @@ static bool MakeURL(const char *baseURL, const char *url, AString *out) {
     return true;
 }
 
-status_t M3UParser::parse(const void *_data, size_t size) {
+status_t M3UParser::parse(
+        const void *_data, size_t size, const sp<M3UParser> &previous) {
     int32_t lineNo = 0;
 
     sp<AMessage> itemMeta;
 
+    // the tags of the next segment of a media playlist
+    bool hasDuration = false;
+    int64_t durationUs = 0ll;
+    bool discontinuity = false;
+    int64_t rangeOffset = 0ll;
+    int64_t rangeLength = -1ll;
+    sp<AMessage> cipherInfo;
+
+    // The segments of |previous| are matched by sequence number, which a media sequence
+    // declared after the first segment would renumber.
+    int32_t firstSeqNumber = 0;
+    bool canShareSegments = (previous != NULL);
+    size_t numSharedSegments = 0;
+    sp<AMessage> sharedCipherInfo;  // the previous key found equal to |cipherInfo|
+
     const char *data = (const char *)_data;
     size_t offset = 0;
     uint64_t segmentRangeOffset = 0;
@@ -588,12 +708,24 @@ status_t M3UParser::parse(const void *_data, size_t size) {
                 if (mIsVariantPlaylist) {
                     return ERROR_MALFORMED;
                 }
+                if (!mSegments.isEmpty()) {
+                    if (numSharedSegments > 0) {
+                        return -EAGAIN;
+                    }
+                    canShareSegments = false;
+                }
                 err = parseMetaData(line, &mMeta, "media-sequence");
+                if (err == OK) {
+                    CHECK(mMeta->findInt32("media-sequence", &firstSeqNumber));
+                }
             } else if (line.startsWith("#EXT-X-KEY")) {
                 if (mIsVariantPlaylist) {
                     return ERROR_MALFORMED;
                 }
-                err = parseCipherInfo(line, &itemMeta, mBaseURI);
+                // the key applies to the segments up to the next one
+                cipherInfo.clear();
+                sharedCipherInfo.clear();
+                err = parseCipherInfo(line, &cipherInfo, mBaseURI);
             } else if (line.startsWith("#EXT-X-ENDLIST")) {
                 mIsComplete = true;
             } else if (line.startsWith("#EXT-X-PLAYLIST-TYPE:EVENT")) {
@@ -602,7 +734,8 @@ status_t M3UParser::parse(const void *_data, size_t size) {
                 if (mIsVariantPlaylist) {
                     return ERROR_MALFORMED;
                 }
-                err = parseMetaDataDuration(line, &itemMeta, "durationUs");
+                err = parseMetaDataDuration(line, &durationUs);
+                hasDuration = (err == OK);
             } else if (line.startsWith("#EXT-X-DISCONTINUITY-SEQUENCE")) {
                 if (mIsVariantPlaylist) {
                     return ERROR_MALFORMED;
@@ -619,13 +752,10 @@ status_t M3UParser::parse(const void *_data, size_t size) {
                 if (mIsVariantPlaylist) {
                     return ERROR_MALFORMED;
                 }
-                if (itemMeta == NULL) {
-                    itemMeta = new AMessage;
-                }
-                itemMeta->setInt32("discontinuity", true);
+                discontinuity = true;
                 ++mDiscontinuityCount;
             } else if (line.startsWith("#EXT-X-STREAM-INF")) {
-                if (mMeta != NULL) {
+                if (mMeta != NULL || !mSegments.isEmpty()) {
                     return ERROR_MALFORMED;
                 }
                 mIsVariantPlaylist = true;
@@ -639,12 +769,8 @@ status_t M3UParser::parse(const void *_data, size_t size) {
                 err = parseByteRange(line, segmentRangeOffset, &length, &offset);
 
                 if (err == OK) {
-                    if (itemMeta == NULL) {
-                        itemMeta = new AMessage;
-                    }
-
-                    itemMeta->setInt64("range-offset", offset);
-                    itemMeta->setInt64("range-length", length);
+                    rangeOffset = offset;
+                    rangeLength = length;
 
                     segmentRangeOffset = offset + length;
                 }
@@ -658,24 +784,63 @@ status_t M3UParser::parse(const void *_data, size_t size) {
         }
 
         if (!line.startsWith("#")) {
-            if (!mIsVariantPlaylist) {
-                int64_t durationUs;
-                if (itemMeta == NULL
-                        || !itemMeta->findInt64("durationUs", &durationUs)) {
-                    return ERROR_MALFORMED;
-                }
-                itemMeta->setInt32("discontinuity-sequence",
-                        mDiscontinuitySeq + mDiscontinuityCount);
-            }
+            if (mIsVariantPlaylist) {
+                mItems.push();
+                Item *item = &mItems.editItemAt(mItems.size() - 1);
 
-            mItems.push();
-            Item *item = &mItems.editItemAt(mItems.size() - 1);
+                CHECK(MakeURL(mBaseURI.c_str(), line.c_str(), &item->mURI));
 
-            CHECK(MakeURL(mBaseURI.c_str(), line.c_str(), &item->mURI));
+                item->mMeta = itemMeta;
 
-            item->mMeta = itemMeta;
+                itemMeta.clear();
+            } else {
+                if (!hasDuration) {
+                    return ERROR_MALFORMED;
+                }
+                int32_t discontinuitySeq = mDiscontinuitySeq + mDiscontinuityCount;
+
+                // A segment keeps its media sequence number while the live window moves
+                // over it, skip resolving and allocating the ones parsed already.
+                sp<Segment> segment;
+                if (canShareSegments) {
+                    segment = previous->findSegment(firstSeqNumber + mSegments.size());
+                    if (segment != NULL && (segment->mDurationUs != durationUs
+                            || segment->mDiscontinuity != discontinuity
+                            || segment->mDiscontinuitySeq != discontinuitySeq
+                            || segment->mRangeOffset != rangeOffset
+                            || segment->mRangeLength != rangeLength)) {
+                        segment.clear();
+                    }
+                    if (segment != NULL && segment->mCipherInfo != cipherInfo
+                            && (sharedCipherInfo == NULL
+                                    || segment->mCipherInfo != sharedCipherInfo)) {
+                        if (isSameCipherInfo(segment->mCipherInfo, cipherInfo)) {
+                            sharedCipherInfo = segment->mCipherInfo;
+                        } else {
+                            segment.clear();
+                        }
+                    }
+                }
 
-            itemMeta.clear();
+                if (segment != NULL) {
+                    ++numSharedSegments;
+                } else {
+                    segment = new Segment;
+                    CHECK(MakeURL(mBaseURI.c_str(), line.c_str(), &segment->mURI));
+                    segment->mDurationUs = durationUs;
+                    segment->mRangeOffset = rangeOffset;
+                    segment->mRangeLength = rangeLength;
+                    segment->mDiscontinuitySeq = discontinuitySeq;
+                    segment->mDiscontinuity = discontinuity;
+                    segment->mCipherInfo = cipherInfo;
+                }
+                mSegments.push_back(segment);
+
+                hasDuration = false;
+                discontinuity = false;
+                rangeOffset = 0ll;
+                rangeLength = -1ll;
+            }
         }
 
         offset = offsetLF + 1;
@@ -698,7 +863,10 @@ status_t M3UParser::parse(const void *_data, size_t size) {
         if (mMeta != NULL) {
             mMeta->findInt32("media-sequence", &mFirstSeqNumber);
         }
-        mLastSeqNumber = mFirstSeqNumber + mItems.size() - 1;
+        mLastSeqNumber = mFirstSeqNumber + mSegments.size() - 1;
+
+        ALOGV("%zu segments, %zu shared with the previous playlist",
+                mSegments.size(), numSharedSegments);
     }
 
     for (size_t i = 0; i < mItems.size(); ++i) {
@@ -745,8 +913,7 @@ status_t M3UParser::parseMetaData(
 }
 
 // static
-status_t M3UParser::parseMetaDataDuration(
-        const AString &line, sp<AMessage> *meta, const char *key) {
+status_t M3UParser::parseMetaDataDuration(const AString &line, int64_t *durationUs) {
     ssize_t colonPos = line.find(":");
 
     if (colonPos < 0) {
@@ -760,10 +927,7 @@ status_t M3UParser::parseMetaDataDuration(
         return err;
     }
 
-    if (meta->get() == NULL) {
-        *meta = new AMessage;
-    }
-    (*meta)->setInt64(key, (int64_t)(x * 1E6));
+    *durationUs = (int64_t)(x * 1E6);
 
     return OK;
 }
@@ -839,6 +1003,20 @@ status_t M3UParser::parseStreamInf(
                 *meta = new AMessage;
             }
             (*meta)->setInt32("bandwidth", x);
+        } else if (!strcasecmp("average-bandwidth", key.c_str())) {
+            const char *s = val.c_str();
+            char *end;
+            unsigned long x = strtoul(s, &end, 10);
+
+            if (end == s || *end != '\0') {
+                // malformed
+                continue;
+            }
+
+            if (meta->get() == NULL) {
+                *meta = new AMessage;
+            }
+            (*meta)->setInt32("average-bandwidth", x);
         } else if (!strcasecmp("codecs", key.c_str())) {
             if (!isQuotedString(val)) {
                 ALOGE("Expected quoted string for %s attribute, "
@@ -969,6 +1147,24 @@ status_t M3UParser::parseCipherInfo(
     return OK;
 }
 
+// static
+bool M3UParser::isSameCipherInfo(const sp<AMessage> &a, const sp<AMessage> &b) {
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+
+    const char *keys[] = {"cipher-method", "cipher-uri", "cipher-iv"};
+    for (size_t i = 0; i < sizeof(keys) / sizeof(const char *); ++i) {
+        AString valueA, valueB;
+        bool hasA = a->findString(keys[i], &valueA);
+        bool hasB = b->findString(keys[i], &valueB);
+        if (hasA != hasB || valueA != valueB) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // static
 status_t M3UParser::parseByteRange(
         const AString &line, uint64_t curOffset,
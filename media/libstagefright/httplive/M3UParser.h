@@ -27,7 +27,11 @@
 namespace android {
 
 struct M3UParser : public RefBase {
-    M3UParser(const char *baseURI, const void *data, size_t size);
+    // If |previous| is the last parse of the same media playlist, the segments it
+    // already holds are shared instead of parsed again, only new ones are added.
+    M3UParser(
+            const char *baseURI, const void *data, size_t size,
+            const sp<M3UParser> &previous = NULL);
 
     status_t initCheck() const;
 
@@ -45,6 +49,12 @@ struct M3UParser : public RefBase {
     size_t size();
     bool itemAt(size_t index, AString *uri, sp<AMessage> *meta = NULL);
 
+    // The segments of a media playlist are stored compactly, and itemAt() builds their
+    // meta on each call. These read single fields without it.
+    int64_t getItemDurationUs(size_t index) const;
+    size_t getItemDiscontinuitySeq(size_t index) const;
+    sp<AMessage> getItemCipherInfo(size_t index) const;  // the key in effect, or NULL
+
     void pickRandomMediaItems();
     status_t selectTrack(size_t index, bool select);
     size_t getTrackCount() const;
@@ -60,7 +70,9 @@ protected:
 
 private:
     struct MediaGroup;
+    struct Segment;
 
+    // the variants of a variant playlist
     struct Item {
         AString mURI;
         sp<AMessage> mMeta;
@@ -81,18 +93,21 @@ private:
 
     sp<AMessage> mMeta;
     Vector<Item> mItems;
+    Vector<sp<Segment> > mSegments;
     ssize_t mSelectedIndex;
 
     // Media groups keyed by group ID.
     KeyedVector<AString, sp<MediaGroup> > mMediaGroups;
 
-    status_t parse(const void *data, size_t size);
+    status_t parse(const void *data, size_t size, const sp<M3UParser> &previous);
+    void reset();
+
+    sp<Segment> findSegment(int32_t seqNumber) const;
 
     static status_t parseMetaData(
             const AString &line, sp<AMessage> *meta, const char *key);
 
-    static status_t parseMetaDataDuration(
-            const AString &line, sp<AMessage> *meta, const char *key);
+    static status_t parseMetaDataDuration(const AString &line, int64_t *durationUs);
 
     status_t parseStreamInf(
             const AString &line, sp<AMessage> *meta) const;
@@ -100,6 +115,8 @@ private:
     static status_t parseCipherInfo(
             const AString &line, sp<AMessage> *meta, const AString &baseURI);
 
+    static bool isSameCipherInfo(const sp<AMessage> &a, const sp<AMessage> &b);
+
     static status_t parseByteRange(
             const AString &line, uint64_t curOffset,
             uint64_t *length, uint64_t *offset);
@@ -23,6 +23,7 @@
 #include "HTTPDownloader.h"
 #include "LiveSession.h"
 #include "M3UParser.h"
+#include "SegmentPrefetcher.h"
 #include "include/avc_utils.h"
 #include "include/ID3.h"
 #include "mpeg2ts/AnotherPacketSource.h"
@@ -34,9 +35,10 @@
 #include <media/stagefright/MetaData.h>
 #include <media/stagefright/Utils.h>
 
+#include <cutils/properties.h>
 #include <ctype.h>
 #include <inttypes.h>
-#include <openssl/aes.h>
+#include <openssl/evp.h>
 
 #define FLOGV(fmt, ...) ALOGV("[fetcher-%d] " fmt, mFetcherID, ##__VA_ARGS__)
 #define FSLOGV(stream, fmt, ...) ALOGV("[fetcher-%d] [%s] " fmt, mFetcherID, \
@@ -50,6 +52,17 @@ const int64_t PlaylistFetcher::kMaxMonitorDelayUs = 3000000ll;
 // LCM of 188 (size of a TS packet) & 1k works well
 const int32_t PlaylistFetcher::kDownloadBlockSize = 47 * 1024;
 
+static inline bool getPrefetchSegmentsSetting() {
+    return property_get_bool("media.httplive.prefetch", true);
+}
+
+// Caps the memory queued per stream, for high bitrate variants where 30 seconds of
+// buffering can take a lot of it.
+static inline size_t getMaxBufferedBytesSetting() {
+    int32_t maxBufferedKb = property_get_int32("media.httplive.max-buffered-kb", 64 * 1024);
+    return maxBufferedKb > 0 ? (size_t)maxBufferedKb * 1024 : 0;
+}
+
 struct PlaylistFetcher::DownloadState : public RefBase {
     DownloadState();
     void resetState();
@@ -167,14 +180,40 @@ PlaylistFetcher::PlaylistFetcher(
       mFirstPTSValid(false),
       mFirstTimeUs(-1ll),
       mVideoBuffer(new AnotherPacketSource(NULL)),
+      mMaxBufferedBytes(getMaxBufferedBytesSetting()),
       mThresholdRatio(-1.0f),
       mDownloadState(new DownloadState()),
-      mHasMetadata(false) {
+      mHasMetadata(false),
+      mCipherContext(EVP_CIPHER_CTX_new()) {
+    CHECK(mCipherContext != NULL);
     memset(mPlaylistHash, 0, sizeof(mPlaylistHash));
     mHTTPDownloader = mSession->getHTTPDownloader();
+    if (getPrefetchSegmentsSetting()) {
+        mPrefetcher = new SegmentPrefetcher(mSession, kDownloadBlockSize);
+    }
 }
 
 PlaylistFetcher::~PlaylistFetcher() {
+    if (mPrefetcher != NULL) {
+        mPrefetcher->stop();
+    }
+    EVP_CIPHER_CTX_free(mCipherContext);
+}
+
+bool PlaylistFetcher::isBufferFull() {
+    if (mMaxBufferedBytes == 0) {
+        return false;
+    }
+
+    for (size_t i = 0; i < mPacketSources.size(); ++i) {
+        if ((mStreamTypeMask & mPacketSources.keyAt(i))
+                && mPacketSources.valueAt(i)->getBufferedBytes() >= mMaxBufferedBytes) {
+            FSLOGV(mPacketSources.keyAt(i), "buffered %zu bytes",
+                    mPacketSources.valueAt(i)->getBufferedBytes());
+            return true;
+        }
+    }
+    return false;
 }
 
 int32_t PlaylistFetcher::getFetcherID() const {
@@ -194,14 +233,7 @@ int64_t PlaylistFetcher::getSegmentStartTimeUs(int32_t seqNumber) const {
     int64_t segmentStartUs = 0ll;
     for (int32_t index = 0;
             index < seqNumber - firstSeqNumberInPlaylist; ++index) {
-        sp<AMessage> itemMeta;
-        CHECK(mPlaylist->itemAt(
-                    index, NULL /* uri */, &itemMeta));
-
-        int64_t itemDurationUs;
-        CHECK(itemMeta->findInt64("durationUs", &itemDurationUs));
-
-        segmentStartUs += itemDurationUs;
+        segmentStartUs += mPlaylist->getItemDurationUs(index);
     }
 
     return segmentStartUs;
@@ -217,15 +249,7 @@ int64_t PlaylistFetcher::getSegmentDurationUs(int32_t seqNumber) const {
     CHECK_GE(seqNumber, firstSeqNumberInPlaylist);
     CHECK_LE(seqNumber, lastSeqNumberInPlaylist);
 
-    int32_t index = seqNumber - firstSeqNumberInPlaylist;
-    sp<AMessage> itemMeta;
-    CHECK(mPlaylist->itemAt(
-                index, NULL /* uri */, &itemMeta));
-
-    int64_t itemDurationUs;
-    CHECK(itemMeta->findInt64("durationUs", &itemDurationUs));
-
-    return itemDurationUs;
+    return mPlaylist->getItemDurationUs(seqNumber - firstSeqNumberInPlaylist);
 }
 
 int64_t PlaylistFetcher::delayUsToRefreshPlaylist() const {
@@ -249,13 +273,7 @@ int64_t PlaylistFetcher::delayUsToRefreshPlaylist() const {
         {
             size_t n = mPlaylist->size();
             if (n > 0) {
-                sp<AMessage> itemMeta;
-                CHECK(mPlaylist->itemAt(n - 1, NULL /* uri */, &itemMeta));
-
-                int64_t itemDurationUs;
-                CHECK(itemMeta->findInt64("durationUs", &itemDurationUs));
-
-                minPlaylistAgeUs = itemDurationUs;
+                minPlaylistAgeUs = mPlaylist->getItemDurationUs(n - 1);
                 break;
             }
 
@@ -292,21 +310,10 @@ int64_t PlaylistFetcher::delayUsToRefreshPlaylist() const {
 status_t PlaylistFetcher::decryptBuffer(
         size_t playlistIndex, const sp<ABuffer> &buffer,
         bool first) {
-    sp<AMessage> itemMeta;
-    bool found = false;
+    // the parser hands each segment the key in effect for it
+    sp<AMessage> itemMeta = mPlaylist->getItemCipherInfo(playlistIndex);
     AString method;
-
-    for (ssize_t i = playlistIndex; i >= 0; --i) {
-        AString uri;
-        CHECK(mPlaylist->itemAt(i, &uri, &itemMeta));
-
-        if (itemMeta->findString("cipher-method", &method)) {
-            found = true;
-            break;
-        }
-    }
-
-    if (!found) {
+    if (itemMeta == NULL || !itemMeta->findString("cipher-method", &method)) {
         method = "NONE";
     }
     buffer->meta()->setString("cipher-method", method.c_str());
@@ -318,8 +325,39 @@ status_t PlaylistFetcher::decryptBuffer(
         return ERROR_UNSUPPORTED;
     }
 
+    // The cipher context carries the key and the chaining state from one block of the
+    // segment to the next, only the first block sets them up.
+    if (first) {
+        status_t err = initDecryption(itemMeta);
+        if (err != OK) {
+            return err;
+        }
+    }
+
+    size_t n = buffer->size();
+    if (!n) {
+        return OK;
+    }
+
+    if (n < 16 || n % 16) {
+        ALOGE("not enough or trailing bytes (%zu) in encrypted buffer", n);
+        return ERROR_MALFORMED;
+    }
+
+    int outLength;
+    if (!EVP_DecryptUpdate(
+            mCipherContext, buffer->data(), &outLength, buffer->data(), n)
+            || outLength != (int)n) {
+        ALOGE("failed to decrypt %zu bytes", n);
+        return UNKNOWN_ERROR;
+    }
+
+    return OK;
+}
+
+status_t PlaylistFetcher::initDecryption(const sp<AMessage> &cipherInfo) {
     AString keyURI;
-    if (!itemMeta->findString("cipher-uri", &keyURI)) {
+    if (!cipherInfo->findString("cipher-uri", &keyURI)) {
         ALOGE("Missing key uri");
         return ERROR_MALFORMED;
     }
@@ -345,64 +383,51 @@ status_t PlaylistFetcher::decryptBuffer(
         mAESKeyForURI.add(keyURI, key);
     }
 
-    AES_KEY aes_key;
-    if (AES_set_decrypt_key(key->data(), 128, &aes_key) != 0) {
-        ALOGE("failed to set AES decryption key.");
-        return UNKNOWN_ERROR;
-    }
-
-    size_t n = buffer->size();
-    if (!n) {
-        return OK;
-    }
-
-    if (n < 16 || n % 16) {
-        ALOGE("not enough or trailing bytes (%zu) in encrypted buffer", n);
-        return ERROR_MALFORMED;
-    }
+    // Read the iv from the manifest or derive it from the file's sequence number.
+    uint8_t aesInitVec[16];
+    AString iv;
+    if (cipherInfo->findString("cipher-iv", &iv)) {
+        if ((!iv.startsWith("0x") && !iv.startsWith("0X"))
+                || iv.size() > 16 * 2 + 2) {
+            ALOGE("malformed cipher IV '%s'.", iv.c_str());
+            return ERROR_MALFORMED;
+        }
 
-    if (first) {
-        // If decrypting the first block in a file, read the iv from the manifest
-        // or derive the iv from the file's sequence number.
+        while (iv.size() < 16 * 2 + 2) {
+            iv.insert("0", 1, 2);
+        }
 
-        AString iv;
-        if (itemMeta->findString("cipher-iv", &iv)) {
-            if ((!iv.startsWith("0x") && !iv.startsWith("0X"))
-                    || iv.size() > 16 * 2 + 2) {
+        memset(aesInitVec, 0, sizeof(aesInitVec));
+        for (size_t i = 0; i < 16; ++i) {
+            char c1 = tolower(iv.c_str()[2 + 2 * i]);
+            char c2 = tolower(iv.c_str()[3 + 2 * i]);
+            if (!isxdigit(c1) || !isxdigit(c2)) {
                 ALOGE("malformed cipher IV '%s'.", iv.c_str());
                 return ERROR_MALFORMED;
             }
+            uint8_t nibble1 = isdigit(c1) ? c1 - '0' : c1 - 'a' + 10;
+            uint8_t nibble2 = isdigit(c2) ? c2 - '0' : c2 - 'a' + 10;
 
-            while (iv.size() < 16 * 2 + 2) {
-                iv.insert("0", 1, 2);
-            }
-
-            memset(mAESInitVec, 0, sizeof(mAESInitVec));
-            for (size_t i = 0; i < 16; ++i) {
-                char c1 = tolower(iv.c_str()[2 + 2 * i]);
-                char c2 = tolower(iv.c_str()[3 + 2 * i]);
-                if (!isxdigit(c1) || !isxdigit(c2)) {
-                    ALOGE("malformed cipher IV '%s'.", iv.c_str());
-                    return ERROR_MALFORMED;
-                }
-                uint8_t nibble1 = isdigit(c1) ? c1 - '0' : c1 - 'a' + 10;
-                uint8_t nibble2 = isdigit(c2) ? c2 - '0' : c2 - 'a' + 10;
-
-                mAESInitVec[i] = nibble1 << 4 | nibble2;
-            }
-        } else {
-            memset(mAESInitVec, 0, sizeof(mAESInitVec));
-            mAESInitVec[15] = mSeqNumber & 0xff;
-            mAESInitVec[14] = (mSeqNumber >> 8) & 0xff;
-            mAESInitVec[13] = (mSeqNumber >> 16) & 0xff;
-            mAESInitVec[12] = (mSeqNumber >> 24) & 0xff;
+            aesInitVec[i] = nibble1 << 4 | nibble2;
         }
+    } else {
+        memset(aesInitVec, 0, sizeof(aesInitVec));
+        aesInitVec[15] = mSeqNumber & 0xff;
+        aesInitVec[14] = (mSeqNumber >> 8) & 0xff;
+        aesInitVec[13] = (mSeqNumber >> 16) & 0xff;
+        aesInitVec[12] = (mSeqNumber >> 24) & 0xff;
+    }
+
+    // The padding is checked and stripped once the whole segment is in, see
+    // checkDecryptPadding(). The EVP interface uses the AES instructions of the CPU
+    // when it has them.
+    if (!EVP_DecryptInit_ex(
+            mCipherContext, EVP_aes_128_cbc(), NULL, key->data(), aesInitVec)
+            || !EVP_CIPHER_CTX_set_padding(mCipherContext, 0)) {
+        ALOGE("failed to set AES decryption key.");
+        return UNKNOWN_ERROR;
     }
 
-    AES_cbc_encrypt(
-            buffer->data(), buffer->data(), buffer->size(),
-            &aes_key, mAESInitVec, AES_DECRYPT);
-
     return OK;
 }
 
@@ -457,6 +482,9 @@ void PlaylistFetcher::setStoppingThreshold(float thresholdRatio, bool disconnect
     }
     if (disconnect) {
         mHTTPDownloader->disconnect();
+        if (mPrefetcher != NULL) {
+            mPrefetcher->disconnect();
+        }
     }
 }
 
@@ -467,9 +495,15 @@ void PlaylistFetcher::resetStoppingThreshold(bool disconnect) {
     }
     if (disconnect) {
         mHTTPDownloader->disconnect();
+        if (mPrefetcher != NULL) {
+            mPrefetcher->disconnect();
+        }
     } else {
         // allow reconnect
         mHTTPDownloader->reconnect();
+        if (mPrefetcher != NULL) {
+            mPrefetcher->reconnect();
+        }
     }
 }
 
@@ -711,6 +745,9 @@ status_t PlaylistFetcher::onStart(const sp<AMessage> &msg) {
         mSeqNumber = -1;
         mTimeChangeSignaled = false;
         mDownloadState->resetState();
+        if (mPrefetcher != NULL) {
+            mPrefetcher->clear();
+        }
     }
 
     postMonitorQueue();
@@ -827,7 +864,12 @@ void PlaylistFetcher::onMonitorQueue() {
         }
     }
 
-    if (finalResult == OK && bufferedDurationUs < kMinBufferedDurationUs) {
+    if (finalResult == OK && bufferedDurationUs < kMinBufferedDurationUs
+            && isBufferFull()) {
+        FLOGV("pausing for %lld, buffer is full", (long long)(targetDurationUs / 2));
+
+        postMonitorQueue(targetDurationUs / 2);
+    } else if (finalResult == OK && bufferedDurationUs < kMinBufferedDurationUs) {
         FLOGV("monitoring, buffered=%lld < %lld",
                 (long long)bufferedDurationUs, (long long)kMinBufferedDurationUs);
 
@@ -859,7 +901,7 @@ status_t PlaylistFetcher::refreshPlaylist() {
     if (delayUsToRefreshPlaylist() <= 0) {
         bool unchanged;
         sp<M3UParser> playlist = mHTTPDownloader->fetchPlaylist(
-                mURI.c_str(), mPlaylistHash, &unchanged);
+                mURI.c_str(), mPlaylistHash, &unchanged, mPlaylist);
 
         if (playlist == NULL) {
             if (unchanged) {
@@ -1224,6 +1266,7 @@ void PlaylistFetcher::onDownloadNext() {
     sp<AMessage> itemMeta;
     sp<ABuffer> buffer;
     sp<ABuffer> tsBuffer;
+    sp<ABuffer> prefetched;
     int32_t firstSeqNumberInPlaylist = 0;
     int32_t lastSeqNumberInPlaylist = 0;
     bool connectHTTP = true;
@@ -1237,6 +1280,7 @@ void PlaylistFetcher::onDownloadNext() {
                 firstSeqNumberInPlaylist,
                 lastSeqNumberInPlaylist);
         connectHTTP = false;
+        buffer->meta()->findBuffer("prefetched", &prefetched);
         FLOGV("resuming: '%s'", uri.c_str());
     } else {
         if (!initDownloadState(
@@ -1256,14 +1300,34 @@ void PlaylistFetcher::onDownloadNext() {
         range_length = -1;
     }
 
+    if (mPrefetcher != NULL && buffer == NULL) {
+        // Once started, the segments are downloaded ahead over several connections.
+        if (!mStartup && mStopParams == NULL
+                && (mStreamTypeMask
+                        & (LiveSession::STREAMTYPE_AUDIO | LiveSession::STREAMTYPE_VIDEO))) {
+            prefetchSegments(firstSeqNumberInPlaylist, lastSeqNumberInPlaylist);
+        }
+        status_t err = mPrefetcher->take(mSeqNumber, uri, range_offset, &prefetched);
+        if (err == ERROR_NOT_CONNECTED) {
+            return;
+        } else if (err != OK) {
+            // not prefetched, or failed, download it here
+            prefetched.clear();
+        }
+    }
+
     // block-wise download
     bool shouldPause = false;
     ssize_t bytesRead;
     do {
         int64_t startUs = ALooper::GetNowUs();
-        bytesRead = mHTTPDownloader->fetchBlock(
-                uri.c_str(), &buffer, range_offset, range_length, kDownloadBlockSize,
-                NULL /* actualURL */, connectHTTP);
+        if (prefetched != NULL) {
+            bytesRead = readPrefetchedBlock(prefetched, &buffer);
+        } else {
+            bytesRead = mHTTPDownloader->fetchBlock(
+                    uri.c_str(), &buffer, range_offset, range_length, kDownloadBlockSize,
+                    NULL /* actualURL */, connectHTTP);
+        }
         int64_t delayUs = ALooper::GetNowUs() - startUs;
 
         if (bytesRead == ERROR_NOT_CONNECTED) {
@@ -1278,8 +1342,9 @@ void PlaylistFetcher::onDownloadNext() {
 
         // add sample for bandwidth estimation, excluding samples from subtitles (as
         // its too small), or during startup/resumeUntil (when we could have more than
-        // one connection open which affects bandwidth)
-        if (!mStartup && mStopParams == NULL && bytesRead > 0
+        // one connection open which affects bandwidth). mPrefetcher measures the
+        // segments it downloads.
+        if (!mStartup && mStopParams == NULL && bytesRead > 0 && prefetched == NULL
                 && (mStreamTypeMask
                         & (LiveSession::STREAMTYPE_AUDIO
                         | LiveSession::STREAMTYPE_VIDEO))) {
@@ -1447,6 +1512,51 @@ void PlaylistFetcher::onDownloadNext() {
     }
 }
 
+void PlaylistFetcher::prefetchSegments(
+        int32_t firstSeqNumberInPlaylist, int32_t lastSeqNumberInPlaylist) {
+    int32_t endSeqNumber = mSeqNumber + (int32_t)mPrefetcher->getConcurrency();
+    if (endSeqNumber > lastSeqNumberInPlaylist + 1) {
+        endSeqNumber = lastSeqNumberInPlaylist + 1;
+    }
+    for (int32_t seqNumber = mSeqNumber; seqNumber < endSeqNumber; ++seqNumber) {
+        AString uri;
+        sp<AMessage> itemMeta;
+        if (!mPlaylist->itemAt(seqNumber - firstSeqNumberInPlaylist, &uri, &itemMeta)) {
+            break;
+        }
+        int32_t val;
+        if (seqNumber > mSeqNumber
+                && itemMeta->findInt32("discontinuity", &val) && val != 0) {
+            // the fetcher may be stopped or switched at a discontinuity
+            break;
+        }
+        int64_t rangeOffset, rangeLength;
+        if (!itemMeta->findInt64("range-offset", &rangeOffset)
+                || !itemMeta->findInt64("range-length", &rangeLength)) {
+            rangeOffset = 0;
+            rangeLength = -1;
+        }
+        mPrefetcher->prefetch(seqNumber, uri, rangeOffset, rangeLength);
+    }
+}
+
+ssize_t PlaylistFetcher::readPrefetchedBlock(
+        const sp<ABuffer> &segment, sp<ABuffer> *buffer) {
+    if (*buffer == NULL) {
+        // The blocks are handed out in place, the buffer keeps the segment alive.
+        *buffer = new ABuffer(segment->data(), segment->size());
+        (*buffer)->setRange(0, 0);
+        (*buffer)->meta()->setBuffer("prefetched", segment);
+    }
+
+    size_t bytesRead = segment->size() - (*buffer)->size();
+    if (bytesRead > (size_t)kDownloadBlockSize) {
+        bytesRead = kDownloadBlockSize;
+    }
+    (*buffer)->setRange(0, (*buffer)->size() + bytesRead);
+    return bytesRead;
+}
+
 /*
  * returns true if we need to adjust mSeqNumber
  */
@@ -1477,26 +1587,14 @@ bool PlaylistFetcher::adjustSeqNumberWithAnchorTime(int64_t anchorTimeUs) {
         while (index > 0 && diffUs > maxDiffUs) {
             --index;
 
-            sp<AMessage> itemMeta;
-            CHECK(mPlaylist->itemAt(index, NULL /* uri */, &itemMeta));
-
-            int64_t itemDurationUs;
-            CHECK(itemMeta->findInt64("durationUs", &itemDurationUs));
-
-            diffUs -= itemDurationUs;
+            diffUs -= mPlaylist->getItemDurationUs(index);
         }
     } else if (diffUs < minDiffUs) {
         while (index + 1 < (ssize_t) mPlaylist->size()
                 && diffUs < minDiffUs) {
             ++index;
 
-            sp<AMessage> itemMeta;
-            CHECK(mPlaylist->itemAt(index, NULL /* uri */, &itemMeta));
-
-            int64_t itemDurationUs;
-            CHECK(itemMeta->findInt64("durationUs", &itemDurationUs));
-
-            diffUs += itemDurationUs;
+            diffUs += mPlaylist->getItemDurationUs(index);
         }
     }
 
@@ -1517,10 +1615,7 @@ int32_t PlaylistFetcher::getSeqNumberForDiscontinuity(size_t discontinuitySeq) c
 
     size_t index = 0;
     while (index < mPlaylist->size()) {
-        sp<AMessage> itemMeta;
-        CHECK(mPlaylist->itemAt( index, NULL /* uri */, &itemMeta));
-        size_t curDiscontinuitySeq;
-        CHECK(itemMeta->findInt32("discontinuity-sequence", (int32_t *)&curDiscontinuitySeq));
+        size_t curDiscontinuitySeq = mPlaylist->getItemDiscontinuitySeq(index);
         int32_t seqNumber = firstSeqNumberInPlaylist + index;
         if (curDiscontinuitySeq == discontinuitySeq) {
             return seqNumber;
@@ -1538,13 +1633,7 @@ int32_t PlaylistFetcher::getSeqNumberForTime(int64_t timeUs) const {
     size_t index = 0;
     int64_t segmentStartUs = 0;
     while (index < mPlaylist->size()) {
-        sp<AMessage> itemMeta;
-        CHECK(mPlaylist->itemAt(
-                    index, NULL /* uri */, &itemMeta));
-
-        int64_t itemDurationUs;
-        CHECK(itemMeta->findInt64("durationUs", &itemDurationUs));
-
+        int64_t itemDurationUs = mPlaylist->getItemDurationUs(index);
         if (timeUs < segmentStartUs + itemDurationUs) {
             break;
         }
@@ -1627,15 +1716,10 @@ status_t PlaylistFetcher::extractAndQueueAccessUnitsFromTs(const sp<ABuffer> &bu
         mNextPTSTimeUs = -1ll;
     }
 
-    size_t offset = 0;
-    while (offset + 188 <= buffer->size()) {
-        status_t err = mTSParser->feedTSPacket(buffer->data() + offset, 188);
-
-        if (err != OK) {
-            return err;
-        }
-
-        offset += 188;
+    size_t offset = buffer->size() - buffer->size() % 188;
+    status_t err = mTSParser->feedTSPackets(buffer->data(), offset / 188);
+    if (err != OK) {
+        return err;
     }
     // setRange to indicate consumed bytes.
     buffer->setRange(buffer->offset() + offset, buffer->size() - offset);
@@ -1697,7 +1781,7 @@ status_t PlaylistFetcher::extractAndQueueAccessUnitsFromTs(const sp<ABuffer> &bu
         }
     }
 
-    status_t err = OK;
+    err = OK;
     for (size_t i = mPacketSources.size(); i > 0;) {
         i--;
         sp<AnotherPacketSource> packetSource = mPacketSources.valueAt(i);
@@ -2084,14 +2168,7 @@ status_t PlaylistFetcher::extractAndQueueAccessUnits(
 void PlaylistFetcher::updateDuration() {
     int64_t durationUs = 0ll;
     for (size_t index = 0; index < mPlaylist->size(); ++index) {
-        sp<AMessage> itemMeta;
-        CHECK(mPlaylist->itemAt(
-                    index, NULL /* uri */, &itemMeta));
-
-        int64_t itemDurationUs;
-        CHECK(itemMeta->findInt64("durationUs", &itemDurationUs));
-
-        durationUs += itemDurationUs;
+        durationUs += mPlaylist->getItemDurationUs(index);
     }
 
     sp<AMessage> msg = mNotify->dup();
@@ -23,6 +23,8 @@
 #include "mpeg2ts/ATSParser.h"
 #include "LiveSession.h"
 
+typedef struct evp_cipher_ctx_st EVP_CIPHER_CTX;
+
 namespace android {
 
 struct ABuffer;
@@ -31,6 +33,7 @@ class DataSource;
 struct HTTPBase;
 struct LiveDataSource;
 struct M3UParser;
+struct SegmentPrefetcher;
 class String8;
 
 struct PlaylistFetcher : public AHandler {
@@ -117,6 +120,7 @@ private:
     sp<AMessage> mStartTimeUsNotify;
 
     sp<HTTPDownloader> mHTTPDownloader;
+    sp<SegmentPrefetcher> mPrefetcher;
     sp<LiveSession> mSession;
     AString mURI;
 
@@ -172,10 +176,8 @@ private:
     int64_t mSegmentFirstPTS;
     sp<AnotherPacketSource> mVideoBuffer;
 
-    // Stores the initialization vector to decrypt the next block of cipher text, which can
-    // either be derived from the sequence number, read from the manifest, or copied from
-    // the last block of cipher text (cipher-block chaining).
-    unsigned char mAESInitVec[16];
+    // Downloading pauses while a stream holds this many bytes, 0 if unlimited.
+    const size_t mMaxBufferedBytes;
 
     Mutex mThresholdLock;
     float mThresholdRatio;
@@ -184,10 +186,16 @@ private:
 
     bool mHasMetadata;
 
+    // Decrypts the segment being downloaded, keeping the initialization vector for the
+    // next block of cipher text: derived from the sequence number or read from the
+    // manifest for the first block, then the last block of cipher text (cipher-block
+    // chaining).
+    EVP_CIPHER_CTX *mCipherContext;
+
     // Set first to true if decrypting the first segment of a playlist segment. When
-    // first is true, reset the initialization vector based on the available
-    // information in the manifest; otherwise, use the initialization vector as
-    // updated by the last call to AES_cbc_encrypt.
+    // first is true, set up the key and the initialization vector based on the
+    // available information in the manifest; otherwise, continue from the state left
+    // by the previous block.
     //
     // For the input to decrypt correctly, decryptBuffer must be called on
     // consecutive byte ranges on block boundaries, e.g. 0..15, 16..47, 48..63,
@@ -195,6 +203,7 @@ private:
     status_t decryptBuffer(
             size_t playlistIndex, const sp<ABuffer> &buffer,
             bool first = true);
+    status_t initDecryption(const sp<AMessage> &cipherInfo);
     status_t checkDecryptPadding(const sp<ABuffer> &buffer);
 
     void postMonitorQueue(int64_t delayUs = 0, int64_t minDelayUs = 0);
@@ -203,6 +212,7 @@ private:
     void resetStoppingThreshold(bool disconnect);
     float getStoppingThreshold();
     bool shouldPauseDownload();
+    bool isBufferFull();
 
     int64_t delayUsToRefreshPlaylist() const;
     status_t refreshPlaylist();
@@ -218,6 +228,11 @@ private:
     void onStop(const sp<AMessage> &msg);
     void onMonitorQueue();
     void onDownloadNext();
+    // Queues the download of the segments from mSeqNumber on with mPrefetcher.
+    void prefetchSegments(int32_t firstSeqNumberInPlaylist, int32_t lastSeqNumberInPlaylist);
+    // Hands the next block of a segment downloaded by mPrefetcher to the block-wise
+    // extraction, like HTTPDownloader::fetchBlock.
+    ssize_t readPrefetchedBlock(const sp<ABuffer> &segment, sp<ABuffer> *buffer);
     bool initDownloadState(
             AString &uri,
             sp<AMessage> &itemMeta,
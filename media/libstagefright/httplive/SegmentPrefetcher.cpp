@@ -0,0 +1,359 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "SegmentPrefetcher"
+#include <utils/Log.h>
+
+#include "SegmentPrefetcher.h"
+#include "HTTPDownloader.h"
+#include "LiveSession.h"
+
+#include <media/stagefright/foundation/ABuffer.h>
+#include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/AHandler.h>
+#include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/foundation/AMessage.h>
+#include <media/stagefright/MediaErrors.h>
+
+namespace android {
+
+struct SegmentPrefetcher::Segment : public RefBase {
+    Segment()
+        : mRangeOffset(0),
+          mRangeLength(-1),
+          mFetching(false),
+          mDone(false),
+          mResult(OK) {
+    }
+
+    AString mUri;
+    int64_t mRangeOffset;
+    int64_t mRangeLength;
+
+    bool mFetching;
+    bool mDone;
+    status_t mResult;
+    sp<ABuffer> mBuffer;
+
+private:
+    DISALLOW_EVIL_CONSTRUCTORS(Segment);
+};
+
+struct SegmentPrefetcher::Worker : public AHandler {
+    enum {
+        kWhatFetch = 'fetc',
+    };
+
+    // The prefetcher stops the looper of the worker before it goes away.
+    Worker(SegmentPrefetcher *prefetcher, const sp<HTTPDownloader> &downloader)
+        : mPrefetcher(prefetcher),
+          mDownloader(downloader),
+          mBusy(false) {
+    }
+
+    SegmentPrefetcher *mPrefetcher;
+    sp<HTTPDownloader> mDownloader;
+    bool mBusy;  // protected by the lock of the prefetcher
+
+protected:
+    virtual void onMessageReceived(const sp<AMessage> &msg) {
+        CHECK_EQ(msg->what(), (uint32_t)kWhatFetch);
+        int32_t seqNumber, generation;
+        CHECK(msg->findInt32("seqNumber", &seqNumber));
+        CHECK(msg->findInt32("generation", &generation));
+        mPrefetcher->onFetch(this, seqNumber, generation);
+    }
+
+private:
+    DISALLOW_EVIL_CONSTRUCTORS(Worker);
+};
+
+SegmentPrefetcher::SegmentPrefetcher(const sp<LiveSession> &session, int32_t blockSize)
+    : mSession(session),
+      mBlockSize(blockSize),
+      mDisconnected(false),
+      mGeneration(0),
+      mLatencyUs(-1ll),
+      mBytesPerUs(0.0),
+      mSegmentBytes(0),
+      mNumFetching(0),
+      mLastMeasurementUs(-1ll) {
+}
+
+SegmentPrefetcher::~SegmentPrefetcher() {
+    stop();
+}
+
+size_t SegmentPrefetcher::getConcurrency() {
+    Mutex::Autolock autoLock(mLock);
+    if (mLatencyUs < 0 || mSegmentBytes == 0) {
+        return kMinConcurrency;
+    }
+
+    // While one connection waits for the response to its request, the others keep the
+    // link busy, so each segment in flight covers up to a segment of the delay.
+    double bandwidthDelayBytes = mLatencyUs * mBytesPerUs;
+    size_t concurrency = 1 + (size_t)(bandwidthDelayBytes / mSegmentBytes + 0.999);
+    if (concurrency < (size_t)kMinConcurrency) {
+        concurrency = kMinConcurrency;
+    } else if (concurrency > (size_t)kMaxConcurrency) {
+        concurrency = kMaxConcurrency;
+    }
+    return concurrency;
+}
+
+void SegmentPrefetcher::prefetch(
+        int32_t seqNumber, const AString &uri, int64_t rangeOffset, int64_t rangeLength) {
+    Mutex::Autolock autoLock(mLock);
+    if (mDisconnected || mSegments.indexOfKey(seqNumber) >= 0) {
+        return;
+    }
+
+    sp<Segment> segment = new Segment;
+    segment->mUri = uri;
+    segment->mRangeOffset = rangeOffset;
+    segment->mRangeLength = rangeLength;
+    mSegments.add(seqNumber, segment);
+    ALOGV("queued segment %d", seqNumber);
+
+    dispatch_l();
+}
+
+status_t SegmentPrefetcher::take(
+        int32_t seqNumber, const AString &uri, int64_t rangeOffset, sp<ABuffer> *out) {
+    Mutex::Autolock autoLock(mLock);
+    while (mSegments.size() > 0 && mSegments.keyAt(0) < seqNumber) {
+        mSegments.removeItemsAt(0);
+    }
+
+    ssize_t index = mSegments.indexOfKey(seqNumber);
+    if (index < 0) {
+        return NAME_NOT_FOUND;
+    }
+    sp<Segment> segment = mSegments.valueAt(index);
+    if (segment->mUri != uri || segment->mRangeOffset != rangeOffset) {
+        // the playlist changed under the queued segment
+        mSegments.removeItemsAt(index);
+        return NAME_NOT_FOUND;
+    }
+
+    while (!segment->mDone && !mDisconnected) {
+        mCondition.wait(mLock);
+    }
+    if (mDisconnected) {
+        return ERROR_NOT_CONNECTED;
+    }
+
+    mSegments.removeItem(seqNumber);
+    *out = segment->mBuffer;
+    return segment->mResult;
+}
+
+void SegmentPrefetcher::clear() {
+    Mutex::Autolock autoLock(mLock);
+    mSegments.clear();
+    ++mGeneration;
+}
+
+void SegmentPrefetcher::disconnect() {
+    Mutex::Autolock autoLock(mLock);
+    mDisconnected = true;
+    mSegments.clear();
+    ++mGeneration;
+    for (size_t i = 0; i < mWorkers.size(); ++i) {
+        mWorkers[i]->mDownloader->disconnect();
+    }
+    mCondition.broadcast();
+}
+
+void SegmentPrefetcher::reconnect() {
+    Mutex::Autolock autoLock(mLock);
+    mDisconnected = false;
+    for (size_t i = 0; i < mWorkers.size(); ++i) {
+        mWorkers[i]->mDownloader->reconnect();
+    }
+}
+
+void SegmentPrefetcher::stop() {
+    disconnect();
+
+    // The downloads return once disconnected, let the workers finish before they go away.
+    Vector<sp<ALooper> > loopers;
+    {
+        Mutex::Autolock autoLock(mLock);
+        loopers = mLoopers;
+        mLoopers.clear();
+    }
+    for (size_t i = 0; i < loopers.size(); ++i) {
+        loopers[i]->stop();
+    }
+
+    Mutex::Autolock autoLock(mLock);
+    mWorkers.clear();
+}
+
+void SegmentPrefetcher::dispatch_l() {
+    if (mDisconnected) {
+        return;
+    }
+
+    for (size_t i = 0; i < mSegments.size(); ++i) {
+        const sp<Segment> &segment = mSegments.valueAt(i);
+        if (segment->mFetching || segment->mDone) {
+            continue;
+        }
+
+        sp<Worker> worker;
+        for (size_t j = 0; j < mWorkers.size(); ++j) {
+            if (!mWorkers[j]->mBusy) {
+                worker = mWorkers[j];
+                break;
+            }
+        }
+        if (worker == NULL) {
+            if (mWorkers.size() >= (size_t)kMaxConcurrency) {
+                return;
+            }
+            // each worker downloads over its own connection
+            sp<ALooper> looper = new ALooper;
+            looper->setName("segment-prefetch");
+            looper->start();
+            worker = new Worker(this, mSession->getHTTPDownloader());
+            looper->registerHandler(worker);
+            mLoopers.push_back(looper);
+            mWorkers.push_back(worker);
+        }
+
+        worker->mBusy = true;
+        segment->mFetching = true;
+        if (mNumFetching++ == 0) {
+            mLastMeasurementUs = ALooper::GetNowUs();
+        }
+
+        sp<AMessage> msg = new AMessage(Worker::kWhatFetch, worker);
+        msg->setInt32("seqNumber", mSegments.keyAt(i));
+        msg->setInt32("generation", mGeneration);
+        msg->post();
+    }
+}
+
+void SegmentPrefetcher::onFetch(
+        const sp<Worker> &worker, int32_t seqNumber, int32_t generation) {
+    AString uri;
+    int64_t rangeOffset, rangeLength;
+    {
+        Mutex::Autolock autoLock(mLock);
+        ssize_t index = mSegments.indexOfKey(seqNumber);
+        if (generation == mGeneration && index >= 0) {
+            const sp<Segment> &segment = mSegments.valueAt(index);
+            uri = segment->mUri;
+            rangeOffset = segment->mRangeOffset;
+            rangeLength = segment->mRangeLength;
+        }
+    }
+
+    // Download in blocks, so that the latency of the request can be told apart from the
+    // throughput of the connection.
+    sp<ABuffer> buffer;
+    status_t result = OK;
+    size_t firstBlockBytes = 0;
+    int64_t firstBlockUs = 0;
+    size_t restBytes = 0;
+    int64_t restUs = 0;
+    if (!uri.empty()) {
+        int64_t startUs = ALooper::GetNowUs();
+        bool connect = true;
+        for (;;) {
+            ssize_t bytesRead = worker->mDownloader->fetchBlock(
+                    uri.c_str(), &buffer, rangeOffset, rangeLength, mBlockSize,
+                    NULL /* actualUrl */, connect);
+            int64_t nowUs = ALooper::GetNowUs();
+            if (bytesRead < 0) {
+                result = bytesRead;
+                break;
+            }
+            if (connect) {
+                firstBlockBytes = bytesRead;
+                firstBlockUs = nowUs - startUs;
+                connect = false;
+            } else {
+                restBytes += bytesRead;
+                restUs = nowUs - startUs - firstBlockUs;
+            }
+            if (bytesRead == 0) {
+                break;
+            }
+        }
+        if (result != OK) {
+            ALOGW("failed to prefetch segment %d (%d)", seqNumber, result);
+        }
+    }
+
+    Mutex::Autolock autoLock(mLock);
+    worker->mBusy = false;
+
+    int64_t nowUs = ALooper::GetNowUs();
+    size_t numBytes = firstBlockBytes + restBytes;
+    if (result == OK && numBytes > 0 && nowUs > mLastMeasurementUs) {
+        // The downloads share the link, the wall clock time since the last measurement
+        // gives their combined bandwidth.
+        mSession->addBandwidthMeasurement(numBytes, nowUs - mLastMeasurementUs);
+        mLastMeasurementUs = nowUs;
+        updateEstimates_l(firstBlockBytes, firstBlockUs, restBytes, restUs);
+    }
+    --mNumFetching;
+
+    ssize_t index = mSegments.indexOfKey(seqNumber);
+    if (generation == mGeneration && index >= 0) {
+        const sp<Segment> &segment = mSegments.valueAt(index);
+        segment->mFetching = false;
+        segment->mDone = true;
+        segment->mResult = uri.empty() ? (status_t)ERROR_NOT_CONNECTED : result;
+        segment->mBuffer = buffer;
+    }
+
+    dispatch_l();
+    mCondition.broadcast();
+}
+
+void SegmentPrefetcher::updateEstimates_l(
+        size_t firstBlockBytes, int64_t firstBlockUs, size_t restBytes, int64_t restUs) {
+    size_t numBytes = firstBlockBytes + restBytes;
+    mSegmentBytes = mSegmentBytes == 0 ? numBytes : (mSegmentBytes * 3 + numBytes) / 4;
+
+    if (restBytes < (size_t)mBlockSize || restUs <= 0) {
+        // the segment is too short to measure the connection
+        return;
+    }
+    double bytesPerUs = (double)restBytes / restUs;
+    int64_t latencyUs = firstBlockUs - (int64_t)(firstBlockBytes / bytesPerUs);
+    if (latencyUs < 0) {
+        latencyUs = 0;
+    }
+
+    if (mLatencyUs < 0) {
+        mLatencyUs = latencyUs;
+        mBytesPerUs = bytesPerUs;
+    } else {
+        mLatencyUs = (mLatencyUs * 3 + latencyUs) / 4;
+        mBytesPerUs = (mBytesPerUs * 3 + bytesPerUs) / 4;
+    }
+    ALOGV("latency %lld us, %.0f kbps per connection, %zu bytes per segment",
+            (long long)mLatencyUs, mBytesPerUs * 8000, mSegmentBytes);
+}
+
+}  // namespace android
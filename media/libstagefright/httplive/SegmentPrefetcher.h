@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SEGMENT_PREFETCHER_H_
+
+#define SEGMENT_PREFETCHER_H_
+
+#include <media/stagefright/foundation/ABase.h>
+#include <media/stagefright/foundation/AString.h>
+#include <utils/KeyedVector.h>
+#include <utils/RefBase.h>
+#include <utils/threads.h>
+
+namespace android {
+
+struct ABuffer;
+struct ALooper;
+struct HTTPDownloader;
+struct LiveSession;
+
+// Downloads the upcoming segments of a playlist over several connections at once, so that
+// the latency of each request does not leave the link idle between segments.
+//
+// The PlaylistFetcher queues the segments it is about to parse with prefetch() and takes
+// them in order with take(), which waits for a segment still being downloaded. The number
+// of segments to keep in flight is sized from the request latency and the throughput of a
+// single connection, i.e. from the bandwidth-delay product of the link.
+struct SegmentPrefetcher : public RefBase {
+    enum {
+        kMinConcurrency = 2,
+        kMaxConcurrency = 4,
+    };
+
+    SegmentPrefetcher(const sp<LiveSession> &session, int32_t blockSize);
+
+    // Returns the number of segments, counting the next one to parse, to keep queued.
+    size_t getConcurrency();
+
+    // Queues the download of a segment unless it is queued already. The segments are
+    // downloaded in the order of their sequence numbers.
+    void prefetch(
+            int32_t seqNumber,
+            const AString &uri,
+            int64_t rangeOffset,
+            int64_t rangeLength);
+
+    // Waits for a queued segment and hands it over, dropping the segments before it.
+    // Returns NAME_NOT_FOUND if the segment was not queued, ERROR_NOT_CONNECTED after a
+    // disconnect, or the error of the download.
+    status_t take(
+            int32_t seqNumber,
+            const AString &uri,
+            int64_t rangeOffset,
+            sp<ABuffer> *out);
+
+    // Drops the queued segments, e.g. on a seek. Downloads in progress complete unused.
+    void clear();
+
+    // Aborts the downloads and drops the queued segments, until reconnect().
+    void disconnect();
+    void reconnect();
+
+    // Aborts the downloads and shuts down the connections.
+    void stop();
+
+protected:
+    virtual ~SegmentPrefetcher();
+
+private:
+    struct Segment;
+    struct Worker;
+
+    sp<LiveSession> mSession;
+    const int32_t mBlockSize;
+
+    Mutex mLock;
+    Condition mCondition;
+    bool mDisconnected;
+    int32_t mGeneration;
+
+    KeyedVector<int32_t, sp<Segment> > mSegments;
+    Vector<sp<Worker> > mWorkers;
+    Vector<sp<ALooper> > mLoopers;
+
+    // link estimates, from the downloads completed
+    int64_t mLatencyUs;
+    double mBytesPerUs;         // throughput of one connection
+    size_t mSegmentBytes;       // average segment size
+
+    // for the bandwidth measurements of the downloads running in parallel
+    size_t mNumFetching;
+    int64_t mLastMeasurementUs;
+
+    void dispatch_l();
+    void onFetch(const sp<Worker> &worker, int32_t seqNumber, int32_t generation);
+    void updateEstimates_l(
+            size_t firstBlockBytes, int64_t firstBlockUs, size_t restBytes, int64_t restUs);
+
+    DISALLOW_EVIL_CONSTRUCTORS(SegmentPrefetcher);
+};
+
+}  // namespace android
+
+#endif  // SEGMENT_PREFETCHER_H_
@@ -59,6 +59,8 @@ private:
 ID3::ID3(const sp<DataSource> &source, bool ignoreV1, off64_t offset)
     : mIsValid(false),
       mData(NULL),
+      mTag(NULL),
+      mTagOffset(0),
       mSize(0),
       mFirstFrameOffset(0),
       mVersion(ID3_UNKNOWN),
@@ -73,6 +75,8 @@ ID3::ID3(const sp<DataSource> &source, bool ignoreV1, off64_t offset)
 ID3::ID3(const uint8_t *data, size_t size, bool ignoreV1)
     : mIsValid(false),
       mData(NULL),
+      mTag(NULL),
+      mTagOffset(0),
       mSize(0),
       mFirstFrameOffset(0),
       mVersion(ID3_UNKNOWN),
@@ -84,16 +88,38 @@ ID3::ID3(const uint8_t *data, size_t size, bool ignoreV1)
 
     mIsValid = parseV2(source, 0);
 
+    if (mIsValid && mSource != NULL) {
+        // no need to go through the source, the tag is here
+        if (mRawSize > size) {
+            clearTag();
+            mIsValid = false;
+        } else {
+            mTag = data + mTagOffset;
+            mSource.clear();
+        }
+    }
+
     if (!mIsValid && !ignoreV1) {
         mIsValid = parseV1(source);
     }
 }
 
 ID3::~ID3() {
+    clearTag();
+}
+
+void ID3::clearTag() {
     if (mData) {
         free(mData);
         mData = NULL;
     }
+    mTag = NULL;
+    mSource.clear();
+
+    for (size_t i = 0; i < mFrames.size(); ++i) {
+        free(mFrames.valueAt(i));
+    }
+    mFrames.clear();
 }
 
 bool ID3::isValid() const {
@@ -179,83 +205,105 @@ struct id3_header {
         return false;
     }
 
-    mData = (uint8_t *)malloc(size);
-
-    if (mData == NULL) {
-        return false;
-    }
-
     mSize = size;
     mRawSize = mSize + sizeof(header);
 
-    if (source->readAt(offset + sizeof(header), mData, mSize) != (ssize_t)mSize) {
-        free(mData);
-        mData = NULL;
-
+    off64_t sourceSize;
+    if (source->getSize(&sourceSize) == OK
+            && (off64_t)mRawSize > sourceSize - offset) {
         return false;
     }
 
+    bool unsynchronized;
     if (header.version_major == 4) {
-        void *copy = malloc(size);
-        if (copy == NULL) {
+        unsynchronized = HasUnsynchronizedFramesV2_4(source, offset + sizeof(header), size);
+    } else {
+        unsynchronized = (header.flags & 0x80) != 0;
+    }
+
+    if (!unsynchronized) {
+        // the frames are used as they are, only read the ones asked for
+        mSource = source;
+        mTagOffset = offset + sizeof(header);
+    } else {
+        mData = (uint8_t *)malloc(size);
+
+        if (mData == NULL) {
+            return false;
+        }
+
+        if (source->readAt(offset + sizeof(header), mData, mSize) != (ssize_t)mSize) {
             free(mData);
             mData = NULL;
-            ALOGE("b/24623447, no more memory");
+
             return false;
         }
+        mTag = mData;
 
-        memcpy(copy, mData, size);
+        if (header.version_major == 4) {
+            void *copy = malloc(size);
+            if (copy == NULL) {
+                clearTag();
+                ALOGE("b/24623447, no more memory");
+                return false;
+            }
 
-        bool success = removeUnsynchronizationV2_4(false /* iTunesHack */);
-        if (!success) {
-            memcpy(mData, copy, size);
-            mSize = size;
+            memcpy(copy, mData, size);
 
-            success = removeUnsynchronizationV2_4(true /* iTunesHack */);
+            bool success = removeUnsynchronizationV2_4(false /* iTunesHack */);
+            if (!success) {
+                memcpy(mData, copy, size);
+                mSize = size;
 
-            if (success) {
-                ALOGV("Had to apply the iTunes hack to parse this ID3 tag");
+                success = removeUnsynchronizationV2_4(true /* iTunesHack */);
+
+                if (success) {
+                    ALOGV("Had to apply the iTunes hack to parse this ID3 tag");
+                }
             }
-        }
 
-        free(copy);
-        copy = NULL;
+            free(copy);
+            copy = NULL;
 
-        if (!success) {
-            free(mData);
-            mData = NULL;
+            if (!success) {
+                clearTag();
 
-            return false;
-        }
-    } else if (header.flags & 0x80) {
-        ALOGV("removing unsynchronization");
+                return false;
+            }
+        } else {
+            ALOGV("removing unsynchronization");
 
-        removeUnsynchronization();
+            removeUnsynchronization();
+        }
     }
 
     mFirstFrameOffset = 0;
+    uint8_t extendedHeaderBuffer[10];
+    const uint8_t *extendedHeader = NULL;
+    if (header.flags & 0x40) {
+        extendedHeader = readTag(
+                0, extendedHeaderBuffer, mSize < 10 ? mSize : sizeof(extendedHeaderBuffer));
+    }
+
     if (header.version_major == 3 && (header.flags & 0x40)) {
         // Version 2.3 has an optional extended header.
 
-        if (mSize < 4) {
-            free(mData);
-            mData = NULL;
+        if (mSize < 4 || extendedHeader == NULL) {
+            clearTag();
 
             return false;
         }
 
-        size_t extendedHeaderSize = U32_AT(&mData[0]);
+        size_t extendedHeaderSize = U32_AT(&extendedHeader[0]);
         if (extendedHeaderSize > SIZE_MAX - 4) {
-            free(mData);
-            mData = NULL;
+            clearTag();
             ALOGE("b/24623447, extendedHeaderSize is too large");
             return false;
         }
         extendedHeaderSize += 4;
 
         if (extendedHeaderSize > mSize) {
-            free(mData);
-            mData = NULL;
+            clearTag();
 
             return false;
         }
@@ -264,17 +312,16 @@ struct id3_header {
 
         uint16_t extendedFlags = 0;
         if (extendedHeaderSize >= 6) {
-            extendedFlags = U16_AT(&mData[4]);
+            extendedFlags = U16_AT(&extendedHeader[4]);
 
             if (extendedHeaderSize >= 10) {
-                size_t paddingSize = U32_AT(&mData[6]);
+                size_t paddingSize = U32_AT(&extendedHeader[6]);
 
                 if (paddingSize > SIZE_MAX - mFirstFrameOffset) {
                     ALOGE("b/24623447, paddingSize is too large");
                 }
                 if (paddingSize > mSize - mFirstFrameOffset) {
-                    free(mData);
-                    mData = NULL;
+                    clearTag();
 
                     return false;
                 }
@@ -290,24 +337,21 @@ struct id3_header {
         // Version 2.4 has an optional extended header, that's different
         // from Version 2.3's...
 
-        if (mSize < 4) {
-            free(mData);
-            mData = NULL;
+        if (mSize < 4 || extendedHeader == NULL) {
+            clearTag();
 
             return false;
         }
 
         size_t ext_size;
-        if (!ParseSyncsafeInteger(mData, &ext_size)) {
-            free(mData);
-            mData = NULL;
+        if (!ParseSyncsafeInteger(extendedHeader, &ext_size)) {
+            clearTag();
 
             return false;
         }
 
         if (ext_size < 6 || ext_size > mSize) {
-            free(mData);
-            mData = NULL;
+            clearTag();
 
             return false;
         }
@@ -328,12 +372,95 @@ struct id3_header {
 }
 
 void ID3::removeUnsynchronization() {
-    for (size_t i = 0; i + 1 < mSize; ++i) {
-        if (mData[i] == 0xff && mData[i + 1] == 0x00) {
-            memmove(&mData[i + 1], &mData[i + 2], mSize - i - 2);
-            --mSize;
+    if (mSize == 0) {
+        return;
+    }
+
+    // drop each 0x00 following a 0xff, in a single pass
+    size_t writeOffset = 1;
+    uint8_t previous = mData[0];
+    for (size_t readOffset = 1; readOffset < mSize; ++readOffset) {
+        uint8_t byte = mData[readOffset];
+        if (previous != 0xff || byte != 0x00) {
+            mData[writeOffset++] = byte;
         }
+        previous = byte;
     }
+    mSize = writeOffset;
+}
+
+// static
+bool ID3::HasUnsynchronizedFramesV2_4(
+        const sp<DataSource> &source, off64_t offset, size_t size) {
+    // Whether removeUnsynchronizationV2_4() would rewrite the tag: frames
+    // that are unsynchronized or have a data length indicator, or sizes
+    // that need the iTunes hack. If unsure, the tag is read and rewritten.
+    size_t frameOffset = 0;
+    while (size >= 10 && frameOffset <= size - 10) {
+        uint8_t frameHeader[10];
+        if (source->readAt(offset + frameOffset, frameHeader, sizeof(frameHeader))
+                != (ssize_t)sizeof(frameHeader)) {
+            return true;
+        }
+
+        if (!memcmp(frameHeader, "\0\0\0\0", 4)) {
+            break;
+        }
+
+        size_t dataSize;
+        if (!ParseSyncsafeInteger(&frameHeader[4], &dataSize)
+                || dataSize > size - 10 - frameOffset) {
+            return true;
+        }
+
+        if (U16_AT(&frameHeader[8]) & 3) {
+            return true;
+        }
+
+        frameOffset += 10 + dataSize;
+    }
+
+    return false;
+}
+
+const uint8_t *ID3::readTag(size_t offset, uint8_t *buffer, size_t size) const {
+    if (offset > mSize || size > mSize - offset) {
+        return NULL;
+    }
+
+    if (mTag != NULL) {
+        return &mTag[offset];
+    }
+
+    if (mSource == NULL
+            || mSource->readAt(mTagOffset + offset, buffer, size) != (ssize_t)size) {
+        return NULL;
+    }
+    return buffer;
+}
+
+const uint8_t *ID3::getFrameData(size_t offset, size_t size) const {
+    if (mTag != NULL) {
+        return readTag(offset, NULL, size);
+    }
+
+    ssize_t index = mFrames.indexOfKey(offset);
+    if (index >= 0) {
+        return mFrames.valueAt(index);
+    }
+
+    uint8_t *data = (uint8_t *)malloc(size);
+    if (data == NULL) {
+        return NULL;
+    }
+
+    if (readTag(offset, data, size) == NULL) {
+        free(data);
+        return NULL;
+    }
+
+    mFrames.add(offset, data);
+    return data;
 }
 
 static void WriteSyncsafeInteger(uint8_t *dst, size_t x) {
@@ -459,10 +586,14 @@ void ID3::Iterator::getID(String8 *id) const {
         return;
     }
 
-    if (mParent.mVersion == ID3_V2_2) {
-        id->setTo((const char *)&mParent.mData[mOffset], 3);
-    } else if (mParent.mVersion == ID3_V2_3 || mParent.mVersion == ID3_V2_4) {
-        id->setTo((const char *)&mParent.mData[mOffset], 4);
+    if (mParent.mVersion == ID3_V2_2 || mParent.mVersion == ID3_V2_3
+            || mParent.mVersion == ID3_V2_4) {
+        size_t idLength = (mParent.mVersion == ID3_V2_2) ? 3 : 4;
+        uint8_t buffer[4];
+        const uint8_t *frameID = mParent.readTag(mOffset, buffer, idLength);
+        if (frameID != NULL) {
+            id->setTo((const char *)frameID, idLength);
+        }
     } else {
         CHECK(mParent.mVersion == ID3_V1 || mParent.mVersion == ID3_V1_1);
 
@@ -587,6 +718,10 @@ void ID3::Iterator::getstring(String8 *id, bool otherdata) const {
         int len = n / 2;
         const char16_t *framedata = (const char16_t *) (frameData + 1);
         char16_t *framedatacopy = NULL;
+        if (len == 0) {
+            // the frames are not always followed by more data to read the marker from
+            return;
+        }
         if (*framedata == 0xfffe) {
             // endianness marker != host endianness, convert & skip
             if (len <= 1) {
@@ -680,14 +815,20 @@ void ID3::Iterator::findFrame() {
                 return;
             }
 
-            if (!memcmp(&mParent.mData[mOffset], "\0\0\0", 3)) {
+            uint8_t buffer[6];
+            const uint8_t *frameHeader = mParent.readTag(mOffset, buffer, sizeof(buffer));
+            if (frameHeader == NULL) {
+                return;
+            }
+
+            if (!memcmp(frameHeader, "\0\0\0", 3)) {
                 return;
             }
 
             mFrameSize =
-                (mParent.mData[mOffset + 3] << 16)
-                | (mParent.mData[mOffset + 4] << 8)
-                | mParent.mData[mOffset + 5];
+                (frameHeader[3] << 16)
+                | (frameHeader[4] << 8)
+                | frameHeader[5];
 
             if (mFrameSize == 0) {
                 return;
@@ -705,18 +846,14 @@ void ID3::Iterator::findFrame() {
                 return;
             }
 
-            mFrameData = &mParent.mData[mOffset + 6];
-
-            if (!mID) {
-                break;
-            }
-
             char id[4];
-            memcpy(id, &mParent.mData[mOffset], 3);
+            memcpy(id, frameHeader, 3);
             id[3] = '\0';
 
-            if (!strcmp(id, mID)) {
-                break;
+            if (!mID || !strcmp(id, mID)) {
+                // only the frames asked for are read
+                mFrameData = mParent.getFrameData(mOffset + 6, mFrameSize - 6);
+                return;
             }
         } else if (mParent.mVersion == ID3_V2_3
                 || mParent.mVersion == ID3_V2_4) {
@@ -724,18 +861,23 @@ void ID3::Iterator::findFrame() {
                 return;
             }
 
-            if (!memcmp(&mParent.mData[mOffset], "\0\0\0\0", 4)) {
+            uint8_t buffer[10];
+            const uint8_t *frameHeader = mParent.readTag(mOffset, buffer, sizeof(buffer));
+            if (frameHeader == NULL) {
+                return;
+            }
+
+            if (!memcmp(frameHeader, "\0\0\0\0", 4)) {
                 return;
             }
 
             size_t baseSize = 0;
             if (mParent.mVersion == ID3_V2_4) {
-                if (!ParseSyncsafeInteger(
-                            &mParent.mData[mOffset + 4], &baseSize)) {
+                if (!ParseSyncsafeInteger(&frameHeader[4], &baseSize)) {
                     return;
                 }
             } else {
-                baseSize = U32_AT(&mParent.mData[mOffset + 4]);
+                baseSize = U32_AT(&frameHeader[4]);
             }
 
             if (baseSize == 0) {
@@ -760,7 +902,7 @@ void ID3::Iterator::findFrame() {
                 return;
             }
 
-            uint16_t flags = U16_AT(&mParent.mData[mOffset + 8]);
+            uint16_t flags = U16_AT(&frameHeader[8]);
 
             if ((mParent.mVersion == ID3_V2_4 && (flags & 0x000c))
                 || (mParent.mVersion == ID3_V2_3 && (flags & 0x00c0))) {
@@ -775,18 +917,13 @@ void ID3::Iterator::findFrame() {
                 continue;
             }
 
-            mFrameData = &mParent.mData[mOffset + 10];
-
-            if (!mID) {
-                break;
-            }
-
             char id[5];
-            memcpy(id, &mParent.mData[mOffset], 4);
+            memcpy(id, frameHeader, 4);
             id[4] = '\0';
 
-            if (!strcmp(id, mID)) {
-                break;
+            if (!mID || !strcmp(id, mID)) {
+                mFrameData = mParent.getFrameData(mOffset + 10, mFrameSize - 10);
+                return;
             }
         } else {
             CHECK(mParent.mVersion == ID3_V1 || mParent.mVersion == ID3_V1_1);
@@ -795,7 +932,7 @@ void ID3::Iterator::findFrame() {
                 return;
             }
 
-            mFrameData = &mParent.mData[mOffset];
+            mFrameData = &mParent.mTag[mOffset];
 
             switch (mOffset) {
                 case 3:
@@ -976,6 +1113,7 @@ bool ID3::parseV1(const sp<DataSource> &source) {
         return false;
     }
 
+    mTag = mData;
     mSize = V1_TAG_SIZE;
     mFirstFrameOffset = 3;
 
@@ -35,6 +35,7 @@ public:
     // DataSource implementation.
     virtual status_t initCheck() const;
     virtual ssize_t readAt(off64_t offset, void *data, size_t size);
+    virtual void readAtRanges(ReadRange *ranges, size_t count);
     virtual status_t getSize(off64_t *size);
     virtual uint32_t flags();
     virtual void close();
@@ -47,8 +48,13 @@ private:
     sp<IDataSource> mIDataSource;
     sp<IMemory> mMemory;
     bool mIsClosed;
+    // the IDataSource only implements readAt
+    bool mReadAtRangesUnsupported;
     String8 mName;
 
+    // Reads ranges that fit the memory together with one readAtRanges call.
+    status_t readBatch(ReadRange *ranges, size_t count);
+
     DISALLOW_EVIL_CONSTRUCTORS(CallbackDataSource);
 };
 
@@ -63,6 +69,9 @@ public:
 
     virtual status_t initCheck() const;
     virtual ssize_t readAt(off64_t offset, void* data, size_t size);
+    virtual void readAtRanges(ReadRange *ranges, size_t count) {
+        mSource->readAtRanges(ranges, count);
+    }
     virtual status_t getSize(off64_t* size);
     virtual uint32_t flags();
     virtual void close() { mSource->close(); }
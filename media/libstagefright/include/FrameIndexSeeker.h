@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRAME_INDEX_SEEKER_H_
+
+#define FRAME_INDEX_SEEKER_H_
+
+#include "include/MP3Seeker.h"
+
+#include <utils/Mutex.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+class DataSource;
+
+// Seeks in files without a XING or VBRI table by walking the frame headers, which is exact
+// for variable bitrate files, unlike an estimate from the bitrate of the first frame. The
+// offset of every kFramesPerEntry-th frame is kept, so that a seek walks at most that many
+// headers once the index covers the target. The index is extended on demand, by at most
+// kMaxScanSize bytes per seek, past which the seek falls back to the bitrate estimate.
+struct FrameIndexSeeker : public MP3Seeker {
+    enum {
+        kFramesPerEntry = 64,
+        kMaxScanSize    = 16 * 1024 * 1024,
+    };
+
+    static sp<FrameIndexSeeker> CreateFromSource(
+            const sp<DataSource> &source, off64_t first_frame_pos, uint32_t fixed_header);
+
+    virtual bool getDuration(int64_t *durationUs);
+    virtual bool getOffsetForTime(int64_t *timeUs, off64_t *pos);
+
+private:
+    struct Entry {
+        off64_t mOffset;
+        int64_t mSample;
+    };
+
+    enum {
+        kBufferSize = 16 * 1024,
+    };
+
+    Mutex mLock;
+    sp<DataSource> mSource;
+    uint32_t mFixedHeader;
+    int mSampleRate;
+
+    Vector<Entry> mIndex;
+
+    // the first frame not indexed yet
+    off64_t mScanPos;
+    int64_t mScanSample;
+    size_t mScanFrames;
+    // the last frame indexed
+    off64_t mLastFramePos;
+    int64_t mLastFrameSample;
+    bool mScanDone;
+    // the scan stopped on something other than a frame, rather than at the end of the file
+    bool mScanFailed;
+
+    uint8_t mBuffer[kBufferSize];
+    off64_t mBufferOffset;
+    size_t mBufferSize;
+
+    FrameIndexSeeker(const sp<DataSource> &source, off64_t first_frame_pos,
+            uint32_t fixed_header, int sample_rate);
+
+    // Reads the header of the frame at |pos|, returning false at the end of the source.
+    bool readHeader(off64_t pos, uint32_t *header);
+    // Parses the frame at |pos|, returning false if there is no frame of the stream there.
+    bool parseFrame(off64_t pos, size_t *frameSize, int *numSamples, bool *eos);
+    void scanTo(int64_t sample);
+
+    DISALLOW_EVIL_CONSTRUCTORS(FrameIndexSeeker);
+};
+
+}  // namespace android
+
+#endif  // FRAME_INDEX_SEEKER_H_
@@ -18,6 +18,7 @@
 
 #define ID3_H_
 
+#include <utils/KeyedVector.h>
 #include <utils/RefBase.h>
 
 namespace android {
@@ -35,7 +36,11 @@ struct ID3 {
         ID3_V2_4,
     };
 
+    // The frames are read from |source| as they are asked for, unless the tag
+    // has to be rewritten to undo its unsynchronization.
     ID3(const sp<DataSource> &source, bool ignoreV1 = false, off64_t offset = 0);
+
+    // The frames are used in place, |data| must outlive the ID3 object.
     ID3(const uint8_t *data, size_t size, bool ignoreV1 = false);
     ~ID3();
 
@@ -76,7 +81,10 @@ struct ID3 {
 
 private:
     bool mIsValid;
-    uint8_t *mData;
+    uint8_t *mData;         // the tag, if it had to be read in full
+    const uint8_t *mTag;    // the tag in memory, NULL if read from mSource
+    sp<DataSource> mSource;
+    off64_t mTagOffset;     // of the tag in mSource, after the header
     size_t mSize;
     size_t mFirstFrameOffset;
     Version mVersion;
@@ -85,10 +93,23 @@ private:
     // only valid for IDV2+
     size_t mRawSize;
 
+    // the frames read from mSource, by offset in the tag
+    mutable KeyedVector<size_t, uint8_t *> mFrames;
+
     bool parseV1(const sp<DataSource> &source);
     bool parseV2(const sp<DataSource> &source, off64_t offset);
+    void clearTag();
     void removeUnsynchronization();
     bool removeUnsynchronizationV2_4(bool iTunesHack);
+    static bool HasUnsynchronizedFramesV2_4(
+            const sp<DataSource> &source, off64_t offset, size_t size);
+
+    // Returns |size| bytes of the tag at |offset|, read into |buffer| if the
+    // tag is not in memory. Returns NULL if they cannot be read.
+    const uint8_t *readTag(size_t offset, uint8_t *buffer, size_t size) const;
+
+    // Returns the data of a frame, valid as long as the ID3 object.
+    const uint8_t *getFrameData(size_t offset, size_t size) const;
 
     static bool ParseSyncsafeInteger(const uint8_t encoded[4], size_t *x);
 
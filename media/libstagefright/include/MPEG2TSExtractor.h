@@ -70,6 +70,18 @@ private:
 
     off64_t mOffset;
 
+    // The first PCR after the first sync point of the seek track, and the time of
+    // that sync point: the time at any other offset is told from the PCR there,
+    // without parsing the stream up to it.
+    int32_t mPCRPID;
+    bool mReferencePCRValid;
+    uint64_t mReferencePCR;
+    int64_t mReferenceTimeUs;
+
+    // Times and offsets of the PCRs read by seeks, a sparse index of the areas
+    // the parser skipped.
+    KeyedVector<int64_t, off64_t> mPCRPoints;
+
     void init();
     // Try to feed more data from source to parser.
     // |isInit| means this function is called inside init(). This is a signal to
@@ -84,6 +96,16 @@ private:
     status_t queueDiscontinuityForSeek(int64_t actualSeekTimeUs);
     status_t seekBeyond(int64_t seekTimeUs);
 
+    // Reads the first PCR of the program clock from |offset| on.
+    status_t readPCRAt(off64_t offset, off64_t *pcrOffset, uint64_t *PCR);
+    // Same, but returns the time of the PCR.
+    status_t readPCRTimeAt(off64_t offset, off64_t *pcrOffset, int64_t *timeUs);
+    // Bisects the area around |seekTimeUs| not yet indexed by its PCRs, and returns
+    // the offset and time of a PCR no later than |targetTimeUs|, that is closer to it
+    // than the sync point at |syncIndex| of mSeekSyncPoints.
+    status_t findOffsetByPCR(
+            int64_t targetTimeUs, size_t syncIndex, off64_t *offset, int64_t *timeUs);
+
     status_t feedUntilBufferAvailable(const sp<AnotherPacketSource> &impl);
 
     // Add a SynPoint derived from |event|.
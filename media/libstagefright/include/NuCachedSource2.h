@@ -21,10 +21,12 @@
 #include <media/stagefright/foundation/ABase.h>
 #include <media/stagefright/foundation/AHandlerReflector.h>
 #include <media/stagefright/DataSource.h>
+#include <utils/RWLock.h>
 
 namespace android {
 
 struct ALooper;
+struct DiskCache;
 struct PageCache;
 
 struct NuCachedSource2 : public DataSource {
@@ -109,8 +111,19 @@ private:
     mutable Mutex mLock;
     Condition mCondition;
 
+    // Guards the pages of mCache and mRetainedRanges. Changing them takes mLock
+    // and then the write side, readAt() copies from them on the read side only.
+    RWLock mPagesLock;
+
     PageCache *mCache;
     off64_t mCacheOffset;
+
+    // Ranges cached before seeking elsewhere, keyed by their offsets. They take
+    // up to half the high water threshold on top of the range being fetched,
+    // which continues into them rather than fetching them again.
+    KeyedVector<off64_t, PageCache *> mRetainedRanges;
+
+    DiskCache *mDiskCache;
     status_t mFinalStatus;
     off64_t mLastAccessPos;
     sp<AMessage> mAsyncResult;
@@ -136,6 +149,11 @@ private:
     ssize_t readInternal(off64_t offset, void *data, size_t size);
     status_t seekInternal_l(off64_t offset);
 
+    // Returns the index of the retained range holding |size| bytes at |offset|, or -1.
+    ssize_t findRetainedRange_l(off64_t offset, size_t size) const;
+    void evictRetainedRanges_l();
+    void mergeRetainedRanges_l();
+
     size_t approxDataRemaining_l(status_t *finalStatus) const;
 
     void restartPrefetcherIfNecessary_l(
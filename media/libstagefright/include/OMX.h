@@ -85,6 +85,10 @@ public:
             node_id node, OMX_U32 port_index, const sp<IMemory> &params,
             buffer_id *buffer, OMX_U32 allottedSize);
 
+    virtual status_t useBuffers(
+            node_id node, OMX_U32 port_index, const Vector<sp<IMemory> > &params,
+            Vector<buffer_id> *buffers, OMX_U32 allottedSize);
+
     virtual status_t useGraphicBuffer(
             node_id node, OMX_U32 port_index,
             const sp<GraphicBuffer> &graphicBuffer, buffer_id *buffer);
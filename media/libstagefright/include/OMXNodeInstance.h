@@ -24,6 +24,8 @@
 #include <utils/SortedVector.h>
 #include <utils/threads.h>
 
+#include <atomic>
+
 namespace android {
 
 class IOMXObserver;
@@ -164,16 +166,25 @@ private:
     sp<GraphicBufferSource> mGraphicBufferSource;
 
 
-    struct ActiveBuffer {
+    // for buffer id to buffer ptr translation. A buffer id is the index of its slot, tagged
+    // with a generation so that the id of a freed buffer no longer matches once its slot is
+    // reused. Slots are read without locking, and taken and released under mBufferIDLock.
+    enum {
+        kBufferSlotBits = 8,
+        kMaxBufferSlots = 1 << kBufferSlotBits,
+    };
+    struct BufferSlot {
+        std::atomic<OMX::buffer_id> mID;    // 0 if the slot is free
+        std::atomic<OMX_BUFFERHEADERTYPE *> mHeader;
+        // whether the buffer is to be freed by freeActiveBuffers, under mLock
+        bool mActive;
         OMX_U32 mPortIndex;
-        OMX::buffer_id mID;
     };
-    Vector<ActiveBuffer> mActiveBuffers;
-    // for buffer ptr to buffer id translation
+    BufferSlot mBufferSlots[kMaxBufferSlots];
+    size_t mNumActiveBuffers;
     Mutex mBufferIDLock;
     uint32_t mBufferIDCount;
-    KeyedVector<OMX::buffer_id, OMX_BUFFERHEADERTYPE *> mBufferIDToBufferHeader;
-    KeyedVector<OMX_BUFFERHEADERTYPE *, OMX::buffer_id> mBufferHeaderToBufferID;
+    size_t mNextBufferSlot;
 
     // metadata and secure buffer type tracking
     MetadataBufferType mMetadataType[2];
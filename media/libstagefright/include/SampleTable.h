@@ -123,7 +123,7 @@ private:
     };
     SampleTimeEntry *mSampleTimeEntries;
 
-    int32_t *mCompositionTimeDeltaEntries;
+    off64_t mCompositionTimeDeltaOffset;
     size_t mNumCompositionTimeDeltaEntries;
     CompositionDeltaLookup *mCompositionDeltaLookup;
 
@@ -144,6 +144,23 @@ private:
     // Approximate size of all tables combined.
     uint64_t mTotalSize;
 
+    // The chunk offset, sample size and composition time tables, which can have an entry per
+    // sample, are not loaded but read on demand, through a few cached windows of the source.
+    enum {
+        kTableWindowSize = 4096,
+        kNumTableWindows = 8,
+    };
+    struct TableWindow {
+        off64_t mOffset;  // a multiple of kTableWindowSize, or -1
+        size_t mSize;
+        uint64_t mLastUse;
+        uint8_t mData[kTableWindowSize];
+    };
+    Mutex mTableWindowLock;
+    TableWindow *mTableWindows;
+    size_t mLastTableWindow;
+    uint64_t mTableWindowUseCount;
+
     friend struct SampleIterator;
 
     // normally we don't round
@@ -155,6 +172,10 @@ private:
     }
 
     status_t getSampleSize_l(uint32_t sample_index, size_t *sample_size);
+
+    // Reads |size| bytes of a table at |offset| through the table windows.
+    status_t readTableData(off64_t offset, void *data, size_t size);
+
     int32_t getCompositionTimeOffset(uint32_t sampleIndex);
 
     static int CompareIncreasingTime(const void *, const void *);
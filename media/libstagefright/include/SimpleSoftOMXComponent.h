@@ -21,6 +21,7 @@
 #include "SoftOMXComponent.h"
 
 #include <media/stagefright/foundation/AHandlerReflector.h>
+#include <system/window.h>
 #include <utils/RefBase.h>
 #include <utils/threads.h>
 #include <utils/Vector.h>
@@ -44,6 +45,8 @@ protected:
     struct BufferInfo {
         OMX_BUFFERHEADERTYPE *mHeader;
         bool mOwnedByUs;
+        // for graphic buffers, whose header points to the buffer handle
+        sp<ANativeWindowBuffer> mGraphicBuffer;
     };
 
     struct PortInfo {
@@ -61,10 +64,21 @@ protected:
     enum {
         kStoreMetaDataExtensionIndex = OMX_IndexVendorStartUnused + 1,
         kPrepareForAdaptivePlaybackIndex,
+        kUseAndroidNativeBufferIndex,
     };
 
     void addPort(const OMX_PARAM_PORTDEFINITIONTYPE &def);
 
+    // Same as useBuffer(), for use from internalSetParameter(). If graphicBuffer is set, ptr
+    // is its handle and a reference on it is held until the buffer is freed.
+    OMX_ERRORTYPE internalUseBuffer(
+            OMX_BUFFERHEADERTYPE **buffer,
+            OMX_U32 portIndex,
+            OMX_PTR appPrivate,
+            OMX_U32 size,
+            OMX_U8 *ptr,
+            const sp<ANativeWindowBuffer> &graphicBuffer = NULL);
+
     virtual OMX_ERRORTYPE internalGetParameter(
             OMX_INDEXTYPE index, OMX_PTR params);
 
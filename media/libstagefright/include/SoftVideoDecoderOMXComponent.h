@@ -20,6 +20,7 @@
 
 #include "SimpleSoftOMXComponent.h"
 
+#include <media/stagefright/foundation/ABuffer.h>
 #include <media/stagefright/foundation/AHandlerReflector.h>
 #include <media/stagefright/foundation/ColorUtils.h>
 #include <media/IOMX.h>
@@ -30,6 +31,8 @@
 
 namespace android {
 
+struct FramePool;
+
 struct SoftVideoDecoderOMXComponent : public SimpleSoftOMXComponent {
     SoftVideoDecoderOMXComponent(
             const char *name,
@@ -43,9 +46,20 @@ struct SoftVideoDecoderOMXComponent : public SimpleSoftOMXComponent {
             OMX_PTR appData,
             OMX_COMPONENTTYPE **component);
 
+    // Allocates the frame sized memory of the decoder, e.g. its reference frames, from a pool
+    // kept for the life of the component. The frames freed by a resolution change are reused
+    // for the new resolution instead of being reallocated. These are public for the allocator
+    // callbacks of the decoder libraries, whose memory context is the component.
+    void *allocateFrameMemory(size_t alignment, size_t size);
+    void freeFrameMemory(void *data);
+
 protected:
+    virtual ~SoftVideoDecoderOMXComponent();
+
     enum {
-        kDescribeColorAspectsIndex = kPrepareForAdaptivePlaybackIndex + 1,
+        kDescribeColorAspectsIndex = kUseAndroidNativeBufferIndex + 1,
+        kEnableAndroidNativeBuffersIndex,
+        kGetAndroidNativeBufferUsageIndex,
     };
 
     enum {
@@ -76,6 +90,11 @@ protected:
 
     virtual int getColorAspectPreference();
 
+    // Whether the decoder writes its frames through lockOutputBuffer(), so that they can be
+    // decoded into the graphic buffers of a native window instead of being copied there by
+    // the software renderer.
+    virtual bool supportsNativeBuffers();
+
     // This function sets both minimum buffer count and actual buffer count of
     // input port to be |numInputBuffers|. It will also set both minimum buffer
     // count and actual buffer count of output port to be |numOutputBuffers|.
@@ -115,10 +134,42 @@ protected:
             bool *portWillReset, uint32_t width, uint32_t height,
             CropSettingsMode cropSettingsMode = kCropUnSet, bool fakeStride = false);
 
+    // Writable planes of an output buffer.
+    struct OutputPlanes {
+        uint8_t *mY;
+        uint8_t *mU;
+        uint8_t *mV;
+        size_t mYStride;
+        size_t mUVStride;
+    };
+
+    // Luma stride of the output buffers returned by lockOutputBuffer(), whose chroma planes
+    // are at half of it.
+    uint32_t outputBufferStride();
+
+    // Locks the output buffer of |header| to write a frame into it. Graphic buffers are
+    // written in place if their layout allows it, or else through an intermediate frame that
+    // is copied into them by unlockOutputBuffer(). Returns false if the buffer is too small
+    // or can't be locked.
+    bool lockOutputBuffer(OMX_BUFFERHEADERTYPE *header, OutputPlanes *planes);
+    void unlockOutputBuffer(OMX_BUFFERHEADERTYPE *header);
+
+    // Returns the number of threads that the decoder may use for the current frame size, at
+    // most |maxThreads|. The online CPU cores are shared among the video decoders of the
+    // process: a decoder gets one thread per kMacroblocksPerDecodeThread macroblocks of its
+    // frames, out of the cores that the others don't use, but always its even share of them.
+    // Call again after a change of frame size, and releaseDecodeThreads() once done decoding.
+    size_t acquireDecodeThreads(size_t maxThreads);
+    void releaseDecodeThreads();
+
     void copyYV12FrameToOutputBuffer(
             uint8_t *dst, const uint8_t *srcY, const uint8_t *srcU, const uint8_t *srcV,
             size_t srcYStride, size_t srcUStride, size_t srcVStride);
 
+    void copyYV12FrameToOutputPlanes(
+            const OutputPlanes &dst, const uint8_t *srcY, const uint8_t *srcU,
+            const uint8_t *srcV, size_t srcYStride, size_t srcUStride, size_t srcVStride);
+
     enum {
         kInputPortIndex  = 0,
         kOutputPortIndex = 1,
@@ -160,6 +211,29 @@ protected:
     void dumpColorAspects(const ColorAspects &colorAspects);
 
 private:
+    // whether the output buffers are graphic buffers of a native window
+    bool mUseNativeBuffers;
+    // luma stride of the graphic buffers if they can be written in place, or 0
+    uint32_t mNativeBufferStride;
+    // intermediate frame for the graphic buffers that can't
+    sp<ABuffer> mNativeBufferFrame;
+
+    sp<FramePool> mFramePool;
+
+    // Gets the planes of the locked graphic buffer |buffer| at |data|.
+    static void getNativeBufferPlanes(
+            const sp<ANativeWindowBuffer> &buffer, uint8_t *data, OutputPlanes *planes);
+
+    sp<ANativeWindowBuffer> getNativeBuffer(OMX_BUFFERHEADERTYPE *header);
+
+    enum {
+        // a quarter of 1080p frames
+        kMacroblocksPerDecodeThread = 2040,
+    };
+
+    // threads counted in the decode budget of the process, or 0
+    size_t mDecodeThreads;
+
     uint32_t mMinInputBufferSize;
     uint32_t mMinCompressionRatio;
 
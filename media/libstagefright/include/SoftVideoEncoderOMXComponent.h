@@ -43,6 +43,9 @@ struct SoftVideoEncoderOMXComponent : public SimpleSoftOMXComponent {
     virtual OMX_ERRORTYPE internalSetParameter(OMX_INDEXTYPE index, const OMX_PTR param);
     virtual OMX_ERRORTYPE internalGetParameter(OMX_INDEXTYPE index, OMX_PTR params);
 
+    virtual OMX_ERRORTYPE getConfig(OMX_INDEXTYPE index, OMX_PTR params);
+    virtual OMX_ERRORTYPE setConfig(OMX_INDEXTYPE index, const OMX_PTR params);
+
 protected:
     void initPorts(
             OMX_U32 numInputBuffers, OMX_U32 numOutputBuffers, OMX_U32 outputBufferSize,
@@ -68,6 +71,10 @@ protected:
 
     virtual OMX_ERRORTYPE getExtensionIndex(const char *name, OMX_INDEXTYPE *index);
 
+    // Number of threads to encode the frames in real time, one per kMacroblocksPerEncodeThread
+    // macroblocks of them, at most |maxThreads| and the online CPU cores.
+    size_t getRealTimeEncodeThreads(size_t maxThreads) const;
+
     enum {
         kInputPortIndex = 0,
         kOutputPortIndex = 1,
@@ -79,11 +86,15 @@ protected:
     uint32_t mBitrate;   // target bitrate set for the encoder, in bits per second
     uint32_t mFramerate; // target framerate set for the encoder, in Q16 format
     OMX_COLOR_FORMATTYPE mColorFormat;  // Color format for the input port
+    bool mRealTime;      // priority 0 was set: favor encoding speed and latency over quality
 
 private:
     void updatePortParams();
     OMX_ERRORTYPE internalSetPortParams(const OMX_PARAM_PORTDEFINITIONTYPE* port);
 
+    // a quarter of 1080p frames
+    static const size_t kMacroblocksPerEncodeThread = 2040;
+
     static const uint32_t kInputBufferAlignment = 1;
     static const uint32_t kOutputBufferAlignment = 2;
 
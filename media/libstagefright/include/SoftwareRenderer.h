@@ -21,6 +21,7 @@
 #include <media/stagefright/ColorConverter.h>
 #include <media/stagefright/FrameRenderTracker.h>
 #include <utils/RefBase.h>
+#include <utils/Vector.h>
 #include <system/window.h>
 
 #include <list>
@@ -46,6 +47,17 @@ private:
         None,
     };
 
+    enum {
+        // frames this large are converted in bands of rows on several threads
+        kMinPixelsForBands = 1280 * 720,
+        kMaxNumBands = 4,
+    };
+
+    struct BandJob;
+    struct BandWorker;
+    struct ConvertJob;
+    struct YV12CopyJob;
+
     OMX_COLOR_FORMATTYPE mColorFormat;
     ColorConverter *mConverter;
     YUVMode mYUVMode;
@@ -56,11 +68,18 @@ private:
     int32_t mRotationDegrees;
     android_dataspace mDataSpace;
     FrameRenderTracker mRenderTracker;
+    Vector<sp<BandWorker> > mBandWorkers;
 
     SoftwareRenderer(const SoftwareRenderer &);
     SoftwareRenderer &operator=(const SoftwareRenderer &);
 
     void resetFormatIfChanged(const sp<AMessage> &format);
+
+    void startBandWorkers();
+
+    // Runs |job| over |numRows| rows, split in bands of an even number of rows
+    // if |split| is set and the frame is large enough.
+    void runInBands(BandJob *job, size_t numRows, bool split);
 };
 
 }  // namespace android
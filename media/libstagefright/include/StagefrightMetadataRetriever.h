@@ -52,8 +52,11 @@ private:
     KeyedVector<int, String8> mMetaData;
     MediaAlbumArt *mAlbumArt;
 
+    struct FrameDecoder;
+    FrameDecoder *mFrameDecoder;
+
     void parseMetaData();
-    // Delete album art and clear metadata.
+    // Delete album art and clear metadata, release the frame decoder.
     void clearMetadata();
 
     StagefrightMetadataRetriever(const StagefrightMetadataRetriever &);
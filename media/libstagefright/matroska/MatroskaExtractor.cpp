@@ -115,6 +115,8 @@ private:
     long mBlockEntryIndex;
 
     void advance_l();
+    bool seekToCuePoint_l(int64_t seekTimeNs);
+    bool seekToCluster_l(int64_t seekTimeNs);
 
     BlockIterator(const BlockIterator &);
     BlockIterator &operator=(const BlockIterator &);
@@ -414,18 +416,44 @@ void BlockIterator::seek(
                 break;
             }
         }
+    }
 
-        if (!pCues) {
-            ALOGE("No Cues in file");
+    if (pCues) {
+        if (!seekToCuePoint_l(seekTimeNs)) {
+            return;
+        }
+    } else {
+        ALOGV("No Cues in file, seeking by cluster");
+        if (!seekToCluster_l(seekTimeNs)) {
             return;
         }
     }
-    else if (!pSH) {
-        ALOGE("No SeekHead");
-        return;
+
+    const mkvparser::Track *thisTrack = pSegment->GetTracks()->GetTrackByNumber(mTrackNum);
+
+    for (;;) {
+        advance_l();
+
+        if (eos()) break;
+
+        if (isAudio || block()->IsKey()) {
+            // Accept the first key frame
+            int64_t frameTimeUs = (block()->GetTime(mCluster) + 500LL) / 1000LL;
+            if (thisTrack->GetType() == 1 || frameTimeUs >= seekTimeUs) {
+                *actualFrameTimeUs = frameTimeUs;
+                ALOGV("Requested seek point: %" PRId64 " actual: %" PRId64,
+                      seekTimeUs, *actualFrameTimeUs);
+                break;
+            }
+        }
     }
+}
+
+bool BlockIterator::seekToCuePoint_l(int64_t seekTimeNs) {
+    mkvparser::Segment* const pSegment = mExtractor->mSegment;
 
     const mkvparser::CuePoint* pCP;
+    const mkvparser::Cues* pCues = pSegment->GetCues();
     mkvparser::Tracks const *pTracks = pSegment->GetTracks();
     while (!pCues->DoneParsing()) {
         pCues->LoadCuePoint();
@@ -468,7 +496,7 @@ void BlockIterator::seek(
     // Always *search* based on the video track, but finalize based on mTrackNum
     if (!pTP) {
         ALOGE("Did not locate the video track for seeking");
-        return;
+        return false;
     }
 
     mCluster = pSegment->FindOrPreloadCluster(pTP->m_pos);
@@ -480,22 +508,38 @@ void BlockIterator::seek(
     CHECK_GT(pTP->m_block, 0);
     mBlockEntryIndex = pTP->m_block - 1;
 
-    for (;;) {
-        advance_l();
+    return true;
+}
 
-        if (eos()) break;
+bool BlockIterator::seekToCluster_l(int64_t seekTimeNs) {
+    mkvparser::Segment* const pSegment = mExtractor->mSegment;
 
-        if (isAudio || block()->IsKey()) {
-            // Accept the first key frame
-            int64_t frameTimeUs = (block()->GetTime(mCluster) + 500LL) / 1000LL;
-            if (thisTrack->GetType() == 1 || frameTimeUs >= seekTimeUs) {
-                *actualFrameTimeUs = frameTimeUs;
-                ALOGV("Requested seek point: %" PRId64 " actual: %" PRId64,
-                      seekTimeUs, *actualFrameTimeUs);
-                break;
-            }
+    // The segment keeps the clusters it has parsed, in order. Parse past the last of them only
+    // if it starts before the requested time, then binary search the loaded clusters, so that
+    // the file is only walked once.
+    const mkvparser::Cluster *cluster = pSegment->GetLast();
+    if (cluster == NULL || cluster->EOS()) {
+        cluster = pSegment->GetFirst();
+    }
+    while (cluster != NULL && !cluster->EOS() && cluster->GetTime() < seekTimeNs) {
+        const mkvparser::Cluster *nextCluster;
+        long long pos;
+        long len;
+        if (pSegment->ParseNext(cluster, nextCluster, pos, len) != 0
+                || nextCluster == NULL || nextCluster->EOS()) {
+            break;
         }
+        cluster = nextCluster;
     }
+
+    mCluster = pSegment->FindCluster(seekTimeNs);
+    if (mCluster == NULL || mCluster->EOS()) {
+        ALOGE("Did not locate a cluster for seeking");
+        return false;
+    }
+    mBlockEntry = NULL;
+    mBlockEntryIndex = 0;
+    return true;
 }
 
 const mkvparser::Block *BlockIterator::block() const {
@@ -54,13 +54,8 @@ struct ATSParser::Program : public RefBase {
     bool parsePSISection(
             unsigned pid, ABitReader *br, status_t *err);
 
-    // Pass to appropriate stream according to pid, and set event if it's a PES
-    // with a sync frame.
-    // Note that the method itself does not touch event.
-    bool parsePID(
-            unsigned pid, unsigned continuity_counter,
-            unsigned payload_unit_start_indicator,
-            ABitReader *br, status_t *err, SyncEvent *event);
+    // Returns the stream of pid, NULL if the program has none.
+    Stream *findStreamByPID(unsigned pid);
 
     void signalDiscontinuity(
             DiscontinuityType type, const sp<AMessage> &extra);
@@ -127,7 +122,7 @@ struct ATSParser::Stream : public RefBase {
     status_t parse(
             unsigned continuity_counter,
             unsigned payload_unit_start_indicator,
-            ABitReader *br,
+            const uint8_t *data, size_t size,
             SyncEvent *event);
 
     void signalDiscontinuity(
@@ -245,21 +240,12 @@ bool ATSParser::Program::parsePSISection(
     return true;
 }
 
-bool ATSParser::Program::parsePID(
-        unsigned pid, unsigned continuity_counter,
-        unsigned payload_unit_start_indicator,
-        ABitReader *br, status_t *err, SyncEvent *event) {
-    *err = OK;
-
+ATSParser::Stream *ATSParser::Program::findStreamByPID(unsigned pid) {
     ssize_t index = mStreams.indexOfKey(pid);
     if (index < 0) {
-        return false;
+        return NULL;
     }
-
-    *err = mStreams.editValueAt(index)->parse(
-            continuity_counter, payload_unit_start_indicator, br, event);
-
-    return true;
+    return mStreams.editValueAt(index).get();
 }
 
 void ATSParser::Program::signalDiscontinuity(
@@ -653,7 +639,8 @@ ATSParser::Stream::~Stream() {
 
 status_t ATSParser::Stream::parse(
         unsigned continuity_counter,
-        unsigned payload_unit_start_indicator, ABitReader *br,
+        unsigned payload_unit_start_indicator,
+        const uint8_t *data, size_t size,
         SyncEvent *event) {
     if (mQueue == NULL) {
         return OK;
@@ -712,13 +699,7 @@ status_t ATSParser::Stream::parse(
         return OK;
     }
 
-    size_t payloadSizeBits = br->numBitsLeft();
-    if (payloadSizeBits % 8 != 0u) {
-        ALOGE("Wrong value");
-        return BAD_VALUE;
-    }
-
-    size_t neededSize = mBuffer->size() + payloadSizeBits / 8;
+    size_t neededSize = mBuffer->size() + size;
     if (mBuffer->capacity() < neededSize) {
         // Increment in multiples of 64K.
         neededSize = (neededSize + 65535) & ~65535;
@@ -731,8 +712,8 @@ status_t ATSParser::Stream::parse(
         mBuffer = newBuffer;
     }
 
-    memcpy(mBuffer->data() + mBuffer->size(), br->data(), payloadSizeBits / 8);
-    mBuffer->setRange(0, mBuffer->size() + payloadSizeBits / 8);
+    memcpy(mBuffer->data() + mBuffer->size(), data, size);
+    mBuffer->setRange(0, mBuffer->size() + size);
 
     return OK;
 }
@@ -1172,6 +1153,7 @@ ATSParser::ATSParser(uint32_t flags)
       mNumTSPacketsParsed(0),
       mNumPCRs(0) {
     mPSISections.add(0 /* PID */, new PSISection);
+    resetPIDTable();
 }
 
 ATSParser::~ATSParser() {
@@ -1184,8 +1166,19 @@ status_t ATSParser::feedTSPacket(const void *data, size_t size,
         return BAD_VALUE;
     }
 
-    ABitReader br((const uint8_t *)data, kTSPacketSize);
-    return parseTS(&br, event);
+    return parseTS((const uint8_t *)data, event);
+}
+
+status_t ATSParser::feedTSPackets(const void *data, size_t numPackets) {
+    const uint8_t *packet = (const uint8_t *)data;
+    for (size_t i = 0; i < numPackets; ++i) {
+        status_t err = parseTS(packet, NULL);
+        if (err != OK) {
+            return err;
+        }
+        packet += kTSPacketSize;
+    }
+    return OK;
 }
 
 void ATSParser::signalDiscontinuity(
@@ -1310,83 +1303,92 @@ void ATSParser::parseProgramAssociationTable(ABitReader *br) {
     MY_LOGV("  CRC = 0x%08x", br->getBits(32));
 }
 
+void ATSParser::resetPIDTable() {
+    memset(mPIDTable, kPIDUnresolved, sizeof(mPIDTable));
+    mPIDStreams.clear();
+}
+
+uint16_t ATSParser::resolvePID(unsigned PID) {
+    if (mPSISections.indexOfKey(PID) >= 0) {
+        return mPIDTable[PID] = kPIDSection;
+    }
+
+    for (size_t i = 0; i < mPrograms.size(); ++i) {
+        Stream *stream = mPrograms.editItemAt(i)->findStreamByPID(PID);
+        if (stream != NULL) {
+            mPIDStreams.push_back(stream);
+            return mPIDTable[PID] = kPIDStream + mPIDStreams.size() - 1;
+        }
+    }
+
+    ALOGV("PID 0x%04x not handled.", PID);
+    return mPIDTable[PID] = kPIDUnhandled;
+}
+
 status_t ATSParser::parsePID(
-        ABitReader *br, unsigned PID,
+        const uint8_t *data, size_t size, unsigned PID,
         unsigned continuity_counter,
         unsigned payload_unit_start_indicator,
         SyncEvent *event) {
-    ssize_t sectionIndex = mPSISections.indexOfKey(PID);
+    uint16_t entry = mPIDTable[PID];
+    if (entry == kPIDUnresolved) {
+        entry = resolvePID(PID);
+    }
 
-    if (sectionIndex >= 0) {
-        sp<PSISection> section = mPSISections.valueAt(sectionIndex);
+    if (entry >= kPIDStream) {
+        return mPIDStreams[entry - kPIDStream]->parse(
+                continuity_counter, payload_unit_start_indicator, data, size, event);
+    } else if (entry == kPIDUnhandled) {
+        return OK;
+    }
 
-        if (payload_unit_start_indicator) {
-            if (!section->isEmpty()) {
-                ALOGW("parsePID encounters payload_unit_start_indicator when section is not empty");
-                section->clear();
-            }
+    sp<PSISection> section = mPSISections.valueFor(PID);
 
-            unsigned skip = br->getBits(8);
-            section->setSkipBytes(skip + 1);  // skip filler bytes + pointer field itself
-            br->skipBits(skip * 8);
+    if (payload_unit_start_indicator) {
+        if (!section->isEmpty()) {
+            ALOGW("parsePID encounters payload_unit_start_indicator when section is not empty");
+            section->clear();
         }
 
-        if (br->numBitsLeft() % 8 != 0) {
+        // skip filler bytes + pointer field itself
+        unsigned skip = (size > 0) ? data[0] + 1u : 1u;
+        if (skip > size) {
             return ERROR_MALFORMED;
         }
-        status_t err = section->append(br->data(), br->numBitsLeft() / 8);
-
-        if (err != OK) {
-            return err;
-        }
+        section->setSkipBytes(skip);
+        data += skip;
+        size -= skip;
+    }
 
-        if (!section->isComplete()) {
-            return OK;
-        }
+    status_t err = section->append(data, size);
 
-        if (!section->isCRCOkay()) {
-            return BAD_VALUE;
-        }
-        ABitReader sectionBits(section->data(), section->size());
+    if (err != OK) {
+        return err;
+    }
 
-        if (PID == 0) {
-            parseProgramAssociationTable(&sectionBits);
-        } else {
-            bool handled = false;
-            for (size_t i = 0; i < mPrograms.size(); ++i) {
-                status_t err;
-                if (!mPrograms.editItemAt(i)->parsePSISection(
-                            PID, &sectionBits, &err)) {
-                    continue;
-                }
+    if (!section->isComplete()) {
+        return OK;
+    }
 
-                if (err != OK) {
-                    return err;
-                }
+    if (!section->isCRCOkay()) {
+        return BAD_VALUE;
+    }
+    ABitReader sectionBits(section->data(), section->size());
 
-                handled = true;
-                break;
-            }
+    // the section may add programs, streams and sections, or change stream PIDs
+    resetPIDTable();
 
-            if (!handled) {
-                mPSISections.removeItem(PID);
-                section.clear();
+    if (PID == 0) {
+        parseProgramAssociationTable(&sectionBits);
+    } else {
+        bool handled = false;
+        for (size_t i = 0; i < mPrograms.size(); ++i) {
+            status_t err;
+            if (!mPrograms.editItemAt(i)->parsePSISection(
+                        PID, &sectionBits, &err)) {
+                continue;
             }
-        }
-
-        if (section != NULL) {
-            section->clear();
-        }
 
-        return OK;
-    }
-
-    bool handled = false;
-    for (size_t i = 0; i < mPrograms.size(); ++i) {
-        status_t err;
-        if (mPrograms.editItemAt(i)->parsePID(
-                    PID, continuity_counter, payload_unit_start_indicator,
-                    br, &err, event)) {
             if (err != OK) {
                 return err;
             }
@@ -1394,10 +1396,15 @@ status_t ATSParser::parsePID(
             handled = true;
             break;
         }
+
+        if (!handled) {
+            mPSISections.removeItem(PID);
+            section.clear();
+        }
     }
 
-    if (!handled) {
-        ALOGV("PID 0x%04x not handled.", PID);
+    if (section != NULL) {
+        section->clear();
     }
 
     return OK;
@@ -1462,46 +1469,52 @@ status_t ATSParser::parseAdaptationField(ABitReader *br, unsigned PID) {
     return OK;
 }
 
-status_t ATSParser::parseTS(ABitReader *br, SyncEvent *event) {
+status_t ATSParser::parseTS(const uint8_t *data, SyncEvent *event) {
     ALOGV("---");
 
-    unsigned sync_byte = br->getBits(8);
-    if (sync_byte != 0x47u) {
-        ALOGE("[error] parseTS: return error as sync_byte=0x%x", sync_byte);
+    if (data[0] != 0x47u) {
+        ALOGE("[error] parseTS: return error as sync_byte=0x%x", data[0]);
         return BAD_VALUE;
     }
 
-    if (br->getBits(1)) {  // transport_error_indicator
+    if (data[1] & 0x80) {  // transport_error_indicator
         // silently ignore.
         return OK;
     }
 
-    unsigned payload_unit_start_indicator = br->getBits(1);
-    ALOGV("payload_unit_start_indicator = %u", payload_unit_start_indicator);
-
-    MY_LOGV("transport_priority = %u", br->getBits(1));
-
-    unsigned PID = br->getBits(13);
-    ALOGV("PID = 0x%04x", PID);
-
-    MY_LOGV("transport_scrambling_control = %u", br->getBits(2));
-
-    unsigned adaptation_field_control = br->getBits(2);
-    ALOGV("adaptation_field_control = %u", adaptation_field_control);
+    unsigned payload_unit_start_indicator = (data[1] >> 6) & 1;
+    unsigned PID = ((data[1] & 0x1f) << 8) | data[2];
+    unsigned adaptation_field_control = (data[3] >> 4) & 3;
+    unsigned continuity_counter = data[3] & 0x0f;
+    ALOGV("PID = 0x%04x, payload_unit_start_indicator = %u, "
+            "adaptation_field_control = %u, continuity_counter = %u",
+            PID, payload_unit_start_indicator, adaptation_field_control,
+            continuity_counter);
 
-    unsigned continuity_counter = br->getBits(4);
-    ALOGV("PID = 0x%04x, continuity_counter = %u", PID, continuity_counter);
-
-    // ALOGI("PID = 0x%04x, continuity_counter = %u", PID, continuity_counter);
+    const uint8_t *payload = data + 4;
+    size_t payloadSize = kTSPacketSize - 4;
 
     status_t err = OK;
 
     if (adaptation_field_control == 2 || adaptation_field_control == 3) {
-        err = parseAdaptationField(br, PID);
+        unsigned adaptation_field_length = payload[0];
+        if (adaptation_field_length >= payloadSize) {
+            ALOGV("Adaptation field should be included in a single TS packet.");
+            err = ERROR_MALFORMED;
+        } else if (adaptation_field_length > 0 && (payload[1] & 0x10)) {
+            // only a PCR needs the adaptation field parsed, otherwise it is skipped
+            ABitReader br(data, kTSPacketSize);
+            br.skipBits(32);
+            err = parseAdaptationField(&br, PID);
+        }
+        if (err == OK) {
+            payload += 1 + adaptation_field_length;
+            payloadSize -= 1 + adaptation_field_length;
+        }
     }
     if (err == OK) {
         if (adaptation_field_control == 1 || adaptation_field_control == 3) {
-            err = parsePID(br, PID, continuity_counter,
+            err = parsePID(payload, payloadSize, PID, continuity_counter,
                     payload_unit_start_indicator, event);
         }
     }
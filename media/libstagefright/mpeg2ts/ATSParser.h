@@ -102,6 +102,10 @@ struct ATSParser : public RefBase {
     status_t feedTSPacket(
             const void *data, size_t size, SyncEvent *event = NULL);
 
+    // Feed |numPackets| consecutive 188-byte TS packets into the parser, stops at
+    // the first packet that fails to parse and returns its error.
+    status_t feedTSPackets(const void *data, size_t numPackets);
+
     void signalDiscontinuity(
             DiscontinuityType type, const sp<AMessage> &extra);
 
@@ -152,6 +156,20 @@ private:
     // Keyed by PID
     KeyedVector<unsigned, sp<PSISection> > mPSISections;
 
+    enum {
+        kNumPIDs = 8192,
+
+        kPIDUnresolved = 0,
+        kPIDUnhandled  = 1,
+        kPIDSection    = 2,
+        kPIDStream     = 3,  // and above, the stream at mPIDStreams[value - kPIDStream]
+    };
+
+    // What each PID is dispatched to, resolved from mPSISections and the streams of
+    // mPrograms on first use, and reset whenever a PSI section may have changed them.
+    uint16_t mPIDTable[kNumPIDs];
+    Vector<Stream *> mPIDStreams;
+
     int64_t mAbsoluteTimeAnchorUs;
 
     bool mTimeOffsetValid;
@@ -167,20 +185,22 @@ private:
     // Note that the method itself does not touch event.
     void parsePES(ABitReader *br, SyncEvent *event);
 
-    // Strip remaining packet headers and pass to appropriate program/stream
-    // to parse the payload. If the payload turns out to be PES and contains
-    // a sync frame, event shall be set with the time and start offset of the
-    // PES.
+    void resetPIDTable();
+    uint16_t resolvePID(unsigned PID);
+
+    // Pass the payload of a packet to the PSI section or the stream of the PID. If the
+    // payload turns out to be PES and contains a sync frame, event shall be set with
+    // the time and start offset of the PES.
     // Note that the method itself does not touch event.
     status_t parsePID(
-        ABitReader *br, unsigned PID,
+        const uint8_t *data, size_t size, unsigned PID,
         unsigned continuity_counter,
         unsigned payload_unit_start_indicator,
         SyncEvent *event);
 
     status_t parseAdaptationField(ABitReader *br, unsigned PID);
-    // see feedTSPacket().
-    status_t parseTS(ABitReader *br, SyncEvent *event);
+    // see feedTSPacket(). |data| holds kTSPacketSize bytes.
+    status_t parseTS(const uint8_t *data, SyncEvent *event);
 
     void updatePCR(unsigned PID, uint64_t PCR, uint64_t byteOffsetFromStart);
 
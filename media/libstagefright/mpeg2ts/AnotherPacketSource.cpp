@@ -44,6 +44,9 @@ AnotherPacketSource::AnotherPacketSource(const sp<MetaData> &meta)
       mEnabled(true),
       mFormat(NULL),
       mLastQueuedTimeUs(0),
+      mNumBuffers(0),
+      mNumDiscontinuities(0),
+      mBufferedBytes(0),
       mEOSResult(OK),
       mLatestEnqueuedMeta(NULL),
       mLatestDequeuedMeta(NULL) {
@@ -123,6 +126,7 @@ status_t AnotherPacketSource::dequeueAccessUnit(sp<ABuffer> *buffer) {
     if (!mBuffers.empty()) {
         *buffer = *mBuffers.begin();
         mBuffers.erase(mBuffers.begin());
+        onBufferDequeued_l(*buffer);
 
         int32_t discontinuity;
         if ((*buffer)->meta()->findInt32("discontinuity", &discontinuity)) {
@@ -160,6 +164,7 @@ void AnotherPacketSource::requeueAccessUnit(const sp<ABuffer> &buffer) {
     // TODO: update corresponding book keeping info.
     Mutex::Autolock autoLock(mLock);
     mBuffers.push_front(buffer);
+    onBufferQueued_l(buffer);
 }
 
 status_t AnotherPacketSource::read(
@@ -175,6 +180,7 @@ status_t AnotherPacketSource::read(
 
         const sp<ABuffer> buffer = *mBuffers.begin();
         mBuffers.erase(mBuffers.begin());
+        onBufferDequeued_l(buffer);
 
         int32_t discontinuity;
         if (buffer->meta()->findInt32("discontinuity", &discontinuity)) {
@@ -242,6 +248,34 @@ bool AnotherPacketSource::wasFormatChange(
     return false;
 }
 
+void AnotherPacketSource::onBufferQueued_l(const sp<ABuffer> &buffer) {
+    ++mNumBuffers;
+    mBufferedBytes += buffer->size();
+
+    int32_t discontinuity;
+    if (buffer->meta()->findInt32("discontinuity", &discontinuity)) {
+        ++mNumDiscontinuities;
+    }
+}
+
+void AnotherPacketSource::onBufferDequeued_l(const sp<ABuffer> &buffer) {
+    --mNumBuffers;
+    mBufferedBytes -= buffer->size();
+
+    int32_t discontinuity;
+    if (buffer->meta()->findInt32("discontinuity", &discontinuity)) {
+        --mNumDiscontinuities;
+    }
+}
+
+void AnotherPacketSource::eraseBuffers_l(
+        List<sp<ABuffer> >::iterator first, List<sp<ABuffer> >::iterator last) {
+    while (first != last) {
+        onBufferDequeued_l(*first);
+        first = mBuffers.erase(first);
+    }
+}
+
 void AnotherPacketSource::queueAccessUnit(const sp<ABuffer> &buffer) {
     int32_t damaged;
     if (buffer->meta()->findInt32("damaged", &damaged) && damaged) {
@@ -251,6 +285,7 @@ void AnotherPacketSource::queueAccessUnit(const sp<ABuffer> &buffer) {
 
     Mutex::Autolock autoLock(mLock);
     mBuffers.push_back(buffer);
+    onBufferQueued_l(buffer);
     mCondition.signal();
 
     int32_t discontinuity;
@@ -302,6 +337,9 @@ void AnotherPacketSource::clear() {
     Mutex::Autolock autoLock(mLock);
 
     mBuffers.clear();
+    mNumBuffers = 0;
+    mNumDiscontinuities = 0;
+    mBufferedBytes = 0;
     mEOSResult = OK;
 
     mDiscontinuitySegments.clear();
@@ -326,6 +364,7 @@ void AnotherPacketSource::queueDiscontinuity(
             int32_t oldDiscontinuityType;
             if (!oldBuffer->meta()->findInt32(
                         "discontinuity", &oldDiscontinuityType)) {
+                onBufferDequeued_l(oldBuffer);
                 it = mBuffers.erase(it);
                 continue;
             }
@@ -357,6 +396,7 @@ void AnotherPacketSource::queueDiscontinuity(
     buffer->meta()->setMessage("extra", extra);
 
     mBuffers.push_back(buffer);
+    onBufferQueued_l(buffer);
     mCondition.signal();
 }
 
@@ -388,12 +428,8 @@ bool AnotherPacketSource::hasDataBufferAvailable(status_t *finalResult) {
     if (!mEnabled) {
         return false;
     }
-    List<sp<ABuffer> >::iterator it;
-    for (it = mBuffers.begin(); it != mBuffers.end(); it++) {
-        int32_t discontinuity;
-        if (!(*it)->meta()->findInt32("discontinuity", &discontinuity)) {
-            return true;
-        }
+    if (mNumBuffers > mNumDiscontinuities) {
+        return true;
     }
 
     *finalResult = mEOSResult;
@@ -408,7 +444,7 @@ size_t AnotherPacketSource::getAvailableBufferCount(status_t *finalResult) {
         return 0;
     }
     if (!mBuffers.empty()) {
-        return mBuffers.size();
+        return mNumBuffers;
     }
     *finalResult = mEOSResult;
     return 0;
@@ -431,6 +467,11 @@ int64_t AnotherPacketSource::getBufferedDurationUs(status_t *finalResult) {
     return durationUs;
 }
 
+size_t AnotherPacketSource::getBufferedBytes() {
+    Mutex::Autolock autoLock(mLock);
+    return mBufferedBytes;
+}
+
 status_t AnotherPacketSource::nextBufferTime(int64_t *timeUs) {
     *timeUs = 0;
 
@@ -550,7 +591,7 @@ void AnotherPacketSource::trimBuffersAfterMeta(
         newLastQueuedTimeUs = curTime.mTimeUs;
     }
 
-    mBuffers.erase(it, mBuffers.end());
+    eraseBuffers_l(it, mBuffers.end());
     mLatestEnqueuedMeta = newLatestEnqueuedMeta;
     mLastQueuedTimeUs = newLastQueuedTimeUs;
 
@@ -620,7 +661,7 @@ sp<AMessage> AnotherPacketSource::trimBuffersBeforeMeta(
             break;
         }
     }
-    mBuffers.erase(mBuffers.begin(), it);
+    eraseBuffers_l(mBuffers.begin(), it);
     mLatestDequeuedMeta = NULL;
 
     // CHECK(!mDiscontinuitySegments.empty());
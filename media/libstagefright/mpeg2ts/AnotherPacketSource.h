@@ -57,6 +57,9 @@ struct AnotherPacketSource : public MediaSource {
     // presentation timestamps since the last discontinuity (if any).
     int64_t getBufferedDurationUs(status_t *finalResult);
 
+    // Returns the number of bytes held by the queued access units.
+    size_t getBufferedBytes();
+
     status_t nextBufferTime(int64_t *timeUs);
 
     void queueAccessUnit(const sp<ABuffer> &buffer);
@@ -114,12 +117,23 @@ private:
     sp<MetaData> mFormat;
     int64_t mLastQueuedTimeUs;
     List<sp<ABuffer> > mBuffers;
+    // List::size() walks the list, the queue is counted as it changes instead
+    size_t mNumBuffers;
+    size_t mNumDiscontinuities;
+    size_t mBufferedBytes;
     status_t mEOSResult;
     sp<AMessage> mLatestEnqueuedMeta;
     sp<AMessage> mLatestDequeuedMeta;
 
     bool wasFormatChange(int32_t discontinuityType) const;
 
+    // Account for a buffer entering or leaving mBuffers.
+    void onBufferQueued_l(const sp<ABuffer> &buffer);
+    void onBufferDequeued_l(const sp<ABuffer> &buffer);
+    // Erases [first, last) from mBuffers.
+    void eraseBuffers_l(
+            List<sp<ABuffer> >::iterator first, List<sp<ABuffer> >::iterator last);
+
     DISALLOW_EVIL_CONSTRUCTORS(AnotherPacketSource);
 };
 
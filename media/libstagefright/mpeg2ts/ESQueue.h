@@ -82,6 +82,10 @@ private:
     // returns its timestamp in us (or -1 if no time information).
     int64_t fetchTimestamp(size_t size);
 
+    // drop the first "size" bytes of mBuffer, by moving the start of its
+    // range rather than the data that follows.
+    void consumeBytes(size_t size);
+
     DISALLOW_EVIL_CONSTRUCTORS(ElementaryStreamQueue);
 };
 
@@ -41,6 +41,14 @@ namespace android {
 
 static const size_t kTSPacketSize = 188;
 
+// PCRs are sent at least every 100ms (ISO/IEC 13818-1, 2.7.2), a probe for one
+// reads blocks of packets until it is found.
+static const size_t kPCRProbeBlockSize = 256 * kTSPacketSize;
+static const size_t kMaxPCRProbeSize = 20 * kPCRProbeBlockSize;
+static const size_t kMaxPCRProbes = 16;
+// PCR seeks stop once this close before the target.
+static const int64_t kPCRSeekToleranceUs = 1000000ll;
+
 struct MPEG2TSSource : public MediaSource {
     MPEG2TSSource(
             const sp<MPEG2TSExtractor> &extractor,
@@ -113,7 +121,12 @@ MPEG2TSExtractor::MPEG2TSExtractor(const sp<DataSource> &source)
     : mDataSource(source),
       mParser(new ATSParser),
       mLastSyncEvent(0),
-      mOffset(0) {
+      mSeekSyncPoints(NULL),
+      mOffset(0),
+      mPCRPID(-1),
+      mReferencePCRValid(false),
+      mReferencePCR(0),
+      mReferenceTimeUs(0) {
     init();
 }
 
@@ -348,7 +361,42 @@ status_t MPEG2TSExtractor::seek(int64_t seekTimeUs,
             }
             break;
     }
-    if (!shouldSeekBeyond || mOffset <= mSeekSyncPoints->valueAt(index)) {
+
+    // Parsing from the sync point up to the seek time is slow when it is far, jump
+    // close to the seek time by the PCRs instead. Stop a sync interval before it, for
+    // the previous sync frame to be found from there.
+    bool seekedByPCR = false;
+    if (seekMode != MediaSource::ReadOptions::SEEK_NEXT_SYNC) {
+        size_t numPoints = mSeekSyncPoints->size() < 16 ? mSeekSyncPoints->size() : 16;
+        int64_t syncIntervalUs = 1000000ll;
+        if (numPoints >= 2) {
+            syncIntervalUs = (mSeekSyncPoints->keyAt(numPoints - 1)
+                    - mSeekSyncPoints->keyAt(0)) / (numPoints - 1);
+            if (syncIntervalUs < 100000ll) {
+                syncIntervalUs = 100000ll;
+            } else if (syncIntervalUs > 5000000ll) {
+                syncIntervalUs = 5000000ll;
+            }
+        }
+
+        int64_t targetTimeUs = seekTimeUs - syncIntervalUs;
+        off64_t offset;
+        int64_t timeUs;
+        if (targetTimeUs - mSeekSyncPoints->keyAt(index) > kPCRSeekToleranceUs
+                && findOffsetByPCR(targetTimeUs, index, &offset, &timeUs) == OK) {
+            ALOGV("seeking to %" PRId64 " us by PCR: %" PRId64 " us at offset %" PRId64,
+                    seekTimeUs, timeUs, (int64_t)offset);
+            mOffset = offset;
+            status_t err = queueDiscontinuityForSeek(timeUs);
+            if (err != OK) {
+                return err;
+            }
+            seekedByPCR = true;
+        }
+    }
+
+    if (!seekedByPCR
+            && (!shouldSeekBeyond || mOffset <= mSeekSyncPoints->valueAt(index))) {
         int64_t actualSeekTimeUs = mSeekSyncPoints->keyAt(index);
         mOffset = mSeekSyncPoints->valueAt(index);
         status_t err = queueDiscontinuityForSeek(actualSeekTimeUs);
@@ -357,7 +405,7 @@ status_t MPEG2TSExtractor::seek(int64_t seekTimeUs,
         }
     }
 
-    if (shouldSeekBeyond) {
+    if (!seekedByPCR && shouldSeekBeyond) {
         status_t err = seekBeyond(seekTimeUs);
         if (err != OK) {
             return err;
@@ -462,6 +510,182 @@ status_t MPEG2TSExtractor::seekBeyond(int64_t seekTimeUs) {
     return OK;
 }
 
+// Returns the PID and the 90kHz base of the PCR the packet carries, if any.
+static bool getPCR(const uint8_t *packet, unsigned *PID, uint64_t *PCR) {
+    if (packet[0] != 0x47
+            || (packet[1] & 0x80)           // transport_error_indicator
+            || (packet[3] & 0x20) == 0      // no adaptation field
+            || packet[4] < 7                // too short for a PCR
+            || (packet[5] & 0x10) == 0) {   // PCR_flag
+        return false;
+    }
+
+    *PID = ((packet[1] & 0x1f) << 8) | packet[2];
+    *PCR = ((uint64_t)packet[6] << 25) | (packet[7] << 17) | (packet[8] << 9)
+            | (packet[9] << 1) | (packet[10] >> 7);
+    return true;
+}
+
+status_t MPEG2TSExtractor::readPCRAt(off64_t offset, off64_t *pcrOffset, uint64_t *PCR) {
+    sp<ABuffer> block = new ABuffer(kPCRProbeBlockSize);
+    for (size_t probed = 0; probed < kMaxPCRProbeSize; probed += kPCRProbeBlockSize) {
+        ssize_t n = mDataSource->readAt(offset + probed, block->data(), kPCRProbeBlockSize);
+        if (n < (ssize_t)kTSPacketSize) {
+            return (n < 0) ? (status_t)n : ERROR_END_OF_STREAM;
+        }
+
+        for (size_t i = 0; i + kTSPacketSize <= (size_t)n; i += kTSPacketSize) {
+            unsigned PID;
+            if (getPCR(block->data() + i, &PID, PCR)
+                    && (mPCRPID < 0 || PID == (unsigned)mPCRPID)) {
+                mPCRPID = PID;
+                *pcrOffset = offset + probed + i;
+                return OK;
+            }
+        }
+    }
+    return NAME_NOT_FOUND;
+}
+
+status_t MPEG2TSExtractor::readPCRTimeAt(
+        off64_t offset, off64_t *pcrOffset, int64_t *timeUs) {
+    uint64_t PCR;
+    status_t err = readPCRAt(offset, pcrOffset, &PCR);
+    if (err != OK) {
+        return err;
+    }
+
+    // the PCR base has 33 bits, and wraps around every 26.5 hours
+    int64_t deltaPCR = (int64_t)((PCR - mReferencePCR) & ((1ull << 33) - 1));
+    if (deltaPCR >= (1ll << 32)) {
+        deltaPCR -= 1ll << 33;
+    }
+    *timeUs = mReferenceTimeUs + deltaPCR * 100 / 9;
+    return OK;
+}
+
+status_t MPEG2TSExtractor::findOffsetByPCR(
+        int64_t targetTimeUs, size_t syncIndex, off64_t *offset, int64_t *timeUs) {
+    off64_t size;
+    if (mDataSource->getSize(&size) != OK) {
+        return ERROR_UNSUPPORTED;
+    }
+
+    if (!mReferencePCRValid) {
+        off64_t pcrOffset;
+        status_t err = readPCRAt(mSeekSyncPoints->valueAt(0), &pcrOffset, &mReferencePCR);
+        if (err != OK) {
+            ALOGW("no PCR to seek by (%d)", err);
+            return err;
+        }
+        mReferenceTimeUs = mSeekSyncPoints->keyAt(0);
+        mReferencePCRValid = true;
+    }
+
+    // bracket the target with the sync points and the PCRs read before
+    off64_t lowOffset = mSeekSyncPoints->valueAt(syncIndex);
+    int64_t lowTimeUs = mSeekSyncPoints->keyAt(syncIndex);
+    off64_t highOffset = size;
+    int64_t highTimeUs = -1;
+    if (syncIndex + 1 < mSeekSyncPoints->size()) {
+        highOffset = mSeekSyncPoints->valueAt(syncIndex + 1);
+        highTimeUs = mSeekSyncPoints->keyAt(syncIndex + 1);
+    }
+
+    bool found = false;
+    for (size_t i = 0; i < mPCRPoints.size(); ++i) {
+        int64_t pointTimeUs = mPCRPoints.keyAt(i);
+        off64_t pointOffset = mPCRPoints.valueAt(i);
+        if (pointOffset <= lowOffset || pointOffset >= highOffset) {
+            continue;
+        }
+        if (pointTimeUs <= targetTimeUs && pointTimeUs > lowTimeUs) {
+            lowOffset = pointOffset;
+            lowTimeUs = pointTimeUs;
+            found = true;
+        } else if (pointTimeUs > targetTimeUs) {
+            highOffset = pointOffset;
+            highTimeUs = pointTimeUs;
+        }
+    }
+
+    // the bitrate seen so far, to guess beyond the last sync point
+    double bytesPerUs = 0.0;
+    size_t numPoints = mSeekSyncPoints->size();
+    if (numPoints >= 2
+            && mSeekSyncPoints->keyAt(numPoints - 1) > mSeekSyncPoints->keyAt(0)) {
+        bytesPerUs = (double)(mSeekSyncPoints->valueAt(numPoints - 1)
+                - mSeekSyncPoints->valueAt(0))
+                / (mSeekSyncPoints->keyAt(numPoints - 1) - mSeekSyncPoints->keyAt(0));
+    }
+
+    // the bitrate varies, when the guesses keep falling on the same side of the
+    // target, halve the bracket instead
+    int32_t sameSideProbes = 0;
+    bool lastProbeLow = false;
+    for (size_t probes = 0; probes < kMaxPCRProbes; ++probes) {
+        if (targetTimeUs - lowTimeUs <= kPCRSeekToleranceUs
+                || highOffset - lowOffset <= (off64_t)kPCRProbeBlockSize) {
+            break;
+        }
+
+        off64_t probeOffset;
+        if (sameSideProbes >= 2) {
+            probeOffset = lowOffset + (highOffset - lowOffset) / 2;
+        } else if (highTimeUs > lowTimeUs) {
+            probeOffset = lowOffset + (off64_t)((double)(highOffset - lowOffset)
+                    * (targetTimeUs - lowTimeUs) / (highTimeUs - lowTimeUs));
+        } else if (bytesPerUs > 0.0) {
+            probeOffset = lowOffset + (off64_t)(bytesPerUs * (targetTimeUs - lowTimeUs));
+        } else {
+            probeOffset = lowOffset + (highOffset - lowOffset) / 2;
+        }
+
+        // keep away from the ends of the bracket, so that it always shrinks
+        off64_t margin = (highOffset - lowOffset) / 16;
+        if (probeOffset < lowOffset + margin) {
+            probeOffset = lowOffset + margin;
+        } else if (probeOffset > highOffset - margin) {
+            probeOffset = highOffset - margin;
+        }
+        probeOffset -= probeOffset % kTSPacketSize;
+
+        off64_t pcrOffset;
+        int64_t pcrTimeUs;
+        status_t err = readPCRTimeAt(probeOffset, &pcrOffset, &pcrTimeUs);
+        if (err == ERROR_END_OF_STREAM || err == NAME_NOT_FOUND
+                || (err == OK && pcrOffset >= highOffset)) {
+            // nothing to go by beyond the probe
+            highOffset = probeOffset;
+            highTimeUs = -1;
+            continue;
+        } else if (err != OK) {
+            return err;
+        }
+
+        ALOGV("PCR at offset %" PRId64 ": %" PRId64 " us", (int64_t)pcrOffset, pcrTimeUs);
+        mPCRPoints.add(pcrTimeUs, pcrOffset);
+        bool probeLow = pcrTimeUs <= targetTimeUs;
+        sameSideProbes = (probes > 0 && probeLow == lastProbeLow) ? sameSideProbes + 1 : 1;
+        lastProbeLow = probeLow;
+        if (probeLow) {
+            lowOffset = pcrOffset;
+            lowTimeUs = pcrTimeUs;
+            found = true;
+        } else {
+            highOffset = pcrOffset;
+            highTimeUs = pcrTimeUs;
+        }
+    }
+
+    if (!found) {
+        return NAME_NOT_FOUND;
+    }
+    *offset = lowOffset;
+    *timeUs = lowTimeUs;
+    return OK;
+}
+
 status_t MPEG2TSExtractor::feedUntilBufferAvailable(
         const sp<AnotherPacketSource> &impl) {
     status_t finalResult;
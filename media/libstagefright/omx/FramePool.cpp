@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "FramePool"
+#include <utils/Log.h>
+
+#include "FramePool.h"
+
+#include <malloc.h>
+#include <stdlib.h>
+
+#include <media/stagefright/foundation/ADebug.h>
+
+namespace android {
+
+FramePool::FramePool()
+    : mUsedBytes(0),
+      mPeakUsedBytes(0),
+      mFreeBytes(0),
+      mReuseCount(0),
+      mAllocationCount(0) {
+}
+
+FramePool::~FramePool() {
+    ALOGV("%zu blocks reused, %zu allocated, peak %zu bytes",
+            mReuseCount, mAllocationCount, mPeakUsedBytes);
+    if (mUsedBlocks.size() > 0) {
+        ALOGW("%zu blocks still in use", mUsedBlocks.size());
+    }
+    clear();
+}
+
+// static
+size_t FramePool::SizeClass(size_t size) {
+    if (size <= 4) {
+        return size;
+    }
+    const size_t log2Size = sizeof(unsigned long) * 8 - 1 - __builtin_clzl(size);
+    const size_t step = (size_t)1 << (log2Size - 2);
+    return (size + step - 1) & ~(step - 1);
+}
+
+void *FramePool::allocate(size_t alignment, size_t size) {
+    if (size < kMinPooledSize || alignment > kAlignment || size > SIZE_MAX / 2) {
+        return memalign(alignment, size);
+    }
+
+    Mutex::Autolock autoLock(mLock);
+    Block block = { NULL, 0 };
+    for (size_t i = 0; i < mFreeBlocks.size(); ++i) {
+        const Block &freeBlock = mFreeBlocks.itemAt(i);
+        if (freeBlock.mCapacity >= size) {
+            if (freeBlock.mCapacity / kMaxWasteFactor <= size) {
+                block = freeBlock;
+                mFreeBlocks.removeAt(i);
+                mFreeBytes -= block.mCapacity;
+                ++mReuseCount;
+            }
+            break;
+        }
+    }
+    if (block.mData == NULL) {
+        block.mCapacity = SizeClass(size);
+        block.mData = memalign(kAlignment, block.mCapacity);
+        if (block.mData == NULL) {
+            ALOGE("Allocation failure for size %zu", block.mCapacity);
+            return NULL;
+        }
+        ++mAllocationCount;
+    }
+
+    mUsedBlocks.add(block.mData, block.mCapacity);
+    mUsedBytes += block.mCapacity;
+    if (mUsedBytes > mPeakUsedBytes) {
+        mPeakUsedBytes = mUsedBytes;
+    }
+    return block.mData;
+}
+
+void FramePool::free(void *data) {
+    if (data == NULL) {
+        return;
+    }
+
+    Mutex::Autolock autoLock(mLock);
+    ssize_t index = mUsedBlocks.indexOfKey(data);
+    if (index < 0) {
+        // not pooled
+        ::free(data);
+        return;
+    }
+
+    Block block = { data, mUsedBlocks.valueAt(index) };
+    mUsedBlocks.removeItemsAt(index);
+    mUsedBytes -= block.mCapacity;
+
+    size_t i = 0;
+    while (i < mFreeBlocks.size() && mFreeBlocks.itemAt(i).mCapacity < block.mCapacity) {
+        ++i;
+    }
+    mFreeBlocks.insertAt(block, i);
+    mFreeBytes += block.mCapacity;
+    evictFreeBlocks_l();
+}
+
+void FramePool::clear() {
+    Mutex::Autolock autoLock(mLock);
+    for (size_t i = 0; i < mFreeBlocks.size(); ++i) {
+        ::free(mFreeBlocks.itemAt(i).mData);
+    }
+    mFreeBlocks.clear();
+    mFreeBytes = 0;
+}
+
+size_t FramePool::freeBytes() {
+    Mutex::Autolock autoLock(mLock);
+    return mFreeBytes;
+}
+
+void FramePool::evictFreeBlocks_l() {
+    // the smallest blocks are the least likely to fit the frames of another resolution
+    while (mFreeBytes > mPeakUsedBytes) {
+        const Block &block = mFreeBlocks.itemAt(0);
+        mFreeBytes -= block.mCapacity;
+        ::free(block.mData);
+        mFreeBlocks.removeAt(0);
+    }
+}
+
+}  // namespace android
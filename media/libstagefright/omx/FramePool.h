@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRAME_POOL_H_
+
+#define FRAME_POOL_H_
+
+#include <utils/KeyedVector.h>
+#include <utils/Mutex.h>
+#include <utils/RefBase.h>
+#include <utils/Vector.h>
+
+#include <media/stagefright/foundation/ABase.h>
+
+namespace android {
+
+// Keeps the frame sized blocks freed by a software decoder, to hand them out again when it
+// reallocates its reference and output frames, e.g. on a resolution change. Blocks are
+// allocated in size classes a quarter of a power of two apart, so that a block can be reused
+// for a somewhat smaller frame, and the pool never keeps more free memory than the decoder
+// used at its peak. Blocks smaller than kMinPooledSize are allocated and freed directly.
+struct FramePool : public RefBase {
+    enum {
+        kAlignment      = 128,
+        kMinPooledSize  = 64 * 1024,
+        // a free block is reused for requests down to a quarter of its size
+        kMaxWasteFactor = 4,
+    };
+
+    FramePool();
+
+    // Returns a block of at least |size| bytes aligned to |alignment|, or NULL.
+    void *allocate(size_t alignment, size_t size);
+
+    // Returns a block from allocate() to the pool. NULL is ignored.
+    void free(void *data);
+
+    // Frees the blocks kept in the pool.
+    void clear();
+
+    // Size of the blocks kept in the pool.
+    size_t freeBytes();
+
+    // Rounds |size| up to its size class.
+    static size_t SizeClass(size_t size);
+
+protected:
+    virtual ~FramePool();
+
+private:
+    struct Block {
+        void *mData;
+        size_t mCapacity;
+    };
+
+    Mutex mLock;
+
+    // capacities of the pooled blocks in use
+    KeyedVector<void *, size_t> mUsedBlocks;
+    // free blocks, by increasing capacity
+    Vector<Block> mFreeBlocks;
+
+    size_t mUsedBytes;
+    size_t mPeakUsedBytes;
+    size_t mFreeBytes;
+
+    size_t mReuseCount;
+    size_t mAllocationCount;
+
+    void evictFreeBlocks_l();
+
+    DISALLOW_EVIL_CONSTRUCTORS(FramePool);
+};
+
+}  // namespace android
+
+#endif  // FRAME_POOL_H_
@@ -134,6 +134,11 @@ GraphicBufferSource::GraphicBufferSource(
     mPrevOriginalTimeUs(-1ll),
     mPrevModifiedTimeUs(-1ll),
     mSkipFramesBeforeNs(-1ll),
+    mMaxInputLatencyUs(-1ll),
+    mNumFramesSubmitted(0),
+    mNumStaleFramesDropped(0),
+    mTotalInputLatencyUs(0ll),
+    mMaxSeenInputLatencyUs(0ll),
     mRepeatAfterUs(-1ll),
     mRepeatLastFrameGeneration(0),
     mRepeatLastFrameTimestamp(-1ll),
@@ -299,6 +304,14 @@ void GraphicBufferSource::omxLoaded(){
     ALOGV("--> loaded; avail=%zu eos=%d eosSent=%d",
             mNumFramesAvailable, mEndOfStream, mEndOfStreamSent);
 
+    if (mMaxInputLatencyUs > 0ll && mNumFramesSubmitted > 0) {
+        ALOGI("%zu frames submitted, %zu stale frames dropped, "
+                "input latency avg %lld us max %lld us",
+                mNumFramesSubmitted, mNumStaleFramesDropped,
+                (long long)(mTotalInputLatencyUs / (int64_t)mNumFramesSubmitted),
+                (long long)mMaxSeenInputLatencyUs);
+    }
+
     // Codec is no longer executing.  Discard all codec-related state.
     mCodecBuffers.clear();
     // TODO: scan mCodecBuffers to verify that all mGraphicBuffer entries
@@ -598,26 +611,36 @@ bool GraphicBufferSource::fillCodecBuffer_l() {
     ALOGV("fillCodecBuffer_l: acquiring buffer, avail=%zu",
             mNumFramesAvailable);
     BufferItem item;
-    status_t err = mConsumer->acquireBuffer(&item, 0);
-    if (err == BufferQueue::NO_BUFFER_AVAILABLE) {
-        // shouldn't happen
-        ALOGW("fillCodecBuffer_l: frame was not available");
-        return false;
-    } else if (err != OK) {
-        // now what? fake end-of-stream?
-        ALOGW("fillCodecBuffer_l: acquireBuffer returned err=%d", err);
+    status_t err = acquireBuffer_l(&item);
+    if (err != OK) {
         return false;
     }
 
-    mNumBufferAcquired++;
-    mNumFramesAvailable--;
+    // If the encoder fell behind, skip ahead to the newest frame that is still
+    // within the latency bound. The stale frame is released before acquiring
+    // the next one so that we never hold more buffers than usual.
+    nsecs_t nowNs = systemTime(SYSTEM_TIME_MONOTONIC);
+    while (mNumFramesAvailable > 0 && isStale_l(item, nowNs)) {
+        ALOGV("dropping stale frame (bq %d, queued %lld us ago)", item.mSlot,
+                (long long)((nowNs - item.mTimestamp) / 1000));
+        releaseBuffer(item.mSlot, item.mFrameNumber, item.mGraphicBuffer, item.mFence);
+        ++mNumStaleFramesDropped;
 
-    // If this is the first time we're seeing this buffer, add it to our
-    // slot table.
-    if (item.mGraphicBuffer != NULL) {
-        ALOGV("fillCodecBuffer_l: setting mBufferSlot %d", item.mSlot);
-        mBufferSlot[item.mSlot] = item.mGraphicBuffer;
-        mBufferUseCount[item.mSlot] = 0;
+        err = acquireBuffer_l(&item);
+        if (err != OK) {
+            return false;
+        }
+    }
+
+    if (mMaxInputLatencyUs > 0ll) {
+        int64_t latencyUs = (nowNs - item.mTimestamp) / 1000;
+        if (latencyUs >= 0ll) {
+            ++mNumFramesSubmitted;
+            mTotalInputLatencyUs += latencyUs;
+            if (latencyUs > mMaxSeenInputLatencyUs) {
+                mMaxSeenInputLatencyUs = latencyUs;
+            }
+        }
     }
 
     if (item.mDataSpace != mLastDataSpace) {
@@ -659,6 +682,36 @@ bool GraphicBufferSource::fillCodecBuffer_l() {
     return true;
 }
 
+status_t GraphicBufferSource::acquireBuffer_l(BufferItem *item) {
+    status_t err = mConsumer->acquireBuffer(item, 0);
+    if (err == BufferQueue::NO_BUFFER_AVAILABLE) {
+        // shouldn't happen
+        ALOGW("fillCodecBuffer_l: frame was not available");
+        return err;
+    } else if (err != OK) {
+        // now what? fake end-of-stream?
+        ALOGW("fillCodecBuffer_l: acquireBuffer returned err=%d", err);
+        return err;
+    }
+
+    mNumBufferAcquired++;
+    mNumFramesAvailable--;
+
+    // If this is the first time we're seeing this buffer, add it to our
+    // slot table.
+    if (item->mGraphicBuffer != NULL) {
+        ALOGV("fillCodecBuffer_l: setting mBufferSlot %d", item->mSlot);
+        mBufferSlot[item->mSlot] = item->mGraphicBuffer;
+        mBufferUseCount[item->mSlot] = 0;
+    }
+    return OK;
+}
+
+bool GraphicBufferSource::isStale_l(const BufferItem &item, nsecs_t nowNs) const {
+    return mMaxInputLatencyUs > 0ll
+            && nowNs - item.mTimestamp > mMaxInputLatencyUs * 1000;
+}
+
 bool GraphicBufferSource::repeatLatestBuffer_l() {
     CHECK(mExecuting && mNumFramesAvailable == 0);
 
@@ -1094,6 +1147,17 @@ status_t GraphicBufferSource::setMaxFps(float maxFps) {
     return OK;
 }
 
+status_t GraphicBufferSource::setMaxInputLatencyUs(int64_t maxLatencyUs) {
+    Mutex::Autolock autoLock(mMutex);
+
+    if (mExecuting || maxLatencyUs <= 0ll) {
+        return INVALID_OPERATION;
+    }
+
+    mMaxInputLatencyUs = maxLatencyUs;
+    return OK;
+}
+
 void GraphicBufferSource::setSkipFramesBeforeUs(int64_t skipFramesBeforeUs) {
     Mutex::Autolock autoLock(mMutex);
 
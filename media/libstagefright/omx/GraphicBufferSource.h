@@ -138,6 +138,14 @@ public:
     // When set, the max frame rate fed to the encoder will be capped at maxFps.
     status_t setMaxFps(float maxFps);
 
+    // When set, frames that have waited in the BufferQueue for longer than
+    // maxLatencyUs (by their timestamp) are dropped in favor of a newer frame
+    // queued behind them, so that an encoder that falls behind is fed the most
+    // recent content instead of a growing backlog. The newest frame is always
+    // submitted. Timestamps must be in the SYSTEM_TIME_MONOTONIC base, as they
+    // are for surfaces from SurfaceFlinger.
+    status_t setMaxInputLatencyUs(int64_t maxLatencyUs);
+
     struct TimeLapseConfig {
         int64_t mTimePerFrameUs;   // the time (us) between two frames for playback
         int64_t mTimePerCaptureUs; // the time (us) between two frames for capture
@@ -248,6 +256,13 @@ private:
             int &id, uint64_t frameNum,
             const sp<GraphicBuffer> buffer, const sp<Fence> &fence);
 
+    // Acquires the next frame from the BufferQueue into item, and adds its
+    // buffer to our slot table if needed.
+    status_t acquireBuffer_l(BufferItem *item);
+
+    // Returns true if item has waited for longer than mMaxInputLatencyUs.
+    bool isStale_l(const BufferItem &item, nsecs_t nowNs) const;
+
     void setLatestBuffer_l(const BufferItem &item, bool dropped);
     bool repeatLatestBuffer_l();
     int64_t getTimestamp(const BufferItem &item);
@@ -318,6 +333,14 @@ private:
 
     sp<FrameDropper> mFrameDropper;
 
+    // Input latency bound, and statistics of the time frames waited in the
+    // BufferQueue before being submitted (logged when the codec is unloaded)
+    int64_t mMaxInputLatencyUs;
+    size_t mNumFramesSubmitted;
+    size_t mNumStaleFramesDropped;
+    int64_t mTotalInputLatencyUs;
+    int64_t mMaxSeenInputLatencyUs;
+
     sp<ALooper> mLooper;
     sp<AHandlerReflector<GraphicBufferSource> > mReflector;
 
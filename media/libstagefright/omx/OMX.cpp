@@ -27,6 +27,7 @@
 #include "../include/OMXNodeInstance.h"
 
 #include <binder/IMemory.h>
+#include <cutils/properties.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <utils/threads.h>
 
@@ -78,12 +79,24 @@ protected:
     virtual ~CallbackDispatcher();
 
 private:
+    // Buffer done and frame rendered messages are held back for up to mMaxBatchDelayNs after
+    // the first of them is queued, or until kMaxBatchSize of them are, so that they reach the
+    // observer in fewer binder transactions. Other messages are dispatched right away, along
+    // with those queued before them.
+    enum {
+        kMaxBatchSize = 16,
+    };
+
     Mutex mLock;
 
     OMXNodeInstance *mOwner;
     bool mDone;
     Condition mQueueChanged;
     std::list<omx_message> mQueue;
+    size_t mQueueSize;
+    bool mQueueIsUrgent;    // holds a message not to be held back
+    nsecs_t mFirstQueuedNs;
+    nsecs_t mMaxBatchDelayNs;
 
     sp<CallbackDispatcherThread> mThread;
 
@@ -95,7 +108,12 @@ private:
 
 OMX::CallbackDispatcher::CallbackDispatcher(OMXNodeInstance *owner)
     : mOwner(owner),
-      mDone(false) {
+      mDone(false),
+      mQueueSize(0),
+      mQueueIsUrgent(false),
+      mFirstQueuedNs(0) {
+    mMaxBatchDelayNs =
+        property_get_int32("debug.stagefright.omx-batch-delay-us", 500) * 1000ll;
     mThread = new CallbackDispatcherThread(this);
     mThread->run("OMXCallbackDisp", ANDROID_PRIORITY_FOREGROUND);
 }
@@ -121,7 +139,16 @@ OMX::CallbackDispatcher::~CallbackDispatcher() {
 void OMX::CallbackDispatcher::post(const omx_message &msg, bool realTime) {
     Mutex::Autolock autoLock(mLock);
 
+    if (mQueue.empty()) {
+        mFirstQueuedNs = systemTime(SYSTEM_TIME_MONOTONIC);
+    }
     mQueue.push_back(msg);
+    ++mQueueSize;
+    if (msg.type != omx_message::EMPTY_BUFFER_DONE
+            && msg.type != omx_message::FILL_BUFFER_DONE
+            && msg.type != omx_message::FRAME_RENDERED) {
+        mQueueIsUrgent = true;
+    }
     if (realTime) {
         mQueueChanged.signal();
     }
@@ -145,11 +172,22 @@ bool OMX::CallbackDispatcher::loop() {
                 mQueueChanged.wait(mLock);
             }
 
+            while (!mDone && !mQueueIsUrgent && mQueueSize < kMaxBatchSize) {
+                nsecs_t delayNs =
+                    mFirstQueuedNs + mMaxBatchDelayNs - systemTime(SYSTEM_TIME_MONOTONIC);
+                if (delayNs <= 0) {
+                    break;
+                }
+                mQueueChanged.waitRelative(mLock, delayNs);
+            }
+
             if (mDone) {
                 break;
             }
 
             messages.swap(mQueue);
+            mQueueSize = 0;
+            mQueueIsUrgent = false;
         }
 
         dispatch(messages);
@@ -462,6 +500,29 @@ status_t OMX::useBuffer(
             port_index, params, buffer, allottedSize);
 }
 
+status_t OMX::useBuffers(
+        node_id node, OMX_U32 port_index, const Vector<sp<IMemory> > &params,
+        Vector<buffer_id> *buffers, OMX_U32 allottedSize) {
+    buffers->clear();
+
+    OMXNodeInstance *instance = findInstance(node);
+
+    if (instance == NULL) {
+        return NAME_NOT_FOUND;
+    }
+
+    for (size_t i = 0; i < params.size(); ++i) {
+        buffer_id buffer;
+        status_t err = instance->useBuffer(port_index, params[i], &buffer, allottedSize);
+        if (err != OK) {
+            return err;
+        }
+        buffers->push(buffer);
+    }
+
+    return OK;
+}
+
 status_t OMX::useGraphicBuffer(
         node_id node, OMX_U32 port_index,
         const sp<GraphicBuffer> &graphicBuffer, buffer_id *buffer) {
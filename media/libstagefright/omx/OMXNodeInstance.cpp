@@ -72,7 +72,7 @@ static const OMX_U32 kPortIndexOutput = 1;
 /* buffer formatting */
 #define BUFFER_FMT(port, fmt, ...) "%s:%u " fmt, portString(port), (port), ##__VA_ARGS__
 #define NEW_BUFFER_FMT(buffer_id, port, fmt, ...) \
-    BUFFER_FMT(port, fmt ") (#%zu => %#x", ##__VA_ARGS__, mActiveBuffers.size(), (buffer_id))
+    BUFFER_FMT(port, fmt ") (#%zu => %#x", ##__VA_ARGS__, mNumActiveBuffers, (buffer_id))
 
 #define SIMPLE_BUFFER(port, size, data) BUFFER_FMT(port, "%zu@%p", (size), (data))
 #define SIMPLE_NEW_BUFFER(buffer_id, port, size, data) \
@@ -100,7 +100,8 @@ struct BufferMeta {
           mCopyFromOmx(copyFromOmx),
           mCopyToOmx(copyToOmx),
           mPortIndex(portIndex),
-          mBackup(backup) {
+          mBackup(backup),
+          mBufferID(0) {
     }
 
     BufferMeta(size_t size, OMX_U32 portIndex)
@@ -108,7 +109,8 @@ struct BufferMeta {
           mCopyFromOmx(false),
           mCopyToOmx(false),
           mPortIndex(portIndex),
-          mBackup(NULL) {
+          mBackup(NULL),
+          mBufferID(0) {
     }
 
     BufferMeta(const sp<GraphicBuffer> &graphicBuffer, OMX_U32 portIndex)
@@ -116,7 +118,8 @@ struct BufferMeta {
           mCopyFromOmx(false),
           mCopyToOmx(false),
           mPortIndex(portIndex),
-          mBackup(NULL) {
+          mBackup(NULL),
+          mBufferID(0) {
     }
 
     void CopyFromOMX(const OMX_BUFFERHEADERTYPE *header) {
@@ -171,6 +174,15 @@ struct BufferMeta {
         return mPortIndex;
     }
 
+    // for the translation of the buffer ptr back to its id
+    void setBufferID(OMX::buffer_id id) {
+        mBufferID = id;
+    }
+
+    OMX::buffer_id getBufferID() const {
+        return mBufferID;
+    }
+
     ~BufferMeta() {
         delete[] mBackup;
     }
@@ -184,6 +196,7 @@ private:
     bool mCopyToOmx;
     OMX_U32 mPortIndex;
     OMX_U8 *mBackup;
+    OMX::buffer_id mBufferID;
 
     BufferMeta(const BufferMeta &);
     BufferMeta &operator=(const BufferMeta &);
@@ -212,7 +225,9 @@ OMXNodeInstance::OMXNodeInstance(
       mDying(false),
       mSailed(false),
       mQueriedProhibitedExtensions(false),
-      mBufferIDCount(0)
+      mNumActiveBuffers(0),
+      mBufferIDCount(0),
+      mNextBufferSlot(0)
 {
     mName = ADebug::GetDebugName(name);
     DEBUG = ADebug::GetDebugLevelFromProperty(name, "debug.stagefright.omx-debug");
@@ -220,6 +235,12 @@ OMXNodeInstance::OMXNodeInstance(
     DEBUG_BUMP = DEBUG;
     mNumPortBuffers[0] = 0;
     mNumPortBuffers[1] = 0;
+    for (size_t i = 0; i < kMaxBufferSlots; ++i) {
+        mBufferSlots[i].mID.store(0, std::memory_order_relaxed);
+        mBufferSlots[i].mHeader.store(NULL, std::memory_order_relaxed);
+        mBufferSlots[i].mActive = false;
+        mBufferSlots[i].mPortIndex = 0;
+    }
     mDebugLevelBumpPendingBuffers[0] = 0;
     mDebugLevelBumpPendingBuffers[1] = 0;
     mMetadataType[0] = kMetadataBufferTypeInvalid;
@@ -1344,9 +1365,10 @@ status_t OMXNodeInstance::freeBuffer(
     OMX_ERRORTYPE err = OMX_FreeBuffer(mHandle, portIndex, header);
     CLOG_IF_ERROR(freeBuffer, err, "%s:%u %#x", portString(portIndex), portIndex, buffer);
 
+    // findBufferID reads buffer_meta without locking
+    invalidateBufferID(buffer);
     delete buffer_meta;
     buffer_meta = NULL;
-    invalidateBufferID(buffer);
 
     return StatusFromOMXError(err);
 }
@@ -1608,6 +1630,7 @@ inline static const char *asString(IOMX::InternalOptionType i, const char *def =
         case IOMX::INTERNAL_OPTION_START_TIME:        return "START_TIME";
         case IOMX::INTERNAL_OPTION_TIME_LAPSE:        return "TIME_LAPSE";
         case IOMX::INTERNAL_OPTION_TIME_OFFSET:       return "TIME_OFFSET";
+        case IOMX::INTERNAL_OPTION_MAX_INPUT_LATENCY: return "MAX_INPUT_LATENCY";
         default:                                      return def;
     }
 }
@@ -1638,6 +1661,7 @@ status_t OMXNodeInstance::setInternalOption(
         case IOMX::INTERNAL_OPTION_TIME_LAPSE:
         case IOMX::INTERNAL_OPTION_TIME_OFFSET:
         case IOMX::INTERNAL_OPTION_COLOR_ASPECTS:
+        case IOMX::INTERNAL_OPTION_MAX_INPUT_LATENCY:
         {
             const sp<GraphicBufferSource> &bufferSource =
                 getGraphicBufferSource();
@@ -1686,6 +1710,14 @@ status_t OMXNodeInstance::setInternalOption(
 
                 CLOG_CONFIG(setInternalOption, "maxFps=%f", maxFps);
                 return bufferSource->setMaxFps(maxFps);
+            } else if (type == IOMX::INTERNAL_OPTION_MAX_INPUT_LATENCY) {
+                int64_t maxLatencyUs;
+                if (!getInternalOption(data, size, &maxLatencyUs)) {
+                    return INVALID_OPERATION;
+                }
+
+                CLOG_CONFIG(setInternalOption, "maxLatencyUs=%lld", (long long)maxLatencyUs);
+                return bufferSource->setMaxInputLatencyUs(maxLatencyUs);
             } else if (type == IOMX::INTERNAL_OPTION_START_TIME) {
                 int64_t skipFramesBeforeUs;
                 if (!getInternalOption(data, size, &skipFramesBeforeUs)) {
@@ -1929,10 +1961,14 @@ OMX_ERRORTYPE OMXNodeInstance::OnFillBufferDone(
 }
 
 void OMXNodeInstance::addActiveBuffer(OMX_U32 portIndex, OMX::buffer_id id) {
-    ActiveBuffer active;
-    active.mPortIndex = portIndex;
-    active.mID = id;
-    mActiveBuffers.push(active);
+    BufferSlot &slot = mBufferSlots[id & (kMaxBufferSlots - 1)];
+    if (id == 0 || slot.mID.load(std::memory_order_relaxed) != id) {
+        CLOGW("Attempt to add an active buffer [%#x] that has no id", id);
+        return;
+    }
+    slot.mActive = true;
+    slot.mPortIndex = portIndex;
+    ++mNumActiveBuffers;
 
     if (portIndex < NELEM(mNumPortBuffers)) {
         ++mNumPortBuffers[portIndex];
@@ -1941,27 +1977,30 @@ void OMXNodeInstance::addActiveBuffer(OMX_U32 portIndex, OMX::buffer_id id) {
 
 void OMXNodeInstance::removeActiveBuffer(
         OMX_U32 portIndex, OMX::buffer_id id) {
-    for (size_t i = 0; i < mActiveBuffers.size(); ++i) {
-        if (mActiveBuffers[i].mPortIndex == portIndex
-                && mActiveBuffers[i].mID == id) {
-            mActiveBuffers.removeItemsAt(i);
-
-            if (portIndex < NELEM(mNumPortBuffers)) {
-                --mNumPortBuffers[portIndex];
-            }
-            return;
+    BufferSlot &slot = mBufferSlots[id & (kMaxBufferSlots - 1)];
+    if (id != 0 && slot.mActive && slot.mPortIndex == portIndex
+            && slot.mID.load(std::memory_order_relaxed) == id) {
+        slot.mActive = false;
+        --mNumActiveBuffers;
+
+        if (portIndex < NELEM(mNumPortBuffers)) {
+            --mNumPortBuffers[portIndex];
         }
+        return;
     }
 
      CLOGW("Attempt to remove an active buffer [%#x] we know nothing about...", id);
 }
 
 void OMXNodeInstance::freeActiveBuffers() {
-    // Make sure to count down here, as freeBuffer will in turn remove
-    // the active buffer from the vector...
-    for (size_t i = mActiveBuffers.size(); i > 0;) {
+    // Count down, so that buffers are mostly freed in the reverse order
+    // they were added, as slots are taken in turn.
+    for (size_t i = kMaxBufferSlots; i > 0;) {
         i--;
-        freeBuffer(mActiveBuffers[i].mPortIndex, mActiveBuffers[i].mID);
+        if (mBufferSlots[i].mActive) {
+            freeBuffer(mBufferSlots[i].mPortIndex,
+                    mBufferSlots[i].mID.load(std::memory_order_relaxed));
+        }
     }
 }
 
@@ -1970,16 +2009,29 @@ OMX::buffer_id OMXNodeInstance::makeBufferID(OMX_BUFFERHEADERTYPE *bufferHeader)
         return 0;
     }
     Mutex::Autolock autoLock(mBufferIDLock);
-    OMX::buffer_id buffer;
-    do { // handle the very unlikely case of ID overflow
-        if (++mBufferIDCount == 0) {
-            ++mBufferIDCount;
+    for (size_t i = 0; i < kMaxBufferSlots; ++i) {
+        // take the slots in turn, so that a slot is not reused right after being released
+        const size_t index = (mNextBufferSlot + i) & (kMaxBufferSlots - 1);
+        BufferSlot &slot = mBufferSlots[index];
+        if (slot.mHeader.load(std::memory_order_relaxed) != NULL) {
+            continue;
         }
-        buffer = (OMX::buffer_id)mBufferIDCount;
-    } while (mBufferIDToBufferHeader.indexOfKey(buffer) >= 0);
-    mBufferIDToBufferHeader.add(buffer, bufferHeader);
-    mBufferHeaderToBufferID.add(bufferHeader, buffer);
-    return buffer;
+
+        uint32_t generation;
+        do { // handle the very unlikely case of generation overflow
+            generation = ++mBufferIDCount & (UINT32_MAX >> kBufferSlotBits);
+        } while (generation == 0);
+        OMX::buffer_id buffer = (OMX::buffer_id)((generation << kBufferSlotBits) | index);
+
+        static_cast<BufferMeta *>(bufferHeader->pAppPrivate)->setBufferID(buffer);
+        slot.mHeader.store(bufferHeader, std::memory_order_relaxed);
+        // publishes the header to the lookups that find the id
+        slot.mID.store(buffer, std::memory_order_release);
+        mNextBufferSlot = index + 1;
+        return buffer;
+    }
+    CLOGW("makeBufferID: all %d buffer ids are in use", kMaxBufferSlots);
+    return 0;
 }
 
 OMX_BUFFERHEADERTYPE *OMXNodeInstance::findBufferHeader(
@@ -1987,13 +2039,19 @@ OMX_BUFFERHEADERTYPE *OMXNodeInstance::findBufferHeader(
     if (buffer == 0) {
         return NULL;
     }
-    Mutex::Autolock autoLock(mBufferIDLock);
-    ssize_t index = mBufferIDToBufferHeader.indexOfKey(buffer);
-    if (index < 0) {
+    BufferSlot &slot = mBufferSlots[buffer & (kMaxBufferSlots - 1)];
+    OMX_BUFFERHEADERTYPE *header = NULL;
+    if (slot.mID.load(std::memory_order_acquire) == buffer) {
+        header = slot.mHeader.load(std::memory_order_acquire);
+        // the slot may have been released, and even taken again, in between
+        if (slot.mID.load(std::memory_order_acquire) != buffer) {
+            header = NULL;
+        }
+    }
+    if (header == NULL) {
         CLOGW("findBufferHeader: buffer %u not found", buffer);
         return NULL;
     }
-    OMX_BUFFERHEADERTYPE *header = mBufferIDToBufferHeader.valueAt(index);
     BufferMeta *buffer_meta =
         static_cast<BufferMeta *>(header->pAppPrivate);
     if (buffer_meta->getPortIndex() != portIndex) {
@@ -2005,16 +2063,17 @@ OMX_BUFFERHEADERTYPE *OMXNodeInstance::findBufferHeader(
 }
 
 OMX::buffer_id OMXNodeInstance::findBufferID(OMX_BUFFERHEADERTYPE *bufferHeader) {
-    if (bufferHeader == NULL) {
+    if (bufferHeader == NULL || bufferHeader->pAppPrivate == NULL) {
         return 0;
     }
-    Mutex::Autolock autoLock(mBufferIDLock);
-    ssize_t index = mBufferHeaderToBufferID.indexOfKey(bufferHeader);
-    if (index < 0) {
+    OMX::buffer_id buffer =
+        static_cast<BufferMeta *>(bufferHeader->pAppPrivate)->getBufferID();
+    const BufferSlot &slot = mBufferSlots[buffer & (kMaxBufferSlots - 1)];
+    if (buffer == 0 || slot.mHeader.load(std::memory_order_acquire) != bufferHeader) {
         CLOGW("findBufferID: bufferHeader %p not found", bufferHeader);
         return 0;
     }
-    return mBufferHeaderToBufferID.valueAt(index);
+    return buffer;
 }
 
 void OMXNodeInstance::invalidateBufferID(OMX::buffer_id buffer) {
@@ -2022,13 +2081,13 @@ void OMXNodeInstance::invalidateBufferID(OMX::buffer_id buffer) {
         return;
     }
     Mutex::Autolock autoLock(mBufferIDLock);
-    ssize_t index = mBufferIDToBufferHeader.indexOfKey(buffer);
-    if (index < 0) {
+    BufferSlot &slot = mBufferSlots[buffer & (kMaxBufferSlots - 1)];
+    if (slot.mID.load(std::memory_order_relaxed) != buffer) {
         CLOGW("invalidateBufferID: buffer %u not found", buffer);
         return;
     }
-    mBufferHeaderToBufferID.removeItem(mBufferIDToBufferHeader.valueAt(index));
-    mBufferIDToBufferHeader.removeItemsAt(index);
+    slot.mID.store(0, std::memory_order_release);
+    slot.mHeader.store(NULL, std::memory_order_release);
 }
 
 }  // namespace android
@@ -20,6 +20,7 @@
 
 #include "include/SimpleSoftOMXComponent.h"
 
+#include <media/hardware/HardwareAPI.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/foundation/ALooper.h>
 #include <media/stagefright/foundation/AMessage.h>
@@ -74,7 +75,10 @@ bool SimpleSoftOMXComponent::isSetParameterAllowed(
 
     OMX_U32 portIndex;
 
-    switch (index) {
+    // Include extension index OMX_INDEXEXTTYPE.
+    const int32_t indexFull = index;
+
+    switch (indexFull) {
         case OMX_IndexParamPortDefinition:
         {
             portIndex = ((OMX_PARAM_PORTDEFINITIONTYPE *)params)->nPortIndex;
@@ -93,6 +97,13 @@ bool SimpleSoftOMXComponent::isSetParameterAllowed(
             break;
         }
 
+        case kUseAndroidNativeBufferIndex:
+        {
+            // buffers are also added to disabled ports, on port reconfiguration
+            portIndex = ((const UseAndroidNativeBufferParams *)params)->nPortIndex;
+            break;
+        }
+
         default:
             return false;
     }
@@ -197,6 +208,16 @@ OMX_ERRORTYPE SimpleSoftOMXComponent::useBuffer(
         OMX_U32 size,
         OMX_U8 *ptr) {
     Mutex::Autolock autoLock(mLock);
+    return internalUseBuffer(header, portIndex, appPrivate, size, ptr);
+}
+
+OMX_ERRORTYPE SimpleSoftOMXComponent::internalUseBuffer(
+        OMX_BUFFERHEADERTYPE **header,
+        OMX_U32 portIndex,
+        OMX_PTR appPrivate,
+        OMX_U32 size,
+        OMX_U8 *ptr,
+        const sp<ANativeWindowBuffer> &graphicBuffer) {
     CHECK_LT(portIndex, mPorts.size());
 
     *header = new OMX_BUFFERHEADERTYPE;
@@ -234,6 +255,7 @@ OMX_ERRORTYPE SimpleSoftOMXComponent::useBuffer(
 
     buffer->mHeader = *header;
     buffer->mOwnedByUs = false;
+    buffer->mGraphicBuffer = graphicBuffer;
 
     if (port->mBuffers.size() == port->mDef.nBufferCountActual) {
         port->mDef.bPopulated = OMX_TRUE;
@@ -64,25 +64,25 @@ static const struct {
 static const size_t kNumComponents =
     sizeof(kComponents) / sizeof(kComponents[0]);
 
-SoftOMXPlugin::SoftOMXPlugin() {
+SoftOMXPlugin::SoftOMXPlugin()
+    : mUseCounter(0) {
 }
 
-OMX_ERRORTYPE SoftOMXPlugin::makeComponentInstance(
-        const char *name,
-        const OMX_CALLBACKTYPE *callbacks,
-        OMX_PTR appData,
-        OMX_COMPONENTTYPE **component) {
-    ALOGV("makeComponentInstance '%s'", name);
-
-    for (size_t i = 0; i < kNumComponents; ++i) {
-        if (strcmp(name, kComponents[i].mName)) {
+SoftOMXPlugin::~SoftOMXPlugin() {
+    for (size_t i = 0; i < mLibraries.size(); ++i) {
+        const Library &library = mLibraries.valueAt(i);
+        if (library.mNumComponents > 0) {
+            ALOGW("%s still has %zu components", mLibraries.keyAt(i).c_str(),
+                    library.mNumComponents);
             continue;
         }
+        dlclose(library.mHandle);
+    }
+}
 
-        AString libName = "libstagefright_soft_";
-        libName.append(kComponents[i].mLibNameSuffix);
-        libName.append(".so");
-
+OMX_ERRORTYPE SoftOMXPlugin::acquireLibrary_l(const AString &libName, Library **library) {
+    ssize_t index = mLibraries.indexOfKey(libName);
+    if (index < 0) {
         void *libHandle = dlopen(libName.c_str(), RTLD_NOW);
 
         if (libHandle == NULL) {
@@ -91,10 +91,6 @@ OMX_ERRORTYPE SoftOMXPlugin::makeComponentInstance(
             return OMX_ErrorComponentNotFound;
         }
 
-        typedef SoftOMXComponent *(*CreateSoftOMXComponentFunc)(
-                const char *, const OMX_CALLBACKTYPE *,
-                OMX_PTR, OMX_COMPONENTTYPE **);
-
         CreateSoftOMXComponentFunc createSoftOMXComponent =
             (CreateSoftOMXComponentFunc)dlsym(
                     libHandle,
@@ -108,20 +104,109 @@ OMX_ERRORTYPE SoftOMXPlugin::makeComponentInstance(
             return OMX_ErrorComponentNotFound;
         }
 
+        Library newLibrary;
+        newLibrary.mHandle = libHandle;
+        newLibrary.mCreate = createSoftOMXComponent;
+        newLibrary.mNumComponents = 0;
+        newLibrary.mLastUse = 0;
+        index = mLibraries.add(libName, newLibrary);
+    } else {
+        ALOGV("reusing loaded %s", libName.c_str());
+    }
+
+    *library = &mLibraries.editValueAt(index);
+    ++(*library)->mNumComponents;
+    (*library)->mLastUse = ++mUseCounter;
+
+    return OMX_ErrorNone;
+}
+
+void SoftOMXPlugin::releaseLibrary_l(void *libHandle) {
+    for (size_t i = 0; i < mLibraries.size(); ++i) {
+        Library &library = mLibraries.editValueAt(i);
+        if (library.mHandle == libHandle) {
+            CHECK_GT(library.mNumComponents, (size_t)0);
+            --library.mNumComponents;
+            library.mLastUse = ++mUseCounter;
+            trimUnusedLibraries_l();
+            return;
+        }
+    }
+
+    ALOGE("released unknown library %p", libHandle);
+}
+
+void SoftOMXPlugin::trimUnusedLibraries_l() {
+    for (;;) {
+        size_t numUnused = 0;
+        ssize_t oldest = -1;
+        for (size_t i = 0; i < mLibraries.size(); ++i) {
+            const Library &library = mLibraries.valueAt(i);
+            if (library.mNumComponents > 0) {
+                continue;
+            }
+            ++numUnused;
+            if (oldest < 0 || library.mLastUse < mLibraries.valueAt(oldest).mLastUse) {
+                oldest = i;
+            }
+        }
+
+        if (numUnused <= kMaxUnusedLibraries) {
+            return;
+        }
+
+        ALOGV("unloading %s", mLibraries.keyAt(oldest).c_str());
+        dlclose(mLibraries.valueAt(oldest).mHandle);
+        mLibraries.removeItemsAt(oldest);
+    }
+}
+
+OMX_ERRORTYPE SoftOMXPlugin::makeComponentInstance(
+        const char *name,
+        const OMX_CALLBACKTYPE *callbacks,
+        OMX_PTR appData,
+        OMX_COMPONENTTYPE **component) {
+    ALOGV("makeComponentInstance '%s'", name);
+
+    for (size_t i = 0; i < kNumComponents; ++i) {
+        if (strcmp(name, kComponents[i].mName)) {
+            continue;
+        }
+
+        AString libName = "libstagefright_soft_";
+        libName.append(kComponents[i].mLibNameSuffix);
+        libName.append(".so");
+
+        void *libHandle;
+        CreateSoftOMXComponentFunc createSoftOMXComponent;
+        {
+            Mutex::Autolock autoLock(mLock);
+
+            Library *library;
+            OMX_ERRORTYPE err = acquireLibrary_l(libName, &library);
+            if (err != OMX_ErrorNone) {
+                return err;
+            }
+            libHandle = library->mHandle;
+            createSoftOMXComponent = library->mCreate;
+        }
+
         sp<SoftOMXComponent> codec =
             (*createSoftOMXComponent)(name, callbacks, appData, component);
 
         if (codec == NULL) {
-            dlclose(libHandle);
-            libHandle = NULL;
+            Mutex::Autolock autoLock(mLock);
+            releaseLibrary_l(libHandle);
 
             return OMX_ErrorInsufficientResources;
         }
 
         OMX_ERRORTYPE err = codec->initCheck();
         if (err != OMX_ErrorNone) {
-            dlclose(libHandle);
-            libHandle = NULL;
+            codec.clear();
+
+            Mutex::Autolock autoLock(mLock);
+            releaseLibrary_l(libHandle);
 
             return err;
         }
@@ -149,7 +234,8 @@ OMX_ERRORTYPE SoftOMXPlugin::destroyComponentInstance(
     me->decStrong(this);
     me = NULL;
 
-    dlclose(libHandle);
+    Mutex::Autolock autoLock(mLock);
+    releaseLibrary_l(libHandle);
     libHandle = NULL;
 
     return OMX_ErrorNone;
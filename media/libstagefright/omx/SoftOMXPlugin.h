@@ -19,12 +19,18 @@
 #define SOFT_OMX_PLUGIN_H_
 
 #include <media/stagefright/foundation/ABase.h>
+#include <media/stagefright/foundation/AString.h>
+#include <utils/KeyedVector.h>
+#include <utils/threads.h>
 #include <OMXPluginBase.h>
 
 namespace android {
 
+struct SoftOMXComponent;
+
 struct SoftOMXPlugin : public OMXPluginBase {
     SoftOMXPlugin();
+    virtual ~SoftOMXPlugin();
 
     virtual OMX_ERRORTYPE makeComponentInstance(
             const char *name,
@@ -45,6 +51,31 @@ struct SoftOMXPlugin : public OMXPluginBase {
             Vector<String8> *roles);
 
 private:
+    typedef SoftOMXComponent *(*CreateSoftOMXComponentFunc)(
+            const char *, const OMX_CALLBACKTYPE *,
+            OMX_PTR, OMX_COMPONENTTYPE **);
+
+    // Libraries stay loaded once their last component is destroyed, so that codecs
+    // opened and closed in quick succession do not dlopen and relocate them every time.
+    enum {
+        kMaxUnusedLibraries = 4,
+    };
+
+    struct Library {
+        void *mHandle;
+        CreateSoftOMXComponentFunc mCreate;
+        size_t mNumComponents;
+        uint64_t mLastUse;
+    };
+
+    Mutex mLock;
+    KeyedVector<AString, Library> mLibraries;  // by file name
+    uint64_t mUseCounter;
+
+    OMX_ERRORTYPE acquireLibrary_l(const AString &libName, Library **library);
+    void releaseLibrary_l(void *libHandle);
+    void trimUnusedLibraries_l();
+
     DISALLOW_EVIL_CONSTRUCTORS(SoftOMXPlugin);
 };
 
@@ -15,6 +15,7 @@
  */
 
 #include <inttypes.h>
+#include <unistd.h>
 
 //#define LOG_NDEBUG 0
 #define LOG_TAG "SoftVideoDecoderOMXComponent"
@@ -22,15 +23,24 @@
 
 #include "include/SoftVideoDecoderOMXComponent.h"
 
+#include "FramePool.h"
+
 #include <media/hardware/HardwareAPI.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/foundation/ALooper.h>
 #include <media/stagefright/foundation/AMessage.h>
 #include <media/stagefright/foundation/AUtils.h>
 #include <media/stagefright/MediaDefs.h>
+#include <ui/GraphicBufferMapper.h>
+#include <ui/Rect.h>
 
 namespace android {
 
+// decode threads of the video decoders of the process
+static Mutex gDecodeThreadsLock;
+static size_t gDecodeThreadsInUse = 0;
+static size_t gDecodersUsingThreads = 0;
+
 template<class T>
 static void InitOMXParams(T *params) {
     params->nSize = sizeof(T);
@@ -62,6 +72,10 @@ SoftVideoDecoderOMXComponent::SoftVideoDecoderOMXComponent(
         mCropWidth(width),
         mCropHeight(height),
         mOutputPortSettingsChange(NONE),
+        mUseNativeBuffers(false),
+        mNativeBufferStride(0),
+        mFramePool(new FramePool),
+        mDecodeThreads(0),
         mMinInputBufferSize(384), // arbitrary, using one uncompressed macroblock
         mMinCompressionRatio(1),  // max input size is normally the output size
         mComponentRole(componentRole),
@@ -75,6 +89,18 @@ SoftVideoDecoderOMXComponent::SoftVideoDecoderOMXComponent(
     memset(&mFinalColorAspects, 0, sizeof(ColorAspects));
 }
 
+SoftVideoDecoderOMXComponent::~SoftVideoDecoderOMXComponent() {
+    releaseDecodeThreads();
+}
+
+void *SoftVideoDecoderOMXComponent::allocateFrameMemory(size_t alignment, size_t size) {
+    return mFramePool->allocate(alignment, size);
+}
+
+void SoftVideoDecoderOMXComponent::freeFrameMemory(void *data) {
+    mFramePool->free(data);
+}
+
 void SoftVideoDecoderOMXComponent::initPorts(
         OMX_U32 numInputBuffers,
         OMX_U32 inputBufferSize,
@@ -301,38 +327,206 @@ status_t SoftVideoDecoderOMXComponent::handleColorAspectsChange() {
     return OK;
 }
 
+size_t SoftVideoDecoderOMXComponent::acquireDecodeThreads(size_t maxThreads) {
+    Mutex::Autolock autoLock(gDecodeThreadsLock);
+
+    if (mDecodeThreads > 0) {
+        gDecodeThreadsInUse -= mDecodeThreads;
+        --gDecodersUsingThreads;
+    }
+
+    // cores taken offline, e.g. for thermal reasons, are left out
+    long onlineCores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t cores = onlineCores > 1 ? (size_t)onlineCores : 1;
+
+    size_t macroblocks = divUp(mWidth, 16u) * divUp(mHeight, 16u);
+    size_t wanted = divUp(macroblocks, (size_t)kMacroblocksPerDecodeThread);
+
+    size_t evenShare = cores / (gDecodersUsingThreads + 1);
+    size_t available = cores > gDecodeThreadsInUse ? cores - gDecodeThreadsInUse : 0;
+
+    size_t threads = min(min(wanted, maxThreads), max(evenShare, available));
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    mDecodeThreads = threads;
+    gDecodeThreadsInUse += threads;
+    ++gDecodersUsingThreads;
+
+    ALOGV("%s: %zu decode threads for %ux%u, %zu in use by %zu decoders on %zu cores",
+            name(), threads, mWidth, mHeight, gDecodeThreadsInUse,
+            gDecodersUsingThreads, cores);
+    return threads;
+}
+
+void SoftVideoDecoderOMXComponent::releaseDecodeThreads() {
+    Mutex::Autolock autoLock(gDecodeThreadsLock);
+
+    if (mDecodeThreads > 0) {
+        gDecodeThreadsInUse -= mDecodeThreads;
+        --gDecodersUsingThreads;
+        mDecodeThreads = 0;
+    }
+}
+
 void SoftVideoDecoderOMXComponent::copyYV12FrameToOutputBuffer(
         uint8_t *dst, const uint8_t *srcY, const uint8_t *srcU, const uint8_t *srcV,
         size_t srcYStride, size_t srcUStride, size_t srcVStride) {
     size_t dstYStride = outputBufferWidth();
-    size_t dstUVStride = dstYStride / 2;
     size_t dstHeight = outputBufferHeight();
-    uint8_t *dstStart = dst;
 
+    OutputPlanes planes;
+    planes.mY = dst;
+    planes.mU = dst + dstYStride * dstHeight;
+    planes.mV = dst + (5 * dstYStride * dstHeight) / 4;
+    planes.mYStride = dstYStride;
+    planes.mUVStride = dstYStride / 2;
+    copyYV12FrameToOutputPlanes(planes, srcY, srcU, srcV, srcYStride, srcUStride, srcVStride);
+}
+
+void SoftVideoDecoderOMXComponent::copyYV12FrameToOutputPlanes(
+        const OutputPlanes &dst, const uint8_t *srcY, const uint8_t *srcU,
+        const uint8_t *srcV, size_t srcYStride, size_t srcUStride, size_t srcVStride) {
+    uint8_t *dstY = dst.mY;
     for (size_t i = 0; i < mHeight; ++i) {
-         memcpy(dst, srcY, mWidth);
+         memcpy(dstY, srcY, mWidth);
          srcY += srcYStride;
-         dst += dstYStride;
+         dstY += dst.mYStride;
     }
 
-    dst = dstStart + dstYStride * dstHeight;
+    uint8_t *dstU = dst.mU;
+    uint8_t *dstV = dst.mV;
     for (size_t i = 0; i < mHeight / 2; ++i) {
-         memcpy(dst, srcU, mWidth / 2);
+         memcpy(dstU, srcU, mWidth / 2);
+         memcpy(dstV, srcV, mWidth / 2);
          srcU += srcUStride;
-         dst += dstUVStride;
+         srcV += srcVStride;
+         dstU += dst.mUVStride;
+         dstV += dst.mUVStride;
+    }
+}
+
+bool SoftVideoDecoderOMXComponent::supportsNativeBuffers() {
+    return false;
+}
+
+uint32_t SoftVideoDecoderOMXComponent::outputBufferStride() {
+    if (mUseNativeBuffers && mNativeBufferStride != 0) {
+        return mNativeBufferStride;
     }
+    return outputBufferWidth();
+}
 
-    dst = dstStart + (5 * dstYStride * dstHeight) / 4;
-    for (size_t i = 0; i < mHeight / 2; ++i) {
-         memcpy(dst, srcV, mWidth / 2);
-         srcV += srcVStride;
-         dst += dstUVStride;
+// static
+void SoftVideoDecoderOMXComponent::getNativeBufferPlanes(
+        const sp<ANativeWindowBuffer> &buffer, uint8_t *data, OutputPlanes *planes) {
+    // YV12, see system/graphics.h
+    planes->mYStride = buffer->stride;
+    planes->mUVStride = (planes->mYStride / 2 + 15) & ~15;
+    planes->mY = data;
+    planes->mV = data + planes->mYStride * buffer->height;
+    planes->mU = planes->mV + planes->mUVStride * buffer->height / 2;
+}
+
+sp<ANativeWindowBuffer> SoftVideoDecoderOMXComponent::getNativeBuffer(
+        OMX_BUFFERHEADERTYPE *header) {
+    const PortInfo *port = editPortInfo(kOutputPortIndex);
+    for (size_t i = 0; i < port->mBuffers.size(); ++i) {
+        if (port->mBuffers[i].mHeader == header) {
+            return port->mBuffers[i].mGraphicBuffer;
+        }
+    }
+    return NULL;
+}
+
+bool SoftVideoDecoderOMXComponent::lockOutputBuffer(
+        OMX_BUFFERHEADERTYPE *header, OutputPlanes *planes) {
+    size_t stride = outputBufferStride();
+    size_t sizeY = stride * outputBufferHeight();
+
+    if (!mUseNativeBuffers) {
+        if (header->nAllocLen < sizeY + sizeY / 2) {
+            android_errorWriteLog(0x534e4554, "27833616");
+            return false;
+        }
+        planes->mY = header->pBuffer;
+        planes->mU = planes->mY + sizeY;
+        planes->mV = planes->mU + sizeY / 4;
+        planes->mYStride = stride;
+        planes->mUVStride = stride / 2;
+        return true;
+    }
+
+    sp<ANativeWindowBuffer> buffer = getNativeBuffer(header);
+    if (buffer == NULL) {
+        ALOGE("output buffer %p is not a graphic buffer", header);
+        return false;
+    }
+
+    if (mNativeBufferStride != 0 && (uint32_t)buffer->stride == mNativeBufferStride) {
+        void *data;
+        status_t err = GraphicBufferMapper::get().lock(
+                buffer->handle, GRALLOC_USAGE_SW_WRITE_OFTEN,
+                Rect(buffer->width, buffer->height), &data);
+        if (err != OK) {
+            ALOGE("could not lock graphic buffer %p (err %d)", buffer->handle, err);
+            return false;
+        }
+        getNativeBufferPlanes(buffer, (uint8_t *)data, planes);
+        return true;
+    }
+
+    // the chroma planes are not at half of the luma stride, decode into an intermediate frame
+    if (mNativeBufferFrame == NULL || mNativeBufferFrame->capacity() < sizeY + sizeY / 2) {
+        mNativeBufferFrame = new ABuffer(sizeY + sizeY / 2);
+    }
+    planes->mY = mNativeBufferFrame->data();
+    planes->mU = planes->mY + sizeY;
+    planes->mV = planes->mU + sizeY / 4;
+    planes->mYStride = stride;
+    planes->mUVStride = stride / 2;
+    return true;
+}
+
+void SoftVideoDecoderOMXComponent::unlockOutputBuffer(OMX_BUFFERHEADERTYPE *header) {
+    if (!mUseNativeBuffers) {
+        return;
+    }
+
+    sp<ANativeWindowBuffer> buffer = getNativeBuffer(header);
+    if (buffer == NULL) {
+        return;
+    }
+
+    GraphicBufferMapper &mapper = GraphicBufferMapper::get();
+    if (mNativeBufferStride == 0 || (uint32_t)buffer->stride != mNativeBufferStride) {
+        void *data;
+        status_t err = mapper.lock(
+                buffer->handle, GRALLOC_USAGE_SW_WRITE_OFTEN,
+                Rect(buffer->width, buffer->height), &data);
+        if (err != OK) {
+            ALOGE("could not lock graphic buffer %p (err %d)", buffer->handle, err);
+            return;
+        }
+        OutputPlanes planes;
+        getNativeBufferPlanes(buffer, (uint8_t *)data, &planes);
+
+        size_t stride = outputBufferStride();
+        const uint8_t *srcY = mNativeBufferFrame->data();
+        const uint8_t *srcU = srcY + stride * outputBufferHeight();
+        const uint8_t *srcV = srcU + stride * outputBufferHeight() / 4;
+        copyYV12FrameToOutputPlanes(planes, srcY, srcU, srcV, stride, stride / 2, stride / 2);
     }
+    mapper.unlock(buffer->handle);
 }
 
 OMX_ERRORTYPE SoftVideoDecoderOMXComponent::internalGetParameter(
         OMX_INDEXTYPE index, OMX_PTR params) {
-    switch (index) {
+    // Include extension index OMX_INDEXEXTTYPE.
+    const int32_t indexFull = index;
+
+    switch (indexFull) {
         case OMX_IndexParamVideoPortFormat:
         {
             OMX_VIDEO_PARAM_PORTFORMATTYPE *formatParams =
@@ -388,6 +582,23 @@ OMX_ERRORTYPE SoftVideoDecoderOMXComponent::internalGetParameter(
             return OMX_ErrorNone;
         }
 
+        case kGetAndroidNativeBufferUsageIndex:
+        {
+            GetAndroidNativeBufferUsageParams *usageParams =
+                (GetAndroidNativeBufferUsageParams *)params;
+
+            if (!isValidOMXParam(usageParams)) {
+                return OMX_ErrorBadParameter;
+            }
+
+            if (usageParams->nPortIndex != kOutputPortIndex) {
+                return OMX_ErrorBadPortIndex;
+            }
+
+            usageParams->nUsage = GRALLOC_USAGE_SW_WRITE_OFTEN;
+            return OMX_ErrorNone;
+        }
+
         default:
             return SimpleSoftOMXComponent::internalGetParameter(index, params);
     }
@@ -449,6 +660,68 @@ OMX_ERRORTYPE SoftVideoDecoderOMXComponent::internalSetParameter(
             return OMX_ErrorNone;
         }
 
+        case kEnableAndroidNativeBuffersIndex:
+        {
+            const EnableAndroidNativeBuffersParams *enableParams =
+                    (const EnableAndroidNativeBuffersParams *)params;
+
+            if (!isValidOMXParam(enableParams)) {
+                return OMX_ErrorBadParameter;
+            }
+
+            if (enableParams->nPortIndex != kOutputPortIndex) {
+                return OMX_ErrorBadPortIndex;
+            }
+
+            mUseNativeBuffers = enableParams->enable;
+            mNativeBufferStride = 0;
+            // the format of the graphic buffers, which are then allocated by the client
+            editPortInfo(kOutputPortIndex)->mDef.format.video.eColorFormat = mUseNativeBuffers ?
+                    (OMX_COLOR_FORMATTYPE)HAL_PIXEL_FORMAT_YV12 : OMX_COLOR_FormatYUV420Planar;
+            return OMX_ErrorNone;
+        }
+
+        case kUseAndroidNativeBufferIndex:
+        {
+            const UseAndroidNativeBufferParams *useParams =
+                    (const UseAndroidNativeBufferParams *)params;
+
+            // not standard layout, as it holds a reference
+            if (useParams->nSize < sizeof(UseAndroidNativeBufferParams)) {
+                return OMX_ErrorBadParameter;
+            }
+
+            if (useParams->nPortIndex != kOutputPortIndex || !mUseNativeBuffers) {
+                return OMX_ErrorBadPortIndex;
+            }
+
+            const sp<ANativeWindowBuffer> &buffer = useParams->nativeBuffer;
+            if (buffer == NULL || buffer->format != HAL_PIXEL_FORMAT_YV12
+                    || (uint32_t)buffer->width < outputBufferWidth()
+                    || (uint32_t)buffer->height < outputBufferHeight()) {
+                ALOGE("unsupported graphic buffer");
+                return OMX_ErrorBadParameter;
+            }
+
+            OMX_ERRORTYPE err = internalUseBuffer(
+                    useParams->bufferHeader, useParams->nPortIndex, useParams->pAppPrivate,
+                    editPortInfo(kOutputPortIndex)->mDef.nBufferSize,
+                    const_cast<OMX_U8 *>(reinterpret_cast<const OMX_U8 *>(buffer->handle)),
+                    buffer);
+            if (err != OMX_ErrorNone) {
+                return err;
+            }
+
+            // The decoders write chroma planes at half of the luma stride, so the buffers are
+            // written in place only if their chroma planes are aligned that way.
+            uint32_t stride = buffer->stride;
+            uint32_t uvStride = (stride / 2 + 15) & ~15;
+            mNativeBufferStride = uvStride * 2 == stride ? stride : 0;
+            ALOGV("using graphic buffer %dx%d stride %d%s", buffer->width, buffer->height,
+                    buffer->stride, mNativeBufferStride == 0 ? " through a copy" : "");
+            return OMX_ErrorNone;
+        }
+
         case kPrepareForAdaptivePlaybackIndex:
         {
             const PrepareForAdaptivePlaybackParams* adaptivePlaybackParams =
@@ -613,6 +886,17 @@ OMX_ERRORTYPE SoftVideoDecoderOMXComponent::getExtensionIndex(
                 && supportsDescribeColorAspects()) {
         *(int32_t*)index = kDescribeColorAspectsIndex;
         return OMX_ErrorNone;
+    } else if (supportsNativeBuffers()) {
+        if (!strcmp(name, "OMX.google.android.index.enableAndroidNativeBuffers")) {
+            *(int32_t*)index = kEnableAndroidNativeBuffersIndex;
+            return OMX_ErrorNone;
+        } else if (!strcmp(name, "OMX.google.android.index.getAndroidNativeBufferUsage")) {
+            *(int32_t*)index = kGetAndroidNativeBufferUsageIndex;
+            return OMX_ErrorNone;
+        } else if (!strcmp(name, "OMX.google.android.index.useAndroidNativeBuffer")) {
+            *(int32_t*)index = kUseAndroidNativeBufferIndex;
+            return OMX_ErrorNone;
+        }
     }
 
     return SimpleSoftOMXComponent::getExtensionIndex(name, index);
@@ -15,6 +15,7 @@
  */
 
 #include <inttypes.h>
+#include <unistd.h>
 
 //#define LOG_NDEBUG 0
 #define LOG_TAG "SoftVideoEncoderOMXComponent"
@@ -70,6 +71,7 @@ SoftVideoEncoderOMXComponent::SoftVideoEncoderOMXComponent(
       mBitrate(192000),
       mFramerate(30 << 16), // Q16 format
       mColorFormat(OMX_COLOR_FormatYUV420Planar),
+      mRealTime(false),
       mMinOutputBufferSize(384), // arbitrary, using one uncompressed macroblock
       mMinCompressionRatio(1),   // max output size is normally the input size
       mComponentRole(componentRole),
@@ -646,6 +648,57 @@ const uint8_t *SoftVideoEncoderOMXComponent::extractGraphicBuffer(
     return dst;
 }
 
+OMX_ERRORTYPE SoftVideoEncoderOMXComponent::getConfig(
+        OMX_INDEXTYPE index, OMX_PTR params) {
+    switch ((int)index) {
+        case OMX_IndexConfigPriority:
+        {
+            OMX_PARAM_U32TYPE *priority = (OMX_PARAM_U32TYPE *)params;
+
+            if (!isValidOMXParam(priority)) {
+                return OMX_ErrorBadParameter;
+            }
+
+            priority->nU32 = mRealTime ? 0 : 1;
+            return OMX_ErrorNone;
+        }
+
+        default:
+            return SimpleSoftOMXComponent::getConfig(index, params);
+    }
+}
+
+OMX_ERRORTYPE SoftVideoEncoderOMXComponent::setConfig(
+        OMX_INDEXTYPE index, const OMX_PTR params) {
+    switch ((int)index) {
+        case OMX_IndexConfigPriority:
+        {
+            const OMX_PARAM_U32TYPE *priority = (const OMX_PARAM_U32TYPE *)params;
+
+            if (!isValidOMXParam(priority)) {
+                return OMX_ErrorBadParameter;
+            }
+
+            // takes effect when the encoder is initialized
+            mRealTime = priority->nU32 == 0;
+            return OMX_ErrorNone;
+        }
+
+        default:
+            return SimpleSoftOMXComponent::setConfig(index, params);
+    }
+}
+
+size_t SoftVideoEncoderOMXComponent::getRealTimeEncodeThreads(size_t maxThreads) const {
+    long onlineCores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t cores = onlineCores > 1 ? (size_t)onlineCores : 1;
+
+    size_t macroblocks = (size_t)divUp(mWidth, 16) * divUp(mHeight, 16);
+    size_t wanted = divUp(macroblocks, (size_t)kMacroblocksPerEncodeThread);
+    size_t threads = min(min(wanted, maxThreads), cores);
+    return threads > 0 ? threads : 1;
+}
+
 OMX_ERRORTYPE SoftVideoEncoderOMXComponent::getExtensionIndex(
         const char *name, OMX_INDEXTYPE *index) {
     if (!strcmp(name, "OMX.google.android.index.storeMetaDataInBuffers") ||
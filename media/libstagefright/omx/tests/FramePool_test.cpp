@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "FramePool_test"
+#include <utils/Log.h>
+
+#include <gtest/gtest.h>
+
+#include "FramePool.h"
+#include <media/stagefright/foundation/ADebug.h>
+
+namespace android {
+
+static const size_t k720pFrame = 1280 * 720 * 3 / 2;
+static const size_t k1080pFrame = 1920 * 1088 * 3 / 2;
+
+class FramePoolTest : public ::testing::Test {
+public:
+    FramePoolTest() : mPool(new FramePool) {}
+
+protected:
+    sp<FramePool> mPool;
+};
+
+TEST_F(FramePoolTest, SizeClassesAreAQuarterOfAPowerOfTwoApart) {
+    EXPECT_EQ(4u, FramePool::SizeClass(4));
+    EXPECT_EQ(65536u, FramePool::SizeClass(65536));
+    EXPECT_EQ(81920u, FramePool::SizeClass(65537));
+    EXPECT_EQ(98304u, FramePool::SizeClass(81921));
+    EXPECT_EQ(131072u, FramePool::SizeClass(114689));
+    for (size_t size = 5; size < (1 << 24); size = size * 5 / 3) {
+        size_t sizeClass = FramePool::SizeClass(size);
+        EXPECT_GE(sizeClass, size);
+        EXPECT_LT(sizeClass, size + size / 4 + 1);
+    }
+}
+
+TEST_F(FramePoolTest, ReusesFreedFrames) {
+    void *frames[4];
+    for (size_t i = 0; i < 4; ++i) {
+        frames[i] = mPool->allocate(64, k1080pFrame);
+        ASSERT_TRUE(frames[i] != NULL);
+        EXPECT_EQ(0u, (uintptr_t)frames[i] % FramePool::kAlignment);
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        mPool->free(frames[i]);
+    }
+
+    // the same frames are handed out for the same resolution, and for a smaller one
+    void *reused[4];
+    for (size_t i = 0; i < 4; ++i) {
+        const size_t size = i < 2 ? k720pFrame : k1080pFrame;
+        reused[i] = mPool->allocate(128, size);
+        EXPECT_TRUE(reused[i] == frames[0] || reused[i] == frames[1]
+                || reused[i] == frames[2] || reused[i] == frames[3]);
+        memset(reused[i], 0, size);
+    }
+    EXPECT_EQ(0u, mPool->freeBytes());
+    for (size_t i = 0; i < 4; ++i) {
+        mPool->free(reused[i]);
+    }
+}
+
+TEST_F(FramePoolTest, DoesNotReuseMuchLargerFrames) {
+    void *frame = mPool->allocate(128, k1080pFrame);
+    mPool->free(frame);
+
+    void *small = mPool->allocate(128, k1080pFrame / FramePool::kMaxWasteFactor - 4096);
+    EXPECT_TRUE(small != frame);
+    mPool->free(small);
+}
+
+TEST_F(FramePoolTest, KeepsNoMoreThanThePeakUsage) {
+    const size_t largeSize = FramePool::SizeClass(k1080pFrame);
+    void *large = mPool->allocate(128, k1080pFrame);
+    mPool->free(large);
+    EXPECT_EQ(largeSize, mPool->freeBytes());
+
+    // too small to reuse the free frame, and evicted once freed
+    void *frame = mPool->allocate(128, FramePool::kMinPooledSize);
+    EXPECT_TRUE(frame != large);
+    mPool->free(frame);
+    EXPECT_EQ(largeSize, mPool->freeBytes());
+
+    EXPECT_TRUE(mPool->allocate(128, k1080pFrame) == large);
+    EXPECT_EQ(0u, mPool->freeBytes());
+    mPool->free(large);
+
+    mPool->clear();
+    EXPECT_EQ(0u, mPool->freeBytes());
+}
+
+TEST_F(FramePoolTest, PassesSmallBlocksThrough) {
+    void *block = mPool->allocate(16, FramePool::kMinPooledSize - 1);
+    ASSERT_TRUE(block != NULL);
+    mPool->free(block);
+    mPool->free(NULL);
+
+    void *aligned = mPool->allocate(4096, k720pFrame);
+    ASSERT_TRUE(aligned != NULL);
+    EXPECT_EQ(0u, (uintptr_t)aligned % 4096);
+    mPool->free(aligned);
+}
+
+} // namespace android
@@ -0,0 +1,1141 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the throughput of the software codecs of SoftOMXPlugin. Each component is
+// instantiated in process, without binder, and decodes a file of the corpus directory or
+// encodes a synthetic signal, once or a few times. The results are written as JSON: frames
+// per second, CPU milliseconds per frame, peak RSS and a checksum of the output, which is
+// expected not to change unless the output of the codec does.
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "SoftCodecBenchmark"
+#include <inttypes.h>
+#include <utils/Log.h>
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cutils/properties.h>
+#include <media/stagefright/foundation/ABuffer.h>
+#include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/AMessage.h>
+#include <media/stagefright/foundation/AString.h>
+#include <media/stagefright/DataSource.h>
+#include <media/stagefright/MediaDefs.h>
+#include <media/stagefright/NuMediaExtractor.h>
+#include <utils/List.h>
+#include <utils/String8.h>
+#include <utils/threads.h>
+#include <utils/Vector.h>
+
+#include <OMX_Component.h>
+
+#include "SoftOMXPlugin.h"
+
+namespace android {
+
+static const char *kDefaultCorpusDir = "/data/local/tmp/softcodec_corpus";
+
+// the benchmark gives up on a component that makes no progress for this long
+static const int64_t kTimeoutNs = 5000000000ll;
+
+enum {
+    kPortIndexInput = 0,
+    kPortIndexOutput = 1,
+};
+
+struct BenchmarkOptions {
+    AString mCorpusDir;
+    size_t mMaxFrames;          // input frames, 0 for the whole corpus file
+    size_t mRuns;               // the fastest run is reported
+    int32_t mWidth;             // of the video encoders
+    int32_t mHeight;
+    int32_t mFrameRate;
+    int32_t mAudioDurationSec;  // of the audio encoders
+};
+
+struct CodecInfo {
+    const char *mRole;
+    const char *mMime;
+    const char *mCorpusFile;    // decoded by the decoders, or NULL for the encoders
+};
+
+static const CodecInfo kCodecInfos[] = {
+    { "video_decoder.avc",      MEDIA_MIMETYPE_VIDEO_AVC,       "h264.mp4" },
+    { "video_decoder.hevc",     MEDIA_MIMETYPE_VIDEO_HEVC,      "hevc.mp4" },
+    { "video_decoder.mpeg2",    MEDIA_MIMETYPE_VIDEO_MPEG2,     "mpeg2.ts" },
+    { "video_decoder.mpeg4",    MEDIA_MIMETYPE_VIDEO_MPEG4,     "mpeg4.mp4" },
+    { "video_decoder.h263",     MEDIA_MIMETYPE_VIDEO_H263,      "h263.3gp" },
+    { "video_decoder.vp8",      MEDIA_MIMETYPE_VIDEO_VP8,       "vp8.webm" },
+    { "video_decoder.vp9",      MEDIA_MIMETYPE_VIDEO_VP9,       "vp9.webm" },
+    { "audio_decoder.aac",      MEDIA_MIMETYPE_AUDIO_AAC,       "aac.m4a" },
+    { "audio_decoder.amrnb",    MEDIA_MIMETYPE_AUDIO_AMR_NB,    "amrnb.amr" },
+    { "audio_decoder.amrwb",    MEDIA_MIMETYPE_AUDIO_AMR_WB,    "amrwb.awb" },
+    { "audio_decoder.mp3",      MEDIA_MIMETYPE_AUDIO_MPEG,      "mp3.mp3" },
+    { "audio_decoder.vorbis",   MEDIA_MIMETYPE_AUDIO_VORBIS,    "vorbis.ogg" },
+    { "audio_decoder.opus",     MEDIA_MIMETYPE_AUDIO_OPUS,      "opus.webm" },
+    { "audio_decoder.raw",      MEDIA_MIMETYPE_AUDIO_RAW,       "raw.wav" },
+    { "audio_decoder.g711alaw", MEDIA_MIMETYPE_AUDIO_G711_ALAW, "alaw.wav" },
+    { "audio_decoder.g711mlaw", MEDIA_MIMETYPE_AUDIO_G711_MLAW, "mlaw.wav" },
+    { "audio_decoder.gsm",      MEDIA_MIMETYPE_AUDIO_MSGSM,     "gsm.wav" },
+    { "video_encoder.avc",      MEDIA_MIMETYPE_VIDEO_AVC,       NULL },
+    { "video_encoder.mpeg4",    MEDIA_MIMETYPE_VIDEO_MPEG4,     NULL },
+    { "video_encoder.h263",     MEDIA_MIMETYPE_VIDEO_H263,      NULL },
+    { "video_encoder.vp8",      MEDIA_MIMETYPE_VIDEO_VP8,       NULL },
+    { "audio_encoder.aac",      MEDIA_MIMETYPE_AUDIO_AAC,       NULL },
+    { "audio_encoder.amrnb",    MEDIA_MIMETYPE_AUDIO_AMR_NB,    NULL },
+    { "audio_encoder.amrwb",    MEDIA_MIMETYPE_AUDIO_AMR_WB,    NULL },
+    { "audio_encoder.flac",     MEDIA_MIMETYPE_AUDIO_FLAC,      NULL },
+};
+
+static const CodecInfo *FindCodecInfo(const char *role) {
+    for (size_t i = 0; i < sizeof(kCodecInfos) / sizeof(kCodecInfos[0]); ++i) {
+        if (!strcmp(role, kCodecInfos[i].mRole)) {
+            return &kCodecInfos[i];
+        }
+    }
+    return NULL;
+}
+
+template<class T>
+static void InitOMXParams(T *params) {
+    params->nSize = sizeof(T);
+    params->nVersion.s.nVersionMajor = 1;
+    params->nVersion.s.nVersionMinor = 0;
+    params->nVersion.s.nRevision = 0;
+    params->nVersion.s.nStep = 0;
+}
+
+static int64_t GetNowNs(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+// Resets the peak RSS of the process, for the next ReadPeakRssKb() to report the peak of the
+// run that follows. Returns false if the kernel doesn't support it.
+static bool ResetPeakRss() {
+    int fd = open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = write(fd, "5", 1) == 1;
+    close(fd);
+    return ok;
+}
+
+static int64_t ReadPeakRssKb() {
+    FILE *file = fopen("/proc/self/status", "re");
+    if (file == NULL) {
+        return -1;
+    }
+    int64_t peakKb = -1;
+    char line[128];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "VmHWM: %" SCNd64, &peakKb) == 1) {
+            break;
+        }
+    }
+    fclose(file);
+    return peakKb;
+}
+
+static uint32_t UpdateChecksum(uint32_t checksum, const uint8_t *data, size_t size) {
+    // FNV-1a
+    for (size_t i = 0; i < size; ++i) {
+        checksum = (checksum ^ data[i]) * 16777619u;
+    }
+    return checksum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Fills the input buffers of a component.
+struct InputSource {
+    virtual ~InputSource() {}
+
+    // Fills |header| with the next input, flagged with EOS if it is the last one. Returns false
+    // once the last input was returned.
+    virtual bool fill(OMX_BUFFERHEADERTYPE *header) = 0;
+};
+
+// Compressed samples of the corpus, read into memory beforehand.
+struct SampleSource : public InputSource {
+    struct Sample {
+        sp<ABuffer> mData;
+        int64_t mTimeUs;
+        uint32_t mFlags;
+    };
+
+    SampleSource() : mNext(0) {}
+
+    status_t load(const char *path, const char *mime, size_t maxFrames, sp<AMessage> *format);
+
+    virtual bool fill(OMX_BUFFERHEADERTYPE *header);
+
+private:
+    Vector<Sample> mSamples;
+    size_t mNext;
+};
+
+status_t SampleSource::load(
+        const char *path, const char *mime, size_t maxFrames, sp<AMessage> *format) {
+    sp<NuMediaExtractor> extractor = new NuMediaExtractor;
+    status_t err = extractor->setDataSource(NULL /* httpService */, path);
+    if (err != OK) {
+        return err;
+    }
+
+    size_t trackIndex = extractor->countTracks();
+    for (size_t i = 0; i < extractor->countTracks(); ++i) {
+        sp<AMessage> trackFormat;
+        AString trackMime;
+        if (extractor->getTrackFormat(i, &trackFormat) == OK
+                && trackFormat->findString("mime", &trackMime)
+                && !strcasecmp(trackMime.c_str(), mime)) {
+            trackIndex = i;
+            *format = trackFormat;
+            break;
+        }
+    }
+    if (trackIndex == extractor->countTracks()) {
+        ALOGE("no %s track in %s", mime, path);
+        return ERROR_UNSUPPORTED;
+    }
+    err = extractor->selectTrack(trackIndex);
+    if (err != OK) {
+        return err;
+    }
+
+    for (size_t i = 0;; ++i) {
+        sp<ABuffer> csd;
+        if (!(*format)->findBuffer(AStringPrintf("csd-%zu", i).c_str(), &csd)) {
+            break;
+        }
+        Sample sample = { csd, 0, OMX_BUFFERFLAG_CODECCONFIG };
+        mSamples.push_back(sample);
+    }
+
+    size_t numFrames = 0;
+    int64_t timeUs;
+    sp<ABuffer> scratch = new ABuffer(4 * 1024 * 1024);
+    while ((maxFrames == 0 || numFrames < maxFrames)
+            && extractor->getSampleTime(&timeUs) == OK) {
+        err = extractor->readSampleData(scratch);
+        if (err != OK) {
+            break;
+        }
+        sp<ABuffer> data = new ABuffer(scratch->size());
+        memcpy(data->data(), scratch->data(), scratch->size());
+        Sample sample = { data, timeUs, OMX_BUFFERFLAG_ENDOFFRAME };
+        mSamples.push_back(sample);
+        ++numFrames;
+        extractor->advance();
+    }
+    if (numFrames == 0) {
+        return ERROR_END_OF_STREAM;
+    }
+    mSamples.editItemAt(mSamples.size() - 1).mFlags |= OMX_BUFFERFLAG_EOS;
+    return OK;
+}
+
+bool SampleSource::fill(OMX_BUFFERHEADERTYPE *header) {
+    if (mNext == mSamples.size()) {
+        return false;
+    }
+    const Sample &sample = mSamples.itemAt(mNext++);
+    size_t size = sample.mData->size();
+    if (size > header->nAllocLen) {
+        ALOGW("truncating a sample of %zu bytes to %u", size, header->nAllocLen);
+        size = header->nAllocLen;
+    }
+    memcpy(header->pBuffer, sample.mData->data(), size);
+    header->nOffset = 0;
+    header->nFilledLen = size;
+    header->nTimeStamp = sample.mTimeUs;
+    header->nFlags = sample.mFlags;
+    return true;
+}
+
+// A synthetic signal for the encoders: a moving gradient for video, or a few sine waves of
+// different frequencies for audio, generated beforehand and repeated.
+struct SyntheticSource : public InputSource {
+    SyntheticSource() : mFrameSize(0), mFrameDurationUs(0), mNumFrames(0), mNext(0) {}
+
+    void initVideo(int32_t width, int32_t height, int32_t frameRate, size_t numFrames);
+    void initAudio(int32_t sampleRate, int32_t channels, size_t frameSamples, size_t numFrames);
+
+    size_t frameSize() const { return mFrameSize; }
+
+    virtual bool fill(OMX_BUFFERHEADERTYPE *header);
+
+private:
+    enum {
+        kNumVideoFrames = 16,
+    };
+
+    sp<ABuffer> mData;
+    size_t mFrameSize;
+    int64_t mFrameDurationUs;
+    size_t mNumFrames;
+    size_t mNext;
+};
+
+void SyntheticSource::initVideo(
+        int32_t width, int32_t height, int32_t frameRate, size_t numFrames) {
+    mFrameSize = width * height * 3 / 2;
+    mFrameDurationUs = 1000000ll / frameRate;
+    mNumFrames = numFrames;
+    mData = new ABuffer(mFrameSize * kNumVideoFrames);
+    for (size_t n = 0; n < kNumVideoFrames; ++n) {
+        uint8_t *y = mData->data() + n * mFrameSize;
+        uint8_t *u = y + width * height;
+        uint8_t *v = u + width * height / 4;
+        for (int32_t i = 0; i < height; ++i) {
+            for (int32_t j = 0; j < width; ++j) {
+                y[i * width + j] = (uint8_t)(i + j * 2 + n * 8) ^ (uint8_t)((i / 16) * 5);
+            }
+        }
+        for (int32_t i = 0; i < height / 2; ++i) {
+            for (int32_t j = 0; j < width / 2; ++j) {
+                u[i * width / 2 + j] = (uint8_t)(128 + i - n * 4);
+                v[i * width / 2 + j] = (uint8_t)(128 + j + n * 4);
+            }
+        }
+    }
+}
+
+void SyntheticSource::initAudio(
+        int32_t sampleRate, int32_t channels, size_t frameSamples, size_t numFrames) {
+    mFrameSize = frameSamples * channels * sizeof(int16_t);
+    mFrameDurationUs = frameSamples * 1000000ll / sampleRate;
+    mNumFrames = numFrames;
+
+    // a second of signal, in whole frames
+    size_t numSamples = (sampleRate + frameSamples - 1) / frameSamples * frameSamples;
+    mData = new ABuffer(numSamples * channels * sizeof(int16_t));
+    int16_t *pcm = (int16_t *)mData->data();
+    for (size_t i = 0; i < numSamples; ++i) {
+        double t = (double)i / sampleRate;
+        for (int32_t c = 0; c < channels; ++c) {
+            double x = 0.4 * sin(2 * M_PI * (220 + 110 * c) * t)
+                    + 0.2 * sin(2 * M_PI * 1375 * t) + 0.1 * sin(2 * M_PI * 4410 * t * t);
+            pcm[i * channels + c] = (int16_t)(x * 32767);
+        }
+    }
+}
+
+bool SyntheticSource::fill(OMX_BUFFERHEADERTYPE *header) {
+    if (mNext == mNumFrames) {
+        return false;
+    }
+    size_t numDataFrames = mData->size() / mFrameSize;
+    size_t size = mFrameSize < header->nAllocLen ? mFrameSize : header->nAllocLen;
+    memcpy(header->pBuffer, mData->data() + (mNext % numDataFrames) * mFrameSize, size);
+    header->nOffset = 0;
+    header->nFilledLen = size;
+    header->nTimeStamp = mNext * mFrameDurationUs;
+    header->nFlags = OMX_BUFFERFLAG_ENDOFFRAME;
+    if (++mNext == mNumFrames) {
+        header->nFlags |= OMX_BUFFERFLAG_EOS;
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct RunResult {
+    size_t mInputFrames;
+    size_t mOutputFrames;
+    int64_t mMediaDurationUs;
+    int64_t mWallNs;
+    int64_t mCpuNs;
+    int64_t mPeakRssKb;
+    uint32_t mChecksum;
+};
+
+// Runs one component from Loaded to Executing and back, as ACodec would, without binder.
+struct Session {
+    Session(SoftOMXPlugin *plugin, const char *componentName);
+    ~Session();
+
+    status_t init(const char *role);
+
+    OMX_ERRORTYPE getParameter(OMX_INDEXTYPE index, OMX_PTR params);
+    OMX_ERRORTYPE setParameter(OMX_INDEXTYPE index, OMX_PTR params);
+
+    // Decodes or encodes all of |source|.
+    status_t run(InputSource *source, RunResult *result);
+
+private:
+    struct Message {
+        enum Type {
+            EVENT,
+            EMPTY_BUFFER_DONE,
+            FILL_BUFFER_DONE,
+        };
+        Type mType;
+        OMX_EVENTTYPE mEvent;
+        OMX_U32 mData1;
+        OMX_U32 mData2;
+        OMX_BUFFERHEADERTYPE *mHeader;
+    };
+
+    SoftOMXPlugin *mPlugin;
+    AString mComponentName;
+    OMX_COMPONENTTYPE *mComponent;
+
+    Mutex mLock;
+    Condition mCondition;
+    List<Message> mMessages;
+
+    Vector<OMX_BUFFERHEADERTYPE *> mBuffers[2];
+    // the output buffers are being freed for a port reconfiguration
+    bool mOutputPortDisabling;
+    // input buffers returned while waiting for a command
+    Vector<OMX_BUFFERHEADERTYPE *> mReturnedInputBuffers;
+
+    static OMX_CALLBACKTYPE kCallbacks;
+
+    static OMX_ERRORTYPE OnEvent(
+            OMX_HANDLETYPE component, OMX_PTR appData, OMX_EVENTTYPE event,
+            OMX_U32 data1, OMX_U32 data2, OMX_PTR eventData);
+    static OMX_ERRORTYPE OnEmptyBufferDone(
+            OMX_HANDLETYPE component, OMX_PTR appData, OMX_BUFFERHEADERTYPE *header);
+    static OMX_ERRORTYPE OnFillBufferDone(
+            OMX_HANDLETYPE component, OMX_PTR appData, OMX_BUFFERHEADERTYPE *header);
+
+    void post(const Message &msg);
+    status_t dequeueMessage(Message *msg);
+
+    // Waits for the completion of |command|, handling the buffers returned meanwhile.
+    status_t waitForCommand(OMX_COMMANDTYPE command, OMX_U32 data);
+
+    status_t allocateBuffers(OMX_U32 portIndex);
+    void freeBuffers(OMX_U32 portIndex);
+    void freeBuffer(OMX_U32 portIndex, OMX_BUFFERHEADERTYPE *header);
+
+    DISALLOW_EVIL_CONSTRUCTORS(Session);
+};
+
+OMX_CALLBACKTYPE Session::kCallbacks = {
+    &OnEvent, &OnEmptyBufferDone, &OnFillBufferDone
+};
+
+Session::Session(SoftOMXPlugin *plugin, const char *componentName)
+    : mPlugin(plugin),
+      mComponentName(componentName),
+      mComponent(NULL),
+      mOutputPortDisabling(false) {
+}
+
+Session::~Session() {
+    if (mComponent != NULL) {
+        mPlugin->destroyComponentInstance(mComponent);
+    }
+}
+
+status_t Session::init(const char *role) {
+    OMX_ERRORTYPE err = mPlugin->makeComponentInstance(
+            mComponentName.c_str(), &kCallbacks, this, &mComponent);
+    if (err != OMX_ErrorNone) {
+        ALOGE("could not instantiate %s: 0x%x", mComponentName.c_str(), err);
+        mComponent = NULL;
+        return UNKNOWN_ERROR;
+    }
+
+    OMX_PARAM_COMPONENTROLETYPE params;
+    InitOMXParams(&params);
+    strncpy((char *)params.cRole, role, OMX_MAX_STRINGNAME_SIZE - 1);
+    params.cRole[OMX_MAX_STRINGNAME_SIZE - 1] = '\0';
+    err = setParameter(OMX_IndexParamStandardComponentRole, &params);
+    if (err != OMX_ErrorNone) {
+        ALOGW("%s does not take role %s: 0x%x", mComponentName.c_str(), role, err);
+    }
+    return OK;
+}
+
+OMX_ERRORTYPE Session::getParameter(OMX_INDEXTYPE index, OMX_PTR params) {
+    return OMX_GetParameter(mComponent, index, params);
+}
+
+OMX_ERRORTYPE Session::setParameter(OMX_INDEXTYPE index, OMX_PTR params) {
+    return OMX_SetParameter(mComponent, index, params);
+}
+
+// static
+OMX_ERRORTYPE Session::OnEvent(
+        OMX_HANDLETYPE /* component */, OMX_PTR appData, OMX_EVENTTYPE event,
+        OMX_U32 data1, OMX_U32 data2, OMX_PTR /* eventData */) {
+    Message msg = { Message::EVENT, event, data1, data2, NULL };
+    static_cast<Session *>(appData)->post(msg);
+    return OMX_ErrorNone;
+}
+
+// static
+OMX_ERRORTYPE Session::OnEmptyBufferDone(
+        OMX_HANDLETYPE /* component */, OMX_PTR appData, OMX_BUFFERHEADERTYPE *header) {
+    Message msg = { Message::EMPTY_BUFFER_DONE, OMX_EventMax, 0, 0, header };
+    static_cast<Session *>(appData)->post(msg);
+    return OMX_ErrorNone;
+}
+
+// static
+OMX_ERRORTYPE Session::OnFillBufferDone(
+        OMX_HANDLETYPE /* component */, OMX_PTR appData, OMX_BUFFERHEADERTYPE *header) {
+    Message msg = { Message::FILL_BUFFER_DONE, OMX_EventMax, 0, 0, header };
+    static_cast<Session *>(appData)->post(msg);
+    return OMX_ErrorNone;
+}
+
+void Session::post(const Message &msg) {
+    Mutex::Autolock autoLock(mLock);
+    mMessages.push_back(msg);
+    mCondition.signal();
+}
+
+status_t Session::dequeueMessage(Message *msg) {
+    Mutex::Autolock autoLock(mLock);
+    while (mMessages.empty()) {
+        if (mCondition.waitRelative(mLock, kTimeoutNs) != OK) {
+            ALOGE("%s timed out", mComponentName.c_str());
+            return TIMED_OUT;
+        }
+    }
+    *msg = *mMessages.begin();
+    mMessages.erase(mMessages.begin());
+    return OK;
+}
+
+status_t Session::waitForCommand(OMX_COMMANDTYPE command, OMX_U32 data) {
+    for (;;) {
+        Message msg;
+        status_t err = dequeueMessage(&msg);
+        if (err != OK) {
+            return err;
+        }
+        if (msg.mType == Message::EMPTY_BUFFER_DONE) {
+            mReturnedInputBuffers.push_back(msg.mHeader);
+        } else if (msg.mType == Message::FILL_BUFFER_DONE && mOutputPortDisabling) {
+            freeBuffer(kPortIndexOutput, msg.mHeader);
+        }
+        if (msg.mType != Message::EVENT) {
+            continue;
+        }
+        if (msg.mEvent == OMX_EventError) {
+            ALOGE("%s signalled error 0x%x", mComponentName.c_str(), msg.mData1);
+            return UNKNOWN_ERROR;
+        }
+        if (msg.mEvent == OMX_EventCmdComplete
+                && msg.mData1 == (OMX_U32)command && msg.mData2 == data) {
+            return OK;
+        }
+    }
+}
+
+status_t Session::allocateBuffers(OMX_U32 portIndex) {
+    OMX_PARAM_PORTDEFINITIONTYPE def;
+    InitOMXParams(&def);
+    def.nPortIndex = portIndex;
+    if (getParameter(OMX_IndexParamPortDefinition, &def) != OMX_ErrorNone) {
+        return UNKNOWN_ERROR;
+    }
+    for (OMX_U32 i = 0; i < def.nBufferCountActual; ++i) {
+        OMX_BUFFERHEADERTYPE *header;
+        OMX_ERRORTYPE err = OMX_AllocateBuffer(
+                mComponent, &header, portIndex, NULL, def.nBufferSize);
+        if (err != OMX_ErrorNone) {
+            ALOGE("could not allocate %u buffers of %u bytes on port %u",
+                    def.nBufferCountActual, def.nBufferSize, portIndex);
+            return NO_MEMORY;
+        }
+        mBuffers[portIndex].push_back(header);
+    }
+    return OK;
+}
+
+void Session::freeBuffer(OMX_U32 portIndex, OMX_BUFFERHEADERTYPE *header) {
+    Vector<OMX_BUFFERHEADERTYPE *> &buffers = mBuffers[portIndex];
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        if (buffers[i] == header) {
+            OMX_FreeBuffer(mComponent, portIndex, header);
+            buffers.removeAt(i);
+            return;
+        }
+    }
+}
+
+void Session::freeBuffers(OMX_U32 portIndex) {
+    Vector<OMX_BUFFERHEADERTYPE *> &buffers = mBuffers[portIndex];
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        OMX_FreeBuffer(mComponent, portIndex, buffers[i]);
+    }
+    buffers.clear();
+}
+
+status_t Session::run(InputSource *source, RunResult *result) {
+    memset(result, 0, sizeof(*result));
+    result->mChecksum = 2166136261u;
+
+    OMX_SendCommand(mComponent, OMX_CommandStateSet, OMX_StateIdle, NULL);
+    status_t err = allocateBuffers(kPortIndexInput);
+    if (err == OK) {
+        err = allocateBuffers(kPortIndexOutput);
+    }
+    if (err == OK) {
+        err = waitForCommand(OMX_CommandStateSet, OMX_StateIdle);
+    }
+    if (err == OK) {
+        OMX_SendCommand(mComponent, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+        err = waitForCommand(OMX_CommandStateSet, OMX_StateExecuting);
+    }
+    if (err != OK) {
+        return err;
+    }
+
+    const bool peakRssReset = ResetPeakRss();
+    const int64_t startWallNs = GetNowNs(CLOCK_MONOTONIC);
+    const int64_t startCpuNs = GetNowNs(CLOCK_PROCESS_CPUTIME_ID);
+
+    for (size_t i = 0; i < mBuffers[kPortIndexOutput].size(); ++i) {
+        OMX_FillThisBuffer(mComponent, mBuffers[kPortIndexOutput][i]);
+    }
+    bool inputDone = false;
+    for (size_t i = 0; i < mBuffers[kPortIndexInput].size() && !inputDone; ++i) {
+        OMX_BUFFERHEADERTYPE *header = mBuffers[kPortIndexInput][i];
+        if (source->fill(header)) {
+            ++result->mInputFrames;
+            OMX_EmptyThisBuffer(mComponent, header);
+        } else {
+            inputDone = true;
+        }
+    }
+
+    bool outputDone = false;
+    while (!outputDone && err == OK) {
+        Message msg;
+        err = dequeueMessage(&msg);
+        if (err != OK) {
+            break;
+        }
+
+        switch (msg.mType) {
+            case Message::EMPTY_BUFFER_DONE:
+            {
+                if (!inputDone && source->fill(msg.mHeader)) {
+                    ++result->mInputFrames;
+                    OMX_EmptyThisBuffer(mComponent, msg.mHeader);
+                } else {
+                    inputDone = true;
+                }
+                break;
+            }
+
+            case Message::FILL_BUFFER_DONE:
+            {
+                OMX_BUFFERHEADERTYPE *header = msg.mHeader;
+                if (mOutputPortDisabling) {
+                    freeBuffer(kPortIndexOutput, header);
+                    break;
+                }
+                if (header->nFilledLen > 0) {
+                    ++result->mOutputFrames;
+                    result->mMediaDurationUs = header->nTimeStamp;
+                    result->mChecksum = UpdateChecksum(result->mChecksum,
+                            header->pBuffer + header->nOffset, header->nFilledLen);
+                }
+                if (header->nFlags & OMX_BUFFERFLAG_EOS) {
+                    outputDone = true;
+                } else {
+                    header->nFilledLen = 0;
+                    header->nFlags = 0;
+                    OMX_FillThisBuffer(mComponent, header);
+                }
+                break;
+            }
+
+            case Message::EVENT:
+            {
+                if (msg.mEvent == OMX_EventError) {
+                    ALOGE("%s signalled error 0x%x", mComponentName.c_str(), msg.mData1);
+                    err = UNKNOWN_ERROR;
+                } else if (msg.mEvent == OMX_EventPortSettingsChanged
+                        && msg.mData1 == kPortIndexOutput
+                        && (msg.mData2 == 0 || msg.mData2 == OMX_IndexParamPortDefinition)) {
+                    // reconfigure the output port, its buffers are freed as they are returned
+                    mOutputPortDisabling = true;
+                    OMX_SendCommand(mComponent, OMX_CommandPortDisable, kPortIndexOutput, NULL);
+                    err = waitForCommand(OMX_CommandPortDisable, kPortIndexOutput);
+                    mOutputPortDisabling = false;
+                    if (err == OK) {
+                        OMX_SendCommand(
+                                mComponent, OMX_CommandPortEnable, kPortIndexOutput, NULL);
+                        err = allocateBuffers(kPortIndexOutput);
+                    }
+                    if (err == OK) {
+                        err = waitForCommand(OMX_CommandPortEnable, kPortIndexOutput);
+                    }
+                    for (size_t i = 0; err == OK && i < mBuffers[kPortIndexOutput].size(); ++i) {
+                        OMX_FillThisBuffer(mComponent, mBuffers[kPortIndexOutput][i]);
+                    }
+                    for (size_t i = 0; i < mReturnedInputBuffers.size(); ++i) {
+                        OMX_BUFFERHEADERTYPE *header = mReturnedInputBuffers[i];
+                        if (!inputDone && source->fill(header)) {
+                            ++result->mInputFrames;
+                            OMX_EmptyThisBuffer(mComponent, header);
+                        } else {
+                            inputDone = true;
+                        }
+                    }
+                    mReturnedInputBuffers.clear();
+                }
+                break;
+            }
+        }
+    }
+
+    result->mWallNs = GetNowNs(CLOCK_MONOTONIC) - startWallNs;
+    result->mCpuNs = GetNowNs(CLOCK_PROCESS_CPUTIME_ID) - startCpuNs;
+    result->mPeakRssKb = peakRssReset ? ReadPeakRssKb() : -1;
+
+    // back to Loaded, the component returns the buffers it holds on its way to Idle
+    OMX_SendCommand(mComponent, OMX_CommandStateSet, OMX_StateIdle, NULL);
+    status_t err2 = waitForCommand(OMX_CommandStateSet, OMX_StateIdle);
+    if (err2 == OK) {
+        OMX_SendCommand(mComponent, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+        freeBuffers(kPortIndexInput);
+        freeBuffers(kPortIndexOutput);
+        err2 = waitForCommand(OMX_CommandStateSet, OMX_StateLoaded);
+    }
+    return err != OK ? err : err2;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct Benchmark {
+    Benchmark(const BenchmarkOptions &options, SoftOMXPlugin *plugin)
+        : mOptions(options),
+          mPlugin(plugin) {
+    }
+
+    // Benchmarks |componentName| in |role|, and appends its JSON result to |json|.
+    void run(const char *componentName, const char *role, AString *json);
+
+private:
+    BenchmarkOptions mOptions;
+    SoftOMXPlugin *mPlugin;
+
+    status_t configureDecoder(
+            Session *session, const CodecInfo &info, const sp<AMessage> &format);
+    status_t configureEncoder(
+            Session *session, const CodecInfo &info, SyntheticSource *source, AString *config);
+
+    DISALLOW_EVIL_CONSTRUCTORS(Benchmark);
+};
+
+status_t Benchmark::configureDecoder(
+        Session *session, const CodecInfo &info, const sp<AMessage> &format) {
+    int32_t width, height;
+    if (format->findInt32("width", &width) && format->findInt32("height", &height)) {
+        OMX_PARAM_PORTDEFINITIONTYPE def;
+        InitOMXParams(&def);
+        def.nPortIndex = kPortIndexInput;
+        if (session->getParameter(OMX_IndexParamPortDefinition, &def) != OMX_ErrorNone) {
+            return UNKNOWN_ERROR;
+        }
+        def.format.video.nFrameWidth = width;
+        def.format.video.nFrameHeight = height;
+        // the decoders reconfigure their output port otherwise
+        session->setParameter(OMX_IndexParamPortDefinition, &def);
+        return OK;
+    }
+
+    int32_t channels, sampleRate;
+    if (!format->findInt32("channel-count", &channels)
+            || !format->findInt32("sample-rate", &sampleRate)) {
+        return OK;
+    }
+    int32_t isADTS;
+    if (!strcmp(info.mMime, MEDIA_MIMETYPE_AUDIO_AAC)
+            && format->findInt32("is-adts", &isADTS) && isADTS) {
+        OMX_AUDIO_PARAM_AACPROFILETYPE aac;
+        InitOMXParams(&aac);
+        aac.nPortIndex = kPortIndexInput;
+        if (session->getParameter(OMX_IndexParamAudioAac, &aac) != OMX_ErrorNone) {
+            return UNKNOWN_ERROR;
+        }
+        aac.nChannels = channels;
+        aac.nSampleRate = sampleRate;
+        aac.eAACStreamFormat = OMX_AUDIO_AACStreamFormatMP4ADTS;
+        if (session->setParameter(OMX_IndexParamAudioAac, &aac) != OMX_ErrorNone) {
+            return UNKNOWN_ERROR;
+        }
+    } else if (!strcmp(info.mMime, MEDIA_MIMETYPE_AUDIO_RAW)
+            || !strcmp(info.mMime, MEDIA_MIMETYPE_AUDIO_G711_ALAW)
+            || !strcmp(info.mMime, MEDIA_MIMETYPE_AUDIO_G711_MLAW)
+            || !strcmp(info.mMime, MEDIA_MIMETYPE_AUDIO_MSGSM)) {
+        OMX_AUDIO_PARAM_PCMMODETYPE pcm;
+        InitOMXParams(&pcm);
+        pcm.nPortIndex = kPortIndexInput;
+        if (session->getParameter(OMX_IndexParamAudioPcm, &pcm) != OMX_ErrorNone) {
+            return UNKNOWN_ERROR;
+        }
+        pcm.nChannels = channels;
+        pcm.nSamplingRate = sampleRate;
+        if (session->setParameter(OMX_IndexParamAudioPcm, &pcm) != OMX_ErrorNone) {
+            return UNKNOWN_ERROR;
+        }
+    }
+    return OK;
+}
+
+status_t Benchmark::configureEncoder(
+        Session *session, const CodecInfo &info, SyntheticSource *source, AString *config) {
+    OMX_PARAM_PORTDEFINITIONTYPE def;
+    InitOMXParams(&def);
+
+    if (!strncmp(info.mMime, "video/", 6)) {
+        int32_t width = mOptions.mWidth;
+        int32_t height = mOptions.mHeight;
+        if (!strcmp(info.mMime, MEDIA_MIMETYPE_VIDEO_H263)) {
+            // the only sizes of H.263 baseline that the encoder supports are the standard ones
+            width = 352;
+            height = 288;
+        }
+        const int32_t frameRate = mOptions.mFrameRate;
+        // about 0.1 bit per pixel
+        const int32_t bitRate = width * height * frameRate / 10;
+
+        def.nPortIndex = kPortIndexInput;
+        if (session->getParameter(OMX_IndexParamPortDefinition, &def) != OMX_ErrorNone) {
+            return UNKNOWN_ERROR;
+        }
+        def.format.video.nFrameWidth = width;
+        def.format.video.nFrameHeight = height;
+        def.format.video.nStride = width;
+        def.format.video.nSliceHeight = height;
+        def.format.video.xFramerate = frameRate << 16;
+        def.format.video.eColorFormat = OMX_COLOR_FormatYUV420Planar;
+        def.nBufferSize = width * height * 3 / 2;
+        if (session->setParameter(OMX_IndexParamPortDefinition, &def) != OMX_ErrorNone) {
+            return UNKNOWN_ERROR;
+        }
+
+        def.nPortIndex = kPortIndexOutput;
+        if (session->getParameter(OMX_IndexParamPortDefinition, &def) != OMX_ErrorNone) {
+            return UNKNOWN_ERROR;
+        }
+        def.format.video.nFrameWidth = width;
+        def.format.video.nFrameHeight = height;
+        def.format.video.nBitrate = bitRate;
+        def.format.video.xFramerate = 0;
+        if (session->setParameter(OMX_IndexParamPortDefinition, &def) != OMX_ErrorNone) {
+            return UNKNOWN_ERROR;
+        }
+
+        size_t numFrames = mOptions.mMaxFrames > 0 ? mOptions.mMaxFrames : 10 * frameRate;
+        source->initVideo(width, height, frameRate, numFrames);
+        *config = AStringPrintf(
+                "\"width\": %d, \"height\": %d, \"frame_rate\": %d, \"bit_rate\": %d",
+                width, height, frameRate, bitRate);
+        return OK;
+    }
+
+    int32_t sampleRate = 44100;
+    int32_t channels = 2;
+    size_t frameSamples = 1024;
+    int32_t bitRate = 0;
+    if (!strcmp(info.mMime, MEDIA_MIMETYPE_AUDIO_AMR_NB)) {
+        sampleRate = 8000;
+        channels = 1;
+        frameSamples = 160;
+    } else if (!strcmp(info.mMime, MEDIA_MIMETYPE_AUDIO_AMR_WB)) {
+        sampleRate = 16000;
+        channels = 1;
+        frameSamples = 320;
+    } else if (!strcmp(info.mMime, MEDIA_MIMETYPE_AUDIO_FLAC)) {
+        frameSamples = 1152;
+    }
+
+    OMX_AUDIO_PARAM_PCMMODETYPE pcm;
+    InitOMXParams(&pcm);
+    pcm.nPortIndex = kPortIndexInput;
+    if (session->getParameter(OMX_IndexParamAudioPcm, &pcm) != OMX_ErrorNone) {
+        return UNKNOWN_ERROR;
+    }
+    pcm.nChannels = channels;
+    pcm.nSamplingRate = sampleRate;
+    if (session->setParameter(OMX_IndexParamAudioPcm, &pcm) != OMX_ErrorNone) {
+        return UNKNOWN_ERROR;
+    }
+
+    if (!strcmp(info.mMime, MEDIA_MIMETYPE_AUDIO_AAC)) {
+        bitRate = 128000;
+        OMX_AUDIO_PARAM_AACPROFILETYPE aac;
+        InitOMXParams(&aac);
+        aac.nPortIndex = kPortIndexOutput;
+        if (session->getParameter(OMX_IndexParamAudioAac, &aac) != OMX_ErrorNone) {
+            return UNKNOWN_ERROR;
+        }
+        aac.nChannels = channels;
+        aac.nSampleRate = sampleRate;
+        aac.nBitRate = bitRate;
+        aac.eAACProfile = OMX_AUDIO_AACObjectLC;
+        aac.eAACStreamFormat = OMX_AUDIO_AACStreamFormatMP4FF;
+        if (session->setParameter(OMX_IndexParamAudioAac, &aac) != OMX_ErrorNone) {
+            return UNKNOWN_ERROR;
+        }
+    } else if (!strcmp(info.mMime, MEDIA_MIMETYPE_AUDIO_AMR_NB)
+            || !strcmp(info.mMime, MEDIA_MIMETYPE_AUDIO_AMR_WB)) {
+        const bool wide = !strcmp(info.mMime, MEDIA_MIMETYPE_AUDIO_AMR_WB);
+        bitRate = wide ? 23850 : 12200;
+        OMX_AUDIO_PARAM_AMRTYPE amr;
+        InitOMXParams(&amr);
+        amr.nPortIndex = kPortIndexOutput;
+        if (session->getParameter(OMX_IndexParamAudioAmr, &amr) != OMX_ErrorNone) {
+            return UNKNOWN_ERROR;
+        }
+        amr.eAMRBandMode = wide ? OMX_AUDIO_AMRBandModeWB8 : OMX_AUDIO_AMRBandModeNB7;
+        if (session->setParameter(OMX_IndexParamAudioAmr, &amr) != OMX_ErrorNone) {
+            return UNKNOWN_ERROR;
+        }
+    }
+
+    size_t numFrames = mOptions.mMaxFrames > 0 ? mOptions.mMaxFrames
+            : (size_t)mOptions.mAudioDurationSec * sampleRate / frameSamples;
+    source->initAudio(sampleRate, channels, frameSamples, numFrames);
+    *config = AStringPrintf(
+            "\"sample_rate\": %d, \"channels\": %d, \"bit_rate\": %d",
+            sampleRate, channels, bitRate);
+    return OK;
+}
+
+void Benchmark::run(const char *componentName, const char *role, AString *json) {
+    const CodecInfo *info = FindCodecInfo(role);
+    const char *status = "ok";
+    AString detail;
+    AString config;
+    RunResult best;
+    bool haveResult = false;
+    bool stable = true;
+
+    // the corpus is read once, for the runs to only measure the codec
+    sp<AMessage> format;
+    SampleSource samples;
+    if (info == NULL) {
+        status = "skipped";
+        detail = "unknown role";
+    } else if (info->mCorpusFile != NULL) {
+        AString path = AStringPrintf("%s/%s", mOptions.mCorpusDir.c_str(), info->mCorpusFile);
+        if (access(path.c_str(), R_OK) != 0) {
+            status = "skipped";
+            detail = AStringPrintf("no %s", path.c_str());
+        } else if (samples.load(path.c_str(), info->mMime, mOptions.mMaxFrames, &format) != OK) {
+            status = "error";
+            detail = AStringPrintf("could not read %s", path.c_str());
+        }
+    }
+
+    for (size_t run = 0; run < mOptions.mRuns && !strcmp(status, "ok"); ++run) {
+        Session session(mPlugin, componentName);
+        SyntheticSource synthetic;
+        status_t err = session.init(role);
+        if (err == OK) {
+            err = info->mCorpusFile != NULL ? configureDecoder(&session, *info, format)
+                    : configureEncoder(&session, *info, &synthetic, &config);
+        }
+        RunResult result;
+        if (err == OK) {
+            SampleSource runSamples = samples;
+            InputSource *source = info->mCorpusFile != NULL
+                    ? static_cast<InputSource *>(&runSamples) : &synthetic;
+            err = session.run(source, &result);
+        }
+        if (err != OK) {
+            status = "error";
+            detail = AStringPrintf("failed with %d", err);
+            break;
+        }
+        if (haveResult && result.mChecksum != best.mChecksum) {
+            stable = false;
+        }
+        if (!haveResult || result.mWallNs < best.mWallNs) {
+            best = result;
+            haveResult = true;
+        }
+    }
+
+    if (!json->empty()) {
+        json->append(",\n");
+    }
+    json->append(AStringPrintf(
+            "    {\"component\": \"%s\", \"role\": \"%s\", \"status\": \"%s\"",
+            componentName, role, status));
+    if (!detail.empty()) {
+        json->append(AStringPrintf(", \"detail\": \"%s\"", detail.c_str()));
+    }
+    if (!config.empty()) {
+        json->append(", ");
+        json->append(config);
+    }
+    if (haveResult) {
+        const double wallSec = best.mWallNs / 1E9;
+        const size_t frames = best.mOutputFrames > 0 ? best.mOutputFrames : 1;
+        json->append(AStringPrintf(
+                ",\n     \"runs\": %zu, \"input_frames\": %zu, \"output_frames\": %zu,"
+                " \"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"fps\": %.2f, \"cpu_ms_per_frame\": %.4f,"
+                " \"realtime_factor\": %.2f, \"peak_rss_kb\": %" PRId64 ","
+                " \"checksum\": \"%08x\", \"stable\": %s",
+                mOptions.mRuns, best.mInputFrames, best.mOutputFrames,
+                best.mWallNs / 1E6, best.mCpuNs / 1E6,
+                wallSec > 0 ? best.mOutputFrames / wallSec : 0.,
+                best.mCpuNs / 1E6 / frames,
+                wallSec > 0 ? best.mMediaDurationUs / 1E6 / wallSec : 0.,
+                best.mPeakRssKb, best.mChecksum, stable ? "true" : "false"));
+    }
+    json->append("}");
+
+    fprintf(stderr, "%-32s %-24s %s%s%s\n", componentName, role, status,
+            haveResult ? AStringPrintf(" %.1f fps", best.mOutputFrames * 1E9 / best.mWallNs)
+                    .c_str() : "",
+            detail.empty() ? "" : AStringPrintf(" (%s)", detail.c_str()).c_str());
+}
+
+}  // namespace android
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [options] [component ...]\n"
+                    "  -h        Show this information\n"
+                    "  -c dir    Corpus directory (default %s)\n"
+                    "  -n count  Maximum number of input frames (default: the whole file,\n"
+                    "            10 s of encoder input)\n"
+                    "  -r runs   Number of runs, the fastest is reported (default 3)\n"
+                    "  -s WxH    Size of the video encoder input (default 1280x720)\n"
+                    "  -o file   Writes the JSON results to file instead of stdout\n\n"
+                    "Benchmarks the given software components, or all of them, in all of their\n"
+                    "roles. Decoders decode the file of the corpus directory for their role, e.g.\n"
+                    "h264.mp4 or aac.m4a, and are skipped if it is missing.\n",
+                    me, android::kDefaultCorpusDir);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    using namespace android;
+
+    DataSource::RegisterDefaultSniffers();
+
+    BenchmarkOptions options;
+    options.mCorpusDir = kDefaultCorpusDir;
+    options.mMaxFrames = 0;
+    options.mRuns = 3;
+    options.mWidth = 1280;
+    options.mHeight = 720;
+    options.mFrameRate = 30;
+    options.mAudioDurationSec = 10;
+    const char *outputPath = NULL;
+
+    int res;
+    while ((res = getopt(argc, argv, "hc:n:r:s:o:")) >= 0) {
+        switch (res) {
+            case 'c':
+                options.mCorpusDir = optarg;
+                break;
+
+            case 'n':
+                options.mMaxFrames = strtoul(optarg, NULL, 10);
+                break;
+
+            case 'r':
+            {
+                options.mRuns = strtoul(optarg, NULL, 10);
+                if (options.mRuns == 0) {
+                    usage(argv[0]);
+                }
+                break;
+            }
+
+            case 's':
+            {
+                if (sscanf(optarg, "%dx%d", &options.mWidth, &options.mHeight) != 2
+                        || options.mWidth <= 0 || options.mHeight <= 0
+                        || (options.mWidth & 15) || (options.mHeight & 1)) {
+                    fprintf(stderr, "Malformed size, the width must be a multiple of 16.\n");
+                    return 1;
+                }
+                break;
+            }
+
+            case 'o':
+                outputPath = optarg;
+                break;
+
+            case 'h':
+            default:
+                usage(argv[0]);
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    SoftOMXPlugin plugin;
+    Vector<AString> components;
+    if (argc > 0) {
+        for (int i = 0; i < argc; ++i) {
+            components.push_back(AString(argv[i]));
+        }
+    } else {
+        char name[128];
+        for (OMX_U32 i = 0; plugin.enumerateComponents(name, sizeof(name), i)
+                == OMX_ErrorNone; ++i) {
+            components.push_back(AString(name));
+        }
+    }
+
+    Benchmark benchmark(options, &plugin);
+    AString results;
+    for (size_t i = 0; i < components.size(); ++i) {
+        Vector<String8> roles;
+        if (plugin.getRolesOfComponent(components[i].c_str(), &roles) != OMX_ErrorNone) {
+            fprintf(stderr, "unknown component %s\n", components[i].c_str());
+            continue;
+        }
+        for (size_t j = 0; j < roles.size(); ++j) {
+            benchmark.run(components[i].c_str(), roles[j].string(), &results);
+        }
+    }
+
+    char fingerprint[PROPERTY_VALUE_MAX];
+    property_get("ro.build.fingerprint", fingerprint, "unknown");
+    AString json = AStringPrintf(
+            "{\n  \"build\": \"%s\",\n  \"corpus\": \"%s\",\n  \"results\": [\n%s\n  ]\n}\n",
+            fingerprint, options.mCorpusDir.c_str(), results.c_str());
+
+    FILE *out = outputPath != NULL ? fopen(outputPath, "we") : stdout;
+    if (out == NULL) {
+        fprintf(stderr, "could not open %s\n", outputPath);
+        return 1;
+    }
+    fputs(json.c_str(), out);
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
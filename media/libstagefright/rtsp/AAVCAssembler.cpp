@@ -159,8 +159,8 @@ bool AAVCAssembler::addSingleTimeAggregationPacket(const sp<ABuffer> &buffer) {
             return false;
         }
 
-        sp<ABuffer> unit = new ABuffer(nalSize);
-        memcpy(unit->data(), &data[2], nalSize);
+        // the NAL units are only copied once, into the access unit
+        sp<ABuffer> unit = ABuffer::CreateAsSlice(buffer, data + 2 - buffer->data(), nalSize);
 
         CopyTimes(unit, buffer);
 
@@ -279,17 +279,11 @@ ARTPAssembler::AssemblyStatus AAVCAssembler::addFragmentedNALUnit(
     mNextExpectedSeqNo = expectedSeqNo;
 
     // We found all the fragments that make up the complete NAL unit.
+    ALOGV("NAL unit of %zu bytes in %zu fragments", totalSize + 1, totalCount);
 
-    // Leave room for the header. So far totalSize did not include the
-    // header byte.
-    ++totalSize;
-
-    sp<ABuffer> unit = new ABuffer(totalSize);
-    CopyTimes(unit, *queue->begin());
-
-    unit->data()[0] = (nri << 5) | nalType;
-
-    size_t offset = 1;
+    // The fragments are only copied once, into the access unit. The NAL header
+    // replaces the FU header of the first fragment, the other fragments are
+    // trimmed to their payload and follow it without a start code.
     List<sp<ABuffer> >::iterator it = queue->begin();
     for (size_t i = 0; i < totalCount; ++i) {
         const sp<ABuffer> &buffer = *it;
@@ -299,16 +293,19 @@ ARTPAssembler::AssemblyStatus AAVCAssembler::addFragmentedNALUnit(
         hexdump(buffer->data(), buffer->size());
 #endif
 
-        memcpy(unit->data() + offset, buffer->data() + 2, buffer->size() - 2);
-        offset += buffer->size() - 2;
+        if (i == 0) {
+            buffer->data()[1] = (nri << 5) | nalType;
+            buffer->setRange(buffer->offset() + 1, buffer->size() - 1);
+            addSingleNALUnit(buffer);
+        } else {
+            buffer->setRange(buffer->offset() + 2, buffer->size() - 2);
+            buffer->meta()->setInt32("fragment", true);
+            mNALUnits.push_back(buffer);
+        }
 
         it = queue->erase(it);
     }
 
-    unit->setRange(0, totalSize);
-
-    addSingleNALUnit(unit);
-
     ALOGV("successfully assembled a NAL unit from fragments.");
 
     return OK;
@@ -322,17 +319,26 @@ void AAVCAssembler::submitAccessUnit() {
     size_t totalSize = 0;
     for (List<sp<ABuffer> >::iterator it = mNALUnits.begin();
          it != mNALUnits.end(); ++it) {
-        totalSize += 4 + (*it)->size();
+        int32_t fragment;
+        if (!(*it)->meta()->findInt32("fragment", &fragment)) {
+            totalSize += 4;
+        }
+        totalSize += (*it)->size();
     }
 
     sp<ABuffer> accessUnit = new ABuffer(totalSize);
     size_t offset = 0;
     for (List<sp<ABuffer> >::iterator it = mNALUnits.begin();
          it != mNALUnits.end(); ++it) {
-        memcpy(accessUnit->data() + offset, "\x00\x00\x00\x01", 4);
-        offset += 4;
-
         sp<ABuffer> nal = *it;
+
+        // continuation fragments of a NAL unit follow it without a start code
+        int32_t fragment;
+        if (!nal->meta()->findInt32("fragment", &fragment)) {
+            memcpy(accessUnit->data() + offset, "\x00\x00\x00\x01", 4);
+            offset += 4;
+        }
+
         memcpy(accessUnit->data() + offset, nal->data(), nal->size());
         offset += nal->size();
     }
@@ -45,6 +45,9 @@ private:
     bool mNextExpectedSeqNoValid;
     uint32_t mNextExpectedSeqNo;
     bool mAccessUnitDamaged;
+
+    // The NAL units of the access unit, a fragmented NAL unit is followed by the
+    // remaining fragments, which carry "fragment" in their meta.
     List<sp<ABuffer> > mNALUnits;
 
     AssemblyStatus addNALUnit(const sp<ARTPSource> &source);
@@ -31,12 +31,19 @@
 #include <media/stagefright/foundation/hexdump.h>
 
 #include <arpa/inet.h>
+#include <errno.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
 namespace android {
 
 static const size_t kMaxUDPSize = 1500;
 
+// RTP datagrams are received in batches of up to this many slots of this size.
+static const size_t kNumReceiveSlots = 16;
+static const size_t kReceiveSlotSize = 4096;
+
 static uint16_t u16at(const uint8_t *data) {
     return data[0] << 8 | data[1];
 }
@@ -50,7 +57,7 @@ static uint64_t u64at(const uint8_t *data) {
 }
 
 // static
-const int64_t ARTPConnection::kSelectTimeoutUs = 1000ll;
+const int64_t ARTPConnection::kPollTimeoutUs = 1000ll;
 
 struct ARTPConnection::StreamInfo {
     int mRTPSocket;
@@ -65,15 +72,22 @@ struct ARTPConnection::StreamInfo {
     struct sockaddr_in mRemoteRTCPAddr;
 
     bool mIsInjected;
+
+    // Cleared once a datagram does not fit in a receive slot, the datagrams are
+    // then received one at a time.
+    bool mReceiveBatched;
 };
 
 ARTPConnection::ARTPConnection(uint32_t flags)
     : mFlags(flags),
+      mEpollFd(epoll_create1(EPOLL_CLOEXEC)),
       mPollEventPending(false),
       mLastReceiverReportTimeUs(-1) {
+    CHECK_GE(mEpollFd, 0);
 }
 
 ARTPConnection::~ARTPConnection() {
+    close(mEpollFd);
 }
 
 void ARTPConnection::addStream(
@@ -204,8 +218,17 @@ void ARTPConnection::onAddStream(const sp<AMessage> &msg) {
     info->mNumRTCPPacketsReceived = 0;
     info->mNumRTPPacketsReceived = 0;
     memset(&info->mRemoteRTCPAddr, 0, sizeof(info->mRemoteRTCPAddr));
+    info->mReceiveBatched = true;
 
     if (!injected) {
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = info->mRTPSocket;
+        CHECK_EQ(epoll_ctl(mEpollFd, EPOLL_CTL_ADD, info->mRTPSocket, &event), 0);
+        event.data.fd = info->mRTCPSocket;
+        CHECK_EQ(epoll_ctl(mEpollFd, EPOLL_CTL_ADD, info->mRTCPSocket, &event), 0);
+
         postPollEvent();
     }
 }
@@ -225,7 +248,60 @@ void ARTPConnection::onRemoveStream(const sp<AMessage> &msg) {
         return;
     }
 
-    mStreams.erase(it);
+    eraseStream(it);
+}
+
+List<ARTPConnection::StreamInfo>::iterator ARTPConnection::eraseStream(
+        List<StreamInfo>::iterator it) {
+    if (!it->mIsInjected) {
+        // the sockets may be closed already, which removed them
+        epoll_ctl(mEpollFd, EPOLL_CTL_DEL, it->mRTPSocket, NULL);
+        epoll_ctl(mEpollFd, EPOLL_CTL_DEL, it->mRTCPSocket, NULL);
+    }
+    return mStreams.erase(it);
+}
+
+void ARTPConnection::sendFeedback() {
+    sp<ABuffer> buffer;
+    for (List<StreamInfo>::iterator it = mStreams.begin(); it != mStreams.end(); ++it) {
+        StreamInfo *s = &*it;
+
+        if (s->mIsInjected || s->mNumRTCPPacketsReceived == 0) {
+            continue;
+        }
+
+        for (size_t i = 0; i < s->mSources.size(); ++i) {
+            sp<ARTPSource> source = s->mSources.valueAt(i);
+            if (!source->hasPendingFeedback()) {
+                continue;
+            }
+
+            if (buffer == NULL) {
+                buffer = new ABuffer(kMaxUDPSize);
+            }
+
+            // feedback goes in a compound packet that starts with a receiver report
+            buffer->setRange(0, 0);
+            source->addReceiverReport(buffer);
+            source->addFeedback(buffer);
+
+            ALOGV("Sending RTCP feedback...");
+
+            ssize_t n;
+            do {
+                n = sendto(
+                    s->mRTCPSocket, buffer->data(), buffer->size(), 0,
+                    (const struct sockaddr *)&s->mRemoteRTCPAddr,
+                    sizeof(s->mRemoteRTCPAddr));
+            } while (n < 0 && errno == EINTR);
+
+            if (n <= 0) {
+                // the receiver reports find out whether the connection is gone
+                ALOGW("failed to send RTCP feedback (%s).",
+                     n == 0 ? "connection gone" : strerror(errno));
+            }
+        }
+    }
 }
 
 void ARTPConnection::postPollEvent() {
@@ -246,65 +322,53 @@ void ARTPConnection::onPollStreams() {
         return;
     }
 
-    struct timeval tv;
-    tv.tv_sec = 0;
-    tv.tv_usec = kSelectTimeoutUs;
-
-    fd_set rs;
-    FD_ZERO(&rs);
-
-    int maxSocket = -1;
+    bool polling = false;
     for (List<StreamInfo>::iterator it = mStreams.begin();
          it != mStreams.end(); ++it) {
-        if ((*it).mIsInjected) {
-            continue;
-        }
-
-        FD_SET(it->mRTPSocket, &rs);
-        FD_SET(it->mRTCPSocket, &rs);
-
-        if (it->mRTPSocket > maxSocket) {
-            maxSocket = it->mRTPSocket;
-        }
-        if (it->mRTCPSocket > maxSocket) {
-            maxSocket = it->mRTCPSocket;
+        if (!(*it).mIsInjected) {
+            polling = true;
+            break;
         }
     }
 
-    if (maxSocket == -1) {
+    if (!polling) {
         return;
     }
 
-    int res = select(maxSocket + 1, &rs, NULL, NULL, &tv);
+    struct epoll_event events[16];
+    int res = epoll_wait(
+            mEpollFd, events, sizeof(events) / sizeof(events[0]), kPollTimeoutUs / 1000ll);
 
-    if (res > 0) {
-        List<StreamInfo>::iterator it = mStreams.begin();
-        while (it != mStreams.end()) {
-            if ((*it).mIsInjected) {
-                ++it;
-                continue;
-            }
+    for (int i = 0; i < res; ++i) {
+        int fd = events[i].data.fd;
 
-            status_t err = OK;
-            if (FD_ISSET(it->mRTPSocket, &rs)) {
-                err = receive(&*it, true);
-            }
-            if (err == OK && FD_ISSET(it->mRTCPSocket, &rs)) {
-                err = receive(&*it, false);
-            }
+        List<StreamInfo>::iterator it = mStreams.begin();
+        while (it != mStreams.end()
+                && (it->mIsInjected || (it->mRTPSocket != fd && it->mRTCPSocket != fd))) {
+            ++it;
+        }
+        if (it == mStreams.end()) {
+            // removed by an earlier event of this batch
+            continue;
+        }
 
-            if (err == -ECONNRESET) {
-                // socket failure, this stream is dead, Jim.
+        status_t err;
+        if (fd == it->mRTPSocket) {
+            err = it->mReceiveBatched ? receiveRTPBatch(&*it) : receive(&*it, true);
+        } else {
+            err = receive(&*it, false);
+        }
 
-                ALOGW("failed to receive RTP/RTCP datagram.");
-                it = mStreams.erase(it);
-                continue;
-            }
+        if (err == -ECONNRESET) {
+            // socket failure, this stream is dead, Jim.
 
-            ++it;
+            ALOGW("failed to receive RTP/RTCP datagram.");
+            eraseStream(it);
         }
     }
 
+    sendFeedback();
+
     int64_t nowUs = ALooper::GetNowUs();
     if (mLastReceiverReportTimeUs <= 0
             || mLastReceiverReportTimeUs + 5000000ll <= nowUs) {
@@ -352,7 +416,7 @@ void ARTPConnection::onPollStreams() {
                     ALOGW("failed to send RTCP receiver report (%s).",
                          n == 0 ? "connection gone" : strerror(errno));
 
-                    it = mStreams.erase(it);
+                    it = eraseStream(it);
                     continue;
                 }
 
@@ -410,6 +474,58 @@ status_t ARTPConnection::receive(StreamInfo *s, bool receiveRTP) {
     return err;
 }
 
+status_t ARTPConnection::receiveRTPBatch(StreamInfo *s) {
+    ALOGV("receiving RTP batch");
+
+    CHECK(!s->mIsInjected);
+
+    if (mReceiveSlots == NULL) {
+        mReceiveSlots = new ABuffer(kNumReceiveSlots * kReceiveSlotSize);
+    }
+
+    struct iovec iovs[kNumReceiveSlots];
+    struct mmsghdr msgs[kNumReceiveSlots];
+    memset(msgs, 0, sizeof(msgs));
+    for (size_t i = 0; i < kNumReceiveSlots; ++i) {
+        iovs[i].iov_base = mReceiveSlots->data() + i * kReceiveSlotSize;
+        iovs[i].iov_len = kReceiveSlotSize;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int n;
+    do {
+        n = recvmmsg(s->mRTPSocket, msgs, kNumReceiveSlots, MSG_DONTWAIT, NULL);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return OK;
+    } else if (n <= 0) {
+        return -ECONNRESET;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        if (msgs[i].msg_len == 0) {
+            return -ECONNRESET;
+        }
+
+        if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+            // the datagram is lost, receive the next ones whole
+            ALOGW("RTP datagram larger than %zu bytes, no longer receiving in batches",
+                    kReceiveSlotSize);
+            s->mReceiveBatched = false;
+            continue;
+        }
+
+        sp<ABuffer> buffer = new ABuffer(msgs[i].msg_len);
+        memcpy(buffer->data(), iovs[i].iov_base, msgs[i].msg_len);
+
+        parseRTP(s, buffer);
+    }
+
+    return OK;
+}
+
 status_t ARTPConnection::parseRTP(StreamInfo *s, const sp<ABuffer> &buffer) {
     if (s->mNumRTPPacketsReceived++ == 0) {
         sp<AMessage> notify = s->mNotifyMsg->dup();
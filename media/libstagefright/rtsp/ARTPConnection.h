@@ -62,13 +62,20 @@ private:
         kWhatInjectPacket,
     };
 
-    static const int64_t kSelectTimeoutUs;
+    static const int64_t kPollTimeoutUs;
 
     uint32_t mFlags;
 
     struct StreamInfo;
     List<StreamInfo> mStreams;
 
+    // The sockets of the streams that are not injected.
+    int mEpollFd;
+
+    // recvmmsg() receives a batch of RTP datagrams in these slots, which are
+    // then copied to buffers of their size.
+    sp<ABuffer> mReceiveSlots;
+
     bool mPollEventPending;
     int64_t mLastReceiverReportTimeUs;
 
@@ -79,6 +86,10 @@ private:
     void onSendReceiverReports();
 
     status_t receive(StreamInfo *info, bool receiveRTP);
+    status_t receiveRTPBatch(StreamInfo *info);
+    void sendFeedback();
+
+    List<StreamInfo>::iterator eraseStream(List<StreamInfo>::iterator it);
 
     status_t parseRTP(StreamInfo *info, const sp<ABuffer> &buffer);
     status_t parseRTCP(StreamInfo *info, const sp<ABuffer> &buffer);
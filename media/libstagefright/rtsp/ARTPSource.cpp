@@ -37,6 +37,42 @@ namespace android {
 
 static const uint32_t kSourceID = 0xdeadbeef;
 
+// Bounds of the wait for a missing packet, the lower one when NACKs give the sender a
+// chance to retransmit it.
+static const int64_t kMinReorderTimeoutUs = 10000ll;
+static const int64_t kMinNACKReorderTimeoutUs = 50000ll;
+static const int64_t kMaxReorderTimeoutUs = 200000ll;
+
+// Larger gaps in the sequence numbers are taken as a restart of the sender.
+static const size_t kMaxMissingPackets = 256;
+static const int64_t kMissingPacketLifetimeUs = 1000000ll;
+
+// A packet is only NACKed once this many packets following it have arrived, so that
+// packets which are merely reordered are not requested again.
+static const uint32_t kNACKReorderThreshold = 3;
+static const size_t kMaxNACKEntries = 32;
+static const int64_t kMinPLIIntervalUs = 1000000ll;
+
+static void ParseFeedback(const AString &value, bool *nack, bool *pli) {
+    size_t start = 0;
+    while (start <= value.size()) {
+        ssize_t end = value.find(";", start);
+        if (end < 0) {
+            end = value.size();
+        }
+
+        AString type(value, start, end - start);
+        type.trim();
+        if (type == "nack") {
+            *nack = true;
+        } else if (type == "nack pli") {
+            *pli = true;
+        }
+
+        start = end + 1;
+    }
+}
+
 ARTPSource::ARTPSource(
         uint32_t id,
         const sp<ASessionDescription> &sessionDesc, size_t index,
@@ -44,6 +80,19 @@ ARTPSource::ARTPSource(
     : mID(id),
       mHighestSeqNumber(0),
       mNumBuffersReceived(0),
+      mBaseSeqNumber(0),
+      mExpectedPrior(0),
+      mReceivedPrior(0),
+      mClockRate(0),
+      mLastTransit(0),
+      mJitter(0.0),
+      mLastNACKedSeqNumber(0),
+      mReorderDelayUs(0),
+      mReorderTimeoutUs(kMinReorderTimeoutUs),
+      mNACKEnabled(false),
+      mPLIEnabled(false),
+      mPLIPending(false),
+      mLastPLIRequestUs(-1),
       mLastNTPTime(0),
       mLastNTPTimeUpdateUs(0),
       mIssueFIRRequests(false),
@@ -79,6 +128,26 @@ ARTPSource::ARTPSource(
     } else {
         TRESPASS();
     }
+
+    int32_t numChannels;
+    ASessionDescription::ParseFormatDesc(desc.c_str(), &mClockRate, &numChannels);
+
+    AString feedback;
+    if (sessionDesc->findAttribute(index, "a=rtcp-fb:*", &feedback)) {
+        ParseFeedback(feedback, &mNACKEnabled, &mPLIEnabled);
+    }
+    char key[32];
+    snprintf(key, sizeof(key), "a=rtcp-fb:%lu", PT);
+    if (sessionDesc->findAttribute(index, key, &feedback)) {
+        ParseFeedback(feedback, &mNACKEnabled, &mPLIEnabled);
+    }
+
+    // only the video assemblers recover at the next key frame
+    mPLIEnabled = mPLIEnabled && mIssueFIRRequests;
+
+    if (mNACKEnabled) {
+        mReorderTimeoutUs = kMinNACKReorderTimeoutUs;
+    }
 }
 
 static uint32_t AbsDiff(uint32_t seq1, uint32_t seq2) {
@@ -107,6 +176,9 @@ bool ARTPSource::queuePacket(const sp<ABuffer> &buffer) {
 
     if (mNumBuffersReceived++ == 0) {
         mHighestSeqNumber = seqNum;
+        mBaseSeqNumber = seqNum;
+        mLastNACKedSeqNumber = seqNum;
+        updateStatistics(seqNum, buffer);
         mQueue.push_back(buffer);
         return true;
     }
@@ -145,27 +217,102 @@ bool ARTPSource::queuePacket(const sp<ABuffer> &buffer) {
         seqNum = seq3;
     }
 
-    if (seqNum > mHighestSeqNumber) {
-        mHighestSeqNumber = seqNum;
-    }
-
     buffer->setInt32Data(seqNum);
 
-    List<sp<ABuffer> >::iterator it = mQueue.begin();
-    while (it != mQueue.end() && (uint32_t)(*it)->int32Data() < seqNum) {
-        ++it;
+    // Packets arrive mostly in order, look for the place of the packet from the end.
+    List<sp<ABuffer> >::iterator it = mQueue.end();
+    while (it != mQueue.begin()) {
+        --it;
+        if ((uint32_t)(*it)->int32Data() <= seqNum) {
+            if ((uint32_t)(*it)->int32Data() == seqNum) {
+                ALOGW("Discarding duplicate buffer");
+                return false;
+            }
+            ++it;
+            break;
+        }
     }
 
-    if (it != mQueue.end() && (uint32_t)(*it)->int32Data() == seqNum) {
-        ALOGW("Discarding duplicate buffer");
-        return false;
-    }
+    updateStatistics(seqNum, buffer);
 
     mQueue.insert(it, buffer);
 
     return true;
 }
 
+void ARTPSource::updateStatistics(uint32_t seqNum, const sp<ABuffer> &buffer) {
+    int64_t nowUs = ALooper::GetNowUs();
+
+    if (mNumBuffersReceived == 1) {
+        // the first packet
+    } else if (seqNum > mHighestSeqNumber) {
+        if (seqNum - mHighestSeqNumber - 1 > kMaxMissingPackets) {
+            ALOGW("sequence number jumped by %u", seqNum - mHighestSeqNumber);
+            mMissingPackets.clear();
+            mLastNACKedSeqNumber = seqNum;
+        } else {
+            for (uint32_t missing = mHighestSeqNumber + 1; missing < seqNum; ++missing) {
+                mMissingPackets.add(missing, nowUs);
+            }
+        }
+        mHighestSeqNumber = seqNum;
+    } else {
+        ssize_t index = mMissingPackets.indexOfKey(seqNum);
+        if (index >= 0) {
+            // Rise to the longest delay at once and fall back slowly, so that the
+            // assembler waits long enough for the next packet that comes late.
+            int64_t delayUs = nowUs - mMissingPackets.valueAt(index);
+            mMissingPackets.removeItemsAt(index);
+            if (delayUs > mReorderDelayUs) {
+                mReorderDelayUs = delayUs;
+            } else {
+                mReorderDelayUs = (mReorderDelayUs * 15 + delayUs) / 16;
+            }
+
+            int64_t minTimeoutUs =
+                    mNACKEnabled ? kMinNACKReorderTimeoutUs : kMinReorderTimeoutUs;
+            mReorderTimeoutUs = mReorderDelayUs * 2;
+            if (mReorderTimeoutUs < minTimeoutUs) {
+                mReorderTimeoutUs = minTimeoutUs;
+            } else if (mReorderTimeoutUs > kMaxReorderTimeoutUs) {
+                mReorderTimeoutUs = kMaxReorderTimeoutUs;
+            }
+            ALOGV("packet %u arrived %lld us late, waiting up to %lld us",
+                    seqNum, (long long)delayUs, (long long)mReorderTimeoutUs);
+        }
+    }
+
+    while (mMissingPackets.size() > kMaxMissingPackets || (mMissingPackets.size() > 0
+            && mMissingPackets.valueAt(0) + kMissingPacketLifetimeUs < nowUs)) {
+        mMissingPackets.removeItemsAt(0);
+    }
+
+    uint32_t rtpTime;
+    if (mClockRate > 0 && buffer->meta()->findInt32("rtp-time", (int32_t *)&rtpTime)) {
+        int64_t arrival = nowUs * mClockRate / 1000000ll;
+        int64_t transit = (int32_t)((uint32_t)arrival - rtpTime);
+        if (mNumBuffersReceived > 1) {
+            int64_t d = (int32_t)(transit - mLastTransit);
+            if (d < 0) {
+                d = -d;
+            }
+            mJitter += (d - mJitter) / 16.0;
+        }
+        mLastTransit = transit;
+    }
+}
+
+void ARTPSource::packetLost() {
+    if (!mPLIEnabled) {
+        return;
+    }
+
+    int64_t nowUs = ALooper::GetNowUs();
+    if (mLastPLIRequestUs < 0 || mLastPLIRequestUs + kMinPLIIntervalUs <= nowUs) {
+        mPLIPending = true;
+    }
+}
+
 void ARTPSource::byeReceived() {
     mAssembler->onByeReceived();
 }
@@ -242,21 +389,48 @@ void ARTPSource::addReceiverReport(const sp<ABuffer> &buffer) {
     data[10] = (mID >> 8) & 0xff;
     data[11] = mID & 0xff;
 
-    data[12] = 0x00;  // fraction lost
+    uint8_t fractionLost = 0;
+    int32_t cumulativeLost = 0;
+    if (mNumBuffersReceived > 0) {
+        uint32_t expected = mHighestSeqNumber - mBaseSeqNumber + 1;
+        int64_t lost = (int64_t)expected - mNumBuffersReceived;
+        if (lost > 0x7fffff) {
+            lost = 0x7fffff;
+        } else if (lost < -0x800000) {
+            lost = -0x800000;
+        }
+        cumulativeLost = lost;
+
+        uint32_t expectedInterval = expected - mExpectedPrior;
+        int32_t receivedInterval = mNumBuffersReceived - mReceivedPrior;
+        int64_t lostInterval = (int64_t)expectedInterval - receivedInterval;
+        if (expectedInterval > 0 && lostInterval > 0) {
+            fractionLost = (lostInterval << 8) / expectedInterval;
+        }
+        mExpectedPrior = expected;
+        mReceivedPrior = mNumBuffersReceived;
+    }
+
+    uint32_t jitter = (uint32_t)mJitter;
+
+    ALOGV("source 0x%08x: %d packets lost, fraction %u/256, jitter %u, reorder wait %lld us",
+            mID, cumulativeLost, fractionLost, jitter, (long long)mReorderTimeoutUs);
+
+    data[12] = fractionLost;
 
-    data[13] = 0x00;  // cumulative lost
-    data[14] = 0x00;
-    data[15] = 0x00;
+    data[13] = (cumulativeLost >> 16) & 0xff;
+    data[14] = (cumulativeLost >> 8) & 0xff;
+    data[15] = cumulativeLost & 0xff;
 
     data[16] = mHighestSeqNumber >> 24;
     data[17] = (mHighestSeqNumber >> 16) & 0xff;
     data[18] = (mHighestSeqNumber >> 8) & 0xff;
     data[19] = mHighestSeqNumber & 0xff;
 
-    data[20] = 0x00;  // Interarrival jitter
-    data[21] = 0x00;
-    data[22] = 0x00;
-    data[23] = 0x00;
+    data[20] = jitter >> 24;  // Interarrival jitter
+    data[21] = (jitter >> 16) & 0xff;
+    data[22] = (jitter >> 8) & 0xff;
+    data[23] = jitter & 0xff;
 
     uint32_t LSR = 0;
     uint32_t DLSR = 0;
@@ -280,6 +454,103 @@ void ARTPSource::addReceiverReport(const sp<ABuffer> &buffer) {
     buffer->setRange(buffer->offset(), buffer->size() + 32);
 }
 
-}  // namespace android
+bool ARTPSource::hasPendingFeedback() const {
+    if (mPLIPending) {
+        return true;
+    }
+    if (!mNACKEnabled) {
+        return false;
+    }
 
+    // the missing packets are sorted, the first one not NACKed yet is the oldest
+    for (size_t i = 0; i < mMissingPackets.size(); ++i) {
+        uint32_t seqNum = mMissingPackets.keyAt(i);
+        if (seqNum > mLastNACKedSeqNumber) {
+            return seqNum + kNACKReorderThreshold <= mHighestSeqNumber;
+        }
+    }
+    return false;
+}
+
+void ARTPSource::addFeedback(const sp<ABuffer> &buffer) {
+    if (mNACKEnabled) {
+        // Each entry holds a missing packet and a bitmask of the 16 following ones.
+        size_t i = 0;
+        while (i < mMissingPackets.size() && mMissingPackets.keyAt(i) <= mLastNACKedSeqNumber) {
+            ++i;
+        }
 
+        uint8_t *data = buffer->data() + buffer->size();
+        size_t numEntries = 0;
+        while (i < mMissingPackets.size() && numEntries < kMaxNACKEntries
+                && mMissingPackets.keyAt(i) + kNACKReorderThreshold <= mHighestSeqNumber
+                && buffer->size() + 16 + numEntries * 4 <= buffer->capacity()) {
+            uint32_t PID = mMissingPackets.keyAt(i++);
+            uint16_t BLP = 0;
+            while (i < mMissingPackets.size() && mMissingPackets.keyAt(i) <= PID + 16
+                    && mMissingPackets.keyAt(i) + kNACKReorderThreshold <= mHighestSeqNumber) {
+                BLP |= 1 << (mMissingPackets.keyAt(i++) - PID - 1);
+            }
+            mLastNACKedSeqNumber = mMissingPackets.keyAt(i - 1);
+
+            uint8_t *entry = data + 12 + numEntries * 4;
+            entry[0] = (PID >> 8) & 0xff;
+            entry[1] = PID & 0xff;
+            entry[2] = BLP >> 8;
+            entry[3] = BLP & 0xff;
+            ++numEntries;
+        }
+
+        if (numEntries > 0) {
+            data[0] = 0x80 | 1;
+            data[1] = 205;  // RTPFB, generic NACK
+            data[2] = 0;
+            data[3] = 2 + numEntries;
+            data[4] = kSourceID >> 24;
+            data[5] = (kSourceID >> 16) & 0xff;
+            data[6] = (kSourceID >> 8) & 0xff;
+            data[7] = kSourceID & 0xff;
+
+            data[8] = mID >> 24;
+            data[9] = (mID >> 16) & 0xff;
+            data[10] = (mID >> 8) & 0xff;
+            data[11] = mID & 0xff;
+
+            buffer->setRange(buffer->offset(), buffer->size() + 12 + numEntries * 4);
+
+            ALOGV("Added NACK for %zu entries.", numEntries);
+        }
+    }
+
+    if (mPLIPending) {
+        if (buffer->size() + 12 > buffer->capacity()) {
+            ALOGW("RTCP buffer too small to accomodate PLI.");
+            return;
+        }
+
+        mPLIPending = false;
+        mLastPLIRequestUs = ALooper::GetNowUs();
+
+        uint8_t *data = buffer->data() + buffer->size();
+
+        data[0] = 0x80 | 1;
+        data[1] = 206;  // PSFB, picture loss indication
+        data[2] = 0;
+        data[3] = 2;
+        data[4] = kSourceID >> 24;
+        data[5] = (kSourceID >> 16) & 0xff;
+        data[6] = (kSourceID >> 8) & 0xff;
+        data[7] = kSourceID & 0xff;
+
+        data[8] = mID >> 24;
+        data[9] = (mID >> 16) & 0xff;
+        data[10] = (mID >> 8) & 0xff;
+        data[11] = mID & 0xff;
+
+        buffer->setRange(buffer->offset(), buffer->size() + 12);
+
+        ALOGV("Added PLI request.");
+    }
+}
+
+}  // namespace android
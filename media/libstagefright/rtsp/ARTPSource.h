@@ -21,6 +21,7 @@
 #include <stdint.h>
 
 #include <media/stagefright/foundation/ABase.h>
+#include <utils/KeyedVector.h>
 #include <utils/List.h>
 #include <utils/RefBase.h>
 
@@ -43,14 +44,48 @@ struct ARTPSource : public RefBase {
 
     List<sp<ABuffer> > *queue() { return &mQueue; }
 
+    // How long the assembler waits for a missing packet before it gives up on it,
+    // adapted to how late the packets that arrive out of order have been.
+    int64_t getReorderTimeoutUs() const { return mReorderTimeoutUs; }
+
+    // Called by the assembler when it gave up on a missing packet.
+    void packetLost();
+
     void addReceiverReport(const sp<ABuffer> &buffer);
     void addFIR(const sp<ABuffer> &buffer);
 
+    // Generic NACKs for the packets found missing since the last call and a picture
+    // loss indication after a loss, as far as the session description allows them.
+    bool hasPendingFeedback() const;
+    void addFeedback(const sp<ABuffer> &buffer);
+
 private:
     uint32_t mID;
     uint32_t mHighestSeqNumber;
     int32_t mNumBuffersReceived;
 
+    // For the loss statistics of the receiver reports (RFC 3550 A.3).
+    uint32_t mBaseSeqNumber;
+    uint32_t mExpectedPrior;
+    int32_t mReceivedPrior;
+
+    // Interarrival jitter in RTP timestamp units (RFC 3550 A.8).
+    int32_t mClockRate;
+    int64_t mLastTransit;
+    double mJitter;
+
+    // The sequence numbers skipped by the packets received so far, with the time they
+    // were found missing.
+    KeyedVector<uint32_t, int64_t> mMissingPackets;
+    uint32_t mLastNACKedSeqNumber;
+    int64_t mReorderDelayUs;
+    int64_t mReorderTimeoutUs;
+
+    bool mNACKEnabled;
+    bool mPLIEnabled;
+    bool mPLIPending;
+    int64_t mLastPLIRequestUs;
+
     List<sp<ABuffer> > mQueue;
     sp<ARTPAssembler> mAssembler;
 
@@ -64,6 +99,7 @@ private:
     sp<AMessage> mNotify;
 
     bool queuePacket(const sp<ABuffer> &buffer);
+    void updateStatistics(uint32_t seqNum, const sp<ABuffer> &buffer);
 
     DISALLOW_EVIL_CONSTRUCTORS(ARTPSource);
 };
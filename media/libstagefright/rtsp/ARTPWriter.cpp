@@ -20,7 +20,9 @@
 
 #include "ARTPWriter.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 #include <media/stagefright/foundation/ABuffer.h>
 #include <media/stagefright/foundation/ADebug.h>
@@ -40,6 +42,16 @@ namespace android {
 // static const size_t kMaxPacketSize = 65507;  // maximum payload in UDP over IP
 static const size_t kMaxPacketSize = 1500;
 
+// RTP packets are sent with one sendmmsg() call per batch.
+static const size_t kNumPacketSlots = 8;
+
+// Frames are sent within this fraction of the frame interval, with bursts of at most
+// a batch of packets.
+static const double kPacingFraction = 0.5;
+static const size_t kPacingBurstBytes = kNumPacketSlots * kMaxPacketSize;
+static const int64_t kDefaultFrameIntervalUs = 33333ll;
+static const int64_t kMaxFrameIntervalUs = 200000ll;
+
 static int UniformRand(int limit) {
     return ((double)rand() * limit) / RAND_MAX;
 }
@@ -73,6 +85,11 @@ ARTPWriter::ARTPWriter(int fd)
     mRTCPAddr = mRTPAddr;
     mRTCPAddr.sin_port = htons(ntohs(mRTPAddr.sin_port) | 1);
 
+    for (size_t i = 0; i < kNumPacketSlots; ++i) {
+        mPackets.push(new ABuffer(kMaxPacketSize));
+    }
+    mNumQueuedPackets = 0;
+
 #if LOG_TO_FILES
     mRTPFd = open(
             "/data/misc/rtpout.bin",
@@ -130,6 +147,12 @@ status_t ARTPWriter::start(MetaData * /* params */) {
     mLastNTPTime = 0;
     mNumSRsSent = 0;
 
+    mLastFrameTimeUs = -1;
+    mFrameIntervalUs = kDefaultFrameIntervalUs;
+    mPacingBytesPerUs = 0.0;
+    mPacingTokens = kPacingBurstBytes;
+    mLastPacingUs = -1;
+
     const char *mime;
     CHECK(mSource->getFormat()->findCString(kKeyMIMEType, &mime));
 
@@ -327,6 +350,101 @@ void ARTPWriter::send(const sp<ABuffer> &buffer, bool isRTCP) {
 #endif
 }
 
+void ARTPWriter::startFrame(int64_t timeUs, size_t size) {
+    if (mLastFrameTimeUs >= 0 && timeUs > mLastFrameTimeUs
+            && timeUs - mLastFrameTimeUs <= kMaxFrameIntervalUs) {
+        mFrameIntervalUs = (mFrameIntervalUs * 7 + (timeUs - mLastFrameTimeUs)) / 8;
+    }
+    mLastFrameTimeUs = timeUs;
+
+    // A frame that fits in a burst goes out at once, this only slows down the large ones.
+    mPacingBytesPerUs = size / (mFrameIntervalUs * kPacingFraction);
+}
+
+sp<ABuffer> ARTPWriter::getPacketBuffer() {
+    CHECK_LT(mNumQueuedPackets, kNumPacketSlots);
+    return mPackets[mNumQueuedPackets];
+}
+
+void ARTPWriter::queuePacket() {
+    const sp<ABuffer> &buffer = mPackets[mNumQueuedPackets];
+
+    ++mSeqNo;
+    ++mNumRTPSent;
+    mNumRTPOctetsSent += buffer->size() - 12;
+
+    if (++mNumQueuedPackets == kNumPacketSlots) {
+        sendQueuedPackets();
+    }
+}
+
+void ARTPWriter::sendQueuedPackets() {
+    if (mNumQueuedPackets == 0) {
+        return;
+    }
+
+    size_t numBytes = 0;
+    struct iovec iovs[kNumPacketSlots];
+    struct mmsghdr msgs[kNumPacketSlots];
+    memset(msgs, 0, sizeof(msgs));
+    for (size_t i = 0; i < mNumQueuedPackets; ++i) {
+        const sp<ABuffer> &buffer = mPackets[i];
+        iovs[i].iov_base = buffer->data();
+        iovs[i].iov_len = buffer->size();
+        msgs[i].msg_hdr.msg_name = &mRTPAddr;
+        msgs[i].msg_hdr.msg_namelen = sizeof(mRTPAddr);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        numBytes += buffer->size();
+    }
+
+    // Wait until the bucket holds enough tokens for the whole batch.
+    int64_t nowUs = ALooper::GetNowUs();
+    if (mLastPacingUs >= 0) {
+        mPacingTokens += (nowUs - mLastPacingUs) * mPacingBytesPerUs;
+        if (mPacingTokens > kPacingBurstBytes) {
+            mPacingTokens = kPacingBurstBytes;
+        }
+    }
+    if (mPacingTokens < numBytes && mPacingBytesPerUs > 0) {
+        int64_t delayUs = (numBytes - mPacingTokens) / mPacingBytesPerUs;
+        ALOGV("pacing %zu packets by %lld us", mNumQueuedPackets, (long long)delayUs);
+        usleep(delayUs);
+        nowUs += delayUs;
+        mPacingTokens = numBytes;
+    }
+    mPacingTokens -= numBytes;
+    mLastPacingUs = nowUs;
+
+    size_t numSent = 0;
+    while (numSent < mNumQueuedPackets) {
+        int n = sendmmsg(mSocket, &msgs[numSent], mNumQueuedPackets - numSent, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        CHECK_GT(n, 0);
+
+        for (int i = 0; i < n; ++i) {
+            CHECK_EQ(msgs[numSent + i].msg_len, iovs[numSent + i].iov_len);
+        }
+        numSent += n;
+    }
+
+#if LOG_TO_FILES
+    for (size_t i = 0; i < mNumQueuedPackets; ++i) {
+        const sp<ABuffer> &buffer = mPackets[i];
+
+        uint32_t ms = tolel(ALooper::GetNowUs() / 1000ll);
+        uint32_t length = tolel(buffer->size());
+        write(mRTPFd, &ms, sizeof(ms));
+        write(mRTPFd, &length, sizeof(length));
+        write(mRTPFd, buffer->data(), buffer->size());
+    }
+#endif
+
+    mNumQueuedPackets = 0;
+}
+
 void ARTPWriter::addSR(const sp<ABuffer> &buffer) {
     uint8_t *data = buffer->data() + buffer->size();
 
@@ -579,8 +697,10 @@ void ARTPWriter::sendAVCData(MediaBuffer *mediaBuf) {
     const uint8_t *mediaData =
         (const uint8_t *)mediaBuf->data() + mediaBuf->range_offset();
 
-    sp<ABuffer> buffer = new ABuffer(kMaxPacketSize);
-    if (mediaBuf->range_length() + 12 <= buffer->capacity()) {
+    startFrame(timeUs, mediaBuf->range_length());
+
+    if (mediaBuf->range_length() + 12 <= kMaxPacketSize) {
+        sp<ABuffer> buffer = getPacketBuffer();
         // The data fits into a single packet
         uint8_t *data = buffer->data();
         data[0] = 0x80;
@@ -601,11 +721,7 @@ void ARTPWriter::sendAVCData(MediaBuffer *mediaBuf) {
 
         buffer->setRange(0, mediaBuf->range_length() + 12);
 
-        send(buffer, false /* isRTCP */);
-
-        ++mSeqNo;
-        ++mNumRTPSent;
-        mNumRTPOctetsSent += buffer->size() - 12;
+        queuePacket();
     } else {
         // FU-A
 
@@ -614,6 +730,8 @@ void ARTPWriter::sendAVCData(MediaBuffer *mediaBuf) {
 
         bool firstPacket = true;
         while (offset < mediaBuf->range_length()) {
+            sp<ABuffer> buffer = getPacketBuffer();
+
             size_t size = mediaBuf->range_length() - offset;
             bool lastPacket = true;
             if (size + 12 + 2 > buffer->capacity()) {
@@ -648,17 +766,15 @@ void ARTPWriter::sendAVCData(MediaBuffer *mediaBuf) {
 
             buffer->setRange(0, 14 + size);
 
-            send(buffer, false /* isRTCP */);
-
-            ++mSeqNo;
-            ++mNumRTPSent;
-            mNumRTPOctetsSent += buffer->size() - 12;
+            queuePacket();
 
             firstPacket = false;
             offset += size;
         }
     }
 
+    sendQueuedPackets();
+
     mLastRTPTime = rtpTime;
     mLastNTPTime = GetNowNTP();
 }
@@ -682,8 +798,10 @@ void ARTPWriter::sendH263Data(MediaBuffer *mediaBuf) {
     size_t offset = 2;
     size_t size = mediaBuf->range_length();
 
+    startFrame(timeUs, size);
+
     while (offset < size) {
-        sp<ABuffer> buffer = new ABuffer(kMaxPacketSize);
+        sp<ABuffer> buffer = getPacketBuffer();
         // CHECK_LE(mediaBuf->range_length() -2 + 14, buffer->capacity());
 
         size_t remaining = size - offset;
@@ -714,13 +832,11 @@ void ARTPWriter::sendH263Data(MediaBuffer *mediaBuf) {
 
         buffer->setRange(0, remaining + 14);
 
-        send(buffer, false /* isRTCP */);
-
-        ++mSeqNo;
-        ++mNumRTPSent;
-        mNumRTPOctetsSent += buffer->size() - 12;
+        queuePacket();
     }
 
+    sendQueuedPackets();
+
     mLastRTPTime = rtpTime;
     mLastNTPTime = GetNowNTP();
 }
@@ -770,7 +886,9 @@ void ARTPWriter::sendAMRData(MediaBuffer *mediaBuf) {
     }
     CHECK_EQ(srcOffset, mediaLength);
 
-    sp<ABuffer> buffer = new ABuffer(kMaxPacketSize);
+    startFrame(timeUs, mediaLength);
+
+    sp<ABuffer> buffer = getPacketBuffer();
     CHECK_LE(mediaLength + 12 + 1, buffer->capacity());
 
     // The data fits into a single packet
@@ -822,11 +940,8 @@ void ARTPWriter::sendAMRData(MediaBuffer *mediaBuf) {
 
     buffer->setRange(0, dstOffset);
 
-    send(buffer, false /* isRTCP */);
-
-    ++mSeqNo;
-    ++mNumRTPSent;
-    mNumRTPOctetsSent += buffer->size() - 12;
+    queuePacket();
+    sendQueuedPackets();
 
     mLastRTPTime = rtpTime;
     mLastNTPTime = GetNowNTP();
@@ -23,6 +23,7 @@
 #include <media/stagefright/foundation/AString.h>
 #include <media/stagefright/foundation/base64.h>
 #include <media/stagefright/MediaWriter.h>
+#include <utils/Vector.h>
 
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -94,6 +95,16 @@ private:
 
     int32_t mNumSRsSent;
 
+    // The RTP packets of a frame are written into these buffers and sent in batches,
+    // paced by a token bucket that spreads large frames over the frame interval.
+    Vector<sp<ABuffer> > mPackets;
+    size_t mNumQueuedPackets;
+    int64_t mLastFrameTimeUs;
+    int64_t mFrameIntervalUs;
+    double mPacingBytesPerUs;
+    double mPacingTokens;
+    int64_t mLastPacingUs;
+
     enum {
         INVALID,
         H264,
@@ -120,6 +131,11 @@ private:
 
     void send(const sp<ABuffer> &buffer, bool isRTCP);
 
+    void startFrame(int64_t timeUs, size_t size);
+    sp<ABuffer> getPacketBuffer();
+    void queuePacket();
+    void sendQueuedPackets();
+
     DISALLOW_EVIL_CONSTRUCTORS(ARTPWriter);
 };
 
@@ -113,6 +113,13 @@ bool ASessionDescription::parse(const void *data, size_t size) {
                         key.setTo(line, 0, spacePos);
 
                         colonPos = spacePos;
+                    } else if (key == "a=rtcp-fb") {
+                        // keyed by payload type, like fmtp
+                        ssize_t spacePos = line.find(" ", colonPos + 1);
+                        if (spacePos >= 0) {
+                            key.setTo(line, 0, spacePos);
+                            colonPos = spacePos;
+                        }
                     }
 
                     value.setTo(line, colonPos + 1, line.size() - colonPos - 1);
@@ -121,6 +128,19 @@ bool ASessionDescription::parse(const void *data, size_t size) {
                 key.trim();
                 value.trim();
 
+                if (key.startsWith("a=rtcp-fb:")) {
+                    // A payload type may list several feedback types, one per line,
+                    // keep all of them separated by ';'.
+                    const Attribs &track = mTracks.itemAt(mTracks.size() - 1);
+                    ssize_t index = track.indexOfKey(key);
+                    if (index >= 0) {
+                        AString values = track.valueAt(index);
+                        values.append(";");
+                        values.append(value);
+                        value = values;
+                    }
+                }
+
                 ALOGV("adding '%s' => '%s'", key.c_str(), value.c_str());
 
                 mTracks.editItemAt(mTracks.size() - 1).add(key, value);
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "FrameIndexSeeker_test"
+#include <utils/Log.h>
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <utils/Vector.h>
+#include <media/stagefright/DataSource.h>
+
+#include "include/FrameIndexSeeker.h"
+
+namespace android {
+
+// MPEG-1 layer III, 44.1 kHz, joint stereo, no CRC, without the bitrate (bits 12 to 15)
+static const uint32_t kHeader = 0xfffb0044;
+static const int kSampleRate = 44100;
+static const int kSamplesPerFrame = 1152;
+static const int kBitrates[] = { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 };
+
+struct MemorySource : public DataSource {
+    MemorySource(const Vector<uint8_t> &data) : mData(data) {}
+
+    virtual status_t initCheck() const { return OK; }
+
+    virtual ssize_t readAt(off64_t offset, void *data, size_t size) {
+        if (offset >= (off64_t)mData.size()) {
+            return 0;
+        }
+        if (size > mData.size() - offset) {
+            size = mData.size() - offset;
+        }
+        memcpy(data, mData.array() + offset, size);
+        return size;
+    }
+
+private:
+    Vector<uint8_t> mData;
+};
+
+class FrameIndexSeekerTest : public ::testing::Test {
+protected:
+    // Writes |numFrames| frames of random bitrates after |prefix| bytes of junk, recording
+    // their offsets.
+    void writeStream(size_t prefix, size_t numFrames, const char *trailer) {
+        srand(numFrames);
+        mData.clear();
+        mFrameOffsets.clear();
+        for (size_t i = 0; i < prefix; ++i) {
+            mData.push(0);
+        }
+        for (size_t i = 0; i < numFrames; ++i) {
+            const uint32_t bitrateIndex = 1 + rand() % 14;
+            const uint32_t padding = rand() % 2;
+            const uint32_t header = kHeader | bitrateIndex << 12 | padding << 9;
+            const size_t frameSize =
+                    144000 * kBitrates[bitrateIndex] / kSampleRate + padding;
+
+            if (i == 0) {
+                mFirstHeader = header;
+            }
+            mFrameOffsets.push(mData.size());
+            for (size_t k = 0; k < frameSize; ++k) {
+                mData.push(k < 4 ? (uint8_t)(header >> (24 - 8 * k)) : (uint8_t)rand());
+            }
+        }
+        for (size_t i = 0; trailer != NULL && trailer[i] != '\0'; ++i) {
+            mData.push(trailer[i]);
+        }
+    }
+
+    sp<FrameIndexSeeker> createSeeker(size_t prefix) {
+        return FrameIndexSeeker::CreateFromSource(new MemorySource(mData), prefix, mFirstHeader);
+    }
+
+    static int64_t frameTimeUs(size_t frame) {
+        return (int64_t)frame * kSamplesPerFrame * 1000000ll / kSampleRate;
+    }
+
+    Vector<uint8_t> mData;
+    Vector<off64_t> mFrameOffsets;
+    uint32_t mFirstHeader;
+};
+
+TEST_F(FrameIndexSeekerTest, SeeksToTheFrameContainingTheTime) {
+    const size_t kNumFrames = 5000;
+    writeStream(10, kNumFrames, "TAG");
+    sp<FrameIndexSeeker> seeker = createSeeker(10);
+    ASSERT_TRUE(seeker != NULL);
+
+    int64_t durationUs;
+    EXPECT_FALSE(seeker->getDuration(&durationUs));
+
+    // seek backwards and forwards, in and out of the indexed range
+    const size_t frames[] = { 4000, 0, 1, 63, 64, 65, 2500, 4999, 3 };
+    for (size_t i = 0; i < sizeof(frames) / sizeof(frames[0]); ++i) {
+        const size_t frame = frames[i];
+        int64_t timeUs = frameTimeUs(frame) + 10000;
+        off64_t pos;
+        ASSERT_TRUE(seeker->getOffsetForTime(&timeUs, &pos));
+        EXPECT_EQ(mFrameOffsets[frame], pos) << "frame " << frame;
+        EXPECT_EQ(frameTimeUs(frame), timeUs) << "frame " << frame;
+    }
+}
+
+TEST_F(FrameIndexSeekerTest, SeeksPastTheEndToTheLastFrame) {
+    const size_t kNumFrames = 200;
+    writeStream(0, kNumFrames, "TAG");
+    sp<FrameIndexSeeker> seeker = createSeeker(0);
+
+    int64_t timeUs = frameTimeUs(kNumFrames) * 2;
+    off64_t pos;
+    ASSERT_TRUE(seeker->getOffsetForTime(&timeUs, &pos));
+    EXPECT_EQ(mFrameOffsets[kNumFrames - 1], pos);
+    EXPECT_EQ(frameTimeUs(kNumFrames - 1), timeUs);
+}
+
+TEST_F(FrameIndexSeekerTest, FallsBackPastLostSync) {
+    const size_t kNumFrames = 200;
+    writeStream(0, kNumFrames, "garbage");
+    sp<FrameIndexSeeker> seeker = createSeeker(0);
+
+    // frames before the corruption are still found
+    int64_t timeUs = frameTimeUs(100);
+    off64_t pos;
+    ASSERT_TRUE(seeker->getOffsetForTime(&timeUs, &pos));
+    EXPECT_EQ(mFrameOffsets[100], pos);
+
+    timeUs = frameTimeUs(kNumFrames) * 2;
+    EXPECT_FALSE(seeker->getOffsetForTime(&timeUs, &pos));
+}
+
+} // namespace android
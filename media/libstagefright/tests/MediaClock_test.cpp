@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "MediaClock_test"
+#include <utils/Log.h>
+
+#include <gtest/gtest.h>
+
+#include <pthread.h>
+
+#include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/MediaClock.h>
+
+namespace android {
+
+static const int64_t kToleranceUs = 20000ll;
+
+class MediaClockTest : public ::testing::Test {
+public:
+    MediaClockTest()
+        : mClock(new MediaClock) {
+    }
+
+protected:
+    sp<MediaClock> mClock;
+};
+
+TEST_F(MediaClockTest, NoAnchor) {
+    int64_t mediaUs;
+    EXPECT_EQ(NO_INIT, mClock->getMediaTime(ALooper::GetNowUs(), &mediaUs));
+    int64_t realUs;
+    EXPECT_EQ(NO_INIT, mClock->getRealTimeFor(0, &realUs));
+    EXPECT_EQ(BAD_VALUE, mClock->getMediaTime(ALooper::GetNowUs(), NULL));
+}
+
+TEST_F(MediaClockTest, FollowsTheAnchor) {
+    int64_t nowUs = ALooper::GetNowUs();
+    mClock->updateAnchor(1000000ll, nowUs);
+
+    int64_t mediaUs;
+    ASSERT_EQ(OK, mClock->getMediaTime(nowUs + 500000ll, &mediaUs));
+    EXPECT_NEAR(1500000ll, mediaUs, kToleranceUs);
+
+    int64_t realUs;
+    ASSERT_EQ(OK, mClock->getRealTimeFor(2000000ll, &realUs));
+    EXPECT_NEAR(nowUs + 1000000ll, realUs, kToleranceUs);
+
+    mClock->clearAnchor();
+    EXPECT_EQ(NO_INIT, mClock->getMediaTime(nowUs, &mediaUs));
+}
+
+TEST_F(MediaClockTest, ClampsToMaxAndStartingTime) {
+    int64_t nowUs = ALooper::GetNowUs();
+    mClock->setStartingTimeMedia(2000000ll);
+    mClock->updateAnchor(1000000ll, nowUs, 3000000ll /* maxTimeMediaUs */);
+
+    int64_t mediaUs;
+    ASSERT_EQ(OK, mClock->getMediaTime(nowUs, &mediaUs));
+    EXPECT_EQ(2000000ll, mediaUs);
+    ASSERT_EQ(OK, mClock->getMediaTime(nowUs + 5000000ll, &mediaUs));
+    EXPECT_EQ(3000000ll, mediaUs);
+    ASSERT_EQ(OK, mClock->getMediaTime(
+            nowUs + 5000000ll, &mediaUs, true /* allowPastMaxTime */));
+    EXPECT_NEAR(6000000ll, mediaUs, kToleranceUs);
+}
+
+TEST_F(MediaClockTest, RateChangeKeepsTheMediaTime) {
+    int64_t nowUs = ALooper::GetNowUs();
+    mClock->updateAnchor(1000000ll, nowUs);
+    mClock->setPlaybackRate(2.0);
+    EXPECT_EQ(2.0, mClock->getPlaybackRate());
+
+    nowUs = ALooper::GetNowUs();
+    int64_t mediaUs;
+    ASSERT_EQ(OK, mClock->getMediaTime(nowUs, &mediaUs));
+    EXPECT_NEAR(1000000ll, mediaUs, kToleranceUs);
+    ASSERT_EQ(OK, mClock->getMediaTime(nowUs + 500000ll, &mediaUs));
+    EXPECT_NEAR(2000000ll, mediaUs, kToleranceUs);
+
+    mClock->setPlaybackRate(0.0);
+    int64_t realUs;
+    EXPECT_EQ(NO_INIT, mClock->getRealTimeFor(mediaUs, &realUs));
+}
+
+struct ReaderArgs {
+    sp<MediaClock> mClock;
+    int64_t mRealUs;
+    volatile bool mDone;
+    int32_t mNumTorn;
+};
+
+static void *readerLoop(void *cookie) {
+    ReaderArgs *args = (ReaderArgs *)cookie;
+    while (!args->mDone) {
+        int64_t mediaUs;
+        if (args->mClock->getMediaTime(args->mRealUs, &mediaUs) == OK
+                && mediaUs != 1000000ll && mediaUs != 5000000ll) {
+            ++args->mNumTorn;
+        }
+    }
+    return NULL;
+}
+
+TEST_F(MediaClockTest, ReadersSeeConsistentAnchors) {
+    // The writer alternates between two anchors, both map mRealUs to a round media time.
+    ReaderArgs args;
+    args.mClock = mClock;
+    args.mRealUs = ALooper::GetNowUs() - 10000000ll;
+    args.mDone = false;
+    args.mNumTorn = 0;
+
+    pthread_t reader;
+    ASSERT_EQ(0, pthread_create(&reader, NULL, readerLoop, &args));
+    for (int32_t i = 0; i < 1000000; ++i) {
+        mClock->clearAnchor();
+        // the anchor is moved to the current time, keeping the same media time line
+        if (i & 1) {
+            mClock->updateAnchor(1000000ll, args.mRealUs);
+        } else {
+            mClock->updateAnchor(5000000ll, args.mRealUs);
+        }
+    }
+    args.mDone = true;
+    pthread_join(reader, NULL);
+    EXPECT_EQ(0, args.mNumTorn);
+}
+
+} // namespace android
@@ -159,4 +159,48 @@ TEST_F(MediaCodecListOverridesTest, exportTestResultsToXML) {
     remove(fileName);
 }
 
+TEST_F(MediaCodecListOverridesTest, exportMeasuredFrameRatesToXML) {
+    const char *fileName = "/sdcard/mediacodec_list_overrides_test.xml";
+    remove(fileName);
+
+    CodecSettings gR;
+    KeyedVector<AString, CodecSettings> eR;
+    KeyedVector<AString, CodecSettings> dR;
+    CodecSettings settings;
+    settings.add("max-supported-instances", "3");
+    settings.add("measured-frame-rate-1280x720", "118-122");
+    dR.add("OMX.qcom.video.decoder.avc video/avc", settings);
+    exportResultsToXML(fileName, gR, eR, dR);
+
+    AString overrides;
+    FILE *f = fopen(fileName, "rb");
+    ASSERT_TRUE(f != NULL);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    rewind(f);
+
+    char *buf = (char *)malloc(size);
+    EXPECT_EQ((size_t)1, fread(buf, size, 1, f));
+    overrides.setTo(buf, size);
+    fclose(f);
+    free(buf);
+
+    AString expected;
+    expected.append(getProfilingVersionString());
+    expected.append("\n");
+    expected.append(
+            "<MediaCodecs>\n"
+            "    <Decoders>\n"
+            "        <MediaCodec name=\"OMX.qcom.video.decoder.avc\" type=\"video/avc\""
+            " update=\"true\" >\n"
+            "            <Limit name=\"max-supported-instances\" value=\"3\" />\n"
+            "            <Limit name=\"measured-frame-rate-1280x720\" range=\"118-122\" />\n"
+            "        </MediaCodec>\n"
+            "    </Decoders>\n"
+            "</MediaCodecs>\n");
+    EXPECT_TRUE(overrides == expected);
+
+    remove(fileName);
+}
+
 } // namespace android
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "MediaSourceSplitter_test"
+#include <utils/Log.h>
+
+#include <gtest/gtest.h>
+
+#include <media/stagefright/MediaBuffer.h>
+#include <media/stagefright/MediaDefs.h>
+#include <media/stagefright/MediaErrors.h>
+#include <media/stagefright/MediaSourceSplitter.h>
+#include <media/stagefright/MetaData.h>
+
+namespace android {
+
+static const int32_t kNumFrames = 100;
+static const int32_t kSyncFrameInterval = 10;
+
+// Emits a codec config buffer followed by kNumFrames frames, whose first byte is their index.
+struct FakeEncoderSource : public MediaSource {
+    FakeEncoderSource()
+        : mFormat(new MetaData),
+          mNumStarts(0),
+          mStarted(false),
+          mNextFrame(-1) {
+        mFormat->setCString(kKeyMIMEType, MEDIA_MIMETYPE_VIDEO_AVC);
+    }
+
+    virtual status_t start(MetaData * /* params */) {
+        ++mNumStarts;
+        mStarted = true;
+        mNextFrame = -1;
+        return OK;
+    }
+
+    virtual status_t stop() {
+        mStarted = false;
+        return OK;
+    }
+
+    virtual sp<MetaData> getFormat() {
+        return mFormat;
+    }
+
+    virtual status_t read(MediaBuffer **buffer, const ReadOptions * /* options */) {
+        if (!mStarted) {
+            return NO_INIT;
+        }
+        if (mNextFrame == kNumFrames) {
+            return ERROR_END_OF_STREAM;
+        }
+
+        *buffer = new MediaBuffer(16);
+        if (mNextFrame < 0) {
+            (*buffer)->meta_data()->setInt32(kKeyIsCodecConfig, true);
+        } else if (mNextFrame % kSyncFrameInterval == 0) {
+            (*buffer)->meta_data()->setInt32(kKeyIsSyncFrame, true);
+        }
+        *(uint8_t *)(*buffer)->data() = mNextFrame++;
+        return OK;
+    }
+
+    sp<MetaData> mFormat;
+    int32_t mNumStarts;
+    bool mStarted;
+    int32_t mNextFrame;
+};
+
+class MediaSourceSplitterTest : public ::testing::Test {
+public:
+    MediaSourceSplitterTest()
+        : mSource(new FakeEncoderSource),
+          mSplitter(new MediaSourceSplitter(mSource)) {
+    }
+
+protected:
+    sp<FakeEncoderSource> mSource;
+    sp<MediaSourceSplitter> mSplitter;
+
+    // Returns the index of the frame read, -1 for codec config, or the error.
+    static int32_t readFrame(const sp<MediaSource> &client, bool *isSync = NULL) {
+        MediaBuffer *buffer;
+        status_t err = client->read(&buffer);
+        if (err != OK) {
+            return err;
+        }
+        int32_t sync = false;
+        buffer->meta_data()->findInt32(kKeyIsSyncFrame, &sync);
+        if (isSync != NULL) {
+            *isSync = sync;
+        }
+        int32_t frame = (int8_t)*(const uint8_t *)buffer->data();
+        buffer->release();
+        return frame;
+    }
+};
+
+TEST_F(MediaSourceSplitterTest, EachClientReadsEveryFrame) {
+    sp<MediaSource> first = mSplitter->createClient();
+    sp<MediaSource> second = mSplitter->createClient();
+    ASSERT_EQ(OK, first->start());
+    ASSERT_EQ(OK, second->start());
+    EXPECT_EQ(1, mSource->mNumStarts);
+
+    for (int32_t i = -1; i < kNumFrames; ++i) {
+        EXPECT_EQ(i, readFrame(first));
+        EXPECT_EQ(i, readFrame(second));
+    }
+    EXPECT_EQ(ERROR_END_OF_STREAM, readFrame(first));
+    EXPECT_EQ(ERROR_END_OF_STREAM, readFrame(second));
+
+    EXPECT_EQ(OK, first->stop());
+    EXPECT_TRUE(mSource->mStarted);
+    EXPECT_EQ(OK, second->stop());
+    EXPECT_FALSE(mSource->mStarted);
+}
+
+TEST_F(MediaSourceSplitterTest, ClonesShareTheData) {
+    sp<MediaSource> first = mSplitter->createClient();
+    sp<MediaSource> second = mSplitter->createClient();
+    ASSERT_EQ(OK, first->start());
+    ASSERT_EQ(OK, second->start());
+
+    MediaBuffer *firstBuffer;
+    MediaBuffer *secondBuffer;
+    ASSERT_EQ(OK, first->read(&firstBuffer));
+    ASSERT_EQ(OK, second->read(&secondBuffer));
+    EXPECT_EQ(firstBuffer->data(), secondBuffer->data());
+    firstBuffer->release();
+
+    // the data outlives the release of the other clone
+    EXPECT_EQ(0xff, *(const uint8_t *)secondBuffer->data());
+    secondBuffer->release();
+
+    first->stop();
+    second->stop();
+}
+
+TEST_F(MediaSourceSplitterTest, SlowClientSkipsToTheNextSyncFrame) {
+    const size_t maxQueuedBuffers = 5;
+    sp<MediaSource> fast = mSplitter->createClient();
+    sp<MediaSource> slow = mSplitter->createClient(maxQueuedBuffers);
+    ASSERT_EQ(OK, fast->start());
+    ASSERT_EQ(OK, slow->start());
+
+    // the fast client is not held up by the slow one
+    for (int32_t i = -1; i < 2 * kSyncFrameInterval + 3; ++i) {
+        EXPECT_EQ(i, readFrame(fast));
+    }
+
+    // the codec config is kept, the frames up to the last sync frame are dropped
+    bool isSync;
+    EXPECT_EQ(-1, readFrame(slow));
+    EXPECT_EQ(2 * kSyncFrameInterval, readFrame(slow, &isSync));
+    EXPECT_TRUE(isSync);
+    EXPECT_EQ(2 * kSyncFrameInterval + 1, readFrame(slow));
+
+    fast->stop();
+    slow->stop();
+}
+
+TEST_F(MediaSourceSplitterTest, LateClientStartsWithCodecConfigAndSyncFrame) {
+    sp<MediaSource> first = mSplitter->createClient();
+    ASSERT_EQ(OK, first->start());
+    for (int32_t i = -1; i < 3; ++i) {
+        EXPECT_EQ(i, readFrame(first));
+    }
+
+    sp<MediaSource> late = mSplitter->createClient();
+    ASSERT_EQ(OK, late->start());
+    EXPECT_EQ(1, mSource->mNumStarts);
+
+    bool isSync;
+    EXPECT_EQ(-1, readFrame(late));
+    EXPECT_EQ(kSyncFrameInterval, readFrame(late, &isSync));
+    EXPECT_TRUE(isSync);
+    for (int32_t i = 3; i <= kSyncFrameInterval; ++i) {
+        EXPECT_EQ(i, readFrame(first));
+    }
+
+    first->stop();
+    late->stop();
+}
+
+TEST_F(MediaSourceSplitterTest, RestartsTheSource) {
+    sp<MediaSource> client = mSplitter->createClient();
+    ASSERT_EQ(OK, client->start());
+    EXPECT_EQ(-1, readFrame(client));
+    EXPECT_EQ(0, readFrame(client));
+    EXPECT_EQ(OK, client->stop());
+    EXPECT_EQ(NO_INIT, readFrame(client));
+
+    ASSERT_EQ(OK, client->start());
+    EXPECT_EQ(2, mSource->mNumStarts);
+    EXPECT_EQ(-1, readFrame(client));
+    EXPECT_EQ(0, readFrame(client));
+    EXPECT_EQ(OK, client->stop());
+}
+
+} // namespace android
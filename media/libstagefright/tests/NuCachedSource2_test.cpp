@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "NuCachedSource2_test"
+#include <utils/Log.h>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <media/stagefright/DataSource.h>
+#include <media/stagefright/MediaErrors.h>
+#include <utils/Mutex.h>
+#include <utils/Vector.h>
+
+#include "include/NuCachedSource2.h"
+
+namespace android {
+
+static const off64_t kSourceSize = 8 * 1024 * 1024;
+
+// 1 MB low water, 4 MB high water, no keep-alives
+static const char *kCacheConfig = "1024/4096/0";
+
+static uint8_t byteAt(off64_t offset) {
+    return (uint8_t)((offset * 7) ^ (offset >> 13));
+}
+
+// Serves byteAt() and records the offsets read.
+struct FakeDataSource : public DataSource {
+    FakeDataSource() {}
+
+    virtual status_t initCheck() const {
+        return OK;
+    }
+
+    virtual ssize_t readAt(off64_t offset, void *data, size_t size) {
+        {
+            Mutex::Autolock autoLock(mLock);
+            mReadOffsets.push_back(offset);
+        }
+
+        if (offset >= kSourceSize) {
+            return 0;
+        }
+        if ((off64_t)size > kSourceSize - offset) {
+            size = kSourceSize - offset;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            ((uint8_t *)data)[i] = byteAt(offset + i);
+        }
+        return size;
+    }
+
+    virtual status_t getSize(off64_t *size) {
+        *size = kSourceSize;
+        return OK;
+    }
+
+    size_t numReads() {
+        Mutex::Autolock autoLock(mLock);
+        return mReadOffsets.size();
+    }
+
+    // Returns how many of the reads after the first |from| were below |offset|.
+    size_t numReadsBelow(off64_t offset, size_t from) {
+        Mutex::Autolock autoLock(mLock);
+        size_t count = 0;
+        for (size_t i = from; i < mReadOffsets.size(); ++i) {
+            if (mReadOffsets[i] < offset) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+private:
+    Mutex mLock;
+    Vector<off64_t> mReadOffsets;
+
+    DISALLOW_EVIL_CONSTRUCTORS(FakeDataSource);
+};
+
+class NuCachedSource2Test : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        mSource = new FakeDataSource;
+        mCachedSource = NuCachedSource2::Create(mSource, kCacheConfig);
+    }
+
+    void expectRead(off64_t offset, size_t size) {
+        Vector<uint8_t> data;
+        data.resize(size);
+        ASSERT_EQ((ssize_t)size, mCachedSource->readAt(offset, data.editArray(), size));
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(byteAt(offset + i), data[i]) << "at offset " << offset + i;
+        }
+    }
+
+    void waitForCachedSize(size_t size) {
+        for (int i = 0; i < 500 && mCachedSource->cachedSize() < size; ++i) {
+            usleep(10000);
+        }
+        ASSERT_GE(mCachedSource->cachedSize(), size);
+    }
+
+    sp<FakeDataSource> mSource;
+    sp<NuCachedSource2> mCachedSource;
+};
+
+TEST_F(NuCachedSource2Test, ReadsBackAfterSeekWithoutFetching) {
+    expectRead(0, 1000);
+    waitForCachedSize(4 * 1024 * 1024);
+
+    // Seeking away keeps the start of the cache, up to half the high water mark.
+    expectRead(6 * 1024 * 1024, 10000);
+    size_t numReads = mSource->numReads();
+
+    expectRead(64 * 1024, 100000);
+    expectRead(1024 * 1024, 200000);
+    EXPECT_EQ(0u, mSource->numReadsBelow(2 * 1024 * 1024, numReads));
+}
+
+TEST_F(NuCachedSource2Test, FetchesOnlyWhatIsMissing) {
+    expectRead(0, 1000);
+    waitForCachedSize(4 * 1024 * 1024);
+
+    expectRead(6 * 1024 * 1024, 10000);
+    size_t numReads = mSource->numReads();
+
+    // Reading past the kept range continues it from its end.
+    expectRead(2 * 1024 * 1024 - 1000, 5000);
+    EXPECT_EQ(0u, mSource->numReadsBelow(2 * 1024 * 1024, numReads));
+
+    // The range fetched after the first seek was kept as well.
+    numReads = mSource->numReads();
+    expectRead(6 * 1024 * 1024, 10000);
+    EXPECT_EQ(numReads, mSource->numReads());
+}
+
+} // namespace android
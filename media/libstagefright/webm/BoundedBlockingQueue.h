@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BOUNDEDBLOCKINGQUEUE_H_
+#define BOUNDEDBLOCKINGQUEUE_H_
+
+#include <media/stagefright/foundation/ABase.h>
+#include <media/stagefright/foundation/ADebug.h>
+#include <utils/Mutex.h>
+#include <utils/Condition.h>
+
+#include <atomic>
+
+namespace android {
+
+// A fixed capacity queue between a single producer thread and a single consumer thread.
+//
+// The elements live in a ring allocated up front, and the producer and the consumer only
+// share the ring indices, so neither side takes a lock unless the queue is full or empty
+// and it has to block.
+template<typename T>
+class BoundedBlockingQueue {
+public:
+    enum {
+        kDefaultCapacity = 1024,
+    };
+
+    // |capacity| must be a power of 2.
+    BoundedBlockingQueue(size_t capacity = kDefaultCapacity)
+        : mCapacity(capacity),
+          mRing(new T[capacity]),
+          mHead(0),
+          mTail(0),
+          mConsumerWaiting(false),
+          mProducerWaiting(false) {
+        CHECK(capacity > 0 && (capacity & (capacity - 1)) == 0);
+    }
+
+    ~BoundedBlockingQueue() {
+        delete[] mRing;
+    }
+
+    bool empty() {
+        return mHead.load() == mTail.load();
+    }
+
+    // Must not be called while the producer or the consumer is running.
+    void clear() {
+        while (!empty()) {
+            take();
+        }
+    }
+
+    // Called by the consumer, blocks while the queue is empty.
+    T peek() {
+        waitUntil(&BoundedBlockingQueue::hasContent, mConsumerWaiting);
+        return mRing[mHead.load() & (mCapacity - 1)];
+    }
+
+    // Called by the consumer, blocks while the queue is empty.
+    T take() {
+        waitUntil(&BoundedBlockingQueue::hasContent, mConsumerWaiting);
+        const size_t head = mHead.load();
+        T e = mRing[head & (mCapacity - 1)];
+        mRing[head & (mCapacity - 1)] = T();
+        mHead.store(head + 1);
+        wake(mProducerWaiting);
+        return e;
+    }
+
+    // Called by the producer, blocks while the queue is full.
+    void push(const T &e) {
+        waitUntil(&BoundedBlockingQueue::hasSpace, mProducerWaiting);
+        const size_t tail = mTail.load();
+        mRing[tail & (mCapacity - 1)] = e;
+        mTail.store(tail + 1);
+        wake(mConsumerWaiting);
+    }
+
+private:
+    const size_t mCapacity;
+    T *mRing;
+
+    // Only the consumer advances mHead, and only the producer advances mTail. Both only ever
+    // grow, their difference is the number of elements queued.
+    std::atomic<size_t> mHead;
+    std::atomic<size_t> mTail;
+
+    // Set by a side about to block, under mLock, so that the other side signals it. The
+    // sequentially consistent accesses make sure that either the side blocking sees the
+    // index moved by the other side, or the other side sees it waiting.
+    std::atomic<bool> mConsumerWaiting;
+    std::atomic<bool> mProducerWaiting;
+    Mutex mLock;
+    Condition mCondition;
+
+    bool hasContent() {
+        return mHead.load() != mTail.load();
+    }
+
+    bool hasSpace() {
+        return mTail.load() - mHead.load() < mCapacity;
+    }
+
+    void waitUntil(bool (BoundedBlockingQueue::*ready)(), std::atomic<bool> &waiting) {
+        if ((this->*ready)()) {
+            return;
+        }
+        Mutex::Autolock autolock(mLock);
+        waiting.store(true);
+        while (!(this->*ready)()) {
+            mCondition.wait(mLock);
+        }
+        waiting.store(false);
+    }
+
+    void wake(std::atomic<bool> &waiting) {
+        if (waiting.load()) {
+            Mutex::Autolock autolock(mLock);
+            mCondition.signal();
+        }
+    }
+
+    DISALLOW_EVIL_CONSTRUCTORS(BoundedBlockingQueue);
+};
+
+} /* namespace android */
+#endif /* BOUNDEDBLOCKINGQUEUE_H_ */
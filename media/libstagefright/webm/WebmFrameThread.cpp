@@ -24,7 +24,9 @@
 #include <media/stagefright/foundation/ADebug.h>
 
 #include <utils/Log.h>
+#include <errno.h>
 #include <inttypes.h>
+#include <unistd.h>
 
 using namespace webm;
 
@@ -55,7 +57,7 @@ status_t WebmFrameThread::stop() {
 
 WebmFrameSourceThread::WebmFrameSourceThread(
     int type,
-    LinkedBlockingQueue<const sp<WebmFrame> >& sink)
+    BoundedBlockingQueue<sp<WebmFrame> >& sink)
     : mType(type), mSink(sink) {
 }
 
@@ -66,33 +68,45 @@ WebmFrameSinkThread::WebmFrameSinkThread(
         const uint64_t& off,
         sp<WebmFrameSourceThread> videoThread,
         sp<WebmFrameSourceThread> audioThread,
+        const uint64_t& cuesOffset,
+        const uint64_t& cuesReservedSize,
         List<sp<WebmElement> >& cues)
     : mFd(fd),
       mSegmentDataStart(off),
+      mCuesOffset(cuesOffset),
+      mCuesReservedSize(cuesReservedSize),
       mVideoFrames(videoThread->mSink),
       mAudioFrames(audioThread->mSink),
       mCues(cues),
+      mCuesWrittenSize(0),
+      mCuesOverflowed(false),
       mDone(true) {
 }
 
 WebmFrameSinkThread::WebmFrameSinkThread(
         const int& fd,
         const uint64_t& off,
-        LinkedBlockingQueue<const sp<WebmFrame> >& videoSource,
-        LinkedBlockingQueue<const sp<WebmFrame> >& audioSource,
+        BoundedBlockingQueue<sp<WebmFrame> >& videoSource,
+        BoundedBlockingQueue<sp<WebmFrame> >& audioSource,
+        const uint64_t& cuesOffset,
+        const uint64_t& cuesReservedSize,
         List<sp<WebmElement> >& cues)
     : mFd(fd),
       mSegmentDataStart(off),
+      mCuesOffset(cuesOffset),
+      mCuesReservedSize(cuesReservedSize),
       mVideoFrames(videoSource),
       mAudioFrames(audioSource),
       mCues(cues),
+      mCuesWrittenSize(0),
+      mCuesOverflowed(false),
       mDone(true) {
 }
 
 // Initializes a webm cluster with its starting timecode.
 //
-// frames:
-//   sequence of input audio/video frames received from the source.
+// frame:
+//   the first frame of the cluster.
 //
 // clusterTimecodeL:
 //   the starting timecode of the cluster; this is the timecode of the first
@@ -104,13 +118,12 @@ WebmFrameSinkThread::WebmFrameSinkThread(
 //
 // static
 void WebmFrameSinkThread::initCluster(
-    List<const sp<WebmFrame> >& frames,
+    const sp<WebmFrame>& frame,
     uint64_t& clusterTimecodeL,
     List<sp<WebmElement> >& children) {
-    CHECK(!frames.empty() && children.empty());
+    CHECK(children.empty());
 
-    const sp<WebmFrame> f = *(frames.begin());
-    clusterTimecodeL = f->mAbsTimecode;
+    clusterTimecodeL = frame->mAbsTimecode;
     WebmUnsigned *clusterTimecode = new WebmUnsigned(kMkvTimecode, clusterTimecodeL);
     children.clear();
     children.push_back(clusterTimecode);
@@ -130,14 +143,14 @@ void WebmFrameSinkThread::writeCluster(List<sp<WebmElement> >& children) {
 //
 // last:
 //   current flush is triggered by EOS instead of a second outstanding video key frame.
-void WebmFrameSinkThread::flushFrames(List<const sp<WebmFrame> >& frames, bool last) {
+void WebmFrameSinkThread::flushFrames(Vector<sp<WebmFrame> >& frames, bool last) {
     if (frames.empty()) {
         return;
     }
 
     uint64_t clusterTimecodeL;
     List<sp<WebmElement> > children;
-    initCluster(frames, clusterTimecodeL, children);
+    initCluster(frames[0], clusterTimecodeL, children);
 
     uint64_t cueTime = clusterTimecodeL;
     off_t fpos = ::lseek(mFd, 0, SEEK_CUR);
@@ -154,37 +167,72 @@ void WebmFrameSinkThread::flushFrames(List<const sp<WebmFrame> >& frames, bool l
     }
 
     for (size_t i = 0; i < n; i++) {
-        const sp<WebmFrame> f = *(frames.begin());
+        const sp<WebmFrame> f = frames[i];
         if (f->mType == kVideoType && f->mKey) {
             cueTime = f->mAbsTimecode;
         }
 
         if (f->mAbsTimecode - clusterTimecodeL > INT16_MAX) {
             writeCluster(children);
-            initCluster(frames, clusterTimecodeL, children);
+            initCluster(f, clusterTimecodeL, children);
         }
 
-        frames.erase(frames.begin());
         children.push_back(f->SimpleBlock(clusterTimecodeL));
     }
 
     // equivalent to last==false
-    if (!frames.empty()) {
+    if (n < frames.size()) {
         // decide whether to write out the second to last frame.
-        const sp<WebmFrame> secondLastFrame = *(frames.begin());
+        const sp<WebmFrame> secondLastFrame = frames[n];
         if (secondLastFrame->mType == kVideoType) {
-            frames.erase(frames.begin());
+            n++;
             children.push_back(secondLastFrame->SimpleBlock(clusterTimecodeL));
         }
     }
+    frames.removeItemsAt(0, n);
 
     writeCluster(children);
     sp<WebmElement> cuePoint = WebmElement::CuePointEntry(cueTime, 1, fpos - mSegmentDataStart);
     mCues.push_back(cuePoint);
+    writeCuePoint(cuePoint);
+}
+
+// Writes a cue point right after the ones written before it in the space reserved for the
+// cues, so that stopping the recording only has to write the header of the cues element. The
+// reserved space stays a valid void element until then.
+void WebmFrameSinkThread::writeCuePoint(const sp<WebmElement>& cuePoint) {
+    if (mCuesReservedSize == 0 || mCuesOverflowed) {
+        return;
+    }
+
+    uint8_t buf[64];
+    const uint64_t size = cuePoint->totalSize();
+    if (size > sizeof(buf) || kCuesHeaderSize + mCuesWrittenSize + size + kMinEbmlVoidSize
+            > mCuesReservedSize) {
+        ALOGW("cues do not fit in the %" PRIu64 " bytes reserved", mCuesReservedSize);
+        mCuesOverflowed = true;
+        return;
+    }
+
+    cuePoint->serializeInto(buf);
+    const off64_t offset = mCuesOffset + kCuesHeaderSize + mCuesWrittenSize;
+    if (::pwrite64(mFd, buf, size, offset) != (ssize_t)size) {
+        ALOGE("failed to write cue point; errno = %d", errno);
+        mCuesOverflowed = true;
+        return;
+    }
+    mCuesWrittenSize += size;
+}
+
+bool WebmFrameSinkThread::cuesWrittenInPlace(uint64_t *size) const {
+    *size = mCuesWrittenSize;
+    return mCuesReservedSize >= kCuesHeaderSize + kMinEbmlVoidSize && !mCuesOverflowed;
 }
 
 status_t WebmFrameSinkThread::start() {
     mDone = false;
+    mCuesWrittenSize = 0;
+    mCuesOverflowed = false;
     return WebmFrameThread::start();
 }
 
@@ -197,7 +245,7 @@ status_t WebmFrameSinkThread::stop() {
 
 void WebmFrameSinkThread::run() {
     int numVideoKeyFrames = 0;
-    List<const sp<WebmFrame> > outstandingFrames;
+    Vector<sp<WebmFrame> > outstandingFrames;
     while (!mDone) {
         ALOGV("wait v frame");
         const sp<WebmFrame> videoFrame = mVideoFrames.peek();
@@ -248,7 +296,7 @@ void WebmFrameMediaSourceThread::clearFlags() {
 WebmFrameMediaSourceThread::WebmFrameMediaSourceThread(
         const sp<IMediaSource>& source,
         int type,
-        LinkedBlockingQueue<const sp<WebmFrame> >& sink,
+        BoundedBlockingQueue<sp<WebmFrame> >& sink,
         uint64_t timeCodeScale,
         int64_t startTimeRealUs,
         int32_t startTimeOffsetMs,
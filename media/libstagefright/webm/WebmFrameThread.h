@@ -18,12 +18,13 @@
 #define WEBMFRAMETHREAD_H_
 
 #include "WebmFrame.h"
-#include "LinkedBlockingQueue.h"
+#include "BoundedBlockingQueue.h"
 
 #include <media/stagefright/FileSource.h>
 #include <media/stagefright/MediaSource.h>
 
 #include <utils/List.h>
+#include <utils/Vector.h>
 #include <utils/Errors.h>
 
 #include <pthread.h>
@@ -61,13 +62,17 @@ public:
             const uint64_t& off,
             sp<WebmFrameSourceThread> videoThread,
             sp<WebmFrameSourceThread> audioThread,
+            const uint64_t& cuesOffset,
+            const uint64_t& cuesReservedSize,
             List<sp<WebmElement> >& cues);
 
     WebmFrameSinkThread(
             const int& fd,
             const uint64_t& off,
-            LinkedBlockingQueue<const sp<WebmFrame> >& videoSource,
-            LinkedBlockingQueue<const sp<WebmFrame> >& audioSource,
+            BoundedBlockingQueue<sp<WebmFrame> >& videoSource,
+            BoundedBlockingQueue<sp<WebmFrame> >& audioSource,
+            const uint64_t& cuesOffset,
+            const uint64_t& cuesReservedSize,
             List<sp<WebmElement> >& cues);
 
     void run();
@@ -77,32 +82,45 @@ public:
     status_t start();
     status_t stop();
 
+    // Returns whether all cue points fit in the space reserved for the cues, where they are
+    // written along with their clusters; |size| is then the size of the cue points written.
+    bool cuesWrittenInPlace(uint64_t *size) const;
+
+    // The size of the cues element written in place is coded on the full width, as it is not
+    // known yet when the first cue point is written.
+    static const uint64_t kCuesHeaderSize = 4 + 8;
+
 private:
     const int& mFd;
     const uint64_t& mSegmentDataStart;
-    LinkedBlockingQueue<const sp<WebmFrame> >& mVideoFrames;
-    LinkedBlockingQueue<const sp<WebmFrame> >& mAudioFrames;
+    const uint64_t& mCuesOffset;
+    const uint64_t& mCuesReservedSize;
+    BoundedBlockingQueue<sp<WebmFrame> >& mVideoFrames;
+    BoundedBlockingQueue<sp<WebmFrame> >& mAudioFrames;
     List<sp<WebmElement> >& mCues;
+    uint64_t mCuesWrittenSize;
+    bool mCuesOverflowed;
 
     volatile bool mDone;
 
     static void initCluster(
-            List<const sp<WebmFrame> >& frames,
+            const sp<WebmFrame>& frame,
             uint64_t& clusterTimecodeL,
             List<sp<WebmElement> >& children);
     void writeCluster(List<sp<WebmElement> >& children);
-    void flushFrames(List<const sp<WebmFrame> >& frames, bool last);
+    void flushFrames(Vector<sp<WebmFrame> >& frames, bool last);
+    void writeCuePoint(const sp<WebmElement>& cuePoint);
 };
 
 //=================================================================================================
 
 class WebmFrameSourceThread : public WebmFrameThread {
 public:
-    WebmFrameSourceThread(int type, LinkedBlockingQueue<const sp<WebmFrame> >& sink);
+    WebmFrameSourceThread(int type, BoundedBlockingQueue<sp<WebmFrame> >& sink);
     virtual int64_t getDurationUs() = 0;
 protected:
     const int mType;
-    LinkedBlockingQueue<const sp<WebmFrame> >& mSink;
+    BoundedBlockingQueue<sp<WebmFrame> >& mSink;
 
     friend class WebmFrameSinkThread;
 };
@@ -111,7 +129,7 @@ protected:
 
 class WebmFrameEmptySourceThread : public WebmFrameSourceThread {
 public:
-    WebmFrameEmptySourceThread(int type, LinkedBlockingQueue<const sp<WebmFrame> >& sink)
+    WebmFrameEmptySourceThread(int type, BoundedBlockingQueue<sp<WebmFrame> >& sink)
         : WebmFrameSourceThread(type, sink) {
     }
     void run() { mSink.push(WebmFrame::EOS); }
@@ -125,7 +143,7 @@ public:
     WebmFrameMediaSourceThread(
             const sp<IMediaSource>& source,
             int type,
-            LinkedBlockingQueue<const sp<WebmFrame> >& sink,
+            BoundedBlockingQueue<sp<WebmFrame> >& sink,
             uint64_t timeCodeScale,
             int64_t startTimeRealUs,
             int32_t startTimeOffsetMs,
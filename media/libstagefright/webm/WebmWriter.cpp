@@ -77,6 +77,8 @@ WebmWriter::WebmWriter(int fd)
             mSegmentDataStart,
             mStreams[kVideoIndex].mSink,
             mStreams[kAudioIndex].mSink,
+            mCuesOffset,
+            mEstimatedCuesSize,
             mCuePoints);
 }
 
@@ -305,20 +307,27 @@ status_t WebmWriter::reset() {
         return err;
     }
 
-    sp<WebmElement> cues = new WebmMaster(kMkvCues, mCuePoints);
-    uint64_t cuesSize = cues->totalSize();
-    // TRICKY Even when the cues do fit in the space we reserved, if they do not fit
-    // perfectly, we still need to check if there is enough "extra space" to write an
-    // EBML void element.
-    if (cuesSize != mEstimatedCuesSize && cuesSize > mEstimatedCuesSize - kMinEbmlVoidSize) {
-        mCuesOffset = ::lseek(mFd, 0, SEEK_CUR);
-        cues->write(mFd, cuesSize);
-    } else {
+    uint64_t cuePointsSize;
+    if (mSinkThread->cuesWrittenInPlace(&cuePointsSize)) {
+        // The cue points are already in the space we reserved, only their header and the
+        // void element left after them need to be written.
+        uint8_t header[WebmFrameSinkThread::kCuesHeaderSize];
+        int idSize = serializeCodedUnsigned(kMkvCues, header);
+        serializeCodedUnsigned(
+                encodeUnsigned(cuePointsSize, sizeOf(kMkvUnknownLength)), header + idSize);
+        ::pwrite64(mFd, header, sizeof(header), mCuesOffset);
+
         uint64_t spaceSize;
-        ::lseek(mFd, mCuesOffset, SEEK_SET);
-        cues->write(mFd, cuesSize);
-        sp<WebmElement> space = new EbmlVoid(mEstimatedCuesSize - cuesSize);
+        ::lseek(mFd, mCuesOffset + sizeof(header) + cuePointsSize, SEEK_SET);
+        sp<WebmElement> space =
+                new EbmlVoid(mEstimatedCuesSize - sizeof(header) - cuePointsSize);
         space->write(mFd, spaceSize);
+    } else {
+        // The reserved space, if any, stays void.
+        uint64_t cuesSize;
+        sp<WebmElement> cues = new WebmMaster(kMkvCues, mCuePoints);
+        mCuesOffset = ::lseek(mFd, 0, SEEK_END);
+        cues->write(mFd, cuesSize);
     }
 
     mCuePoints.clear();
@@ -19,7 +19,7 @@
 
 #include "WebmConstants.h"
 #include "WebmFrameThread.h"
-#include "LinkedBlockingQueue.h"
+#include "BoundedBlockingQueue.h"
 
 #include <media/stagefright/MediaSource.h>
 #include <media/stagefright/MediaWriter.h>
@@ -88,7 +88,7 @@ private:
         sp<IMediaSource> mSource;
         sp<WebmElement> mTrackEntry;
         sp<WebmFrameSourceThread> mThread;
-        LinkedBlockingQueue<const sp<WebmFrame> > mSink;
+        BoundedBlockingQueue<sp<WebmFrame> > mSink;
 
         WebmStream()
             : mType(kInvalidType),
@@ -25,6 +25,7 @@
 
 #include "include/avc_utils.h"
 
+#include <cutils/properties.h>
 #include <media/IHDCP.h>
 #include <media/stagefright/MediaBuffer.h>
 #include <media/stagefright/foundation/ABuffer.h>
@@ -44,8 +45,16 @@ MediaSender::MediaSender(
       mGeneration(0),
       mPrevTimeUs(-1ll),
       mInitDoneCount(0),
+      mLowLatency(false),
       mLogFile(NULL) {
     // mLogFile = fopen("/data/misc/log.ts", "wb");
+
+    char val[PROPERTY_VALUE_MAX];
+    if (property_get("media.wfd.low-latency", val, NULL)
+            && (!strcasecmp("true", val) || !strcmp("1", val))) {
+        ALOGI("Sending with low latency.");
+        mLowLatency = true;
+    }
 }
 
 MediaSender::~MediaSender() {
@@ -105,6 +114,10 @@ status_t MediaSender::initAsync(
         }
         mTSPacketizer = new TSPacketizer(flags);
 
+        // RTPSender forms its packets around the transport packets in place.
+        mTSPacketizer->setHeaderRoom(
+                12 /* RTP header */, RTPSender::kMaxNumTSPacketsPerRTPPacket);
+
         status_t err = OK;
         for (size_t i = 0; i < mTrackInfos.size(); ++i) {
             TrackInfo *info = &mTrackInfos.editItemAt(i);
@@ -217,6 +230,10 @@ status_t MediaSender::queueAccessUnit(
 
         mTSPacketizer->extractCSDIfNecessary(info->mPacketizerTrackIndex);
 
+        if (mLowLatency) {
+            return sendAccessUnit(trackIndex);
+        }
+
         for (;;) {
             ssize_t minTrackIndex = -1;
             int64_t minTimeUs = -1ll;
@@ -244,29 +261,7 @@ status_t MediaSender::queueAccessUnit(
                 return OK;
             }
 
-            TrackInfo *info = &mTrackInfos.editItemAt(minTrackIndex);
-            sp<ABuffer> accessUnit = *info->mAccessUnits.begin();
-            info->mAccessUnits.erase(info->mAccessUnits.begin());
-
-            sp<ABuffer> tsPackets;
-            status_t err = packetizeAccessUnit(
-                    minTrackIndex, accessUnit, &tsPackets);
-
-            if (err == OK) {
-                if (mLogFile != NULL) {
-                    fwrite(tsPackets->data(), 1, tsPackets->size(), mLogFile);
-                }
-
-                int64_t timeUs;
-                CHECK(accessUnit->meta()->findInt64("timeUs", &timeUs));
-                tsPackets->meta()->setInt64("timeUs", timeUs);
-
-                err = mTSSender->queueBuffer(
-                        tsPackets,
-                        33 /* packetType */,
-                        RTPSender::PACKETIZATION_TRANSPORT_STREAM);
-            }
-
+            status_t err = sendAccessUnit(minTrackIndex);
             if (err != OK) {
                 return err;
             }
@@ -378,6 +373,38 @@ void MediaSender::notifyError(status_t err) {
     notify->post();
 }
 
+status_t MediaSender::sendAccessUnit(size_t trackIndex) {
+    TrackInfo *info = &mTrackInfos.editItemAt(trackIndex);
+    sp<ABuffer> accessUnit = *info->mAccessUnits.begin();
+    info->mAccessUnits.erase(info->mAccessUnits.begin());
+
+    sp<ABuffer> tsPackets;
+    status_t err = packetizeAccessUnit(trackIndex, accessUnit, &tsPackets);
+
+    if (err == OK) {
+        if (mLogFile != NULL) {
+            // skip the room left for the RTP headers
+            size_t packetsSize = RTPSender::kMaxNumTSPacketsPerRTPPacket * 188;
+            for (size_t offset = 12; offset < tsPackets->size(); offset += 12 + packetsSize) {
+                size_t size = tsPackets->size() - offset;
+                fwrite(tsPackets->data() + offset, 1,
+                        size < packetsSize ? size : packetsSize, mLogFile);
+            }
+        }
+
+        int64_t timeUs;
+        CHECK(accessUnit->meta()->findInt64("timeUs", &timeUs));
+        tsPackets->meta()->setInt64("timeUs", timeUs);
+
+        err = mTSSender->queueBuffer(
+                tsPackets,
+                33 /* packetType */,
+                RTPSender::PACKETIZATION_TRANSPORT_STREAM);
+    }
+
+    return err;
+}
+
 void MediaSender::notifyNetworkStall(size_t numBytesQueued) {
     sp<AMessage> notify = mNotify->dup();
     notify->setInt32("what", kWhatNetworkStall);
@@ -397,8 +424,14 @@ status_t MediaSender::packetizeAccessUnit(
     uint64_t inputCTR;
     uint8_t HDCP_private_data[16];
 
+    int32_t continuation;
+    if (!accessUnit->meta()->findInt32("continuation", &continuation)) {
+        continuation = false;
+    }
+
     bool manuallyPrependSPSPPS =
         !info.mIsAudio
+        && !continuation
         && (info.mFlags & FLAG_MANUALLY_PREPEND_SPS_PPS)
         && IsIDR(accessUnit);
 
@@ -493,6 +526,16 @@ status_t MediaSender::packetizeAccessUnit(
         flags |= TSPacketizer::PREPEND_SPS_PPS_TO_IDR_FRAMES;
     }
 
+    if (mLowLatency && !info.mIsAudio) {
+        // Every part of the frame is encrypted with its own counter, only the clear
+        // ones can continue the PES packet.
+        if (continuation && !isHDCPEncrypted) {
+            flags |= TSPacketizer::CONTINUE_PES;
+        } else {
+            flags |= TSPacketizer::UNBOUNDED_PES;
+        }
+    }
+
     int64_t timeUs = ALooper::GetNowUs();
     if (mPrevTimeUs < 0ll || mPrevTimeUs + 100000ll <= timeUs) {
         flags |= TSPacketizer::EMIT_PCR;
@@ -110,6 +110,10 @@ private:
 
     size_t mInitDoneCount;
 
+    // Access units, and the parts of frames that the encoder outputs separately, are
+    // sent as they come instead of being interleaved with the other tracks by time.
+    bool mLowLatency;
+
     FILE *mLogFile;
 
     void onSenderNotify(const sp<AMessage> &msg);
@@ -118,6 +122,8 @@ private:
     void notifyError(status_t err);
     void notifyNetworkStall(size_t numBytesQueued);
 
+    status_t sendAccessUnit(size_t trackIndex);
+
     status_t packetizeAccessUnit(
             size_t trackIndex,
             sp<ABuffer> accessUnit,
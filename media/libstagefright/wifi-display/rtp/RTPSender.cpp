@@ -247,15 +247,39 @@ status_t RTPSender::queueRawPacket(
 
 status_t RTPSender::queueTSPackets(
         const sp<ABuffer> &tsPackets, uint8_t packetType) {
-    CHECK_EQ(0, tsPackets->size() % 188);
+    // The packetizer may have left room for the RTP header in front of every
+    // packet's worth of TS packets, the RTP packets are then formed in place.
+    int32_t headerRoom;
+    if (tsPackets->meta()->findInt32("headerRoom", &headerRoom)) {
+        int32_t numPacketsPerChunk;
+        CHECK(tsPackets->meta()->findInt32("packetsPerChunk", &numPacketsPerChunk));
+        CHECK_EQ(headerRoom, 12);
+        CHECK_EQ(numPacketsPerChunk, (int32_t)kMaxNumTSPacketsPerRTPPacket);
+    } else {
+        headerRoom = 0;
+        CHECK_EQ(0, tsPackets->size() % 188);
+    }
 
     int64_t timeUs;
     CHECK(tsPackets->meta()->findInt64("timeUs", &timeUs));
 
     size_t srcOffset = 0;
     while (srcOffset < tsPackets->size()) {
-        sp<ABuffer> udpPacket =
-            new ABuffer(12 + kMaxNumTSPacketsPerRTPPacket * 188);
+        size_t numTSPackets = (tsPackets->size() - srcOffset - headerRoom) / 188;
+        if (numTSPackets > kMaxNumTSPacketsPerRTPPacket) {
+            numTSPackets = kMaxNumTSPacketsPerRTPPacket;
+        }
+
+        sp<ABuffer> udpPacket;
+        if (headerRoom > 0) {
+            udpPacket = ABuffer::CreateAsSlice(
+                    tsPackets, srcOffset, 12 + numTSPackets * 188);
+        } else {
+            udpPacket = new ABuffer(12 + numTSPackets * 188);
+            memcpy(udpPacket->data() + 12,
+                   tsPackets->data() + srcOffset,
+                   numTSPackets * 188);
+        }
 
         udpPacket->setInt32Data(mRTPSeqNo);
 
@@ -280,16 +304,7 @@ status_t RTPSender::queueTSPackets(
         rtp[10] = (kSourceID >> 8) & 0xff;
         rtp[11] = kSourceID & 0xff;
 
-        size_t numTSPackets = (tsPackets->size() - srcOffset) / 188;
-        if (numTSPackets > kMaxNumTSPacketsPerRTPPacket) {
-            numTSPackets = kMaxNumTSPacketsPerRTPPacket;
-        }
-
-        memcpy(&rtp[12], tsPackets->data() + srcOffset, numTSPackets * 188);
-
-        udpPacket->setRange(0, 12 + numTSPackets * 188);
-
-        srcOffset += numTSPackets * 188;
+        srcOffset += headerRoom + numTSPackets * 188;
         bool isLastPacket = (srcOffset == tsPackets->size());
 
         status_t err = sendRTPPacket(
@@ -461,9 +476,9 @@ status_t RTPSender::sendRTPPacket(
         bool timeValid, int64_t timeUs) {
     CHECK(mRTPConnected);
 
-    status_t err = mNetSession->sendRequest(
-            mRTPSessionID, buffer->data(), buffer->size(),
-            timeValid, timeUs);
+    // the packets are not modified once sent, also not when retransmitted
+    status_t err = mNetSession->sendDatagram(
+            mRTPSessionID, buffer, timeValid, timeUs);
 
     if (err != OK) {
         return err;
@@ -39,6 +39,10 @@ struct RTPSender : public RTPBase, public AHandler {
         kWhatNetworkStall,
         kWhatInformSender,
     };
+    enum {
+        kMaxNumTSPacketsPerRTPPacket = (kMaxUDPPacketSize - 12) / 188,
+    };
+
     RTPSender(
             const sp<ANetworkSession> &netSession,
             const sp<AMessage> &notify);
@@ -67,7 +71,6 @@ private:
     };
 
     enum {
-        kMaxNumTSPacketsPerRTPPacket = (kMaxUDPPacketSize - 12) / 188,
         kMaxHistorySize              = 1024,
         kSourceID                    = 0xdeadbeef,
     };
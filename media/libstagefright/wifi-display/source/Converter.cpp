@@ -61,6 +61,7 @@ Converter::Converter(
       ,mPrevVideoBitrate(-1)
       ,mNumFramesToDrop(0)
       ,mEncodingSuspended(false)
+      ,mPrevOutputTimeUs(-1ll)
     {
     AString mime;
     CHECK(mOutputFormat->findString("mime", &mime));
@@ -366,6 +367,17 @@ void Converter::onMessageReceived(const sp<AMessage> &msg) {
                 }
 #endif
 
+                if (mIsVideo) {
+                    // While the encoder is behind, a stale frame is replaced rather than
+                    // queued behind, releasing it lets the source supply the next one.
+                    while (mInputBufferQueue.size() >= kMaxQueuedVideoFrames
+                            && *mInputBufferQueue.begin() != NULL) {
+                        (*mInputBufferQueue.begin())->setMediaBufferBase(NULL);
+                        mInputBufferQueue.erase(mInputBufferQueue.begin());
+                        ALOGV("dropping stale frame.");
+                    }
+                }
+
                 mInputBufferQueue.push_back(accessUnit);
 
                 feedEncoderInputBuffers();
@@ -759,7 +771,14 @@ status_t Converter::doMoreWork() {
                     mOutputFormat->setBuffer("csd-0", buffer);
                 }
             } else {
-                if (mNeedToManuallyPrependSPSPPS
+                bool continuation = mIsVideo && timeUs == mPrevOutputTimeUs;
+                mPrevOutputTimeUs = timeUs;
+
+                if (continuation) {
+                    // the rest of an IDR frame is IDR slices as well, the CSD goes
+                    // in front of the first one only
+                    buffer->meta()->setInt32("continuation", true);
+                } else if (mNeedToManuallyPrependSPSPPS
                         && mIsH264
                         && (mFlags & FLAG_PREPEND_CSD_IF_NECESSARY)
                         && IsIDR(buffer)) {
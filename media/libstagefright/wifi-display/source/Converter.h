@@ -92,6 +92,11 @@ private:
         kWhatReleaseOutputBuffer,
     };
 
+    enum {
+        // video frames waiting for encoder input buffers at most
+        kMaxQueuedVideoFrames = 2,
+    };
+
     sp<AMessage> mNotify;
     sp<ALooper> mCodecLooper;
     sp<AMessage> mOutputFormat;
@@ -129,6 +134,10 @@ private:
     int32_t mNumFramesToDrop;
     bool mEncodingSuspended;
 
+    // Encoders that output a frame in several buffers, e.g. a slice at a time, give them
+    // the same time, the later ones are sent on as continuations of the frame.
+    int64_t mPrevOutputTimeUs;
+
     status_t initEncoder();
     void releaseEncoder();
 
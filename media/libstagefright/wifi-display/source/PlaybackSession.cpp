@@ -365,7 +365,12 @@ WifiDisplaySource::PlaybackSession::PlaybackSession(
       mPullExtractorPending(false),
       mPullExtractorGeneration(0),
       mFirstSampleTimeRealUs(-1ll),
-      mFirstSampleTimeUs(-1ll) {
+      mFirstSampleTimeUs(-1ll),
+      mNominalFrameRateHz(-1.0),
+      mNominalVideoBitrate(-1),
+      mLastStallUs(-1ll),
+      mLastStallBackoffUs(-1ll),
+      mStallRecoveryPending(false) {
     if (path != NULL) {
         mMediaPath.setTo(path);
     }
@@ -557,15 +562,7 @@ void WifiDisplaySource::PlaybackSession::onMessageReceived(
                 size_t numBytesQueued;
                 CHECK(msg->findSize("numBytesQueued", &numBytesQueued));
 
-                if (mVideoTrackIndex >= 0) {
-                    const sp<Track> &videoTrack =
-                        mTracks.valueFor(mVideoTrackIndex);
-
-                    sp<Converter> converter = videoTrack->converter();
-                    if (converter != NULL) {
-                        converter->dropAFrame();
-                    }
-                }
+                onNetworkStall(numBytesQueued);
             } else if (what == MediaSender::kWhatInformSender) {
                 onSinkFeedback(msg);
             } else {
@@ -658,6 +655,14 @@ void WifiDisplaySource::PlaybackSession::onMessageReceived(
             break;
         }
 
+        case kWhatRecoverFromStall:
+        {
+            mStallRecoveryPending = false;
+
+            onRecoverFromStall();
+            break;
+        }
+
         default:
             TRESPASS();
     }
@@ -746,6 +751,135 @@ void WifiDisplaySource::PlaybackSession::onSinkFeedback(const sp<AMessage> &msg)
     }
 }
 
+void WifiDisplaySource::PlaybackSession::onNetworkStall(size_t numBytesQueued) {
+    if (mVideoTrackIndex < 0) {
+        return;
+    }
+
+    const sp<Track> &videoTrack = mTracks.valueFor(mVideoTrackIndex);
+
+    sp<Converter> converter = videoTrack->converter();
+    if (converter != NULL) {
+        converter->dropAFrame();
+    }
+
+    int64_t nowUs = ALooper::GetNowUs();
+    mLastStallUs = nowUs;
+
+    if (mLastStallBackoffUs >= 0ll
+            && nowUs < mLastStallBackoffUs + kStallBackoffIntervalUs) {
+        // the last step down has yet to take effect.
+        return;
+    }
+    mLastStallBackoffUs = nowUs;
+
+    if (converter != NULL
+            && Converter::GetInt32Property("media.wfd.video-bitrate", -1) < 0) {
+        int32_t videoBitrate = converter->getVideoBitrate();
+        if (mNominalVideoBitrate < 0) {
+            mNominalVideoBitrate = videoBitrate;
+        }
+
+        videoBitrate = videoBitrate * 4 / 5;
+        if (videoBitrate < 500000) {
+            videoBitrate = 500000;
+        }
+
+        if (videoBitrate != converter->getVideoBitrate()) {
+            ALOGI("%zu bytes queued, lowering video bitrate to %d bps",
+                  numBytesQueued, videoBitrate);
+
+            converter->setVideoBitrate(videoBitrate);
+        }
+    }
+
+    sp<RepeaterSource> repeaterSource = videoTrack->repeaterSource();
+    if (repeaterSource != NULL
+            && Converter::GetInt32Property("media.wfd.video-framerate", -1) < 0) {
+        double rateHz = repeaterSource->getFrameRate();
+        if (mNominalFrameRateHz < 0.0) {
+            mNominalFrameRateHz = rateHz;
+        }
+
+        rateHz *= 0.8;
+        if (rateHz < 5.0) {
+            rateHz = 5.0;
+        }
+
+        if (rateHz != repeaterSource->getFrameRate()) {
+            ALOGI("%zu bytes queued, lowering frame rate to %.2f Hz",
+                  numBytesQueued, rateHz);
+
+            repeaterSource->setFrameRate(rateHz);
+        }
+    }
+
+    scheduleStallRecovery(kStallRecoveryIntervalUs);
+}
+
+void WifiDisplaySource::PlaybackSession::onRecoverFromStall() {
+    if (mWeAreDead || mVideoTrackIndex < 0) {
+        return;
+    }
+
+    int64_t nowUs = ALooper::GetNowUs();
+    if (nowUs < mLastStallUs + kStallRecoveryIntervalUs) {
+        scheduleStallRecovery(mLastStallUs + kStallRecoveryIntervalUs - nowUs);
+        return;
+    }
+
+    const sp<Track> &videoTrack = mTracks.valueFor(mVideoTrackIndex);
+    bool recovered = true;
+
+    sp<Converter> converter = videoTrack->converter();
+    if (converter != NULL && mNominalVideoBitrate > 0) {
+        int32_t videoBitrate = converter->getVideoBitrate() * 11 / 10;
+        if (videoBitrate >= mNominalVideoBitrate) {
+            videoBitrate = mNominalVideoBitrate;
+            mNominalVideoBitrate = -1;
+        } else {
+            recovered = false;
+        }
+
+        if (videoBitrate != converter->getVideoBitrate()) {
+            ALOGI("raising video bitrate to %d bps", videoBitrate);
+
+            converter->setVideoBitrate(videoBitrate);
+        }
+    }
+
+    sp<RepeaterSource> repeaterSource = videoTrack->repeaterSource();
+    if (repeaterSource != NULL && mNominalFrameRateHz > 0.0) {
+        double rateHz = repeaterSource->getFrameRate() * 1.1;
+        if (rateHz >= mNominalFrameRateHz) {
+            rateHz = mNominalFrameRateHz;
+            mNominalFrameRateHz = -1.0;
+        } else {
+            recovered = false;
+        }
+
+        if (rateHz != repeaterSource->getFrameRate()) {
+            ALOGI("raising frame rate to %.2f Hz", rateHz);
+
+            repeaterSource->setFrameRate(rateHz);
+        }
+    }
+
+    if (!recovered) {
+        // step back up gradually, the network may only just sustain the rate.
+        scheduleStallRecovery(kStallBackoffIntervalUs);
+    }
+}
+
+void WifiDisplaySource::PlaybackSession::scheduleStallRecovery(int64_t delayUs) {
+    if (mStallRecoveryPending) {
+        return;
+    }
+
+    (new AMessage(kWhatRecoverFromStall, this))->post(delayUs);
+    mStallRecoveryPending = true;
+}
+
 status_t WifiDisplaySource::PlaybackSession::setupMediaPacketizer(
         bool enableAudio, bool enableVideo) {
     DataSource::RegisterDefaultSniffers();
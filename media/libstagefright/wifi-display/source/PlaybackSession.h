@@ -97,8 +97,14 @@ private:
         kWhatResume,
         kWhatMediaSenderNotify,
         kWhatPullExtractorSample,
+        kWhatRecoverFromStall,
     };
 
+    // The network is given this long to drain after the frame rate and the
+    // video bitrate were lowered, and after a stall before they are raised.
+    static const int64_t kStallBackoffIntervalUs = 500000ll;
+    static const int64_t kStallRecoveryIntervalUs = 2000000ll;
+
     String16 mOpPackageName;
 
     sp<ANetworkSession> mNetSession;
@@ -129,6 +135,14 @@ private:
     int64_t mFirstSampleTimeRealUs;
     int64_t mFirstSampleTimeUs;
 
+    // frame rate and video bitrate before the network stalled, -1 if not
+    // backed off
+    double mNominalFrameRateHz;
+    int32_t mNominalVideoBitrate;
+    int64_t mLastStallUs;
+    int64_t mLastStallBackoffUs;
+    bool mStallRecoveryPending;
+
     status_t setupMediaPacketizer(bool enableAudio, bool enableVideo);
 
     status_t setupPacketizer(
@@ -167,6 +181,13 @@ private:
 
     void onSinkFeedback(const sp<AMessage> &msg);
 
+    // Lowers the frame rate and the video bitrate while the RTP packets
+    // queue up, unless fixed by media.wfd.video-framerate and
+    // media.wfd.video-bitrate, and raises them back once the queue drained.
+    void onNetworkStall(size_t numBytesQueued);
+    void onRecoverFromStall();
+    void scheduleStallRecovery(int64_t delayUs);
+
     DISALLOW_EVIL_CONSTRUCTORS(PlaybackSession);
 };
 
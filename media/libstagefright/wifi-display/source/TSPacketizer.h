@@ -41,11 +41,22 @@ struct TSPacketizer : public RefBase {
     // Returns trackIndex or error.
     ssize_t addTrack(const sp<AMessage> &format);
 
+    // Leaves |headerRoom| bytes before every |numPacketsPerChunk| transport
+    // packets of the output, for the transport to write its own header in
+    // place, e.g. RTP. Such output carries "headerRoom" and "packetsPerChunk"
+    // in its meta.
+    void setHeaderRoom(size_t headerRoom, size_t numPacketsPerChunk);
+
     enum {
         EMIT_PAT_AND_PMT                = 1,
         EMIT_PCR                        = 2,
         IS_ENCRYPTED                    = 4,
         PREPEND_SPS_PPS_TO_IDR_FRAMES   = 8,
+        // The PES packet of a video access unit leaves its length open, so that later
+        // parts of the frame can continue it.
+        UNBOUNDED_PES                   = 16,
+        // The access unit continues the last PES packet of the track.
+        CONTINUE_PES                    = 32,
     };
     status_t packetize(
             size_t trackIndex, const sp<ABuffer> &accessUnit,
@@ -77,11 +88,24 @@ private:
 
     Vector<sp<ABuffer> > mProgramInfoDescriptors;
 
+    size_t mHeaderRoom;
+    size_t mPacketsPerChunk;
+
+    // PAT and PMT packets, but for their continuity counters.
+    sp<ABuffer> mPATPacket;
+    sp<ABuffer> mPMTPacket;
+
     unsigned mPATContinuityCounter;
     unsigned mPMTContinuityCounter;
 
     uint32_t mCrcTable[256];
 
+    void initPSIPackets();
+
+    // Returns the start of the packet following |packet| in the output,
+    // counting it in |packetIndex|.
+    uint8_t *nextPacket(uint8_t *packet, size_t *packetIndex) const;
+
     void initCrcTable();
     uint32_t crc32(const uint8_t *start, size_t size) const;
 
@@ -385,6 +385,8 @@ void MtpDataPacket::putAInt32(const int32_t* values, int count) {
 }
 
 void MtpDataPacket::putAUInt32(const uint32_t* values, int count) {
+    // reserve the whole array at once, handle lists can hold thousands of entries
+    allocate(mOffset + 4 + (count > 0 ? count : 0) * 4);
     putUInt32(count);
     for (int i = 0; i < count; i++)
         putUInt32(*values++);
@@ -395,6 +397,7 @@ void MtpDataPacket::putAUInt32(const UInt32List* list) {
         putEmptyArray();
     } else {
         size_t size = list->size();
+        allocate(mOffset + 4 + size * 4);
         putUInt32(size);
         for (size_t i = 0; i < size; i++)
             putUInt32((*list)[i]);
@@ -430,12 +433,20 @@ void MtpDataPacket::putString(const uint16_t* string) {
         else
             break;
     }
-    putUInt8(count > 0 ? count + 1 : 0);
-    for (int i = 0; i < count; i++)
-        putUInt16(string[i]);
+    // write the length byte and all characters at once
+    allocate(mOffset + 1 + (count > 0 ? (count + 1) * 2 : 0));
+    mBuffer[mOffset++] = (uint8_t)(count > 0 ? count + 1 : 0);
+    for (int i = 0; i < count; i++) {
+        mBuffer[mOffset++] = (uint8_t)(string[i] & 0xFF);
+        mBuffer[mOffset++] = (uint8_t)(string[i] >> 8);
+    }
     // only terminate with zero if string is not empty
-    if (count > 0)
-        putUInt16(0);
+    if (count > 0) {
+        mBuffer[mOffset++] = 0;
+        mBuffer[mOffset++] = 0;
+    }
+    if (mPacketSize < mOffset)
+        mPacketSize = mOffset;
 }
 
 #ifdef MTP_DEVICE 
@@ -576,9 +587,17 @@ int MtpDataPacket::write(struct usb_request *request,
     size_t processedBytes = 0;
     bool readError = false;
 
-    // Bind the packet with given request.
-    request->buffer = mBuffer;
+    // Double buffer the transfer: the next chunk is read from the FD while the previous one is
+    // being sent, so that file and USB I/O overlap.
     allocate(maxBulkTransferSize);
+    uint8_t* const spareBuffer = static_cast<uint8_t*>(malloc(maxBulkTransferSize));
+    if (!spareBuffer) {
+        ALOGE("Failed to allocate the bulk transfer buffer.");
+        return -1;
+    }
+    uint8_t* buffer = mBuffer;
+    size_t pendingTransferSize = 0;
+    bool transferError = false;
 
     while (processedBytes < containerLength) {
         size_t bulkTransferSize = 0;
@@ -602,7 +621,7 @@ int MtpDataPacket::write(struct usb_request *request,
             if (!readError) {
                 const ssize_t result = readExactBytes(
                         fd,
-                        mBuffer + bulkTransferSize,
+                        buffer + bulkTransferSize,
                         bulkTransferPayloadSize);
                 if (result < 0) {
                     ALOGE("Found an error while reading data from FD. Send 0 data instead.");
@@ -610,23 +629,46 @@ int MtpDataPacket::write(struct usb_request *request,
                 }
             }
             if (readError) {
-                memset(mBuffer + bulkTransferSize, 0, bulkTransferPayloadSize);
+                memset(buffer + bulkTransferSize, 0, bulkTransferPayloadSize);
             }
             bulkTransferSize += bulkTransferPayloadSize;
         }
 
-        // Bulk transfer.
+        // Wait for the previous bulk transfer, then queue this one.
+        if (pendingTransferSize > 0) {
+            const int result = readDataWait(request->dev);
+            pendingTransferSize = 0;
+            if (result != static_cast<ssize_t>(request->buffer_length)) {
+                transferError = true;
+                break;
+            }
+        }
         mPacketSize = bulkTransferSize;
+        request->buffer = buffer;
         request->buffer_length = bulkTransferSize;
-        const int result = transfer(request);
-        if (result != static_cast<ssize_t>(bulkTransferSize)) {
-            // Cannot recover writing error.
-            ALOGE("Found an error while write data to MtpDevice.");
-            return -1;
+        if (usb_request_queue(request)) {
+            ALOGE("usb_request_queue failed, errno: %d", errno);
+            transferError = true;
+            break;
         }
+        pendingTransferSize = bulkTransferSize;
 
         // Update variables.
         processedBytes += bulkTransferSize;
+        buffer = (buffer == mBuffer) ? spareBuffer : mBuffer;
+    }
+
+    if (pendingTransferSize > 0
+            && readDataWait(request->dev) != static_cast<ssize_t>(pendingTransferSize)) {
+        transferError = true;
+    }
+    request->buffer = mBuffer;
+    free(spareBuffer);
+
+    if (transferError) {
+        // Cannot recover writing error.
+        ALOGE("Found an error while write data to MtpDevice.");
+        return -1;
     }
 
     return readError ? -1 : processedBytes;
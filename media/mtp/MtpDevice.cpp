@@ -212,7 +212,7 @@ MtpDevice::MtpDevice(struct usb_device* device, int interface,
     :   mDevice(device),
         mInterface(interface),
         mRequestIn1(NULL),
-        mRequestIn2(NULL),
+        mDataBuffersIn(NULL),
         mRequestOut(NULL),
         mRequestIntr(NULL),
         mDeviceInfo(NULL),
@@ -226,7 +226,14 @@ MtpDevice::MtpDevice(struct usb_device* device, int interface,
         mPacketDivisionMode(FIRST_PACKET_HAS_PAYLOAD)
 {
     mRequestIn1 = usb_request_new(device, ep_in);
-    mRequestIn2 = usb_request_new(device, ep_in);
+    // USB reads greater than 16K don't work.
+    mDataBuffersIn = (char*)malloc(kDataRequestCount * MTP_BUFFER_SIZE);
+    for (int i = 0; i < kDataRequestCount; i++) {
+        mDataRequestsIn[i] = usb_request_new(device, ep_in);
+        if (mDataRequestsIn[i] && mDataBuffersIn) {
+            mDataRequestsIn[i]->buffer = mDataBuffersIn + i * MTP_BUFFER_SIZE;
+        }
+    }
     mRequestOut = usb_request_new(device, ep_out);
     mRequestIntr = usb_request_new(device, ep_intr);
 }
@@ -236,7 +243,9 @@ MtpDevice::~MtpDevice() {
     for (size_t i = 0; i < mDeviceProperties.size(); i++)
         delete mDeviceProperties[i];
     usb_request_free(mRequestIn1);
-    usb_request_free(mRequestIn2);
+    for (int i = 0; i < kDataRequestCount; i++)
+        usb_request_free(mDataRequestsIn[i]);
+    free(mDataBuffersIn);
     usb_request_free(mRequestOut);
     usb_request_free(mRequestIntr);
 }
@@ -737,48 +746,53 @@ bool MtpDevice::readData(ReadObjectCallback callback,
         }
     }
 
-    // USB reads greater than 16K don't work.
-    char buffer1[MTP_BUFFER_SIZE], buffer2[MTP_BUFFER_SIZE];
-    mRequestIn1->buffer = buffer1;
-    mRequestIn2->buffer = buffer2;
-    struct usb_request* req = NULL;
+    if (!mDataBuffersIn) {
+        ALOGE("no buffers to read data");
+        return false;
+    }
 
-    while (offset < length) {
-        // Wait for previous read to complete.
-        void* writeBuffer = NULL;
-        int writeLength = 0;
-        if (req) {
-            const int read = mData.readDataWait(mDevice);
-            if (read < 0) {
-                ALOGE("readDataWait failed.");
-                return false;
-            }
-            writeBuffer = req->buffer;
-            writeLength = read;
-        }
+    // Keep several reads queued, so that the next chunk is already being transferred while
+    // the previous one is written out to |callback|. Bulk requests on an endpoint complete in
+    // the order they were queued.
+    uint32_t queuedOffset = offset;
+    int first = 0;
+    int queued = 0;
 
-        // Request to read next chunk.
-        const uint32_t nextOffset = offset + writeLength;
-        if (nextOffset < length) {
-            // Queue up a read request.
-            const size_t remaining = length - nextOffset;
-            req = (req == mRequestIn1 ? mRequestIn2 : mRequestIn1);
+    while (offset < length) {
+        while (queued < kDataRequestCount && queuedOffset < length) {
+            struct usb_request* const req = mDataRequestsIn[(first + queued) % kDataRequestCount];
+            const size_t remaining = length - queuedOffset;
             req->buffer_length = remaining > MTP_BUFFER_SIZE ?
                     static_cast<size_t>(MTP_BUFFER_SIZE) : remaining;
             if (mData.readDataAsync(req) != 0) {
                 ALOGE("readDataAsync failed");
+                cancelDataRequests(first, queued);
                 return false;
             }
+            queuedOffset += req->buffer_length;
+            queued++;
+        }
+
+        struct usb_request* const req = mDataRequestsIn[first];
+        const int read = mData.readDataWait(mDevice);
+        first = (first + 1) % kDataRequestCount;
+        queued--;
+        if (read < 0) {
+            ALOGE("readDataWait failed.");
+            cancelDataRequests(first, queued);
+            return false;
         }
+        // a short read ends the transfer early, the requests queued after it continue
+        // from where it stopped
+        queuedOffset -= req->buffer_length - read;
 
-        // Write previous buffer.
-        if (writeBuffer && !writingError) {
-            if (!callback(writeBuffer, offset, writeLength, clientData)) {
+        if (!writingError && read > 0) {
+            if (!callback(req->buffer, offset, read, clientData)) {
                 ALOGE("write failed");
                 writingError = true;
             }
         }
-        offset = nextOffset;
+        offset += read;
     }
 
     if (writtenSize) {
@@ -833,6 +847,13 @@ bool MtpDevice::readPartialObject64(MtpObjectHandle handle,
     return readData(callback, nullptr /* expected size */, writtenSize, clientData);
 }
 
+void MtpDevice::cancelDataRequests(int first, int count) {
+    for (int i = 0; i < count; i++)
+        usb_request_cancel(mDataRequestsIn[(first + i) % kDataRequestCount]);
+    for (int i = 0; i < count; i++)
+        mData.readDataWait(mDevice);
+}
+
 bool MtpDevice::sendRequest(MtpOperationCode operation) {
     ALOGV("sendRequest: %s\n", MtpDebug::getOperationCodeName(operation));
     mReceivedResponse = false;
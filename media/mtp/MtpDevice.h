@@ -41,7 +41,10 @@ private:
     struct usb_device*      mDevice;
     int                     mInterface;
     struct usb_request*     mRequestIn1;
-    struct usb_request*     mRequestIn2;
+    // bulk in requests kept queued together while reading object data
+    static const int        kDataRequestCount = 4;
+    struct usb_request*     mDataRequestsIn[kDataRequestCount];
+    char*                   mDataBuffersIn;
     struct usb_request*     mRequestOut;
     struct usb_request*     mRequestIntr;
     MtpDeviceInfo*          mDeviceInfo;
@@ -159,6 +162,8 @@ private:
                                      const uint32_t* objectSize,
                                      uint32_t* writtenData,
                                      void* clientData);
+    // Cancels and reaps |count| queued data requests starting at index |first|.
+    void                    cancelDataRequests(int first, int count);
     bool                    sendRequest(MtpOperationCode operation);
     bool                    sendData();
     bool                    readData();
@@ -48,13 +48,21 @@ MtpPacket::~MtpPacket() {
 
 void MtpPacket::reset() {
     allocate(MTP_CONTAINER_HEADER_SIZE);
+    // only clear what the last packet used, a buffer grown by a large packet stays allocated
+    // but does not need to be cleared again for every small one
+    size_t clearSize = mPacketSize > mAllocationIncrement ? mPacketSize : mAllocationIncrement;
+    if (clearSize > mBufferSize)
+        clearSize = mBufferSize;
+    memset(mBuffer, 0, clearSize);
     mPacketSize = MTP_CONTAINER_HEADER_SIZE;
-    memset(mBuffer, 0, mBufferSize);
 }
 
 void MtpPacket::allocate(size_t length) {
     if (length > mBufferSize) {
-        int newLength = length + mAllocationIncrement;
+        // grow geometrically so that packets built one field at a time are copied O(log n) times
+        size_t newLength = length + mAllocationIncrement;
+        if (newLength < mBufferSize * 2)
+            newLength = mBufferSize * 2;
         mBuffer = (uint8_t *)realloc(mBuffer, newLength);
         if (!mBuffer) {
             ALOGE("out of memory!");
@@ -109,11 +109,16 @@ MtpServer::MtpServer(int fd, MtpDatabase* database, bool ptp,
         mSessionOpen(false),
         mSendObjectHandle(kInvalidObjectHandle),
         mSendObjectFormat(0),
-        mSendObjectFileSize(0)
+        mSendObjectFileSize(0),
+        mCachedHandles(NULL),
+        mCachedStorageID(0),
+        mCachedFormat(0),
+        mCachedParent(0)
 {
 }
 
 MtpServer::~MtpServer() {
+    invalidateObjectCache();
 }
 
 void MtpServer::addStorage(MtpStorage* storage) {
@@ -246,21 +251,25 @@ void MtpServer::run() {
 
 void MtpServer::sendObjectAdded(MtpObjectHandle handle) {
     ALOGV("sendObjectAdded %d\n", handle);
+    invalidateObjectCache();
     sendEvent(MTP_EVENT_OBJECT_ADDED, handle);
 }
 
 void MtpServer::sendObjectRemoved(MtpObjectHandle handle) {
     ALOGV("sendObjectRemoved %d\n", handle);
+    invalidateObjectCache();
     sendEvent(MTP_EVENT_OBJECT_REMOVED, handle);
 }
 
 void MtpServer::sendStoreAdded(MtpStorageID id) {
     ALOGV("sendStoreAdded %08X\n", id);
+    invalidateObjectCache();
     sendEvent(MTP_EVENT_STORE_ADDED, id);
 }
 
 void MtpServer::sendStoreRemoved(MtpStorageID id) {
     ALOGV("sendStoreRemoved %08X\n", id);
+    invalidateObjectCache();
     sendEvent(MTP_EVENT_STORE_REMOVED, id);
 }
 
@@ -279,6 +288,32 @@ void MtpServer::sendEvent(MtpEventCode code, uint32_t param1) {
     }
 }
 
+void MtpServer::invalidateObjectCache() {
+    Mutex::Autolock autoLock(mObjectCacheLock);
+    delete mCachedHandles;
+    mCachedHandles = NULL;
+}
+
+MtpObjectHandleList* MtpServer::getCachedObjectList(MtpStorageID storageID,
+        MtpObjectFormat format, MtpObjectHandle parent) {
+    Mutex::Autolock autoLock(mObjectCacheLock);
+    if (!mCachedHandles || mCachedStorageID != storageID || mCachedFormat != format
+            || mCachedParent != parent) {
+        return NULL;
+    }
+    return new MtpObjectHandleList(*mCachedHandles);
+}
+
+void MtpServer::setCachedObjectList(MtpStorageID storageID, MtpObjectFormat format,
+        MtpObjectHandle parent, const MtpObjectHandleList* handles) {
+    Mutex::Autolock autoLock(mObjectCacheLock);
+    delete mCachedHandles;
+    mCachedHandles = handles ? new MtpObjectHandleList(*handles) : NULL;
+    mCachedStorageID = storageID;
+    mCachedFormat = format;
+    mCachedParent = parent;
+}
+
 void MtpServer::addEditObject(MtpObjectHandle handle, MtpString& path,
         uint64_t size, MtpObjectFormat format, int fd) {
     ObjectEdit*  edit = new ObjectEdit(handle, path, size, format, fd);
@@ -334,6 +369,21 @@ bool MtpServer::handleRequest() {
 
     ALOGV("got command %s (%x)", MtpDebug::getOperationCodeName(operation), operation);
 
+    switch (operation) {
+        case MTP_OPERATION_OPEN_SESSION:
+        case MTP_OPERATION_CLOSE_SESSION:
+        case MTP_OPERATION_SET_OBJECT_REFERENCES:
+        case MTP_OPERATION_SET_OBJECT_PROP_VALUE:
+        case MTP_OPERATION_SEND_OBJECT_INFO:
+        case MTP_OPERATION_SEND_OBJECT:
+        case MTP_OPERATION_DELETE_OBJECT:
+            // may add, remove or move objects
+            invalidateObjectCache();
+            break;
+        default:
+            break;
+    }
+
     switch (operation) {
         case MTP_OPERATION_GET_DEVICE_INFO:
             response = doGetDeviceInfo();
@@ -579,7 +629,11 @@ MtpResponseCode MtpServer::doGetObjectHandles() {
     if (!hasStorage(storageID))
         return MTP_RESPONSE_INVALID_STORAGE_ID;
 
-    MtpObjectHandleList* handles = mDatabase->getObjectList(storageID, format, parent);
+    MtpObjectHandleList* handles = getCachedObjectList(storageID, format, parent);
+    if (!handles) {
+        handles = mDatabase->getObjectList(storageID, format, parent);
+        setCachedObjectList(storageID, format, parent, handles);
+    }
     mData.putAUInt32(handles);
     delete handles;
     return MTP_RESPONSE_OK;
@@ -597,7 +651,14 @@ MtpResponseCode MtpServer::doGetNumObjects() {
     if (!hasStorage(storageID))
         return MTP_RESPONSE_INVALID_STORAGE_ID;
 
-    int count = mDatabase->getNumObjects(storageID, format, parent);
+    int count;
+    MtpObjectHandleList* handles = getCachedObjectList(storageID, format, parent);
+    if (handles) {
+        count = handles->size();
+        delete handles;
+    } else {
+        count = mDatabase->getNumObjects(storageID, format, parent);
+    }
     if (count >= 0) {
         mResponse.setParameter(1, count);
         return MTP_RESPONSE_OK;
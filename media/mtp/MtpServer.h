@@ -68,6 +68,14 @@ private:
 
     Mutex               mMutex;
 
+    // handles returned by the last GetObjectHandles, reused by GetNumObjects and repeated
+    // queries for the same storage, format and parent until an object is added or removed
+    Mutex               mObjectCacheLock;
+    MtpObjectHandleList* mCachedHandles;
+    MtpStorageID        mCachedStorageID;
+    MtpObjectFormat     mCachedFormat;
+    MtpObjectHandle     mCachedParent;
+
     // represents an MTP object that is being edited using the android extensions
     // for direct editing (BeginEditObject, SendPartialObject, TruncateObject and EndEditObject)
     class ObjectEdit {
@@ -111,6 +119,13 @@ private:
     void                sendStoreRemoved(MtpStorageID id);
     void                sendEvent(MtpEventCode code, uint32_t param1);
 
+    void                invalidateObjectCache();
+    // returns a copy of the cached handle list for the query, or NULL
+    MtpObjectHandleList* getCachedObjectList(MtpStorageID storageID, MtpObjectFormat format,
+                                MtpObjectHandle parent);
+    void                setCachedObjectList(MtpStorageID storageID, MtpObjectFormat format,
+                                MtpObjectHandle parent, const MtpObjectHandleList* handles);
+
     void                addEditObject(MtpObjectHandle handle, MtpString& path,
                                 uint64_t size, MtpObjectFormat format, int fd);
     ObjectEdit*         getEditObject(MtpObjectHandle handle);
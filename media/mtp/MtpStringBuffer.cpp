@@ -154,10 +154,25 @@ bool MtpStringBuffer::readFromPacket(MtpDataPacket* packet) {
 void MtpStringBuffer::writeToPacket(MtpDataPacket* packet) const {
     int count = mCharCount;
     const uint8_t* src = mBuffer;
-    packet->putUInt8(count > 0 ? count + 1 : 0);
+    uint16_t chars[MTP_STRING_MAX_CHARACTER_NUMBER + 1];
+
+    // expand utf8 to 16 bit chars, then hand the whole string to the packet
+    int i = 0;
+    while (i < count) {
+        // file names are mostly ascii, widen four characters at a time while they are
+        if (i + 4 <= count) {
+            uint32_t word;
+            memcpy(&word, src, sizeof(word));
+            if ((word & 0x80808080) == 0) {
+                chars[i++] = src[0];
+                chars[i++] = src[1];
+                chars[i++] = src[2];
+                chars[i++] = src[3];
+                src += 4;
+                continue;
+            }
+        }
 
-    // expand utf8 to 16 bit chars
-    for (int i = 0; i < count; i++) {
         uint16_t ch;
         uint16_t ch1 = *src++;
         if ((ch1 & 0x80) == 0) {
@@ -173,11 +188,10 @@ void MtpStringBuffer::writeToPacket(MtpDataPacket* packet) const {
             uint16_t ch3 = *src++;
             ch = ((ch1 & 0x0F) << 12) | ((ch2 & 0x3F) << 6) | (ch3 & 0x3F);
         }
-        packet->putUInt16(ch);
+        chars[i++] = ch;
     }
-    // only terminate with zero if string is not empty
-    if (count > 0)
-        packet->putUInt16(0);
+    chars[count] = 0;
+    packet->putString(chars);
 }
 
 }  // namespace android
@@ -17,6 +17,12 @@
 #define LOG_TAG "SchedulingPolicyService"
 //#define LOG_NDEBUG 0
 
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 #include <binder/IServiceManager.h>
 #include <utils/Mutex.h>
 #include "ISchedulingPolicyService.h"
@@ -59,4 +65,45 @@ int requestPriority(pid_t pid, pid_t tid, int32_t prio, bool asynchronous)
     return ret;
 }
 
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+// Not declared by the C library, see include/uapi/linux/sched/types.h in the kernel sources.
+struct sched_attr_deadline {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t  sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+};
+
+int requestDeadline(pid_t tid, int64_t runtimeNs, int64_t deadlineNs, int64_t periodNs)
+{
+    if (runtimeNs <= 0 || runtimeNs > deadlineNs || deadlineNs > periodNs) {
+        return -EINVAL;
+    }
+#ifdef __NR_sched_setattr
+    struct sched_attr_deadline attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.sched_policy = SCHED_DEADLINE;
+    attr.sched_runtime = runtimeNs;
+    attr.sched_deadline = deadlineNs;
+    attr.sched_period = periodNs;
+    if (syscall(__NR_sched_setattr, tid, &attr, 0 /*flags*/) != 0) {
+        const int err = errno;
+        ALOGV("sched_setattr SCHED_DEADLINE for tid %d failed: %s", tid, strerror(err));
+        return -err;
+    }
+    return 0;
+#else
+    (void) tid;
+    return -ENOSYS;
+#endif
+}
+
 }   // namespace android
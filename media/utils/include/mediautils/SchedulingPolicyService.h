@@ -26,6 +26,16 @@ namespace android {
 // The default value 'false' means to return after request has been enqueued and executed.
 int requestPriority(pid_t pid, pid_t tid, int32_t prio, bool asynchronous = false);
 
+// Request the SCHED_DEADLINE policy for thread tid of the calling process, with a CPU budget of
+// runtimeNs to be consumed within deadlineNs of the start of each periodNs.
+// The scheduling policy service has no deadline request, so this is applied directly with
+// sched_setattr() and requires the caller to have CAP_SYS_NICE.
+// Returns 0 on success, or a negative errno such as -ENOSYS if the kernel has no SCHED_DEADLINE,
+// -EPERM if not permitted, or -EBUSY if admission control rejected the reservation.
+// On failure the thread's policy is unchanged and the caller should fall back to
+// requestPriority().
+int requestDeadline(pid_t tid, int64_t runtimeNs, int64_t deadlineNs, int64_t periodNs);
+
 }   // namespace android
 
 #endif  // _ANDROID_SCHEDULING_POLICY_SERVICE_H
@@ -30,8 +30,12 @@ LOCAL_SRC_FILES:=               \
     Effects.cpp                 \
     AudioMixer.cpp.arm          \
     BufferProviders.cpp         \
+    ClientHeap.cpp              \
     PatchPanel.cpp              \
-    StateQueue.cpp
+    StateQueue.cpp              \
+    TimeStretcher.cpp           \
+    WorkerPool.cpp              \
+    MemoryPrefaulter.cpp
 
 LOCAL_C_INCLUDES := \
     $(TOPDIR)frameworks/av/services/audiopolicy \
@@ -247,6 +247,10 @@ void AudioFlinger::onFirstRef()
 
     mPatchPanel = new PatchPanel(this);
 
+    if (property_get_bool("af.track.prefault", true /* default_value */)) {
+        mPrefaulter = new MemoryPrefaulter();
+    }
+
     mMode = AUDIO_MODE_NORMAL;
 }
 
@@ -279,6 +283,19 @@ AudioFlinger::~AudioFlinger()
             }
         }
     }
+
+    if (mPrefaulter != 0) {
+        // requestExit() wakes the thread, requestExitAndWait() alone would not
+        mPrefaulter->requestExit();
+        mPrefaulter->requestExitAndWait();
+    }
+}
+
+void AudioFlinger::prefaultMemory(const sp<IMemory>& memory)
+{
+    if (mPrefaulter != 0) {
+        mPrefaulter->prefault(memory);
+    }
 }
 
 static const char * const audio_interfaces[] = {
@@ -330,6 +347,7 @@ void AudioFlinger::dumpClients(int fd, const Vector<String16>& args __unused)
         if (client != 0) {
             snprintf(buffer, SIZE, "  pid: %d\n", client->pid());
             result.append(buffer);
+            client->heap()->dump(result, "    ");
         }
     }
 
@@ -362,6 +380,10 @@ void AudioFlinger::dumpInternals(int fd, const Vector<String16>& args __unused)
                             hardwareStatus,
                             (uint32_t)(mStandbyTimeInNsecs / 1000000));
     result.append(buffer);
+    if (mPrefaulter != 0) {
+        result.appendFormat("Prefaulted track pages: %llu\n",
+                (unsigned long long) mPrefaulter->pagesTouched());
+    }
     write(fd, result.string(), result.size());
 }
 
@@ -438,6 +460,8 @@ status_t AudioFlinger::dump(int fd, const Vector<String16>& args)
             mRecordThreads.valueAt(i)->dump(fd, args);
         }
 
+        dumpUidMixerUsage(fd);
+
         // dump orphan effect chains
         if (mOrphanEffectChains.size() != 0) {
             write(fd, "  Orphan Effect Chains\n", strlen("  Orphan Effect Chains\n"));
@@ -592,7 +616,6 @@ sp<IAudioTrack> AudioFlinger::createTrack(
     sp<TrackHandle> trackHandle;
     sp<Client> client;
     status_t lStatus;
-    audio_session_t lSessionId;
 
     const uid_t callingUid = IPCThreadState::self()->getCallingUid();
     if (pid == -1 || !isTrustedCallingUid(callingUid)) {
@@ -603,132 +626,244 @@ sp<IAudioTrack> AudioFlinger::createTrack(
         pid = callingPid;
     }
 
+    {
+        Mutex::Autolock _l(mLock);
+        track = createPlaybackTrack_l(client, pid, streamType, sampleRate, format, channelMask,
+                frameCount, flags, sharedBuffer, output, tid, sessionId, clientUid,
+                NULL /*playbackThread*/, &lStatus);
+    }
+
+    if (lStatus != NO_ERROR) {
+        // remove local strong reference to Client before deleting the Track so that the
+        // Client destructor is called by the TrackBase destructor with mClientLock held
+        // Don't hold mClientLock when releasing the reference on the track as the
+        // destructor will acquire it.
+        {
+            Mutex::Autolock _cl(mClientLock);
+            client.clear();
+        }
+        track.clear();
+        goto Exit;
+    }
+
+    // return handle to client
+    trackHandle = new TrackHandle(track);
+
+Exit:
+    *status = lStatus;
+    return trackHandle;
+}
+
+status_t AudioFlinger::createTracks(Vector<AudioTrackCreateArgs>& args,
+                                    pid_t pid,
+                                    int clientUid,
+                                    bool start)
+{
+    if (args.isEmpty() || args.size() > kMaxCreateTracks) {
+        return BAD_VALUE;
+    }
+
+    const uid_t callingUid = IPCThreadState::self()->getCallingUid();
+    if (pid == -1 || !isTrustedCallingUid(callingUid)) {
+        const pid_t callingPid = IPCThreadState::self()->getCallingPid();
+        ALOGW_IF(pid != -1 && pid != callingPid,
+                 "%s uid %d pid %d tried to pass itself off as pid %d",
+                 __func__, callingUid, callingPid, pid);
+        pid = callingPid;
+    }
+
+    sp<Client> client;
+    Vector< sp<PlaybackThread::Track> > tracks;
+    Vector< sp<PlaybackThread> > threads;
+    {
+        Mutex::Autolock _l(mLock);
+        for (size_t i = 0; i < args.size(); i++) {
+            AudioTrackCreateArgs& arg = args.editItemAt(i);
+            sp<PlaybackThread> thread;
+            sp<PlaybackThread::Track> track = createPlaybackTrack_l(client, pid,
+                    arg.mStreamType, arg.mSampleRate, arg.mFormat, arg.mChannelMask,
+                    &arg.mFrameCount, &arg.mFlags, arg.mSharedBuffer, arg.mOutput, arg.mTid,
+                    &arg.mSessionId, clientUid, &thread, &arg.mStatus);
+            tracks.add(track);
+            threads.add(thread);
+        }
+    }
+
+    // as in createTrack(), release the Client before the tracks that failed
+    {
+        Mutex::Autolock _cl(mClientLock);
+        client.clear();
+    }
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i].mStatus != NO_ERROR) {
+            tracks.editItemAt(i).clear();
+            threads.editItemAt(i).clear();
+        }
+    }
+
+    if (start) {
+        // start the tracks of each playback thread together, so they share a mix cycle
+        for (size_t i = 0; i < args.size(); i++) {
+            if (threads[i] == 0) {
+                continue;
+            }
+            const sp<PlaybackThread> thread = threads[i];
+            Vector<size_t> indices;
+            Vector< sp<PlaybackThread::Track> > threadTracks;
+            for (size_t j = i; j < args.size(); j++) {
+                if (threads[j] == thread) {
+                    indices.add(j);
+                    threadTracks.add(tracks[j]);
+                    threads.editItemAt(j).clear();
+                }
+            }
+            Vector<status_t> statuses;
+            thread->startTracks(threadTracks, statuses);
+            for (size_t k = 0; k < indices.size(); k++) {
+                args.editItemAt(indices[k]).mStartStatus = statuses[k];
+            }
+        }
+    }
+
+    for (size_t i = 0; i < args.size(); i++) {
+        if (tracks[i] != 0) {
+            args.editItemAt(i).mTrack = new TrackHandle(tracks[i]);
+        }
+    }
+    return NO_ERROR;
+}
+
+// createPlaybackTrack_l() must be called with AudioFlinger::mLock held
+sp<AudioFlinger::PlaybackThread::Track> AudioFlinger::createPlaybackTrack_l(
+        sp<Client>& client,
+        pid_t pid,
+        audio_stream_type_t streamType,
+        uint32_t sampleRate,
+        audio_format_t format,
+        audio_channel_mask_t channelMask,
+        size_t *frameCount,
+        audio_output_flags_t *flags,
+        const sp<IMemory>& sharedBuffer,
+        audio_io_handle_t output,
+        pid_t tid,
+        audio_session_t *sessionId,
+        int clientUid,
+        sp<PlaybackThread> *playbackThread,
+        status_t *status)
+{
+    sp<PlaybackThread::Track> track;
+    audio_session_t lSessionId;
+
     // client AudioTrack::set already implements AUDIO_STREAM_DEFAULT => AUDIO_STREAM_MUSIC,
     // but if someone uses binder directly they could bypass that and cause us to crash
     if (uint32_t(streamType) >= AUDIO_STREAM_CNT) {
         ALOGE("createTrack() invalid stream type %d", streamType);
-        lStatus = BAD_VALUE;
-        goto Exit;
+        *status = BAD_VALUE;
+        return track;
     }
 
     // further sample rate checks are performed by createTrack_l() depending on the thread type
     if (sampleRate == 0) {
         ALOGE("createTrack() invalid sample rate %u", sampleRate);
-        lStatus = BAD_VALUE;
-        goto Exit;
+        *status = BAD_VALUE;
+        return track;
     }
 
     // further channel mask checks are performed by createTrack_l() depending on the thread type
     if (!audio_is_output_channel(channelMask)) {
         ALOGE("createTrack() invalid channel mask %#x", channelMask);
-        lStatus = BAD_VALUE;
-        goto Exit;
+        *status = BAD_VALUE;
+        return track;
     }
 
     // further format checks are performed by createTrack_l() depending on the thread type
     if (!audio_is_valid_format(format)) {
         ALOGE("createTrack() invalid format %#x", format);
-        lStatus = BAD_VALUE;
-        goto Exit;
+        *status = BAD_VALUE;
+        return track;
     }
 
     if (sharedBuffer != 0 && sharedBuffer->pointer() == NULL) {
         ALOGE("createTrack() sharedBuffer is non-0 but has NULL pointer()");
-        lStatus = BAD_VALUE;
-        goto Exit;
+        *status = BAD_VALUE;
+        return track;
     }
 
-    {
-        Mutex::Autolock _l(mLock);
-        PlaybackThread *thread = checkPlaybackThread_l(output);
-        if (thread == NULL) {
-            ALOGE("no playback thread found for output handle %d", output);
-            lStatus = BAD_VALUE;
-            goto Exit;
-        }
+    PlaybackThread *thread = checkPlaybackThread_l(output);
+    if (thread == NULL) {
+        ALOGE("no playback thread found for output handle %d", output);
+        *status = BAD_VALUE;
+        return track;
+    }
 
+    if (client == 0) {
         client = registerPid(pid);
+    }
 
-        PlaybackThread *effectThread = NULL;
-        if (sessionId != NULL && *sessionId != AUDIO_SESSION_ALLOCATE) {
-            if (audio_unique_id_get_use(*sessionId) != AUDIO_UNIQUE_ID_USE_SESSION) {
-                ALOGE("createTrack() invalid session ID %d", *sessionId);
-                lStatus = BAD_VALUE;
-                goto Exit;
-            }
-            lSessionId = *sessionId;
-            // check if an effect chain with the same session ID is present on another
-            // output thread and move it here.
-            for (size_t i = 0; i < mPlaybackThreads.size(); i++) {
-                sp<PlaybackThread> t = mPlaybackThreads.valueAt(i);
-                if (mPlaybackThreads.keyAt(i) != output) {
-                    uint32_t sessions = t->hasAudioSession(lSessionId);
-                    if (sessions & ThreadBase::EFFECT_SESSION) {
-                        effectThread = t.get();
-                        break;
-                    }
+    PlaybackThread *effectThread = NULL;
+    if (sessionId != NULL && *sessionId != AUDIO_SESSION_ALLOCATE) {
+        if (audio_unique_id_get_use(*sessionId) != AUDIO_UNIQUE_ID_USE_SESSION) {
+            ALOGE("createTrack() invalid session ID %d", *sessionId);
+            *status = BAD_VALUE;
+            return track;
+        }
+        lSessionId = *sessionId;
+        // check if an effect chain with the same session ID is present on another
+        // output thread and move it here.
+        for (size_t i = 0; i < mPlaybackThreads.size(); i++) {
+            sp<PlaybackThread> t = mPlaybackThreads.valueAt(i);
+            if (mPlaybackThreads.keyAt(i) != output) {
+                uint32_t sessions = t->hasAudioSession(lSessionId);
+                if (sessions & ThreadBase::EFFECT_SESSION) {
+                    effectThread = t.get();
+                    break;
                 }
             }
-        } else {
-            // if no audio session id is provided, create one here
-            lSessionId = (audio_session_t) nextUniqueId(AUDIO_UNIQUE_ID_USE_SESSION);
-            if (sessionId != NULL) {
-                *sessionId = lSessionId;
-            }
         }
-        ALOGV("createTrack() lSessionId: %d", lSessionId);
-
-        track = thread->createTrack_l(client, streamType, sampleRate, format,
-                channelMask, frameCount, sharedBuffer, lSessionId, flags, tid, clientUid, &lStatus);
-        LOG_ALWAYS_FATAL_IF((lStatus == NO_ERROR) && (track == 0));
-        // we don't abort yet if lStatus != NO_ERROR; there is still work to be done regardless
-
-        // move effect chain to this output thread if an effect on same session was waiting
-        // for a track to be created
-        if (lStatus == NO_ERROR && effectThread != NULL) {
-            // no risk of deadlock because AudioFlinger::mLock is held
-            Mutex::Autolock _dl(thread->mLock);
-            Mutex::Autolock _sl(effectThread->mLock);
-            moveEffectChain_l(lSessionId, effectThread, thread, true);
-        }
-
-        // Look for sync events awaiting for a session to be used.
-        for (size_t i = 0; i < mPendingSyncEvents.size(); i++) {
-            if (mPendingSyncEvents[i]->triggerSession() == lSessionId) {
-                if (thread->isValidSyncEvent(mPendingSyncEvents[i])) {
-                    if (lStatus == NO_ERROR) {
-                        (void) track->setSyncEvent(mPendingSyncEvents[i]);
-                    } else {
-                        mPendingSyncEvents[i]->cancel();
-                    }
-                    mPendingSyncEvents.removeAt(i);
-                    i--;
+    } else {
+        // if no audio session id is provided, create one here
+        lSessionId = (audio_session_t) nextUniqueId(AUDIO_UNIQUE_ID_USE_SESSION);
+        if (sessionId != NULL) {
+            *sessionId = lSessionId;
+        }
+    }
+    ALOGV("createTrack() lSessionId: %d", lSessionId);
+
+    track = thread->createTrack_l(client, streamType, sampleRate, format,
+            channelMask, frameCount, sharedBuffer, lSessionId, flags, tid, clientUid, status);
+    LOG_ALWAYS_FATAL_IF((*status == NO_ERROR) && (track == 0));
+    // we don't abort yet if *status != NO_ERROR; there is still work to be done regardless
+
+    // move effect chain to this output thread if an effect on same session was waiting
+    // for a track to be created
+    if (*status == NO_ERROR && effectThread != NULL) {
+        // no risk of deadlock because AudioFlinger::mLock is held
+        Mutex::Autolock _dl(thread->mLock);
+        Mutex::Autolock _sl(effectThread->mLock);
+        moveEffectChain_l(lSessionId, effectThread, thread, true);
+    }
+
+    // Look for sync events awaiting for a session to be used.
+    for (size_t i = 0; i < mPendingSyncEvents.size(); i++) {
+        if (mPendingSyncEvents[i]->triggerSession() == lSessionId) {
+            if (thread->isValidSyncEvent(mPendingSyncEvents[i])) {
+                if (*status == NO_ERROR) {
+                    (void) track->setSyncEvent(mPendingSyncEvents[i]);
+                } else {
+                    mPendingSyncEvents[i]->cancel();
                 }
+                mPendingSyncEvents.removeAt(i);
+                i--;
             }
         }
-
-        setAudioHwSyncForSession_l(thread, lSessionId);
     }
 
-    if (lStatus != NO_ERROR) {
-        // remove local strong reference to Client before deleting the Track so that the
-        // Client destructor is called by the TrackBase destructor with mClientLock held
-        // Don't hold mClientLock when releasing the reference on the track as the
-        // destructor will acquire it.
-        {
-            Mutex::Autolock _cl(mClientLock);
-            client.clear();
-        }
-        track.clear();
-        goto Exit;
-    }
-
-    // return handle to client
-    trackHandle = new TrackHandle(track);
+    setAudioHwSyncForSession_l(thread, lSessionId);
 
-Exit:
-    *status = lStatus;
-    return trackHandle;
+    if (playbackThread != NULL) {
+        *playbackThread = thread;
+    }
+    return track;
 }
 
 uint32_t AudioFlinger::sampleRate(audio_io_handle_t ioHandle) const
@@ -777,6 +912,19 @@ size_t AudioFlinger::frameCountHAL(audio_io_handle_t ioHandle) const
     return thread->frameCountHAL();
 }
 
+status_t AudioFlinger::prewarmOutput(audio_io_handle_t output)
+{
+    Mutex::Autolock _l(mLock);
+    PlaybackThread *thread = output == AUDIO_IO_HANDLE_NONE ?
+            primaryPlaybackThread_l() : checkPlaybackThread_l(output);
+    if (thread == NULL) {
+        ALOGW("prewarmOutput() unknown thread %d", output);
+        return BAD_VALUE;
+    }
+    thread->prewarm();
+    return NO_ERROR;
+}
+
 uint32_t AudioFlinger::latency(audio_io_handle_t output) const
 {
     Mutex::Autolock _l(mLock);
@@ -1429,7 +1577,7 @@ AudioFlinger::Client::Client(const sp<AudioFlinger>& audioFlinger, pid_t pid)
     if (!audioFlinger->isLowRamDevice()) {
         heapSize *= kClientSharedHeapSizeMultiplier;
     }
-    mMemoryDealer = new MemoryDealer(heapSize, "AudioFlinger::Client");
+    mHeap = new ClientHeap(heapSize, "AudioFlinger::Client");
 }
 
 // Client destructor must be called with AudioFlinger::mClientLock held
@@ -1438,9 +1586,9 @@ AudioFlinger::Client::~Client()
     mAudioFlinger->removeClient_l(mPid);
 }
 
-sp<MemoryDealer> AudioFlinger::Client::heap() const
+sp<ClientHeap> AudioFlinger::Client::heap() const
 {
-    return mMemoryDealer;
+    return mHeap;
 }
 
 // ----------------------------------------------------------------------------
@@ -1803,6 +1951,65 @@ status_t AudioFlinger::systemReady()
     return NO_ERROR;
 }
 
+status_t AudioFlinger::listUidMixerUsage(unsigned int *num_usages,
+                                         struct AudioUidMixerUsage *usages)
+{
+    if (!dumpAllowed()) {
+        return PERMISSION_DENIED;
+    }
+    if (num_usages == NULL || (*num_usages != 0 && usages == NULL)) {
+        return BAD_VALUE;
+    }
+    KeyedVector<uid_t, AudioUidMixerUsage> all;
+    {
+        Mutex::Autolock _l(mLock);
+        getUidMixerUsage_l(all);
+    }
+    unsigned int count = 0;
+    for (; count < *num_usages && count < all.size(); ++count) {
+        usages[count] = all.valueAt(count);
+    }
+    *num_usages = count;
+    return NO_ERROR;
+}
+
+// getUidMixerUsage_l() must be called with AudioFlinger::mLock held
+void AudioFlinger::getUidMixerUsage_l(KeyedVector<uid_t, AudioUidMixerUsage>& usages)
+{
+    for (size_t i = 0; i < mPlaybackThreads.size(); i++) {
+        sp<PlaybackThread> thread = mPlaybackThreads.valueAt(i);
+        Mutex::Autolock _l(thread->mLock);
+        thread->getUidMixerUsage_l(usages);
+    }
+}
+
+void AudioFlinger::dumpUidMixerUsage(int fd)
+{
+    // called from dump() with mLock possibly held; thread locks are only tried
+    KeyedVector<uid_t, AudioUidMixerUsage> usages;
+    for (size_t i = 0; i < mPlaybackThreads.size(); i++) {
+        sp<PlaybackThread> thread = mPlaybackThreads.valueAt(i);
+        const bool locked = dumpTryLock(thread->mLock);
+        thread->getUidMixerUsage_l(usages);
+        if (locked) {
+            thread->mLock.unlock();
+        }
+    }
+    dprintf(fd, "\nMixer usage per uid:\n");
+    if (usages.isEmpty()) {
+        dprintf(fd, "  none\n");
+        return;
+    }
+    dprintf(fd, "    Uid Tracks ResampleMs EffectMs   BytesMixed Underruns Und/s\n");
+    for (size_t i = 0; i < usages.size(); i++) {
+        const AudioUidMixerUsage& usage = usages.valueAt(i);
+        dprintf(fd, "  %5d %6u %10.3f %8.3f %12lld %9u %5.1f\n",
+                usage.mUid, usage.mTrackCount, usage.mResamplerNs * 1e-6,
+                usage.mEffectNs * 1e-6, (long long) usage.mBytesMixed,
+                usage.mUnderruns, usage.mUnderrunsPerSecond);
+    }
+}
+
 // setAudioHwSyncForSession_l() must be called with AudioFlinger::mLock held
 void AudioFlinger::setAudioHwSyncForSession_l(PlaybackThread *thread, audio_session_t sessionId)
 {
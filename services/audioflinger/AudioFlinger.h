@@ -54,10 +54,14 @@
 #include <media/nbaio/NBAIO.h>
 #include "AudioWatchdog.h"
 #include "AudioMixer.h"
+#include "ClientHeap.h"
 #include "AudioStreamOut.h"
 #include "SpdifStreamOut.h"
 #include "AudioHwDevice.h"
 #include "LinearMap.h"
+#include "MemoryPrefaulter.h"
+#include "MpscQueue.h"
+#include "WorkerPool.h"
 
 #include <powermanager/IPowerManager.h>
 
@@ -261,6 +265,16 @@ public:
     /* Indicate JAVA services are ready (scheduling, power management ...) */
     virtual status_t systemReady();
 
+    virtual status_t listUidMixerUsage(unsigned int *num_usages,
+                                       struct AudioUidMixerUsage *usages);
+
+    virtual status_t createTracks(Vector<AudioTrackCreateArgs>& args,
+                                  pid_t pid,
+                                  int clientUid,
+                                  bool start);
+
+    virtual status_t prewarmOutput(audio_io_handle_t output);
+
     virtual     status_t    onTransact(
                                 uint32_t code,
                                 const Parcel& data,
@@ -407,13 +421,17 @@ private:
     void dumpPermissionDenial(int fd, const Vector<String16>& args);
     void dumpClients(int fd, const Vector<String16>& args);
     void dumpInternals(int fd, const Vector<String16>& args);
+    void dumpUidMixerUsage(int fd);
+    // collects the per-uid mixer usage of all playback threads,
+    // must be called with AudioFlinger::mLock held
+    void getUidMixerUsage_l(KeyedVector<uid_t, AudioUidMixerUsage>& usages);
 
     // --- Client ---
     class Client : public RefBase {
     public:
                             Client(const sp<AudioFlinger>& audioFlinger, pid_t pid);
         virtual             ~Client();
-        sp<MemoryDealer>    heap() const;
+        sp<ClientHeap>      heap() const;
         pid_t               pid() const { return mPid; }
         sp<AudioFlinger>    audioFlinger() const { return mAudioFlinger; }
 
@@ -421,7 +439,7 @@ private:
                             Client(const Client&);
                             Client& operator = (const Client&);
         const sp<AudioFlinger> mAudioFlinger;
-              sp<MemoryDealer> mMemoryDealer;
+              sp<ClientHeap> mHeap;
         const pid_t         mPid;
     };
 
@@ -711,6 +729,26 @@ private:
 private:
     sp<Client>  registerPid(pid_t pid);    // always returns non-0
 
+    // Common part of createTrack() and createTracks(), called with mLock held.
+    // client is registered for pid if still 0 and the parameters are valid.
+    // A Track may be returned even if *status != NO_ERROR, see createTrack().
+    sp<PlaybackThread::Track> createPlaybackTrack_l(
+                                sp<Client>& client,
+                                pid_t pid,
+                                audio_stream_type_t streamType,
+                                uint32_t sampleRate,
+                                audio_format_t format,
+                                audio_channel_mask_t channelMask,
+                                size_t *frameCount,
+                                audio_output_flags_t *flags,
+                                const sp<IMemory>& sharedBuffer,
+                                audio_io_handle_t output,
+                                pid_t tid,
+                                audio_session_t *sessionId,
+                                int clientUid,
+                                sp<PlaybackThread> *playbackThread,
+                                status_t *status /*non-NULL*/);
+
     // for use from destructor
     status_t    closeOutput_nonvirtual(audio_io_handle_t output);
     void        closeOutputInternal_l(sp<PlaybackThread> thread);
@@ -755,6 +793,10 @@ public:
     // The reason we don't want to take mLock is because it could block the caller for a long time.
     bool    isLowRamDevice() const { return mIsLowRamDevice; }
 
+    // Queues client shared memory that a mixer thread is about to read to mPrefaulter,
+    // if prefaulting is enabled by property af.track.prefault.
+    void    prefaultMemory(const sp<IMemory>& memory);
+
 private:
     bool    mIsLowRamDevice;
     bool    mIsDeviceTypeKnown;
@@ -762,6 +804,8 @@ private:
 
     sp<PatchPanel> mPatchPanel;
 
+    sp<MemoryPrefaulter> mPrefaulter;   // set by onFirstRef(), then constant
+
     bool        mSystemReady;
 };
 
@@ -27,6 +27,7 @@
 
 #include <utils/Errors.h>
 #include <utils/Log.h>
+#include <utils/Timers.h>
 
 #include <cutils/bitops.h>
 #include <cutils/compiler.h>
@@ -38,6 +39,7 @@
 #include <audio_utils/format.h>
 
 #include "AudioMixerOps.h"
+#include "AudioMixerOpsSimd.h"
 #include "AudioMixer.h"
 
 // The FCC_2 macro refers to the Fixed Channel Count of 2 for the legacy integer mixer.
@@ -100,7 +102,7 @@ T min(const T& a, const T& b)
 
 AudioMixer::AudioMixer(size_t frameCount, uint32_t sampleRate, uint32_t maxNumTracks)
     :   mTrackNames(0), mConfiguredNames((maxNumTracks >= 32 ? 0 : 1 << maxNumTracks) - 1),
-        mSampleRate(sampleRate)
+        mSampleRate(sampleRate), mInUpdate(false), mPendingChanges(0)
 {
     ALOG_ASSERT(maxNumTracks <= MAX_NUM_TRACKS, "maxNumTracks %u > MAX_NUM_TRACKS %u",
             maxNumTracks, MAX_NUM_TRACKS);
@@ -117,6 +119,7 @@ AudioMixer::AudioMixer(size_t frameCount, uint32_t sampleRate, uint32_t maxNumTr
     mState.outputTemp   = NULL;
     mState.resampleTemp = NULL;
     mState.mLog         = &mDummyLog;
+    mState.numOutputGroups = 0;
     // mState.reserved
 
     // FIXME Most of the following initialization is probably redundant since
@@ -228,6 +231,7 @@ int AudioMixer::getTrackName(audio_channel_mask_t channelMask,
                 AUDIO_CHANNEL_REPRESENTATION_POSITION, AUDIO_CHANNEL_OUT_STEREO);
         t->mMixerChannelCount = audio_channel_count_from_out_mask(t->mMixerChannelMask);
         t->mPlaybackRate = AUDIO_PLAYBACK_RATE_DEFAULT;
+        t->mResampleNs = 0;
         // Check the downmixing (or upmixing) requirements.
         status_t status = t->prepareForDownmix();
         if (status != OK) {
@@ -246,12 +250,29 @@ int AudioMixer::getTrackName(audio_channel_mask_t channelMask,
 
 void AudioMixer::invalidateState(uint32_t mask)
 {
-    if (mask != 0) {
+    if (mInUpdate) {
+        mPendingChanges |= mask;
+    } else if (mask != 0) {
         mState.needsChanged |= mask;
         mState.hook = process__validate;
     }
  }
 
+void AudioMixer::beginUpdate()
+{
+    ALOG_ASSERT(!mInUpdate, "beginUpdate() called twice");
+    mInUpdate = true;
+    mPendingChanges = 0;
+}
+
+void AudioMixer::commitUpdate()
+{
+    ALOG_ASSERT(mInUpdate, "commitUpdate() without beginUpdate()");
+    mInUpdate = false;
+    invalidateState(mPendingChanges);
+    mPendingChanges = 0;
+}
+
 // Called when channel masks have changed for a track name
 // TODO: Fix DownmixerBufferProvider not to (possibly) change mixer input format,
 // which will simplify this logic.
@@ -329,6 +350,14 @@ status_t AudioMixer::track_t::prepareForDownmix()
                     && mMixerChannelMask == AUDIO_CHANNEL_OUT_STEREO)) {
         return NO_ERROR;
     }
+    // The common fold downs to stereo are done in the mixer input format.
+    if (StereoDownmixBufferProvider::isSupported(channelMask, mMixerChannelMask,
+            mMixerInFormat)) {
+        downmixerBufferProvider = new StereoDownmixBufferProvider(channelMask,
+                kCopyBufferFrameCount);
+        reconfigureBufferProviders();
+        return NO_ERROR;
+    }
     // DownmixerBufferProvider is only used for position masks.
     if (audio_channel_mask_get_representation(channelMask)
                 == AUDIO_CHANNEL_REPRESENTATION_POSITION
@@ -754,6 +783,35 @@ void AudioMixer::setParameter(int name, int target, int param, void *value)
     }
 }
 
+void AudioMixer::setVolumes(int name, int target, float left, float right, float aux)
+{
+    name -= TRACK0;
+    ALOG_ASSERT(uint32_t(name) < MAX_NUM_TRACKS, "bad track name %d", name);
+    LOG_ALWAYS_FATAL_IF(target != VOLUME && target != RAMP_VOLUME,
+            "setVolumes: bad target %d", target);
+    track_t& track = mState.tracks[name];
+
+    // most cycles have no volume change, so check that before computing any ramp
+    if (left == track.mVolume[0] && right == track.mVolume[1] && aux == track.mAuxLevel) {
+        return;
+    }
+    const int32_t ramp = target == RAMP_VOLUME ? mState.frameCount : 0;
+    bool changed = setVolumeRampVariables(left, ramp,
+            &track.volume[0], &track.prevVolume[0], &track.volumeInc[0],
+            &track.mVolume[0], &track.mPrevVolume[0], &track.mVolumeInc[0]);
+    changed |= setVolumeRampVariables(right, ramp,
+            &track.volume[1], &track.prevVolume[1], &track.volumeInc[1],
+            &track.mVolume[1], &track.mPrevVolume[1], &track.mVolumeInc[1]);
+    changed |= setVolumeRampVariables(aux, ramp,
+            &track.auxLevel, &track.prevAuxLevel, &track.auxInc,
+            &track.mAuxLevel, &track.mPrevAuxLevel, &track.mAuxInc);
+    if (changed) {
+        ALOGV("setVolumes(%s, %04x %04x %04x)", target == VOLUME ? "VOLUME" : "RAMP_VOLUME",
+                track.volume[0], track.volume[1], track.auxLevel);
+        invalidateState(1 << name);
+    }
+}
+
 bool AudioMixer::track_t::setResampler(uint32_t trackSampleRate, uint32_t devSampleRate)
 {
     if (trackSampleRate != devSampleRate || resampler != NULL) {
@@ -880,6 +938,15 @@ size_t AudioMixer::getUnreleasedFrames(int name) const
     return 0;
 }
 
+int64_t AudioMixer::getResampleNs(int name) const
+{
+    name -= TRACK0;
+    if (uint32_t(name) < MAX_NUM_TRACKS) {
+        return mState.tracks[name].mResampleNs;
+    }
+    return 0;
+}
+
 void AudioMixer::setBufferProvider(int name, AudioBufferProvider* bufferProvider)
 {
     name -= TRACK0;
@@ -929,6 +996,7 @@ void AudioMixer::process__validate(state_t* state)
     }
     state->enabledTracks &= ~disabled;
     state->enabledTracks |=  enabled;
+    groupTracksByOutput(state);
 
     // compute everything we need...
     int countActiveTracks = 0;
@@ -1364,28 +1432,41 @@ void AudioMixer::track__16BitsMono(track_t* t, int32_t* out, size_t frameCount,
 }
 
 // no-op case
-void AudioMixer::process__nop(state_t* state)
+// Groups the enabled tracks by main buffer into state->outputGroups.
+// Each group is led by its track with the highest name, and groups are ordered by leader,
+// which is the order in which the process hooks used to discover them.
+void AudioMixer::groupTracksByOutput(state_t* state)
 {
-    ALOGVV("process__nop\n");
+    uint32_t numGroups = 0;
     uint32_t e0 = state->enabledTracks;
     while (e0) {
-        // process by group of tracks with same output buffer to
-        // avoid multiple memset() on same buffer
-        uint32_t e1 = e0, e2 = e0;
+        const int i = 31 - __builtin_clz(e0);
+        const int32_t* mainBuffer = state->tracks[i].mainBuffer;
+        uint32_t group = 1 << i;
+        uint32_t e1 = e0 & ~group;
+        while (e1) {
+            const int j = 31 - __builtin_clz(e1);
+            e1 &= ~(1 << j);
+            if (state->tracks[j].mainBuffer == mainBuffer) {
+                group |= 1 << j;
+            }
+        }
+        e0 &= ~group;
+        state->outputGroups[numGroups++] = group;
+    }
+    state->numOutputGroups = numGroups;
+}
+
+void AudioMixer::process__nop(state_t* state)
+{
+    ALOGVV("process__nop\n");
+    // process by group of tracks with same output buffer to
+    // avoid multiple memset() on same buffer
+    for (uint32_t g = 0; g < state->numOutputGroups; g++) {
+        uint32_t e1 = state->outputGroups[g];
         int i = 31 - __builtin_clz(e1);
         {
             track_t& t1 = state->tracks[i];
-            e2 &= ~(1<<i);
-            while (e2) {
-                i = 31 - __builtin_clz(e2);
-                e2 &= ~(1<<i);
-                track_t& t2 = state->tracks[i];
-                if (CC_UNLIKELY(t2.mainBuffer != t1.mainBuffer)) {
-                    e1 &= ~(1<<i);
-                }
-            }
-            e0 &= ~(e1);
-
             memset(t1.mainBuffer, 0, state->frameCount * t1.mMixerChannelCount
                     * audio_bytes_per_sample(t1.mMixerFormat));
         }
@@ -1427,23 +1508,11 @@ void AudioMixer::process__genericNoResampling(state_t* state)
         t.in = t.buffer.raw;
     }
 
-    e0 = enabledTracks;
-    while (e0) {
-        // process by group of tracks with same output buffer to
-        // optimize cache use
-        uint32_t e1 = e0, e2 = e0;
-        int j = 31 - __builtin_clz(e1);
-        track_t& t1 = state->tracks[j];
-        e2 &= ~(1<<j);
-        while (e2) {
-            j = 31 - __builtin_clz(e2);
-            e2 &= ~(1<<j);
-            track_t& t2 = state->tracks[j];
-            if (CC_UNLIKELY(t2.mainBuffer != t1.mainBuffer)) {
-                e1 &= ~(1<<j);
-            }
-        }
-        e0 &= ~(e1);
+    // process by group of tracks with same output buffer to
+    // optimize cache use
+    for (uint32_t g = 0; g < state->numOutputGroups; g++) {
+        uint32_t e1 = state->outputGroups[g], e2;
+        track_t& t1 = state->tracks[31 - __builtin_clz(e1)];
         // this assumes output 16 bits stereo, no resampling
         int32_t *out = t1.mainBuffer;
         size_t numFrames = 0;
@@ -1522,23 +1591,11 @@ void AudioMixer::process__genericResampling(state_t* state)
     int32_t* const outTemp = state->outputTemp;
     size_t numFrames = state->frameCount;
 
-    uint32_t e0 = state->enabledTracks;
-    while (e0) {
-        // process by group of tracks with same output buffer
-        // to optimize cache use
-        uint32_t e1 = e0, e2 = e0;
-        int j = 31 - __builtin_clz(e1);
-        track_t& t1 = state->tracks[j];
-        e2 &= ~(1<<j);
-        while (e2) {
-            j = 31 - __builtin_clz(e2);
-            e2 &= ~(1<<j);
-            track_t& t2 = state->tracks[j];
-            if (CC_UNLIKELY(t2.mainBuffer != t1.mainBuffer)) {
-                e1 &= ~(1<<j);
-            }
-        }
-        e0 &= ~(e1);
+    // process by group of tracks with same output buffer
+    // to optimize cache use
+    for (uint32_t g = 0; g < state->numOutputGroups; g++) {
+        uint32_t e1 = state->outputGroups[g];
+        track_t& t1 = state->tracks[31 - __builtin_clz(e1)];
         int32_t *out = t1.mainBuffer;
         memset(outTemp, 0, sizeof(*outTemp) * t1.mMixerChannelCount * state->frameCount);
         while (e1) {
@@ -1554,7 +1611,9 @@ void AudioMixer::process__genericResampling(state_t* state)
             // acquire/release the buffers because it's done by
             // the resampler.
             if (t.needs & NEEDS_RESAMPLE) {
+                const nsecs_t startNs = systemTime();
                 t.hook(&t, outTemp, numFrames, state->resampleTemp, aux);
+                t.mResampleNs += systemTime() - startNs;
             } else {
 
                 size_t outFrames = 0;
@@ -1682,6 +1741,11 @@ void AudioMixer::process__OneTrack16BitsStereoNoResampling(state_t* state)
 #define MIXTYPE_MONOVOL(mixtype) (mixtype == MIXTYPE_MULTI ? MIXTYPE_MULTI_MONOVOL : \
         mixtype == MIXTYPE_MULTI_SAVEONLY ? MIXTYPE_MULTI_SAVEONLY_MONOVOL : mixtype)
 
+/* The channel dispatching volumeRampMulti() and volumeMulti() below first try the
+ * NEON/SSE kernels of AudioMixerOpsSimd.h, which cover the common no aux buffer cases,
+ * then fall back to the scalar templates of AudioMixerOps.h.
+ */
+
 /* MIXTYPE     (see AudioMixerOps.h MIXTYPE_* enumeration)
  * TO: int32_t (Q4.27) or float
  * TI: int32_t (Q4.27) or int16_t (Q0.15) or float
@@ -1692,6 +1756,10 @@ template <int MIXTYPE,
 static void volumeRampMulti(uint32_t channels, TO* out, size_t frameCount,
         const TI* in, TA* aux, TV *vol, const TV *volinc, TAV *vola, TAV volainc)
 {
+    if (aux == NULL && MixSimd<MIXTYPE, TO, TI, TV>::volumeRamp(channels,
+            out, frameCount, in, vol, volinc)) {
+        return;
+    }
     switch (channels) {
     case 1:
         volumeRampMulti<MIXTYPE, 1>(out, frameCount, in, aux, vol, volinc, vola, volainc);
@@ -1736,6 +1804,10 @@ template <int MIXTYPE,
 static void volumeMulti(uint32_t channels, TO* out, size_t frameCount,
         const TI* in, TA* aux, const TV *vol, TAV vola)
 {
+    if (aux == NULL && MixSimd<MIXTYPE, TO, TI, TV>::volume(channels,
+            out, frameCount, in, vol)) {
+        return;
+    }
     switch (channels) {
     case 1:
         volumeMulti<MIXTYPE, 1>(out, frameCount, in, aux, vol, vola);
@@ -125,6 +125,16 @@ public:
 
     void        setParameter(int name, int target, int param, void *value);
 
+    // Sets the VOLUME0, VOLUME1 and AUXLEVEL parameters of a track in one call.
+    // target is VOLUME or RAMP_VOLUME, as for setParameter().
+    void        setVolumes(int name, int target, float left, float right, float aux);
+
+    // Group the parameter changes of a mix cycle: between beginUpdate() and commitUpdate(),
+    // changed tracks are only recorded, and the process hook is invalidated once by
+    // commitUpdate() if any track has changed.  Updates do not nest.
+    void        beginUpdate();
+    void        commitUpdate();
+
     void        setBufferProvider(int name, AudioBufferProvider* bufferProvider);
     void        process();
 
@@ -132,6 +142,10 @@ public:
 
     size_t      getUnreleasedFrames(int name) const;
 
+    // Cumulative time in nanoseconds spent in the resampling track hook for the track,
+    // since the track name was allocated.  Used for per-track usage accounting.
+    int64_t     getResampleNs(int name) const;
+
     static inline bool isValidPcmTrackFormat(audio_format_t format) {
         switch (format) {
         case AUDIO_FORMAT_PCM_8_BIT:
@@ -217,6 +231,29 @@ private:
 
         // 16-byte boundary
 
+        audio_format_t mMixerFormat;     // output mix format: AUDIO_FORMAT_PCM_(FLOAT|16_BIT)
+        audio_format_t mFormat;          // input track format
+        audio_format_t mMixerInFormat;   // mix internal format AUDIO_FORMAT_PCM_(FLOAT|16_BIT)
+                                         // each track must be converted to this format.
+        audio_format_t mDownmixRequiresFormat;  // required downmixer format
+                                                // AUDIO_FORMAT_PCM_16_BIT if 16 bit necessary
+                                                // AUDIO_FORMAT_INVALID if no required format
+
+        float          mVolume[MAX_NUM_VOLUMES];     // floating point set volume
+        float          mPrevVolume[MAX_NUM_VOLUMES]; // floating point previous volume
+        float          mVolumeInc[MAX_NUM_VOLUMES];  // floating point volume increment
+
+        float          mAuxLevel;                     // floating point set aux level
+        float          mPrevAuxLevel;                 // floating point prev aux level
+        float          mAuxInc;                       // floating point aux increment
+
+        audio_channel_mask_t mMixerChannelMask;
+        uint32_t             mMixerChannelCount;
+
+        // The fields above are read by the process and track hooks for every mixed block,
+        // and are kept together ahead of the fields below, which are mostly used when the
+        // track is configured.
+
         /* Buffer providers are constructed to translate the track input data as needed.
          *
          * TODO: perhaps make a single PlaybackConverterProvider class to move
@@ -241,27 +278,10 @@ private:
 
         int32_t     sessionId;
 
-        audio_format_t mMixerFormat;     // output mix format: AUDIO_FORMAT_PCM_(FLOAT|16_BIT)
-        audio_format_t mFormat;          // input track format
-        audio_format_t mMixerInFormat;   // mix internal format AUDIO_FORMAT_PCM_(FLOAT|16_BIT)
-                                         // each track must be converted to this format.
-        audio_format_t mDownmixRequiresFormat;  // required downmixer format
-                                                // AUDIO_FORMAT_PCM_16_BIT if 16 bit necessary
-                                                // AUDIO_FORMAT_INVALID if no required format
-
-        float          mVolume[MAX_NUM_VOLUMES];     // floating point set volume
-        float          mPrevVolume[MAX_NUM_VOLUMES]; // floating point previous volume
-        float          mVolumeInc[MAX_NUM_VOLUMES];  // floating point volume increment
-
-        float          mAuxLevel;                     // floating point set aux level
-        float          mPrevAuxLevel;                 // floating point prev aux level
-        float          mAuxInc;                       // floating point aux increment
-
-        audio_channel_mask_t mMixerChannelMask;
-        uint32_t             mMixerChannelCount;
-
         AudioPlaybackRate    mPlaybackRate;
 
+        int64_t              mResampleNs;   // cumulative time in the resampling hook
+
         bool        needsRamp() { return (volumeInc[0] | volumeInc[1] | auxInc) != 0; }
         bool        setResampler(uint32_t trackSampleRate, uint32_t devSampleRate);
         bool        doesResample() const { return resampler != NULL; }
@@ -290,6 +310,11 @@ private:
         int32_t         *resampleTemp;
         NBLog::Writer*  mLog;
         int32_t         reserved[1];
+        // Enabled tracks grouped by main buffer, refreshed by process__validate().
+        // The process hooks walk these masks instead of comparing the mainBuffer of each pair
+        // of enabled tracks on every call, which touched a track_t cache line per track.
+        uint32_t        numOutputGroups;
+        uint32_t        outputGroups[MAX_NUM_TRACKS];
         // FIXME allocate dynamically to save some memory when maxNumTracks < MAX_NUM_TRACKS
         track_t         tracks[MAX_NUM_TRACKS] __attribute__((aligned(32)));
     };
@@ -309,6 +334,9 @@ public:
 private:
     state_t         mState __attribute__((aligned(32)));
 
+    bool            mInUpdate;          // true between beginUpdate() and commitUpdate()
+    uint32_t        mPendingChanges;    // tracks changed since beginUpdate()
+
     // Call after changing either the enabled status of a track, or parameters of an enabled track.
     // OK to call more often than that, but unnecessary.
     void invalidateState(uint32_t mask);
@@ -329,6 +357,7 @@ private:
             int32_t* aux);
 
     static void process__validate(state_t* state);
+    static void groupTracksByOutput(state_t* state);
     static void process__nop(state_t* state);
     static void process__genericNoResampling(state_t* state);
     static void process__genericResampling(state_t* state);
@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_MIXER_OPS_SIMD_H
+#define ANDROID_AUDIO_MIXER_OPS_SIMD_H
+
+#if defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#define USE_MIXER_NEON 1
+#define USE_MIXER_SSE 0
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_MIXER_NEON 0
+#define USE_MIXER_SSE 1
+#else
+#define USE_MIXER_NEON 0
+#define USE_MIXER_SSE 0
+#endif
+
+#define USE_MIXER_SIMD (USE_MIXER_NEON || USE_MIXER_SSE)
+
+namespace android {
+
+// depends on AudioMixerOps.h
+
+/* MixSimd provides vectorized versions of volumeMulti() and volumeRampMulti()
+ * in AudioMixerOps.h for the common mixer engine cases without an aux buffer:
+ *
+ *   <TO, TI, TV> = <float, float, float>       float tracks into a float mix buffer
+ *   <TO, TI, TV> = <int32_t, int16_t, int16_t> int16 tracks into a Q4.27 mix buffer
+ *   <TO, TI, TV> = <int32_t, int16_t, int32_t> same, volume ramp (U4.28 volume)
+ *
+ * Each method returns true if the frames were processed, or false if the
+ * combination is not accelerated, in which case the caller must fall back to
+ * the scalar templates.  The selection is made at compile time, so a
+ * track or process hook chosen by AudioMixer::process__validate() resolves
+ * to either the vector or the scalar code, with no per-buffer dispatch.
+ *
+ * MIXTYPE is the un-adjusted mixtype (MIXTYPE_MULTI or MIXTYPE_MULTI_SAVEONLY);
+ * for more than 2 channels the volume of channel 0 applies to all channels,
+ * matching MIXTYPE_MONOVOL() in AudioMixer.cpp.
+ *
+ * Integer results are bit-exact with the scalar code.  Float volume ramps
+ * step the volume by 2 or 4 increments per vector, so may differ from the
+ * scalar code by rounding in the last bit.
+ */
+
+template <int MIXTYPE, typename TO, typename TI, typename TV>
+struct MixSimd {
+    static inline bool volume(uint32_t channels __unused, TO* out __unused,
+            size_t frameCount __unused, const TI* in __unused, const TV* vol __unused) {
+        return false;
+    }
+    static inline bool volumeRamp(uint32_t channels __unused, TO* out __unused,
+            size_t frameCount __unused, const TI* in __unused,
+            TV* vol __unused, const TV* volinc __unused) {
+        return false;
+    }
+};
+
+#if USE_MIXER_SIMD
+
+// Loads the 4 lane volume for constant volume processing of 4 consecutive samples.
+template <typename TV>
+static inline void mixSimdVolumeLanes(uint32_t channels, const TV* vol, TV lanes[4]) {
+    if (channels == 2) {
+        lanes[0] = lanes[2] = vol[0];
+        lanes[1] = lanes[3] = vol[1];
+    } else {
+        lanes[0] = lanes[1] = lanes[2] = lanes[3] = vol[0];
+    }
+}
+
+// Loads the 4 lane volume and increment for ramped processing of 4 consecutive samples.
+// Only mono and stereo are supported, as the volume is then per sample.
+template <typename TV>
+static inline void mixSimdRampLanes(uint32_t channels, const TV* vol, const TV* volinc,
+        TV lanes[4], TV incs[4]) {
+    if (channels == 2) {
+        lanes[0] = vol[0];
+        lanes[1] = vol[1];
+        lanes[2] = vol[0] + volinc[0];
+        lanes[3] = vol[1] + volinc[1];
+        incs[0] = incs[2] = volinc[0] * 2;
+        incs[1] = incs[3] = volinc[1] * 2;
+    } else {
+        for (int i = 0; i < 4; ++i) {
+            lanes[i] = vol[0] + volinc[0] * i;
+            incs[i] = volinc[0] * 4;
+        }
+    }
+}
+
+// Stores the volume of the next unprocessed frame back from the lanes.
+template <typename TV>
+static inline void mixSimdStoreRamp(uint32_t channels, const TV lanes[4], TV* vol) {
+    vol[0] = lanes[0];
+    if (channels == 2) {
+        vol[1] = lanes[1];
+    }
+}
+
+template <bool ACCUMULATE>
+static inline bool mixSimdFloat(uint32_t channels, float* out, size_t frameCount,
+        const float* in, const float* vol)
+{
+    float lanes[4];
+    mixSimdVolumeLanes(channels, vol, lanes);
+    size_t samples = frameCount * channels;
+#if USE_MIXER_NEON
+    const float32x4_t v = vld1q_f32(lanes);
+    for (; samples >= 4; samples -= 4) {
+        float32x4_t x = vld1q_f32(in);
+        if (ACCUMULATE) {
+            vst1q_f32(out, vmlaq_f32(vld1q_f32(out), x, v));
+        } else {
+            vst1q_f32(out, vmulq_f32(x, v));
+        }
+        in += 4;
+        out += 4;
+    }
+#else
+    const __m128 v = _mm_loadu_ps(lanes);
+    for (; samples >= 4; samples -= 4) {
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(in), v);
+        if (ACCUMULATE) {
+            x = _mm_add_ps(_mm_loadu_ps(out), x);
+        }
+        _mm_storeu_ps(out, x);
+        in += 4;
+        out += 4;
+    }
+#endif
+    // remaining samples are always whole frames for mono and stereo,
+    // and use lane 0 for the monovol case.
+    for (size_t i = 0; i < samples; ++i) {
+        const float x = in[i] * lanes[i & 3];
+        out[i] = ACCUMULATE ? out[i] + x : x;
+    }
+    return true;
+}
+
+template <bool ACCUMULATE>
+static inline bool mixSimdFloatRamp(uint32_t channels, float* out, size_t frameCount,
+        const float* in, float* vol, const float* volinc)
+{
+    if (channels > 2) {
+        return false; // monovol ramps are per frame, leave to scalar
+    }
+    float lanes[4], incs[4];
+    mixSimdRampLanes(channels, vol, volinc, lanes, incs);
+    size_t samples = frameCount * channels;
+#if USE_MIXER_NEON
+    float32x4_t v = vld1q_f32(lanes);
+    const float32x4_t vinc = vld1q_f32(incs);
+    for (; samples >= 4; samples -= 4) {
+        float32x4_t x = vld1q_f32(in);
+        if (ACCUMULATE) {
+            vst1q_f32(out, vmlaq_f32(vld1q_f32(out), x, v));
+        } else {
+            vst1q_f32(out, vmulq_f32(x, v));
+        }
+        v = vaddq_f32(v, vinc);
+        in += 4;
+        out += 4;
+    }
+    vst1q_f32(lanes, v);
+#else
+    __m128 v = _mm_loadu_ps(lanes);
+    const __m128 vinc = _mm_loadu_ps(incs);
+    for (; samples >= 4; samples -= 4) {
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(in), v);
+        if (ACCUMULATE) {
+            x = _mm_add_ps(_mm_loadu_ps(out), x);
+        }
+        _mm_storeu_ps(out, x);
+        v = _mm_add_ps(v, vinc);
+        in += 4;
+        out += 4;
+    }
+    _mm_storeu_ps(lanes, v);
+#endif
+    mixSimdStoreRamp(channels, lanes, vol);
+    for (size_t i = 0; i < samples; i += channels) {
+        for (uint32_t j = 0; j < channels; ++j) {
+            const float x = in[i + j] * vol[j];
+            out[i + j] = ACCUMULATE ? out[i + j] + x : x;
+            vol[j] += volinc[j];
+        }
+    }
+    return true;
+}
+
+// Accumulates 4 int16 samples scaled by 4 Q15-range volumes into 4 int32 outputs.
+#if USE_MIXER_NEON
+static inline void mixSimdMulAcc16(int32_t* out, const int16_t* in, int16x4_t v) {
+    vst1q_s32(out, vmlal_s16(vld1q_s32(out), vld1_s16(in), v));
+}
+#else
+static inline void mixSimdMulAcc16(int32_t* out, const int16_t* in, __m128i v) {
+    const __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in));
+    const __m128i lo = _mm_mullo_epi16(x, v);
+    const __m128i hi = _mm_mulhi_epi16(x, v);
+    __m128i* o = reinterpret_cast<__m128i*>(out);
+    _mm_storeu_si128(o, _mm_add_epi32(_mm_loadu_si128(o), _mm_unpacklo_epi16(lo, hi)));
+}
+#endif
+
+static inline bool mixSimdInt16(uint32_t channels, int32_t* out, size_t frameCount,
+        const int16_t* in, const int16_t* vol)
+{
+    int16_t lanes[4];
+    mixSimdVolumeLanes(channels, vol, lanes);
+    size_t samples = frameCount * channels;
+#if USE_MIXER_NEON
+    const int16x4_t v = vld1_s16(lanes);
+#else
+    const __m128i v = _mm_set_epi16(lanes[3], lanes[2], lanes[1], lanes[0],
+            lanes[3], lanes[2], lanes[1], lanes[0]);
+#endif
+    for (; samples >= 4; samples -= 4) {
+        mixSimdMulAcc16(out, in, v);
+        in += 4;
+        out += 4;
+    }
+    for (size_t i = 0; i < samples; ++i) {
+        out[i] += MixMul<int32_t, int16_t, int16_t>(in[i], lanes[i & 3]);
+    }
+    return true;
+}
+
+static inline bool mixSimdInt16Ramp(uint32_t channels, int32_t* out, size_t frameCount,
+        const int16_t* in, int32_t* vol, const int32_t* volinc)
+{
+    if (channels > 2) {
+        return false;
+    }
+    int32_t lanes[4], incs[4];
+    mixSimdRampLanes(channels, vol, volinc, lanes, incs);
+    size_t samples = frameCount * channels;
+    // MixMul<int32_t, int16_t, int32_t> uses the upper 16 bits of the U4.28 volume,
+    // which is at most U4.12 unity gain and so fits in an int16_t.
+#if USE_MIXER_NEON
+    int32x4_t v = vld1q_s32(lanes);
+    const int32x4_t vinc = vld1q_s32(incs);
+    for (; samples >= 4; samples -= 4) {
+        mixSimdMulAcc16(out, in, vmovn_s32(vshrq_n_s32(v, 16)));
+        v = vaddq_s32(v, vinc);
+        in += 4;
+        out += 4;
+    }
+    vst1q_s32(lanes, v);
+#else
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+    const __m128i vinc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(incs));
+    for (; samples >= 4; samples -= 4) {
+        const __m128i v16 = _mm_srai_epi32(v, 16);
+        mixSimdMulAcc16(out, in, _mm_packs_epi32(v16, v16));
+        v = _mm_add_epi32(v, vinc);
+        in += 4;
+        out += 4;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), v);
+#endif
+    mixSimdStoreRamp(channels, lanes, vol);
+    for (size_t i = 0; i < samples; i += channels) {
+        for (uint32_t j = 0; j < channels; ++j) {
+            out[i + j] += MixMul<int32_t, int16_t, int32_t>(in[i + j], vol[j]);
+            vol[j] += volinc[j];
+        }
+    }
+    return true;
+}
+
+template <>
+struct MixSimd<MIXTYPE_MULTI, float, float, float> {
+    static inline bool volume(uint32_t channels, float* out, size_t frameCount,
+            const float* in, const float* vol) {
+        return mixSimdFloat<true /*ACCUMULATE*/>(channels, out, frameCount, in, vol);
+    }
+    static inline bool volumeRamp(uint32_t channels, float* out, size_t frameCount,
+            const float* in, float* vol, const float* volinc) {
+        return mixSimdFloatRamp<true /*ACCUMULATE*/>(channels, out, frameCount,
+                in, vol, volinc);
+    }
+};
+
+template <>
+struct MixSimd<MIXTYPE_MULTI_SAVEONLY, float, float, float> {
+    static inline bool volume(uint32_t channels, float* out, size_t frameCount,
+            const float* in, const float* vol) {
+        return mixSimdFloat<false /*ACCUMULATE*/>(channels, out, frameCount, in, vol);
+    }
+    static inline bool volumeRamp(uint32_t channels, float* out, size_t frameCount,
+            const float* in, float* vol, const float* volinc) {
+        return mixSimdFloatRamp<false /*ACCUMULATE*/>(channels, out, frameCount,
+                in, vol, volinc);
+    }
+};
+
+template <>
+struct MixSimd<MIXTYPE_MULTI, int32_t, int16_t, int16_t> {
+    static inline bool volume(uint32_t channels, int32_t* out, size_t frameCount,
+            const int16_t* in, const int16_t* vol) {
+        return mixSimdInt16(channels, out, frameCount, in, vol);
+    }
+    static inline bool volumeRamp(uint32_t channels __unused, int32_t* out __unused,
+            size_t frameCount __unused, const int16_t* in __unused,
+            int16_t* vol __unused, const int16_t* volinc __unused) {
+        return false; // integer ramps use U4.28 volume
+    }
+};
+
+template <>
+struct MixSimd<MIXTYPE_MULTI, int32_t, int16_t, int32_t> {
+    static inline bool volume(uint32_t channels __unused, int32_t* out __unused,
+            size_t frameCount __unused, const int16_t* in __unused,
+            const int32_t* vol __unused) {
+        return false; // integer constant volume uses U4.12 volume
+    }
+    static inline bool volumeRamp(uint32_t channels, int32_t* out, size_t frameCount,
+            const int16_t* in, int32_t* vol, const int32_t* volinc) {
+        return mixSimdInt16Ramp(channels, out, frameCount, in, vol, volinc);
+    }
+};
+
+#endif // USE_MIXER_SIMD
+
+} // namespace android
+
+#endif /*ANDROID_AUDIO_MIXER_OPS_SIMD_H*/
@@ -32,8 +32,10 @@
 #include "AudioResamplerFirOps.h" // USE_NEON and USE_INLINE_ASSEMBLY defined here
 #include "AudioResamplerFirProcess.h"
 #include "AudioResamplerFirProcessNeon.h"
+#include "AudioResamplerFirProcessAvx2.h"
 #include "AudioResamplerFirGen.h" // requires math.h
 #include "AudioResamplerDyn.h"
+#include "AudioResamplerDynTables.h"
 
 //#define DEBUG_RESAMPLER
 
@@ -167,7 +169,7 @@ AudioResamplerDyn<TC, TI, TO>::AudioResamplerDyn(
         int inChannelCount, int32_t sampleRate, src_quality quality)
     : AudioResampler(inChannelCount, sampleRate, quality),
       mResampleFunc(0), mFilterSampleRate(0), mFilterQuality(DEFAULT_QUALITY),
-    mCoefBuffer(NULL)
+    mFilterBank(NULL)
 {
     mVolumeSimd[0] = mVolumeSimd[1] = 0;
     // The AudioResampler base class assumes we are always ready for 1:1 resampling.
@@ -180,7 +182,7 @@ AudioResamplerDyn<TC, TI, TO>::AudioResamplerDyn(
 template<typename TC, typename TI, typename TO>
 AudioResamplerDyn<TC, TI, TO>::~AudioResamplerDyn()
 {
-    free(mCoefBuffer);
+    releaseFilterBank(mFilterBank);
 }
 
 template<typename TC, typename TI, typename TO>
@@ -209,28 +211,118 @@ template<typename T> T max(T a, T b) {return a > b ? a : b;}
 
 template<typename T> T absdiff(T a, T b) {return a > b ? a - b : b - a;}
 
+template<typename TC, typename TI, typename TO>
+pthread_mutex_t AudioResamplerDyn<TC, TI, TO>::sFilterBankLock = PTHREAD_MUTEX_INITIALIZER;
+
+template<typename TC, typename TI, typename TO>
+typename AudioResamplerDyn<TC, TI, TO>::FilterBank*
+        AudioResamplerDyn<TC, TI, TO>::sFilterBanks = NULL;
+
+// Returns a referenced filter bank matching the design parameters, generating it if
+// no other resampler of this type holds one and AudioResamplerDynTables.h has no table
+// precomputed for it.  The coefficients depend only on these
+// parameters (not on the channel count), so they can be shared across all tracks.
+// Generation is done with the lock held; it is relatively rare and keeps two resamplers
+// from building the same filter concurrently.
+template<typename TC, typename TI, typename TO>
+typename AudioResamplerDyn<TC, TI, TO>::FilterBank*
+        AudioResamplerDyn<TC, TI, TO>::acquireFilterBank(int L, unsigned int halfNumCoefs,
+                double stopBandAtten, double fcr, double atten, bool* created)
+{
+    pthread_mutex_lock(&sFilterBankLock);
+    FilterBank* bank;
+    for (bank = sFilterBanks; bank != NULL; bank = bank->mNext) {
+        if (bank->mL == L && bank->mHalfNumCoefs == halfNumCoefs
+                && bank->mStopBandAtten == stopBandAtten && bank->mFcr == fcr) {
+            break;
+        }
+    }
+    *created = false;
+    if (bank == NULL) {
+        // use the table generated by tools/resampler_tools/fir for this design, if any.
+        // fcr is compared with a tolerance as the host may round it differently.
+        const TC* coefs = NULL;
+        for (const DynFilterTable<TC>* table = dynFilterTables(static_cast<const TC*>(NULL));
+                table->coefs != NULL; table++) {
+            if (table->L == L && table->halfNumCoefs == (int)halfNumCoefs
+                    && table->stopBandAtten == stopBandAtten && table->atten == atten
+                    && fabs(table->fcr - fcr) < 1e-12) {
+                coefs = table->coefs;
+                break;
+            }
+        }
+        if (coefs == NULL) {
+            TC* buf = NULL;
+            (void)posix_memalign(reinterpret_cast<void**>(&buf), 32,
+                    (L+1)*halfNumCoefs*sizeof(TC));
+            firKaiserGen(buf, L, halfNumCoefs, stopBandAtten, fcr, atten);
+            coefs = buf;
+            *created = true;
+        }
+        bank = new FilterBank;
+        bank->mL = L;
+        bank->mHalfNumCoefs = halfNumCoefs;
+        bank->mStopBandAtten = stopBandAtten;
+        bank->mFcr = fcr;
+        bank->mCoefs = coefs;
+        bank->mPrecomputed = !*created;
+        bank->mRefCount = 0;
+        bank->mNext = sFilterBanks;
+        sFilterBanks = bank;
+    }
+    ++bank->mRefCount;
+    pthread_mutex_unlock(&sFilterBankLock);
+    return bank;
+}
+
+// Drops a reference; the last user frees the filter bank, so cache memory is bounded
+// by the number of distinct filter designs in use.
+template<typename TC, typename TI, typename TO>
+void AudioResamplerDyn<TC, TI, TO>::releaseFilterBank(FilterBank* bank)
+{
+    if (bank == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&sFilterBankLock);
+    if (--bank->mRefCount == 0) {
+        for (FilterBank** link = &sFilterBanks; *link != NULL; link = &(*link)->mNext) {
+            if (*link == bank) {
+                *link = bank->mNext;
+                break;
+            }
+        }
+        if (!bank->mPrecomputed) {
+            free(const_cast<TC*>(bank->mCoefs));
+        }
+        delete bank;
+    }
+    pthread_mutex_unlock(&sFilterBankLock);
+}
+
 template<typename TC, typename TI, typename TO>
 void AudioResamplerDyn<TC, TI, TO>::createKaiserFir(Constants &c,
         double stopBandAtten, int inSampleRate, int outSampleRate, double tbwCheat)
 {
-    TC* buf = NULL;
     static const double atten = 0.9998;   // to avoid ripple overflow
     double fcr;
     double tbw = firKaiserTbw(c.mHalfNumCoefs, stopBandAtten);
 
-    (void)posix_memalign(reinterpret_cast<void**>(&buf), 32, (c.mL+1)*c.mHalfNumCoefs*sizeof(TC));
     if (inSampleRate < outSampleRate) { // upsample
         fcr = max(0.5*tbwCheat - tbw/2, tbw/2);
     } else { // downsample
         fcr = max(0.5*tbwCheat*outSampleRate/inSampleRate - tbw/2, tbw/2);
     }
-    // create and set filter
-    firKaiserGen(buf, c.mL, c.mHalfNumCoefs, stopBandAtten, fcr, atten);
+    // find or create the filter, then set it
+    bool created;
+    FilterBank* bank = acquireFilterBank(c.mL, c.mHalfNumCoefs, stopBandAtten, fcr, atten,
+            &created);
+    const TC* buf = bank->mCoefs;
     c.mFirCoefs = buf;
-    if (mCoefBuffer) {
-        free(mCoefBuffer);
-    }
-    mCoefBuffer = buf;
+    releaseFilterBank(mFilterBank);
+    mFilterBank = bank;
+    ALOGV("%s filter L:%d hnc:%u fcr:%lf",
+            created ? "created" : bank->mPrecomputed ? "precomputed" : "shared",
+            c.mL, c.mHalfNumCoefs, fcr);
 #ifdef DEBUG_RESAMPLER
     // print basic filter stats
     printf("L:%d  hnc:%d  stopBandAtten:%lf  fcr:%lf  atten:%lf  tbw:%lf\n",
@@ -468,6 +560,20 @@ void AudioResamplerDyn<TC, TI, TO>::setSampleRate(int32_t inSampleRate)
             break;
         }
     }
+#if USE_AVX2
+    // x86 builds cannot assume AVX2, so its kernels are selected here at runtime.
+    if (mChannelCount <= 2 && resamplerCpuHasAvx2()) {
+        if (locked) {
+            mResampleFunc = mChannelCount == 1
+                    ? &AudioResamplerDyn<TC, TI, TO>::resampleAvx2<1, true>
+                    : &AudioResamplerDyn<TC, TI, TO>::resampleAvx2<2, true>;
+        } else {
+            mResampleFunc = mChannelCount == 1
+                    ? &AudioResamplerDyn<TC, TI, TO>::resampleAvx2<1, false>
+                    : &AudioResamplerDyn<TC, TI, TO>::resampleAvx2<2, false>;
+        }
+    }
+#endif
 #ifdef DEBUG_RESAMPLER
     printf("channels:%d  %s  stride:%d  %s  coef:%d  shift:%d\n",
             mChannelCount, locked ? "locked" : "interpolated",
@@ -482,6 +588,18 @@ size_t AudioResamplerDyn<TC, TI, TO>::resample(int32_t* out, size_t outFrameCoun
     return (this->*mResampleFunc)(reinterpret_cast<TO*>(out), outFrameCount, provider);
 }
 
+#if USE_AVX2
+// flatten inlines resample() and the kernels so the whole loop is compiled for AVX2.
+template<typename TC, typename TI, typename TO>
+template<int CHANNELS, bool LOCKED>
+__attribute__((target("avx2,fma"), flatten))
+size_t AudioResamplerDyn<TC, TI, TO>::resampleAvx2(TO* out, size_t outFrameCount,
+        AudioBufferProvider* provider)
+{
+    return resample<CHANNELS, LOCKED, kAvx2Stride>(out, outFrameCount, provider);
+}
+#endif
+
 template<typename TC, typename TI, typename TO>
 template<int CHANNELS, bool LOCKED, int STRIDE>
 size_t AudioResamplerDyn<TC, TI, TO>::resample(TO* out, size_t outFrameCount,
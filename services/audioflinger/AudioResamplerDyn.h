@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 #include <sys/types.h>
+#include <pthread.h>
 #include <cutils/log.h>
 
 #include "AudioResampler.h"
@@ -107,12 +108,42 @@ private:
         size_t mStateCount; // size of state in units of TI.
     };
 
+    // A generated polyphase filter bank.  Filter banks are immutable once created
+    // and are shared by every resampler of this type using the same filter design, so
+    // identical (input rate, output rate, quality) tracks pay the generation cost once.
+    // The cache is protected by sFilterBankLock and entries are reference counted.
+    struct FilterBank {
+                 int mL;             // design parameters, used as the cache key
+        unsigned int mHalfNumCoefs;
+              double mStopBandAtten;
+              double mFcr;
+           const TC* mCoefs;         // (mL+1)*mHalfNumCoefs coefficients, 32 byte aligned
+                bool mPrecomputed;   // mCoefs is a table of AudioResamplerDynTables.h
+                 int mRefCount;      // protected by sFilterBankLock
+          FilterBank* mNext;
+    };
+
+    static FilterBank* acquireFilterBank(int L, unsigned int halfNumCoefs,
+            double stopBandAtten, double fcr, double atten, bool* created);
+    static void releaseFilterBank(FilterBank* bank);
+
+    static pthread_mutex_t sFilterBankLock;
+    static FilterBank*     sFilterBanks;     // singly linked list of cached filter banks
+
     void createKaiserFir(Constants &c, double stopBandAtten,
             int inSampleRate, int outSampleRate, double tbwCheat);
 
     template<int CHANNELS, bool LOCKED, int STRIDE>
     size_t resample(TO* out, size_t outFrameCount, AudioBufferProvider* provider);
 
+#if defined(__i386__) || defined(__x86_64__)
+    // resample() with the AVX2/FMA kernels of AudioResamplerFirProcessAvx2.h,
+    // selected by setSampleRate() only if the CPU supports AVX2.
+    template<int CHANNELS, bool LOCKED>
+    __attribute__((target("avx2,fma"), flatten))
+    size_t resampleAvx2(TO* out, size_t outFrameCount, AudioBufferProvider* provider);
+#endif
+
     // define a pointer to member function type for resample
     typedef size_t (AudioResamplerDyn<TC, TI, TO>::*resample_ABP_t)(TO* out,
             size_t outFrameCount, AudioBufferProvider* provider);
@@ -124,7 +155,7 @@ private:
      resample_ABP_t mResampleFunc;     // called function for resampling
             int32_t mFilterSampleRate; // designed filter sample rate.
         src_quality mFilterQuality;    // designed filter quality.
-              void* mCoefBuffer;       // if a filter is created, this is not null
+         FilterBank* mFilterBank;      // if a filter is created, this is not null
 };
 
 } // namespace android
@@ -0,0 +1,1926 @@
+// cmd-line: fir -G -f float -q low -q med 44100:48000 48000:44100
+// Generated by frameworks/av/tools/resampler_tools/fir -G, do not edit.
+
+#ifndef ANDROID_AUDIO_RESAMPLER_DYN_TABLES_H
+#define ANDROID_AUDIO_RESAMPLER_DYN_TABLES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace android {
+
+// A precomputed filter bank and the design it was generated from.
+template <typename TC>
+struct DynFilterTable {
+    int L;
+    int halfNumCoefs;
+    double stopBandAtten;
+    double fcr;
+    double atten;
+    const TC* coefs;    // (L+1)*halfNumCoefs coefficients, NULL ends the list
+};
+
+// 44100 -> 48000 Hz, DYN_LOW_QUALITY, float coefficients
+// passband(0, 0.001321): ripple 0.001007 dB, stopband(0.003281, 0.5): 78.83 dB, SNR 151.23 dB
+static const float kDynFilter0[] __attribute__((aligned(32))) = {
+    0.736264646f, 0.221323282f, -0.125621304f, 0.0379981771f,
+    0.00508493930f, -0.0108648054f, 0.00445665931f, -0.000542523863f,
+    0.736237347f, 0.216848850f, -0.125186518f, 0.0385364890f,
+    0.00463554589f, -0.0107008619f, 0.00444054790f, -0.000551529869f,
+    0.736155391f, 0.212387994f, -0.124727629f, 0.0390612893f,
+    0.00418938883f, -0.0105361389f, 0.00442345720f, -0.000560160435f,
+    0.736018896f, 0.207941234f, -0.124244943f, 0.0395725705f,
+    0.00374654541f, -0.0103706885f, 0.00440540537f, -0.000568419229f,
+    0.735827863f, 0.203509063f, -0.123738788f, 0.0400703326f,
+    0.00330709131f, -0.0102045601f, 0.00438641012f, -0.000576310209f,
+    0.735582232f, 0.199091971f, -0.123209476f, 0.0405545756f,
+    0.00287110102f, -0.0100378050f, 0.00436649052f, -0.000583819696f,
+    0.735282063f, 0.194690451f, -0.122657336f, 0.0410253108f,
+    0.00243864767f, -0.00987047236f, 0.00434566475f, -0.000590987154f,
+    0.734927475f, 0.190304980f, -0.122082695f, 0.0414825380f,
+    0.00200980250f, -0.00970261171f, 0.00432395097f, -0.000597798789f,
+    0.734518468f, 0.185936049f, -0.121485874f, 0.0419262722f,
+    0.00158463512f, -0.00953427330f, 0.00430136779f, -0.000604258617f,
+    0.734055102f, 0.181584135f, -0.120867200f, 0.0423565283f,
+    0.00116321410f, -0.00936550554f, 0.00427793339f, -0.000610370887f,
+    0.733537436f, 0.177249700f, -0.120227002f, 0.0427733213f,
+    0.000745606143f, -0.00919635687f, 0.00425366685f, -0.000616139849f,
+    0.732965529f, 0.172933221f, -0.119565621f, 0.0431766696f,
+    0.000331876276f, -0.00902687386f, 0.00422858680f, -0.000621569692f,
+    0.732339561f, 0.168635145f, -0.118883379f, 0.0435666032f,
+    -7.79117981e-05f, -0.00885710679f, 0.00420271093f, -0.000626664842f,
+    0.731659472f, 0.164355963f, -0.118180610f, 0.0439431407f,
+    -0.000483696000f, -0.00868710037f, 0.00417605834f, -0.000631429721f,
+    0.730925441f, 0.160096094f, -0.117457658f, 0.0443063118f,
+    -0.000885415822f, -0.00851690304f, 0.00414864719f, -0.000635868637f,
+    0.730137646f, 0.155856013f, -0.116714858f, 0.0446561538f,
+    -0.00128301233f, -0.00834656041f, 0.00412049610f, -0.000639986189f,
+    0.729296029f, 0.151636153f, -0.115952544f, 0.0449926928f,
+    -0.00167642813f, -0.00817611814f, 0.00409162370f, -0.000643786858f,
+    0.728400886f, 0.147436962f, -0.115171053f, 0.0453159697f,
+    -0.00206560735f, -0.00800562184f, 0.00406204863f, -0.000647275243f,
+    0.727452219f, 0.143258870f, -0.114370726f, 0.0456260256f,
+    -0.00245049573f, -0.00783511624f, 0.00403178856f, -0.000650455884f,
+    0.726450205f, 0.139102310f, -0.113551915f, 0.0459229052f,
+    -0.00283104065f, -0.00766464556f, 0.00400086259f, -0.000653333438f,
+    0.725395024f, 0.134967715f, -0.112714946f, 0.0462066457f,
+    -0.00320719066f, -0.00749425450f, 0.00396928843f, -0.000655912620f,
+    0.724286735f, 0.130855486f, -0.111860171f, 0.0464772992f,
+    -0.00357889663f, -0.00732398545f, 0.00393708469f, -0.000658198143f,
+    0.723125637f, 0.126766041f, -0.110987939f, 0.0467349216f,
+    -0.00394611014f, -0.00715388265f, 0.00390426978f, -0.000660194724f,
+    0.721911728f, 0.122699820f, -0.110098578f, 0.0469795577f,
+    -0.00430878485f, -0.00698398706f, 0.00387086160f, -0.000661907077f,
+    0.720645368f, 0.118657194f, -0.109192446f, 0.0472112671f,
+    -0.00466687558f, -0.00681434153f, 0.00383687834f, -0.000663340092f,
+    0.719326556f, 0.114638582f, -0.108269885f, 0.0474301055f,
+    -0.00502033951f, -0.00664498750f, 0.00380233815f, -0.000664498482f,
+    0.717955589f, 0.110644378f, -0.107331246f, 0.0476361401f,
+    -0.00536913471f, -0.00647596503f, 0.00376725895f, -0.000665387139f,
+    0.716532707f, 0.106674962f, -0.106376864f, 0.0478294268f,
+    -0.00571322022f, -0.00630731555f, 0.00373165868f, -0.000666010892f,
+    0.715057969f, 0.102730721f, -0.105407096f, 0.0480100326f,
+    -0.00605255831f, -0.00613907818f, 0.00369555503f, -0.000666374632f,
+    0.713531673f, 0.0988120437f, -0.104422286f, 0.0481780320f,
+    -0.00638711080f, -0.00597129203f, 0.00365896593f, -0.000666483189f,
+    0.711954057f, 0.0949192867f, -0.103422776f, 0.0483334847f,
+    -0.00671684276f, -0.00580399670f, 0.00362190884f, -0.000666341512f,
+    0.710325301f, 0.0910528302f, -0.102408923f, 0.0484764725f,
+    -0.00704171974f, -0.00563722942f, 0.00358440168f, -0.000665954489f,
+    0.708645701f, 0.0872130394f, -0.101381063f, 0.0486070663f,
+    -0.00736170961f, -0.00547102792f, 0.00354646146f, -0.000665327010f,
+    0.706915379f, 0.0834002569f, -0.100339554f, 0.0487253442f,
+    -0.00767678069f, -0.00530542992f, 0.00350810611f, -0.000664464082f,
+    0.705134690f, 0.0796148479f, -0.0992847458f, 0.0488313846f,
+    -0.00798690319f, -0.00514047127f, 0.00346935238f, -0.000663370534f,
+    0.703303874f, 0.0758571401f, -0.0982169732f, 0.0489252694f,
+    -0.00829205010f, -0.00497618783f, 0.00343021750f, -0.000662051316f,
+    0.701423168f, 0.0721274912f, -0.0971365944f, 0.0490070842f,
+    -0.00859219488f, -0.00481261592f, 0.00339071872f, -0.000660511374f,
+    0.699492812f, 0.0684262291f, -0.0960439444f, 0.0490769111f,
+    -0.00888731051f, -0.00464978907f, 0.00335087301f, -0.000658755656f,
+    0.697513163f, 0.0647536740f, -0.0949393883f, 0.0491348431f,
+    -0.00917737558f, -0.00448774174f, 0.00331069669f, -0.000656789052f,
+    0.695484400f, 0.0611101538f, -0.0938232541f, 0.0491809659f,
+    -0.00946236774f, -0.00432650791f, 0.00327020697f, -0.000654616510f,
+    0.693406880f, 0.0574959889f, -0.0926958919f, 0.0492153727f,
+    -0.00974226557f, -0.00416612066f, 0.00322942040f, -0.000652242918f,
+    0.691280901f, 0.0539114811f, -0.0915576592f, 0.0492381603f,
+    -0.0100170504f, -0.00400661211f, 0.00318835303f, -0.000649673224f,
+    0.689106703f, 0.0503569394f, -0.0904088840f, 0.0492494218f,
+    -0.0102867037f, -0.00384801393f, 0.00314702117f, -0.000646912260f,
+    0.686884701f, 0.0468326621f, -0.0892499238f, 0.0492492542f,
+    -0.0105512105f, -0.00369035755f, 0.00310544134f, -0.000643964973f,
+    0.684615076f, 0.0433389395f, -0.0880811140f, 0.0492377579f,
+    -0.0108105559f, -0.00353367371f, 0.00306362915f, -0.000640836195f,
+    0.682298303f, 0.0398760587f, -0.0869027972f, 0.0492150337f,
+    -0.0110647259f, -0.00337799219f, 0.00302160089f, -0.000637530873f,
+    0.679934561f, 0.0364442989f, -0.0857153162f, 0.0491811857f,
+    -0.0113137085f, -0.00322334259f, 0.00297937170f, -0.000634053722f,
+    0.677524328f, 0.0330439322f, -0.0845190138f, 0.0491363220f,
+    -0.0115574934f, -0.00306975353f, 0.00293695764f, -0.000630409573f,
+    0.675067842f, 0.0296752341f, -0.0833142325f, 0.0490805432f,
+    -0.0117960721f, -0.00291725341f, 0.00289437384f, -0.000626603316f,
+    0.672565460f, 0.0263384581f, -0.0821013004f, 0.0490139611f,
+    -0.0120294355f, -0.00276586972f, 0.00285163545f, -0.000622639724f,
+    0.670017600f, 0.0230338648f, -0.0808805674f, 0.0489366874f,
+    -0.0122575788f, -0.00261562923f, 0.00280875806f, -0.000618523452f,
+    0.667424560f, 0.0197617002f, -0.0796523616f, 0.0488488264f,
+    -0.0124804964f, -0.00246655894f, 0.00276575587f, -0.000614259392f,
+    0.664786696f, 0.0165222082f, -0.0784170255f, 0.0487504974f,
+    -0.0126981847f, -0.00231868401f, 0.00272264425f, -0.000609852083f,
+    0.662104428f, 0.0133156274f, -0.0771748871f, 0.0486418158f,
+    -0.0129106417f, -0.00217202981f, 0.00267943763f, -0.000605306355f,
+    0.659378171f, 0.0101421867f, -0.0759262815f, 0.0485228933f,
+    -0.0131178657f, -0.00202662079f, 0.00263615022f, -0.000600626750f,
+    0.656608224f, 0.00700211013f, -0.0746715441f, 0.0483938493f,
+    -0.0133198583f, -0.00188248116f, 0.00259279623f, -0.000595817924f,
+    0.653795004f, 0.00389561639f, -0.0734110028f, 0.0482548028f,
+    -0.0135166198f, -0.00173963385f, 0.00254939008f, -0.000590884534f,
+    0.650938928f, 0.000822917325f, -0.0721449777f, 0.0481058732f,
+    -0.0137081537f, -0.00159810181f, 0.00250594551f, -0.000585831061f,
+    0.648040414f, -0.00221578195f, -0.0708738118f, 0.0479471833f,
+    -0.0138944658f, -0.00145790703f, 0.00246247626f, -0.000580662047f,
+    0.645099819f, -0.00522028236f, -0.0695978105f, 0.0477788523f,
+    -0.0140755596f, -0.00131907093f, 0.00241899560f, -0.000575382030f,
+    0.642117560f, -0.00819039159f, -0.0683173165f, 0.0476010107f,
+    -0.0142514426f, -0.00118161435f, 0.00237551727f, -0.000569995376f,
+    0.639094055f, -0.0111259231f, -0.0670326427f, 0.0474137776f,
+    -0.0144221243f, -0.00104555767f, 0.00233205408f, -0.000564506627f,
+    0.636029780f, -0.0140266968f, -0.0657441095f, 0.0472172797f,
+    -0.0145876119f, -0.000910920382f, 0.00228861929f, -0.000558920030f,
+    0.632925153f, -0.0168925393f, -0.0644520372f, 0.0470116474f,
+    -0.0147479177f, -0.000777721638f, 0.00224522548f, -0.000553240010f,
+    0.629780591f, -0.0197232831f, -0.0631567463f, 0.0467970110f,
+    -0.0149030518f, -0.000645979715f, 0.00220188545f, -0.000547470874f,
+    0.626596510f, -0.0225187670f, -0.0618585460f, 0.0465734936f,
+    -0.0150530282f, -0.000515712483f, 0.00215861131f, -0.000541616813f,
+    0.623373330f, -0.0252788384f, -0.0605577491f, 0.0463412292f,
+    -0.0151978619f, -0.000386937085f, 0.00211541564f, -0.000535682135f,
+    0.620111585f, -0.0280033462f, -0.0592546649f, 0.0461003482f,
+    -0.0153375668f, -0.000259670167f, 0.00207231008f, -0.000529670913f,
+    0.616811752f, -0.0306921527f, -0.0579496101f, 0.0458509848f,
+    -0.0154721597f, -0.000133927708f, 0.00202930672f, -0.000523587340f,
+    0.613474131f, -0.0333451182f, -0.0566428825f, 0.0455932729f,
+    -0.0156016583f, -9.72506677e-06f, 0.00198641699f, -0.000517435430f,
+    0.610099375f, -0.0359621197f, -0.0553347915f, 0.0453273430f,
+    -0.0157260820f, 0.000112922964f, 0.00194365252f, -0.000511219318f,
+    0.606687844f, -0.0385430269f, -0.0540256388f, 0.0450533368f,
+    -0.0158454496f, 0.000234002189f, 0.00190102425f, -0.000504942902f,
+    0.603240013f, -0.0410877317f, -0.0527157225f, 0.0447713807f,
+    -0.0159597825f, 0.000353499025f, 0.00185854349f, -0.000498610199f,
+    0.599756360f, -0.0435961187f, -0.0514053404f, 0.0444816165f,
+    -0.0160691012f, 0.000471400475f, 0.00181622093f, -0.000492224994f,
+    0.596237421f, -0.0460680872f, -0.0500947908f, 0.0441841818f,
+    -0.0161734316f, 0.000587694114f, 0.00177406718f, -0.000485791214f,
+    0.592683673f, -0.0485035367f, -0.0487843640f, 0.0438792109f,
+    -0.0162727963f, 0.000702368096f, 0.00173209270f, -0.000479312643f,
+    0.589095533f, -0.0509023815f, -0.0474743508f, 0.0435668454f,
+    -0.0163672213f, 0.000815411215f, 0.00169030763f, -0.000472792977f,
+    0.585473597f, -0.0532645360f, -0.0461650416f, 0.0432472229f,
+    -0.0164567307f, 0.000926812820f, 0.00164872198f, -0.000466235972f,
+    0.581818342f, -0.0555899218f, -0.0448567197f, 0.0429204851f,
+    -0.0165413544f, 0.00103656272f, 0.00160734553f, -0.000459645176f,
+    0.578130186f, -0.0578784645f, -0.0435496680f, 0.0425867662f,
+    -0.0166211184f, 0.00114465156f, 0.00156618794f, -0.000453024230f,
+    0.574409723f, -0.0601301044f, -0.0422441661f, 0.0422462113f,
+    -0.0166960526f, 0.00125107029f, 0.00152525865f, -0.000446376653f,
+    0.570657492f, -0.0623447783f, -0.0409404971f, 0.0418989621f,
+    -0.0167661868f, 0.00135581067f, 0.00148456660f, -0.000439705909f,
+    0.566873908f, -0.0645224303f, -0.0396389291f, 0.0415451601f,
+    -0.0168315526f, 0.00145886466f, 0.00144412101f, -0.000433015404f,
+    0.563059568f, -0.0666630268f, -0.0383397378f, 0.0411849394f,
+    -0.0168921817f, 0.00156022527f, 0.00140393060f, -0.000426308543f,
+    0.559214950f, -0.0687665120f, -0.0370431915f, 0.0408184528f,
+    -0.0169481058f, 0.00165988551f, 0.00136400387f, -0.000419588614f,
+    0.555340588f, -0.0708328635f, -0.0357495584f, 0.0404458307f,
+    -0.0169993602f, 0.00175783958f, 0.00132434908f, -0.000412858848f,
+    0.551437020f, -0.0728620440f, -0.0344591029f, 0.0400672257f,
+    -0.0170459785f, 0.00185408152f, 0.00128497451f, -0.000406122446f,
+    0.547504842f, -0.0748540387f, -0.0331720859f, 0.0396827757f,
+    -0.0170879960f, 0.00194860657f, 0.00124588818f, -0.000399382581f,
+    0.543544471f, -0.0768088251f, -0.0318887644f, 0.0392926261f,
+    -0.0171254501f, 0.00204140996f, 0.00120709755f, -0.000392642280f,
+    0.539556563f, -0.0787264109f, -0.0306093935f, 0.0388969146f,
+    -0.0171583761f, 0.00213248795f, 0.00116861041f, -0.000385904626f,
+    0.535541534f, -0.0806067735f, -0.0293342285f, 0.0384957902f,
+    -0.0171868131f, 0.00222183694f, 0.00113043387f, -0.000379172532f,
+    0.531500041f, -0.0824499205f, -0.0280635171f, 0.0380893946f,
+    -0.0172108002f, 0.00230945414f, 0.00109257514f, -0.000372448936f,
+    0.527432621f, -0.0842558667f, -0.0267975032f, 0.0376778655f,
+    -0.0172303747f, 0.00239533675f, 0.00105504121f, -0.000365736691f,
+    0.523339748f, -0.0860246271f, -0.0255364347f, 0.0372613519f,
+    -0.0172455776f, 0.00247948337f, 0.00101783860f, -0.000359038560f,
+    0.519222021f, -0.0877562165f, -0.0242805481f, 0.0368399955f,
+    -0.0172564499f, 0.00256189238f, 0.000980973826f, -0.000352357281f,
+    0.515080035f, -0.0894506648f, -0.0230300836f, 0.0364139378f,
+    -0.0172630344f, 0.00264256261f, 0.000944453350f, -0.000345695531f,
+    0.510914266f, -0.0911080018f, -0.0217852741f, 0.0359833241f,
+    -0.0172653720f, 0.00272149406f, 0.000908283109f, -0.000339055929f,
+    0.506725371f, -0.0927282795f, -0.0205463488f, 0.0355482958f,
+    -0.0172635056f, 0.00279868674f, 0.000872469041f, -0.000332441006f,
+    0.502513826f, -0.0943115279f, -0.0193135366f, 0.0351089947f,
+    -0.0172574781f, 0.00287414133f, 0.000837016793f, -0.000325853267f,
+    0.498280227f, -0.0958577991f, -0.0180870630f, 0.0346655659f,
+    -0.0172473360f, 0.00294785853f, 0.000801931834f, -0.000319295184f,
+    0.494025171f, -0.0973671526f, -0.0168671478f, 0.0342181437f,
+    -0.0172331221f, 0.00301984046f, 0.000767219521f, -0.000312769058f,
+    0.489749163f, -0.0988396555f, -0.0156540107f, 0.0337668806f,
+    -0.0172148831f, 0.00309008849f, 0.000732884917f, -0.000306277274f,
+    0.485452861f, -0.100275367f, -0.0144478641f, 0.0333119109f,
+    -0.0171926636f, 0.00315860542f, 0.000698932796f, -0.000299822044f,
+    0.481136739f, -0.101674370f, -0.0132489214f, 0.0328533798f,
+    -0.0171665121f, 0.00322539429f, 0.000665367988f, -0.000293405552f,
+    0.476801455f, -0.103036731f, -0.0120573891f, 0.0323914252f,
+    -0.0171364751f, 0.00329045858f, 0.000632194919f, -0.000287029980f,
+    0.472447544f, -0.104362547f, -0.0108734732f, 0.0319261886f,
+    -0.0171025991f, 0.00335380156f, 0.000599417835f, -0.000280697393f,
+    0.468075603f, -0.105651908f, -0.00969737489f, 0.0314578079f,
+    -0.0170649327f, 0.00341542810f, 0.000567040930f, -0.000274409802f,
+    0.463686198f, -0.106904902f, -0.00852929149f, 0.0309864264f,
+    -0.0170235261f, 0.00347534264f, 0.000535068044f, -0.000268169155f,
+    0.459279895f, -0.108121634f, -0.00736941863f, 0.0305121802f,
+    -0.0169784259f, 0.00353355054f, 0.000503502961f, -0.000261977344f,
+    0.454857290f, -0.109302208f, -0.00621794676f, 0.0300352108f,
+    -0.0169296842f, 0.00359005714f, 0.000472349115f, -0.000255836232f,
+    0.450418979f, -0.110446744f, -0.00507506402f, 0.0295556523f,
+    -0.0168773513f, 0.00364486827f, 0.000441609911f, -0.000249747623f,
+    0.445965528f, -0.111555353f, -0.00394095434f, 0.0290736444f,
+    -0.0168214757f, 0.00369799067f, 0.000411288493f, -0.000243713177f,
+    0.441497505f, -0.112628162f, -0.00281579909f, 0.0285893250f,
+    -0.0167621076f, 0.00374943111f, 0.000381387828f, -0.000237734610f,
+    0.437015533f, -0.113665290f, -0.00169977534f, 0.0281028263f,
+    -0.0166993011f, 0.00379919657f, 0.000351910683f, -0.000231813523f,
+    0.432520181f, -0.114666887f, -0.000593057135f, 0.0276142880f,
+    -0.0166331083f, 0.00384729472f, 0.000322859647f, -0.000225951444f,
+    0.428012043f, -0.115633078f, 0.000504185038f, 0.0271238424f,
+    -0.0165635776f, 0.00389373349f, 0.000294237194f, -0.000220149901f,
+    0.423491657f, -0.116564013f, 0.00159178430f, 0.0266316235f,
+    -0.0164907649f, 0.00393852126f, 0.000266045507f, -0.000214410291f,
+    0.418959677f, -0.117459841f, 0.00266957725f, 0.0261377655f,
+    -0.0164147206f, 0.00398166664f, 0.000238286681f, -0.000208734025f,
+    0.414416671f, -0.118320711f, 0.00373740401f, 0.0256424006f,
+    -0.0163354985f, 0.00402317895f, 0.000210962593f, -0.000203122399f,
+    0.409863204f, -0.119146787f, 0.00479510799f, 0.0251456592f,
+    -0.0162531529f, 0.00406306749f, 0.000184074946f, -0.000197576708f,
+    0.405299872f, -0.119938225f, 0.00584253715f, 0.0246476755f,
+    -0.0161677357f, 0.00410134206f, 0.000157625298f, -0.000192098145f,
+    0.400727272f, -0.120695204f, 0.00687954109f, 0.0241485760f,
+    -0.0160793010f, 0.00413801242f, 0.000131615016f, -0.000186687874f,
+    0.396145970f, -0.121417895f, 0.00790597498f, 0.0236484930f,
+    -0.0159879047f, 0.00417308928f, 0.000106045307f, -0.000181346986f,
+    0.391556591f, -0.122106470f, 0.00892169587f, 0.0231475513f,
+    -0.0158936009f, 0.00420658384f, 8.09171979e-05f, -0.000176076544f,
+    0.386959672f, -0.122761123f, 0.00992656685f, 0.0226458833f,
+    -0.0157964416f, 0.00423850678f, 5.62315654e-05f, -0.000170877538f,
+    0.382355839f, -0.123382024f, 0.0109204510f, 0.0221436098f,
+    -0.0156964846f, 0.00426886929f, 3.19891187e-05f, -0.000165750884f,
+    0.377745658f, -0.123969384f, 0.0119032171f, 0.0216408595f,
+    -0.0155937830f, 0.00429768348f, 8.19040633e-06f, -0.000160697513f,
+    0.373129725f, -0.124523386f, 0.0128747383f, 0.0211377554f,
+    -0.0154883917f, 0.00432496145f, -1.51641780e-05f, -0.000155718226f,
+    0.368508607f, -0.125044242f, 0.0138348890f, 0.0206344221f,
+    -0.0153803667f, 0.00435071532f, -3.80744023e-05f, -0.000150813808f,
+    0.363882929f, -0.125532150f, 0.0147835501f, 0.0201309826f,
+    -0.0152697628f, 0.00437495764f, -6.05401801e-05f, -0.000145985003f,
+    0.359253228f, -0.125987321f, 0.0157206021f, 0.0196275562f,
+    -0.0151566360f, 0.00439770147f, -8.25615934e-05f, -0.000141232493f,
+    0.354620069f, -0.126409963f, 0.0166459344f, 0.0191242658f,
+    -0.0150410412f, 0.00441895984f, -0.000104138853f, -0.000136556904f,
+    0.349984109f, -0.126800314f, 0.0175594352f, 0.0186212268f,
+    -0.0149230352f, 0.00443874625f, -0.000125272330f, -0.000131958819f,
+    0.345345855f, -0.127158567f, 0.0184609964f, 0.0181185603f,
+    -0.0148026720f, 0.00445707422f, -0.000145962549f, -0.000127438761f,
+    0.340705931f, -0.127484977f, 0.0193505194f, 0.0176163837f,
+    -0.0146800084f, 0.00447395816f, -0.000166210157f, -0.000122997240f,
+    0.336064875f, -0.127779752f, 0.0202278998f, 0.0171148106f,
+    -0.0145550994f, 0.00448941207f, -0.000186015968f, -0.000118634656f,
+    0.331423283f, -0.128043160f, 0.0210930463f, 0.0166139565f,
+    -0.0144280018f, 0.00450344989f, -0.000205380900f, -0.000114351431f,
+    0.326781750f, -0.128275394f, 0.0219458640f, 0.0161139350f,
+    -0.0142987715f, 0.00451608701f, -0.000224306030f, -0.000110147885f,
+    0.322140813f, -0.128476724f, 0.0227862634f, 0.0156148588f,
+    -0.0141674625f, 0.00452733785f, -0.000242792579f, -0.000106024323f,
+    0.317501038f, -0.128647402f, 0.0236141626f, 0.0151168378f,
+    -0.0140341315f, 0.00453721732f, -0.000260841887f, -0.000101981001f,
+    0.312863022f, -0.128787667f, 0.0244294778f, 0.0146199819f,
+    -0.0138988355f, 0.00454574171f, -0.000278455409f, -9.80181139e-05f,
+    0.308227301f, -0.128897771f, 0.0252321307f, 0.0141244000f,
+    -0.0137616284f, 0.00455292547f, -0.000295634760f, -9.41358376e-05f,
+    0.303594470f, -0.128977969f, 0.0260220468f, 0.0136301992f,
+    -0.0136225661f, 0.00455878442f, -0.000312381657f, -9.03342880e-05f,
+    0.298965067f, -0.129028529f, 0.0267991554f, 0.0131374858f,
+    -0.0134817045f, 0.00456333533f, -0.000328697963f, -8.66135379e-05f,
+    0.294339657f, -0.129049703f, 0.0275633875f, 0.0126463640f,
+    -0.0133390985f, 0.00456659310f, -0.000344585598f, -8.29736236e-05f,
+    0.289718807f, -0.129041776f, 0.0283146817f, 0.0121569363f,
+    -0.0131948041f, 0.00456857495f, -0.000360046688f, -7.94145453e-05f,
+    0.285103083f, -0.129005015f, 0.0290529765f, 0.0116693061f,
+    -0.0130488761f, 0.00456929673f, -0.000375083386f, -7.59362447e-05f,
+    0.280492991f, -0.128939688f, 0.0297782123f, 0.0111835739f,
+    -0.0129013686f, 0.00456877565f, -0.000389698049f, -7.25386490e-05f,
+    0.275889128f, -0.128846064f, 0.0304903369f, 0.0106998375f,
+    -0.0127523383f, 0.00456702756f, -0.000403893093f, -6.92216272e-05f,
+    0.271292001f, -0.128724441f, 0.0311893001f, 0.0102181947f,
+    -0.0126018375f, 0.00456407014f, -0.000417671021f, -6.59850193e-05f,
+    0.266702205f, -0.128575101f, 0.0318750553f, 0.00973874424f,
+    -0.0124499230f, 0.00455991970f, -0.000431034481f, -6.28286216e-05f,
+    0.262120217f, -0.128398329f, 0.0325475559f, 0.00926157925f,
+    -0.0122966478f, 0.00455459440f, -0.000443986210f, -5.97522012e-05f,
+    0.257546633f, -0.128194392f, 0.0332067646f, 0.00878679380f,
+    -0.0121420668f, 0.00454811053f, -0.000456529058f, -5.67554780e-05f,
+    0.252981961f, -0.127963617f, 0.0338526443f, 0.00831448007f,
+    -0.0119862333f, 0.00454048580f, -0.000468665967f, -5.38381501e-05f,
+    0.248426750f, -0.127706274f, 0.0344851613f, 0.00784472935f,
+    -0.0118292011f, 0.00453173835f, -0.000480399933f, -5.09998717e-05f,
+    0.243881509f, -0.127422661f, 0.0351042859f, 0.00737763010f,
+    -0.0116710234f, 0.00452188496f, -0.000491734128f, -4.82402647e-05f,
+    0.239346772f, -0.127113104f, 0.0357099883f, 0.00691327127f,
+    -0.0115117533f, 0.00451094378f, -0.000502671755f, -4.55589252e-05f,
+    0.234823063f, -0.126777872f, 0.0363022499f, 0.00645173807f,
+    -0.0113514438f, 0.00449893298f, -0.000513216073f, -4.29554057e-05f,
+    0.230310902f, -0.126417294f, 0.0368810445f, 0.00599311665f,
+    -0.0111901481f, 0.00448586978f, -0.000523370574f, -4.04292368e-05f,
+    0.225810811f, -0.126031667f, 0.0374463573f, 0.00553748943f,
+    -0.0110279173f, 0.00447177235f, -0.000533138635f, -3.79799130e-05f,
+    0.221323282f, -0.125621304f, 0.0379981771f, 0.00508493930f,
+    -0.0108648054f, 0.00445665931f, -0.000542523863f, -3.56068995e-05f,
+};
+
+// 44100 -> 48000 Hz, DYN_MED_QUALITY, float coefficients
+// passband(0, 0.002184): ripple 0.000556 dB, stopband(0.003219, 0.5): 83.59 dB, SNR 152.58 dB
+static const float kDynFilter1[] __attribute__((aligned(32))) = {
+    0.864328325f, 0.129433423f, -0.112605318f, 0.0884577408f,
+    -0.0616214499f, 0.0366037153f, -0.0166880954f, 0.00335367327f,
+    0.00367789622f, -0.00589964585f, 0.00526515953f, -0.00352224242f,
+    0.00182951114f, -0.000695195457f, 0.000146723483f, 1.70468738e-05f,
+    0.864286304f, 0.123771973f, -0.110526755f, 0.0877569541f,
+    -0.0616067424f, 0.0369029231f, -0.0170723349f, 0.00369316246f,
+    0.00343762734f, -0.00576158660f, 0.00520491740f, -0.00350810378f,
+    0.00183515577f, -0.000704600010f, 0.000153279485f, 1.41136043e-05f,
+    0.864160240f, 0.118146673f, -0.108430535f, 0.0870343223f,
+    -0.0615741238f, 0.0371899977f, -0.0174498335f, 0.00402996736f,
+    0.00319755217f, -0.00562257273f, 0.00514348457f, -0.00349300401f,
+    0.00184019713f, -0.000713700429f, 0.000159713731f, 1.12185517e-05f,
+    0.863950193f, 0.112558290f, -0.106317364f, 0.0862901583f,
+    -0.0615236908f, 0.0374649167f, -0.0178205147f, 0.00436400110f,
+    0.00295774057f, -0.00548265083f, 0.00508088665f, -0.00347695407f,
+    0.00184463814f, -0.000722496479f, 0.000166025347f, 8.36228901e-06f,
+    0.863656163f, 0.107007563f, -0.104187936f, 0.0855247900f,
+    -0.0614555404f, 0.0377276503f, -0.0181842986f, 0.00469517801f,
+    0.00271826261f, -0.00534186838f, 0.00501714973f, -0.00345996558f,
+    0.00184848206f, -0.000730987929f, 0.000172213506f, 5.54536700e-06f,
+    0.863278210f, 0.101495236f, -0.102042943f, 0.0847385451f,
+    -0.0613697730f, 0.0379781798f, -0.0185411107f, 0.00502341380f,
+    0.00247918791f, -0.00520027149f, 0.00495229941f, -0.00344204972f,
+    0.00185173214f, -0.000739174895f, 0.000178277434f, 2.76831247e-06f,
+    0.862816393f, 0.0960220322f, -0.0998830870f, 0.0839317739f,
+    -0.0612665005f, 0.0382164828f, -0.0188908763f, 0.00534862513f,
+    0.00224058516f, -0.00505790720f, 0.00488636270f, -0.00342321792f,
+    0.00185439200f, -0.000747057318f, 0.000184216406f, 3.16313589e-08f,
+    0.862270832f, 0.0905886739f, -0.0977090597f, 0.0831047967f,
+    -0.0611458309f, 0.0384425446f, -0.0192335248f, 0.00567073049f,
+    0.00200252328f, -0.00491482206f, 0.00481936522f, -0.00340348273f,
+    0.00185646513f, -0.000754635432f, 0.000190029750f, -2.66419283e-06f,
+    0.861641586f, 0.0851958618f, -0.0955215618f, 0.0822579637f,
+    -0.0610078797f, 0.0386563540f, -0.0195689872f, 0.00598964887f,
+    0.00176507002f, -0.00477106357f, 0.00475133397f, -0.00338285556f,
+    0.00185795536f, -0.000761909410f, 0.000195716857f, -5.31869910e-06f,
+    0.860928774f, 0.0798443034f, -0.0933212787f, 0.0813916251f,
+    -0.0608527660f, 0.0388579071f, -0.0198971983f, 0.00630530156f,
+    0.00152829301f, -0.00462667737f, 0.00468229549f, -0.00336134876f,
+    0.00185886666f, -0.000768879720f, 0.000201277129f, -7.93144773e-06f,
+    0.860132575f, 0.0745346695f, -0.0911089033f, 0.0805061236f,
+    -0.0606806204f, 0.0390471965f, -0.0202180948f, 0.00661761034f,
+    0.00129225920f, -0.00448171049f, 0.00461227680f, -0.00333897513f,
+    0.00185920321f, -0.000775546709f, 0.000206710043f, -1.05020226e-05f,
+    0.859253049f, 0.0692676529f, -0.0888851285f, 0.0796018094f,
+    -0.0604915656f, 0.0392242223f, -0.0205316134f, 0.00692649884f,
+    0.00105703506f, -0.00433620997f, 0.00454130536f, -0.00331574725f,
+    0.00185896934f, -0.000781911018f, 0.000212015162f, -1.30300277e-05f,
+    0.858290374f, 0.0640439093f, -0.0866506472f, 0.0786790550f,
+    -0.0602857396f, 0.0393889882f, -0.0208376963f, 0.00723189162f,
+    0.000822686241f, -0.00419022143f, 0.00446940726f, -0.00329167768f,
+    0.00185816921f, -0.000787973229f, 0.000217192035f, -1.55150883e-05f,
+    0.857244730f, 0.0588640980f, -0.0844061449f, 0.0777382031f,
+    -0.0600632764f, 0.0395415016f, -0.0211362876f, 0.00753371557f,
+    0.000589278236f, -0.00404379191f, 0.00439661043f, -0.00326677971f,
+    0.00185680762f, -0.000793734158f, 0.000222240284f, -1.79568542e-05f,
+    0.856116354f, 0.0537288599f, -0.0821522996f, 0.0767796263f,
+    -0.0598243214f, 0.0396817699f, -0.0214273334f, 0.00783189759f,
+    0.000356875506f, -0.00389696728f, 0.00432294235f, -0.00324106612f,
+    0.00185488921f, -0.000799194502f, 0.000227159602f, -2.03549953e-05f,
+    0.854905307f, 0.0486388281f, -0.0798898041f, 0.0758036897f,
+    -0.0595690161f, 0.0398098081f, -0.0217107814f, 0.00812636688f,
+    0.000125542196f, -0.00374979386f, 0.00424843049f, -0.00321455067f,
+    0.00185241876f, -0.000804355310f, 0.000231949685f, -2.27092005e-05f,
+    0.853612006f, 0.0435946286f, -0.0776193440f, 0.0748107657f,
+    -0.0592975169f, 0.0399256311f, -0.0219865832f, 0.00841705408f,
+    -0.000104658378f, -0.00360231730f, 0.00417310186f, -0.00318724685f,
+    0.00184940139f, -0.000809217512f, 0.000236610344f, -2.50191861e-05f,
+    0.852236509f, 0.0385968685f, -0.0753415897f, 0.0738012195f,
+    -0.0590099692f, 0.0400292650f, -0.0222546924f, 0.00870389119f,
+    -0.000333663455f, -0.00345458393f, 0.00409698486f, -0.00315916794f,
+    0.00184584211f, -0.000813782215f, 0.000241141359f, -2.72846810e-05f,
+    0.850779116f, 0.0336461477f, -0.0730572194f, 0.0727754310f,
+    -0.0587065332f, 0.0401207320f, -0.0225150641f, 0.00898681208f,
+    -0.000561411027f, -0.00330663892f, 0.00402010698f, -0.00313032814f,
+    0.00184174627f, -0.000818050641f, 0.000245542615f, -2.95054433e-05f,
+    0.849240124f, 0.0287430603f, -0.0707669035f, 0.0717337728f,
+    -0.0583873764f, 0.0402000584f, -0.0227676593f, 0.00926574972f,
+    -0.000787839643f, -0.00315852789f, 0.00394249614f, -0.00310074119f,
+    0.00183711911f, -0.000822024071f, 0.000249814038f, -3.16812475e-05f,
+    0.847619772f, 0.0238881763f, -0.0684713274f, 0.0706766322f,
+    -0.0580526553f, 0.0402672738f, -0.0230124351f, 0.00954064354f,
+    -0.00101288862f, -0.00301029603f, 0.00386417983f, -0.00307042105f,
+    0.00183196634f, -0.000825703901f, 0.000253955543f, -3.38118916e-05f,
+    0.845918298f, 0.0190820657f, -0.0661711469f, 0.0696043894f,
+    -0.0577025488f, 0.0403224155f, -0.0232493579f, 0.00981142838f,
+    -0.00123649812f, -0.00286198850f, 0.00378518621f, -0.00303938240f,
+    0.00182629353f, -0.000829091470f, 0.000257967185f, -3.58971884e-05f,
+    0.844136119f, 0.0143252825f, -0.0638670400f, 0.0685174242f,
+    -0.0573372208f, 0.0403655171f, -0.0234783906f, 0.0100780455f,
+    -0.00145860889f, -0.00271365023f, 0.00370554347f, -0.00300763920f,
+    0.00182010641f, -0.000832188409f, 0.000261848967f, -3.79369776e-05f,
+    0.842273474f, 0.00961836707f, -0.0615596548f, 0.0674161315f,
+    -0.0569568500f, 0.0403966270f, -0.0236995053f, 0.0103404354f,
+    -0.00167916238f, -0.00256532547f, 0.00362527929f, -0.00297520589f,
+    0.00181341078f, -0.000834996230f, 0.000265601033f, -3.99311175e-05f,
+    0.840330660f, 0.00496185059f, -0.0592496619f, 0.0663008988f,
+    -0.0565616153f, 0.0404157862f, -0.0239126701f, 0.0105985403f,
+    -0.00189810095f, -0.00241705892f, 0.00354442187f, -0.00294209761f,
+    0.00180621282f, -0.000837516738f, 0.000269223470f, -4.18794843e-05f,
+    0.838308096f, 0.000356252480f, -0.0569377132f, 0.0651721135f,
+    -0.0561517067f, 0.0404230393f, -0.0241178591f, 0.0108523034f,
+    -0.00211536768f, -0.00226889458f, 0.00346299913f, -0.00290832832f,
+    0.00179851858f, -0.000839751621f, 0.000272716512f, -4.37819799e-05f,
+    0.836206138f, -0.00419792067f, -0.0546244606f, 0.0640301630f,
+    -0.0557273030f, 0.0404184386f, -0.0243150480f, 0.0111016724f,
+    -0.00233090622f, -0.00212087599f, 0.00338103902f, -0.00287391338f,
+    0.00179033435f, -0.000841702800f, 0.000276080362f, -4.56385133e-05f,
+    0.834025085f, -0.00870017335f, -0.0523105524f, 0.0628754571f,
+    -0.0552885979f, 0.0404020399f, -0.0245042145f, 0.0113465916f,
+    -0.00254466129f, -0.00197304715f, 0.00329856970f, -0.00283886748f,
+    0.00178166630f, -0.000843372196f, 0.000279315282f, -4.74490298e-05f,
+    0.831765413f, -0.0131500242f, -0.0499966331f, 0.0617083833f,
+    -0.0548357852f, 0.0403739028f, -0.0246853419f, 0.0115870116f,
+    -0.00275657861f, -0.00182545080f, 0.00321561936f, -0.00280320575f,
+    0.00177252106f, -0.000844761787f, 0.000282421592f, -4.92134786e-05f,
+    0.829427481f, -0.0175470002f, -0.0476833433f, 0.0605293363f,
+    -0.0543690585f, 0.0403340831f, -0.0248584095f, 0.0118228830f,
+    -0.00296660396f, -0.00167813024f, 0.00313221593f, -0.00276694307f,
+    0.00176290493f, -0.000845873612f, 0.000285399641f, -5.09318379e-05f,
+    0.827011645f, -0.0218906440f, -0.0453713238f, 0.0593387224f,
+    -0.0538886152f, 0.0402826481f, -0.0250234045f, 0.0120541556f,
+    -0.00317468494f, -0.00153112807f, 0.00304838712f, -0.00273009483f,
+    0.00175282487f, -0.000846709881f, 0.000288249837f, -5.26041040e-05f,
+    0.824518442f, -0.0261805113f, -0.0430612005f, 0.0581369363f,
+    -0.0533946678f, 0.0402196608f, -0.0251803156f, 0.0122807845f,
+    -0.00338076917f, -0.00138448644f, 0.00296416110f, -0.00269267638f,
+    0.00174228742f, -0.000847272808f, 0.000290972588f, -5.42302841e-05f,
+    0.821948230f, -0.0304161627f, -0.0407536067f, 0.0569243804f,
+    -0.0528874099f, 0.0401451960f, -0.0253291335f, 0.0125027234f,
+    -0.00358480564f, -0.00123824738f, 0.00287956581f, -0.00265470264f,
+    0.00173129945f, -0.000847564719f, 0.000293568417f, -5.58104111e-05f,
+    0.819301546f, -0.0345971808f, -0.0384491608f, 0.0557014570f,
+    -0.0523670577f, 0.0400593244f, -0.0254698507f, 0.0127199311f,
+    -0.00378674385f, -0.00109245256f, 0.00279462873f, -0.00261618965f,
+    0.00171986793f, -0.000847587944f, 0.000296037819f, -5.73445359e-05f,
+    0.816578746f, -0.0387231559f, -0.0361484848f, 0.0544685721f,
+    -0.0518338233f, 0.0399621241f, -0.0256024618f, 0.0129323630f,
+    -0.00398653466f, -0.000947143009f, 0.00270937802f, -0.00257715234f,
+    0.00170799985f, -0.000847344927f, 0.000298381347f, -5.88327202e-05f,
+    0.813780367f, -0.0427936912f, -0.0338521935f, 0.0532261245f,
+    -0.0512879118f, 0.0398536697f, -0.0257269647f, 0.0131399808f,
+    -0.00418412918f, -0.000802359777f, 0.00262384140f, -0.00253760675f,
+    0.00169570232f, -0.000846838171f, 0.000300599582f, -6.02750588e-05f,
+    0.810906947f, -0.0468083993f, -0.0315608904f, 0.0519745238f,
+    -0.0507295504f, 0.0397340432f, -0.0258433595f, 0.0133427456f,
+    -0.00437948015f, -0.000658143312f, 0.00253804633f, -0.00249756803f,
+    0.00168298243f, -0.000846070237f, 0.000302693166f, -6.16716425e-05f,
+    0.807958961f, -0.0507669114f, -0.0292751864f, 0.0507141761f,
+    -0.0501589514f, 0.0396033339f, -0.0259516500f, 0.0135406200f,
+    -0.00457254099f, -0.000514533720f, 0.00245202030f, -0.00245705200f,
+    0.00166984764f, -0.000845043745f, 0.000304662768f, -6.30225986e-05f,
+    0.804936886f, -0.0546688698f, -0.0269956756f, 0.0494454801f,
+    -0.0495763384f, 0.0394616276f, -0.0260518398f, 0.0137335695f,
+    -0.00476326514f, -0.000371570612f, 0.00236579077f, -0.00241607428f,
+    0.00165630516f, -0.000843761372f, 0.000306509115f, -6.43280582e-05f,
+    0.801841259f, -0.0585139245f, -0.0247229505f, 0.0481688492f,
+    -0.0489819348f, 0.0393090136f, -0.0261439364f, 0.0139215598f,
+    -0.00495160837f, -0.000229293364f, 0.00227938499f, -0.00237465068f,
+    0.00164236245f, -0.000842225912f, 0.000308232906f, -6.55881813e-05f,
+    0.798672676f, -0.0623017401f, -0.0224576034f, 0.0468846858f,
+    -0.0483759716f, 0.0391455851f, -0.0262279492f, 0.0141045591f,
+    -0.00513752643f, -8.77407656e-05f, 0.00219283043f, -0.00233279704f,
+    0.00162802695f, -0.000840440101f, 0.000309834984f, -6.68031280e-05f,
+    0.795431674f, -0.0660319999f, -0.0202002134f, 0.0455933958f,
+    -0.0477586724f, 0.0389714390f, -0.0263038911f, 0.0142825367f,
+    -0.00532097649f, 5.30487305e-05f, 0.00210615434f, -0.00229052897f,
+    0.00161330623f, -0.000838406908f, 0.000311316078f, -6.79730947e-05f,
+    0.792118847f, -0.0697043911f, -0.0179513581f, 0.0442953855f,
+    -0.0471302718f, 0.0387866758f, -0.0263717752f, 0.0144554647f,
+    -0.00550191663f, 0.000193037151f, 0.00201938325f, -0.00224786229f,
+    0.00159820798f, -0.000836129242f, 0.000312677090f, -6.90982706e-05f,
+    0.788734734f, -0.0733186230f, -0.0157116111f, 0.0429910645f,
+    -0.0464910008f, 0.0385913923f, -0.0264316201f, 0.0146233151f,
+    -0.00568030542f, 0.000332186959f, 0.00193254417f, -0.00220481283f,
+    0.00158273987f, -0.000833610015f, 0.000313918892f, -7.01788813e-05f,
+    0.785279930f, -0.0768744126f, -0.0134815332f, 0.0416808352f,
+    -0.0458410941f, 0.0383856967f, -0.0264834408f, 0.0147860628f,
+    -0.00585610280f, 0.000470461091f, 0.00184566388f, -0.00216139643f,
+    0.00156690949f, -0.000830852310f, 0.000315032928f, -7.12151596e-05f,
+    0.781755090f, -0.0803714842f, -0.0112616876f, 0.0403651036f,
+    -0.0451807939f, 0.0381696932f, -0.0265272632f, 0.0149436835f,
+    -0.00602927059f, 0.000607822964f, 0.00175876892f, -0.00211762916f,
+    0.00155072485f, -0.000827859156f, 0.000316039223f, -7.22073528e-05f,
+    0.778160810f, -0.0838095844f, -0.00905262493f, 0.0390442796f,
+    -0.0445103347f, 0.0379434936f, -0.0265631080f, 0.0150961559f,
+    -0.00619976921f, 0.000744236400f, 0.00167188561f, -0.00207352662f,
+    0.00153419364f, -0.000824633811f, 0.000316929130f, -7.31557157e-05f,
+    0.774497688f, -0.0871884599f, -0.00685489411f, 0.0377187580f,
+    -0.0438299589f, 0.0377072059f, -0.0265910011f, 0.0152434586f,
+    -0.00636756280f, 0.000879665837f, 0.00158504036f, -0.00202910462f,
+    0.00151732378f, -0.000821179303f, 0.000317703671f, -7.40605319e-05f,
+    0.770766377f, -0.0905078948f, -0.00466903439f, 0.0363889523f,
+    -0.0431399122f, 0.0374609455f, -0.0266109705f, 0.0153855737f,
+    -0.00653261459f, 0.00101407606f, 0.00149825914f, -0.00198437925f,
+    0.00150012341f, -0.000817499007f, 0.000318363891f, -7.49220926e-05f,
+    0.766967595f, -0.0937676653f, -0.00249558105f, 0.0350552574f,
+    -0.0424404368f, 0.0372048318f, -0.0266230479f, 0.0155224828f,
+    -0.00669488916f, 0.00114743249f, 0.00141156779f, -0.00193936611f,
+    0.00148260023f, -0.000813596125f, 0.000318910839f, -7.57406960e-05f,
+    0.763101935f, -0.0969675556f, -0.000335061632f, 0.0337180831f,
+    -0.0417317785f, 0.0369389802f, -0.0266272631f, 0.0156541709f,
+    -0.00685435347f, 0.00127970090f, 0.00132499204f, -0.00189408101f,
+    0.00146476238f, -0.000809473975f, 0.000319345592f, -7.65166697e-05f,
+    0.759170115f, -0.100107379f, 0.00181200262f, 0.0323778242f,
+    -0.0410141833f, 0.0366635136f, -0.0266236514f, 0.0157806221f,
+    -0.00701097306f, 0.00141084776f, 0.00123855739f, -0.00184853980f,
+    0.00144661812f, -0.000805135933f, 0.000319669314f, -7.72503408e-05f,
+    0.755172789f, -0.103186958f, 0.00394509733f, 0.0310348850f,
+    -0.0402879044f, 0.0363785550f, -0.0266122501f, 0.0159018263f,
+    -0.00716471719f, 0.00154083990f, 0.00115228933f, -0.00180275831f,
+    0.00142817525f, -0.000800585432f, 0.000319883140f, -7.79420589e-05f,
+    0.751110673f, -0.106206119f, 0.00606371416f, 0.0296896603f,
+    -0.0395531915f, 0.0360842273f, -0.0265930984f, 0.0160177741f,
+    -0.00731555372f, 0.00166964484f, 0.00106621266f, -0.00175675203f,
+    0.00140944216f, -0.000795825908f, 0.000319988263f, -7.85921729e-05f,
+    0.746984482f, -0.109164715f, 0.00816735253f, 0.0283425525f,
+    -0.0388102978f, 0.0357806645f, -0.0265662353f, 0.0161284525f,
+    -0.00746345334f, 0.00179723056f, 0.000980352634f, -0.00171053689f,
+    0.00139042689f, -0.000790860795f, 0.000319985847f, -7.92010615e-05f,
+    0.742794871f, -0.112062603f, 0.0102555184f, 0.0269939546f,
+    -0.0380594693f, 0.0354679935f, -0.0265317056f, 0.0162338540f,
+    -0.00760838669f, 0.00192356552f, 0.000894733588f, -0.00166412839f,
+    0.00137113757f, -0.000785693701f, 0.000319877145f, -7.97690955e-05f,
+    0.738542736f, -0.114899650f, 0.0123277251f, 0.0256442595f,
+    -0.0373009704f, 0.0351463407f, -0.0264895540f, 0.0163339768f,
+    -0.00775032584f, 0.00204861886f, 0.000809380203f, -0.00161754224f,
+    0.00135158270f, -0.000780328119f, 0.000319663435f, -8.02966824e-05f,
+    0.734228611f, -0.117675737f, 0.0143834921f, 0.0242938641f,
+    -0.0365350470f, 0.0348158516f, -0.0264398288f, 0.0164288115f,
+    -0.00788924377f, 0.00217236020f, 0.000724316633f, -0.00157079380f,
+    0.00133177021f, -0.000774767715f, 0.000319345942f, -8.07842152e-05f,
+    0.729853451f, -0.120390773f, 0.0164223481f, 0.0229431577f,
+    -0.0357619636f, 0.0344766527f, -0.0263825748f, 0.0165183600f,
+    -0.00802511536f, 0.00229475973f, 0.000639566861f, -0.00152389880f,
+    0.00131170847f, -0.000769015984f, 0.000318926031f, -8.12321232e-05f,
+    0.725417852f, -0.123044655f, 0.0184438247f, 0.0215925276f,
+    -0.0349819735f, 0.0341288857f, -0.0263178479f, 0.0166026186f,
+    -0.00815791450f, 0.00241578836f, 0.000555154635f, -0.00147687248f,
+    0.00129140588f, -0.000763076707f, 0.000318404956f, -8.16408283e-05f,
+    0.720922649f, -0.125637308f, 0.0204474684f, 0.0202423651f,
+    -0.0341953337f, 0.0337726921f, -0.0262456983f, 0.0166815873f,
+    -0.00828761887f, 0.00253541721f, 0.000471103471f, -0.00142973033f,
+    0.00127087056f, -0.000756953552f, 0.000317784114f, -8.20107598e-05f,
+    0.716368616f, -0.128168672f, 0.0224328265f, 0.0188930538f,
+    -0.0334023014f, 0.0334082134f, -0.0261661820f, 0.0167552680f,
+    -0.00841420423f, 0.00265361834f, 0.000387436623f, -0.00138248748f,
+    0.00125011080f, -0.000750650128f, 0.000317064871f, -8.23423834e-05f,
+    0.711756587f, -0.130638689f, 0.0243994556f, 0.0175449755f,
+    -0.0326031446f, 0.0330355912f, -0.0260793567f, 0.0168236662f,
+    -0.00853765011f, 0.00277036428f, 0.000304177025f, -0.00133515941f,
+    0.00122913509f, -0.000744170276f, 0.000316248566f, -8.26361429e-05f,
+    0.707087338f, -0.133047327f, 0.0263469201f, 0.0161985122f,
+    -0.0317981131f, 0.0326549709f, -0.0259852801f, 0.0168867856f,
+    -0.00865793601f, 0.00288562803f, 0.000221347436f, -0.00128776103f,
+    0.00120795157f, -0.000737517781f, 0.000315336656f, -8.28925113e-05f,
+    0.702361584f, -0.135394558f, 0.0282747950f, 0.0148540437f,
+    -0.0309874751f, 0.0322664976f, -0.0258840136f, 0.0169446319f,
+    -0.00877504144f, 0.00299938349f, 0.000138970296f, -0.00124030758f,
+    0.00118656864f, -0.000730696309f, 0.000314330566f, -8.31119614e-05f,
+    0.697580278f, -0.137680352f, 0.0301826578f, 0.0135119455f,
+    -0.0301714875f, 0.0318703242f, -0.0257756207f, 0.0169972144f,
+    -0.00888894778f, 0.00311160507f, 5.70677512e-05f, -0.00119281386f,
+    0.00116499455f, -0.000723709760f, 0.000313231692f, -8.32949881e-05f,
+    0.692744195f, -0.139904723f, 0.0320700966f, 0.0121725909f,
+    -0.0293504149f, 0.0314666033f, -0.0256601628f, 0.0170445442f,
+    -0.00899963826f, 0.00322226738f, -2.43382856e-05f, -0.00114529498f,
+    0.00114323769f, -0.000716561917f, 0.000312041520f, -8.34420862e-05f,
+    0.687854171f, -0.142067686f, 0.0339367092f, 0.0108363517f,
+    -0.0285245162f, 0.0310554784f, -0.0255377088f, 0.0170866288f,
+    -0.00910709705f, 0.00333134597f, -0.000105226223f, -0.00109776552f,
+    0.00112130621f, -0.000709256681f, 0.000310761563f, -8.35537430e-05f,
+    0.682911038f, -0.144169256f, 0.0357820950f, 0.00950359646f,
+    -0.0276940539f, 0.0306371097f, -0.0254083257f, 0.0171234850f,
+    -0.00921130739f, 0.00343881734f, -0.000185574754f, -0.00105024024f,
+    0.00109920849f, -0.000701797893f, 0.000309393246f, -8.36304898e-05f,
+    0.677915692f, -0.146209463f, 0.0376058705f, 0.00817469042f,
+    -0.0268592909f, 0.0302116480f, -0.0252720844f, 0.0171551257f,
+    -0.00931225531f, 0.00354465796f, -0.000265362847f, -0.00100273383f,
+    0.00107695290f, -0.000694189395f, 0.000307938142f, -8.36728359e-05f,
+    0.672868967f, -0.148188353f, 0.0394076519f, 0.00684999628f,
+    -0.0260204896f, 0.0297792517f, -0.0251290537f, 0.0171815641f,
+    -0.00940992869f, 0.00364884525f, -0.000344569824f, -0.000955260708f,
+    0.00105454761f, -0.000686435145f, 0.000306397735f, -8.36813124e-05f,
+    0.667771697f, -0.150106013f, 0.0411870703f, 0.00552987447f,
+    -0.0251779128f, 0.0293400791f, -0.0249793101f, 0.0172028206f,
+    -0.00950431451f, 0.00375135755f, -0.000423175254f, -0.000907835201f,
+    0.00103200087f, -0.000678539043f, 0.000304773595f, -8.36564432e-05f,
+    0.662624776f, -0.151962489f, 0.0429437570f, 0.00421468168f,
+    -0.0243318193f, 0.0288942866f, -0.0248229261f, 0.0172189120f,
+    -0.00959540065f, 0.00385217322f, -0.000501159055f, -0.000860471628f,
+    0.00100932084f, -0.000670504931f, 0.000303067238f, -8.35987739e-05f,
+    0.657429099f, -0.153757870f, 0.0446773618f, 0.00290477159f,
+    -0.0234824754f, 0.0284420345f, -0.0246599782f, 0.0172298588f,
+    -0.00968317874f, 0.00395127153f, -0.000578501436f, -0.000813184131f,
+    0.000986515894f, -0.000662336824f, 0.000301280234f, -8.35088576e-05f,
+    0.652185619f, -0.155492261f, 0.0463875346f, 0.00160049461f,
+    -0.0226301383f, 0.0279834848f, -0.0244905446f, 0.0172356833f,
+    -0.00976763945f, 0.00404863246f, -0.000655182928f, -0.000765986741f,
+    0.000963594008f, -0.000654038624f, 0.000299414154f, -8.33872400e-05f,
+    0.646895111f, -0.157165766f, 0.0480739363f, 0.000302198110f,
+    -0.0217750743f, 0.0275188014f, -0.0243147053f, 0.0172364078f,
+    -0.00984877348f, 0.00414423691f, -0.000731184438f, -0.000718893367f,
+    0.000940563565f, -0.000645614287f, 0.000297470629f, -8.32344813e-05f,
+    0.641558588f, -0.158778504f, 0.0497362316f, -0.000989774242f,
+    -0.0209175404f, 0.0270481445f, -0.0241325404f, 0.0172320567f,
+    -0.00992657524f, 0.00423806533f, -0.000806487107f, -0.000671917689f,
+    0.000917432480f, -0.000637067773f, 0.000295451202f, -8.30511490e-05f,
+    0.636176884f, -0.160330623f, 0.0513741076f, -0.00227508182f,
+    -0.0200577974f, 0.0265716799f, -0.0239441339f, 0.0172226541f,
+    -0.0100010382f, 0.00433010049f, -0.000881072425f, -0.000625073386f,
+    0.000894209021f, -0.000628403039f, 0.000293357502f, -8.28378033e-05f,
+    0.630750954f, -0.161822245f, 0.0529872403f, -0.00355338817f,
+    -0.0191961080f, 0.0260895733f, -0.0237495694f, 0.0172082298f,
+    -0.0100721577f, 0.00442032423f, -0.000954922347f, -0.000578374020f,
+    0.000870901102f, -0.000619623985f, 0.000291191158f, -8.25950265e-05f,
+    0.625281751f, -0.163253546f, 0.0545753278f, -0.00482435990f,
+    -0.0183327291f, 0.0256019924f, -0.0235489309f, 0.0171888117f,
+    -0.0101399301f, 0.00450871978f, -0.00102801900f, -0.000531832920f,
+    0.000847516872f, -0.000610734685f, 0.000288953772f, -8.23234004e-05f,
+    0.619770169f, -0.164624676f, 0.0561380759f, -0.00608766731f,
+    -0.0174679197f, 0.0251091011f, -0.0233423077f, 0.0171644296f,
+    -0.0102043515f, 0.00459527085f, -0.00110034493f, -0.000485463301f,
+    0.000824064191f, -0.000601738982f, 0.000286646973f, -8.20235073e-05f,
+    0.614217222f, -0.165935844f, 0.0576751940f, -0.00734298443f,
+    -0.0166019406f, 0.0246110708f, -0.0231297854f, 0.0171351135f,
+    -0.0102654211f, 0.00467996253f, -0.00117188296f, -0.000439278199f,
+    0.000800551090f, -0.000592640950f, 0.000284272392f, -8.16959291e-05f,
+    0.608623743f, -0.167187214f, 0.0591864027f, -0.00858998951f,
+    -0.0157350451f, 0.0241080690f, -0.0229114555f, 0.0171008967f,
+    -0.0103231370f, 0.00476277946f, -0.00124261645f, -0.000393290597f,
+    0.000776985486f, -0.000583444431f, 0.000281831715f, -8.13412553e-05f,
+    0.602990687f, -0.168378994f, 0.0606714264f, -0.00982836541f,
+    -0.0148674911f, 0.0236002635f, -0.0226874091f, 0.0170618128f,
+    -0.0103775011f, 0.00484370720f, -0.00131252885f, -0.000347513240f,
+    0.000753375120f, -0.000574153499f, 0.000279326545f, -8.09600897e-05f,
+    0.597319126f, -0.169511408f, 0.0621300079f, -0.0110577960f,
+    -0.0139995338f, 0.0230878275f, -0.0224577375f, 0.0170178972f,
+    -0.0104285134f, 0.00492273271f, -0.00138160423f, -0.000301958760f,
+    0.000729727908f, -0.000564771995f, 0.000276758568f, -8.05530217e-05f,
+    0.591609895f, -0.170584679f, 0.0635618865f, -0.0122779738f,
+    -0.0131314276f, 0.0225709286f, -0.0222225338f, 0.0169691853f,
+    -0.0104761766f, 0.00499984203f, -0.00144982676f, -0.000256639614f,
+    0.000706051535f, -0.000555303937f, 0.000274129416f, -8.01206552e-05f,
+    0.585864067f, -0.171599045f, 0.0649668276f, -0.0134885907f,
+    -0.0122634256f, 0.0220497400f, -0.0219818931f, 0.0169157181f,
+    -0.0105204936f, 0.00507502398f, -0.00151718105f, -0.000211568098f,
+    0.000682353741f, -0.000545753224f, 0.000271440775f, -7.96635941e-05f,
+    0.580082536f, -0.172554746f, 0.0663445815f, -0.0146893458f,
+    -0.0113957804f, 0.0215244330f, -0.0217359103f, 0.0168575291f,
+    -0.0105614681f, 0.00514826644f, -0.00158365234f, -0.000166756348f,
+    0.000658642151f, -0.000536123815f, 0.000268694304f, -7.91824423e-05f,
+    0.574266255f, -0.173452049f, 0.0676949322f, -0.0158799421f,
+    -0.0105287414f, 0.0209951811f, -0.0214846842f, 0.0167946629f,
+    -0.0105991066f, 0.00521955872f, -0.00164922571f, -0.000122216341f,
+    0.000634924392f, -0.000526419550f, 0.000265891664f, -7.86778110e-05f,
+    0.568416297f, -0.174291223f, 0.0690176487f, -0.0170600861f,
+    -0.00966256019f, 0.0204621553f, -0.0212283116f, 0.0167271569f,
+    -0.0106334146f, 0.00528889010f, -0.00171388709f, -7.79598922e-05f,
+    0.000611207914f, -0.000516644446f, 0.000263034541f, -7.81502968e-05f,
+    0.562533617f, -0.175072566f, 0.0703125298f, -0.0182294901f,
+    -0.00879748259f, 0.0199255291f, -0.0209668931f, 0.0166550577f,
+    -0.0106643988f, 0.00535625080f, -0.00177762262f, -3.39986145e-05f,
+    0.000587500283f, -0.000506802287f, 0.000260124565f, -7.76005181e-05f,
+    0.556619167f, -0.175796330f, 0.0715793669f, -0.0193878673f,
+    -0.00793375634f, 0.0193854757f, -0.0207005255f, 0.0165784061f,
+    -0.0106920684f, 0.00542163244f, -0.00184041879f, 9.65602885e-06f,
+    0.000563808891f, -0.000496897032f, 0.000257163454f, -7.70290935e-05f,
+    0.550673902f, -0.176462859f, 0.0728179663f, -0.0205349401f,
+    -0.00707162730f, 0.0188421682f, -0.0204293150f, 0.0164972488f,
+    -0.0107164308f, 0.00548502570f, -0.00190226233f, 5.29927565e-05f,
+    0.000540141074f, -0.000486932491f, 0.000254152837f, -7.64366196e-05f,
+    0.544698954f, -0.177072436f, 0.0740281492f, -0.0216704309f,
+    -0.00621133810f, 0.0182957817f, -0.0201533586f, 0.0164116304f,
+    -0.0107374974f, 0.00554642407f, -0.00196314044f, 9.60004618e-05f,
+    0.000516504049f, -0.000476912566f, 0.000251094432f, -7.58237220e-05f,
+    0.538695216f, -0.177625403f, 0.0752097368f, -0.0227940716f,
+    -0.00535313087f, 0.0177464895f, -0.0198727623f, 0.0163215976f,
+    -0.0107552791f, 0.00560581964f, -0.00202304102f, 0.000138668227f,
+    0.000492905092f, -0.000466841011f, 0.000247989869f, -7.51910047e-05f,
+    0.532663703f, -0.178122088f, 0.0763625652f, -0.0239055939f,
+    -0.00449724635f, 0.0171944629f, -0.0195876304f, 0.0162271988f,
+    -0.0107697863f, 0.00566320587f, -0.00208195182f, 0.000180985313f,
+    0.000469351333f, -0.000456721726f, 0.000244840805f, -7.45390789e-05f,
+    0.526605487f, -0.178562835f, 0.0774864703f, -0.0250047389f,
+    -0.00364392344f, 0.0166398790f, -0.0192980655f, 0.0161284823f,
+    -0.0107810330f, 0.00571857765f, -0.00213986123f, 0.000222941177f,
+    0.000445849815f, -0.000446558406f, 0.000241648944f, -7.38685630e-05f,
+    0.520521462f, -0.178947985f, 0.0785813034f, -0.0260912478f,
+    -0.00279339799f, 0.0160829127f, -0.0190041754f, 0.0160255004f,
+    -0.0107890330f, 0.00577192940f, -0.00219675805f, 0.000264525443f,
+    0.000422407582f, -0.000436354923f, 0.000238415916f, -7.31800683e-05f,
+    0.514412701f, -0.179277927f, 0.0796469301f, -0.0271648690f,
+    -0.00194590550f, 0.0155237336f, -0.0187060665f, 0.0159183051f,
+    -0.0107938014f, 0.00582325691f, -0.00225263136f, 0.000305727910f,
+    0.000399031502f, -0.000426114944f, 0.000235143394f, -7.24742058e-05f,
+    0.508280277f, -0.179553032f, 0.0806832090f, -0.0282253586f,
+    -0.00110167882f, 0.0149625186f, -0.0184038449f, 0.0158069450f,
+    -0.0107953520f, 0.00587255601f, -0.00230747066f, 0.000346538640f,
+    0.000375728443f, -0.000415842223f, 0.000231833008f, -7.17515795e-05f,
+    0.502125084f, -0.179773659f, 0.0816900283f, -0.0292724706f,
+    -0.000260949048f, 0.0143994400f, -0.0180976205f, 0.0156914759f,
+    -0.0107937017f, 0.00591982389f, -0.00236126618f, 0.000386947824f,
+    0.000352505158f, -0.000405540457f, 0.000228486417f, -7.10128079e-05f,
+    0.495948255f, -0.179940224f, 0.0826672614f, -0.0303059705f,
+    0.000576055027f, 0.0138346711f, -0.0177874994f, 0.0155719509f,
+    -0.0107888691f, 0.00596505776f, -0.00241400767f, 0.000426945859f,
+    0.000329368369f, -0.000395213341f, 0.000225105265f, -7.02584875e-05f,
+    0.489750743f, -0.180053115f, 0.0836148039f, -0.0313256271f,
+    0.00140910654f, 0.0132683860f, -0.0174735915f, 0.0154484259f,
+    -0.0107808709f, 0.00600825530f, -0.00246568630f, 0.000466523372f,
+    0.000306324597f, -0.000384864514f, 0.000221691182f, -6.94892224e-05f,
+    0.483533591f, -0.180112749f, 0.0845325738f, -0.0323312096f,
+    0.00223798072f, 0.0127007570f, -0.0171560068f, 0.0153209567f,
+    -0.0107697267f, 0.00604941603f, -0.00251629273f, 0.000505671138f,
+    0.000283380446f, -0.000374497584f, 0.000218245797f, -6.87056308e-05f,
+    0.477297813f, -0.180119559f, 0.0854204595f, -0.0333224982f,
+    0.00306245498f, 0.0121319555f, -0.0168348588f, 0.0151896002f,
+    -0.0107554561f, 0.00608853856f, -0.00256581861f, 0.000544380106f,
+    0.000260542292f, -0.000364116160f, 0.000214770727f, -6.79082950e-05f,
+    0.471044421f, -0.180073977f, 0.0862784013f, -0.0342992768f,
+    0.00388230942f, 0.0115621546f, -0.0165102538f, 0.0150544140f,
+    -0.0107380794f, 0.00612562336f, -0.00261425576f, 0.000582641573f,
+    0.000237816494f, -0.000353723794f, 0.000211267601f, -6.70978261e-05f,
+    0.464774460f, -0.179976419f, 0.0871063173f, -0.0352613330f,
+    0.00469732611f, 0.0109915249f, -0.0161823072f, 0.0149154579f,
+    -0.0107176192f, 0.00616067043f, -0.00266159629f, 0.000620446866f,
+    0.000215209307f, -0.000343324034f, 0.000207737990f, -6.62748134e-05f,
+    0.458488971f, -0.179827347f, 0.0879041478f, -0.0362084620f,
+    0.00550728897f, 0.0104202377f, -0.0158511288f, 0.0147727914f,
+    -0.0106940977f, 0.00619368115f, -0.00270783296f, 0.000657787663f,
+    0.000192726933f, -0.000332920376f, 0.000204183525f, -6.54398536e-05f,
+    0.452188939f, -0.179627210f, 0.0886718333f, -0.0371404588f,
+    0.00631198566f, 0.00984846428f, -0.0155168325f, 0.0146264732f,
+    -0.0106675373f, 0.00622465787f, -0.00275295880f, 0.000694655697f,
+    0.000170375410f, -0.000322516309f, 0.000200605762f, -6.45935288e-05f,
+    0.445875406f, -0.179376483f, 0.0894093290f, -0.0380571336f,
+    0.00711120525f, 0.00927637238f, -0.0151795298f, 0.0144765666f,
+    -0.0106379613f, 0.00625360198f, -0.00279696705f, 0.000731043052f,
+    0.000148160747f, -0.000312115240f, 0.000197006302f, -6.37364283e-05f,
+    0.439549416f, -0.179075643f, 0.0901166052f, -0.0389582925f,
+    0.00790474005f, 0.00870413333f, -0.0148393363f, 0.0143231312f,
+    -0.0106053967f, 0.00628051767f, -0.00283985143f, 0.000766941928f,
+    0.000126088838f, -0.000301720604f, 0.000193386702f, -6.28691341e-05f,
+    0.433211982f, -0.178725168f, 0.0907936320f, -0.0398437455f,
+    0.00869238377f, 0.00813191384f, -0.0144963628f, 0.0141662322f,
+    -0.0105698667f, 0.00630540727f, -0.00288160611f, 0.000802344759f,
+    0.000104165483f, -0.000291335746f, 0.000189748520f, -6.19922212e-05f,
+    0.426864117f, -0.178325549f, 0.0914403796f, -0.0407133214f,
+    0.00947393384f, 0.00755988294f, -0.0141507257f, 0.0140059320f,
+    -0.0105313985f, 0.00632827636f, -0.00292222574f, 0.000837244210f,
+    8.23963856e-05f, -0.000280964014f, 0.000186093283f, -6.11062715e-05f,
+    0.420506865f, -0.177877292f, 0.0920568481f, -0.0415668376f,
+    0.0102491900f, 0.00698820595f, -0.0138025368f, 0.0138422949f,
+    -0.0104900189f, 0.00634912821f, -0.00296170521f, 0.000871633121f,
+    6.07871516e-05f, -0.000270608696f, 0.000182422547f, -6.02118453e-05f,
+    0.414141268f, -0.177380875f, 0.0926430300f, -0.0424041301f,
+    0.0110179549f, 0.00641705049f, -0.0134519134f, 0.0136753852f,
+    -0.0104457550f, 0.00636796933f, -0.00300003984f, 0.000905504567f,
+    3.93432929e-05f, -0.000260273053f, 0.000178737828f, -5.93095101e-05f,
+    0.407768309f, -0.176836848f, 0.0931989253f, -0.0432250351f,
+    0.0117800348f, 0.00584658049f, -0.0130989673f, 0.0135052688f,
+    -0.0103986366f, 0.00638480531f, -0.00303722522f, 0.000938851794f,
+    1.80702245e-05f, -0.000249960343f, 0.000175040623f, -5.83998262e-05f,
+    0.401389033f, -0.176245704f, 0.0937245488f, -0.0440293923f,
+    0.0125352358f, 0.00527696032f, -0.0127438148f, 0.0133320112f,
+    -0.0103486925f, 0.00639964268f, -0.00307325739f, 0.000971668342f,
+    -3.02673971e-06f, -0.000239673696f, 0.000171332431f, -5.74833502e-05f,
+    0.395004481f, -0.175607979f, 0.0942199230f, -0.0448170453f,
+    0.0132833701f, 0.00470835343f, -0.0123865716f, 0.0131556801f,
+    -0.0102959517f, 0.00641248887f, -0.00310813286f, 0.00100394792f,
+    -2.39423898e-05f, -0.000229416284f, 0.000167614737f, -5.65606315e-05f,
+    0.388615638f, -0.174924225f, 0.0946850777f, -0.0455878563f,
+    0.0140242521f, 0.00414092233f, -0.0120273503f, 0.0129763437f,
+    -0.0102404458f, 0.00642335089f, -0.00314184860f, 0.00103568437f,
+    -4.46716112e-05f, -0.000219191206f, 0.000163888995f, -5.56322157e-05f,
+    0.382223517f, -0.174194977f, 0.0951200500f, -0.0463416763f,
+    0.0147576965f, 0.00357482769f, -0.0116662681f, 0.0127940672f,
+    -0.0101822047f, 0.00643223757f, -0.00317440182f, 0.00106687192f,
+    -6.52093950e-05f, -0.000209001519f, 0.000160156676f, -5.46986412e-05f,
+    0.375829190f, -0.173420772f, 0.0955248848f, -0.0470783673f,
+    0.0154835256f, 0.00301022944f, -0.0113034397f, 0.0126089221f,
+    -0.0101212617f, 0.00643915730f, -0.00320578995f, 0.00109750486f,
+    -8.55508406e-05f, -0.000198850263f, 0.000156419221f, -5.37604428e-05f,
+    0.369433612f, -0.172602192f, 0.0958996415f, -0.0477978066f,
+    0.0162015595f, 0.00244728662f, -0.0109389797f, 0.0124209747f,
+    -0.0100576477f, 0.00644411938f, -0.00323601090f, 0.00112757774f,
+    -0.000105691142f, -0.000188740407f, 0.000152678025f, -5.28181481e-05f,
+    0.363037825f, -0.171739787f, 0.0962443724f, -0.0484998599f,
+    0.0169116259f, 0.00188615697f, -0.0105730025f, 0.0122302966f,
+    -0.00999139715f, 0.00644713407f, -0.00326506305f, 0.00115708541f,
+    -0.000125625607f, -0.000178674876f, 0.000148934516f, -5.18722809e-05f,
+    0.356642842f, -0.170834109f, 0.0965591520f, -0.0491844155f,
+    0.0176135544f, 0.00132699672f, -0.0102056246f, 0.0120369559f,
+    -0.00992254354f, 0.00644821115f, -0.00329294521f, 0.00118602277f,
+    -0.000145349637f, -0.000168656581f, 0.000145190090f, -5.09233505e-05f,
+    0.350249648f, -0.169885769f, 0.0968440548f, -0.0498513505f,
+    0.0183071736f, 0.000769961276f, -0.00983695965f, 0.0118410252f,
+    -0.00985112134f, 0.00644736271f, -0.00331965624f, 0.00121438515f,
+    -0.000164858735f, -0.000158688345f, 0.000141446115f, -4.99718735e-05f,
+    0.343859255f, -0.168895334f, 0.0970991775f, -0.0505005643f,
+    0.0189923216f, 0.000215204302f, -0.00946712214f, 0.0116425734f,
+    -0.00977716502f, 0.00644459901f, -0.00334519590f, 0.00124216790f,
+    -0.000184148550f, -0.000148773004f, 0.000137703944f, -4.90183520e-05f,
+    0.337472677f, -0.167863384f, 0.0973245949f, -0.0511319488f,
+    0.0196688361f, -0.000337121630f, -0.00909622759f, 0.0114416732f,
+    -0.00970071089f, 0.00643993262f, -0.00336956372f, 0.00126936671f,
+    -0.000203214790f, -0.000138913296f, 0.000133964932f, -4.80632807e-05f,
+    0.331090897f, -0.166790530f, 0.0975204259f, -0.0517454110f,
+    0.0203365590f, -0.000886865426f, -0.00872439053f, 0.0112383952f,
+    -0.00962179340f, 0.00643337565f, -0.00339276018f, 0.00129597727f,
+    -0.000222053306f, -0.000129111941f, 0.000130230386f, -4.71071507e-05f,
+    0.324714899f, -0.165677369f, 0.0976867601f, -0.0523408540f,
+    0.0209953357f, -0.00143387751f, -0.00835172366f, 0.0110328114f,
+    -0.00954045169f, 0.00642494159f, -0.00341478526f, 0.00132199586f,
+    -0.000240660025f, -0.000119371594f, 0.000126501633f, -4.61504424e-05f,
+    0.318345696f, -0.164524511f, 0.0978237316f, -0.0529181957f,
+    0.0216450114f, -0.00197800947f, -0.00797834154f, 0.0108249951f,
+    -0.00945672113f, 0.00641464395f, -0.00343564036f, 0.00134741876f,
+    -0.000259031018f, -0.000109694884f, 0.000122779951f, -4.51936357e-05f,
+    0.311984271f, -0.163332552f, 0.0979314446f, -0.0534773543f,
+    0.0222854409f, -0.00251911464f, -0.00760435779f, 0.0106150182f,
+    -0.00937063992f, 0.00640249625f, -0.00345532666f, 0.00137224223f,
+    -0.000277162413f, -0.000100084377f, 0.000119066623f, -4.42371929e-05f,
+    0.305631608f, -0.162102118f, 0.0980100483f, -0.0540182516f,
+    0.0229164772f, -0.00305704819f, -0.00722988509f, 0.0104029533f,
+    -0.00928224623f, 0.00638851291f, -0.00347384554f, 0.00139646325f,
+    -0.000295050530f, -9.05426059e-05f, 0.000115362891f, -4.32815832e-05f,
+    0.299288660f, -0.160833821f, 0.0980596691f, -0.0545408204f,
+    0.0235379785f, -0.00359166600f, -0.00685503660f, 0.0101888748f,
+    -0.00919157825f, 0.00637270929f, -0.00349119911f, 0.00142007868f,
+    -0.000312691729f, -8.10720448e-05f, 0.000111669993f, -4.23272613e-05f,
+    0.292956412f, -0.159528315f, 0.0980804563f, -0.0550449975f,
+    0.0241498072f, -0.00412282674f, -0.00647992408f, 0.00997285545f,
+    -0.00909867696f, 0.00635510078f, -0.00350738945f, 0.00144308549f,
+    -0.000330082490f, -7.16751092e-05f, 0.000107989144f, -4.13746639e-05f,
+    0.286635876f, -0.158186197f, 0.0980725586f, -0.0555307232f,
+    0.0247518271f, -0.00465038931f, -0.00610465975f, 0.00975496881f,
+    -0.00900358055f, 0.00633570272f, -0.00352241960f, 0.00146548124f,
+    -0.000347219437f, -6.23541928e-05f, 0.000104321538f, -4.04242419e-05f,
+    0.280327946f, -0.156808138f, 0.0980361402f, -0.0559979416f,
+    0.0253439080f, -0.00517421588f, -0.00572935538f, 0.00953528937f,
+    -0.00890632905f, 0.00631453190f, -0.00353629212f, 0.00148726348f,
+    -0.000364099280f, -5.31116129e-05f, 0.000100668360f, -3.94764174e-05f,
+    0.274033606f, -0.155394748f, 0.0979713649f, -0.0564466119f,
+    0.0259259213f, -0.00569416909f, -0.00535412133f, 0.00931389071f,
+    -0.00880696345f, 0.00629160553f, -0.00354901049f, 0.00150842988f,
+    -0.000380718819f, -4.39496544e-05f, 9.70307592e-05f, -3.85316198e-05f,
+    0.267753839f, -0.153946698f, 0.0978784114f, -0.0568766892f,
+    0.0264977440f, -0.00621011341f, -0.00497906795f, 0.00909084640f,
+    -0.00870552473f, 0.00626693945f, -0.00356057845f, 0.00152897846f,
+    -0.000397075026f, -3.48705435e-05f, 9.34098716e-05f, -3.75902637e-05f,
+    0.261489540f, -0.152464613f, 0.0977574512f, -0.0572881363f,
+    0.0270592514f, -0.00672191614f, -0.00460430514f, 0.00886623189f,
+    -0.00860205479f, 0.00624055276f, -0.00357099995f, 0.00154890749f,
+    -0.000413164904f, -2.58764630e-05f, 8.98068174e-05f, -3.66527565e-05f,
+    0.255241692f, -0.150949165f, 0.0976086780f, -0.0576809198f,
+    0.0276103299f, -0.00722944550f, -0.00422994280f, 0.00864012074f,
+    -0.00849659462f, 0.00621246267f, -0.00358027918f, 0.00156821520f,
+    -0.000428985659f, -1.69695359e-05f, 8.62227025e-05f, -3.57194949e-05f,
+    0.249011219f, -0.149400994f, 0.0974322781f, -0.0580550209f,
+    0.0281508621f, -0.00773257157f, -0.00385608873f, 0.00841258839f,
+    -0.00838918705f, 0.00618268782f, -0.00358842104f, 0.00158690044f,
+    -0.000444534555f, -8.15184103e-06f, 8.26585892e-05f, -3.47908754e-05f,
+    0.242799059f, -0.147820771f, 0.0972284600f, -0.0584104136f,
+    0.0286807399f, -0.00823116582f, -0.00348285120f, 0.00818370841f,
+    -0.00827987399f, 0.00615124730f, -0.00359543017f, 0.00160496181f,
+    -0.000459808944f, 5.74595390e-07f, 7.91155398e-05f, -3.38672762e-05f,
+    0.236606121f, -0.146209165f, 0.0969974324f, -0.0587470867f,
+    0.0291998554f, -0.00872510392f, -0.00311033730f, 0.00795355625f,
+    -0.00816869829f, 0.00611815974f, -0.00360131217f, 0.00162239850f,
+    -0.000474806322f, 9.20779894e-06f, 7.55945875e-05f, -3.29490758e-05f,
+    0.230433330f, -0.144566834f, 0.0967393965f, -0.0590650290f,
+    0.0297081079f, -0.00921426062f, -0.00273865392f, 0.00772220595f,
+    -0.00805570371f, 0.00608344562f, -0.00360607239f, 0.00163920969f,
+    -0.000489524333f, 1.77458478e-05f, 7.20967437e-05f, -3.20366416e-05f,
+    0.224281594f, -0.142894447f, 0.0964545831f, -0.0593642406f,
+    0.0302053932f, -0.00969851390f, -0.00236790674f, 0.00748973247f,
+    -0.00794093311f, 0.00604712451f, -0.00360971666f, 0.00165539479f,
+    -0.000503960648f, 2.61868699e-05f, 6.86230051e-05f, -3.11303265e-05f,
+    0.218151823f, -0.141192675f, 0.0961432159f, -0.0596447214f,
+    0.0306916200f, -0.0101777446f, -0.00199820055f, 0.00725621032f,
+    -0.00782443117f, 0.00600921735f, -0.00361225149f, 0.00167095347f,
+    -0.000518113084f, 3.45290464e-05f, 6.51743467e-05f, -3.02304870e-05f,
+    0.212044910f, -0.139462203f, 0.0958055258f, -0.0599064752f,
+    0.0311666913f, -0.0106518334f, -0.00162963988f, 0.00702171400f,
+    -0.00770624122f, 0.00596974418f, -0.00361368340f, 0.00168588548f,
+    -0.000531979604f, 4.27706109e-05f, 6.17517071e-05f, -2.93374596e-05f,
+    0.205961749f, -0.137703717f, 0.0954417437f, -0.0601495169f,
+    0.0316305235f, -0.0111206640f, -0.00126232801f, 0.00678631803f,
+    -0.00758640794f, 0.00592872640f, -0.00361401890f, 0.00170019094f,
+    -0.000545558287f, 5.09098463e-05f, 5.83560141e-05f, -2.84515772e-05f,
+    0.199903220f, -0.135917872f, 0.0950521305f, -0.0603738651f,
+    0.0320830271f, -0.0115841245f, -0.000896367710f, 0.00655009644f,
+    -0.00746497605f, 0.00588618591f, -0.00361326546f, 0.00171387009f,
+    -0.000558847212f, 5.89450938e-05f, 5.49881843e-05f, -2.75731636e-05f,
+    0.193870202f, -0.134105369f, 0.0946369171f, -0.0605795421f,
+    0.0325241238f, -0.0120421005f, -0.000531860569f, 0.00631312374f,
+    -0.00734199071f, 0.00584214367f, -0.00361143006f, 0.00172692328f,
+    -0.000571844750f, 6.68747452e-05f, 5.16490945e-05f, -2.67025353e-05f,
+    0.187863573f, -0.132266894f, 0.0941963717f, -0.0607665777f,
+    0.0329537354f, -0.0124944840f, -0.000168907383f, 0.00607547397f,
+    -0.00721749663f, 0.00579662295f, -0.00360852061f, 0.00173935108f,
+    -0.000584549154f, 7.46972364e-05f, 4.83396107e-05f, -2.58399959e-05f,
+    0.181884170f, -0.130403131f, 0.0937307552f, -0.0609350018f,
+    0.0333717912f, -0.0129411668f, 0.000192391904f, 0.00583722116f,
+    -0.00709153945f, 0.00574964564f, -0.00360454526f, 0.00175115454f,
+    -0.000596959027f, 8.24110684e-05f, 4.50605730e-05f, -2.49858476e-05f,
+    0.175932869f, -0.128514767f, 0.0932403356f, -0.0610848553f,
+    0.0337782130f, -0.0133820428f, 0.000551938429f, 0.00559843890f,
+    -0.00696416432f, 0.00570123410f, -0.00359951193f, 0.00176233437f,
+    -0.000609072915f, 9.00147861e-05f, 4.18127966e-05f, -2.41403741e-05f,
+    0.170010507f, -0.126602486f, 0.0927253813f, -0.0612161830f,
+    0.0341729373f, -0.0138170095f, 0.000909634167f, 0.00535920076f,
+    -0.00683541736f, 0.00565141207f, -0.00359342946f, 0.00177289208f,
+    -0.000620889477f, 9.75069852e-05f, 3.85970779e-05f, -2.33038591e-05f,
+    0.164117917f, -0.124666989f, 0.0921861678f, -0.0613290332f,
+    0.0345559046f, -0.0142459655f, 0.00126538228f, 0.00511958031f,
+    -0.00670534419f, 0.00560020283f, -0.00358630647f, 0.00178282883f,
+    -0.000632407609f, 0.000104886327f, 3.54141921e-05f, -2.24765718e-05f,
+    0.158255935f, -0.122708969f, 0.0916229784f, -0.0614234582f,
+    0.0349270552f, -0.0146688120f, 0.00161908683f, 0.00487965019f,
+    -0.00657399092f, 0.00554763013f, -0.00357815181f, 0.00179214624f,
+    -0.000643626205f, 0.000112151516f, 3.22648884e-05f, -2.16587759e-05f,
+    0.152425364f, -0.120729119f, 0.0910361111f, -0.0614995174f,
+    0.0352863297f, -0.0150854522f, 0.00197065272f, 0.00463948352f,
+    -0.00644140411f, 0.00549371773f, -0.00356897525f, 0.00180084608f,
+    -0.000654544216f, 0.000119301301f, 2.91499000e-05f, -2.08507226e-05f,
+    0.146627039f, -0.118728131f, 0.0904258564f, -0.0615572743f,
+    0.0356336795f, -0.0154957911f, 0.00231998670f, 0.00439915294f,
+    -0.00630762940f, 0.00543848984f, -0.00355878612f, 0.00180893019f,
+    -0.000665160886f, 0.000126334504f, 2.60699308e-05f, -2.00526592e-05f,
+    0.140861735f, -0.116706707f, 0.0897925049f, -0.0615967996f,
+    0.0359690562f, -0.0158997383f, 0.00266699539f, 0.00415873015f,
+    -0.00617271429f, 0.00538197113f, -0.00354759418f, 0.00181640091f,
+    -0.000675475399f, 0.000133249981f, 2.30256665e-05f, -1.92648204e-05f,
+    0.135130271f, -0.114665538f, 0.0891363621f, -0.0616181642f,
+    0.0362924151f, -0.0162972026f, 0.00301158777f, 0.00391828734f,
+    -0.00603670394f, 0.00532418583f, -0.00353540946f, 0.00182326045f,
+    -0.000685487117f, 0.000140046657f, 2.00177674e-05f, -1.84874334e-05f,
+    0.129433423f, -0.112605318f, 0.0884577408f, -0.0616214499f,
+    0.0366037153f, -0.0166880954f, 0.00335367327f, 0.00367789622f,
+    -0.00589964585f, 0.00526515953f, -0.00352224242f, 0.00182951114f,
+    -0.000695195457f, 0.000146723483f, 1.70468738e-05f, -1.77207148e-05f,
+};
+
+// 48000 -> 44100 Hz, DYN_LOW_QUALITY, float coefficients
+// passband(0, 0.001085): ripple 0.001013 dB, stopband(0.003219, 0.5): 79.67 dB, SNR 150.97 dB
+static const float kDynFilter2[] __attribute__((aligned(32))) = {
+    0.632597864f, 0.274708271f, -0.0933726355f, -0.0195566732f,
+    0.0297838394f, -0.00635333173f, -0.00275049638f, 0.00113153062f,
+    0.632576883f, 0.270979255f, -0.0940377712f, -0.0186672322f,
+    0.0295857303f, -0.00646432163f, -0.00267890887f, 0.00112211844f,
+    0.632514060f, 0.267252415f, -0.0946773738f, -0.0177824032f,
+    0.0293833502f, -0.00657244818f, -0.00260775629f, 0.00111253210f,
+    0.632409275f, 0.263528198f, -0.0952915549f, -0.0169023257f,
+    0.0291767903f, -0.00667771976f, -0.00253705168f, 0.00110277813f,
+    0.632262588f, 0.259806961f, -0.0958804637f, -0.0160271395f,
+    0.0289661344f, -0.00678014522f, -0.00246680784f, 0.00109286315f,
+    0.632074058f, 0.256089151f, -0.0964442343f, -0.0151569806f,
+    0.0287514739f, -0.00687973341f, -0.00239703665f, 0.00108276168f,
+    0.631843686f, 0.252375126f, -0.0969830006f, -0.0142919812f,
+    0.0285328962f, -0.00697649457f, -0.00232775020f, 0.00107254565f,
+    0.631571531f, 0.248665333f, -0.0974969044f, -0.0134322736f,
+    0.0283104889f, -0.00707043847f, -0.00225896039f, 0.00106218818f,
+    0.631257594f, 0.244960129f, -0.0979861021f, -0.0125779873f,
+    0.0280843414f, -0.00716157723f, -0.00219067885f, 0.00105169544f,
+    0.630901873f, 0.241259947f, -0.0984507278f, -0.0117292479f,
+    0.0278545413f, -0.00724992156f, -0.00212291628f, 0.00104107393f,
+    0.630504489f, 0.237565160f, -0.0988909453f, -0.0108861802f,
+    0.0276211780f, -0.00733548449f, -0.00205568364f, 0.00103032973f,
+    0.630065441f, 0.233876169f, -0.0993068963f, -0.0100489073f,
+    0.0273843370f, -0.00741827814f, -0.00198899163f, 0.00101946900f,
+    0.629584849f, 0.230193362f, -0.0996987522f, -0.00921754912f,
+    0.0271441080f, -0.00749831600f, -0.00192285026f, 0.00100849802f,
+    0.629062712f, 0.226517126f, -0.100066654f, -0.00839222316f,
+    0.0269005783f, -0.00757561205f, -0.00185726956f, 0.000997422845f,
+    0.628499150f, 0.222847849f, -0.100410789f, -0.00757304439f,
+    0.0266538374f, -0.00765018025f, -0.00179225928f, 0.000986249303f,
+    0.627894163f, 0.219185919f, -0.100731298f, -0.00676012691f,
+    0.0264039710f, -0.00772203552f, -0.00172782864f, 0.000974983326f,
+    0.627247930f, 0.215531707f, -0.101028360f, -0.00595358061f,
+    0.0261510685f, -0.00779119367f, -0.00166398683f, 0.000963630911f,
+    0.626560450f, 0.211885586f, -0.101302147f, -0.00515351491f,
+    0.0258952156f, -0.00785767008f, -0.00160074246f, 0.000952197646f,
+    0.625831902f, 0.208247960f, -0.101552829f, -0.00436003553f,
+    0.0256365016f, -0.00792148151f, -0.00153810403f, 0.000940689351f,
+    0.625062287f, 0.204619184f, -0.101780578f, -0.00357324677f,
+    0.0253750104f, -0.00798264425f, -0.00147607992f, 0.000929111615f,
+    0.624251723f, 0.200999632f, -0.101985581f, -0.00279324991f,
+    0.0251108333f, -0.00804117601f, -0.00141467783f, 0.000917469966f,
+    0.623400390f, 0.197389662f, -0.102168001f, -0.00202014437f,
+    0.0248440523f, -0.00809709355f, -0.00135390542f, 0.000905769935f,
+    0.622508347f, 0.193789661f, -0.102328040f, -0.00125402701f,
+    0.0245747548f, -0.00815041736f, -0.00129377015f, 0.000894016877f,
+    0.621575713f, 0.190199986f, -0.102465868f, -0.000494992768f,
+    0.0243030302f, -0.00820116326f, -0.00123427890f, 0.000882216147f,
+    0.620602548f, 0.186621010f, -0.102581687f, 0.000256866188f,
+    0.0240289588f, -0.00824935269f, -0.00117543852f, 0.000870372984f,
+    0.619589090f, 0.183053061f, -0.102675669f, 0.00100145978f,
+    0.0237526316f, -0.00829500332f, -0.00111725554f, 0.000858492567f,
+    0.618535459f, 0.179496512f, -0.102748014f, 0.00173870032f,
+    0.0234741289f, -0.00833813660f, -0.00105973601f, 0.000846579962f,
+    0.617441714f, 0.175951719f, -0.102798916f, 0.00246850238f,
+    0.0231935382f, -0.00837877207f, -0.00100288610f, 0.000834640174f,
+    0.616308033f, 0.172419041f, -0.102828577f, 0.00319078285f,
+    0.0229109433f, -0.00841692928f, -0.000946711225f, 0.000822678208f,
+    0.615134597f, 0.168898806f, -0.102837183f, 0.00390546094f,
+    0.0226264279f, -0.00845263153f, -0.000891216972f, 0.000810698839f,
+    0.613921523f, 0.165391356f, -0.102824934f, 0.00461245840f,
+    0.0223400760f, -0.00848589931f, -0.000836408348f, 0.000798706955f,
+    0.612668991f, 0.161897048f, -0.102792040f, 0.00531169912f,
+    0.0220519714f, -0.00851675402f, -0.000782290183f, 0.000786707096f,
+    0.611377180f, 0.158416197f, -0.102738701f, 0.00600310881f,
+    0.0217621960f, -0.00854521804f, -0.000728867133f, 0.000774704036f,
+    0.610046208f, 0.154949173f, -0.102665119f, 0.00668661622f,
+    0.0214708317f, -0.00857131369f, -0.000676143507f, 0.000762702199f,
+    0.608676255f, 0.151496276f, -0.102571510f, 0.00736215198f,
+    0.0211779606f, -0.00859506428f, -0.000624123262f, 0.000750706065f,
+    0.607267559f, 0.148057848f, -0.102458075f, 0.00802964997f,
+    0.0208836645f, -0.00861649215f, -0.000572810299f, 0.000738720002f,
+    0.605820239f, 0.144634202f, -0.102325022f, 0.00868904404f,
+    0.0205880236f, -0.00863562245f, -0.000522208109f, 0.000726748316f,
+    0.604334474f, 0.141225681f, -0.102172576f, 0.00934027229f,
+    0.0202911198f, -0.00865247753f, -0.000472319953f, 0.000714795256f,
+    0.602810562f, 0.137832582f, -0.102000944f, 0.00998327602f,
+    0.0199930333f, -0.00866708159f, -0.000423148886f, 0.000702864840f,
+    0.601248562f, 0.134455234f, -0.101810344f, 0.0106179956f,
+    0.0196938422f, -0.00867945980f, -0.000374697673f, 0.000690961140f,
+    0.599648774f, 0.131093949f, -0.101600982f, 0.0112443762f,
+    0.0193936247f, -0.00868963543f, -0.000326968846f, 0.000679088174f,
+    0.598011374f, 0.127749011f, -0.101373091f, 0.0118623637f,
+    0.0190924592f, -0.00869763456f, -0.000279964705f, 0.000667249726f,
+    0.596336603f, 0.124420762f, -0.101126887f, 0.0124719087f,
+    0.0187904257f, -0.00870348234f, -0.000233687228f, 0.000655449636f,
+    0.594624639f, 0.121109471f, -0.100862585f, 0.0130729610f,
+    0.0184875987f, -0.00870720390f, -0.000188138263f, 0.000643691630f,
+    0.592875719f, 0.117815450f, -0.100580417f, 0.0136654750f,
+    0.0181840565f, -0.00870882533f, -0.000143319354f, 0.000631979317f,
+    0.591090083f, 0.114538997f, -0.100280605f, 0.0142494058f,
+    0.0178798754f, -0.00870837085f, -9.92318310e-05f, 0.000620316190f,
+    0.589267910f, 0.111280389f, -0.0999633744f, 0.0148247108f,
+    0.0175751299f, -0.00870586932f, -5.58767679e-05f, 0.000608705741f,
+    0.587409496f, 0.108039923f, -0.0996289477f, 0.0153913498f,
+    0.0172698945f, -0.00870134495f, -1.32550394e-05f, 0.000597151404f,
+    0.585515082f, 0.104817875f, -0.0992775559f, 0.0159492865f,
+    0.0169642419f, -0.00869482476f, 2.86327249e-05f, 0.000585656322f,
+    0.583584905f, 0.101614527f, -0.0989094302f, 0.0164984837f,
+    0.0166582484f, -0.00868633576f, 6.97861178e-05f, 0.000574223872f,
+    0.581619143f, 0.0984301567f, -0.0985247940f, 0.0170389097f,
+    0.0163519848f, -0.00867590401f, 0.000110204950f, 0.000562857080f,
+    0.579618156f, 0.0952650383f, -0.0981238857f, 0.0175705329f,
+    0.0160455257f, -0.00866355840f, 0.000149889252f, 0.000551558973f,
+    0.577582121f, 0.0921194255f, -0.0977069363f, 0.0180933233f,
+    0.0157389380f, -0.00864932500f, 0.000188839273f, 0.000540332578f,
+    0.575511396f, 0.0889935941f, -0.0972741693f, 0.0186072532f,
+    0.0154322973f, -0.00863323081f, 0.000227055469f, 0.000529180747f,
+    0.573406100f, 0.0858877972f, -0.0968258381f, 0.0191123001f,
+    0.0151256705f, -0.00861530472f, 0.000264538510f, 0.000518106273f,
+    0.571266651f, 0.0828022957f, -0.0963621587f, 0.0196084380f,
+    0.0148191284f, -0.00859557278f, 0.000301289285f, 0.000507111894f,
+    0.569093287f, 0.0797373429f, -0.0958833694f, 0.0200956501f,
+    0.0145127382f, -0.00857406482f, 0.000337308884f, 0.000496200169f,
+    0.566886187f, 0.0766931772f, -0.0953897163f, 0.0205739159f,
+    0.0142065696f, -0.00855080690f, 0.000372598530f, 0.000485373719f,
+    0.564645767f, 0.0736700520f, -0.0948814303f, 0.0210432187f,
+    0.0139006879f, -0.00852582790f, 0.000407159765f, 0.000474635017f,
+    0.562372267f, 0.0706682056f, -0.0943587497f, 0.0215035453f,
+    0.0135951601f, -0.00849915575f, 0.000440994248f, 0.000463986420f,
+    0.560065925f, 0.0676878691f, -0.0938219130f, 0.0219548829f,
+    0.0132900523f, -0.00847081933f, 0.000474103814f, 0.000453430257f,
+    0.557727158f, 0.0647292808f, -0.0932711586f, 0.0223972201f,
+    0.0129854297f, -0.00844084751f, 0.000506490527f, 0.000442968769f,
+    0.555356145f, 0.0617926642f, -0.0927067250f, 0.0228305496f,
+    0.0126813548f, -0.00840926636f, 0.000538156659f, 0.000432604109f,
+    0.552953243f, 0.0588782430f, -0.0921288505f, 0.0232548639f,
+    0.0123778917f, -0.00837610662f, 0.000569104624f, 0.000422338344f,
+    0.550518751f, 0.0559862405f, -0.0915377811f, 0.0236701611f,
+    0.0120751029f, -0.00834139623f, 0.000599336985f, 0.000412173482f,
+    0.548053026f, 0.0531168655f, -0.0909337476f, 0.0240764357f,
+    0.0117730498f, -0.00830516405f, 0.000628856535f, 0.000402111415f,
+    0.545556307f, 0.0502703339f, -0.0903170034f, 0.0244736895f,
+    0.0114717940f, -0.00826743804f, 0.000657666242f, 0.000392154034f,
+    0.543028951f, 0.0474468470f, -0.0896877795f, 0.0248619244f,
+    0.0111713959f, -0.00822824705f, 0.000685769191f, 0.000382303086f,
+    0.540471256f, 0.0446466170f, -0.0890463293f, 0.0252411421f,
+    0.0108719133f, -0.00818762090f, 0.000713168643f, 0.000372560258f,
+    0.537883580f, 0.0418698341f, -0.0883928835f, 0.0256113503f,
+    0.0105734048f, -0.00814558659f, 0.000739868148f, 0.000362927152f,
+    0.535266221f, 0.0391166992f, -0.0877276808f, 0.0259725526f,
+    0.0102759292f, -0.00810217485f, 0.000765871198f, 0.000353405369f,
+    0.532619596f, 0.0363873951f, -0.0870509744f, 0.0263247620f,
+    0.00997954234f, -0.00805741269f, 0.000791181636f, 0.000343996304f,
+    0.529943883f, 0.0336821117f, -0.0863630027f, 0.0266679861f,
+    0.00968430098f, -0.00801133085f, 0.000815803360f, 0.000334701414f,
+    0.527239621f, 0.0310010277f, -0.0856640041f, 0.0270022415f,
+    0.00939025916f, -0.00796395633f, 0.000839740387f, 0.000325521978f,
+    0.524506986f, 0.0283443239f, -0.0849542245f, 0.0273275394f,
+    0.00909747183f, -0.00791531801f, 0.000862996967f, 0.000316459278f,
+    0.521746337f, 0.0257121697f, -0.0842339024f, 0.0276438966f,
+    0.00880599301f, -0.00786544662f, 0.000885577407f, 0.000307514478f,
+    0.518958151f, 0.0231047366f, -0.0835032836f, 0.0279513337f,
+    0.00851587299f, -0.00781436823f, 0.000907486305f, 0.000298688683f,
+    0.516142666f, 0.0205221847f, -0.0827626064f, 0.0282498673f,
+    0.00822716579f, -0.00776211359f, 0.000928728201f, 0.000289982971f,
+    0.513300300f, 0.0179646779f, -0.0820121169f, 0.0285395216f,
+    0.00793992076f, -0.00770871015f, 0.000949307869f, 0.000281398272f,
+    0.510431349f, 0.0154323680f, -0.0812520534f, 0.0288203191f,
+    0.00765418867f, -0.00765418680f, 0.000969230197f, 0.000272935518f,
+    0.507536173f, 0.0129254078f, -0.0804826543f, 0.0290922858f,
+    0.00737001793f, -0.00759857241f, 0.000988500193f, 0.000264595554f,
+    0.504615247f, 0.0104439445f, -0.0797041655f, 0.0293554459f,
+    0.00708745699f, -0.00754189491f, 0.00100712315f, 0.000256379106f,
+    0.501668811f, 0.00798811857f, -0.0789168179f, 0.0296098311f,
+    0.00680655334f, -0.00748418318f, 0.00102510420f, 0.000248286931f,
+    0.498697311f, 0.00555806933f, -0.0781208649f, 0.0298554692f,
+    0.00652735308f, -0.00742546516f, 0.00104244857f, 0.000240319641f,
+    0.495701075f, 0.00315392972f, -0.0773165375f, 0.0300923921f,
+    0.00624990184f, -0.00736576924f, 0.00105916208f, 0.000232477818f,
+    0.492680520f, 0.000775828550f, -0.0765040740f, 0.0303206332f,
+    0.00597424433f, -0.00730512338f, 0.00107525010f, 0.000224761985f,
+    0.489635974f, -0.00157610932f, -0.0756837204f, 0.0305402298f,
+    0.00570042431f, -0.00724355550f, 0.00109071843f, 0.000217172579f,
+    0.486567885f, -0.00390176359f, -0.0748557076f, 0.0307512134f,
+    0.00542848418f, -0.00718109403f, 0.00110557291f, 0.000209709993f,
+    0.483476549f, -0.00620101858f, -0.0740202740f, 0.0309536271f,
+    0.00515846629f, -0.00711776642f, 0.00111981935f, 0.000202374562f,
+    0.480362415f, -0.00847376324f, -0.0731776580f, 0.0311475061f,
+    0.00489041209f, -0.00705360062f, 0.00113346393f, 0.000195166562f,
+    0.477225870f, -0.0107198888f, -0.0723280981f, 0.0313328952f,
+    0.00462436071f, -0.00698862365f, 0.00114651257f, 0.000188086196f,
+    0.474067271f, -0.0129392948f, -0.0714718252f, 0.0315098315f,
+    0.00436035218f, -0.00692286342f, 0.00115897157f, 0.000181133626f,
+    0.470887005f, -0.0151318815f, -0.0706090778f, 0.0316783637f,
+    0.00409842515f, -0.00685634743f, 0.00117084710f, 0.000174308938f,
+    0.467685521f, -0.0172975566f, -0.0697400793f, 0.0318385363f,
+    0.00383861619f, -0.00678910222f, 0.00118214579f, 0.000167612176f,
+    0.464463145f, -0.0194362290f, -0.0688650757f, 0.0319903940f,
+    0.00358096231f, -0.00672115525f, 0.00119287381f, 0.000161043325f,
+    0.461220324f, -0.0215478130f, -0.0679842979f, 0.0321339853f,
+    0.00332549936f, -0.00665253308f, 0.00120303780f, 0.000154602341f,
+    0.457957476f, -0.0236322321f, -0.0670979694f, 0.0322693624f,
+    0.00307226204f, -0.00658326270f, 0.00121264439f, 0.000148289066f,
+    0.454674929f, -0.0256894045f, -0.0662063211f, 0.0323965698f,
+    0.00282128388f, -0.00651337020f, 0.00122170022f, 0.000142103352f,
+    0.451373130f, -0.0277192630f, -0.0653095916f, 0.0325156674f,
+    0.00257259840f, -0.00644288259f, 0.00123021204f, 0.000136044968f,
+    0.448052496f, -0.0297217369f, -0.0644079968f, 0.0326267034f,
+    0.00232623727f, -0.00637182593f, 0.00123818661f, 0.000130113636f,
+    0.444713414f, -0.0316967666f, -0.0635017753f, 0.0327297337f,
+    0.00208223192f, -0.00630022539f, 0.00124563091f, 0.000124309037f,
+    0.441356301f, -0.0336442888f, -0.0625911430f, 0.0328248143f,
+    0.00184061262f, -0.00622810796f, 0.00125255180f, 0.000118630800f,
+    0.437981576f, -0.0355642512f, -0.0616763346f, 0.0329120010f,
+    0.00160140870f, -0.00615549879f, 0.00125895627f, 0.000113078509f,
+    0.434589654f, -0.0374566019f, -0.0607575662f, 0.0329913534f,
+    0.00136464869f, -0.00608242303f, 0.00126485142f, 0.000107651693f,
+    0.431180894f, -0.0393212996f, -0.0598350652f, 0.0330629312f,
+    0.00113036030f, -0.00600890629f, 0.00127024413f, 0.000102349848f,
+    0.427755773f, -0.0411582999f, -0.0589090511f, 0.0331267938f,
+    0.000898570288f, -0.00593497371f, 0.00127514184f, 9.71724148e-05f,
+    0.424314678f, -0.0429675654f, -0.0579797439f, 0.0331830047f,
+    0.000669304398f, -0.00586064951f, 0.00127955154f, 9.21187966e-05f,
+    0.420858055f, -0.0447490625f, -0.0570473671f, 0.0332316272f,
+    0.000442587712f, -0.00578595931f, 0.00128348055f, 8.71883531e-05f,
+    0.417386293f, -0.0465027653f, -0.0561121292f, 0.0332727209f,
+    0.000218444329f, -0.00571092637f, 0.00128693599f, 8.23804075e-05f,
+    0.413899809f, -0.0482286476f, -0.0551742539f, 0.0333063528f,
+    -3.10253176e-06f, -0.00563557586f, 0.00128992531f, 7.76942325e-05f,
+    0.410399020f, -0.0499266908f, -0.0542339534f, 0.0333325900f,
+    -0.000222030518f, -0.00555993104f, 0.00129245571f, 7.31290638e-05f,
+    0.406884372f, -0.0515968762f, -0.0532914437f, 0.0333514996f,
+    -0.000438318122f, -0.00548401615f, 0.00129453465f, 6.86841158e-05f,
+    0.403356284f, -0.0532391928f, -0.0523469336f, 0.0333631486f,
+    -0.000651944720f, -0.00540785445f, 0.00129616959f, 6.43585445e-05f,
+    0.399815172f, -0.0548536368f, -0.0514006354f, 0.0333676040f,
+    -0.000862890505f, -0.00533146970f, 0.00129736774f, 6.01514730e-05f,
+    0.396261454f, -0.0564402007f, -0.0504527614f, 0.0333649404f,
+    -0.00107113668f, -0.00525488378f, 0.00129813666f, 5.60619992e-05f,
+    0.392695546f, -0.0579988882f, -0.0495035127f, 0.0333552249f,
+    -0.00127666502f, -0.00517812092f, 0.00129848381f, 5.20891808e-05f,
+    0.389117897f, -0.0595297031f, -0.0485530980f, 0.0333385319f,
+    -0.00147945853f, -0.00510120252f, 0.00129841652f, 4.82320429e-05f,
+    0.385528922f, -0.0610326566f, -0.0476017222f, 0.0333149321f,
+    -0.00167950068f, -0.00502415095f, 0.00129794248f, 4.44895704e-05f,
+    0.381929040f, -0.0625077561f, -0.0466495901f, 0.0332844965f,
+    -0.00187677599f, -0.00494698901f, 0.00129706913f, 4.08607339e-05f,
+    0.378318697f, -0.0639550239f, -0.0456968993f, 0.0332473032f,
+    -0.00207126979f, -0.00486973813f, 0.00129580381f, 3.73444600e-05f,
+    0.374698311f, -0.0653744861f, -0.0447438546f, 0.0332034267f,
+    -0.00226296810f, -0.00479241973f, 0.00129415421f, 3.39396502e-05f,
+    0.371068299f, -0.0667661577f, -0.0437906459f, 0.0331529379f,
+    -0.00245185825f, -0.00471505476f, 0.00129212777f, 3.06451766e-05f,
+    0.367429078f, -0.0681300685f, -0.0428374782f, 0.0330959223f,
+    -0.00263792742f, -0.00463766512f, 0.00128973206f, 2.74598879e-05f,
+    0.363781124f, -0.0694662631f, -0.0418845415f, 0.0330324508f,
+    -0.00282116490f, -0.00456027081f, 0.00128697453f, 2.43825998e-05f,
+    0.360124797f, -0.0707747713f, -0.0409320295f, 0.0329625979f,
+    -0.00300155976f, -0.00448289234f, 0.00128386263f, 2.14121101e-05f,
+    0.356460571f, -0.0720556378f, -0.0399801321f, 0.0328864530f,
+    -0.00317910197f, -0.00440555019f, 0.00128040405f, 1.85471836e-05f,
+    0.352788895f, -0.0733089000f, -0.0390290394f, 0.0328040868f,
+    -0.00335378293f, -0.00432826392f, 0.00127660611f, 1.57865688e-05f,
+    0.349110126f, -0.0745346174f, -0.0380789377f, 0.0327155814f,
+    -0.00352559448f, -0.00425105402f, 0.00127247639f, 1.31289898e-05f,
+    0.345424742f, -0.0757328346f, -0.0371300131f, 0.0326210149f,
+    -0.00369452895f, -0.00417393865f, 0.00126802223f, 1.05731478e-05f,
+    0.341733158f, -0.0769036189f, -0.0361824483f, 0.0325204730f,
+    -0.00386057980f, -0.00409693783f, 0.00126325130f, 8.11772406e-06f,
+    0.338035822f, -0.0780470148f, -0.0352364294f, 0.0324140377f,
+    -0.00402374100f, -0.00402006973f, 0.00125817081f, 5.76138018e-06f,
+    0.334333122f, -0.0791631043f, -0.0342921317f, 0.0323017873f,
+    -0.00418400811f, -0.00394335343f, 0.00125278824f, 3.50275923e-06f,
+    0.330625474f, -0.0802519470f, -0.0333497338f, 0.0321838036f,
+    -0.00434137601f, -0.00386680709f, 0.00124711113f, 1.34048628e-06f,
+    0.326913387f, -0.0813136175f, -0.0324094146f, 0.0320601724f,
+    -0.00449584145f, -0.00379044819f, 0.00124114670f, -7.26830820e-07f,
+    0.323197186f, -0.0823481828f, -0.0314713418f, 0.0319309793f,
+    -0.00464740209f, -0.00371429487f, 0.00123490230f, -2.70059968e-06f,
+    0.319477350f, -0.0833557323f, -0.0305356942f, 0.0317963026f,
+    -0.00479605468f, -0.00363836414f, 0.00122838526f, -4.58224349e-06f,
+    0.315754294f, -0.0843363479f, -0.0296026375f, 0.0316562317f,
+    -0.00494179875f, -0.00356267346f, 0.00122160290f, -6.37319863e-06f,
+    0.312028438f, -0.0852901191f, -0.0286723413f, 0.0315108523f,
+    -0.00508463383f, -0.00348723936f, 0.00121456233f, -8.07491688e-06f,
+    0.308300227f, -0.0862171277f, -0.0277449731f, 0.0313602425f,
+    -0.00522455946f, -0.00341207837f, 0.00120727101f, -9.68885979e-06f,
+    0.304570019f, -0.0871174634f, -0.0268206932f, 0.0312044956f,
+    -0.00536157656f, -0.00333720678f, 0.00119973603f, -1.12165017e-05f,
+    0.300838292f, -0.0879912376f, -0.0258996654f, 0.0310436934f,
+    -0.00549568655f, -0.00326264044f, 0.00119196437f, -1.26593286e-05f,
+    0.297105461f, -0.0888385475f, -0.0249820501f, 0.0308779236f,
+    -0.00562689174f, -0.00318839494f, 0.00118396326f, -1.40188349e-05f,
+    0.293371916f, -0.0896594897f, -0.0240680017f, 0.0307072736f,
+    -0.00575519539f, -0.00311448541f, 0.00117573980f, -1.52965240e-05f,
+    0.289638102f, -0.0904541761f, -0.0231576804f, 0.0305318274f,
+    -0.00588060031f, -0.00304092746f, 0.00116730097f, -1.64939083e-05f,
+    0.285904408f, -0.0912227184f, -0.0222512372f, 0.0303516742f,
+    -0.00600311114f, -0.00296773505f, 0.00115865376f, -1.76125068e-05f,
+    0.282171279f, -0.0919652283f, -0.0213488210f, 0.0301668998f,
+    -0.00612273300f, -0.00289492309f, 0.00114980503f, -1.86538473e-05f,
+    0.278439075f, -0.0926818326f, -0.0204505846f, 0.0299775917f,
+    -0.00623947103f, -0.00282250554f, 0.00114076165f, -1.96194578e-05f,
+    0.274708271f, -0.0933726355f, -0.0195566732f, 0.0297838394f,
+    -0.00635333173f, -0.00275049638f, 0.00113153062f, -2.05108772e-05f,
+};
+
+// 48000 -> 44100 Hz, DYN_MED_QUALITY, float coefficients
+// passband(0, 0.002030): ripple 0.000488 dB, stopband(0.003156, 0.5): 83.89 dB, SNR 152.12 dB
+static const float kDynFilter3[] __attribute__((aligned(32))) = {
+    0.762286246f, 0.212809086f, -0.149248317f, 0.0725431293f,
+    -0.00967694260f, -0.0240008663f, 0.0292837825f, -0.0181477964f,
+    0.00433700904f, 0.00389700895f, -0.00542114163f, 0.00330342352f,
+    -0.000896088721f, -0.000279499014f, 0.000394030270f, -0.000164033467f,
+    0.762251973f, 0.207575709f, -0.148470894f, 0.0732539296f,
+    -0.0106489370f, -0.0233564619f, 0.0290941242f, -0.0182645209f,
+    0.00454259943f, 0.00374821690f, -0.00536641385f, 0.00331080309f,
+    -0.000920928316f, -0.000262179936f, 0.000387733511f, -0.000163227043f,
+    0.762149155f, 0.202359125f, -0.147659421f, 0.0739408955f,
+    -0.0116131082f, -0.0227088816f, 0.0288975034f, -0.0183756724f,
+    0.00474582287f, 0.00359927537f, -0.00531055406f, 0.00331719825f,
+    -0.000945297594f, -0.000244952796f, 0.000381391990f, -0.000162376557f,
+    0.761977851f, 0.197160035f, -0.146814391f, 0.0746039674f,
+    -0.0125692394f, -0.0220583137f, 0.0286940075f, -0.0184812490f,
+    0.00494663604f, 0.00345022720f, -0.00525358459f, 0.00332261459f,
+    -0.000969193177f, -0.000227821918f, 0.000375008269f, -0.000161482953f,
+    0.761738062f, 0.191979155f, -0.145936251f, 0.0752431229f,
+    -0.0135171153f, -0.0214049481f, 0.0284837279f, -0.0185812507f,
+    0.00514499610f, 0.00330111408f, -0.00519552920f, 0.00332705770f,
+    -0.000992612098f, -0.000210791608f, 0.000368584850f, -0.000160547192f,
+    0.761429846f, 0.186817169f, -0.145025462f, 0.0758583248f,
+    -0.0144565245f, -0.0207489785f, 0.0282667503f, -0.0186756775f,
+    0.00534086255f, 0.00315197837f, -0.00513641117f, 0.00333053293f,
+    -0.00101555116f, -0.000193866057f, 0.000362124294f, -0.000159570263f,
+    0.761053205f, 0.181674793f, -0.144082516f, 0.0764495507f,
+    -0.0153872594f, -0.0200905912f, 0.0280431714f, -0.0187645331f,
+    0.00553419394f, 0.00300286151f, -0.00507625379f, 0.00333304680f,
+    -0.00103800779f, -0.000177049413f, 0.000355629134f, -0.000158553114f,
+    0.760608256f, 0.176552713f, -0.143107891f, 0.0770167857f,
+    -0.0163091142f, -0.0194299761f, 0.0278130807f, -0.0188478194f,
+    0.00572495116f, 0.00285380520f, -0.00501508126f, 0.00333460514f,
+    -0.00105997943f, -0.000160345749f, 0.000349101843f, -0.000157496732f,
+    0.760095000f, 0.171451598f, -0.142102048f, 0.0775600150f,
+    -0.0172218867f, -0.0187673252f, 0.0275765751f, -0.0189255457f,
+    0.00591309555f, 0.00270485040f, -0.00495291734f, 0.00333521445f,
+    -0.00108146342f, -0.000143759025f, 0.000342544925f, -0.000156402093f,
+    0.759513617f, 0.166372120f, -0.141065493f, 0.0780792311f,
+    -0.0181253795f, -0.0181028228f, 0.0273337513f, -0.0189977176f,
+    0.00609858893f, 0.00255603786f, -0.00488978578f, 0.00333488174f,
+    -0.00110245752f, -0.000127293199f, 0.000335960853f, -0.000155270158f,
+    0.758864164f, 0.161314979f, -0.139998689f, 0.0785744488f,
+    -0.0190193988f, -0.0174366627f, 0.0270847026f, -0.0190643407f,
+    0.00628139498f, 0.00240740879f, -0.00482571032f, 0.00333361374f,
+    -0.00112295977f, -0.000110952096f, 0.000329352042f, -0.000154101916f,
+    0.758146703f, 0.156280831f, -0.138902143f, 0.0790456533f,
+    -0.0199037530f, -0.0167690292f, 0.0268295314f, -0.0191254299f,
+    0.00646147737f, 0.00225900323f, -0.00476071611f, 0.00333141768f,
+    -0.00114296819f, -9.47394874e-05f, 0.000322720938f, -0.000152898356f,
+    0.757361412f, 0.151270330f, -0.137776345f, 0.0794928744f,
+    -0.0207782537f, -0.0161001105f, 0.0265683345f, -0.0191809926f,
+    0.00663880166f, 0.00211086124f, -0.00469482690f, 0.00332830101f,
+    -0.00116248080f, -7.86590754e-05f, 0.000316069956f, -0.000151660439f,
+    0.756508410f, 0.146284118f, -0.136621788f, 0.0799161196f,
+    -0.0216427185f, -0.0154300956f, 0.0263012145f, -0.0192310456f,
+    0.00681333384f, 0.00196302240f, -0.00462806690f, 0.00332427095f,
+    -0.00118149607f, -6.27144764e-05f, 0.000309401483f, -0.000150389154f,
+    0.755587816f, 0.141322866f, -0.135438994f, 0.0803154260f,
+    -0.0224969648f, -0.0147591680f, 0.0260282699f, -0.0192756001f,
+    0.00698504038f, 0.00181552663f, -0.00456046080f, 0.00331933564f,
+    -0.00120001275f, -4.69092374e-05f, 0.000302717905f, -0.000149085492f,
+    0.754599750f, 0.136387199f, -0.134228438f, 0.0806908160f,
+    -0.0233408157f, -0.0140875159f, 0.0257496089f, -0.0193146747f,
+    0.00715389010f, 0.00166841259f, -0.00449203374f, 0.00331350300f,
+    -0.00121802918f, -3.12468255e-05f, 0.000296021550f, -0.000147750397f,
+    0.753544450f, 0.131477773f, -0.132990643f, 0.0810423270f,
+    -0.0241740979f, -0.0134153236f, 0.0254653301f, -0.0193482842f,
+    0.00731985085f, 0.00152171927f, -0.00442280993f, 0.00330678141f,
+    -0.00123554445f, -1.57306313e-05f, 0.000289314776f, -0.000146384875f,
+    0.752422094f, 0.126595184f, -0.131726116f, 0.0813700035f,
+    -0.0249966439f, -0.0127427746f, 0.0251755416f, -0.0193764493f,
+    0.00748289376f, 0.00137548498f, -0.00435281359f, 0.00329917902f,
+    -0.00125255750f, -3.63965853e-07f, 0.000282599853f, -0.000144989885f,
+    0.751232803f, 0.121740066f, -0.130435377f, 0.0816738978f,
+    -0.0258082859f, -0.0120700523f, 0.0248803496f, -0.0193991885f,
+    0.00764298905f, 0.00122974790f, -0.00428207079f, 0.00329070468f,
+    -0.00126906764f, 1.48499330e-05f, 0.000275879051f, -0.000143566416f,
+    0.749976814f, 0.116913043f, -0.129118934f, 0.0819540545f,
+    -0.0266088601f, -0.0113973413f, 0.0245798603f, -0.0194165241f,
+    0.00780010875f, 0.00108454574f, -0.00421060529f, 0.00328136701f,
+    -0.00128507393f, 2.99079093e-05f, 0.000269154698f, -0.000142115416f,
+    0.748654246f, 0.112114713f, -0.127777293f, 0.0822105482f,
+    -0.0273982119f, -0.0107248211f, 0.0242741797f, -0.0194284804f,
+    0.00795422588f, 0.000939915655f, -0.00413844222f, 0.00327117508f,
+    -0.00130057614f, 4.48068822e-05f, 0.000262428977f, -0.000140637872f,
+    0.747265458f, 0.107345678f, -0.126410991f, 0.0824434310f,
+    -0.0281761829f, -0.0100526744f, 0.0239634197f, -0.0194350816f,
+    0.00810531341f, 0.000795894768f, -0.00406560674f, 0.00326013798f,
+    -0.00131557370f, 5.95438505e-05f, 0.000255704101f, -0.000139134747f,
+    0.745810628f, 0.102606528f, -0.125020549f, 0.0826527774f,
+    -0.0289426222f, -0.00938108005f, 0.0236476865f, -0.0194363520f,
+    0.00825334713f, 0.000652519637f, -0.00399212399f, 0.00324826548f,
+    -0.00133006659f, 7.41158947e-05f, 0.000248982280f, -0.000137606999f,
+    0.744289935f, 0.0978978500f, -0.123606481f, 0.0828386769f,
+    -0.0296973847f, -0.00871021766f, 0.0233270954f, -0.0194323175f,
+    0.00839830283f, 0.000509826350f, -0.00391801866f, 0.00323556643f,
+    -0.00134405459f, 8.85201734e-05f, 0.000242265640f, -0.000136055605f,
+    0.742703736f, 0.0932202265f, -0.122169323f, 0.0830011964f,
+    -0.0304403268f, -0.00804026518f, 0.0230017528f, -0.0194230098f,
+    0.00854015723f, 0.000367850676f, -0.00384331588f, 0.00322205108f,
+    -0.00135753804f, 0.000102753918f, 0.000235556348f, -0.000134481481f,
+    0.741052151f, 0.0885742232f, -0.120709591f, 0.0831404328f,
+    -0.0311713070f, -0.00737139815f, 0.0226717740f, -0.0194084570f,
+    0.00867888704f, 0.000226628021f, -0.00376804080f, 0.00320772920f,
+    -0.00137051695f, 0.000116814444f, 0.000228856516f, -0.000132885616f,
+    0.739335597f, 0.0839604065f, -0.119227827f, 0.0832564756f,
+    -0.0318901911f, -0.00670379307f, 0.0223372690f, -0.0193886887f,
+    0.00881447271f, 8.61932785e-05f, -0.00369221810f, 0.00319261081f,
+    -0.00138299190f, 0.000130699162f, 0.000222168193f, -0.000131268927f,
+    0.737554252f, 0.0793793276f, -0.117724553f, 0.0833494291f,
+    -0.0325968489f, -0.00603762455f, 0.0219983533f, -0.0193637386f,
+    0.00894689374f, -5.34190440e-05f, -0.00361587317f, 0.00317670591f,
+    -0.00139496324f, 0.000144405523f, 0.000215493463f, -0.000129632390f,
+    0.735708475f, 0.0748315379f, -0.116200306f, 0.0834193975f,
+    -0.0332911462f, -0.00537306536f, 0.0216551404f, -0.0193336401f,
+    0.00907612965f, -0.000192174892f, -0.00353903067f, 0.00316002523f,
+    -0.00140643190f, 0.000157931107f, 0.000208834346f, -0.000127976906f,
+    0.733798563f, 0.0703175738f, -0.114655614f, 0.0834664926f,
+    -0.0339729674f, -0.00471028732f, 0.0213077441f, -0.0192984287f,
+    0.00920216367f, -0.000330040639f, -0.00346171577f, 0.00314257899f,
+    -0.00141739869f, 0.000171273525f, 0.000202192838f, -0.000126303406f,
+    0.731824756f, 0.0658379793f, -0.113091022f, 0.0834908187f,
+    -0.0346421860f, -0.00404946180f, 0.0209562816f, -0.0192581378f,
+    0.00932497717f, -0.000466983125f, -0.00338395359f, 0.00312437792f,
+    -0.00142786442f, 0.000184430508f, 0.000195570901f, -0.000124612852f,
+    0.729787469f, 0.0613932610f, -0.111507066f, 0.0834925026f,
+    -0.0352986902f, -0.00339075713f, 0.0206008665f, -0.0192128085f,
+    0.00944455527f, -0.000602969609f, -0.00330576883f, 0.00310543273f,
+    -0.00143783039f, 0.000197399859f, 0.000188970487f, -0.000122906131f,
+    0.727686942f, 0.0569839440f, -0.109904274f, 0.0834716707f,
+    -0.0359423608f, -0.00273434189f, 0.0202416163f, -0.0191624761f,
+    0.00956088211f, -0.000737967901f, -0.00322718662f, 0.00308575458f,
+    -0.00144729787f, 0.000210179423f, 0.000182393516f, -0.000121184159f,
+    0.725523651f, 0.0526105352f, -0.108283184f, 0.0834284574f,
+    -0.0365730971f, -0.00208038255f, 0.0198786482f, -0.0191071797f,
+    0.00967394374f, -0.000871946162f, -0.00314823142f, 0.00306535466f,
+    -0.00145626813f, 0.000222767194f, 0.000175841866f, -0.000119447846f,
+    0.723297834f, 0.0482735336f, -0.106644347f, 0.0833629966f,
+    -0.0371907949f, -0.00142904371f, 0.0195120797f, -0.0190469641f,
+    0.00978372619f, -0.00100487308f, -0.00306892837f, 0.00304424367f,
+    -0.00146474293f, 0.000235161162f, 0.000169317384f, -0.000117698088f,
+    0.721009910f, 0.0439734310f, -0.104988292f, 0.0832754225f,
+    -0.0377953500f, -0.000780489238f, 0.0191420261f, -0.0189818665f,
+    0.00989021733f, -0.00113671797f, -0.00298930216f, 0.00302243349f,
+    -0.00147272379f, 0.000247359480f, 0.000162821903f, -0.000115935785f,
+    0.718660235f, 0.0397107117f, -0.103315562f, 0.0831658915f,
+    -0.0383866653f, -0.000134881004f, 0.0187686067f, -0.0189119335f,
+    0.00999340694f, -0.00126745028f, -0.00290937722f, 0.00299993507f,
+    -0.00148021255f, 0.000259360328f, 0.000156357200f, -0.000114161812f,
+    0.716249228f, 0.0354858525f, -0.101626702f, 0.0830345452f,
+    -0.0389646478f, 0.000507620629f, 0.0183919426f, -0.0188372079f,
+    0.0100932829f, -0.00139704032f, -0.00282917824f, 0.00297676050f,
+    -0.00148721121f, 0.000271161960f, 0.000149925065f, -0.000112377049f,
+    0.713777244f, 0.0312993117f, -0.0999222472f, 0.0828815401f,
+    -0.0395292155f, 0.00114685681f, 0.0180121474f, -0.0187577344f,
+    0.0101898378f, -0.00152545876f, -0.00274872966f, 0.00295292097f,
+    -0.00149372197f, 0.000282762776f, 0.000143527199f, -0.000110582361f,
+    0.711244702f, 0.0271515530f, -0.0982027352f, 0.0827070400f,
+    -0.0400802791f, 0.00178267027f, 0.0176293459f, -0.0186735615f,
+    0.0102830613f, -0.00165267673f, -0.00266805617f, 0.00292842882f,
+    -0.00149974681f, 0.000294161146f, 0.000137165320f, -0.000108778615f,
+    0.708652020f, 0.0230430216f, -0.0964687169f, 0.0825112015f,
+    -0.0406177603f, 0.00241490570f, 0.0172436517f, -0.0185847338f,
+    0.0103729479f, -0.00177866581f, -0.00258718175f, 0.00290329545f,
+    -0.00150528818f, 0.000305355614f, 0.000130841072f, -0.000106966654f,
+    0.705999613f, 0.0189741608f, -0.0947207212f, 0.0822942108f,
+    -0.0411415808f, 0.00304340944f, 0.0168551877f, -0.0184913017f,
+    0.0104594901f, -0.00190339843f, -0.00250613084f, 0.00287753297f,
+    -0.00151034864f, 0.000316344784f, 0.000124552433f, -0.000105147330f,
+    0.703287959f, 0.0149454009f, -0.0929592997f, 0.0820562243f,
+    -0.0416516699f, 0.00366802909f, 0.0164640732f, -0.0183933135f,
+    0.0105426833f, -0.00202684710f, -0.00242492743f, 0.00285115372f,
+    -0.00151493074f, 0.000327127287f, 0.000118308628f, -0.000103321472f,
+    0.700517416f, 0.0109571638f, -0.0911849886f, 0.0817974284f,
+    -0.0421479568f, 0.00428861473f, 0.0160704255f, -0.0182908196f,
+    0.0106225219f, -0.00214898516f, -0.00234359573f, 0.00282416982f,
+    -0.00151903706f, 0.000337701902f, 0.000112107271f, -0.000101489903f,
+    0.697688520f, 0.00700986339f, -0.0893983245f, 0.0815180019f,
+    -0.0426303819f, 0.00490501802f, 0.0156743675f, -0.0181838721f,
+    0.0106990039f, -0.00226978632f, -0.00226215902f, 0.00279659336f,
+    -0.00152267062f, 0.000348067435f, 0.000105949912f, -9.96534436e-05f,
+    0.694801688f, 0.00310390443f, -0.0875998512f, 0.0812181383f,
+    -0.0430988818f, 0.00551709207f, 0.0152760185f, -0.0180725250f,
+    0.0107721249f, -0.00238922494f, -0.00218064175f, 0.00276843691f,
+    -0.00152583432f, 0.000358222751f, 9.98380492e-05f, -9.78129028e-05f,
+    0.691857398f, -0.000760317780f, -0.0857900977f, 0.0808980241f,
+    -0.0435533971f, 0.00612469204f, 0.0148754977f, -0.0179568306f,
+    0.0108418847f, -0.00250727567f, -0.00209906721f, 0.00273971283f,
+    -0.00152853120f, 0.000368166890f, 9.37731529e-05f, -9.59690660e-05f,
+    0.688856125f, -0.00458241627f, -0.0839696154f, 0.0805578604f,
+    -0.0439938791f, 0.00672767544f, 0.0144729251f, -0.0178368408f,
+    0.0109082814f, -0.00262391428f, -0.00201745867f, 0.00271043344f,
+    -0.00153076439f, 0.000377898890f, 8.77566708e-05f, -9.41227263e-05f,
+    0.685798347f, -0.00836201385f, -0.0821389332f, 0.0801978409f,
+    -0.0444202833f, 0.00732590165f, 0.0140684210f, -0.0177126136f,
+    0.0109713171f, -0.00273911655f, -0.00193583989f, 0.00268061180f,
+    -0.00153253740f, 0.000387417851f, 8.17900072e-05f, -9.22746622e-05f,
+    0.682684600f, -0.0120987408f, -0.0802985951f, 0.0798181668f,
+    -0.0448325574f, 0.00791923143f, 0.0136621045f, -0.0175842047f,
+    0.0110309916f, -0.00285285874f, -0.00185423368f, 0.00265026023f,
+    -0.00153385347f, 0.000396722986f, 7.58745446e-05f, -9.04256303e-05f,
+    0.679515362f, -0.0157922395f, -0.0784491226f, 0.0794190541f,
+    -0.0452306643f, 0.00850752741f, 0.0132540958f, -0.0174516700f,
+    0.0110873077f, -0.00296511804f, -0.00177266332f, 0.00261939131f,
+    -0.00153471623f, 0.000405813596f, 7.00116143e-05f, -8.85764020e-05f,
+    0.676291168f, -0.0194421597f, -0.0765910596f, 0.0790007114f,
+    -0.0456145704f, 0.00909065548f, 0.0128445150f, -0.0173150692f,
+    0.0111402683f, -0.00307587208f, -0.00169115153f, 0.00258801831f,
+    -0.00153512915f, 0.000414689042f, 6.42025261e-05f, -8.67277049e-05f,
+    0.673012555f, -0.0230481606f, -0.0747249350f, 0.0785633475f,
+    -0.0459842384f, 0.00966848247f, 0.0124334823f, -0.0171744600f,
+    0.0111898771f, -0.00318509899f, -0.00160972099f, 0.00255615357f,
+    -0.00153509621f, 0.000423348713f, 5.84485497e-05f, -8.48802883e-05f,
+    0.669679999f, -0.0266099125f, -0.0728512779f, 0.0781071931f,
+    -0.0463396423f, 0.0102408780f, 0.0120211150f, -0.0170299001f,
+    0.0112361396f, -0.00329277758f, -0.00152839441f, 0.00252381014f,
+    -0.00153462111f, 0.000431792170f, 5.27509364e-05f, -8.30348654e-05f,
+    0.666294098f, -0.0301270895f, -0.0709706172f, 0.0776324645f,
+    -0.0466807559f, 0.0108077116f, 0.0116075343f, -0.0168814529f,
+    0.0112790614f, -0.00339888711f, -0.00144719391f, 0.00249100127f,
+    -0.00153370772f, 0.000440018950f, 4.71108833e-05f, -8.11921491e-05f,
+    0.662855387f, -0.0335993804f, -0.0690834820f, 0.0771393850f,
+    -0.0470075645f, 0.0113688596f, 0.0111928573f, -0.0167291760f,
+    0.0113186492f, -0.00350340712f, -0.00136614160f, 0.00245773932f,
+    -0.00153236021f, 0.000448028703f, 4.15295654e-05f, -7.93528379e-05f,
+    0.659364402f, -0.0370264873f, -0.0671904013f, 0.0766281933f,
+    -0.0473200455f, 0.0119241951f, 0.0107772034f, -0.0165731348f,
+    0.0113549102f, -0.00360631850f, -0.00128525973f, 0.00242403778f,
+    -0.00153058267f, 0.000455821166f, 3.60081249e-05f, -7.75176304e-05f,
+    0.655821741f, -0.0404081084f, -0.0652918890f, 0.0760991201f,
+    -0.0476181842f, 0.0124735972f, 0.0103606917f, -0.0164133906f,
+    0.0113878539f, -0.00370760192f, -0.00120456982f, 0.00238990947f,
+    -0.00152837939f, 0.000463396136f, 3.05476606e-05f, -7.56871887e-05f,
+    0.652227938f, -0.0437439643f, -0.0633884817f, 0.0755523965f,
+    -0.0479019769f, 0.0130169457f, 0.00994343869f, -0.0162500050f,
+    0.0114174895f, -0.00380723900f, -0.00112409354f, 0.00235536741f,
+    -0.00152575469f, 0.000470753439f, 2.51492493e-05f, -7.38621966e-05f,
+    0.648583591f, -0.0470337793f, -0.0614806861f, 0.0749882683f,
+    -0.0481714159f, 0.0135541214f, 0.00952556264f, -0.0160830431f,
+    0.0114438264f, -0.00390521204f, -0.00104385230f, 0.00232042489f,
+    -0.00152271288f, 0.000477893074f, 1.98139223e-05f, -7.20432945e-05f,
+    0.644889295f, -0.0502772890f, -0.0595690273f, 0.0744069740f,
+    -0.0484265015f, 0.0140850106f, 0.00910717994f, -0.0159125701f,
+    0.0114668766f, -0.00400150334f, -0.000963867176f, 0.00228509470f,
+    -0.00151925860f, 0.000484815013f, 1.45426857e-05f, -7.02311299e-05f,
+    0.641145647f, -0.0534742363f, -0.0576540157f, 0.0738087744f,
+    -0.0486672372f, 0.0146094998f, 0.00868840795f, -0.0157386493f,
+    0.0114866523f, -0.00409609685f, -0.000884159177f, 0.00224939035f,
+    -0.00151539641f, 0.000491519342f, 9.33650790e-06f, -6.84263359e-05f,
+    0.637353301f, -0.0566243753f, -0.0557361655f, 0.0731939003f,
+    -0.0488936231f, 0.0151274763f, 0.00826936401f, -0.0155613469f,
+    0.0115031647f, -0.00418897625f, -0.000804748968f, 0.00221332489f,
+    -0.00151113083f, 0.000498006179f, 4.19632352e-06f, -6.66295236e-05f,
+    0.633512735f, -0.0597274713f, -0.0538159870f, 0.0725626126f,
+    -0.0491056778f, 0.0156388320f, 0.00785016175f, -0.0153807309f,
+    0.0115164295f, -0.00428012572f, -0.000725657097f, 0.00217691134f,
+    -0.00150646688f, 0.000504275784f, -8.76965657e-07f, -6.48413043e-05f,
+    0.629624724f, -0.0627833009f, -0.0518939905f, 0.0719151720f,
+    -0.0493034087f, 0.0161434617f, 0.00743091712f, -0.0151968673f,
+    0.0115264608f, -0.00436953083f, -0.000646903820f, 0.00214016275f,
+    -0.00150140934f, 0.000510328391f, -5.88249259e-06f, -6.30622671e-05f,
+    0.625689805f, -0.0657916367f, -0.0499706753f, 0.0712518319f,
+    -0.0494868383f, 0.0166412611f, 0.00701174559f, -0.0150098242f,
+    0.0115332725f, -0.00445717666f, -0.000568509218f, 0.00210309261f,
+    -0.00149596296f, 0.000516164349f, -1.08194236e-05f, -6.12929944e-05f,
+    0.621708632f, -0.0687522814f, -0.0480465479f, 0.0705728531f,
+    -0.0496559814f, 0.0171321258f, 0.00659276033f, -0.0148196686f,
+    0.0115368823f, -0.00454304926f, -0.000490493025f, 0.00206571375f,
+    -0.00149013300f, 0.000521784066f, -1.56869573e-05f, -5.95340534e-05f,
+    0.617681801f, -0.0716650262f, -0.0461221077f, 0.0698785037f,
+    -0.0498108715f, 0.0176159590f, 0.00617407495f, -0.0146264695f,
+    0.0115373069f, -0.00462713651f, -0.000412874855f, 0.00202803966f,
+    -0.00148392434f, 0.000527188007f, -2.04843309e-05f, -5.77860010e-05f,
+    0.613610029f, -0.0745297000f, -0.0441978462f, 0.0691690445f,
+    -0.0499515310f, 0.0180926640f, 0.00575580262f, -0.0144302957f,
+    0.0115345642f, -0.00470942492f, -0.000335674034f, 0.00199008291f,
+    -0.00147734222f, 0.000532376755f, -2.52108075e-05f, -5.60493791e-05f,
+    0.609493971f, -0.0773461089f, -0.0422742590f, 0.0684447438f,
+    -0.0500779971f, 0.0185621437f, 0.00533805555f, -0.0142312171f,
+    0.0115286717f, -0.00478990236f, -0.000258909597f, 0.00195185724f,
+    -0.00147039175f, 0.000537350890f, -2.98656887e-05f, -5.43247188e-05f,
+    0.605334222f, -0.0801140890f, -0.0403518341f, 0.0677058846f,
+    -0.0501903035f, 0.0190243069f, 0.00492094457f, -0.0140293036f,
+    0.0115196500f, -0.00486855814f, -0.000182600386f, 0.00191337545f,
+    -0.00146307831f, 0.000542111113f, -3.44483087e-05f, -5.26125405e-05f,
+    0.601131499f, -0.0828334838f, -0.0384310633f, 0.0669527277f,
+    -0.0502884910f, 0.0194790661f, 0.00450458098f, -0.0138246259f,
+    0.0115075177f, -0.00494538108f, -0.000106764943f, 0.00187465060f,
+    -0.00145540724f, 0.000546658062f, -3.89580346e-05f, -5.09133461e-05f,
+    0.596886396f, -0.0855041444f, -0.0365124233f, 0.0661855489f,
+    -0.0503725968f, 0.0199263301f, 0.00408907421f, -0.0136172548f,
+    0.0114922980f, -0.00502036046f, -3.14215868e-05f, 0.00183569570f,
+    -0.00144738390f, 0.000550992612f, -4.33942660e-05f, -4.92276267e-05f,
+    0.592599750f, -0.0881259292f, -0.0345963985f, 0.0654046386f,
+    -0.0504426770f, 0.0203660168f, 0.00367453438f, -0.0134072602f,
+    0.0114740105f, -0.00509348745f, 4.34116555e-05f, 0.00179652392f,
+    -0.00143901387f, 0.000555115519f, -4.77564317e-05f, -4.75558627e-05f,
+    0.588272095f, -0.0906987041f, -0.0326834619f, 0.0646102726f,
+    -0.0504987799f, 0.0207980443f, 0.00326106907f, -0.0131947147f,
+    0.0114526777f, -0.00516475225f, 0.000117717020f, 0.00175714819f,
+    -0.00143030251f, 0.000559027831f, -5.20440044e-05f, -4.58985196e-05f,
+    0.583904147f, -0.0932223573f, -0.0307740849f, 0.0638027266f,
+    -0.0505409539f, 0.0212223288f, 0.00284878607f, -0.0129796900f,
+    0.0114283236f, -0.00523414649f, 0.000191476996f, 0.00171758130f,
+    -0.00142125553f, 0.000562730362f, -5.62564746e-05f, -4.42560522e-05f,
+    0.579496682f, -0.0956967697f, -0.0288687386f, 0.0629822910f,
+    -0.0505692586f, 0.0216387976f, 0.00243779202f, -0.0127622588f,
+    0.0114009725f, -0.00530166272f, 0.000264674396f, 0.00167783641f,
+    -0.00141187850f, 0.000566224218f, -6.03933768e-05f, -4.26289007e-05f,
+    0.575050354f, -0.0981218442f, -0.0269678850f, 0.0621492565f,
+    -0.0505837575f, 0.0220473725f, 0.00202819309f, -0.0125424918f,
+    0.0113706468f, -0.00536729302f, 0.000337292237f, 0.00163792633f,
+    -0.00140217727f, 0.000569510448f, -6.44542743e-05f, -4.10174871e-05f,
+    0.570565820f, -0.100497492f, -0.0250719879f, 0.0613038987f,
+    -0.0505845137f, 0.0224479809f, 0.00162009406f, -0.0123204635f,
+    0.0113373734f, -0.00543103088f, 0.000409313856f, 0.00159786374f,
+    -0.00139215740f, 0.000572590216f, -6.84387560e-05f, -3.94222334e-05f,
+    0.566043913f, -0.102823630f, -0.0231815018f, 0.0604465194f,
+    -0.0505715944f, 0.0228405539f, 0.00121359888f, -0.0120962467f,
+    0.0113011776f, -0.00549286976f, 0.000480722927f, 0.00155766145f,
+    -0.00138182472f, 0.000575464685f, -7.23464545e-05f, -3.78435361e-05f,
+    0.561485231f, -0.105100185f, -0.0212968793f, 0.0595774017f,
+    -0.0505450666f, 0.0232250262f, 0.000808810524f, -0.0118699139f,
+    0.0112620862f, -0.00555280503f, 0.000551503268f, 0.00151733228f,
+    -0.00137118506f, 0.000578135136f, -7.61770134e-05f, -3.62817846e-05f,
+    0.556890547f, -0.107327096f, -0.0194185711f, 0.0586968437f,
+    -0.0505050123f, 0.0236013290f, 0.000405831204f, -0.0116415387f,
+    0.0112201264f, -0.00561083062f, 0.000621639192f, 0.00147688866f,
+    -0.00136024435f, 0.000580602849f, -7.99301415e-05f, -3.47373534e-05f,
+    0.552260578f, -0.109504305f, -0.0175470170f, 0.0578051396f,
+    -0.0504515022f, 0.0239694007f, 4.76196692e-06f, -0.0114111947f,
+    0.0111753251f, -0.00566694234f, 0.000691115099f, 0.00143634342f,
+    -0.00134900853f, 0.000582869106f, -8.36055406e-05f, -3.32106065e-05f,
+    0.547596037f, -0.111631773f, -0.0156826600f, 0.0569025800f,
+    -0.0503846183f, 0.0243291836f, -0.000394297153f, -0.0111789564f,
+    0.0111277131f, -0.00572113646f, 0.000759915798f, 0.00139570888f,
+    -0.00133748353f, 0.000584935420f, -8.72029777e-05f, -3.17018930e-05f,
+    0.542897761f, -0.113709472f, -0.0138259353f, 0.0559894703f,
+    -0.0503044464f, 0.0246806182f, -0.000791247119f, -0.0109448964f,
+    0.0110773174f, -0.00577340974f, 0.000828026386f, 0.00135499763f,
+    -0.00132567540f, 0.000586803188f, -9.07222202e-05f, -3.02115441e-05f,
+    0.538166344f, -0.115737371f, -0.0119772721f, 0.0550661013f,
+    -0.0502110720f, 0.0250236522f, -0.00118599006f, -0.0107090892f,
+    0.0110241678f, -0.00582375936f, 0.000895432255f, 0.00131422211f,
+    -0.00131358998f, 0.000588473864f, -9.41630788e-05f, -2.87398889e-05f,
+    0.533402681f, -0.117715456f, -0.0101370979f, 0.0541327745f,
+    -0.0501045845f, 0.0253582299f, -0.00157842902f, -0.0104716094f,
+    0.0109682959f, -0.00587218301f, 0.000962119026f, 0.00127339445f,
+    -0.00130123354f, 0.000589949079f, -9.75254006e-05f, -2.72872367e-05f,
+    0.528607368f, -0.119643725f, -0.00830583461f, 0.0531897917f,
+    -0.0499850772f, 0.0256843045f, -0.00196846831f, -0.0102325315f,
+    0.0109097324f, -0.00591867883f, 0.00102807279f, 0.00123252685f,
+    -0.00128861214f, 0.000591230346f, -0.000100809062f, -2.58538839e-05f,
+    0.523781300f, -0.121522181f, -0.00648389757f, 0.0522374548f,
+    -0.0498526469f, 0.0260018259f, -0.00235601352f, -0.00999192800f,
+    0.0108485082f, -0.00596324634f, 0.00109327980f, 0.00119163166f,
+    -0.00127573183f, 0.000592319411f, -0.000104013954f, -2.44401144e-05f,
+    0.518925130f, -0.123350829f, -0.00467169983f, 0.0512760654f,
+    -0.0497073941f, 0.0263107531f, -0.00274097081f, -0.00974987540f,
+    0.0107846558f, -0.00600588415f, 0.00115772651f, 0.00115072087f,
+    -0.00126259879f, 0.000593217846f, -0.000107140004f, -2.30462028e-05f,
+    0.514039695f, -0.125129715f, -0.00286964816f, 0.0503059290f,
+    -0.0495494157f, 0.0266110413f, -0.00312324823f, -0.00950644631f,
+    0.0107182078f, -0.00604659319f, 0.00122140010f, 0.00110980636f,
+    -0.00124921917f, 0.000593927456f, -0.000110187182f, -2.16724075e-05f,
+    0.509125710f, -0.126858845f, -0.00107814511f, 0.0493273437f,
+    -0.0493788235f, 0.0269026514f, -0.00350275449f, -0.00926171523f,
+    0.0106491977f, -0.00608537393f, 0.00128428766f, 0.00106890022f,
+    -0.00123559916f, 0.000594449986f, -0.000113155467f, -2.03189757e-05f,
+    0.504183948f, -0.128538266f, 0.000702412042f, 0.0483406186f,
+    -0.0491957217f, 0.0271855481f, -0.00387939997f, -0.00901575759f,
+    0.0105776591f, -0.00612222683f, 0.00134637672f, 0.00102801400f,
+    -0.00122174504f, 0.000594787300f, -0.000116044874f, -1.89861385e-05f,
+    0.499215215f, -0.130168051f, 0.00247163139f, 0.0473460555f,
+    -0.0490002185f, 0.0274596959f, -0.00425309595f, -0.00876864605f,
+    0.0105036255f, -0.00615715422f, 0.00140765507f, 0.000987159554f,
+    -0.00120766298f, 0.000594941142f, -0.000118855445f, -1.76741214e-05f,
+    0.494220257f, -0.131748229f, 0.00422912603f, 0.0463439636f,
+    -0.0487924330f, 0.0277250614f, -0.00462375442f, -0.00852045603f,
+    0.0104271332f, -0.00619015796f, 0.00146811106f, 0.000946348475f,
+    -0.00119335938f, 0.000594913552f, -0.000121587254f, -1.63831319e-05f,
+    0.489199847f, -0.133278891f, 0.00597451348f, 0.0453346483f,
+    -0.0485724770f, 0.0279816184f, -0.00499129016f, -0.00827126112f,
+    0.0103482157f, -0.00622124085f, 0.00152773305f, 0.000905592227f,
+    -0.00117884018f, 0.000594706391f, -0.000124240396f, -1.51133645e-05f,
+    0.484154791f, -0.134760112f, 0.00770741794f, 0.0443184115f,
+    -0.0483404696f, 0.0282293372f, -0.00535561796f, -0.00802113488f,
+    0.0102669094f, -0.00625040615f, 0.00158650987f, 0.000864902162f,
+    -0.00116411189f, 0.000594321580f, -0.000126814994f, -1.38650066e-05f,
+    0.479085863f, -0.136191964f, 0.00942746829f, 0.0432955660f,
+    -0.0480965339f, 0.0284681935f, -0.00571665401f, -0.00777015183f,
+    0.0101832515f, -0.00627765758f, 0.00164443068f, 0.000824289687f,
+    -0.00114918081f, 0.000593761273f, -0.000129311215f, -1.26382292e-05f,
+    0.473993808f, -0.137574568f, 0.0111342976f, 0.0422664136f,
+    -0.0478407964f, 0.0286981687f, -0.00607431680f, -0.00751838507f,
+    0.0100972774f, -0.00630299933f, 0.00170148490f, 0.000783765863f,
+    -0.00113405311f, 0.000593027391f, -0.000131729204f, -1.14331924e-05f,
+    0.468879491f, -0.138908014f, 0.0128275473f, 0.0412312597f,
+    -0.0475733802f, 0.0289192405f, -0.00642852485f, -0.00726590818f,
+    0.0100090252f, -0.00632643653f, 0.00175766239f, 0.000743341807f,
+    -0.00111873518f, 0.000592122087f, -0.000134069196f, -1.02500444e-05f,
+    0.463743657f, -0.140192419f, 0.0145068606f, 0.0401904173f,
+    -0.0472944155f, 0.0291313939f, -0.00677919853f, -0.00701279473f,
+    0.00991853140f, -0.00634797476f, 0.00181295315f, 0.000703028461f,
+    -0.00110323320f, 0.000591047457f, -0.000136331393f, -9.08891980e-06f,
+    0.458587080f, -0.141427904f, 0.0161718894f, 0.0391441882f,
+    -0.0470040329f, 0.0293346122f, -0.00712626008f, -0.00675911782f,
+    0.00982583500f, -0.00636761915f, 0.00186734751f, 0.000662836654f,
+    -0.00108755357f, 0.000589805655f, -0.000138516072f, -7.94994503e-06f,
+    0.453410596f, -0.142614618f, 0.0178222898f, 0.0380928814f,
+    -0.0467023663f, 0.0295288879f, -0.00746963220f, -0.00650495011f,
+    0.00973097328f, -0.00638537621f, 0.00192083651f, 0.000622777152f,
+    -0.00107170246f, 0.000588398892f, -0.000140623510f, -6.83323060e-06f,
+    0.448214978f, -0.143752679f, 0.0194577221f, 0.0370368026f,
+    -0.0463895537f, 0.0297142081f, -0.00780924037f, -0.00625036424f,
+    0.00963398628f, -0.00640125340f, 0.00197341107f, 0.000582860492f,
+    -0.00105568639f, 0.000586829323f, -0.000142653982f, -5.73887792e-06f,
+    0.443001032f, -0.144842237f, 0.0210778564f, 0.0359762534f,
+    -0.0460657366f, 0.0298905671f, -0.00814501010f, -0.00599543285f,
+    0.00953491218f, -0.00641525723f, 0.00202506245f, 0.000543097209f,
+    -0.00103951141f, 0.000585099275f, -0.000144607839f, -4.66697611e-06f,
+    0.437769532f, -0.145883471f, 0.0226823650f, 0.0349115431f,
+    -0.0457310490f, 0.0300579611f, -0.00847686827f, -0.00574022764f,
+    0.00943379011f, -0.00642739609f, 0.00207578251f, 0.000503497606f,
+    -0.00102318393f, 0.000583210960f, -0.000146485429f, -3.61760294e-06f,
+    0.432521313f, -0.146876529f, 0.0242709257f, 0.0338429809f,
+    -0.0453856401f, 0.0302163865f, -0.00880474411f, -0.00548482081f,
+    0.00933066104f, -0.00643767836f, 0.00212556310f, 0.000464071869f,
+    -0.00100671023f, 0.000581166649f, -0.000148287116f, -2.59082503e-06f,
+    0.427257180f, -0.147821590f, 0.0258432273f, 0.0327708609f,
+    -0.0450296514f, 0.0303658471f, -0.00912856869f, -0.00522928359f,
+    0.00922556408f, -0.00644611195f, 0.00217439700f, 0.000424830127f,
+    -0.000990096480f, 0.000578968786f, -0.000150013308f, -1.58669764e-06f,
+    0.421977907f, -0.148718849f, 0.0273989569f, 0.0316954963f,
+    -0.0446632355f, 0.0305063426f, -0.00944827311f, -0.00497368677f,
+    0.00911854114f, -0.00645270711f, 0.00222227653f, 0.000385782332f,
+    -0.000973349088f, 0.000576619583f, -0.000151664412f, -6.05264916e-07f,
+    0.416684300f, -0.149568498f, 0.0289378129f, 0.0306171868f,
+    -0.0442865379f, 0.0306378808f, -0.00976379029f, -0.00471810158f,
+    0.00900963135f, -0.00645747315f, 0.00226919516f, 0.000346938294f,
+    -0.000956474163f, 0.000574121543f, -0.000153240864f, 3.53439901e-07f,
+    0.411377192f, -0.150370717f, 0.0304594971f, 0.0295362342f,
+    -0.0438997112f, 0.0307604689f, -0.0100750560f, -0.00446259836f,
+    0.00889887754f, -0.00646042032f, 0.00231514568f, 0.000308307703f,
+    -0.000939477934f, 0.000571476994f, -0.000154743146f, 1.28939428e-06f,
+    0.406057358f, -0.151125729f, 0.0319637209f, 0.0284529403f,
+    -0.0435029119f, 0.0308741182f, -0.0103820059f, -0.00420724647f,
+    0.00878631976f, -0.00646155886f, 0.00236012228f, 0.000269900105f,
+    -0.000922366627f, 0.000568688440f, -0.000156171707f, 2.20258630e-06f,
+    0.400725633f, -0.151833743f, 0.0334501974f, 0.0273676049f,
+    -0.0430962928f, 0.0309788380f, -0.0106845777f, -0.00395211624f,
+    0.00867199991f, -0.00646090042f, 0.00240411842f, 0.000231724916f,
+    -0.000905146473f, 0.000565758208f, -0.000157527087f, 3.09301481e-06f,
+    0.395382792f, -0.152494997f, 0.0349186473f, 0.0262805298f,
+    -0.0426800102f, 0.0310746469f, -0.0109827109f, -0.00369727658f,
+    0.00855595991f, -0.00645845616f, 0.00244712899f, 0.000193791391f,
+    -0.000887823582f, 0.000562688860f, -0.000158809795f, 3.96068890e-06f,
+    0.390029639f, -0.153109714f, 0.0363687985f, 0.0251920111f,
+    -0.0422542244f, 0.0311615616f, -0.0112763448f, -0.00344279618f,
+    0.00843824260f, -0.00645423867f, 0.00248914841f, 0.000156108639f,
+    -0.000870404067f, 0.000559482840f, -0.000160020354f, 4.80562767e-06f,
+    0.384667009f, -0.153678149f, 0.0378003828f, 0.0241023488f,
+    -0.0418190993f, 0.0312395990f, -0.0115654245f, -0.00318874326f,
+    0.00831888989f, -0.00644825911f, 0.00253017154f, 0.000118685639f,
+    -0.000852894096f, 0.000556142710f, -0.000161159362f, 5.62786136e-06f,
+    0.379295677f, -0.154200524f, 0.0392131396f, 0.0230118372f,
+    -0.0413747989f, 0.0313087851f, -0.0118498914f, -0.00293518556f,
+    0.00819794461f, -0.00644053146f, 0.00257019396f, 8.15312378e-05f,
+    -0.000835299725f, 0.000552670914f, -0.000162227370f, 6.42742816e-06f,
+    0.373916447f, -0.154677108f, 0.0406068191f, 0.0219207723f,
+    -0.0409214795f, 0.0313691422f, -0.0121296914f, -0.00268219016f,
+    0.00807544962f, -0.00643106876f, 0.00260921102f, 4.46540980e-05f,
+    -0.000817627064f, 0.000549070071f, -0.000163225006f, 7.20437856e-06f,
+    0.368530184f, -0.155108184f, 0.0419811681f, 0.0208294466f,
+    -0.0404593162f, 0.0314206965f, -0.0124047734f, -0.00242982409f,
+    0.00795144681f, -0.00641988404f, 0.00264721876f, 8.06275420e-06f,
+    -0.000799882109f, 0.000545342686f, -0.000164152851f, 7.95877077e-06f,
+    0.363137603f, -0.155493990f, 0.0433359444f, 0.0197381526f,
+    -0.0399884693f, 0.0314634778f, -0.0126750832f, -0.00217815349f,
+    0.00782598089f, -0.00640699174f, 0.00268421345f, -2.82344117e-05f,
+    -0.000782070798f, 0.000541491376f, -0.000165011574f, 8.69067298e-06f,
+    0.357739568f, -0.155834824f, 0.0446709171f, 0.0186471809f,
+    -0.0395091139f, 0.0314975157f, -0.0129405726f, -0.00192724401f,
+    0.00769909471f, -0.00639240630f, 0.00272019184f, -6.42291780e-05f,
+    -0.000764199183f, 0.000537518645f, -0.000165801830f, 9.40016344e-06f,
+    0.352336854f, -0.156130984f, 0.0459858514f, 0.0175568201f,
+    -0.0390214212f, 0.0315228477f, -0.0132011920f, -0.00167716073f,
+    0.00757083157f, -0.00637614261f, 0.00275515043f, -9.99134645e-05f,
+    -0.000746273203f, 0.000533427170f, -0.000166524260f, 1.00873285e-05f,
+    0.346930265f, -0.156382740f, 0.0472805314f, 0.0164673589f,
+    -0.0385255590f, 0.0315395035f, -0.0134568959f, -0.00142796815f,
+    0.00744123571f, -0.00635821605f, 0.00278908713f, -0.000135279362f,
+    -0.000728298677f, 0.000529219513f, -0.000167179562f, 1.07522646e-05f,
+    0.341520637f, -0.156590417f, 0.0485547334f, 0.0153790833f,
+    -0.0380217023f, 0.0315475240f, -0.0137076387f, -0.00117973040f,
+    0.00731034996f, -0.00633864151f, 0.00282199867f, -0.000170319108f,
+    -0.000710281543f, 0.000524898351f, -0.000167768449f, 1.13950773e-05f,
+    0.336108714f, -0.156754300f, 0.0498082526f, 0.0142922755f,
+    -0.0375100262f, 0.0315469503f, -0.0139533766f, -0.000932510651f,
+    0.00717821857f, -0.00631743576f, 0.00285388343f, -0.000205025091f,
+    -0.000692227506f, 0.000520466245f, -0.000168291619f, 1.20158784e-05f,
+    0.330695301f, -0.156874716f, 0.0510408841f, 0.0132072195f,
+    -0.0369907059f, 0.0315378234f, -0.0141940676f, -0.000686371699f,
+    0.00704488624f, -0.00629461510f, 0.00288473954f, -0.000239389890f,
+    -0.000674142444f, 0.000515925873f, -0.000168749830f, 1.26147906e-05f,
+    0.325281233f, -0.156951979f, 0.0522524267f, 0.0121241948f,
+    -0.0364639238f, 0.0315201841f, -0.0144296717f, -0.000441375596f,
+    0.00691039581f, -0.00627019582f, 0.00291456538f, -0.000273406185f,
+    -0.000656032120f, 0.000511279854f, -0.000169143808f, 1.31919451e-05f,
+    0.319867253f, -0.156986445f, 0.0534426942f, 0.0110434787f,
+    -0.0359298512f, 0.0314940847f, -0.0146601498f, -0.000197583853f,
+    0.00677479245f, -0.00624419516f, 0.00294335955f, -0.000307066890f,
+    -0.000637902063f, 0.000506530865f, -0.000169474311f, 1.37474790e-05f,
+    0.314454168f, -0.156978413f, 0.0546115004f, 0.00996534899f,
+    -0.0353886709f, 0.0314595699f, -0.0148854647f, 4.49427971e-05f,
+    0.00663811993f, -0.00621663034f, 0.00297112158f, -0.000340365019f,
+    -0.000619758095f, 0.000501681585f, -0.000169742125f, 1.42815397e-05f,
+    0.309042782f, -0.156928256f, 0.0557586662f, 0.00889008027f,
+    -0.0348405652f, 0.0314166918f, -0.0151055809f, 0.000286144234f,
+    0.00650042249f, -0.00618751906f, 0.00299785053f, -0.000373293791f,
+    -0.000601605687f, 0.000496734574f, -0.000169948034f, 1.47942828e-05f,
+    0.303633869f, -0.156836301f, 0.0568840206f, 0.00781794358f,
+    -0.0342857130f, 0.0313655026f, -0.0153204640f, 0.000525961048f,
+    0.00636174437f, -0.00615687994f, 0.00302354619f, -0.000405846542f,
+    -0.000583450485f, 0.000491692626f, -0.000170092841f, 1.52858684e-05f,
+    0.298228234f, -0.156702921f, 0.0579873994f, 0.00674920902f,
+    -0.0337242968f, 0.0313060544f, -0.0155300833f, 0.000764334516f,
+    0.00622213027f, -0.00612473069f, 0.00304820854f, -0.000438016839f,
+    -0.000565297960f, 0.000486558361f, -0.000170177358f, 1.57564664e-05f,
+    0.292826623f, -0.156528473f, 0.0590686463f, 0.00568414433f,
+    -0.0331565030f, 0.0312384069f, -0.0157344062f, 0.00100120669f,
+    0.00608162396f, -0.00609109038f, 0.00307183783f, -0.000469798339f,
+    -0.000547153526f, 0.000481334457f, -0.000170202402f, 1.62062552e-05f,
+    0.287429839f, -0.156313330f, 0.0601276048f, 0.00462301541f,
+    -0.0325825140f, 0.0311626159f, -0.0159334037f, 0.00123652013f,
+    0.00594027014f, -0.00605597813f, 0.00309443497f, -0.000501184899f,
+    -0.000529022596f, 0.000476023532f, -0.000170168816f, 1.66354184e-05f,
+    0.282038659f, -0.156057850f, 0.0611641295f, 0.00356608513f,
+    -0.0320025161f, 0.0310787428f, -0.0161270499f, 0.00147021841f,
+    0.00579811260f, -0.00601941301f, 0.00311600044f, -0.000532170583f,
+    -0.000510910526f, 0.000470628351f, -0.000170077445f, 1.70441454e-05f,
+    0.276653826f, -0.155762434f, 0.0621780828f, 0.00251361355f,
+    -0.0314166881f, 0.0309868511f, -0.0163153186f, 0.00170224591f,
+    0.00565519650f, -0.00598141458f, 0.00313653587f, -0.000562749570f,
+    -0.000492822612f, 0.000465151505f, -0.000169929146f, 1.74326360e-05f,
+    0.271276146f, -0.155427456f, 0.0631693304f, 0.00146585901f,
+    -0.0308252275f, 0.0308870040f, -0.0164981838f, 0.00193254731f,
+    0.00551156513f, -0.00594200287f, 0.00315604242f, -0.000592916214f,
+    -0.000474764092f, 0.000459595729f, -0.000169724779f, 1.78010923e-05f,
+    0.265906364f, -0.155053318f, 0.0641377494f, 0.000423077290f,
+    -0.0302283131f, 0.0307792686f, -0.0166756231f, 0.00216106861f,
+    0.00536726322f, -0.00590119790f, 0.00317452196f, -0.000622664986f,
+    -0.000456740148f, 0.000453963643f, -0.000169465231f, 1.81497289e-05f,
+    0.260545224f, -0.154640421f, 0.0650832206f, -0.000614478835f,
+    -0.0296261366f, 0.0306637101f, -0.0168476161f, 0.00238775602f,
+    0.00522233453f, -0.00585902017f, 0.00319197658f, -0.000651990646f,
+    -0.000438755902f, 0.000448257924f, -0.000169151390f, 1.84787586e-05f,
+    0.255193532f, -0.154189155f, 0.0660056248f, -0.00164655899f,
+    -0.0290188845f, 0.0305403993f, -0.0170141440f, 0.00261255726f,
+    0.00507682376f, -0.00581549061f, 0.00320840860f, -0.000680888072f,
+    -0.000420816417f, 0.000442481251f, -0.000168784143f, 1.87884070e-05f,
+    0.249852031f, -0.153699934f, 0.0669048652f, -0.00267291558f,
+    -0.0284067467f, 0.0304094087f, -0.0171751902f, 0.00283542019f,
+    0.00493077375f, -0.00577062974f, 0.00322382059f, -0.000709352200f,
+    -0.000402926671f, 0.000436636270f, -0.000168364393f, 1.90789015e-05f,
+    0.244521454f, -0.153173178f, 0.0677808300f, -0.00369330379f,
+    -0.0277899094f, 0.0302708112f, -0.0173307341f, 0.00305629382f,
+    0.00478422921f, -0.00572445849f, 0.00323821558f, -0.000737378316f,
+    -0.000385091640f, 0.000430725602f, -0.000167893042f, 1.93504784e-05f,
+    0.239202544f, -0.152609304f, 0.0686334297f, -0.00470748171f,
+    -0.0271685664f, 0.0301246811f, -0.0174807645f, 0.00327512808f,
+    0.00463723345f, -0.00567699922f, 0.00325159659f, -0.000764961820f,
+    -0.000367316185f, 0.000424751954f, -0.000167371036f, 1.96033761e-05f,
+    0.233896062f, -0.152008757f, 0.0694625750f, -0.00571520953f,
+    -0.0265429020f, 0.0299710948f, -0.0176252667f, 0.00349187362f,
+    0.00448983023f, -0.00562827336f, 0.00326396711f, -0.000792098115f,
+    -0.000349605136f, 0.000418717886f, -0.000166799276f, 1.98378420e-05f,
+    0.228602752f, -0.151371941f, 0.0702681914f, -0.00671625137f,
+    -0.0259131100f, 0.0298101325f, -0.0177642293f, 0.00370648154f,
+    0.00434206286f, -0.00557830231f, 0.00327533111f, -0.000818783010f,
+    -0.000331963238f, 0.000412626105f, -0.000166178696f, 2.00541253e-05f,
+    0.223323315f, -0.150699303f, 0.0710502043f, -0.00771037396f,
+    -0.0252793804f, 0.0296418704f, -0.0178976450f, 0.00391890481f,
+    0.00419397512f, -0.00552710844f, 0.00328569231f, -0.000845012371f,
+    -0.000314395176f, 0.000406479143f, -0.000165510239f, 2.02524825e-05f,
+    0.218058527f, -0.149991274f, 0.0718085319f, -0.00869734678f,
+    -0.0246419013f, 0.0294663943f, -0.0180255026f, 0.00412909593f,
+    0.00404560938f, -0.00547471410f, 0.00329505489f, -0.000870782183f,
+    -0.000296905579f, 0.000400279678f, -0.000164794837f, 2.04331718e-05f,
+    0.212809086f, -0.149248317f, 0.0725431293f, -0.00967694260f,
+    -0.0240008663f, 0.0292837825f, -0.0181477964f, 0.00433700904f,
+    0.00389700895f, -0.00542114163f, 0.00330342352f, -0.000896088721f,
+    -0.000279499014f, 0.000394030270f, -0.000164033467f, 2.05964607e-05f,
+};
+
+static const DynFilterTable<float> kDynFilterTablesFloat[] = {
+    { 160, 8, 80, 0.36820595403899725, 0.99980000000000002, kDynFilter0 },
+    { 160, 16, 84, 0.43225060933147635, 0.99980000000000002, kDynFilter1 },
+    { 147, 8, 80, 0.31636220403899717, 0.99980000000000002, kDynFilter2 },
+    { 147, 16, 84, 0.38121935933147633, 0.99980000000000002, kDynFilter3 },
+    { 0, 0, 0., 0., 0., NULL },
+};
+
+static const DynFilterTable<int16_t> kDynFilterTablesInt16[] = {
+    { 0, 0, 0., 0., 0., NULL },
+};
+
+static const DynFilterTable<int32_t> kDynFilterTablesInt32[] = {
+    { 0, 0, 0., 0., 0., NULL },
+};
+
+// Returns the NULL terminated list of the tables with coefficients of type TC.
+static inline const DynFilterTable<float>* dynFilterTables(const float*) {
+    return kDynFilterTablesFloat;
+}
+static inline const DynFilterTable<int16_t>* dynFilterTables(const int16_t*) {
+    return kDynFilterTablesInt16;
+}
+static inline const DynFilterTable<int32_t>* dynFilterTables(const int32_t*) {
+    return kDynFilterTablesInt32;
+}
+
+} // namespace android
+
+#endif // ANDROID_AUDIO_RESAMPLER_DYN_TABLES_H
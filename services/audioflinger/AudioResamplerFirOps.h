@@ -36,6 +36,14 @@ namespace android {
 #include <arm_neon.h>
 #endif
 
+// AVX2 kernels are built on all x86 targets, and used only if the CPU supports them.
+// This must match the resampleAvx2() declaration in AudioResamplerDyn.h.
+#if defined(__i386__) || defined(__x86_64__)
+#define USE_AVX2 (true)
+#else
+#define USE_AVX2 (false)
+#endif
+
 template<typename T, typename U>
 struct is_same
 {
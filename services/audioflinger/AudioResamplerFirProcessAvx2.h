@@ -0,0 +1,563 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_RESAMPLER_FIR_PROCESS_AVX2_H
+#define ANDROID_AUDIO_RESAMPLER_FIR_PROCESS_AVX2_H
+
+// depends on AudioResamplerFirOps.h, AudioResamplerFirProcess.h
+
+#if USE_AVX2
+#include <immintrin.h>
+#endif
+
+namespace android {
+
+#if USE_AVX2
+
+//
+// AVX2/FMA specializations of Process() and ProcessL() in AudioResamplerFirProcess.h
+//
+// The x86 ABI does not guarantee AVX2, so these kernels are compiled with a function
+// target attribute and are only reached from AudioResamplerDyn::resampleAvx2(), which is
+// chosen at runtime by setSampleRate() when resamplerCpuHasAvx2() is true.  They are
+// specialized on STRIDE = kAvx2Stride so they never replace the portable kernels used
+// by resample<CHANNELS, LOCKED, 16>.
+//
+// The integer kernels are bit-exact with the portable ProcessBase(): products and
+// interpolations are computed with the same truncations, and the integer sums are
+// order independent.  The float kernels use fused multiply-add and a different
+// summation order, so they differ from ProcessBase() by rounding only.
+//
+// As with NEON, count (halfNumCoefs) must be a multiple of 8 and only 1 or 2 channels
+// are supported.
+//
+
+static const int kAvx2Stride = 8;
+
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+
+static inline bool resamplerCpuHasAvx2()
+{
+    static const bool hasAvx2 = (__builtin_cpu_init(),
+            __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"));
+    return hasAvx2;
+}
+
+// Reverses the order of 8 int16_t.
+static inline AVX2_TARGET
+__m128i reverseS16Avx2(__m128i v)
+{
+    return _mm_shuffle_epi8(v, _mm_setr_epi8(
+            14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1));
+}
+
+// Same as interpolate<int16_t, uint32_t>() on 8 coefficients: lerp * (c1 - c0) >> 15 + c0,
+// with the 32 bit product reassembled from its high and low halves.
+static inline AVX2_TARGET
+__m128i interpolateS16Avx2(__m128i c0, __m128i c1, __m128i lerp)
+{
+    const __m128i diff = _mm_sub_epi16(c1, c0);
+    const __m128i hi = _mm_mulhi_epi16(diff, lerp);
+    const __m128i lo = _mm_mullo_epi16(diff, lerp);
+    return _mm_add_epi16(_mm_or_si128(_mm_slli_epi16(hi, 1), _mm_srli_epi16(lo, 15)), c0);
+}
+
+// Narrows the low 32 bits of 4 int64 lanes to 4 int32.
+static inline AVX2_TARGET
+__m128i narrowS64Avx2(__m256i v)
+{
+    return _mm256_castsi256_si128(
+            _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+}
+
+// Same as interpolate<int32_t, uint32_t>() on 4 coefficients: lerp * (c1 - c0) >> 31 + c0.
+// Only the low 32 bits of the shifted 64 bit product are kept, so a logical shift suffices.
+static inline AVX2_TARGET
+__m128i interpolateS32Avx2(__m128i c0, __m128i c1, __m256i lerp)
+{
+    const __m256i diff = _mm256_cvtepi32_epi64(_mm_sub_epi32(c1, c0));
+    return _mm_add_epi32(
+            narrowS64Avx2(_mm256_srli_epi64(_mm256_mul_epi32(diff, lerp), 31)), c0);
+}
+
+// Same as mulAdd(int16_t, int32_t, int32_t) on 4 samples (the low 64 bits of samples),
+// returned in the low 32 bits of 4 int64 lanes.
+static inline AVX2_TARGET
+__m256i mulS16S32Avx2(__m128i samples, __m128i coefs)
+{
+    return _mm256_srli_epi64(_mm256_mul_epi32(
+            _mm256_cvtepi16_epi64(samples), _mm256_cvtepi32_epi64(coefs)), 16);
+}
+
+static inline AVX2_TARGET
+int32_t sumS32Avx2(__m128i v)
+{
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+template <int CHANNELS, bool FIXED>
+static inline AVX2_TARGET
+void ProcessAvx2Intrinsic(int32_t* out,
+        int count,
+        const int16_t* coefsP,
+        const int16_t* coefsN,
+        const int16_t* sP,
+        const int16_t* sN,
+        const int32_t* volumeLR,
+        uint32_t lerpP,
+        const int16_t* coefsP1,
+        const int16_t* coefsN1)
+{
+    ALOG_ASSERT(count > 0 && (count & 7) == 0); // multiple of 8
+    COMPILE_TIME_ASSERT_FUNCTION_SCOPE(CHANNELS == 1 || CHANNELS == 2);
+
+    const __m128i interp = _mm_set1_epi16(static_cast<int16_t>(lerpP));
+    // stereo: words of each lane regrouped as LLLLRRRR
+    const __m256i deinterleave = _mm256_setr_epi8(
+            0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15,
+            0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+    // stereo: coefficients matching the regrouped samples, 4 per channel per lane.
+    // The positive side frames are loaded in reverse order (7..4, 3..0).
+    const __m256i posCoefOrder = _mm256_setr_epi8(
+            14, 15, 12, 13, 10, 11, 8, 9, 14, 15, 12, 13, 10, 11, 8, 9,
+            6, 7, 4, 5, 2, 3, 0, 1, 6, 7, 4, 5, 2, 3, 0, 1);
+    const __m256i negCoefOrder = _mm256_setr_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7,
+            8, 9, 10, 11, 12, 13, 14, 15, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m256i accum = _mm256_setzero_si256();
+    __m256i accum2 = _mm256_setzero_si256();
+    do {
+        __m128i posCoef = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefsP));
+        coefsP += 8;
+        __m128i negCoef = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefsN));
+        coefsN += 8;
+        if (!FIXED) { // interpolate
+            const __m128i posCoef1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefsP1));
+            coefsP1 += 8;
+            const __m128i negCoef1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefsN1));
+            coefsN1 += 8;
+            posCoef = interpolateS16Avx2(posCoef, posCoef1, interp);
+            negCoef = interpolateS16Avx2(negCoef1, negCoef, interp); // rev
+        }
+        switch (CHANNELS) {
+        case 1: {
+            // positive samples run backwards from sP, negative samples forwards from sN.
+            const __m128i posSamp = reverseS16Avx2(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(sP - 7)));
+            sP -= 8;
+            const __m128i negSamp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sN));
+            sN += 8;
+            accum = _mm256_add_epi32(accum, _mm256_madd_epi16(
+                    _mm256_inserti128_si256(_mm256_castsi128_si256(posSamp), negSamp, 1),
+                    _mm256_inserti128_si256(_mm256_castsi128_si256(posCoef), negCoef, 1)));
+        } break;
+        case 2: {
+            const __m256i posSamp = _mm256_shuffle_epi8(_mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(sP - 14)), deinterleave);
+            sP -= 16;
+            const __m256i negSamp = _mm256_shuffle_epi8(_mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(sN)), deinterleave);
+            sN += 16;
+            accum = _mm256_add_epi32(accum, _mm256_madd_epi16(posSamp,
+                    _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(posCoef), posCoefOrder)));
+            accum2 = _mm256_add_epi32(accum2, _mm256_madd_epi16(negSamp,
+                    _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(negCoef), negCoefOrder)));
+        } break;
+        }
+    } while (count -= 8);
+
+    accum = _mm256_add_epi32(accum, accum2);
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(accum),
+            _mm256_extracti128_si256(accum, 1));
+    if (CHANNELS == 1) {
+        const int32_t l = sumS32Avx2(sum);
+        out[0] += volumeAdjust(l, volumeLR[0]);
+        out[1] += volumeAdjust(l, volumeLR[1]);
+    } else {
+        // sum is LLRR
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        out[0] += volumeAdjust(_mm_cvtsi128_si32(sum), volumeLR[0]);
+        out[1] += volumeAdjust(_mm_extract_epi32(sum, 2), volumeLR[1]);
+    }
+}
+
+template <int CHANNELS, bool FIXED>
+static inline AVX2_TARGET
+void ProcessAvx2Intrinsic(int32_t* out,
+        int count,
+        const int32_t* coefsP,
+        const int32_t* coefsN,
+        const int16_t* sP,
+        const int16_t* sN,
+        const int32_t* volumeLR,
+        uint32_t lerpP,
+        const int32_t* coefsP1,
+        const int32_t* coefsN1)
+{
+    ALOG_ASSERT(count > 0 && (count & 7) == 0); // multiple of 8
+    COMPILE_TIME_ASSERT_FUNCTION_SCOPE(CHANNELS == 1 || CHANNELS == 2);
+
+    const __m256i interp = _mm256_set1_epi64x(lerpP);
+    // stereo: frames of a 128 bit load regrouped as LLLLRRRR, in increasing
+    // coefficient order for the positive (reversed) and negative sides.
+    const __m128i posOrder = _mm_setr_epi8(
+            12, 13, 8, 9, 4, 5, 0, 1, 14, 15, 10, 11, 6, 7, 2, 3);
+    const __m128i negOrder = _mm_setr_epi8(
+            0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+    // 64 bit lanes, of which only the low 32 bits are significant.
+    __m256i accum = _mm256_setzero_si256();
+    __m256i accum2 = _mm256_setzero_si256();
+    do {
+        __m128i posCoef0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefsP));
+        __m128i posCoef1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefsP + 4));
+        coefsP += 8;
+        __m128i negCoef0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefsN));
+        __m128i negCoef1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefsN + 4));
+        coefsN += 8;
+        if (!FIXED) { // interpolate
+            posCoef0 = interpolateS32Avx2(posCoef0,
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefsP1)), interp);
+            posCoef1 = interpolateS32Avx2(posCoef1,
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefsP1 + 4)), interp);
+            coefsP1 += 8;
+            negCoef0 = interpolateS32Avx2(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefsN1)), negCoef0,
+                    interp); // rev
+            negCoef1 = interpolateS32Avx2(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefsN1 + 4)), negCoef1,
+                    interp); // rev
+            coefsN1 += 8;
+        }
+        switch (CHANNELS) {
+        case 1: {
+            const __m128i posSamp = reverseS16Avx2(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(sP - 7)));
+            sP -= 8;
+            const __m128i negSamp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sN));
+            sN += 8;
+            accum = _mm256_add_epi64(accum, mulS16S32Avx2(posSamp, posCoef0));
+            accum2 = _mm256_add_epi64(accum2, mulS16S32Avx2(_mm_srli_si128(posSamp, 8),
+                    posCoef1));
+            accum = _mm256_add_epi64(accum, mulS16S32Avx2(negSamp, negCoef0));
+            accum2 = _mm256_add_epi64(accum2, mulS16S32Avx2(_mm_srli_si128(negSamp, 8),
+                    negCoef1));
+        } break;
+        case 2: {
+            // positive frames 7..4 pair with posCoef1, frames 3..0 with posCoef0.
+            const __m128i posSamp1 = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(sP - 14)), posOrder);
+            const __m128i posSamp0 = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(sP - 6)), posOrder);
+            sP -= 16;
+            const __m128i negSamp0 = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(sN)), negOrder);
+            const __m128i negSamp1 = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(sN + 8)), negOrder);
+            sN += 16;
+            // accum is L, accum2 is R
+            accum = _mm256_add_epi64(accum, mulS16S32Avx2(posSamp0, posCoef0));
+            accum = _mm256_add_epi64(accum, mulS16S32Avx2(posSamp1, posCoef1));
+            accum = _mm256_add_epi64(accum, mulS16S32Avx2(negSamp0, negCoef0));
+            accum = _mm256_add_epi64(accum, mulS16S32Avx2(negSamp1, negCoef1));
+            accum2 = _mm256_add_epi64(accum2, mulS16S32Avx2(_mm_srli_si128(posSamp0, 8),
+                    posCoef0));
+            accum2 = _mm256_add_epi64(accum2, mulS16S32Avx2(_mm_srli_si128(posSamp1, 8),
+                    posCoef1));
+            accum2 = _mm256_add_epi64(accum2, mulS16S32Avx2(_mm_srli_si128(negSamp0, 8),
+                    negCoef0));
+            accum2 = _mm256_add_epi64(accum2, mulS16S32Avx2(_mm_srli_si128(negSamp1, 8),
+                    negCoef1));
+        } break;
+        }
+    } while (count -= 8);
+
+    if (CHANNELS == 1) {
+        const int32_t l = sumS32Avx2(narrowS64Avx2(_mm256_add_epi64(accum, accum2)));
+        out[0] += volumeAdjust(l, volumeLR[0]);
+        out[1] += volumeAdjust(l, volumeLR[1]);
+    } else {
+        out[0] += volumeAdjust(sumS32Avx2(narrowS64Avx2(accum)), volumeLR[0]);
+        out[1] += volumeAdjust(sumS32Avx2(narrowS64Avx2(accum2)), volumeLR[1]);
+    }
+}
+
+template <int CHANNELS, bool FIXED>
+static inline AVX2_TARGET
+void ProcessAvx2Intrinsic(float* out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        const float* volumeLR,
+        float lerpP,
+        const float* coefsP1,
+        const float* coefsN1)
+{
+    ALOG_ASSERT(count > 0 && (count & 7) == 0); // multiple of 8
+    COMPILE_TIME_ASSERT_FUNCTION_SCOPE(CHANNELS == 1 || CHANNELS == 2);
+
+    const __m256 interp = _mm256_set1_ps(lerpP);
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    // stereo: coefficients duplicated for interleaved L/R frames.
+    // The positive side frames are loaded in reverse order (7..4, 3..0).
+    const __m256i posCoefOrder1 = _mm256_setr_epi32(7, 7, 6, 6, 5, 5, 4, 4);
+    const __m256i posCoefOrder0 = _mm256_setr_epi32(3, 3, 2, 2, 1, 1, 0, 0);
+    const __m256i negCoefOrder0 = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i negCoefOrder1 = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+    // separate accumulators shorten the FMA dependency chains.
+    __m256 accum = _mm256_setzero_ps();
+    __m256 accum2 = _mm256_setzero_ps();
+    __m256 accum3 = _mm256_setzero_ps();
+    __m256 accum4 = _mm256_setzero_ps();
+    do {
+        __m256 posCoef = _mm256_loadu_ps(coefsP);
+        coefsP += 8;
+        __m256 negCoef = _mm256_loadu_ps(coefsN);
+        coefsN += 8;
+        if (!FIXED) { // interpolate
+            const __m256 posCoef1 = _mm256_loadu_ps(coefsP1);
+            coefsP1 += 8;
+            const __m256 negCoef1 = _mm256_loadu_ps(coefsN1);
+            coefsN1 += 8;
+            posCoef = _mm256_fmadd_ps(interp, _mm256_sub_ps(posCoef1, posCoef), posCoef);
+            negCoef = _mm256_fmadd_ps(interp, _mm256_sub_ps(negCoef, negCoef1), negCoef1); // rev
+        }
+        switch (CHANNELS) {
+        case 1: {
+            const __m256 posSamp = _mm256_permutevar8x32_ps(_mm256_loadu_ps(sP - 7), reverse);
+            sP -= 8;
+            const __m256 negSamp = _mm256_loadu_ps(sN);
+            sN += 8;
+            accum = _mm256_fmadd_ps(posSamp, posCoef, accum);
+            accum2 = _mm256_fmadd_ps(negSamp, negCoef, accum2);
+        } break;
+        case 2: {
+            // samples stay interleaved, accumulator lanes alternate L and R.
+            const __m256 posSamp1 = _mm256_loadu_ps(sP - 14);
+            const __m256 posSamp0 = _mm256_loadu_ps(sP - 6);
+            sP -= 16;
+            const __m256 negSamp0 = _mm256_loadu_ps(sN);
+            const __m256 negSamp1 = _mm256_loadu_ps(sN + 8);
+            sN += 16;
+            accum = _mm256_fmadd_ps(posSamp1,
+                    _mm256_permutevar8x32_ps(posCoef, posCoefOrder1), accum);
+            accum2 = _mm256_fmadd_ps(posSamp0,
+                    _mm256_permutevar8x32_ps(posCoef, posCoefOrder0), accum2);
+            accum3 = _mm256_fmadd_ps(negSamp0,
+                    _mm256_permutevar8x32_ps(negCoef, negCoefOrder0), accum3);
+            accum4 = _mm256_fmadd_ps(negSamp1,
+                    _mm256_permutevar8x32_ps(negCoef, negCoefOrder1), accum4);
+        } break;
+        }
+    } while (count -= 8);
+
+    accum = _mm256_add_ps(_mm256_add_ps(accum, accum2), _mm256_add_ps(accum3, accum4));
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(accum), _mm256_extractf128_ps(accum, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum)); // LR in the low two lanes
+    if (CHANNELS == 1) {
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+        const float l = _mm_cvtss_f32(sum);
+        out[0] += l * volumeLR[0];
+        out[1] += l * volumeLR[1];
+    } else {
+        out[0] += _mm_cvtss_f32(sum) * volumeLR[0];
+        out[1] += _mm_cvtss_f32(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)))
+                * volumeLR[1];
+    }
+}
+
+template <>
+inline void ProcessL<1, kAvx2Stride>(int32_t* const out,
+        int count,
+        const int16_t* coefsP,
+        const int16_t* coefsN,
+        const int16_t* sP,
+        const int16_t* sN,
+        const int32_t* const volumeLR)
+{
+    ProcessAvx2Intrinsic<1, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+}
+
+template <>
+inline void ProcessL<2, kAvx2Stride>(int32_t* const out,
+        int count,
+        const int16_t* coefsP,
+        const int16_t* coefsN,
+        const int16_t* sP,
+        const int16_t* sN,
+        const int32_t* const volumeLR)
+{
+    ProcessAvx2Intrinsic<2, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+}
+
+template <>
+inline void Process<1, kAvx2Stride>(int32_t* const out,
+        int count,
+        const int16_t* coefsP,
+        const int16_t* coefsN,
+        const int16_t* coefsP1,
+        const int16_t* coefsN1,
+        const int16_t* sP,
+        const int16_t* sN,
+        uint32_t lerpP,
+        const int32_t* const volumeLR)
+{
+    ProcessAvx2Intrinsic<1, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            lerpP, coefsP1, coefsN1);
+}
+
+template <>
+inline void Process<2, kAvx2Stride>(int32_t* const out,
+        int count,
+        const int16_t* coefsP,
+        const int16_t* coefsN,
+        const int16_t* coefsP1,
+        const int16_t* coefsN1,
+        const int16_t* sP,
+        const int16_t* sN,
+        uint32_t lerpP,
+        const int32_t* const volumeLR)
+{
+    ProcessAvx2Intrinsic<2, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            lerpP, coefsP1, coefsN1);
+}
+
+template <>
+inline void ProcessL<1, kAvx2Stride>(int32_t* const out,
+        int count,
+        const int32_t* coefsP,
+        const int32_t* coefsN,
+        const int16_t* sP,
+        const int16_t* sN,
+        const int32_t* const volumeLR)
+{
+    ProcessAvx2Intrinsic<1, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+}
+
+template <>
+inline void ProcessL<2, kAvx2Stride>(int32_t* const out,
+        int count,
+        const int32_t* coefsP,
+        const int32_t* coefsN,
+        const int16_t* sP,
+        const int16_t* sN,
+        const int32_t* const volumeLR)
+{
+    ProcessAvx2Intrinsic<2, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+}
+
+template <>
+inline void Process<1, kAvx2Stride>(int32_t* const out,
+        int count,
+        const int32_t* coefsP,
+        const int32_t* coefsN,
+        const int32_t* coefsP1,
+        const int32_t* coefsN1,
+        const int16_t* sP,
+        const int16_t* sN,
+        uint32_t lerpP,
+        const int32_t* const volumeLR)
+{
+    ProcessAvx2Intrinsic<1, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            lerpP, coefsP1, coefsN1);
+}
+
+template <>
+inline void Process<2, kAvx2Stride>(int32_t* const out,
+        int count,
+        const int32_t* coefsP,
+        const int32_t* coefsN,
+        const int32_t* coefsP1,
+        const int32_t* coefsN1,
+        const int16_t* sP,
+        const int16_t* sN,
+        uint32_t lerpP,
+        const int32_t* const volumeLR)
+{
+    ProcessAvx2Intrinsic<2, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            lerpP, coefsP1, coefsN1);
+}
+
+template <>
+inline void ProcessL<1, kAvx2Stride>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        const float* const volumeLR)
+{
+    ProcessAvx2Intrinsic<1, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+}
+
+template <>
+inline void ProcessL<2, kAvx2Stride>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        const float* const volumeLR)
+{
+    ProcessAvx2Intrinsic<2, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+}
+
+template <>
+inline void Process<1, kAvx2Stride>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* coefsP1,
+        const float* coefsN1,
+        const float* sP,
+        const float* sN,
+        float lerpP,
+        const float* const volumeLR)
+{
+    ProcessAvx2Intrinsic<1, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            lerpP, coefsP1, coefsN1);
+}
+
+template <>
+inline void Process<2, kAvx2Stride>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* coefsP1,
+        const float* coefsN1,
+        const float* sP,
+        const float* sN,
+        float lerpP,
+        const float* const volumeLR)
+{
+    ProcessAvx2Intrinsic<2, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            lerpP, coefsP1, coefsN1);
+}
+
+#endif //USE_AVX2
+
+} // namespace android
+
+#endif /*ANDROID_AUDIO_RESAMPLER_FIR_PROCESS_AVX2_H*/
@@ -353,6 +353,27 @@ static inline void ProcessNeonIntrinsic(int32_t* out,
     vst1_s32(out, outSamp);
 }
 
+// AArch64 has a fused multiply-accumulate for float (vmlaq_f32 is emitted there as a
+// separate multiply and add), and twice the vector registers of ARMv7, so the float kernel
+// uses vfmaq and splits the mono sums over two accumulators to shorten the dependency chain.
+static inline float32x4_t vmacq_f32(float32x4_t a, float32x4_t b, float32x4_t c)
+{
+#ifdef __aarch64__
+    return vfmaq_f32(a, b, c);
+#else
+    return vmlaq_f32(a, b, c);
+#endif
+}
+
+static inline float32x4_t vmacq_lane0_f32(float32x4_t a, float32x4_t b, float32x2_t v)
+{
+#ifdef __aarch64__
+    return vfmaq_lane_f32(a, b, v, 0);
+#else
+    return vmlaq_lane_f32(a, b, v, 0);
+#endif
+}
+
 template <int CHANNELS, int STRIDE, bool FIXED>
 static inline void ProcessNeonIntrinsic(float* out,
         int count,
@@ -382,10 +403,14 @@ static inline void ProcessNeonIntrinsic(float* out,
     // warning uninitialized if we use veorq_s32
     // (alternative to below) accum = veorq_s32(accum, accum);
     accum = vdupq_n_f32(0);
+#ifdef __aarch64__
+    accum2 = vdupq_n_f32(0);
+#else
     if (CHANNELS == 2) {
         // (alternative to below) accum2 = veorq_s32(accum2, accum2);
         accum2 = vdupq_n_f32(0);
     }
+#endif
     do {
 #ifdef vld1q_f32_x2
         float32x4x2_t posCoef = vld1q_f32_x2(coefsP);
@@ -427,10 +452,10 @@ static inline void ProcessNeonIntrinsic(float* out,
             negCoef.val[0] = vsubq_f32(negCoef.val[0], negCoef1.val[0]);
             negCoef.val[1] = vsubq_f32(negCoef.val[1], negCoef1.val[1]);
 
-            posCoef.val[0] = vmlaq_lane_f32(posCoef.val[0], posCoef1.val[0], interp, 0);
-            posCoef.val[1] = vmlaq_lane_f32(posCoef.val[1], posCoef1.val[1], interp, 0);
-            negCoef.val[0] = vmlaq_lane_f32(negCoef1.val[0], negCoef.val[0], interp, 0); // rev
-            negCoef.val[1] = vmlaq_lane_f32(negCoef1.val[1], negCoef.val[1], interp, 0); // rev
+            posCoef.val[0] = vmacq_lane0_f32(posCoef.val[0], posCoef1.val[0], interp);
+            posCoef.val[1] = vmacq_lane0_f32(posCoef.val[1], posCoef1.val[1], interp);
+            negCoef.val[0] = vmacq_lane0_f32(negCoef1.val[0], negCoef.val[0], interp); // rev
+            negCoef.val[1] = vmacq_lane0_f32(negCoef1.val[1], negCoef.val[1], interp); // rev
         }
         switch (CHANNELS) {
         case 1: {
@@ -459,10 +484,17 @@ static inline void ProcessNeonIntrinsic(float* out,
             posSamp.val[1] = vcombine_f32(
                     vget_high_f32(posSamp.val[1]), vget_low_f32(posSamp.val[1]));
 
-            accum = vmlaq_f32(accum, posSamp.val[0], posCoef.val[1]);
-            accum = vmlaq_f32(accum, posSamp.val[1], posCoef.val[0]);
-            accum = vmlaq_f32(accum, negSamp.val[0], negCoef.val[0]);
-            accum = vmlaq_f32(accum, negSamp.val[1], negCoef.val[1]);
+#ifdef __aarch64__
+            accum = vmacq_f32(accum, posSamp.val[0], posCoef.val[1]);
+            accum2 = vmacq_f32(accum2, posSamp.val[1], posCoef.val[0]);
+            accum = vmacq_f32(accum, negSamp.val[0], negCoef.val[0]);
+            accum2 = vmacq_f32(accum2, negSamp.val[1], negCoef.val[1]);
+#else
+            accum = vmacq_f32(accum, posSamp.val[0], posCoef.val[1]);
+            accum = vmacq_f32(accum, posSamp.val[1], posCoef.val[0]);
+            accum = vmacq_f32(accum, negSamp.val[0], negCoef.val[0]);
+            accum = vmacq_f32(accum, negSamp.val[1], negCoef.val[1]);
+#endif
         } break;
         case 2: {
             float32x4x2_t posSamp0 = vld2q_f32(sP);
@@ -491,15 +523,15 @@ static inline void ProcessNeonIntrinsic(float* out,
             // Also, speed appears slower using vmul/vadd instead of vmla for
             // stereo case, comparable for mono.
 
-            accum = vmlaq_f32(accum, negSamp0.val[0], negCoef.val[0]);
-            accum = vmlaq_f32(accum, negSamp1.val[0], negCoef.val[1]);
-            accum2 = vmlaq_f32(accum2, negSamp0.val[1], negCoef.val[0]);
-            accum2 = vmlaq_f32(accum2, negSamp1.val[1], negCoef.val[1]);
+            accum = vmacq_f32(accum, negSamp0.val[0], negCoef.val[0]);
+            accum = vmacq_f32(accum, negSamp1.val[0], negCoef.val[1]);
+            accum2 = vmacq_f32(accum2, negSamp0.val[1], negCoef.val[0]);
+            accum2 = vmacq_f32(accum2, negSamp1.val[1], negCoef.val[1]);
 
-            accum = vmlaq_f32(accum, posSamp0.val[0], posCoef.val[1]); // reversed
-            accum = vmlaq_f32(accum, posSamp1.val[0], posCoef.val[0]); // reversed
-            accum2 = vmlaq_f32(accum2, posSamp0.val[1], posCoef.val[1]); // reversed
-            accum2 = vmlaq_f32(accum2, posSamp1.val[1], posCoef.val[0]); // reversed
+            accum = vmacq_f32(accum, posSamp0.val[0], posCoef.val[1]); // reversed
+            accum = vmacq_f32(accum, posSamp1.val[0], posCoef.val[0]); // reversed
+            accum2 = vmacq_f32(accum2, posSamp0.val[1], posCoef.val[1]); // reversed
+            accum2 = vmacq_f32(accum2, posSamp1.val[1], posCoef.val[0]); // reversed
         } break;
         }
     } while (count -= 8);
@@ -508,6 +540,11 @@ static inline void ProcessNeonIntrinsic(float* out,
     volumeLR = (const float*)__builtin_assume_aligned(volumeLR, 8);
     float32x2_t vLR = vld1_f32(volumeLR);
     float32x2_t outSamp = vld1_f32(out);
+#ifdef __aarch64__
+    if (CHANNELS == 1) {
+        accum = vaddq_f32(accum, accum2);
+    }
+#endif
     // combine and funnel down accumulator
     float32x2_t outAccum = vpadd_f32(vget_low_f32(accum), vget_high_f32(accum));
     if (CHANNELS == 1) {
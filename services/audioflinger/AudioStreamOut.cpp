@@ -17,9 +17,12 @@
 
 #define LOG_TAG "AudioFlinger"
 //#define LOG_NDEBUG 0
+#define ATRACE_TAG ATRACE_TAG_AUDIO
 
+#include <cutils/properties.h>
 #include <hardware/audio.h>
 #include <utils/Log.h>
+#include <utils/Trace.h>
 
 #include "AudioHwDevice.h"
 #include "AudioStreamOut.h"
@@ -37,7 +40,17 @@ AudioStreamOut::AudioStreamOut(AudioHwDevice *dev, audio_output_flags_t flags)
         , mRateMultiplier(1)
         , mHalFormatHasProportionalFrames(false)
         , mHalFrameSize(0)
+        , mHalSampleRate(0)
+        , mTraceWrites(property_get_bool("af.hal.write_trace", false /* default_value */))
+        , mColdWrite(true)
+        , mWriteStalls(0)
+        , mMaxWriteNs(0)
+        , mLastStallNs(0)
+        , mLastStallExpectedNs(0)
 {
+    for (size_t i = 0; i < kNumWriteBuckets; i++) {
+        mWriteBuckets[i].store(0, std::memory_order_relaxed);
+    }
 }
 
 audio_hw_device_t *AudioStreamOut::hwDev() const
@@ -159,6 +172,7 @@ status_t AudioStreamOut::open(
         stream = outStream;
         mHalFormatHasProportionalFrames = audio_has_proportional_frames(config->format);
         mHalFrameSize = audio_stream_out_frame_size(stream);
+        mHalSampleRate = stream->common.get_sample_rate(&stream->common);
     }
 
     return status;
@@ -185,6 +199,7 @@ int AudioStreamOut::flush()
     mRenderPosition = 0;
     mFramesWritten = 0;
     mFramesWrittenAtStandby = 0;
+    mColdWrite = true;
     if (stream->flush != NULL) {
         return stream->flush(stream);
     }
@@ -196,17 +211,131 @@ int AudioStreamOut::standby()
     ALOG_ASSERT(stream != NULL);
     mRenderPosition = 0;
     mFramesWrittenAtStandby = mFramesWritten;
+    mColdWrite = true;
     return stream->common.standby(&stream->common);
 }
 
 ssize_t AudioStreamOut::write(const void *buffer, size_t numBytes)
 {
     ALOG_ASSERT(stream != NULL);
+    const nsecs_t startNs = systemTime();
+    if (mTraceWrites) {
+        ATRACE_BEGIN("halWrite");
+    }
     ssize_t bytesWritten = stream->write(stream, buffer, numBytes);
+    if (mTraceWrites) {
+        ATRACE_END();
+    }
     if (bytesWritten > 0 && mHalFrameSize > 0) {
         mFramesWritten += bytesWritten / mHalFrameSize;
     }
+    recordWrite(startNs, bytesWritten);
     return bytesWritten;
 }
 
+size_t AudioStreamOut::writeBucket(nsecs_t ns)
+{
+    const uint64_t us = ns > 0 ? ns / 1000 : 0;
+    if (us < (1u << kMinOctave)) {
+        return 0;
+    }
+    const uint32_t octave = 63 - __builtin_clzll(us);
+    // the two bits below the leading one select the bucket within the octave
+    const size_t bucket = 1 + (octave - kMinOctave) * kBucketsPerOctave
+            + ((us >> (octave - 2)) & (kBucketsPerOctave - 1));
+    return bucket < kNumWriteBuckets ? bucket : kNumWriteBuckets - 1;
+}
+
+nsecs_t AudioStreamOut::writeBucketUpperNs(size_t bucket)
+{
+    if (bucket == 0) {
+        return (nsecs_t) (1u << kMinOctave) * 1000;
+    }
+    const uint32_t octave = kMinOctave + (bucket - 1) / kBucketsPerOctave;
+    const uint64_t sub = (bucket - 1) % kBucketsPerOctave;
+    return (nsecs_t) ((kBucketsPerOctave + sub + 1) << (octave - 2)) * 1000;
+}
+
+void AudioStreamOut::recordWrite(nsecs_t startNs, ssize_t bytes)
+{
+    const nsecs_t durationNs = systemTime() - startNs;
+    if (mTraceWrites) {
+        ATRACE_INT("halWriteUs", (int32_t) (durationNs / 1000));
+    }
+    // the first write after open, flush or standby includes the HAL start up time
+    const bool coldWrite = mColdWrite;
+    mColdWrite = false;
+    if (bytes <= 0 || coldWrite) {
+        return;
+    }
+    mWriteBuckets[writeBucket(durationNs)].fetch_add(1, std::memory_order_relaxed);
+    if (durationNs > mMaxWriteNs.load(std::memory_order_relaxed)) {
+        mMaxWriteNs.store(durationNs, std::memory_order_relaxed);
+    }
+
+    // Stalls are only detected for PCM, where the duration of the audio written is known.
+    // A non-blocking write returns early, so it never stalls.
+    if (!mHalFormatHasProportionalFrames || mHalFrameSize == 0 || mHalSampleRate == 0) {
+        return;
+    }
+    const nsecs_t expectedNs = (nsecs_t) ((int64_t) (bytes / mHalFrameSize) * 1000000000LL
+            / mHalSampleRate);
+    nsecs_t thresholdNs = expectedNs * kStallFactor;
+    if (thresholdNs < kMinStallNs) {
+        thresholdNs = kMinStallNs;
+    }
+    if (durationNs > thresholdNs) {
+        mLastStallNs.store(durationNs, std::memory_order_relaxed);
+        mLastStallExpectedNs.store(expectedNs, std::memory_order_relaxed);
+        const uint32_t stalls = mWriteStalls.fetch_add(1, std::memory_order_release) + 1;
+        if (mTraceWrites) {
+            ATRACE_INT("halWriteStalls", (int32_t) stalls);
+        }
+    }
+}
+
+void AudioStreamOut::getWriteStats(WriteStats *stats) const
+{
+    const uint32_t stalls = mWriteStalls.load(std::memory_order_acquire);
+    stats->stalls = stalls;
+    stats->lastStallNs = mLastStallNs.load(std::memory_order_relaxed);
+    stats->lastStallExpectedNs = mLastStallExpectedNs.load(std::memory_order_relaxed);
+    stats->maxNs = mMaxWriteNs.load(std::memory_order_relaxed);
+
+    // the count is the sum of the buckets read, so that it stays consistent with them
+    // if a write is recorded meanwhile
+    uint32_t buckets[kNumWriteBuckets];
+    uint32_t count = 0;
+    for (size_t i = 0; i < kNumWriteBuckets; i++) {
+        buckets[i] = mWriteBuckets[i].load(std::memory_order_relaxed);
+        count += buckets[i];
+    }
+    stats->count = count;
+    stats->p50Ns = 0;
+    stats->p99Ns = 0;
+    if (count == 0) {
+        return;
+    }
+    const uint64_t p50Rank = ((uint64_t) count * 50 + 99) / 100;
+    const uint64_t p99Rank = ((uint64_t) count * 99 + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kNumWriteBuckets; i++) {
+        seen += buckets[i];
+        if (stats->p50Ns == 0 && seen >= p50Rank) {
+            stats->p50Ns = writeBucketUpperNs(i);
+        }
+        if (seen >= p99Rank) {
+            stats->p99Ns = writeBucketUpperNs(i);
+            break;
+        }
+    }
+    // the maximum is exact, and bounds the percentiles
+    if (stats->p50Ns > stats->maxNs) {
+        stats->p50Ns = stats->maxNs;
+    }
+    if (stats->p99Ns > stats->maxNs) {
+        stats->p99Ns = stats->maxNs;
+    }
+}
+
 } // namespace android
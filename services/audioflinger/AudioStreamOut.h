@@ -18,10 +18,12 @@
 #ifndef ANDROID_AUDIO_STREAM_OUT_H
 #define ANDROID_AUDIO_STREAM_OUT_H
 
+#include <atomic>
 #include <stdint.h>
 #include <sys/types.h>
 
 #include <system/audio.h>
+#include <utils/Timers.h>
 
 #include "AudioStreamOut.h"
 
@@ -101,6 +103,37 @@ public:
     virtual status_t flush();
     virtual status_t standby();
 
+    /**
+     * Latency statistics of the HAL writes of this stream.
+     * Percentiles are the upper bounds of the histogram buckets they fall in,
+     * and are 0 if no write was recorded yet.
+     */
+    struct WriteStats {
+        uint32_t    count;
+        uint32_t    stalls;         // writes longer than kStallFactor times their duration
+        nsecs_t     p50Ns;
+        nsecs_t     p99Ns;
+        nsecs_t     maxNs;
+        nsecs_t     lastStallNs;    // duration of the last stall
+        nsecs_t     lastStallExpectedNs; // audio duration written by the last stall
+    };
+
+    // A write that takes more than kStallFactor times the duration of the audio it writes,
+    // and at least kMinStallNs, is counted as a stall.
+    static const uint32_t kStallFactor = 2;
+    static const nsecs_t kMinStallNs = 10000000;
+
+    /**
+     * Records a HAL write of bytes which began at startNs.  Called by write(),
+     * and by threads that write to the stream through an NBAIO sink.
+     * Must only be called by the writing thread.
+     */
+    void recordWrite(nsecs_t startNs, ssize_t bytes);
+
+    // May be called from any thread.
+    void getWriteStats(WriteStats *stats) const;
+    uint32_t writeStallCount() const { return mWriteStalls.load(std::memory_order_relaxed); }
+
 protected:
     uint64_t             mFramesWritten; // reset by flush
     uint64_t             mFramesWrittenAtStandby;
@@ -108,6 +141,25 @@ protected:
     int                  mRateMultiplier;
     bool                 mHalFormatHasProportionalFrames;
     size_t               mHalFrameSize;
+
+private:
+    // Latency histogram, with kBucketsPerOctave buckets per octave from 2^kMinOctave us,
+    // and bucket 0 for shorter writes.  Single writer, relaxed readers.
+    static const uint32_t kMinOctave = 4;
+    static const uint32_t kBucketsPerOctave = 4;
+    static const size_t kNumWriteBuckets = 1 + 20 * kBucketsPerOctave;
+
+    static size_t   writeBucket(nsecs_t ns);
+    static nsecs_t  writeBucketUpperNs(size_t bucket);
+
+    uint32_t             mHalSampleRate;
+    bool                 mTraceWrites;  // from property af.hal.write_trace
+    bool                 mColdWrite;    // next write follows open, flush or standby
+    std::atomic<uint32_t> mWriteBuckets[kNumWriteBuckets];
+    std::atomic<uint32_t> mWriteStalls;
+    std::atomic<int64_t> mMaxWriteNs;
+    std::atomic<int64_t> mLastStallNs;
+    std::atomic<int64_t> mLastStallExpectedNs;
 };
 
 } // namespace android
@@ -32,6 +32,19 @@
 #define ARRAY_SIZE(x) (sizeof(x)/sizeof((x)[0]))
 #endif
 
+#if defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#define USE_DOWNMIX_NEON 1
+#define USE_DOWNMIX_SSE 0
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define USE_DOWNMIX_NEON 0
+#define USE_DOWNMIX_SSE 1
+#else
+#define USE_DOWNMIX_NEON 0
+#define USE_DOWNMIX_SSE 0
+#endif
+
 namespace android {
 
 // ----------------------------------------------------------------------------
@@ -301,6 +314,137 @@ void RemixBufferProvider::copyFrames(void *dst, const void *src, size_t frames)
             src, mInputChannels, mIdxAry, mSampleSize, frames);
 }
 
+StereoDownmixBufferProvider::StereoDownmixBufferProvider(audio_channel_mask_t inputChannelMask,
+        size_t bufferFrameCount) :
+        CopyBufferProvider(
+                sizeof(float) * audio_channel_count_from_out_mask(inputChannelMask),
+                sizeof(float) * 2 /* stereo */,
+                bufferFrameCount),
+        mInputChannels(audio_channel_count_from_out_mask(inputChannelMask))
+{
+    ALOGV("StereoDownmixBufferProvider(%p)(%#x) %u", this, inputChannelMask, mInputChannels);
+}
+
+/*static*/ bool StereoDownmixBufferProvider::isSupported(audio_channel_mask_t inputChannelMask,
+        audio_channel_mask_t outputChannelMask, audio_format_t format)
+{
+    if (format != AUDIO_FORMAT_PCM_FLOAT || outputChannelMask != AUDIO_CHANNEL_OUT_STEREO) {
+        return false;
+    }
+    // the channels of these masks are FL FR FC LFE, then BL BR or SL SR, then SL SR for 7.1
+    switch (inputChannelMask) {
+    case AUDIO_CHANNEL_OUT_5POINT1_BACK:
+    case AUDIO_CHANNEL_OUT_5POINT1_SIDE:
+    case AUDIO_CHANNEL_OUT_7POINT1:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void StereoDownmixBufferProvider::copyFrames(void *dst, const void *src, size_t frames)
+{
+    downmix((float *) dst, (const float *) src, frames, mInputChannels);
+}
+
+// Same fold down as EffectDownmix.c:
+//   left  = (FL + (FC + LFE) * -3dB + BL [+ SL]) / 2
+//   right = (FR + (FC + LFE) * -3dB + BR [+ SR]) / 2
+// The vector loops produce 2 stereo frames from 2 input frames, and read all of their input
+// before writing, so processing in place is safe.
+/*static*/ void StereoDownmixBufferProvider::downmix(float *dst, const float *src, size_t frames,
+        uint32_t inputChannels)
+{
+    static const float kHalf = 0.5f;
+    static const float kCenterGain = 0.5f * 0.70710678f; // -3dB, halved like the other channels
+#if USE_DOWNMIX_NEON
+    const float32x4_t half = vdupq_n_f32(kHalf);
+    const float32x4_t centerGain = vdupq_n_f32(kCenterGain);
+    if (inputChannels == 6) {
+        for (; frames >= 2; frames -= 2) {
+            const float32x4_t v0 = vld1q_f32(src);      // FL0 FR0 C0  LFE0
+            const float32x4_t v1 = vld1q_f32(src + 4);  // BL0 BR0 FL1 FR1
+            const float32x4_t v2 = vld1q_f32(src + 8);  // C1  LFE1 BL1 BR1
+            src += 12;
+            const float32x4_t front = vcombine_f32(vget_low_f32(v0), vget_high_f32(v1));
+            const float32x4_t center = vcombine_f32(vget_high_f32(v0), vget_low_f32(v2));
+            const float32x4_t back = vcombine_f32(vget_low_f32(v1), vget_high_f32(v2));
+            const float32x4_t centerSum = vaddq_f32(center, vrev64q_f32(center));
+            vst1q_f32(dst, vmlaq_f32(vmulq_f32(vaddq_f32(front, back), half),
+                    centerSum, centerGain));
+            dst += 4;
+        }
+    } else {
+        for (; frames >= 2; frames -= 2) {
+            const float32x4_t a0 = vld1q_f32(src);      // FL0 FR0 C0  LFE0
+            const float32x4_t b0 = vld1q_f32(src + 4);  // BL0 BR0 SL0 SR0
+            const float32x4_t a1 = vld1q_f32(src + 8);
+            const float32x4_t b1 = vld1q_f32(src + 12);
+            src += 16;
+            const float32x4_t front = vcombine_f32(vget_low_f32(a0), vget_low_f32(a1));
+            const float32x4_t center = vcombine_f32(vget_high_f32(a0), vget_high_f32(a1));
+            const float32x4_t back = vcombine_f32(vget_low_f32(b0), vget_low_f32(b1));
+            const float32x4_t side = vcombine_f32(vget_high_f32(b0), vget_high_f32(b1));
+            const float32x4_t centerSum = vaddq_f32(center, vrev64q_f32(center));
+            vst1q_f32(dst, vmlaq_f32(vmulq_f32(vaddq_f32(vaddq_f32(front, back), side), half),
+                    centerSum, centerGain));
+            dst += 4;
+        }
+    }
+#elif USE_DOWNMIX_SSE
+    const __m128 half = _mm_set1_ps(kHalf);
+    const __m128 centerGain = _mm_set1_ps(kCenterGain);
+    if (inputChannels == 6) {
+        for (; frames >= 2; frames -= 2) {
+            const __m128 v0 = _mm_loadu_ps(src);        // FL0 FR0 C0  LFE0
+            const __m128 v1 = _mm_loadu_ps(src + 4);    // BL0 BR0 FL1 FR1
+            const __m128 v2 = _mm_loadu_ps(src + 8);    // C1  LFE1 BL1 BR1
+            src += 12;
+            const __m128 front = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 2, 1, 0));
+            const __m128 center = _mm_shuffle_ps(v0, v2, _MM_SHUFFLE(1, 0, 3, 2));
+            const __m128 back = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(3, 2, 1, 0));
+            const __m128 centerSum = _mm_add_ps(center,
+                    _mm_shuffle_ps(center, center, _MM_SHUFFLE(2, 3, 0, 1)));
+            _mm_storeu_ps(dst, _mm_add_ps(_mm_mul_ps(_mm_add_ps(front, back), half),
+                    _mm_mul_ps(centerSum, centerGain)));
+            dst += 4;
+        }
+    } else {
+        for (; frames >= 2; frames -= 2) {
+            const __m128 a0 = _mm_loadu_ps(src);        // FL0 FR0 C0  LFE0
+            const __m128 b0 = _mm_loadu_ps(src + 4);    // BL0 BR0 SL0 SR0
+            const __m128 a1 = _mm_loadu_ps(src + 8);
+            const __m128 b1 = _mm_loadu_ps(src + 12);
+            src += 16;
+            const __m128 front = _mm_movelh_ps(a0, a1);
+            const __m128 center = _mm_movehl_ps(a1, a0);
+            const __m128 back = _mm_movelh_ps(b0, b1);
+            const __m128 side = _mm_movehl_ps(b1, b0);
+            const __m128 centerSum = _mm_add_ps(center,
+                    _mm_shuffle_ps(center, center, _MM_SHUFFLE(2, 3, 0, 1)));
+            _mm_storeu_ps(dst, _mm_add_ps(
+                    _mm_mul_ps(_mm_add_ps(_mm_add_ps(front, back), side), half),
+                    _mm_mul_ps(centerSum, centerGain)));
+            dst += 4;
+        }
+    }
+#endif
+    // remaining frames, or all of them without vector support
+    for (; frames > 0; frames--) {
+        const float center = (src[2] + src[3]) * kCenterGain;
+        float left = src[0] + src[4];
+        float right = src[1] + src[5];
+        if (inputChannels == 8) {
+            left += src[6];
+            right += src[7];
+        }
+        dst[0] = left * kHalf + center;
+        dst[1] = right * kHalf + center;
+        src += inputChannels;
+        dst += 2;
+    }
+}
+
 ReformatBufferProvider::ReformatBufferProvider(int32_t channelCount,
         audio_format_t inputFormat, audio_format_t outputFormat,
         size_t bufferFrameCount) :
@@ -330,13 +474,10 @@ TimestretchBufferProvider::TimestretchBufferProvider(int32_t channelCount,
         mLocalBufferFrameCount(0),
         mLocalBufferData(NULL),
         mRemaining(0),
-        mSonicStream(sonicCreateStream(sampleRate, mChannelCount)),
+        mStretcher(NULL),
         mFallbackFailErrorShown(false),
         mAudioPlaybackRateValid(false)
 {
-    LOG_ALWAYS_FATAL_IF(mSonicStream == NULL,
-            "TimestretchBufferProvider can't allocate Sonic stream");
-
     setPlaybackRate(playbackRate);
     ALOGV("TimestretchBufferProvider(%p)(%u, %#x, %u %f %f %d %d)",
             this, channelCount, format, sampleRate, playbackRate.mSpeed,
@@ -347,7 +488,7 @@ TimestretchBufferProvider::TimestretchBufferProvider(int32_t channelCount,
 TimestretchBufferProvider::~TimestretchBufferProvider()
 {
     ALOGV("~TimestretchBufferProvider(%p)", this);
-    sonicDestroyStream(mSonicStream);
+    delete mStretcher;
     if (mBuffer.frameCount != 0) {
         mTrackBufferProvider->releaseBuffer(&mBuffer);
     }
@@ -460,7 +601,16 @@ status_t TimestretchBufferProvider::setPlaybackRate(const AudioPlaybackRate &pla
 {
     mPlaybackRate = playbackRate;
     mFallbackFailErrorShown = false;
-    sonicSetSpeed(mSonicStream, mPlaybackRate.mSpeed);
+    // a change of engine drops the few milliseconds of frames buffered by the previous one
+    const TimeStretcher::engine_t engine = TimeStretcher::selectEngine(mPlaybackRate, mFormat);
+    if (mStretcher == NULL || mStretcher->engine() != engine) {
+        ALOGV("TimestretchBufferProvider(%p) engine %d", this, engine);
+        delete mStretcher;
+        mStretcher = TimeStretcher::create(engine, mChannelCount, mFormat, mSampleRate);
+        LOG_ALWAYS_FATAL_IF(mStretcher == NULL,
+                "TimestretchBufferProvider can't create time stretcher %d", engine);
+    }
+    mStretcher->setSpeed(mPlaybackRate.mSpeed);
     //TODO: pitch is ignored for now
     //TODO: optimize: if parameters are the same, don't do any extra computation.
 
@@ -516,25 +666,11 @@ void TimestretchBufferProvider::processFrames(void *dstBuffer, size_t *dstFrames
             }
         }
     } else {
-        switch (mFormat) {
-        case AUDIO_FORMAT_PCM_FLOAT:
-            if (sonicWriteFloatToStream(mSonicStream, (float*)srcBuffer, *srcFrames) != 1) {
-                ALOGE("sonicWriteFloatToStream cannot realloc");
-                *srcFrames = 0; // cannot consume all of srcBuffer
-            }
-            *dstFrames = sonicReadFloatFromStream(mSonicStream, (float*)dstBuffer, *dstFrames);
-            break;
-        case AUDIO_FORMAT_PCM_16_BIT:
-            if (sonicWriteShortToStream(mSonicStream, (short*)srcBuffer, *srcFrames) != 1) {
-                ALOGE("sonicWriteShortToStream cannot realloc");
-                *srcFrames = 0; // cannot consume all of srcBuffer
-            }
-            *dstFrames = sonicReadShortFromStream(mSonicStream, (short*)dstBuffer, *dstFrames);
-            break;
-        default:
-            // could also be caught on construction
-            LOG_ALWAYS_FATAL("invalid format %#x for TimestretchBufferProvider", mFormat);
+        if (!mStretcher->write(srcBuffer, *srcFrames)) {
+            ALOGE("time stretcher cannot realloc");
+            *srcFrames = 0; // cannot consume all of srcBuffer
         }
+        *dstFrames = mStretcher->read(dstBuffer, *dstFrames);
     }
 }
 // ----------------------------------------------------------------------------
@@ -23,7 +23,7 @@
 #include <hardware/audio_effect.h>
 #include <media/AudioBufferProvider.h>
 #include <system/audio.h>
-#include <sonic.h>
+#include "TimeStretcher.h"
 
 namespace android {
 
@@ -132,6 +132,29 @@ protected:
     int8_t               mIdxAry[sizeof(uint32_t) * 8]; // 32 bits => channel indices
 };
 
+// StereoDownmixBufferProvider derives from CopyBufferProvider to fold down 5.1 and 7.1
+// float frames to stereo, with the coefficients of the fold down of the downmix effect.
+// It runs in the mixer input format, so unlike DownmixerBufferProvider it does not need
+// the track converted to PCM 16 bit and back, and it is vectorized with NEON or SSE.
+class StereoDownmixBufferProvider : public CopyBufferProvider {
+public:
+    StereoDownmixBufferProvider(audio_channel_mask_t inputChannelMask, size_t bufferFrameCount);
+    //Overrides
+    virtual void copyFrames(void *dst, const void *src, size_t frames);
+
+    // Returns true if the conversion from inputChannelMask to outputChannelMask in format
+    // is handled by this provider.
+    static bool isSupported(audio_channel_mask_t inputChannelMask,
+            audio_channel_mask_t outputChannelMask, audio_format_t format);
+
+    // Folds down frames of inputChannels (6 or 8) channels in src to stereo in dst.
+    // dst may be equal to src.
+    static void downmix(float *dst, const float *src, size_t frames, uint32_t inputChannels);
+
+protected:
+    const uint32_t       mInputChannels;
+};
+
 // ReformatBufferProvider derives from CopyBufferProvider to convert the input data
 // to an acceptable mixer input format type.
 class ReformatBufferProvider : public CopyBufferProvider {
@@ -185,8 +208,7 @@ private:
     void                *mLocalBufferData;        // internally allocated buffer for data returned
                                                   // to caller
     size_t               mRemaining;              // remaining data in local buffer
-    sonicStream          mSonicStream;            // handle to sonic timestretch object
-    //FIXME: this dependency should be abstracted out
+    TimeStretcher       *mStretcher;              // engine selected by setPlaybackRate()
     bool                 mFallbackFailErrorShown; // log fallback error only once
     bool                 mAudioPlaybackRateValid; // flag for current parameters validity
 };
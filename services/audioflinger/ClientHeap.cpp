@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "ClientHeap"
+//#define LOG_NDEBUG 0
+
+#include <string.h>
+
+#include <binder/MemoryBase.h>
+#include <utils/Log.h>
+
+#include "ClientHeap.h"
+
+namespace android {
+
+// ----------------------------------------------------------------------------
+
+SlabAllocator::SlabAllocator(size_t size)
+    : mPageCount(size / kPageSize),
+      mPages(new Page[size / kPageSize]),
+      mFailures(0)
+{
+    for (size_t i = 0; i < mPageCount; i++) {
+        mPages[i].mKind = PAGE_FREE;
+        mPages[i].mHead = i;
+        mPages[i].mPages = 0;
+        mPages[i].mFreeSlots = 0;
+    }
+}
+
+SlabAllocator::~SlabAllocator()
+{
+    ALOGW_IF(!mRequested.isEmpty(), "%zu allocations still in use", mRequested.size());
+    delete[] mPages;
+}
+
+// static
+size_t SlabAllocator::classBytes(size_t index)
+{
+    if (index >= kNumClasses) {
+        return 0;
+    }
+    return (kMinClassBytes << index) + kHeaderBytes;
+}
+
+// static
+size_t SlabAllocator::slotsPerSlab(size_t index)
+{
+    size_t slots = kSlabBytes / classBytes(index);
+    if (slots < 1) {
+        slots = 1;
+    } else if (slots > kMaxSlotsPerSlab) {
+        slots = kMaxSlotsPerSlab;
+    }
+    return slots;
+}
+
+// static
+size_t SlabAllocator::pagesPerSlab(size_t index)
+{
+    return (slotsPerSlab(index) * classBytes(index) + kPageSize - 1) / kPageSize;
+}
+
+ssize_t SlabAllocator::allocatePages(size_t pages)
+{
+    ssize_t best = -1;
+    size_t bestPages = 0;
+    size_t i = 0;
+    while (i < mPageCount) {
+        if (mPages[i].mKind != PAGE_FREE) {
+            i += mPages[mPages[i].mHead].mPages;
+            continue;
+        }
+        size_t j = i;
+        while (j < mPageCount && mPages[j].mKind == PAGE_FREE) {
+            j++;
+        }
+        const size_t run = j - i;
+        if (run >= pages && (best < 0 || run < bestPages)) {
+            best = i;
+            bestPages = run;
+            if (run == pages) {
+                break;
+            }
+        }
+        i = j;
+    }
+    return best;
+}
+
+void SlabAllocator::freePages(size_t head)
+{
+    const size_t pages = mPages[head].mPages;
+    for (size_t i = head; i < head + pages; i++) {
+        mPages[i].mKind = PAGE_FREE;
+        mPages[i].mHead = i;
+        mPages[i].mPages = 0;
+        mPages[i].mFreeSlots = 0;
+    }
+}
+
+ssize_t SlabAllocator::allocate(size_t size)
+{
+    if (size == 0) {
+        size = 1;
+    }
+    size_t index = 0;
+    while (index < kNumClasses && classBytes(index) < size) {
+        index++;
+    }
+
+    ssize_t offset = -1;
+    if (index < kNumClasses) {
+        // look for a slab of this class with a free slot, otherwise start a new slab
+        ssize_t head = -1;
+        size_t i = 0;
+        while (i < mPageCount) {
+            if (mPages[i].mKind == PAGE_FREE) {
+                i++;
+                continue;
+            }
+            if (mPages[i].mKind == (int8_t) index && mPages[i].mFreeSlots != 0) {
+                head = i;
+                break;
+            }
+            i += mPages[i].mPages;
+        }
+        if (head < 0) {
+            const size_t pages = pagesPerSlab(index);
+            head = allocatePages(pages);
+            if (head >= 0) {
+                for (size_t j = head; j < head + pages; j++) {
+                    mPages[j].mKind = index;
+                    mPages[j].mHead = head;
+                }
+                mPages[head].mPages = pages;
+                const size_t slots = slotsPerSlab(index);
+                mPages[head].mFreeSlots =
+                        slots == 32 ? 0xFFFFFFFF : (uint32_t) ((1u << slots) - 1);
+            }
+        }
+        if (head >= 0) {
+            const int slot = __builtin_ctz(mPages[head].mFreeSlots);
+            mPages[head].mFreeSlots &= ~(1u << slot);
+            offset = head * kPageSize + slot * classBytes(index);
+        }
+    } else {
+        const size_t pages = (size + kPageSize - 1) / kPageSize;
+        const ssize_t head = pages <= mPageCount ? allocatePages(pages) : -1;
+        if (head >= 0) {
+            for (size_t i = head; i < head + pages; i++) {
+                mPages[i].mKind = PAGE_LARGE;
+                mPages[i].mHead = head;
+            }
+            mPages[head].mPages = pages;
+            offset = head * kPageSize;
+        }
+    }
+
+    if (offset < 0) {
+        mFailures++;
+        return -1;
+    }
+    mRequested.add(offset, size);
+    return offset;
+}
+
+void SlabAllocator::deallocate(size_t offset)
+{
+    const ssize_t index = mRequested.indexOfKey(offset);
+    if (index < 0) {
+        ALOGE("deallocate() of unknown offset %zu", offset);
+        return;
+    }
+    mRequested.removeItemsAt(index);
+
+    const size_t head = mPages[offset / kPageSize].mHead;
+    const int8_t kind = mPages[head].mKind;
+    if (kind == PAGE_LARGE) {
+        freePages(head);
+        return;
+    }
+    ALOG_ASSERT(kind >= 0 && (size_t) kind < kNumClasses);
+    const size_t slot = (offset - head * kPageSize) / classBytes(kind);
+    mPages[head].mFreeSlots |= 1u << slot;
+    const size_t slots = slotsPerSlab(kind);
+    const uint32_t allFree = slots == 32 ? 0xFFFFFFFF : (uint32_t) ((1u << slots) - 1);
+    if (mPages[head].mFreeSlots == allFree) {
+        // the slab is empty, so make its pages available to any size class
+        freePages(head);
+    }
+}
+
+void SlabAllocator::getStats(Stats *stats) const
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->mHeapBytes = size();
+    for (size_t i = 0; i < mRequested.size(); i++) {
+        stats->mRequestedBytes += mRequested.valueAt(i);
+    }
+    stats->mAllocations = mRequested.size();
+    stats->mFailures = mFailures;
+    size_t freeRun = 0;
+    size_t i = 0;
+    while (i < mPageCount) {
+        const Page& page = mPages[i];
+        if (page.mKind == PAGE_FREE) {
+            stats->mFreeBytes += kPageSize;
+            freeRun++;
+            if (freeRun * kPageSize > stats->mLargestFreeBytes) {
+                stats->mLargestFreeBytes = freeRun * kPageSize;
+            }
+            i++;
+            continue;
+        }
+        freeRun = 0;
+        stats->mUsedBytes += page.mPages * kPageSize;
+        if (page.mKind == PAGE_LARGE) {
+            stats->mLargeRuns++;
+        } else {
+            stats->mSlabs[page.mKind]++;
+            stats->mSlotsUsed[page.mKind] +=
+                    slotsPerSlab(page.mKind) - __builtin_popcount(page.mFreeSlots);
+        }
+        i += page.mPages;
+    }
+}
+
+void SlabAllocator::dump(String8& result, const char *prefix) const
+{
+    Stats stats;
+    getStats(&stats);
+    // external fragmentation: share of the free bytes not usable by the largest large request
+    const float fragmentation = stats.mFreeBytes == 0 ? 0.0f :
+            1.0f - (float) stats.mLargestFreeBytes / stats.mFreeBytes;
+    result.appendFormat("%sheap %zu KiB, used %zu KiB, requested %zu KiB, free %zu KiB, "
+            "largest free %zu KiB, fragmentation %.0f%%\n",
+            prefix, stats.mHeapBytes / 1024, stats.mUsedBytes / 1024,
+            stats.mRequestedBytes / 1024, stats.mFreeBytes / 1024,
+            stats.mLargestFreeBytes / 1024, fragmentation * 100.0f);
+    result.appendFormat("%sallocations %u, large %u, failures %u, slabs (slots used) per class:",
+            prefix, stats.mAllocations, stats.mLargeRuns, stats.mFailures);
+    for (size_t i = 0; i < kNumClasses; i++) {
+        result.appendFormat(" %zu:%u(%u)", classBytes(i), stats.mSlabs[i], stats.mSlotsUsed[i]);
+    }
+    result.append("\n");
+}
+
+// ----------------------------------------------------------------------------
+
+class ClientHeap::Allocation : public MemoryBase {
+public:
+    Allocation(const sp<ClientHeap>& heap, ssize_t offset, size_t size)
+        : MemoryBase(heap->getMemoryHeap(), offset, size), mClientHeap(heap) { }
+
+    virtual ~Allocation() {
+        ssize_t offset;
+        size_t size;
+        (void) getMemory(&offset, &size);
+        mClientHeap->deallocate(offset);
+    }
+
+private:
+    const sp<ClientHeap> mClientHeap;
+};
+
+ClientHeap::ClientHeap(size_t size, const char *name)
+    : mHeap(new MemoryHeapBase(size, 0 /*flags*/, name)),
+      mAllocator(size)
+{
+    ALOGE_IF(mHeap->getHeapID() < 0, "cannot create heap %s of %zu bytes", name, size);
+}
+
+ClientHeap::~ClientHeap()
+{
+}
+
+sp<IMemory> ClientHeap::allocate(size_t size)
+{
+    if (mHeap->getHeapID() < 0) {
+        return 0;
+    }
+    ssize_t offset;
+    {
+        Mutex::Autolock _l(mLock);
+        offset = mAllocator.allocate(size);
+    }
+    if (offset < 0) {
+        return 0;
+    }
+    return new Allocation(this, offset, size);
+}
+
+void ClientHeap::deallocate(size_t offset)
+{
+    Mutex::Autolock _l(mLock);
+    mAllocator.deallocate(offset);
+}
+
+void ClientHeap::getStats(SlabAllocator::Stats *stats) const
+{
+    Mutex::Autolock _l(mLock);
+    mAllocator.getStats(stats);
+}
+
+void ClientHeap::dump(const char *what) const
+{
+    String8 result;
+    dump(result, "");
+    ALOGD("%s: %s", what, result.string());
+}
+
+void ClientHeap::dump(String8& result, const char *prefix) const
+{
+    Mutex::Autolock _l(mLock);
+    mAllocator.dump(result, prefix);
+}
+
+}   // namespace android
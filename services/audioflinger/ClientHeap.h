@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_CLIENT_HEAP_H
+#define ANDROID_AUDIO_CLIENT_HEAP_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <binder/IMemory.h>
+#include <binder/MemoryHeapBase.h>
+#include <utils/KeyedVector.h>
+#include <utils/RefBase.h>
+#include <utils/String8.h>
+#include <utils/threads.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+// SlabAllocator manages the offsets of a fixed size region, typically a shared memory heap,
+// for track and effect control blocks with their buffers.
+//
+// The region is divided into pages.  Requests up to the largest size class are rounded up to
+// a class, and served from a slab: a run of pages carved into equal slots of that class.
+// Size classes are a power of 2 plus kHeaderBytes, so that a control block followed by a
+// buffer of a typical frame count (a power of 2 number of bytes) fits a class tightly.
+// Larger requests get a dedicated run of pages, chosen by best fit.
+// A slab whose slots are all free returns its pages to the pool, so that they can be reused
+// by any size class or by a large request.
+//
+// Not thread-safe; the caller serializes access.
+class SlabAllocator {
+public:
+    static const size_t kPageSize = 4096;
+    static const size_t kHeaderBytes = 256;     // room for a control block ahead of the buffer
+    static const size_t kMinClassBytes = 1024;  // smallest power of 2 part of a size class
+    static const size_t kNumClasses = 6;        // 1 KiB to 32 KiB plus kHeaderBytes
+    static const size_t kSlabBytes = 64 * 1024; // nominal slab size, before rounding to pages
+    static const size_t kMaxSlotsPerSlab = 32;
+
+    // size is rounded down to a multiple of kPageSize
+    explicit SlabAllocator(size_t size);
+    ~SlabAllocator();
+
+    // Returns the offset of a block of at least size bytes, or a negative value if none is
+    // available.  Offsets are aligned to at least 256 bytes.
+    ssize_t     allocate(size_t size);
+
+    // Frees the block at offset, which must have been returned by allocate().
+    void        deallocate(size_t offset);
+
+    size_t      size() const { return mPageCount * kPageSize; }
+
+    struct Stats {
+        size_t      mHeapBytes;         // total size of the region
+        size_t      mRequestedBytes;    // sum of the sizes requested by live allocations
+        size_t      mUsedBytes;         // bytes of pages held by slabs and large runs
+        size_t      mFreeBytes;         // bytes of free pages
+        size_t      mLargestFreeBytes;  // largest run of free pages, the largest possible
+                                        // large request
+        uint32_t    mAllocations;       // number of live allocations
+        uint32_t    mFailures;          // total number of failed allocate() calls
+        uint32_t    mSlabs[kNumClasses];        // number of slabs per size class
+        uint32_t    mSlotsUsed[kNumClasses];    // number of slots in use per size class
+        uint32_t    mLargeRuns;                 // number of live large requests
+    };
+    void        getStats(Stats *stats) const;
+
+    // Appends a human-readable summary of getStats() to result, each line starting with prefix.
+    void        dump(String8& result, const char *prefix) const;
+
+    // Size in bytes of the slots of size class index, or 0 if index is out of range
+    static size_t classBytes(size_t index);
+
+private:
+    enum {
+        PAGE_FREE = -1,     // page is not in use
+        PAGE_LARGE = -2,    // page belongs to a large request
+        // values >= 0 are the size class of the slab that the page belongs to
+    };
+
+    struct Page {
+        int8_t      mKind;      // PAGE_FREE, PAGE_LARGE, or size class index
+        uint32_t    mHead;      // first page of the slab or large run containing this page
+        uint32_t    mPages;     // number of pages of the slab or run, valid on the head page
+        uint32_t    mFreeSlots; // bit i set if slot i of the slab is free, valid on the head page
+    };
+
+    // returns the first page of a best fit run of free pages, or -1
+    ssize_t     allocatePages(size_t pages);
+    void        freePages(size_t head);
+    static size_t slotsPerSlab(size_t index);
+    static size_t pagesPerSlab(size_t index);
+
+    const size_t    mPageCount;
+    Page*           mPages;
+    KeyedVector<size_t, size_t> mRequested; // offset to requested size of live allocations
+    uint32_t        mFailures;
+
+    SlabAllocator(const SlabAllocator&);
+    SlabAllocator& operator=(const SlabAllocator&);
+};
+
+// ClientHeap hands out IMemory blocks of a single shared memory heap, replacing MemoryDealer
+// for the control blocks and buffers of the tracks and effects of a client process.
+// The IMemory blocks keep the ClientHeap alive, and free their block on destruction.
+class ClientHeap : public RefBase {
+public:
+    ClientHeap(size_t size, const char *name);
+    virtual ~ClientHeap();
+
+    // Returns 0 if the heap has no block of size bytes available.
+    sp<IMemory>     allocate(size_t size);
+
+    // Logs the heap statistics, for example after a failed allocate().
+    void            dump(const char *what) const;
+
+    // Appends the heap statistics to result, each line starting with prefix.
+    void            dump(String8& result, const char *prefix) const;
+
+    void            getStats(SlabAllocator::Stats *stats) const;
+
+    const sp<IMemoryHeap>& getMemoryHeap() const { return mHeap; }
+
+private:
+    class Allocation;
+    friend class Allocation;
+
+    void            deallocate(size_t offset);
+
+    const sp<IMemoryHeap>   mHeap;
+    mutable Mutex           mLock;
+    SlabAllocator           mAllocator;     // protected by mLock
+};
+
+}   // namespace android
+
+#endif  // ANDROID_AUDIO_CLIENT_HEAP_H
@@ -1483,7 +1483,7 @@ void AudioFlinger::EffectHandle::dumpToBuffer(char* buffer, size_t size)
 AudioFlinger::EffectChain::EffectChain(ThreadBase *thread,
                                         audio_session_t sessionId)
     : mThread(thread), mSessionId(sessionId), mActiveTrackCnt(0), mTrackCnt(0), mTailBufferCount(0),
-      mOwnInBuffer(false), mVolumeCtrlIdx(-1), mLeftVolume(UINT_MAX), mRightVolume(UINT_MAX),
+      mProcessNs(0), mOwnInBuffer(false), mOwnOutBuffer(false), mVolumeCtrlIdx(-1), mLeftVolume(UINT_MAX), mRightVolume(UINT_MAX),
       mNewLeftVolume(UINT_MAX), mNewRightVolume(UINT_MAX)
 {
     mStrategy = AudioSystem::getStrategyForStream(AUDIO_STREAM_MUSIC);
@@ -1499,6 +1499,9 @@ AudioFlinger::EffectChain::~EffectChain()
     if (mOwnInBuffer) {
         delete mInBuffer;
     }
+    if (mOwnOutBuffer) {
+        delete[] mOutBuffer;
+    }
 }
 
 // getEffectFromDesc_l() must be called with ThreadBase::mLock held
@@ -1601,9 +1604,12 @@ void AudioFlinger::EffectChain::process_l()
 
     size_t size = mEffects.size();
     if (doProcess) {
+        const nsecs_t startNs = systemTime();
         for (size_t i = 0; i < size; i++) {
             mEffects[i]->process();
         }
+        mProcessNs.store(mProcessNs.load(std::memory_order_relaxed) + systemTime() - startNs,
+                std::memory_order_relaxed);
     }
     bool doResetVolume = false;
     for (size_t i = 0; i < size; i++) {
@@ -307,8 +307,17 @@ public:
     int16_t *inBuffer() const {
         return mInBuffer;
     }
-    void setOutBuffer(int16_t *buffer) {
+    void setOutBuffer(int16_t *buffer, bool ownsBuffer = false) {
+        if (mOwnOutBuffer && buffer != mOutBuffer) {
+            delete[] mOutBuffer;
+        }
         mOutBuffer = buffer;
+        mOwnOutBuffer = ownsBuffer;
+    }
+    // true if the chain writes to a private output buffer, which the thread then accumulates
+    // into the mix, see PlaybackThread::processEffectChains()
+    bool ownsOutBuffer() const {
+        return mOwnOutBuffer;
     }
     int16_t *outBuffer() const {
         return mOutBuffer;
@@ -323,6 +332,9 @@ public:
     void decActiveTrackCnt() { android_atomic_dec(&mActiveTrackCnt); }
     int32_t activeTrackCnt() const { return android_atomic_acquire_load(&mActiveTrackCnt); }
 
+    // cumulative time in nanoseconds spent processing the effects of this chain
+    int64_t processNs() const { return mProcessNs.load(std::memory_order_relaxed); }
+
     uint32_t strategy() const { return mStrategy; }
     void setStrategy(uint32_t strategy)
             { mStrategy = strategy; }
@@ -401,8 +413,11 @@ protected:
     volatile int32_t mTrackCnt;          // number of tracks connected
 
              int32_t mTailBufferCount;   // current effect tail buffer count
+             // written by process_l() on the thread loop, read with the thread lock held
+             std::atomic<int64_t> mProcessNs; // cumulative effect processing time
              int32_t mMaxTailBuffers;    // maximum effect tail buffers
              bool mOwnInBuffer;          // true if the chain owns its input buffer
+             bool mOwnOutBuffer;         // true if the chain owns its output buffer
              int mVolumeCtrlIdx;         // index of insert effect having control over volume
              uint32_t mLeftVolume;       // previous volume on left channel
              uint32_t mRightVolume;      // previous volume on right channel
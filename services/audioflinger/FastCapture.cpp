@@ -32,6 +32,9 @@ namespace android {
 /*static*/ const FastCaptureState FastCapture::sInitial;
 
 FastCapture::FastCapture() : FastThread("cycleC_ms", "loadC_us"),
+    // mTimestampShared
+    mTimestampMutator(&mTimestampShared),
+    mTimestampObserver(&mTimestampShared),
     mInputSource(NULL), mInputSourceGen(0), mPipeSink(NULL), mPipeSinkGen(0),
     mReadBuffer(NULL), mReadBufferState(-1), mFormat(Format_Invalid), mSampleRate(0),
     // mDummyDumpState
@@ -176,6 +179,15 @@ void FastCapture::onWork()
             mTotalNativeFramesRead += framesRead;
             dumpState->mFramesRead = mTotalNativeFramesRead;
             mReadBufferState = framesRead;
+            // the HAL is not busy in a read now, so the capture position does not block
+            ExtendedTimestamp timestamp;
+            if (mInputSource->getTimestamp(timestamp) == NO_ERROR) {
+                mTimestampMutator.push(timestamp);
+                // and for all the readers of the pipe
+                if (mPipeSink != NULL) {
+                    mPipeSink->setTimestamp(timestamp);
+                }
+            }
         } else {
             dumpState->mReadErrors++;
             mReadBufferState = 0;
@@ -17,6 +17,8 @@
 #ifndef ANDROID_AUDIO_FAST_CAPTURE_H
 #define ANDROID_AUDIO_FAST_CAPTURE_H
 
+#include <media/AudioTimestamp.h>
+#include <media/SingleStateQueue.h>
 #include "FastThread.h"
 #include "StateQueue.h"
 #include "FastCaptureState.h"
@@ -25,6 +27,7 @@
 namespace android {
 
 typedef StateQueue<FastCaptureState> FastCaptureStateQueue;
+typedef SingleStateQueue<ExtendedTimestamp> ExtendedTimestampSingleStateQueue;
 
 class FastCapture : public FastThread {
 
@@ -34,9 +37,22 @@ public:
 
             FastCaptureStateQueue*  sq();
 
+            // Returns true and the kernel capture position as of the most recent HAL read,
+            // if a new one was published since the previous call.  Published by the fast
+            // capture thread right after each read, so that the normal capture thread does not
+            // call into the HAL, which could block on the read.
+            // Must only be called by the normal capture thread.
+            bool                    pollTimestamp(ExtendedTimestamp& timestamp)
+                                        { return mTimestampObserver.poll(timestamp); }
+
 private:
             FastCaptureStateQueue   mSQ;
 
+            // lock-free, single writer and single reader; the observer initializes mShared
+            ExtendedTimestampSingleStateQueue::Shared   mTimestampShared;
+            ExtendedTimestampSingleStateQueue::Mutator  mTimestampMutator;
+            ExtendedTimestampSingleStateQueue::Observer mTimestampObserver;
+
     // callouts
     virtual const FastThreadState *poll();
     virtual void setLog(NBLog::Writer *logWriter);
@@ -52,7 +68,7 @@ private:
     // FIXME by renaming, could pull up many of these to FastThread
     NBAIO_Source*       mInputSource;
     int                 mInputSourceGen;
-    NBAIO_Sink*         mPipeSink;
+    Pipe*               mPipeSink;
     int                 mPipeSinkGen;
     void*               mReadBuffer;
     ssize_t             mReadBufferState;   // number of initialized frames in readBuffer,
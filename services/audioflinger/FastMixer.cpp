@@ -39,6 +39,7 @@
 #endif
 #include <audio_utils/conversion.h>
 #include <audio_utils/format.h>
+#include <audio_utils/primitives.h>
 #include "AudioMixer.h"
 #include "FastMixer.h"
 
@@ -65,6 +66,10 @@ FastMixer::FastMixer() : FastThread("cycle_ms", "load_us"),
     mTotalNativeFramesWritten(0),
     // timestamp
     mNativeFramesWrittenButNotPresented(0),   // the = 0 is to silence the compiler
+    mDirectIndex(-1),
+    // mDirectVolume
+    mDirectProvider(NULL),
+    // mDirectBuffer
     mMasterMono(false)
 {
     // FIXME pass sInitial as parameter to base class constructor, and make it static local
@@ -323,6 +328,7 @@ void FastMixer::onStateChange()
         }
 
         mFastTracksGen = current->mFastTracksGen;
+        mDirectIndex = -1;
 
         dumpState->mNumTracks = popcount(currentTrackMask);
     }
@@ -341,6 +347,10 @@ void FastMixer::onWork()
         // AudioMixer::mState.enabledTracks is undefined if mState.hook == process__validate,
         // so we keep a side copy of enabledTracks
         bool anyEnabledTracks = false;
+        unsigned enabledTrackCount = 0;
+        // the only enabled track, if it has a full buffer; see mixDirect()
+        int directIndex = -1;
+        float directVolume[2] = {AudioMixer::UNITY_GAIN_FLOAT, AudioMixer::UNITY_GAIN_FLOAT};
 
         // for each track, update volume and check for underrun
         unsigned currentTrackMask = current->mTrackMask;
@@ -369,10 +379,12 @@ void FastMixer::onWork()
 
             int name = mFastTrackNames[i];
             ALOG_ASSERT(name >= 0);
+            float vlf = AudioMixer::UNITY_GAIN_FLOAT;
+            float vrf = AudioMixer::UNITY_GAIN_FLOAT;
             if (fastTrack->mVolumeProvider != NULL) {
                 gain_minifloat_packed_t vlr = fastTrack->mVolumeProvider->getVolumeLR();
-                float vlf = float_from_gain(gain_minifloat_unpack_left(vlr));
-                float vrf = float_from_gain(gain_minifloat_unpack_right(vlr));
+                vlf = float_from_gain(gain_minifloat_unpack_left(vlr));
+                vrf = float_from_gain(gain_minifloat_unpack_right(vlr));
 
                 mMixer->setParameter(name, AudioMixer::VOLUME, AudioMixer::VOLUME0, &vlf);
                 mMixer->setParameter(name, AudioMixer::VOLUME, AudioMixer::VOLUME1, &vrf);
@@ -403,19 +415,45 @@ void FastMixer::onWork()
                     underruns.mBitFields.mMostRecent = UNDERRUN_PARTIAL;
                     mMixer->enable(name);
                     anyEnabledTracks = true;
+                    enabledTrackCount++;
                 }
             } else {
                 underruns.mBitFields.mFull++;
                 underruns.mBitFields.mMostRecent = UNDERRUN_FULL;
                 mMixer->enable(name);
                 anyEnabledTracks = true;
+                enabledTrackCount++;
+                directIndex = i;
+                directVolume[0] = vlf;
+                directVolume[1] = vrf;
             }
             ftDump->mUnderruns = underruns;
             ftDump->mFramesReady = framesReady;
             ftDump->mFramesWritten = trackFramesWritten;
         }
 
-        if (anyEnabledTracks) {
+        // A single track matching the sink format and channel mask can bypass the mixer,
+        // once its volume has been steady for a cycle so that any volume ramp is complete.
+        if (enabledTrackCount != 1 || directIndex < 0
+                || current->mFastTracks[directIndex].mFormat != mFormat.mFormat
+                || current->mFastTracks[directIndex].mChannelMask != mSinkChannelMask
+                || ((directVolume[0] != AudioMixer::UNITY_GAIN_FLOAT
+                        || directVolume[1] != AudioMixer::UNITY_GAIN_FLOAT)
+                    && mSinkChannelCount != FCC_2)
+                || mMasterMono.load()) {  // memory_order_seq_cst
+            directIndex = -1;
+        }
+        const bool mixedDirect = directIndex >= 0 && directIndex == mDirectIndex
+                && directVolume[0] == mDirectVolume[0] && directVolume[1] == mDirectVolume[1];
+        mDirectIndex = directIndex;
+        mDirectVolume[0] = directVolume[0];
+        mDirectVolume[1] = directVolume[1];
+
+        if (mixedDirect) {
+            mixDirect(&current->mFastTracks[directIndex], directVolume[0], directVolume[1],
+                    frameCount);
+            dumpState->mDirectCycles++;
+        } else if (anyEnabledTracks) {
             // process() is CPU-bound
             mMixer->process();
             mMixerBufferState = MIXED;
@@ -428,33 +466,45 @@ void FastMixer::onWork()
     }
     //bool didFullWrite = false;    // dumpsys could display a count of partial writes
     if ((command & FastMixerState::WRITE) && (mOutputSink != NULL) && (mMixerBuffer != NULL)) {
-        if (mMixerBufferState == UNDEFINED) {
-            memset(mMixerBuffer, 0, mMixerBufferSize);
-            mMixerBufferState = ZEROED;
-        }
+        void *buffer;
+        if (mDirectBuffer.raw != NULL) {
+            // client frames already in the sink format, see mixDirect()
+            buffer = mDirectBuffer.raw;
+        } else {
+            if (mMixerBufferState == UNDEFINED) {
+                memset(mMixerBuffer, 0, mMixerBufferSize);
+                mMixerBufferState = ZEROED;
+            }
 
-        if (mMasterMono.load()) {  // memory_order_seq_cst
-            mono_blend(mMixerBuffer, mMixerBufferFormat, Format_channelCount(mFormat), frameCount,
-                    true /*limit*/);
-        }
-        // prepare the buffer used to write to sink
-        void *buffer = mSinkBuffer != NULL ? mSinkBuffer : mMixerBuffer;
-        if (mFormat.mFormat != mMixerBufferFormat) { // sink format not the same as mixer format
-            memcpy_by_audio_format(buffer, mFormat.mFormat, mMixerBuffer, mMixerBufferFormat,
-                    frameCount * Format_channelCount(mFormat));
+            if (mMasterMono.load()) {  // memory_order_seq_cst
+                mono_blend(mMixerBuffer, mMixerBufferFormat, Format_channelCount(mFormat),
+                        frameCount, true /*limit*/);
+            }
+            // prepare the buffer used to write to sink
+            buffer = mSinkBuffer != NULL ? mSinkBuffer : mMixerBuffer;
+            if (mFormat.mFormat != mMixerBufferFormat) { // sink format not the same as mixer format
+                memcpy_by_audio_format(buffer, mFormat.mFormat, mMixerBuffer, mMixerBufferFormat,
+                        frameCount * Format_channelCount(mFormat));
+            }
         }
-        // if non-NULL, then duplicate write() to this non-blocking sink
-        NBAIO_Sink* teeSink;
-        if ((teeSink = current->mTeeSink) != NULL) {
+        // if non-NULL, then duplicate write() to this non-blocking sink;
+        // under deadline pressure this is done after the sink write() instead of before it
+        NBAIO_Sink* teeSink = current->mTeeSink;
+        if (teeSink != NULL && !mDeferWork) {
             (void) teeSink->write(buffer, frameCount);
         }
         // FIXME write() is non-blocking and lock-free for a properly implemented NBAIO sink,
         //       but this code should be modified to handle both non-blocking and blocking sinks
         dumpState->mWriteSequence++;
         ATRACE_BEGIN("write");
+        const nsecs_t writeStartNs = systemTime(SYSTEM_TIME_MONOTONIC);
         ssize_t framesWritten = mOutputSink->write(buffer, frameCount);
+        mWriteNs = (long) (systemTime(SYSTEM_TIME_MONOTONIC) - writeStartNs);
         ATRACE_END();
         dumpState->mWriteSequence++;
+        if (teeSink != NULL && mDeferWork) {
+            (void) teeSink->write(buffer, frameCount);
+        }
         if (framesWritten >= 0) {
             ALOG_ASSERT((size_t) framesWritten <= frameCount);
             mTotalNativeFramesWritten += framesWritten;
@@ -499,6 +549,71 @@ void FastMixer::onWork()
             mTimestamp.mTimeNs[ExtendedTimestamp::LOCATION_KERNEL] = -1;
         }
     }
+    if (mDirectBuffer.raw != NULL) {
+        mDirectProvider->releaseBuffer(&mDirectBuffer);
+        mDirectProvider = NULL;
+    }
+}
+
+// Replaces AudioMixer for a cycle when a single fast track is enabled, with a full buffer
+// and the same format and channel mask as the sink, so no resampling, remixing or format
+// conversion is needed.  At unity gain, client frames that are contiguous in shared memory
+// are handed to the sink write() without a copy, and released afterwards by onWork().
+// Otherwise they are copied into mMixerBuffer with the track volume applied; as the mixer
+// buffer format then equals the sink format, this is the only pass over the data.
+void FastMixer::mixDirect(const FastTrack* fastTrack, float vlf, float vrf, size_t frameCount)
+{
+    ExtendedAudioBufferProvider* provider = fastTrack->mBufferProvider;
+    const bool unity = vlf == AudioMixer::UNITY_GAIN_FLOAT && vrf == AudioMixer::UNITY_GAIN_FLOAT;
+    AudioBufferProvider::Buffer buffer;
+    buffer.frameCount = frameCount;
+    provider->getNextBuffer(&buffer);
+    if (unity && buffer.raw != NULL && buffer.frameCount == frameCount) {
+        mDirectProvider = provider;
+        mDirectBuffer = buffer;
+        if (mMixerBufferState == MIXED) {
+            mMixerBufferState = UNDEFINED;
+        }
+        return;
+    }
+
+    const size_t frameSize = mSinkChannelCount * audio_bytes_per_sample(mMixerBufferFormat);
+    const uint16_t vl = u4_12_from_float(vlf);
+    const uint16_t vr = u4_12_from_float(vrf);
+    size_t framesDone = 0;
+    while (buffer.raw != NULL) {
+        void *dst = (char *) mMixerBuffer + framesDone * frameSize;
+        if (unity) {
+            memcpy(dst, buffer.raw, buffer.frameCount * frameSize);
+        } else if (mMixerBufferFormat == AUDIO_FORMAT_PCM_FLOAT) {
+            // stereo only, checked by onWork()
+            const float *in = (const float *) buffer.raw;
+            float *out = (float *) dst;
+            for (size_t i = 0; i < buffer.frameCount; ++i) {
+                *out++ = *in++ * vlf;
+                *out++ = *in++ * vrf;
+            }
+        } else {
+            const int16_t *in = buffer.i16;
+            int16_t *out = (int16_t *) dst;
+            for (size_t i = 0; i < buffer.frameCount; ++i) {
+                *out++ = clamp16((*in++ * vl) >> 12);
+                *out++ = clamp16((*in++ * vr) >> 12);
+            }
+        }
+        framesDone += buffer.frameCount;
+        provider->releaseBuffer(&buffer);
+        if (framesDone >= frameCount) {
+            break;
+        }
+        buffer.frameCount = frameCount - framesDone;
+        provider->getNextBuffer(&buffer);
+    }
+    if (framesDone < frameCount) {
+        memset((char *) mMixerBuffer + framesDone * frameSize, 0,
+                (frameCount - framesDone) * frameSize);
+    }
+    mMixerBufferState = MIXED;
 }
 
 }   // namespace android
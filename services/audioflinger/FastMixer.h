@@ -53,6 +53,8 @@ private:
     virtual void onStateChange();
     virtual void onWork();
 
+            void mixDirect(const FastTrack* fastTrack, float vlf, float vrf, size_t frameCount);
+
     // FIXME these former local variables need comments
     static const FastMixerState sInitial;
 
@@ -86,6 +88,13 @@ private:
     ExtendedTimestamp mTimestamp;
     int64_t         mNativeFramesWrittenButNotPresented;
 
+    // single fast track bypass of the mixer, see mixDirect()
+    int             mDirectIndex;       // fast track index eligible for bypass last cycle, or -1
+    float           mDirectVolume[2];   // volume of that track last cycle
+    ExtendedAudioBufferProvider* mDirectProvider; // provider of mDirectBuffer
+    AudioBufferProvider::Buffer mDirectBuffer;    // client frames handed to write() this cycle,
+                                                  // raw is NULL if none
+
     // accessed without lock between multiple threads.
     std::atomic_bool mMasterMono;
     std::atomic_int_fast64_t mBoottimeOffset;
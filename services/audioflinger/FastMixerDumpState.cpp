@@ -20,6 +20,7 @@
 #include "Configuration.h"
 #ifdef FAST_THREAD_STATISTICS
 #include <cpustats/CentralTendencyStatistics.h>
+#include <cpustats/LogHistogram.h>
 #ifdef CPU_FREQUENCY_STATISTICS
 #include <cpustats/ThreadCpuUsage.h>
 #endif
@@ -32,7 +33,7 @@ namespace android {
 
 FastMixerDumpState::FastMixerDumpState() : FastThreadDumpState(),
     mWriteSequence(0), mFramesWritten(0),
-    mNumTracks(0), mWriteErrors(0),
+    mNumTracks(0), mWriteErrors(0), mDirectCycles(0),
     mSampleRate(0), mFrameCount(0),
     mTrackMask(0)
 {
@@ -66,13 +67,13 @@ void FastMixerDumpState::dump(int fd) const
             (mMeasuredWarmupTs.tv_nsec / 1000000.0);
     double mixPeriodSec = (double) mFrameCount / mSampleRate;
     dprintf(fd, "  FastMixer command=%s writeSequence=%u framesWritten=%u\n"
-                "            numTracks=%u writeErrors=%u underruns=%u overruns=%u\n"
+                "            numTracks=%u writeErrors=%u directCycles=%u underruns=%u overruns=%u\n"
                 "            sampleRate=%u frameCount=%zu measuredWarmup=%.3g ms, warmupCycles=%u\n"
-                "            mixPeriod=%.2f ms\n",
+                "            mixPeriod=%.2f ms deferredCycles=%u jitter=%.3f ms\n",
                 FastMixerState::commandToString(mCommand), mWriteSequence, mFramesWritten,
-                mNumTracks, mWriteErrors, mUnderruns, mOverruns,
+                mNumTracks, mWriteErrors, mDirectCycles, mUnderruns, mOverruns,
                 mSampleRate, mFrameCount, measuredWarmupMs, mWarmupCycles,
-                mixPeriodSec * 1e3);
+                mixPeriodSec * 1e3, mDeferredCycles, mJitterNs * 1e-6);
 #ifdef FAST_THREAD_STATISTICS
     // find the interval of valid samples
     uint32_t bounds = mBounds;
@@ -95,6 +96,9 @@ void FastMixerDumpState::dump(int fd) const
     // sample set, we get 99.8% combined, or close to three standard deviations.
     static const uint32_t kTailDenominator = 1000;
     uint32_t *tail = n >= kTailDenominator ? new uint32_t[n] : NULL;
+    // histograms of cycle and sink write() times from 1 us to 1 s, for percentiles within 2%
+    LogHistogram wallHistogram(1000 /*minValue*/, 20 /*octaves*/, 24 /*bucketsPerOctave*/);
+    LogHistogram writeHistogram(1000 /*minValue*/, 20 /*octaves*/, 24 /*bucketsPerOctave*/);
     // loop over all the samples
     for (uint32_t j = 0; j < n; ++j) {
         size_t i = oldestClosed++ & (mSamplingN - 1);
@@ -103,6 +107,8 @@ void FastMixerDumpState::dump(int fd) const
             tail[j] = wallNs;
         }
         wall.sample(wallNs);
+        wallHistogram.sample(wallNs);
+        writeHistogram.sample(mWriteNs[i]);
         uint32_t sampleLoadNs = mLoadNs[i];
         loadNs.sample(sampleLoadNs);
 #ifdef CPU_FREQUENCY_STATISTICS
@@ -130,6 +136,14 @@ void FastMixerDumpState::dump(int fd) const
                     "      mean=%.0f min=%.0f max=%.0f stddev=%.0f\n",
                     loadNs.mean()*1e-3, loadNs.minimum()*1e-3, loadNs.maximum()*1e-3,
                     loadNs.stddev()*1e-3);
+        dprintf(fd, "    percentiles in ms of wall clock time per mix cycle:\n"
+                    "      p50=%.2f p90=%.2f p99=%.2f p99.9=%.2f\n",
+                    wallHistogram.quantile(0.5)*1e-6, wallHistogram.quantile(0.9)*1e-6,
+                    wallHistogram.quantile(0.99)*1e-6, wallHistogram.quantile(0.999)*1e-6);
+        dprintf(fd, "    percentiles in ms of sink write() time per mix cycle:\n"
+                    "      p50=%.2f p90=%.2f p99=%.2f p99.9=%.2f\n",
+                    writeHistogram.quantile(0.5)*1e-6, writeHistogram.quantile(0.9)*1e-6,
+                    writeHistogram.quantile(0.99)*1e-6, writeHistogram.quantile(0.999)*1e-6);
     } else {
         dprintf(fd, "  No FastMixer statistics available currently\n");
     }
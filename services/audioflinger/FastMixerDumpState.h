@@ -70,6 +70,7 @@ struct FastMixerDumpState : FastThreadDumpState {
     uint32_t mFramesWritten;    // total number of frames written successfully
     uint32_t mNumTracks;        // total number of active fast tracks
     uint32_t mWriteErrors;      // total number of write() errors
+    uint32_t mDirectCycles;     // total number of cycles that bypassed the mixer
     uint32_t mSampleRate;
     size_t   mFrameCount;
     uint32_t mTrackMask;        // mask of active tracks
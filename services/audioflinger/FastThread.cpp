@@ -32,6 +32,15 @@
 #define MIN_WARMUP_CYCLES          2    // minimum number of consecutive in-range loop cycles
                                         // to wait for warmup
 #define MAX_WARMUP_CYCLES         10    // maximum number of loop cycles to wait for warmup
+#define FAST_MIN_SLEEP_NS     100000L   // 100 us: under deadline pressure, yield instead of a
+                                        // shorter nanosleep, whose wakeup latency is comparable
+#define MISS_SCORE_UNDERRUN      256    // added to mMissScore for an underrun
+#define MISS_SCORE_LATE           64    // added for a cycle more than halfway to an underrun
+#define MISS_SCORE_DEFER          64    // defer work while mMissScore is at least this value
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE             6    // not defined by all C libraries
+#endif
 
 namespace android {
 
@@ -47,6 +56,10 @@ FastThread::FastThread(const char *cycleMs, const char *loadUs) : Thread(false /
     mForceNs(0),
     mWarmupNsMin(0),
     mWarmupNsMax(LONG_MAX),
+    mWriteNs(0),
+    mJitterNs(0),
+    mMissScore(0),
+    mDeferWork(false),
     // re-initialized to &mDummySubclassDumpState by subclass constructor
     mDummyDumpState(NULL),
     mDumpState(NULL),
@@ -168,7 +181,7 @@ bool FastThread::threadLoop()
                     syscall(__NR_futex, coldFutexAddr, FUTEX_WAIT_PRIVATE, old - 1, NULL);
                 }
                 int policy = sched_getscheduler(0) & ~SCHED_RESET_ON_FORK;
-                if (!(policy == SCHED_FIFO || policy == SCHED_RR)) {
+                if (!(policy == SCHED_FIFO || policy == SCHED_RR || policy == SCHED_DEADLINE)) {
                     ALOGE("did not receive expected priority boost");
                 }
                 // This may be overly conservative; there could be times that the normal mixer
@@ -178,6 +191,9 @@ bool FastThread::threadLoop()
                 mMeasuredWarmupTs.tv_nsec = 0;
                 mWarmupCycles = 0;
                 mWarmupConsecutiveInRangeCycles = 0;
+                mJitterNs = 0;
+                mMissScore = 0;
+                mDeferWork = false;
                 mSleepNs = -1;
                 mColdGen = mCurrent->mColdGen;
 #ifdef FAST_THREAD_STATISTICS
@@ -209,6 +225,7 @@ bool FastThread::threadLoop()
 
         // do work using current state here
         mAttemptedWrite = false;
+        mWriteNs = 0;
         onWork();
 
         // To be exactly periodic, compute the next sleep time based on current time.
@@ -259,6 +276,27 @@ bool FastThread::threadLoop()
                 }
                 mSleepNs = -1;
                 if (mIsWarm) {
+                    // Estimate how close recent cycles came to missing the sink deadline.
+                    // Both the peak deviation from the period and the miss score decay by 1/64
+                    // per cycle, so a single underrun keeps mDeferWork set for ~90 cycles.
+                    const long deviationNs = sec > 0 ? mUnderrunNs : labs(nsec - mPeriodNs);
+                    if (deviationNs > mJitterNs) {
+                        mJitterNs = deviationNs;
+                    } else {
+                        mJitterNs -= mJitterNs >> 6;
+                    }
+                    mMissScore -= mMissScore >> 6;
+                    if (sec > 0 || nsec > mUnderrunNs) {
+                        mMissScore += MISS_SCORE_UNDERRUN;
+                    } else if (nsec > mPeriodNs + (mUnderrunNs - mPeriodNs) / 2) {
+                        mMissScore += MISS_SCORE_LATE;
+                    }
+                    mDeferWork = mMissScore >= MISS_SCORE_DEFER;
+                    if (mDeferWork) {
+                        mDumpState->mDeferredCycles++;
+                    }
+                    mDumpState->mJitterNs = mJitterNs;
+
                     if (sec > 0 || nsec > mUnderrunNs) {
                         ATRACE_NAME("underrun");
                         // FIXME only log occasionally
@@ -282,6 +320,16 @@ bool FastThread::threadLoop()
                         //  - recovers from overrun immediately after underrun
                         // It doesn't work with a non-blocking audio HAL.
                         mSleepNs = mForceNs - nsec;
+                        // Under deadline pressure, end the forced cycle early by the recent
+                        // jitter, but no earlier than mOverrunNs, so a late wakeup or a slow
+                        // write() in the next cycle is less likely to cause an underrun.
+                        if (mDeferWork) {
+                            mSleepNs -= mJitterNs < mForceNs - mOverrunNs ?
+                                    mJitterNs : mForceNs - mOverrunNs;
+                            if (mSleepNs < FAST_MIN_SLEEP_NS) {
+                                mSleepNs = 0;
+                            }
+                        }
                     } else {
                         mIgnoreNextOverrun = false;
                     }
@@ -334,6 +382,7 @@ bool FastThread::threadLoop()
                     // or with respect to store #4 below
                     mDumpState->mMonotonicNs[i] = monotonicNs;
                     mDumpState->mLoadNs[i] = loadNs;
+                    mDumpState->mWriteNs[i] = mWriteNs;
 #ifdef CPU_FREQUENCY_STATISTICS
                     mDumpState->mCpukHz[i] = kHz;
 #endif
@@ -62,6 +62,11 @@ protected:
     long            mWarmupNsMin;   // warmup complete when write cycle is greater than or equal to
                                     // this value
     long            mWarmupNsMax;   // and less than or equal to this value
+    long            mWriteNs;       // duration of the most recent sink write(), set by onWork()
+    long            mJitterNs;      // decaying peak deviation of cycle time from mPeriodNs
+    uint32_t        mMissScore;     // decaying weighted count of recent late cycles
+    bool            mDeferWork;     // true means onWork() should defer work that the sink write()
+                                    // doesn't depend on, such as tee and log, until after it
     FastThreadDumpState* mDummyDumpState;
     FastThreadDumpState* mDumpState;
     bool            mIgnoreNextOverrun;     // used to ignore initial overrun and first after an
@@ -21,7 +21,7 @@ namespace android {
 FastThreadDumpState::FastThreadDumpState() :
     mCommand(FastThreadState::INITIAL), mUnderruns(0), mOverruns(0),
     /* mMeasuredWarmupTs({0, 0}), */
-    mWarmupCycles(0)
+    mWarmupCycles(0), mDeferredCycles(0), mJitterNs(0)
 #ifdef FAST_THREAD_STATISTICS
     , mSamplingN(0), mBounds(0)
 #endif
@@ -48,6 +48,7 @@ void FastThreadDumpState::increaseSamplingN(uint32_t samplingN)
     // so clearing reduces chance for dumpsys to read random uninitialized samples
     memset(&mMonotonicNs[mSamplingN], 0, sizeof(mMonotonicNs[0]) * additional);
     memset(&mLoadNs[mSamplingN], 0, sizeof(mLoadNs[0]) * additional);
+    memset(&mWriteNs[mSamplingN], 0, sizeof(mWriteNs[0]) * additional);
 #ifdef CPU_FREQUENCY_STATISTICS
     memset(&mCpukHz[mSamplingN], 0, sizeof(mCpukHz[0]) * additional);
 #endif
@@ -37,6 +37,8 @@ struct FastThreadDumpState {
     uint32_t mOverruns;         // total number of overruns
     struct timespec mMeasuredWarmupTs;  // measured warmup time
     uint32_t mWarmupCycles;     // number of loop cycles required to warmup
+    uint32_t mDeferredCycles;   // total number of cycles run under deadline pressure
+    uint32_t mJitterNs;         // most recent decaying peak of cycle time deviation from period
 
 #ifdef FAST_THREAD_STATISTICS
     // Recently collected samples of per-cycle monotonic time, thread CPU time, and CPU frequency.
@@ -57,6 +59,7 @@ struct FastThreadDumpState {
     // The elements in the *Ns arrays are in units of nanoseconds <= 3999999999.
     uint32_t mMonotonicNs[kSamplingN];  // delta monotonic (wall clock) time
     uint32_t mLoadNs[kSamplingN];       // delta CPU load in time
+    uint32_t mWriteNs[kSamplingN];      // sink write() duration, or 0 if not measured
 #ifdef CPU_FREQUENCY_STATISTICS
     uint32_t mCpukHz[kSamplingN];       // absolute CPU clock frequency in kHz, bits 0-3 are CPU#
 #endif
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "MemoryPrefaulter"
+#define ATRACE_TAG ATRACE_TAG_AUDIO
+//#define LOG_NDEBUG 0
+
+#include <unistd.h>
+
+#include <utils/Log.h>
+#include <utils/Trace.h>
+
+#include "MemoryPrefaulter.h"
+
+namespace android {
+
+MemoryPrefaulter::MemoryPrefaulter()
+    : Thread(false /*canCallJava*/), mPagesTouched(0)
+{
+}
+
+MemoryPrefaulter::~MemoryPrefaulter()
+{
+}
+
+void MemoryPrefaulter::onFirstRef()
+{
+    run("AudioPrefault", ANDROID_PRIORITY_BACKGROUND);
+}
+
+void MemoryPrefaulter::prefault(const sp<IMemory>& memory)
+{
+    if (memory == 0 || memory->pointer() == NULL || memory->size() == 0) {
+        return;
+    }
+    Mutex::Autolock _l(mLock);
+    for (size_t i = 0; i < mPending.size(); i++) {
+        if (mPending[i]->pointer() == memory->pointer()) {
+            return;
+        }
+    }
+    mPending.add(memory);
+    mCond.signal();
+}
+
+uint64_t MemoryPrefaulter::pagesTouched() const
+{
+    Mutex::Autolock _l(mLock);
+    return mPagesTouched;
+}
+
+bool MemoryPrefaulter::threadLoop()
+{
+    sp<IMemory> memory;
+    {
+        Mutex::Autolock _l(mLock);
+        while (mPending.isEmpty() && !exitPending()) {
+            mCond.wait(mLock);
+        }
+        if (exitPending()) {
+            return false;
+        }
+        memory = mPending[0];
+        mPending.removeAt(0);
+    }
+
+    ATRACE_BEGIN("prefault");
+    const size_t pages = touch(memory->pointer(), memory->size());
+    ATRACE_END();
+    ALOGV("touched %zu pages at %p", pages, memory->pointer());
+
+    Mutex::Autolock _l(mLock);
+    mPagesTouched += pages;
+    return true;
+}
+
+void MemoryPrefaulter::requestExit()
+{
+    // must call base class
+    Thread::requestExit();
+    Mutex::Autolock _l(mLock);
+    mCond.signal();
+}
+
+size_t MemoryPrefaulter::touch(const void *pointer, size_t size)
+{
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+    const uintptr_t start = (uintptr_t) pointer & ~(pageSize - 1);
+    const uintptr_t end = (uintptr_t) pointer + size;
+    size_t pages = 0;
+    // the first page may start before pointer, but it is mapped since pointer is
+    for (uintptr_t page = start; page < end; page += pageSize) {
+        const uintptr_t address = page < (uintptr_t) pointer ? (uintptr_t) pointer : page;
+        (void) *(const volatile uint8_t *) address;
+        pages++;
+    }
+    return pages;
+}
+
+}   // namespace android
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_MEMORY_PREFAULTER_H
+#define ANDROID_AUDIO_MEMORY_PREFAULTER_H
+
+#include <stdint.h>
+
+#include <binder/IMemory.h>
+#include <utils/Condition.h>
+#include <utils/Mutex.h>
+#include <utils/Thread.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+// MemoryPrefaulter is a low priority thread that reads one byte of each page of the
+// shared memory blocks queued to it, so that the page faults of their first access by
+// audioflinger are taken on this thread rather than on a mixer thread.
+//
+// Pages are only read: the blocks are shared with a client, which may be writing them.
+// A queued block is kept mapped by its IMemory reference until it has been touched.
+class MemoryPrefaulter : public Thread {
+public:
+    MemoryPrefaulter();
+    virtual ~MemoryPrefaulter();
+
+    // Queues memory to be touched, unless it is already queued.  Does not block.
+    void        prefault(const sp<IMemory>& memory);
+
+    // Number of pages touched since creation, for dumpsys.
+    uint64_t    pagesTouched() const;
+
+    // Thread virtuals
+    virtual void requestExit();     // also wakes the thread
+
+private:
+    virtual void onFirstRef();
+    virtual bool threadLoop();
+
+    // reads each page of size bytes at pointer, and returns the number of pages read
+    static size_t touch(const void *pointer, size_t size);
+
+    mutable Mutex       mLock;
+    Condition           mCond;          // signaled when memory is queued, or on exit
+    Vector< sp<IMemory> > mPending;     // protected by mLock
+    uint64_t            mPagesTouched;  // protected by mLock
+};
+
+}   // namespace android
+
+#endif  // ANDROID_AUDIO_MEMORY_PREFAULTER_H
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_MPSC_QUEUE_H
+#define ANDROID_AUDIO_MPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+
+namespace android {
+
+// A bounded, lock-free, multi-producer single-consumer FIFO queue.
+//
+// Any number of threads may push() concurrently without taking a lock; a producer never blocks,
+// and push() returns false if the queue is full so the caller can fall back to a locked path.
+// Only one thread at a time may pop(), peek at empty(), or call size(); typically this is
+// guaranteed by calling them with the consumer's mutex held.
+//
+// Each slot carries a sequence number which tells whether it is free for production (sequence ==
+// position), or holds an item ready for consumption (sequence == position + 1).  Producers claim
+// a position with a compare and swap, then publish the item by releasing the slot sequence.
+// A producer that has claimed a slot but not yet published it makes the queue appear empty to
+// the consumer at that position; later items become visible once it completes.
+//
+// T must be default constructible and assignable; it is moved out of the slot on pop(), and the
+// slot is reset to T() so references such as sp<> are released promptly.
+// kCapacity must be a power of 2.
+
+template <typename T, size_t kCapacity>
+class MpscQueue {
+public:
+    MpscQueue() : mEnqueuePos(0), mDequeuePos(0) {
+        static_assert(kCapacity >= 2 && (kCapacity & (kCapacity - 1)) == 0,
+                "kCapacity must be a power of 2");
+        for (size_t i = 0; i < kCapacity; ++i) {
+            mSlots[i].mSequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Any thread.  Returns true if the item was queued, false if the queue is full.
+    bool push(const T& item) {
+        size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot &slot = mSlots[pos & (kCapacity - 1)];
+            const size_t seq = slot.mSequence.load(std::memory_order_acquire);
+            const ptrdiff_t diff = (ptrdiff_t) seq - (ptrdiff_t) pos;
+            if (diff == 0) {
+                if (mEnqueuePos.compare_exchange_weak(pos, pos + 1,
+                        std::memory_order_relaxed)) {
+                    slot.mItem = item;
+                    // seq_cst so a following load by the producer of the consumer's
+                    // "waiting" state cannot be reordered before the publication.
+                    slot.mSequence.store(pos + 1, std::memory_order_seq_cst);
+                    return true;
+                }
+                // pos was updated by the failed compare_exchange, retry
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = mEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer only.  Returns true and the oldest published item, or false if none is available.
+    bool pop(T* item) {
+        Slot &slot = mSlots[mDequeuePos & (kCapacity - 1)];
+        if (slot.mSequence.load(std::memory_order_seq_cst) != mDequeuePos + 1) {
+            return false;
+        }
+        *item = slot.mItem;
+        slot.mItem = T();
+        slot.mSequence.store(mDequeuePos + kCapacity, std::memory_order_release);
+        ++mDequeuePos;
+        return true;
+    }
+
+    // Consumer only.  Returns true if there is no published item at the head of the queue.
+    bool empty() const {
+        const Slot &slot = mSlots[mDequeuePos & (kCapacity - 1)];
+        return slot.mSequence.load(std::memory_order_seq_cst) != mDequeuePos + 1;
+    }
+
+    // Consumer only.  Number of claimed positions; approximate, and intended for dumpsys.
+    size_t size() const {
+        return mEnqueuePos.load(std::memory_order_relaxed) - mDequeuePos;
+    }
+
+    static size_t capacity() { return kCapacity; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> mSequence;
+        T                   mItem;
+    };
+
+    Slot                    mSlots[kCapacity];
+    std::atomic<size_t>     mEnqueuePos;    // next position claimed by a producer
+    size_t                  mDequeuePos;    // next position read by the consumer
+
+    MpscQueue(const MpscQueue&);
+    MpscQueue& operator=(const MpscQueue&);
+};
+
+}   // namespace android
+
+#endif  // ANDROID_AUDIO_MPSC_QUEUE_H
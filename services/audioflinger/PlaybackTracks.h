@@ -40,9 +40,15 @@ public:
 
     static  void        appendDumpHeader(String8& result);
             void        dump(char* buffer, size_t size, bool active);
+    static  void        appendUsageDumpHeader(String8& result);
+            void        dumpUsage(char* buffer, size_t size) const;
+            // adds this track's mixer usage to the per-uid totals in usage
+            void        addUsage(AudioUidMixerUsage *usage) const;
     virtual status_t    start(AudioSystem::sync_event_t event =
                                     AudioSystem::SYNC_EVENT_NONE,
                              audio_session_t triggerSession = AUDIO_SESSION_NONE);
+            // as start() but called with the thread lock held, see PlaybackThread::startTracks()
+            status_t    start_l(bool outputStarted);
     virtual void        stop();
             void        pause();
 
@@ -152,6 +158,15 @@ protected:
 
     ExtendedTimestamp  mSinkTimestamp;
 
+    // Mixer usage accounting, updated by PlaybackThread::updateTrackUsage_l()
+    // and read with the thread lock held.
+    int64_t             mResamplerNs;       // cumulative time in the mixer resampler
+    int64_t             mEffectNs;          // cumulative share of the session effect chain time
+    int64_t             mLastChainNs;       // session effect chain time at last update, or -1
+    nsecs_t             mUnderrunWindowNs;  // start time of the current underrun rate window
+    uint32_t            mUnderrunWindowCount; // underrun count at the start of the window
+    float               mUnderrunsPerSecond; // underrun rate over the last complete window
+
 private:
     // The following fields are only for fast tracks, and should be in a subclass
     int                 mFastIndex; // index within FastMixerState::mFastTracks[];
@@ -177,9 +192,26 @@ private:
 class OutputTrack : public Track {
 public:
 
+    // Reference counted copy of mixed frames.  The output tracks of a DuplicatingThread write
+    // the same frames, so the frames that cannot be written at once are copied once, and
+    // queued by all the output tracks that are full.  Also holds the recent mixes that the
+    // DuplicatingThread writes late to the outputs it delays.
+    class SharedFrames : public LightRefBase<SharedFrames> {
+    public:
+        // copies size bytes of data, or zeroes them if data is NULL
+        SharedFrames(const void *data, size_t size);
+        ~SharedFrames();
+        void       *data() const { return mData; }       // NULL if allocation failed
+        bool        contains(const void *p) const {
+                        return p >= mData && p < (const int8_t *)mData + mSize; }
+    private:
+        void       *mData;
+        const size_t mSize;
+    };
+
     class Buffer : public AudioBufferProvider::Buffer {
     public:
-        void *mBuffer;
+        sp<SharedFrames> mFrames;   // holds the queued frames that raw points into
     };
 
                         OutputTrack(PlaybackThread *thread,
@@ -195,7 +227,16 @@ public:
                                     AudioSystem::SYNC_EVENT_NONE,
                              audio_session_t triggerSession = AUDIO_SESSION_NONE);
     virtual void        stop();
-            bool        write(void* data, uint32_t frames);
+            // If sharedFrames is not NULL, the frames that cannot be written now are queued
+            // by reference to *sharedFrames: either it contains data, or it is created on
+            // first use with a copy of the frames, for the other outputs writing the same data.
+            bool        write(void* data, uint32_t frames,
+                              sp<SharedFrames> *sharedFrames = NULL);
+            // Delay of the frames written by the DuplicatingThread to this output, to align it
+            // with the output of highest latency.
+            void        setLatencyCompensation(uint32_t frames)
+                                { mLatencyCompensationFrames = frames; }
+            uint32_t    latencyCompensation() const { return mLatencyCompensationFrames; }
             bool        bufferQueueEmpty() const { return mBufferQueue.size() == 0; }
             bool        isActive() const { return mActive; }
     const wp<ThreadBase>& thread() const { return mThread; }
@@ -216,6 +257,7 @@ private:
     bool                        mActive;
     DuplicatingThread* const mSourceThread; // for waitTimeMs() in write()
     AudioTrackClientProxy*      mClientProxy;
+    uint32_t                    mLatencyCompensationFrames; // owned by the DuplicatingThread
 };  // end of OutputTrack
 
 // playback track, used by PatchPanel
@@ -89,6 +89,11 @@ private:
 
             // used by the record thread to convert frames to proper destination format
             RecordBufferConverter              *mRecordBufferConverter;
+
+            // if not NULL, the record thread converts frames once for this track and others
+            // with the same format, and the track reads them at mSharedConverterFront
+            SharedRecordConverter              *mSharedConverter;
+            int32_t                             mSharedConverterFront;
             audio_input_flags_t                mFlags;
 };
 
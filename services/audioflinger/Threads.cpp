@@ -22,6 +22,7 @@
 
 #include "Configuration.h"
 #include <math.h>
+#include <algorithm>
 #include <fcntl.h>
 #include <linux/futex.h>
 #include <sys/stat.h>
@@ -116,6 +117,10 @@ static const int8_t kMaxTrackRetriesDirect = 2;
 // don't warn about blocked writes or record buffer overflows more often than this
 static const nsecs_t kWarningThrottleNs = seconds(5);
 
+// PlaybackThread::getParameters() key for the HAL write latency statistics, answered with
+// "count,stalls,p50_us,p99_us,max_us"
+static const char * const kWriteLatencyKey = "af_write_latency";
+
 // RecordThread loop sleep time upon application overrun or audio HAL read error
 static const int kRecordThreadSleepUs = 5000;
 
@@ -143,6 +148,27 @@ static const nsecs_t kOffloadStandbyDelayNs = seconds(1);
 // Direct output thread minimum sleep time in idle or active(underrun) state
 static const nsecs_t kDirectMinSleepTimeUs = 10000;
 
+// Bounds of the adaptive standby delay, see PlaybackThread::adaptiveStandbyDelay_l()
+static const nsecs_t kMinAdaptiveStandbyDelayNs = seconds(1);
+static const nsecs_t kMaxAdaptiveStandbyDelayNs = seconds(10);
+
+// Minimum number of idle periods observed before the standby delay is adapted
+static const size_t kMinIdleHistory = 4;
+
+// Maximum number of effect worker threads per MixerThread, see af.fx.workers
+static const size_t kMaxEffectWorkers = 4;
+
+// Minimum number of session effect chains for the worker pool to be used
+static const size_t kMinParallelEffectChains = 2;
+
+// Number of mix cycles to process session effect chains serially after a parallel batch
+// missed its deadline
+static const uint32_t kParallelEffectBackoffCycles = 100;
+
+// Maximum latency difference between the outputs of a duplicating thread that is compensated
+// by delaying the outputs of lower latency
+static const uint32_t kMaxLatencyCompensationMs = 200;
+
 
 // Whether to use fast mixer
 static const enum {
@@ -173,6 +199,10 @@ static const int kPriorityAudioApp = 2;
 static const int kPriorityFastMixer = 3;
 static const int kPriorityFastCapture = 3;
 
+// If property af.fast_mixer.deadline is true, the fast mixer first asks for a SCHED_DEADLINE
+// reservation of this percentage of its period, and falls back to kPriorityFastMixer.
+static const int kFastMixerDeadlineRuntimePercent = 50;
+
 // IAudioFlinger::createTrack() has an in/out parameter 'pFrameCount' for the total size of the
 // track buffer in shared memory.  Zero on input means to use a default value.  For fast tracks,
 // AudioFlinger derives the default from HAL buffer size and 'fast track multiplier'.
@@ -640,6 +670,7 @@ AudioFlinger::ThreadBase::ThreadBase(const sp<AudioFlinger>& audioFlinger, audio
         mAudioSource(AUDIO_SOURCE_DEFAULT), mId(id),
         // mName will be set by concrete (non-virtual) subclass
         mDeathRecipient(new PMDeathRecipient(this)),
+        mWaitingForWork(false),
         mSystemReady(systemReady),
         mNotifiedBatteryStart(false)
 {
@@ -697,9 +728,15 @@ void AudioFlinger::ThreadBase::exit()
 status_t AudioFlinger::ThreadBase::setParameters(const String8& keyValuePairs)
 {
     ALOGV("ThreadBase::setParameters() %s", keyValuePairs.string());
-    Mutex::Autolock _l(mLock);
-
-    return sendSetParameterConfigEvent_l(keyValuePairs);
+    AudioParameter param(keyValuePairs);
+    int value;
+    if (param.getInt(String8(AUDIO_PARAMETER_MONO_OUTPUT), value) == NO_ERROR) {
+        // master mono is applied synchronously under the thread lock
+        Mutex::Autolock _l(mLock);
+        return sendSetParameterConfigEvent_l(keyValuePairs);
+    }
+    sp<ConfigEvent> configEvent = (ConfigEvent *)new SetParameterConfigEvent(keyValuePairs);
+    return sendConfigEvent(configEvent);
 }
 
 // sendConfigEvent_l() must be called with ThreadBase::mLock held
@@ -713,6 +750,8 @@ status_t AudioFlinger::ThreadBase::sendConfigEvent_l(sp<ConfigEvent>& event)
         mPendingConfigEvents.add(event);
         return status;
     }
+    // keep events from sendConfigEvent() ahead of this one
+    drainConfigEventQueue_l();
     mConfigEvents.add(event);
     ALOGV("sendConfigEvent_l() num events %zu event %d", mConfigEvents.size(), event->mType);
     mWaitWorkCV.signal();
@@ -731,10 +770,68 @@ status_t AudioFlinger::ThreadBase::sendConfigEvent_l(sp<ConfigEvent>& event)
     return status;
 }
 
+// sendConfigEvent() must be called without ThreadBase::mLock held
+status_t AudioFlinger::ThreadBase::sendConfigEvent(sp<ConfigEvent>& event)
+{
+    if (event->mRequiresSystemReady || !mConfigEventQueue.push(event)) {
+        Mutex::Autolock _l(mLock);
+        return sendConfigEvent_l(event);
+    }
+    ALOGV("sendConfigEvent() queued event %d", event->mType);
+    // Pairs with waitWork_l(): the thread sets mWaitingForWork before checking the queue,
+    // and we check mWaitingForWork after publishing the event, so at least one of us
+    // sees the other.  Only an idle or sleeping thread is signaled, so the lock is not
+    // contended by the mixer loop; a running thread drains the queue on its next cycle.
+    if (mWaitingForWork.load()) {
+        Mutex::Autolock _l(mLock);
+        mWaitWorkCV.signal();
+    }
+    status_t status = NO_ERROR;
+    {
+        Mutex::Autolock _l(event->mLock);
+        while (event->mWaitStatus) {
+            if (event->mCond.waitRelative(event->mLock, kConfigEventTimeoutNs) != NO_ERROR) {
+                event->mStatus = TIMED_OUT;
+                event->mWaitStatus = false;
+            }
+        }
+        status = event->mStatus;
+    }
+    return status;
+}
+
+void AudioFlinger::ThreadBase::drainConfigEventQueue_l()
+{
+    sp<ConfigEvent> event;
+    while (mConfigEventQueue.pop(&event)) {
+        mConfigEvents.add(event);
+    }
+}
+
+void AudioFlinger::ThreadBase::waitWork_l()
+{
+    mWaitingForWork.store(true);
+    if (mConfigEventQueue.empty()) {
+        mWaitWorkCV.wait(mLock);
+    }
+    mWaitingForWork.store(false);
+}
+
+status_t AudioFlinger::ThreadBase::waitWorkRelative_l(nsecs_t reltime)
+{
+    status_t status = NO_ERROR;
+    mWaitingForWork.store(true);
+    if (mConfigEventQueue.empty()) {
+        status = mWaitWorkCV.waitRelative(mLock, reltime);
+    }
+    mWaitingForWork.store(false);
+    return status;
+}
+
 void AudioFlinger::ThreadBase::sendIoConfigEvent(audio_io_config_event event, pid_t pid)
 {
-    Mutex::Autolock _l(mLock);
-    sendIoConfigEvent_l(event, pid);
+    sp<ConfigEvent> configEvent = (ConfigEvent *)new IoConfigEvent(event, pid);
+    sendConfigEvent(configEvent);
 }
 
 // sendIoConfigEvent_l() must be called with ThreadBase::mLock held
@@ -746,8 +843,16 @@ void AudioFlinger::ThreadBase::sendIoConfigEvent_l(audio_io_config_event event,
 
 void AudioFlinger::ThreadBase::sendPrioConfigEvent(pid_t pid, pid_t tid, int32_t prio)
 {
-    Mutex::Autolock _l(mLock);
-    sendPrioConfigEvent_l(pid, tid, prio);
+    sp<ConfigEvent> configEvent = (ConfigEvent *)new PrioConfigEvent(pid, tid, prio);
+    sendConfigEvent(configEvent);
+}
+
+void AudioFlinger::ThreadBase::sendDeadlineConfigEvent(pid_t pid, pid_t tid, int32_t prio,
+                                                       nsecs_t runtimeNs, nsecs_t periodNs)
+{
+    sp<ConfigEvent> configEvent =
+            (ConfigEvent *)new PrioConfigEvent(pid, tid, prio, runtimeNs, periodNs);
+    sendConfigEvent(configEvent);
 }
 
 // sendPrioConfigEvent_l() must be called with ThreadBase::mLock held
@@ -780,9 +885,8 @@ status_t AudioFlinger::ThreadBase::sendCreateAudioPatchConfigEvent(
                                                         const struct audio_patch *patch,
                                                         audio_patch_handle_t *handle)
 {
-    Mutex::Autolock _l(mLock);
     sp<ConfigEvent> configEvent = (ConfigEvent *)new CreateAudioPatchConfigEvent(*patch, *handle);
-    status_t status = sendConfigEvent_l(configEvent);
+    status_t status = sendConfigEvent(configEvent);
     if (status == NO_ERROR) {
         CreateAudioPatchConfigEventData *data =
                                         (CreateAudioPatchConfigEventData *)configEvent->mData.get();
@@ -794,9 +898,8 @@ status_t AudioFlinger::ThreadBase::sendCreateAudioPatchConfigEvent(
 status_t AudioFlinger::ThreadBase::sendReleaseAudioPatchConfigEvent(
                                                                 const audio_patch_handle_t handle)
 {
-    Mutex::Autolock _l(mLock);
     sp<ConfigEvent> configEvent = (ConfigEvent *)new ReleaseAudioPatchConfigEvent(handle);
-    return sendConfigEvent_l(configEvent);
+    return sendConfigEvent(configEvent);
 }
 
 
@@ -805,6 +908,7 @@ void AudioFlinger::ThreadBase::processConfigEvents_l()
 {
     bool configChanged = false;
 
+    drainConfigEventQueue_l();
     while (!mConfigEvents.isEmpty()) {
         ALOGV("processConfigEvents_l() remaining events %zu", mConfigEvents.size());
         sp<ConfigEvent> event = mConfigEvents[0];
@@ -812,6 +916,18 @@ void AudioFlinger::ThreadBase::processConfigEvents_l()
         switch (event->mType) {
         case CFG_EVENT_PRIO: {
             PrioConfigEventData *data = (PrioConfigEventData *)event->mData.get();
+            if (data->mRuntimeNs > 0) {
+                // only a thread of this process can be given a deadline reservation
+                ALOG_ASSERT(data->mPid == getpid_cached);
+                int err = requestDeadline(data->mTid, data->mRuntimeNs, data->mPeriodNs,
+                        data->mPeriodNs);
+                if (err == 0) {
+                    break;
+                }
+                ALOGW("Policy SCHED_DEADLINE %lld/%lld ns is unavailable for tid %d; error %d, "
+                      "falling back to SCHED_FIFO", (long long) data->mRuntimeNs,
+                      (long long) data->mPeriodNs, data->mTid, err);
+            }
             // FIXME Need to understand why this has to be done asynchronously
             int err = requestPriority(data->mPid, data->mTid, data->mPrio,
                     true /*asynchronous*/);
@@ -955,6 +1071,8 @@ void AudioFlinger::ThreadBase::dumpBase(int fd, const Vector<String16>& args __u
     } else {
         dprintf(fd, " none\n");
     }
+    dprintf(fd, "  Queued config events: %zu of %zu\n",
+            mConfigEventQueue.size(), mConfigEventQueue.capacity());
     dprintf(fd, "  Output device: %#x (%s)\n", mOutDevice, devicesToString(mOutDevice).string());
     dprintf(fd, "  Input device: %#x (%s)\n", mInDevice, devicesToString(mInDevice).string());
     dprintf(fd, "  Audio source: %d (%s)\n", mAudioSource, sourceToString(mAudioSource));
@@ -1692,6 +1810,10 @@ AudioFlinger::PlaybackThread::PlaybackThread(const sp<AudioFlinger>& audioFlinge
         mEffectBufferSize(0),
         mEffectBufferFormat(AUDIO_FORMAT_INVALID),
         mEffectBufferValid(false),
+        mParallelEffectChains(NULL),
+        mParallelEffectBackoff(0),
+        mParallelEffectCycles(0),
+        mParallelEffectMisses(0),
         mSuspended(0), mBytesWritten(0),
         mFramesWritten(0),
         mSuspendedFrames(0),
@@ -1699,6 +1821,7 @@ AudioFlinger::PlaybackThread::PlaybackThread(const sp<AudioFlinger>& audioFlinge
         // mStreamTypes[] initialized in constructor body
         mOutput(output),
         mLastWriteTime(-1), mNumWrites(0), mNumDelayedWrites(0), mInWrite(false),
+        mReportedWriteStalls(0), mLastWriteStallWarningNs(0),
         mMixerStatus(MIXER_IDLE),
         mMixerStatusIgnoringFastTracks(MIXER_IDLE),
         mStandbyDelayNs(AudioFlinger::mStandbyTimeInNsecs),
@@ -1711,7 +1834,16 @@ AudioFlinger::PlaybackThread::PlaybackThread(const sp<AudioFlinger>& audioFlinge
         mScreenState(AudioFlinger::mScreenState),
         // index 0 is reserved for normal mixer's submix
         mFastTrackAvailMask(((1 << FastMixerState::sMaxFastTracks) - 1) & ~1),
-        mHwSupportsPause(false), mHwPaused(false), mFlushPending(false)
+        mHwSupportsPause(false), mHwPaused(false), mFlushPending(false),
+        mAdaptiveStandby(type == MIXER && property_get_bool("af.standby.adaptive", false)),
+        mConfiguredStandbyDelayNs(AudioFlinger::mStandbyTimeInNsecs),
+        mIdleStartNs(-1),
+        mIdleHistoryCount(0),
+        mIdleHistoryIndex(0),
+        mWarmIdleSupported(false),
+        mWarmIdle(false),
+        mWarmIdleTimeNs(0),
+        mPrewarmPending(false)
 {
     snprintf(mThreadName, kThreadNameLength, "AudioOut_%X", id);
     mNBLogWriter = audioFlinger->newWriter_l(kLogSize, mThreadName);
@@ -1821,10 +1953,66 @@ void AudioFlinger::PlaybackThread::dumpTracks(int fd, const Vector<String16>& ar
             }
         }
     }
+    if (numtracks) {
+        result.append("  Track mixer usage:\n");
+        Track::appendUsageDumpHeader(result);
+        for (size_t i = 0; i < numtracks; ++i) {
+            sp<Track> track = mTracks[i];
+            if (track != 0) {
+                track->dumpUsage(buffer, SIZE);
+                result.append(buffer);
+            }
+        }
+    }
 
     write(fd, result.string(), result.size());
 }
 
+void AudioFlinger::PlaybackThread::updateTrackUsage_l(Track *track, nsecs_t now)
+{
+    static const nsecs_t kUnderrunWindowNs = seconds(1);
+
+    // share the session effect chain time between the active tracks on the session
+    sp<EffectChain> chain = getEffectChain_l(track->sessionId());
+    if (chain != 0) {
+        const int64_t chainNs = chain->processNs();
+        if (track->mLastChainNs >= 0 && chainNs > track->mLastChainNs) {
+            const int32_t activeTracks = chain->activeTrackCnt();
+            track->mEffectNs += (chainNs - track->mLastChainNs) / max(activeTracks, 1);
+        }
+        track->mLastChainNs = chainNs;
+    } else {
+        track->mLastChainNs = -1;
+    }
+
+    const uint32_t underruns = track->mAudioTrackServerProxy->getUnderrunCount();
+    if (track->mUnderrunWindowNs == 0) {
+        track->mUnderrunWindowNs = now;
+        track->mUnderrunWindowCount = underruns;
+    } else if (now - track->mUnderrunWindowNs >= kUnderrunWindowNs) {
+        track->mUnderrunsPerSecond = (float) (underruns - track->mUnderrunWindowCount) *
+                1e9 / (now - track->mUnderrunWindowNs);
+        track->mUnderrunWindowNs = now;
+        track->mUnderrunWindowCount = underruns;
+    }
+}
+
+void AudioFlinger::PlaybackThread::getUidMixerUsage_l(
+        KeyedVector<uid_t, AudioUidMixerUsage>& usages) const
+{
+    for (size_t i = 0; i < mTracks.size(); ++i) {
+        const sp<Track>& track = mTracks[i];
+        const uid_t uid = track->uid();
+        ssize_t index = usages.indexOfKey(uid);
+        if (index < 0) {
+            AudioUidMixerUsage usage = {};
+            usage.mUid = uid;
+            index = usages.add(uid, usage);
+        }
+        track->addUsage(&usages.editValueAt(index));
+    }
+}
+
 void AudioFlinger::PlaybackThread::dumpInternals(int fd, const Vector<String16>& args)
 {
     dprintf(fd, "\nOutput thread %p type %d (%s):\n", this, type(), threadTypeToString(type()));
@@ -1852,7 +2040,26 @@ void AudioFlinger::PlaybackThread::dumpInternals(int fd, const Vector<String16>&
     if (mPipeSink.get() != nullptr) {
         dprintf(fd, "  PipeSink frames written: %lld\n", (long long)mPipeSink->framesWritten());
     }
+    if (mAdaptiveStandby) {
+        dprintf(fd, "  Adaptive standby: delay %lld ms (configured %lld ms), %zu idle periods, "
+                "warm idle %s%s\n",
+                (long long) ns2ms(mStandbyDelayNs), (long long) ns2ms(mConfiguredStandbyDelayNs),
+                mIdleHistoryCount, mWarmIdleSupported ? "supported" : "not supported",
+                mWarmIdle ? ", paused" : "");
+    }
+    if (mEffectWorkers != 0) {
+        dprintf(fd, "  Effect workers: %zu, parallel cycles %u, missed deadlines %u\n",
+                mEffectWorkers->threadCount(), mParallelEffectCycles, mParallelEffectMisses);
+    }
     if (output != nullptr) {
+        AudioStreamOut::WriteStats stats;
+        output->getWriteStats(&stats);
+        dprintf(fd, "  Hal write latency: %u writes, p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+                stats.count, stats.p50Ns * 1e-6, stats.p99Ns * 1e-6, stats.maxNs * 1e-6);
+        if (stats.stalls > 0) {
+            dprintf(fd, "  Hal write stalls: %u, last %.2f ms for %.2f ms of audio\n",
+                    stats.stalls, stats.lastStallNs * 1e-6, stats.lastStallExpectedNs * 1e-6);
+        }
         dprintf(fd, "  Hal stream dump:\n");
         (void)output->stream->common.dump(&output->stream->common, fd);
     }
@@ -2160,8 +2367,49 @@ float AudioFlinger::PlaybackThread::streamVolume(audio_stream_type_t stream) con
     return mStreamTypes[stream].volume;
 }
 
-// addTrack_l() must be called with ThreadBase::mLock held
-status_t AudioFlinger::PlaybackThread::addTrack_l(const sp<Track>& track)
+void AudioFlinger::PlaybackThread::startTracks(const Vector< sp<Track> >& tracks,
+                                               Vector<status_t>& statuses)
+{
+    statuses.clear();
+    statuses.insertAt(NO_ERROR, 0, tracks.size());
+    Vector<bool> outputStarted;
+    outputStarted.insertAt(false, 0, tracks.size());
+    bool lockedStart = false;
+    for (size_t i = 0; i < tracks.size(); i++) {
+        const sp<Track>& track = tracks[i];
+        if (track->isOffloaded()) {
+            // needs the offload checks of Track::start(), and does not share a mix cycle anyway
+            statuses.editItemAt(i) = track->start();
+        } else if (track->isExternalTrack()) {
+            if (AudioSystem::startOutput(mId, track->streamType(), track->sessionId())
+                    == NO_ERROR) {
+                outputStarted.editItemAt(i) = true;
+                lockedStart = true;
+            } else {
+                // rejected by audio policy manager
+                statuses.editItemAt(i) = PERMISSION_DENIED;
+            }
+        } else {
+            lockedStart = true;
+        }
+    }
+    if (!lockedStart) {
+        return;
+    }
+    Mutex::Autolock _l(mLock);
+    for (size_t i = 0; i < tracks.size(); i++) {
+        const sp<Track>& track = tracks[i];
+        if (track->isOffloaded() || statuses[i] != NO_ERROR) {
+            continue;
+        }
+        statuses.editItemAt(i) = track->start_l(outputStarted[i]);
+    }
+}
+
+// addTrack_l() must be called with ThreadBase::mLock held.
+// If outputStarted is true, the caller has already called AudioSystem::startOutput()
+// successfully for this track, and the lock is not released.
+status_t AudioFlinger::PlaybackThread::addTrack_l(const sp<Track>& track, bool outputStarted)
 {
     status_t status = ALREADY_EXISTS;
 
@@ -2169,7 +2417,7 @@ status_t AudioFlinger::PlaybackThread::addTrack_l(const sp<Track>& track)
         // the track is newly added, make sure it fills up all its
         // buffers before playing. This is to ensure the client will
         // effectively get the latency it requested.
-        if (track->isExternalTrack()) {
+        if (track->isExternalTrack() && !outputStarted) {
             TrackBase::track_state state = track->mState;
             mLock.unlock();
             status = AudioSystem::startOutput(mId, track->streamType(),
@@ -2282,12 +2530,62 @@ String8 AudioFlinger::PlaybackThread::getParameters(const String8& keys)
         return String8();
     }
 
-    char *s = mOutput->stream->common.get_parameters(&mOutput->stream->common, keys.string());
-    const String8 out_s8(s);
+    // the write latency statistics are answered here, and the other keys by the HAL
+    AudioParameter param(keys);
+    String8 halKeys(keys);
+    String8 out_s8;
+    String8 value;
+    if (param.get(String8(kWriteLatencyKey), value) == NO_ERROR) {
+        AudioStreamOut::WriteStats stats;
+        mOutput->getWriteStats(&stats);
+        AudioParameter reply;
+        reply.add(String8(kWriteLatencyKey), String8::format("%u,%u,%lld,%lld,%lld",
+                stats.count, stats.stalls, (long long) ns2us(stats.p50Ns),
+                (long long) ns2us(stats.p99Ns), (long long) ns2us(stats.maxNs)));
+        out_s8 = reply.toString();
+        param.remove(String8(kWriteLatencyKey));
+        if (param.size() == 0) {
+            return out_s8;
+        }
+        halKeys = param.toString();
+    }
+
+    char *s = mOutput->stream->common.get_parameters(&mOutput->stream->common,
+            halKeys.string());
+    if (s != NULL && *s != '\0') {
+        if (!out_s8.isEmpty()) {
+            out_s8 += ";";
+        }
+        out_s8 += s;
+    }
     free(s);
     return out_s8;
 }
 
+void AudioFlinger::PlaybackThread::reportWriteStalls_l()
+{
+    if (mOutput == NULL) {
+        return;
+    }
+    const uint32_t stalls = mOutput->writeStallCount();
+    if (stalls == mReportedWriteStalls) {
+        return;
+    }
+    AudioStreamOut::WriteStats stats;
+    mOutput->getWriteStats(&stats);
+    mNBLogWriter->logFormat("HAL write stall %lld us for %lld us of audio, %u stalls",
+            (long long) ns2us(stats.lastStallNs), (long long) ns2us(stats.lastStallExpectedNs),
+            stats.stalls);
+    const nsecs_t now = systemTime();
+    if (now - mLastWriteStallWarningNs >= kWarningThrottleNs) {
+        ALOGW("HAL write stall on thread %p: %lld ms for %lld ms of audio, %u since last warning",
+                this, (long long) ns2ms(stats.lastStallNs),
+                (long long) ns2ms(stats.lastStallExpectedNs), stats.stalls - mReportedWriteStalls);
+        mLastWriteStallWarningNs = now;
+    }
+    mReportedWriteStalls = stats.stalls;
+}
+
 void AudioFlinger::PlaybackThread::ioConfigChanged(audio_io_config_event event, pid_t pid) {
     sp<AudioIoDescriptor> desc = new AudioIoDescriptor();
     ALOGV("PlaybackThread::ioConfigChanged, thread %p, event %d", this, event);
@@ -2437,6 +2735,10 @@ void AudioFlinger::PlaybackThread::readOutputParameters_l()
         LOG_ALWAYS_FATAL("HW_AV_SYNC requested but HAL does not implement pause and resume");
     }
 
+    // pause() is optional for mixer outputs, and may still fail at run time
+    mWarmIdleSupported = mAdaptiveStandby && mOutput->stream->pause != NULL &&
+            mOutput->stream->resume != NULL;
+
     if (mType == DUPLICATING && mMixerBufferEnabled && mEffectBufferEnabled) {
         // For best precision, we use float instead of the associated output
         // device format (typically PCM 16 bit).
@@ -2724,8 +3026,14 @@ ssize_t AudioFlinger::PlaybackThread::threadLoop_write()
                         (pipe->maxFrames() * 7) / 8 : mNormalFrameCount * 2);
             }
         }
+        // without a fast mixer the normal sink is the HAL stream, so time it as a HAL write
+        const nsecs_t startNs = systemTime();
         ssize_t framesWritten = mNormalSink->write((char *)mSinkBuffer + offset, count);
         ATRACE_END();
+        if (mNormalSink == mOutputSink) {
+            mOutput->recordWrite(startNs,
+                    framesWritten > 0 ? framesWritten * mFrameSize : framesWritten);
+        }
         if (framesWritten > 0) {
             bytesWritten = framesWritten * mFrameSize;
         } else {
@@ -2822,6 +3130,80 @@ void AudioFlinger::PlaybackThread::cacheParameters_l()
             mStandbyDelayNs = kDefaultStandbyTimeInNsecs;
         }
     }
+    mConfiguredStandbyDelayNs = mStandbyDelayNs;
+    if (mAdaptiveStandby) {
+        mStandbyDelayNs = adaptiveStandbyDelay_l();
+    }
+}
+
+// updateIdleState_l() must be called with ThreadBase::mLock held
+void AudioFlinger::PlaybackThread::updateIdleState_l()
+{
+    if (!mAdaptiveStandby) {
+        return;
+    }
+    if (mActiveTracks.size() != 0) {
+        if (mIdleStartNs > 0) {
+            mIdleHistoryNs[mIdleHistoryIndex] = systemTime() - mIdleStartNs;
+            mIdleHistoryIndex = (mIdleHistoryIndex + 1) % kIdleHistorySize;
+            if (mIdleHistoryCount < kIdleHistorySize) {
+                mIdleHistoryCount++;
+            }
+            const nsecs_t standbyDelayNs = adaptiveStandbyDelay_l();
+            ALOGV_IF(standbyDelayNs != mStandbyDelayNs, "standby delay %lld ms",
+                    (long long) ns2ms(standbyDelayNs));
+            mStandbyDelayNs = standbyDelayNs;
+        }
+        mIdleStartNs = 0;
+    } else if (mIdleStartNs == 0) {
+        mIdleStartNs = systemTime();
+        // let the last audio play out of the HAL buffers before pausing the stream
+        mWarmIdleTimeNs = mIdleStartNs + milliseconds(2 * latency_l());
+    }
+}
+
+// adaptiveStandbyDelay_l() must be called with ThreadBase::mLock held
+nsecs_t AudioFlinger::PlaybackThread::adaptiveStandbyDelay_l() const
+{
+    if (mIdleHistoryCount < kMinIdleHistory) {
+        return mConfiguredStandbyDelayNs;
+    }
+    nsecs_t idleNs[kIdleHistorySize];
+    memcpy(idleNs, mIdleHistoryNs, mIdleHistoryCount * sizeof(nsecs_t));
+    std::sort(idleNs, idleNs + mIdleHistoryCount);
+    const nsecs_t typicalIdleNs = idleNs[mIdleHistoryCount * 3 / 4];
+
+    nsecs_t standbyDelayNs;
+    if (typicalIdleNs <= kMaxAdaptiveStandbyDelayNs) {
+        // most idle periods are short enough to be bridged, so that the next sound starts
+        // without the HAL wake-up latency
+        standbyDelayNs = typicalIdleNs + typicalIdleNs / 4;
+    } else {
+        // most idle periods would end in standby anyway, so enter it as soon as possible
+        standbyDelayNs = kMinAdaptiveStandbyDelayNs;
+    }
+    if (standbyDelayNs < kMinAdaptiveStandbyDelayNs) {
+        standbyDelayNs = kMinAdaptiveStandbyDelayNs;
+    } else if (standbyDelayNs > kMaxAdaptiveStandbyDelayNs) {
+        standbyDelayNs = kMaxAdaptiveStandbyDelayNs;
+    }
+    // same minimum as the configured delay, to avoid truncating audio on A2DP
+    if ((mOutDevice & AUDIO_DEVICE_OUT_ALL_A2DP) != 0 &&
+            standbyDelayNs < kDefaultStandbyTimeInNsecs) {
+        standbyDelayNs = kDefaultStandbyTimeInNsecs;
+    }
+    return standbyDelayNs;
+}
+
+void AudioFlinger::PlaybackThread::prewarm()
+{
+    if (mType != MIXER) {
+        return;
+    }
+    Mutex::Autolock _l(mLock);
+    mPrewarmPending = true;
+    mStandbyTimeNs = systemTime() + mStandbyDelayNs;
+    broadcast_l();
 }
 
 bool AudioFlinger::PlaybackThread::invalidateTracks_l(audio_stream_type_t streamType)
@@ -2890,8 +3272,15 @@ status_t AudioFlinger::PlaybackThread::addEffectChain_l(const sp<EffectChain>& c
     }
     chain->setThread(this);
     chain->setInBuffer(buffer, ownsBuffer);
-    chain->setOutBuffer(reinterpret_cast<int16_t*>(mEffectBufferEnabled
-            ? mEffectBuffer : mSinkBuffer));
+    if (ownsBuffer && mEffectWorkers != 0) {
+        // the chain may be processed in parallel with other sessions, so it cannot
+        // accumulate directly into the shared buffer, see processEffectChains()
+        size_t numSamples = mNormalFrameCount * mChannelCount;
+        chain->setOutBuffer(new int16_t[numSamples], true /*ownsBuffer*/);
+    } else {
+        chain->setOutBuffer(reinterpret_cast<int16_t*>(mEffectBufferEnabled
+                ? mEffectBuffer : mSinkBuffer));
+    }
     // Effect chain for session AUDIO_SESSION_OUTPUT_STAGE is inserted at end of effect
     // chains list in order to be processed last as it contains output stage effects.
     // Effect chain for session AUDIO_SESSION_OUTPUT_MIX is inserted before
@@ -3047,6 +3436,7 @@ bool AudioFlinger::PlaybackThread::threadLoop()
                 mNBLogWriter->log(logString);
                 logString = NULL;
             }
+            reportWriteStalls_l();
 
             // Gather the framesReleased counters for all active tracks,
             // and associate with the sink frames written out.  We need
@@ -3136,7 +3526,7 @@ bool AudioFlinger::PlaybackThread::threadLoop()
                     mActiveTracksGeneration++;
                 }
                 ALOGV("wait async completion");
-                mWaitWorkCV.wait(mLock);
+                waitWork_l();
                 ALOGV("async completion/wake");
                 if (released) {
                     acquireWakeLock_l();
@@ -3146,6 +3536,8 @@ bool AudioFlinger::PlaybackThread::threadLoop()
 
                 continue;
             }
+            updateIdleState_l();
+
             if ((!mActiveTracks.size() && systemTime() > mStandbyTimeNs) ||
                                    isSuspended()) {
                 // put audio hardware into standby after short delay
@@ -3156,7 +3548,7 @@ bool AudioFlinger::PlaybackThread::threadLoop()
                     mStandby = true;
                 }
 
-                if (!mActiveTracks.size() && mConfigEvents.isEmpty()) {
+                if (!mActiveTracks.size() && !configEventsPending_l()) {
                     // we're about to wait, flush the binder command buffer
                     IPCThreadState::self()->flushCommands();
 
@@ -3171,7 +3563,7 @@ bool AudioFlinger::PlaybackThread::threadLoop()
                     mActiveTracksGeneration++;
                     // wait until we have something to do...
                     ALOGV("%s going to sleep", myName.string());
-                    mWaitWorkCV.wait(mLock);
+                    waitWork_l();
                     ALOGV("%s waking up", myName.string());
                     acquireWakeLock_l();
 
@@ -3258,9 +3650,7 @@ bool AudioFlinger::PlaybackThread::threadLoop()
 
             // only process effects if we're going to write
             if (mSleepTimeUs == 0 && mType != OFFLOAD) {
-                for (size_t i = 0; i < effectChains.size(); i ++) {
-                    effectChains[i]->process_l();
-                }
+                processEffectChains(effectChains);
             }
         }
         // Process effect chains for offloaded thread even if no audio
@@ -3382,8 +3772,8 @@ bool AudioFlinger::PlaybackThread::threadLoop()
             } else {
                 ATRACE_BEGIN("sleep");
                 Mutex::Autolock _l(mLock);
-                if (!mSignalPending && mConfigEvents.isEmpty() && !exitPending()) {
-                    mWaitWorkCV.waitRelative(mLock, microseconds((nsecs_t)mSleepTimeUs));
+                if (!mSignalPending && !configEventsPending_l() && !exitPending()) {
+                    waitWorkRelative_l(microseconds((nsecs_t)mSleepTimeUs));
                 }
                 ATRACE_END();
             }
@@ -3423,6 +3813,64 @@ bool AudioFlinger::PlaybackThread::threadLoop()
     return false;
 }
 
+// static
+void AudioFlinger::PlaybackThread::processEffectChainJob(void *cookie, size_t index)
+{
+    PlaybackThread *thread = (PlaybackThread *) cookie;
+    (*thread->mParallelEffectChains)[index]->process_l();
+}
+
+void AudioFlinger::PlaybackThread::processEffectChains(
+        const Vector< sp<EffectChain> >& effectChains)
+{
+    // session chains are first in the list, see addEffectChain_l()
+    size_t sessionChains = 0;
+    while (sessionChains < effectChains.size() &&
+            effectChains[sessionChains]->ownsOutBuffer()) {
+        sessionChains++;
+    }
+
+    if (sessionChains > 0) {
+        const size_t numSamples = mNormalFrameCount * mChannelCount;
+        for (size_t i = 0; i < sessionChains; i++) {
+            memset(effectChains[i]->outBuffer(), 0, numSamples * sizeof(int16_t));
+        }
+        if (sessionChains >= kMinParallelEffectChains && mParallelEffectBackoff == 0) {
+            // leave at least half of the period to the global chains, mixing and the write
+            const nsecs_t deadlineNs = (nsecs_t) mNormalFrameCount * 1000000000LL
+                    / mSampleRate / 2;
+            mParallelEffectChains = &effectChains;
+            if (!mEffectWorkers->run(processEffectChainJob, this, sessionChains, deadlineNs)) {
+                // cores are likely busy elsewhere, do not compete with ourselves for a while
+                mParallelEffectMisses++;
+                mParallelEffectBackoff = kParallelEffectBackoffCycles;
+            }
+            mParallelEffectChains = NULL;
+            mParallelEffectCycles++;
+        } else {
+            if (mParallelEffectBackoff > 0) {
+                mParallelEffectBackoff--;
+            }
+            for (size_t i = 0; i < sessionChains; i++) {
+                effectChains[i]->process_l();
+            }
+        }
+        // accumulate in chain order, so that the result does not depend on scheduling
+        int16_t *mixBuffer = reinterpret_cast<int16_t*>(mEffectBufferEnabled
+                ? mEffectBuffer : mSinkBuffer);
+        for (size_t i = 0; i < sessionChains; i++) {
+            const int16_t *chainBuffer = effectChains[i]->outBuffer();
+            for (size_t j = 0; j < numSamples; j++) {
+                mixBuffer[j] = clamp16((int32_t) mixBuffer[j] + (int32_t) chainBuffer[j]);
+            }
+        }
+    }
+
+    for (size_t i = sessionChains; i < effectChains.size(); i++) {
+        effectChains[i]->process_l();
+    }
+}
+
 // removeTracks_l() must be called with ThreadBase::mLock held
 void AudioFlinger::PlaybackThread::removeTracks_l(const Vector< sp<Track> >& tracksToRemove)
 {
@@ -3633,6 +4081,15 @@ AudioFlinger::MixerThread::MixerThread(const sp<AudioFlinger>& audioFlinger, Aud
             mNormalFrameCount);
     mAudioMixer = new AudioMixer(mNormalFrameCount, mSampleRate);
 
+    // the calling thread takes part in each batch, so N workers give N + 1 way parallelism
+    const int32_t effectWorkers = property_get_int32("af.fx.workers", 0);
+    if (effectWorkers > 0) {
+        char name[16];
+        snprintf(name, sizeof(name), "AudioFx%d_", id);
+        mEffectWorkers = new WorkerPool(min((size_t) effectWorkers, kMaxEffectWorkers), name,
+                ANDROID_PRIORITY_URGENT_AUDIO);
+    }
+
     if (type == DUPLICATING) {
         // The Duplicating thread uses the AudioMixer and delivers data to OutputTracks
         // (downstream MixerThreads) in DuplicatingThread::threadLoop_write().
@@ -3763,7 +4220,13 @@ AudioFlinger::MixerThread::MixerThread(const sp<AudioFlinger>& audioFlinger, Aud
         // start the fast mixer
         mFastMixer->run("FastMixer", PRIORITY_URGENT_AUDIO);
         pid_t tid = mFastMixer->getTid();
-        sendPrioConfigEvent(getpid_cached, tid, kPriorityFastMixer);
+        if (property_get_bool("af.fast_mixer.deadline", false /* default_value */)) {
+            const nsecs_t periodNs = (nsecs_t) mFrameCount * 1000000000LL / mSampleRate;
+            sendDeadlineConfigEvent(getpid_cached, tid, kPriorityFastMixer,
+                    periodNs * kFastMixerDeadlineRuntimePercent / 100, periodNs);
+        } else {
+            sendPrioConfigEvent(getpid_cached, tid, kPriorityFastMixer);
+        }
 
 #ifdef AUDIO_WATCHDOG
         // create and start the watchdog
@@ -3845,6 +4308,7 @@ void AudioFlinger::MixerThread::threadLoop_removeTracks(const Vector< sp<Track>
 
 ssize_t AudioFlinger::MixerThread::threadLoop_write()
 {
+    exitWarmIdle();
     // FIXME we should only do one push per cycle; confirm this is true
     // Start the fast mixer if it's not already running
     if (mFastMixer != 0) {
@@ -3888,11 +4352,14 @@ ssize_t AudioFlinger::MixerThread::threadLoop_write()
 
 void AudioFlinger::MixerThread::threadLoop_standby()
 {
-    // Idle the fast mixer if it's currently running
+    // the HAL stream leaves pause when entering standby
+    mWarmIdle = false;
+    // Idle the fast mixer if it's currently running, or hot idle for warm idle
     if (mFastMixer != 0) {
         FastMixerStateQueue *sq = mFastMixer->sq();
         FastMixerState *state = sq->begin();
-        if (!(state->mCommand & FastMixerState::IDLE)) {
+        if (!(state->mCommand & FastMixerState::IDLE) ||
+                state->mCommand == FastMixerState::HOT_IDLE) {
             state->mCommand = FastMixerState::COLD_IDLE;
             state->mColdFutexAddr = &mFastMixerFutex;
             state->mColdGen++;
@@ -3978,8 +4445,65 @@ void AudioFlinger::MixerThread::threadLoop_mix()
 
 }
 
+bool AudioFlinger::MixerThread::enterWarmIdle()
+{
+    if (mFastMixer != 0) {
+        FastMixerStateQueue *sq = mFastMixer->sq();
+        FastMixerState *state = sq->begin();
+        if (state->mCommand == FastMixerState::MIX_WRITE) {
+            if (kUseFastMixer == FastMixer_Dynamic) {
+                // the fast mixer could be switched off while hot idle, with mNormalSink
+                // still set to mPipeSink
+                sq->end(false /*didModify*/);
+                return false;
+            }
+            // stop fast mixer I/O, but without the cold start on the next write
+            state->mCommand = FastMixerState::HOT_IDLE;
+            sq->end();
+            sq->push(FastMixerStateQueue::BLOCK_UNTIL_ACKED);
+        } else {
+            sq->end(false /*didModify*/);
+        }
+    }
+    int ret = mOutput->stream->pause(mOutput->stream);
+    if (ret != 0) {
+        // the next write restarts the fast mixer if needed
+        ALOGW("pause() returned %d, writing silence while idle", ret);
+        mWarmIdleSupported = false;
+        return false;
+    }
+    ALOGV("entering warm idle, thread %p", this);
+    mWarmIdle = true;
+    return true;
+}
+
+void AudioFlinger::MixerThread::exitWarmIdle()
+{
+    if (mWarmIdle) {
+        ALOGV("leaving warm idle, thread %p", this);
+        mOutput->stream->resume(mOutput->stream);
+        mWarmIdle = false;
+    }
+}
+
 void AudioFlinger::MixerThread::threadLoop_sleepTime()
 {
+    if (mPrewarmPending.exchange(false) && (mStandby || mWarmIdle)) {
+        // write silence to get the HAL ready ahead of the first track, see prewarm()
+        if (mMixerBufferValid) {
+            memset(mMixerBuffer, 0, mMixerBufferSize);
+        } else {
+            memset(mSinkBuffer, 0, mSinkBufferSize);
+        }
+        mSleepTimeUs = 0;
+        return;
+    }
+    // while idle, pause the HAL stream rather than writing silence until standby
+    if (mIdleStartNs > 0 && (mWarmIdle || (mWarmIdleSupported && mBytesWritten != 0 &&
+            systemTime() > mWarmIdleTimeNs && enterWarmIdle()))) {
+        mSleepTimeUs = mIdleSleepTimeUs;
+        return;
+    }
     // If no tracks are ready, sleep once for the duration of an output
     // buffer size, then write 0s to the output
     if (mSleepTimeUs == 0) {
@@ -4055,6 +4579,9 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
     mMixerBufferValid = false;  // mMixerBuffer has no valid data until appropriate tracks found.
     mEffectBufferValid = false; // mEffectBuffer has no valid data until tracks found.
 
+    // the mixer revalidates its process hook once for all the track changes below
+    mAudioMixer->beginUpdate();
+    const nsecs_t now = systemTime();
     for (size_t i=0 ; i<count ; i++) {
         const sp<Track> t = mActiveTracks[i].promote();
         if (t == 0) {
@@ -4064,6 +4591,11 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
         // this const just means the local variable doesn't change
         Track* const track = t.get();
 
+        if (!track->isFastTrack()) {
+            track->mResamplerNs = mAudioMixer->getResampleNs(track->name());
+        }
+        updateTrackUsage_l(track, now);
+
         // process fast tracks
         if (track->isFastTrack()) {
 
@@ -4376,9 +4908,7 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
             mAudioMixer->setBufferProvider(name, track);
             mAudioMixer->enable(name);
 
-            mAudioMixer->setParameter(name, param, AudioMixer::VOLUME0, &vlf);
-            mAudioMixer->setParameter(name, param, AudioMixer::VOLUME1, &vrf);
-            mAudioMixer->setParameter(name, param, AudioMixer::AUXLEVEL, &vaf);
+            mAudioMixer->setVolumes(name, param, vlf, vrf, vaf);
             mAudioMixer->setParameter(
                 name,
                 AudioMixer::TRACK,
@@ -4516,6 +5046,7 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
         }   // local variable scope to avoid goto warning
 
     }
+    mAudioMixer->commitUpdate();
 
     // Push the new FastMixer state if necessary
     bool pauseAudioWatchdog = false;
@@ -4895,6 +5426,7 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::DirectOutputThread::prep
     bool doHwResume = false;
 
     // find out which tracks need to be processed
+    const nsecs_t now = systemTime();
     for (size_t i = 0; i < count; i++) {
         sp<Track> t = mActiveTracks[i].promote();
         // The track died recently
@@ -4909,6 +5441,7 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::DirectOutputThread::prep
         }
 
         Track* const track = t.get();
+        updateTrackUsage_l(track, now);
 #ifdef VERY_VERY_VERBOSE_LOGGING
         audio_track_cblk_t* cblk = track->cblk();
 #endif
@@ -5730,7 +6263,9 @@ AudioFlinger::DuplicatingThread::DuplicatingThread(const sp<AudioFlinger>& audio
         AudioFlinger::MixerThread* mainThread, audio_io_handle_t id, bool systemReady)
     :   MixerThread(audioFlinger, mainThread->getOutput(), id, mainThread->outDevice(),
                     systemReady, DUPLICATING),
-        mWaitTimeMs(UINT_MAX)
+        mWaitTimeMs(UINT_MAX),
+        mLatencyCompensation(property_get_bool("af.duplicating.latency_compensation", true)),
+        mMaxCompensationFrames(0)
 {
     addOutputTrack(mainThread);
 }
@@ -5782,19 +6317,116 @@ void AudioFlinger::DuplicatingThread::threadLoop_sleepTime()
 
 ssize_t AudioFlinger::DuplicatingThread::threadLoop_write()
 {
+    if (mLatencyCompensation && writeFrames != 0) {
+        updateLatencyCompensation();
+    }
+    // One copy of the frames that any of the outputs cannot take now, or of every mix
+    // if some outputs are delayed, as they are then written again in later cycles.
+    sp<OutputTrack::SharedFrames> sharedFrames;
+    const bool delayed = mMaxCompensationFrames != 0 && writeFrames == mNormalFrameCount;
+    if (delayed) {
+        sharedFrames = new OutputTrack::SharedFrames(mSinkBuffer, writeFrames * mFrameSize);
+        mMixHistory.insertAt(sharedFrames, 0);
+        const size_t historySize = mMaxCompensationFrames / mNormalFrameCount + 2;
+        if (mMixHistory.size() > historySize) {
+            mMixHistory.removeItemsAt(historySize, mMixHistory.size() - historySize);
+        }
+    } else {
+        mMixHistory.clear();
+    }
     for (size_t i = 0; i < outputTracks.size(); i++) {
-        outputTracks[i]->write(mSinkBuffer, writeFrames);
+        const uint32_t delayFrames = outputTracks[i]->latencyCompensation();
+        if (delayed && delayFrames != 0) {
+            writeDelayed(outputTracks[i], delayFrames);
+        } else {
+            outputTracks[i]->write(mSinkBuffer, writeFrames, &sharedFrames);
+        }
     }
     mStandby = false;
     return (ssize_t)mSinkBufferSize;
 }
 
+// Returns the mix of index cycles ago, or silence if it is not available.
+sp<AudioFlinger::PlaybackThread::OutputTrack::SharedFrames>
+        AudioFlinger::DuplicatingThread::mixHistory(size_t index)
+{
+    if (index < mMixHistory.size() && mMixHistory[index]->data() != NULL) {
+        return mMixHistory[index];
+    }
+    if (mSilence == 0) {
+        mSilence = new OutputTrack::SharedFrames(NULL, mNormalFrameCount * mFrameSize);
+    }
+    return mSilence;
+}
+
+// Writes the mNormalFrameCount frames of the mix delayFrames ago:
+// the end of one mix history entry followed by the start of the next one.
+void AudioFlinger::DuplicatingThread::writeDelayed(const sp<OutputTrack>& track,
+        uint32_t delayFrames)
+{
+    const size_t cycles = delayFrames / mNormalFrameCount;
+    const size_t frames = delayFrames % mNormalFrameCount;
+    if (frames != 0) {
+        sp<OutputTrack::SharedFrames> older = mixHistory(cycles + 1);
+        track->write((int8_t *)older->data() + (mNormalFrameCount - frames) * mFrameSize,
+                frames, &older);
+    }
+    sp<OutputTrack::SharedFrames> newer = mixHistory(cycles);
+    track->write(newer->data(), mNormalFrameCount - frames, &newer);
+}
+
+// Called without mLock before the output tracks are written.  The latencies are only queried
+// when an output track is about to start, and only the delay of the starting tracks changes,
+// so that the tracks already playing do not skip or repeat frames.
+void AudioFlinger::DuplicatingThread::updateLatencyCompensation()
+{
+    bool starting = false;
+    for (size_t i = 0; i < outputTracks.size(); i++) {
+        if (!outputTracks[i]->isActive()) {
+            starting = true;
+            break;
+        }
+    }
+    if (!starting) {
+        return;
+    }
+    Vector<uint32_t> latenciesMs;
+    uint32_t maxLatencyMs = 0;
+    for (size_t i = 0; i < outputTracks.size(); i++) {
+        sp<ThreadBase> thread = outputTracks[i]->thread().promote();
+        const uint32_t latencyMs = thread != 0 ?
+                ((PlaybackThread *)thread.get())->latency() : 0;
+        latenciesMs.add(latencyMs);
+        if (latencyMs > maxLatencyMs) {
+            maxLatencyMs = latencyMs;
+        }
+    }
+    for (size_t i = 0; i < outputTracks.size(); i++) {
+        if (outputTracks[i]->isActive()) {
+            continue;
+        }
+        const uint32_t compensationMs = min(maxLatencyMs - latenciesMs[i],
+                kMaxLatencyCompensationMs);
+        ALOGV("output track %p latency %u ms, compensation %u ms", outputTracks[i].get(),
+                latenciesMs[i], compensationMs);
+        outputTracks[i]->setLatencyCompensation(
+                (uint32_t)((uint64_t)compensationMs * mSampleRate / 1000));
+    }
+    mMaxCompensationFrames = 0;
+    for (size_t i = 0; i < outputTracks.size(); i++) {
+        mMaxCompensationFrames = max(mMaxCompensationFrames,
+                outputTracks[i]->latencyCompensation());
+    }
+}
+
 void AudioFlinger::DuplicatingThread::threadLoop_standby()
 {
     // DuplicatingThread implements standby by stopping all tracks
     for (size_t i = 0; i < outputTracks.size(); i++) {
         outputTracks[i]->stop();
     }
+    mMixHistory.clear();
+    mSilence.clear();
 }
 
 void AudioFlinger::DuplicatingThread::saveOutputTracks()
@@ -5921,7 +6553,8 @@ AudioFlinger::RecordThread::RecordThread(const sp<AudioFlinger>& audioFlinger,
     ThreadBase(audioFlinger, id, outDevice, inDevice, RECORD, systemReady),
     mInput(input), mActiveTracksGen(0), mRsmpInBuffer(NULL),
     // mRsmpInFrames and mRsmpInFramesP2 are set by readInputParameters_l()
-    mRsmpInRear(0)
+    mRsmpInRear(0),
+    mShareConversions(property_get_bool("af.record.shared_conversion", true))
 #ifdef TEE_SINK
     , mTeeSink(teeSink)
 #endif
@@ -6060,6 +6693,9 @@ AudioFlinger::RecordThread::~RecordThread()
     }
     mAudioFlinger->unregisterWriter(mFastCaptureNBLogWriter);
     mAudioFlinger->unregisterWriter(mNBLogWriter);
+    for (size_t i = 0; i < mSharedConverters.size(); i++) {
+        delete mSharedConverters[i];
+    }
     free(mRsmpInBuffer);
 }
 
@@ -6127,7 +6763,7 @@ reacquire_wakelock:
             // sleep with mutex unlocked
             if (sleepUs > 0) {
                 ATRACE_BEGIN("sleepC");
-                mWaitWorkCV.waitRelative(mLock, microseconds((nsecs_t)sleepUs));
+                waitWorkRelative_l(microseconds((nsecs_t)sleepUs));
                 ATRACE_END();
                 sleepUs = 0;
                 continue;
@@ -6141,7 +6777,7 @@ reacquire_wakelock:
                 releaseWakeLock_l();
                 ALOGV("RecordThread: loop stopping");
                 // go to sleep
-                mWaitWorkCV.wait(mLock);
+                waitWork_l();
                 ALOGV("RecordThread: loop starting");
                 goto reacquire_wakelock;
             }
@@ -6192,6 +6828,8 @@ reacquire_wakelock:
                     doBroadcast = true;
                     mStandby = false;
                     activeTrack->mState = TrackBase::ACTIVE;
+                    // data is discontinuous, so join a shared conversion at its current position
+                    activeTrack->mSharedConverter = NULL;
                     allStopped = false;
                     break;
 
@@ -6233,6 +6871,8 @@ reacquire_wakelock:
             }
             sleepUs = 0;
 
+            updateSharedConverters_l(activeTracks);
+
             lockEffectChains_l(effectChains);
         }
 
@@ -6305,8 +6945,12 @@ reacquire_wakelock:
             framesRead = mPipeSource->read((uint8_t*)mRsmpInBuffer + rear * mFrameSize,
                     framesToRead);
             if (framesRead == 0) {
-                // since pipe is non-blocking, simulate blocking input
-                sleepUs = (framesToRead * 1000000LL) / mSampleRate;
+                // wait for FastCapture to write, for at most the time to capture framesToRead
+                PipeReader *pipeReader = static_cast<PipeReader *>(mPipeSource.get());
+                if (pipeReader->waitAvailable((framesToRead * 1000000000LL) / mSampleRate) > 0) {
+                    framesRead = mPipeSource->read(
+                            (uint8_t*)mRsmpInBuffer + rear * mFrameSize, framesToRead);
+                }
             }
         // otherwise use the HAL / AudioStreamIn directly
         } else {
@@ -6327,8 +6971,17 @@ reacquire_wakelock:
         mTimestamp.mTimeNs[ExtendedTimestamp::LOCATION_SERVER] = systemTime();
 
         // Update server timestamp with kernel stats
-        if (mInput->stream->get_capture_position != nullptr
-                && mPipeSource.get() == nullptr /* don't obtain for FastCapture, could block */) {
+        if (mFastCapture != 0) {
+            // don't obtain for FastCapture, could block; use the latest one FastCapture took
+            // right after its HAL read, as published to the readers of its pipe
+            ExtendedTimestamp timestamp;
+            if (mPipeSource->getTimestamp(timestamp) == NO_ERROR) {
+                mTimestamp.mPosition[ExtendedTimestamp::LOCATION_KERNEL] =
+                        timestamp.mPosition[ExtendedTimestamp::LOCATION_KERNEL];
+                mTimestamp.mTimeNs[ExtendedTimestamp::LOCATION_KERNEL] =
+                        timestamp.mTimeNs[ExtendedTimestamp::LOCATION_KERNEL];
+            }
+        } else if (mInput->stream->get_capture_position != nullptr) {
             int64_t position, time;
             int ret = mInput->stream->get_capture_position(mInput->stream, &position, &time);
             if (ret == NO_ERROR) {
@@ -6368,6 +7021,11 @@ reacquire_wakelock:
         }
         rear = mRsmpInRear += framesRead;
 
+        // convert once for all the tracks sharing a conversion
+        for (size_t i = 0; i < mSharedConverters.size(); i++) {
+            mSharedConverters[i]->convert();
+        }
+
         size = activeTracks.size();
         // loop over each active track
         for (size_t i = 0; i < size; i++) {
@@ -6398,25 +7056,39 @@ reacquire_wakelock:
                 // check available frames and handle overrun conditions
                 // if the record track isn't draining fast enough.
                 bool hasOverrun;
-                size_t framesIn;
-                activeTrack->mResamplerBufferProvider->sync(&framesIn, &hasOverrun);
-                if (hasOverrun) {
-                    overrun = OVERRUN_TRUE;
-                }
-                if (framesOut == 0 || framesIn == 0) {
-                    break;
-                }
+                if (activeTrack->mSharedConverter != NULL) {
+                    // copy frames already converted for all tracks sharing the conversion
+                    framesOut = activeTrack->mSharedConverter->read(activeTrack->mSink.raw,
+                            framesOut, &activeTrack->mSharedConverterFront, &hasOverrun);
+                    if (hasOverrun) {
+                        overrun = OVERRUN_TRUE;
+                    }
+                    if (framesOut == 0) {
+                        break;
+                    }
+                } else {
+                    size_t framesIn;
+                    activeTrack->mResamplerBufferProvider->sync(&framesIn, &hasOverrun);
+                    if (hasOverrun) {
+                        overrun = OVERRUN_TRUE;
+                    }
+                    if (framesOut == 0 || framesIn == 0) {
+                        break;
+                    }
 
-                // Don't allow framesOut to be larger than what is possible with resampling
-                // from framesIn.
-                // This isn't strictly necessary but helps limit buffer resizing in
-                // RecordBufferConverter.  TODO: remove when no longer needed.
-                framesOut = min(framesOut,
-                        destinationFramesPossible(
-                                framesIn, mSampleRate, activeTrack->mSampleRate));
-                // process frames from the RecordThread buffer provider to the RecordTrack buffer
-                framesOut = activeTrack->mRecordBufferConverter->convert(
-                        activeTrack->mSink.raw, activeTrack->mResamplerBufferProvider, framesOut);
+                    // Don't allow framesOut to be larger than what is possible with resampling
+                    // from framesIn.
+                    // This isn't strictly necessary but helps limit buffer resizing in
+                    // RecordBufferConverter.  TODO: remove when no longer needed.
+                    framesOut = min(framesOut,
+                            destinationFramesPossible(
+                                    framesIn, mSampleRate, activeTrack->mSampleRate));
+                    // process frames from the RecordThread buffer provider to the RecordTrack
+                    // buffer
+                    framesOut = activeTrack->mRecordBufferConverter->convert(
+                            activeTrack->mSink.raw, activeTrack->mResamplerBufferProvider,
+                            framesOut);
+                }
 
                 if (framesOut > 0 && (overrun == OVERRUN_UNKNOWN)) {
                     overrun = OVERRUN_FALSE;
@@ -6943,9 +7615,17 @@ void AudioFlinger::RecordThread::dumpTracks(int fd, const Vector<String16>& args
 }
 
 
+sp<AudioFlinger::ThreadBase> AudioFlinger::RecordThread::ResamplerBufferProvider::thread() const
+{
+    if (mRecordTrack == NULL) {
+        return mRecordThread;
+    }
+    return mRecordTrack->mThread.promote();
+}
+
 void AudioFlinger::RecordThread::ResamplerBufferProvider::reset()
 {
-    sp<ThreadBase> threadBase = mRecordTrack->mThread.promote();
+    sp<ThreadBase> threadBase = thread();
     RecordThread *recordThread = (RecordThread *) threadBase.get();
     mRsmpInFront = recordThread->mRsmpInRear;
     mRsmpInUnrel = 0;
@@ -6954,7 +7634,7 @@ void AudioFlinger::RecordThread::ResamplerBufferProvider::reset()
 void AudioFlinger::RecordThread::ResamplerBufferProvider::sync(
         size_t *framesAvailable, bool *hasOverrun)
 {
-    sp<ThreadBase> threadBase = mRecordTrack->mThread.promote();
+    sp<ThreadBase> threadBase = thread();
     RecordThread *recordThread = (RecordThread *) threadBase.get();
     const int32_t rear = recordThread->mRsmpInRear;
     const int32_t front = mRsmpInFront;
@@ -6987,7 +7667,7 @@ void AudioFlinger::RecordThread::ResamplerBufferProvider::sync(
 status_t AudioFlinger::RecordThread::ResamplerBufferProvider::getNextBuffer(
         AudioBufferProvider::Buffer* buffer)
 {
-    sp<ThreadBase> threadBase = mRecordTrack->mThread.promote();
+    sp<ThreadBase> threadBase = thread();
     if (threadBase == 0) {
         buffer->frameCount = 0;
         buffer->raw = NULL;
@@ -7287,6 +7967,159 @@ void AudioFlinger::RecordThread::RecordBufferConverter::convertResampler(
             frames * mDstChannelCount);
 }
 
+AudioFlinger::RecordThread::SharedRecordConverter::SharedRecordConverter(
+        RecordThread *recordThread,
+        audio_channel_mask_t dstChannelMask, audio_format_t dstFormat, uint32_t dstSampleRate)
+    : mUsers(0),
+      mRecordThread(recordThread),
+      mSrcChannelMask(recordThread->mChannelMask),
+      mSrcFormat(recordThread->mFormat),
+      mSrcSampleRate(recordThread->mSampleRate),
+      mDstChannelMask(dstChannelMask),
+      mDstFormat(dstFormat),
+      mDstSampleRate(dstSampleRate),
+      mProvider(recordThread),
+      mConverter(mSrcChannelMask, mSrcFormat, mSrcSampleRate,
+              dstChannelMask, dstFormat, dstSampleRate),
+      mFrameSize(audio_channel_count_from_in_mask(dstChannelMask)
+              * audio_bytes_per_sample(dstFormat)),
+      mFramesP2(0),
+      mBuffer(NULL),
+      mRear(0)
+{
+    // hold as much converted data as the RecordThread holds input data
+    mFramesP2 = roundup(destinationFramesPossible(recordThread->mRsmpInFrames,
+            mSrcSampleRate, mDstSampleRate) + 1);
+    mBuffer = calloc(mFramesP2, mFrameSize);
+    mProvider.reset();
+}
+
+AudioFlinger::RecordThread::SharedRecordConverter::~SharedRecordConverter()
+{
+    free(mBuffer);
+}
+
+bool AudioFlinger::RecordThread::SharedRecordConverter::matches(const RecordTrack *track) const
+{
+    return track->channelMask() == mDstChannelMask && track->format() == mDstFormat &&
+            track->sampleRate() == mDstSampleRate &&
+            mRecordThread->mChannelMask == mSrcChannelMask &&
+            mRecordThread->mFormat == mSrcFormat &&
+            mRecordThread->mSampleRate == mSrcSampleRate;
+}
+
+void AudioFlinger::RecordThread::SharedRecordConverter::convert()
+{
+    for (;;) {
+        size_t framesIn;
+        mProvider.sync(&framesIn);
+        if (framesIn == 0) {
+            break;
+        }
+        const size_t index = mRear & (mFramesP2 - 1);
+        size_t frames = min(mFramesP2 - index,
+                destinationFramesPossible(framesIn, mSrcSampleRate, mDstSampleRate));
+        if (frames == 0) {
+            break;
+        }
+        frames = mConverter.convert((uint8_t *) mBuffer + index * mFrameSize, &mProvider, frames);
+        if (frames == 0) {
+            break;
+        }
+        mRear += frames;
+    }
+}
+
+size_t AudioFlinger::RecordThread::SharedRecordConverter::read(
+        void *dst, size_t frames, int32_t *front, bool *hasOverrun) const
+{
+    const ssize_t filled = mRear - *front;
+    size_t available;
+    *hasOverrun = false;
+    if (filled < 0) {
+        // should not happen, but treat like a massive overrun and re-sync
+        *front = mRear;
+        available = 0;
+        *hasOverrun = true;
+    } else if ((size_t) filled <= mFramesP2) {
+        available = (size_t) filled;
+    } else {
+        // the track is not keeping up, but give it the latest data
+        available = mFramesP2;
+        *front = mRear - available;
+        *hasOverrun = true;
+    }
+    if (frames > available) {
+        frames = available;
+    }
+    if (frames == 0) {
+        return 0;
+    }
+    const size_t index = *front & (mFramesP2 - 1);
+    const size_t part1 = min(frames, mFramesP2 - index);
+    memcpy(dst, (const uint8_t *) mBuffer + index * mFrameSize, part1 * mFrameSize);
+    if (frames > part1) {
+        memcpy((uint8_t *) dst + part1 * mFrameSize, mBuffer, (frames - part1) * mFrameSize);
+    }
+    *front += frames;
+    return frames;
+}
+
+// updateSharedConverters_l() must be called with ThreadBase::mLock held
+void AudioFlinger::RecordThread::updateSharedConverters_l(
+        const Vector< sp<RecordTrack> >& activeTracks)
+{
+    for (size_t i = 0; i < mSharedConverters.size(); i++) {
+        mSharedConverters[i]->mUsers = 0;
+    }
+    for (size_t i = 0; i < activeTracks.size(); i++) {
+        const sp<RecordTrack>& track = activeTracks[i];
+        // without resampling, the conversion is as cheap as the copy from a shared ring
+        if (!mShareConversions || track->isFastTrack() || track->mSampleRate == mSampleRate) {
+            track->mSharedConverter = NULL;
+            continue;
+        }
+        SharedRecordConverter *converter = track->mSharedConverter;
+        if (converter == NULL || !converter->matches(track.get())) {
+            converter = NULL;
+            for (size_t j = 0; j < mSharedConverters.size(); j++) {
+                if (mSharedConverters[j]->matches(track.get())) {
+                    converter = mSharedConverters[j];
+                    break;
+                }
+            }
+            if (converter == NULL) {
+                converter = new SharedRecordConverter(this,
+                        track->mChannelMask, track->mFormat, track->mSampleRate);
+                if (converter->initCheck() != NO_ERROR) {
+                    // fall back to the track's own converter
+                    delete converter;
+                    track->mSharedConverter = NULL;
+                    continue;
+                }
+                mSharedConverters.add(converter);
+            }
+            track->mSharedConverter = converter;
+            track->mSharedConverterFront = converter->rear();
+        }
+        converter->mUsers++;
+    }
+    for (size_t i = 0; i < mSharedConverters.size(); ) {
+        SharedRecordConverter *converter = mSharedConverters[i];
+        if (converter->mUsers != 0) {
+            i++;
+            continue;
+        }
+        for (size_t j = 0; j < mTracks.size(); j++) {
+            if (mTracks[j]->mSharedConverter == converter) {
+                mTracks[j]->mSharedConverter = NULL;
+            }
+        }
+        mSharedConverters.removeAt(i);
+        delete converter;
+    }
+}
+
 bool AudioFlinger::RecordThread::checkForNewParameter_l(const String8& keyValuePair,
                                                         status_t& status)
 {
@@ -72,15 +72,24 @@ public:
     //  5. sendConfigEvent_l() returns status
     //  6. Unlock
     //
+    // The same sequence without the thread lock (e.g. binder thread calling setParameters(),
+    // or audio policy creating a patch) uses sendConfigEvent() instead of steps 2 to 6:
+    //  1. push the event onto the lock-free mConfigEventQueue, or if it is full,
+    //     lock mLock and fall back to sendConfigEvent_l()
+    //  2. if the thread is waiting on mWaitWorkCV, lock mLock and signal it; otherwise
+    //     the thread drains mConfigEventQueue at the top of its next cycle
+    //  3. wait on the event's own mLock/mCond, which acts as the completion token
+    //
     // Parameter sequence by server: threadLoop calling processConfigEvents_l():
     // 1. Lock mLock
-    // 2. If there is an entry in mConfigEvents proceed ...
-    // 3. Read first entry in mConfigEvents
-    // 4. Remove first entry from mConfigEvents
-    // 5. Process
-    // 6. Set event->mStatus
-    // 7. event->mCond.signal
-    // 8. Unlock
+    // 2. Move any entries in mConfigEventQueue to the end of mConfigEvents
+    // 3. If there is an entry in mConfigEvents proceed ...
+    // 4. Read first entry in mConfigEvents
+    // 5. Remove first entry from mConfigEvents
+    // 6. Process
+    // 7. Set event->mStatus
+    // 8. event->mCond.signal
+    // 9. Unlock
 
     class ConfigEvent: public RefBase {
     public:
@@ -126,23 +135,28 @@ public:
 
     class PrioConfigEventData : public ConfigEventData {
     public:
-        PrioConfigEventData(pid_t pid, pid_t tid, int32_t prio) :
-            mPid(pid), mTid(tid), mPrio(prio) {}
+        PrioConfigEventData(pid_t pid, pid_t tid, int32_t prio,
+                            nsecs_t runtimeNs, nsecs_t periodNs) :
+            mPid(pid), mTid(tid), mPrio(prio), mRuntimeNs(runtimeNs), mPeriodNs(periodNs) {}
 
         virtual  void dump(char *buffer, size_t size) {
-            snprintf(buffer, size, "Prio event: pid %d, tid %d, prio %d\n", mPid, mTid, mPrio);
+            snprintf(buffer, size, "Prio event: pid %d, tid %d, prio %d, deadline %lld/%lld ns\n",
+                    mPid, mTid, mPrio, (long long) mRuntimeNs, (long long) mPeriodNs);
         }
 
         const pid_t mPid;
         const pid_t mTid;
         const int32_t mPrio;
+        const nsecs_t mRuntimeNs;   // if > 0, try SCHED_DEADLINE before SCHED_FIFO priority mPrio
+        const nsecs_t mPeriodNs;    // SCHED_DEADLINE period and relative deadline
     };
 
     class PrioConfigEvent : public ConfigEvent {
     public:
-        PrioConfigEvent(pid_t pid, pid_t tid, int32_t prio) :
+        PrioConfigEvent(pid_t pid, pid_t tid, int32_t prio,
+                        nsecs_t runtimeNs = 0, nsecs_t periodNs = 0) :
             ConfigEvent(CFG_EVENT_PRIO, true) {
-            mData = new PrioConfigEventData(pid, tid, prio);
+            mData = new PrioConfigEventData(pid, tid, prio, runtimeNs, periodNs);
         }
         virtual ~PrioConfigEvent() {}
     };
@@ -265,15 +279,31 @@ public:
                 // Can temporarily release the lock if waiting for a reply from
                 // processConfigEvents_l().
                 status_t    sendConfigEvent_l(sp<ConfigEvent>& event);
+                // sendConfigEvent() must be called without ThreadBase::mLock held.
+                // The event is queued without taking mLock unless the thread must be woken up,
+                // the queue is full, or the event must wait for system ready.
+                status_t    sendConfigEvent(sp<ConfigEvent>& event);
                 void        sendIoConfigEvent(audio_io_config_event event, pid_t pid = 0);
                 void        sendIoConfigEvent_l(audio_io_config_event event, pid_t pid = 0);
                 void        sendPrioConfigEvent(pid_t pid, pid_t tid, int32_t prio);
+                // As sendPrioConfigEvent(), but first try a SCHED_DEADLINE reservation of
+                // runtimeNs every periodNs, falling back to SCHED_FIFO priority prio.
+                void        sendDeadlineConfigEvent(pid_t pid, pid_t tid, int32_t prio,
+                                                    nsecs_t runtimeNs, nsecs_t periodNs);
                 void        sendPrioConfigEvent_l(pid_t pid, pid_t tid, int32_t prio);
                 status_t    sendSetParameterConfigEvent_l(const String8& keyValuePair);
                 status_t    sendCreateAudioPatchConfigEvent(const struct audio_patch *patch,
                                                             audio_patch_handle_t *handle);
                 status_t    sendReleaseAudioPatchConfigEvent(audio_patch_handle_t handle);
                 void        processConfigEvents_l();
+                // moves events posted by sendConfigEvent() to mConfigEvents, preserving order
+                void        drainConfigEventQueue_l();
+                bool        configEventsPending_l() const {
+                                return !mConfigEvents.isEmpty() || !mConfigEventQueue.empty();
+                            }
+                // wait on mWaitWorkCV, advertising to sendConfigEvent() that a signal is needed
+                void        waitWork_l();
+                status_t    waitWorkRelative_l(nsecs_t reltime);
     virtual     void        cacheParameters_l() = 0;
     virtual     status_t    createAudioPatch_l(const struct audio_patch *patch,
                                                audio_patch_handle_t *handle) = 0;
@@ -452,6 +482,11 @@ protected:
 
                 Vector< sp<ConfigEvent> >     mConfigEvents;
                 Vector< sp<ConfigEvent> >     mPendingConfigEvents; // events awaiting system ready
+                static const size_t kConfigEventQueueSize = 64;
+                // events posted by sendConfigEvent() without mLock, consumed with mLock held
+                MpscQueue< sp<ConfigEvent>, kConfigEventQueueSize > mConfigEventQueue;
+                // true while the thread is blocked on mWaitWorkCV (written with mLock held)
+                std::atomic_bool        mWaitingForWork;
 
                 // These fields are written and read by thread itself without lock or barrier,
                 // and read by other threads without lock or barrier via standby(), outDevice()
@@ -544,6 +579,10 @@ protected:
     virtual     mixer_state prepareTracks_l(Vector< sp<Track> > *tracksToRemove) = 0;
                 void        removeTracks_l(const Vector< sp<Track> >& tracksToRemove);
 
+                // updates the effect time share and underrun rate of an active track,
+                // called by prepareTracks_l() once per cycle
+                void        updateTrackUsage_l(Track *track, nsecs_t now);
+
                 void        writeCallback();
                 void        resetWriteBlocked(uint32_t sequence);
                 void        drainCallback();
@@ -594,6 +633,20 @@ public:
                                 int uid,
                                 status_t *status /*non-NULL*/);
 
+                // Starts tracks of this thread so that they all begin in the same mix cycle.
+                // Audio policy is consulted for every track before the thread lock is taken,
+                // then all tracks are made active under a single hold of the lock.
+                // The result for tracks[i] is returned in statuses[i].
+                void        startTracks(const Vector< sp<Track> >& tracks,
+                                        Vector<status_t>& statuses);
+
+                // Leaves standby ahead of a track start, see IAudioFlinger::prewarmOutput().
+                void        prewarm();
+
+                // adds the mixer usage of this thread's tracks to the per-uid totals
+                void        getUidMixerUsage_l(
+                                    KeyedVector<uid_t, AudioUidMixerUsage>& usages) const;
+
                 AudioStreamOut* getOutput() const;
                 AudioStreamOut* clearOutput();
                 virtual audio_stream_t* stream() const;
@@ -717,6 +770,23 @@ protected:
     // for any processing (including output processing).
     bool                            mEffectBufferValid;
 
+    // Processes the effect chains after mixing, with the chains locked and mLock not held.
+    // When mEffectWorkers is set, the chains of audio sessions other than the output mix and
+    // output stage write to a private buffer and are processed in parallel; their outputs are
+    // then accumulated in chain order before the global chains are processed.
+                void        processEffectChains(const Vector< sp<EffectChain> >& effectChains);
+    static      void        processEffectChainJob(void *cookie, size_t index);
+
+    // optional pool helping the thread to process session effect chains, see
+    // processEffectChains().  Set at construction, when enabled by property af.fx.workers.
+    sp<WorkerPool>                  mEffectWorkers;
+    // chains of the current processEffectChains() call, valid during WorkerPool::run()
+    const Vector< sp<EffectChain> >* mParallelEffectChains;
+    // remaining cycles of serial processing after a parallel batch missed its deadline
+    uint32_t                        mParallelEffectBackoff;
+    uint32_t                        mParallelEffectCycles;  // cycles processed in parallel
+    uint32_t                        mParallelEffectMisses;  // parallel cycles over deadline
+
     // suspend count, > 0 means suspended.  While suspended, the thread continues to pull from
     // tracks and mix, but doesn't write to HAL.  A2DP and SCO HAL implementations can't handle
     // concurrent use of both of them, so Audio Policy Service suspends one of the threads to
@@ -780,13 +850,16 @@ private:
 
     PlaybackThread& operator = (const PlaybackThread&);
 
-    status_t    addTrack_l(const sp<Track>& track);
+    status_t    addTrack_l(const sp<Track>& track, bool outputStarted = false);
     bool        destroyTrack_l(const sp<Track>& track);
     void        removeTrack_l(const sp<Track>& track);
     void        broadcast_l();
 
     void        readOutputParameters_l();
 
+    // logs the HAL write stalls detected by mOutput since the last call
+    void        reportWriteStalls_l();
+
     virtual void dumpInternals(int fd, const Vector<String16>& args);
     void        dumpTracks(int fd, const Vector<String16>& args);
 
@@ -799,6 +872,8 @@ private:
     int                             mNumWrites;
     int                             mNumDelayedWrites;
     bool                            mInWrite;
+    uint32_t                        mReportedWriteStalls;
+    nsecs_t                         mLastWriteStallWarningNs;
 
     // FIXME rename these former local variables of threadLoop to standard "m" names
     nsecs_t                         mStandbyTimeNs;
@@ -876,7 +951,27 @@ protected:
                 bool        mHwSupportsPause;
                 bool        mHwPaused;
                 bool        mFlushPending;
-};
+
+                // Adaptive standby (MIXER only, enabled by property af.standby.adaptive).
+                // The standby delay follows the recent idle periods of the output, see
+                // adaptiveStandbyDelay_l(), and if the HAL implements pause() the stream is
+                // paused instead of written with silence while waiting for standby.
+                // Accessed within threadLoop() except where noted.
+                void        updateIdleState_l();
+                nsecs_t     adaptiveStandbyDelay_l() const;
+
+                static const size_t kIdleHistorySize = 16;
+                const bool  mAdaptiveStandby;
+                nsecs_t     mConfiguredStandbyDelayNs;  // standby delay before adaptation
+                nsecs_t     mIdleStartNs;   // start of the current idle period, 0 while active,
+                                            // -1 until the first track becomes active
+                nsecs_t     mIdleHistoryNs[kIdleHistorySize];   // most recent idle periods
+                size_t      mIdleHistoryCount;
+                size_t      mIdleHistoryIndex;
+                bool        mWarmIdleSupported;     // HAL implements pause() and resume()
+                bool        mWarmIdle;              // HAL paused while idle, not in standby
+                nsecs_t     mWarmIdleTimeNs;        // earliest time to pause in this idle period
+                std::atomic<bool> mPrewarmPending;  // set by prewarm() from binder threads
 
 class MixerThread : public PlaybackThread {
 public:
@@ -925,6 +1020,10 @@ protected:
 
                 AudioMixer* mAudioMixer;    // normal mixer
 private:
+                // pause and resume the HAL stream while idle, see mWarmIdle
+                bool        enterWarmIdle();
+                void        exitWarmIdle();
+
                 // one-time initialization, no locks required
                 sp<FastMixer>     mFastMixer;     // non-0 if there is also a fast mixer
                 sp<AudioWatchdog> mAudioWatchdog; // non-0 if there is an audio watchdog thread
@@ -1101,12 +1200,21 @@ protected:
 private:
     // called from threadLoop, addOutputTrack, removeOutputTrack
     virtual     void        updateWaitTime_l();
+    // called from threadLoop_write() to align the outputs that are about to start
+                void        updateLatencyCompensation();
+                void        writeDelayed(const sp<OutputTrack>& track, uint32_t delayFrames);
+                sp<OutputTrack::SharedFrames> mixHistory(size_t index);
 protected:
     virtual     void        saveOutputTracks();
     virtual     void        clearOutputTracks();
 private:
 
                 uint32_t    mWaitTimeMs;
+                const bool  mLatencyCompensation;   // delay outputs to match highest latency
+                uint32_t    mMaxCompensationFrames; // highest delay of the output tracks
+    // recent mixes, most recent first, kept while some output tracks are delayed
+    Vector< sp<OutputTrack::SharedFrames> > mMixHistory;
+    sp<OutputTrack::SharedFrames> mSilence; // written to delayed outputs on start
     SortedVector < sp<OutputTrack> >  outputTracks;
     SortedVector < sp<OutputTrack> >  mOutputTracks;
 public:
@@ -1129,7 +1237,11 @@ public:
     {
     public:
         ResamplerBufferProvider(RecordTrack* recordTrack) :
-            mRecordTrack(recordTrack),
+            mRecordTrack(recordTrack), mRecordThread(NULL),
+            mRsmpInUnrel(0), mRsmpInFront(0) { }
+        // for a SharedRecordConverter, which reads on behalf of several RecordTracks
+        explicit ResamplerBufferProvider(RecordThread* recordThread) :
+            mRecordTrack(NULL), mRecordThread(recordThread),
             mRsmpInUnrel(0), mRsmpInFront(0) { }
         virtual ~ResamplerBufferProvider() { }
 
@@ -1154,7 +1266,10 @@ public:
         virtual status_t    getNextBuffer(AudioBufferProvider::Buffer* buffer);
         virtual void        releaseBuffer(AudioBufferProvider::Buffer* buffer);
     private:
-        RecordTrack * const mRecordTrack;
+        sp<ThreadBase>      thread() const;
+
+        RecordTrack * const mRecordTrack;   // NULL if mRecordThread is set
+        RecordThread * const mRecordThread; // only for a SharedRecordConverter
         size_t              mRsmpInUnrel;   // unreleased frames remaining from
                                             // most recent getNextBuffer
                                             // for debug only
@@ -1248,6 +1363,56 @@ public:
         int8_t               mIdxAry[sizeof(uint32_t) * 8]; // used for channel mask conversion
     };
 
+    /* The SharedRecordConverter converts the RecordThread data once for all the active
+     * RecordTracks that resample to the same sample rate, format and channel mask.
+     * The converted frames are kept in a ring, which each RecordTrack reads at its own
+     * position, so that a track that does not keep up overruns without affecting the others.
+     * Used only within threadLoop(), see updateSharedConverters_l().
+     */
+    class SharedRecordConverter
+    {
+    public:
+        SharedRecordConverter(RecordThread *recordThread,
+                audio_channel_mask_t dstChannelMask, audio_format_t dstFormat,
+                uint32_t dstSampleRate);
+        ~SharedRecordConverter();
+
+        status_t initCheck() const { return mConverter.initCheck(); }
+
+        // true if the converter produces the format of track from the current thread input
+        bool     matches(const RecordTrack *track) const;
+
+        // converts all the RecordThread data not yet converted into the ring
+        void     convert();
+
+        // read position of a track joining the conversion: the next frame to be converted
+        int32_t  rear() const { return mRear; }
+
+        /* Copies up to frames converted frames to dst from the read position *front, and
+         * advances *front.  If the track has fallen behind by more than the ring size,
+         * *front skips to the oldest frame still available and *hasOverrun is set.
+         * Returns the number of frames copied.
+         */
+        size_t   read(void *dst, size_t frames, int32_t *front, bool *hasOverrun) const;
+
+        size_t   mUsers;    // number of active tracks using the converter in this cycle
+
+    private:
+        RecordThread * const    mRecordThread;
+        const audio_channel_mask_t mSrcChannelMask;
+        const audio_format_t    mSrcFormat;
+        const uint32_t          mSrcSampleRate;
+        const audio_channel_mask_t mDstChannelMask;
+        const audio_format_t    mDstFormat;
+        const uint32_t          mDstSampleRate;
+        ResamplerBufferProvider mProvider;
+        RecordBufferConverter   mConverter;
+        const size_t            mFrameSize;     // of the converted frames
+        size_t                  mFramesP2;      // ring size in frames, a power of 2
+        void                   *mBuffer;
+        int32_t                 mRear;          // rolling index of the next converted frame
+    };
+
 #include "RecordTracks.h"
 
             RecordThread(const sp<AudioFlinger>& audioFlinger,
@@ -1367,6 +1532,16 @@ private:
             // rolling index that is never cleared
             int32_t                             mRsmpInRear;    // last filled frame + 1
 
+            // Assigns a SharedRecordConverter to each of activeTracks that resamples,
+            // and deletes the converters no longer used.
+            void                                updateSharedConverters_l(
+                                                    const Vector< sp<RecordTrack> >&
+                                                            activeTracks);
+            // converters of the active RecordTracks, accessed only by threadLoop()
+            Vector<SharedRecordConverter *>     mSharedConverters;
+            // false if disabled by property af.record.shared_conversion
+            const bool                          mShareConversions;
+
             // For dumpsys
             const sp<NBAIO_Sink>                mTeeSink;
 
@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "TimeStretcher"
+//#define LOG_NDEBUG 0
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <utils/Log.h>
+
+#include "TimeStretcher.h"
+
+#if defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#define USE_WSOLA_NEON 1
+#define USE_WSOLA_SSE 0
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_WSOLA_NEON 0
+#define USE_WSOLA_SSE 1
+#else
+#define USE_WSOLA_NEON 0
+#define USE_WSOLA_SSE 0
+#endif
+
+namespace android {
+
+// ----------------------------------------------------------------------------
+
+// static
+TimeStretcher::engine_t TimeStretcher::selectEngine(const AudioPlaybackRate &playbackRate,
+        audio_format_t format)
+{
+    if (format == AUDIO_FORMAT_PCM_FLOAT
+            && playbackRate.mStretchMode == AUDIO_TIMESTRETCH_STRETCH_SPEECH
+            && playbackRate.mSpeed >= WsolaTimeStretcher::kMinSpeed
+            && playbackRate.mSpeed <= WsolaTimeStretcher::kMaxSpeed) {
+        return ENGINE_WSOLA;
+    }
+    return ENGINE_SONIC;
+}
+
+// static
+TimeStretcher *TimeStretcher::create(engine_t engine, uint32_t channelCount,
+        audio_format_t format, uint32_t sampleRate)
+{
+    switch (engine) {
+    case ENGINE_WSOLA:
+        if (format == AUDIO_FORMAT_PCM_FLOAT) {
+            return new WsolaTimeStretcher(channelCount, sampleRate);
+        }
+        ALOGE("WSOLA time stretcher does not support format %#x", format);
+        return NULL;
+    case ENGINE_SONIC: {
+        SonicTimeStretcher *stretcher = new SonicTimeStretcher(channelCount, format, sampleRate);
+        if (!stretcher->initCheck()) {
+            delete stretcher;
+            return NULL;
+        }
+        return stretcher;
+        }
+    default:
+        ALOGE("invalid time stretcher engine %d", engine);
+        return NULL;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+SonicTimeStretcher::SonicTimeStretcher(uint32_t channelCount, audio_format_t format,
+        uint32_t sampleRate) :
+        mFormat(format),
+        mSonicStream(sonicCreateStream(sampleRate, channelCount))
+{
+}
+
+SonicTimeStretcher::~SonicTimeStretcher()
+{
+    if (mSonicStream != NULL) {
+        sonicDestroyStream(mSonicStream);
+    }
+}
+
+void SonicTimeStretcher::setSpeed(float speed)
+{
+    sonicSetSpeed(mSonicStream, speed);
+}
+
+bool SonicTimeStretcher::write(const void *src, size_t frameCount)
+{
+    switch (mFormat) {
+    case AUDIO_FORMAT_PCM_FLOAT:
+        return sonicWriteFloatToStream(mSonicStream, (float *)src, frameCount) == 1;
+    case AUDIO_FORMAT_PCM_16_BIT:
+        return sonicWriteShortToStream(mSonicStream, (short *)src, frameCount) == 1;
+    default:
+        // could also be caught on construction
+        LOG_ALWAYS_FATAL("invalid format %#x for SonicTimeStretcher", mFormat);
+        return false;
+    }
+}
+
+size_t SonicTimeStretcher::read(void *dst, size_t frameCount)
+{
+    switch (mFormat) {
+    case AUDIO_FORMAT_PCM_FLOAT:
+        return sonicReadFloatFromStream(mSonicStream, (float *)dst, frameCount);
+    case AUDIO_FORMAT_PCM_16_BIT:
+        return sonicReadShortFromStream(mSonicStream, (short *)dst, frameCount);
+    default:
+        LOG_ALWAYS_FATAL("invalid format %#x for SonicTimeStretcher", mFormat);
+        return 0;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// Returns the correlation of a and b, and the energy of b, over count samples.
+static inline void correlate(const float *a, const float *b, size_t count,
+        float *correlation, float *energy)
+{
+    size_t i = 0;
+#if USE_WSOLA_NEON
+    float32x4_t c4 = vdupq_n_f32(0.0f);
+    float32x4_t e4 = vdupq_n_f32(0.0f);
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t a4 = vld1q_f32(a + i);
+        const float32x4_t b4 = vld1q_f32(b + i);
+        c4 = vmlaq_f32(c4, a4, b4);
+        e4 = vmlaq_f32(e4, b4, b4);
+    }
+    float c2[2], e2[2];
+    vst1_f32(c2, vadd_f32(vget_low_f32(c4), vget_high_f32(c4)));
+    vst1_f32(e2, vadd_f32(vget_low_f32(e4), vget_high_f32(e4)));
+    float c = c2[0] + c2[1];
+    float e = e2[0] + e2[1];
+#elif USE_WSOLA_SSE
+    __m128 c4 = _mm_setzero_ps();
+    __m128 e4 = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        const __m128 a4 = _mm_loadu_ps(a + i);
+        const __m128 b4 = _mm_loadu_ps(b + i);
+        c4 = _mm_add_ps(c4, _mm_mul_ps(a4, b4));
+        e4 = _mm_add_ps(e4, _mm_mul_ps(b4, b4));
+    }
+    float c1[4], e1[4];
+    _mm_storeu_ps(c1, c4);
+    _mm_storeu_ps(e1, e4);
+    float c = (c1[0] + c1[1]) + (c1[2] + c1[3]);
+    float e = (e1[0] + e1[1]) + (e1[2] + e1[3]);
+#else
+    float c = 0.0f;
+    float e = 0.0f;
+#endif
+    for (; i < count; i++) {
+        c += a[i] * b[i];
+        e += b[i] * b[i];
+    }
+    *correlation = c;
+    *energy = e;
+}
+
+WsolaTimeStretcher::WsolaTimeStretcher(uint32_t channelCount, uint32_t sampleRate) :
+        mChannelCount(channelCount),
+        mOverlapFrames(sampleRate * kOverlapMs / 1000),
+        mSearchFrames(sampleRate * kSearchMs / 1000),
+        mFade(new float[mOverlapFrames]),
+        mTail(new float[mOverlapFrames * channelCount]),
+        mHaveTail(false),
+        mSpeed(AUDIO_TIMESTRETCH_SPEED_NORMAL),
+        mInput(NULL),
+        mInputFrames(0),
+        mInputCapacity(0),
+        mInputPosition(0),
+        mOutput(NULL),
+        mOutputFrames(0),
+        mOutputCapacity(0)
+{
+    // raised cosine, so that the gains of the two cross-faded segments sum to 1
+    for (size_t i = 0; i < mOverlapFrames; i++) {
+        mFade[i] = 0.5f - 0.5f * cosf(M_PI * (i + 0.5f) / mOverlapFrames);
+    }
+}
+
+WsolaTimeStretcher::~WsolaTimeStretcher()
+{
+    delete[] mFade;
+    delete[] mTail;
+    free(mInput);
+    free(mOutput);
+}
+
+void WsolaTimeStretcher::setSpeed(float speed)
+{
+    mSpeed = speed;
+}
+
+bool WsolaTimeStretcher::reserve(float **buffer, size_t *capacity, size_t used,
+        size_t frameCount)
+{
+    if (frameCount <= *capacity) {
+        return true;
+    }
+    // grow geometrically, as the input provider may deliver slightly different counts
+    const size_t newCapacity = frameCount + frameCount / 2;
+    void *newBuffer;
+    if (posix_memalign(&newBuffer, 32, newCapacity * mChannelCount * sizeof(float)) != 0) {
+        return false;
+    }
+    if (used != 0) {
+        memcpy(newBuffer, *buffer, used * mChannelCount * sizeof(float));
+    }
+    free(*buffer);
+    *buffer = (float *)newBuffer;
+    *capacity = newCapacity;
+    return true;
+}
+
+bool WsolaTimeStretcher::write(const void *src, size_t frameCount)
+{
+    if (!reserve(&mInput, &mInputCapacity, mInputFrames, mInputFrames + frameCount)) {
+        return false;
+    }
+    memcpy(mInput + mInputFrames * mChannelCount, src,
+            frameCount * mChannelCount * sizeof(float));
+    mInputFrames += frameCount;
+    process();
+    return true;
+}
+
+size_t WsolaTimeStretcher::read(void *dst, size_t frameCount)
+{
+    if (frameCount > mOutputFrames) {
+        frameCount = mOutputFrames;
+    }
+    const size_t sampleCount = frameCount * mChannelCount;
+    memcpy(dst, mOutput, sampleCount * sizeof(float));
+    mOutputFrames -= frameCount;
+    if (mOutputFrames != 0) {
+        memmove(mOutput, mOutput + sampleCount, mOutputFrames * mChannelCount * sizeof(float));
+    }
+    return frameCount;
+}
+
+size_t WsolaTimeStretcher::search(size_t nominal) const
+{
+    const size_t first = nominal > mSearchFrames ? nominal - mSearchFrames : 0;
+    const size_t last = nominal + mSearchFrames;
+    const size_t sampleCount = mOverlapFrames * mChannelCount;
+
+    // coarse pass over the whole range, then fine pass around the best coarse candidate
+    size_t best = nominal;
+    float bestScore = -INFINITY;
+    for (int pass = 0; pass < 2; pass++) {
+        size_t from = first, to = last, step = kCoarseStep;
+        if (pass == 1) {
+            from = best > first + kCoarseStep - 1 ? best - (kCoarseStep - 1) : first;
+            to = best + (kCoarseStep - 1) < last ? best + (kCoarseStep - 1) : last;
+            step = 1;
+        }
+        for (size_t start = from; start <= to; start += step) {
+            float correlation, energy;
+            correlate(mTail, mInput + start * mChannelCount, sampleCount,
+                    &correlation, &energy);
+            // normalize by the candidate energy only, as the energy of mTail is the same
+            // for all candidates
+            const float score = correlation / sqrtf(energy + 1e-9f);
+            if (score > bestScore) {
+                bestScore = score;
+                best = start;
+            }
+        }
+    }
+    return best;
+}
+
+void WsolaTimeStretcher::process()
+{
+    const size_t hopSamples = mOverlapFrames * mChannelCount;
+    for (;;) {
+        // a hop needs a segment and its natural continuation at the furthest candidate
+        const size_t nominal = (size_t)mInputPosition;
+        if (nominal + mSearchFrames + 2 * mOverlapFrames > mInputFrames) {
+            break;
+        }
+        if (!reserve(&mOutput, &mOutputCapacity, mOutputFrames,
+                mOutputFrames + mOverlapFrames)) {
+            ALOGE("cannot grow output buffer");
+            break;
+        }
+        const size_t start = mHaveTail ? search(nominal) : nominal;
+        const float *in = mInput + start * mChannelCount;
+        float *out = mOutput + mOutputFrames * mChannelCount;
+        if (mHaveTail) {
+            for (size_t i = 0; i < mOverlapFrames; i++) {
+                const float fade = mFade[i];
+                for (uint32_t c = 0; c < mChannelCount; c++) {
+                    const float tail = mTail[i * mChannelCount + c];
+                    out[i * mChannelCount + c] = tail + (in[i * mChannelCount + c] - tail) * fade;
+                }
+            }
+        } else {
+            memcpy(out, in, hopSamples * sizeof(float));
+            mHaveTail = true;
+        }
+        memcpy(mTail, in + hopSamples, hopSamples * sizeof(float));
+        mOutputFrames += mOverlapFrames;
+        mInputPosition += mOverlapFrames * mSpeed;
+    }
+
+    // discard the input before the earliest candidate of the next hop
+    const size_t nominal = (size_t)mInputPosition;
+    size_t discard = nominal > mSearchFrames ? nominal - mSearchFrames : 0;
+    if (discard > mInputFrames) {
+        discard = mInputFrames;
+    }
+    if (discard != 0) {
+        mInputFrames -= discard;
+        memmove(mInput, mInput + discard * mChannelCount,
+                mInputFrames * mChannelCount * sizeof(float));
+        mInputPosition -= discard;
+    }
+}
+
+// ----------------------------------------------------------------------------
+} // namespace android
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_TIME_STRETCHER_H
+#define ANDROID_TIME_STRETCHER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <media/AudioResamplerPublic.h>
+#include <system/audio.h>
+#include <utils/Compat.h>
+#include <sonic.h>
+
+namespace android {
+
+// ----------------------------------------------------------------------------
+
+// TimeStretcher is the interface of the time stretching engines of TimestretchBufferProvider.
+// Frames are interleaved, with the channel count and format given at creation.
+// Stretched frames are produced as input is written, and are buffered until read.
+class TimeStretcher {
+public:
+    enum engine_t {
+        ENGINE_SONIC,   // Sonic, PCM 16 bit or float, the whole AudioPlaybackRate speed range
+        ENGINE_WSOLA,   // WSOLA tuned for speech, float only, see WsolaTimeStretcher
+    };
+
+    virtual ~TimeStretcher() { }
+
+    virtual engine_t engine() const = 0;
+
+    virtual void    setSpeed(float speed) = 0;
+
+    // Queues frameCount frames of src.  Returns false if they could not all be queued.
+    virtual bool    write(const void *src, size_t frameCount) = 0;
+
+    // Reads up to frameCount stretched frames into dst, and returns the number of frames read.
+    virtual size_t  read(void *dst, size_t frameCount) = 0;
+
+    // Returns the engine to use for a track with these playback rate and format.
+    static engine_t selectEngine(const AudioPlaybackRate &playbackRate, audio_format_t format);
+
+    // Returns a new engine, or NULL if it cannot be created.
+    static TimeStretcher *create(engine_t engine, uint32_t channelCount,
+            audio_format_t format, uint32_t sampleRate);
+};
+
+// SonicTimeStretcher wraps the Sonic library, which TimestretchBufferProvider always used.
+class SonicTimeStretcher : public TimeStretcher {
+public:
+    SonicTimeStretcher(uint32_t channelCount, audio_format_t format, uint32_t sampleRate);
+    virtual ~SonicTimeStretcher();
+
+    bool            initCheck() const { return mSonicStream != NULL; }
+
+    virtual engine_t engine() const { return ENGINE_SONIC; }
+    virtual void    setSpeed(float speed);
+    virtual bool    write(const void *src, size_t frameCount);
+    virtual size_t  read(void *dst, size_t frameCount);
+
+private:
+    const audio_format_t mFormat;
+    sonicStream          mSonicStream;
+};
+
+// WsolaTimeStretcher is a waveform similarity overlap-add stretcher for float frames.
+//
+// Output is produced in hops of kOverlapMs.  For each hop, the input segment that best
+// continues the previous output is searched within kSearchMs of the nominal input position,
+// by normalized cross-correlation, and is cross-faded with that continuation.
+// The nominal input position advances by speed times the hop.
+// The correlation kernel is vectorized with NEON or SSE where available, and the search is
+// coarse then fine, so the cost per output frame does not depend on the speed.
+class WsolaTimeStretcher : public TimeStretcher {
+public:
+    static const uint32_t kOverlapMs = 10;      // output hop and cross-fade length
+    static const uint32_t kSearchMs = 5;        // search range each side of the nominal position
+    static const uint32_t kCoarseStep = 4;      // frames between the coarse search candidates
+
+    // Speeds outside this range are left to Sonic: at low speeds the repeated segments become
+    // audible as an echo, and at high speeds the hop skips whole phonemes.
+    static const CONSTEXPR float kMinSpeed = 0.5f;
+    static const CONSTEXPR float kMaxSpeed = 3.0f;
+
+    WsolaTimeStretcher(uint32_t channelCount, uint32_t sampleRate);
+    virtual ~WsolaTimeStretcher();
+
+    virtual engine_t engine() const { return ENGINE_WSOLA; }
+    virtual void    setSpeed(float speed);
+    virtual bool    write(const void *src, size_t frameCount);
+    virtual size_t  read(void *dst, size_t frameCount);
+
+private:
+    // produces as many output hops as the queued input allows
+    void            process();
+
+    // returns the start of the input segment that best matches mTail around nominal
+    size_t          search(size_t nominal) const;
+
+    // grows *buffer to hold at least frameCount frames, keeping the first used frames
+    bool            reserve(float **buffer, size_t *capacity, size_t used, size_t frameCount);
+
+    const uint32_t  mChannelCount;
+    const size_t    mOverlapFrames;     // frames per output hop
+    const size_t    mSearchFrames;      // search range in frames on each side
+    float          *mFade;              // mOverlapFrames cross-fade gains, rising from 0 to 1
+    float          *mTail;              // natural continuation of the last output hop
+    bool            mHaveTail;          // false until the first hop is output
+    float           mSpeed;
+
+    float          *mInput;
+    size_t          mInputFrames;       // frames queued in mInput
+    size_t          mInputCapacity;
+    double          mInputPosition;     // nominal position of the next hop in mInput, in frames
+
+    float          *mOutput;
+    size_t          mOutputFrames;      // frames available to read() in mOutput
+    size_t          mOutputCapacity;
+
+    WsolaTimeStretcher(const WsolaTimeStretcher&);
+    WsolaTimeStretcher& operator=(const WsolaTimeStretcher&);
+};
+
+// ----------------------------------------------------------------------------
+} // namespace android
+
+#endif // ANDROID_TIME_STRETCHER_H
@@ -376,6 +376,12 @@ AudioFlinger::PlaybackThread::Track::Track(
     mPresentationCompleteFrames(0),
     mFrameMap(16 /* sink-frame-to-track-frame map memory */),
     // mSinkTimestamp
+    mResamplerNs(0),
+    mEffectNs(0),
+    mLastChainNs(-1),
+    mUnderrunWindowNs(0),
+    mUnderrunWindowCount(0),
+    mUnderrunsPerSecond(0.),
     mFastIndex(-1),
     mCachedVolume(1.0),
     mIsInvalid(false),
@@ -394,6 +400,12 @@ AudioFlinger::PlaybackThread::Track::Track(
         return;
     }
 
+    // A static buffer was filled by the client and has not been accessed by this process yet,
+    // unlike a streaming buffer which was cleared by TrackBase.
+    if (sharedBuffer != 0) {
+        thread->mAudioFlinger->prefaultMemory(sharedBuffer);
+    }
+
     if (sharedBuffer == 0) {
         mAudioTrackServerProxy = new AudioTrackServerProxy(mCblk, mBuffer, frameCount,
                 mFrameSize, !isExternalTrack(), sampleRate);
@@ -564,6 +576,39 @@ void AudioFlinger::PlaybackThread::Track::dump(char* buffer, size_t size, bool a
             nowInUnderrun);
 }
 
+/*static*/ void AudioFlinger::PlaybackThread::Track::appendUsageDumpHeader(String8& result)
+{
+    result.append("    Name   Uid ResampleMs EffectMs   BytesMixed Underruns Und/s\n");
+}
+
+void AudioFlinger::PlaybackThread::Track::dumpUsage(char* buffer, size_t size) const
+{
+    if (isFastTrack()) {
+        sprintf(buffer, "    F %2d", mFastIndex);
+    } else if (mName >= AudioMixer::TRACK0) {
+        sprintf(buffer, "    %4d", mName - AudioMixer::TRACK0);
+    } else {
+        sprintf(buffer, "    none");
+    }
+    snprintf(&buffer[8], size-8, " %5d %10.3f %8.3f %12lld %9u %5.1f\n",
+            mUid,
+            mResamplerNs * 1e-6,
+            mEffectNs * 1e-6,
+            (long long) (framesReleased() * mFrameSize),
+            mAudioTrackServerProxy->getUnderrunCount(),
+            mUnderrunsPerSecond);
+}
+
+void AudioFlinger::PlaybackThread::Track::addUsage(AudioUidMixerUsage *usage) const
+{
+    usage->mTrackCount++;
+    usage->mResamplerNs += mResamplerNs;
+    usage->mEffectNs += mEffectNs;
+    usage->mBytesMixed += framesReleased() * mFrameSize;
+    usage->mUnderruns += mAudioTrackServerProxy->getUnderrunCount();
+    usage->mUnderrunsPerSecond += mUnderrunsPerSecond;
+}
+
 uint32_t AudioFlinger::PlaybackThread::Track::sampleRate() const {
     return mAudioTrackServerProxy->getSampleRate();
 }
@@ -649,6 +694,11 @@ status_t AudioFlinger::PlaybackThread::Track::start(AudioSystem::sync_event_t ev
 
     sp<ThreadBase> thread = mThread.promote();
     if (thread != 0) {
+        // pages of an idle track may have been reclaimed since they were last accessed
+        if (mCblkMemory != 0) {
+            thread->mAudioFlinger->prefaultMemory(
+                    mSharedBuffer != 0 ? mSharedBuffer : mCblkMemory);
+        }
         if (isOffloaded()) {
             Mutex::Autolock _laf(thread->mAudioFlinger->mLock);
             Mutex::Autolock _lth(thread->mLock);
@@ -660,6 +710,20 @@ status_t AudioFlinger::PlaybackThread::Track::start(AudioSystem::sync_event_t ev
             }
         }
         Mutex::Autolock _lth(thread->mLock);
+        status = start_l(false /*outputStarted*/);
+    } else {
+        status = BAD_VALUE;
+    }
+    return status;
+}
+
+// start_l() must be called with the thread lock held.
+// If outputStarted is true, AudioSystem::startOutput() has already succeeded for this track.
+status_t AudioFlinger::PlaybackThread::Track::start_l(bool outputStarted)
+{
+    status_t status = NO_ERROR;
+    sp<ThreadBase> thread = mThread.promote();
+    if (thread != 0) {
         track_state state = mState;
         // here the track could be either new, or restarted
         // in both cases "unstop" the track
@@ -693,7 +757,7 @@ status_t AudioFlinger::PlaybackThread::Track::start(AudioSystem::sync_event_t ev
             // after stop.
             mObservedUnderruns = playbackThread->getFastTrackUnderruns(mFastIndex);
         }
-        status = playbackThread->addTrack_l(this);
+        status = playbackThread->addTrack_l(this, outputStarted);
         if (status == INVALID_OPERATION || status == PERMISSION_DENIED) {
             triggerEvents(AudioSystem::SYNC_EVENT_PRESENTATION_COMPLETE);
             //  restore previous state if start was rejected by policy manager
@@ -1160,7 +1224,8 @@ AudioFlinger::PlaybackThread::OutputTrack::OutputTrack(
               sampleRate, format, channelMask, frameCount,
               NULL, 0, AUDIO_SESSION_NONE, uid, AUDIO_OUTPUT_FLAG_NONE,
               TYPE_OUTPUT),
-    mActive(false), mSourceThread(sourceThread), mClientProxy(NULL)
+    mActive(false), mSourceThread(sourceThread), mClientProxy(NULL),
+    mLatencyCompensationFrames(0)
 {
 
     if (mCblk != NULL) {
@@ -1210,7 +1275,26 @@ void AudioFlinger::PlaybackThread::OutputTrack::stop()
     mActive = false;
 }
 
-bool AudioFlinger::PlaybackThread::OutputTrack::write(void* data, uint32_t frames)
+AudioFlinger::PlaybackThread::OutputTrack::SharedFrames::SharedFrames(const void *data,
+        size_t size)
+    :   mData(malloc(size)), mSize(mData != NULL ? size : 0)
+{
+    if (mData != NULL) {
+        if (data != NULL) {
+            memcpy(mData, data, size);
+        } else {
+            memset(mData, 0, size);
+        }
+    }
+}
+
+AudioFlinger::PlaybackThread::OutputTrack::SharedFrames::~SharedFrames()
+{
+    free(mData);
+}
+
+bool AudioFlinger::PlaybackThread::OutputTrack::write(void* data, uint32_t frames,
+        sp<SharedFrames> *sharedFrames)
 {
     Buffer *pInBuffer;
     Buffer inBuffer;
@@ -1274,7 +1358,6 @@ bool AudioFlinger::PlaybackThread::OutputTrack::write(void* data, uint32_t frame
         if (pInBuffer->frameCount == 0) {
             if (mBufferQueue.size()) {
                 mBufferQueue.removeAt(0);
-                free(pInBuffer->mBuffer);
                 delete pInBuffer;
                 ALOGV("OutputTrack::write() %p thread %p released overflow buffer %zu", this,
                         mThread.unsafe_get(), mBufferQueue.size());
@@ -1290,13 +1373,35 @@ bool AudioFlinger::PlaybackThread::OutputTrack::write(void* data, uint32_t frame
         if (thread != 0 && !thread->standby()) {
             if (mBufferQueue.size() < kMaxOverFlowBuffers) {
                 pInBuffer = new Buffer;
-                pInBuffer->mBuffer = malloc(inBuffer.frameCount * mFrameSize);
-                pInBuffer->frameCount = inBuffer.frameCount;
-                pInBuffer->raw = pInBuffer->mBuffer;
-                memcpy(pInBuffer->raw, inBuffer.raw, inBuffer.frameCount * mFrameSize);
-                mBufferQueue.add(pInBuffer);
-                ALOGV("OutputTrack::write() %p thread %p adding overflow buffer %zu", this,
-                        mThread.unsafe_get(), mBufferQueue.size());
+                void *raw;
+                if (sharedFrames == NULL) {
+                    pInBuffer->mFrames = new SharedFrames(inBuffer.raw,
+                            inBuffer.frameCount * mFrameSize);
+                    raw = pInBuffer->mFrames->data();
+                } else if (*sharedFrames != 0 && (*sharedFrames)->contains(inBuffer.raw)) {
+                    // the caller already holds the frames in shared memory
+                    pInBuffer->mFrames = *sharedFrames;
+                    raw = inBuffer.raw;
+                } else {
+                    // copied by the first output that could not take all of them
+                    if (*sharedFrames == 0) {
+                        *sharedFrames = new SharedFrames(data, frames * mFrameSize);
+                    }
+                    pInBuffer->mFrames = *sharedFrames;
+                    raw = (int8_t *)(*sharedFrames)->data() +
+                            (frames - inBuffer.frameCount) * mFrameSize;
+                }
+                if (pInBuffer->mFrames->data() != NULL) {
+                    pInBuffer->frameCount = inBuffer.frameCount;
+                    pInBuffer->raw = raw;
+                    mBufferQueue.add(pInBuffer);
+                    ALOGV("OutputTrack::write() %p thread %p adding overflow buffer %zu", this,
+                            mThread.unsafe_get(), mBufferQueue.size());
+                } else {
+                    ALOGW("OutputTrack::write() %p thread %p cannot allocate overflow buffer",
+                            this, mThread.unsafe_get());
+                    delete pInBuffer;
+                }
             } else {
                 ALOGW("OutputTrack::write() %p thread %p no more overflow buffers",
                         mThread.unsafe_get(), this);
@@ -1333,7 +1438,6 @@ void AudioFlinger::PlaybackThread::OutputTrack::clearBufferQueue()
 
     for (size_t i = 0; i < size; i++) {
         Buffer *pBuffer = mBufferQueue.itemAt(i);
-        free(pBuffer->mBuffer);
         delete pBuffer;
     }
     mBufferQueue.clear();
@@ -1505,6 +1609,8 @@ AudioFlinger::RecordThread::RecordTrack::RecordTrack(
         mFramesToDrop(0),
         mResamplerBufferProvider(NULL), // initialize in case of early constructor exit
         mRecordBufferConverter(NULL),
+        mSharedConverter(NULL),
+        mSharedConverterFront(0),
         mFlags(flags)
 {
     if (mCblk == NULL) {
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "WorkerPool"
+//#define LOG_NDEBUG 0
+
+#include <stdio.h>
+
+#include <utils/Log.h>
+
+#include "WorkerPool.h"
+
+namespace android {
+
+WorkerPool::WorkerPool(size_t threadCount, const char *name, int32_t priority)
+    : mGeneration(0), mExit(false), mJob(NULL), mCookie(NULL), mCount(0),
+      mClaim(0), mPending(0)
+{
+    for (size_t i = 0; i < threadCount; i++) {
+        sp<Worker> worker = new Worker(this);
+        char threadName[32];
+        snprintf(threadName, sizeof(threadName), "%s%zu", name, i);
+        if (worker->run(threadName, priority) != NO_ERROR) {
+            ALOGW("cannot start worker thread %s", threadName);
+            continue;
+        }
+        mWorkers.add(worker);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        Mutex::Autolock _l(mLock);
+        mExit = true;
+        mWorkCond.broadcast();
+    }
+    for (size_t i = 0; i < mWorkers.size(); i++) {
+        mWorkers[i]->requestExitAndWait();
+    }
+}
+
+bool WorkerPool::run(job_t job, void *cookie, size_t count, nsecs_t deadlineNs)
+{
+    if (count == 0) {
+        return true;
+    }
+    const nsecs_t startNs = systemTime();
+    uint32_t generation;
+    {
+        Mutex::Autolock _l(mLock);
+        generation = ++mGeneration;
+        mJob = job;
+        mCookie = cookie;
+        mCount.store(count, std::memory_order_relaxed);
+        mPending.store(count, std::memory_order_relaxed);
+        mClaim.store((uint64_t) generation << 32, std::memory_order_release);
+        // only wake as many workers as there are jobs to share with the calling thread
+        if (count > 1) {
+            if (count - 1 >= mWorkers.size()) {
+                mWorkCond.broadcast();
+            } else {
+                for (size_t i = 0; i < count - 1; i++) {
+                    mWorkCond.signal();
+                }
+            }
+        }
+    }
+
+    runJobs(generation);
+
+    bool metDeadline = true;
+    Mutex::Autolock _l(mLock);
+    while (mPending.load(std::memory_order_acquire) != 0) {
+        if (deadlineNs > 0 && metDeadline) {
+            const nsecs_t remainingNs = deadlineNs - (systemTime() - startNs);
+            if (remainingNs <= 0 || mDoneCond.waitRelative(mLock, remainingNs) == TIMED_OUT) {
+                // the jobs already claimed must still complete, so keep waiting
+                metDeadline = false;
+            }
+        } else {
+            mDoneCond.wait(mLock);
+        }
+    }
+    if (metDeadline && deadlineNs > 0 && systemTime() - startNs > deadlineNs) {
+        metDeadline = false;
+    }
+    return metDeadline;
+}
+
+void WorkerPool::runJobs(uint32_t generation)
+{
+    uint64_t claim = mClaim.load(std::memory_order_acquire);
+    for (;;) {
+        if ((uint32_t) (claim >> 32) != generation || (claim & 0xFFFFFFFF) >= mCount.load(std::memory_order_relaxed)) {
+            return;
+        }
+        // on failure claim is reloaded, and the generation is checked again
+        if (!mClaim.compare_exchange_weak(claim, claim + 1, std::memory_order_acq_rel)) {
+            continue;
+        }
+        mJob(mCookie, (size_t) (claim & 0xFFFFFFFF));
+        if (mPending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Mutex::Autolock _l(mLock);
+            mDoneCond.signal();
+        }
+        claim = mClaim.load(std::memory_order_acquire);
+    }
+}
+
+bool WorkerPool::Worker::threadLoop()
+{
+    uint32_t generation;
+    {
+        Mutex::Autolock _l(mPool->mLock);
+        generation = mPool->mGeneration;
+    }
+    for (;;) {
+        {
+            Mutex::Autolock _l(mPool->mLock);
+            while (!mPool->mExit && mPool->mGeneration == generation) {
+                mPool->mWorkCond.wait(mPool->mLock);
+            }
+            if (mPool->mExit) {
+                return false;
+            }
+            generation = mPool->mGeneration;
+        }
+        mPool->runJobs(generation);
+    }
+}
+
+}   // namespace android
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_WORKER_POOL_H
+#define ANDROID_AUDIO_WORKER_POOL_H
+
+#include <atomic>
+#include <stdint.h>
+
+#include <utils/Condition.h>
+#include <utils/Mutex.h>
+#include <utils/RefBase.h>
+#include <utils/Thread.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+// WorkerPool is a fixed set of threads that help one calling thread to run a batch of
+// independent jobs, for example the effect chains of several audio sessions.
+//
+// The caller takes part in the batch, so run() makes progress even if no worker is scheduled.
+// Jobs are claimed through a single atomic word that also carries the batch generation,
+// so that a worker that wakes up late cannot claim a job of a later batch.
+// Only one thread may call run() at a time.
+class WorkerPool : public RefBase {
+public:
+    typedef void (*job_t)(void *cookie, size_t index);
+
+    // Starts threadCount threads named name with the specified priority.
+    WorkerPool(size_t threadCount, const char *name, int32_t priority);
+    virtual ~WorkerPool();
+
+    // Runs job(cookie, i) for each i in [0, count) on the workers and the calling thread,
+    // and returns when all of them have completed.  Returns false if the batch took longer
+    // than deadlineNs, or if deadlineNs <= 0 it is not checked.
+    bool        run(job_t job, void *cookie, size_t count, nsecs_t deadlineNs);
+
+    size_t      threadCount() const { return mWorkers.size(); }
+
+private:
+    class Worker : public Thread {
+    public:
+        explicit Worker(WorkerPool *pool) : Thread(false /*canCallJava*/), mPool(pool) { }
+    private:
+        virtual bool threadLoop();
+        WorkerPool * const mPool;   // outlives the Worker, see ~WorkerPool()
+    };
+
+    // claims and runs jobs of batch generation until there are none left
+    void        runJobs(uint32_t generation);
+
+    Mutex               mLock;
+    Condition           mWorkCond;      // signaled when a batch starts, or on exit
+    Condition           mDoneCond;      // signaled when the last job of a batch completes
+    uint32_t            mGeneration;    // protected by mLock, incremented for each batch
+    bool                mExit;          // protected by mLock
+
+    // batch description, written by run() before the batch is published in mClaim
+    job_t               mJob;
+    void               *mCookie;
+    std::atomic<size_t> mCount;         // also read by late workers, before claiming a job
+
+    std::atomic<uint64_t> mClaim;       // generation in the upper 32 bits, next index in the lower
+    std::atomic<size_t> mPending;       // jobs of the current batch not yet completed
+
+    Vector< sp<Worker> > mWorkers;
+};
+
+}   // namespace android
+
+#endif  // ANDROID_AUDIO_WORKER_POOL_H
@@ -27,6 +27,57 @@ LOCAL_CFLAGS := -Werror -Wall
 
 include $(BUILD_NATIVE_TEST)
 
+#
+# client heap unit test
+#
+include $(CLEAR_VARS)
+
+LOCAL_SHARED_LIBRARIES := \
+	liblog \
+	libutils \
+	libcutils \
+	libbinder
+
+LOCAL_C_INCLUDES := \
+	frameworks/av/services/audioflinger
+
+LOCAL_SRC_FILES := \
+	client_heap_tests.cpp \
+	../ClientHeap.cpp
+
+LOCAL_MODULE := client_heap_tests
+LOCAL_MODULE_TAGS := tests
+
+LOCAL_CFLAGS := -Werror -Wall
+
+include $(BUILD_NATIVE_TEST)
+
+#
+# time stretcher unit test
+#
+include $(CLEAR_VARS)
+
+LOCAL_SHARED_LIBRARIES := \
+	liblog \
+	libutils \
+	libcutils \
+	libsonic
+
+LOCAL_C_INCLUDES := \
+	frameworks/av/services/audioflinger \
+	external/sonic
+
+LOCAL_SRC_FILES := \
+	timestretch_tests.cpp \
+	../TimeStretcher.cpp
+
+LOCAL_MODULE := timestretch_tests
+LOCAL_MODULE_TAGS := tests
+
+LOCAL_CFLAGS := -Werror -Wall
+
+include $(BUILD_NATIVE_TEST)
+
 #
 # audio mixer test tool
 #
@@ -35,7 +86,8 @@ include $(CLEAR_VARS)
 LOCAL_SRC_FILES:= \
 	test-mixer.cpp \
 	../AudioMixer.cpp.arm \
-	../BufferProviders.cpp
+	../BufferProviders.cpp \
+	../TimeStretcher.cpp
 
 LOCAL_C_INCLUDES := \
 	$(call include-path-for, audio-effects) \
@@ -66,3 +118,44 @@ LOCAL_CXX_STL := libc++
 LOCAL_CFLAGS := -Werror -Wall
 
 include $(BUILD_EXECUTABLE)
+
+#
+# resampler, mixer and buffer provider benchmarks
+#
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	audioflinger_benchmarks.cpp \
+	../AudioMixer.cpp.arm \
+	../BufferProviders.cpp \
+	../TimeStretcher.cpp
+
+LOCAL_C_INCLUDES := \
+	$(call include-path-for, audio-effects) \
+	$(call include-path-for, audio-utils) \
+	frameworks/av/services/audioflinger \
+	external/sonic
+
+LOCAL_STATIC_LIBRARIES := \
+	libsndfile
+
+LOCAL_SHARED_LIBRARIES := \
+	libeffects \
+	libnbaio \
+	libaudioresampler \
+	libaudioutils \
+	libdl \
+	libcutils \
+	libutils \
+	liblog \
+	libsonic
+
+LOCAL_MODULE:= audioflinger_benchmarks
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_CXX_STL := libc++
+
+LOCAL_CFLAGS := -Werror -Wall
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,760 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "audioflinger_benchmarks"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cutils/log.h>
+#include <media/AudioBufferProvider.h>
+#include "AudioMixer.h"
+#include "AudioMixerOps.h"
+#include "AudioMixerOpsSimd.h"
+#include "AudioResampler.h"
+#include "BufferProviders.h"
+#include "test_utils.h"
+
+/* Benchmarks of the resamplers, the AudioMixer process hooks, the buffer providers
+ * and the mixer ops, to catch performance regressions.
+ *
+ * Each benchmark prints one line "<name>,<ns per output frame>", which is the best
+ * of several passes of one second of 48 kHz output, after an untimed warm up pass.
+ * Lines starting with '#' are comments.  The output of a run can be kept as a
+ * baseline and given back with -t on the same device, in which case the benchmarks
+ * more than the tolerance slower than the baseline are reported on stderr and the
+ * exit status is non-zero:
+ *
+ *   adb shell audioflinger_benchmarks > baseline.csv
+ *   adb push baseline.csv /data/local/tmp
+ *   adb shell audioflinger_benchmarks -t /data/local/tmp/baseline.csv
+ *
+ * Results depend on the cpu frequency: compare runs with the same governor settings.
+ */
+
+using android::AudioBufferProvider;
+using android::AudioMixer;
+using android::AudioPlaybackRate;
+using android::AudioResampler;
+using android::DownmixerBufferProvider;
+using android::MixSimd;
+using android::PassthruBufferProvider;
+using android::ReformatBufferProvider;
+using android::RemixBufferProvider;
+using android::StereoDownmixBufferProvider;
+using android::TimestretchBufferProvider;
+
+static const uint32_t kSampleRate = 48000;      // output sample rate of all benchmarks
+static const size_t kPassFrames = kSampleRate;  // output frames per timed pass
+
+static int gPasses = 5;
+static const char *gFilter = NULL;
+static std::vector<std::pair<std::string, double> > gResults;
+
+static int64_t nowNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+static const char *formatName(audio_format_t format)
+{
+    return format == AUDIO_FORMAT_PCM_FLOAT ? "f32" : "i16";
+}
+
+static bool selected(const char *name)
+{
+    return gFilter == NULL || strstr(name, gFilter) != NULL;
+}
+
+class Benchmark {
+public:
+    virtual ~Benchmark() { }
+
+    // Called before each pass, untimed.
+    virtual void prepare() { }
+
+    // Processes one pass, and returns the number of frames output.
+    virtual size_t run() = 0;
+};
+
+// Runs benchmark and reports its best ns/frame over gPasses passes as name.
+static void measure(const char *name, Benchmark &benchmark)
+{
+    double best = 0.;
+    for (int pass = 0; pass <= gPasses; ++pass) {
+        benchmark.prepare();
+        const int64_t start = nowNs();
+        const size_t frames = benchmark.run();
+        const int64_t elapsedNs = nowNs() - start;
+        if (frames == 0) {
+            fprintf(stderr, "%s: no frames output\n", name);
+            return;
+        }
+        const double nsPerFrame = (double) elapsedNs / frames;
+        if (pass == 1 || (pass > 1 && nsPerFrame < best)) { // pass 0 is the warm up
+            best = nsPerFrame;
+        }
+    }
+    printf("%s,%.3f\n", name, best);
+    fflush(stdout);
+    gResults.push_back(std::make_pair(std::string(name), best));
+}
+
+// Creates the sine input of a benchmark, long enough for a pass consuming input
+// at speed times the output rate.
+static void setSine(SignalProvider &provider, audio_format_t format, uint32_t channels,
+        uint32_t sampleRate, double speed)
+{
+    const double seconds = speed * kPassFrames / kSampleRate + 0.1;
+    if (format == AUDIO_FORMAT_PCM_FLOAT) {
+        provider.setSine<float>(channels, 1000., sampleRate, seconds);
+    } else {
+        provider.setSine<int16_t>(channels, 1000., sampleRate, seconds);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class ResamplerBenchmark : public Benchmark {
+public:
+    ResamplerBenchmark(AudioResampler::src_quality quality, audio_format_t format,
+            uint32_t channels, uint32_t inputRate, size_t frameCount)
+        : mFrameCount(frameCount),
+          mOutputChannels(std::max(channels, 2u)) // mono is resampled to stereo
+    {
+        setSine(mProvider, format, channels, inputRate, (double) inputRate / kSampleRate);
+        mResampler = AudioResampler::create(format, channels, kSampleRate, quality);
+        mResampler->setSampleRate(inputRate);
+        mResampler->setVolume(AudioResampler::UNITY_GAIN_FLOAT,
+                AudioResampler::UNITY_GAIN_FLOAT);
+        // the resamplers accumulate int32_t or float, both 4 bytes
+        mOutput.resize(kPassFrames * mOutputChannels);
+    }
+
+    virtual ~ResamplerBenchmark()
+    {
+        delete mResampler;
+    }
+
+    virtual void prepare()
+    {
+        mProvider.reset();
+        mResampler->reset();
+        memset(mOutput.data(), 0, mOutput.size() * sizeof(mOutput[0]));
+    }
+
+    virtual size_t run()
+    {
+        size_t frames = 0;
+        while (frames < kPassFrames) {
+            const size_t resampled = mResampler->resample(&mOutput[frames * mOutputChannels],
+                    std::min(mFrameCount, kPassFrames - frames), &mProvider);
+            if (resampled == 0) {
+                break;
+            }
+            frames += resampled;
+        }
+        return frames;
+    }
+
+private:
+    const size_t            mFrameCount;
+    const uint32_t          mOutputChannels;
+    SignalProvider          mProvider;
+    AudioResampler         *mResampler;
+    std::vector<int32_t>    mOutput;
+};
+
+static const struct {
+    AudioResampler::src_quality quality;
+    const char                 *name;
+    bool                        dynamic;    // float input and more than 2 channels supported
+} kResamplerQualities[] = {
+    { AudioResampler::DEFAULT_QUALITY,      "default",      false },
+    { AudioResampler::LOW_QUALITY,          "low",          false },
+    { AudioResampler::MED_QUALITY,          "med",          false },
+    { AudioResampler::HIGH_QUALITY,         "high",         false },
+    { AudioResampler::VERY_HIGH_QUALITY,    "very_high",    false },
+    { AudioResampler::DYN_LOW_QUALITY,      "dyn_low",      true },
+    { AudioResampler::DYN_MED_QUALITY,      "dyn_med",      true },
+    { AudioResampler::DYN_HIGH_QUALITY,     "dyn_high",     true },
+};
+
+static void benchmarkResamplers()
+{
+    static const uint32_t kInputRates[] = { 44100, 96000 };
+    static const size_t kFrameCounts[] = { 64, 256, 1024 };
+    static const uint32_t kChannels[] = { 1, 2, 8 };
+    static const audio_format_t kFormats[] = { AUDIO_FORMAT_PCM_16_BIT, AUDIO_FORMAT_PCM_FLOAT };
+
+    for (size_t q = 0; q < ARRAY_SIZE(kResamplerQualities); ++q) {
+        const bool dynamic = kResamplerQualities[q].dynamic;
+        for (size_t f = 0; f < (dynamic ? ARRAY_SIZE(kFormats) : 1); ++f) {
+            for (size_t c = 0; c < ARRAY_SIZE(kChannels); ++c) {
+                if (kChannels[c] > 2 && !dynamic) {
+                    continue;
+                }
+                for (size_t r = 0; r < ARRAY_SIZE(kInputRates); ++r) {
+                    for (size_t n = 0; n < ARRAY_SIZE(kFrameCounts); ++n) {
+                        char name[128];
+                        snprintf(name, sizeof(name),
+                                "resampler/%s/%s/ch:%u/rate:%u-%u/frames:%zu",
+                                kResamplerQualities[q].name, formatName(kFormats[f]),
+                                kChannels[c], kInputRates[r], kSampleRate, kFrameCounts[n]);
+                        if (!selected(name)) {
+                            continue;
+                        }
+                        ResamplerBenchmark benchmark(kResamplerQualities[q].quality,
+                                kFormats[f], kChannels[c], kInputRates[r], kFrameCounts[n]);
+                        measure(name, benchmark);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+struct MixerConfig {
+    const char     *hook;           // process hook AudioMixer::process__validate() selects
+    size_t          tracks;
+    audio_format_t  trackFormat;
+    uint32_t        trackChannels;
+    uint32_t        trackRate;      // the tracks are resampled if not kSampleRate
+    audio_format_t  mixerFormat;
+    uint32_t        mixerChannels;
+    bool            muted;
+};
+
+static const MixerConfig kMixerConfigs[] = {
+    { "nop",                 1, AUDIO_FORMAT_PCM_16_BIT, 2, 48000, AUDIO_FORMAT_PCM_16_BIT, 2,
+            true },
+    { "NoResampleOneTrack",  1, AUDIO_FORMAT_PCM_16_BIT, 2, 48000, AUDIO_FORMAT_PCM_16_BIT, 2,
+            false },
+    { "NoResampleOneTrack",  1, AUDIO_FORMAT_PCM_16_BIT, 2, 48000, AUDIO_FORMAT_PCM_FLOAT, 2,
+            false },
+    { "NoResampleOneTrack",  1, AUDIO_FORMAT_PCM_FLOAT, 2, 48000, AUDIO_FORMAT_PCM_16_BIT, 2,
+            false },
+    { "NoResampleOneTrack",  1, AUDIO_FORMAT_PCM_FLOAT, 2, 48000, AUDIO_FORMAT_PCM_FLOAT, 2,
+            false },
+    { "NoResampleOneTrack",  1, AUDIO_FORMAT_PCM_FLOAT, 6, 48000, AUDIO_FORMAT_PCM_FLOAT, 6,
+            false },
+    // 5.1 downmixed to stereo by the StereoDownmixBufferProvider of the track
+    { "NoResampleOneTrack",  1, AUDIO_FORMAT_PCM_FLOAT, 6, 48000, AUDIO_FORMAT_PCM_FLOAT, 2,
+            false },
+    // mono tracks are expanded by the track hook, and never get a one track process hook
+    { "genericNoResampling", 1, AUDIO_FORMAT_PCM_16_BIT, 1, 48000, AUDIO_FORMAT_PCM_16_BIT, 2,
+            false },
+    { "genericNoResampling", 4, AUDIO_FORMAT_PCM_16_BIT, 2, 48000, AUDIO_FORMAT_PCM_16_BIT, 2,
+            false },
+    { "genericNoResampling", 4, AUDIO_FORMAT_PCM_FLOAT, 2, 48000, AUDIO_FORMAT_PCM_FLOAT, 2,
+            false },
+    { "genericNoResampling", 4, AUDIO_FORMAT_PCM_FLOAT, 8, 48000, AUDIO_FORMAT_PCM_FLOAT, 8,
+            false },
+    { "genericResampling",   1, AUDIO_FORMAT_PCM_16_BIT, 2, 44100, AUDIO_FORMAT_PCM_16_BIT, 2,
+            false },
+    { "genericResampling",   1, AUDIO_FORMAT_PCM_FLOAT, 2, 44100, AUDIO_FORMAT_PCM_FLOAT, 2,
+            false },
+    { "genericResampling",   4, AUDIO_FORMAT_PCM_FLOAT, 2, 44100, AUDIO_FORMAT_PCM_FLOAT, 2,
+            false },
+    { "genericResampling",   4, AUDIO_FORMAT_PCM_16_BIT, 1, 44100, AUDIO_FORMAT_PCM_FLOAT, 2,
+            false },
+};
+
+class MixerBenchmark : public Benchmark {
+public:
+    MixerBenchmark(const MixerConfig &config, size_t frameCount)
+        : mFrameCount(frameCount),
+          mProviders(config.tracks), // not resized afterwards: SignalProvider owns its buffer
+          mOutput(frameCount * config.mixerChannels * audio_bytes_per_sample(config.mixerFormat))
+    {
+        mMixer = new AudioMixer(frameCount, kSampleRate);
+        const audio_channel_mask_t trackChannelMask =
+                audio_channel_out_mask_from_count(config.trackChannels);
+        const audio_channel_mask_t mixerChannelMask =
+                audio_channel_out_mask_from_count(config.mixerChannels);
+        float volume = config.muted ? 0.f : AudioMixer::UNITY_GAIN_FLOAT / config.tracks;
+        for (size_t i = 0; i < config.tracks; ++i) {
+            setSine(mProviders[i], config.trackFormat, config.trackChannels, config.trackRate,
+                    (double) config.trackRate / kSampleRate);
+            const int name = mMixer->getTrackName(trackChannelMask, config.trackFormat,
+                    AUDIO_SESSION_OUTPUT_MIX);
+            ALOG_ASSERT(name >= 0);
+            mMixer->setBufferProvider(name, &mProviders[i]);
+            mMixer->setParameter(name, AudioMixer::TRACK, AudioMixer::MAIN_BUFFER,
+                    mOutput.data());
+            mMixer->setParameter(name, AudioMixer::TRACK, AudioMixer::MIXER_FORMAT,
+                    (void *)(uintptr_t)config.mixerFormat);
+            mMixer->setParameter(name, AudioMixer::TRACK, AudioMixer::FORMAT,
+                    (void *)(uintptr_t)config.trackFormat);
+            mMixer->setParameter(name, AudioMixer::TRACK, AudioMixer::MIXER_CHANNEL_MASK,
+                    (void *)(uintptr_t)mixerChannelMask);
+            mMixer->setParameter(name, AudioMixer::TRACK, AudioMixer::CHANNEL_MASK,
+                    (void *)(uintptr_t)trackChannelMask);
+            mMixer->setParameter(name, AudioMixer::RESAMPLE, AudioMixer::SAMPLE_RATE,
+                    (void *)(uintptr_t)config.trackRate);
+            // no ramp: the warm up pass leaves the hook selected for the steady state
+            mMixer->setParameter(name, AudioMixer::VOLUME, AudioMixer::VOLUME0, &volume);
+            mMixer->setParameter(name, AudioMixer::VOLUME, AudioMixer::VOLUME1, &volume);
+            mMixer->enable(name);
+        }
+    }
+
+    virtual ~MixerBenchmark()
+    {
+        delete mMixer;
+    }
+
+    virtual void prepare()
+    {
+        for (size_t i = 0; i < mProviders.size(); ++i) {
+            mProviders[i].reset();
+        }
+    }
+
+    virtual size_t run()
+    {
+        size_t frames = 0;
+        for (; frames < kPassFrames; frames += mFrameCount) {
+            mMixer->process();
+        }
+        return frames;
+    }
+
+private:
+    const size_t                mFrameCount;
+    std::vector<SignalProvider> mProviders;
+    std::vector<uint8_t>        mOutput;
+    AudioMixer                 *mMixer;
+};
+
+static void benchmarkMixer()
+{
+    static const size_t kFrameCounts[] = { 240, 960 }; // 5 ms and 20 ms
+    for (size_t i = 0; i < ARRAY_SIZE(kMixerConfigs); ++i) {
+        const MixerConfig &config = kMixerConfigs[i];
+        for (size_t n = 0; n < ARRAY_SIZE(kFrameCounts); ++n) {
+            char name[160];
+            snprintf(name, sizeof(name),
+                    "mixer/%s/tracks:%zu/in:%s/ch:%u/rate:%u/out:%s/ch:%u/frames:%zu",
+                    config.hook, config.tracks, formatName(config.trackFormat),
+                    config.trackChannels, config.trackRate, formatName(config.mixerFormat),
+                    config.mixerChannels, kFrameCounts[n]);
+            if (!selected(name)) {
+                continue;
+            }
+            MixerBenchmark benchmark(config, kFrameCounts[n]);
+            measure(name, benchmark);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class ProviderBenchmark : public Benchmark {
+public:
+    // Pulls frameCount frames at a time from provider, which is deleted with the benchmark,
+    // and reads a sine of format and channels consumed at speed times the output rate.
+    ProviderBenchmark(PassthruBufferProvider *provider, audio_format_t format,
+            uint32_t channels, double speed, size_t frameCount)
+        : mFrameCount(frameCount),
+          mProvider(provider)
+    {
+        setSine(mSource, format, channels, kSampleRate, speed);
+        mProvider->setBufferProvider(&mSource);
+    }
+
+    virtual ~ProviderBenchmark()
+    {
+        delete mProvider;
+    }
+
+    virtual void prepare()
+    {
+        mProvider->reset();
+        mSource.reset();
+    }
+
+    virtual size_t run()
+    {
+        size_t frames = 0;
+        while (frames < kPassFrames) {
+            AudioBufferProvider::Buffer buffer;
+            buffer.frameCount = std::min(mFrameCount, kPassFrames - frames);
+            if (mProvider->getNextBuffer(&buffer) != android::OK || buffer.frameCount == 0) {
+                break;
+            }
+            frames += buffer.frameCount;
+            mProvider->releaseBuffer(&buffer);
+        }
+        return frames;
+    }
+
+private:
+    const size_t            mFrameCount;
+    SignalProvider          mSource;
+    PassthruBufferProvider *mProvider;
+};
+
+// Creates the provider of variant with the given parameters, or returns NULL.
+static PassthruBufferProvider *createProvider(const char *variant, audio_format_t inFormat,
+        audio_format_t outFormat, uint32_t inChannels, uint32_t outChannels,
+        const AudioPlaybackRate &rate, size_t frameCount)
+{
+    const audio_channel_mask_t inMask = audio_channel_out_mask_from_count(inChannels);
+    const audio_channel_mask_t outMask = audio_channel_out_mask_from_count(outChannels);
+    if (!strcmp(variant, "reformat")) {
+        return new ReformatBufferProvider(inChannels, inFormat, outFormat, frameCount);
+    } else if (!strcmp(variant, "remix")) {
+        return new RemixBufferProvider(inMask, outMask, inFormat, frameCount);
+    } else if (!strcmp(variant, "stereodownmix")) {
+        return new StereoDownmixBufferProvider(inMask, frameCount);
+    } else if (!strcmp(variant, "downmix")) {
+        DownmixerBufferProvider *provider = new DownmixerBufferProvider(inMask, outMask,
+                inFormat, kSampleRate, AUDIO_SESSION_OUTPUT_MIX, frameCount);
+        if (!provider->isValid()) { // no downmix effect on this device
+            delete provider;
+            return NULL;
+        }
+        return provider;
+    } else if (!strcmp(variant, "timestretch")) {
+        return new TimestretchBufferProvider(inChannels, inFormat, kSampleRate, rate);
+    }
+    return NULL;
+}
+
+static const struct {
+    const char     *variant;
+    audio_format_t  inFormat;
+    audio_format_t  outFormat;
+    uint32_t        inChannels;
+    uint32_t        outChannels;
+    float           speed;          // timestretch only
+    bool            speech;         // timestretch only, selects the speech stretcher
+} kProviderConfigs[] = {
+    { "reformat", AUDIO_FORMAT_PCM_16_BIT, AUDIO_FORMAT_PCM_FLOAT, 1, 1, 1.f, false },
+    { "reformat", AUDIO_FORMAT_PCM_16_BIT, AUDIO_FORMAT_PCM_FLOAT, 2, 2, 1.f, false },
+    { "reformat", AUDIO_FORMAT_PCM_16_BIT, AUDIO_FORMAT_PCM_FLOAT, 8, 8, 1.f, false },
+    { "reformat", AUDIO_FORMAT_PCM_FLOAT, AUDIO_FORMAT_PCM_16_BIT, 2, 2, 1.f, false },
+    { "remix", AUDIO_FORMAT_PCM_FLOAT, AUDIO_FORMAT_PCM_FLOAT, 1, 2, 1.f, false },
+    { "remix", AUDIO_FORMAT_PCM_FLOAT, AUDIO_FORMAT_PCM_FLOAT, 2, 1, 1.f, false },
+    { "remix", AUDIO_FORMAT_PCM_16_BIT, AUDIO_FORMAT_PCM_16_BIT, 6, 2, 1.f, false },
+    { "stereodownmix", AUDIO_FORMAT_PCM_FLOAT, AUDIO_FORMAT_PCM_FLOAT, 6, 2, 1.f, false },
+    { "stereodownmix", AUDIO_FORMAT_PCM_FLOAT, AUDIO_FORMAT_PCM_FLOAT, 8, 2, 1.f, false },
+    { "downmix", AUDIO_FORMAT_PCM_16_BIT, AUDIO_FORMAT_PCM_16_BIT, 6, 2, 1.f, false },
+    { "timestretch", AUDIO_FORMAT_PCM_16_BIT, AUDIO_FORMAT_PCM_16_BIT, 2, 2, 1.5f, false },
+    { "timestretch", AUDIO_FORMAT_PCM_FLOAT, AUDIO_FORMAT_PCM_FLOAT, 2, 2, 1.5f, false },
+    { "timestretch", AUDIO_FORMAT_PCM_FLOAT, AUDIO_FORMAT_PCM_FLOAT, 2, 2, 2.f, true },
+};
+
+static void benchmarkProviders()
+{
+    static const size_t kFrameCounts[] = { 240, 960 };
+    for (size_t i = 0; i < ARRAY_SIZE(kProviderConfigs); ++i) {
+        AudioPlaybackRate rate = android::AUDIO_PLAYBACK_RATE_DEFAULT;
+        rate.mSpeed = kProviderConfigs[i].speed;
+        if (kProviderConfigs[i].speech) {
+            rate.mStretchMode = android::AUDIO_TIMESTRETCH_STRETCH_SPEECH;
+        }
+        for (size_t n = 0; n < ARRAY_SIZE(kFrameCounts); ++n) {
+            char name[160];
+            snprintf(name, sizeof(name), "provider/%s/%s-%s/ch:%u-%u/speed:%.1f%s/frames:%zu",
+                    kProviderConfigs[i].variant, formatName(kProviderConfigs[i].inFormat),
+                    formatName(kProviderConfigs[i].outFormat), kProviderConfigs[i].inChannels,
+                    kProviderConfigs[i].outChannels, rate.mSpeed,
+                    kProviderConfigs[i].speech ? "/speech" : "", kFrameCounts[n]);
+            if (!selected(name)) {
+                continue;
+            }
+            PassthruBufferProvider *provider = createProvider(kProviderConfigs[i].variant,
+                    kProviderConfigs[i].inFormat, kProviderConfigs[i].outFormat,
+                    kProviderConfigs[i].inChannels, kProviderConfigs[i].outChannels,
+                    rate, kFrameCounts[n]);
+            if (provider == NULL) {
+                fprintf(stderr, "# %s: not available\n", name);
+                continue;
+            }
+            ProviderBenchmark benchmark(provider, kProviderConfigs[i].inFormat,
+                    kProviderConfigs[i].inChannels, rate.mSpeed, kFrameCounts[n]);
+            measure(name, benchmark);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// Times volumeMulti() or volumeRampMulti() of AudioMixerOps.h, or their MixSimd
+// counterparts of AudioMixerOpsSimd.h, without aux buffer.
+// MIXTYPE is un-adjusted: above 2 channels the scalar code uses the volume of channel 0,
+// as the channel dispatch of AudioMixer.cpp does.
+template <int MIXTYPE, int NCHAN, typename TO, typename TI, typename TV>
+class MixerOpsBenchmark : public Benchmark {
+public:
+    static const int SCALAR_MIXTYPE = NCHAN <= 2 ? MIXTYPE
+            : MIXTYPE == android::MIXTYPE_MULTI ? android::MIXTYPE_MULTI_MONOVOL
+            : MIXTYPE == android::MIXTYPE_MULTI_SAVEONLY ? android::MIXTYPE_MULTI_SAVEONLY_MONOVOL
+            : MIXTYPE;
+
+    MixerOpsBenchmark(bool ramp, bool simd, size_t frameCount, TV volume, TV increment)
+        : mRamp(ramp),
+          mSimd(simd),
+          mFrameCount(frameCount),
+          mVolume(volume),
+          mIn(frameCount * (MIXTYPE == android::MIXTYPE_MONOEXPAND ? 1 : NCHAN)),
+          mOut(frameCount * NCHAN)
+    {
+        const size_t inChannels = mIn.size() / frameCount;
+        createSine<TI>(mIn.data(), frameCount, inChannels, kSampleRate, 1000.);
+        for (int i = 0; i < NCHAN; ++i) {
+            mIncrement[i] = increment;
+        }
+        mAvailable = !simd || process(mFrameCount); // MixSimd returns false if not vectorized
+    }
+
+    bool available() const { return mAvailable; }
+
+    virtual void prepare()
+    {
+        memset(mOut.data(), 0, mOut.size() * sizeof(mOut[0]));
+    }
+
+    virtual size_t run()
+    {
+        size_t frames = 0;
+        while (frames < kPassFrames) {
+            const size_t count = std::min(mFrameCount, kPassFrames - frames);
+            process(count);
+            frames += count;
+        }
+        return frames;
+    }
+
+private:
+    // the volume restarts from mVolume for each buffer, so that ramps stay in range
+    bool process(size_t frameCount)
+    {
+        TV vol[NCHAN];
+        for (int i = 0; i < NCHAN; ++i) {
+            vol[i] = mVolume;
+        }
+        if (mSimd) {
+            return mRamp
+                    ? MixSimd<MIXTYPE, TO, TI, TV>::volumeRamp(NCHAN, mOut.data(), frameCount,
+                            mIn.data(), vol, mIncrement)
+                    : MixSimd<MIXTYPE, TO, TI, TV>::volume(NCHAN, mOut.data(), frameCount,
+                            mIn.data(), vol);
+        }
+        float vola = 0.f;
+        if (mRamp) {
+            android::volumeRampMulti<SCALAR_MIXTYPE, NCHAN>(mOut.data(), frameCount,
+                    mIn.data(), (int32_t *) NULL, vol, mIncrement, &vola, 0.f);
+        } else {
+            android::volumeMulti<SCALAR_MIXTYPE, NCHAN>(mOut.data(), frameCount,
+                    mIn.data(), (int32_t *) NULL, vol, vola);
+        }
+        return true;
+    }
+
+    const bool      mRamp;
+    const bool      mSimd;
+    const size_t    mFrameCount;
+    const TV        mVolume;
+    TV              mIncrement[NCHAN];
+    std::vector<TI> mIn;
+    std::vector<TO> mOut;
+    bool            mAvailable;
+};
+
+template <int MIXTYPE, int NCHAN, typename TO, typename TI, typename TV>
+static void benchmarkMixerOps(const char *mixtype, const char *types, bool ramp,
+        TV volume, TV increment)
+{
+    static const size_t kFrameCounts[] = { 64, 256, 1024 };
+    for (size_t n = 0; n < ARRAY_SIZE(kFrameCounts); ++n) {
+        for (int simd = 0; simd <= 1; ++simd) {
+            char name[160];
+            snprintf(name, sizeof(name), "mixerops/%s/%s/%s/%s/ch:%d/frames:%zu",
+                    ramp ? "volumeRampMulti" : "volumeMulti", simd ? "simd" : "scalar",
+                    mixtype, types, NCHAN, kFrameCounts[n]);
+            if (!selected(name)) {
+                continue;
+            }
+            MixerOpsBenchmark<MIXTYPE, NCHAN, TO, TI, TV> benchmark(ramp, simd != 0,
+                    kFrameCounts[n], volume, increment);
+            if (benchmark.available()) {
+                measure(name, benchmark);
+            }
+        }
+    }
+}
+
+// float volume, as used by the AudioMixer with kUseFloat
+template <int MIXTYPE, int NCHAN, typename TO, typename TI>
+static void benchmarkMixerOpsFloatVolume(const char *mixtype, const char *types)
+{
+    benchmarkMixerOps<MIXTYPE, NCHAN, TO, TI, float>(mixtype, types, false, 0.5f, 0.f);
+    benchmarkMixerOps<MIXTYPE, NCHAN, TO, TI, float>(mixtype, types, true, 0.5f, 1e-6f);
+}
+
+// U4.12 constant volume and U4.28 ramps of int16 tracks into a Q4.27 mix buffer,
+// at 1/256 unity gain so that the accumulation of a pass does not overflow.
+template <int MIXTYPE, int NCHAN>
+static void benchmarkMixerOpsIntVolume(const char *mixtype)
+{
+    benchmarkMixerOps<MIXTYPE, NCHAN, int32_t, int16_t, int16_t>(mixtype, "q4_27-i16", false,
+            AudioMixer::UNITY_GAIN_INT >> 8, 0);
+    benchmarkMixerOps<MIXTYPE, NCHAN, int32_t, int16_t, int32_t>(mixtype, "q4_27-i16", true,
+            AudioMixer::UNITY_GAIN_INT << 8, 1);
+}
+
+static void benchmarkAllMixerOps()
+{
+    benchmarkMixerOpsFloatVolume<android::MIXTYPE_MULTI, 1, float, float>("multi", "f32-f32");
+    benchmarkMixerOpsFloatVolume<android::MIXTYPE_MULTI, 2, float, float>("multi", "f32-f32");
+    benchmarkMixerOpsFloatVolume<android::MIXTYPE_MULTI, 8, float, float>("multi", "f32-f32");
+    benchmarkMixerOpsFloatVolume<android::MIXTYPE_MULTI_SAVEONLY, 1, float, float>(
+            "saveonly", "f32-f32");
+    benchmarkMixerOpsFloatVolume<android::MIXTYPE_MULTI_SAVEONLY, 2, float, float>(
+            "saveonly", "f32-f32");
+    benchmarkMixerOpsFloatVolume<android::MIXTYPE_MULTI_SAVEONLY, 8, float, float>(
+            "saveonly", "f32-f32");
+    benchmarkMixerOpsFloatVolume<android::MIXTYPE_MONOEXPAND, 2, float, float>(
+            "monoexpand", "f32-f32");
+    benchmarkMixerOpsFloatVolume<android::MIXTYPE_MULTI, 2, float, int16_t>("multi", "f32-i16");
+    benchmarkMixerOpsFloatVolume<android::MIXTYPE_MULTI_SAVEONLY, 2, float, int16_t>(
+            "saveonly", "f32-i16");
+
+    benchmarkMixerOpsIntVolume<android::MIXTYPE_MULTI, 1>("multi");
+    benchmarkMixerOpsIntVolume<android::MIXTYPE_MULTI, 2>("multi");
+    benchmarkMixerOpsIntVolume<android::MIXTYPE_MULTI, 8>("multi");
+    benchmarkMixerOpsIntVolume<android::MIXTYPE_MONOEXPAND, 2>("monoexpand");
+}
+
+// ----------------------------------------------------------------------------
+
+// Reads the "<name>,<ns per frame>" lines of a previous run.
+static bool readBaseline(const char *path, std::map<std::string, double> &baseline)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char *comma = strrchr(line, ',');
+        if (line[0] == '#' || comma == NULL) {
+            continue;
+        }
+        *comma = '\0';
+        baseline[line] = atof(comma + 1);
+    }
+    fclose(file);
+    return true;
+}
+
+// Returns the number of results slower than their baseline by more than tolerance percent.
+static int compareWithBaseline(const std::map<std::string, double> &baseline, double tolerance)
+{
+    int regressions = 0;
+    size_t compared = 0;
+    for (size_t i = 0; i < gResults.size(); ++i) {
+        std::map<std::string, double>::const_iterator it = baseline.find(gResults[i].first);
+        if (it == baseline.end()) {
+            continue;
+        }
+        ++compared;
+        const double threshold = it->second * (1. + tolerance / 100.);
+        if (gResults[i].second > threshold) {
+            fprintf(stderr, "regression: %s %.3f ns/frame, threshold %.3f (baseline %.3f)\n",
+                    gResults[i].first.c_str(), gResults[i].second, threshold, it->second);
+            ++regressions;
+        }
+    }
+    printf("# %zu of %zu benchmarks compared with the baseline, %d regressions\n",
+            compared, gResults.size(), regressions);
+    return regressions;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "Usage: %s [-p passes] [-f filter] [-t baseline] [-T tolerance]\n", name);
+    fprintf(stderr, "    -p    number of timed passes of each benchmark, the best is reported"
+                    " (default %d)\n", gPasses);
+    fprintf(stderr, "    -f    only run the benchmarks whose name contains filter\n");
+    fprintf(stderr, "    -t    compare with baseline, the output of a previous run, and exit"
+                    " with an error on regressions\n");
+    fprintf(stderr, "    -T    regression tolerance in percent (default 10)\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* const progname = argv[0];
+    const char *baselineFilename = NULL;
+    double tolerance = 10.;
+
+    for (int ch; (ch = getopt(argc, argv, "p:f:t:T:")) != -1;) {
+        switch (ch) {
+        case 'p':
+            gPasses = atoi(optarg);
+            break;
+        case 'f':
+            gFilter = optarg;
+            break;
+        case 't':
+            baselineFilename = optarg;
+            break;
+        case 'T':
+            tolerance = atof(optarg);
+            break;
+        case '?':
+        default:
+            usage(progname);
+            return EXIT_FAILURE;
+        }
+    }
+    if (gPasses < 1 || optind != argc) {
+        usage(progname);
+        return EXIT_FAILURE;
+    }
+
+    std::map<std::string, double> baseline;
+    if (baselineFilename != NULL && !readBaseline(baselineFilename, baseline)) {
+        return EXIT_FAILURE;
+    }
+
+    printf("# benchmark,ns_per_frame\n");
+    benchmarkResamplers();
+    benchmarkMixer();
+    benchmarkProviders();
+    benchmarkAllMixerOps();
+
+    if (baselineFilename != NULL && compareWithBaseline(baseline, tolerance) > 0) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "audioflinger_client_heap_tests"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include <utility>
+#include <gtest/gtest.h>
+#include "ClientHeap.h"
+
+using android::SlabAllocator;
+
+static const size_t kHeapSize = 1024 * 1024;
+
+// check that live allocations don't overlap and are within the heap
+static void checkDisjoint(const std::vector<std::pair<ssize_t, size_t> >& blocks,
+        size_t heapSize)
+{
+    std::vector<std::pair<ssize_t, size_t> > sorted(blocks);
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        ASSERT_GE(sorted[i].first, 0);
+        ASSERT_LE(sorted[i].first + sorted[i].second, heapSize);
+        ASSERT_EQ(0, sorted[i].first % 256);
+        if (i > 0) {
+            ASSERT_LE(sorted[i - 1].first + sorted[i - 1].second, (size_t) sorted[i].first);
+        }
+    }
+}
+
+TEST(audioflinger_client_heap, size_classes) {
+    SlabAllocator allocator(kHeapSize);
+    std::vector<ssize_t> offsets;
+    // a control block plus a power of 2 buffer fits a class without doubling
+    for (size_t i = 0; i < SlabAllocator::kNumClasses; ++i) {
+        const size_t size = (SlabAllocator::kMinClassBytes << i) + 200;
+        EXPECT_EQ(size - 200 + SlabAllocator::kHeaderBytes, SlabAllocator::classBytes(i));
+        ssize_t offset = allocator.allocate(size);
+        ASSERT_GE(offset, 0);
+        offsets.push_back(offset);
+    }
+    SlabAllocator::Stats stats;
+    allocator.getStats(&stats);
+    EXPECT_EQ((uint32_t) SlabAllocator::kNumClasses, stats.mAllocations);
+    for (size_t i = 0; i < SlabAllocator::kNumClasses; ++i) {
+        EXPECT_EQ(1u, stats.mSlabs[i]);
+        EXPECT_EQ(1u, stats.mSlotsUsed[i]);
+    }
+    EXPECT_EQ(0u, stats.mLargeRuns);
+    EXPECT_EQ(kHeapSize, stats.mUsedBytes + stats.mFreeBytes);
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        allocator.deallocate(offsets[i]);
+    }
+}
+
+TEST(audioflinger_client_heap, reuse_after_free) {
+    SlabAllocator allocator(kHeapSize);
+    // fill the heap with slots of the smallest class, then free everything
+    std::vector<ssize_t> offsets;
+    for (;;) {
+        ssize_t offset = allocator.allocate(1000);
+        if (offset < 0) {
+            break;
+        }
+        offsets.push_back(offset);
+    }
+    ASSERT_GT(offsets.size(), 0u);
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        allocator.deallocate(offsets[i]);
+    }
+    SlabAllocator::Stats stats;
+    allocator.getStats(&stats);
+    EXPECT_EQ(0u, stats.mAllocations);
+    EXPECT_EQ(kHeapSize, stats.mFreeBytes);
+    EXPECT_EQ(kHeapSize, stats.mLargestFreeBytes);
+    // the emptied slabs are available to a request for the whole heap
+    ssize_t offset = allocator.allocate(kHeapSize);
+    EXPECT_EQ(0, offset);
+    allocator.deallocate(offset);
+    EXPECT_LT(allocator.allocate(kHeapSize + 1), 0);
+}
+
+TEST(audioflinger_client_heap, churn) {
+    SlabAllocator allocator(kHeapSize);
+    std::vector<std::pair<ssize_t, size_t> > blocks;
+    srand(42);
+    size_t requested = 0;
+    for (int i = 0; i < 20000; ++i) {
+        if (!blocks.empty() && (rand() & 1)) {
+            size_t j = rand() % blocks.size();
+            allocator.deallocate(blocks[j].first);
+            requested -= blocks[j].second;
+            blocks[j] = blocks.back();
+            blocks.pop_back();
+        } else {
+            // typical track and effect sizes: a control block plus a buffer
+            size_t size = 200 + (rand() % 4 == 0 ? rand() % 100000 : 256 << (rand() % 7));
+            ssize_t offset = allocator.allocate(size);
+            if (offset >= 0) {
+                blocks.push_back(std::make_pair(offset, size));
+                requested += size;
+            }
+        }
+        if (i % 1000 == 0) {
+            checkDisjoint(blocks, kHeapSize);
+        }
+    }
+    checkDisjoint(blocks, kHeapSize);
+    SlabAllocator::Stats stats;
+    allocator.getStats(&stats);
+    EXPECT_EQ(blocks.size(), stats.mAllocations);
+    EXPECT_EQ(requested, stats.mRequestedBytes);
+    EXPECT_GE(stats.mUsedBytes, stats.mRequestedBytes);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        allocator.deallocate(blocks[i].first);
+    }
+    allocator.getStats(&stats);
+    EXPECT_EQ(kHeapSize, stats.mLargestFreeBytes);
+}
@@ -32,8 +32,13 @@
 #include <iostream>
 #include <cutils/log.h>
 #include <gtest/gtest.h>
+#include <utils/Debug.h>
 #include <media/AudioBufferProvider.h>
 #include "AudioResampler.h"
+#include "AudioResamplerFirOps.h"
+#include "AudioResamplerFirProcess.h"
+#include "AudioResamplerFirProcessNeon.h"
+#include "AudioResamplerFirProcessAvx2.h"
 #include "test_utils.h"
 
 void resample(int channels, void *output,
@@ -412,3 +417,117 @@ TEST(audioflinger_resampler, stopbandresponse_float_multichannel) {
     }
 }
 
+
+template <typename T>
+static void fillFirRandom(T* data, size_t count, T range)
+{
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = static_cast<T>(rand() % (2 * static_cast<int32_t>(range) + 1) - range);
+    }
+}
+
+static void fillFirRandom(float* data, size_t count, float range)
+{
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = range * (2. * rand() / RAND_MAX - 1.);
+    }
+}
+
+/* SIMD kernel test
+ *
+ * Compares the SIMD dot product kernels selected by STRIDE (NEON with stride 16,
+ * AVX2 with kAvx2Stride) against the portable ProcessBase() kernels (stride 2) on
+ * random coefficients and samples, for every filter length the resampler may use.
+ * Integer AVX2 kernels must be bit-exact; other kernels must be within snrDb.
+ *
+ * TC = filter coefficient type, TI = input type, TO = output type
+ */
+template <int CHANNELS, bool LOCKED, int STRIDE, typename TC, typename TI, typename TO>
+void testFirKernel(TC coefRange, TI sampleRange, const TO* volumeLR, bool exact, double snrDb)
+{
+    static const int kPhases = 63;
+    static const int kCoefShift = 20;
+    const uint32_t phaseWrapLimit = kPhases << kCoefShift;
+
+    for (int halfNumCoefs = 8; halfNumCoefs <= 48; halfNumCoefs += 8) {
+        std::vector<TC> coefs((kPhases + 1) * halfNumCoefs);
+        std::vector<TI> samples(2 * (halfNumCoefs + 1) * CHANNELS);
+        fillFirRandom(&coefs[0], coefs.size(), coefRange);
+        fillFirRandom(&samples[0], samples.size(), sampleRange);
+        const TI* impulse = &samples[halfNumCoefs * CHANNELS];
+
+        double signal = 0.;
+        double noise = 0.;
+        for (int i = 0; i < 1000; ++i) {
+            uint32_t phase = (static_cast<uint32_t>(rand()) << 8 ^ rand()) % phaseWrapLimit;
+            if (LOCKED) {
+                phase = phase >> kCoefShift << kCoefShift;
+            }
+            TO reference[2] = {0, 0};
+            TO test[2] = {0, 0};
+            android::fir<CHANNELS, LOCKED, 2>(reference, phase, phaseWrapLimit,
+                    kCoefShift, halfNumCoefs, &coefs[0], impulse, volumeLR);
+            android::fir<CHANNELS, LOCKED, STRIDE>(test, phase, phaseWrapLimit,
+                    kCoefShift, halfNumCoefs, &coefs[0], impulse, volumeLR);
+            for (int j = 0; j < 2; ++j) {
+                if (exact) {
+                    ASSERT_EQ(reference[j], test[j]);
+                }
+                signal += static_cast<double>(reference[j]) * reference[j];
+                noise += (static_cast<double>(test[j]) - reference[j])
+                        * (static_cast<double>(test[j]) - reference[j]);
+            }
+        }
+        if (noise > 0.) {
+            ASSERT_GT(10. * log10(signal / noise), snrDb);
+        }
+    }
+}
+
+template <int STRIDE>
+void testFirKernels(bool exactInteger)
+{
+    static const int32_t kVolumeInt[2] __attribute__((aligned(8))) = {0x10000000, 0x0c000000};
+    static const float kVolumeFloat[2] __attribute__((aligned(8))) = {1.f, 0.75f};
+
+    // 16b coefficients (DYN_LOW_QUALITY, DYN_MED_QUALITY)
+    testFirKernel<1, true, STRIDE, int16_t, int16_t, int32_t>(
+            4096, 4096, kVolumeInt, exactInteger, 80.);
+    testFirKernel<2, true, STRIDE, int16_t, int16_t, int32_t>(
+            4096, 4096, kVolumeInt, exactInteger, 80.);
+    testFirKernel<1, false, STRIDE, int16_t, int16_t, int32_t>(
+            4096, 4096, kVolumeInt, exactInteger, 80.);
+    testFirKernel<2, false, STRIDE, int16_t, int16_t, int32_t>(
+            4096, 4096, kVolumeInt, exactInteger, 80.);
+
+    // 32b coefficients (DYN_HIGH_QUALITY)
+    testFirKernel<1, true, STRIDE, int32_t, int16_t, int32_t>(
+            1 << 27, 4096, kVolumeInt, exactInteger, 80.);
+    testFirKernel<2, true, STRIDE, int32_t, int16_t, int32_t>(
+            1 << 27, 4096, kVolumeInt, exactInteger, 80.);
+    testFirKernel<1, false, STRIDE, int32_t, int16_t, int32_t>(
+            1 << 27, 4096, kVolumeInt, exactInteger, 80.);
+    testFirKernel<2, false, STRIDE, int32_t, int16_t, int32_t>(
+            1 << 27, 4096, kVolumeInt, exactInteger, 80.);
+
+    // float
+    testFirKernel<1, true, STRIDE, float, float, float>(1.f, 1.f, kVolumeFloat, false, 120.);
+    testFirKernel<2, true, STRIDE, float, float, float>(1.f, 1.f, kVolumeFloat, false, 120.);
+    testFirKernel<1, false, STRIDE, float, float, float>(1.f, 1.f, kVolumeFloat, false, 120.);
+    testFirKernel<2, false, STRIDE, float, float, float>(1.f, 1.f, kVolumeFloat, false, 120.);
+}
+
+TEST(audioflinger_resampler, firkernel_neon) {
+#if USE_NEON
+    testFirKernels<16>(false /* exactInteger */);
+#endif
+}
+
+TEST(audioflinger_resampler, firkernel_avx2) {
+#if USE_AVX2
+    if (!android::resamplerCpuHasAvx2()) {
+        return;
+    }
+    testFirKernels<android::kAvx2Stride>(true /* exactInteger */);
+#endif
+}
@@ -10,3 +10,5 @@ adb root && adb wait-for-device remount
 
 #adb shell /system/bin/resampler_tests
 adb shell /data/nativetest/resampler_tests/resampler_tests
+adb shell /data/nativetest/client_heap_tests/client_heap_tests
+adb shell /data/nativetest/timestretch_tests/timestretch_tests
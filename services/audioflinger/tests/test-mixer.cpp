@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include <inttypes.h>
 #include <math.h>
+#include <time.h>
 #include <vector>
 #include <audio_utils/primitives.h>
 #include <audio_utils/sndfile.h>
@@ -36,16 +37,20 @@
 using namespace android;
 
 static void usage(const char* name) {
-    fprintf(stderr, "Usage: %s [-f] [-m] [-c channels]"
+    fprintf(stderr, "Usage: %s [-f] [-m] [-n] [-c channels]"
                     " [-s sample-rate] [-o <output-file>] [-a <aux-buffer-file>] [-P csv]"
+                    " [-b <iterations>] [-M <cpu-MHz>]"
                     " (<input-file> | <command>)+\n", name);
     fprintf(stderr, "    -f    enable floating point input track by default\n");
     fprintf(stderr, "    -m    enable floating point mixer output\n");
+    fprintf(stderr, "    -n    disable the initial volume ramp\n");
     fprintf(stderr, "    -c    number of mixer output channels\n");
     fprintf(stderr, "    -s    mixer sample-rate\n");
     fprintf(stderr, "    -o    <output-file> WAV file, pcm16 (or float if -m specified)\n");
     fprintf(stderr, "    -a    <aux-buffer-file>\n");
     fprintf(stderr, "    -P    # frames provided per call to resample() in CSV format\n");
+    fprintf(stderr, "    -b    benchmark the mixer process hook over <iterations> passes\n");
+    fprintf(stderr, "    -M    cpu clock in MHz, to report the benchmark in cycles per frame\n");
     fprintf(stderr, "    <input-file> is a WAV file\n");
     fprintf(stderr, "    <command> can be 'sine:[(i|f),]<channels>,<frequency>,<samplerate>'\n");
     fprintf(stderr, "                     'chirp:[(i|f),]<channels>,<samplerate>'\n");
@@ -103,8 +108,10 @@ int main(int argc, char* argv[]) {
     std::vector<int32_t> names;
     std::vector<SignalProvider> providers;
     std::vector<audio_format_t> formats;
+    int benchmarkIterations = 0;
+    double cpuMHz = 0.;
 
-    for (int ch; (ch = getopt(argc, argv, "fmc:s:o:a:P:")) != -1;) {
+    for (int ch; (ch = getopt(argc, argv, "fmnc:s:o:a:P:b:M:")) != -1;) {
         switch (ch) {
         case 'f':
             useInputFloat = true;
@@ -112,6 +119,15 @@ int main(int argc, char* argv[]) {
         case 'm':
             useMixerFloat = true;
             break;
+        case 'n':
+            useRamp = false;
+            break;
+        case 'b':
+            benchmarkIterations = atoi(optarg);
+            break;
+        case 'M':
+            cpuMHz = atof(optarg);
+            break;
         case 'c':
             outputChannels = atoi(optarg);
             break;
@@ -311,6 +327,46 @@ int main(int argc, char* argv[]) {
     }
     outputFrames = i; // reset output frames to the data actually produced.
 
+    // benchmark the process hook selected by process__validate() for the track setup.
+    // The output buffer is reused, so output content is only valid without -b.
+    if (benchmarkIterations > 0 && outputFrames > 0) {
+        struct timespec start, end;
+        size_t framesMixed = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int iter = 0; iter < benchmarkIterations; ++iter) {
+            for (size_t j = 0; j < names.size(); ++j) {
+                providers[j].reset();
+            }
+            for (size_t k = 0; k < outputFrames; k += mixerFrameCount) {
+                for (size_t j = 0; j < names.size(); ++j) {
+                    mixer->setParameter(names[j], AudioMixer::TRACK, AudioMixer::MAIN_BUFFER,
+                            (char *) outputAddr + k * outputFrameSize);
+                    if (auxFilename) {
+                        mixer->setParameter(names[j], AudioMixer::TRACK,
+                                AudioMixer::AUX_BUFFER, (char *) auxAddr + k * auxFrameSize);
+                    }
+                }
+                mixer->process();
+                framesMixed += mixerFrameCount;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        const int64_t elapsedNs = (end.tv_sec - start.tv_sec) * 1000000000LL
+                + (end.tv_nsec - start.tv_nsec);
+        const double nsPerFrame = (double) elapsedNs / framesMixed;
+        const double nsPerTrackFrame = nsPerFrame / names.size();
+        printf("benchmark: tracks:%zu  input:%s  mixer:%s  channels:%u  ramp:%s  aux:%s\n",
+                names.size(), useInputFloat ? "float" : "int16",
+                useMixerFloat ? "float" : "int16", outputChannels,
+                useRamp ? "yes" : "no", auxFilename ? "yes" : "no");
+        printf("benchmark: %zu frames in %" PRId64 " ns: %.2f ns/frame  %.2f ns/track-frame\n",
+                framesMixed, elapsedNs, nsPerFrame, nsPerTrackFrame);
+        if (cpuMHz > 0.) {
+            printf("benchmark: %.2f cycles/frame  %.2f cycles/track-frame @ %.0f MHz\n",
+                    nsPerFrame * cpuMHz * 1e-3, nsPerTrackFrame * cpuMHz * 1e-3, cpuMHz);
+        }
+    }
+
     // write to files
     writeFile(outputFilename, outputAddr,
             outputSampleRate, outputChannels, outputFrames, useMixerFloat);
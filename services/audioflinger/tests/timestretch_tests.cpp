@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "audioflinger_timestretch_tests"
+
+#include <math.h>
+#include <vector>
+#include <gtest/gtest.h>
+#include "TimeStretcher.h"
+
+using android::AUDIO_PLAYBACK_RATE_DEFAULT;
+using android::AUDIO_TIMESTRETCH_STRETCH_SPEECH;
+using android::AudioPlaybackRate;
+using android::TimeStretcher;
+using android::WsolaTimeStretcher;
+
+static const uint32_t kSampleRate = 48000;
+static const uint32_t kChannelCount = 2;
+static const size_t kBlockFrames = 960;     // 20 ms, as delivered by a typical track
+
+// Stretches seconds of a stereo sine at speed, writing blocks as the buffer provider does,
+// and returns the output.
+static std::vector<float> stretchSine(float speed, double frequency, double seconds)
+{
+    TimeStretcher *stretcher = TimeStretcher::create(TimeStretcher::ENGINE_WSOLA,
+            kChannelCount, AUDIO_FORMAT_PCM_FLOAT, kSampleRate);
+    EXPECT_TRUE(stretcher != NULL);
+    stretcher->setSpeed(speed);
+
+    std::vector<float> output;
+    std::vector<float> block(kBlockFrames * kChannelCount);
+    std::vector<float> out(4 * kBlockFrames * kChannelCount);
+    const size_t totalFrames = seconds * kSampleRate;
+    for (size_t frame = 0; frame < totalFrames; frame += kBlockFrames) {
+        for (size_t i = 0; i < kBlockFrames; i++) {
+            const float v = 0.5 * sin(2 * M_PI * frequency * (frame + i) / kSampleRate);
+            block[i * kChannelCount] = v;
+            block[i * kChannelCount + 1] = -v;
+        }
+        EXPECT_TRUE(stretcher->write(block.data(), kBlockFrames));
+        size_t read;
+        while ((read = stretcher->read(out.data(), 4 * kBlockFrames)) > 0) {
+            output.insert(output.end(), out.begin(), out.begin() + read * kChannelCount);
+        }
+    }
+    delete stretcher;
+    return output;
+}
+
+TEST(audioflinger_timestretch, select_engine) {
+    AudioPlaybackRate rate = AUDIO_PLAYBACK_RATE_DEFAULT;
+    rate.mSpeed = 1.5f;
+    EXPECT_EQ(TimeStretcher::ENGINE_SONIC,
+            TimeStretcher::selectEngine(rate, AUDIO_FORMAT_PCM_FLOAT));
+    rate.mStretchMode = AUDIO_TIMESTRETCH_STRETCH_SPEECH;
+    EXPECT_EQ(TimeStretcher::ENGINE_WSOLA,
+            TimeStretcher::selectEngine(rate, AUDIO_FORMAT_PCM_FLOAT));
+    EXPECT_EQ(TimeStretcher::ENGINE_SONIC,
+            TimeStretcher::selectEngine(rate, AUDIO_FORMAT_PCM_16_BIT));
+    rate.mSpeed = (float) WsolaTimeStretcher::kMaxSpeed * 2;
+    EXPECT_EQ(TimeStretcher::ENGINE_SONIC,
+            TimeStretcher::selectEngine(rate, AUDIO_FORMAT_PCM_FLOAT));
+}
+
+TEST(audioflinger_timestretch, wsola_duration) {
+    const double seconds = 4.0;
+    const float speeds[] = { 0.5f, 1.0f, 1.5f, 2.0f, 3.0f };
+    for (size_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++) {
+        const std::vector<float> output = stretchSine(speeds[i], 220.0, seconds);
+        const double expected = seconds * kSampleRate / speeds[i];
+        const double actual = output.size() / kChannelCount;
+        // the stretcher holds back at most a hop and its search range of input
+        EXPECT_NEAR(expected, actual, 0.03 * kSampleRate / speeds[i]) << "speed " << speeds[i];
+    }
+}
+
+TEST(audioflinger_timestretch, wsola_preserves_waveform) {
+    const std::vector<float> output = stretchSine(2.0f, 220.0, 2.0);
+    const size_t frames = output.size() / kChannelCount;
+    ASSERT_GT(frames, kSampleRate / 4);
+    // a stretched sine keeps its amplitude and channel phase, without cross-fade dips
+    double energy = 0;
+    float peak = 0;
+    for (size_t i = 0; i < frames; i++) {
+        const float left = output[i * kChannelCount];
+        const float right = output[i * kChannelCount + 1];
+        EXPECT_FLOAT_EQ(left, -right);
+        energy += left * left;
+        peak = fmaxf(peak, fabsf(left));
+    }
+    const double rms = sqrt(energy / frames);
+    EXPECT_NEAR(0.5 / sqrt(2.0), rms, 0.02);
+    EXPECT_LE(peak, 0.51f);
+}
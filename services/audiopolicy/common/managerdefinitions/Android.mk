@@ -36,7 +36,9 @@ LOCAL_C_INCLUDES := \
 
 ifeq ($(USE_XML_AUDIO_POLICY_CONF), 1)
 
-LOCAL_SRC_FILES += src/Serializer.cpp
+LOCAL_SRC_FILES += \
+    src/Serializer.cpp \
+    src/BinarySerializer.cpp
 
 LOCAL_STATIC_LIBRARIES += libxml2
 
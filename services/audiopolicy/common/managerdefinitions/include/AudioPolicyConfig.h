@@ -80,11 +80,15 @@ public:
         mAvailableOutputDevices.add(availableOutputDevices);
     }
 
+    const VolumeCurvesCollection *getVolumes() const { return mVolumeCurves; }
+
     void setSpeakerDrcEnabled(bool isSpeakerDrcEnabled)
     {
         mIsSpeakerDrcEnabled = isSpeakerDrcEnabled;
     }
 
+    bool isSpeakerDrcEnabled() const { return mIsSpeakerDrcEnabled; }
+
     const HwModuleCollection getHwModules() const { return mHwModules; }
 
     const DeviceVector &getAvailableInputDevices() const
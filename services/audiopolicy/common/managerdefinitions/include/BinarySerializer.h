@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "AudioPolicyConfig.h"
+#include <utils/Errors.h>
+
+namespace android {
+
+/**
+ * Binary snapshot of the audio policy configuration parsed by PolicySerializer.
+ *
+ * Parsing the XML configuration and the module files it includes takes a noticeable part of
+ * the audioserver start. The snapshot is written once the XML has been parsed, and on the next
+ * starts it is mapped and decoded instead, for as long as the build fingerprint and the top level
+ * XML file are unchanged.
+ * The XML file stays the source of truth: a snapshot that is truncated, corrupted, of another
+ * format version, or whose port references do not resolve is rejected, and written again
+ * from the XML.
+ */
+class BinaryPolicySerializer
+{
+public:
+    /**
+     * Loads config from binaryFile, if it was written from xmlFile by this build.
+     * config is left untouched if an error is returned.
+     */
+    status_t deserialize(const char *binaryFile, const char *xmlFile, AudioPolicyConfig &config);
+
+    /** Writes binaryFile from config, as just parsed from xmlFile. */
+    status_t serialize(const char *binaryFile, const char *xmlFile,
+                       const AudioPolicyConfig &config);
+
+    static const uint32_t gMagic;
+    static const uint32_t gVersion; /**< incremented on any change of the snapshot layout. */
+};
+
+}; // namespace android
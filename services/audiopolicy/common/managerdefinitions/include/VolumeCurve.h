@@ -23,6 +23,7 @@
 #include <utils/String8.h>
 #include <utils/SortedVector.h>
 #include <utils/KeyedVector.h>
+#include <utils/Vector.h>
 #include <system/audio.h>
 #include <cutils/config_utils.h>
 #include <string>
@@ -56,14 +57,24 @@ public:
     device_category getDeviceCategory() const { return mDeviceCategory; }
     audio_stream_type_t getStreamType() const { return mStreamType; }
 
-    void add(const CurvePoint &point) { mCurvePoints.add(point); }
+    void add(const CurvePoint &point);
+    const SortedVector<CurvePoint> &getCurvePoints() const { return mCurvePoints; }
 
     float volIndexToDb(int indexInUi, int volIndexMin, int volIndexMax) const;
 
     void dump(int fd) const;
 
 private:
+    // curves with a last point index above this are interpolated on each volIndexToDb() call
+    static const uint32_t kMaxDbTableSize = 1024;
+
+    // interpolates the attenuation in dB of a curve index
+    float interpolateDb(int volIdx) const;
+
     SortedVector<CurvePoint> mCurvePoints;
+    // interpolateDb() of each curve index up to the last point, rebuilt when a point is added:
+    // curves are built at configuration load and then evaluated on every volume change
+    Vector<float> mDbTable;
     device_category mDeviceCategory;
     audio_stream_type_t mStreamType;
 };
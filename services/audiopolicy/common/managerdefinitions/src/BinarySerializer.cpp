@@ -0,0 +1,561 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "APM::BinarySerializer"
+//#define LOG_NDEBUG 0
+
+#include "BinarySerializer.h"
+#include <cutils/properties.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+
+namespace android {
+
+const uint32_t BinaryPolicySerializer::gMagic = 0x42435041; // "APCB"
+const uint32_t BinaryPolicySerializer::gVersion = 1;
+
+// The snapshot is a header followed by 32 bit words in native byte order, as it is only ever
+// read back on the device that wrote it. A string is its length followed by its characters,
+// padded to a word.
+struct SnapshotHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;      /**< number of bytes following the header. */
+    uint32_t checksum;  /**< FNV-1a hash of the bytes following the header. */
+};
+
+enum {
+    DYNAMIC_FORMAT = 1 << 0,
+    DYNAMIC_CHANNELS = 1 << 1,
+    DYNAMIC_RATE = 1 << 2,
+};
+
+static uint32_t checksum(const uint8_t *data, size_t size)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Identifies the XML file a snapshot is written from. The files it includes are only covered by
+// the build fingerprint, so a module file pushed on a development device is not noticed until
+// the snapshot is removed.
+static String8 sourceKey(const char *xmlFile)
+{
+    struct stat st;
+    if (stat(xmlFile, &st) != 0) {
+        return String8();
+    }
+    char fingerprint[PROPERTY_VALUE_MAX];
+    property_get("ro.build.fingerprint", fingerprint, "");
+    return String8::format("%s %lld %lld.%09ld", fingerprint, (long long)st.st_size,
+                           (long long)st.st_mtim.tv_sec, (long)st.st_mtim.tv_nsec);
+}
+
+class SnapshotWriter
+{
+public:
+    void writeWord(uint32_t value) { mData.append((const char *)&value, sizeof(value)); }
+
+    void writeString(const String8 &value)
+    {
+        writeWord(value.length());
+        mData.append(value.string(), value.length());
+        mData.append((sizeof(uint32_t) - value.length() % sizeof(uint32_t)) % sizeof(uint32_t),
+                     '\0');
+    }
+
+    const std::string &data() const { return mData; }
+
+private:
+    std::string mData;
+};
+
+class SnapshotReader
+{
+public:
+    SnapshotReader(const uint8_t *data, size_t size) :
+        mData(data), mEnd(data + size), mFailed(false) {}
+
+    uint32_t readWord()
+    {
+        uint32_t value = 0;
+        if (mFailed || remaining() < sizeof(value)) {
+            mFailed = true;
+            return 0;
+        }
+        memcpy(&value, mData, sizeof(value));
+        mData += sizeof(value);
+        return value;
+    }
+
+    // a count of elements of at least one word each, so that a bad count fails before the
+    // elements are allocated
+    uint32_t readCount()
+    {
+        uint32_t count = readWord();
+        if (count > remaining() / sizeof(uint32_t)) {
+            mFailed = true;
+            return 0;
+        }
+        return count;
+    }
+
+    String8 readString()
+    {
+        uint32_t length = readWord();
+        if (mFailed || length > remaining()) {
+            mFailed = true;
+            return String8();
+        }
+        String8 value((const char *)mData, length);
+        size_t padded = length + (sizeof(uint32_t) - length % sizeof(uint32_t)) % sizeof(uint32_t);
+        mData += padded <= remaining() ? padded : remaining();
+        return value;
+    }
+
+    bool failed() const { return mFailed; }
+    void fail() { mFailed = true; }
+    bool atEnd() const { return mData == mEnd; }
+
+private:
+    size_t remaining() const { return mEnd - mData; }
+
+    const uint8_t *mData;
+    const uint8_t * const mEnd;
+    bool mFailed;
+};
+
+static void writeProfiles(SnapshotWriter &writer, const AudioProfileVector &profiles)
+{
+    writer.writeWord(profiles.size());
+    for (size_t i = 0; i < profiles.size(); i++) {
+        const sp<AudioProfile> &profile = profiles.itemAt(i);
+        writer.writeWord(profile->getFormat());
+        writer.writeWord((profile->isDynamicFormat() ? DYNAMIC_FORMAT : 0) |
+                         (profile->isDynamicChannels() ? DYNAMIC_CHANNELS : 0) |
+                         (profile->isDynamicRate() ? DYNAMIC_RATE : 0));
+        const ChannelsVector &channels = profile->getChannels();
+        writer.writeWord(channels.size());
+        for (size_t j = 0; j < channels.size(); j++) {
+            writer.writeWord(channels[j]);
+        }
+        const SampleRateVector &rates = profile->getSampleRates();
+        writer.writeWord(rates.size());
+        for (size_t j = 0; j < rates.size(); j++) {
+            writer.writeWord(rates[j]);
+        }
+    }
+}
+
+static AudioProfileVector readProfiles(SnapshotReader &reader)
+{
+    AudioProfileVector profiles;
+    uint32_t count = reader.readCount();
+    for (uint32_t i = 0; i < count && !reader.failed(); i++) {
+        audio_format_t format = (audio_format_t)reader.readWord();
+        uint32_t dynamic = reader.readWord();
+        ChannelsVector channels;
+        uint32_t channelCount = reader.readCount();
+        for (uint32_t j = 0; j < channelCount; j++) {
+            channels.add((audio_channel_mask_t)reader.readWord());
+        }
+        SampleRateVector rates;
+        uint32_t rateCount = reader.readCount();
+        for (uint32_t j = 0; j < rateCount; j++) {
+            rates.add(reader.readWord());
+        }
+        sp<AudioProfile> profile = new AudioProfile(format, channels, rates);
+        profile->setDynamicFormat((dynamic & DYNAMIC_FORMAT) != 0);
+        profile->setDynamicChannels((dynamic & DYNAMIC_CHANNELS) != 0);
+        profile->setDynamicRate((dynamic & DYNAMIC_RATE) != 0);
+        profiles.add(profile);
+    }
+    return profiles;
+}
+
+static void writeGains(SnapshotWriter &writer, const AudioGainCollection &gains)
+{
+    writer.writeWord(gains.size());
+    for (size_t i = 0; i < gains.size(); i++) {
+        const sp<AudioGain> &gain = gains.itemAt(i);
+        writer.writeWord(gain->getMode());
+        writer.writeWord(gain->getChannelMask());
+        writer.writeWord(gain->getMinValueInMb());
+        writer.writeWord(gain->getMaxValueInMb());
+        writer.writeWord(gain->getDefaultValueInMb());
+        writer.writeWord(gain->getStepValueInMb());
+        writer.writeWord(gain->getMinRampInMs());
+        writer.writeWord(gain->getMaxRampInMs());
+    }
+}
+
+static AudioGainCollection readGains(SnapshotReader &reader)
+{
+    AudioGainCollection gains;
+    uint32_t count = reader.readCount();
+    for (uint32_t i = 0; i < count && !reader.failed(); i++) {
+        // indexed by position and using the input channel mask, as PolicySerializer does
+        sp<AudioGain> gain = new AudioGain(i, true);
+        gain->setMode((audio_gain_mode_t)reader.readWord());
+        gain->setChannelMask((audio_channel_mask_t)reader.readWord());
+        gain->setMinValueInMb((int32_t)reader.readWord());
+        gain->setMaxValueInMb((int32_t)reader.readWord());
+        gain->setDefaultValueInMb((int32_t)reader.readWord());
+        gain->setStepValueInMb(reader.readWord());
+        gain->setMinRampInMs(reader.readWord());
+        gain->setMaxRampInMs(reader.readWord());
+        gains.add(gain);
+    }
+    return gains;
+}
+
+static void writeModule(SnapshotWriter &writer, const sp<HwModule> &module)
+{
+    writer.writeString(String8(module->getName()));
+    writer.writeWord(module->getHalVersion());
+
+    const IOProfileCollection *mixPorts[] = {
+        &module->getOutputProfiles(), &module->getInputProfiles()
+    };
+    writer.writeWord(mixPorts[0]->size() + mixPorts[1]->size());
+    for (size_t i = 0; i < sizeof(mixPorts) / sizeof(mixPorts[0]); i++) {
+        for (size_t j = 0; j < mixPorts[i]->size(); j++) {
+            const sp<IOProfile> &mixPort = mixPorts[i]->itemAt(j);
+            writer.writeString(mixPort->getName());
+            writer.writeWord(mixPort->getRole());
+            writer.writeWord(mixPort->getFlags());
+            writeProfiles(writer, mixPort->getAudioProfiles());
+            writeGains(writer, mixPort->getGains());
+        }
+    }
+
+    const DeviceVector &devicePorts = module->getDeclaredDevices();
+    writer.writeWord(devicePorts.size());
+    for (size_t i = 0; i < devicePorts.size(); i++) {
+        const sp<DeviceDescriptor> &devicePort = devicePorts.itemAt(i);
+        writer.writeString(devicePort->getTagName());
+        writer.writeWord(devicePort->type());
+        writer.writeString(devicePort->mAddress);
+        writeProfiles(writer, devicePort->getAudioProfiles());
+        writeGains(writer, devicePort->getGains());
+    }
+
+    const AudioRouteVector &routes = module->getRoutes();
+    writer.writeWord(routes.size());
+    for (size_t i = 0; i < routes.size(); i++) {
+        const sp<AudioRoute> &route = routes.itemAt(i);
+        writer.writeWord(route->getType());
+        writer.writeString(route->getSink()->getTagName());
+        const AudioPortVector &sources = route->getSources();
+        writer.writeWord(sources.size());
+        for (size_t j = 0; j < sources.size(); j++) {
+            writer.writeString(sources.itemAt(j)->getTagName());
+        }
+    }
+}
+
+static sp<HwModule> readModule(SnapshotReader &reader)
+{
+    String8 name = reader.readString();
+    uint32_t halVersion = reader.readWord();
+    sp<HwModule> module = new HwModule(name.string(), halVersion);
+
+    IOProfileCollection mixPorts;
+    uint32_t mixPortCount = reader.readCount();
+    for (uint32_t i = 0; i < mixPortCount && !reader.failed(); i++) {
+        String8 mixPortName = reader.readString();
+        audio_port_role_t role = (audio_port_role_t)reader.readWord();
+        if (role != AUDIO_PORT_ROLE_SOURCE && role != AUDIO_PORT_ROLE_SINK) {
+            reader.fail();
+            break;
+        }
+        sp<IOProfile> mixPort = new IOProfile(mixPortName, role);
+        mixPort->setFlags(reader.readWord());
+        mixPort->setAudioProfiles(readProfiles(reader));
+        mixPort->setGains(readGains(reader));
+        mixPorts.add(mixPort);
+    }
+    module->setProfiles(mixPorts);
+
+    DeviceVector devicePorts;
+    uint32_t devicePortCount = reader.readCount();
+    for (uint32_t i = 0; i < devicePortCount && !reader.failed(); i++) {
+        String8 tagName = reader.readString();
+        sp<DeviceDescriptor> devicePort =
+                new DeviceDescriptor((audio_devices_t)reader.readWord(), tagName);
+        devicePort->mAddress = reader.readString();
+        devicePort->setAudioProfiles(readProfiles(reader));
+        devicePort->setGains(readGains(reader));
+        devicePorts.add(devicePort);
+    }
+    module->setDeclaredDevices(devicePorts);
+
+    AudioRouteVector routes;
+    uint32_t routeCount = reader.readCount();
+    for (uint32_t i = 0; i < routeCount && !reader.failed(); i++) {
+        sp<AudioRoute> route = new AudioRoute((audio_route_type_t)reader.readWord());
+        sp<AudioPort> sink = module->findPortByTagName(reader.readString());
+        AudioPortVector sources;
+        uint32_t sourceCount = reader.readCount();
+        for (uint32_t j = 0; j < sourceCount && !reader.failed(); j++) {
+            sp<AudioPort> source = module->findPortByTagName(reader.readString());
+            if (source == 0) {
+                reader.fail();
+                break;
+            }
+            sources.add(source);
+        }
+        if (sink == 0 || reader.failed()) {
+            reader.fail();
+            break;
+        }
+        route->setSink(sink);
+        sink->addRoute(route);
+        for (size_t j = 0; j < sources.size(); j++) {
+            sources.itemAt(j)->addRoute(route);
+        }
+        route->setSources(sources);
+        routes.add(route);
+    }
+    module->setRoutes(routes);
+    return module;
+}
+
+// writes the module index and the tag name of device, which must be declared by a module
+static bool writeDeviceReference(SnapshotWriter &writer, const HwModuleCollection &modules,
+                                 const sp<DeviceDescriptor> &device)
+{
+    for (size_t i = 0; i < modules.size(); i++) {
+        if (modules[i]->getDeclaredDevices().indexOf(device) >= 0) {
+            writer.writeWord(i);
+            writer.writeString(device->getTagName());
+            return true;
+        }
+    }
+    return false;
+}
+
+static sp<DeviceDescriptor> readDeviceReference(SnapshotReader &reader,
+                                                const HwModuleCollection &modules)
+{
+    uint32_t moduleIndex = reader.readWord();
+    String8 tagName = reader.readString();
+    if (reader.failed() || moduleIndex >= modules.size()) {
+        reader.fail();
+        return 0;
+    }
+    sp<DeviceDescriptor> device =
+            modules[moduleIndex]->getDeclaredDevices().getDeviceFromTagName(tagName);
+    if (device == 0) {
+        reader.fail();
+    }
+    return device;
+}
+
+status_t BinaryPolicySerializer::serialize(const char *binaryFile, const char *xmlFile,
+                                           const AudioPolicyConfig &config)
+{
+    String8 key = sourceKey(xmlFile);
+    const VolumeCurvesCollection *volumes = config.getVolumes();
+    if (key.isEmpty() || volumes == NULL) {
+        return BAD_VALUE;
+    }
+    SnapshotWriter writer;
+    writer.writeString(key);
+    writer.writeWord(config.isSpeakerDrcEnabled());
+
+    const HwModuleCollection modules = config.getHwModules();
+    writer.writeWord(modules.size());
+    for (size_t i = 0; i < modules.size(); i++) {
+        writeModule(writer, modules[i]);
+    }
+
+    const DeviceVector *attachedDevices[] = {
+        &config.getAvailableOutputDevices(), &config.getAvailableInputDevices()
+    };
+    writer.writeWord(attachedDevices[0]->size() + attachedDevices[1]->size());
+    for (size_t i = 0; i < sizeof(attachedDevices) / sizeof(attachedDevices[0]); i++) {
+        for (size_t j = 0; j < attachedDevices[i]->size(); j++) {
+            if (!writeDeviceReference(writer, modules, attachedDevices[i]->itemAt(j))) {
+                ALOGW("%s: attached device %s is not declared by any module", __FUNCTION__,
+                      attachedDevices[i]->itemAt(j)->getTagName().string());
+                return BAD_VALUE;
+            }
+        }
+    }
+    const sp<DeviceDescriptor> &defaultOutputDevice = config.getDefaultOutputDevice();
+    writer.writeWord(defaultOutputDevice != 0);
+    if (defaultOutputDevice != 0 &&
+            !writeDeviceReference(writer, modules, defaultOutputDevice)) {
+        return BAD_VALUE;
+    }
+
+    size_t curveCount = 0;
+    for (size_t i = 0; i < volumes->size(); i++) {
+        curveCount += volumes->valueAt(i).size();
+    }
+    writer.writeWord(curveCount);
+    for (size_t i = 0; i < volumes->size(); i++) {
+        const VolumeCurvesForStream &curves = volumes->valueAt(i);
+        for (size_t j = 0; j < curves.size(); j++) {
+            const sp<VolumeCurve> &curve = curves.valueAt(j);
+            writer.writeWord(curve->getStreamType());
+            writer.writeWord(curve->getDeviceCategory());
+            const SortedVector<CurvePoint> &points = curve->getCurvePoints();
+            writer.writeWord(points.size());
+            for (size_t k = 0; k < points.size(); k++) {
+                writer.writeWord(points[k].mIndex);
+                writer.writeWord(points[k].mAttenuationInMb);
+            }
+        }
+    }
+
+    const std::string &data = writer.data();
+    SnapshotHeader header;
+    header.magic = gMagic;
+    header.version = gVersion;
+    header.size = data.size();
+    header.checksum = checksum((const uint8_t *)data.data(), data.size());
+
+    // written aside and renamed, so that a snapshot is never seen partially written
+    String8 tmpFile = String8::format("%s.tmp", binaryFile);
+    int fd = open(tmpFile.string(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        ALOGW("%s: could not create %s: %s", __FUNCTION__, tmpFile.string(), strerror(errno));
+        return -errno;
+    }
+    bool written = write(fd, &header, sizeof(header)) == (ssize_t)sizeof(header) &&
+            write(fd, data.data(), data.size()) == (ssize_t)data.size() &&
+            fsync(fd) == 0;
+    close(fd);
+    if (!written || rename(tmpFile.string(), binaryFile) != 0) {
+        ALOGW("%s: could not write %s: %s", __FUNCTION__, binaryFile, strerror(errno));
+        unlink(tmpFile.string());
+        return INVALID_OPERATION;
+    }
+    ALOGV("%s: wrote %zu bytes to %s", __FUNCTION__, sizeof(header) + data.size(), binaryFile);
+    return NO_ERROR;
+}
+
+status_t BinaryPolicySerializer::deserialize(const char *binaryFile, const char *xmlFile,
+                                             AudioPolicyConfig &config)
+{
+    int fd = open(binaryFile, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        ALOGV("%s: no snapshot %s: %s", __FUNCTION__, binaryFile, strerror(errno));
+        return NAME_NOT_FOUND;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(SnapshotHeader)) {
+        close(fd);
+        ALOGW("%s: %s is truncated", __FUNCTION__, binaryFile);
+        return BAD_VALUE;
+    }
+    size_t size = st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        ALOGW("%s: could not map %s: %s", __FUNCTION__, binaryFile, strerror(errno));
+        return NO_MEMORY;
+    }
+
+    SnapshotHeader header;
+    memcpy(&header, map, sizeof(header));
+    const uint8_t *data = (const uint8_t *)map + sizeof(header);
+    if (header.magic != gMagic || header.version != gVersion ||
+            header.size != size - sizeof(header) ||
+            header.checksum != checksum(data, header.size)) {
+        munmap(map, size);
+        ALOGW("%s: %s is not a valid snapshot of version %u", __FUNCTION__, binaryFile, gVersion);
+        return BAD_VALUE;
+    }
+    SnapshotReader reader(data, header.size);
+    if (reader.readString() != sourceKey(xmlFile)) {
+        munmap(map, size);
+        ALOGV("%s: %s is out of date", __FUNCTION__, binaryFile);
+        return BAD_VALUE;
+    }
+
+    // decoded aside, so that config is only updated with a complete configuration
+    bool isSpeakerDrcEnabled = reader.readWord() != 0;
+
+    HwModuleCollection modules;
+    uint32_t moduleCount = reader.readCount();
+    for (uint32_t i = 0; i < moduleCount && !reader.failed(); i++) {
+        modules.add(readModule(reader));
+    }
+
+    DeviceVector attachedDevices;
+    uint32_t attachedDeviceCount = reader.readCount();
+    for (uint32_t i = 0; i < attachedDeviceCount && !reader.failed(); i++) {
+        sp<DeviceDescriptor> device = readDeviceReference(reader, modules);
+        if (device != 0) {
+            attachedDevices.add(device);
+        }
+    }
+    sp<DeviceDescriptor> defaultOutputDevice;
+    if (reader.readWord() != 0) {
+        defaultOutputDevice = readDeviceReference(reader, modules);
+    }
+
+    VolumeCurvesCollection volumes;
+    uint32_t curveCount = reader.readCount();
+    for (uint32_t i = 0; i < curveCount && !reader.failed(); i++) {
+        audio_stream_type_t stream = (audio_stream_type_t)reader.readWord();
+        device_category category = (device_category)reader.readWord();
+        if (stream >= AUDIO_STREAM_CNT || category >= DEVICE_CATEGORY_CNT) {
+            reader.fail();
+            break;
+        }
+        sp<VolumeCurve> curve = new VolumeCurve(category, stream);
+        uint32_t pointCount = reader.readCount();
+        for (uint32_t j = 0; j < pointCount; j++) {
+            uint32_t index = reader.readWord();
+            curve->add(CurvePoint(index, (int32_t)reader.readWord()));
+        }
+        volumes.add(curve);
+    }
+
+    bool failed = reader.failed() || !reader.atEnd();
+    munmap(map, size);
+    if (failed) {
+        ALOGW("%s: %s does not decode", __FUNCTION__, binaryFile);
+        return BAD_VALUE;
+    }
+
+    config.setHwModules(modules);
+    for (size_t i = 0; i < attachedDevices.size(); i++) {
+        config.addAvailableDevice(attachedDevices[i]);
+    }
+    if (defaultOutputDevice != 0) {
+        config.setDefaultOutputDevice(defaultOutputDevice);
+    }
+    config.setVolumes(volumes);
+    config.setSpeakerDrcEnabled(isSpeakerDrcEnabled);
+    ALOGV("%s: loaded %u modules from %s", __FUNCTION__, moduleCount, binaryFile);
+    return NO_ERROR;
+}
+
+}; // namespace android
@@ -22,6 +22,20 @@
 
 namespace android {
 
+void VolumeCurve::add(const CurvePoint &point)
+{
+    mCurvePoints.add(point);
+
+    mDbTable.clear();
+    uint32_t lastIndex = mCurvePoints[mCurvePoints.size() - 1].mIndex;
+    if (lastIndex < kMaxDbTableSize) {
+        mDbTable.setCapacity(lastIndex + 1);
+        for (uint32_t volIdx = 0; volIdx <= lastIndex; volIdx++) {
+            mDbTable.add(interpolateDb(volIdx));
+        }
+    }
+}
+
 float VolumeCurve::volIndexToDb(int indexInUi, int volIndexMin, int volIndexMax) const
 {
     ALOG_ASSERT(!mCurvePoints.isEmpty(), "Invalid volume curve");
@@ -31,6 +45,16 @@ float VolumeCurve::volIndexToDb(int indexInUi, int volIndexMin, int volIndexMax)
     int nbSteps = 1 + mCurvePoints[nbCurvePoints - 1].mIndex - mCurvePoints[0].mIndex;
     int volIdx = (nbSteps * (indexInUi - volIndexMin)) / (volIndexMax - volIndexMin);
 
+    if (volIdx >= 0 && (size_t)volIdx < mDbTable.size()) {
+        return mDbTable[volIdx];
+    }
+    return interpolateDb(volIdx);
+}
+
+float VolumeCurve::interpolateDb(int volIdx) const
+{
+    size_t nbCurvePoints = mCurvePoints.size();
+
     // Where would this volume index been inserted in the curve point
     size_t indexInUiPosition = mCurvePoints.orderOf(CurvePoint(volIdx, 0));
     if (indexInUiPosition >= nbCurvePoints) {
@@ -25,6 +25,7 @@
 #endif
 
 #define AUDIO_POLICY_XML_CONFIG_FILE "/system/etc/audio_policy_configuration.xml"
+#define AUDIO_POLICY_BINARY_CONFIG_FILE "/data/misc/audioserver/audio_policy_configuration.bin"
 
 #include <inttypes.h>
 #include <math.h>
@@ -44,6 +45,7 @@
 #include <StreamDescriptor.h>
 #endif
 #include <Serializer.h>
+#include <BinarySerializer.h>
 #include "TypeConverter.h"
 #include <policy.h>
 
@@ -99,12 +101,14 @@ status_t AudioPolicyManager::setDeviceConnectionStateInt(audio_devices_t device,
 
             // register new device as available
             index = mAvailableOutputDevices.add(devDesc);
+            invalidateRoutingDecisions();
             if (index >= 0) {
                 sp<HwModule> module = mHwModules.getModuleForDevice(device);
                 if (module == 0) {
                     ALOGD("setDeviceConnectionState() could not find HW module for device %08x",
                           device);
                     mAvailableOutputDevices.remove(devDesc);
+                    invalidateRoutingDecisions();
                     return INVALID_OPERATION;
                 }
                 mAvailableOutputDevices[index]->attach(module);
@@ -114,6 +118,7 @@ status_t AudioPolicyManager::setDeviceConnectionStateInt(audio_devices_t device,
 
             if (checkOutputsForDevice(devDesc, state, outputs, devDesc->mAddress) != NO_ERROR) {
                 mAvailableOutputDevices.remove(devDesc);
+                invalidateRoutingDecisions();
                 return INVALID_OPERATION;
             }
             // Propagate device availability to Engine
@@ -147,6 +152,7 @@ status_t AudioPolicyManager::setDeviceConnectionStateInt(audio_devices_t device,
 
             // remove device from available output devices
             mAvailableOutputDevices.remove(devDesc);
+            invalidateRoutingDecisions();
 
             checkOutputsForDevice(devDesc, state, outputs, devDesc->mAddress);
 
@@ -231,6 +237,7 @@ status_t AudioPolicyManager::setDeviceConnectionStateInt(audio_devices_t device,
             }
 
             index = mAvailableInputDevices.add(devDesc);
+            invalidateRoutingDecisions();
             if (index >= 0) {
                 mAvailableInputDevices[index]->attach(module);
             } else {
@@ -262,6 +269,7 @@ status_t AudioPolicyManager::setDeviceConnectionStateInt(audio_devices_t device,
 
             checkInputsForDevice(devDesc, state, inputs, devDesc->mAddress);
             mAvailableInputDevices.remove(devDesc);
+            invalidateRoutingDecisions();
 
             // Propagate device availability to Engine
             mEngine->setDeviceConnectionState(devDesc, state);
@@ -473,6 +481,7 @@ void AudioPolicyManager::setPhoneState(audio_mode_t state)
         ALOGW("setPhoneState() invalid or same state %d", state);
         return;
     }
+    invalidateRoutingDecisions();
     /// Opens: can these line be executed after the switch of volume curves???
     // if leaving call state, handle special case of active streams
     // pertaining to sonification strategy see handleIncallSonification()
@@ -584,6 +593,7 @@ void AudioPolicyManager::setForceUse(audio_policy_force_use_t usage,
         ALOGW("setForceUse() could not set force cfg %d for usage %d", config, usage);
         return;
     }
+    invalidateRoutingDecisions();
     bool forceVolumeReeval = (usage == AUDIO_POLICY_FORCE_FOR_COMMUNICATION) ||
             (usage == AUDIO_POLICY_FORCE_FOR_DOCK) ||
             (usage == AUDIO_POLICY_FORCE_FOR_SYSTEM);
@@ -1179,6 +1189,7 @@ status_t AudioPolicyManager::startSource(sp<AudioOutputDescriptor> outputDesc,
     // NOTE that the usage count is the same for duplicated output and hardware output which is
     // necessary for a correct control of hardware output routing by startOutput() and stopOutput()
     outputDesc->changeRefCount(stream, 1);
+    invalidateRoutingDecisions();
 
     if (outputDesc->mRefCount[stream] == 1 || device != AUDIO_DEVICE_NONE) {
         // starting an output being rerouted?
@@ -1301,6 +1312,7 @@ status_t AudioPolicyManager::stopSource(sp<AudioOutputDescriptor> outputDesc,
     if (outputDesc->mRefCount[stream] > 0) {
         // decrement usage count of this stream on the output
         outputDesc->changeRefCount(stream, -1);
+        invalidateRoutingDecisions();
 
         // store time at which the stream was stopped - see isStreamActive()
         if (outputDesc->mRefCount[stream] == 0 || forceDeviceUpdate) {
@@ -2288,6 +2300,9 @@ status_t AudioPolicyManager::dump(int fd)
     result.append(buffer);
     snprintf(buffer, SIZE, " Master mono: %s\n", mMasterMono ? "on" : "off");
     result.append(buffer);
+    snprintf(buffer, SIZE, " Routing decisions: generation %u, %u hits, %u misses\n",
+            mRoutingGeneration, mRoutingDecisionHits, mRoutingDecisionMisses);
+    result.append(buffer);
 
     write(fd, result.string(), result.size());
 
@@ -3180,12 +3195,34 @@ uint32_t AudioPolicyManager::nextAudioPortGeneration()
     return android_atomic_inc(&mAudioPortGeneration);
 }
 
+#ifdef USE_XML_AUDIO_POLICY_CONF
+// Loads the XML configuration from its binary snapshot if it is up to date, otherwise parses the
+// XML and snapshots the result for the next start.
+static status_t deserializeAudioPolicyXmlConfig(AudioPolicyConfig &config)
+{
+    BinaryPolicySerializer binarySerializer;
+    if (binarySerializer.deserialize(AUDIO_POLICY_BINARY_CONFIG_FILE,
+                                     AUDIO_POLICY_XML_CONFIG_FILE, config) == NO_ERROR) {
+        return NO_ERROR;
+    }
+    PolicySerializer serializer;
+    status_t status = serializer.deserialize(AUDIO_POLICY_XML_CONFIG_FILE, config);
+    if (status == NO_ERROR) {
+        binarySerializer.serialize(AUDIO_POLICY_BINARY_CONFIG_FILE,
+                                   AUDIO_POLICY_XML_CONFIG_FILE, config);
+    }
+    return status;
+}
+#endif
+
 AudioPolicyManager::AudioPolicyManager(AudioPolicyClientInterface *clientInterface)
     :
 #ifdef AUDIO_POLICY_TEST
     Thread(false),
 #endif //AUDIO_POLICY_TEST
-    mLimitRingtoneVolume(false), mLastVoiceVolume(-1.0f),
+    mLimitRingtoneVolume(false),
+    mRoutingGeneration(1), mRoutingDecisionHits(0), mRoutingDecisionMisses(0),
+    mLastVoiceVolume(-1.0f),
     mA2dpSuspended(false),
     mAudioPortGeneration(1),
     mBeaconMuteRefCount(0),
@@ -3196,6 +3233,9 @@ AudioPolicyManager::AudioPolicyManager(AudioPolicyClientInterface *clientInterfa
 {
     mUidCached = getuid();
     mpClientInterface = clientInterface;
+    for (int i = 0; i < NUM_STRATEGIES; i++) {
+        mRoutingDecisionGeneration[i] = 0;
+    }
 
     // TODO: remove when legacy conf file is removed. true on devices that use DRC on the
     // DEVICE_CATEGORY_SPEAKER path to boost soft sounds, used to adjust volume curves accordingly.
@@ -3207,8 +3247,7 @@ AudioPolicyManager::AudioPolicyManager(AudioPolicyClientInterface *clientInterfa
     AudioPolicyConfig config(mHwModules, mAvailableOutputDevices, mAvailableInputDevices,
                              mDefaultOutputDevice, speakerDrcEnabled,
                              static_cast<VolumeCurvesCollection *>(mVolumeCurves));
-    PolicySerializer serializer;
-    if (serializer.deserialize(AUDIO_POLICY_XML_CONFIG_FILE, config) != NO_ERROR) {
+    if (deserializeAudioPolicyXmlConfig(config) != NO_ERROR) {
 #else
     mVolumeCurves = new StreamDescriptorCollection();
     AudioPolicyConfig config(mHwModules, mAvailableOutputDevices, mAvailableInputDevices,
@@ -3637,6 +3676,7 @@ void AudioPolicyManager::addOutput(audio_io_handle_t output, sp<SwAudioOutputDes
 {
     outputDesc->setIoHandle(output);
     mOutputs.add(output, outputDesc);
+    invalidateRoutingDecisions();
     updateMono(output); // update mono status when adding to output list
     nextAudioPortGeneration();
 }
@@ -3644,6 +3684,7 @@ void AudioPolicyManager::addOutput(audio_io_handle_t output, sp<SwAudioOutputDes
 void AudioPolicyManager::removeOutput(audio_io_handle_t output)
 {
     mOutputs.removeItem(output);
+    invalidateRoutingDecisions();
 }
 
 void AudioPolicyManager::addInput(audio_io_handle_t input, sp<AudioInputDescriptor> inputDesc)
@@ -4102,6 +4143,7 @@ void AudioPolicyManager::closeOutput(audio_io_handle_t output)
             for (int j = 0; j < AUDIO_STREAM_CNT; j++) {
                 int refCount = dupOutputDesc->mRefCount[j];
                 outputDesc2->changeRefCount((audio_stream_type_t)j,-refCount);
+                invalidateRoutingDecisions();
             }
             audio_io_handle_t duplicatedOutput = mOutputs.keyAt(i);
             ALOGV("closeOutput() closing also duplicated output %d", duplicatedOutput);
@@ -4556,7 +4598,17 @@ audio_devices_t AudioPolicyManager::getDeviceForStrategy(routing_strategy strate
               strategy, mDeviceForStrategy[strategy]);
         return mDeviceForStrategy[strategy];
     }
-    return mEngine->getDeviceForStrategy(strategy);
+    // STRATEGY_SONIFICATION_RESPECTFUL depends on how recently music was played, which is not
+    // tracked by mRoutingGeneration, so it is always evaluated
+    if (strategy != STRATEGY_SONIFICATION_RESPECTFUL &&
+            mRoutingDecisionGeneration[strategy] == mRoutingGeneration) {
+        mRoutingDecisionHits++;
+        return mRoutingDecision[strategy];
+    }
+    mRoutingDecisionMisses++;
+    mRoutingDecision[strategy] = mEngine->getDeviceForStrategy(strategy);
+    mRoutingDecisionGeneration[strategy] = mRoutingGeneration;
+    return mRoutingDecision[strategy];
 }
 
 void AudioPolicyManager::updateDevicesAndOutputs()
@@ -4684,6 +4736,7 @@ uint32_t AudioPolicyManager::setOutputDevice(const sp<AudioOutputDescriptor>& ou
 
     if (device != AUDIO_DEVICE_NONE) {
         outputDesc->mDevice = device;
+        invalidateRoutingDecisions();
     }
     muteWaitMs = checkDeviceMuteStrategies(outputDesc, prevDevice, delayMs);
 
@@ -288,6 +288,8 @@ protected:
         // "future" device selection (fromCache == false) when called from a context
         //  where conditions are changing (setDeviceConnectionState(), setPhoneState()...) AND
         //  before updateDevicesAndOutputs() is called.
+        // if fromCache is false, the engine decision is still memoized in mRoutingDecision[]
+        // until invalidateRoutingDecisions() is called.
         virtual audio_devices_t getDeviceForStrategy(routing_strategy strategy,
                                                      bool fromCache);
 
@@ -531,6 +533,13 @@ protected:
 
         bool    mLimitRingtoneVolume;        // limit ringtone volume to music volume if headset connected
         audio_devices_t mDeviceForStrategy[NUM_STRATEGIES];
+        // last mEngine->getDeviceForStrategy() result for each strategy, valid while
+        // mRoutingDecisionGeneration[strategy] equals mRoutingGeneration
+        audio_devices_t mRoutingDecision[NUM_STRATEGIES];
+        uint32_t mRoutingDecisionGeneration[NUM_STRATEGIES];
+        uint32_t mRoutingGeneration;     // see invalidateRoutingDecisions()
+        uint32_t mRoutingDecisionHits;   // getDeviceForStrategy() calls served from
+        uint32_t mRoutingDecisionMisses; // mRoutingDecision[] or from the engine
         float   mLastVoiceVolume;            // last voice volume value sent to audio HAL
 
         EffectDescriptorCollection mEffects;  // list of registered audio effects
@@ -583,6 +592,10 @@ protected:
 
         uint32_t nextAudioPortGeneration();
 
+        // must be called after any change of the state the engine routing decisions depend on:
+        // available devices, phone state, forced usages, outputs, their devices and activity
+        void invalidateRoutingDecisions() { mRoutingGeneration++; }
+
         // Audio Policy Engine Interface.
         AudioPolicyManagerInterface *mEngine;
 private:
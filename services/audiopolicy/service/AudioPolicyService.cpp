@@ -77,6 +77,8 @@ void AudioPolicyService::onFirstRef()
         mAudioCommandThread = new AudioCommandThread(String8("ApmAudio"), this);
         // start output activity command thread
         mOutputCommandThread = new AudioCommandThread(String8("ApmOutput"), this);
+        // start HAL parameters command thread
+        mParametersCommandThread = new AudioCommandThread(String8("ApmParams"), this);
 
 #ifdef USE_LEGACY_AUDIO_POLICY
         ALOGI("AudioPolicyService CSTOR in legacy mode");
@@ -126,6 +128,7 @@ AudioPolicyService::~AudioPolicyService()
     mTonePlaybackThread->exit();
     mAudioCommandThread->exit();
     mOutputCommandThread->exit();
+    mParametersCommandThread->exit();
 
 #ifdef USE_LEGACY_AUDIO_POLICY
     if (mpAudioPolicy != NULL && mpAudioPolicyDev != NULL) {
@@ -368,6 +371,8 @@ status_t AudioPolicyService::dumpInternals(int fd)
     result.append(buffer);
     snprintf(buffer, SIZE, "Tones Thread: %p\n", mTonePlaybackThread.get());
     result.append(buffer);
+    snprintf(buffer, SIZE, "Parameters Thread: %p\n", mParametersCommandThread.get());
+    result.append(buffer);
 
     write(fd, result.string(), result.size());
     return NO_ERROR;
@@ -391,6 +396,9 @@ status_t AudioPolicyService::dump(int fd, const Vector<String16>& args __unused)
         if (mTonePlaybackThread != 0) {
             mTonePlaybackThread->dump(fd);
         }
+        if (mParametersCommandThread != 0) {
+            mParametersCommandThread->dump(fd);
+        }
 
 #ifdef USE_LEGACY_AUDIO_POLICY
         if (mpAudioPolicy) {
@@ -496,6 +504,9 @@ bool AudioPolicyService::AudioCommandThread::threadLoop()
                     command->mStatus = AudioSystem::setStreamVolume(data->mStream,
                                                                     data->mVolume,
                                                                     data->mIO);
+                    ALOGW_IF(command->mStatus != NO_ERROR,
+                            "AudioCommandThread() set volume stream %d output %d failed %d",
+                            data->mStream, data->mIO, command->mStatus);
                     }break;
                 case SET_PARAMETERS: {
                     ParametersData *data = (ParametersData *)command->mParam.get();
@@ -508,6 +519,8 @@ bool AudioPolicyService::AudioCommandThread::threadLoop()
                     ALOGV("AudioCommandThread() processing set voice volume volume %f",
                             data->mVolume);
                     command->mStatus = AudioSystem::setVoiceVolume(data->mVolume);
+                    ALOGW_IF(command->mStatus != NO_ERROR,
+                            "AudioCommandThread() set voice volume failed %d", command->mStatus);
                     }break;
                 case STOP_OUTPUT: {
                     StopOutputData *data = (StopOutputData *)command->mParam.get();
@@ -728,7 +741,9 @@ status_t AudioPolicyService::AudioCommandThread::volumeCommand(audio_stream_type
     data->mVolume = volume;
     data->mIO = output;
     command->mParam = data;
-    command->mWaitStatus = true;
+    // not waited for: the callers ignore the status, and must not be held by the commands
+    // queued before this one
+    command->mWaitStatus = false;
     ALOGV("AudioCommandThread() adding set volume stream %d, volume %f, output %d",
             stream, volume, output);
     return sendCommand(command, delayMs);
@@ -757,7 +772,7 @@ status_t AudioPolicyService::AudioCommandThread::voiceVolumeCommand(float volume
     sp<VoiceVolumeData> data = new VoiceVolumeData();
     data->mVolume = volume;
     command->mParam = data;
-    command->mWaitStatus = true;
+    command->mWaitStatus = false;   // see volumeCommand()
     ALOGV("AudioCommandThread() adding set voice volume volume %f", volume);
     return sendCommand(command, delayMs);
 }
@@ -1072,6 +1087,22 @@ void AudioPolicyService::AudioCommandThread::insertCommand_l(sp<AudioCommand>& c
     }
     removedCommands.clear();
 
+    // last writer wins: an immediate volume command updates a pending volume command for the
+    // same stream and output instead of being queued behind it
+    if (command->mCommand == SET_VOLUME && delayMs == 0) {
+        VolumeData *data = (VolumeData *)command->mParam.get();
+        for (ssize_t j = i; j >= 0; j--) {
+            sp<AudioCommand> command2 = mAudioCommands[j];
+            if (command2->mCommand != SET_VOLUME) continue;
+            VolumeData *data2 = (VolumeData *)command2->mParam.get();
+            if (data->mIO != data2->mIO || data->mStream != data2->mStream) continue;
+            ALOGV("Updating pending volume command on output %d for stream %d to %f",
+                    data->mIO, data->mStream, data->mVolume);
+            data2->mVolume = data->mVolume;
+            return;
+        }
+    }
+
     // Disable wait for status if delay is not 0.
     // Except for create audio patch command because the returned patch handle
     // is needed by audio policy manager
@@ -1113,8 +1144,8 @@ void AudioPolicyService::setParameters(audio_io_handle_t ioHandle,
                                        const char *keyValuePairs,
                                        int delayMs)
 {
-    mAudioCommandThread->parametersCommand(ioHandle, keyValuePairs,
-                                           delayMs);
+    mParametersCommandThread->parametersCommand(ioHandle, keyValuePairs,
+                                                delayMs);
 }
 
 int AudioPolicyService::setStreamVolume(audio_stream_type_t stream,
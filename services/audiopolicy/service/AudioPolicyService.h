@@ -574,6 +574,9 @@ private:
     sp<AudioCommandThread> mAudioCommandThread;     // audio commands thread
     sp<AudioCommandThread> mTonePlaybackThread;     // tone playback thread
     sp<AudioCommandThread> mOutputCommandThread;    // process stop and release output
+    // parameters are set on the HAL, which can be slow (e.g. A2DP): they have their own thread
+    // so that they do not delay volume and patch commands
+    sp<AudioCommandThread> mParametersCommandThread;
     struct audio_policy_device *mpAudioPolicyDev;
     struct audio_policy *mpAudioPolicy;
     AudioPolicyInterface *mAudioPolicyManager;
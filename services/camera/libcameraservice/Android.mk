@@ -52,7 +52,8 @@ LOCAL_SRC_FILES :=  \
     gui/RingBufferConsumer.cpp \
     utils/CameraTraces.cpp \
     utils/AutoConditionLock.cpp \
-    utils/TagMonitor.cpp
+    utils/TagMonitor.cpp \
+    utils/FrameTimeline.cpp
 
 LOCAL_SHARED_LIBRARIES:= \
     libui \
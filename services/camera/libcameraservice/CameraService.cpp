@@ -865,10 +865,8 @@ Status CameraService::getLegacyParametersLazy(int cameraId,
 
     String8 id = String8::format("%d", cameraId);
 
-    // Check if we already have parameters
+    // Check if we already have parameters without mServiceLock, so this does not wait on connects
     {
-        // Scope for service lock
-        Mutex::Autolock lock(mServiceLock);
         auto cameraState = getCameraState(id);
         if (cameraState == nullptr) {
             ALOGE("%s: Invalid camera ID: %s", __FUNCTION__, id.string());
@@ -892,8 +890,6 @@ Status CameraService::getLegacyParametersLazy(int cameraId,
 
     // Check for parameters again
     {
-        // Scope for service lock
-        Mutex::Autolock lock(mServiceLock);
         auto cameraState = getCameraState(id);
         if (cameraState == nullptr) {
             ALOGE("%s: Invalid camera ID: %s", __FUNCTION__, id.string());
@@ -2329,10 +2325,12 @@ int32_t CameraService::CameraState::getStatus() const {
 }
 
 CameraParameters CameraService::CameraState::getShimParams() const {
+    Mutex::Autolock lock(mShimParamsLock);
     return mShimParams;
 }
 
 void CameraService::CameraState::setShimParams(const CameraParameters& params) {
+    Mutex::Autolock lock(mShimParamsLock);
     mShimParams = params;
 }
 
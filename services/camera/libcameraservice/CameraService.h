@@ -456,11 +456,15 @@ private:
         /**
          * Return the last set CameraParameters object generated from the information returned by
          * the HAL for this device (or an empty CameraParameters object if none has been set).
+         *
+         * This method acquires mShimParamsLock.
          */
         CameraParameters getShimParams() const;
 
         /**
          * Set the CameraParameters for this device.
+         *
+         * This method acquires mShimParamsLock.
          */
         void setShimParams(const CameraParameters& params);
 
@@ -485,6 +489,9 @@ private:
         const int mCost;
         std::set<String8> mConflicting;
         mutable Mutex mStatusLock;
+        // Guards mShimParams so that queries do not need mServiceLock, which connect holds
+        // while the HAL opens the device
+        mutable Mutex mShimParamsLock;
         CameraParameters mShimParams;
     }; // class CameraState
 
@@ -1493,6 +1493,13 @@ status_t Camera2Client::setParameters(const String8& params) {
 
     SharedParameters::Lock l(mParameters);
 
+    // Apps commonly set back what they got, e.g. on every zoom step even when
+    // the zoom did not change. Nothing to validate or rebuild in that case.
+    if (params == l.mParameters.get()) {
+        ALOGV("%s: Camera %d: Parameters unchanged", __FUNCTION__, mCameraId);
+        return OK;
+    }
+
     Parameters::focusMode_t focusModeBefore = l.mParameters.focusMode;
     res = l.mParameters.set(params);
     if (res != OK) return res;
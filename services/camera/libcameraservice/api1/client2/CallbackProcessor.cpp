@@ -465,10 +465,16 @@ status_t CallbackProcessor::convertFromFlexibleYuv(int32_t previewFormat,
     // Copy Y plane, adjusting for stride
     const uint8_t *ySrc = src.data;
     uint8_t *yDst = dst;
-    for (size_t row = 0; row < src.height; row++) {
-        memcpy(yDst, ySrc, src.width);
-        ySrc += src.stride;
-        yDst += dstYStride;
+    if (src.stride == dstYStride && src.height > 0) {
+        // Same layout, the padding can be copied along with the rows
+        memcpy(yDst, ySrc, src.stride * (src.height - 1) + src.width);
+        yDst += dstYStride * src.height;
+    } else {
+        for (size_t row = 0; row < src.height; row++) {
+            memcpy(yDst, ySrc, src.width);
+            ySrc += src.stride;
+            yDst += dstYStride;
+        }
     }
 
     // Copy/swizzle chroma planes, 4:2:0 subsampling
@@ -487,10 +493,26 @@ status_t CallbackProcessor::convertFromFlexibleYuv(int32_t previewFormat,
         if (cbSrc == crSrc + 1 && src.chromaStep == 2) {
             ALOGV("%s: Fast NV21->NV21", __FUNCTION__);
             // Source has semiplanar CrCb chroma layout, can copy by rows
+            if (src.chromaStride == src.width) {
+                memcpy(crcbDst, crSrc, src.width * chromaHeight);
+            } else {
+                for (size_t row = 0; row < chromaHeight; row++) {
+                    memcpy(crcbDst, crSrc, src.width);
+                    crcbDst += src.width;
+                    crSrc += src.chromaStride;
+                }
+            }
+        } else if (crSrc == cbSrc + 1 && src.chromaStep == 2) {
+            ALOGV("%s: Fast NV12->NV21", __FUNCTION__);
+            // Source has semiplanar CbCr chroma layout, only swap each pair.
+            // Fixed offsets let the compiler vectorize the inner loop.
             for (size_t row = 0; row < chromaHeight; row++) {
-                memcpy(crcbDst, crSrc, src.width);
+                for (size_t col = 0; col < chromaWidth; col++) {
+                    crcbDst[2 * col] = cbSrc[2 * col + 1];
+                    crcbDst[2 * col + 1] = cbSrc[2 * col];
+                }
                 crcbDst += src.width;
-                crSrc += src.chromaStride;
+                cbSrc += src.chromaStride;
             }
         } else {
             ALOGV("%s: Generic->NV21", __FUNCTION__);
@@ -525,6 +547,20 @@ status_t CallbackProcessor::convertFromFlexibleYuv(int32_t previewFormat,
                 cbDst += dstCStride;
                 cbSrc += src.chromaStride;
             }
+        } else if (src.chromaStep == 2 &&
+                (cbSrc == crSrc + 1 || crSrc == cbSrc + 1)) {
+            ALOGV("%s: Fast semiplanar->YV12", __FUNCTION__);
+            // Source has semiplanar chroma layout, deinterleave by row
+            for (size_t row = 0; row < chromaHeight; row++) {
+                for (size_t col = 0; col < chromaWidth; col++) {
+                    crDst[col] = crSrc[2 * col];
+                    cbDst[col] = cbSrc[2 * col];
+                }
+                crSrc += src.chromaStride;
+                cbSrc += src.chromaStride;
+                crDst += dstCStride;
+                cbDst += dstCStride;
+            }
         } else {
             ALOGV("%s: Generic->YV12", __FUNCTION__);
             // Generic copy, always works but not very efficient
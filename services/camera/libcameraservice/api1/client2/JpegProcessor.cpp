@@ -42,9 +42,8 @@ JpegProcessor::JpegProcessor(
         mDevice(client->getCameraDevice()),
         mSequencer(sequencer),
         mId(client->getCameraId()),
-        mCaptureDone(false),
-        mCaptureSuccess(false),
-        mCaptureStreamId(NO_STREAM) {
+        mCaptureStreamId(NO_STREAM),
+        mCaptureHeapSize(0) {
 }
 
 JpegProcessor::~JpegProcessor() {
@@ -55,11 +54,8 @@ JpegProcessor::~JpegProcessor() {
 void JpegProcessor::onFrameAvailable(const BufferItem& /*item*/) {
     Mutex::Autolock l(mInputMutex);
     ALOGV("%s", __FUNCTION__);
-    if (!mCaptureDone) {
-        mCaptureDone = true;
-        mCaptureSuccess = true;
-        mCaptureDoneSignal.signal();
-    }
+    mPendingCaptures.push_back(true);
+    mCaptureDoneSignal.signal();
 }
 
 void JpegProcessor::onBufferAcquired(const BufferInfo& /*bufferInfo*/) {
@@ -76,8 +72,7 @@ void JpegProcessor::onBufferReleased(const BufferInfo& bufferInfo) {
         // b/29524651
         ALOGV("%s: JPEG buffer lost", __FUNCTION__);
         Mutex::Autolock l(mInputMutex);
-        mCaptureDone = true;
-        mCaptureSuccess = false;
+        mPendingCaptures.push_back(false);
         mCaptureDoneSignal.signal();
     }
 }
@@ -117,22 +112,30 @@ status_t JpegProcessor::updateStream(const Parameters &params) {
     // Since ashmem heaps are rounded up to page size, don't reallocate if
     // the capture heap isn't exactly the same size as the required JPEG buffer
     const size_t HEAP_SLACK_FACTOR = 2;
-    if (mCaptureHeap == 0 ||
-            (mCaptureHeap->getSize() < static_cast<size_t>(maxJpegSize)) ||
-            (mCaptureHeap->getSize() >
-                    static_cast<size_t>(maxJpegSize) * HEAP_SLACK_FACTOR) ) {
-        // Create memory for API consumption
-        mCaptureHeap.clear();
-        mCaptureHeap =
+    for (size_t i = mCaptureHeaps.size(); i > 0; i--) {
+        size_t heapSize = mCaptureHeaps[i - 1].mHeap->getSize();
+        if (heapSize < static_cast<size_t>(maxJpegSize) ||
+                heapSize > static_cast<size_t>(maxJpegSize) * HEAP_SLACK_FACTOR) {
+            mCaptureHeaps.removeAt(i - 1);
+        }
+    }
+    mCaptureHeapSize = maxJpegSize;
+    if (mCaptureHeaps.size() == 0) {
+        // Create memory for API consumption. More heaps are only added when
+        // captures come in faster than the client releases them.
+        CaptureHeap captureHeap;
+        captureHeap.mHeap =
                 new MemoryHeapBase(maxJpegSize, 0, "Camera2Client::CaptureHeap");
-        if (mCaptureHeap->getSize() == 0) {
+        captureHeap.mLastUsed = 0;
+        if (captureHeap.mHeap->getSize() == 0) {
             ALOGE("%s: Camera %d: Unable to allocate memory for capture",
                     __FUNCTION__, mId);
             return NO_MEMORY;
         }
+        mCaptureHeaps.push_back(captureHeap);
     }
     ALOGV("%s: Camera %d: JPEG capture heap now %zu bytes; requested %zd bytes",
-            __FUNCTION__, mId, mCaptureHeap->getSize(), maxJpegSize);
+            __FUNCTION__, mId, mCaptureHeaps[0].mHeap->getSize(), maxJpegSize);
 
     if (mCaptureStreamId != NO_STREAM) {
         // Check if stream parameters have to change
@@ -201,7 +204,7 @@ status_t JpegProcessor::deleteStream() {
 
         device->deleteStream(mCaptureStreamId);
 
-        mCaptureHeap.clear();
+        mCaptureHeaps.clear();
         mCaptureWindow.clear();
         mCaptureConsumer.clear();
 
@@ -225,14 +228,14 @@ bool JpegProcessor::threadLoop() {
     {
         Mutex::Autolock l(mInputMutex);
 
-        while (!mCaptureDone) {
+        while (mPendingCaptures.empty()) {
             res = mCaptureDoneSignal.waitRelative(mInputMutex,
                     kWaitDuration);
             if (res == TIMED_OUT) return true;
         }
 
-        captureSuccess = mCaptureSuccess;
-        mCaptureDone = false;
+        captureSuccess = mPendingCaptures[0];
+        mPendingCaptures.removeAt(0);
     }
 
     res = processNewCapture(captureSuccess);
@@ -282,7 +285,14 @@ status_t JpegProcessor::processNewCapture(bool captureSuccess) {
         if (jpegSize == 0) { // failed to find size, default to whole buffer
             jpegSize = imgBuffer.width;
         }
-        size_t heapSize = mCaptureHeap->getSize();
+        ssize_t heapIndex = getCaptureHeapLocked();
+        if (heapIndex < 0) {
+            ALOGE("%s: Camera %d: No memory for still image", __FUNCTION__, mId);
+            mCaptureConsumer->unlockBuffer(imgBuffer);
+            return NO_MEMORY;
+        }
+        CaptureHeap& captureHeap = mCaptureHeaps.editItemAt(heapIndex);
+        size_t heapSize = captureHeap.mHeap->getSize();
         if (jpegSize > heapSize) {
             ALOGW("%s: JPEG image is larger than expected, truncating "
                     "(got %zu, expected at most %zu bytes)",
@@ -291,9 +301,11 @@ status_t JpegProcessor::processNewCapture(bool captureSuccess) {
         }
 
         // TODO: Optimize this to avoid memcopy
-        captureBuffer = new MemoryBase(mCaptureHeap, 0, jpegSize);
-        void* captureMemory = mCaptureHeap->getBase();
+        captureBuffer = new MemoryBase(captureHeap.mHeap, 0, jpegSize);
+        void* captureMemory = captureHeap.mHeap->getBase();
         memcpy(captureMemory, imgBuffer.data, jpegSize);
+        captureHeap.mBuffer = captureBuffer;
+        captureHeap.mLastUsed = systemTime();
 
         mCaptureConsumer->unlockBuffer(imgBuffer);
     }
@@ -306,6 +318,38 @@ status_t JpegProcessor::processNewCapture(bool captureSuccess) {
     return OK;
 }
 
+ssize_t JpegProcessor::getCaptureHeapLocked() {
+    size_t oldest = 0;
+    for (size_t i = 0; i < mCaptureHeaps.size(); i++) {
+        if (mCaptureHeaps[i].mBuffer.promote() == 0) {
+            return i;
+        }
+        if (mCaptureHeaps[i].mLastUsed < mCaptureHeaps[oldest].mLastUsed) {
+            oldest = i;
+        }
+    }
+
+    // The client still holds every previous capture, as in a burst. Copy this one
+    // to a new heap rather than overwrite what the client may not have read yet.
+    if (mCaptureHeaps.size() < kMaxCaptureHeaps) {
+        CaptureHeap captureHeap;
+        captureHeap.mHeap =
+                new MemoryHeapBase(mCaptureHeapSize, 0, "Camera2Client::CaptureHeap");
+        captureHeap.mLastUsed = 0;
+        if (captureHeap.mHeap->getSize() != 0) {
+            return mCaptureHeaps.add(captureHeap);
+        }
+        ALOGW("%s: Camera %d: Unable to allocate another capture heap",
+                __FUNCTION__, mId);
+        if (mCaptureHeaps.isEmpty()) {
+            return NO_MEMORY;
+        }
+    }
+    ALOGW("%s: Camera %d: Reusing capture heap %zu still held by the client",
+            __FUNCTION__, mId, oldest);
+    return oldest;
+}
+
 /*
  * JPEG FILE FORMAT OVERVIEW.
  * http://www.jpeg.org/public/jfif.pdf
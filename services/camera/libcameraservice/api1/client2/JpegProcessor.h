@@ -30,6 +30,7 @@ namespace android {
 
 class Camera2Client;
 class CameraDeviceBase;
+class MemoryBase;
 class MemoryHeapBase;
 
 namespace camera2 {
@@ -61,13 +62,16 @@ class JpegProcessor:
     void dump(int fd, const Vector<String16>& args) const;
   private:
     static const nsecs_t kWaitDuration = 10000000; // 10 ms
+    // Heaps kept for captures the client has not released yet
+    static const size_t kMaxCaptureHeaps = 2;
     wp<CameraDeviceBase> mDevice;
     wp<CaptureSequencer> mSequencer;
     int mId;
 
     mutable Mutex mInputMutex;
-    bool mCaptureDone;
-    bool mCaptureSuccess;
+    // One entry per capture not processed yet, in arrival order; false if
+    // the buffer was lost
+    Vector<bool> mPendingCaptures;
     Condition mCaptureDoneSignal;
 
     enum {
@@ -77,11 +81,22 @@ class JpegProcessor:
     int mCaptureStreamId;
     sp<CpuConsumer>    mCaptureConsumer;
     sp<Surface>        mCaptureWindow;
-    sp<MemoryHeapBase> mCaptureHeap;
+
+    struct CaptureHeap {
+        sp<MemoryHeapBase> mHeap;
+        // Last capture copied to the heap, alive until the client releases it
+        wp<MemoryBase> mBuffer;
+        nsecs_t mLastUsed;
+    };
+    Vector<CaptureHeap> mCaptureHeaps;
+    size_t mCaptureHeapSize;
 
     virtual bool threadLoop();
 
     status_t processNewCapture(bool captureSuccess);
+    // Returns the index of a heap no longer held by the client, or of the
+    // least recently used one if they all still are. NO_MEMORY if there is none.
+    ssize_t getCaptureHeapLocked();
     size_t findJpegSize(uint8_t* jpegBuffer, size_t maxSize);
 
 };
@@ -170,10 +170,13 @@ status_t FrameProcessorBase::processListeners(const CaptureResult &result,
 
     camera_metadata_ro_entry_t entry;
 
-    // Check if this result is partial.
+    // Check if this result is partial. From HAL3.2 the request ID is also in the
+    // CaptureResultExtras, so there's no need to look it up in the metadata.
     bool isPartialResult = false;
+    int32_t requestId;
     if (device->getDeviceVersion() >= CAMERA_DEVICE_API_VERSION_3_2) {
         isPartialResult = result.mResultExtras.partialResultCount < mNumPartialResults;
+        requestId = result.mResultExtras.requestId;
     } else {
         entry = result.mMetadata.find(ANDROID_QUIRKS_PARTIAL_RESULT);
         if (entry.count != 0 &&
@@ -182,23 +185,21 @@ status_t FrameProcessorBase::processListeners(const CaptureResult &result,
                     __FUNCTION__, device->getId());
             isPartialResult = true;
         }
-    }
 
-    // TODO: instead of getting requestID from CameraMetadata, we should get it
-    // from CaptureResultExtras. This will require changing Camera2Device.
-    // Currently Camera2Device uses MetadataQueue to store results, which does not
-    // include CaptureResultExtras.
-    entry = result.mMetadata.find(ANDROID_REQUEST_ID);
-    if (entry.count == 0) {
-        ALOGE("%s: Camera %d: Error reading frame id", __FUNCTION__, device->getId());
-        return BAD_VALUE;
+        entry = result.mMetadata.find(ANDROID_REQUEST_ID);
+        if (entry.count == 0) {
+            ALOGE("%s: Camera %d: Error reading frame id", __FUNCTION__, device->getId());
+            return BAD_VALUE;
+        }
+        requestId = entry.data.i32[0];
     }
-    int32_t requestId = entry.data.i32[0];
 
-    List<sp<FilteredListener> > listeners;
+    // All matching listeners get the same result; collect them in a single allocation
+    Vector<sp<FilteredListener> > listeners;
     {
         Mutex::Autolock l(mInputMutex);
 
+        listeners.setCapacity(mRangeListeners.size());
         List<RangeListener>::iterator item = mRangeListeners.begin();
         // Don't deliver partial results to listeners that don't want them
         while (item != mRangeListeners.end()) {
@@ -218,9 +219,8 @@ status_t FrameProcessorBase::processListeners(const CaptureResult &result,
     ALOGV("%s: Camera %d: Got %zu range listeners out of %zu", __FUNCTION__,
           device->getId(), listeners.size(), mRangeListeners.size());
 
-    List<sp<FilteredListener> >::iterator item = listeners.begin();
-    for (; item != listeners.end(); item++) {
-        (*item)->onResultAvailable(result);
+    for (size_t i = 0; i < listeners.size(); i++) {
+        listeners[i]->onResultAvailable(result);
     }
     return OK;
 }
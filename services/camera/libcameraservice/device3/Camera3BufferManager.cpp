@@ -18,6 +18,8 @@
 #define LOG_TAG "Camera3-BufferManager"
 #define ATRACE_TAG ATRACE_TAG_CAMERA
 
+#include <unistd.h>
+
 #include <gui/ISurfaceComposer.h>
 #include <private/gui/ComposerService.h>
 #include <utils/Log.h>
@@ -41,6 +43,11 @@ Camera3BufferManager::Camera3BufferManager(const sp<IGraphicBufferAlloc>& alloca
 }
 
 Camera3BufferManager::~Camera3BufferManager() {
+    for (auto& buffer : mIdleBuffers) {
+        if (buffer.fenceFd >= 0) {
+            close(buffer.fenceFd);
+        }
+    }
 }
 
 status_t Camera3BufferManager::registerStream(wp<Camera3OutputStream>& stream,
@@ -148,6 +155,14 @@ status_t Camera3BufferManager::unregisterStream(int streamId, int streamSetId) {
     BufferCountMap& handOutBufferCounts = currentSet.handoutBufferCountMap;
     BufferCountMap& attachedBufferCounts = currentSet.attachedBufferCountMap;
     InfoMap& infoMap = currentSet.streamInfoMap;
+    // Keep the free buffers around for a stream that may be configured with the same buffers.
+    while (true) {
+        GraphicBufferEntry buffer = getFirstBufferFromBufferListLocked(freeBufs, streamId);
+        if (buffer.graphicBuffer == nullptr) {
+            break;
+        }
+        addIdleBufferLocked(buffer);
+    }
     removeBuffersFromBufferListLocked(freeBufs, streamId);
     handOutBufferCounts.removeItem(streamId);
     attachedBufferCounts.removeItem(streamId);
@@ -215,7 +230,12 @@ status_t Camera3BufferManager::getBufferForStream(int streamId, int streamSetId,
             getFirstBufferFromBufferListLocked(streamSet.freeBuffers, streamId);
 
     if (mGrallocVersion < HARDWARE_DEVICE_API_VERSION(1,0)) {
-        // Allocate one if there is no free buffer available.
+        // Reuse an idle buffer of an unregistered stream if there is no free buffer available.
+        if (buffer.graphicBuffer == nullptr) {
+            buffer = getIdleBufferLocked(streamSet.streamInfoMap.valueFor(streamId));
+        }
+
+        // Allocate one if there is no idle buffer either.
         if (buffer.graphicBuffer == nullptr) {
             const StreamInfo& info = streamSet.streamInfoMap.valueFor(streamId);
             status_t res = OK;
@@ -368,7 +388,10 @@ status_t Camera3BufferManager::returnBufferForStream(int streamId,
 
     if (!checkIfStreamRegisteredLocked(streamId, streamSetId)){
         ALOGV("%s: returning buffer for an already unregistered stream (stream %d with set id %d),"
-                "buffer will be dropped right away!", __FUNCTION__, streamId, streamSetId);
+                "buffer will be kept as idle buffer!", __FUNCTION__, streamId, streamSetId);
+        if (buffer != 0 && mGrallocVersion < HARDWARE_DEVICE_API_VERSION(1,0)) {
+            addIdleBufferLocked(GraphicBufferEntry(buffer, fenceFd));
+        }
         return OK;
     }
 
@@ -440,6 +463,13 @@ void Camera3BufferManager::dump(int fd, const Vector<String16>& args) const {
             }
         }
     }
+    lines.appendFormat("      Idle buffer count: %zu\n", mIdleBuffers.size());
+    for (auto& idleBuffer : mIdleBuffers) {
+        const sp<GraphicBuffer>& buffer = idleBuffer.graphicBuffer;
+        lines.appendFormat("        buffer: %p, handle: %p (%ux%u, format 0x%x, usage 0x%x).\n",
+                buffer.get(), buffer->handle, buffer->getWidth(), buffer->getHeight(),
+                buffer->getPixelFormat(), buffer->getUsage());
+    }
     write(fd, lines.string(), lines.size());
 }
 
@@ -530,5 +560,37 @@ Camera3BufferManager::GraphicBufferEntry Camera3BufferManager::getFirstBufferFro
     return entry;
 }
 
+void Camera3BufferManager::addIdleBufferLocked(const GraphicBufferEntry& buffer) {
+    mIdleBuffers.push_back(buffer);
+    while (mIdleBuffers.size() > kMaxIdleBufferCount) {
+        GraphicBufferEntry& oldest = mIdleBuffers.front();
+        ALOGV("%s: free idle buffer %p", __FUNCTION__, oldest.graphicBuffer.get());
+        if (oldest.fenceFd >= 0) {
+            close(oldest.fenceFd);
+        }
+        mIdleBuffers.pop_front();
+    }
+}
+
+Camera3BufferManager::GraphicBufferEntry Camera3BufferManager::getIdleBufferLocked(
+        const StreamInfo& info) {
+    GraphicBufferEntry entry;
+    std::list<GraphicBufferEntry>::iterator match = mIdleBuffers.end();
+    for (auto i = mIdleBuffers.begin(); i != mIdleBuffers.end(); i++) {
+        const sp<GraphicBuffer>& buffer = i->graphicBuffer;
+        if (buffer->getWidth() == info.width && buffer->getHeight() == info.height &&
+                static_cast<uint32_t>(buffer->getPixelFormat()) == info.format &&
+                buffer->getUsage() == info.combinedUsage) {
+            match = i;
+        }
+    }
+    if (match != mIdleBuffers.end()) {
+        entry = *match;
+        mIdleBuffers.erase(match);
+        ALOGV("%s: reuse idle buffer %p", __FUNCTION__, entry.graphicBuffer.get());
+    }
+    return entry;
+}
+
 } // namespace camera3
 } // namespace android
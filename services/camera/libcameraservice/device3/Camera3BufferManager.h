@@ -41,6 +41,10 @@ class Camera3OutputStream;
  * In doing so, it reduces the memory footprint unless it is already minimal without impacting
  * performance.
  *
+ * The free buffers of unregistered streams are kept in a small idle list, so that a stream
+ * configured later with the same size, format and usage (e.g., after switching between use
+ * cases) can reuse them instead of allocating new ones.
+ *
  */
 class Camera3BufferManager: public virtual RefBase {
 public:
@@ -88,9 +92,9 @@ public:
      * This method unregisters a stream from this buffer manager.
      *
      * After a stream is unregistered, further getBufferForStream() calls will fail for this stream.
-     * After all streams for a given stream set are unregistered, all the buffers solely owned (for
-     * this stream set) by this buffer manager will be freed; all buffers subsequently returned to
-     * this buffer manager for this stream set will be freed immediately.
+     * The free buffers of this stream, and all buffers subsequently returned to this buffer
+     * manager for it, are moved to the idle buffer list. Once that list holds kMaxIdleBufferCount
+     * buffers, the least recently added buffers are freed.
      *
      * Return values:
      *
@@ -186,6 +190,11 @@ private:
 
     static const size_t kMaxBufferCount = BufferQueueDefs::NUM_BUFFER_SLOTS;
 
+    /**
+     * The max number of buffers kept in the idle buffer list.
+     */
+    static const size_t kMaxIdleBufferCount = 8;
+
     /**
      * mAllocator is the connection to SurfaceFlinger that is used to allocate new GraphicBuffer
      * objects.
@@ -289,6 +298,13 @@ private:
     KeyedVector<StreamSetId, StreamSet> mStreamSetMap;
     KeyedVector<StreamId, wp<Camera3OutputStream>> mStreamMap;
 
+    /**
+     * Free buffers of unregistered streams, from the least to the most recently added one. They
+     * are not associated with any stream set, and are handed out to any stream that would
+     * allocate a buffer of the same size, format and usage.
+     */
+    std::list<GraphicBufferEntry> mIdleBuffers;
+
     // TODO: There is no easy way to query the Gralloc version in this code yet, we have different
     // code paths for different Gralloc versions, hardcode something here for now.
     const uint32_t mGrallocVersion = GRALLOC_DEVICE_API_VERSION_0_1;
@@ -331,6 +347,23 @@ private:
      *
      */
     bool inline hasBufferForStreamLocked(BufferList& buffers, int streamId);
+
+    /**
+     * Add a buffer to the idle buffer list, freeing the least recently added idle buffer if the
+     * list is full.
+     *
+     * This method needs to be called with mLock held.
+     */
+    void addIdleBufferLocked(const GraphicBufferEntry& buffer);
+
+    /**
+     * Get the most recently added idle buffer matching the size, format and usage of the given
+     * stream, and remove it from the idle buffer list. The graphicBuffer inside the entry will be
+     * NULL if there is no such buffer.
+     *
+     * This method needs to be called with mLock held.
+     */
+    GraphicBufferEntry getIdleBufferLocked(const StreamInfo& info);
 };
 
 } // namespace camera3
@@ -217,6 +217,13 @@ status_t Camera3Device::initialize(CameraModule *module)
     mDummyStreamId = NO_STREAM;
     mNeedConfig = true;
     mPauseStateNotify = false;
+    mRequestThreadBoosted = false;
+    mPauseDuration = 0;
+    mConfigPauseDuration = 0;
+    mConfigStartDuration = 0;
+    mConfigHalDuration = 0;
+    mConfigFinishDuration = 0;
+    mConfigNumStreams = 0;
 
     // Measure the clock domain offset between camera and video/hw_composer
     camera_metadata_entry timestampSource =
@@ -573,6 +580,10 @@ status_t Camera3Device::dump(int fd, const Vector<String16> &args) {
     lines.appendFormat("    Stream configuration:\n");
     lines.appendFormat("    Operation mode: %s \n", mIsConstrainedHighSpeedConfiguration ?
             "CONSTRAINED HIGH SPEED VIDEO" : "NORMAL");
+    lines.appendFormat("    Last configuration of %zu streams: pause %" PRId64 " us, start %"
+            PRId64 " us, HAL %" PRId64 " us, finish %" PRId64 " us\n", mConfigNumStreams,
+            ns2us(mConfigPauseDuration), ns2us(mConfigStartDuration),
+            ns2us(mConfigHalDuration), ns2us(mConfigFinishDuration));
 
     if (mInputStream != NULL) {
         write(fd, lines.string(), lines.size());
@@ -642,6 +653,8 @@ status_t Camera3Device::dump(int fd, const Vector<String16> &args) {
 
     mTagMonitor.dumpMonitoredMetadata(fd);
 
+    mFrameTimeline.dumpTimeline(fd);
+
     if (mHal3Device != NULL) {
         lines = String8("    HAL device dump:\n");
         write(fd, lines.string(), lines.size());
@@ -1412,7 +1425,9 @@ status_t Camera3Device::internalPauseAndWaitLocked() {
     mPauseStateNotify = true;
 
     ALOGV("%s: Camera %d: Internal wait until idle", __FUNCTION__, mId);
+    nsecs_t startTime = systemTime();
     status_t res = waitUntilStateThenRelock(/*active*/ false, kShutdownTimeout);
+    mPauseDuration += systemTime() - startTime;
     if (res != OK) {
         SET_ERR_L("Can't idle device in %f seconds!",
                 kShutdownTimeout/1e9);
@@ -1536,6 +1551,8 @@ status_t Camera3Device::getNextResult(CaptureResult *frame) {
     frame->mMetadata.acquire(result.mMetadata);
     mResultQueue.erase(mResultQueue.begin());
 
+    mFrameTimeline.record(FrameTimeline::RESULT_DELIVERED, frame->mResultExtras.frameNumber);
+
     return OK;
 }
 
@@ -1946,6 +1963,7 @@ status_t Camera3Device::configureStreamsLocked() {
 
     // Start configuring the streams
     ALOGV("%s: Camera %d: Starting stream configuration", __FUNCTION__, mId);
+    nsecs_t startTime = systemTime();
 
     camera3_stream_configuration config;
     config.operation_mode = mIsConstrainedHighSpeedConfiguration ?
@@ -1991,9 +2009,11 @@ status_t Camera3Device::configureStreamsLocked() {
 
     // Do the HAL configuration; will potentially touch stream
     // max_buffers, usage, priv fields.
+    nsecs_t halStartTime = systemTime();
     ATRACE_BEGIN("camera3->configure_streams");
     res = mHal3Device->ops->configure_streams(mHal3Device, &config);
     ATRACE_END();
+    nsecs_t halEndTime = systemTime();
 
     if (res == BAD_VALUE) {
         // HAL rejected this set of streams as unsupported, clean up config
@@ -2009,7 +2029,8 @@ status_t Camera3Device::configureStreamsLocked() {
         return res;
     }
 
-    // Finish all stream configuration immediately.
+    // Finish all stream configuration immediately. Streams whose usage and max
+    // buffers the HAL left unchanged keep their buffers and registrations.
     // TODO: Try to relax this later back to lazy completion, which should be
     // faster
 
@@ -2037,6 +2058,16 @@ status_t Camera3Device::configureStreamsLocked() {
         }
     }
 
+    mConfigPauseDuration = mPauseDuration;
+    mPauseDuration = 0;
+    mConfigStartDuration = halStartTime - startTime;
+    mConfigHalDuration = halEndTime - halStartTime;
+    mConfigFinishDuration = systemTime() - halEndTime;
+    mConfigNumStreams = config.num_streams;
+    ALOGV("%s: Camera %d: Configured %u streams in %" PRId64 " us (HAL %" PRId64 " us)",
+            __FUNCTION__, mId, config.num_streams, ns2us(systemTime() - startTime),
+            ns2us(mConfigHalDuration));
+
     // Request thread needs to know to avoid using repeat-last-settings protocol
     // across configure_streams() calls
     mRequestThread->configurationComplete(mIsConstrainedHighSpeedConfiguration);
@@ -2044,8 +2075,9 @@ status_t Camera3Device::configureStreamsLocked() {
     char value[PROPERTY_VALUE_MAX];
     property_get("camera.fifo.disable", value, "0");
     int32_t disableFifo = atoi(value);
-    if (disableFifo != 1) {
-        // Boost priority of request thread to SCHED_FIFO.
+    if (disableFifo != 1 && !mRequestThreadBoosted) {
+        // Boost priority of request thread to SCHED_FIFO. The request thread
+        // lives as long as the device, so this is only needed once.
         pid_t requestThreadTid = mRequestThread->getTid();
         res = requestPriority(getpid(), requestThreadTid,
                 kRequestThreadPriority, /*asynchronous*/ false);
@@ -2054,6 +2086,7 @@ status_t Camera3Device::configureStreamsLocked() {
                     strerror(-res), res);
         } else {
             ALOGD("Set real time priority for request queue thread (tid %d)", requestThreadTid);
+            mRequestThreadBoosted = true;
         }
     }
 
@@ -2222,6 +2255,35 @@ void Camera3Device::returnOutputBuffers(
     }
 }
 
+void Camera3Device::queueOutputBuffersLocked(
+        const camera3_stream_buffer_t *outputBuffers, size_t numBuffers,
+        nsecs_t timestamp) {
+    for (size_t i = 0; i < numBuffers; i++) {
+        OutputBufferToReturn b;
+        b.buffer = outputBuffers[i];
+        b.timestamp = timestamp;
+        mOutputBuffersToReturn.push_back(b);
+    }
+}
+
+void Camera3Device::takeOutputBuffersToReturnLocked(Vector<OutputBufferToReturn> *buffers) {
+    // Lock before mInFlightLock is released, so that a later result can't return its
+    // buffers first.
+    mReturnOutputBuffersLock.lock();
+    buffers->clear();
+    if (!mOutputBuffersToReturn.isEmpty()) {
+        buffers->appendVector(mOutputBuffersToReturn);
+        mOutputBuffersToReturn.clear();
+    }
+}
+
+void Camera3Device::returnTakenOutputBuffers(const Vector<OutputBufferToReturn> &buffers) {
+    for (size_t i = 0; i < buffers.size(); i++) {
+        returnOutputBuffers(&buffers[i].buffer, 1, buffers[i].timestamp);
+    }
+    mReturnOutputBuffersLock.unlock();
+}
+
 void Camera3Device::removeInFlightMapEntryLocked(int idx) {
     mInFlightMap.removeItemsAt(idx, 1);
 
@@ -2262,7 +2324,7 @@ void Camera3Device::removeInFlightRequestIfReadyLocked(int idx) {
         // return.
         assert(request.requestStatus != OK ||
                request.pendingOutputBuffers.size() == 0);
-        returnOutputBuffers(request.pendingOutputBuffers.array(),
+        queueOutputBuffersLocked(request.pendingOutputBuffers.array(),
             request.pendingOutputBuffers.size(), 0);
 
         removeInFlightMapEntryLocked(idx);
@@ -2297,9 +2359,11 @@ void Camera3Device::insertResultLocked(CaptureResult *result, uint32_t frameNumb
 
     overrideResultForPrecaptureCancel(&result->mMetadata, aeTriggerCancelOverride);
 
-    // Valid result, insert into queue
+    // Valid result, insert into queue. The metadata is moved, not copied.
     List<CaptureResult>::iterator queuedResult =
-            mResultQueue.insert(mResultQueue.end(), CaptureResult(*result));
+            mResultQueue.insert(mResultQueue.end(), CaptureResult());
+    queuedResult->mResultExtras = result->mResultExtras;
+    queuedResult->mMetadata.acquire(result->mMetadata);
     ALOGVV("%s: result requestId = %" PRId32 ", frameNumber = %" PRId64
            ", burstId = %" PRId32, __FUNCTION__,
            queuedResult->mResultExtras.requestId,
@@ -2355,7 +2419,7 @@ void Camera3Device::sendCaptureResult(CameraMetadata &pendingMetadata,
 
     CaptureResult captureResult;
     captureResult.mResultExtras = resultExtras;
-    captureResult.mMetadata = pendingMetadata;
+    captureResult.mMetadata.acquire(pendingMetadata);
 
     // Append any previous partials to form a complete result
     if (mUsePartialResult && !collectedPartialResult.isEmpty()) {
@@ -2428,6 +2492,7 @@ void Camera3Device::processCaptureResult(const camera3_capture_result *result) {
     // arrives. Update the in-flight status and remove the in-flight entry if
     // all result data and shutter timestamp have been received.
     nsecs_t shutterTimestamp = 0;
+    Vector<OutputBufferToReturn> buffersToReturn;
 
     {
         Mutex::Autolock l(mInFlightLock);
@@ -2482,6 +2547,7 @@ void Camera3Device::processCaptureResult(const camera3_capture_result *result) {
             }
 
             if (isPartialResult) {
+                mFrameTimeline.record(FrameTimeline::PARTIAL_RESULT, frameNumber);
                 // Send partial capture result
                 sendPartialCaptureResult(result->result, request.resultExtras, frameNumber,
                         request.aeTriggerCancelOverride);
@@ -2507,6 +2573,9 @@ void Camera3Device::processCaptureResult(const camera3_capture_result *result) {
         }
 
         uint32_t numBuffersReturned = result->num_output_buffers;
+        if (numBuffersReturned > 0) {
+            mFrameTimeline.record(FrameTimeline::BUFFERS_RETURNED, frameNumber);
+        }
         if (result->input_buffer != NULL) {
             if (hasInputBufferInRequest) {
                 numBuffersReturned += 1;
@@ -2537,14 +2606,14 @@ void Camera3Device::processCaptureResult(const camera3_capture_result *result) {
             request.pendingOutputBuffers.appendArray(result->output_buffers,
                 result->num_output_buffers);
         } else {
-            returnOutputBuffers(result->output_buffers,
+            queueOutputBuffersLocked(result->output_buffers,
                 result->num_output_buffers, shutterTimestamp);
         }
 
         if (result->result != NULL && !isPartialResult) {
             if (shutterTimestamp == 0) {
                 request.pendingMetadata = result->result;
-                request.collectedPartialResult = collectedPartialResult;
+                request.collectedPartialResult.acquire(collectedPartialResult);
             } else {
                 CameraMetadata metadata;
                 metadata = result->result;
@@ -2555,7 +2624,12 @@ void Camera3Device::processCaptureResult(const camera3_capture_result *result) {
         }
 
         removeInFlightRequestIfReadyLocked(idx);
+
+        // Returning buffers can block on the consumers, don't make the request thread
+        // wait for mInFlightLock meanwhile.
+        takeOutputBuffersToReturnLocked(&buffersToReturn);
     } // scope for mInFlightLock
+    returnTakenOutputBuffers(buffersToReturn);
 
     if (result->input_buffer != NULL) {
         if (hasInputBufferInRequest) {
@@ -2679,6 +2753,9 @@ void Camera3Device::notifyError(const camera3_error_msg_t &msg,
 void Camera3Device::notifyShutter(const camera3_shutter_msg_t &msg,
         sp<NotificationListener> listener) {
     ssize_t idx;
+    Vector<OutputBufferToReturn> buffersToReturn;
+
+    mFrameTimeline.record(FrameTimeline::SHUTTER, msg.frame_number);
 
     // Set timestamp for the request in the in-flight tracking
     // and get the request ID to send upstream
@@ -2725,13 +2802,15 @@ void Camera3Device::notifyShutter(const camera3_shutter_msg_t &msg,
             sendCaptureResult(r.pendingMetadata, r.resultExtras,
                 r.collectedPartialResult, msg.frame_number,
                 r.hasInputBuffer, r.aeTriggerCancelOverride);
-            returnOutputBuffers(r.pendingOutputBuffers.array(),
+            queueOutputBuffersLocked(r.pendingOutputBuffers.array(),
                 r.pendingOutputBuffers.size(), r.shutterTimestamp);
             r.pendingOutputBuffers.clear();
 
             removeInFlightRequestIfReadyLocked(idx);
         }
+        takeOutputBuffersToReturnLocked(&buffersToReturn);
     }
+    returnTakenOutputBuffers(buffersToReturn);
     if (idx < 0) {
         SET_ERR("Shutter notification for non-existent frame number %d",
                 msg.frame_number);
@@ -2757,6 +2836,10 @@ void Camera3Device::monitorMetadata(TagMonitor::eventSource source,
     mTagMonitor.monitorMetadata(source, frameNumber, timestamp, metadata);
 }
 
+void Camera3Device::recordFrameEvent(FrameTimeline::event e, uint32_t frameNumber) {
+    mFrameTimeline.record(e, frameNumber);
+}
+
 /**
  * RequestThread inner class methods
  */
@@ -3156,7 +3239,13 @@ bool Camera3Device::RequestThread::threadLoop() {
 
     ALOGVV("%s: %d: submitting %zu requests in a batch.", __FUNCTION__, __LINE__,
             mNextRequests.size());
+    sp<Camera3Device> parent = mParent.promote();
     for (auto& nextRequest : mNextRequests) {
+        if (parent != NULL) {
+            parent->recordFrameEvent(FrameTimeline::REQUEST_SUBMITTED,
+                    nextRequest.halRequest.frame_number);
+        }
+
         // Submit request and block until ready for next one
         ATRACE_ASYNC_BEGIN("frame capture", nextRequest.halRequest.frame_number);
         ATRACE_BEGIN("camera3->process_capture_request");
@@ -3187,7 +3276,6 @@ bool Camera3Device::RequestThread::threadLoop() {
             camera_metadata_t* cloned = clone_camera_metadata(nextRequest.halRequest.settings);
             mLatestRequest.acquire(cloned);
 
-            sp<Camera3Device> parent = mParent.promote();
             if (parent != NULL) {
                 parent->monitorMetadata(TagMonitor::REQUEST, nextRequest.halRequest.frame_number,
                         0, mLatestRequest);
@@ -3228,6 +3316,8 @@ bool Camera3Device::RequestThread::threadLoop() {
 status_t Camera3Device::RequestThread::prepareHalRequests() {
     ATRACE_CALL();
 
+    // Settings of the last request in this batch that carries any, NULL if none does yet
+    const camera_metadata_t *lastSettings = NULL;
     for (auto& nextRequest : mNextRequests) {
         sp<CaptureRequest> captureRequest = nextRequest.captureRequest;
         camera3_capture_request_t* halRequest = &nextRequest.halRequest;
@@ -3269,16 +3359,30 @@ status_t Camera3Device::RequestThread::prepareHalRequests() {
              */
             captureRequest->mSettings.sort();
             halRequest->settings = captureRequest->mSettings.getAndLock();
+            bool reconfigured = (mPrevRequest == NULL);
             mPrevRequest = captureRequest;
-            ALOGVV("%s: Request settings are NEW", __FUNCTION__);
+
+            // Repeating bursts, like the ones of high speed recording, are separate requests
+            // that mostly carry the same settings. Don't make the HAL parse those again.
+            if (!triggersMixedIn && !reconfigured &&
+                    isLatestSettings(halRequest->settings, lastSettings)) {
+                captureRequest->mSettings.unlock(halRequest->settings);
+                halRequest->settings = NULL;
+                ALOGVV("%s: Request settings are UNCHANGED", __FUNCTION__);
+            } else {
+                lastSettings = halRequest->settings;
+                ALOGVV("%s: Request settings are NEW", __FUNCTION__);
+            }
 
             IF_ALOGV() {
                 camera_metadata_ro_entry_t e = camera_metadata_ro_entry_t();
-                find_camera_metadata_ro_entry(
-                        halRequest->settings,
-                        ANDROID_CONTROL_AF_TRIGGER,
-                        &e
-                );
+                if (halRequest->settings != NULL) {
+                    find_camera_metadata_ro_entry(
+                            halRequest->settings,
+                            ANDROID_CONTROL_AF_TRIGGER,
+                            &e
+                    );
+                }
                 if (e.count > 0) {
                     ALOGV("%s: Request (frame num %d) had AF trigger 0x%x",
                           __FUNCTION__,
@@ -3364,6 +3468,50 @@ status_t Camera3Device::RequestThread::prepareHalRequests() {
     return OK;
 }
 
+bool Camera3Device::RequestThread::isLatestSettings(const camera_metadata_t *settings,
+        const camera_metadata_t *lastSettings) const {
+    Mutex::Autolock al(mLatestRequestMutex);
+
+    const camera_metadata_t *latest = lastSettings;
+    if (latest == NULL) {
+        latest = mLatestRequest.getAndLock();
+    }
+
+    // A trigger has to fire again even if the settings did not change.
+    static const uint32_t kTriggerTags[] = {
+        ANDROID_CONTROL_AF_TRIGGER,
+        ANDROID_CONTROL_AE_PRECAPTURE_TRIGGER,
+    };
+    bool same = (latest != NULL);
+    for (size_t i = 0; same && i < sizeof(kTriggerTags) / sizeof(kTriggerTags[0]); i++) {
+        camera_metadata_ro_entry_t e;
+        if (find_camera_metadata_ro_entry(settings, kTriggerTags[i], &e) == OK &&
+                e.count > 0 && e.data.u8[0] != 0 /* *_TRIGGER_IDLE */) {
+            same = false;
+        }
+    }
+
+    size_t entryCount = get_camera_metadata_entry_count(settings);
+    if (same && (entryCount != get_camera_metadata_entry_count(latest) ||
+            get_camera_metadata_data_count(settings) != get_camera_metadata_data_count(latest))) {
+        same = false;
+    }
+    for (size_t i = 0; same && i < entryCount; i++) {
+        camera_metadata_ro_entry_t a, b;
+        if (get_camera_metadata_ro_entry(settings, i, &a) != OK ||
+                get_camera_metadata_ro_entry(latest, i, &b) != OK ||
+                a.tag != b.tag || a.type != b.type || a.count != b.count ||
+                memcmp(a.data.u8, b.data.u8, a.count * camera_metadata_type_size[a.type]) != 0) {
+            same = false;
+        }
+    }
+
+    if (lastSettings == NULL) {
+        mLatestRequest.unlock(latest);
+    }
+    return same;
+}
+
 CameraMetadata Camera3Device::RequestThread::getLatestRequest() const {
     Mutex::Autolock al(mLatestRequestMutex);
 
@@ -3853,16 +4001,13 @@ status_t Camera3Device::RequestThread::addDummyTriggerIds(
  */
 
 Camera3Device::PreparerThread::PreparerThread() :
-        Thread(/*canCallJava*/false), mListener(nullptr),
-        mActive(false), mCancelNow(false) {
+        mListener(nullptr), mCancelGeneration(0) {
 }
 
 Camera3Device::PreparerThread::~PreparerThread() {
-    Thread::requestExitAndWait();
-    if (mCurrentStream != nullptr) {
-        mCurrentStream->cancelPrepare();
-        ATRACE_ASYNC_END("stream prepare", mCurrentStream->getId());
-        mCurrentStream.clear();
+    for (size_t i = 0; i < mWorkers.size(); i++) {
+        mWorkers[i]->requestExitAndWait();
+        mWorkers[i]->cancelCurrentStream();
     }
     clear();
 }
@@ -3885,22 +4030,42 @@ status_t Camera3Device::PreparerThread::prepare(int maxCount, sp<Camera3StreamIn
         return res;
     }
 
-    // Need to prepare, start up thread if necessary
-    if (!mActive) {
-        // mRunning will change to false before the thread fully shuts down, so wait to be sure it
-        // isn't running
-        Thread::requestExitAndWait();
-        res = Thread::run("C3PrepThread", PRIORITY_BACKGROUND);
-        if (res != OK) {
+    // Need to prepare, start up another worker if still within budget, so that
+    // the buffers of this stream are allocated in parallel with the others
+    size_t numActiveWorkers = 0;
+    ssize_t idleWorker = -1;
+    for (size_t i = 0; i < mWorkers.size(); i++) {
+        if (mWorkers[i]->mActive) {
+            numActiveWorkers++;
+        } else if (idleWorker < 0) {
+            idleWorker = i;
+        }
+    }
+    if (numActiveWorkers < kMaxParallelStreams) {
+        sp<PrepareWorker> worker;
+        if (idleWorker >= 0) {
+            // mActive changes to false before the thread fully shuts down, so wait to be sure it
+            // isn't running
+            worker = mWorkers[idleWorker];
+            worker->requestExitAndWait();
+        } else {
+            worker = new PrepareWorker(this);
+            mWorkers.push_back(worker);
+        }
+        res = worker->run("C3PrepThread", PRIORITY_BACKGROUND);
+        if (res == OK) {
+            worker->mActive = true;
+            numActiveWorkers++;
+            ALOGV("%s: Preparer worker started, %zu active", __FUNCTION__, numActiveWorkers);
+        } else {
             ALOGE("%s: Unable to start preparer stream: %d (%s)", __FUNCTION__, res, strerror(-res));
-            if (listener != NULL) {
-                listener->notifyPrepared(stream->getId());
-            }
-            return res;
         }
-        mCancelNow = false;
-        mActive = true;
-        ALOGV("%s: Preparer stream started", __FUNCTION__);
+    }
+    if (numActiveWorkers == 0) {
+        if (listener != NULL) {
+            listener->notifyPrepared(stream->getId());
+        }
+        return res;
     }
 
     // queue up the work
@@ -3917,7 +4082,7 @@ status_t Camera3Device::PreparerThread::clear() {
         stream->cancelPrepare();
     }
     mPendingStreams.clear();
-    mCancelNow = true;
+    mCancelGeneration++;
 
     return OK;
 }
@@ -3927,13 +4092,25 @@ void Camera3Device::PreparerThread::setNotificationListener(wp<NotificationListe
     mListener = listener;
 }
 
-bool Camera3Device::PreparerThread::threadLoop() {
+Camera3Device::PreparerThread::PrepareWorker::PrepareWorker(PreparerThread *parent) :
+        Thread(/*canCallJava*/false), mActive(false), mParent(parent), mCancelGeneration(0) {
+}
+
+void Camera3Device::PreparerThread::PrepareWorker::cancelCurrentStream() {
+    if (mCurrentStream != nullptr) {
+        mCurrentStream->cancelPrepare();
+        ATRACE_ASYNC_END("stream prepare", mCurrentStream->getId());
+        mCurrentStream.clear();
+    }
+}
+
+bool Camera3Device::PreparerThread::PrepareWorker::threadLoop() {
     status_t res;
     {
-        Mutex::Autolock l(mLock);
+        Mutex::Autolock l(mParent->mLock);
         if (mCurrentStream == nullptr) {
             // End thread if done with work
-            if (mPendingStreams.empty()) {
+            if (mParent->mPendingStreams.empty()) {
                 ALOGV("%s: Preparer stream out of work", __FUNCTION__);
                 // threadLoop _must not_ re-acquire mLock after it sets mActive to false; would
                 // cause deadlock with prepare()'s requestExitAndWait triggered by !mActive.
@@ -3942,17 +4119,15 @@ bool Camera3Device::PreparerThread::threadLoop() {
             }
 
             // Get next stream to prepare
-            auto it = mPendingStreams.begin();
+            auto it = mParent->mPendingStreams.begin();
             mCurrentStream = *it;
-            mPendingStreams.erase(it);
+            mParent->mPendingStreams.erase(it);
+            mCancelGeneration = mParent->mCancelGeneration;
             ATRACE_ASYNC_BEGIN("stream prepare", mCurrentStream->getId());
             ALOGV("%s: Preparing stream %d", __FUNCTION__, mCurrentStream->getId());
-        } else if (mCancelNow) {
-            mCurrentStream->cancelPrepare();
-            ATRACE_ASYNC_END("stream prepare", mCurrentStream->getId());
+        } else if (mCancelGeneration != mParent->mCancelGeneration) {
             ALOGV("%s: Cancelling stream %d prepare", __FUNCTION__, mCurrentStream->getId());
-            mCurrentStream.clear();
-            mCancelNow = false;
+            cancelCurrentStream();
             return true;
         }
     }
@@ -3968,8 +4143,8 @@ bool Camera3Device::PreparerThread::threadLoop() {
     }
 
     // This stream has finished, notify listener
-    Mutex::Autolock l(mLock);
-    sp<NotificationListener> listener = mListener.promote();
+    Mutex::Autolock l(mParent->mLock);
+    sp<NotificationListener> listener = mParent->mListener.promote();
     if (listener != NULL) {
         ALOGV("%s: Stream %d prepare done, signaling listener", __FUNCTION__,
                 mCurrentStream->getId());
@@ -31,6 +31,7 @@
 #include "device3/StatusTracker.h"
 #include "device3/Camera3BufferManager.h"
 #include "utils/TagMonitor.h"
+#include "utils/FrameTimeline.h"
 
 /**
  * Function pointer types with C calling convention to
@@ -260,6 +261,19 @@ class Camera3Device :
     // Need to hold on to stream references until configure completes.
     Vector<sp<camera3::Camera3StreamInterface> > mDeletedStreams;
 
+    // Whether the request thread already runs at kRequestThreadPriority
+    bool                       mRequestThreadBoosted;
+
+    // Time spent in internalPauseAndWaitLocked() since the last stream configuration
+    nsecs_t                    mPauseDuration;
+
+    // Durations of the phases of the last stream configuration, for dumpsys
+    nsecs_t                    mConfigPauseDuration;  // waiting for the device to idle
+    nsecs_t                    mConfigStartDuration;  // startConfiguration() of all streams
+    nsecs_t                    mConfigHalDuration;    // configure_streams() of the HAL
+    nsecs_t                    mConfigFinishDuration; // finishConfiguration() of all streams
+    size_t                     mConfigNumStreams;
+
     // Whether the HAL will send partial result
     bool                       mUsePartialResult;
 
@@ -551,6 +565,11 @@ class Camera3Device :
         // a trigger does
         status_t          addDummyTriggerIds(const sp<CaptureRequest> &request);
 
+        // Returns true if the sorted |settings| hold the same entries as the settings the
+        // HAL uses, |lastSettings| if not NULL, or else the latest request submitted.
+        bool              isLatestSettings(const camera_metadata_t *settings,
+                                           const camera_metadata_t *lastSettings) const;
+
         static const nsecs_t kRequestTimeout = 50e6; // 50 ms
 
         // Used to prepare a batch of requests.
@@ -723,10 +742,20 @@ class Camera3Device :
     // Map from frame number to the in-flight request state
     typedef KeyedVector<uint32_t, InFlightRequest> InFlightMap;
 
-    Mutex                  mInFlightLock; // Protects mInFlightMap
+    Mutex                  mInFlightLock; // Protects mInFlightMap, mOutputBuffersToReturn
     InFlightMap            mInFlightMap;
     int                    mInFlightStatusId;
 
+    // An output buffer to return to its stream once mInFlightLock is released.
+    struct OutputBufferToReturn {
+        camera3_stream_buffer_t buffer;
+        nsecs_t timestamp;
+    };
+    Vector<OutputBufferToReturn> mOutputBuffersToReturn;
+    // Held while returning buffers outside of mInFlightLock, so that they still reach
+    // their streams in the order they were queued.
+    Mutex                  mReturnOutputBuffersLock;
+
     status_t registerInFlight(uint32_t frameNumber,
             int32_t numBuffers, CaptureResultExtras resultExtras, bool hasInput,
             const AeTriggerCancelOverride_t &aeTriggerCancelOverride);
@@ -753,7 +782,7 @@ class Camera3Device :
     /**
      * Thread for preparing streams
      */
-    class PreparerThread : private Thread, public virtual RefBase {
+    class PreparerThread : public virtual RefBase {
       public:
         PreparerThread();
         ~PreparerThread();
@@ -761,9 +790,10 @@ class Camera3Device :
         void setNotificationListener(wp<NotificationListener> listener);
 
         /**
-         * Queue up a stream to be prepared. Streams are processed by a background thread in FIFO
-         * order.  Pre-allocate up to maxCount buffers for the stream, or the maximum number needed
-         * for the pipeline if maxCount is ALLOCATE_PIPELINE_MAX.
+         * Queue up a stream to be prepared. Streams are processed by background threads in FIFO
+         * order, up to kMaxParallelStreams at once.  Pre-allocate up to maxCount buffers for the
+         * stream, or the maximum number needed for the pipeline if maxCount is
+         * ALLOCATE_PIPELINE_MAX.
          */
         status_t prepare(int maxCount, sp<camera3::Camera3StreamInterface>& stream);
 
@@ -773,20 +803,40 @@ class Camera3Device :
         status_t clear();
 
       private:
-        Mutex mLock;
+        // Max number of streams that have their buffers allocated in parallel
+        static const size_t kMaxParallelStreams = 3;
 
-        virtual bool threadLoop();
+        // Prepares the pending streams one at a time, until there are none left
+        class PrepareWorker : public Thread {
+          public:
+            explicit PrepareWorker(PreparerThread *parent);
+
+            // Cancel the preparation in progress, if any. Only call once the thread has
+            // exited.
+            void cancelCurrentStream();
+
+            // Guarded by the parent's mLock
+            bool mActive;
+
+          private:
+            virtual bool threadLoop();
+
+            PreparerThread *mParent;
+
+            // Only accessed by threadLoop and cancelCurrentStream
+            sp<camera3::Camera3StreamInterface> mCurrentStream;
+            uint32_t mCancelGeneration;
+        };
+
+        Mutex mLock;
 
         // Guarded by mLock
 
         wp<NotificationListener> mListener;
         List<sp<camera3::Camera3StreamInterface> > mPendingStreams;
-        bool mActive;
-        bool mCancelNow;
-
-        // Only accessed by threadLoop and the destructor
-
-        sp<camera3::Camera3StreamInterface> mCurrentStream;
+        Vector<sp<PrepareWorker> > mWorkers;
+        // Incremented by clear() to cancel the preparations in progress
+        uint32_t mCancelGeneration;
     };
     sp<PreparerThread> mPreparerThread;
 
@@ -835,14 +885,15 @@ class Camera3Device :
             const AeTriggerCancelOverride_t &aeTriggerCancelOverride);
 
     // Send a total capture result given the pending metadata and result extras,
-    // partial results, and the frame number to the result queue.
+    // partial results, and the frame number to the result queue. The result takes
+    // over the buffer of pendingMetadata, which is empty afterwards.
     void sendCaptureResult(CameraMetadata &pendingMetadata,
             CaptureResultExtras &resultExtras,
             CameraMetadata &collectedPartialResult, uint32_t frameNumber,
             bool reprocess, const AeTriggerCancelOverride_t &aeTriggerCancelOverride);
 
     // Insert the result to the result queue after updating frame number and overriding AE
-    // trigger cancel.
+    // trigger cancel. The metadata of the result is moved into the queue.
     // mOutputLock must be held when calling this function.
     void insertResultLocked(CaptureResult *result, uint32_t frameNumber,
             const AeTriggerCancelOverride_t &aeTriggerCancelOverride);
@@ -856,8 +907,21 @@ class Camera3Device :
     // if it's no longer needed. It must only be called with mInFlightLock held.
     void removeInFlightRequestIfReadyLocked(int idx);
 
+    // Queue output buffers to return to the streams, instead of returning them while
+    // holding mInFlightLock. It must only be called with mInFlightLock held.
+    void queueOutputBuffersLocked(const camera3_stream_buffer_t *outputBuffers,
+            size_t numBuffers, nsecs_t timestamp);
+    // Move the queued output buffers to |buffers| and lock mReturnOutputBuffersLock. It
+    // must be called right before releasing mInFlightLock, and followed by
+    // returnTakenOutputBuffers().
+    void takeOutputBuffersToReturnLocked(Vector<OutputBufferToReturn> *buffers);
+
     /**** End scope for mInFlightLock ****/
 
+    // Return the buffers from takeOutputBuffersToReturnLocked() to the streams and unlock
+    // mReturnOutputBuffersLock.
+    void returnTakenOutputBuffers(const Vector<OutputBufferToReturn> &buffers);
+
     // Debug tracker for metadata tag value changes
     // - Enabled with the -m <taglist> option to dumpsys, such as
     //   dumpsys -m android.control.aeState,android.control.aeMode
@@ -868,6 +932,11 @@ class Camera3Device :
     void monitorMetadata(TagMonitor::eventSource source, int64_t frameNumber,
             nsecs_t timestamp, const CameraMetadata& metadata);
 
+    // Always-on record of the recent frames going through the pipeline, shown in dump()
+    FrameTimeline mFrameTimeline;
+
+    void recordFrameEvent(FrameTimeline::event e, uint32_t frameNumber);
+
     /**
      * Static callback forwarding methods from HAL to instance
      */
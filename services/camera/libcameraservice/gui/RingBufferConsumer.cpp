@@ -101,7 +101,7 @@ sp<PinnedBufferItem> RingBufferConsumer::pinSelectedBuffer(
         }
 
         pinnedBuffer = new PinnedBufferItem(this, *accIt);
-        pinBufferLocked(pinnedBuffer->getBufferItem());
+        pinBufferLocked(accIt);
 
     } // end scope of mMutex autolock
 
@@ -161,27 +161,10 @@ nsecs_t RingBufferConsumer::getLatestTimestamp() {
     return mLatestTimestamp;
 }
 
-void RingBufferConsumer::pinBufferLocked(const BufferItem& item) {
-    List<RingBufferItem>::iterator it, end;
-
-    for (it = mBufferItemList.begin(), end = mBufferItemList.end();
-         it != end;
-         ++it) {
-
-        RingBufferItem& find = *it;
-        if (item.mGraphicBuffer == find.mGraphicBuffer) {
-            find.mPinCount++;
-            break;
-        }
-    }
-
-    if (it == end) {
-        BI_LOGE("Failed to pin buffer (timestamp %" PRId64 ", framenumber %" PRIu64 ")",
-                 item.mTimestamp, item.mFrameNumber);
-    } else {
-        BI_LOGV("Pinned buffer (frame %" PRIu64 ", timestamp %" PRId64 ")",
-                item.mFrameNumber, item.mTimestamp);
-    }
+void RingBufferConsumer::pinBufferLocked(List<RingBufferItem>::iterator it) {
+    it->mPinCount++;
+    BI_LOGV("Pinned buffer (frame %" PRIu64 ", timestamp %" PRId64 ")",
+            it->mFrameNumber, it->mTimestamp);
 }
 
 status_t RingBufferConsumer::releaseOldestBufferLocked(size_t* pinnedFrames) {
@@ -204,6 +187,8 @@ status_t RingBufferConsumer::releaseOldestBufferLocked(size_t* pinnedFrames) {
         return NOT_ENOUGH_DATA;
     }
 
+    // The list is sorted by timestamp, so the first buffer that isn't pinned
+    // is the oldest one
     for (; it != end; ++it) {
         RingBufferItem& find = *it;
 
@@ -215,9 +200,8 @@ status_t RingBufferConsumer::releaseOldestBufferLocked(size_t* pinnedFrames) {
             continue;
         }
 
-        if (find.mTimestamp < accIt->mTimestamp || accIt == end) {
-            accIt = it;
-        }
+        accIt = it;
+        break;
     }
 
     if (accIt != end) {
@@ -317,11 +301,34 @@ void RingBufferConsumer::onFrameAvailable(const BufferItem& item) {
         mLatestTimestamp = item.mTimestamp;
 
         item.mGraphicBuffer = mSlots[item.mSlot].mGraphicBuffer;
+
+        sortNewestBufferLocked();
     } // end of mMutex lock
 
     ConsumerBase::onFrameAvailable(item);
 }
 
+void RingBufferConsumer::sortNewestBufferLocked() {
+    List<RingBufferItem>::iterator newest = --mBufferItemList.end();
+
+    // Timestamps normally increase, so this only moves past the last item
+    // when the producer went back in time
+    List<RingBufferItem>::iterator pos = newest;
+    while (pos != mBufferItemList.begin()) {
+        List<RingBufferItem>::iterator prev = pos;
+        --prev;
+        if (prev->mTimestamp <= newest->mTimestamp) {
+            break;
+        }
+        pos = prev;
+    }
+
+    if (pos != newest) {
+        mBufferItemList.insert(pos, *newest);
+        mBufferItemList.erase(newest);
+    }
+}
+
 void RingBufferConsumer::unpinBuffer(const BufferItem& item) {
     Mutex::Autolock _l(mMutex);
 
@@ -166,20 +166,25 @@ class RingBufferConsumer : public ConsumerBase,
     // Override ConsumerBase::onFrameAvailable
     virtual void onFrameAvailable(const BufferItem& item);
 
-    void pinBufferLocked(const BufferItem& item);
+    struct RingBufferItem : public BufferItem {
+        RingBufferItem() : BufferItem(), mPinCount(0) {}
+        int mPinCount;
+    };
+
+    void pinBufferLocked(List<RingBufferItem>::iterator it);
     void unpinBuffer(const BufferItem& item);
 
     // Releases oldest buffer. Returns NO_BUFFER_AVAILABLE
-    // if all the buffers were pinned.
+    // if all the buffers were pinned, in which case pinnedFrames
+    // counts all of them.
     // Returns NOT_ENOUGH_DATA if list was empty.
     status_t releaseOldestBufferLocked(size_t* pinnedFrames);
 
-    struct RingBufferItem : public BufferItem {
-        RingBufferItem() : BufferItem(), mPinCount(0) {}
-        int mPinCount;
-    };
+    // Moves the last acquired buffer to keep mBufferItemList sorted by timestamp.
+    void sortNewestBufferLocked();
 
-    // List of acquired buffers in our ring buffer
+    // List of acquired buffers in our ring buffer, from the oldest to the
+    // newest timestamp
     List<RingBufferItem>       mBufferItemList;
     const int                  mBufferCount;
 
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "Camera3-FrameTimeline"
+//#define LOG_NDEBUG 0
+
+#include "FrameTimeline.h"
+
+#include <algorithm>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <utils/Log.h>
+
+namespace android {
+
+const char *FrameTimeline::kEventNames[EVENT_COUNT] = {
+    "submit",
+    "shutter",
+    "partial",
+    "buffers",
+    "result"
+};
+
+FrameTimeline::FrameTimeline():
+        mLatestFrameNumber(0),
+        mHasFrames(false) {
+    memset(mFrames, 0, sizeof(mFrames));
+}
+
+void FrameTimeline::record(event e, uint32_t frameNumber) {
+    nsecs_t now = systemTime();
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    FrameRecord &frame = mFrames[frameNumber % kMaxFrames];
+    if (frame.frameNumber != frameNumber) {
+        // The slot holds an older frame, or nothing yet
+        memset(&frame, 0, sizeof(frame));
+        frame.frameNumber = frameNumber;
+    }
+    if (e == PARTIAL_RESULT && frame.timestamps[e] != 0) {
+        return;
+    }
+    frame.timestamps[e] = now;
+
+    if (!mHasFrames || frameNumber > mLatestFrameNumber) {
+        mLatestFrameNumber = frameNumber;
+        mHasFrames = true;
+    }
+}
+
+void FrameTimeline::dumpTimeline(int fd) {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (!mHasFrames) {
+        dprintf(fd, "    Frame timeline: no frames yet\n");
+        return;
+    }
+
+    dprintf(fd, "    Frame timeline (ms after submit):\n");
+    dprintf(fd, "      %10s %16s", "frame", "submit (ns)");
+    for (int e = SHUTTER; e < EVENT_COUNT; e++) {
+        dprintf(fd, " %9s", kEventNames[e]);
+    }
+    dprintf(fd, "\n");
+
+    size_t count = static_cast<size_t>(mLatestFrameNumber) + 1;
+    if (count > kMaxDumpedFrames) {
+        count = kMaxDumpedFrames;
+    }
+    for (size_t i = count; i > 0; i--) {
+        uint32_t frameNumber = mLatestFrameNumber - (i - 1);
+        const FrameRecord &frame = mFrames[frameNumber % kMaxFrames];
+        if (frame.frameNumber != frameNumber || frame.timestamps[REQUEST_SUBMITTED] == 0) {
+            continue;
+        }
+        nsecs_t submitted = frame.timestamps[REQUEST_SUBMITTED];
+        dprintf(fd, "      %10" PRIu32 " %16" PRId64, frameNumber, submitted);
+        for (int e = SHUTTER; e < EVENT_COUNT; e++) {
+            if (frame.timestamps[e] == 0) {
+                dprintf(fd, " %9s", "-");
+            } else {
+                dprintf(fd, " %9.2f", (frame.timestamps[e] - submitted) / 1e6);
+            }
+        }
+        dprintf(fd, "\n");
+    }
+
+    dprintf(fd, "    Latency from submit over the last %zu frames (ms):\n", kMaxFrames);
+    for (int e = SHUTTER; e < EVENT_COUNT; e++) {
+        dumpLatencyLocked(fd, static_cast<event>(e));
+    }
+}
+
+void FrameTimeline::dumpLatencyLocked(int fd, event e) {
+    std::vector<nsecs_t> latencies;
+    latencies.reserve(kMaxFrames);
+    for (size_t i = 0; i < kMaxFrames; i++) {
+        const FrameRecord &frame = mFrames[i];
+        if (frame.timestamps[REQUEST_SUBMITTED] != 0 && frame.timestamps[e] != 0) {
+            latencies.push_back(frame.timestamps[e] - frame.timestamps[REQUEST_SUBMITTED]);
+        }
+    }
+    if (latencies.empty()) {
+        dprintf(fd, "      %-8s no samples\n", kEventNames[e]);
+        return;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    size_t last = latencies.size() - 1;
+    dprintf(fd, "      %-8s p50 %.2f, p90 %.2f, p99 %.2f, max %.2f (%zu samples)\n",
+            kEventNames[e],
+            latencies[last * 50 / 100] / 1e6,
+            latencies[last * 90 / 100] / 1e6,
+            latencies[last * 99 / 100] / 1e6,
+            latencies[last] / 1e6,
+            latencies.size());
+}
+
+} // namespace android
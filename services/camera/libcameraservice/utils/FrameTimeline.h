@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SERVERS_CAMERA_FRAMETIMELINE_H
+#define ANDROID_SERVERS_CAMERA_FRAMETIMELINE_H
+
+#include <mutex>
+
+#include <utils/Timers.h>
+
+namespace android {
+
+/**
+ * An always-on record of when each recent frame went through the camera pipeline.
+ * Keeps a fixed-size ring of per-frame timestamps, indexed by frame number, that can be
+ * dumped as a timeline with latency percentiles. Recording an event only takes a lock and
+ * stores a timestamp, so it is cheap enough to stay enabled. */
+class FrameTimeline {
+  public:
+    enum event {
+        REQUEST_SUBMITTED,   // Request sent to the HAL
+        SHUTTER,             // Shutter notification from the HAL
+        PARTIAL_RESULT,      // First partial result from the HAL
+        BUFFERS_RETURNED,    // Latest output buffers from the HAL
+        RESULT_DELIVERED,    // Latest result taken by the client
+        EVENT_COUNT
+    };
+
+    FrameTimeline();
+
+    // Record the current time for the event of the frame. PARTIAL_RESULT keeps the first
+    // time, all other events keep the latest one.
+    void record(event e, uint32_t frameNumber);
+
+    // Dump the most recent frames and latency percentiles to the provided fd
+    void dumpTimeline(int fd);
+
+  private:
+    // Latency percentiles of the event from the request submission
+    void dumpLatencyLocked(int fd, event e);
+
+    struct FrameRecord {
+        uint32_t frameNumber;
+        nsecs_t timestamps[EVENT_COUNT];
+    };
+
+    // Frames kept in the ring, and the most recent of them shown in the timeline
+    static const size_t kMaxFrames = 256;
+    static const size_t kMaxDumpedFrames = 16;
+
+    static const char *kEventNames[EVENT_COUNT];
+
+    std::mutex mMutex;
+    FrameRecord mFrames[kMaxFrames];
+    uint32_t mLatestFrameNumber;
+    bool mHasFrames;
+};
+
+} // namespace android
+
+#endif
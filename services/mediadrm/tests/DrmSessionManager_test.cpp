@@ -177,6 +177,11 @@ TEST_F(DrmSessionManagerTest, useSession) {
     const SessionInfos& infos2 = map.valueFor(kTestPid2);
     ExpectEqSessionInfo(infos1[0], mTestDrm1, mSessionId1, 3);
     ExpectEqSessionInfo(infos2[1], mTestDrm2, mSessionId3, 4);
+
+    // the used session moves behind the less recently used ones.
+    mDrmSessionManager->useSession(mSessionId2);
+    ExpectEqSessionInfo(infos2[0], mTestDrm2, mSessionId3, 4);
+    ExpectEqSessionInfo(infos2[1], mTestDrm2, mSessionId2, 5);
 }
 
 TEST_F(DrmSessionManagerTest, removeSession) {
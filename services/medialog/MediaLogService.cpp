@@ -17,7 +17,9 @@
 #define LOG_TAG "MediaLog"
 //#define LOG_NDEBUG 0
 
+#include <stdio.h>
 #include <sys/mman.h>
+#include <cutils/properties.h>
 #include <utils/Log.h>
 #include <binder/PermissionCache.h>
 #include <media/nbaio/NBLog.h>
@@ -28,6 +30,35 @@ namespace android {
 
 static const char kDeadlockedString[] = "MediaLogService may be deadlocked\n";
 
+static const int32_t kDefaultStreamMaxKb = 4096;
+static const int32_t kDefaultStreamPeriodMs = 100;
+
+MediaLogService::~MediaLogService()
+{
+    if (mMerger != 0) {
+        mMerger->requestExit();
+        mMerger->requestExitAndWait();
+    }
+}
+
+void MediaLogService::onFirstRef()
+{
+    char path[PROPERTY_VALUE_MAX];
+    if (property_get("media.log.stream_path", path, NULL) <= 0) {
+        return;
+    }
+    const int32_t maxKb = property_get_int32("media.log.stream_max_kb", kDefaultStreamMaxKb);
+    const int32_t periodMs =
+            property_get_int32("media.log.stream_period_ms", kDefaultStreamPeriodMs);
+    if (maxKb <= 0 || periodMs <= 0) {
+        ALOGE("invalid media.log.stream_max_kb %d or media.log.stream_period_ms %d",
+                maxKb, periodMs);
+        return;
+    }
+    mMerger = new Merger(*this, path, (off_t) maxKb * 1024, periodMs);
+    mMerger->run("MediaLogMerger", PRIORITY_BACKGROUND);
+}
+
 void MediaLogService::registerWriter(const sp<IMemory>& shared, size_t size, const char *name)
 {
     if (IPCThreadState::self()->getCallingUid() != AID_AUDIOSERVER || shared == 0 ||
@@ -36,7 +67,8 @@ void MediaLogService::registerWriter(const sp<IMemory>& shared, size_t size, con
         return;
     }
     sp<NBLog::Reader> reader(new NBLog::Reader(size, shared));
-    NamedReader namedReader(reader, name);
+    sp<NBLog::Reader> streamReader(mMerger != 0 ? new NBLog::Reader(size, shared) : NULL);
+    NamedReader namedReader(reader, streamReader, name);
     Mutex::Autolock _l(mLock);
     mNamedReaders.add(namedReader);
 }
@@ -49,6 +81,9 @@ void MediaLogService::unregisterWriter(const sp<IMemory>& shared)
     Mutex::Autolock _l(mLock);
     for (size_t i = 0; i < mNamedReaders.size(); ) {
         if (mNamedReaders[i].reader()->isIMemory(shared)) {
+            if (mNamedReaders[i].streamReader() != 0) {
+                mRetiredReaders.add(mNamedReaders[i]);
+            }
             mNamedReaders.removeAt(i);
         } else {
             i++;
@@ -99,6 +134,10 @@ status_t MediaLogService::dump(int fd, const Vector<String16>& args __unused)
         mLock.unlock();
     }
 
+    if (mMerger != 0) {
+        mMerger->dump(fd);
+    }
+
     for (size_t i = 0; i < namedReaders.size(); i++) {
         const NamedReader& namedReader = namedReaders[i];
         if (fd >= 0) {
@@ -111,6 +150,123 @@ status_t MediaLogService::dump(int fd, const Vector<String16>& args __unused)
     return NO_ERROR;
 }
 
+// ---------------------------------------------------------------------------
+
+MediaLogService::Merger::Merger(MediaLogService& service, const char *path, off_t maxBytes,
+        uint32_t periodMs)
+    : Thread(false /*canCallJava*/), mService(service), mPath(path), mMaxBytes(maxBytes),
+      mPeriodMs(periodMs), mFile(NULL), mLines(0), mRotations(0)
+{
+}
+
+MediaLogService::Merger::~Merger()
+{
+    if (mFile != NULL) {
+        gzclose(mFile);
+    }
+}
+
+void MediaLogService::Merger::requestExit()
+{
+    Thread::requestExit();
+    Mutex::Autolock _l(mLock);
+    mCond.signal();
+}
+
+void MediaLogService::Merger::dump(int fd)
+{
+    Mutex::Autolock _l(mLock);
+    dprintf(fd, "Streaming to %s%s: %llu lines, %u rotations\n", mPath.string(),
+            mFile == NULL ? " (not open)" : "", (unsigned long long) mLines, mRotations);
+}
+
+bool MediaLogService::Merger::openFile_l()
+{
+    mFile = gzopen(mPath.string(), "ab");
+    if (mFile == NULL) {
+        ALOGE("cannot open %s for streaming", mPath.string());
+        return false;
+    }
+    return true;
+}
+
+bool MediaLogService::Merger::threadLoop()
+{
+    {
+        Mutex::Autolock _l(mLock);
+        if (exitPending()) {
+            return false;
+        }
+        mCond.waitRelative(mLock, milliseconds(mPeriodMs));
+    }
+    merge();
+    return !exitPending();
+}
+
+void MediaLogService::Merger::merge()
+{
+    Vector<NamedReader> namedReaders;
+    {
+        Mutex::Autolock _l(mService.mLock);
+        namedReaders = mService.mNamedReaders;
+        namedReaders.appendVector(mService.mRetiredReaders);
+        mService.mRetiredReaders.clear();
+    }
+
+    // the lines of each reader are in time order already, so merge them by their heads
+    Vector< Vector<NBLog::Reader::Line> > lines;
+    lines.resize(namedReaders.size());
+    size_t total = 0;
+    for (size_t i = 0; i < namedReaders.size(); i++) {
+        namedReaders[i].streamReader()->read(lines.editItemAt(i));
+        total += lines[i].size();
+    }
+    if (total == 0) {
+        return;
+    }
+    Vector<size_t> heads;
+    heads.insertAt(0, 0, lines.size());
+
+    Mutex::Autolock _l(mLock);
+    if (mFile == NULL && !openFile_l()) {
+        return;
+    }
+    for (; total > 0; total--) {
+        ssize_t next = -1;
+        for (size_t i = 0; i < lines.size(); i++) {
+            if (heads[i] < lines[i].size() && (next < 0 ||
+                    lines[i][heads[i]].mTimeNs < lines[next][heads[next]].mTimeNs)) {
+                next = i;
+            }
+        }
+        const NBLog::Reader::Line& line = lines[next][heads.editItemAt(next)++];
+        if (line.mTimeNs >= 0) {
+            gzprintf(mFile, "%lld.%03lld %s: %s\n", (long long) (line.mTimeNs / 1000000000),
+                    (long long) (line.mTimeNs / 1000000 % 1000), namedReaders[next].name(),
+                    line.mText.string());
+        } else {
+            gzprintf(mFile, "- %s: %s\n", namedReaders[next].name(), line.mText.string());
+        }
+        mLines++;
+    }
+    // keep what has been merged readable if audioserver or this process dies
+    gzflush(mFile, Z_SYNC_FLUSH);
+    if (gzoffset(mFile) >= mMaxBytes) {
+        gzclose(mFile);
+        mFile = NULL;
+        String8 previous(mPath);
+        previous.append(".1");
+        if (rename(mPath.string(), previous.string()) != 0) {
+            ALOGW("cannot rename %s, truncating it", mPath.string());
+            unlink(mPath.string());
+        }
+        mRotations++;
+        (void) openFile_l();
+    }
+}
+
+// ---------------------------------------------------------------------------
+
 status_t MediaLogService::onTransact(uint32_t code, const Parcel& data, Parcel* reply,
         uint32_t flags)
 {
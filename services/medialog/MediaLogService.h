@@ -20,6 +20,9 @@
 #include <binder/BinderService.h>
 #include <media/IMediaLogService.h>
 #include <media/nbaio/NBLog.h>
+#include <utils/Condition.h>
+#include <utils/Thread.h>
+#include <zlib.h>
 
 namespace android {
 
@@ -28,8 +31,8 @@ class MediaLogService : public BinderService<MediaLogService>, public BnMediaLog
     friend class BinderService<MediaLogService>;    // for MediaLogService()
 public:
     MediaLogService() : BnMediaLogService() { }
-    virtual ~MediaLogService() { }
-    virtual void onFirstRef() { }
+    virtual ~MediaLogService();
+    virtual void onFirstRef();
 
     static const char*  getServiceName() { return "media.log"; }
 
@@ -52,18 +55,59 @@ private:
     Mutex               mLock;
     class NamedReader {
     public:
-        NamedReader() : mReader(0) { mName[0] = '\0'; } // for Vector
-        NamedReader(const sp<NBLog::Reader>& reader, const char *name) : mReader(reader)
+        NamedReader() : mReader(0), mStreamReader(0) { mName[0] = '\0'; } // for Vector
+        NamedReader(const sp<NBLog::Reader>& reader, const sp<NBLog::Reader>& streamReader,
+                const char *name) : mReader(reader), mStreamReader(streamReader)
             { strlcpy(mName, name, sizeof(mName)); }
         ~NamedReader() { }
         const sp<NBLog::Reader>&  reader() const { return mReader; }
+        // a second reader of the same writer for the Merger, so that dump() still shows
+        // the entries since the previous dump; 0 if not streaming
+        const sp<NBLog::Reader>&  streamReader() const { return mStreamReader; }
         const char*               name() const { return mName; }
     private:
         sp<NBLog::Reader>   mReader;
+        sp<NBLog::Reader>   mStreamReader;
         static const size_t kMaxName = 32;
         char                mName[kMaxName];
     };
     Vector<NamedReader> mNamedReaders;
+    Vector<NamedReader> mRetiredReaders;    // unregistered, for the Merger to drain one last time
+
+    // The Merger periodically drains the stream readers of all writers, merges their lines
+    // in timestamp order, and appends them to a gzip file, so that the history outlasts the
+    // circular buffers of the writers.  It is started if the property media.log.stream_path
+    // names the file.  When the file reaches media.log.stream_max_kb of compressed data,
+    // it is renamed with the suffix ".1", replacing the previous one, and a new file is begun.
+    class Merger : public Thread {
+    public:
+        Merger(MediaLogService& service, const char *path, off_t maxBytes, uint32_t periodMs);
+        virtual ~Merger();
+
+        void            dump(int fd);
+
+        // Thread virtuals
+        virtual void    requestExit();
+
+    private:
+        virtual bool    threadLoop();
+
+        // drains the readers and writes their merged lines
+        void            merge();
+        bool            openFile_l();
+
+        MediaLogService& mService;      // outlives the Merger, see ~MediaLogService()
+        const String8   mPath;
+        const off_t     mMaxBytes;
+        const uint32_t  mPeriodMs;
+
+        Mutex           mLock;
+        Condition       mCond;          // signaled on exit
+        gzFile          mFile;          // protected by mLock, NULL if it could not be opened
+        uint64_t        mLines;         // protected by mLock
+        uint32_t        mRotations;     // protected by mLock
+    };
+    sp<Merger>          mMerger;        // set once by onFirstRef(), 0 if not streaming
 };
 
 }   // namespace android
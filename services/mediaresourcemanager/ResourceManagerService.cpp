@@ -23,6 +23,7 @@
 #include <binder/IServiceManager.h>
 #include <dirent.h>
 #include <media/stagefright/ProcessInfo.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -43,7 +44,7 @@ static String8 getString(const Vector<T> &items) {
     return itemsStr;
 }
 
-static bool hasResourceType(MediaResource::Type type, Vector<MediaResource> resources) {
+static bool hasResourceType(MediaResource::Type type, const Vector<MediaResource> &resources) {
     for (size_t i = 0; i < resources.size(); ++i) {
         if (resources[i].mType == type) {
             return true;
@@ -52,7 +53,7 @@ static bool hasResourceType(MediaResource::Type type, Vector<MediaResource> reso
     return false;
 }
 
-static bool hasResourceType(MediaResource::Type type, ResourceInfos infos) {
+static bool hasResourceType(MediaResource::Type type, const ResourceInfos &infos) {
     for (size_t i = 0; i < infos.size(); ++i) {
         if (hasResourceType(type, infos[i].resources)) {
             return true;
@@ -61,6 +62,16 @@ static bool hasResourceType(MediaResource::Type type, ResourceInfos infos) {
     return false;
 }
 
+static uint64_t getCodecLoad(const ResourceInfo &info) {
+    uint64_t load = 0;
+    for (size_t i = 0; i < info.resources.size(); ++i) {
+        if (info.resources[i].mType == MediaResource::kCodecLoad) {
+            load += info.resources[i].mValue;
+        }
+    }
+    return load;
+}
+
 static ResourceInfos& getResourceInfosForEdit(
         int pid,
         PidResourceInfosMap& map) {
@@ -120,12 +131,16 @@ status_t ResourceManagerService::dump(int fd, const Vector<String16>& /* args */
     PidResourceInfosMap mapCopy;
     bool supportsMultipleSecureCodecs;
     bool supportsSecureWithNonSecureCodec;
+    uint64_t maxCodecLoad;
+    uint64_t totalCodecLoad;
     String8 serviceLog;
     {
         Mutex::Autolock lock(mLock);
         mapCopy = mMap;  // Shadow copy, real copy will happen on write.
         supportsMultipleSecureCodecs = mSupportsMultipleSecureCodecs;
         supportsSecureWithNonSecureCodec = mSupportsSecureWithNonSecureCodec;
+        maxCodecLoad = mMaxCodecLoad;
+        totalCodecLoad = getTotalCodecLoad_l();
         serviceLog = mServiceLog->toString("    " /* linePrefix */);
     }
 
@@ -139,6 +154,9 @@ status_t ResourceManagerService::dump(int fd, const Vector<String16>& /* args */
     snprintf(buffer, SIZE, "    SupportsSecureWithNonSecureCodec: %d\n",
             supportsSecureWithNonSecureCodec);
     result.append(buffer);
+    snprintf(buffer, SIZE, "    MaxCodecLoad: %llu (current %llu)\n",
+            (unsigned long long)maxCodecLoad, (unsigned long long)totalCodecLoad);
+    result.append(buffer);
 
     result.append("  Processes:\n");
     for (size_t i = 0; i < mapCopy.size(); ++i) {
@@ -176,7 +194,9 @@ ResourceManagerService::ResourceManagerService(sp<ProcessInfoInterface> processI
     : mProcessInfo(processInfo),
       mServiceLog(new ServiceLog()),
       mSupportsMultipleSecureCodecs(true),
-      mSupportsSecureWithNonSecureCodec(true) {}
+      mSupportsSecureWithNonSecureCodec(true),
+      mMaxCodecLoad(0),
+      mTotalCodecLoad(0) {}
 
 ResourceManagerService::~ResourceManagerService() {}
 
@@ -192,6 +212,8 @@ void ResourceManagerService::config(const Vector<MediaResourcePolicy> &policies)
             mSupportsMultipleSecureCodecs = (value == "true");
         } else if (type == kPolicySupportsSecureWithNonSecureCodec) {
             mSupportsSecureWithNonSecureCodec = (value == "true");
+        } else if (type == kPolicyMaxCodecLoad) {
+            mMaxCodecLoad = strtoull(value.string(), NULL, 10);
         }
     }
 }
@@ -212,8 +234,29 @@ void ResourceManagerService::addResource(
     }
     ResourceInfos& infos = getResourceInfosForEdit(pid, mMap);
     ResourceInfo& info = getResourceInfoForEdit(clientId, client, infos);
-    // TODO: do the merge instead of append.
-    info.resources.appendVector(resources);
+    for (size_t i = 0; i < resources.size(); ++i) {
+        // the codec load is re-reported as it changes, so it replaces the previous one.
+        if (resources[i].mType == MediaResource::kCodecLoad) {
+            bool replaced = false;
+            for (size_t j = 0; j < info.resources.size(); ++j) {
+                if (info.resources[j].mType == MediaResource::kCodecLoad) {
+                    mTotalCodecLoad -= info.resources[j].mValue;
+                    mTotalCodecLoad += resources[i].mValue;
+                    info.resources.editItemAt(j) = resources[i];
+                    replaced = true;
+                    break;
+                }
+            }
+            if (replaced) {
+                continue;
+            }
+        }
+        // TODO: do the merge instead of append.
+        if (resources[i].mType == MediaResource::kCodecLoad) {
+            mTotalCodecLoad += resources[i].mValue;
+        }
+        info.resources.push_back(resources[i]);
+    }
     notifyResourceGranted(pid, resources);
 }
 
@@ -237,6 +280,7 @@ void ResourceManagerService::removeResource(int pid, int64_t clientId) {
     ResourceInfos &infos = mMap.editValueAt(index);
     for (size_t j = 0; j < infos.size(); ++j) {
         if (infos[j].clientId == clientId) {
+            mTotalCodecLoad -= getCodecLoad(infos[j]);
             j = infos.removeAt(j);
             found = true;
             break;
@@ -258,6 +302,10 @@ void ResourceManagerService::getClientForResource_l(
     }
 }
 
+uint64_t ResourceManagerService::getTotalCodecLoad_l() const {
+    return mTotalCodecLoad;
+}
+
 bool ResourceManagerService::reclaimResource(
         int callingPid, const Vector<MediaResource> &resources) {
     String8 log = String8::format("reclaimResource(callingPid %d, resources %s)",
@@ -274,6 +322,7 @@ bool ResourceManagerService::reclaimResource(
         const MediaResource *secureCodec = NULL;
         const MediaResource *nonSecureCodec = NULL;
         const MediaResource *graphicMemory = NULL;
+        const MediaResource *codecLoad = NULL;
         for (size_t i = 0; i < resources.size(); ++i) {
             MediaResource::Type type = resources[i].mType;
             if (resources[i].mType == MediaResource::kSecureCodec) {
@@ -282,6 +331,8 @@ bool ResourceManagerService::reclaimResource(
                 nonSecureCodec = &resources[i];
             } else if (type == MediaResource::kGraphicMemory) {
                 graphicMemory = &resources[i];
+            } else if (type == MediaResource::kCodecLoad) {
+                codecLoad = &resources[i];
             }
         }
 
@@ -311,6 +362,14 @@ bool ResourceManagerService::reclaimResource(
             getClientForResource_l(callingPid, graphicMemory, &clients);
         }
 
+        if (clients.size() == 0 && codecLoad != NULL && mMaxCodecLoad > 0
+                && getTotalCodecLoad_l() + codecLoad->mValue > mMaxCodecLoad) {
+            // the codecs can't run the requested load on top of the current one, free the
+            // biggest load. This also covers codecs that have no output buffers to account for,
+            // e.g. tunneled ones.
+            getClientForResource_l(callingPid, codecLoad, &clients);
+        }
+
         if (clients.size() == 0) {
             // if we are here, run the third pass to free one codec with the same type.
             getClientForResource_l(callingPid, secureCodec, &clients);
@@ -355,6 +414,7 @@ bool ResourceManagerService::reclaimResource(
             ResourceInfos &infos = mMap.editValueAt(i);
             for (size_t j = 0; j < infos.size();) {
                 if (infos[j].client == failedClient) {
+                    mTotalCodecLoad -= getCodecLoad(infos[j]);
                     j = infos.removeAt(j);
                     found = true;
                 } else {
@@ -377,16 +437,19 @@ bool ResourceManagerService::getAllClients_l(
         int callingPid, MediaResource::Type type, Vector<sp<IResourceManagerClient>> *clients) {
     Vector<sp<IResourceManagerClient>> temp;
     for (size_t i = 0; i < mMap.size(); ++i) {
-        ResourceInfos &infos = mMap.editValueAt(i);
+        const ResourceInfos &infos = mMap.valueAt(i);
+        // the priorities are only checked once per process
+        bool checkedPriority = false;
         for (size_t j = 0; j < infos.size(); ++j) {
             if (hasResourceType(type, infos[j].resources)) {
-                if (!isCallingPriorityHigher_l(callingPid, mMap.keyAt(i))) {
+                if (!checkedPriority && !isCallingPriorityHigher_l(callingPid, mMap.keyAt(i))) {
                     // some higher/equal priority process owns the resource,
                     // this request can't be fulfilled.
                     ALOGE("getAllClients_l: can't reclaim resource %s from pid %d",
                             asString(type), mMap.keyAt(i));
                     return false;
                 }
+                checkedPriority = true;
                 temp.push_back(infos[j].client);
             }
         }
@@ -426,8 +489,7 @@ bool ResourceManagerService::getLowestPriorityBiggestClient_l(
 
 bool ResourceManagerService::getLowestPriorityPid_l(
         MediaResource::Type type, int *lowestPriorityPid, int *lowestPriority) {
-    int pid = -1;
-    int priority = -1;
+    Vector<int> pids;
     for (size_t i = 0; i < mMap.size(); ++i) {
         if (mMap.valueAt(i).size() == 0) {
             // no client on this process.
@@ -437,9 +499,23 @@ bool ResourceManagerService::getLowestPriorityPid_l(
             // doesn't have the requested resource type
             continue;
         }
-        int tempPid = mMap.keyAt(i);
+        pids.push_back(mMap.keyAt(i));
+    }
+
+    // query all the processes at once, and only ask them one by one if that fails so that
+    // the processes whose priority can't be read are skipped.
+    Vector<int> priorities;
+    bool havePriorities = (pids.size() > 1) && mProcessInfo->getPriorities(pids, &priorities)
+            && priorities.size() == pids.size();
+
+    int pid = -1;
+    int priority = -1;
+    for (size_t i = 0; i < pids.size(); ++i) {
+        int tempPid = pids[i];
         int tempPriority;
-        if (!mProcessInfo->getPriority(tempPid, &tempPriority)) {
+        if (havePriorities) {
+            tempPriority = priorities[i];
+        } else if (!mProcessInfo->getPriority(tempPid, &tempPriority)) {
             ALOGV("getLowestPriorityPid_l: can't get priority of pid %d, skipped", tempPid);
             // TODO: remove this pid from mMap?
             continue;
@@ -483,7 +559,7 @@ bool ResourceManagerService::getBiggestClient_l(
     uint64_t largestValue = 0;
     const ResourceInfos &infos = mMap.valueAt(index);
     for (size_t i = 0; i < infos.size(); ++i) {
-        Vector<MediaResource> resources = infos[i].resources;
+        const Vector<MediaResource> &resources = infos[i].resources;
         for (size_t j = 0; j < resources.size(); ++j) {
             if (resources[j].mType == type) {
                 if (resources[j].mValue > largestValue) {
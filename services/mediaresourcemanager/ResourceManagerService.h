@@ -103,12 +103,18 @@ private:
     void getClientForResource_l(
         int callingPid, const MediaResource *res, Vector<sp<IResourceManagerClient>> *clients);
 
+    // Gets the sum of the codec load of all the clients, in macroblocks per second. It is
+    // kept up to date as the resources are added and removed.
+    uint64_t getTotalCodecLoad_l() const;
+
     mutable Mutex mLock;
     sp<ProcessInfoInterface> mProcessInfo;
     sp<ServiceLog> mServiceLog;
     PidResourceInfosMap mMap;
     bool mSupportsMultipleSecureCodecs;
     bool mSupportsSecureWithNonSecureCodec;
+    uint64_t mMaxCodecLoad;  // in macroblocks per second, 0 if unlimited
+    uint64_t mTotalCodecLoad;  // sum of the codec load of the clients in mMap
 };
 
 // ----------------------------------------------------------------------------
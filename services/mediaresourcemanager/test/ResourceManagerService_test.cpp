@@ -217,6 +217,15 @@ protected:
         mService->config(policies2);
         EXPECT_FALSE(mService->mSupportsMultipleSecureCodecs);
         EXPECT_TRUE(mService->mSupportsSecureWithNonSecureCodec);
+
+        EXPECT_EQ(0u, mService->mMaxCodecLoad);
+        Vector<MediaResourcePolicy> policies3;
+        policies3.push_back(
+                MediaResourcePolicy(
+                        String8(kPolicyMaxCodecLoad),
+                        String8("972000")));
+        mService->config(policies3);
+        EXPECT_EQ(972000u, mService->mMaxCodecLoad);
     }
 
     void testRemoveResource() {
@@ -234,6 +243,68 @@ protected:
         EXPECT_EQ(mTestClient3, infos2[0].client);
     }
 
+    void testAddCodecLoad() {
+        Vector<MediaResource> resources1;
+        resources1.push_back(MediaResource(MediaResource::kCodecLoad, 100));
+        mService->addResource(kTestPid1, getId(mTestClient1), mTestClient1, resources1);
+        EXPECT_EQ(100u, mService->getTotalCodecLoad_l());
+
+        // a new codec load replaces the previous one of the client.
+        Vector<MediaResource> resources11;
+        resources11.push_back(MediaResource(MediaResource::kCodecLoad, 300));
+        mService->addResource(kTestPid1, getId(mTestClient1), mTestClient1, resources11);
+        const ResourceInfos &infos1 = mService->mMap.valueFor(kTestPid1);
+        EXPECT_EQ(1u, infos1.size());
+        expectEqResourceInfo(infos1[0], mTestClient1, resources11);
+
+        Vector<MediaResource> resources2;
+        resources2.push_back(MediaResource(MediaResource::kCodecLoad, 200));
+        mService->addResource(kTestPid2, getId(mTestClient2), mTestClient2, resources2);
+        EXPECT_EQ(500u, mService->getTotalCodecLoad_l());
+
+        mService->removeResource(kTestPid1, getId(mTestClient1));
+        EXPECT_EQ(200u, mService->getTotalCodecLoad_l());
+        mService->removeResource(kTestPid2, getId(mTestClient2));
+    }
+
+    void testReclaimResourceCodecLoad() {
+        Vector<MediaResource> resources;
+        resources.push_back(MediaResource(MediaResource::kNonSecureCodec, 1));
+        resources.push_back(MediaResource(MediaResource::kCodecLoad, 300));
+
+        Vector<MediaResource> resources1;
+        resources1.push_back(MediaResource(MediaResource::kNonSecureCodec, 1));
+        resources1.push_back(MediaResource(MediaResource::kCodecLoad, 400));
+        mService->addResource(kTestPid1, getId(mTestClient1), mTestClient1, resources1);
+        Vector<MediaResource> resources2;
+        resources2.push_back(MediaResource(MediaResource::kNonSecureCodec, 1));
+        resources2.push_back(MediaResource(MediaResource::kCodecLoad, 200));
+        mService->addResource(kTestPid2, getId(mTestClient2), mTestClient2, resources2);
+
+        mService->mMaxCodecLoad = 1000;
+
+        // priority too low
+        EXPECT_FALSE(mService->reclaimResource(kLowPriorityPid, resources));
+
+        // the requested load fits, one non-secure codec from lowest process got reclaimed
+        EXPECT_TRUE(mService->reclaimResource(kHighPriorityPid, resources));
+        verifyClients(true /* c1 */, false /* c2 */, false /* c3 */);
+
+        mService->addResource(kTestPid1, getId(mTestClient1), mTestClient1, resources1);
+        mService->mMaxCodecLoad = 800;
+
+        // the requested load doesn't fit, the biggest load from lowest process got reclaimed
+        Vector<MediaResource> loadOnly;
+        loadOnly.push_back(MediaResource(MediaResource::kCodecLoad, 300));
+        EXPECT_TRUE(mService->reclaimResource(kHighPriorityPid, loadOnly));
+        verifyClients(true /* c1 */, false /* c2 */, false /* c3 */);
+
+        // the requested load fits now
+        EXPECT_FALSE(mService->reclaimResource(kHighPriorityPid, loadOnly));
+
+        mService->removeResource(kTestPid2, getId(mTestClient2));
+    }
+
     void testGetAllClients() {
         addResource();
 
@@ -519,6 +590,11 @@ TEST_F(ResourceManagerServiceTest, removeResource) {
 TEST_F(ResourceManagerServiceTest, reclaimResource) {
     testReclaimResourceSecure();
     testReclaimResourceNonSecure();
+    testReclaimResourceCodecLoad();
+}
+
+TEST_F(ResourceManagerServiceTest, addCodecLoad) {
+    testAddCodecLoad();
 }
 
 TEST_F(ResourceManagerServiceTest, getAllClients_l) {
@@ -274,14 +274,17 @@ sp<IMemory> SoundTriggerHwService::prepareRecognitionEvent_l(
 void SoundTriggerHwService::sendRecognitionEvent(struct sound_trigger_recognition_event *event,
                                                  Module *module)
  {
-     AutoMutex lock(mServiceLock);
      if (module == NULL) {
          return;
      }
+     // The event may carry the buffered keyphrase audio. mMemoryDealer has its own lock, so
+     // copy it out before taking mServiceLock: the HAL callback thread must not wait for a
+     // concurrent capture state change, which calls back into the HAL, to finish first.
      sp<IMemory> eventMemory = prepareRecognitionEvent_l(event);
      if (eventMemory == 0) {
          return;
      }
+     AutoMutex lock(mServiceLock);
      sp<Module> strongModule;
      for (size_t i = 0; i < mModules.size(); i++) {
          if (mModules.valueAt(i).get() == module) {
@@ -331,11 +334,12 @@ sp<IMemory> SoundTriggerHwService::prepareSoundModelEvent_l(struct sound_trigger
 void SoundTriggerHwService::sendSoundModelEvent(struct sound_trigger_model_event *event,
                                                 Module *module)
 {
-    AutoMutex lock(mServiceLock);
+    // see sendRecognitionEvent()
     sp<IMemory> eventMemory = prepareSoundModelEvent_l(event);
     if (eventMemory == 0) {
         return;
     }
+    AutoMutex lock(mServiceLock);
     sp<Module> strongModule;
     for (size_t i = 0; i < mModules.size(); i++) {
         if (mModules.valueAt(i).get() == module) {
@@ -179,6 +179,8 @@ public:
            void detachModule(sp<Module> module);
 
     static void recognitionCallback(struct sound_trigger_recognition_event *event, void *cookie);
+           // prepare*Event_l() only use mMemoryDealer and may also be called without
+           // mServiceLock held
            sp<IMemory> prepareRecognitionEvent_l(struct sound_trigger_recognition_event *event);
            void sendRecognitionEvent(struct sound_trigger_recognition_event *event, Module *module);
 
@@ -12,6 +12,9 @@ LOCAL_SRC_FILES := \
 
 LOCAL_MODULE := fir
 
+# for the AudioResamplerDyn filter design
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../../services/audioflinger
+
 LOCAL_CFLAGS := -Werror -Wall
 
 include $(BUILD_HOST_EXECUTABLE)
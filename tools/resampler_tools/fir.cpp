@@ -15,11 +15,15 @@
  */
 
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "AudioResamplerFirOps.h"
+#include "AudioResamplerFirGen.h"
+
 static inline double sinc(double x) {
     if (fabs(x) == 0.0f) return 1.0f;
     return sin(x) / x;
@@ -64,12 +68,239 @@ static double kaiser(int k, int N, double beta) {
     return I0(beta * sqrt(1.0 - sqr((2.0*k)/N - 1.0))) / I0(beta);
 }
 
+// AudioResamplerDyn filter qualities, in the order of AudioResampler::src_quality
+enum {
+    DYN_LOW_QUALITY,
+    DYN_MED_QUALITY,
+    DYN_HIGH_QUALITY,
+    DYN_NUM_QUALITIES
+};
+
+static const char* const kDynQualityNames[DYN_NUM_QUALITIES] = {
+    "DYN_LOW_QUALITY", "DYN_MED_QUALITY", "DYN_HIGH_QUALITY",
+};
+
+// Filter design of AudioResamplerDyn, the cache key of its filter banks.
+struct DynDesign {
+    int L;
+    int halfNumCoefs;
+    double stopBandAtten;
+    double fcr;
+    double atten;
+};
+
+static int gcd(int n, int m) {
+    return m == 0 ? n : gcd(m, n % m);
+}
+
+// Returns the design chosen by AudioResamplerDyn::setSampleRate() and createKaiserFir(),
+// which this must be kept in sync with.  A design that does not match is not used by
+// AudioResamplerDyn, which then generates its filter at run time as before.
+static DynDesign dynDesign(int quality, int inSampleRate, int outSampleRate) {
+    DynDesign d;
+    double tbwCheat = 1.;
+    if (quality == DYN_HIGH_QUALITY) {
+        d.stopBandAtten = 98.;
+        if (inSampleRate >= outSampleRate * 4) {
+            d.halfNumCoefs = 48;
+        } else if (inSampleRate >= outSampleRate * 2) {
+            d.halfNumCoefs = 40;
+        } else {
+            d.halfNumCoefs = 32;
+        }
+    } else if (quality == DYN_LOW_QUALITY) {
+        d.stopBandAtten = 80.;
+        if (inSampleRate >= outSampleRate * 4) {
+            d.halfNumCoefs = 24;
+        } else if (inSampleRate >= outSampleRate * 2) {
+            d.halfNumCoefs = 16;
+        } else {
+            d.halfNumCoefs = 8;
+        }
+        tbwCheat = inSampleRate <= outSampleRate ? 1.05 : 1.03;
+    } else {
+        d.stopBandAtten = 84.;
+        if (inSampleRate >= outSampleRate * 4) {
+            d.halfNumCoefs = 32;
+        } else if (inSampleRate >= outSampleRate * 2) {
+            d.halfNumCoefs = 24;
+        } else {
+            d.halfNumCoefs = 16;
+        }
+        tbwCheat = inSampleRate <= outSampleRate ? 1.03 : 1.01;
+    }
+    int phases = outSampleRate / gcd(outSampleRate, inSampleRate);
+    while (phases < 63) {
+        phases *= 2;
+    }
+    if (phases >= 256) {
+        phases = 127;
+    }
+    d.L = phases;
+    d.atten = 0.9998;
+    const double tbw = android::firKaiserTbw(d.halfNumCoefs, d.stopBandAtten);
+    if (inSampleRate < outSampleRate) {
+        d.fcr = fmax(0.5*tbwCheat - tbw/2, tbw/2);
+    } else {
+        d.fcr = fmax(0.5*tbwCheat*outSampleRate/inSampleRate - tbw/2, tbw/2);
+    }
+    return d;
+}
+
+static const char* typeName(const float*) { return "float"; }
+static const char* typeName(const int16_t*) { return "int16_t"; }
+static const char* typeName(const int32_t*) { return "int32_t"; }
+
+static bool is_float(const float*) { return true; }
+template <typename T> static bool is_float(const T*) { return false; }
+
+static void printCoef(float c) { printf("%#.9gf,", c); }
+static void printCoef(int16_t c) { printf("%d,", c); }
+static void printCoef(int32_t c) { printf("%d,", c); }
+
+// Prints the coefficient table of design d as kDynFilter<index>, preceded by its measured
+// passband ripple, stopband attenuation and coefficient quantization SNR.
+template <typename T>
+static void printDynTable(int index, int quality, int inSampleRate, int outSampleRate,
+        const DynDesign& d) {
+    const int count = (d.L + 1) * d.halfNumCoefs;
+    T* coefs = new T[count];
+    double* exact = new double[count];
+    float* scaled = new float[count];
+    android::firKaiserGen(coefs, d.L, d.halfNumCoefs, d.stopBandAtten, d.fcr, d.atten);
+    android::firKaiserGen(exact, d.L, d.halfNumCoefs, d.stopBandAtten, d.fcr, d.atten);
+
+    // full scale of the coefficients of type T
+    const double scale = is_float(coefs) ? 1. : double(1ULL << (sizeof(T)*8 - 1));
+    double signal = 0, noise = 0;
+    for (int i = 0; i < count; i++) {
+        const double e = exact[i] * scale;
+        signal += e * e;
+        noise += sqr(coefs[i] - e);
+        // testFir() normalizes by the integer full scale of its type, 2^31 for float
+        scaled[i] = coefs[i] * (double(1ULL << 31) / scale);
+    }
+
+    const double tbw = android::firKaiserTbw(d.halfNumCoefs, d.stopBandAtten);
+    const double fp = (d.fcr - tbw/2) / d.L;
+    const double fs = (d.fcr + tbw/2) / d.L;
+    double passMin, passMax, passRipple, stopMax, stopRipple;
+    android::testFir(scaled, d.L, d.halfNumCoefs, fp, fs, /*passSteps*/ 1000,
+            /*stopSteps*/ 100000, passMin, passMax, passRipple, stopMax, stopRipple);
+
+    printf("\n// %d -> %d Hz, %s, %s coefficients\n", inSampleRate, outSampleRate,
+            kDynQualityNames[quality], typeName(coefs));
+    printf("// passband(0, %lf): ripple %.6lf dB, stopband(%lf, 0.5): %.2lf dB, SNR %.2lf dB\n",
+            fp, passRipple, fs, stopRipple, noise > 0 ? 10. * log10(signal / noise) : INFINITY);
+    printf("static const %s kDynFilter%d[] __attribute__((aligned(32))) = {",
+            typeName(coefs), index);
+    const int perLine = is_float(coefs) ? 4 : 8; // halfNumCoefs is a multiple of 8
+    for (int i = 0; i < count; i++) {
+        if (i % perLine == 0) {
+            printf("\n   ");
+        }
+        printf(" ");
+        printCoef(coefs[i]);
+    }
+    printf("\n};\n");
+    delete[] scaled;
+    delete[] exact;
+    delete[] coefs;
+}
+
+// Prints the list of the tables of coefficient type T, as generated by printDynTable().
+template <typename T>
+static void printDynTableList(const DynDesign* designs, const int* types, int count,
+        int type, const char* name) {
+    printf("\nstatic const DynFilterTable<%s> %s[] = {\n", typeName((T*)NULL), name);
+    for (int i = 0; i < count; i++) {
+        if (types[i] == type) {
+            printf("    { %d, %d, %.17g, %.17g, %.17g, kDynFilter%d },\n",
+                    designs[i].L, designs[i].halfNumCoefs, designs[i].stopBandAtten,
+                    designs[i].fcr, designs[i].atten, i);
+        }
+    }
+    printf("    { 0, 0, 0., 0., 0., NULL },\n};\n");
+}
+
+// Generates AudioResamplerDynTables.h: the AudioResamplerDyn filter banks of the qualities
+// in qualityMask, for the in:out sample rate pairs in rates, either with the coefficients used
+// for float resampling, or with those used by each quality for 16 bit resampling.
+static int generateDynTables(int argc, char** argv, int qualityMask, bool floatCoefs,
+        char** rates, int numRates) {
+    enum { TYPE_FLOAT, TYPE_INT16, TYPE_INT32 };
+    const int maxDesigns = numRates * DYN_NUM_QUALITIES;
+    DynDesign* designs = new DynDesign[maxDesigns];
+    int* types = new int[maxDesigns];
+    int count = 0;
+
+    printf("// cmd-line:");
+    for (int i = 0; i < argc; i++) {
+        printf(" %s", argv[i]);
+    }
+    printf("\n// Generated by frameworks/av/tools/resampler_tools/fir -G, do not edit.\n");
+    printf("\n#ifndef ANDROID_AUDIO_RESAMPLER_DYN_TABLES_H\n");
+    printf("#define ANDROID_AUDIO_RESAMPLER_DYN_TABLES_H\n");
+    printf("\n#include <stddef.h>\n#include <stdint.h>\n");
+    printf("\nnamespace android {\n");
+    printf("\n// A precomputed filter bank and the design it was generated from.\n");
+    printf("template <typename TC>\nstruct DynFilterTable {\n");
+    printf("    int L;\n    int halfNumCoefs;\n    double stopBandAtten;\n");
+    printf("    double fcr;\n    double atten;\n");
+    printf("    const TC* coefs;    // (L+1)*halfNumCoefs coefficients, NULL ends the list\n");
+    printf("};\n");
+
+    for (int r = 0; r < numRates; r++) {
+        int inSampleRate, outSampleRate;
+        if (sscanf(rates[r], "%d:%d", &inSampleRate, &outSampleRate) != 2
+                || inSampleRate <= 0 || outSampleRate <= 0) {
+            fprintf(stderr, "invalid sample rate pair %s\n", rates[r]);
+            return 1;
+        }
+        for (int q = 0; q < DYN_NUM_QUALITIES; q++) {
+            if (!(qualityMask & (1 << q))) {
+                continue;
+            }
+            designs[count] = dynDesign(q, inSampleRate, outSampleRate);
+            if (floatCoefs) {
+                types[count] = TYPE_FLOAT;
+                printDynTable<float>(count, q, inSampleRate, outSampleRate, designs[count]);
+            } else if (q == DYN_HIGH_QUALITY) {
+                types[count] = TYPE_INT32;
+                printDynTable<int32_t>(count, q, inSampleRate, outSampleRate, designs[count]);
+            } else {
+                types[count] = TYPE_INT16;
+                printDynTable<int16_t>(count, q, inSampleRate, outSampleRate, designs[count]);
+            }
+            count++;
+        }
+    }
+
+    printDynTableList<float>(designs, types, count, TYPE_FLOAT, "kDynFilterTablesFloat");
+    printDynTableList<int16_t>(designs, types, count, TYPE_INT16, "kDynFilterTablesInt16");
+    printDynTableList<int32_t>(designs, types, count, TYPE_INT32, "kDynFilterTablesInt32");
+    printf("\n// Returns the NULL terminated list of the tables with coefficients of type TC.\n");
+    printf("static inline const DynFilterTable<float>* dynFilterTables(const float*) {\n");
+    printf("    return kDynFilterTablesFloat;\n}\n");
+    printf("static inline const DynFilterTable<int16_t>* dynFilterTables(const int16_t*) {\n");
+    printf("    return kDynFilterTablesInt16;\n}\n");
+    printf("static inline const DynFilterTable<int32_t>* dynFilterTables(const int32_t*) {\n");
+    printf("    return kDynFilterTablesInt32;\n}\n");
+    printf("\n} // namespace android\n");
+    printf("\n#endif // ANDROID_AUDIO_RESAMPLER_DYN_TABLES_H\n");
+
+    delete[] types;
+    delete[] designs;
+    return 0;
+}
+
 static void usage(char* name) {
     fprintf(stderr,
             "usage: %s [-h] [-d] [-D] [-s sample_rate] [-c cut-off_frequency] [-n half_zero_crossings]"
             " [-f {float|fixed|fixed16}] [-b beta] [-v dBFS] [-l lerp]\n"
             "       %s [-h] [-d] [-D] [-s sample_rate] [-c cut-off_frequency] [-n half_zero_crossings]"
             " [-f {float|fixed|fixed16}] [-b beta] [-v dBFS] -p M/N\n"
+            "       %s -G [-f {float|fixed}] [-q {low|med|high}]... in_rate:out_rate...\n"
             "    -h    this help message\n"
             "    -d    debug, print comma-separated coefficient table\n"
             "    -D    generate extra declarations\n"
@@ -81,8 +312,10 @@ static void usage(char* name) {
             "    -m    number of polyphases (related to -l, default 16)\n"
             "    -f    output format, can be fixed, fixed16, or float (fixed)\n"
             "    -b    kaiser window parameter beta (7.865 [-80dB])\n"
-            "    -v    attenuation in dBFS (0)\n",
-            name, name
+            "    -v    attenuation in dBFS (0)\n"
+            "    -G    generate the AudioResamplerDyn precomputed filter banks header\n"
+            "    -q    AudioResamplerDyn quality to generate, may be repeated (all)\n",
+            name, name, name
     );
     exit(0);
 }
@@ -100,6 +333,8 @@ int main(int argc, char** argv)
     double atten = 1;
     int format = 0;     // 0=fixed, 1=float
     bool declarations = false;
+    bool dynTables = false;
+    int dynQualityMask = 0;
 
     // in order to keep the errors associated with the linear
     // interpolation of the coefficients below the quantization error
@@ -160,7 +395,7 @@ int main(int argc, char** argv)
 
     int M = 1 << 4; // number of phases for interpolation
     int ch;
-    while ((ch = getopt(argc, argv, ":hds:c:n:f:l:m:b:p:v:z:D")) != -1) {
+    while ((ch = getopt(argc, argv, ":hds:c:n:f:l:m:b:p:v:z:DGq:")) != -1) {
         switch (ch) {
             case 'd':
                 debug = true;
@@ -168,6 +403,20 @@ int main(int argc, char** argv)
             case 'D':
                 declarations = true;
                 break;
+            case 'G':
+                dynTables = true;
+                break;
+            case 'q':
+                if (!strcmp(optarg, "low")) {
+                    dynQualityMask |= 1 << DYN_LOW_QUALITY;
+                } else if (!strcmp(optarg, "med")) {
+                    dynQualityMask |= 1 << DYN_MED_QUALITY;
+                } else if (!strcmp(optarg, "high")) {
+                    dynQualityMask |= 1 << DYN_HIGH_QUALITY;
+                } else {
+                    usage(argv[0]);
+                }
+                break;
             case 'p':
                 if (sscanf(optarg, "%u/%u", &polyM, &polyN) != 2) {
                     usage(argv[0]);
@@ -217,6 +466,17 @@ int main(int argc, char** argv)
         }
     }
 
+    if (dynTables) {
+        if (optind >= argc) {
+            usage(argv[0]);
+        }
+        if (dynQualityMask == 0) {
+            dynQualityMask = (1 << DYN_NUM_QUALITIES) - 1;
+        }
+        return generateDynTables(argc, argv, dynQualityMask, format == 1,
+                argv + optind, argc - optind);
+    }
+
     // cut off frequency ratio Fc/Fs
     double Fcr = Fc / Fs;
 